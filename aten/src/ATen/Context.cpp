@@ -74,6 +74,15 @@ void Context::setBenchmarkCuDNN(bool b) {
   benchmark_cudnn = b;
 }
 
+int64_t Context::workspaceLimitCuDNN() const {
+  return workspace_limit_cudnn;
+}
+
+void Context::setWorkspaceLimitCuDNN(int64_t limit) {
+  AT_CHECK(limit >= 0, "the cuDNN workspace limit must be non-negative, got ", limit);
+  workspace_limit_cudnn = limit;
+}
+
 bool Context::hasMKL() const {
 #if AT_MKL_ENABLED()
   return true;
@@ -109,6 +109,10 @@ class CAFFE2_API Context {
   void setBenchmarkCuDNN(bool);
   bool deterministicCuDNN() const;
   void setDeterministicCuDNN(bool);
+  // The cap, in bytes, on the workspace of the convolution algorithms
+  // chosen by cuDNN, or 0 for no cap
+  int64_t workspaceLimitCuDNN() const;
+  void setWorkspaceLimitCuDNN(int64_t);
   std::unique_ptr<Generator>
     generator_registry[static_cast<int>(DeviceType::COMPILE_TIME_MAX_DEVICE_TYPES)];
 private:
@@ -127,6 +131,7 @@ private:
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool benchmark_cudnn = false;
+  int64_t workspace_limit_cudnn = 0;
   std::atomic<size_t> next_id;
   std::unique_ptr<THCState, void(*)(THCState*)> thc_state;
   friend struct Type;
@@ -1,5 +1,6 @@
 #include "ATen/DLConvertor.h"
 #include "ATen/Functions.h"
+#include "ATen/detail/CUDAHooksInterface.h"
 
 #include <iostream>
 #include <sstream>
@@ -37,6 +38,8 @@ static DLDataType getDLDataType(const Type& type) {
     case ScalarType::Half:
       dtype.code = DLDataTypeCode::kDLFloat;
       break;
+    case ScalarType::BFloat16:
+      throw std::logic_error("BFloat16 is not supported by dlpack");
     case ScalarType::ComplexHalf:
       throw std::logic_error("ComplexHalf is not supported by dlpack");
     case ScalarType::ComplexFloat:
@@ -177,4 +180,25 @@ Tensor fromDLPack(const DLManagedTensor* src) {
       deleter,
       at::device(device_type).dtype(stype));
 }
+
+DLManagedTensor* toDLPack(const Tensor& src, void* consumer_stream) {
+  if (src.is_cuda()) {
+    const auto& hooks = detail::getCUDAHooks();
+    const int64_t device = src.get_device();
+    hooks.streamWaitStream(
+        consumer_stream, hooks.getCurrentCUDAStreamHandle(device), device);
+  }
+  return toDLPack(src);
+}
+
+
+Tensor fromDLPack(const DLManagedTensor* src, void* producer_stream) {
+  if (getATenDeviceType(src->dl_tensor.ctx) == DeviceType::CUDA) {
+    const auto& hooks = detail::getCUDAHooks();
+    const int64_t device = src->dl_tensor.ctx.device_id;
+    hooks.streamWaitStream(
+        hooks.getCurrentCUDAStreamHandle(device), producer_stream, device);
+  }
+  return fromDLPack(src);
+}
 } //namespace at
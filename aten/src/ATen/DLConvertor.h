@@ -14,4 +14,15 @@ CAFFE2_API ScalarType toScalarType(const DLDataType& dtype);
 CAFFE2_API DLManagedTensor* toDLPack(const Tensor& src);
 CAFFE2_API Tensor fromDLPack(const DLManagedTensor* src);
 
+// The DLPack tensors carry no stream, so a consumer of a CUDA tensor must
+// otherwise synchronize with the streams it was produced on before using it.
+// These overloads make the cudaStream_t of the consumer wait for the work
+// queued so far on the current stream of the producer instead, without
+// blocking the host: on the consumer_stream that will use the tensor when
+// exporting it, and on the current stream of the tensor's device for the
+// producer_stream that produced it when importing it. The streams are
+// ignored for CPU tensors.
+CAFFE2_API DLManagedTensor* toDLPack(const Tensor& src, void* consumer_stream);
+CAFFE2_API Tensor fromDLPack(const DLManagedTensor* src, void* producer_stream);
+
 } //namespace at
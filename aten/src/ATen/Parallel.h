@@ -1,8 +1,12 @@
 #pragma once
 #include <ATen/ATen.h>
+#include <ATen/Config.h>
+#include <ATen/core/thread_pool.h>
+#include <c10/util/TraceContext.h>
 #include <atomic>
 #include <cstddef>
 #include <exception>
+#include <functional>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -22,6 +26,95 @@ inline int64_t divup(int64_t x, int64_t y) {
   return (x + y - 1) / y;
 }
 
+// Inter-op parallelism: runs func asynchronously on a pool that is separate
+// from the one used by parallel_for, so that independent ops (e.g. forked
+// TorchScript subgraphs) can execute concurrently, each with its own
+// intra-op parallelism. Exceptions thrown by func are swallowed; report
+// errors through the result channel (e.g. an ivalue::Future) instead.
+CAFFE2_API void launch(std::function<void()> func);
+
+// Sets the number of inter-op threads. Must be called before the first
+// call to launch().
+CAFFE2_API void set_num_interop_threads(int);
+
+CAFFE2_API int get_num_interop_threads();
+
+#if AT_PARALLEL_NATIVE()
+
+// The native backend runs parallel regions on a lazily created
+// WorkStealingThreadPool (see ATen/core/thread_pool.h) sized by
+// at::set_num_threads(), or by the number of hardware threads if that was
+// never called. The calling thread always participates, so get_thread_num()
+// returns 0 for it and 1..get_max_threads()-1 for pool workers.
+
+CAFFE2_API int get_max_threads();
+
+CAFFE2_API int get_thread_num();
+
+CAFFE2_API bool in_parallel_region();
+
+// Runs func asynchronously on the intra-op pool.
+CAFFE2_API void intraop_launch(std::function<void()> func);
+
+// Counters of the intra-op pool's workers, e.g. to tell how busy it is. The
+// share of regions that launching threads run themselves is not included.
+CAFFE2_API c10::WorkStealingThreadPool::Stats get_intraop_pool_stats();
+
+namespace internal {
+// Runs f over [begin, end) split into chunks of at least grain_size
+// elements. Chunks are claimed dynamically, so threads that finish early
+// pick up the remaining work rather than idling. Nested calls from inside a
+// chunk reuse the same pool and never spawn additional threads.
+CAFFE2_API void _parallel_run(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& f);
+} // namespace internal
+
+template <class F>
+inline void parallel_for(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const F& f) {
+  if (begin >= end) {
+    return;
+  }
+  if ((end - begin) < grain_size || get_max_threads() == 1) {
+    f(begin, end);
+    return;
+  }
+  internal::_parallel_run(begin, end, grain_size, f);
+}
+
+template <class scalar_t, class F, class SF>
+inline scalar_t parallel_reduce(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const scalar_t ident,
+    const F f,
+    const SF sf) {
+  if ((end - begin) < grain_size || get_max_threads() == 1) {
+    return f(begin, end, ident);
+  }
+  const int64_t num_results = divup((end - begin), grain_size);
+  std::vector<scalar_t> results(num_results);
+  scalar_t* results_data = results.data();
+  internal::_parallel_run(
+      0, num_results, 1, [&](int64_t begin_id, int64_t end_id) {
+        for (int64_t id = begin_id; id < end_id; id++) {
+          int64_t i = begin + id * grain_size;
+          results_data[id] = f(i, i + std::min(end - i, grain_size), ident);
+        }
+      });
+  return std::accumulate(
+      results_data, results_data + results.size(), ident, sf);
+}
+
+#else
+
 inline int get_max_threads() {
 #ifdef _OPENMP
   return omp_get_max_threads();
@@ -46,6 +139,11 @@ inline bool in_parallel_region() {
 #endif
 }
 
+// OpenMP threads cannot be handed arbitrary tasks, so this runs func inline.
+inline void intraop_launch(std::function<void()> func) {
+  func();
+}
+
 template <class F>
 inline void parallel_for(
     const int64_t begin,
@@ -55,8 +153,12 @@ inline void parallel_for(
 #ifdef _OPENMP
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
   std::exception_ptr eptr;
+  // OpenMP threads are not handed tasks, so they take the trace context of
+  // the caller here
+  auto trace_context = c10::TraceContext::current();
 #pragma omp parallel if (!omp_in_parallel() && ((end - begin) >= grain_size))
   {
+    c10::TraceContextGuard trace_guard(trace_context);
     int64_t num_threads = omp_get_num_threads();
     int64_t tid = omp_get_thread_num();
     int64_t chunk_size = divup((end - begin), num_threads);
@@ -105,4 +207,6 @@ inline scalar_t parallel_reduce(
   }
 }
 
+#endif // AT_PARALLEL_NATIVE()
+
 } // namespace at
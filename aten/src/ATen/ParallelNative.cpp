@@ -0,0 +1,202 @@
+#include <ATen/Parallel.h>
+
+#if AT_PARALLEL_NATIVE()
+
+#include <ATen/core/thread_pool.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if AT_MKL_ENABLED()
+#include <mkl.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace at {
+namespace {
+
+// Number of chunks handed out per thread. More than one chunk per thread
+// lets threads that finish early take over work from slower ones.
+constexpr int64_t CHUNKS_PER_THREAD = 4;
+
+// Thread number reported by get_thread_num(); 0 outside of pool workers.
+thread_local int thread_num_ = 0;
+// Whether the current thread is executing a chunk of a parallel region.
+thread_local bool in_parallel_region_ = false;
+
+c10::WorkStealingThreadPool& intraop_pool() {
+  static c10::WorkStealingThreadPool pool([]() -> size_t {
+    int num_threads = at::get_num_threads();
+    if (num_threads <= 0) {
+      num_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    }
+    // The thread that launches a region works on it as well.
+    return num_threads - 1;
+  }());
+  return pool;
+}
+
+// Also keeps MKL, and OpenMP users like MKL-DNN, called from a chunk to the
+// calling thread: the pool's threads already occupy the cores, and letting
+// each start its own would oversubscribe them.
+struct ParallelRegionGuard {
+  ParallelRegionGuard() : prev_(in_parallel_region_) {
+    in_parallel_region_ = true;
+#if AT_MKL_ENABLED()
+    prev_mkl_threads_ = mkl_set_num_threads_local(1);
+#endif
+#ifdef _OPENMP
+    prev_omp_threads_ = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+  }
+  ~ParallelRegionGuard() {
+    in_parallel_region_ = prev_;
+#if AT_MKL_ENABLED()
+    mkl_set_num_threads_local(prev_mkl_threads_);
+#endif
+#ifdef _OPENMP
+    omp_set_num_threads(prev_omp_threads_);
+#endif
+  }
+
+ private:
+  bool prev_;
+#if AT_MKL_ENABLED()
+  int prev_mkl_threads_;
+#endif
+#ifdef _OPENMP
+  int prev_omp_threads_;
+#endif
+};
+
+// Shared state of one parallel_for call. Owned jointly by the launching
+// thread and all helper tasks, since a helper may be dequeued only after
+// the region has already completed.
+struct ParallelRegion {
+  ParallelRegion(
+      int64_t begin,
+      int64_t end,
+      int64_t chunk_size,
+      const std::function<void(int64_t, int64_t)>& f)
+      : next(begin),
+        end(end),
+        chunk_size(chunk_size),
+        remaining(divup(end - begin, chunk_size)),
+        f(&f) {}
+
+  std::atomic<int64_t> next;
+  const int64_t end;
+  const int64_t chunk_size;
+  // Number of chunks that have not finished yet. f is only dereferenced
+  // after successfully claiming a chunk, i.e. while the launching thread is
+  // still blocked waiting for this to drop to zero.
+  std::atomic<int64_t> remaining;
+  const std::function<void(int64_t, int64_t)>* f;
+
+  // Set by the first chunk that throws; later chunks are skipped. eptr is
+  // only read by the launching thread once all chunks have finished.
+  std::atomic<bool> failed{false};
+  std::exception_ptr eptr;
+
+  std::mutex mutex;
+  std::condition_variable done;
+
+  void run_chunks() {
+    ParallelRegionGuard guard;
+    while (true) {
+      int64_t chunk_begin = next.fetch_add(chunk_size);
+      if (chunk_begin >= end) {
+        return;
+      }
+      if (!failed.load()) {
+        try {
+          (*f)(chunk_begin, std::min(end, chunk_begin + chunk_size));
+        } catch (...) {
+          bool expected = false;
+          if (failed.compare_exchange_strong(expected, true)) {
+            eptr = std::current_exception();
+          }
+        }
+      }
+      if (--remaining == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_all();
+      }
+    }
+  }
+};
+
+} // namespace
+
+int get_max_threads() {
+  return static_cast<int>(intraop_pool().size()) + 1;
+}
+
+int get_thread_num() {
+  return thread_num_;
+}
+
+bool in_parallel_region() {
+  return in_parallel_region_;
+}
+
+c10::WorkStealingThreadPool::Stats get_intraop_pool_stats() {
+  return intraop_pool().stats();
+}
+
+void intraop_launch(std::function<void()> func) {
+  auto& pool = intraop_pool();
+  if (pool.size() == 0) {
+    func();
+    return;
+  }
+  pool.run([func, &pool]() {
+    thread_num_ = pool.currentWorkerId() + 1;
+    func();
+  });
+}
+
+namespace internal {
+
+void _parallel_run(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& f) {
+  auto& pool = intraop_pool();
+  const int64_t num_threads = static_cast<int64_t>(pool.size()) + 1;
+  const int64_t chunk_size = std::max<int64_t>(
+      std::max<int64_t>(grain_size, 1),
+      divup(end - begin, num_threads * CHUNKS_PER_THREAD));
+
+  auto region = std::make_shared<ParallelRegion>(begin, end, chunk_size, f);
+  const int64_t num_helpers =
+      std::min<int64_t>(region->remaining.load() - 1, pool.size());
+  for (int64_t i = 0; i < num_helpers; ++i) {
+    pool.run([region, &pool]() {
+      thread_num_ = pool.currentWorkerId() + 1;
+      region->run_chunks();
+    });
+  }
+
+  region->run_chunks();
+  {
+    std::unique_lock<std::mutex> lock(region->mutex);
+    region->done.wait(lock, [&]() { return region->remaining.load() == 0; });
+  }
+  if (region->eptr) {
+    std::rethrow_exception(region->eptr);
+  }
+}
+
+} // namespace internal
+} // namespace at
+
+#endif // AT_PARALLEL_NATIVE()
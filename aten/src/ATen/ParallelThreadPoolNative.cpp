@@ -0,0 +1,53 @@
+#include <ATen/Parallel.h>
+#include <ATen/core/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace at {
+namespace {
+
+// Number of inter-op threads requested through set_num_interop_threads(),
+// or -1 if it was never called.
+std::atomic<int> num_interop_threads{-1};
+// Set once the pool has been created; its size is fixed from then on.
+std::atomic<bool> interop_pool_created{false};
+
+int default_num_interop_threads() {
+  return std::max<int>(std::thread::hardware_concurrency(), 1);
+}
+
+c10::WorkStealingThreadPool& interop_pool() {
+  static c10::WorkStealingThreadPool pool([]() -> size_t {
+    interop_pool_created = true;
+    int num_threads = num_interop_threads.load();
+    return num_threads > 0 ? num_threads : default_num_interop_threads();
+  }());
+  return pool;
+}
+
+} // namespace
+
+void set_num_interop_threads(int nthreads) {
+  AT_CHECK(nthreads > 0, "Expected a positive number of threads, got ", nthreads);
+  AT_CHECK(
+      !interop_pool_created.load(),
+      "Cannot set the number of inter-op threads after inter-op work "
+      "has been launched");
+  num_interop_threads.store(nthreads);
+}
+
+int get_num_interop_threads() {
+  if (interop_pool_created.load()) {
+    return static_cast<int>(interop_pool().size());
+  }
+  int num_threads = num_interop_threads.load();
+  return num_threads > 0 ? num_threads : default_num_interop_threads();
+}
+
+void launch(std::function<void()> func) {
+  interop_pool().run(std::move(func));
+}
+
+} // namespace at
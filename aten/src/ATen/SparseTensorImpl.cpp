@@ -110,8 +110,10 @@ void SparseTensorImpl::set_indices_and_values_unsafe(const Tensor& indices, cons
 
   indices_ = indices;
   values_ = values;
+  clear_csr_indices();
 
   coalesced_ = false;
+  unique_indices_ = false;
 }
 
 
@@ -4,6 +4,9 @@
 #include "ATen/core/TensorImpl.h"
 #include "c10/util/Exception.h"
 
+#include <mutex>
+#include <utility>
+
 namespace at {
 struct CAFFE2_API SparseTensorImpl : public TensorImpl {
   // Stored in COO format, indices + values.
@@ -34,6 +37,20 @@ struct CAFFE2_API SparseTensorImpl : public TensorImpl {
   // because many algorithms proceed by merging two sorted lists (of indices).
   bool coalesced_ = false;
 
+  // Whether every index is known to occur at most once, although not
+  // necessarily in sorted order, e.g. in the transpose of a coalesced tensor.
+  // Coalescing such a tensor only needs to sort its entries.
+  bool unique_indices_ = false;
+
+  // The row indices of a coalesced matrix (sparse_dim == 2) compressed to the
+  // size(0) + 1 offsets of the rows into the nnz, as in the CSR format, and
+  // its column indices, both as the kernels of the backend take them. They
+  // are computed by the first sparse-dense matmul that needs them, and kept
+  // for the next ones with the same matrix until the indices or sizes change.
+  Tensor csr_row_indices_;
+  Tensor csr_col_indices_;
+  mutable std::mutex csr_mutex_;
+
 public:
   // Public for now...
   explicit SparseTensorImpl(at::TensorTypeId, const caffe2::TypeMeta&);
@@ -42,6 +59,7 @@ public:
   int64_t sparse_dim() const { return sparse_dim_; }
   int64_t dense_dim() const { return dense_dim_; }
   bool coalesced() const { return coalesced_; }
+  bool unique_indices() const { return coalesced_ || unique_indices_; }
   Tensor indices() const { return indices_; }
   Tensor values() const { return values_; }
 
@@ -63,6 +81,7 @@ public:
   // WARNING: This function does NOT preserve invariants of sparse_dim/dense_dim with
   // respect to indices and values
   void raw_resize_(int64_t sparse_dim, int64_t dense_dim, IntList size) {
+    clear_csr_indices();
     size_ = size.vec();
     sparse_dim_ = sparse_dim;
     dense_dim_ = dense_dim;
@@ -139,6 +158,7 @@ public:
       values_size.insert(values_size.end(), dense_size.begin(), dense_size.end());
       values_.resize_(values_size);
       indices_.resize_({sparse_dim, nnz});
+      clear_csr_indices();
     }
 
     size_ = size.vec();
@@ -166,9 +186,14 @@ public:
 
   void set_coalesced(bool coalesced) { coalesced_ = coalesced; }
 
+  // NOTE: this function doesn't check that the indices are unique, and
+  // coalesce() trusts it.
+  void set_unique_indices(bool unique_indices) { unique_indices_ = unique_indices; }
+
   // NOTE: this function is only used internally and not exposed to Python frontend
   void set_nnz_and_narrow(int64_t new_nnz) {
     AT_ASSERT(new_nnz <= nnz());
+    clear_csr_indices();
     indices_ = indices_.narrow(1, 0, new_nnz);
     values_ = values_.narrow(0, 0, new_nnz);
   }
@@ -182,7 +207,27 @@ public:
   // make it happen
   void set_indices_and_values_unsafe(const Tensor& indices, const Tensor& values);
 
+  // The CSR row and column indices kept by set_csr_indices, both undefined
+  // if none were kept since the indices or sizes last changed.
+  std::pair<Tensor, Tensor> csr_indices() const {
+    std::lock_guard<std::mutex> guard(csr_mutex_);
+    return std::make_pair(csr_row_indices_, csr_col_indices_);
+  }
+
+  // NOTE: the caller must make sure that the tensor is coalesced and that the
+  // indices are those of its current indices. Changing the indices in place,
+  // through indices(), does not drop them.
+  void set_csr_indices(const Tensor& row_indices, const Tensor& col_indices) {
+    std::lock_guard<std::mutex> guard(csr_mutex_);
+    csr_row_indices_ = row_indices;
+    csr_col_indices_ = col_indices;
+  }
+
  private:
+  void clear_csr_indices() {
+    set_csr_indices(Tensor(), Tensor());
+  }
+
   int64_t get_device_slow() const override {
     return values_.get_device();
   }
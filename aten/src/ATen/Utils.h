@@ -65,6 +65,9 @@ static inline TensorImpl* checked_tensor_unwrap(const Tensor& expr, const char *
   if(allowNull && !expr.defined()) {
     return nullptr;
   }
+  if (expr.is_variable()) {
+    AT_ERROR("Expected Tensor (not Variable) for argument #", pos, " '", name, "'");
+  }
   if (tensorTypeIdToBackend(expr.type_id()) != backend) {
     AT_ERROR("Expected object of backend ", backend, " but got backend ", tensorTypeIdToBackend(expr.type_id()),
              " for argument #", pos, " '", name, "'");
@@ -82,6 +85,10 @@ static inline std::vector<TensorImpl*> checked_tensor_list_unwrap(ArrayRef<Tenso
   unwrapped.reserve(tensors.size());
   for (unsigned int i = 0; i < tensors.size(); ++i) {
     const auto& expr = tensors[i];
+    if (expr.is_variable()) {
+      AT_ERROR("Expected Tensor (not Variable) for sequence element ", i,
+               " in sequence argument at position #", pos, " '", name, "'");
+    }
     if (tensorTypeIdToBackend(expr.type_id()) != backend) {
       AT_ERROR("Expected object of backend ", backend, " but got backend ", tensorTypeIdToBackend(expr.type_id()),
                " for sequence element ", i, " in sequence argument at position #", pos, " '", name, "'");
@@ -110,6 +110,12 @@ Tensor & ${Type}::_s_copy_from(const Tensor & src, Tensor & dst, bool non_blocki
 """)
 
 
+def is_cuda_bfloat16_copy(src_type, dst_type):
+    # BFloat16 is a CPU only type, copied by the native CPU kernel
+    return ('BFloat16' in (src_type['ScalarName'], dst_type['ScalarName']) and
+            'CUDA' in (src_type['Backend'], dst_type['Backend']))
+
+
 def create_one_copy(dst_type, all_types):
     copy_body = []
 
@@ -117,6 +123,8 @@ def create_one_copy(dst_type, all_types):
         if dst_type['Density'] == 'Sparse' or src_type['Density'] == 'Sparse':
             # skip sparse copies, which are not yet implemented
             continue
+        if is_cuda_bfloat16_copy(src_type, dst_type):
+            continue
         cuda = ''
         state = []
         if src_type['Backend'] == 'CUDA' or dst_type['Backend'] == 'CUDA':
@@ -188,6 +196,8 @@ def create_one_copy_from(src_type, all_types):
         if dst_type['Density'] == 'Sparse' or src_type['Density'] == 'Sparse':
             # skip sparse copies, which are not yet implemented
             continue
+        if is_cuda_bfloat16_copy(src_type, dst_type):
+            continue
         cuda = ''
         state = []
         if src_type['Backend'] == 'CUDA':
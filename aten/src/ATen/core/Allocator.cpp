@@ -27,10 +27,42 @@ void SetAllocator(at::DeviceType t, at::Allocator* alloc) {
   allocator_array[static_cast<int>(t)] = alloc;
 }
 
+namespace {
+
+thread_local at::Allocator* thread_local_allocator_array[static_cast<int>(
+    at::DeviceType::COMPILE_TIME_MAX_DEVICE_TYPES)];
+
+} // namespace
+
 at::Allocator* GetAllocator(const at::DeviceType& t) {
+  auto* alloc = thread_local_allocator_array[static_cast<int>(t)];
+  if (alloc) {
+    return alloc;
+  }
+  return GetGlobalAllocator(t);
+}
+
+at::Allocator* GetGlobalAllocator(const at::DeviceType& t) {
   auto* alloc = allocator_array[static_cast<int>(t)];
   AT_ASSERTM(alloc, "Allocator for ", t, " is not set.");
   return alloc;
 }
 
+ThreadLocalAllocatorGuard::ThreadLocalAllocatorGuard(
+    at::DeviceType t,
+    at::Allocator* alloc)
+    : device_type_(t),
+      prev_(thread_local_allocator_array[static_cast<int>(t)]),
+      active_(alloc != nullptr) {
+  if (active_) {
+    thread_local_allocator_array[static_cast<int>(t)] = alloc;
+  }
+}
+
+ThreadLocalAllocatorGuard::~ThreadLocalAllocatorGuard() {
+  if (active_) {
+    thread_local_allocator_array[static_cast<int>(device_type_)] = prev_;
+  }
+}
+
 } // namespace caffe2
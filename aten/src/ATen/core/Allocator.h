@@ -149,6 +149,26 @@ namespace caffe2 {
 CAFFE2_API void SetAllocator(at::DeviceType t, at::Allocator* alloc);
 CAFFE2_API at::Allocator* GetAllocator(const at::DeviceType& t);
 
+/** Returns the allocator set with SetAllocator for DeviceType `t`, ignoring
+ *  any ThreadLocalAllocatorGuard of the calling thread.
+ */
+CAFFE2_API at::Allocator* GetGlobalAllocator(const at::DeviceType& t);
+
+/** Makes GetAllocator(t) return `alloc` on the calling thread for the
+ *  lifetime of the guard. A null `alloc` leaves the current allocator in
+ *  place. caffe2::Workspace uses it to serve the allocations of the operators
+ *  it runs from its memory pool.
+ */
+struct CAFFE2_API ThreadLocalAllocatorGuard {
+  ThreadLocalAllocatorGuard(at::DeviceType t, at::Allocator* alloc);
+  ~ThreadLocalAllocatorGuard();
+
+ private:
+  at::DeviceType device_type_;
+  at::Allocator* prev_;
+  bool active_;
+};
+
 template <at::DeviceType t>
 struct AllocatorRegisterer {
   explicit AllocatorRegisterer(at::Allocator* alloc) {
@@ -8,6 +8,7 @@
 
 #include "ATen/core/ATenGeneral.h"
 #include "ATen/core/ScalarType.h"
+#include "ATen/core/BFloat16.h"
 #include "ATen/core/Half.h"
 
 namespace at {
@@ -27,6 +28,7 @@ class CAFFE2_API Scalar {
   // syntax v{ .member = ... } because it doesn't work on MSVC
 
   AT_FORALL_SCALAR_TYPES(DEFINE_IMPLICIT_CTOR)
+  DEFINE_IMPLICIT_CTOR(at::BFloat16,BFloat16,d)
 
 #undef DEFINE_IMPLICIT_CTOR
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <c10/util/ArrayRef.h>
+#include "ATen/core/BFloat16.h"
 #include "ATen/core/Half.h"
 #include <c10/util/typeid.h>
 
@@ -23,7 +24,8 @@ _(float,Float,d)   /* 6 */ \
 _(double,Double,d) /* 7 */ \
 _(at::ComplexHalf,ComplexHalf,z)        /* 8 */ \
 _(std::complex<float>,ComplexFloat,z)   /* 9 */ \
-_(std::complex<double>,ComplexDouble,z) /* 10 */
+_(std::complex<double>,ComplexDouble,z) /* 10 */ \
+_(at::BFloat16,BFloat16,d) /* 11 */
 
 // If you want to support ComplexHalf for real, replace occurrences
 // of this macro with AT_FORALL_SCALAR_TYPES_WITH_COMPLEX.  But
@@ -38,7 +40,8 @@ _(at::Half,Half,d) \
 _(float,Float,d)   \
 _(double,Double,d) \
 _(std::complex<float>,ComplexFloat,z) \
-_(std::complex<double>,ComplexDouble,z)
+_(std::complex<double>,ComplexDouble,z) \
+_(at::BFloat16,BFloat16,d)
 
 #define AT_FORALL_SCALAR_TYPES(_) \
 _(uint8_t,Byte,i)  \
@@ -155,7 +158,8 @@ static inline bool isIntegralType(ScalarType t) {
 static inline bool isFloatingType(ScalarType t) {
   return (t == ScalarType::Double ||
           t == ScalarType::Float ||
-          t == ScalarType::Half);
+          t == ScalarType::Half ||
+          t == ScalarType::BFloat16);
 }
 
 static inline bool isComplexType(ScalarType t) {
@@ -181,6 +185,16 @@ static inline ScalarType promoteTypes(ScalarType a, ScalarType b) {
   if (isComplexType(a) || isComplexType(b)) {
     AT_ERROR("promoteTypes with complex numbers is not handled yet; figure out what the correct rules should be");
   }
+  // BFloat16 is not in the lookup table, which follows NumPy's types: it wins
+  // over the integral types, and goes to Float with Half, which has more
+  // mantissa but less range.
+  if (a == ScalarType::BFloat16 || b == ScalarType::BFloat16) {
+    auto other = a == ScalarType::BFloat16 ? b : a;
+    if (other == ScalarType::Half) {
+      return f4;
+    }
+    return isFloatingType(other) ? other : ScalarType::BFloat16;
+  }
   static constexpr ScalarType _promoteTypesLookup
       [static_cast<int>(ScalarType::NumOptions)]
       [static_cast<int>(ScalarType::NumOptions)] = {
@@ -1 +1,26 @@
 #include <ATen/core/StorageImpl.h>
+
+#include "c10/util/ThreadLocalFreeList.h"
+
+namespace at {
+
+namespace {
+using StorageImplFreeList = c10::ThreadLocalFreeList<StorageImpl, sizeof(StorageImpl)>;
+} // namespace
+
+void* StorageImpl::operator new(size_t size) {
+  if (size == sizeof(StorageImpl)) {
+    return StorageImplFreeList::allocate();
+  }
+  return ::operator new(size);
+}
+
+void StorageImpl::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(StorageImpl)) {
+    StorageImplFreeList::deallocate(ptr);
+    return;
+  }
+  ::operator delete(ptr);
+}
+
+} // namespace at
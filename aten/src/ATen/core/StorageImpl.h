@@ -58,6 +58,10 @@ struct CAFFE2_API StorageImpl : public c10::intrusive_ptr_target {
   StorageImpl(const StorageImpl&) = delete;
   ~StorageImpl() = default;
 
+  // StorageImpls are allocated from a per thread free list, like TensorImpls
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   void reset() {
     data_ptr_.clear();
     numel_ = 0;
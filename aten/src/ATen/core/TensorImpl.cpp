@@ -4,11 +4,31 @@
 #include <ATen/core/LegacyTypeDispatch.h>
 #include <ATen/core/WrapDimMinimal.h>
 #include "c10/util/Optional.h"
+#include "c10/util/ThreadLocalFreeList.h"
 
 #include <ATen/core/VariableHooksInterface.h>
 
 namespace at {
 
+namespace {
+using TensorImplFreeList = c10::ThreadLocalFreeList<TensorImpl, sizeof(TensorImpl)>;
+} // namespace
+
+void* TensorImpl::operator new(size_t size) {
+  if (size == sizeof(TensorImpl)) {
+    return TensorImplFreeList::allocate();
+  }
+  return ::operator new(size);
+}
+
+void TensorImpl::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(TensorImpl)) {
+    TensorImplFreeList::deallocate(ptr);
+    return;
+  }
+  ::operator delete(ptr);
+}
+
 Tensor& TensorImpl::grad() {
   AT_ERROR("grad is not implemented for Tensor");
 }
@@ -302,6 +302,15 @@ struct CAFFE2_API TensorImpl : public c10::intrusive_ptr_target {
   TensorImpl(TensorImpl&&) = default;
   TensorImpl& operator=(TensorImpl&&) = default;
 
+  /**
+   * TensorImpls are allocated from a per thread free list (see
+   * c10/util/ThreadLocalFreeList.h), so that creating a tensor usually
+   * doesn't call malloc.  Subclasses have a different size and go to
+   * ::operator new.
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   /**
    * Release (decref) storage, and any other external allocations.  This
    * override is for `intrusive_ptr_target` and is used to implement weak
@@ -314,11 +314,11 @@ inline Tensor Tensor::index(TensorList indices) const {
 inline Tensor & Tensor::index_copy_(int64_t dim, const Tensor & index, const Tensor & source) {
     return type().index_copy_(*this, dim, index, source);
 }
-inline Tensor Tensor::index_put(TensorList indices, const Tensor & values) const {
-    return type().index_put(*this, indices, values);
+inline Tensor Tensor::index_put(TensorList indices, const Tensor & values, bool accumulate) const {
+    return type().index_put(*this, indices, values, accumulate);
 }
-inline Tensor & Tensor::index_put_(TensorList indices, const Tensor & values) {
-    return type().index_put_(*this, indices, values);
+inline Tensor & Tensor::index_put_(TensorList indices, const Tensor & values, bool accumulate) {
+    return type().index_put_(*this, indices, values, accumulate);
 }
 inline Tensor Tensor::inverse() const {
     return type().inverse(*this);
@@ -752,6 +752,9 @@ inline Tensor Tensor::_values() const {
 inline Tensor & Tensor::_coalesced_(bool coalesced) {
     return type()._coalesced_(*this, coalesced);
 }
+inline Tensor & Tensor::_unique_indices_(bool unique_indices) {
+    return type()._unique_indices_(*this, unique_indices);
+}
 inline Tensor Tensor::indices() const {
     return type().indices(*this);
 }
@@ -48,6 +48,7 @@ enum class TypeID {
   CPULong,
   CPUShort,
   CPUHalf,
+  CPUBFloat16,
   SparseCPUByte,
   SparseCPUChar,
   SparseCPUDouble,
@@ -257,8 +258,8 @@ struct CAFFE2_API Type {
   virtual Tensor irfft(const Tensor & self, int64_t signal_ndim, bool normalized, bool onesided, IntList signal_sizes) const = 0;
   virtual Tensor index(const Tensor & self, TensorList indices) const = 0;
   virtual Tensor & index_copy_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) const = 0;
-  virtual Tensor index_put(const Tensor & self, TensorList indices, const Tensor & values) const = 0;
-  virtual Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & values) const = 0;
+  virtual Tensor index_put(const Tensor & self, TensorList indices, const Tensor & values, bool accumulate) const = 0;
+  virtual Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & values, bool accumulate) const = 0;
   virtual Tensor inverse(const Tensor & self) const = 0;
   virtual Tensor isclose(const Tensor & self, const Tensor & other, double rtol, double atol, bool equal_nan) const = 0;
   virtual bool is_distributed(const Tensor & self) const = 0;
@@ -403,6 +404,7 @@ struct CAFFE2_API Type {
   virtual Tensor _indices(const Tensor & self) const = 0;
   virtual Tensor _values(const Tensor & self) const = 0;
   virtual Tensor & _coalesced_(Tensor & self, bool coalesced) const = 0;
+  virtual Tensor & _unique_indices_(Tensor & self, bool unique_indices) const = 0;
   virtual Tensor indices(const Tensor & self) const = 0;
   virtual Tensor values(const Tensor & self) const = 0;
   virtual int64_t numel(const Tensor & self) const = 0;
@@ -57,7 +57,10 @@ _(aten, _cudnn_rnn) \
 _(aten, _cudnn_rnn_backward) \
 _(aten, _cudnn_rnn_flatten_weight) \
 _(aten, _cufft_clear_plan_cache) \
+_(aten, _cufft_get_plan_cache_evictions) \
+_(aten, _cufft_get_plan_cache_hits) \
 _(aten, _cufft_get_plan_cache_max_size) \
+_(aten, _cufft_get_plan_cache_misses) \
 _(aten, _cufft_get_plan_cache_size) \
 _(aten, _cufft_set_plan_cache_max_size) \
 _(aten, _cumprod) \
@@ -402,6 +405,8 @@ _(aten, leaky_relu_forward) \
 _(aten, lerp) \
 _(aten, lgamma) \
 _(aten, linear) \
+_(aten, linear_prepack) \
+_(aten, linear_prepacked) \
 _(aten, linspace) \
 _(aten, log) \
 _(aten, log10) \
@@ -13,7 +13,21 @@
 
 namespace c10 {
 
+constexpr size_t InternedStrings::kInfoChunkSize;
+constexpr size_t InternedStrings::kMaxInfoChunks;
+
 Symbol InternedStrings::symbol(const std::string& s) {
+  auto sym = string_to_sym_.read(
+      [&](const std::unordered_map<std::string, Symbol>& map) -> optional<Symbol> {
+        auto it = map.find(s);
+        if (it == map.end()) {
+          return nullopt;
+        }
+        return it->second;
+      });
+  if (sym) {
+    return *sym;
+  }
   std::lock_guard<std::mutex> guard(mutex_);
   return _symbol(s);
 }
@@ -41,17 +55,22 @@ Symbol InternedStrings::ns(Symbol sym) {
     return namespaces::ns;
     FORALL_NS_SYMBOLS(DEFINE_CASE)
 #undef DEFINE_CASE
-    default: {
-      std::lock_guard<std::mutex> guard(mutex_);
-      return sym_to_info_.at(sym).ns;
-    }
+    default:
+      return info(sym).ns;
   }
 }
 
 Symbol InternedStrings::_symbol(const std::string& s) {
-  auto it = string_to_sym_.find(s);
-  if (it != string_to_sym_.end())
-    return it->second;
+  auto found = string_to_sym_.read(
+      [&](const std::unordered_map<std::string, Symbol>& map) -> optional<Symbol> {
+        auto it = map.find(s);
+        if (it == map.end()) {
+          return nullopt;
+        }
+        return it->second;
+      });
+  if (found)
+    return *found;
 
   auto pos = s.find("::");
   if (pos == std::string::npos) {
@@ -61,15 +80,34 @@ Symbol InternedStrings::_symbol(const std::string& s) {
   }
   Symbol ns = _symbol("namespaces::" + s.substr(0, pos));
 
-  Symbol sym(sym_to_info_.size());
-  string_to_sym_[s] = sym;
-  sym_to_info_.push_back({ns, s, s.substr(pos + strlen("::"))});
+  Symbol sym(num_symbols_.load());
+  mutableInfo(sym) = {ns, s, s.substr(pos + strlen("::"))};
+  num_symbols_.store(sym + 1, std::memory_order_release);
+  string_to_sym_.write(
+      [&](std::unordered_map<std::string, Symbol>& map) { map[s] = sym; });
   return sym;
 }
 
+InternedStrings::SymbolInfo& InternedStrings::mutableInfo(Symbol sym) {
+  const size_t chunk = sym / kInfoChunkSize;
+  if (chunk >= kMaxInfoChunks) {
+    throw std::runtime_error("too many symbols were interned");
+  }
+  if (!sym_to_info_[chunk]) {
+    sym_to_info_[chunk].reset(new SymbolInfo[kInfoChunkSize]);
+  }
+  return sym_to_info_[chunk][sym % kInfoChunkSize];
+}
+
+const InternedStrings::SymbolInfo& InternedStrings::info(Symbol sym) const {
+  if (sym >= num_symbols_.load(std::memory_order_acquire)) {
+    throw std::out_of_range("unknown symbol");
+  }
+  return sym_to_info_[sym / kInfoChunkSize][sym % kInfoChunkSize];
+}
+
 std::pair<const char*, const char*> InternedStrings::customString(Symbol sym) {
-  std::lock_guard<std::mutex> guard(mutex_);
-  SymbolInfo& s = sym_to_info_.at(sym);
+  const SymbolInfo& s = info(sym);
   return {s.qual_name.c_str(), s.unqual_name.c_str()};
 }
 
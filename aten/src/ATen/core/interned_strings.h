@@ -67,6 +67,13 @@ namespace c10 {
   _(prim, ConstantChunk)           \
   _(prim, NoneGenerator)           \
   _(prim, MMTreeReduce)            \
+  _(prim, MMBatchSide)             \
+  _(prim, AddMMBatchSide)          \
+  _(prim, ConvBatchSide)           \
+  _(prim, BatchedMM)               \
+  _(prim, MemoryArena)             \
+  _(prim, ArenaSlice)              \
+  _(prim, CalibrationObserver)     \
   _(aten, floordiv)                \
   _(aten, __round_to_zero_floordiv)\
   _(prim, fork)                    \
@@ -130,7 +137,9 @@ namespace c10 {
   _(attr, name)                    \
   _(attr, a)                       \
   _(attr, b)                       \
-  _(attr, beg)
+  _(attr, beg)                     \
+  _(attr, calibration)             \
+  _(attr, side)
 #else
 #define FORALL_NS_SYMBOLS(_) \
   _(namespaces, prim)              \
@@ -1,6 +1,8 @@
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -8,6 +10,7 @@
 #include <vector>
 #include "ATen/core/interned_strings.h"
 #include "c10/util/Exception.h"
+#include "c10/util/LeftRight.h"
 
 namespace c10 {
 
@@ -18,17 +21,32 @@ struct CAFFE2_API InternedStrings {
   Symbol ns(Symbol sym);
 
  private:
-  // prereq - holding mutex_
-  Symbol _symbol(const std::string& s);
-  std::pair<const char*, const char*> customString(Symbol sym);
-  std::unordered_map<std::string, Symbol> string_to_sym_;
-
   struct SymbolInfo {
     Symbol ns;
     std::string qual_name;
     std::string unqual_name;
   };
-  std::vector<SymbolInfo> sym_to_info_;
+
+  // prereq - holding mutex_
+  Symbol _symbol(const std::string& s);
+  // prereq - holding mutex_, or in the constructor
+  SymbolInfo& mutableInfo(Symbol sym);
+  const SymbolInfo& info(Symbol sym) const;
+  std::pair<const char*, const char*> customString(Symbol sym);
+
+  // Symbols are looked up by many threads at once, while compiling graphs
+  // and naming profiler events, and are rarely added, so that the lookups
+  // don't lock: the strings are read through a LeftRight, and the infos of
+  // the symbols are in chunks which never move, of which the first
+  // num_symbols_ entries are set. Adding a symbol (under mutex_) sets its
+  // info, publishes it by incrementing num_symbols_, and then adds its
+  // string.
+  LeftRight<std::unordered_map<std::string, Symbol>> string_to_sym_;
+
+  static constexpr size_t kInfoChunkSize = 1024;
+  static constexpr size_t kMaxInfoChunks = 4096;
+  std::unique_ptr<SymbolInfo[]> sym_to_info_[kMaxInfoChunks];
+  std::atomic<size_t> num_symbols_{0};
 
   std::mutex mutex_;
 };
@@ -6,8 +6,10 @@
 #include <ATen/core/UndefinedTensorImpl.h>
 #include <ATen/core/blob.h>
 #include <c10/util/intrusive_ptr.h>
-#include <ATen/core/thread_pool.h>
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <type_traits>
 
 namespace c10 {
@@ -212,7 +214,6 @@ struct CAFFE2_API IValue final {
 
   // Future
   IValue(c10::intrusive_ptr<ivalue::Future> v);
-  IValue(ivalue::Future&& future);
   bool isFuture() const { return Tag::Future == tag; }
   c10::intrusive_ptr<ivalue::Future> toFuture() && {
     AT_ASSERT(isFuture());
@@ -444,49 +445,79 @@ struct CAFFE2_API IValue final {
 };
 
 // Future
+// Futures may be completed and waited on from different threads; the
+// completing thread runs the registered callbacks after releasing the lock.
 struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
- private:
-  c10::intrusive_ptr<Future> intrusive_from_this() {
-    c10::raw::intrusive_ptr::incref(this); // we are creating a new pointer
-                                           // from a raw `this` pointer
-                                           // so we need to bump the refcount
-                                           // to account for this ownership
-    return c10::intrusive_ptr<Future>::reclaim(this);
-  }
-
  public:
+  // Blocks the calling thread until the future is completed.
   void wait() {
-    if (completed()) {
-      return;
-    }
-    c10::global_work_queue.workOnTasksUntilCompleted(intrusive_from_this());
-    AT_ASSERT(completed());
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_cv_.wait(lock, [&]() { return completed_; });
   }
 
+  // Error a future completes with when the computation producing its value
+  // failed; rethrown by value().
+  struct FutureError final : public std::exception {
+    explicit FutureError(std::string error_msg_)
+        : error_msg(std::move(error_msg_)) {}
+
+    const char* what() const noexcept override {
+      return error_msg.c_str();
+    }
+
+    std::string error_msg;
+  };
+
   void markCompleted(IValue value) {
-    value_ = std::move(value);
-    completed_ = true;
+    std::vector<std::function<void(void)>> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      AT_ASSERT(!completed_);
+      value_ = std::move(value);
+      completed_ = true;
+      callbacks.swap(callbacks_);
+    }
+    finished_cv_.notify_all();
     for (auto& callback : callbacks) {
       callback();
     }
-    callbacks.clear();
+  }
+
+  void markCompleted(FutureError&& error) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      has_error_ = true;
+      error_ = std::move(error);
+    }
+    markCompleted(IValue());
   }
 
   // Get the result of the current future.
   IValue value() {
-    AT_ASSERT(completed());
+    std::lock_guard<std::mutex> lock(mutex_);
+    AT_ASSERT(completed_);
+    if (has_error_) {
+      throw error_;
+    }
     return value_;
   }
 
+  // Runs callback once the future is completed, immediately and on the
+  // calling thread if it already is.
   void addCallback(std::function<void(void)> callback) {
-    if (completed()) {
-      callback();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!completed_) {
+        callbacks_.push_back(std::move(callback));
+        return;
+      }
     }
-    callbacks.push_back(callback);
+    callback();
   }
 
   // Check if the current future has completed
   bool completed() {
+    std::lock_guard<std::mutex> lock(mutex_);
     return completed_;
   }
 
@@ -495,9 +526,13 @@ struct C10_EXPORT ivalue::Future final : c10::intrusive_ptr_target {
       const Future& v);
 
  private:
+  std::mutex mutex_;
+  std::condition_variable finished_cv_;
   IValue value_; // when finished the value
   bool completed_ = false; // is this future complete
-  std::vector<std::function<void(void)>> callbacks;
+  std::vector<std::function<void(void)>> callbacks_;
+  bool has_error_ = false;
+  FutureError error_{""};
 };
 
 #undef TORCH_FORALL_TAGS
@@ -614,8 +649,6 @@ inline IValue::IValue(c10::intrusive_ptr<ivalue::Future> v)
 : tag(Tag::Future), is_intrusive_ptr(true) {
   payload.as_intrusive_ptr = v.release();
 }
-inline IValue::IValue(ivalue::Future&& future)
-: IValue(c10::make_intrusive<ivalue::Future>(std::move(future))) {}
 
 
 inline const std::vector<int64_t>& IValue::toIntListRef() const {
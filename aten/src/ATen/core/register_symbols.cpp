@@ -4,13 +4,16 @@
 // function is huge and only called once at startup.
 
 namespace c10 {
-InternedStrings::InternedStrings()
-    : sym_to_info_(static_cast<size_t>(_keys::num_symbols)) {
-#define REGISTER_SYMBOL(n, s)        \
-  string_to_sym_[#n "::" #s] = n::s; \
-  sym_to_info_[n::s] = {namespaces::n, #n "::" #s, #s};
+InternedStrings::InternedStrings() {
+  std::unordered_map<std::string, Symbol> builtins;
+#define REGISTER_SYMBOL(n, s)   \
+  builtins[#n "::" #s] = n::s; \
+  mutableInfo(n::s) = {namespaces::n, #n "::" #s, #s};
 
   FORALL_NS_SYMBOLS(REGISTER_SYMBOL)
 #undef REGISTER_SYMBOL
+  num_symbols_.store(static_cast<size_t>(_keys::num_symbols));
+  string_to_sym_.write(
+      [&](std::unordered_map<std::string, Symbol>& map) { map = builtins; });
 }
 } // namespace c10
@@ -1,25 +1,134 @@
 #include <ATen/core/thread_pool.h>
-#include <ATen/core/ivalue.h>
+
+#include <c10/util/TraceContext.h>
+
+#include <chrono>
 
 namespace c10 {
 
-ThreadPool::ThreadPool() { /* intended to leave empty */ }
+namespace {
+// Pool and worker index of the calling thread, if it is a pool worker.
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local int current_worker_id = -1;
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t num_threads)
+    : pending_(0),
+      next_queue_(0),
+      running_(true),
+      tasks_run_(0),
+      tasks_stolen_(0),
+      busy_nanoseconds_(0) {
+  queues_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    queues_.emplace_back(new TaskQueue());
+  }
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i]() { mainLoop(i); });
+  }
+}
 
-ThreadPool::~ThreadPool() { /* intended to leave empty */ }
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  condition_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+int WorkStealingThreadPool::currentWorkerId() const {
+  return current_pool == this ? current_worker_id : -1;
+}
 
-void ThreadPool::schedule(std::function<void(void)> task) {
-  tasks.push(task);
+WorkStealingThreadPool::Stats WorkStealingThreadPool::stats() const {
+  Stats stats;
+  stats.tasks_run = tasks_run_.load();
+  stats.tasks_stolen = tasks_stolen_.load();
+  stats.busy_nanoseconds = busy_nanoseconds_.load();
+  return stats;
 }
 
-void ThreadPool::workOnTasksUntilCompleted(
-    c10::intrusive_ptr<ivalue::Future> future) {
-  while (!future->completed()) {
-    auto task = tasks.front();
-    tasks.pop();
+void WorkStealingThreadPool::run(std::function<void()> task) {
+  if (threads_.empty()) {
     task();
+    return;
   }
+  task = withCurrentTraceContext(std::move(task));
+  int self = currentWorkerId();
+  size_t id = self >= 0 ? static_cast<size_t>(self)
+                        : next_queue_.fetch_add(1) % queues_.size();
+  {
+    std::lock_guard<std::mutex> guard(queues_[id]->mutex);
+    queues_[id]->tasks.push_back(std::move(task));
+  }
+  {
+    // Publish under mutex_ so a worker about to sleep cannot miss the task.
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++pending_;
+  }
+  condition_.notify_one();
+}
+
+bool WorkStealingThreadPool::popLocal(
+    size_t id,
+    std::function<void()>& task) {
+  auto& queue = *queues_[id];
+  std::lock_guard<std::mutex> guard(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  --pending_;
+  return true;
 }
 
-ThreadPool global_work_queue;
+bool WorkStealingThreadPool::steal(size_t id, std::function<void()>& task) {
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    auto& queue = *queues_[(id + offset) % queues_.size()];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::mainLoop(size_t id) {
+  current_pool = this;
+  current_worker_id = static_cast<int>(id);
+  while (true) {
+    std::function<void()> task;
+    bool found = popLocal(id, task);
+    if (!found && steal(id, task)) {
+      found = true;
+      ++tasks_stolen_;
+    }
+    if (found) {
+      auto start = std::chrono::steady_clock::now();
+      try {
+        task();
+      } catch (const std::exception&) {
+      }
+      busy_nanoseconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+      ++tasks_run_;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return !running_ || pending_ > 0; });
+    if (!running_ && pending_ == 0) {
+      break;
+    }
+  }
+}
 
 } // namespace c10
@@ -1,29 +1,84 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
 #include <functional>
-#include <queue>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-#include <c10/util/intrusive_ptr.h>
+#include <c10/macros/Macros.h>
 
 namespace c10 {
 
-namespace ivalue {
-struct Future;
-} // namespace ivalue
+// A fixed-size pool of worker threads with one task deque per worker.
+//
+// Tasks submitted from inside a worker are pushed to (and popped from) the
+// back of that worker's own deque, so nested work stays on the core that
+// produced it. Tasks submitted from outside the pool are spread round-robin
+// over the workers. A worker whose deque runs dry steals from the front of
+// its siblings' deques before going to sleep.
+//
+// Tasks run with the trace context of the thread that submitted them (see
+// c10/util/TraceContext.h).
+//
+// Tasks must not throw; exceptions escaping a task are swallowed.
+class CAFFE2_API WorkStealingThreadPool final {
+ public:
+  explicit WorkStealingThreadPool(size_t num_threads);
 
-struct C10_API ThreadPool final {
-  ThreadPool();
+  ~WorkStealingThreadPool();
 
-  ~ThreadPool();
+  void run(std::function<void()> task);
 
-  void schedule(std::function<void(void)> task);
+  size_t size() const {
+    return threads_.size();
+  }
 
-  void workOnTasksUntilCompleted(c10::intrusive_ptr<ivalue::Future> future);
+  // Index of the calling thread within this pool, or -1 if the calling
+  // thread is not one of this pool's workers.
+  int currentWorkerId() const;
+
+  // Counters accumulated by the workers since the pool was created. Tasks
+  // that run() executes inline, on a pool without workers, are not counted.
+  struct Stats {
+    // Tasks the workers have executed, and how many of them were stolen
+    // from the deque of another worker.
+    uint64_t tasks_run;
+    uint64_t tasks_stolen;
+    // Total time the workers have spent executing tasks; dividing by the
+    // wall time and size() gives the utilization of the pool.
+    uint64_t busy_nanoseconds;
+  };
+
+  Stats stats() const;
 
  private:
-  std::queue<std::function<void(void)>> tasks;
-};
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool popLocal(size_t id, std::function<void()>& task);
+  bool steal(size_t id, std::function<void()>& task);
+  void mainLoop(size_t id);
 
-C10_API extern ThreadPool global_work_queue;
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  // Guards sleeping and waking; pending_ counts tasks sitting in any deque.
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::atomic<size_t> pending_;
+  std::atomic<size_t> next_queue_;
+  bool running_;
+
+  std::atomic<uint64_t> tasks_run_;
+  std::atomic<uint64_t> tasks_stolen_;
+  std::atomic<uint64_t> busy_nanoseconds_;
+};
 
 } // namespace c10
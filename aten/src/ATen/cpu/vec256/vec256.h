@@ -6,6 +6,8 @@
 #include "vec256_float.h"
 #include "vec256_double.h"
 #include "vec256_int.h"
+#include "vec256_half.h"
+#include "vec256_bfloat16.h"
 
 #include <algorithm>
 #include <cstddef>
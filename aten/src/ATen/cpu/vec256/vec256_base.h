@@ -122,6 +122,17 @@ public:
   T& operator[](int idx) {
     return values[idx];
   }
+  // Returns an integer mask where all zero elements are translated to 1-bit
+  // and others are translated to 0-bit
+  int zero_mask() const {
+    int mask = 0;
+    for (int i = 0; i < size; ++i) {
+      if (values[i] == static_cast<T>(0)) {
+        mask |= (1 << i);
+      }
+    }
+    return mask;
+  }
   Vec256<T> map(T (*f)(T)) const {
     Vec256<T> ret;
     for (int64_t i = 0; i != size; i++) {
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#include "vec256_float.h"
+#include "vec256_half.h"
+
+#include <c10/BFloat16.h>
+
+// Conversions between BFloat16 and float, 8 values at a time. A BFloat16 is
+// the upper half of a float, so loads only widen and shift; stores round to
+// nearest even as c10::BFloat16 does, with AVX2 integer ops when available.
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// Vec256<float>::size BFloat16 values starting at ptr, as floats
+inline Vec256<float> load_bfloat16_as_float(const BFloat16* ptr) {
+#if defined(__AVX2__) && !defined(_MSC_VER)
+  __m256i bits = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16));
+#else
+  float buffer[Vec256<float>::size];
+  for (int i = 0; i < Vec256<float>::size; i++) {
+    buffer[i] = static_cast<float>(ptr[i]);
+  }
+  return Vec256<float>::loadu(buffer);
+#endif
+}
+
+// Stores the Vec256<float>::size floats of v as BFloat16 values, rounding to
+// nearest even
+inline void store_float_as_bfloat16(const Vec256<float>& v, BFloat16* ptr) {
+#if defined(__AVX2__) && !defined(_MSC_VER)
+  __m256 values = v;
+  __m256i bits = _mm256_castps_si256(values);
+  __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+  __m256i rounded = _mm256_srli_epi32(
+      _mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7FFF))), 16);
+  // NaNs stay quiet NaNs instead of rounding to an infinity
+  __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(values, values, _CMP_UNORD_Q));
+  rounded = _mm256_blendv_epi8(rounded, _mm256_set1_epi32(0x7FC0), nan);
+  // packs each 128-bit lane, then gathers the two packed halves
+  __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rounded, rounded), 0xD8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), _mm256_castsi256_si128(packed));
+#else
+  float buffer[Vec256<float>::size];
+  v.store(buffer);
+  for (int i = 0; i < Vec256<float>::size; i++) {
+    ptr[i] = static_cast<BFloat16>(buffer[i]);
+  }
+#endif
+}
+
+// Loads and stores of the 16-bit floating types, for the kernels that are
+// written once for both
+inline Vec256<float> load_as_float(const Half* ptr) {
+  return load_half_as_float(ptr);
+}
+
+inline Vec256<float> load_as_float(const BFloat16* ptr) {
+  return load_bfloat16_as_float(ptr);
+}
+
+inline void store_float_as(const Vec256<float>& v, Half* ptr) {
+  store_float_as_half(v, ptr);
+}
+
+inline void store_float_as(const Vec256<float>& v, BFloat16* ptr) {
+  store_float_as_bfloat16(v, ptr);
+}
+
+template <>
+void convert(const BFloat16* src, float* dst, int64_t n) {
+  int64_t i = 0;
+  for (; i <= n - Vec256<float>::size; i += Vec256<float>::size) {
+    load_bfloat16_as_float(src + i).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+template <>
+void convert(const float* src, BFloat16* dst, int64_t n) {
+  int64_t i = 0;
+  for (; i <= n - Vec256<float>::size; i += Vec256<float>::size) {
+    store_float_as_bfloat16(Vec256<float>::loadu(src + i), dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] = static_cast<BFloat16>(src[i]);
+  }
+}
+
+}}}
@@ -83,6 +83,11 @@ public:
   }
   const float& operator[](int idx) const  = delete;
   float& operator[](int idx) = delete;
+  int zero_mask() const {
+    // returns an integer mask where all zero elements are translated to 1-bit and others are translated to 0-bit
+    __m256 cmp = _mm256_cmp_ps(values, _mm256_set1_ps(0.0f), _CMP_EQ_OQ);
+    return _mm256_movemask_ps(cmp);
+  }
   Vec256<float> map(float (*f)(float)) const {
     __at_align32__ float tmp[8];
     store(tmp);
@@ -246,6 +251,39 @@ Vec256<float> inline operator^(const Vec256<float>& a, const Vec256<float>& b) {
   return _mm256_xor_ps(a, b);
 }
 
+template <>
+void convert(const float *src, double *dst, int64_t n) {
+  int64_t i;
+  // float has half the size of double
+  constexpr int64_t half_size = Vec256<float>::size / 2;
+#pragma unroll
+  for (i = 0; i <= (n - half_size); i += half_size) {
+    auto input_128_vec = _mm_loadu_ps(src + i);
+    auto output_vec = _mm256_cvtps_pd(input_128_vec);
+    _mm256_storeu_pd(dst + i, output_vec);
+  }
+#pragma unroll
+  for (; i < n; i++) {
+    dst[i] = static_cast<double>(src[i]);
+  }
+}
+
+template <>
+void convert(const float *src, int32_t *dst, int64_t n) {
+  int64_t i;
+  // truncates towards zero like static_cast
+#pragma unroll
+  for (i = 0; i <= (n - Vec256<float>::size); i += Vec256<float>::size) {
+    auto input_vec = _mm256_loadu_ps(src + i);
+    auto output_vec = _mm256_cvttps_epi32(input_vec);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), output_vec);
+  }
+#pragma unroll
+  for (; i < n; i++) {
+    dst[i] = static_cast<int32_t>(src[i]);
+  }
+}
+
 #ifdef __AVX2__
 template <>
 Vec256<float> inline fmadd(const Vec256<float>& a, const Vec256<float>& b, const Vec256<float>& c) {
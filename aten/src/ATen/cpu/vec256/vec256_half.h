@@ -0,0 +1,94 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#include "vec256_float.h"
+
+#include <c10/Half.h>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Conversions between Half and float, 8 values at a time: with F16C on x86
+// (the AVX2 and AVX512 kernels are compiled for it), NEON on aarch64, and
+// c10::Half's bit manipulation otherwise. Half tensors are stored as Half and
+// computed on as float vectors, see load_half_as_float.
+
+// Like Vec256<float>, the F16C path is not built with MSVC.
+#if defined(__F16C__) && defined(__AVX__) && !defined(_MSC_VER)
+#define AT_VEC256_F16C
+#endif
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// Vec256<float>::size Half values starting at ptr, as floats
+inline Vec256<float> load_half_as_float(const Half* ptr) {
+#if defined(AT_VEC256_F16C)
+  return _mm256_cvtph_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  float buffer[Vec256<float>::size];
+  for (int i = 0; i < Vec256<float>::size; i += 4) {
+    vst1q_f32(
+        buffer + i,
+        vcvt_f32_f16(vld1_f16(reinterpret_cast<const __fp16*>(ptr + i))));
+  }
+  return Vec256<float>::loadu(buffer);
+#else
+  float buffer[Vec256<float>::size];
+  for (int i = 0; i < Vec256<float>::size; i++) {
+    buffer[i] = static_cast<float>(ptr[i]);
+  }
+  return Vec256<float>::loadu(buffer);
+#endif
+}
+
+// Stores the Vec256<float>::size floats of v as Half values, rounding to
+// nearest even
+inline void store_float_as_half(const Vec256<float>& v, Half* ptr) {
+#if defined(AT_VEC256_F16C)
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(ptr),
+      _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  float buffer[Vec256<float>::size];
+  v.store(buffer);
+  for (int i = 0; i < Vec256<float>::size; i += 4) {
+    vst1_f16(
+        reinterpret_cast<__fp16*>(ptr + i), vcvt_f16_f32(vld1q_f32(buffer + i)));
+  }
+#else
+  float buffer[Vec256<float>::size];
+  v.store(buffer);
+  for (int i = 0; i < Vec256<float>::size; i++) {
+    ptr[i] = static_cast<Half>(buffer[i]);
+  }
+#endif
+}
+
+template <>
+void convert(const Half* src, float* dst, int64_t n) {
+  int64_t i = 0;
+  for (; i <= n - Vec256<float>::size; i += Vec256<float>::size) {
+    load_half_as_float(src + i).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+template <>
+void convert(const float* src, Half* dst, int64_t n) {
+  int64_t i = 0;
+  for (; i <= n - Vec256<float>::size; i += Vec256<float>::size) {
+    store_float_as_half(Vec256<float>::loadu(src + i), dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] = static_cast<Half>(src[i]);
+  }
+}
+
+}}}
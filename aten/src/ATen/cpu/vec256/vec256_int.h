@@ -240,6 +240,37 @@ void convert(const int32_t *src, double *dst, int64_t n) {
   }
 }
 
+// Byte tensors, e.g. images, are widened 8 elements at a time
+template <>
+void convert(const uint8_t *src, float *dst, int64_t n) {
+  int64_t i;
+#pragma unroll
+  for (i = 0; i <= (n - Vec256<float>::size); i += Vec256<float>::size) {
+    auto input_64_vec = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    auto output_vec = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(input_64_vec));
+    _mm256_storeu_ps(dst + i, output_vec);
+  }
+#pragma unroll
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+template <>
+void convert(const int8_t *src, float *dst, int64_t n) {
+  int64_t i;
+#pragma unroll
+  for (i = 0; i <= (n - Vec256<float>::size); i += Vec256<float>::size) {
+    auto input_64_vec = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    auto output_vec = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(input_64_vec));
+    _mm256_storeu_ps(dst + i, output_vec);
+  }
+#pragma unroll
+  for (; i < n; i++) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
 template <>
 struct Vec256<int16_t> : public Vec256i {
   static constexpr int size = 16;
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <cmath>
+#include <type_traits>
+
+#include "ATen/Utils.h"
+#include "ATen/cpu/vec256/vec256_base.h"
+
+#if defined(__GNUC__)
+#define __at_align64__ __attribute__((aligned(64)))
+#elif defined(_WIN32)
+#define __at_align64__ __declspec(align(64))
+#else
+#define __at_align64__
+#endif
+
+// Vec512<T> is the 512-bit counterpart of Vec256<T> (see
+// ATen/cpu/vec256/vec256_base.h) and offers the same interface, so kernels
+// can be written against either width. It is backed by AVX-512 registers when
+// compiled with -mavx512f (CPU_CAPABILITY=AVX512) and emulated otherwise.
+
+namespace at {
+namespace vec512 {
+namespace {
+
+using vec256::int_same_size_t;
+
+// NOTE: If you specialize on a type, you must define all operations!
+
+// emulates vectorized types
+template <class T>
+struct Vec512 {
+private:
+  T values[64 / sizeof(T)] = {0};
+public:
+  static constexpr int size = 64 / sizeof(T);
+  Vec512() {}
+  Vec512(T val) {
+    for (int i = 0; i != size; i++) {
+      values[i] = val;
+    }
+  }
+  template <int64_t mask_>
+  static Vec512<T> blend(const Vec512<T>& a, const Vec512<T>& b) {
+    int64_t mask = mask_;
+    Vec512 vec;
+    for (int64_t i = 0; i < size; i++) {
+      if (mask & 0x01) {
+        vec[i] = b[i];
+      } else {
+        vec[i] = a[i];
+      }
+      mask = mask >> 1;
+    }
+    return vec;
+  }
+  static Vec512<T> blendv(const Vec512<T>& a, const Vec512<T>& b,
+                          const Vec512<T>& mask) {
+    Vec512 vec;
+    int_same_size_t<T> buffer[size];
+    mask.store(buffer);
+    for (int64_t i = 0; i < size; i++) {
+      if (buffer[i] & 0x01) {
+        vec[i] = b[i];
+      } else {
+        vec[i] = a[i];
+      }
+    }
+    return vec;
+  }
+  static Vec512<T> arange(T base = static_cast<T>(0), T step = static_cast<T>(1)) {
+    Vec512 vec;
+    for (int64_t i = 0; i < size; i++) {
+      vec.values[i] = base + i * step;
+    }
+    return vec;
+  }
+  static Vec512<T> set(const Vec512<T>& a, const Vec512<T>& b, int64_t count = size) {
+    Vec512 vec;
+    for (int64_t i = 0; i < size; i++) {
+      if (i < count) {
+        vec[i] = b[i];
+      } else {
+        vec[i] = a[i];
+      }
+    }
+    return vec;
+  }
+  static Vec512<T> loadu(const void* ptr) {
+    Vec512 vec;
+    std::memcpy(vec.values, ptr, 64);
+    return vec;
+  }
+  static Vec512<T> loadu(const void* ptr, int64_t count) {
+    Vec512 vec;
+    std::memcpy(vec.values, ptr, count * sizeof(T));
+    return vec;
+  }
+  void store(void* ptr, int count = size) const {
+    std::memcpy(ptr, values, count * sizeof(T));
+  }
+  const T& operator[](int idx) const {
+    return values[idx];
+  }
+  T& operator[](int idx) {
+    return values[idx];
+  }
+  Vec512<T> map(T (*f)(T)) const {
+    Vec512<T> ret;
+    for (int64_t i = 0; i != size; i++) {
+      ret[i] = f(values[i]);
+    }
+    return ret;
+  }
+  Vec512<T> abs() const {
+    Vec512<T> ret;
+    for (int64_t i = 0; i < size; i++) {
+      ret[i] = values[i] < 0 ? -values[i] : values[i];
+    }
+    return ret;
+  }
+  Vec512<T> acos() const {
+    return map(std::acos);
+  }
+  Vec512<T> asin() const {
+    return map(std::asin);
+  }
+  Vec512<T> atan() const {
+    return map(std::atan);
+  }
+  Vec512<T> erf() const {
+    return map(std::erf);
+  }
+  Vec512<T> erfc() const {
+    return map(std::erfc);
+  }
+  Vec512<T> exp() const {
+    return map(std::exp);
+  }
+  Vec512<T> expm1() const {
+    return map(std::expm1);
+  }
+  Vec512<T> log() const {
+    return map(std::log);
+  }
+  Vec512<T> log10() const {
+    return map(std::log10);
+  }
+  Vec512<T> log1p() const {
+    return map(std::log1p);
+  }
+  Vec512<T> log2() const {
+    return map(std::log2);
+  }
+  Vec512<T> ceil() const {
+    return map(std::ceil);
+  }
+  Vec512<T> cos() const {
+    return map(std::cos);
+  }
+  Vec512<T> cosh() const {
+    return map(std::cosh);
+  }
+  Vec512<T> floor() const {
+    return map(std::floor);
+  }
+  Vec512<T> neg() const {
+    return map([](T x) { return -x; });
+  }
+  Vec512<T> round() const {
+    return map(std::round);
+  }
+  Vec512<T> sin() const {
+    return map(std::sin);
+  }
+  Vec512<T> sinh() const {
+    return map(std::sinh);
+  }
+  Vec512<T> tan() const {
+    return map(std::tan);
+  }
+  Vec512<T> tanh() const {
+    return map(std::tanh);
+  }
+  Vec512<T> trunc() const {
+    return map(std::trunc);
+  }
+  Vec512<T> sqrt() const {
+    return map(std::sqrt);
+  }
+  Vec512<T> reciprocal() const {
+    return map([](T x) { return (T)(1) / x; });
+  }
+  Vec512<T> rsqrt() const {
+    return map([](T x) { return 1 / std::sqrt(x); });
+  }
+  Vec512<T> pow(const Vec512<T> &exp) const {
+    Vec512<T> ret;
+    for (int64_t i = 0; i < size; i++) {
+      ret[i] = std::pow(values[i], exp[i]);
+    }
+    return ret;
+  }
+#define DEFINE_COMP(binary_pred)                                              \
+  Vec512<T> operator binary_pred(const Vec512<T> &other) const {              \
+    Vec512<T> vec;                                                            \
+    for (int64_t i = 0; i != size; i++) {                                     \
+      if (values[i] binary_pred other.values[i]) {                            \
+        std::memset(static_cast<void*>(vec.values + i), 0xFF, sizeof(T));     \
+      } else {                                                                \
+        std::memset(static_cast<void*>(vec.values + i), 0, sizeof(T));        \
+      }                                                                       \
+    }                                                                         \
+    return vec;                                                               \
+  }
+  DEFINE_COMP(==)
+  DEFINE_COMP(!=)
+  DEFINE_COMP(>=)
+  DEFINE_COMP(<=)
+  DEFINE_COMP(>)
+  DEFINE_COMP(<)
+#undef DEFINE_COMP
+};
+
+#define DEFINE_ARITH_OP(op)                                                 \
+template <class T>                                                          \
+Vec512<T> inline operator op(const Vec512<T> &a, const Vec512<T> &b) {      \
+  Vec512<T> c = Vec512<T>();                                                \
+  for (int i = 0; i != Vec512<T>::size; i++) {                              \
+    c[i] = a[i] op b[i];                                                    \
+  }                                                                         \
+  return c;                                                                 \
+}
+DEFINE_ARITH_OP(+)
+DEFINE_ARITH_OP(-)
+DEFINE_ARITH_OP(*)
+#undef DEFINE_ARITH_OP
+
+template <class T> Vec512<T> inline operator/(const Vec512<T> &a, const Vec512<T> &b) __ubsan_ignore_float_divide_by_zero__ {
+  Vec512<T> c = Vec512<T>();
+  for (int i = 0; i != Vec512<T>::size; i++) {
+    c[i] = a[i] / b[i];
+  }
+  return c;
+}
+
+template <class T> Vec512<T> inline max(const Vec512<T> &a, const Vec512<T> &b) {
+  Vec512<T> c = Vec512<T>();
+  for (int i = 0; i != Vec512<T>::size; i++) {
+    c[i] = std::max(a[i], b[i]);
+  }
+  return c;
+}
+
+template <class T> Vec512<T> inline min(const Vec512<T> &a, const Vec512<T> &b) {
+  Vec512<T> c = Vec512<T>();
+  for (int i = 0; i != Vec512<T>::size; i++) {
+    c[i] = std::min(a[i], b[i]);
+  }
+  return c;
+}
+
+#define DEFINE_BITWISE_OP(op)                                               \
+template <class T>                                                          \
+Vec512<T> inline operator op(const Vec512<T> &a, const Vec512<T> &b) {      \
+  using iT = int_same_size_t<T>;                                            \
+  iT buffer[Vec512<T>::size];                                               \
+  for (int64_t i = 0; i != Vec512<T>::size; i++) {                          \
+    auto a_val = a[i];                                                      \
+    auto b_val = b[i];                                                      \
+    iT *i_a_ptr = reinterpret_cast<iT*>(&a_val);                            \
+    iT *i_b_ptr = reinterpret_cast<iT*>(&b_val);                            \
+    buffer[i] = *i_a_ptr op *i_b_ptr;                                       \
+  }                                                                         \
+  return Vec512<T>::loadu(buffer);                                          \
+}
+DEFINE_BITWISE_OP(&)
+DEFINE_BITWISE_OP(|)
+DEFINE_BITWISE_OP(^)
+#undef DEFINE_BITWISE_OP
+
+template <typename T>
+inline Vec512<T> fmadd(const Vec512<T>& a, const Vec512<T>& b, const Vec512<T>& c) {
+  return a * b + c;
+}
+
+// Sum of all lanes.
+template <typename T>
+inline T reduce_add(const Vec512<T>& a) {
+  T result = 0;
+  for (int i = 0; i != Vec512<T>::size; i++) {
+    result += a[i];
+  }
+  return result;
+}
+
+}}}
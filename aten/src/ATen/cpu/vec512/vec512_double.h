@@ -0,0 +1,238 @@
+#pragma once
+
+#include "ATen/cpu/vec256/intrinsics.h"
+#include "vec512_base.h"
+
+namespace at {
+namespace vec512 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+template <> class Vec512<double> {
+private:
+  __m512d values;
+  static inline Vec512<double> from_mask(__mmask8 mask) {
+    return _mm512_castsi512_pd(_mm512_maskz_set1_epi64(mask, -1));
+  }
+public:
+  static constexpr int size = 8;
+  Vec512() {}
+  Vec512(__m512d v) : values(v) {}
+  Vec512(double val) {
+    values = _mm512_set1_pd(val);
+  }
+  operator __m512d() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec512<double> blend(const Vec512<double>& a, const Vec512<double>& b) {
+    return _mm512_mask_blend_pd(static_cast<__mmask8>(mask), a.values, b.values);
+  }
+  static Vec512<double> blendv(const Vec512<double>& a, const Vec512<double>& b,
+                               const Vec512<double>& mask) {
+    auto m = _mm512_castpd_si512(mask.values);
+    return _mm512_mask_blend_pd(_mm512_test_epi64_mask(m, m), a.values, b.values);
+  }
+  static Vec512<double> arange(double base = 0, double step = 1) {
+    __at_align64__ double tmp_values[size];
+    for (int i = 0; i < size; i++) {
+      tmp_values[i] = base + i * step;
+    }
+    return _mm512_load_pd(tmp_values);
+  }
+  static Vec512<double> set(const Vec512<double>& a, const Vec512<double>& b,
+                            int64_t count = size) {
+    __mmask8 mask = static_cast<__mmask8>((1ULL << count) - 1);
+    return _mm512_mask_blend_pd(mask, a.values, b.values);
+  }
+  static Vec512<double> loadu(const void* ptr, int64_t count = size) {
+    if (count == size)
+      return _mm512_loadu_pd(reinterpret_cast<const double*>(ptr));
+    __mmask8 mask = static_cast<__mmask8>((1ULL << count) - 1);
+    return _mm512_maskz_loadu_pd(mask, ptr);
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      _mm512_storeu_pd(reinterpret_cast<double*>(ptr), values);
+    } else if (count > 0) {
+      __mmask8 mask = static_cast<__mmask8>((1ULL << count) - 1);
+      _mm512_mask_storeu_pd(ptr, mask, values);
+    }
+  }
+  const double& operator[](int idx) const  = delete;
+  double& operator[](int idx) = delete;
+  Vec512<double> map(double (*f)(double)) const {
+    __at_align64__ double tmp[size];
+    _mm512_store_pd(tmp, values);
+    for (int64_t i = 0; i < size; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return _mm512_load_pd(tmp);
+  }
+  Vec512<double> abs() const {
+    auto mask = _mm512_set1_epi64(0x7fffffffffffffffLL);
+    return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(values), mask));
+  }
+  Vec512<double> acos() const {
+    return map(std::acos);
+  }
+  Vec512<double> asin() const {
+    return map(std::asin);
+  }
+  Vec512<double> atan() const {
+    return map(std::atan);
+  }
+  Vec512<double> erf() const {
+    return map(std::erf);
+  }
+  Vec512<double> erfc() const {
+    return map(std::erfc);
+  }
+  Vec512<double> exp() const {
+    return map(std::exp);
+  }
+  Vec512<double> expm1() const {
+    return map(std::expm1);
+  }
+  Vec512<double> log() const {
+    return map(std::log);
+  }
+  Vec512<double> log10() const {
+    return map(std::log10);
+  }
+  Vec512<double> log1p() const {
+    return map(std::log1p);
+  }
+  Vec512<double> log2() const {
+    return map(std::log2);
+  }
+  Vec512<double> cos() const {
+    return map(std::cos);
+  }
+  Vec512<double> cosh() const {
+    return map(std::cosh);
+  }
+  Vec512<double> sin() const {
+    return map(std::sin);
+  }
+  Vec512<double> sinh() const {
+    return map(std::sinh);
+  }
+  Vec512<double> tan() const {
+    return map(std::tan);
+  }
+  Vec512<double> tanh() const {
+    return map(std::tanh);
+  }
+  Vec512<double> ceil() const {
+    return _mm512_roundscale_pd(values, _MM_FROUND_TO_POS_INF);
+  }
+  Vec512<double> floor() const {
+    return _mm512_roundscale_pd(values, _MM_FROUND_TO_NEG_INF);
+  }
+  Vec512<double> round() const {
+    return _mm512_roundscale_pd(values, _MM_FROUND_TO_NEAREST_INT);
+  }
+  Vec512<double> trunc() const {
+    return _mm512_roundscale_pd(values, _MM_FROUND_TO_ZERO);
+  }
+  Vec512<double> neg() const {
+    auto mask = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL));
+    return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(values), mask));
+  }
+  Vec512<double> sqrt() const {
+    return _mm512_sqrt_pd(values);
+  }
+  Vec512<double> reciprocal() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), values);
+  }
+  Vec512<double> rsqrt() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), _mm512_sqrt_pd(values));
+  }
+  Vec512<double> pow(const Vec512<double> &b) const {
+    __at_align64__ double x_tmp[size];
+    __at_align64__ double y_tmp[size];
+    _mm512_store_pd(x_tmp, values);
+    _mm512_store_pd(y_tmp, b.values);
+    for (int64_t i = 0; i < size; i++) {
+      x_tmp[i] = std::pow(x_tmp[i], y_tmp[i]);
+    }
+    return _mm512_load_pd(x_tmp);
+  }
+  // Comparisons return a vector with all bits of the true lanes set, like
+  // Vec256, rather than an AVX-512 mask register.
+  Vec512<double> operator==(const Vec512<double>& other) const {
+    return from_mask(_mm512_cmp_pd_mask(values, other.values, _CMP_EQ_OQ));
+  }
+  Vec512<double> operator!=(const Vec512<double>& other) const {
+    return from_mask(_mm512_cmp_pd_mask(values, other.values, _CMP_NEQ_OQ));
+  }
+  Vec512<double> operator<(const Vec512<double>& other) const {
+    return from_mask(_mm512_cmp_pd_mask(values, other.values, _CMP_LT_OQ));
+  }
+  Vec512<double> operator<=(const Vec512<double>& other) const {
+    return from_mask(_mm512_cmp_pd_mask(values, other.values, _CMP_LE_OQ));
+  }
+  Vec512<double> operator>(const Vec512<double>& other) const {
+    return from_mask(_mm512_cmp_pd_mask(values, other.values, _CMP_GT_OQ));
+  }
+  Vec512<double> operator>=(const Vec512<double>& other) const {
+    return from_mask(_mm512_cmp_pd_mask(values, other.values, _CMP_GE_OQ));
+  }
+};
+
+template <>
+Vec512<double> inline operator+(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_add_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator-(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_sub_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator*(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_mul_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator/(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_div_pd(a, b);
+}
+
+template <>
+Vec512<double> inline max(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_max_pd(a, b);
+}
+
+template <>
+Vec512<double> inline min(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_min_pd(a, b);
+}
+
+#define DEFINE_BITWISE_OP(op, intrinsic)                                          \
+template <>                                                                       \
+Vec512<double> inline operator op(const Vec512<double>& a, const Vec512<double>& b) {  \
+  return _mm512_castsi512_pd(                                                    \
+      intrinsic(_mm512_castpd_si512(a), _mm512_castpd_si512(b)));              \
+}
+DEFINE_BITWISE_OP(&, _mm512_and_si512)
+DEFINE_BITWISE_OP(|, _mm512_or_si512)
+DEFINE_BITWISE_OP(^, _mm512_xor_si512)
+#undef DEFINE_BITWISE_OP
+
+template <>
+Vec512<double> inline fmadd(const Vec512<double>& a, const Vec512<double>& b, const Vec512<double>& c) {
+  return _mm512_fmadd_pd(a, b, c);
+}
+
+template <>
+double inline reduce_add(const Vec512<double>& a) {
+  return _mm512_reduce_add_pd(a);
+}
+
+#endif
+
+}}}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "ATen/cpu/vec256/intrinsics.h"
+#include "vec512_base.h"
+
+namespace at {
+namespace vec512 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+template <> class Vec512<float> {
+private:
+  __m512 values;
+  static inline Vec512<float> from_mask(__mmask16 mask) {
+    return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(mask, -1));
+  }
+public:
+  static constexpr int size = 16;
+  Vec512() {}
+  Vec512(__m512 v) : values(v) {}
+  Vec512(float val) {
+    values = _mm512_set1_ps(val);
+  }
+  operator __m512() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec512<float> blend(const Vec512<float>& a, const Vec512<float>& b) {
+    return _mm512_mask_blend_ps(static_cast<__mmask16>(mask), a.values, b.values);
+  }
+  static Vec512<float> blendv(const Vec512<float>& a, const Vec512<float>& b,
+                               const Vec512<float>& mask) {
+    auto m = _mm512_castps_si512(mask.values);
+    return _mm512_mask_blend_ps(_mm512_test_epi32_mask(m, m), a.values, b.values);
+  }
+  static Vec512<float> arange(float base = 0, float step = 1) {
+    __at_align64__ float tmp_values[size];
+    for (int i = 0; i < size; i++) {
+      tmp_values[i] = base + i * step;
+    }
+    return _mm512_load_ps(tmp_values);
+  }
+  static Vec512<float> set(const Vec512<float>& a, const Vec512<float>& b,
+                            int64_t count = size) {
+    __mmask16 mask = static_cast<__mmask16>((1ULL << count) - 1);
+    return _mm512_mask_blend_ps(mask, a.values, b.values);
+  }
+  static Vec512<float> loadu(const void* ptr, int64_t count = size) {
+    if (count == size)
+      return _mm512_loadu_ps(reinterpret_cast<const float*>(ptr));
+    __mmask16 mask = static_cast<__mmask16>((1ULL << count) - 1);
+    return _mm512_maskz_loadu_ps(mask, ptr);
+  }
+  void store(void* ptr, int64_t count = size) const {
+    if (count == size) {
+      _mm512_storeu_ps(reinterpret_cast<float*>(ptr), values);
+    } else if (count > 0) {
+      __mmask16 mask = static_cast<__mmask16>((1ULL << count) - 1);
+      _mm512_mask_storeu_ps(ptr, mask, values);
+    }
+  }
+  const float& operator[](int idx) const  = delete;
+  float& operator[](int idx) = delete;
+  Vec512<float> map(float (*f)(float)) const {
+    __at_align64__ float tmp[size];
+    _mm512_store_ps(tmp, values);
+    for (int64_t i = 0; i < size; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return _mm512_load_ps(tmp);
+  }
+  Vec512<float> abs() const {
+    auto mask = _mm512_set1_epi32(0x7fffffff);
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(values), mask));
+  }
+  Vec512<float> acos() const {
+    return map(std::acos);
+  }
+  Vec512<float> asin() const {
+    return map(std::asin);
+  }
+  Vec512<float> atan() const {
+    return map(std::atan);
+  }
+  Vec512<float> erf() const {
+    return map(std::erf);
+  }
+  Vec512<float> erfc() const {
+    return map(std::erfc);
+  }
+  Vec512<float> exp() const {
+    return map(std::exp);
+  }
+  Vec512<float> expm1() const {
+    return map(std::expm1);
+  }
+  Vec512<float> log() const {
+    return map(std::log);
+  }
+  Vec512<float> log10() const {
+    return map(std::log10);
+  }
+  Vec512<float> log1p() const {
+    return map(std::log1p);
+  }
+  Vec512<float> log2() const {
+    return map(std::log2);
+  }
+  Vec512<float> cos() const {
+    return map(std::cos);
+  }
+  Vec512<float> cosh() const {
+    return map(std::cosh);
+  }
+  Vec512<float> sin() const {
+    return map(std::sin);
+  }
+  Vec512<float> sinh() const {
+    return map(std::sinh);
+  }
+  Vec512<float> tan() const {
+    return map(std::tan);
+  }
+  Vec512<float> tanh() const {
+    return map(std::tanh);
+  }
+  Vec512<float> ceil() const {
+    return _mm512_roundscale_ps(values, _MM_FROUND_TO_POS_INF);
+  }
+  Vec512<float> floor() const {
+    return _mm512_roundscale_ps(values, _MM_FROUND_TO_NEG_INF);
+  }
+  Vec512<float> round() const {
+    return _mm512_roundscale_ps(values, _MM_FROUND_TO_NEAREST_INT);
+  }
+  Vec512<float> trunc() const {
+    return _mm512_roundscale_ps(values, _MM_FROUND_TO_ZERO);
+  }
+  Vec512<float> neg() const {
+    auto mask = _mm512_set1_epi32(static_cast<int>(0x80000000));
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(values), mask));
+  }
+  Vec512<float> sqrt() const {
+    return _mm512_sqrt_ps(values);
+  }
+  Vec512<float> reciprocal() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), values);
+  }
+  Vec512<float> rsqrt() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), _mm512_sqrt_ps(values));
+  }
+  Vec512<float> pow(const Vec512<float> &b) const {
+    __at_align64__ float x_tmp[size];
+    __at_align64__ float y_tmp[size];
+    _mm512_store_ps(x_tmp, values);
+    _mm512_store_ps(y_tmp, b.values);
+    for (int64_t i = 0; i < size; i++) {
+      x_tmp[i] = std::pow(x_tmp[i], y_tmp[i]);
+    }
+    return _mm512_load_ps(x_tmp);
+  }
+  // Comparisons return a vector with all bits of the true lanes set, like
+  // Vec256, rather than an AVX-512 mask register.
+  Vec512<float> operator==(const Vec512<float>& other) const {
+    return from_mask(_mm512_cmp_ps_mask(values, other.values, _CMP_EQ_OQ));
+  }
+  Vec512<float> operator!=(const Vec512<float>& other) const {
+    return from_mask(_mm512_cmp_ps_mask(values, other.values, _CMP_NEQ_OQ));
+  }
+  Vec512<float> operator<(const Vec512<float>& other) const {
+    return from_mask(_mm512_cmp_ps_mask(values, other.values, _CMP_LT_OQ));
+  }
+  Vec512<float> operator<=(const Vec512<float>& other) const {
+    return from_mask(_mm512_cmp_ps_mask(values, other.values, _CMP_LE_OQ));
+  }
+  Vec512<float> operator>(const Vec512<float>& other) const {
+    return from_mask(_mm512_cmp_ps_mask(values, other.values, _CMP_GT_OQ));
+  }
+  Vec512<float> operator>=(const Vec512<float>& other) const {
+    return from_mask(_mm512_cmp_ps_mask(values, other.values, _CMP_GE_OQ));
+  }
+};
+
+template <>
+Vec512<float> inline operator+(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_add_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator-(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_sub_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator*(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_mul_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator/(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_div_ps(a, b);
+}
+
+template <>
+Vec512<float> inline max(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_max_ps(a, b);
+}
+
+template <>
+Vec512<float> inline min(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_min_ps(a, b);
+}
+
+#define DEFINE_BITWISE_OP(op, intrinsic)                                          \
+template <>                                                                       \
+Vec512<float> inline operator op(const Vec512<float>& a, const Vec512<float>& b) {  \
+  return _mm512_castsi512_ps(                                                    \
+      intrinsic(_mm512_castps_si512(a), _mm512_castps_si512(b)));              \
+}
+DEFINE_BITWISE_OP(&, _mm512_and_si512)
+DEFINE_BITWISE_OP(|, _mm512_or_si512)
+DEFINE_BITWISE_OP(^, _mm512_xor_si512)
+#undef DEFINE_BITWISE_OP
+
+template <>
+Vec512<float> inline fmadd(const Vec512<float>& a, const Vec512<float>& b, const Vec512<float>& c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+
+template <>
+float inline reduce_add(const Vec512<float>& a) {
+  return _mm512_reduce_add_ps(a);
+}
+
+#endif
+
+}}}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include "ATen/cpu/vec256/intrinsics.h"
+#include "vec512_base.h"
+
+namespace at {
+namespace vec512 {
+namespace {
+
+#if defined(__AVX512F__) && !defined(_MSC_VER)
+
+struct Vec512i {
+protected:
+  __m512i values;
+public:
+  Vec512i() {}
+  Vec512i(__m512i v) : values(v) {}
+  operator __m512i() const {
+    return values;
+  }
+};
+
+template <>
+struct Vec512<int64_t> : public Vec512i {
+private:
+  static inline Vec512<int64_t> from_mask(__mmask8 mask) {
+    return _mm512_maskz_set1_epi64(mask, -1);
+  }
+public:
+  static constexpr int size = 8;
+  using Vec512i::Vec512i;
+  Vec512() {}
+  Vec512(int64_t v) { values = _mm512_set1_epi64(v); }
+  template <int64_t mask>
+  static Vec512<int64_t> blend(Vec512<int64_t> a, Vec512<int64_t> b) {
+    return _mm512_mask_blend_epi64(static_cast<__mmask8>(mask), a.values, b.values);
+  }
+  static Vec512<int64_t> blendv(const Vec512<int64_t>& a, const Vec512<int64_t>& b,
+                              const Vec512<int64_t>& mask) {
+    return _mm512_mask_blend_epi64(
+        _mm512_test_epi64_mask(mask.values, mask.values), a.values, b.values);
+  }
+  static Vec512<int64_t> arange(int64_t base = 0, int64_t step = 1) {
+    __at_align64__ int64_t tmp_values[size];
+    for (int i = 0; i < size; i++) {
+      tmp_values[i] = base + i * step;
+    }
+    return _mm512_load_si512(tmp_values);
+  }
+  static Vec512<int64_t> set(Vec512<int64_t> a, Vec512<int64_t> b, int64_t count = size) {
+    __mmask8 mask = static_cast<__mmask8>((1ULL << count) - 1);
+    return _mm512_mask_blend_epi64(mask, a.values, b.values);
+  }
+  static Vec512<int64_t> loadu(const void* ptr) {
+    return _mm512_loadu_si512(ptr);
+  }
+  static Vec512<int64_t> loadu(const void* ptr, int64_t count) {
+    __mmask8 mask = static_cast<__mmask8>((1ULL << count) - 1);
+    return _mm512_maskz_loadu_epi64(mask, ptr);
+  }
+  void store(void* ptr, int count = size) const {
+    if (count == size) {
+      _mm512_storeu_si512(ptr, values);
+    } else if (count > 0) {
+      __mmask8 mask = static_cast<__mmask8>((1ULL << count) - 1);
+      _mm512_mask_storeu_epi64(ptr, mask, values);
+    }
+  }
+  const int64_t& operator[](int idx) const  = delete;
+  int64_t& operator[](int idx)  = delete;
+  Vec512<int64_t> abs() const {
+    return _mm512_abs_epi64(values);
+  }
+  Vec512<int64_t> neg() const {
+    return _mm512_sub_epi64(_mm512_setzero_si512(), values);
+  }
+  Vec512<int64_t> operator==(const Vec512<int64_t>& other) const {
+    return from_mask(_mm512_cmpeq_epi64_mask(values, other.values));
+  }
+  Vec512<int64_t> operator!=(const Vec512<int64_t>& other) const {
+    return from_mask(_mm512_cmpneq_epi64_mask(values, other.values));
+  }
+  Vec512<int64_t> operator<(const Vec512<int64_t>& other) const {
+    return from_mask(_mm512_cmplt_epi64_mask(values, other.values));
+  }
+  Vec512<int64_t> operator<=(const Vec512<int64_t>& other) const {
+    return from_mask(_mm512_cmple_epi64_mask(values, other.values));
+  }
+  Vec512<int64_t> operator>(const Vec512<int64_t>& other) const {
+    return from_mask(_mm512_cmpgt_epi64_mask(values, other.values));
+  }
+  Vec512<int64_t> operator>=(const Vec512<int64_t>& other) const {
+    return from_mask(_mm512_cmpge_epi64_mask(values, other.values));
+  }
+};
+
+template <>
+Vec512<int64_t> inline operator+(const Vec512<int64_t>& a, const Vec512<int64_t>& b) {
+  return _mm512_add_epi64(a, b);
+}
+
+template <>
+Vec512<int64_t> inline operator-(const Vec512<int64_t>& a, const Vec512<int64_t>& b) {
+  return _mm512_sub_epi64(a, b);
+}
+
+template <>
+Vec512<int64_t> inline max(const Vec512<int64_t>& a, const Vec512<int64_t>& b) {
+  return _mm512_max_epi64(a, b);
+}
+
+template <>
+Vec512<int64_t> inline min(const Vec512<int64_t>& a, const Vec512<int64_t>& b) {
+  return _mm512_min_epi64(a, b);
+}
+
+template <>
+int64_t inline reduce_add(const Vec512<int64_t>& a) {
+  return _mm512_reduce_add_epi64(a);
+}
+
+template <>
+struct Vec512<int32_t> : public Vec512i {
+private:
+  static inline Vec512<int32_t> from_mask(__mmask16 mask) {
+    return _mm512_maskz_set1_epi32(mask, -1);
+  }
+public:
+  static constexpr int size = 16;
+  using Vec512i::Vec512i;
+  Vec512() {}
+  Vec512(int32_t v) { values = _mm512_set1_epi32(v); }
+  template <int64_t mask>
+  static Vec512<int32_t> blend(Vec512<int32_t> a, Vec512<int32_t> b) {
+    return _mm512_mask_blend_epi32(static_cast<__mmask16>(mask), a.values, b.values);
+  }
+  static Vec512<int32_t> blendv(const Vec512<int32_t>& a, const Vec512<int32_t>& b,
+                              const Vec512<int32_t>& mask) {
+    return _mm512_mask_blend_epi32(
+        _mm512_test_epi32_mask(mask.values, mask.values), a.values, b.values);
+  }
+  static Vec512<int32_t> arange(int32_t base = 0, int32_t step = 1) {
+    __at_align64__ int32_t tmp_values[size];
+    for (int i = 0; i < size; i++) {
+      tmp_values[i] = base + i * step;
+    }
+    return _mm512_load_si512(tmp_values);
+  }
+  static Vec512<int32_t> set(Vec512<int32_t> a, Vec512<int32_t> b, int32_t count = size) {
+    __mmask16 mask = static_cast<__mmask16>((1ULL << count) - 1);
+    return _mm512_mask_blend_epi32(mask, a.values, b.values);
+  }
+  static Vec512<int32_t> loadu(const void* ptr) {
+    return _mm512_loadu_si512(ptr);
+  }
+  static Vec512<int32_t> loadu(const void* ptr, int32_t count) {
+    __mmask16 mask = static_cast<__mmask16>((1ULL << count) - 1);
+    return _mm512_maskz_loadu_epi32(mask, ptr);
+  }
+  void store(void* ptr, int count = size) const {
+    if (count == size) {
+      _mm512_storeu_si512(ptr, values);
+    } else if (count > 0) {
+      __mmask16 mask = static_cast<__mmask16>((1ULL << count) - 1);
+      _mm512_mask_storeu_epi32(ptr, mask, values);
+    }
+  }
+  const int32_t& operator[](int idx) const  = delete;
+  int32_t& operator[](int idx)  = delete;
+  Vec512<int32_t> abs() const {
+    return _mm512_abs_epi32(values);
+  }
+  Vec512<int32_t> neg() const {
+    return _mm512_sub_epi32(_mm512_setzero_si512(), values);
+  }
+  Vec512<int32_t> operator==(const Vec512<int32_t>& other) const {
+    return from_mask(_mm512_cmpeq_epi32_mask(values, other.values));
+  }
+  Vec512<int32_t> operator!=(const Vec512<int32_t>& other) const {
+    return from_mask(_mm512_cmpneq_epi32_mask(values, other.values));
+  }
+  Vec512<int32_t> operator<(const Vec512<int32_t>& other) const {
+    return from_mask(_mm512_cmplt_epi32_mask(values, other.values));
+  }
+  Vec512<int32_t> operator<=(const Vec512<int32_t>& other) const {
+    return from_mask(_mm512_cmple_epi32_mask(values, other.values));
+  }
+  Vec512<int32_t> operator>(const Vec512<int32_t>& other) const {
+    return from_mask(_mm512_cmpgt_epi32_mask(values, other.values));
+  }
+  Vec512<int32_t> operator>=(const Vec512<int32_t>& other) const {
+    return from_mask(_mm512_cmpge_epi32_mask(values, other.values));
+  }
+};
+
+template <>
+Vec512<int32_t> inline operator+(const Vec512<int32_t>& a, const Vec512<int32_t>& b) {
+  return _mm512_add_epi32(a, b);
+}
+
+template <>
+Vec512<int32_t> inline operator-(const Vec512<int32_t>& a, const Vec512<int32_t>& b) {
+  return _mm512_sub_epi32(a, b);
+}
+
+template <>
+Vec512<int32_t> inline max(const Vec512<int32_t>& a, const Vec512<int32_t>& b) {
+  return _mm512_max_epi32(a, b);
+}
+
+template <>
+Vec512<int32_t> inline min(const Vec512<int32_t>& a, const Vec512<int32_t>& b) {
+  return _mm512_min_epi32(a, b);
+}
+
+template <>
+int32_t inline reduce_add(const Vec512<int32_t>& a) {
+  return _mm512_reduce_add_epi32(a);
+}
+
+template <>
+Vec512<int32_t> inline operator*(const Vec512<int32_t>& a, const Vec512<int32_t>& b) {
+  return _mm512_mullo_epi32(a, b);
+}
+
+#if defined(__AVX512DQ__)
+template <>
+Vec512<int64_t> inline operator*(const Vec512<int64_t>& a, const Vec512<int64_t>& b) {
+  return _mm512_mullo_epi64(a, b);
+}
+#else
+template <>
+Vec512<int64_t> inline operator*(const Vec512<int64_t>& a, const Vec512<int64_t>& b) {
+  __at_align64__ int64_t a_values[Vec512<int64_t>::size];
+  __at_align64__ int64_t b_values[Vec512<int64_t>::size];
+  a.store(a_values);
+  b.store(b_values);
+  for (int i = 0; i < Vec512<int64_t>::size; i++) {
+    a_values[i] *= b_values[i];
+  }
+  return Vec512<int64_t>::loadu(a_values);
+}
+#endif
+
+#define DEFINE_INTEGER_BINARY_OP(op, func)                                                \
+template <>                                                                               \
+Vec512<int64_t> inline operator op(const Vec512<int64_t>& a, const Vec512<int64_t>& b) { \
+  return func(a, b);                                                                      \
+}                                                                                         \
+template <>                                                                               \
+Vec512<int32_t> inline operator op(const Vec512<int32_t>& a, const Vec512<int32_t>& b) { \
+  return func(a, b);                                                                      \
+}
+
+DEFINE_INTEGER_BINARY_OP(&, _mm512_and_si512)
+DEFINE_INTEGER_BINARY_OP(|, _mm512_or_si512)
+DEFINE_INTEGER_BINARY_OP(^, _mm512_xor_si512)
+
+#undef DEFINE_INTEGER_BINARY_OP
+
+#endif
+
+}}}
@@ -1,4 +1,5 @@
 #include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/detail/DeviceStreamHandlePool.h"
 #include "THC/THCGeneral.hpp"
 
 namespace at { namespace cuda {
@@ -25,8 +26,37 @@ cusparseHandle_t getCurrentCUDASparseHandle() {
   return THCState_getCurrentSparseHandle(at::globalContext().getTHCState());
 }
 
+namespace {
+
+cublasHandle_t createBlasHandle(cudaStream_t stream) {
+  cublasHandle_t handle;
+  THCublasCheck(cublasCreate(&handle));
+  THCublasCheck(cublasSetStream(handle, stream));
+  return handle;
+}
+
+void destroyBlasHandle(cublasHandle_t handle) {
+  cublasDestroy(handle);
+}
+
+detail::DeviceStreamHandlePool<cublasHandle_t>& blasHandlePool() {
+  static auto* pool = new detail::DeviceStreamHandlePool<cublasHandle_t>(
+      createBlasHandle, destroyBlasHandle);
+  return *pool;
+}
+
+} // namespace
+
 cublasHandle_t getCurrentCUDABlasHandle() {
-  return THCState_getCurrentBlasHandle(at::globalContext().getTHCState());
+  return getCUDABlasHandle(c10::cuda::current_device(), getCurrentCUDAStream().stream());
+}
+
+cublasHandle_t getCUDABlasHandle(DeviceIndex device, cudaStream_t stream) {
+  return blasHandlePool().get(device, stream);
+}
+
+void releaseCUDABlasHandle(DeviceIndex device, cudaStream_t stream) {
+  blasHandlePool().release(device, stream);
 }
 
 } // namespace cuda
@@ -53,6 +53,13 @@ CAFFE2_API Allocator* getCUDADeviceAllocator();
 CAFFE2_API cusparseHandle_t getCurrentCUDASparseHandle();
 CAFFE2_API cublasHandle_t getCurrentCUDABlasHandle();
 
+// The cuBLAS handle bound to `stream` on `device`, shared with the caffe2
+// CUDAContext; see DeviceStreamHandlePool. The current handle is that of the
+// current stream.
+CAFFE2_API cublasHandle_t getCUDABlasHandle(DeviceIndex device, cudaStream_t stream);
+// Destroys the cuBLAS handle of `stream`, to be called before destroying it.
+CAFFE2_API void releaseCUDABlasHandle(DeviceIndex device, cudaStream_t stream);
+
 
 } // namespace cuda
 } // namespace at
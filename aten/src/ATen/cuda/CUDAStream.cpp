@@ -33,6 +33,8 @@ struct CUDAStreamInternals {
 static int64_t num_gpus = -1;
 static constexpr int kStreamsPerPoolBits = 5;
 static constexpr int kStreamsPerPool = 1 << kStreamsPerPoolBits;
+static constexpr uint32_t kAllStreamsMask =
+    static_cast<uint32_t>((uint64_t(1) << kStreamsPerPool) - 1);
 static constexpr unsigned int kDefaultFlags = cudaStreamNonBlocking;
 
 // Note: stream priority is not supported by HIP
@@ -60,6 +62,14 @@ static std::deque<std::atomic<uint32_t>> high_priority_counters;
 static std::vector<std::array<CUDAStreamInternals, kStreamsPerPool>> low_priority_streams;
 static std::vector<std::array<CUDAStreamInternals, kStreamsPerPool>> high_priority_streams;
 
+// Bit i of the reserved masks is set while stream i of the pool is reserved
+// (see the note in CUDAStream.h), and the assignment counts track how many
+// times each stream was handed out, for getStreamPoolStats.
+static std::deque<std::atomic<uint32_t>> low_priority_reserved;
+static std::deque<std::atomic<uint32_t>> high_priority_reserved;
+static std::deque<std::array<std::atomic<uint64_t>, kStreamsPerPool>> low_priority_assignments;
+static std::deque<std::array<std::atomic<uint64_t>, kStreamsPerPool>> high_priority_assignments;
+
 // Note [StreamId assignment]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // How do we assign stream IDs?
@@ -169,12 +179,22 @@ static void initGlobalStreamState() {
   high_priority_counters.resize(num_gpus);
   low_priority_streams.resize(num_gpus);
   high_priority_streams.resize(num_gpus);
+  low_priority_reserved.resize(num_gpus);
+  high_priority_reserved.resize(num_gpus);
+  low_priority_assignments.resize(num_gpus);
+  high_priority_assignments.resize(num_gpus);
 
   // Initializes default streams
   for (auto i = decltype(num_gpus){0}; i < num_gpus; ++i) {
     default_streams[i].device = i;
     low_priority_counters[i] = 0;
     high_priority_counters[i] = 0;
+    low_priority_reserved[i] = 0;
+    high_priority_reserved[i] = 0;
+    for (auto j = decltype(kStreamsPerPool){0}; j < kStreamsPerPool; ++j) {
+      low_priority_assignments[i][j] = 0;
+      high_priority_assignments[i][j] = 0;
+    }
   }
 }
 
@@ -243,10 +263,15 @@ CUDAStreamInternals* CUDAStream_getDefaultStream(int64_t device) {
 }
 
 // Helper to determine the index of the stream to return
-// Note: Streams are returned round-robin (see note in CUDAStream.h)
-static uint32_t get_idx(std::atomic<uint32_t> &counter) {
-  auto raw_idx = counter++;
-  return raw_idx % kStreamsPerPool;
+// Note: Streams are returned round-robin, skipping the reserved ones, of
+// which there are at most kStreamsPerPool - 1 (see note in CUDAStream.h)
+static uint32_t get_idx(std::atomic<uint32_t> &counter, const std::atomic<uint32_t> &reserved) {
+  while (true) {
+    auto idx = counter++ % kStreamsPerPool;
+    if (!(reserved.load() & (1u << idx))) {
+      return idx;
+    }
+  }
 }
 
 // Returns a stream from the requested pool
@@ -263,14 +288,56 @@ CUDAStreamInternals* CUDAStream_getStreamFromPool(
   std::call_once(device_flags[device], initDeviceStreamState, device);
 
   if (isHighPriority) {
-    const auto idx = get_idx(high_priority_counters[device]);
+    const auto idx = get_idx(high_priority_counters[device], high_priority_reserved[device]);
+    high_priority_assignments[device][idx]++;
     return &high_priority_streams[device][idx];
   }
 
-  const auto idx = get_idx(low_priority_counters[device]);
+  const auto idx = get_idx(low_priority_counters[device], low_priority_reserved[device]);
+  low_priority_assignments[device][idx]++;
   return &low_priority_streams[device][idx];
 }
 
+CUDAStreamInternals* CUDAStream_reserveStreamFromPool(
+  const bool isHighPriority
+, int64_t device) {
+  initCUDAStreamsOnce();
+  if (device == -1) device = current_device();
+  check_gpu(device);
+  std::call_once(device_flags[device], initDeviceStreamState, device);
+
+  auto& reserved = isHighPriority ? high_priority_reserved[device] : low_priority_reserved[device];
+  uint32_t mask = reserved.load();
+  uint32_t idx;
+  do {
+    idx = 0;
+    while (mask & (1u << idx)) {
+      idx++;
+    }
+    AT_CHECK((mask | (1u << idx)) != kAllStreamsMask,
+             "cannot reserve more than ", kStreamsPerPool - 1, " ",
+             isHighPriority ? "high" : "low", " priority streams on device ", device);
+  } while (!reserved.compare_exchange_weak(mask, mask | (1u << idx)));
+
+  if (isHighPriority) {
+    high_priority_assignments[device][idx]++;
+    return &high_priority_streams[device][idx];
+  }
+  low_priority_assignments[device][idx]++;
+  return &low_priority_streams[device][idx];
+}
+
+void CUDAStream_releaseReservedStream(CUDAStreamInternals* ptr) {
+  AT_ASSERT(ptr);
+  StreamId id = CUDAStream_getStreamId(ptr);
+  StreamIdType st = streamIdType(id);
+  AT_CHECK(st != StreamIdType::DEFAULT, "the default stream is never reserved");
+  auto& reserved = st == StreamIdType::HIGH ? high_priority_reserved[ptr->device] : low_priority_reserved[ptr->device];
+  uint32_t bit = 1u << streamIdIndex(id);
+  AT_CHECK(reserved.fetch_and(~bit) & bit, "stream ", id, " on device ", ptr->device,
+           " is not reserved");
+}
+
 CUDAStreamInternals* CUDAStream_getCurrentStream(int64_t device) {
   initCUDAStreamsOnce();
   if (device == -1) device = current_device();
@@ -298,6 +365,21 @@ int64_t CUDAStream_device(const CUDAStreamInternals* ptr) {
   return ptr->device;
 }
 
+// Returns the stats of the streams of one pool
+static void getPoolStats(
+    int64_t device,
+    bool isHighPriority,
+    std::vector<CUDAStreamPoolStats>& stats) {
+  auto& streams = isHighPriority ? high_priority_streams[device] : low_priority_streams[device];
+  uint32_t mask = (isHighPriority ? high_priority_reserved[device] : low_priority_reserved[device]).load();
+  auto& assignments = isHighPriority ? high_priority_assignments[device] : low_priority_assignments[device];
+  for (auto i = decltype(kStreamsPerPool){0}; i < kStreamsPerPool; ++i) {
+    CUDAStream stream(&streams[i]);
+    stats.push_back({stream, isHighPriority, (mask & (1u << i)) != 0,
+                     assignments[i].load(), !stream.query()});
+  }
+}
+
 } // namespace impl
 
 CUDAStream::CUDAStream(const impl::CUDAStreamInternals* ptr)
@@ -323,6 +405,19 @@ impl::CUDAStreamInternals* CUDAStream::internals() const {
   }
 }
 
+bool CUDAStream::query() const {
+  cudaError_t err = cudaStreamQuery(stream());
+  if (err == cudaErrorNotReady) {
+    return false;
+  }
+  C10_CUDA_CHECK(err);
+  return true;
+}
+
+void CUDAStream::synchronize() const {
+  C10_CUDA_CHECK(cudaStreamSynchronize(stream()));
+}
+
 /* Streams */
 CUDAStream getStreamFromPool(
   const bool isHighPriority
@@ -330,6 +425,29 @@ CUDAStream getStreamFromPool(
   return CUDAStream(impl::CUDAStream_getStreamFromPool(isHighPriority, device));
 }
 
+CUDAStream reserveStreamFromPool(
+  const bool isHighPriority
+, int64_t device) {
+  return CUDAStream(impl::CUDAStream_reserveStreamFromPool(isHighPriority, device));
+}
+
+void releaseReservedStream(CUDAStream stream) {
+  impl::CUDAStream_releaseReservedStream(stream.internals());
+}
+
+std::vector<CUDAStreamPoolStats> getStreamPoolStats(int64_t device) {
+  impl::initCUDAStreamsOnce();
+  if (device == -1) device = current_device();
+  impl::check_gpu(device);
+  std::call_once(impl::device_flags[device], impl::initDeviceStreamState, device);
+
+  std::vector<CUDAStreamPoolStats> stats;
+  stats.reserve(2 * impl::kStreamsPerPool);
+  impl::getPoolStats(device, /*isHighPriority=*/false, stats);
+  impl::getPoolStats(device, /*isHighPriority=*/true, stats);
+  return stats;
+}
+
 CUDAStream getDefaultCUDAStream(int64_t device) {
   return CUDAStream(impl::CUDAStream_getDefaultStream(device));
 }
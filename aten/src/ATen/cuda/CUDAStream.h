@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <utility>
+#include <vector>
 
 #include "cuda_runtime_api.h"
 
@@ -42,11 +43,18 @@
 * the second pool except the streams are created with a higher priority.
 *
 * These pools suggest that stream users should prefer many short-lived streams,
-* as the cost of acquiring and releasing streams is effectively zero. If
-* many longer-lived streams are required in performance critical scenarios
-* then the functionality here may need to be extended to allow, for example,
-* "reserving" a subset of the pool so that other streams do not accidentally
-* overlap the performance critical streams.
+* as the cost of acquiring and releasing streams is effectively zero. Longer-
+* lived streams in performance critical scenarios, e.g. one per model served
+* on a GPU, can instead be reserved from the low or high priority pool. A
+* reserved stream is skipped by the round-robin until it is released, so
+* other stream users don't accidentally overlap it. Reserving one doesn't
+* wait for the work that earlier users of the stream may have queued on it,
+* so streams are best reserved before the workloads start. At least one
+* stream of each pool is always left to the round-robin.
+*
+* The current stream is per thread and per device: a thread serving a
+* workload can bind its reserved stream with setCurrentCUDAStream, or
+* CUDAStreamGuard for a scope, without affecting the other threads.
 */
 
 namespace at {
@@ -63,6 +71,11 @@ AT_CUDA_API CUDAStreamInternals* CUDAStream_getStreamFromPool(
   const bool isHighPriority = false
 , int64_t device = -1);
 
+AT_CUDA_API CUDAStreamInternals* CUDAStream_reserveStreamFromPool(
+  const bool isHighPriority = false
+, int64_t device = -1);
+AT_CUDA_API void CUDAStream_releaseReservedStream(CUDAStreamInternals* internals);
+
 AT_CUDA_API CUDAStreamInternals* CUDAStream_getCurrentStream(int64_t device = -1);
 
 AT_CUDA_API void CUDAStream_setStream(CUDAStreamInternals* internals);
@@ -99,6 +112,11 @@ struct AT_CUDA_API CUDAStream {
 
   Stream unwrap() const { return stream_; }
 
+  // True if all the work queued on the stream has completed
+  bool query() const;
+  // Blocks the host until all the work queued on the stream has completed
+  void synchronize() const;
+
   // Deleted for now; use CUDAEvent::block instead
   // void synchronize_with(const CUDAEvent& event) const;
 
@@ -119,6 +137,34 @@ private:
 CAFFE2_API CUDAStream
 getStreamFromPool(const bool isHighPriority = false, int64_t device = -1);
 
+/**
+ * Reserve a stream of the low or high priority pool, which getStreamFromPool
+ * won't return until it's released with releaseReservedStream.  See the
+ * stream pool note for the caveats.  Errors if every stream of the pool but
+ * the last one is already reserved.
+ */
+CAFFE2_API CUDAStream
+reserveStreamFromPool(const bool isHighPriority = false, int64_t device = -1);
+CAFFE2_API void releaseReservedStream(CUDAStream stream);
+
+/**
+ * The state of a stream of the pools, for the introspection of multi-tenant
+ * workloads.  CUDA doesn't expose how much work is queued on a stream:
+ * num_assigned counts how many times the stream was handed out, so streams
+ * shared by several workloads stand out, and busy tells whether it still has
+ * work in flight.
+ */
+struct CUDAStreamPoolStats {
+  CUDAStream stream;
+  bool is_high_priority;
+  bool is_reserved;
+  uint64_t num_assigned;
+  bool busy;
+};
+
+// Returns the stats of the low then the high priority streams of a device
+CAFFE2_API std::vector<CUDAStreamPoolStats> getStreamPoolStats(int64_t device = -1);
+
 CAFFE2_API CUDAStream getDefaultCUDAStream(int64_t device = -1);
 CAFFE2_API CUDAStream getCurrentCUDAStream(int64_t device = -1);
 
@@ -4,6 +4,9 @@
 #include <ATen/Context.h>
 #include <ATen/RegisterCUDA.h>
 #include <ATen/cuda/CUDAConfig.h>
+#include <ATen/cuda/CUDAGuard.h>
+#include <ATen/cuda/CUDAStream.h>
+#include <ATen/cuda/Exceptions.h>
 #include <ATen/cuda/PinnedMemoryAllocator.h>
 #include <ATen/detail/CUDAHooksInterface.h>
 #include <ATen/native/cuda/CuFFTPlanCache.h>
@@ -160,33 +163,42 @@ double CUDAHooks::batchnormMinEpsilonCuDNN() const {
 #endif
 }
 
-int64_t CUDAHooks::cuFFTGetPlanCacheMaxSize() const {
+int64_t CUDAHooks::cuFFTGetPlanCacheMaxSize(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
-  return at::native::detail::cufft_get_plan_cache_max_size_impl();
+  return at::native::detail::cufft_get_plan_cache_max_size_impl(device_index);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
-void CUDAHooks::cuFFTSetPlanCacheMaxSize(int64_t max_size) const {
+void CUDAHooks::cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const {
 #ifndef __HIP_PLATFORM_HCC__
-  at::native::detail::cufft_set_plan_cache_max_size_impl(max_size);
+  at::native::detail::cufft_set_plan_cache_max_size_impl(device_index, max_size);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
-int64_t CUDAHooks::cuFFTGetPlanCacheSize() const {
+int64_t CUDAHooks::cuFFTGetPlanCacheSize(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
-  return at::native::detail::cufft_get_plan_cache_size_impl();
+  return at::native::detail::cufft_get_plan_cache_size_impl(device_index);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
 }
 
-void CUDAHooks::cuFFTClearPlanCache() const {
+void CUDAHooks::cuFFTClearPlanCache(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
-  at::native::detail::cufft_clear_plan_cache_impl();
+  at::native::detail::cufft_clear_plan_cache_impl(device_index);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
+void CUDAHooks::cuFFTGetPlanCacheStats(int64_t device_index, int64_t* hits,
+                                       int64_t* misses, int64_t* evictions) const {
+#ifndef __HIP_PLATFORM_HCC__
+  at::native::detail::cufft_get_plan_cache_stats_impl(device_index, hits, misses, evictions);
 #else
   AT_ERROR("cuFFT with HIP is not supported");
 #endif
@@ -204,6 +216,26 @@ int CUDAHooks::getNumGPUs() const {
   return count;
 }
 
+void* CUDAHooks::getCurrentCUDAStreamHandle(int64_t device_index) const {
+  return at::cuda::getCurrentCUDAStream(device_index).stream();
+}
+
+void CUDAHooks::streamWaitStream(void* waiting, void* producing, int64_t device_index) const {
+  if (waiting == producing) {
+    return;
+  }
+  at::cuda::CUDAGuard device_guard(static_cast<DeviceIndex>(device_index));
+  cudaEvent_t event;
+  AT_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  cudaError_t err = cudaEventRecord(event, static_cast<cudaStream_t>(producing));
+  if (err == cudaSuccess) {
+    err = cudaStreamWaitEvent(static_cast<cudaStream_t>(waiting), event, 0);
+  }
+  // The wait keeps what it needs of the event, which can be destroyed now
+  AT_CUDA_CHECK(cudaEventDestroy(event));
+  AT_CUDA_CHECK(err);
+}
+
 // Sigh, the registry doesn't support namespaces :(
 using at::CUDAHooksRegistry;
 using at::RegistererCUDAHooksRegistry;
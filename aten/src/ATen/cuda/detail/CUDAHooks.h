@@ -23,11 +23,15 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   bool supportsDilatedConvolutionWithCuDNN() const override;
   long versionCuDNN() const override;
   double batchnormMinEpsilonCuDNN() const override;
-  int64_t cuFFTGetPlanCacheMaxSize() const override;
-  void cuFFTSetPlanCacheMaxSize(int64_t max_size) const override;
-  int64_t cuFFTGetPlanCacheSize() const override;
-  void cuFFTClearPlanCache() const override;
+  int64_t cuFFTGetPlanCacheMaxSize(int64_t device_index) const override;
+  void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const override;
+  int64_t cuFFTGetPlanCacheSize(int64_t device_index) const override;
+  void cuFFTClearPlanCache(int64_t device_index) const override;
+  void cuFFTGetPlanCacheStats(int64_t device_index, int64_t* hits,
+                              int64_t* misses, int64_t* evictions) const override;
   int getNumGPUs() const override;
+  void* getCurrentCUDAStreamHandle(int64_t device_index) const override;
+  void streamWaitStream(void* waiting, void* producing, int64_t device_index) const override;
 };
 
 }}} // at::cuda::detail
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ATen/cuda/CUDAGuard.h>
+#include <c10/Device.h>
+
+#include <cuda_runtime_api.h>
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace at { namespace cuda { namespace detail {
+
+// A pool of library handles (cuBLAS, cuDNN), one per device and stream, each
+// bound to its stream when it is created. ATen and the caffe2 CUDAContext get
+// their handles from the same pools, so that a process mixing the two does
+// not create handles, and workspaces, twice.
+//
+// A handle is only ever used with its own stream, so it is only shared by the
+// threads sharing the stream, as are handles today.
+//
+// The handles that are not released are never destroyed: at exit, the CUDA
+// context may already be gone by the time static objects are destroyed.
+template <typename Handle_t>
+class DeviceStreamHandlePool {
+ public:
+  // Creates a handle on the current device, bound to the stream
+  using CreateFn = Handle_t (*)(cudaStream_t);
+  using DestroyFn = void (*)(Handle_t);
+
+  DeviceStreamHandlePool(CreateFn create, DestroyFn destroy)
+    : create_(create), destroy_(destroy) {}
+
+  Handle_t get(DeviceIndex device, cudaStream_t stream) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Handle_t& handle = handles_[std::make_pair(device, stream)];
+    if (!handle) {
+      CUDAGuard device_guard(device);
+      handle = create_(stream);
+    }
+    return handle;
+  }
+
+  // Destroys the handle of the stream, if there is one. To be called before
+  // the stream is destroyed, so that the pool does not hand the handle out
+  // for another stream which gets the same cudaStream_t.
+  void release(DeviceIndex device, cudaStream_t stream) {
+    Handle_t handle;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto it = handles_.find(std::make_pair(device, stream));
+      if (it == handles_.end()) {
+        return;
+      }
+      handle = it->second;
+      handles_.erase(it);
+    }
+    CUDAGuard device_guard(device);
+    destroy_(handle);
+  }
+
+ private:
+  CreateFn create_;
+  DestroyFn destroy_;
+  std::mutex mutex_;
+  std::map<std::pair<DeviceIndex, cudaStream_t>, Handle_t> handles_;
+};
+
+}}} // namespace at::cuda::detail
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ATen/cuda/ATenCUDAGeneral.h"
+
+#include <cstdint>
+#include <string>
+
+namespace at { namespace native {
+
+// Persistence of the algorithms chosen by cudnn_convolution and friends
+// when benchmarking is enabled, so that a job can skip the cudnnFind*
+// search for the shapes some previous job already tuned.
+//
+// The file holds one section per GPU model and cuDNN version.  Exporting
+// writes the current cache as a section for the current device; the
+// exports of several kinds of GPUs can be concatenated into a single file.
+// Importing only loads the entries of the section matching the current
+// device, and returns their number.
+
+AT_CUDA_API void exportConvolutionBenchmarkCache(const std::string& path);
+
+AT_CUDA_API int64_t importConvolutionBenchmarkCache(const std::string& path);
+
+}} // namespace
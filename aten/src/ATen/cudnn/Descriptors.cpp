@@ -1,6 +1,7 @@
 #include "Descriptors.h"
 
 #include <ATen/ATen.h>
+#include <ATen/native/ChannelsLast.h>
 
 #include <ostream>
 #include <sstream>
@@ -30,9 +31,27 @@ inline cudnnDataType_t getDataType(const at::Tensor& t) {
 
 
 void TensorDescriptor::set(const at::Tensor &t, size_t pad) {
+  if (is_channels_last(t) && pad <= static_cast<size_t>(t.dim())) {
+    set_channels_last(getDataType(t), t.sizes());
+    return;
+  }
   set(getDataType(t), t.sizes(), t.strides(), pad);
 }
 
+// cuDNN recognizes NHWC tensors by their strides, including those of the
+// dimensions of size 1, which fixSizeOneDimStride would make NCHW ones.
+void TensorDescriptor::set_channels_last(cudnnDataType_t datatype, IntList t_sizes) {
+  auto t_strides = channels_last_strides(t_sizes);
+  int size[CUDNN_DIM_MAX];
+  int stride[CUDNN_DIM_MAX];
+  for (size_t i = 0; i < t_sizes.size(); ++i) {
+    size[i] = static_cast<int>(t_sizes[i]);
+    stride[i] = static_cast<int>(t_strides[i]);
+  }
+  AT_CUDNN_CHECK(cudnnSetTensorNdDescriptor(
+      mut_desc(), datatype, static_cast<int>(t_sizes.size()), size, stride));
+}
+
 void TensorDescriptor::set(cudnnDataType_t datatype, IntList t_sizes, IntList t_strides, size_t pad) {
   size_t dim = t_sizes.size();
   if (dim > CUDNN_DIM_MAX || pad > CUDNN_DIM_MAX)
@@ -106,7 +125,7 @@ std::ostream& operator<<(std::ostream & out, const TensorDescriptor& d) {
 
 void TensorDescriptor::print() { std::cout << *this; }
 
-void FilterDescriptor::set(const at::Tensor &t, int64_t pad) {
+void FilterDescriptor::set(const at::Tensor &t, int64_t pad, bool channels_last) {
   auto dim = t.ndimension();
   if (dim > CUDNN_DIM_MAX || pad > CUDNN_DIM_MAX)
 #define _STR(X) #X
@@ -114,12 +133,14 @@ void FilterDescriptor::set(const at::Tensor &t, int64_t pad) {
     throw std::runtime_error("cuDNN supports only up to " STR(CUDNN_DIM_MAX) " dimensions");
 #undef _STR
 #undef STR
-  if (!t.is_contiguous()) {
+  if (channels_last ? !has_channels_last_strides(t) : !t.is_contiguous()) {
     // NB: It is possible for this test to be insufficient, because the
     // Tensor passed in to set the filter descriptor may not be the actual
     // Tensor whose data pointer is passed to cuDNN.  Nevertheless,
     // that is the common case, so we can catch most client errors with this test.
-    throw std::runtime_error("cuDNN filters (a.k.a. weights) must be contiguous");
+    throw std::runtime_error(channels_last
+        ? "cuDNN NHWC filters (a.k.a. weights) must be channels last"
+        : "cuDNN filters (a.k.a. weights) must be contiguous");
   }
   int size[CUDNN_DIM_MAX];
   for (int i = 0; i < dim; ++i) {
@@ -129,7 +150,7 @@ void FilterDescriptor::set(const at::Tensor &t, int64_t pad) {
     size[i] = (int) 1;
   }
   dim = std::max(dim, pad);
-  set(getDataType(t), (int) dim, size);
+  set(getDataType(t), (int) dim, size, channels_last ? CUDNN_TENSOR_NHWC : CUDNN_TENSOR_NCHW);
 }
 
 }}
@@ -161,6 +161,8 @@ public:
   void print();
 
 private:
+  void set_channels_last(cudnnDataType_t dataType, IntList sizes);
+
   void set(cudnnDataType_t dataType, int dim, int* size, int* stride) {
     fixSizeOneDimStride(dim, size, stride);
     AT_CUDNN_CHECK(cudnnSetTensorNdDescriptor(mut_desc(), dataType, dim, size, stride));
@@ -175,11 +177,14 @@ class FilterDescriptor
                       &cudnnDestroyFilterDescriptor>
 {
 public:
-  void set(const at::Tensor &t, int64_t pad = 0);
+  // channels_last describes a filter laid out KRSC (see
+  // ATen/native/ChannelsLast.h) instead of KCRS, which cuDNN wants for
+  // convolutions of NHWC tensors
+  void set(const at::Tensor &t, int64_t pad = 0, bool channels_last = false);
 
 private:
-  void set(cudnnDataType_t dataType, int dim, int* size) {
-    AT_CUDNN_CHECK(cudnnSetFilterNdDescriptor(mut_desc(), dataType, CUDNN_TENSOR_NCHW, dim, size));
+  void set(cudnnDataType_t dataType, int dim, int* size, cudnnTensorFormat_t format) {
+    AT_CUDNN_CHECK(cudnnSetFilterNdDescriptor(mut_desc(), dataType, format, dim, size));
   }
 };
 
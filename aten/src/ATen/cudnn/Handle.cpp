@@ -1,24 +1,21 @@
 #include "Handle.h"
 
+#include "ATen/cuda/CUDAContext.h"
 #include "ATen/cuda/Exceptions.h"
-
-#include <unordered_map>
-#include <mutex>
-
-// TODO: Get rid of the mutex, and just initialize these
-// handles in at::Context along with lazy CUDA initialization
+#include "ATen/cuda/detail/DeviceStreamHandlePool.h"
 
 namespace at { namespace native {
 
 namespace {
 
-struct Handle {
+cudnnHandle_t createHandle(cudaStream_t stream) {
   cudnnHandle_t handle;
-  Handle() : handle(NULL) {
-    AT_CUDNN_CHECK(cudnnCreate(&handle));
-  }
-  ~Handle() {
-    if (handle) {
+  AT_CUDNN_CHECK(cudnnCreate(&handle));
+  AT_CUDNN_CHECK(cudnnSetStream(handle, stream));
+  return handle;
+}
+
+void destroyHandle(cudnnHandle_t handle) {
 // this is because of something dumb in the ordering of
 // destruction. Sometimes atexit, the cuda context (or something)
 // would already be destroyed by the time this gets destroyed. It
@@ -27,25 +24,32 @@ struct Handle {
 //   - @soumith
 #ifdef NO_CUDNN_DESTROY_HANDLE
 #else
-      cudnnDestroy(handle);
+  cudnnDestroy(handle);
 #endif
-    }
-  }
-};
+}
 
-std::mutex mutex;
-std::unordered_map<int, Handle> handles;
+cuda::detail::DeviceStreamHandlePool<cudnnHandle_t>& handlePool() {
+  static auto* pool = new cuda::detail::DeviceStreamHandlePool<cudnnHandle_t>(
+      createHandle, destroyHandle);
+  return *pool;
+}
 
 }  // namespace
 
 
 cudnnHandle_t getCudnnHandle()
 {
-  int device;
-  AT_CUDA_CHECK(cudaGetDevice(&device));
+  return getCudnnHandle(c10::cuda::current_device(), cuda::getCurrentCUDAStream().stream());
+}
 
-  std::lock_guard<std::mutex> guard(mutex);
-  return handles[device].handle;
+cudnnHandle_t getCudnnHandle(DeviceIndex device, cudaStream_t stream)
+{
+  return handlePool().get(device, stream);
+}
+
+void releaseCudnnHandle(DeviceIndex device, cudaStream_t stream)
+{
+  handlePool().release(device, stream);
 }
 
 }} // namespace at::cudnn
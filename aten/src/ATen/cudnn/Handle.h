@@ -3,8 +3,19 @@
 #include "cudnn-wrapper.h"
 #include "ATen/cuda/ATenCUDAGeneral.h"
 
+#include <c10/Device.h>
+
+#include <cuda_runtime_api.h>
+
 namespace at { namespace native {
 
+// The cuDNN handle of the current stream
 AT_CUDA_API cudnnHandle_t getCudnnHandle();
 
+// The cuDNN handle bound to `stream` on `device`, shared with the caffe2
+// CUDAContext; see DeviceStreamHandlePool.
+AT_CUDA_API cudnnHandle_t getCudnnHandle(DeviceIndex device, cudaStream_t stream);
+// Destroys the cuDNN handle of `stream`, to be called before destroying it.
+AT_CUDA_API void releaseCudnnHandle(DeviceIndex device, cudaStream_t stream);
+
 }} // namespace
@@ -9,6 +9,8 @@
 namespace at { namespace native {
 
 inline void setCuDNNStreamToCurrent() {
+  // The handle of the current stream is already bound to it; this only
+  // matters to handles not taken from getCudnnHandle().
   // TODO: Should getCurrentStream be a method on Context?
   AT_CUDNN_CHECK(cudnnSetStream(getCudnnHandle(), THCState_getCurrentStream(globalContext().getTHCState())));
 }
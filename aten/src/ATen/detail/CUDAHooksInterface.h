@@ -107,25 +107,42 @@ struct CAFFE2_API CUDAHooksInterface {
         "Cannot query batchnormMinEpsilonCuDNN() without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual int64_t cuFFTGetPlanCacheMaxSize() const {
+  virtual int64_t cuFFTGetPlanCacheMaxSize(int64_t device_index) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual void cuFFTSetPlanCacheMaxSize(int64_t max_size) const {
+  virtual void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual int64_t cuFFTGetPlanCacheSize() const {
+  virtual int64_t cuFFTGetPlanCacheSize(int64_t device_index) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
-  virtual void cuFFTClearPlanCache() const {
+  virtual void cuFFTClearPlanCache(int64_t device_index) const {
+    AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual void cuFFTGetPlanCacheStats(int64_t device_index, int64_t* hits,
+                                      int64_t* misses, int64_t* evictions) const {
     AT_ERROR("Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
   virtual int getNumGPUs() const {
     return 0;
   }
+
+  // The cudaStream_t of the current stream on the device
+  virtual void* getCurrentCUDAStreamHandle(int64_t device_index) const {
+    AT_ERROR("Cannot get the current CUDA stream without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  // Makes the cudaStream_t waiting wait for the work queued on the
+  // cudaStream_t producing so far, both on the device, by recording an event
+  // on producing. Neither stream is synchronized with the host.
+  virtual void streamWaitStream(void* waiting, void* producing, int64_t device_index) const {
+    AT_ERROR("Cannot synchronize CUDA streams without ATen_cuda library. ", CUDA_HELP);
+  }
 };
 
 // NB: dummy argument to suppress "ISO C++11 requires at least one argument
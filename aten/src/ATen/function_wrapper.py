@@ -121,6 +121,12 @@ ${return_type} ${Type}::${api_name}(${type_method_formals}) const {
 TYPE_DEFINITION_BODY_NATIVE = CodeTemplate("""\
 ${return_call} at::native::${native_type_method_dispatch}(/* native_actuals */ ${native_actuals});
 """)
+# body of an _out function derived from the in-place variant of a native
+# function (out_from_inplace: True in native_functions.yaml)
+TYPE_DEFINITION_BODY_OUT_FROM_INPLACE = CodeTemplate("""\
+out.resize_as_(self).copy_(self);
+return ${inplace_call};
+""")
 
 # add non-virtual declaration to Tensor.h
 TENSOR_METHOD_DECLARATION = CodeTemplate("""\
@@ -480,6 +486,7 @@ FunctionOption = TypedDict('FunctionOption', {
     'device_guard_declaration': str,
     'with_gil': bool,
     'cpu_half': bool,
+    'cpu_bfloat16': bool,
     'deprecated': bool,
     'formals_list': List[AtFormal],
     'formals_with_defaults': List[str],
@@ -500,6 +507,8 @@ FunctionOption = TypedDict('FunctionOption', {
     'native_type_method_dispatch': str,
     # options should be List[FunctionOption]
     'options': Any,
+    # the in-place function name_out is implemented with, see native_parse.py
+    'out_from_inplace': Dict[str, Any],
     'requires_tensor': bool,
     'return_call': str,
     'return_type': str,
@@ -565,7 +574,7 @@ def is_mutable_formal_argument(argument, option):
 
 def check_methods_do_not_start_with_underscore(name, is_method):
     if name in {'_local_scalar', '_values', '_indices', '_nnz', '_dimI',
-                '_dimV', '_coalesced_'}:
+                '_dimV', '_coalesced_', '_unique_indices_'}:
         return
     if is_method and name.startswith('_') and not name.startswith('__') and not name.startswith('_th_'):
         message = "Function '{}' starts with a single underscore and is ".format(name)
@@ -1124,6 +1133,17 @@ def create_generic(top_env, declarations):
         elif is_deprecated_factory_method:
             top_env['type_method_definitions'].append(
                 DEPRECATED_TYPE_METHOD_DEFINITION_CONCRETE.substitute(env))
+        elif option.get('out_from_inplace'):
+            inplace = option['out_from_inplace']
+            inplace_actuals = ['out'] + option['actuals'][2:]
+            if inplace['method']:
+                inplace_call = 'out.{}({})'.format(inplace['name'], ', '.join(inplace_actuals[1:]))
+            else:
+                inplace_call = 'at::{}({})'.format(inplace['name'], ', '.join(inplace_actuals))
+            body = TYPE_DEFINITION_BODY_OUT_FROM_INPLACE.substitute(env, inplace_call=inplace_call)
+            top_env['type_method_definitions'].append(
+                TYPE_METHOD_DEFINITION_CONCRETE.substitute(
+                    env, type_definition_body=body))
         elif not is_factory_method:
             body = TYPE_DEFINITION_BODY_NATIVE.substitute(env)
             top_env['type_method_definitions'].append(
@@ -1131,7 +1151,7 @@ def create_generic(top_env, declarations):
                     env, type_definition_body=body))
 
         # generate the at::native function declarations (i.e. what the user will implement)
-        if needs_native_definition:
+        if needs_native_definition and not option.get('out_from_inplace'):
             if isinstance(type_method_dispatch, dict):
                 generated_native_functions = []  # type: List[str]
                 for key in sorted(type_method_dispatch.keys()):
@@ -167,6 +167,7 @@ scalar_types = [
     ('Long', 'int64_t', 'Long', 'int64_t', False),
     ('Short', 'int16_t', 'Long', 'int16_t', False),
     ('Half', 'Half', 'Double', 'at::Half', True),
+    ('BFloat16', 'BFloat16', 'Double', 'at::BFloat16', True),
 ]
 
 # shared environment for non-derived base classes Type.h Tensor.h Storage.h
@@ -334,6 +335,10 @@ def iterate_types():
                 if density == 'Sparse' and scalar_type[0] == 'Half':
                     # THS does not do half type yet.
                     continue
+                if scalar_type[0] == 'BFloat16' and (backend, density) != ('CPU', 'Dense'):
+                    # BFloat16 only has native CPU kernels, there is no TH or
+                    # THC type for it.
+                    continue
                 yield (backend, density, scalar_type)
 
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ATen/core/ATenGeneral.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace at { namespace native {
+
+// The primitives mkldnn_convolution and its backward functions create for a
+// shape are kept in a cache shared by all threads, and the least recently
+// used ones are dropped once it holds more than its capacity per direction.
+// The counters sum the forward, backward data and backward weights caches.
+// When ATen is not compiled with MKLDNN the cache is always empty.
+
+struct ConvPrimitiveCacheStats {
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+  int64_t size;
+};
+
+CAFFE2_API ConvPrimitiveCacheStats mkldnnConvPrimitiveCacheStats();
+
+CAFFE2_API void setMkldnnConvPrimitiveCacheCapacity(size_t capacity);
+
+CAFFE2_API void clearMkldnnConvPrimitiveCache();
+
+}} // namespace at::native
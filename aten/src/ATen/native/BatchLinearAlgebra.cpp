@@ -2,11 +2,15 @@
 #include "ATen/CPUApplyUtils.h"
 #include "ATen/Dispatch.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 
 #include "ATen/native/LinearAlgebraUtils.h"
 
 #include "TH.h"  // for USE_LAPACK
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
 #include <vector>
 
 // First the required LAPACK implementations are registered here.
@@ -105,6 +109,164 @@ template<> void lapackCholesky<float>(char uplo, int n, float *a, int lda, int *
 }
 #endif
 
+// Unblocked versions of the LAPACK routines above, for the small matrices of
+// a batch, for which the cost of a call to LAPACK (argument checks, block size
+// queries) is larger than that of the factorization itself. They take and
+// return the same column major matrices, pivots and infos as their LAPACK
+// counterparts, with lda == n.
+static constexpr int64_t kSmallMatrixMaxSize = 16;
+
+// getrf with partial pivoting, as dgetf2
+template<typename scalar_t>
+static void smallGetrf(int n, scalar_t *a, int *ipiv, int *info) {
+  *info = 0;
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    scalar_t max = std::abs(a[k + k * n]);
+    for (int i = k + 1; i < n; i++) {
+      if (std::abs(a[i + k * n]) > max) {
+        max = std::abs(a[i + k * n]);
+        p = i;
+      }
+    }
+    ipiv[k] = p + 1;
+    if (a[p + k * n] != 0) {
+      if (p != k) {
+        for (int j = 0; j < n; j++) {
+          std::swap(a[k + j * n], a[p + j * n]);
+        }
+      }
+      scalar_t pivot_inverse = 1 / a[k + k * n];
+      for (int i = k + 1; i < n; i++) {
+        a[i + k * n] *= pivot_inverse;
+      }
+    } else if (*info == 0) {
+      *info = k + 1;
+    }
+    for (int j = k + 1; j < n; j++) {
+      scalar_t a_kj = a[k + j * n];
+      for (int i = k + 1; i < n; i++) {
+        a[i + j * n] -= a[i + k * n] * a_kj;
+      }
+    }
+  }
+}
+
+// getrs on the output of smallGetrf, for a non singular U
+template<typename scalar_t>
+static void smallGetrs(int n, int nrhs, const scalar_t *a, const int *ipiv, scalar_t *b) {
+  for (int c = 0; c < nrhs; c++) {
+    scalar_t* x = &b[c * n];
+    for (int k = 0; k < n; k++) {
+      std::swap(x[k], x[ipiv[k] - 1]);
+    }
+    for (int k = 0; k < n; k++) {
+      for (int i = k + 1; i < n; i++) {
+        x[i] -= a[i + k * n] * x[k];
+      }
+    }
+    for (int k = n - 1; k >= 0; k--) {
+      x[k] /= a[k + k * n];
+      for (int i = 0; i < k; i++) {
+        x[i] -= a[i + k * n] * x[k];
+      }
+    }
+  }
+}
+
+template<typename scalar_t>
+static void smallGesv(int n, int nrhs, scalar_t *a, int *ipiv, scalar_t *b, int *info) {
+  smallGetrf<scalar_t>(n, a, ipiv, info);
+  if (*info == 0) {
+    smallGetrs<scalar_t>(n, nrhs, a, ipiv, b);
+  }
+}
+
+// getrf followed by getri, the inverse being solved for in place of the
+// identity
+template<typename scalar_t>
+static void smallInverse(int n, scalar_t *a, int *info) {
+  int ipiv[kSmallMatrixMaxSize];
+  scalar_t inverse[kSmallMatrixMaxSize * kSmallMatrixMaxSize];
+  smallGetrf<scalar_t>(n, a, ipiv, info);
+  if (*info != 0) {
+    return;
+  }
+  std::fill(inverse, inverse + n * n, scalar_t(0));
+  for (int i = 0; i < n; i++) {
+    inverse[i + i * n] = 1;
+  }
+  smallGetrs<scalar_t>(n, n, a, ipiv, inverse);
+  std::copy(inverse, inverse + n * n, a);
+}
+
+// potrf, as dpotf2: the factor overwrites the upper or lower triangle of a,
+// the other one is not referenced
+template<typename scalar_t>
+static void smallCholesky(bool upper, int n, scalar_t *a, int *info) {
+  *info = 0;
+  // with U(i, j) = a[i + j * n] and L(i, j) = a[j + i * n], both factors are
+  // computed by the same loops on their transposed indices
+  const int row_stride = upper ? 1 : n;
+  const int col_stride = upper ? n : 1;
+  for (int j = 0; j < n; j++) {
+    scalar_t* u_j = &a[j * col_stride];
+    scalar_t a_jj = u_j[j * row_stride];
+    for (int k = 0; k < j; k++) {
+      a_jj -= u_j[k * row_stride] * u_j[k * row_stride];
+    }
+    if (!(a_jj > 0)) {
+      u_j[j * row_stride] = a_jj;
+      *info = j + 1;
+      return;
+    }
+    a_jj = std::sqrt(a_jj);
+    u_j[j * row_stride] = a_jj;
+    for (int i = j + 1; i < n; i++) {
+      scalar_t* u_i = &a[i * col_stride];
+      scalar_t u_ji = u_i[j * row_stride];
+      for (int k = 0; k < j; k++) {
+        u_ji -= u_j[k * row_stride] * u_i[k * row_stride];
+      }
+      u_i[j * row_stride] = u_ji / a_jj;
+    }
+  }
+}
+
+// potrs on the output of smallCholesky, solving U^T U x = b or L L^T x = b
+template<typename scalar_t>
+static void smallPotrs(bool upper, int n, int nrhs, const scalar_t *a, scalar_t *b) {
+  // U(i, j) for the upper factor, L^T(i, j) for the lower one
+  const int row_stride = upper ? 1 : n;
+  const int col_stride = upper ? n : 1;
+  auto u = [&](int i, int j) { return a[i * row_stride + j * col_stride]; };
+  for (int c = 0; c < nrhs; c++) {
+    scalar_t* x = &b[c * n];
+    for (int i = 0; i < n; i++) {
+      scalar_t x_i = x[i];
+      for (int k = 0; k < i; k++) {
+        x_i -= u(k, i) * x[k];
+      }
+      x[i] = x_i / u(i, i);
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      scalar_t x_i = x[i];
+      for (int k = i + 1; k < n; k++) {
+        x_i -= u(i, k) * x[k];
+      }
+      x[i] = x_i / u(i, i);
+    }
+  }
+}
+
+// The matrices of a batch are factorized in parallel, in chunks of about
+// GRAIN_SIZE flops, so that batches of tiny matrices are not split in chunks
+// too small to pay for the threads, and that each of the large matrices,
+// which LAPACK already runs in parallel, gets its own chunk.
+static int64_t batchGrainSize(int64_t n) {
+  return std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, n * n * n));
+}
+
 // Below of the definitions of the functions operating on a batch that are going to be dispatched
 // in the main helper functions for the linear algebra operations
 
@@ -124,18 +286,20 @@ static void apply_gesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
   auto n = A.size(-2);
   auto nrhs = b.size(-1);
 
-  auto ipiv = at::empty({n}, b.type().toScalarType(kInt));
-
-  int info;
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
-    scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
-    lapackGesv<scalar_t>(n, nrhs, A_working_ptr, n, ipiv.data<int>(), b_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+    std::vector<int> ipiv(n);
+    for (int64_t i = begin; i < end; i++) {
+      int info;
+      scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
+      scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
+      if (n <= kSmallMatrixMaxSize) {
+        smallGesv<scalar_t>(n, nrhs, A_working_ptr, ipiv.data(), b_working_ptr, &info);
+      } else {
+        lapackGesv<scalar_t>(n, nrhs, A_working_ptr, n, ipiv.data(), b_working_ptr, n, &info);
+      }
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -184,34 +348,37 @@ static void apply_inverse(Tensor& self, std::vector<int64_t>& infos) {
   auto batch_size = batchCount(self);
   auto n = self.size(-2);
 
-  auto ipiv = at::empty({n}, self.type().toScalarType(kInt));
-  int lwork;
-  scalar_t wkopt;
-  Tensor work;
-
-  for (int64_t i = 0; i < batch_size; i++) {
-    int info;
-    scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
-    lapackGetrf<scalar_t>(n, n, self_working_ptr, n, ipiv.data<int>(), &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
-    }
-
-    // Run twice, first to get the optimum work size
-    lwork = -1;
-    lapackGetri<scalar_t>(n, self_working_ptr, n, ipiv.data<int>(), &wkopt, lwork, &info);
-
-    lwork = static_cast<int>(wkopt);
-    work = at::empty({lwork}, self.type());
+  if (n <= kSmallMatrixMaxSize) {
+    parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        int info;
+        smallInverse<scalar_t>(n, &self_data[i * self_matrix_stride], &info);
+        infos[i] = info;
+      }
+    });
+    return;
+  }
 
-    // now to compute the actual inverse
-    lapackGetri<scalar_t>(n, self_working_ptr, n, ipiv.data<int>(), work.data<scalar_t>(), lwork, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  // Query the optimum work size, which only depends on n, once for the batch
+  int info;
+  int lwork = -1;
+  scalar_t wkopt;
+  lapackGetri<scalar_t>(n, self_data, n, nullptr, &wkopt, lwork, &info);
+  lwork = static_cast<int>(wkopt);
+
+  parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+    std::vector<int> ipiv(n);
+    std::vector<scalar_t> work(lwork);
+    for (int64_t i = begin; i < end; i++) {
+      int info;
+      scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
+      lapackGetrf<scalar_t>(n, n, self_working_ptr, n, ipiv.data(), &info);
+      if (info == 0) {
+        lapackGetri<scalar_t>(n, self_working_ptr, n, ipiv.data(), work.data(), lwork, &info);
+      }
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -262,16 +429,19 @@ static void apply_potrs(Tensor& b, Tensor& A, bool upper, std::vector<int64_t>&
   auto n = A.size(-2);
   auto nrhs = b.size(-1);
 
-  for (int64_t i = 0; i < batch_size; i++) {
-    int info;
-    scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
-    scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
-    lapackPotrs<scalar_t>(uplo, n, nrhs, A_working_ptr, n, b_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int info = 0;
+      scalar_t* A_working_ptr = &A_data[i * A_mat_stride];
+      scalar_t* b_working_ptr = &b_data[i * b_mat_stride];
+      if (n <= kSmallMatrixMaxSize) {
+        smallPotrs<scalar_t>(upper, n, nrhs, A_working_ptr, b_working_ptr);
+      } else {
+        lapackPotrs<scalar_t>(uplo, n, nrhs, A_working_ptr, n, b_working_ptr, n, &info);
+      }
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
@@ -319,15 +489,18 @@ static void apply_cholesky(Tensor& self, bool upper, std::vector<int64_t>& infos
   auto batch_size = batchCount(self);
   auto n = self.size(-2);
 
-  int info;
-  for (int64_t i = 0; i < batch_size; i++) {
-    scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
-    lapackCholesky<scalar_t>(uplo, n, self_working_ptr, n, &info);
-    infos[i] = info;
-    if (info != 0) {
-      return;
+  parallel_for(0, batch_size, batchGrainSize(n), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int info;
+      scalar_t* self_working_ptr = &self_data[i * self_matrix_stride];
+      if (n <= kSmallMatrixMaxSize) {
+        smallCholesky<scalar_t>(upper, n, self_working_ptr, &info);
+      } else {
+        lapackCholesky<scalar_t>(uplo, n, self_working_ptr, n, &info);
+      }
+      infos[i] = info;
     }
-  }
+  });
 #endif
 }
 
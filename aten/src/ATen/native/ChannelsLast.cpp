@@ -0,0 +1,64 @@
+#include "ATen/native/ChannelsLast.h"
+
+namespace at { namespace native {
+
+std::vector<int64_t> channels_last_strides(IntList sizes) {
+  AT_CHECK(sizes.size() == 4 || sizes.size() == 5,
+           "channels last tensors must be 4-d or 5-d, got ", sizes.size(), " dimensions");
+  std::vector<int64_t> strides(sizes.size());
+  int64_t stride = 1;
+  strides[1] = stride;
+  stride *= std::max<int64_t>(sizes[1], 1);
+  for (int64_t d = sizes.size() - 1; d >= 2; d--) {
+    strides[d] = stride;
+    stride *= std::max<int64_t>(sizes[d], 1);
+  }
+  strides[0] = stride;
+  return strides;
+}
+
+bool has_channels_last_strides(const Tensor& t) {
+  if (t.dim() != 4 && t.dim() != 5) {
+    return false;
+  }
+  // the strides of dimensions of size 1 don't matter
+  int64_t expected = 1;
+  auto check = [&](int64_t d) {
+    if (t.size(d) == 1) {
+      return true;
+    }
+    if (t.stride(d) != expected) {
+      return false;
+    }
+    expected *= t.size(d);
+    return true;
+  };
+  if (!check(1)) {
+    return false;
+  }
+  for (int64_t d = t.dim() - 1; d >= 2; d--) {
+    if (!check(d)) {
+      return false;
+    }
+  }
+  return check(0);
+}
+
+bool is_channels_last(const Tensor& t) {
+  return has_channels_last_strides(t) && !t.is_contiguous();
+}
+
+Tensor empty_channels_last(IntList sizes, const TensorOptions& options) {
+  return at::empty_strided(sizes, channels_last_strides(sizes), options);
+}
+
+Tensor channels_last_contiguous(const Tensor& t) {
+  if (has_channels_last_strides(t)) {
+    return t;
+  }
+  auto result = empty_channels_last(t.sizes(), t.options());
+  result.copy_(t);
+  return result;
+}
+
+}} // namespace at::native
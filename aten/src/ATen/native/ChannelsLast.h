@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <vector>
+
+// Channels last is the memory layout of an N x C x H x W (or N x C x D x H x W)
+// tensor in which the channels vary fastest, as if it were a contiguous
+// N x H x W x C tensor permuted to N x C x H x W. Images often come in this
+// layout, and cuDNN runs half convolutions of NHWC tensors on Tensor Cores
+// without transposing them.
+//
+// Elementwise ops keep channels last inputs channels last, because
+// TensorIterator allocates their outputs with the strides of the inputs.
+
+namespace at { namespace native {
+
+// Whether t is a 4-d or 5-d tensor laid out channels last. Tensors which are
+// also contiguous, e.g. because they have a single channel, are not.
+CAFFE2_API bool is_channels_last(const Tensor& t);
+
+// Whether the strides of t are those of a channels last tensor, which
+// contiguous tensors with a single channel or a single pixel also have.
+CAFFE2_API bool has_channels_last_strides(const Tensor& t);
+
+// The strides of a channels last tensor of the given sizes.
+CAFFE2_API std::vector<int64_t> channels_last_strides(IntList sizes);
+
+// Allocates a channels last tensor.
+CAFFE2_API Tensor empty_channels_last(IntList sizes, const TensorOptions& options);
+
+// Returns t if it has the strides of a channels last tensor, and a channels
+// last copy of it otherwise.
+CAFFE2_API Tensor channels_last_contiguous(const Tensor& t);
+
+}} // namespace at::native
@@ -1,5 +1,6 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/ChannelsLast.h"
 
 #include "ATen/Config.h"
 
@@ -29,6 +30,7 @@ struct ConvParams {
   bool use_miopen(const at::Tensor& input) const;
   bool use_mkldnn(const at::Tensor& input) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
+  bool is_cpu_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
 std::ostream& operator<<(std::ostream & out, const ConvParams& params) {
@@ -158,6 +160,96 @@ auto ConvParams::is_depthwise(
          weight.size(0) % input.size(1) == 0; // output channels must be a multiple of input channels
 }
 
+// Depthwise convolutions on CPU, of any floating type, that the direct
+// implementation below runs instead of a convolution per group
+auto ConvParams::is_cpu_depthwise(
+        const at::Tensor& input, const at::Tensor& weight) const -> bool {
+  return input.type().backend() == at::Backend::CPU &&
+         at::isFloatingType(input.type().scalarType()) &&
+         !transposed &&
+         input.ndimension() == 4 &&
+         input.size(1) == groups &&
+         groups > 1 &&
+         weight.size(0) % input.size(1) == 0;
+}
+
+// Computes a depthwise convolution as the sum over the kernel positions of
+// the input, shifted by the position, times the weight of the position. This
+// takes a pass over the output per kernel position, vectorized and parallel
+// over the whole batch, instead of an im2col and a GEMM for each channel of
+// each image, and autograd differentiates it without keeping any buffer but
+// the padded input.
+static at::Tensor cpu_depthwise_convolution(
+    const at::Tensor& input_r, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  auto input = input_r;
+  const int64_t batch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t out_channels = weight.size(0);
+  if (out_channels != channels) {
+    // Repeat each channel for each output channel of its group
+    input = input.unsqueeze(2)
+                .expand({batch, channels, out_channels / channels,
+                         input.size(2), input.size(3)})
+                .reshape({batch, out_channels, input.size(2), input.size(3)});
+  }
+  if (params.is_padded()) {
+    input = at::constant_pad_nd(
+        input,
+        {params.padding[1], params.padding[1], params.padding[0], params.padding[0]});
+  }
+  const int64_t kernel_h = weight.size(2);
+  const int64_t kernel_w = weight.size(3);
+  const int64_t output_h =
+      (input.size(2) - params.dilation[0] * (kernel_h - 1) - 1) / params.stride[0] + 1;
+  const int64_t output_w =
+      (input.size(3) - params.dilation[1] * (kernel_w - 1) - 1) / params.stride[1] + 1;
+  AT_CHECK(output_h > 0 && output_w > 0,
+           "Given input size per channel (", input_r.size(2), " x ", input_r.size(3),
+           ") and kernel size (", kernel_h, " x ", kernel_w,
+           "), calculated output size is too small");
+
+  auto output = bias.defined()
+      ? bias.view({1, out_channels, 1, 1})
+            .expand({batch, out_channels, output_h, output_w})
+            .contiguous()
+      : at::zeros({batch, out_channels, output_h, output_w}, input.options());
+  for (int64_t kh = 0; kh < kernel_h; kh++) {
+    for (int64_t kw = 0; kw < kernel_w; kw++) {
+      const int64_t h0 = kh * params.dilation[0];
+      const int64_t w0 = kw * params.dilation[1];
+      auto shifted = input
+          .slice(2, h0, h0 + (output_h - 1) * params.stride[0] + 1, params.stride[0])
+          .slice(3, w0, w0 + (output_w - 1) * params.stride[1] + 1, params.stride[1]);
+      auto weight_k = weight.select(3, kw).select(2, kh).reshape({out_channels, 1, 1});
+      output.addcmul_(shifted, weight_k);
+    }
+  }
+  return output;
+}
+
+// Computes a 1x1 convolution on CPU as a matrix product per image, which
+// reads the inputs where they are instead of unfolding them first
+static at::Tensor cpu_pointwise_convolution(
+    const at::Tensor& input_r, const at::Tensor& weight, const at::Tensor& bias,
+    IntList stride) {
+  auto input = input_r;
+  if (stride[0] != 1 || stride[1] != 1) {
+    input = input.slice(2, 0, input.size(2), stride[0])
+                 .slice(3, 0, input.size(3), stride[1]);
+  }
+  const int64_t batch = input.size(0);
+  const int64_t output_h = input.size(2);
+  const int64_t output_w = input.size(3);
+  auto output = at::matmul(
+      weight.reshape({weight.size(0), weight.size(1)}),
+      input.reshape({batch, input.size(1), output_h * output_w}));
+  if (bias.defined()) {
+    output = output + bias.view({1, weight.size(0), 1});
+  }
+  return output.view({batch, weight.size(0), output_h, output_w});
+}
+
 static void check_input_shape_forward(const at::Tensor& input,
                                       const at::Tensor& weight, const at::Tensor& bias,
                                       int64_t groups, bool transposed) {
@@ -295,7 +387,17 @@ at::Tensor _convolution(
     bool transposed_, IntList output_padding_, int64_t groups_,
     bool benchmark, bool deterministic, bool cudnn_enabled) {
 
-  auto input = input_r.contiguous();
+  if (input_r.type().scalarType() == kBFloat16) {
+    // no convolution backend takes BFloat16, it is convolved in float; the
+    // conversions are differentiable so this also covers the backward
+    return at::_convolution(
+        input_r.toType(kFloat), weight_r.toType(kFloat),
+        bias_r.defined() ? bias_r.toType(kFloat) : bias_r,
+        stride_, padding_, dilation_, transposed_, output_padding_, groups_,
+        benchmark, deterministic, cudnn_enabled).toType(kBFloat16);
+  }
+
+  auto input = input_r;
   auto weight = weight_r;
   auto bias = bias_r;
   auto k = weight.ndimension();
@@ -325,6 +427,15 @@ at::Tensor _convolution(
     weight = view4d(weight);
   }
 
+  // cuDNN runs channels last inputs as they are (see native/cudnn/Conv.cpp),
+  // the other implementations want contiguous ones
+  bool cudnn_channels_last = is_channels_last(input) &&
+      !params.is_depthwise(input, weight) && params.use_cudnn(input) &&
+      detail::getCUDAHooks().versionCuDNN() >= 7000;
+  if (!cudnn_channels_last) {
+    input = input.contiguous();
+  }
+
   auto output = at::empty({0}, input.options());
 
   if (params.is_depthwise(input, weight)) {
@@ -381,6 +492,8 @@ at::Tensor _convolution(
 
     output = at::mkldnn_convolution(input, weight, bias, params.padding, params.stride, params.dilation, params.groups);
 #endif
+  } else if (params.is_cpu_depthwise(input, weight)) {
+    output = cpu_depthwise_convolution(input, weight, bias, params);
   } else {
     if (params.groups == 1) {
       output = at::_convolution_nogroup(
@@ -444,6 +557,10 @@ at::Tensor _convolution_nogroup(
             input, weight, kernel_size, bias,
             stride, padding, dilation);
       } else {  /* dim == 4, non-dilated */
+        if (input.type().backend() == at::Backend::CPU &&
+            kernel_size[0] == 1 && kernel_size[1] == 1 && !params.is_padded()) {
+          return cpu_pointwise_convolution(input, weight, bias, stride);
+        }
         /* CPU implementation has specialized MM kernels
            for non-dilated case here */
         return at::thnn_conv2d(
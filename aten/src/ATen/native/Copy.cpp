@@ -4,6 +4,7 @@
 #include "ATen/CPUApplyUtils.h"
 #include "ATen/Dispatch.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/TensorIterator.h"
 
 namespace {
 
@@ -18,7 +19,7 @@ void _copy__cpu(at::Tensor& self, const at::Tensor& src) {
 
 template <typename self_T>
 void _copy__cpu(at::Tensor& self, const at::Tensor& src) {
-  AT_DISPATCH_ALL_TYPES_AND_HALF(
+  AT_DISPATCH_ALL_TYPES_AND_HALF_AND_BFLOAT16(
       src.type(), "_copy__cpu", [&]() { _copy__cpu<self_T, scalar_t>(self, src); });
 }
 
@@ -28,10 +29,25 @@ namespace at {
 namespace native {
 
 Tensor& _copy__cpu(Tensor& self, const Tensor& src) {
-  AT_DISPATCH_ALL_TYPES_AND_HALF(
+  // copy_ has already expanded src to the shape of self. Tensors that only
+  // have the same number of elements are copied in the order of their
+  // elements, which TensorIterator doesn't do.
+  if (self.sizes().equals(src.sizes())) {
+    auto builder = TensorIterator::Builder();
+    builder.add_output(self);
+    builder.add_input(src);
+    builder.dont_resize_outputs();
+    builder.dont_compute_common_dtype();
+    auto iter = builder.build();
+    copy_stub(kCPU, *iter);
+    return self;
+  }
+  AT_DISPATCH_ALL_TYPES_AND_HALF_AND_BFLOAT16(
       self.type(), "_copy__cpu", [&]() { ::_copy__cpu<scalar_t>(self, src); });
   return self;
 }
 
+DEFINE_DISPATCH(copy_stub);
+
 } // namespace native
 } // namespace at
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "ATen/ATen.h"
+#include "ATen/native/DispatchStub.h"
 
 namespace at {
+struct TensorIterator;
+
 namespace native {
 
 // Note [Implicit conversion between signed and unsigned]
@@ -43,5 +46,11 @@ struct inter_copy_type<uint8_t> {
 template <typename T>
 using inter_copy_type_t = typename inter_copy_type<T>::type;
 
+// The iterator operands are the destination and the source, of the same
+// shape but possibly of different types.
+using copy_fn = void(*)(TensorIterator&);
+
+DECLARE_DISPATCH(copy_fn, copy_stub);
+
 } // namespace native
 } // namespace at
@@ -11,6 +11,9 @@ namespace at { namespace native {
 static CPUCapability compute_cpu_capability() {
   auto envar = std::getenv("ATEN_CPU_CAPABILITY");
   if (envar) {
+    if (strcmp(envar, "avx512") == 0) {
+      return CPUCapability::AVX512;
+    }
     if (strcmp(envar, "avx2") == 0) {
       return CPUCapability::AVX2;
     }
@@ -25,7 +28,15 @@ static CPUCapability compute_cpu_capability() {
 
 #ifndef __powerpc__
   if (cpuinfo_initialize()) {
-    if (cpuinfo_has_x86_avx2() && cpuinfo_has_x86_fma3()) {
+    // The AVX512 kernels are compiled for the Skylake-SP subset. Both them
+    // and the AVX2 kernels convert Half values with F16C.
+    if (cpuinfo_has_x86_avx512f() && cpuinfo_has_x86_avx512dq() &&
+        cpuinfo_has_x86_avx512vl() && cpuinfo_has_x86_avx512bw() &&
+        cpuinfo_has_x86_fma3() && cpuinfo_has_x86_f16c()) {
+      return CPUCapability::AVX512;
+    }
+    if (cpuinfo_has_x86_avx2() && cpuinfo_has_x86_fma3() &&
+        cpuinfo_has_x86_f16c()) {
       return CPUCapability::AVX2;
     }
     if (cpuinfo_has_x86_avx()) {
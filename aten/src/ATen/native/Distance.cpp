@@ -4,6 +4,10 @@
 
 #include <ATen/native/Distance.h>
 
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
 namespace at { namespace native {
 
 DEFINE_DISPATCH(pdist_forward_stub);
@@ -13,6 +17,83 @@ Tensor pairwise_distance(const Tensor& x1, const Tensor& x2, double p, double ep
   return at::norm(x1 - x2 + eps, p, 1, keepdim);
 }
 
+// The rows of x1 are processed in blocks, so that the intermediate tensors
+// of a block with all the rows of x2 hold at most this many elements
+constexpr int64_t kCdistBlockElements = 1 << 22;
+
+static void check_cdist(const char* name, const Tensor& x1, const Tensor& x2, const double p) {
+  AT_CHECK(x1.dim() == 2 && x2.dim() == 2,
+      name, " only supports 2D tensors, got: ", x1.dim(), "D and ", x2.dim(), "D");
+  AT_CHECK(x1.size(1) == x2.size(1),
+      name, " expects the rows of x1 and x2 to have the same size, got: ", x1.size(1), " and ", x2.size(1));
+  AT_CHECK(at::isFloatingType(x1.type().scalarType()) && x1.type() == x2.type(),
+      name, " only supports floating-point dtypes, with x1 and x2 of the same type");
+  AT_CHECK(p >= 0, name, " only supports non-negative p values");
+}
+
+// ||x1 - x2||^2 = ||x1||^2 + ||x2||^2 - 2 x1 x2^T, with a single GEMM. The
+// difference cancels for close rows, so the distances of nearly equal rows
+// are less accurate than with the direct computation.
+static Tensor cdist_euclidean(const Tensor& x1, const Tensor& x2) {
+  Tensor x1_norm = x1.pow(2).sum(1, /*keepdim=*/true);
+  Tensor x2_norm = x2.pow(2).sum(1, /*keepdim=*/true);
+  Tensor squared = at::addmm(x2_norm.t(), x1, x2.t(), /*beta=*/1, /*alpha=*/-2).add(x1_norm);
+  return squared.clamp_min(0).sqrt();
+}
+
+static Tensor cdist_blocked(const Tensor& x1, const Tensor& x2, const double p) {
+  const int64_t n = x2.size(0) * x2.size(1);
+  const int64_t block_rows = std::max<int64_t>(1, kCdistBlockElements / std::max<int64_t>(n, 1));
+  if (block_rows >= x1.size(0)) {
+    return (x1.unsqueeze(1) - x2.unsqueeze(0)).norm(p, 2);
+  }
+  std::vector<Tensor> blocks;
+  for (int64_t row = 0; row < x1.size(0); row += block_rows) {
+    blocks.push_back((x1.slice(0, row, row + block_rows).unsqueeze(1) - x2.unsqueeze(0)).norm(p, 2));
+  }
+  return at::cat(blocks, 0);
+}
+
+Tensor cdist(const Tensor& x1, const Tensor& x2, const double p) {
+  check_cdist("cdist", x1, x2, p);
+  if (x1.size(0) == 0 || x2.size(0) == 0 || x1.size(1) == 0) {
+    return at::zeros({x1.size(0), x2.size(0)}, x1.options());
+  }
+  if (p == 2) {
+    return cdist_euclidean(x1, x2);
+  }
+  return cdist_blocked(x1, x2, p);
+}
+
+// The distances to a block of rows of x2 at a time, keeping the k smallest
+// (or largest) of each row of x1 seen so far, so that the whole distance
+// matrix is never held
+std::tuple<Tensor, Tensor> cdist_topk(const Tensor& x1, const Tensor& x2, int64_t k, const double p, bool largest) {
+  check_cdist("cdist_topk", x1, x2, p);
+  AT_CHECK(k >= 0 && k <= x2.size(0),
+      "cdist_topk expects k to be between 0 and the number of rows of x2, got: ", k);
+  const int64_t n = x1.size(0) * std::max<int64_t>(x1.size(1), 1);
+  const int64_t block_rows = std::max<int64_t>(
+      std::max<int64_t>(k, 1), kCdistBlockElements / std::max<int64_t>(n, 1));
+  Tensor values, indices;
+  for (int64_t row = 0; row < x2.size(0) || !values.defined(); row += block_rows) {
+    Tensor distances = at::cdist(x1, x2.slice(0, row, row + block_rows), p);
+    Tensor block_values, block_indices;
+    std::tie(block_values, block_indices) = distances.topk(
+        std::min(k, distances.size(1)), 1, largest, /*sorted=*/true);
+    block_indices.add_(row);
+    if (!values.defined()) {
+      values = block_values;
+      indices = block_indices;
+      continue;
+    }
+    Tensor order;
+    std::tie(values, order) = at::cat({values, block_values}, 1).topk(k, 1, largest, /*sorted=*/true);
+    indices = at::cat({indices, block_indices}, 1).gather(1, order);
+  }
+  return std::make_tuple(values, indices);
+}
+
 // This is to guarantee that the contiguous memory is passed to the backward pass
 Tensor pdist(const Tensor& self, const double p) {
   AT_CHECK(self.dim() == 2,
@@ -4,6 +4,7 @@
 #include "ATen/Dispatch.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include "c10/util/Exception.h"
 
 #include "ATen/CPUGenerator.h"
@@ -11,10 +12,14 @@
 #include "ATen/core/Generator.h"
 #include "ATen/native/Distributions.h"
 #include "ATen/native/DispatchStub.h"
+#include "ATen/native/Philox.h"
 #include "ATen/native/cpu/UnaryOpsKernel.h"
 
 #include <type_traits>
 #include <functional>
+#include <limits>
+#include <tuple>
+#include <vector>
 #include <assert.h>
 #include <cpuinfo.h>
 
@@ -125,27 +130,48 @@ Tensor& bernoulli_out(Tensor& result, const Tensor& self, Generator* gen) {
   return result.resize_(self.sizes()).bernoulli_(self, gen);
 }
 
+// Draws the seed of a Philox stream from the generator, which is only locked
+// for that, and then samples the elements of self in parallel, each from the
+// number of the stream at its offset in self, so that the result does not
+// depend on the number of threads. sample(i, uniform) returns element i
+// given a uniform double in [0, 1).
+template <typename scalar_t, typename Sample>
+static void philox_sample(Tensor& self, Generator* gen, const Sample& sample) {
+  THGenerator* generator = get_generator(gen);
+  uint64_t seed;
+  {
+    std::lock_guard<std::mutex> lock(generator->mutex);
+    seed = THRandom_random64(generator);
+  }
+  Tensor result = self.is_contiguous() ? self : at::empty(self.sizes(), self.options());
+  scalar_t* result_data = result.data<scalar_t>();
+  parallel_for(0, result.numel(), /* grain_size= */ 800, [&](int64_t begin, int64_t end) {
+    Philox4x32 philox(seed, begin);
+    for (int64_t i = begin; i < end; i++) {
+      result_data[i] = sample(i, Philox4x32::uniform_double(philox()));
+    }
+  });
+  if (!result.is_same(self)) {
+    self.copy_(result);
+  }
+}
+
 Tensor& bernoulli_tensor_cpu_(Tensor& self, const Tensor& p_, Generator* gen) {
   AT_DISPATCH_ALL_TYPES(self.type(), "bernoulli_tensor_cpu_self_", [&] {
-    THGenerator* generator = get_generator(gen);
-    std::lock_guard<std::mutex> lock(generator->mutex);
     using self_t = scalar_t;
-    if (p_.type().scalarType() == kDouble) {
-      auto p = std::get<0>(expand_inplace(self, p_.to(kCPU)));
-      CPU_tensor_apply2<self_t, double>(
-        self, p, [generator](self_t& ret_val, double& p_val) {
-          ret_val = static_cast<self_t>(THRandom_bernoulli(generator, p_val));
-        });
-    } else {
-      AT_DISPATCH_FLOATING_TYPES(p_.type(), "bernoulli_tensor_cpu_p_", [&] {
-        auto p = std::get<0>(expand_inplace(self, p_.to(kCPU)));
-        using p_t = scalar_t;
-        CPU_tensor_apply2<self_t, p_t>(
-          self, p, [generator](self_t& ret_val, p_t& p_val) {
-            ret_val = static_cast<self_t>(THRandom_bernoulliFloat(generator, static_cast<p_t>(p_val)));
-          });
+    AT_DISPATCH_FLOATING_TYPES(p_.type(), "bernoulli_tensor_cpu_p_", [&] {
+      using p_t = scalar_t;
+      auto p = std::get<0>(expand_inplace(self, p_.to(kCPU))).contiguous();
+      const p_t* p_data = p.data<p_t>();
+      // written so that NaN fails the check too
+      for (int64_t i = 0; i < p.numel(); i++) {
+        AT_CHECK(0 <= p_data[i] && p_data[i] <= 1,
+                 "bernoulli_ expects all elements of p to be in [0, 1], but got p=", p_data[i]);
+      }
+      philox_sample<self_t>(self, gen, [p_data](int64_t i, double uniform) {
+        return static_cast<self_t>(uniform < p_data[i]);
       });
-    }
+    });
   });
   return self;
 }
@@ -161,12 +187,9 @@ Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   }
 #endif
   AT_DISPATCH_ALL_TYPES(self.type(), "bernoulli_scalar_cpu_", [&] {
-    THGenerator* generator = get_generator(gen);
-    std::lock_guard<std::mutex> lock(generator->mutex);
-    CPU_tensor_apply1<scalar_t>(
-        self, [generator, p](scalar_t& ret_val) {
-          ret_val = static_cast<scalar_t>(THRandom_bernoulli(generator, p));
-        });
+    philox_sample<scalar_t>(self, gen, [p](int64_t i, double uniform) {
+      return static_cast<scalar_t>(uniform < p);
+    });
   });
   return self;
 }
@@ -224,4 +247,89 @@ Tensor _s_gamma_cpu(const Tensor& alpha, Generator *gen) {
   return ret;
 }
 
+// Vose's alias method: category i is drawn by picking a column k uniformly,
+// and then keeping k with probability q[k], or else taking its alias J[k].
+// The table is built on the CPU in O(number of categories) and copied to
+// the device of probs.
+std::tuple<Tensor, Tensor> _multinomial_alias_setup(const Tensor& probs) {
+  AT_CHECK(probs.dim() == 1, "_multinomial_alias_setup expects a 1-D tensor of probabilities, but got ",
+           probs.dim(), " dimensions");
+  AT_CHECK(at::isFloatingType(probs.type().scalarType()),
+           "_multinomial_alias_setup expects floating point probabilities, but got ", probs.type().toString());
+  const int64_t K = probs.numel();
+  AT_CHECK(K > 0 && K <= std::numeric_limits<uint32_t>::max(),
+           "_multinomial_alias_setup expects between 1 and 2^32 - 1 categories, but got ", K);
+  auto probs_cpu = probs.to(kCPU, kDouble).contiguous();
+  const double* p = probs_cpu.data<double>();
+  double sum = 0;
+  for (int64_t i = 0; i < K; i++) {
+    AT_CHECK(p[i] >= 0 && std::isfinite(p[i]),
+             "_multinomial_alias_setup expects finite non-negative probabilities, but got ", p[i]);
+    sum += p[i];
+  }
+  AT_CHECK(sum > 0, "_multinomial_alias_setup expects probabilities with a positive sum");
+
+  auto q = at::empty({K}, probs_cpu.options());
+  auto J = at::empty({K}, probs_cpu.options().dtype(kLong));
+  double* q_data = q.data<double>();
+  int64_t* J_data = J.data<int64_t>();
+  std::vector<int64_t> small, large;
+  for (int64_t i = 0; i < K; i++) {
+    q_data[i] = p[i] * K / sum;
+    J_data[i] = i;
+    (q_data[i] < 1 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    const int64_t s = small.back();
+    const int64_t l = large.back();
+    small.pop_back();
+    large.pop_back();
+    J_data[s] = l;
+    q_data[l] -= 1 - q_data[s];
+    (q_data[l] < 1 ? small : large).push_back(l);
+  }
+  // what is left is 1 up to the rounding errors
+  for (int64_t i : small) {
+    q_data[i] = 1;
+  }
+  for (int64_t i : large) {
+    q_data[i] = 1;
+  }
+  return std::make_tuple(
+      q.to(probs.device(), probs.type().scalarType()), J.to(probs.device()));
+}
+
+Tensor _multinomial_alias_draw_cpu(const Tensor& q, const Tensor& J, int64_t num_samples, Generator* gen) {
+  AT_CHECK(q.dim() == 1 && J.dim() == 1 && q.numel() == J.numel() && q.numel() > 0,
+           "_multinomial_alias_draw expects the 1-D tables of _multinomial_alias_setup");
+  AT_CHECK(J.type().scalarType() == kLong, "_multinomial_alias_draw expects J to be a LongTensor");
+  AT_CHECK(num_samples >= 0, "_multinomial_alias_draw expects a non-negative number of samples, but got ",
+           num_samples);
+  THGenerator* generator = get_generator(gen);
+  uint64_t seed;
+  {
+    std::lock_guard<std::mutex> lock(generator->mutex);
+    seed = THRandom_random64(generator);
+  }
+  const uint64_t K = q.numel();
+  auto result = at::empty({num_samples}, J.options());
+  auto J_contig = J.contiguous();
+  const int64_t* J_data = J_contig.data<int64_t>();
+  int64_t* result_data = result.data<int64_t>();
+  AT_DISPATCH_FLOATING_TYPES(q.type(), "_multinomial_alias_draw", [&] {
+    auto q_contig = q.contiguous();
+    const scalar_t* q_data = q_contig.data<scalar_t>();
+    // two numbers of the stream per sample
+    parallel_for(0, num_samples, /* grain_size= */ 800, [&](int64_t begin, int64_t end) {
+      Philox4x32 philox(seed, 2 * begin);
+      for (int64_t i = begin; i < end; i++) {
+        const int64_t k = (static_cast<uint64_t>(philox()) * K) >> 32;
+        const double uniform = Philox4x32::uniform_double(philox());
+        result_data[i] = uniform < q_data[k] ? k : J_data[k];
+      }
+    });
+  });
+  return result;
+}
+
 }} // namespace at::native
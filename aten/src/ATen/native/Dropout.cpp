@@ -1,5 +1,9 @@
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/FusedDropout.h"
+
+#include <cmath>
 
 namespace at { namespace native {
 
@@ -78,6 +82,54 @@ ALIAS_SPECIALIZATION(_feature_dropout,       true,  false)
 ALIAS_SPECIALIZATION(_alpha_dropout,         false, true )
 ALIAS_SPECIALIZATION(_feature_alpha_dropout, true,  true )
 
+// Packs a contiguous mask of zeros and ones, one byte per element, into bits
+Tensor pack_mask(const Tensor& keep) {
+  const int64_t numel = keep.numel();
+  auto mask = at::empty({packed_mask_size(numel)}, keep.options());
+  const uint8_t* keep_data = keep.data<uint8_t>();
+  uint8_t* mask_data = mask.data<uint8_t>();
+  parallel_for(0, mask.numel(), internal::GRAIN_SIZE / 8, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t bits = std::min<int64_t>(8, numel - 8 * i);
+      uint8_t byte = 0;
+      for (int64_t j = 0; j < bits; j++) {
+        byte |= keep_data[8 * i + j] << j;
+      }
+      mask_data[i] = byte;
+    }
+  });
+  return mask;
+}
+
+Tensor fused_activation(const Tensor& x, FusedActivation activation) {
+  switch (activation) {
+    case FusedActivation::ReLU:
+      return x.relu();
+    case FusedActivation::GELU:
+      return x * (x * M_SQRT1_2).erf_().add_(1).mul_(0.5);
+    default:
+      return x;
+  }
+}
+
+// The derivative of fused_activation at x, for the activations other than None
+Tensor fused_activation_derivative(const Tensor& x, FusedActivation activation) {
+  if (activation == FusedActivation::ReLU) {
+    return (x > 0).type_as(x);
+  }
+  // Phi(x) + x * phi(x)
+  auto pdf = (x * x).mul_(-0.5).exp_().mul_(0.5 * M_2_SQRTPI * M_SQRT1_2);
+  return (x * M_SQRT1_2).erf_().add_(1).mul_(0.5).addcmul_(x, pdf);
+}
+
+// Samples the mask of a fused dropout of self, returning self * mask / p and
+// the packed mask
+std::tuple<Tensor, Tensor> fused_dropout_cpu_impl(const Tensor& self, double p, Generator* gen) {
+  auto keep = at::empty(self.sizes(), self.options().dtype(kByte)).bernoulli_(p, gen);
+  return std::make_tuple(self * keep.type_as(self).mul_(1. / p), pack_mask(keep));
+}
+
+
 } // anomymous namepsace
 
 Tensor dropout(const Tensor& input, double p, bool train) {
@@ -115,4 +167,56 @@ Tensor& feature_alpha_dropout_(Tensor& input, double p, bool train) {
   return _feature_alpha_dropout<true>(input, p, train);
 }
 
+// The CPU versions of the fused dropouts only fuse the mask: they are there
+// for the CUDA kernels to be checked against and used the same way.
+std::tuple<Tensor, Tensor> fused_dropout_add_cpu(const Tensor& self, const Tensor& residual, double p, Generator* gen) {
+  check_fused_dropout_args(self, p);
+  AT_CHECK(residual.sizes() == self.sizes() && residual.type() == self.type(),
+           "expected a residual of type ", self.type(), " and sizes ", self.sizes(),
+           " but got ", residual.type(), " of sizes ", residual.sizes());
+  auto result = fused_dropout_cpu_impl(self, p, gen);
+  std::get<0>(result).add_(residual);
+  return result;
+}
+
+std::tuple<Tensor, Tensor> fused_bias_activation_dropout_cpu(
+    const Tensor& self, const Tensor& bias, int64_t activation, double p, Generator* gen) {
+  check_fused_dropout_args(self, p);
+  check_fused_bias(self, bias);
+  return fused_dropout_cpu_impl(
+      fused_activation(self + bias, check_fused_activation(activation)), p, gen);
+}
+
+Tensor fused_bias_activation_dropout_backward_cpu(
+    const Tensor& grad, const Tensor& self, const Tensor& bias, const Tensor& mask,
+    int64_t activation, double p) {
+  check_fused_bias(self, bias);
+  AT_CHECK(grad.sizes() == self.sizes(), "expected a gradient of sizes ", self.sizes(), " but got ", grad.sizes());
+  auto act = check_fused_activation(activation);
+  auto grad_input = at::_packed_masked_scale(grad, mask, 1. / p);
+  if (act != FusedActivation::None) {
+    grad_input.mul_(fused_activation_derivative(self + bias, act));
+  }
+  return grad_input;
+}
+
+Tensor packed_masked_scale_cpu(const Tensor& self, const Tensor& mask, double scale) {
+  check_packed_mask(self, mask);
+  auto src = self.contiguous();
+  auto mask_ = mask.contiguous();
+  auto ret = at::empty_like(src);
+  AT_DISPATCH_FLOATING_TYPES(ret.type(), "packed_masked_scale", [&] {
+    const scalar_t* src_data = src.data<scalar_t>();
+    const uint8_t* mask_data = mask_.data<uint8_t>();
+    scalar_t* ret_data = ret.data<scalar_t>();
+    const scalar_t scale_ = static_cast<scalar_t>(scale);
+    parallel_for(0, ret.numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        ret_data[i] = src_data[i] * (((mask_data[i >> 3] >> (i & 7)) & 1) ? scale_ : scalar_t(0));
+      }
+    });
+  });
+  return ret;
+}
+
 }} // namespace at::native
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <memory>
 #include <sstream>
+#include <tuple>
 #include <vector>
 
 #ifdef _OPENMP
@@ -75,9 +76,14 @@ Tensor embedding_sparse_backward(
                                          weight_size);
   }
 
-  auto index = indices.reshape({1, -1});
-  auto values = grad.reshape({-1, num_features});
-  return at::_sparse_coo_tensor_unsafe(index, values, weight_size);
+  // The gradient is row-sparse: one row of values per distinct index, summed
+  // over its occurrences. Building it coalesced saves optimizers (and the
+  // accumulation of gradients) from sorting and reducing the duplicates.
+  Tensor rows, inverse;
+  std::tie(rows, inverse) = at::_unique(indices.reshape(-1), /*sorted=*/true, /*return_inverse=*/true);
+  auto values = at::zeros({rows.numel(), num_features}, dense_options)
+      .index_add_(0, inverse, grad.reshape({-1, num_features}));
+  return at::_sparse_coo_tensor_unsafe(rows.reshape({1, -1}), values, weight_size)._coalesced_(true);
 }
 
 Tensor embedding_dense_backward_cpu(
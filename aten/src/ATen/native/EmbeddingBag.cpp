@@ -1,9 +1,16 @@
 #include "ATen/ATen.h"
+#include "ATen/Config.h"
+#include "ATen/Parallel.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
 
 #include "TH/THBlasUtils.h"
 
+#if AT_CAFFE2_PERFKERNELS_ENABLED()
+#include <caffe2/perfkernels/embedding_lookup.h>
+#endif
+
+#include <climits>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -23,39 +30,184 @@ namespace {
 namespace at {
 namespace native {
 
-static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
-                            Tensor &offset2bag) {
+static Tensor make_offset2bag(const Tensor &offsets, const Tensor &indices) {
+  // If the last entries are empty, that the last offsets are irrelevant as they
+  // won't change anything in the assignment of ID -> bag, but index_add would
+  // throw out of bounds error. So to keep it simple we just add one more
+  // entry to the end then get rid of it after computing offset2bag.
+  auto offset2bag = at::zeros(
+     {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
   offset2bag.index_add_(
       0, offsets, at::ones_like(offsets)); // offset2bag = [1 0 1 0 1]
   offset2bag[0] -= 1;                     // offset2bag = [0 0 1 0 1]
   offset2bag = offset2bag.cumsum(0);     // offset2bag = [0 0 1 1 2]
+  return offset2bag.narrow(0, 0, indices.sizes()[0]);
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
+// The number of indices in every bag, as the perfkernels take them
+static std::vector<int> make_bag_lengths(const Tensor &offsets, const Tensor &indices) {
+  auto offsets_data = offsets.data<int64_t>();
+  int64_t num_bags = offsets.size(0);
+  int64_t numel = indices.numel();
+  std::vector<int> lengths(num_bags);
+  for (int64_t bag = 0; bag < num_bags; bag++) {
+    int64_t begin = offsets_data[bag];
+    int64_t end = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+    AT_CHECK(0 <= begin && begin <= end && end <= numel,
+             "embedding_bag: offsets must be non-decreasing and within the bounds of indices, but bag ",
+             bag, " spans [", begin, ", ", end, ") with ", numel, " indices");
+    AT_CHECK(end - begin <= INT_MAX, "embedding_bag: bag ", bag, " is too large");
+    lengths[bag] = end - begin;
+  }
+  return lengths;
+}
+
+// Runs f(start, end) over the bags in parallel. The work per bag is about the
+// average number of indices per bag times the embedding dimension.
+template <typename F>
+static void parallel_for_bags(const Tensor &offsets, const Tensor &indices,
+                              int64_t ddim, const F& f) {
+  int64_t num_bags = offsets.size(0);
+  int64_t work_per_bag = std::max<int64_t>(1, indices.numel() * ddim / std::max<int64_t>(1, num_bags));
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / work_per_bag);
+  parallel_for(0, num_bags, grain_size, f);
+}
+
+// Sums the rows of src selected by the indices of every bag into its row of
+// output, and averages them for MODE_MEAN (empty bags stay all 0s).
 template<typename T>
-static void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output) {
-  auto add_indices_data = add_indices.data<int64_t>();
-  auto select_indices_data = select_indices.data<int64_t>();
+static void embedding_bag_sum_generic(const Tensor &src, const Tensor &indices,
+                                      const Tensor &offsets, const std::vector<int> &lengths,
+                                      const int64_t mode, Tensor &output) {
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
   auto src_data = src.data<T>();
   auto output_data = output.data<T>();
-  auto numel = add_indices.numel();
+  int64_t num_weights = src.size(0);
   int64_t ddim = src.size(1);
   auto src_stride0 = src.stride(0);
   auto src_stride1 = src.stride(1);
   auto output_stride0 = output.stride(0);
   auto output_stride1 = output.stride(1);
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
+  parallel_for_bags(offsets, indices, ddim, [&](int64_t start, int64_t end) {
+    for (int64_t bag = start; bag < end; bag++) {
+      T* out = output_data + output_stride0 * bag;
+      for (int64_t i = offsets_data[bag]; i < offsets_data[bag] + lengths[bag]; i++) {
+        int64_t idx = indices_data[i];
+        AT_CHECK(0 <= idx && idx < num_weights,
+                 "embedding_bag: index ", idx, " is out of range for ", num_weights, " embeddings");
+        THBlas_axpy<T>(ddim, 1, src_data + src_stride0 * idx, src_stride1,
+                       out, output_stride1);
+      }
+      if (mode == MODE_MEAN && lengths[bag] > 0) {
+        T scale = T(1) / lengths[bag];
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d * output_stride1] *= scale;
+        }
+      }
+    }
+  });
+}
+
+template<typename T>
+static void embedding_bag_sum(const Tensor &src, const Tensor &indices,
+                              const Tensor &offsets, const std::vector<int> &lengths,
+                              const int64_t mode, Tensor &output) {
+  embedding_bag_sum_generic<T>(src, indices, offsets, lengths, mode, output);
+}
+
+#if AT_CAFFE2_PERFKERNELS_ENABLED()
+// Embeddings with contiguous rows go through the caffe2 perfkernels, which are
+// vectorized (AVX2 when available), check the indices and sum into a
+// contiguous float output.
+template<typename T>
+static void embedding_bag_sum_lookup(const Tensor &src, const Tensor &indices,
+                                     const Tensor &offsets, const std::vector<int> &lengths,
+                                     const int64_t mode, Tensor &output) {
+  int64_t ddim = src.size(1);
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  auto src_data = src.data<T>();
+  auto output_data = output.data<float>();
+  int64_t num_weights = src.size(0);
+  parallel_for_bags(offsets, indices, ddim, [&](int64_t start, int64_t end) {
+    int64_t index_begin = offsets_data[start];
+    int64_t index_size = 0;
+    for (int64_t bag = start; bag < end; bag++) {
+      index_size += lengths[bag];
+    }
+    caffe2::EmbeddingLookup<int64_t, T, float, false>(
+        ddim, end - start, index_size, num_weights, src_data,
+        indices_data + index_begin, lengths.data() + start,
+        /*weights=*/nullptr, /*scale_bias=*/nullptr,
+        /*normalize_by_lengths=*/mode == MODE_MEAN,
+        output_data + ddim * start);
+  });
+}
+
+template<>
+void embedding_bag_sum<float>(const Tensor &src, const Tensor &indices,
+                              const Tensor &offsets, const std::vector<int> &lengths,
+                              const int64_t mode, Tensor &output) {
+  int64_t ddim = src.size(1);
+  if (!(src.stride(1) == 1 && src.stride(0) == ddim && output.is_contiguous())) {
+    return embedding_bag_sum_generic<float>(src, indices, offsets, lengths, mode, output);
   }
+  embedding_bag_sum_lookup<float>(src, indices, offsets, lengths, mode, output);
+}
+
+// Half embeddings are read as Half and summed in float.
+template<>
+void embedding_bag_sum<at::Half>(const Tensor &src, const Tensor &indices,
+                                 const Tensor &offsets, const std::vector<int> &lengths,
+                                 const int64_t mode, Tensor &output) {
+  auto output_float = at::zeros(output.sizes(), output.type().toScalarType(kFloat));
+  embedding_bag_sum_lookup<at::Half>(src.contiguous(), indices, offsets, lengths, mode, output_float);
+  output.copy_(output_float);
 }
 
+#else
+
+// Without the caffe2 perfkernels (BUILD_ATEN_ONLY), Half embeddings are
+// summed in float by a plain loop.
+template<>
+void embedding_bag_sum<at::Half>(const Tensor &src, const Tensor &indices,
+                                 const Tensor &offsets, const std::vector<int> &lengths,
+                                 const int64_t mode, Tensor &output) {
+  auto output_float = at::zeros(output.sizes(), output.type().toScalarType(kFloat));
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  auto src_data = src.data<at::Half>();
+  auto output_data = output_float.data<float>();
+  int64_t num_weights = src.size(0);
+  int64_t ddim = src.size(1);
+  auto src_stride0 = src.stride(0);
+  auto src_stride1 = src.stride(1);
+  parallel_for_bags(offsets, indices, ddim, [&](int64_t start, int64_t end) {
+    for (int64_t bag = start; bag < end; bag++) {
+      float* out = output_data + ddim * bag;
+      for (int64_t i = offsets_data[bag]; i < offsets_data[bag] + lengths[bag]; i++) {
+        int64_t idx = indices_data[i];
+        AT_CHECK(0 <= idx && idx < num_weights,
+                 "embedding_bag: index ", idx, " is out of range for ", num_weights, " embeddings");
+        const at::Half* row = src_data + src_stride0 * idx;
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d] += static_cast<float>(row[d * src_stride1]);
+        }
+      }
+      if (mode == MODE_MEAN && lengths[bag] > 0) {
+        float scale = 1.f / lengths[bag];
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d] *= scale;
+        }
+      }
+    }
+  });
+  output.copy_(output_float);
+}
+
+#endif // AT_CAFFE2_PERFKERNELS_ENABLED()
+
 static void make_bag_size(const Tensor &offsets, const Tensor &indices,
                           const int64_t mode, Tensor &bag_size) {
   if (mode == MODE_MEAN || mode == MODE_MAX) {
@@ -69,26 +221,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = indices.size(0);
-      output /= bag_size_;
-    } else {
-      // Avoid dividing by 0 for empty bags.
-      // Instead we want empty bags to return all 0s
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .toType(output.type())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -171,33 +303,28 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
   checkScalarType("embedding_bag", indices_arg, kLong);
   auto weight_arg = TensorArg(weight, "weight", 1);
-  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble, kHalf});
 
   auto bag_size = at::zeros(offsets.sizes(), indices.type());
   make_bag_size(offsets, indices, mode, bag_size);
 
-  // If the last entries are empty, that the last offsets are irrelevant as they
-  // won't change anything in the assignment of ID -> bag, but index_add would
-  // throw out of bounds error. So to keep it simple we just add one more
-  // entry to the end then get rid of it after make_offset2bag.
-  auto offset2bag = at::zeros(
-     {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-  make_offset2bag(offsets, indices, offset2bag);
-
-  offset2bag.resize_({indices.sizes()[0]});
-
   auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
+    auto lengths = make_bag_lengths(offsets, indices);
     if (weight.type().scalarType() == kFloat) {
-      index_select_add<float>(indices, offset2bag, weight, output);
+      embedding_bag_sum<float>(weight, indices, offsets, lengths, mode, output);
     } else if (weight.type().scalarType() == kDouble) {
-      index_select_add<double>(indices, offset2bag, weight, output);
+      embedding_bag_sum<double>(weight, indices, offsets, lengths, mode, output);
+    } else if (weight.type().scalarType() == kHalf) {
+      embedding_bag_sum<at::Half>(weight, indices, offsets, lengths, mode, output);
     }
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    // The sums are computed per bag, so offset2bag is only needed by the
+    // backward, which computes it from the offsets when it's empty.
+    auto offset2bag = at::empty({0}, indices.options());
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
+    auto offset2bag = make_offset2bag(offsets, indices);
     return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.type(), "embedding_bag_cpu_max", [&]() {
         return embedding_bag_cpu_max<scalar_t>(weight, indices, offset2bag, output, bag_size, offsets);
@@ -210,7 +337,7 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
 // See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
 Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
                               const Tensor &offsets,
-                              const Tensor &offset2bag,
+                              const Tensor &offset2bag_,
                               const Tensor &bag_size_,
                               const Tensor &max_indices_,
                               int64_t num_weights,
@@ -222,6 +349,12 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
   checkScalarType("embedding_bag", offsets_arg, kLong);
   checkContiguous("embedding_bag", offsets_arg);
+
+  // The CPU forward of the sum and mean modes doesn't compute offset2bag
+  Tensor offset2bag = offset2bag_;
+  if (offset2bag.numel() == 0 && indices.numel() != 0) {
+    offset2bag = make_offset2bag(offsets, indices);
+  }
   auto offset2bag_arg = TensorArg(offset2bag, "offset2bag", 1);
   checkScalarType("embedding_bag", offset2bag_arg, kLong);
   checkContiguous("embedding_bag", offset2bag_arg);
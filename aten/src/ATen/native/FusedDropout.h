@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <cstdint>
+
+namespace at { namespace native {
+
+// The activation applied by _fused_bias_activation_dropout, to x + bias,
+// before the dropout. It is passed as an int64_t through the native
+// function, like the reductions are.
+enum class FusedActivation : int64_t {
+  None = 0,
+  ReLU = 1,
+  GELU = 2, // x * Phi(x), with the erf form of the normal CDF Phi
+};
+
+// The kernels of the fused dropouts keep one bit of mask per element instead
+// of a byte: bit j of byte i is the mask of element 8 * i + j of the
+// (contiguous) input.
+static inline int64_t packed_mask_size(int64_t numel) {
+  return (numel + 7) / 8;
+}
+
+static inline FusedActivation check_fused_activation(int64_t activation) {
+  AT_CHECK(activation >= static_cast<int64_t>(FusedActivation::None) &&
+           activation <= static_cast<int64_t>(FusedActivation::GELU),
+           "unknown activation ", activation, " for a fused dropout");
+  return static_cast<FusedActivation>(activation);
+}
+
+static inline void check_fused_dropout_args(const Tensor& self, double p) {
+  AT_CHECK(p > 0 && p <= 1, "fused dropout expects a probability to keep an element in (0, 1], but got ", p);
+  AT_CHECK(self.is_floating_point(), "fused dropout expects a floating point input, but got ", self.type());
+}
+
+static inline void check_fused_bias(const Tensor& self, const Tensor& bias) {
+  AT_CHECK(self.dim() > 0 && bias.dim() == 1 && bias.size(0) == self.size(-1),
+           "expected a bias of size ", self.dim() > 0 ? self.size(-1) : 1,
+           " for the last dimension of the input, but got a bias of sizes ", bias.sizes());
+  AT_CHECK(bias.type() == self.type(), "expected a bias of type ", self.type(), " but got ", bias.type());
+}
+
+static inline void check_packed_mask(const Tensor& self, const Tensor& mask) {
+  AT_CHECK(mask.scalar_type() == kByte, "mask should be torch.uint8 dtype");
+  AT_CHECK(mask.numel() == packed_mask_size(self.numel()),
+           "expected a packed mask of ", packed_mask_size(self.numel()),
+           " bytes for an input of ", self.numel(), " elements, but got ", mask.numel());
+}
+
+}} // namespace at::native
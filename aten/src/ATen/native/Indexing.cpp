@@ -20,19 +20,33 @@
 // Note 2: The behavior is more complicated when the index tensors are not all
 // adjacent (e.g. x[[0, 1], :, [2, 3]]). In this case, self and the index
 // tensors are transposed to the front: x.transpose(1, 2)[[0, 1], [2, 3]]
+//
+// The indexing kernels (index_stub and index_put_stub) iterate over the
+// result with a TensorIterator. The indexed dimensions of self are replaced by
+// the shape of the broadcast indices with stride 0, so that the iterator moves
+// over the other dimensions of self and the indices together, and the kernels
+// add the offsets of the indexed elements. For example, indexing self of shape
+// (5, 6, 7, 8) by two indices of shape (2, 3) at dimensions 1 and 2 iterates
+// over the shape (5, 2, 3, 8), where self has the strides
+// (self.stride(0), 0, 0, self.stride(3)) and both indices are viewed as
+// (1, 2, 3, 1).
 
 
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/ExpandUtils.h"
+#include "ATen/native/Indexing.h"
+#include "ATen/native/TensorIterator.h"
 
 #include <algorithm>
-#include <functional>
-#include <numeric>
+#include <memory>
 #include <vector>
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(index_stub);
+DEFINE_DISPATCH(index_put_stub);
+
 [[noreturn]]
 static void invalid_mask(const Tensor & self, int64_t idx, const Tensor & mask, int64_t maskIdx) {
   std::stringstream ss;
@@ -121,93 +135,91 @@ transposeToFront(Tensor self, TensorList indices) {
   return std::make_tuple(self.permute(dims), std::move(transposedIndices));
 }
 
-static std::vector<int64_t> computeLinearStride(const Tensor & tensor) {
-  // computes the stride as if tensor were contigous
-  auto sizes = tensor.sizes();
-  std::vector<int64_t> stride(tensor.dim());
-  stride[tensor.dim() - 1] = 1;
-  std::partial_sum(sizes.rbegin(), sizes.rend() - 1, stride.rbegin() + 1, std::multiplies<int64_t>());
-  return stride;
+// Replaces the dimensions of src from dims_before to dims_before + dims_indexed
+// by replacement_shape with stride 0
+static Tensor restrideSrc(const Tensor & src, int64_t dims_before, int64_t dims_indexed, IntList replacement_shape) {
+  auto shape = src.sizes().vec();
+  auto strides = src.strides().vec();
+  int64_t end = dims_before + dims_indexed;
+  shape.erase(shape.begin() + dims_before, shape.begin() + end);
+  strides.erase(strides.begin() + dims_before, strides.begin() + end);
+  shape.insert(shape.begin() + dims_before, replacement_shape.begin(), replacement_shape.end());
+  strides.insert(strides.begin() + dims_before, replacement_shape.size(), 0);
+  return src.as_strided(shape, strides);
 }
 
-// Unsqueezes src `before` times at the front and `after` times at the end
-static Tensor unsqueezeN(const Tensor & src, int64_t before, int64_t after) {
-  auto srcSizes = src.sizes();
-  auto nDim = src.dim();
-  std::vector<int64_t> sizes(nDim + before + after, 1);
-  for (int64_t i = 0; i < nDim; i++) {
-    sizes[i + before] = srcSizes[i];
-  }
-  return src.view(sizes);
+// Views the index with dims_before and dims_after dimensions of size 1 around
+// its own dimensions
+static Tensor reshapeIndexer(const Tensor & index, int64_t dims_before, int64_t dims_after) {
+  auto orig_shape = index.sizes();
+  std::vector<int64_t> shape(dims_before, 1);
+  shape.insert(shape.end(), orig_shape.begin(), orig_shape.end());
+  shape.insert(shape.end(), dims_after, 1);
+  return index.reshape(shape);
 }
 
-static Tensor wrapIndexOnce(const Tensor & index, int64_t dim, int64_t dim_size) {
-  if (index.numel() != 0) {
-    auto max_idx = index.max().item<int64_t>();
-    auto min_idx = index.min().item<int64_t>();
-    AT_CHECK(max_idx < dim_size,
-             "index ", max_idx, " is out of bounds for dimension ", dim, " with size ", dim_size);
-    AT_CHECK(min_idx >= -dim_size,
-             "index ", min_idx, " is out of bounds for dimension ", dim, " with size ", dim_size);
-  }
-  return index.remainder(dim_size);
-}
+// The operands of the indexing kernels, computed from self and the null-padded
+// index tensors whose non-null entries are adjacent.
+struct AdvancedIndex {
+  AdvancedIndex(const Tensor & self, TensorList indices);
 
-static Tensor computeLinearIndex(const Tensor & src, TensorList indices) {
-  auto strides = computeLinearStride(src);
-  Type& longType = src.type().toScalarType(kLong);
-
-  // Compute the linear index by multiplying the indexing tensors by the
-  // stride and summing them. All the indexing tensors have the same shape at
-  // this point. We also compute the number of dimensions before and after that
-  // are not being index.
-  Tensor linearIndex;
-  int64_t emptyBefore = 0, emptyAfter = 0, nElemBefore = 1, nElemAfter = 1;
-  for (int64_t i = 0; i < src.dim(); i++) {
-    if (indices[i].defined()) {
-      // Cast index to the longType matching src's backend
-      // This allows us to support ie indexing a cuda tensor with a cpu tensor
-      Tensor index = (wrapIndexOnce(indices[i], i, src.size(i)) * strides[i]).toType(longType);
-      if (linearIndex.defined()) {
-        linearIndex += index;
+  // self, restrided to the shape of the result
+  Tensor src;
+  // the non-null indices, viewed with as many dimensions as src
+  std::vector<Tensor> indices;
+  // the sizes and strides (in bytes) of the indexed dimensions of self
+  std::vector<int64_t> indexed_sizes;
+  std::vector<int64_t> indexed_strides;
+};
+
+AdvancedIndex::AdvancedIndex(const Tensor & self, TensorList indices_list) {
+  int64_t element_size_bytes = self.type().elementSizeInBytes();
+  int64_t dims_before = 0, dims_after = 0, dims_indexed = 0;
+  IntList replacement_shape;
+  for (size_t dim = 0; dim < indices_list.size(); dim++) {
+    if (!indices_list[dim].defined()) {
+      if (dims_indexed == 0) {
+        dims_before++;
       } else {
-        linearIndex = index;
+        dims_after++;
       }
-    } else if (linearIndex.defined()) {
-      emptyAfter++;
-      nElemAfter *= src.size(i);
     } else {
-      emptyBefore++;
-      nElemBefore *= src.size(i);
+      dims_indexed++;
+      replacement_shape = indices_list[dim].sizes();
+      indexed_sizes.push_back(self.size(dim));
+      indexed_strides.push_back(self.stride(dim) * element_size_bytes);
     }
   }
 
-  // Compute the linear indices for the parts of the tensor not being indexed
-  Tensor beforeIndex;
-  if (emptyBefore > 0) {
-    auto index = at::arange(0, nElemBefore, longType) * strides[emptyBefore - 1];
-    index = index.view(src.sizes().slice(0, emptyBefore));
-    beforeIndex = unsqueezeN(index, 0, linearIndex.dim() + emptyAfter);
-  }
-  Tensor afterIndex;
-  if (emptyAfter > 0) {
-    auto index = at::arange(0, nElemAfter, longType);
-    index = index.view(src.sizes().slice(src.dim() - emptyAfter, emptyAfter));
-    afterIndex = unsqueezeN(index, linearIndex.dim() + emptyBefore, 0);
+  // There is no valid index into an empty dimension. The kernels check the
+  // bounds of every index they read, but they don't read any if another
+  // dimension of the result is empty.
+  if (std::find(indexed_sizes.begin(), indexed_sizes.end(), 0) != indexed_sizes.end() &&
+      std::find(replacement_shape.begin(), replacement_shape.end(), 0) == replacement_shape.end()) {
+    AT_ERROR("index is out of bounds for dimension with size 0");
   }
 
-  // Sum with broadcasting to compute the full index
-  linearIndex = unsqueezeN(linearIndex, emptyBefore, emptyAfter);
-  if (beforeIndex.defined()) {
-    linearIndex = linearIndex + beforeIndex;
+  src = restrideSrc(self, dims_before, dims_indexed, replacement_shape);
+  for (auto & index : indices_list) {
+    if (index.defined()) {
+      indices.push_back(reshapeIndexer(index, dims_before, dims_after));
+    }
   }
-  if (afterIndex.defined()) {
-    linearIndex = linearIndex + afterIndex;
+
+  // The CUDA kernel reads all indices at the offset of the first one
+  if (indices.size() >= 2 && src.type().device_type() == kCUDA) {
+    auto sameStrides = [&](const Tensor & index) {
+      return index.strides().equals(indices[0].strides());
+    };
+    if (!std::all_of(indices.begin(), indices.end(), sameStrides)) {
+      for (auto & index : indices) {
+        index = index.contiguous();
+      }
+    }
   }
-  return linearIndex;
 }
 
-static std::tuple<Tensor, Tensor> makeLinearIndex(Tensor self, TensorList orig) {
+static AdvancedIndex make_info(Tensor self, TensorList orig) {
   checkIndexTensorTypes(orig);
   // first expand ByteTensor (boolean masks) into 1 or more LongTensors
   auto indices = expandByteTensors(self, orig);
@@ -222,38 +234,63 @@ static std::tuple<Tensor, Tensor> makeLinearIndex(Tensor self, TensorList orig)
   if (!hasContiguousSubspace(indices)) {
     std::tie(self, indices) = transposeToFront(self, indices);
   }
-  auto linearIndex = computeLinearIndex(self, indices);
-  return std::make_tuple(self, linearIndex);
+  // This allows us to support ie indexing a cuda tensor with a cpu tensor
+  for (auto & index : indices) {
+    if (index.defined() && index.device() != self.device()) {
+      index = index.to(self.device());
+    }
+  }
+  return AdvancedIndex(self, indices);
 }
 
-Tensor index(const Tensor & self, TensorList indices) {
-  AT_CHECK(indices.size() <= (size_t)self.dim(),
-           "too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
+static std::unique_ptr<TensorIterator> make_index_iterator(const AdvancedIndex & info) {
+  auto builder = TensorIterator::Builder();
+  builder.dont_compute_common_dtype();
+  builder.add_output(at::empty(info.src.sizes(), info.src.options()));
+  builder.add_input(info.src);
+  for (auto & index : info.indices) {
+    builder.add_input(index);
+  }
+  return builder.build();
+}
 
-  Tensor src, linearIndex;
-  std::tie(src, linearIndex) = makeLinearIndex(self, indices);
-  return src.take(linearIndex);
+static std::unique_ptr<TensorIterator> make_index_put_iterator(const AdvancedIndex & info, const Tensor & value) {
+  AT_CHECK(is_expandable_to(value.sizes(), info.src.sizes()),
+           "shape mismatch: value tensor of shape ", value.sizes(),
+           " cannot be broadcast to indexing result of shape ", info.src.sizes());
+  auto builder = TensorIterator::Builder();
+  builder.dont_compute_common_dtype();
+  builder.dont_resize_outputs();
+  builder.add_output(info.src);
+  builder.add_input(value.type() == info.src.type() ? value : value.toType(info.src.type()));
+  for (auto & index : info.indices) {
+    builder.add_input(index);
+  }
+  return builder.build();
 }
 
-Tensor index_put(const Tensor & self, TensorList indices, const Tensor & value) {
+Tensor index(const Tensor & self, TensorList indices) {
   AT_CHECK(indices.size() <= (size_t)self.dim(),
            "too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
 
-  Tensor src, linearIndex, expandedValue;
-  std::tie(src, linearIndex) = makeLinearIndex(self, indices);
-  std::tie(expandedValue) = expand_inplace(linearIndex, value);
-  Tensor dst = src.clone();
-  return dst.put_(linearIndex, expandedValue);
+  auto info = make_info(self, indices);
+  auto iter = make_index_iterator(info);
+  index_stub(iter->device_type(), *iter, info.indexed_sizes, info.indexed_strides);
+  return iter->output();
+}
+
+Tensor index_put(const Tensor & self, TensorList indices, const Tensor & value, bool accumulate) {
+  return self.clone().index_put_(indices, value, accumulate);
 }
 
-Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & value) {
+Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & value, bool accumulate) {
   AT_CHECK(indices.size() <= (size_t)self.dim(),
            "too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
 
-  Tensor src, linearIndex, expandedValue;
-  std::tie(src, linearIndex) = makeLinearIndex(self, indices);
-  std::tie(expandedValue) = expand_inplace(linearIndex, value);
-  return src.put_(linearIndex, expandedValue);
+  auto info = make_info(self, indices);
+  auto iter = make_index_put_iterator(info, value);
+  index_put_stub(iter->device_type(), *iter, info.indexed_sizes, info.indexed_strides, accumulate);
+  return self;
 }
 
 Tensor & index_copy_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) {
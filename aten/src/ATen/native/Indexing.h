@@ -0,0 +1,22 @@
+#pragma once
+
+// Indexing tensors by tensors
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { struct TensorIterator; }
+
+namespace at { namespace native {
+
+// The iterator operands are the output, the restrided input (see Indexing.cpp)
+// and one long tensor per indexed dimension. indexed_sizes and
+// indexed_strides hold the size and the stride in bytes of every indexed
+// dimension of the original tensor.
+using index_fn = void(*)(TensorIterator&, IntList indexed_sizes, IntList indexed_strides);
+using index_put_fn = void(*)(TensorIterator&, IntList indexed_sizes, IntList indexed_strides, bool accumulate);
+
+DECLARE_DISPATCH(index_fn, index_stub);
+DECLARE_DISPATCH(index_put_fn, index_put_stub);
+
+}} // namespace at::native
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Layer norm of X viewed as a contiguous M x N matrix, normalizing each row.
+// gamma and beta, of N elements, are optional. mean and rstd, the mean and
+// reciprocal of the standard deviation of each row, are saved for backward.
+using layer_norm_fn = void (*)(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta,
+    int64_t M, int64_t N, double eps,
+    Tensor& Y, Tensor& mean, Tensor& rstd);
+
+// Only computes the gradients among dX, dgamma and dbeta that are defined.
+using layer_norm_backward_fn = void (*)(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta);
+
+DECLARE_DISPATCH(layer_norm_fn, layer_norm_stub);
+DECLARE_DISPATCH(layer_norm_backward_fn, layer_norm_backward_stub);
+
+}} // namespace at::native
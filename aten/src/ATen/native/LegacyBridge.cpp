@@ -13,6 +13,17 @@ namespace {
   static bool _has_native(const Tensor& self) {
     return _type_has_native(self.type());
   }
+
+  // there is no TH BFloat16 tensor, so these use the native kernels
+  static bool _is_bfloat16(const Tensor& self) {
+    return self.type().scalarType() == kBFloat16;
+  }
+
+  // BFloat16 has no BLAS, the product is computed in float
+  static Tensor _bfloat16_addmm(const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+    return at::addmm(self.toType(kFloat), mat1.toType(kFloat), mat2.toType(kFloat), beta, alpha)
+        .toType(kBFloat16);
+  }
 }
 
 // These native operations are not "really" native; they're actually just bridge
@@ -25,6 +36,8 @@ namespace {
 Tensor clone(const Tensor& self) {
   if (_has_native(self)) {
     return native_clone(self);
+  } else if (_is_bfloat16(self)) {
+    return at::empty_like(self).copy_(self);
   } else {
     return _th_clone(self);
   }
@@ -33,6 +46,8 @@ Tensor clone(const Tensor& self) {
 Tensor& resize_as_(Tensor& self, const Tensor& the_template) {
   if (_has_native(self)) {
     return native_resize_as_(self, the_template);
+  } else if (_is_bfloat16(self)) {
+    return self.resize_(the_template.sizes());
   } else {
     return _th_resize_as_(self, the_template);
   }
@@ -57,6 +72,8 @@ Tensor pow(const Tensor& self, Scalar exponent) {
 Tensor& zero_(Tensor& self) {
   if (_has_native(self)) {
     return native_zero_(self);
+  } else if (_is_bfloat16(self)) {
+    return self.fill_(0);
   } else {
     return _th_zero_(self);
   }
@@ -106,6 +123,9 @@ Tensor& addmm_out(Tensor& result, const Tensor& self, const Tensor& mat1, const
     Tensor b_self;
     std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
     return s_native_addmm_out(result, b_self, mat1, mat2, beta, alpha);
+  } else if (_is_bfloat16(self)) {
+    Tensor product = _bfloat16_addmm(self, mat1, mat2, beta, alpha);
+    return result.resize_(product.sizes()).copy_(product);
   } else {
     return _th_addmm_out(result, self, mat1, mat2, beta, alpha);
   }
@@ -118,6 +138,8 @@ Tensor addmm(const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar
     Tensor b_self;
     std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm");
     return s_native_addmm(b_self, mat1, mat2, beta, alpha);
+  } else if (_is_bfloat16(self)) {
+    return _bfloat16_addmm(self, mat1, mat2, beta, alpha);
   } else {
     return _th_addmm(self, mat1, mat2, beta, alpha);
   }
@@ -129,6 +151,8 @@ Tensor& addmm_(Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta
   if (mat1_sparse) {
     // inplace is not broadcasting
     return s_native_addmm_(self, mat1, mat2, beta, alpha);
+  } else if (_is_bfloat16(self)) {
+    return self.copy_(_bfloat16_addmm(self, mat1, mat2, beta, alpha));
   } else {
     return _th_addmm_(self, mat1, mat2, beta, alpha);
   }
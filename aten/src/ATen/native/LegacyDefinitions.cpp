@@ -638,14 +638,6 @@ Tensor lerp(const Tensor & self, const Tensor & end, Scalar weight) {
   return at::_th_lerp(self, end, weight);
 }
 
-Tensor & histc_out(Tensor & result, const Tensor & self, int64_t bins, Scalar min, Scalar max) {
-  return at::_th_histc_out(result, self, bins, min, max);
-}
-
-Tensor histc(const Tensor & self, int64_t bins, Scalar min, Scalar max) {
-  return at::_th_histc(self, bins, min, max);
-}
-
 Tensor & sign_out(Tensor & result, const Tensor & self) {
   return at::_th_sign_out(result, self);
 }
@@ -713,21 +705,6 @@ Tensor median(const Tensor & self) {
   return at::_th_median(self);
 }
 
-std::tuple<Tensor &,Tensor &> sort_out(Tensor & values, Tensor & indices, const Tensor & self, int64_t dim, bool descending) {
-  return at::_th_sort_out(values, indices, self, dim, descending);
-}
-
-std::tuple<Tensor,Tensor> sort(const Tensor & self, int64_t dim, bool descending) {
-  return at::_th_sort(self, dim, descending);
-}
-std::tuple<Tensor &,Tensor &> topk_out(Tensor & values, Tensor & indices, const Tensor & self, int64_t k, int64_t dim, bool largest, bool sorted) {
-  return at::_th_topk_out(values, indices, self, k, dim, largest, sorted);
-}
-
-std::tuple<Tensor,Tensor> topk(const Tensor & self, int64_t k, int64_t dim, bool largest, bool sorted) {
-  return at::_th_topk(self, k, dim, largest, sorted);
-}
-
 Tensor all(const Tensor & self) {
   return at::_th_all(self);
 }
@@ -335,10 +335,6 @@ Tensor & adaptive_avg_pool2d_out(Tensor & output, const Tensor & self, IntList o
   return at::_thnn_adaptive_avg_pool2d_out(output, self, output_size);
 }
 
-Tensor adaptive_avg_pool2d(const Tensor & self, IntList output_size) {
-  return at::_thnn_adaptive_avg_pool2d(self, output_size);
-}
-
 Tensor & adaptive_avg_pool2d_backward_out(Tensor & grad_input, const Tensor & grad_output, const Tensor & self) {
   return at::_thnn_adaptive_avg_pool2d_backward_out(grad_input, grad_output, self);
 }
@@ -399,10 +395,6 @@ Tensor & avg_pool2d_out(Tensor & output, const Tensor & self, IntList kernel_siz
   return at::_thnn_avg_pool2d_out(output, self, kernel_size, stride, padding, ceil_mode, count_include_pad);
 }
 
-Tensor avg_pool2d(const Tensor & self, IntList kernel_size, IntList stride, IntList padding, bool ceil_mode, bool count_include_pad) {
-  return at::_thnn_avg_pool2d(self, kernel_size, stride, padding, ceil_mode, count_include_pad);
-}
-
 Tensor & avg_pool2d_backward_out(Tensor & grad_input, const Tensor & grad_output, const Tensor & self, IntList kernel_size, IntList stride, IntList padding, bool ceil_mode, bool count_include_pad) {
   return at::_thnn_avg_pool2d_backward_out(grad_input, grad_output, self, kernel_size, stride, padding, ceil_mode, count_include_pad);
 }
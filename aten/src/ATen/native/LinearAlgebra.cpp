@@ -5,8 +5,12 @@
 #include "ATen/native/LinearAlgebraUtils.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/Parallel.h"
+#include "ATen/native/cpu/BatchGemmKernel.h"
+#include <chrono>
 #include <functional>
+#include <mutex>
 #include <numeric>
+#include <unordered_map>
 #include <vector>
 
 namespace at {
@@ -154,6 +158,10 @@ Tensor mm(const Tensor& self, const Tensor& mat2) {
   if (self.is_sparse()) {
     return mat2.type().addmm(at::zeros({}, mat2.type()), self, mat2, 0, 1);
   }
+  if (self.type().scalarType() == kBFloat16) {
+    // BFloat16 has no BLAS, the product is computed in float
+    return at::mm(self.toType(kFloat), mat2.toType(kFloat)).toType(kBFloat16);
+  }
   return at::_th_mm(self, mat2);
 }
 
@@ -161,6 +169,10 @@ Tensor& mm_out(Tensor& result, const Tensor& self, const Tensor& mat2) {
   if (self.is_sparse()) {
     return at::addmm_out(result, at::zeros({}, mat2.options()), self, mat2, 0, 1);
   }
+  if (self.type().scalarType() == kBFloat16) {
+    Tensor product = at::native::mm(self, mat2);
+    return result.resize_(product.sizes()).copy_(product);
+  }
   return at::_th_mm_out(result, self, mat2);
 }
 
@@ -249,12 +261,102 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
     });
 }
 
+DEFINE_DISPATCH(batch_gemm_kernel);
+
+static void check_baddbmm_packed(const Tensor& self, const Tensor& batch1, const Tensor& batch2) {
+  CheckedFrom c = "_baddbmm_packed_";
+  TensorArg self_arg(self, "self", 0);
+  TensorArg b1_arg(batch1, "batch1", 1);
+  TensorArg b2_arg(batch2, "batch2", 2);
+  checkBackend(c, {self, batch1, batch2}, Backend::CPU);
+  checkAllSameType(c, {self_arg, b1_arg, b2_arg});
+  checkDim(c, self_arg, 3);
+  checkDim(c, b1_arg, 3);
+  checkDim(c, b2_arg, 3);
+  checkSize(c, b1_arg, 0, self.size(0));
+  checkSize(c, b1_arg, 1, self.size(1));
+  checkSize(c, b2_arg, 0, self.size(0));
+  checkSize(c, b2_arg, 1, batch1.size(2));
+  checkSize(c, b2_arg, 2, self.size(2));
+  AT_CHECK(self.scalar_type() == kFloat || self.scalar_type() == kDouble,
+           "_baddbmm_packed_: expected a float or double tensor, but got ", self.type().toString());
+}
+
+// The packed kernel of native/cpu/BatchGemmKernel.cpp, whatever the shapes.
+Tensor& _baddbmm_packed_(Tensor& self, const Tensor& batch1, const Tensor& batch2, Scalar beta, Scalar alpha) {
+  check_baddbmm_packed(self, batch1, batch2);
+  if (self.numel() > 0) {
+    batch_gemm_kernel(kCPU, self, batch1, batch2, beta, alpha, false);
+  }
+  return self;
+}
+
+// The packed kernel only runs on matrices with no size larger than this.
+static constexpr int64_t kBatchGemmMaxSize = 512;
+
+static int64_t ceil_log2(int64_t x) {
+  int64_t log2 = 0;
+  while ((int64_t(1) << log2) < x) {
+    log2++;
+  }
+  return log2;
+}
+
+// Whether the packed kernel is faster than the other backends for the class
+// of the shapes of a bmm/baddbmm: the shapes of the same type whose batch
+// size, rows, columns and contraction size have the same ceil(log2), as the
+// choice depends on the CPU, on the BLAS library and on whether ATen uses
+// MKL. It is made once per class, by timing both on the first call of the
+// class, and cached.
+static bool use_batch_gemm_kernel(
+    const Tensor& result,
+    const Tensor& batch1,
+    const std::function<void(Tensor&)>& run_packed,
+    const std::function<void(Tensor&)>& run_default) {
+  static std::mutex mutex;
+  static std::unordered_map<int64_t, bool> use_packed;
+
+  const int64_t key =
+      (((static_cast<int64_t>(result.type().scalarType()) * 32 + std::min(ceil_log2(result.size(0)), int64_t(31))) * 16
+        + ceil_log2(result.size(1))) * 16 + ceil_log2(result.size(2))) * 16 + ceil_log2(batch1.size(2));
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = use_packed.find(key);
+    if (it != use_packed.end()) {
+      return it->second;
+    }
+  }
+
+  // Times the backends on a scratch result, as baddbmm reads it
+  Tensor scratch = at::zeros_like(result);
+  auto time = [&](const std::function<void(Tensor&)>& run) {
+    // The first run may initialize the backend
+    run(scratch);
+    auto best = std::chrono::steady_clock::duration::max();
+    for (int i = 0; i < 3; i++) {
+      const auto start = std::chrono::steady_clock::now();
+      run(scratch);
+      best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return best;
+  };
+  const bool packed = time(run_packed) < time(run_default);
+
+  std::lock_guard<std::mutex> guard(mutex);
+  use_packed.emplace(key, packed);
+  return packed;
+}
+
 // This tries to apply some optimizations to bmm/baddbmm:
+// - For floating point matrices of small and medium sizes, the packed and
+//   register-blocked kernel of native/cpu/BatchGemmKernel.cpp is used when
+//   it is faster than the backends below for the class of the shapes, see
+//   use_batch_gemm_kernel.
 // - When the operand size is small, computation are parallelized over the batch
 //   dimension using OMP and naive matrix multiplication is applied.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
 // - Otherwise, we use a series of matrix multiplications.
-// The threshold of 400 for the first has not been thoroughly benchmarked yet and may have room for further
+// The threshold of 400 for the second has not been thoroughly benchmarked yet and may have room for further
 // optimization, it likely depends on the characteristics of the CPU, MKL will be different from non-MKL etc.,
 // but this seems to be a first starting point.
 
@@ -291,37 +393,59 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
     return self_or_result.zero_();
   }
 
+  if (self_or_result.scalar_type() == kBFloat16) {
+    // BFloat16 has no BLAS, the products are computed in float
+    Tensor acc = self_or_result.toType(kFloat);
+    bmm_out_or_baddbmm_(acc, batch1.toType(kFloat), batch2.toType(kFloat), beta, alpha, is_bmm_out);
+    return self_or_result.copy_(acc);
+  }
+
   auto batch_items_contiguous_or_transposed = [&](const Tensor& t) {
     return (t.stride(2) == 1 && t.stride(1) == t.size(2))
             || (t.stride(1) == 1 && t.stride(2) == t.size(1));
   };
 
-  if (contraction_size * res_rows * res_cols < 400) {
-    if (is_bmm_out) {
-      AT_DISPATCH_ALL_TYPES(batch1.type(), "bmm", [&] {
-          baddbmm_cpu_kernel<scalar_t, true>(self_or_result, batch1, batch2, beta, alpha);
-        });
-    } else {
-      AT_DISPATCH_ALL_TYPES(batch1.type(), "baddbmm", [&] {
-          baddbmm_cpu_kernel<scalar_t, false>(self_or_result, batch1, batch2, beta, alpha);
-        });
-    }
-  } else if (at::hasMKL() && at::native::is_floating_point(self_or_result)
-	     && batch_items_contiguous_or_transposed(batch1)
-	     && batch_items_contiguous_or_transposed(batch2)
-	     && self_or_result.is_contiguous()) {
-    at::native::_baddbmm_mkl_(self_or_result, batch1, batch2, beta, alpha);
-  } else { // split along batch dimension
-    if (is_bmm_out) {
-      for (int64_t b = 0; b < bs; b++) {
-        auto r = self_or_result.select(0, b);
-        at::native::mm_out(r, batch1.select(0, b), batch2.select(0, b));
+  auto run_default = [&](Tensor& result) {
+    if (contraction_size * res_rows * res_cols < 400) {
+      if (is_bmm_out) {
+        AT_DISPATCH_ALL_TYPES(batch1.type(), "bmm", [&] {
+            baddbmm_cpu_kernel<scalar_t, true>(result, batch1, batch2, beta, alpha);
+          });
+      } else {
+        AT_DISPATCH_ALL_TYPES(batch1.type(), "baddbmm", [&] {
+            baddbmm_cpu_kernel<scalar_t, false>(result, batch1, batch2, beta, alpha);
+          });
       }
-    } else {
-      for (int64_t b = 0; b < bs; b++) {
-        self_or_result.select(0, b).addmm_(batch1.select(0, b), batch2.select(0, b), beta, alpha);
+    } else if (at::hasMKL() && at::native::is_floating_point(result)
+         && batch_items_contiguous_or_transposed(batch1)
+         && batch_items_contiguous_or_transposed(batch2)
+         && result.is_contiguous()) {
+      at::native::_baddbmm_mkl_(result, batch1, batch2, beta, alpha);
+    } else { // split along batch dimension
+      if (is_bmm_out) {
+        for (int64_t b = 0; b < bs; b++) {
+          auto r = result.select(0, b);
+          at::native::mm_out(r, batch1.select(0, b), batch2.select(0, b));
+        }
+      } else {
+        for (int64_t b = 0; b < bs; b++) {
+          result.select(0, b).addmm_(batch1.select(0, b), batch2.select(0, b), beta, alpha);
+        }
       }
     }
+  };
+  auto run_packed = [&](Tensor& result) {
+    batch_gemm_kernel(kCPU, result, batch1, batch2, beta, alpha, is_bmm_out);
+  };
+
+  const auto scalar_type = self_or_result.scalar_type();
+  if ((scalar_type == kFloat || scalar_type == kDouble)
+      && res_rows <= kBatchGemmMaxSize && res_cols <= kBatchGemmMaxSize
+      && contraction_size <= kBatchGemmMaxSize
+      && use_batch_gemm_kernel(self_or_result, batch1, run_packed, run_default)) {
+    run_packed(self_or_result);
+  } else {
+    run_default(self_or_result);
   }
   return self_or_result;
 }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+#include <tuple>
+
+namespace at { namespace native {
+
+// The CPU forward returns the negative log likelihoods and the log alphas,
+// which the backward reuses
+using ctc_loss_fn = std::tuple<Tensor, Tensor>(*)(
+    const Tensor& log_probs, const Tensor& targets, IntList input_lengths,
+    IntList target_lengths, int64_t BLANK);
+using ctc_loss_backward_fn = Tensor(*)(
+    const Tensor& grad_out, const Tensor& log_probs, const Tensor& targets,
+    IntList input_lengths, IntList target_lengths,
+    const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK);
+
+DECLARE_DISPATCH(ctc_loss_fn, ctc_loss_stub);
+DECLARE_DISPATCH(ctc_loss_backward_fn, ctc_loss_backward_stub);
+
+}} // namespace at::native
@@ -6,6 +6,7 @@
 #include "ATen/Config.h"
 
 #include "ATen/detail/CUDAHooksInterface.h"
+#include "ATen/native/LayerNorm.h"
 
 #include <vector>
 
@@ -351,27 +352,75 @@ Tensor layer_norm(const Tensor& input, IntList normalized_shape,
       AT_ERROR(ss.str());
     }
 
-    int64_t n = 1;
+    int64_t M = 1;
     for (int64_t i = 0; i < input_ndim - normalized_ndim; i++) {
-      n *= input_shape[i];
+      M *= input_shape[i];
+    }
+    int64_t N = 1;
+    for (auto size : normalized_shape) {
+      N *= size;
     }
 
-    // Apply layer norm
-    auto input_reshaped = input.contiguous().view({1, n, -1});
+    // The fused kernels don't use cuDNN, so cudnn_enabled is ignored
+    auto X = input.contiguous();
+    auto gamma = weight.defined() ? weight.contiguous().view({N}) : weight;
+    auto beta = bias.defined() ? bias.contiguous().view({N}) : bias;
+    return std::get<0>(at::native_layer_norm(X, gamma, beta, M, N, eps));
+}
 
-    auto out = at::batch_norm(input_reshaped, {}, {}, {}, {}, true, 0, eps,
-                              cudnn_enabled);
-    out = out.view(input_shape);
+DEFINE_DISPATCH(layer_norm_stub);
+DEFINE_DISPATCH(layer_norm_backward_stub);
 
-    if (weight.defined() && bias.defined()) {
-      return bias.addcmul(out, weight, 1);
-    } else if (weight.defined()) {
-      return out.mul(weight);
-    } else if (bias.defined()) {
-      return out.add(bias);
-    } else {
-      return out;
+std::tuple<Tensor, Tensor, Tensor> native_layer_norm(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    int64_t M, int64_t N, double eps) {
+  AT_CHECK(input.is_contiguous() && input.numel() == M * N,
+           "native_layer_norm: expected a contiguous input of ", M, " x ", N,
+           " elements, but got input of size ", input.sizes());
+  AT_CHECK(!weight.defined() || (weight.is_contiguous() && weight.numel() == N),
+           "native_layer_norm: expected a contiguous weight of ", N, " elements");
+  AT_CHECK(!bias.defined() || (bias.is_contiguous() && bias.numel() == N),
+           "native_layer_norm: expected a contiguous bias of ", N, " elements");
+  // for half inputs, the statistics are saved as float
+  auto stats_options = input.options().dtype(
+      input.type().scalarType() == at::kHalf ? at::kFloat : input.type().scalarType());
+  Tensor output = at::empty_like(input);
+  Tensor mean = at::empty({M}, stats_options);
+  Tensor rstd = at::empty({M}, stats_options);
+  if (M > 0) {
+    layer_norm_stub(input.type().device_type(), input, weight, bias, M, N, eps, output, mean, rstd);
+  }
+  return std::make_tuple(output, mean, rstd);
+}
+
+std::tuple<Tensor, Tensor, Tensor> native_layer_norm_backward(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean, const Tensor& rstd,
+    const Tensor& weight /* optional */, int64_t M, int64_t N, std::array<bool,3> output_mask) {
+  auto dY = grad_out.contiguous();
+  Tensor dX;
+  Tensor dgamma;
+  Tensor dbeta;
+  if (output_mask[0]) {
+    dX = at::empty_like(input);
+  }
+  if (output_mask[1]) {
+    dgamma = at::empty({N}, input.options());
+  }
+  if (output_mask[2]) {
+    dbeta = at::empty({N}, input.options());
+  }
+  if (M > 0) {
+    layer_norm_backward_stub(
+        input.type().device_type(), dY, input, mean, rstd, weight, M, N, dX, dgamma, dbeta);
+  } else {
+    if (dgamma.defined()) {
+      dgamma.zero_();
     }
+    if (dbeta.defined()) {
+      dbeta.zero_();
+    }
+  }
+  return std::make_tuple(dX, dgamma, dbeta);
 }
 
 Tensor group_norm(const Tensor& input, int64_t num_groups,
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+
+namespace at { namespace native {
+
+// The Philox4x32-10 counter based generator of Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3" (SC'11), the one curand uses on the
+// GPU. The n-th number of the stream of a key is a function of the key and
+// n alone, so that the elements of a tensor can be sampled in any order and
+// in parallel, with each chunk of a parallel_for starting its own generator
+// at the offset of its first element, and the result does not depend on the
+// number of threads.
+//
+// Each call of the operator() returns the next 32 bits of the stream. The
+// numbers come in blocks of four, one per value of the 128 bits counter,
+// which is made of the offset of the block and the subsequence.
+class Philox4x32 {
+ public:
+  Philox4x32(uint64_t seed, uint64_t offset = 0, uint64_t subsequence = 0) {
+    key_[0] = static_cast<uint32_t>(seed);
+    key_[1] = static_cast<uint32_t>(seed >> 32);
+    counter_[0] = 0;
+    counter_[1] = 0;
+    counter_[2] = static_cast<uint32_t>(subsequence);
+    counter_[3] = static_cast<uint32_t>(subsequence >> 32);
+    skip(offset);
+  }
+
+  uint32_t operator()() {
+    if (index_ == 0) {
+      compute(output_);
+      increment();
+    }
+    uint32_t result = output_[index_];
+    index_ = (index_ + 1) & 3;
+    return result;
+  }
+
+  // Skips the next n numbers
+  void skip(uint64_t n) {
+    // the position of the next number from the start of the block of
+    // output_, or of the counter when output_ is stale
+    uint64_t block = offset();
+    if (index_ != 0) {
+      block -= 1;
+    }
+    uint64_t position = n + index_;
+    set_offset(block + (position >> 2));
+    index_ = position & 3;
+    if (index_ != 0) {
+      compute(output_);
+      increment();
+    }
+  }
+
+  // A uniform float in [0, 1), from 24 of the bits
+  static float uniform_float(uint32_t x) {
+    return (x >> 8) * (1.0f / (1u << 24));
+  }
+
+  // A uniform double in [0, 1), from 32 of the bits
+  static double uniform_double(uint32_t x) {
+    return x * (1.0 / 4294967296.0);
+  }
+
+ private:
+  static constexpr uint32_t kPhiloxM0 = 0xD2511F53;
+  static constexpr uint32_t kPhiloxM1 = 0xCD9E8D57;
+  static constexpr uint32_t kPhiloxW0 = 0x9E3779B9;
+  static constexpr uint32_t kPhiloxW1 = 0xBB67AE85;
+
+  static uint32_t mulhilo(uint32_t a, uint32_t b, uint32_t* hi) {
+    uint64_t product = static_cast<uint64_t>(a) * b;
+    *hi = static_cast<uint32_t>(product >> 32);
+    return static_cast<uint32_t>(product);
+  }
+
+  void compute(uint32_t* out) const {
+    uint32_t c[4] = {counter_[0], counter_[1], counter_[2], counter_[3]};
+    uint32_t k[2] = {key_[0], key_[1]};
+    for (int round = 0; round < 10; round++) {
+      uint32_t hi0, hi1;
+      uint32_t lo0 = mulhilo(kPhiloxM0, c[0], &hi0);
+      uint32_t lo1 = mulhilo(kPhiloxM1, c[2], &hi1);
+      c[0] = hi1 ^ c[1] ^ k[0];
+      c[1] = lo1;
+      c[2] = hi0 ^ c[3] ^ k[1];
+      c[3] = lo0;
+      k[0] += kPhiloxW0;
+      k[1] += kPhiloxW1;
+    }
+    out[0] = c[0];
+    out[1] = c[1];
+    out[2] = c[2];
+    out[3] = c[3];
+  }
+
+  // The 64 bits offset of the counter
+  uint64_t offset() const {
+    return (static_cast<uint64_t>(counter_[1]) << 32) | counter_[0];
+  }
+
+  void set_offset(uint64_t offset) {
+    counter_[0] = static_cast<uint32_t>(offset);
+    counter_[1] = static_cast<uint32_t>(offset >> 32);
+  }
+
+  void increment() {
+    set_offset(offset() + 1);
+  }
+
+  uint32_t key_[2];
+  uint32_t counter_[4];
+  uint32_t output_[4];
+  // the next number of output_ to return, output_ is stale when it is 0
+  uint32_t index_ = 0;
+};
+
+}} // namespace at::native
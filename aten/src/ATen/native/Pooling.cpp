@@ -2,12 +2,96 @@
 
 #include "ATen/NativeFunctions.h"
 #include "ATen/TensorUtils.h"
+#include "ATen/div_rtn.h"
+#include "ATen/native/ChannelsLast.h"
+#include "ATen/native/Pooling.h"
 #include "c10/util/Exception.h"
 
 #include <tuple>
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(max_pool2d_kernel);
+DEFINE_DISPATCH(avg_pool2d_kernel);
+
+// The output size along a dimension, as THNN computes it
+static int64_t pooling_output_size(
+    int64_t input_size, int64_t kernel, int64_t stride, int64_t pad,
+    int64_t dilation, bool ceil_mode) {
+  int64_t output_size = div_rtn<int64_t>(
+      input_size + 2 * pad - dilation * (kernel - 1) - 1 +
+          (ceil_mode ? stride - 1 : 0),
+      stride) + 1;
+  // The last window must start inside the input or its left padding
+  if (ceil_mode && (output_size - 1) * stride >= input_size + pad) {
+    --output_size;
+  }
+  return output_size;
+}
+
+// Runs a 2d pooling of a 4-d CPU float or double tensor through the
+// vectorized kernels, and returns an undefined tensor if they can't do it, in
+// which case THNN pools it and reports the errors of invalid arguments. The
+// output is channels last if the input is.
+template <typename Stub>
+static Tensor pool2d_cpu(
+    Stub& stub,
+    const Tensor& self,
+    IntList kernel_size,
+    IntList stride,
+    IntList padding,
+    IntList dilation,
+    bool ceil_mode,
+    bool count_include_pad) {
+  if (stride.empty()) {
+    stride = kernel_size;
+  }
+  if (self.type().backend() != Backend::CPU ||
+      (self.type().scalarType() != kFloat && self.type().scalarType() != kDouble) ||
+      self.dim() != 4 || self.numel() == 0 || kernel_size.size() != 2 ||
+      stride.size() != 2 || padding.size() != 2 || dilation.size() != 2) {
+    return Tensor();
+  }
+  for (size_t i = 0; i < 2; i++) {
+    if (kernel_size[i] <= 0 || stride[i] <= 0 || dilation[i] <= 0 ||
+        padding[i] < 0 || padding[i] > kernel_size[i] / 2) {
+      return Tensor();
+    }
+  }
+  PoolingParams2d params;
+  params.kernel_h = kernel_size[0];
+  params.kernel_w = kernel_size[1];
+  params.stride_h = stride[0];
+  params.stride_w = stride[1];
+  params.pad_h = padding[0];
+  params.pad_w = padding[1];
+  params.dilation_h = dilation[0];
+  params.dilation_w = dilation[1];
+  params.count_include_pad = count_include_pad;
+  const int64_t output_h = pooling_output_size(
+      self.size(2), params.kernel_h, params.stride_h, params.pad_h,
+      params.dilation_h, ceil_mode);
+  const int64_t output_w = pooling_output_size(
+      self.size(3), params.kernel_w, params.stride_w, params.pad_w,
+      params.dilation_w, ceil_mode);
+  if (output_h < 1 || output_w < 1) {
+    return Tensor();
+  }
+  const std::vector<int64_t> output_sizes = {
+      self.size(0), self.size(1), output_h, output_w};
+  Tensor input;
+  Tensor output;
+  if (is_channels_last(self)) {
+    input = self;
+    output = empty_channels_last(output_sizes, self.options());
+  } else {
+    input = self.contiguous();
+    output = at::empty(output_sizes, self.options());
+  }
+  stub(kCPU, output, input, params);
+  return output;
+}
+
 static void check1d(
     const char* function_name,
     const char* argument_name,
@@ -114,11 +198,49 @@ Tensor max_pool2d(
     IntList padding,
     IntList dilation,
     bool ceil_mode) {
+  // The backward of max pooling needs the indices of the maxima, which only
+  // max_pool2d_with_indices computes
+  if (!self.requires_grad()) {
+    Tensor output = pool2d_cpu(
+        max_pool2d_kernel, self, kernel_size, stride, padding, dilation,
+        ceil_mode, /*count_include_pad=*/false);
+    if (output.defined()) {
+      return output;
+    }
+  }
   auto output_and_indices = at::max_pool2d_with_indices(
       self, kernel_size, stride, padding, dilation, ceil_mode);
   return std::get<0>(output_and_indices);
 }
 
+Tensor avg_pool2d(
+    const Tensor& self,
+    IntList kernel_size,
+    IntList stride,
+    IntList padding,
+    bool ceil_mode,
+    bool count_include_pad) {
+  Tensor output = pool2d_cpu(
+      avg_pool2d_kernel, self, kernel_size, stride, padding, {1, 1},
+      ceil_mode, count_include_pad);
+  if (output.defined()) {
+    return output;
+  }
+  return at::_thnn_avg_pool2d(
+      self, kernel_size, stride, padding, ceil_mode, count_include_pad);
+}
+
+Tensor adaptive_avg_pool2d(const Tensor& self, IntList output_size) {
+  // Global pooling, as at the end of most classification networks, is a mean
+  // over the pixels, which reduces a vector at a time in either layout
+  if (self.type().backend() == Backend::CPU && output_size.size() == 2 &&
+      output_size[0] == 1 && output_size[1] == 1 && self.dim() >= 3 &&
+      self.numel() > 0 && isFloatingType(self.type().scalarType())) {
+    return self.mean(-1, /*keepdim=*/true).mean(-2, /*keepdim=*/true);
+  }
+  return at::_thnn_adaptive_avg_pool2d(self, output_size);
+}
+
 Tensor max_pool3d(
     const Tensor& self,
     IntList kernel_size,
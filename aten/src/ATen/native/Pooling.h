@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// The parameters of a 2d pooling, of an NCHW input in either the contiguous
+// or the channels last layout, into an output of the same layout
+struct PoolingParams2d {
+  int64_t kernel_h, kernel_w;
+  int64_t stride_h, stride_w;
+  int64_t pad_h, pad_w;
+  int64_t dilation_h, dilation_w;
+  // Whether the divisor of an average counts the padded elements
+  bool count_include_pad;
+};
+
+using pooling_fn = void(*)(Tensor& output, const Tensor& input, const PoolingParams2d& params);
+
+DECLARE_DISPATCH(pooling_fn, max_pool2d_kernel);
+DECLARE_DISPATCH(pooling_fn, avg_pool2d_kernel);
+
+}} // namespace at::native
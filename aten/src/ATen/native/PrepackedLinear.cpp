@@ -0,0 +1,196 @@
+#include "ATen/ATen.h"
+#include "ATen/Config.h"
+#include "ATen/NativeFunctions.h"
+
+#include <cstdint>
+#include <memory>
+
+#if AT_MKL_ENABLED()
+#include <mkl.h>
+#endif // AT_MKL_ENABLED()
+
+#if AT_FBGEMM_ENABLED()
+#include "fbgemm/FbgemmFP16.h"
+#endif // AT_FBGEMM_ENABLED()
+
+// linear calls BLAS with the raw weight, which BLAS lays out again for its
+// kernels on every call: for small batches, as in inference, that's a large
+// part of the time of the GEMM. linear_prepack lays the weight out once, and
+// linear_prepacked runs the GEMM with it:
+//   - a float weight is packed by MKL (cblas_sgemm_pack) when ATen has it, and
+//     kept transposed and contiguous otherwise;
+//   - an fp16 weight is packed by fbgemm (fp16 storage, fp32 compute) on the
+//     CPUs fbgemm supports, and kept transposed and contiguous in half, and
+//     converted by each call, otherwise.
+
+namespace at { namespace native {
+
+namespace {
+
+struct PrepackedLinearWeight {
+  int64_t N;
+  int64_t K;
+#if AT_MKL_ENABLED()
+  float* mkl_packed = nullptr;
+#endif // AT_MKL_ENABLED()
+#if AT_FBGEMM_ENABLED()
+  std::unique_ptr<fbgemm::PackedGemmMatrixFP16> fp16_packed;
+#endif // AT_FBGEMM_ENABLED()
+  // Without a packed weight, the K x N transpose of the weight
+  Tensor weight_t;
+
+  ~PrepackedLinearWeight() {
+#if AT_MKL_ENABLED()
+    if (mkl_packed) {
+      cblas_sgemm_free(mkl_packed);
+    }
+#endif // AT_MKL_ENABLED()
+  }
+};
+
+void deletePrepackedLinearWeight(void* ptr) {
+  delete static_cast<PrepackedLinearWeight*>(ptr);
+}
+
+// Like the weights of fbgemm_linear_int8_weight, the prepacked weight lives
+// in the storage of a uint8 tensor, identified by its deleter.
+Tensor prepackedLinearWeightTensor(
+    std::unique_ptr<PrepackedLinearWeight> weight,
+    const TensorOptions& options) {
+  auto packed = at::empty(
+      {static_cast<int64_t>(sizeof(PrepackedLinearWeight))},
+      options.dtype(kByte));
+  auto* ptr = weight.release();
+  packed.storage().set_data_ptr(
+      at::DataPtr(ptr, ptr, &deletePrepackedLinearWeight, at::kCPU));
+  return packed;
+}
+
+const PrepackedLinearWeight& prepackedLinearWeight(const Tensor& packed) {
+  const auto* weight =
+      packed.storage().data_ptr().cast_context<PrepackedLinearWeight>(
+          &deletePrepackedLinearWeight);
+  AT_CHECK(weight, "packed_weight must be the result of linear_prepack");
+  return *weight;
+}
+
+} // namespace
+
+Tensor linear_prepack(const Tensor& weight, bool fp16) {
+  AT_CHECK(
+      weight.dim() == 2 && weight.type() == CPU(kFloat),
+      "linear_prepack expects a 2-D CPU float weight, got ",
+      weight.type().toString(), " of sizes ", weight.sizes());
+  auto weight_contig = weight.contiguous();
+  auto packed =
+      std::unique_ptr<PrepackedLinearWeight>(new PrepackedLinearWeight());
+  packed->N = weight.size(0);
+  packed->K = weight.size(1);
+  const bool empty = packed->N == 0 || packed->K == 0;
+
+  if (fp16) {
+#if AT_FBGEMM_ENABLED()
+    if (!empty && at::fbgemm_is_cpu_supported()) {
+      // The weight is N x K, and the GEMM takes its transpose
+      packed->fp16_packed.reset(new fbgemm::PackedGemmMatrixFP16(
+          fbgemm::matrix_op_t::Transpose,
+          packed->K,
+          packed->N,
+          1.0f, // alpha
+          weight_contig.data<float>()));
+      return prepackedLinearWeightTensor(std::move(packed), weight.options());
+    }
+#endif // AT_FBGEMM_ENABLED()
+    packed->weight_t = weight_contig.t().contiguous().to(kHalf);
+    return prepackedLinearWeightTensor(std::move(packed), weight.options());
+  }
+
+#if AT_MKL_ENABLED()
+  if (!empty) {
+    packed->mkl_packed =
+        cblas_sgemm_alloc(CblasBMatrix, 1, packed->N, packed->K);
+    AT_CHECK(packed->mkl_packed, "linear_prepack: cblas_sgemm_alloc failed");
+    cblas_sgemm_pack(
+        CblasRowMajor,
+        CblasBMatrix,
+        CblasTrans,
+        1, // M, unused to pack B
+        packed->N,
+        packed->K,
+        1.0f, // alpha
+        weight_contig.data<float>(),
+        packed->K, // ldb
+        packed->mkl_packed);
+    return prepackedLinearWeightTensor(std::move(packed), weight.options());
+  }
+#endif // AT_MKL_ENABLED()
+  packed->weight_t = weight_contig.t().contiguous();
+  return prepackedLinearWeightTensor(std::move(packed), weight.options());
+}
+
+Tensor linear_prepacked(
+    const Tensor& input,
+    const Tensor& packed_weight,
+    const Tensor& bias) {
+  const auto& weight = prepackedLinearWeight(packed_weight);
+  AT_CHECK(
+      input.dim() >= 1 && input.type() == CPU(kFloat),
+      "linear_prepacked expects a CPU float input, got ",
+      input.type().toString());
+  AT_CHECK(
+      input.size(-1) == weight.K,
+      "input has ", input.size(-1), " features, the weight expects ", weight.K);
+  AT_CHECK(
+      !bias.defined() ||
+          (bias.dim() == 1 && bias.size(0) == weight.N &&
+           bias.type() == CPU(kFloat)),
+      "bias must be a CPU float tensor of size ", weight.N);
+
+  auto input_contig = input.contiguous();
+  const int64_t M = input.numel() / weight.K;
+  // The GEMMs accumulate into the output, which starts with the bias
+  auto output = bias.defined()
+      ? bias.expand({M, weight.N}).contiguous()
+      : at::zeros({M, weight.N}, input.options());
+  auto output_sizes = input.sizes().vec();
+  output_sizes.back() = weight.N;
+  if (output.numel() == 0 || weight.K == 0) {
+    return output.view(output_sizes);
+  }
+
+#if AT_MKL_ENABLED()
+  if (weight.mkl_packed) {
+    cblas_sgemm_compute(
+        CblasRowMajor,
+        CblasNoTrans,
+        CblasPacked,
+        M,
+        weight.N,
+        weight.K,
+        input_contig.data<float>(),
+        weight.K, // lda
+        weight.mkl_packed,
+        weight.N, // ldb, unused for a packed matrix
+        1.0f, // beta
+        output.data<float>(),
+        weight.N); // ldc
+    return output.view(output_sizes);
+  }
+#endif // AT_MKL_ENABLED()
+#if AT_FBGEMM_ENABLED()
+  if (weight.fp16_packed) {
+    fbgemm::cblas_gemm_compute(
+        fbgemm::matrix_op_t::NoTranspose,
+        M,
+        input_contig.data<float>(),
+        *weight.fp16_packed,
+        1.0f, // beta
+        output.data<float>());
+    return output.view(output_sizes);
+  }
+#endif // AT_FBGEMM_ENABLED()
+  output.addmm_(input_contig.view({M, weight.K}), weight.weight_t.to(kFloat));
+  return output.view(output_sizes);
+}
+
+}} // namespace at::native
@@ -0,0 +1,348 @@
+#include "ATen/ATen.h"
+#include "ATen/Config.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/WrapDimUtils.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if AT_FBGEMM_ENABLED()
+#include <cpuinfo.h>
+#include "fbgemm/Fbgemm.h"
+#include "fbgemm/QuantUtils.h"
+#endif // AT_FBGEMM_ENABLED()
+
+// Affine quantization maps a float x to the uint8 q = round(x / scale) +
+// zero_point, clamped to [0, 255], either with one scale and zero point for
+// the tensor or with one of each per slice along an axis. The quantized
+// tensors are plain uint8 tensors, whose scales and zero points are held by
+// the caller.
+
+namespace at { namespace native {
+
+namespace {
+
+constexpr int64_t kQMin = 0;
+constexpr int64_t kQMax = 255;
+
+void checkZeroPoint(int64_t zero_point) {
+  AT_CHECK(
+      zero_point >= kQMin && zero_point <= kQMax,
+      "zero_point must be within [", kQMin, ", ", kQMax, "], got ", zero_point);
+}
+
+// Checks that there is one scale and zero point per slice of self along axis
+void checkPerChannelParams(
+    const Tensor& self,
+    const Tensor& scales,
+    const Tensor& zero_points,
+    int64_t axis) {
+  AT_CHECK(
+      scales.dim() == 1 && scales.size(0) == self.size(axis),
+      "scales must have one element per slice of dimension ", axis,
+      " of self, i.e. ", self.size(axis), ", got sizes ", scales.sizes());
+  AT_CHECK(
+      zero_points.dim() == 1 && zero_points.size(0) == self.size(axis),
+      "zero_points must have one element per slice of dimension ", axis,
+      " of self, i.e. ", self.size(axis), ", got sizes ", zero_points.sizes());
+  AT_CHECK(
+      scales.scalar_type() == kFloat && zero_points.scalar_type() == kLong,
+      "scales must be a float tensor and zero_points a long tensor");
+}
+
+std::vector<int64_t> channelShape(const Tensor& self, int64_t axis) {
+  std::vector<int64_t> shape(self.dim(), 1);
+  shape[axis] = self.size(axis);
+  return shape;
+}
+
+} // namespace
+
+Tensor quantize_linear(const Tensor& self, double scale, int64_t zero_point) {
+  AT_CHECK(
+      self.scalar_type() == kFloat,
+      "quantize_linear expects a float tensor, got ", self.type().toString());
+  AT_CHECK(scale > 0, "scale must be positive, got ", scale);
+  checkZeroPoint(zero_point);
+  return (self / scale)
+      .round_()
+      .add_(zero_point)
+      .clamp_(Scalar(kQMin), Scalar(kQMax))
+      .to(kByte);
+}
+
+Tensor dequantize_linear(const Tensor& self, double scale, int64_t zero_point) {
+  AT_CHECK(
+      self.scalar_type() == kByte,
+      "dequantize_linear expects a uint8 tensor, got ", self.type().toString());
+  checkZeroPoint(zero_point);
+  return self.to(kFloat).sub_(zero_point).mul_(scale);
+}
+
+Tensor quantize_linear_per_channel(
+    const Tensor& self,
+    const Tensor& scales,
+    const Tensor& zero_points,
+    int64_t axis) {
+  AT_CHECK(
+      self.scalar_type() == kFloat,
+      "quantize_linear_per_channel expects a float tensor, got ",
+      self.type().toString());
+  axis = maybe_wrap_dim(axis, self.dim());
+  checkPerChannelParams(self, scales, zero_points, axis);
+  AT_CHECK(scales.gt(0).all().item<uint8_t>(), "scales must be positive");
+  AT_CHECK(
+      zero_points.ge(kQMin).all().item<uint8_t>() &&
+          zero_points.le(kQMax).all().item<uint8_t>(),
+      "zero_points must be within [", kQMin, ", ", kQMax, "]");
+  const auto shape = channelShape(self, axis);
+  return (self / scales.view(shape))
+      .round_()
+      .add_(zero_points.to(kFloat).view(shape))
+      .clamp_(Scalar(kQMin), Scalar(kQMax))
+      .to(kByte);
+}
+
+Tensor dequantize_linear_per_channel(
+    const Tensor& self,
+    const Tensor& scales,
+    const Tensor& zero_points,
+    int64_t axis) {
+  AT_CHECK(
+      self.scalar_type() == kByte,
+      "dequantize_linear_per_channel expects a uint8 tensor, got ",
+      self.type().toString());
+  axis = maybe_wrap_dim(axis, self.dim());
+  checkPerChannelParams(self, scales, zero_points, axis);
+  const auto shape = channelShape(self, axis);
+  return self.to(kFloat)
+      .sub_(zero_points.to(kFloat).view(shape))
+      .mul_(scales.view(shape));
+}
+
+#if AT_FBGEMM_ENABLED()
+
+namespace {
+
+// The weight of fbgemm_linear_int8_weight: the int8 matrix packed by fbgemm,
+// and the parameters that the GEMM needs along with it
+struct PackedLinearWeight {
+  std::unique_ptr<fbgemm::PackBMatrix<int8_t>> w;
+  // Sum of each row of the quantized weight, minus K times the zero point
+  std::vector<int32_t> col_offsets;
+  float w_scale;
+  int32_t w_zero_point;
+  int64_t N;
+  int64_t K;
+};
+
+void deletePackedLinearWeight(void* ptr) {
+  delete static_cast<PackedLinearWeight*>(ptr);
+}
+
+// The packed weight lives in the storage of a uint8 tensor, so that it is
+// passed around, and freed, like any tensor. The deleter of the storage
+// identifies it.
+Tensor packedLinearWeightTensor(
+    std::unique_ptr<PackedLinearWeight> weight,
+    const TensorOptions& options) {
+  auto packed = at::empty(
+      {static_cast<int64_t>(sizeof(PackedLinearWeight))},
+      options.dtype(kByte));
+  auto* ptr = weight.release();
+  packed.storage().set_data_ptr(
+      at::DataPtr(ptr, ptr, &deletePackedLinearWeight, at::kCPU));
+  return packed;
+}
+
+const PackedLinearWeight& packedLinearWeight(const Tensor& packed) {
+  const auto* weight =
+      packed.storage().data_ptr().cast_context<PackedLinearWeight>(
+          &deletePackedLinearWeight);
+  AT_CHECK(
+      weight,
+      "packed_weight must be the result of fbgemm_linear_pack_weight");
+  return *weight;
+}
+
+template <bool FUSE_RELU>
+void linearInt8Weight(
+    const float* input,
+    const PackedLinearWeight& weight,
+    const float* bias,
+    int64_t M,
+    float* output) {
+  const auto K = weight.K;
+  const auto N = weight.N;
+
+  // The input is quantized per tensor, with the range of this batch
+  float x_min, x_max;
+  fbgemm::FindMinMax(input, &x_min, &x_max, M * K);
+  auto x_qparams = fbgemm::ChooseQuantizationParams(
+      x_min, x_max, kQMin, kQMax, /*preserve_sparsity=*/false);
+  x_qparams.precision = 8;
+
+  // Quantizes the input while packing it, and sums its rows
+  std::vector<int32_t> row_offsets(
+      fbgemm::PackAWithQuantRowOffset<uint8_t>::rowOffsetBufferSize());
+  std::vector<uint8_t> x_pack_buf(
+      fbgemm::PackAWithQuantRowOffset<uint8_t>::packedBufferSize());
+  fbgemm::PackAWithQuantRowOffset<uint8_t> packA(
+      fbgemm::matrix_op_t::NoTranspose,
+      M,
+      K,
+      input,
+      K,
+      x_pack_buf.data(),
+      x_qparams.scale,
+      x_qparams.zero_point,
+      1, // groups
+      row_offsets.data());
+
+  // Removes the offsets of the zero points from the int32 results,
+  // dequantizes them and adds the bias
+  fbgemm::DoNothing<float, float> doNothingObj{};
+  fbgemm::ReQuantizeForFloat<FUSE_RELU> outputProcObj(
+      doNothingObj,
+      x_qparams.scale,
+      weight.w_scale,
+      x_qparams.zero_point,
+      weight.w_zero_point,
+      packA.getRowOffsetBuffer(),
+      weight.col_offsets.data(),
+      bias);
+
+  // The int32 results are dequantized in place
+  fbgemm::fbgemmPacked(
+      packA,
+      *weight.w,
+      output,
+      reinterpret_cast<int32_t*>(output),
+      N,
+      outputProcObj,
+      0, // thread_id
+      1); // num_threads
+}
+
+} // namespace
+
+bool fbgemm_is_cpu_supported() {
+  return cpuinfo_initialize() && cpuinfo_has_x86_avx2() &&
+      cpuinfo_has_x86_fma3();
+}
+
+Tensor fbgemm_linear_pack_weight(const Tensor& weight) {
+  AT_CHECK(fbgemm_is_cpu_supported(), "FBGEMM requires a CPU with AVX2");
+  AT_CHECK(
+      weight.dim() == 2 && weight.type() == CPU(kFloat),
+      "fbgemm_linear_pack_weight expects a 2-D CPU float weight, got ",
+      weight.type().toString(), " of sizes ", weight.sizes());
+  auto weight_contig = weight.contiguous();
+  const auto* weight_data = weight_contig.data<float>();
+  auto packed = std::unique_ptr<PackedLinearWeight>(new PackedLinearWeight());
+  packed->N = weight.size(0);
+  packed->K = weight.size(1);
+
+  // The weight is quantized to int8, per tensor
+  float w_min, w_max;
+  fbgemm::FindMinMax(weight_data, &w_min, &w_max, weight.numel());
+  auto w_qparams = fbgemm::ChooseQuantizationParams(
+      w_min, w_max, -128, 127, /*preserve_sparsity=*/false);
+  w_qparams.precision = 8;
+  std::vector<int8_t> w_quantized(weight.numel());
+  fbgemm::Quantize<int8_t>(
+      weight_data, w_quantized.data(), w_quantized.size(), w_qparams);
+  packed->w_scale = w_qparams.scale;
+  packed->w_zero_point = w_qparams.zero_point;
+
+  packed->col_offsets.resize(packed->N);
+  for (int64_t j = 0; j < packed->N; ++j) {
+    int32_t sum = 0;
+    for (int64_t k = 0; k < packed->K; ++k) {
+      sum += w_quantized[j * packed->K + k];
+    }
+    packed->col_offsets[j] = sum - w_qparams.zero_point * packed->K;
+  }
+
+  // The weight is N x K, and the GEMM takes its transpose
+  packed->w.reset(new fbgemm::PackBMatrix<int8_t>(
+      fbgemm::matrix_op_t::Transpose,
+      packed->K,
+      packed->N,
+      w_quantized.data(),
+      packed->K, // ld
+      nullptr, // pmat
+      1, // groups
+      w_qparams.zero_point));
+  return packedLinearWeightTensor(std::move(packed), weight.options());
+}
+
+Tensor fbgemm_linear_int8_weight(
+    const Tensor& input,
+    const Tensor& packed_weight,
+    const Tensor& bias,
+    bool relu) {
+  // Results must be the same on every machine the model runs on, so there is
+  // no fallback for CPUs that FBGEMM does not support
+  AT_CHECK(fbgemm_is_cpu_supported(), "FBGEMM requires a CPU with AVX2");
+  const auto& weight = packedLinearWeight(packed_weight);
+  AT_CHECK(
+      input.dim() >= 1 && input.type() == CPU(kFloat),
+      "fbgemm_linear_int8_weight expects a CPU float input, got ",
+      input.type().toString());
+  AT_CHECK(
+      input.size(-1) == weight.K,
+      "input has ", input.size(-1), " features, the weight expects ", weight.K);
+  AT_CHECK(
+      bias.dim() == 1 && bias.size(0) == weight.N &&
+          bias.type() == CPU(kFloat),
+      "bias must be a CPU float tensor of size ", weight.N);
+
+  auto input_contig = input.contiguous();
+  auto bias_contig = bias.contiguous();
+  const int64_t M = input.numel() / weight.K;
+  auto output = at::empty({M, weight.N}, input.options());
+  if (M > 0) {
+    if (relu) {
+      linearInt8Weight<true>(
+          input_contig.data<float>(),
+          weight,
+          bias_contig.data<float>(),
+          M,
+          output.data<float>());
+    } else {
+      linearInt8Weight<false>(
+          input_contig.data<float>(),
+          weight,
+          bias_contig.data<float>(),
+          M,
+          output.data<float>());
+    }
+  }
+  auto output_sizes = input.sizes().vec();
+  output_sizes.back() = weight.N;
+  return output.view(output_sizes);
+}
+
+#else // AT_FBGEMM_ENABLED()
+
+bool fbgemm_is_cpu_supported() {
+  return false;
+}
+
+Tensor fbgemm_linear_pack_weight(const Tensor& weight) {
+  AT_ERROR("fbgemm_linear_pack_weight: ATen not compiled with FBGEMM support");
+}
+
+Tensor fbgemm_linear_int8_weight(
+    const Tensor& input,
+    const Tensor& packed_weight,
+    const Tensor& bias,
+    bool relu) {
+  AT_ERROR("fbgemm_linear_int8_weight: ATen not compiled with FBGEMM support");
+}
+
+#endif // AT_FBGEMM_ENABLED()
+
+}} // namespace at::native
@@ -2,6 +2,7 @@
 
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/TensorUtils.h"
 
 namespace at { namespace native {
 
@@ -138,65 +139,60 @@ template<typename hidden_type_tmpl>
 struct Cell {
   using hidden_type = hidden_type_tmpl;
   virtual ~Cell() {} // This is really dumb, but enables projects with -Wnon-virtual-dtor to compile...
-  virtual hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const = 0;
+  // If pre_compute_input is set, input is a slice of the result of
+  // project_input, rather than the input itself.
+  virtual hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                                 bool pre_compute_input = false) const = 0;
+  // Computes the input part of the gates. Layers call it once for the inputs of
+  // all steps, which is a single matrix multiplication instead of one per step.
+  virtual Tensor project_input(const Tensor& input, const CellParams& params) const = 0;
 };
 
 template<typename nonlinearity>
 struct SimpleCell : Cell<Tensor> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    return nonlinearity{}(at::linear(input, params.w_ih, params.b_ih) + at::linear(hidden, params.w_hh, params.b_hh));
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    auto igates = pre_compute_input ? input : project_input(input, params);
+    return nonlinearity{}(igates + at::linear(hidden, params.w_hh, params.b_hh));
+  }
+
+  Tensor project_input(const Tensor& input, const CellParams& params) const override {
+    return at::linear(input, params.w_ih, params.b_ih);
   }
 };
 
-// TODO: can use inplace ops?
+// The LSTM and GRU cells add the biases in _thnn_fused_*_cell, which is
+// differentiable, so the projected inputs don't include them.
 struct LSTMCell : Cell<std::tuple<Tensor, Tensor>> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    auto hx = std::get<0>(hidden);
-    auto cx = std::get<1>(hidden);
-
-    if (input.is_cuda()) {
-      auto igates = at::matmul(input, params.w_ih.t());
-      auto hgates = at::matmul(hx, params.w_hh.t());
-      auto result = at::_thnn_fused_lstm_cell(igates, hgates, cx, params.b_ih, params.b_hh);
-      // Slice off the workspace argument (it's needed only for AD).
-      return std::make_tuple(std::get<0>(result), std::get<1>(result));
-    }
-
-    auto gates = at::linear(input, params.w_ih, params.b_ih) + at::linear(hx, params.w_hh, params.b_hh);
-    auto chunked_gates = gates.chunk(4, 1);
-
-    auto ingate = chunked_gates[0].sigmoid();
-    auto forgetgate = chunked_gates[1].sigmoid();
-    auto cellgate = chunked_gates[2].tanh();
-    auto outgate = chunked_gates[3].sigmoid();
-
-    auto cy = (forgetgate * cx) + (ingate * cellgate);
-    auto hy = outgate * cy.tanh();
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    const auto& hx = std::get<0>(hidden);
+    const auto& cx = std::get<1>(hidden);
+
+    auto igates = pre_compute_input ? input : project_input(input, params);
+    auto hgates = at::matmul(hx, params.w_hh.t());
+    auto result = at::_thnn_fused_lstm_cell(igates, hgates, cx, params.b_ih, params.b_hh);
+    // Slice off the workspace argument (it's needed only for AD).
+    return std::make_tuple(std::get<0>(result), std::get<1>(result));
+  }
 
-    return std::make_tuple(hy, cy);
+  Tensor project_input(const Tensor& input, const CellParams& params) const override {
+    return at::matmul(input, params.w_ih.t());
   }
 };
 
 struct GRUCell : Cell<Tensor> {
-  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params) const override {
-    if (input.is_cuda()) {
-      auto igates = at::matmul(input, params.w_ih.t());
-      auto hgates = at::matmul(hidden, params.w_hh.t());
-      auto result = at::_thnn_fused_gru_cell(igates, hgates, hidden, params.b_ih, params.b_hh);
-      // Slice off the workspace argument (it's needed only for AD).
-      return std::get<0>(result);
-    }
-
-    auto igates = at::linear(input, params.w_ih, params.b_ih);
-    auto hgates = at::linear(hidden, params.w_hh, params.b_hh);
-    auto chunked_igates = igates.chunk(3, 1);
-    auto chunked_hgates = hgates.chunk(3, 1);
-
-    auto reset_gate = at::sigmoid(chunked_igates[0] + chunked_hgates[0]);
-    auto input_gate = at::sigmoid(chunked_igates[1] + chunked_hgates[1]);
-    auto new_gate = at::tanh(chunked_igates[2] + reset_gate * chunked_hgates[2]);
+  hidden_type operator()(const Tensor& input, const hidden_type& hidden, const CellParams& params,
+                         bool pre_compute_input = false) const override {
+    auto igates = pre_compute_input ? input : project_input(input, params);
+    auto hgates = at::matmul(hidden, params.w_hh.t());
+    auto result = at::_thnn_fused_gru_cell(igates, hgates, hidden, params.b_ih, params.b_hh);
+    // Slice off the workspace argument (it's needed only for AD).
+    return std::get<0>(result);
+  }
 
-    return new_gate + input_gate * (hidden - new_gate);
+  Tensor project_input(const Tensor& input, const CellParams& params) const override {
+    return at::matmul(input, params.w_ih.t());
   }
 };
 
@@ -232,18 +228,21 @@ struct FullLayer : Layer<Tensor, hidden_type, CellParams> {
   FullLayer(Cell<hidden_type>& cell)
     : cell_(cell) {};
 
-  unstacked_output_type operator()(std::vector<Tensor> step_inputs, const hidden_type& input_hidden, const CellParams& params) const {
+  unstacked_output_type operator()(std::vector<Tensor> step_inputs, const hidden_type& input_hidden, const CellParams& params,
+                                   bool pre_compute_input = false) const {
     std::vector<Tensor> step_outputs;
+    step_outputs.reserve(step_inputs.size());
     auto hidden = input_hidden;
     for (size_t i = 0; i < step_inputs.size(); i++) {
-      hidden = cell_(step_inputs[i], hidden, params);
+      hidden = cell_(step_inputs[i], hidden, params, pre_compute_input);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     return {step_outputs, hidden};
   }
 
   output_type operator()(const Tensor& inputs, const hidden_type& input_hidden, const CellParams& params) const override {
-    auto unstacked_output = (*this)(inputs.unbind(0), input_hidden, params);
+    auto unstacked_output = (*this)(cell_.project_input(inputs, params).unbind(0), input_hidden, params,
+                                    /*pre_compute_input=*/true);
     return {at::stack(unstacked_output.outputs, 0), unstacked_output.final_hidden};
   }
 
@@ -260,12 +259,13 @@ struct FullBidirectionalLayer : Layer<Tensor, pair_of<dir_hidden_type>, pair_of<
     : layer_(cell) {};
 
   output_type operator()(const Tensor& input, const hidden_type& input_hidden, const param_type& params) const override {
-    auto step_inputs = input.unbind(0);
-    auto fw_result = layer_(step_inputs, input_hidden.first, params.first);
+    auto& cell = layer_.cell_;
+    auto fw_step_inputs = cell.project_input(input, params.first).unbind(0);
+    auto fw_result = layer_(fw_step_inputs, input_hidden.first, params.first, /*pre_compute_input=*/true);
     auto fw_output = at::stack(fw_result.outputs, 0);
 
-    auto rev_step_inputs = reverse(std::move(step_inputs));
-    auto rev_result = layer_(rev_step_inputs, input_hidden.second, params.second);
+    auto rev_step_inputs = reverse(cell.project_input(input, params.second).unbind(0));
+    auto rev_result = layer_(rev_step_inputs, input_hidden.second, params.second, /*pre_compute_input=*/true);
     std::reverse(rev_result.outputs.begin(), rev_result.outputs.end());
     auto rev_output = at::stack(rev_result.outputs, 0);
 
@@ -295,6 +295,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     int64_t num_steps = input.batch_sizes.size(0);
     int64_t* batch_sizes = input.batch_sizes.data<int64_t>();
     int64_t last_batch_size = batch_sizes[0];
+    auto projected_input = cell_.project_input(input.data, params);
 
     // Batch sizes is a sequence of decreasing lengths, which are offsets
     // into a 1D list of inputs. At every step we slice out batch_size elements,
@@ -305,7 +306,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     auto hidden = input_hidden;
     for (int64_t i = 0; i < num_steps; ++i) {
       int64_t batch_size = batch_sizes[i];
-      auto step_input = input.data.narrow(0, input_offset, batch_size);
+      auto step_input = projected_input.narrow(0, input_offset, batch_size);
       input_offset += batch_size;
 
       int64_t dec = last_batch_size - batch_size;
@@ -315,7 +316,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
       }
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     hiddens.push_back(hidden);
@@ -340,6 +341,7 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
     int64_t num_steps = input.batch_sizes.size(0);
     int64_t* batch_sizes = input.batch_sizes.data<int64_t>();
     int64_t last_batch_size = batch_sizes[num_steps - 1];
+    auto projected_input = cell_.project_input(input.data, params);
 
     // Here the situation is similar to that above, except we start out with
     // the smallest batch size (and a small set of hidden states we actually use),
@@ -353,11 +355,11 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, CellParams> {
         hidden = hidden_concat(ArrayRef<hidden_type>{hidden, hidden_slice(input_hidden, last_batch_size, batch_size)});
       }
 
-      auto step_input = input.data.narrow(0, input_offset - batch_size, batch_size);
+      auto step_input = projected_input.narrow(0, input_offset - batch_size, batch_size);
       input_offset -= batch_size;
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     std::reverse(step_outputs.begin(), step_outputs.end());
@@ -589,6 +591,221 @@ std::tuple<Tensor, Tensor, Tensor> lstm(
   return std::make_tuple(packed_output.data, std::get<1>(result), std::get<2>(result));
 }
 
+DEFINE_DISPATCH(lstm_cell_stub);
+DEFINE_DISPATCH(lstm_cell_backward_stub);
+DEFINE_DISPATCH(gru_cell_stub);
+DEFINE_DISPATCH(gru_cell_backward_stub);
+
+// Factor will be 3 for GRU and 4 for LSTM
+static void check_fused_cell_sizes(CheckedFrom c,
+                                   const TensorArg& input_gates, const TensorArg& hidden_gates,
+                                   const TensorArg& input_bias, const TensorArg& hidden_bias,
+                                   int64_t factor, const TensorArg& prev_hidden) {
+  checkDim(c, input_gates, 2);
+  checkSameSize(c, input_gates, hidden_gates);
+  int64_t gates_size = input_gates->size(1);
+
+  for (auto& bias : {input_bias, hidden_bias}) {
+    if (bias->defined()) {
+      checkDim(c, bias, 1);
+      checkNumel(c, bias, gates_size);
+    }
+  }
+
+  checkDim(c, prev_hidden, 2);
+  checkNumel(c, prev_hidden, input_gates->size(0) * gates_size / factor);
+
+  checkAllSameType(c, {input_gates, hidden_gates, prev_hidden});
+  for (auto& bias : {input_bias, hidden_bias}) {
+    if (bias->defined()) {
+      checkSameType(c, input_gates, bias);
+    }
+  }
+}
+
+static Tensor contiguous_if_defined(const Tensor& t) {
+  return t.defined() ? t.contiguous() : t;
+}
+
+std::tuple<Tensor, Tensor, Tensor> _thnn_fused_lstm_cell_cpu(
+      const Tensor& input_gates_, const Tensor& hidden_gates_,
+      const Tensor& cx_,
+      const Tensor& input_bias_, const Tensor& hidden_bias_) {
+  check_fused_cell_sizes("_thnn_fused_lstm_cell_cpu",
+                         {input_gates_, "input_gates", 1}, {hidden_gates_, "hidden_gates", 2},
+                         {input_bias_, "input_bias", 3}, {hidden_bias_, "hidden_bias", 4},
+                         /*factor=*/4, {cx_, "prev_hidden", 5});
+
+  auto input_gates = input_gates_.contiguous();
+  auto hidden_gates = hidden_gates_.contiguous();
+  auto cx = cx_.contiguous();
+  auto input_bias = contiguous_if_defined(input_bias_);
+  auto hidden_bias = contiguous_if_defined(hidden_bias_);
+
+  auto workspace = at::empty_like(input_gates);
+  auto hy = at::empty_like(cx);
+  auto cy = at::empty_like(cx);
+  lstm_cell_stub(kCPU, hy, cy, workspace, input_gates, hidden_gates, cx, input_bias, hidden_bias);
+  return std::make_tuple(hy, cy, workspace);
+}
+
+static void check_lstm_backward_sizes(const TensorArg& grad_hy, const TensorArg& grad_cy,
+                                      const TensorArg& cx, const TensorArg& cy,
+                                      const TensorArg& workspace) {
+  CheckedFrom c = "fused_lstm_cell_backward";
+  const TensorArg& defined_grad = grad_hy->defined() ? grad_hy : grad_cy;
+  checkDim(c, defined_grad, 2);
+  auto exp_size = defined_grad->sizes();
+  if (grad_hy->defined()) {
+    checkSize(c, grad_hy, exp_size);
+  }
+  if (grad_cy->defined()) {
+    checkSize(c, grad_cy, exp_size);
+  }
+  checkSize(c, cx, exp_size);
+  checkSize(c, cy, exp_size);
+  checkDim(c, workspace, 2);
+  checkNumel(c, workspace, exp_size[0] * exp_size[1] * 4);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_fused_lstm_cell_backward_cpu(
+      const Tensor& grad_hy_, const Tensor& grad_cy_,
+      const Tensor& cx_, const Tensor& cy_,
+      const Tensor& workspace_, bool has_bias) {
+  check_lstm_backward_sizes({grad_hy_, "grad_hy", 1}, {grad_cy_, "grad_cy", 2},
+                            {cx_, "cx", 3}, {cy_, "cy", 4},
+                            {workspace_, "workspace", 5});
+
+  auto grad_hy = contiguous_if_defined(grad_hy_);
+  auto grad_cy = contiguous_if_defined(grad_cy_);
+  auto cx = cx_.contiguous();
+  auto cy = cy_.contiguous();
+  auto workspace = workspace_.contiguous();
+
+  auto grad_gates = at::empty_like(workspace);
+  auto grad_cx = at::empty_like(cx);
+  lstm_cell_backward_stub(kCPU, grad_gates, grad_cx, grad_hy, grad_cy, cx, cy, workspace);
+
+  auto grad_bias = has_bias ? grad_gates.sum(0, /*keepdim=*/false) : at::Tensor{};
+  return std::make_tuple(grad_gates, grad_gates, grad_cx, grad_bias, grad_bias);
+}
+
+static constexpr int64_t GRU_WORKSPACE_MULTIPLIER = 5;
+
+std::tuple<Tensor, Tensor> _thnn_fused_gru_cell_cpu(
+      const Tensor& input_gates_, const Tensor& hidden_gates_,
+      const Tensor& hx_,
+      const Tensor& input_bias_, const Tensor& hidden_bias_) {
+  check_fused_cell_sizes("_thnn_fused_gru_cell_cpu",
+                         {input_gates_, "input_gates", 1}, {hidden_gates_, "hidden_gates", 2},
+                         {input_bias_, "input_bias", 3}, {hidden_bias_, "hidden_bias", 4},
+                         /*factor=*/3, {hx_, "prev_hidden", 5});
+
+  auto input_gates = input_gates_.contiguous();
+  auto hidden_gates = hidden_gates_.contiguous();
+  auto hx = hx_.contiguous();
+  auto input_bias = contiguous_if_defined(input_bias_);
+  auto hidden_bias = contiguous_if_defined(hidden_bias_);
+
+  auto workspace = at::empty({hx.size(0), hx.size(1) * GRU_WORKSPACE_MULTIPLIER}, hx.options());
+  auto hy = at::empty_like(hx);
+  gru_cell_stub(kCPU, hy, workspace, input_gates, hidden_gates, hx, input_bias, hidden_bias);
+  return std::make_tuple(hy, workspace);
+}
+
+static void check_gru_backward_sizes(const TensorArg& grad_hy, const TensorArg& workspace) {
+  CheckedFrom c = "fused_gru_cell_backward";
+  checkDim(c, grad_hy, 2);
+  checkSize(c, workspace, {grad_hy->size(0), grad_hy->size(1) * GRU_WORKSPACE_MULTIPLIER});
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_fused_gru_cell_backward_cpu(
+      const Tensor& grad_hy_, const Tensor& workspace_, bool has_bias) {
+  check_gru_backward_sizes({grad_hy_, "grad_hy", 1}, {workspace_, "workspace", 2});
+
+  auto grad_hy = grad_hy_.contiguous();
+  auto workspace = workspace_.contiguous();
+
+  int64_t hidden_size = workspace.size(1) / GRU_WORKSPACE_MULTIPLIER;
+  auto grad_input_gates = at::empty({workspace.size(0), hidden_size * 3}, workspace.options());
+  auto grad_hidden_gates = at::empty({workspace.size(0), hidden_size * 3}, workspace.options());
+  auto grad_hx = at::empty_like(grad_hy);
+  gru_cell_backward_stub(kCPU, grad_input_gates, grad_hidden_gates, grad_hx, grad_hy, workspace);
+
+  at::Tensor grad_input_bias, grad_hidden_bias;
+  if (has_bias) {
+    grad_input_bias = grad_input_gates.sum(0, /*keepdim=*/false);
+    grad_hidden_bias = grad_hidden_gates.sum(0, /*keepdim=*/false);
+  }
+
+  return std::make_tuple(grad_input_gates, grad_hidden_gates, grad_hx, grad_input_bias, grad_hidden_bias);
+}
+
+// Differentiable backward paths, alternatives to the fused backwards, used
+// when backward is itself creating a graph. They recompute the gates from the
+// inputs of the fused cells with differentiable ops, so that double backward
+// through the cells works.
+static Tensor add_bias_if_defined(const Tensor& gates, const Tensor& bias) {
+  return bias.defined() ? gates + bias : gates;
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_differentiable_lstm_cell_backward(
+      const Tensor& grad_hy, const Tensor& grad_cy,
+      const Tensor& input_gates, const Tensor& hidden_gates,
+      const Tensor& input_bias, const Tensor& hidden_bias,
+      const Tensor& cx) {
+  auto gates = add_bias_if_defined(add_bias_if_defined(input_gates + hidden_gates, input_bias), hidden_bias);
+  auto chunked_gates = gates.chunk(4, 1);
+  auto ingate = chunked_gates[0].sigmoid();
+  auto forgetgate = chunked_gates[1].sigmoid();
+  auto cellgate = chunked_gates[2].tanh();
+  auto outgate = chunked_gates[3].sigmoid();
+  auto tanh_cy = (forgetgate * cx + ingate * cellgate).tanh();
+
+  // the gradient of cy, including the part flowing through hy
+  Tensor gcy = grad_cy.defined() ? grad_cy : at::zeros_like(cx);
+  Tensor gog = at::zeros_like(outgate);
+  if (grad_hy.defined()) {
+    gcy = gcy + grad_hy * outgate * (1 - tanh_cy * tanh_cy);
+    gog = grad_hy * tanh_cy * outgate * (1 - outgate);
+  }
+  auto gig = gcy * cellgate * ingate * (1 - ingate);
+  auto gfg = gcy * cx * forgetgate * (1 - forgetgate);
+  auto gcg = gcy * ingate * (1 - cellgate * cellgate);
+  auto grad_gates = at::cat({gig, gfg, gcg, gog}, 1);
+  auto grad_cx = gcy * forgetgate;
+
+  auto grad_bias = input_bias.defined() ? grad_gates.sum(0, /*keepdim=*/false) : at::Tensor{};
+  return std::make_tuple(grad_gates, grad_gates, grad_cx, grad_bias, grad_bias);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> _thnn_differentiable_gru_cell_backward(
+      const Tensor& grad_hy,
+      const Tensor& input_gates, const Tensor& hidden_gates,
+      const Tensor& hx,
+      const Tensor& input_bias, const Tensor& hidden_bias) {
+  auto chunked_igates = add_bias_if_defined(input_gates, input_bias).chunk(3, 1);
+  auto chunked_hgates = add_bias_if_defined(hidden_gates, hidden_bias).chunk(3, 1);
+  auto reset_gate = (chunked_igates[0] + chunked_hgates[0]).sigmoid();
+  auto input_gate = (chunked_igates[1] + chunked_hgates[1]).sigmoid();
+  auto new_gate = (chunked_igates[2] + reset_gate * chunked_hgates[2]).tanh();
+
+  auto gig = grad_hy * (hx - new_gate) * input_gate * (1 - input_gate);
+  auto gng = grad_hy * (1 - input_gate) * (1 - new_gate * new_gate);
+  auto grg = gng * chunked_hgates[2] * reset_gate * (1 - reset_gate);
+  auto grad_input_gates = at::cat({grg, gig, gng}, 1);
+  auto grad_hidden_gates = at::cat({grg, gig, gng * reset_gate}, 1);
+  auto grad_hx = grad_hy * input_gate;
+
+  at::Tensor grad_input_bias, grad_hidden_bias;
+  if (input_bias.defined()) {
+    grad_input_bias = grad_input_gates.sum(0, /*keepdim=*/false);
+    grad_hidden_bias = grad_hidden_gates.sum(0, /*keepdim=*/false);
+  }
+
+  return std::make_tuple(grad_input_gates, grad_hidden_gates, grad_hx, grad_input_bias, grad_hidden_bias);
+}
+
 std::tuple<Tensor, Tensor> lstm_cell(
     const Tensor& input, TensorList hx,
     const Tensor& w_ih, const Tensor& w_hh, const Tensor& b_ih, const Tensor& b_hh) {
@@ -22,6 +22,7 @@ namespace native {
 DEFINE_DISPATCH(sum_stub);
 DEFINE_DISPATCH(prod_stub);
 DEFINE_DISPATCH(norm_kernel);
+DEFINE_DISPATCH(std_var_kernel);
 
 static inline Tensor integer_upcast(const Tensor& self, optional<ScalarType> dtype) {
   ScalarType scalarType = self.type().scalarType();
@@ -167,6 +168,13 @@ Tensor& cumprod_out(Tensor& result, const Tensor& self, int64_t dim) {
 
 // ALL REDUCE #################################################################
 
+// CPU kernels only read and write Half and BFloat16, and compute in float
+static inline bool is_cpu_reduced_floating(const Tensor& self) {
+  auto scalar_type = self.type().scalarType();
+  return self.type().backend() == Backend::CPU &&
+      (scalar_type == kHalf || scalar_type == kBFloat16);
+}
+
 static inline Tensor mean(const Tensor &self, optional<ScalarType> dtype) {
   ScalarType scalarType = self.type().scalarType();
   AT_CHECK(
@@ -175,6 +183,11 @@ static inline Tensor mean(const Tensor &self, optional<ScalarType> dtype) {
       toString(scalarType),
       " instead.");
   if (self.numel() > 0) {
+    if (is_cpu_reduced_floating(self)) {
+      // CPU Half and BFloat16 tensors are only stored as such, the mean is
+      // taken in float
+      return at::native::sum(self, kFloat).div_(self.numel()).toType(scalarType);
+    }
     Tensor result = at::native::sum(self);
     return result.div_(self.numel());
   } else {
@@ -204,9 +217,54 @@ static ScalarType get_dtype(Tensor& result, const Tensor& self, optional<ScalarT
   return src_type;
 }
 
+// Sums a CPU Half or BFloat16 tensor into a float accumulator, which is the
+// result for dtype=float, reading the input as is instead of converting it
+// first.
+static Tensor& sum_reduced_out(Tensor& result, const Tensor& self, IntList dim,
+                            bool keepdim, ScalarType dtype) {
+  AT_CHECK(
+      !result.defined() || result.type().scalarType() == dtype,
+      "sum: provided dtype must match dtype of result. Got ",
+      toString(result.type().scalarType()),
+      " and ",
+      toString(dtype),
+      ".");
+  int ndim = self.dim();
+  auto mask = make_dim_mask(dim, ndim);
+  Tensor acc;
+  if (dtype == kFloat) {
+    acc = result;
+  }
+  allocate_reduction_result(acc, self, mask, keepdim, kFloat);
+  auto viewed_acc = review_reduce_result(acc, ndim, mask, keepdim);
+  auto iter = TensorIterator::Builder()
+      .add_output(viewed_acc)
+      .add_input(self)
+      .dont_resize_outputs()
+      .dont_compute_common_dtype()
+      .build();
+  if (iter->numel() == 0) {
+    acc.zero_();
+  } else {
+    sum_stub(iter->device_type(), *iter);
+  }
+  if (dtype == kFloat) {
+    result = acc;
+  } else if (result.defined()) {
+    result.resize_(acc.sizes()).copy_(acc);
+  } else {
+    result = acc.toType(dtype);
+  }
+  return result;
+}
+
 static Tensor& sum_out(Tensor& result, const Tensor& self, IntList dim,
                        bool keepdim, optional<ScalarType> opt_dtype) {
   ScalarType dtype = get_dtype(result, self, opt_dtype, true);
+  if (is_cpu_reduced_floating(self) &&
+      (dtype == self.type().scalarType() || dtype == kFloat)) {
+    return sum_reduced_out(result, self, dim, keepdim, dtype);
+  }
   auto iter = make_reduction("sum", result, self, dim, keepdim, dtype);
   if (iter->numel() == 0) {
     result.zero_();
@@ -327,7 +385,9 @@ static inline Tensor mean(const Tensor &self, int64_t dim, bool keepdim, optiona
       "Can only calculate the mean of floating types. Got ",
       toString(scalarType),
       " instead.");
-  Tensor result = at::native::sum(self, dim, keepdim);
+  bool reduced = is_cpu_reduced_floating(self);
+  Tensor result = reduced ? at::native::sum(self, dim, keepdim, kFloat)
+                          : at::native::sum(self, dim, keepdim);
   if (result.numel() > 0 && self.ndimension() > 0) {
     int64_t numel = self.size(dim);
     if (numel > 0) {
@@ -337,7 +397,7 @@ static inline Tensor mean(const Tensor &self, int64_t dim, bool keepdim, optiona
       result.fill_(std::numeric_limits<double>::quiet_NaN());
     }
   }
-  return result;
+  return reduced ? result.toType(scalarType) : result;
 }
 
 Tensor mean(const Tensor& self, int64_t dim, bool keepdim, ScalarType dtype) {
@@ -494,12 +554,44 @@ Tensor &any_out(Tensor &result, const Tensor &self, int64_t dim, bool keepdim) {
   }
 }
 
+static Tensor _std_var_all(const Tensor& self, bool unbiased, bool take_sqrt) {
+  Tensor result = at::empty({}, self.options());
+  std_var_kernel(self.type().device_type(), result, self, c10::nullopt, unbiased, take_sqrt);
+  return result;
+}
+
+static Tensor& _std_var_out(Tensor& result, const Tensor& self, int64_t dim, bool unbiased, bool keepdim, bool take_sqrt) {
+  _dimreduce_setup(result, self, dim);
+  std_var_kernel(self.type().device_type(), result, self, dim, unbiased, take_sqrt);
+  if (!keepdim) {
+    result.squeeze_(dim);
+  }
+  return result;
+}
+
+// The CUDA kernel is a TensorIterator reduction, which handles any strides
+static bool _std_var_use_kernel(const Tensor& self) {
+  return self.type().backend() == Backend::CUDA ||
+      (self.type().backend() == Backend::CPU && self.is_contiguous());
+}
+
+static bool _std_var_use_kernel(const Tensor& self, const Tensor& result) {
+  return _std_var_use_kernel(self) &&
+      (self.type().backend() == Backend::CUDA || result.is_contiguous());
+}
+
 Tensor var(const Tensor& self, bool unbiased) {
   AT_CHECK(self.type().backend() == Backend::CPU || self.type().backend() == Backend::CUDA,
            "var only supports CPU AND CUDA backend, got: ", toString(self.type().backend()));
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "var only supports floating-point dtypes");
   auto trivial_return = _allreduce_return_trivial(self, std::numeric_limits<double>::quiet_NaN());
-  return trivial_return.has_value() ? trivial_return.value() : at::_th_var(self, unbiased);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  if (_std_var_use_kernel(self)) {
+    return _std_var_all(self, unbiased, /*take_sqrt=*/false);
+  }
+  return at::_th_var(self, unbiased);
 }
 
 Tensor var(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
@@ -514,6 +606,8 @@ Tensor &var_out(Tensor &result, const Tensor &self, int64_t dim, bool unbiased,
   dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, std::numeric_limits<double>::quiet_NaN(), dim, keepdim)) {
     return result;
+  } else if (_std_var_use_kernel(self, result)) {
+    return _std_var_out(result, self, dim, unbiased, keepdim, /*take_sqrt=*/false);
   } else {
     return at::_th_var_out(result, self, dim, unbiased, keepdim);
   }
@@ -524,7 +618,13 @@ Tensor std(const Tensor& self, bool unbiased) {
            "std only supports CPU AND CUDA backend, got: ", toString(self.type().backend()));
   AT_CHECK(at::isFloatingType(self.type().scalarType()), "std only supports floating-point dtypes");
   auto trivial_return = _allreduce_return_trivial(self, std::numeric_limits<double>::quiet_NaN());
-  return trivial_return.has_value() ? trivial_return.value() : at::_th_std(self, unbiased);
+  if (trivial_return.has_value()) {
+    return trivial_return.value();
+  }
+  if (_std_var_use_kernel(self)) {
+    return _std_var_all(self, unbiased, /*take_sqrt=*/true);
+  }
+  return at::_th_std(self, unbiased);
 }
 
 Tensor std(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
@@ -539,6 +639,8 @@ Tensor &std_out(Tensor &result, const Tensor &self, int64_t dim, bool unbiased,
   dim = maybe_wrap_dim(dim, self.dim());
   if (_dimreduce_return_trivial(result, self, std::numeric_limits<double>::quiet_NaN(), dim, keepdim)) {
     return result;
+  } else if (_std_var_use_kernel(self, result)) {
+    return _std_var_out(result, self, dim, unbiased, keepdim, /*take_sqrt=*/true);
   } else {
     return at::_th_std_out(result, self, dim, unbiased, keepdim);
   }
@@ -19,4 +19,8 @@ using reduce_norm_fn =
     void (*)(Tensor&, const Tensor&, Scalar, c10::optional<int64_t>);
 DECLARE_DISPATCH(reduce_norm_fn, norm_kernel);
 
+using reduce_std_var_fn =
+    void (*)(Tensor&, const Tensor&, c10::optional<int64_t>, bool, bool);
+DECLARE_DISPATCH(reduce_std_var_fn, std_var_kernel);
+
 }} // namespace at::native
@@ -1,6 +1,12 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <tuple>
+#include <vector>
 
 namespace at {
 namespace native {
@@ -48,80 +54,94 @@ std::tuple<at::Tensor, at::Tensor> RoiPooling2d_forward_cpu(
   auto *rawOutput = output.data<float>();
   auto *rawArgmaxes = argmaxes.data<int>();
   auto outputChannelStride = pooledHeight * pooledWidth;
+  auto outputProposalStride = inputChannels * outputChannelStride;
+  auto batchSize = input.size(0);
 
   // Now that our Tensors are properly sized, we can perform the pooling operation.
-  // We iterate over each RoI and perform pooling on each channel in the input, to
-  // generate a pooledHeight x pooledWidth output for each RoI
-  for (auto i = 0; i < proposals; ++i) {
-    auto n = static_cast<int>(rawRois[0]);
-    auto startWidth = static_cast<int>(std::round(rawRois[1] * spatialScale));
-    auto startHeight = static_cast<int>(std::round(rawRois[2] * spatialScale));
-    auto endWidth = static_cast<int>(std::round(rawRois[3] * spatialScale));
-    auto endHeight = static_cast<int>(std::round(rawRois[4] * spatialScale));
-
-    // TODO: assertions for valid values?
-    // TODO: fix malformed ROIs??
-
-    auto roiHeight = endHeight - startHeight;
-    auto roiWidth = endWidth - startWidth;
-
-    // Because the Region of Interest can be of variable size, but our output
-    // must always be (pooledHeight x pooledWidth), we need to split the RoI
-    // into a pooledHeight x pooledWidth grid of tiles
+  // The RoIs write disjoint slices of the output, so they are pooled in parallel,
+  // each one on every channel in the input, to generate a pooledHeight x
+  // pooledWidth output for each RoI
+  auto grainSize = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, outputProposalStride));
+  parallel_for(0, proposals, grainSize, [&](int64_t begin, int64_t end) {
+    // Tile bounds only depend on the RoI, so they are computed once and shared
+    // by all channels
+    std::vector<int64_t> tileBounds(4 * outputChannelStride);
+    for (auto i = begin; i < end; ++i) {
+      auto *roi = rawRois + i * roiProposalStride;
+      auto n = static_cast<int64_t>(roi[0]);
+      AT_CHECK(n >= 0 && n < batchSize, "RoI ", i, " has batch index ", n,
+               " out of range for an input batch of size ", batchSize);
+      auto startWidth = static_cast<int>(std::round(roi[1] * spatialScale));
+      auto startHeight = static_cast<int>(std::round(roi[2] * spatialScale));
+      auto endWidth = static_cast<int>(std::round(roi[3] * spatialScale));
+      auto endHeight = static_cast<int>(std::round(roi[4] * spatialScale));
+
+      // TODO: fix malformed ROIs??
+
+      auto roiHeight = endHeight - startHeight;
+      auto roiWidth = endWidth - startWidth;
+
+      // Because the Region of Interest can be of variable size, but our output
+      // must always be (pooledHeight x pooledWidth), we need to split the RoI
+      // into a pooledHeight x pooledWidth grid of tiles
+
+      auto tileHeight = static_cast<float>(roiHeight) / static_cast<float>(pooledHeight);
+      auto tileWidth = static_cast<float>(roiWidth) / static_cast<float>(pooledWidth);
 
-    auto tileHeight = static_cast<float>(roiHeight) / static_cast<float>(pooledHeight);
-    auto tileWidth = static_cast<float>(roiWidth) / static_cast<float>(pooledWidth);
-
-    auto *rawInputBatch = rawInput + (n * inputBatchStride);
-
-    // Compute pooling for each of the (pooledHeight x pooledWidth) tiles for each
-    // channel in the input
-    for (auto ch = 0; ch < inputChannels; ++ch) {
       for (auto ph = 0; ph < pooledHeight; ++ph) {
         for (auto pw = 0; pw < pooledWidth; ++pw) {
           auto tileHStart = static_cast<int64_t>(std::floor(ph * tileHeight));
-          auto tileWStart =	static_cast<int64_t>(std::floor(pw * tileWidth));
+          auto tileWStart = static_cast<int64_t>(std::floor(pw * tileWidth));
           auto tileHEnd = static_cast<int64_t>(std::ceil((ph + 1) * tileHeight));
           auto tileWEnd = static_cast<int64_t>(std::ceil((pw + 1) * tileWidth));
 
           // Add tile offsets to RoI offsets, and clip to input boundaries
-          tileHStart = std::min(std::max<int64_t>(tileHStart + startHeight, 0), inputHeight);
-          tileWStart = std::min(std::max<int64_t>(tileWStart + startWidth, 0), inputWidth);
-          tileHEnd = std::min(std::max<int64_t>(tileHEnd + startHeight, 0), inputHeight);
-          tileWEnd = std::min(std::max<int64_t>(tileWEnd + startWidth, 0), inputWidth);
+          auto *bounds = &tileBounds[4 * ((ph * pooledWidth) + pw)];
+          bounds[0] = std::min(std::max<int64_t>(tileHStart + startHeight, 0), inputHeight);
+          bounds[1] = std::min(std::max<int64_t>(tileWStart + startWidth, 0), inputWidth);
+          bounds[2] = std::min(std::max<int64_t>(tileHEnd + startHeight, 0), inputHeight);
+          bounds[3] = std::min(std::max<int64_t>(tileWEnd + startWidth, 0), inputWidth);
+        }
+      }
 
-          auto poolIndex = (ph * pooledWidth) + pw;
+      auto *rawInputBatch = rawInput + (n * inputBatchStride);
+      auto *rawOutputRoi = rawOutput + (i * outputProposalStride);
+      // TODO: make optional for test
+      auto *rawArgmaxesRoi = rawArgmaxes + (i * outputProposalStride);
+
+      // Compute pooling for each of the (pooledHeight x pooledWidth) tiles for each
+      // channel in the input
+      for (auto ch = 0; ch < inputChannels; ++ch) {
+        for (auto poolIndex = 0; poolIndex < outputChannelStride; ++poolIndex) {
+          const auto *bounds = &tileBounds[4 * poolIndex];
 
           // If our pooling region is empty, we set the output to 0, otherwise to
           // the min float so we can calculate the max properly
-          auto empty = tileHStart >= tileHEnd || tileWStart >= tileWEnd;
-          rawOutput[poolIndex] = empty ? 0 : std::numeric_limits<float>::min();
+          auto empty = bounds[0] >= bounds[2] || bounds[1] >= bounds[3];
+          auto max = empty ? 0 : std::numeric_limits<float>::min();
 
           // Set to -1 so we don't try to backprop to anywhere
-          // TODO: make optional for test
-          rawArgmaxes[poolIndex] = -1;
+          int maxIndex = -1;
 
-          for (auto th = tileHStart; th < tileHEnd; ++th) {
-            for (auto tw = tileWStart; tw < tileWEnd; ++tw) {
+          for (auto th = bounds[0]; th < bounds[2]; ++th) {
+            for (auto tw = bounds[1]; tw < bounds[3]; ++tw) {
               auto index = (th * inputWidth) + tw;
-              if (rawInputBatch[index] > rawOutput[poolIndex]) {
-                rawOutput[poolIndex] = rawInputBatch[index];
-                // TODO: make optional for test
-                rawArgmaxes[poolIndex] = index;
+              if (rawInputBatch[index] > max) {
+                max = rawInputBatch[index];
+                maxIndex = index;
               }
             }
           }
+          rawOutputRoi[poolIndex] = max;
+          rawArgmaxesRoi[poolIndex] = maxIndex;
         }
+        // Increment raw pointers by channel stride
+        rawInputBatch += inputChannelStride;
+        rawOutputRoi += outputChannelStride;
+        rawArgmaxesRoi += outputChannelStride;
       }
-      // Increment raw pointers by channel stride
-      rawInputBatch += inputChannelStride;
-      rawOutput += outputChannelStride;
-      // TODO: make optional for test
-      rawArgmaxes += outputChannelStride;
     }
-    // Increment RoI raw pointer
-    rawRois += roiProposalStride;
-  }
+  });
 
   return std::make_tuple(output, argmaxes);
 }
@@ -134,7 +154,74 @@ Tensor RoiPooling2d_backward_cpu(
   double spatialScale,
   const Tensor& gradOutput,
   const Tensor& argmaxes) {
-  AT_ERROR("not implemented");
+  AT_CHECK(input.ndimension() == 4, "Input to RoI Pooling should be a NCHW Tensor");
+  AT_CHECK(rois.ndimension() == 2 && rois.size(1) == 5,
+           "Proposals should be of the form [batch_index startW startH endW enH]");
+  AT_CHECK(rois.is_contiguous(), "rois must be contiguous");
+
+  auto proposals = rois.size(0);
+  auto inputChannels = input.size(1);
+  auto inputChannelStride = input.size(2) * input.size(3);
+  auto inputBatchStride = inputChannels * inputChannelStride;
+  auto outputChannelStride = pooledHeight * pooledWidth;
+  auto outputProposalStride = inputChannels * outputChannelStride;
+  AT_CHECK(gradOutput.numel() == proposals * outputProposalStride &&
+           argmaxes.numel() == gradOutput.numel(),
+           "gradOutput and argmaxes should be of size (num_rois, C, pooledHeight, pooledWidth)");
+
+  auto gradOutputContig = gradOutput.contiguous();
+  auto argmaxesContig = argmaxes.contiguous();
+  auto *rawGradOutput = gradOutputContig.data<float>();
+  auto *rawArgmaxes = argmaxesContig.data<int>();
+  auto *rawRois = rois.data<float>();
+  auto roiProposalStride = rois.size(1);
+
+  auto gradInput = at::zeros(input.sizes(), input.options());
+
+  // Several RoIs can take the max from the same input element, so the RoIs
+  // are split in chunks which scatter into buffers of their own, summed after.
+  // There is only one chunk per thread, and only as many as there are RoI
+  // elements to scatter for the buffers to be worth zeroing and reducing.
+  auto numChunks = std::max<int64_t>(1, std::min<int64_t>(
+      get_max_threads(),
+      gradOutput.numel() / std::max<int64_t>(inputBatchStride * input.size(0), internal::GRAIN_SIZE)));
+  Tensor buffers;
+  if (numChunks > 1) {
+    auto bufferSizes = input.sizes().vec();
+    bufferSizes.insert(bufferSizes.begin(), numChunks - 1);
+    buffers = at::zeros(bufferSizes, input.options());
+  }
+
+  parallel_for(0, numChunks, 1, [&](int64_t begin, int64_t end) {
+    for (auto chunk = begin; chunk < end; ++chunk) {
+      // The first chunk accumulates into gradInput itself
+      auto *rawGradInput = chunk == 0
+          ? gradInput.data<float>()
+          : buffers.data<float>() + (chunk - 1) * gradInput.numel();
+      for (auto i = proposals * chunk / numChunks; i < proposals * (chunk + 1) / numChunks; ++i) {
+        auto n = static_cast<int64_t>(rawRois[i * roiProposalStride]);
+        auto *rawGradInputBatch = rawGradInput + (n * inputBatchStride);
+        auto *rawGradOutputRoi = rawGradOutput + (i * outputProposalStride);
+        auto *rawArgmaxesRoi = rawArgmaxes + (i * outputProposalStride);
+        for (auto ch = 0; ch < inputChannels; ++ch) {
+          for (auto poolIndex = 0; poolIndex < outputChannelStride; ++poolIndex) {
+            auto argmax = rawArgmaxesRoi[poolIndex];
+            if (argmax != -1) {
+              rawGradInputBatch[argmax] += rawGradOutputRoi[poolIndex];
+            }
+          }
+          rawGradInputBatch += inputChannelStride;
+          rawGradOutputRoi += outputChannelStride;
+          rawArgmaxesRoi += outputChannelStride;
+        }
+      }
+    }
+  });
+
+  if (numChunks > 1) {
+    gradInput.add_(buffers.sum(0));
+  }
+  return gradInput;
 }
 
 }
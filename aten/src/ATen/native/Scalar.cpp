@@ -17,6 +17,9 @@ Scalar _local_scalar(const Tensor& self) {
 }
 
 Scalar _local_scalar_dense_cpu(const Tensor& self) {
+  if (self.type().scalarType() == kBFloat16) {
+    return Scalar(*self.data<BFloat16>());
+  }
   Scalar r;
   AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX(
       self.type(), "_local_scalar_dense_cpu", [&] {
@@ -1,5 +1,6 @@
 #include "ATen/ATen.h"
 #include "ATen/AccumulateType.h"
+#include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/Parallel.h"
 #include "ATen/TensorUtils.h"
@@ -217,6 +218,22 @@ Tensor log_softmax_backward_cpu(
   return grad_input;
 }
 
+Tensor scaled_masked_softmax_cpu(const Tensor& input, const Tensor& mask, double scale) {
+  AT_CHECK(input.dim() > 0, "_scaled_masked_softmax: expected an input with at least one dimension");
+  Tensor scaled = input * scale;
+  if (mask.defined()) {
+    AT_CHECK(is_expandable_to(mask.sizes(), input.sizes()),
+             "_scaled_masked_softmax: mask of size ", mask.sizes(),
+             " can't be broadcast to the input of size ", input.sizes());
+    scaled.add_(mask);
+  }
+  return at::_softmax(scaled, -1, false);
+}
+
+Tensor scaled_masked_softmax_backward_cpu(const Tensor& grad, const Tensor& output, double scale) {
+  return at::_softmax_backward_data(grad, output, -1, output).mul_(scale);
+}
+
 Tensor softmax(const Tensor& input_, const int64_t dim_) {
   return at::_softmax(input_, dim_, false);
 }
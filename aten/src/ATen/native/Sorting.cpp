@@ -0,0 +1,69 @@
+#include <ATen/native/Sorting.h>
+
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/WrapDimUtils.h>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(sort_stub);
+DEFINE_DISPATCH(topk_stub);
+DEFINE_DISPATCH(kthvalue_stub);
+
+// The CPU kernels take every slice along a dimension; zero-dim tensors, Half
+// and CUDA stay with TH.
+static bool use_sorting_kernel(const Tensor& self) {
+  return self.type().backend() == Backend::CPU && self.dim() > 0 &&
+      self.scalar_type() != kHalf;
+}
+
+static void check_sorting_outputs(const Tensor& values, const Tensor& indices, const Tensor& self,
+                                  const char* fn_name) {
+  AT_CHECK(values.type() == self.type(), fn_name, ": expected values to be of type ",
+           self.type(), " but got ", values.type());
+  AT_CHECK(indices.scalar_type() == kLong, fn_name, ": expected indices to be of scalar type Long but got ",
+           indices.scalar_type());
+}
+
+std::tuple<Tensor&, Tensor&> sort_out(Tensor& values, Tensor& indices, const Tensor& self, int64_t dim, bool descending) {
+  if (!use_sorting_kernel(self)) {
+    return at::_th_sort_out(values, indices, self, dim, descending);
+  }
+  check_sorting_outputs(values, indices, self, "sort");
+  dim = maybe_wrap_dim(dim, self.dim());
+  values.resize_(self.sizes());
+  indices.resize_(self.sizes());
+  sort_stub(kCPU, values, indices, self, dim, descending);
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> sort(const Tensor& self, int64_t dim, bool descending) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return at::native::sort_out(values, indices, self, dim, descending);
+}
+
+std::tuple<Tensor&, Tensor&> topk_out(Tensor& values, Tensor& indices, const Tensor& self,
+                                      int64_t k, int64_t dim, bool largest, bool sorted) {
+  if (!use_sorting_kernel(self)) {
+    return at::_th_topk_out(values, indices, self, k, dim, largest, sorted);
+  }
+  check_sorting_outputs(values, indices, self, "topk");
+  dim = maybe_wrap_dim(dim, self.dim());
+  AT_CHECK(k >= 0 && k <= self.size(dim), "k not in range for dimension");
+  std::vector<int64_t> sizes = self.sizes().vec();
+  sizes[dim] = k;
+  values.resize_(sizes);
+  indices.resize_(sizes);
+  topk_stub(kCPU, values, indices, self, k, dim, largest, sorted);
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> topk(const Tensor& self, int64_t k, int64_t dim, bool largest, bool sorted) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return at::native::topk_out(values, indices, self, k, dim, largest, sorted);
+}
+
+}} // namespace at::native
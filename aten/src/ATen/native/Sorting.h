@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// The kernels order NaN after every other value, and write into values and
+// indices that the caller has already resized: to the sizes of self for
+// sort, with k or 1 elements along dim for topk and kthvalue.
+
+using sort_fn = void(*)(Tensor& values, Tensor& indices, const Tensor& self,
+                        int64_t dim, bool descending);
+using topk_fn = void(*)(Tensor& values, Tensor& indices, const Tensor& self,
+                        int64_t k, int64_t dim, bool largest, bool sorted);
+using kthvalue_fn = void(*)(Tensor& values, Tensor& indices, const Tensor& self,
+                            int64_t k, int64_t dim);
+
+DECLARE_DISPATCH(sort_fn, sort_stub);
+DECLARE_DISPATCH(topk_fn, topk_stub);
+DECLARE_DISPATCH(kthvalue_fn, kthvalue_stub);
+
+}} // namespace at::native
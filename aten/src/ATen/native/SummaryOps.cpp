@@ -1,15 +1,56 @@
-// Returns the frequency of elements of input non-negative integer tensor.
+// Returns the frequency of elements of input non-negative integer tensor,
+// and the histogram of a floating point tensor.
 
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
 
+#include <algorithm>
 #include <tuple>
+#include <vector>
 
 namespace at { namespace native {
 
-///////////////// bincount /////////////////
 namespace {
 
+// Fills hist, of nbins zeroed bins, with add(bins, i) adding the element i of
+// n to bins. Large inputs are split into a chunk per thread, each counting
+// into bins of its own, which are summed into hist at the end, so that threads
+// don't contend for the bins of frequent values. A chunk has at least as many
+// elements as bins, for counting it to outweigh clearing and summing its bins.
+template <typename hist_t, typename Add>
+void histogram_cpu(hist_t* hist, int64_t nbins, int64_t n, const Add& add) {
+  const int64_t num_chunks = std::min<int64_t>(
+      get_max_threads(), n / std::max(nbins, internal::GRAIN_SIZE));
+  if (num_chunks <= 1) {
+    for (int64_t i = 0; i < n; i++) {
+      add(hist, i);
+    }
+    return;
+  }
+  std::vector<hist_t> private_bins(num_chunks * nbins, hist_t(0));
+  const int64_t chunk_size = divup(n, num_chunks);
+  parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      hist_t* bins = private_bins.data() + chunk * nbins;
+      const int64_t chunk_end = std::min(n, (chunk + 1) * chunk_size);
+      for (int64_t i = chunk * chunk_size; i < chunk_end; i++) {
+        add(bins, i);
+      }
+    }
+  });
+  parallel_for(0, nbins, internal::GRAIN_SIZE / num_chunks, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = 0; chunk < num_chunks; chunk++) {
+      const hist_t* bins = private_bins.data() + chunk * nbins;
+      for (int64_t bin = begin; bin < end; bin++) {
+        hist[bin] += bins[bin];
+      }
+    }
+  });
+}
+
+///////////////// bincount /////////////////
+
 template <typename input_t, typename weights_t>
 Tensor _bincount_cpu_template(
     const Tensor& self,
@@ -34,23 +75,51 @@ Tensor _bincount_cpu_template(
   int64_t nbins = static_cast<int64_t>(*self.max().data<input_t>()) + 1L;
   nbins = std::max(nbins, minlength); // at least minlength # of bins
 
-  const input_t* self_p = self.contiguous().data<input_t>();
+  Tensor self_contig = self.contiguous();
+  const input_t* self_p = self_contig.data<input_t>();
   if (has_weights) {
     output = native::zeros({nbins}, weights.options());
-    weights_t* output_p = output.data<weights_t>();
-    const weights_t* weights_p = weights.contiguous().data<weights_t>();
-    for (int64_t i = 0; i < self.size(0); i++) {
-      output_p[self_p[i]] += weights_p[i];
-    }
+    Tensor weights_contig = weights.contiguous();
+    const weights_t* weights_p = weights_contig.data<weights_t>();
+    histogram_cpu(output.data<weights_t>(), nbins, self.size(0), [&](weights_t* bins, int64_t i) {
+      bins[self_p[i]] += weights_p[i];
+    });
   } else {
     output = native::zeros({nbins}, kLong);
-    int64_t* output_p = output.data<int64_t>();
-    for (int64_t i = 0; i < self.size(0); i++) {
-      output_p[self_p[i]] += 1L;
-    }
+    histogram_cpu(output.data<int64_t>(), nbins, self.size(0), [&](int64_t* bins, int64_t i) {
+      bins[self_p[i]] += 1L;
+    });
   }
   return output;
 }
+
+///////////////// histc /////////////////
+// As THTensor_(histc): the elements in [min, max] are counted into bins of
+// equal width, and min and max default to those of the elements.
+template <typename scalar_t>
+void _histc_cpu_template(Tensor& hist, const Tensor& self, int64_t nbins, Scalar min, Scalar max) {
+  AT_CHECK(nbins > 0, "bins must be > 0");
+  hist.resize_({nbins}).zero_();
+  scalar_t minval = min.to<scalar_t>();
+  scalar_t maxval = max.to<scalar_t>();
+  if (minval == maxval) {
+    minval = self.min().item<scalar_t>();
+    maxval = self.max().item<scalar_t>();
+  }
+  if (minval == maxval) {
+    minval = minval - 1;
+    maxval = maxval + 1;
+  }
+  Tensor self_contig = self.contiguous();
+  const scalar_t* self_p = self_contig.data<scalar_t>();
+  histogram_cpu(hist.data<scalar_t>(), nbins, self.numel(), [&](scalar_t* bins, int64_t i) {
+    const scalar_t value = self_p[i];
+    if (value >= minval && value <= maxval) {
+      const int64_t bin = static_cast<int64_t>((value - minval) / (maxval - minval) * nbins);
+      bins[std::min(bin, nbins - 1)] += 1;
+    }
+  });
+}
 } // namespace
 
 Tensor
@@ -64,4 +133,21 @@ _bincount_cpu(const Tensor& self, const Tensor& weights, int64_t minlength) {
   });
 }
 
+Tensor& histc_out(Tensor& result, const Tensor& self, int64_t bins, Scalar min, Scalar max) {
+  if (self.type().backend() != Backend::CPU ||
+      (self.type().scalarType() != kFloat && self.type().scalarType() != kDouble) ||
+      result.type() != self.type()) {
+    return at::_th_histc_out(result, self, bins, min, max);
+  }
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "histc", [&] {
+    _histc_cpu_template<scalar_t>(result, self, bins, min, max);
+  });
+  return result;
+}
+
+Tensor histc(const Tensor& self, int64_t bins, Scalar min, Scalar max) {
+  Tensor result = at::empty({0}, self.options());
+  return at::native::histc_out(result, self, bins, min, max);
+}
+
 }} // namespace at::native
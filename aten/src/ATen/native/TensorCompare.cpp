@@ -4,6 +4,7 @@
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
 #include "ReduceOpsUtils.h"
+#include "Sorting.h"
 #include "c10/util/Exception.h"
 #include "cpu/TensorCompareKernel.h"
 
@@ -107,8 +108,18 @@ std::tuple<Tensor &,Tensor &> kthvalue_out(Tensor& values, Tensor& indices,
     AT_ASSERT(values.dim() == 0);
     indices.resize_({}).fill_(0);
     return std::forward_as_tuple(values, indices);
-  } else {
+  } else if (self.is_cuda() || self.scalar_type() == kHalf) {
     return at::_th_kthvalue_out(values, indices, self, k, dim, keepdim);
+  } else {
+    AT_CHECK(k >= 1 && k <= self.size(dim), "selected index out of range");
+    _dimreduce_setup(values, self, dim);
+    _dimreduce_setup(indices, self, dim);
+    kthvalue_stub(kCPU, values, indices, self, k, dim);
+    if (!keepdim) {
+      values.squeeze_(dim);
+      indices.squeeze_(dim);
+    }
+    return std::forward_as_tuple(values, indices);
   }
 }
 
@@ -9,6 +9,7 @@
 #include "ATen/CheckGenerator.h"
 #include "ATen/Dispatch.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include "ATen/ScalarType.h"
 #include "ATen/core/Deprecated.h"
 #include "ATen/core/TensorOptions.h"
@@ -458,6 +459,79 @@ void randperm_cpu(Tensor& result, int64_t n, THGenerator* generator) {
     r__data[(z+i)*r__stride_0] = sav;
   }
 }
+
+// Permutations of at least two buckets of this many indices are generated in
+// parallel, with at most kRandpermMaxBuckets buckets. The number of buckets
+// only depends on n, so that the permutation for a seed does not depend on
+// the number of threads.
+constexpr int64_t kRandpermBucketSize = 1 << 20;
+constexpr int64_t kRandpermMaxBuckets = 1 << 10;
+
+// The splitmix64 generator, which gives the random number for a counter
+inline uint64_t randperm_random(uint64_t seed, uint64_t counter) {
+  uint64_t z = seed + (counter + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Sends every index to one of num_buckets buckets at random, and then shuffles
+// every bucket with Fisher-Yates. Both steps are uniform, so the permutation
+// is too. The indices are read in as many chunks as there are buckets; each
+// chunk counts how many of its indices go to every bucket, so that it can
+// then write them there without synchronizing with the other chunks.
+template <typename scalar_t>
+void randperm_cpu_parallel(Tensor& result, int64_t n, int64_t num_buckets,
+                           uint64_t bucket_seed, uint64_t shuffle_seed) {
+  scalar_t *r__data = result.data<scalar_t>();
+  int64_t r__stride_0 = result.stride(0);
+  auto bucket_of = [&](int64_t i) {
+    return static_cast<int64_t>(randperm_random(bucket_seed, i) % num_buckets);
+  };
+
+  // offsets[c * num_buckets + b] is where chunk c writes its indices going to
+  // bucket b
+  std::vector<int64_t> offsets(num_buckets * num_buckets, 0);
+  parallel_for(0, num_buckets, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t* counts = &offsets[c * num_buckets];
+      for (int64_t i = n * c / num_buckets; i < n * (c + 1) / num_buckets; i++) {
+        counts[bucket_of(i)]++;
+      }
+    }
+  });
+  std::vector<int64_t> bucket_begin(num_buckets + 1);
+  int64_t offset = 0;
+  for (int64_t b = 0; b < num_buckets; b++) {
+    bucket_begin[b] = offset;
+    for (int64_t c = 0; c < num_buckets; c++) {
+      int64_t count = offsets[c * num_buckets + b];
+      offsets[c * num_buckets + b] = offset;
+      offset += count;
+    }
+  }
+  bucket_begin[num_buckets] = n;
+
+  parallel_for(0, num_buckets, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t* chunk_offsets = &offsets[c * num_buckets];
+      for (int64_t i = n * c / num_buckets; i < n * (c + 1) / num_buckets; i++) {
+        r__data[(chunk_offsets[bucket_of(i)]++)*r__stride_0] = static_cast<scalar_t>(i);
+      }
+    }
+  });
+
+  parallel_for(0, num_buckets, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      int64_t first = bucket_begin[b];
+      int64_t size = bucket_begin[b + 1] - first;
+      for (int64_t i = 0; i < size - 1; i++) {
+        int64_t z = randperm_random(shuffle_seed, first + i) % (size - i);
+        std::swap(r__data[(first + i)*r__stride_0], r__data[(first + z + i)*r__stride_0]);
+      }
+    }
+  });
+}
 } // namespace
 
 
@@ -484,8 +558,23 @@ Tensor& randperm_out_cpu(Tensor& result, int64_t n, Generator* generator) {
   AT_CHECK(n >= 0, "n must be non-negative, got", n);
   result.resize_({n});
   auto gen = get_generator(generator);
+  auto num_buckets = std::min(n / kRandpermBucketSize, kRandpermMaxBuckets);
+  if (num_buckets < 2) {
+    AT_DISPATCH_ALL_TYPES(result.type(), "randperm", [&]() -> void {
+      randperm_cpu<scalar_t>(result, n, gen);
+    });
+    return result;
+  }
+
+  // Only the seeds are drawn under the generator lock
+  uint64_t bucket_seed, shuffle_seed;
+  {
+    std::lock_guard<std::mutex> lock(gen->mutex);
+    bucket_seed = THRandom_random64(gen);
+    shuffle_seed = THRandom_random64(gen);
+  }
   AT_DISPATCH_ALL_TYPES(result.type(), "randperm", [&]() -> void {
-    randperm_cpu<scalar_t>(result, n, gen);
+    randperm_cpu_parallel<scalar_t>(result, n, num_buckets, bucket_seed, shuffle_seed);
   });
 
   return result;
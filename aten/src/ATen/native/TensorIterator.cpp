@@ -112,6 +112,16 @@ static bool needs_cast(const Tensor& tensor, const Type& dst_type) {
 }
 
 void TensorIterator::compute_common_type() {
+  if (!compute_common_dtype_) {
+    for (auto& op : operands_) {
+      AT_ASSERT(op.tensor.defined());
+      if (!op.type) {
+        op.type = &op.tensor.type();
+      }
+    }
+    return;
+  }
+
   // See [Result type computation] in TensorIterator.h
   auto result_type = ScalarType::Undefined;
   auto backend = Backend::Undefined;
@@ -167,6 +177,63 @@ DimVector TensorIterator::invert_perm(IntList input) const {
   return res;
 }
 
+bool TensorIterator::fast_set_up() {
+  // Handles the common case where every operand is either contiguous with
+  // the same shape, or a zero-dim tensor that is broadcast over the others.
+  // The result is a 1-d iterator over numel() elements, so we can skip
+  // broadcasting, re-ordering and coalescing dimensions, which dominate the
+  // cost of building an iterator for small tensors.
+  IntList shape;
+  bool has_shape = false;
+  for (int arg = num_outputs_; arg < ntensors(); arg++) {
+    auto& tensor = operands_[arg].tensor;
+    if (!tensor.defined()) {
+      return false;
+    }
+    if (tensor.dim() == 0) {
+      continue;
+    }
+    if (!has_shape) {
+      shape = tensor.sizes();
+      has_shape = true;
+    } else if (!tensor.sizes().equals(shape)) {
+      return false;
+    }
+    if (!tensor.is_contiguous()) {
+      return false;
+    }
+  }
+  if (!has_shape) {
+    return false;
+  }
+  // Outputs that need to be resized or that are not contiguous take the
+  // general path.
+  for (int i = 0; i < num_outputs_; i++) {
+    auto& tensor = operands_[i].tensor;
+    if (tensor.defined() && (!tensor.sizes().equals(shape) || !tensor.is_contiguous())) {
+      return false;
+    }
+  }
+
+  compute_common_type();
+
+  int64_t numel = 1;
+  for (int64_t size : shape) {
+    numel *= size;
+  }
+  shape_ = { numel };
+  perm_ = { 0 };
+  for (auto& op : operands_) {
+    if (!op.tensor.defined()) {
+      op.tensor = at::empty(shape, op.type->options());
+    }
+    int64_t stride = op.tensor.dim() == 0 ? 0 : op.tensor.type().elementSizeInBytes();
+    op.stride_bytes = { stride };
+  }
+  has_coalesced_dimensions_ = true;
+  return true;
+}
+
 void TensorIterator::allocate_outputs() {
   for (int i = 0; i < num_outputs_; i++) {
     auto& op = operands_[i];
@@ -338,7 +405,21 @@ static loop2d_t loop_wrapper(const loop_t& loop) {
 }
 
 void TensorIterator::for_each(const loop_t& loop) {
-  for_each(loop_wrapper(loop));
+  if (ndim() > 1) {
+    return for_each(loop_wrapper(loop));
+  }
+  // 1-d iterators call the inner loop directly, without wrapping it in a
+  // 2-d loop (which heap-allocates a copy of the std::function).
+  int64_t numel = this->numel();
+  if (numel == 0) {
+    return;
+  } else if (numel < internal::GRAIN_SIZE || at::get_max_threads() == 1) {
+    return serial_for_each(loop, {0, numel});
+  } else {
+    at::parallel_for(0, numel, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      serial_for_each(loop, {begin, end});
+    });
+  }
 }
 
 void TensorIterator::for_each(const loop2d_t& loop) {
@@ -365,7 +446,12 @@ DimVector TensorIterator::get_strides() const {
 }
 
 void TensorIterator::serial_for_each(const loop_t& loop, Range range) const {
-  serial_for_each(loop_wrapper(loop), range);
+  if (ndim() > 1) {
+    return serial_for_each(loop_wrapper(loop), range);
+  }
+  auto strides = get_inner_strides();
+  auto ptrs = get_data_ptrs(get_base_ptrs(), { range.begin });
+  loop(ntensors(), ptrs.data(), strides.data(), range.size());
 }
 
 void TensorIterator::serial_for_each(const loop2d_t& loop, Range range) const {
@@ -458,7 +544,21 @@ std::unique_ptr<TensorIterator> TensorIterator::reduce_op(Tensor& out, const Ten
   auto builder = TensorIterator::Builder();
   builder.add_output(out);
   builder.add_input(a);
-  builder.iter_->resize_outputs_ = false;
+  builder.dont_resize_outputs();
+  return builder.build();
+}
+
+std::unique_ptr<TensorIterator> TensorIterator::reduce_op(Tensor& out1, Tensor& out2, const Tensor& a) {
+  AT_ASSERT(out1.defined());
+  AT_ASSERT(out2.defined());
+  AT_CHECK(out1.sizes() == out2.sizes() && out1.strides() == out2.strides(),
+           "reduce_op(): expected both outputs to have the same sizes and strides, but got ",
+           out1.sizes(), " and ", out2.sizes());
+  auto builder = TensorIterator::Builder();
+  builder.add_output(out1);
+  builder.add_output(out2);
+  builder.add_input(a);
+  builder.dont_resize_outputs();
   return builder.build();
 }
 
@@ -485,7 +585,7 @@ void TensorIterator::compute_shape() {
     // For now, don't include output tensors that are not also input tensors.
     // This preserves the legacy behavior where torch.add(..., out=dst) resizes
     // the destination tensor.
-    if (op.is_output && !op.is_read_write) continue;
+    if (resize_outputs_ && op.is_output && !op.is_read_write) continue;
 
     auto shape = op.tensor.sizes();
     if (shape_.empty()) {
@@ -605,18 +705,22 @@ SplitUntil32Bit TensorIterator::with_32bit_indexing() const {
 std::unique_ptr<TensorIterator> TensorIterator::Builder::build() {
   // set is_output and is_read_write flags on appropriate tensors
   iter_->mark_outputs();
-  // compute the broadcasted shape
-  iter_->compute_shape();
-  // compute each tensor's stride after broadcasting
-  iter_->compute_strides();
-  // re-order dimensions to improve coalescing
-  iter_->reorder_dimensions();
-  // compute the result dtype and backend
-  iter_->compute_common_type();
-  // allocate the output tensor if it's not provided
-  iter_->allocate_outputs();
-  // coalesce adjacent dimensions when possible
-  iter_->coalesce_dimensions();
+  // contiguous operands of the same shape, or broadcast zero-dim tensors,
+  // don't need any of the steps below
+  if (!iter_->fast_set_up()) {
+    // compute the broadcasted shape
+    iter_->compute_shape();
+    // compute each tensor's stride after broadcasting
+    iter_->compute_strides();
+    // re-order dimensions to improve coalescing
+    iter_->reorder_dimensions();
+    // compute the result dtype and backend
+    iter_->compute_common_type();
+    // allocate the output tensor if it's not provided
+    iter_->allocate_outputs();
+    // coalesce adjacent dimensions when possible
+    iter_->coalesce_dimensions();
+  }
 
   for (auto& op : iter_->operands_) {
     AT_ASSERT(op.tensor.defined());
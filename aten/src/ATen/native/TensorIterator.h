@@ -109,6 +109,7 @@ struct CAFFE2_API TensorIterator {
 
   static std::unique_ptr<TensorIterator> binary_op(Tensor& out, const Tensor& a, const Tensor& b);
   static std::unique_ptr<TensorIterator> reduce_op(Tensor& out, const Tensor& a);
+  static std::unique_ptr<TensorIterator> reduce_op(Tensor& out1, Tensor& out2, const Tensor& a);
 
   int ndim() const { return shape_.size(); }
   IntList shape() const { return shape_; }
@@ -211,6 +212,7 @@ protected:
   void reorder_dimensions();
   void permute_dimensions(IntList perm);
   void compute_common_type();
+  bool fast_set_up();
   void allocate_outputs();
   void coalesce_dimensions();
   void check_type_conversions();
@@ -223,6 +225,7 @@ protected:
   bool has_coalesced_dimensions_ = false;
   bool accumulate_ = false;
   bool resize_outputs_ = true;
+  bool compute_common_dtype_ = true;
 };
 
 struct TensorIterator::Builder {
@@ -241,6 +244,21 @@ struct TensorIterator::Builder {
     return *this;
   }
 
+  /// Keeps the type of every operand instead of promoting them to a common
+  /// type, e.g. for the long index tensors of the indexing kernels. Undefined
+  /// outputs are not supported in this mode.
+  Builder& dont_compute_common_dtype() {
+    iter_->compute_common_dtype_ = false;
+    return *this;
+  }
+
+  /// Requires the outputs to match the broadcast shape of the operands, which
+  /// then includes the outputs, instead of resizing them.
+  Builder& dont_resize_outputs() {
+    iter_->resize_outputs_ = false;
+    return *this;
+  }
+
   std::unique_ptr<TensorIterator> build();
 
 protected:
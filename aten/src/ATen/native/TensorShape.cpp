@@ -5,12 +5,14 @@
 #include "ATen/ExpandUtils.h"
 #include "ATen/InferSize.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include "ATen/WrapDimUtils.h"
 #include "c10/util/Exception.h"
 #include "c10/util/Optional.h"
 #include "ATen/native/Resize.h"
 #include <ATen/SparseTensorUtils.h>
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace at {
@@ -43,9 +45,126 @@ static void check_cat_no_zero_dim(TensorList tensors) {
   }
 }
 
+// Size [0] tensors were once the only possible empty tensors, so cat skips
+// them for backwards compatibility (other empty sizes are not skipped).
+static inline bool should_skip(const Tensor& t) {
+  return t.dim() == 1 && t.size(0) == 0;
+}
+
+static void check_cat_shape_except_dim(const Tensor& first, const Tensor& second, int64_t dimension) {
+  int64_t first_dims = first.dim();
+  int64_t second_dims = second.dim();
+  AT_CHECK(first_dims == second_dims,
+           "Tensors must have same number of dimensions: got ", first_dims, " and ", second_dims);
+  for (int64_t dim = 0; dim < first_dims; dim++) {
+    if (dim == dimension) {
+      continue;
+    }
+    int64_t first_dim_size = first.size(dim);
+    int64_t second_dim_size = second.size(dim);
+    AT_CHECK(first_dim_size == second_dim_size,
+             "Sizes of tensors must match except in dimension ", dimension, ". Got ",
+             first_dim_size, " and ", second_dim_size, " in dimension ", dim);
+  }
+}
+
+// Copies contiguous inputs into the contiguous result. Viewed as
+// [outer, size(dim) * inner], the result is made of outer rows, each of which
+// holds one block of every input, so the block offsets are computed once and
+// the (row, input) pairs are copied in parallel.
+static void cat_contiguous_cpu(Tensor& result, const std::vector<Tensor>& inputs, int64_t dim) {
+  int64_t element_size = result.type().elementSizeInBytes();
+  int64_t outer = 1;
+  for (int64_t i = 0; i < dim; i++) {
+    outer *= result.size(i);
+  }
+  int64_t inner = 1;
+  for (int64_t i = dim + 1; i < result.dim(); i++) {
+    inner *= result.size(i);
+  }
+
+  int64_t num_inputs = inputs.size();
+  std::vector<int64_t> block_bytes(num_inputs);
+  std::vector<int64_t> block_offsets(num_inputs);
+  int64_t row_bytes = 0;
+  for (int64_t j = 0; j < num_inputs; j++) {
+    block_bytes[j] = inputs[j].size(dim) * inner * element_size;
+    block_offsets[j] = row_bytes;
+    row_bytes += block_bytes[j];
+  }
+  if (outer == 0 || row_bytes == 0) {
+    return;
+  }
+
+  char* result_data = (char*)result.data_ptr();
+  int64_t num_blocks = outer * num_inputs;
+  int64_t elements_per_block = std::max<int64_t>(1, result.numel() / num_blocks);
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / elements_per_block);
+  parallel_for(0, num_blocks, grain_size, [&](int64_t start, int64_t end) {
+    for (int64_t b = start; b < end; b++) {
+      int64_t row = b / num_inputs;
+      int64_t j = b % num_inputs;
+      int64_t nbytes = block_bytes[j];
+      // C says memcpy can't be passed a nullptr, even to copy 0 bytes
+      if (nbytes == 0) {
+        continue;
+      }
+      const char* src = (const char*)inputs[j].data_ptr() + row * nbytes;
+      memcpy(result_data + row * row_bytes + block_offsets[j], src, nbytes);
+    }
+  });
+}
+
+static Tensor & cat_out_cpu(Tensor & result, TensorList tensors, int64_t dim) {
+  std::vector<Tensor> inputs;
+  inputs.reserve(tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto& t = tensors[i];
+    AT_CHECK(t.type() == result.type(),
+             "Expected object of type ", result.type().toString(), " but found type ",
+             t.type().toString(), " for sequence element ", i,
+             " in sequence argument at position #1 'tensors'");
+    if (!should_skip(t)) {
+      inputs.push_back(t);
+    }
+  }
+  if (inputs.empty()) {
+    return result;
+  }
+
+  const Tensor& first = inputs[0];
+  AT_CHECK(dim < first.dim(), "invalid dimension ", dim);
+  int64_t cat_dim_size = 0;
+  for (auto& t : inputs) {
+    check_cat_shape_except_dim(first, t, dim);
+    cat_dim_size += t.size(dim);
+  }
+  auto size = first.sizes().vec();
+  size[dim] = cat_dim_size;
+  // a no-op if out= already has the right size
+  result.resize_(size);
+
+  bool all_contiguous = result.is_contiguous() &&
+      std::all_of(inputs.begin(), inputs.end(), [](const Tensor& t) { return t.is_contiguous(); });
+  if (all_contiguous) {
+    cat_contiguous_cpu(result, inputs, dim);
+  } else {
+    int64_t offset = 0;
+    for (auto& t : inputs) {
+      int64_t dim_size = t.size(dim);
+      result.narrow(dim, offset, dim_size).copy_(t);
+      offset += dim_size;
+    }
+  }
+  return result;
+}
+
 Tensor & cat_out(Tensor & result, TensorList tensors, int64_t dim) {
   check_cat_no_zero_dim(tensors);
   dim = legacy_cat_wrap_dim(dim, tensors);
+  if (result.type().backend() == Backend::CPU) {
+    return cat_out_cpu(result, tensors, dim);
+  }
   return at::_th_cat_out(result, tensors, dim);
 }
 
@@ -125,6 +244,10 @@ Tensor cat(TensorList tensors, int64_t dim) {
   }
   check_cat_no_zero_dim(tensors);
   dim = legacy_cat_wrap_dim(dim, tensors);
+  if (tensors.size() > 0 && tensors[0].type().backend() == Backend::CPU) {
+    Tensor result = at::empty({0}, tensors[0].options());
+    return cat_out_cpu(result, tensors, dim);
+  }
   return at::_th_cat(tensors, dim);
 }
 
@@ -516,6 +639,9 @@ static inline Tensor & sparse_transpose_(Tensor & self, int64_t dim0, int64_t di
     row0.copy_(row1);
     row1.copy_(tmp);
 
+    // the indices are not sorted anymore, but stay unique
+    auto impl = at::sparse::get_sparse_impl(self);
+    impl->set_unique_indices(impl->unique_indices());
     self._coalesced_(false);
 
     auto sizes = self.sizes().vec();
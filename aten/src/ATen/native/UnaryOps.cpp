@@ -89,10 +89,21 @@ Tensor& _clamp_min_out_cpu(Tensor& result, const Tensor& self, Scalar min) {
 }
 
 Tensor& fill_(Tensor& self, Scalar value) {
+  if (self.type().scalarType() == kBFloat16) {
+    // there is no TH BFloat16 tensor
+    auto v = value.toBFloat16();
+    CPU_tensor_apply1<BFloat16>(self, [v](BFloat16& x) { x = v; });
+    return self;
+  }
   return at::_th_fill_(self, value);
 }
 
 Tensor& fill_(Tensor& self, const Tensor& value) {
+  if (self.type().scalarType() == kBFloat16) {
+    AT_CHECK(value.dim() == 0, "fill_ only supports a 0-dimensional value tensor, but got tensor "
+        "with ", value.dim(), " dimension(s)");
+    return at::native::fill_(self, value._local_scalar());
+  }
   return at::_th_fill_(self, value);
 }
 
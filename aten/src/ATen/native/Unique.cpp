@@ -2,6 +2,7 @@
 
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
+#include "ATen/WrapDimUtils.h"
 
 #include <set>
 #include <tuple>
@@ -14,10 +15,11 @@ namespace native{
 namespace {
 
 template <typename scalar_t>
-std::tuple<Tensor, Tensor> _unique_cpu_template(
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_template(
     const Tensor& self,
     const bool sorted,
-    const bool return_inverse) {
+    const bool return_inverse,
+    const bool return_counts) {
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data<scalar_t>();
   std::unordered_set<scalar_t> set(input_data, input_data + input.numel());
@@ -33,19 +35,85 @@ std::tuple<Tensor, Tensor> _unique_cpu_template(
   }
 
   Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
-  if (return_inverse) {
-    inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
+  Tensor counts = at::empty({0}, self.options().dtype(kLong));
+  if (return_inverse || return_counts) {
+    int64_t* inverse_indices_data = nullptr;
+    int64_t* counts_data = nullptr;
+    if (return_inverse) {
+      inverse_indices.resize_(input.sizes());
+      inverse_indices_data = inverse_indices.data<int64_t>();
+    }
+    if (return_counts) {
+      counts.resize_({output.numel()}).zero_();
+      counts_data = counts.data<int64_t>();
+    }
     std::unordered_map<scalar_t, int64_t> inverse_map;
     inverse_map.reserve(output.numel());
-    for (int i = 0; i < output.numel(); ++i) {
+    for (int64_t i = 0; i < output.numel(); ++i) {
       inverse_map[output_data[i]] = i;
     }
-    for (int i = 0; i < input.numel(); ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
+    for (int64_t i = 0; i < input.numel(); ++i) {
+      int64_t index = inverse_map[input_data[i]];
+      if (return_inverse) {
+        inverse_indices_data[i] = index;
+      }
+      if (return_counts) {
+        counts_data[index]++;
+      }
     }
   }
-  return std::make_tuple(output, inverse_indices);
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> _unique_consecutive_cpu_template(
+    const Tensor& self,
+    const bool return_inverse,
+    const bool return_counts) {
+  const Tensor& input = self.contiguous();
+  const scalar_t* input_data = input.data<scalar_t>();
+  int64_t numel = input.numel();
+  Tensor output = at::empty({numel}, input.options());
+  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+  Tensor counts = at::empty({0}, self.options().dtype(kLong));
+  if (return_inverse) {
+    inverse_indices.resize_(input.sizes());
+  }
+
+  if (numel > 0) {
+    scalar_t* output_data = output.data<scalar_t>();
+    int64_t* inverse_indices_data = return_inverse ? inverse_indices.data<int64_t>() : nullptr;
+    int64_t* counts_data = nullptr;
+    if (return_counts) {
+      counts.resize_({numel});
+      counts_data = counts.data<int64_t>();
+    }
+    // the first value of each run of equal values is kept, at output_data[last]
+    int64_t last = 0;
+    int64_t run_start = 0;
+    output_data[0] = input_data[0];
+    if (return_inverse) {
+      inverse_indices_data[0] = 0;
+    }
+    for (int64_t i = 1; i < numel; ++i) {
+      if (input_data[i] != output_data[last]) {
+        if (return_counts) {
+          counts_data[last] = i - run_start;
+        }
+        run_start = i;
+        output_data[++last] = input_data[i];
+      }
+      if (return_inverse) {
+        inverse_indices_data[i] = last;
+      }
+    }
+    if (return_counts) {
+      counts_data[last] = numel - run_start;
+      counts.resize_({last + 1});
+    }
+    output.resize_({last + 1});
+  }
+  return std::make_tuple(output, inverse_indices, counts);
 }
 
 template<class ForwardIt>
@@ -128,7 +196,24 @@ std::tuple<Tensor, Tensor> _unique_dim_cpu_template(
 std::tuple<Tensor, Tensor>
 _unique_cpu(const Tensor& self, const bool sorted, const bool return_inverse) {
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse);
+    Tensor output, inverse_indices, counts;
+    std::tie(output, inverse_indices, counts) =
+      _unique_cpu_template<scalar_t>(self, sorted, return_inverse, false);
+    return std::make_tuple(output, inverse_indices);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cpu(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
+    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse, return_counts);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique_consecutive_cpu(const Tensor& self, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique_consecutive", [&] {
+    return _unique_consecutive_cpu_template<scalar_t>(self, return_inverse, return_counts);
   });
 }
 
@@ -140,5 +225,40 @@ _unique_dim_cpu(const Tensor& self, const int64_t dim, const bool sorted, const
   });
 }
 
+// Consecutive unique slices along dim, for any device: a slice starts a new
+// run when it differs from the previous one.
+std::tuple<Tensor, Tensor, Tensor>
+_unique_dim_consecutive(const Tensor& self, int64_t dim, const bool return_inverse, const bool return_counts) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  Tensor input_flat = self.transpose(dim, 0);
+  auto orig_sizes = input_flat.sizes().vec();
+  int64_t size = input_flat.size(0);
+  input_flat = input_flat.contiguous().view({size, -1});
+
+  auto long_options = self.options().dtype(kLong);
+  Tensor is_run_start = at::ones({size}, self.options().dtype(kByte));
+  if (size > 1) {
+    is_run_start.narrow(0, 1, size - 1).copy_(
+      input_flat.narrow(0, 1, size - 1).ne(input_flat.narrow(0, 0, size - 1)).any(1));
+  }
+  Tensor run_starts = is_run_start.nonzero().view(-1);
+
+  Tensor output = input_flat.index_select(0, run_starts);
+  auto new_sizes = std::vector<int64_t>(orig_sizes);
+  new_sizes[0] = -1;
+  output = output.view(new_sizes).transpose(0, dim);
+
+  Tensor inverse_indices = at::empty({0}, long_options);
+  if (return_inverse) {
+    inverse_indices = is_run_start.toType(kLong).cumsum(0).sub_(1);
+  }
+  Tensor counts = at::empty({0}, long_options);
+  if (return_counts && size > 0) {
+    counts = at::cat({run_starts.narrow(0, 1, run_starts.numel() - 1),
+                      at::full({1}, size, long_options)}).sub_(run_starts);
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
 }  // namespace native
 }  // namespace at
@@ -0,0 +1,183 @@
+#include "ATen/native/cpu/BatchGemmKernel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// A packed, register-blocked gemm for the small and medium matrices of a
+// batch, such as the [B * H, 64, 64] products of attention, for which the
+// overhead of one BLAS call per matrix dominates.
+//
+// Each matrix of batch1 is packed in panels of kMR rows and each matrix of
+// batch2 in panels of kNR = 2 vectors of columns, k-major, padded with zeros,
+// so that the micro-kernel reads both operands contiguously whatever their
+// strides, and keeps a kMR x kNR block of the product in 2 * kMR vector
+// registers over the whole contraction.
+
+namespace at { namespace native {
+namespace {
+
+constexpr int64_t kMR = 4;
+
+template <typename scalar_t>
+struct BatchGemm {
+  using Vec = vec256::Vec256<scalar_t>;
+  static constexpr int64_t kNR = 2 * Vec::size;
+
+  // out[panel][k][r] = a[i0 + r][k], for the panels of kMR rows of a
+  static void pack_a(
+      const scalar_t* a,
+      int64_t stride_m,
+      int64_t stride_k,
+      int64_t m,
+      int64_t k,
+      scalar_t* out) {
+    for (int64_t i0 = 0; i0 < m; i0 += kMR) {
+      const int64_t rows = std::min(kMR, m - i0);
+      for (int64_t p = 0; p < k; p++) {
+        for (int64_t r = 0; r < kMR; r++) {
+          *out++ = r < rows ? a[(i0 + r) * stride_m + p * stride_k] : 0;
+        }
+      }
+    }
+  }
+
+  // out[panel][k][c] = b[k][j0 + c], for the panels of kNR columns of b
+  static void pack_b(
+      const scalar_t* b,
+      int64_t stride_k,
+      int64_t stride_n,
+      int64_t k,
+      int64_t n,
+      scalar_t* out) {
+    for (int64_t j0 = 0; j0 < n; j0 += kNR) {
+      const int64_t cols = std::min(int64_t(kNR), n - j0);
+      for (int64_t p = 0; p < k; p++) {
+        for (int64_t c = 0; c < kNR; c++) {
+          *out++ = c < cols ? b[p * stride_k + (j0 + c) * stride_n] : 0;
+        }
+      }
+    }
+  }
+
+  // acc[r][c] = sum_k a_panel[k][r] * b_panel[k][c]
+  static void micro_kernel(
+      const scalar_t* a_panel,
+      const scalar_t* b_panel,
+      int64_t k,
+      scalar_t* acc) {
+    Vec c0[kMR];
+    Vec c1[kMR];
+    for (int64_t r = 0; r < kMR; r++) {
+      c0[r] = Vec(0);
+      c1[r] = Vec(0);
+    }
+    for (int64_t p = 0; p < k; p++) {
+      const Vec b0 = Vec::loadu(b_panel);
+      const Vec b1 = Vec::loadu(b_panel + Vec::size);
+      for (int64_t r = 0; r < kMR; r++) {
+        const Vec a(a_panel[r]);
+        c0[r] = vec256::fmadd(a, b0, c0[r]);
+        c1[r] = vec256::fmadd(a, b1, c1[r]);
+      }
+      a_panel += kMR;
+      b_panel += kNR;
+    }
+    for (int64_t r = 0; r < kMR; r++) {
+      c0[r].store(acc + r * kNR);
+      c1[r].store(acc + r * kNR + Vec::size);
+    }
+  }
+
+  static void apply(
+      Tensor& result,
+      const Tensor& batch1,
+      const Tensor& batch2,
+      Scalar beta_,
+      Scalar alpha_,
+      bool is_bmm) {
+    const int64_t bs = result.size(0);
+    const int64_t m = result.size(1);
+    const int64_t n = result.size(2);
+    const int64_t k = batch1.size(2);
+    const scalar_t alpha = alpha_.to<scalar_t>();
+    const scalar_t beta = beta_.to<scalar_t>();
+
+    const int64_t m_panels = (m + kMR - 1) / kMR;
+    const int64_t n_panels = (n + kNR - 1) / kNR;
+
+    scalar_t* r_data = result.data<scalar_t>();
+    const scalar_t* a_data = batch1.data<scalar_t>();
+    const scalar_t* b_data = batch2.data<scalar_t>();
+
+    const int64_t grain_size =
+        std::max(internal::GRAIN_SIZE / (m * n * k), int64_t(1));
+    parallel_for(0, bs, grain_size, [&](int64_t b_begin, int64_t b_end) {
+      std::vector<scalar_t> a_packed(m_panels * kMR * k);
+      std::vector<scalar_t> b_packed(n_panels * kNR * k);
+      scalar_t acc[kMR * kNR];
+      for (int64_t b = b_begin; b < b_end; b++) {
+        pack_a(
+            a_data + b * batch1.stride(0),
+            batch1.stride(1),
+            batch1.stride(2),
+            m,
+            k,
+            a_packed.data());
+        pack_b(
+            b_data + b * batch2.stride(0),
+            batch2.stride(1),
+            batch2.stride(2),
+            k,
+            n,
+            b_packed.data());
+        scalar_t* r = r_data + b * result.stride(0);
+        for (int64_t jp = 0; jp < n_panels; jp++) {
+          const int64_t j0 = jp * kNR;
+          const int64_t cols = std::min(int64_t(kNR), n - j0);
+          for (int64_t ip = 0; ip < m_panels; ip++) {
+            const int64_t i0 = ip * kMR;
+            const int64_t rows = std::min(kMR, m - i0);
+            micro_kernel(
+                a_packed.data() + ip * kMR * k,
+                b_packed.data() + jp * kNR * k,
+                k,
+                acc);
+            for (int64_t i = 0; i < rows; i++) {
+              scalar_t* r_row = r + (i0 + i) * result.stride(1);
+              for (int64_t j = 0; j < cols; j++) {
+                scalar_t& out = r_row[(j0 + j) * result.stride(2)];
+                if (is_bmm) {
+                  out = acc[i * kNR + j];
+                } else {
+                  out = beta * out + alpha * acc[i * kNR + j];
+                }
+              }
+            }
+          }
+        }
+      }
+    });
+  }
+};
+
+static void batch_gemm_kernel_impl(
+    Tensor& result,
+    const Tensor& batch1,
+    const Tensor& batch2,
+    Scalar beta,
+    Scalar alpha,
+    bool is_bmm) {
+  AT_DISPATCH_FLOATING_TYPES(result.type(), "batch_gemm", [&] {
+    BatchGemm<scalar_t>::apply(result, batch1, batch2, beta, alpha, is_bmm);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(batch_gemm_kernel, &batch_gemm_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// result[b] = beta * result[b] + alpha * batch1[b] @ batch2[b] for each b,
+// or result[b] = batch1[b] @ batch2[b] when is_bmm, for float and double
+// tensors of any strides.
+using batch_gemm_fn = void (*)(
+    Tensor& result,
+    const Tensor& batch1,
+    const Tensor& batch2,
+    Scalar beta,
+    Scalar alpha,
+    bool is_bmm);
+
+DECLARE_DISPATCH(batch_gemm_fn, batch_gemm_kernel);
+
+}} // namespace at::native
@@ -13,7 +13,25 @@ namespace {
 
 using namespace vec256;
 
+// Half and BFloat16 are stored as such but computed on in float
+static inline bool is_reduced_floating(const TensorIterator& iter) {
+  auto t = iter.type().scalarType();
+  return t == kHalf || t == kBFloat16;
+}
+
 void add_kernel(TensorIterator& iter, Scalar alpha_scalar) {
+  if (is_reduced_floating(iter)) {
+    auto alpha = alpha_scalar.to<float>();
+    auto alpha_vec = Vec256<float>(alpha);
+    AT_DISPATCH_REDUCED_FLOATING_TYPES(iter.type(), "add", [&]() {
+      binary_kernel_vec_reduced<scalar_t>(iter,
+        [=](float a, float b) -> float { return a + alpha * b; },
+        [=](Vec256<float> a, Vec256<float> b) {
+          return vec256::fmadd(b, alpha_vec, a);
+        });
+    });
+    return;
+  }
   AT_DISPATCH_ALL_TYPES(iter.type(), "add", [&]() {
     auto alpha = alpha_scalar.to<scalar_t>();
     auto alpha_vec = Vec256<scalar_t>(alpha);
@@ -30,6 +48,16 @@ void sub_kernel(TensorIterator& iter, Scalar alpha_scalar) {
 }
 
 void mul_kernel(TensorIterator& iter) {
+  if (is_reduced_floating(iter)) {
+    AT_DISPATCH_REDUCED_FLOATING_TYPES(iter.type(), "mul", [&]() {
+      binary_kernel_vec_reduced<scalar_t>(iter,
+        [=](float a, float b) -> float { return a * b; },
+        [=](Vec256<float> a, Vec256<float> b) {
+          return a * b;
+        });
+    });
+    return;
+  }
   AT_DISPATCH_ALL_TYPES(iter.type(), "mul", [&]() {
     binary_kernel_vec(iter,
       [=](scalar_t a, scalar_t b) -> scalar_t { return a * b; },
@@ -0,0 +1,96 @@
+#include "ATen/native/Copy.h"
+
+#include <cstring>
+#include <type_traits>
+#include "ATen/Dispatch.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/Loops.h"
+
+namespace at { namespace native {
+namespace {
+
+template <typename dst_t, typename src_t>
+static inline dst_t convert_value(src_t value) {
+  // See Note [Implicit conversion between signed and unsigned]
+  return static_cast<dst_t>(static_cast<inter_copy_type_t<dst_t>>(value));
+}
+
+template <typename dst_t, typename src_t>
+static inline void copy_strided(char* dst, const char* src, int64_t dst_stride, int64_t src_stride, int64_t n) {
+  for (int64_t i = 0; i < n; i++) {
+    *(dst_t*)(dst + i * dst_stride) = convert_value<dst_t>(*(const src_t*)(src + i * src_stride));
+  }
+}
+
+template <typename dst_t, typename src_t>
+static inline void copy_contiguous(char* dst, const char* src, int64_t n) {
+  if (std::is_same<dst_t, src_t>::value) {
+    std::memcpy(dst, src, n * sizeof(dst_t));
+  } else if (std::is_same<dst_t, inter_copy_type_t<dst_t>>::value) {
+    vec256::convert((const src_t*)src, (dst_t*)dst, n);
+  } else {
+    copy_strided<dst_t, src_t>(dst, src, sizeof(dst_t), sizeof(src_t), n);
+  }
+}
+
+template <typename dst_t, typename src_t>
+static inline void copy_row(char* dst, const char* src, int64_t dst_stride, int64_t src_stride, int64_t n) {
+  if (dst_stride == sizeof(dst_t) && src_stride == sizeof(src_t)) {
+    copy_contiguous<dst_t, src_t>(dst, src, n);
+  } else if (dst_stride == sizeof(dst_t) && src_stride == 0) {
+    std::fill_n((dst_t*)dst, n, convert_value<dst_t>(*(const src_t*)src));
+  } else {
+    copy_strided<dst_t, src_t>(dst, src, dst_stride, src_stride, n);
+  }
+}
+
+template <typename dst_t, typename src_t>
+void copy_kernel_impl(TensorIterator& iter) {
+  iter.for_each([](int ntensor, char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    const int64_t* outer_strides = &strides[2];
+    // Copying between tensors laid out differently, e.g. a transposed or
+    // channels-last source into a contiguous destination, is done in tiles
+    // as in blocked_binary_loop, so the operand that is contiguous along
+    // dimension 1 reuses each cache line it fetches for the following rows.
+    bool dst_transposed = strides[0] != sizeof(dst_t) && outer_strides[0] == sizeof(dst_t);
+    bool src_transposed = strides[1] != sizeof(src_t) && strides[1] != 0 &&
+                          outer_strides[1] == sizeof(src_t);
+    if (size1 > 1 && (dst_transposed || src_transposed)) {
+      for (int64_t j0 = 0; j0 < size1; j0 += kBlockSize1) {
+        int64_t j1 = std::min(size1, j0 + kBlockSize1);
+        for (int64_t i0 = 0; i0 < size0; i0 += kBlockSize0) {
+          int64_t n = std::min(size0 - i0, kBlockSize0);
+          for (int64_t j = j0; j < j1; j++) {
+            copy_strided<dst_t, src_t>(
+                data[0] + i0 * strides[0] + j * outer_strides[0],
+                data[1] + i0 * strides[1] + j * outer_strides[1],
+                strides[0], strides[1], n);
+          }
+        }
+      }
+      return;
+    }
+    char* dst = data[0];
+    const char* src = data[1];
+    for (int64_t j = 0; j < size1; j++) {
+      copy_row<dst_t, src_t>(dst, src, strides[0], strides[1], size0);
+      dst += outer_strides[0];
+      src += outer_strides[1];
+    }
+  });
+}
+
+static void copy_kernel(TensorIterator& iter) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF_AND_BFLOAT16(iter.type(0), "copy_kernel", [&] {
+    using dst_t = scalar_t;
+    AT_DISPATCH_ALL_TYPES_AND_HALF_AND_BFLOAT16(iter.type(1), "copy_kernel", [&] {
+      copy_kernel_impl<dst_t, scalar_t>(iter);
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(copy_stub, &copy_kernel);
+
+}} // namespace at::native
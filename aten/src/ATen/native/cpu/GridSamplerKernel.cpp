@@ -3,6 +3,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/native/ChannelsLast.h>
 #include <ATen/native/GridSampler.h>
 #include <ATen/native/cpu/GridSamplerKernel.h>
 #include <ATen/cpu/vml.h>
@@ -448,6 +449,62 @@ struct ApplyGridSample<scalar_t, 2, GridSamplerInterpolation::Bilinear, padding>
     }
   }
 
+  // Same as `forward`, for an input and output laid out channels last, with
+  // `inp_ptr` and `out_ptr` pointing to the sample. The interpolation
+  // weights and offsets are computed once, as above, and then each output
+  // location is a contiguous vector of channels, interpolated from contiguous
+  // vectors of channels of the (at most) 4 corners in bounds.
+  inline void forward_channels_last(scalar_t* out_ptr, const scalar_t* inp_ptr,
+                                    int64_t offset, const Vec& grid_x, const Vec& grid_y,
+                                    int64_t len) const {
+    auto x = compute_W.apply(grid_x);
+    auto y = compute_H.apply(grid_y);
+
+    auto interp_params = compute_interp_params(x, y);
+
+    auto i_y_n = std::get<12>(interp_params);
+    auto i_x_w = std::get<13>(interp_params);
+
+    auto i_nw_offset = i_y_n * iVec(inp_sH) + i_x_w * iVec(inp_sW);
+    auto i_ne_offset = i_nw_offset + iVec(inp_sW);
+    auto i_sw_offset = i_nw_offset + iVec(inp_sH);
+    auto i_se_offset = i_sw_offset + iVec(inp_sW);
+
+    // corners in the order nw, ne, sw, se
+    scalar_t weight_arr[4][Vec::size];
+    integer_t mask_arr[4][iVec::size];
+    integer_t offset_arr[4][iVec::size];
+    std::get<4>(interp_params).store(weight_arr[0]);
+    std::get<5>(interp_params).store(weight_arr[1]);
+    std::get<6>(interp_params).store(weight_arr[2]);
+    std::get<7>(interp_params).store(weight_arr[3]);
+    std::get<8>(interp_params).store(mask_arr[0]);
+    std::get<9>(interp_params).store(mask_arr[1]);
+    std::get<10>(interp_params).store(mask_arr[2]);
+    std::get<11>(interp_params).store(mask_arr[3]);
+    i_nw_offset.store(offset_arr[0]);
+    i_ne_offset.store(offset_arr[1]);
+    i_sw_offset.store(offset_arr[2]);
+    i_se_offset.store(offset_arr[3]);
+
+    for (int64_t i = 0; i < len; i++) {
+      auto out_loc_ptr = out_ptr + (offset + i) * C;
+      for (int64_t c = 0; c < C; c += Vec::size) {
+        auto count = std::min<int64_t>(Vec::size, C - c);
+        auto interpolated = Vec(0);
+        for (int corner = 0; corner < 4; corner++) {
+          if (mask_arr[corner][i]) {
+            auto corner_ptr = inp_ptr + offset_arr[corner][i] + c;
+            auto corner_val = count == Vec::size ? Vec::loadu(corner_ptr)
+                                                 : Vec::loadu(corner_ptr, count);
+            interpolated = interpolated + corner_val * Vec(weight_arr[corner][i]);
+          }
+        }
+        interpolated.store(out_loc_ptr + c, count);
+      }
+    }
+  }
+
   inline void backward(TensorAccessor<scalar_t, 3>& gInp_slice,
                        TensorAccessor<scalar_t, 3>& gGrid_slice,
                        const TensorAccessor<scalar_t, 3>& gOut_slice,
@@ -601,6 +658,37 @@ struct ApplyGridSample<scalar_t, 2, GridSamplerInterpolation::Nearest, padding>
     }
   }
 
+  // Same as `forward`, for an input and output laid out channels last. See
+  // the bilinear `forward_channels_last`.
+  inline void forward_channels_last(scalar_t* out_ptr, const scalar_t* inp_ptr,
+                                    int64_t offset, const Vec& grid_x, const Vec& grid_y,
+                                    int64_t len) const {
+    auto x = compute_W.apply(grid_x);
+    auto y = compute_H.apply(grid_y);
+
+    auto i_x_nearest = convert_to_int_of_same_size(x.round());
+    auto i_y_nearest = convert_to_int_of_same_size(y.round());
+
+    auto i_mask = must_in_bound ? iVec(-1)
+                                : (i_x_nearest > iVec(-1)) & (i_x_nearest < iVec(inp_W)) &
+                                  (i_y_nearest > iVec(-1)) & (i_y_nearest < iVec(inp_H));
+    auto i_offset = i_y_nearest * iVec(inp_sH) + i_x_nearest * iVec(inp_sW);
+
+    integer_t mask_arr[iVec::size];
+    i_mask.store(mask_arr);
+    integer_t offset_arr[iVec::size];
+    i_offset.store(offset_arr);
+
+    for (int64_t i = 0; i < len; i++) {
+      auto out_loc_ptr = out_ptr + (offset + i) * C;
+      if (mask_arr[i]) {
+        std::memcpy(out_loc_ptr, inp_ptr + offset_arr[i], C * sizeof(scalar_t));
+      } else {
+        std::memset(out_loc_ptr, 0, C * sizeof(scalar_t));
+      }
+    }
+  }
+
   inline void backward(TensorAccessor<scalar_t, 3>& gInp_slice,
                        TensorAccessor<scalar_t, 3>& gGrid_slice,
                        const TensorAccessor<scalar_t, 3>& gOut_slice,
@@ -756,6 +844,38 @@ static inline void grid_sample_2d_grid_slice_iterator(
   }
 }
 
+// Applies `grid_sample_2d_grid_slice_iterator` to the output rows [begin, end)
+// of the whole grid, the rows of all samples being numbered n * H + h, so that
+// the work can be split between threads by tiles of rows even when there are
+// fewer samples than threads. `apply_fn` is also given the sample index, and
+// `spatial_offset` is from the beginning of the slice of that sample, e.g.,
+//    void apply_fn(int64_t n,
+//                  const Vec256<scalar_t>& grid_x,
+//                  const Vec256<scalar_t>& grid_y,
+//                  int64_t spatial_offset, int64_t len);
+template<typename scalar_t, typename ApplyFn>
+static inline void grid_sample_2d_grid_rows_iterator(
+    const TensorAccessor<scalar_t, 4>& grid, int64_t begin, int64_t end,
+    const ApplyFn &apply_fn) {
+  int64_t out_H = grid.size(1);
+  int64_t out_W = grid.size(2);
+  const int64_t strides[3] = {grid.stride(1), grid.stride(2), grid.stride(3)};
+  for (int64_t row = begin; row < end;) {
+    int64_t n = row / out_H;
+    int64_t h_begin = row % out_H;
+    int64_t h_end = std::min(out_H, h_begin + (end - row));
+    const int64_t sizes[3] = {h_end - h_begin, out_W, 2};
+    TensorAccessor<scalar_t, 3> rows(grid[n].data() + h_begin * strides[0], sizes, strides);
+    grid_sample_2d_grid_slice_iterator(
+      rows,
+      [&](const Vec256<scalar_t>& grid_x, const Vec256<scalar_t>& grid_y,
+          int64_t spatial_offset, int64_t len) {
+        apply_fn(n, grid_x, grid_y, h_begin * out_W + spatial_offset, len);
+      });
+    row += h_end - h_begin;
+  }
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Grid Sample Kernels ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Use the structs & functions defined above to calculate grid sample forward
 // and backward.
@@ -765,28 +885,37 @@ Tensor grid_sampler_2d_cpu_kernel_impl(const Tensor& input, const Tensor& grid,
                                        int64_t interpolation_mode,
                                        int64_t padding_mode) {
   auto N = input.size(0);
+  auto C = input.size(1);
   auto H = grid.size(1);
   auto W = grid.size(2);
-  auto output = at::empty({N, input.size(1), H, W}, input.options());
-  auto spatial_size = H * W;
-  auto grain_size = spatial_size == 0 ? (N + 1)
-                                      : at::divup(at::internal::GRAIN_SIZE, spatial_size * 4 /* 2d * 2 tensors*/);
+  // A channels last input gives a channels last output, and each output
+  // location is then computed a vector of channels at a time.
+  const bool channels_last = is_channels_last(input);
+  auto output = channels_last ? empty_channels_last({N, C, H, W}, input.options())
+                              : at::empty({N, C, H, W}, input.options());
+  // Split in tiles of output rows rather than in samples, so that small
+  // batches use all threads too.
+  auto grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, W * C * 4 /* corners */));
 
 #define HANDLE_CASE(interp, padding)                                           \
   case padding: {                                                              \
     ApplyGridSample<scalar_t, 2, interp, padding> grid_sample(inp_acc);        \
-    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {           \
-      for (int64_t n = begin; n < end; n++) {                                  \
-        auto out_slice = out_acc[n];                                           \
-        auto inp_slice = inp_acc[n];                                           \
-        grid_sample_2d_grid_slice_iterator(                                    \
-          grid_acc[n],                                                         \
-          [&](const Vec256<scalar_t>& grid_x, const Vec256<scalar_t>& grid_y,  \
-              int64_t spatial_offset, int64_t len) {                           \
-            grid_sample.forward(out_slice, inp_slice, spatial_offset,          \
+    parallel_for(0, N * H, grain_size, [&](int64_t begin, int64_t end) {       \
+      grid_sample_2d_grid_rows_iterator(                                       \
+        grid_acc, begin, end,                                                  \
+        [&](int64_t n, const Vec256<scalar_t>& grid_x,                         \
+            const Vec256<scalar_t>& grid_y, int64_t spatial_offset,            \
+            int64_t len) {                                                     \
+          if (channels_last) {                                                 \
+            grid_sample.forward_channels_last(                                 \
+              out_acc[n].data(), inp_acc[n].data(), spatial_offset,            \
+              grid_x, grid_y, len);                                            \
+          } else {                                                             \
+            auto out_slice = out_acc[n];                                       \
+            grid_sample.forward(out_slice, inp_acc[n], spatial_offset,         \
                                 grid_x, grid_y, len);                          \
-          });                                                                  \
-        }                                                                      \
+          }                                                                    \
+        });                                                                    \
       });                                                                      \
     return;                                                                    \
   }
@@ -0,0 +1,128 @@
+#include "ATen/native/Indexing.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/TensorIterator.h"
+
+namespace at { namespace native {
+namespace {
+
+// Computes the offset (in bytes) of the indexed element from the index
+// tensors that follow the output and the input in the operands of the
+// iterator. Each index is checked, and wrapped if negative.
+struct Indexer {
+  Indexer(int64_t num_indexers, char** indexers, const int64_t* indexer_strides,
+          IntList original_sizes, IntList original_strides)
+    : num_indexers(num_indexers)
+    , indexers(indexers)
+    , indexer_strides(indexer_strides)
+    , original_sizes(original_sizes.data())
+    , original_strides(original_strides.data()) {
+    AT_ASSERT((int64_t)original_sizes.size() == num_indexers);
+    AT_ASSERT((int64_t)original_strides.size() == num_indexers);
+  }
+
+  int64_t num_indexers;
+  char** indexers;
+  const int64_t* indexer_strides;
+  const int64_t* original_sizes;
+  const int64_t* original_strides;
+
+  int64_t get(int64_t idx) {
+    int64_t offset = 0;
+    for (int64_t j = 0; j < num_indexers; j++) {
+      int64_t value = *(int64_t*)&indexers[j][idx * indexer_strides[j]];
+      int64_t size = original_sizes[j];
+      AT_CHECK(value >= -size && value < size,
+               "index ", value, " is out of bounds for dimension ", j, " with size ", size);
+      if (value < 0) {
+        value += size;
+      }
+      offset += value * original_strides[j];
+    }
+    return offset;
+  }
+};
+
+// true if every element of the inner loop reads the same indices
+static bool is_constant_index(int ntensor, const int64_t* strides) {
+  for (int arg = 2; arg < ntensor; arg++) {
+    if (strides[arg] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Calls f(dst, src, offset) for every element of the iterator, where offset
+// is the offset of the indexed element. For index, dst is the output and src
+// the indexed tensor, which f reads at the offset; for index_put it is the
+// other way round.
+template <typename scalar_t, typename func_t>
+void cpu_index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride,
+                      const func_t& f, bool serial_execution=false) {
+  auto loop = [&](int ntensor, char** data, const int64_t* strides, int64_t n) {
+    auto indexer = Indexer(ntensor - 2, &data[2], &strides[2], index_size, index_stride);
+    char* dst = data[0];
+    char* src = data[1];
+    if (is_constant_index(ntensor, strides)) {
+      // The inner loop runs over a non-indexed dimension, so all of it moves
+      // by the same offset
+      int64_t offset = indexer.get(0);
+      if (strides[0] == sizeof(scalar_t) && strides[1] == sizeof(scalar_t)) {
+        // contiguous on both sides: unit strides let the compiler vectorize
+        for (int64_t i = 0; i < n; i++) {
+          f(dst + sizeof(scalar_t) * i, src + sizeof(scalar_t) * i, offset);
+        }
+      } else {
+        for (int64_t i = 0; i < n; i++) {
+          f(dst + strides[0] * i, src + strides[1] * i, offset);
+        }
+      }
+    } else {
+      for (int64_t i = 0; i < n; i++) {
+        int64_t offset = indexer.get(i);
+        f(dst + strides[0] * i, src + strides[1] * i, offset);
+      }
+    }
+  };
+  if (serial_execution) {
+    if (iter.numel() > 0) {
+      iter.serial_for_each(loop, {0, iter.numel()});
+    }
+  } else {
+    iter.for_each(loop);
+  }
+}
+
+void index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(0), "index", [&] {
+    cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+      *(scalar_t*)dst = *(scalar_t*)(src + offset);
+    });
+  });
+}
+
+void index_put_kernel(TensorIterator& iter, IntList index_size, IntList index_stride, bool accumulate) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(0), "index_put", [&] {
+    if (accumulate) {
+      // Duplicate indices add to the same element: run serially, in the order
+      // of the iterator, so that the result is deterministic
+      cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+        *(scalar_t*)(dst + offset) += *(scalar_t*)src;
+      }, /*serial_execution=*/true);
+    } else {
+      cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+        *(scalar_t*)(dst + offset) = *(scalar_t*)src;
+      });
+    }
+  });
+}
+
+} // anonymous namespace
+
+
+REGISTER_DISPATCH(index_stub, &index_kernel);
+REGISTER_DISPATCH(index_put_stub, &index_put_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,194 @@
+#include "ATen/native/LayerNorm.h"
+
+#include <cmath>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/functional.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// Each row of N elements is normalized by a single task. The rows are read
+// once to compute the mean, once for the variance and once more to normalize
+// them; for the sizes layer norm is used with, a row stays in cache and the
+// two pass variance costs less than the divisions of Welford's algorithm,
+// which also doesn't vectorize as well.
+
+namespace at { namespace native {
+namespace {
+
+template <typename scalar_t>
+void layer_norm_kernel_impl(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta,
+    int64_t M, int64_t N, scalar_t eps,
+    Tensor& Y, Tensor& mean, Tensor& rstd) {
+  using Vec = vec256::Vec256<scalar_t>;
+  scalar_t* X_data = X.data<scalar_t>();
+  const scalar_t* gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+  const scalar_t* beta_data = beta.defined() ? beta.data<scalar_t>() : nullptr;
+  scalar_t* Y_data = Y.data<scalar_t>();
+  scalar_t* mean_data = mean.data<scalar_t>();
+  scalar_t* rstd_data = rstd.data<scalar_t>();
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (4 * N));
+
+  parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      scalar_t* X_ptr = X_data + i * N;
+      scalar_t* Y_ptr = Y_data + i * N;
+      const scalar_t row_mean = vec256::reduce_all<scalar_t>(
+          [](Vec& x, Vec& y) { return x + y; }, X_ptr, N) / N;
+      const scalar_t row_var = vec256::map_reduce_all<scalar_t>(
+          [row_mean](Vec x) {
+            x = x - Vec(row_mean);
+            return x * x;
+          },
+          [](Vec x, Vec y) { return x + y; },
+          X_ptr,
+          N) / N;
+      const scalar_t row_rstd = 1 / std::sqrt(row_var + eps);
+      mean_data[i] = row_mean;
+      rstd_data[i] = row_rstd;
+
+      // Y = (X - mean) * rstd * gamma + beta
+      const Vec scale(row_rstd);
+      const Vec bias(-row_mean * row_rstd);
+      int64_t d = 0;
+      for (; d < N; d += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, N - d);
+        Vec y = Vec::loadu(X_ptr + d, count) * scale + bias;
+        if (gamma_data != nullptr) {
+          y = y * Vec::loadu(gamma_data + d, count);
+        }
+        if (beta_data != nullptr) {
+          y = y + Vec::loadu(beta_data + d, count);
+        }
+        y.store(Y_ptr + d, count);
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void layer_norm_backward_kernel_impl(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const scalar_t* dY_data = dY.data<scalar_t>();
+  const scalar_t* X_data = X.data<scalar_t>();
+  const scalar_t* mean_data = mean.data<scalar_t>();
+  const scalar_t* rstd_data = rstd.data<scalar_t>();
+  const scalar_t* gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+  const Vec zero(0);
+
+  if (dX.defined()) {
+    // With a = dY * gamma and X_hat = (X - mean) * rstd,
+    // dX = rstd * (a - mean(a) - X_hat * mean(a * X_hat)),
+    // which is computed as rstd * a + b * X + c for each row, from the sums
+    // of a and of a * (X - mean).
+    scalar_t* dX_data = dX.data<scalar_t>();
+    int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (4 * N));
+    parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* dY_ptr = dY_data + i * N;
+        const scalar_t* X_ptr = X_data + i * N;
+        scalar_t* dX_ptr = dX_data + i * N;
+        const scalar_t row_mean = mean_data[i];
+        const scalar_t row_rstd = rstd_data[i];
+        const Vec mean_vec(row_mean);
+        Vec ds_vec = zero;
+        Vec db_vec = zero;
+        for (int64_t d = 0; d < N; d += Vec::size) {
+          const int64_t count = std::min<int64_t>(Vec::size, N - d);
+          // the lanes past count are loaded as zeros, so a is zero there
+          Vec a = Vec::loadu(dY_ptr + d, count);
+          if (gamma_data != nullptr) {
+            a = a * Vec::loadu(gamma_data + d, count);
+          }
+          ds_vec = ds_vec + a * (Vec::loadu(X_ptr + d, count) - mean_vec);
+          db_vec = db_vec + a;
+        }
+        scalar_t ds_arr[Vec::size];
+        scalar_t db_arr[Vec::size];
+        ds_vec.store(ds_arr);
+        db_vec.store(db_arr);
+        scalar_t ds = 0;
+        scalar_t db = 0;
+        for (int64_t k = 0; k < Vec::size; k++) {
+          ds += ds_arr[k];
+          db += db_arr[k];
+        }
+        const scalar_t b = -ds * row_rstd * row_rstd * row_rstd / N;
+        const scalar_t c = -b * row_mean - db * row_rstd / N;
+        const Vec rstd_vec(row_rstd);
+        const Vec b_vec(b);
+        const Vec c_vec(c);
+        for (int64_t d = 0; d < N; d += Vec::size) {
+          const int64_t count = std::min<int64_t>(Vec::size, N - d);
+          Vec a = Vec::loadu(dY_ptr + d, count);
+          if (gamma_data != nullptr) {
+            a = a * Vec::loadu(gamma_data + d, count);
+          }
+          Vec dx = rstd_vec * a + b_vec * Vec::loadu(X_ptr + d, count) + c_vec;
+          dx.store(dX_ptr + d, count);
+        }
+      }
+    });
+  }
+
+  if (dgamma.defined() || dbeta.defined()) {
+    // dgamma = sum(dY * X_hat) and dbeta = sum(dY) over the rows, computed
+    // together by tasks over blocks of columns
+    scalar_t* dgamma_data = dgamma.defined() ? dgamma.data<scalar_t>() : nullptr;
+    scalar_t* dbeta_data = dbeta.defined() ? dbeta.data<scalar_t>() : nullptr;
+    int64_t grain_size = std::max<int64_t>(Vec::size, internal::GRAIN_SIZE / (4 * M));
+    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t d = begin; d < end; d += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, end - d);
+        Vec dgamma_vec = zero;
+        Vec dbeta_vec = zero;
+        for (int64_t i = 0; i < M; i++) {
+          Vec dy = Vec::loadu(dY_data + i * N + d, count);
+          if (dgamma_data != nullptr) {
+            Vec x_hat = (Vec::loadu(X_data + i * N + d, count) - Vec(mean_data[i])) *
+                Vec(rstd_data[i]);
+            dgamma_vec = dgamma_vec + dy * x_hat;
+          }
+          dbeta_vec = dbeta_vec + dy;
+        }
+        if (dgamma_data != nullptr) {
+          dgamma_vec.store(dgamma_data + d, count);
+        }
+        if (dbeta_data != nullptr) {
+          dbeta_vec.store(dbeta_data + d, count);
+        }
+      }
+    });
+  }
+}
+
+static void layer_norm_kernel(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta,
+    int64_t M, int64_t N, double eps,
+    Tensor& Y, Tensor& mean, Tensor& rstd) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "layer_norm", [&] {
+    layer_norm_kernel_impl<scalar_t>(
+        X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
+  });
+}
+
+static void layer_norm_backward_kernel(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "layer_norm_backward", [&] {
+    layer_norm_backward_kernel_impl<scalar_t>(
+        dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(layer_norm_stub, &layer_norm_kernel);
+REGISTER_DISPATCH(layer_norm_backward_stub, &layer_norm_backward_kernel);
+
+}} // namespace at::native
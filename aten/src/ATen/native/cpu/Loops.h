@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/cpu/vec256/vec256.h>
@@ -33,6 +34,19 @@ static inline bool is_binary_contiguous_s2(const int64_t* strides) {
          strides[2] == 0;
 }
 
+// some operand is strided along dimension 0 but contiguous along dimension 1
+// of a 2-d loop, e.g. a transposed or channels-last input of a contiguous
+// output (strides holds the strides of dimension 0 followed by dimension 1)
+template <typename traits>
+static inline bool is_binary_transposed(const int64_t* strides) {
+  return (strides[0] != sizeof(typename traits::result_type) &&
+          strides[3] == sizeof(typename traits::result_type)) ||
+         (strides[1] != sizeof(typename traits::arg1_t) && strides[1] != 0 &&
+          strides[4] == sizeof(typename traits::arg1_t)) ||
+         (strides[2] != sizeof(typename traits::arg2_t) && strides[2] != 0 &&
+          strides[5] == sizeof(typename traits::arg2_t));
+}
+
 // result is
 static inline bool is_reduction(char** data, const int64_t* strides) {
   return strides[0] == 0 &&
@@ -130,6 +144,78 @@ static inline void vectorized_binary_loop_s2(char** data, int64_t n, func_t op,
   binary_loop(data, strides, i, n, op);
 }
 
+// loads Vec::size elements spaced stride bytes apart, gathering them one by
+// one only if they are neither contiguous nor a broadcast scalar
+template <typename scalar_t>
+static inline Vec256<scalar_t> load_strided(const char* ptr, int64_t stride) {
+  using Vec = Vec256<scalar_t>;
+  if (stride == sizeof(scalar_t)) {
+    return Vec::loadu(ptr);
+  } else if (stride == 0) {
+    return Vec(*(scalar_t*)ptr);
+  }
+  scalar_t buffer[Vec::size];
+  for (int j = 0; j < Vec::size; j++) {
+    buffer[j] = *(scalar_t*)(ptr + j * stride);
+  }
+  return Vec::loadu(buffer);
+}
+
+// computes out = op(in1, in2) where out is contiguous and the inputs have
+// arbitrary strides
+template <typename func_t, typename vec_func_t>
+static inline void vectorized_binary_loop_strided(char** data, const int64_t* strides, int64_t n, func_t op, vec_func_t vop) {
+  VEC_LOOP_HEADER(func_t, data)
+  int64_t s1 = strides[1], s2 = strides[2];
+  int64_t i = 0;
+  for (; i <= n - Vec::size; i += Vec::size) {
+    auto a = load_strided<scalar_t>(in1_ptr + i * s1, s1);
+    auto b = load_strided<scalar_t>(in2_ptr + i * s2, s2);
+    vop(a, b).store(out_ptr + i * sizeof(scalar_t));
+  }
+  binary_loop(data, strides, i, n, op);
+}
+
+// Tiles of the blocked 2-d loop, in elements. A tile of 64 x 16 float
+// elements reads 64 cache lines of an operand transposed with respect to the
+// output, each of them 16 times, which keeps them in L1.
+constexpr int64_t kBlockSize0 = 64;
+constexpr int64_t kBlockSize1 = 16;
+
+// Runs a 2-d loop of a binary op tile by tile, calling row(ptrs, n) on the
+// row of n <= kBlockSize0 elements of each tile starting at ptrs. Operands
+// which are contiguous along dimension 1 then read each cache line several
+// times before it's evicted, instead of once per row of the whole loop.
+template <typename row_func_t>
+static inline void blocked_binary_loop(char** data, const int64_t* strides, int64_t size0, int64_t size1, row_func_t row) {
+  const int64_t* outer_strides = &strides[3];
+  for (int64_t j0 = 0; j0 < size1; j0 += kBlockSize1) {
+    int64_t j1 = std::min(size1, j0 + kBlockSize1);
+    for (int64_t i0 = 0; i0 < size0; i0 += kBlockSize0) {
+      int64_t n = std::min(size0 - i0, kBlockSize0);
+      for (int64_t j = j0; j < j1; j++) {
+        char* ptrs[3];
+        for (int arg = 0; arg < 3; arg++) {
+          ptrs[arg] = data[arg] + i0 * strides[arg] + j * outer_strides[arg];
+        }
+        row(ptrs, n);
+      }
+    }
+  }
+}
+
+// Runs row(ptrs, size0) on each of the size1 rows of a 2-d loop
+template <typename row_func_t>
+static inline void binary_rows(char** data, const int64_t* strides, int64_t size1, row_func_t row) {
+  char* ptrs[3] = { data[0], data[1], data[2] };
+  for (int64_t j = 0; j < size1; j++) {
+    row(ptrs);
+    for (int arg = 0; arg < 3; arg++) {
+      ptrs[arg] += strides[3 + arg];
+    }
+  }
+}
+
 template <typename func_t, typename vec_func_t>
 static inline void reduction128(char** data, int64_t n, int64_t stride, func_t op, vec_func_t vop, bool reduce) {
   VEC_HEADER(func_t)
@@ -212,17 +298,25 @@ template <typename func_t>
 void binary_kernel(TensorIterator& iter, func_t op) {
   using traits = binary_function_traits<func_t>;
 
-  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
-    // Specializations to encourage auto-vectorization (trick from Numpy's loops.c.src)
-    if (is_binary_contiguous<traits>(strides)) {
-      binary_loop(data, strides, 0, n, op);
-    } else if (is_binary_contiguous_s1<traits>(strides)) {
-      binary_loop(data, strides, 0, n, op);
-    } else if (is_binary_contiguous_s2<traits>(strides)) {
-      binary_loop(data, strides, 0, n, op);
-    } else {
-      binary_loop(data, strides, 0, n, op);
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    if (size1 > 1 && is_binary_transposed<traits>(strides)) {
+      blocked_binary_loop(data, strides, size0, size1, [&](char** ptrs, int64_t n) {
+        binary_loop(ptrs, strides, 0, n, op);
+      });
+      return;
     }
+    binary_rows(data, strides, size1, [&](char** ptrs) {
+      // Specializations to encourage auto-vectorization (trick from Numpy's loops.c.src)
+      if (is_binary_contiguous<traits>(strides)) {
+        binary_loop(ptrs, strides, 0, size0, op);
+      } else if (is_binary_contiguous_s1<traits>(strides)) {
+        binary_loop(ptrs, strides, 0, size0, op);
+      } else if (is_binary_contiguous_s2<traits>(strides)) {
+        binary_loop(ptrs, strides, 0, size0, op);
+      } else {
+        binary_loop(ptrs, strides, 0, size0, op);
+      }
+    });
   });
 }
 
@@ -236,16 +330,105 @@ void binary_kernel_vec(TensorIterator& iter, func_t op, vec_func_t vop) {
     std::is_same<typename traits::result_type, typename traits::arg2_t>::value,
     "all types must match");
 
-  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t n) {
-    if (is_binary_contiguous<traits>(strides)) {
-      vectorized_binary_loop(data, n, op, vop);
-    } else if (is_binary_contiguous_s1<traits>(strides)) {
-      vectorized_binary_loop_s1(data, n, op, vop);
-    } else if (is_binary_contiguous_s2<traits>(strides)) {
-      vectorized_binary_loop_s2(data, n, op, vop);
-    } else {
-      binary_loop(data, strides, 0, n, op);
+  using scalar_t = typename traits::result_type;
+
+  // A 2-d loop over operands which aren't all laid out alike, e.g. an NHWC
+  // input of an NCHW output, is run in tiles, vectorized along dimension 0
+  // if the output is contiguous along it, gathering the inputs which aren't.
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    if (size1 > 1 && is_binary_transposed<traits>(strides)) {
+      if (strides[0] == sizeof(scalar_t)) {
+        blocked_binary_loop(data, strides, size0, size1, [&](char** ptrs, int64_t n) {
+          vectorized_binary_loop_strided(ptrs, strides, n, op, vop);
+        });
+      } else {
+        blocked_binary_loop(data, strides, size0, size1, [&](char** ptrs, int64_t n) {
+          binary_loop(ptrs, strides, 0, n, op);
+        });
+      }
+      return;
+    }
+    binary_rows(data, strides, size1, [&](char** ptrs) {
+      if (is_binary_contiguous<traits>(strides)) {
+        vectorized_binary_loop(ptrs, size0, op, vop);
+      } else if (is_binary_contiguous_s1<traits>(strides)) {
+        vectorized_binary_loop_s1(ptrs, size0, op, vop);
+      } else if (is_binary_contiguous_s2<traits>(strides)) {
+        vectorized_binary_loop_s2(ptrs, size0, op, vop);
+      } else {
+        binary_loop(ptrs, strides, 0, size0, op);
+      }
+    });
+  });
+}
+
+// Vec256<float>::size Half or BFloat16 values spaced stride bytes apart, as
+// floats
+template <typename scalar_t>
+static inline Vec256<float> load_reduced_strided(const char* ptr, int64_t stride) {
+  if (stride == sizeof(scalar_t)) {
+    return load_as_float((const scalar_t*)ptr);
+  } else if (stride == 0) {
+    return Vec256<float>(static_cast<float>(*(const scalar_t*)ptr));
+  }
+  scalar_t buffer[Vec256<float>::size];
+  for (int j = 0; j < Vec256<float>::size; j++) {
+    buffer[j] = *(const scalar_t*)(ptr + j * stride);
+  }
+  return load_as_float(buffer);
+}
+
+// computes out = op(in1, in2) on n Half or BFloat16 values, in float,
+// vectorized if out is contiguous
+template <typename scalar_t, typename func_t, typename vec_func_t>
+static inline void reduced_binary_loop(char** data, const int64_t* strides, int64_t n, func_t op, vec_func_t vop) {
+  using Vec = Vec256<float>;
+  int64_t s0 = strides[0], s1 = strides[1], s2 = strides[2];
+  int64_t i = 0;
+  if (s0 == sizeof(scalar_t)) {
+    for (; i <= n - Vec::size; i += Vec::size) {
+      auto a = load_reduced_strided<scalar_t>(data[1] + i * s1, s1);
+      auto b = load_reduced_strided<scalar_t>(data[2] + i * s2, s2);
+      store_float_as(vop(a, b), (scalar_t*)(data[0] + i * s0));
+    }
+  }
+  for (; i < n; i++) {
+    float a = *(const scalar_t*)(data[1] + i * s1);
+    float b = *(const scalar_t*)(data[2] + i * s2);
+    *(scalar_t*)(data[0] + i * s0) = op(a, b);
+  }
+}
+
+// the operand types of a Half or BFloat16 op, for the stride checks
+template <typename scalar_t>
+struct reduced_binary_traits {
+  using result_type = scalar_t;
+  using arg1_t = scalar_t;
+  using arg2_t = scalar_t;
+};
+
+// binary_kernel_vec for Half or BFloat16 operands, which are stored as such
+// but computed on in float: op and vop take and return float and
+// Vec256<float>
+template <typename scalar_t, typename func_t, typename vec_func_t>
+void binary_kernel_vec_reduced(TensorIterator& iter, func_t op, vec_func_t vop) {
+  using traits = binary_function_traits<func_t>;
+  static_assert(
+    std::is_same<typename traits::result_type, float>::value &&
+    std::is_same<typename traits::arg1_t, float>::value &&
+    std::is_same<typename traits::arg2_t, float>::value,
+    "Half and BFloat16 ops are computed in float");
+
+  iter.for_each([&](int ntensor, char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    if (size1 > 1 && is_binary_transposed<reduced_binary_traits<scalar_t>>(strides)) {
+      blocked_binary_loop(data, strides, size0, size1, [&](char** ptrs, int64_t n) {
+        reduced_binary_loop<scalar_t>(ptrs, strides, n, op, vop);
+      });
+      return;
     }
+    binary_rows(data, strides, size1, [&](char** ptrs) {
+      reduced_binary_loop<scalar_t>(ptrs, strides, size0, op, vop);
+    });
   });
 }
 
@@ -0,0 +1,372 @@
+// Copyright (c) 2018 MathInf GmbH, Thomas Viehmann
+// Licensed under the BSD-3-Clause license
+// This is the CPU implementation of the Connectionist Temporal Loss.
+// We mostly follow Graves.
+// 1. Graves et al: http://www.cs.toronto.edu/~graves/icml_2006.pdf
+// We use the equations from above link, but note that [1] has 1-based indexing and we (of course) use 0-based.
+// Graves et al call the probabilities y, we use log_probs (also calling them inputs)
+//
+// The batch items are computed in parallel. Within an item, each time step of the alpha and beta recursions is a
+// log-sum-exp of the previous step shifted by 0, 1 and 2 target positions, which is computed a vector of positions
+// at a time.
+
+#include "ATen/native/LossCTC.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/TensorUtils.h"
+#include "ATen/cpu/vec256/functional.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+// this ad-hoc converts from targets (l in [1]) to augmented targets (l' in [1]) note that no bound-checking is done
+template<typename target_t>
+static inline int64_t get_target_prime(target_t* target, int64_t offset, int64_t stride, int64_t idx, int64_t BLANK) {
+  if (idx % 2 == 0) {
+    return BLANK;
+  } else {
+    return target[offset + stride * (idx / 2)];
+  }
+}
+
+// log(exp(a)+exp(b)+exp(c)), keeping track of the maximum for stability
+template<typename scalar_t>
+static inline scalar_t log_sum_exp(scalar_t a, scalar_t b, scalar_t c) {
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  scalar_t m = std::max(a, std::max(b, c));
+  if (m == neginf) // cannot do neginf-neginf
+    m = 0;
+  return std::log(std::exp(a-m)+std::exp(b-m)+std::exp(c-m))+m;
+}
+
+// One step of the alpha (shift = -1) or beta (shift = 1) recursion for the target positions s in [begin, end), eq (6)
+// and (10): out[s] is the log-sum-exp of prev[s], prev[s+shift] and prev[s+2*shift]+skip[s], plus log_probs_prime[s].
+// skip[s] is 0 if the path may skip the blank between s and s+2*shift and neginf otherwise.
+template<typename scalar_t>
+static void ctc_step(scalar_t* out, const scalar_t* prev, const scalar_t* skip, const scalar_t* log_probs_prime,
+                     int64_t begin, int64_t end, int64_t shift) {
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  int64_t s = begin;
+  for (; s + Vec::size <= end; s += Vec::size) {
+    Vec l1 = Vec::loadu(prev + s);
+    Vec l2 = Vec::loadu(prev + s + shift);
+    Vec l3 = Vec::loadu(prev + s + 2 * shift) + Vec::loadu(skip + s);
+    Vec m = vec256::max(l1, vec256::max(l2, l3));
+    m = Vec::blendv(m, Vec(0), m == Vec(neginf));
+    Vec sum = (l1 - m).exp() + (l2 - m).exp() + (l3 - m).exp();
+    (sum.log() + m + Vec::loadu(log_probs_prime + s)).store(out + s);
+  }
+  for (; s < end; s++) {
+    out[s] = log_sum_exp(prev[s], prev[s + shift], prev[s + 2 * shift] + skip[s]) + log_probs_prime[s];
+  }
+}
+
+// The offsets of the targets of each batch item and their stride, for targets of either layout
+static void get_target_offsets(const Tensor& targets, IntList target_lengths, int64_t batch_size,
+                               std::vector<int64_t>& tg_batch_offsets, int64_t& tg_target_stride,
+                               int64_t& max_target_length) {
+  tg_batch_offsets.resize(batch_size);
+  if (targets.dim() == 1) { // concatenated targets
+    int64_t pos = 0;
+    max_target_length = 0;
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets[i] = pos;
+      pos += target_lengths[i];
+      if (max_target_length < target_lengths[i])
+        max_target_length = target_lengths[i];
+    }
+    tg_target_stride = targets.stride(0);
+  }
+  else { // batch x max_target_length
+    // dim is 2
+    int64_t tg_batch_stride = targets.stride(0);
+    for (int64_t i = 0; i < batch_size; i++) {
+      tg_batch_offsets[i] = i * tg_batch_stride;
+    }
+    tg_target_stride = targets.stride(1);
+    max_target_length = targets.size(1);
+  }
+}
+
+// The augmented targets of a batch item and the skip terms of ctc_step for the alpha recursion. Those of the beta
+// recursion are skip + 2.
+template<typename scalar_t, typename target_t>
+static void get_target_primes(target_t* targets_data, int64_t tg_batch_offset, int64_t tg_target_stride,
+                              int64_t target_length, int64_t BLANK,
+                              std::vector<int64_t>& target_primes, std::vector<scalar_t>& skip) {
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  int64_t num_positions = 2*target_length+1;
+  target_primes.resize(num_positions);
+  skip.resize(num_positions);
+  for (int64_t s = 0; s < num_positions; s++) {
+    target_primes[s] = get_target_prime(targets_data, tg_batch_offset, tg_target_stride, s, BLANK);
+    skip[s] = (s > 1 && target_primes[s-2] != target_primes[s]) ? 0 : neginf;
+  }
+}
+
+// This kernel is a relatively straightforward implementation of the alpha calculation in the forward backward algorithm (section 4.1).
+// A (minor) twist is that we are using log-calculations to enhance numerical stability (log_probs and log_alpha).
+// The function returns the loss and the alphas, the alphas are kept for the backward step. The wrapper (ctc_loss) hides
+// the alphas from the user by only returning the loss.
+template<typename scalar_t, ScalarType target_scalar_type>
+std::tuple<Tensor, Tensor> ctc_loss_cpu_template(const Tensor& log_probs_, const Tensor& targets, IntList input_lengths, IntList target_lengths, int64_t BLANK) {
+  // log_probs: input_len x batch_size x num_labels
+  // targets [int64]: batch_size x target_length OR sum(target_lengths)
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  using target_t = typename std::conditional<target_scalar_type == kInt, int, int64_t>::type;
+
+  CheckedFrom c = "ctc_loss_cpu";
+  auto log_probs_arg = TensorArg(log_probs_, "log_probs", 1);
+  auto targets_arg = TensorArg(targets, "targets", 2);
+  checkScalarType(c, targets_arg, target_scalar_type);
+  checkDim(c, log_probs_arg, 3);
+  checkDimRange(c, targets_arg, 1, 3);
+
+  int64_t batch_size = log_probs_.size(1);
+  int64_t num_labels = log_probs_.size(2);
+  AT_CHECK((0 <= BLANK) && (BLANK < num_labels), "blank must be in label range");
+  AT_CHECK((int64_t) input_lengths.size() == batch_size, "input_lengths must be of size batch_size");
+  AT_CHECK((int64_t) target_lengths.size() == batch_size, "target_lengths must be of size batch_size");
+
+  int64_t tg_target_stride;
+  int64_t max_target_length;
+  std::vector<int64_t> tg_batch_offsets;
+  get_target_offsets(targets, target_lengths, batch_size, tg_batch_offsets, tg_target_stride, max_target_length);
+  if (targets.dim() == 1) {
+    checkSize(c, targets_arg, 0, std::accumulate(target_lengths.begin(), target_lengths.end(), int64_t(0)));
+  } else {
+    checkSize(c, targets_arg, 0, batch_size);
+  }
+  int64_t max_input_length = log_probs_.size(0);
+  for (int64_t b = 0; b < batch_size; b++) {
+    AT_CHECK(input_lengths[b] <= max_input_length,
+             "Expected tensor to have size at least ", max_input_length, " at dimension 1, but got size ", targets.size(0), " for ", targets_arg,
+             " (while checking arguments for ", c, ")");
+  }
+
+  Tensor log_probs = log_probs_.contiguous();
+  int64_t max_num_positions = 2*max_target_length+1;
+  Tensor log_alpha = at::empty({batch_size, max_input_length, max_num_positions}, log_probs.options());
+  Tensor neg_log_likelihood = at::empty({batch_size}, log_probs.options());
+
+  scalar_t* log_probs_data = log_probs.data<scalar_t>();
+  scalar_t* log_alpha_data = log_alpha.data<scalar_t>();
+  scalar_t* neg_log_likelihood_data = neg_log_likelihood.data<scalar_t>();
+  auto targets_data = targets.data<target_t>();
+  int64_t lp_input_stride = log_probs.stride(0);
+  int64_t lp_batch_stride = log_probs.stride(1);
+
+  parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+    // reused across the batch items of the chunk
+    std::vector<int64_t> target_primes;
+    std::vector<scalar_t> skip;
+    std::vector<scalar_t> log_probs_prime(max_num_positions);
+    for (int64_t b = begin; b < end; b++) {
+      int64_t input_length = input_lengths[b];
+      int64_t target_length = target_lengths[b];
+      int64_t num_positions = 2*target_length+1;
+      const scalar_t* log_probs_b = log_probs_data + b * lp_batch_stride;
+      scalar_t* log_alpha_b = log_alpha_data + b * max_input_length * max_num_positions;
+      get_target_primes(targets_data, tg_batch_offsets[b], tg_target_stride, target_length, BLANK, target_primes, skip);
+
+      // alpha calculation for the first row, the three equations for alpha_1 above eq (6)
+      // first the default
+      std::fill(log_alpha_b, log_alpha_b + max_num_positions, neginf);
+      // the first two items of alpha_t above eq (6)
+      log_alpha_b[0] = log_probs_b[BLANK];
+      if (target_length > 0)
+        log_alpha_b[1] = log_probs_b[target_primes[1]];
+
+      // now the loop over the inputs
+      for (int64_t t=1; t<input_length; t++) {
+        const scalar_t* lp_t = log_probs_b + t * lp_input_stride;
+        const scalar_t* prev = log_alpha_b + (t-1) * max_num_positions;
+        scalar_t* cur = log_alpha_b + t * max_num_positions;
+        for (int64_t s=0; s<num_positions; s++) {
+          log_probs_prime[s] = lp_t[target_primes[s]];
+        }
+        // This is eq (6) and (7), la1,2,3 are the three summands, of which the first two positions have fewer
+        cur[0] = log_sum_exp(prev[0], neginf, neginf) + log_probs_prime[0];
+        if (num_positions > 1)
+          cur[1] = log_sum_exp(prev[1], prev[0], neginf) + log_probs_prime[1];
+        ctc_step(cur, prev, skip.data(), log_probs_prime.data(), 2, num_positions, -1);
+      }
+      // the likelihood is the the sum of the last two alphas, eq (8), the loss is the negative log likelihood
+      const scalar_t* last = log_alpha_b + (input_length-1) * max_num_positions;
+      scalar_t l1 = last[target_length*2];
+      scalar_t l2 = target_length > 0 ? last[target_length*2-1] : neginf;
+      scalar_t m = std::max(l1, l2);
+      m = ((m == neginf) ? 0 : m);
+      scalar_t log_likelihood = std::log(std::exp(l1-m)+std::exp(l2-m))+m;
+      neg_log_likelihood_data[b] = -log_likelihood;
+    }
+  });
+
+  return std::make_tuple(neg_log_likelihood, log_alpha);
+}
+
+// This is the backward. It consists of two phases:
+// a) computing the beta analogous to the alphas in the forward (backward half of the forward-backward algorithm) (eq (10) and (11))
+// b) collecting the per-activation characters for all s and wrapping the gradient (eq (16), the collection is the sum)
+// Each beta is only needed for the next time step and the collection of its own, so two rows of betas per batch item
+// are kept instead of a tensor of the size of log_alpha.
+template<typename scalar_t, ScalarType target_scalar_type>
+Tensor ctc_loss_backward_cpu_template(const Tensor& grad_out, const Tensor& log_probs_, const Tensor& targets, IntList input_lengths, IntList target_lengths,
+                                      const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK) {
+  constexpr scalar_t neginf = -std::numeric_limits<scalar_t>::infinity();
+  using target_t = typename std::conditional<target_scalar_type == kInt, int, int64_t>::type;
+  Tensor log_probs = log_probs_.contiguous();
+  int64_t max_input_length = log_probs.size(0);
+  int64_t batch_size = log_probs.size(1);
+  int64_t num_labels = log_probs.size(2);
+  Tensor grad = at::full_like(log_probs, neginf); // at this point, this is log of empty sum
+
+  // The admin bits. We don't do much checking and assume that the forward did.
+  int64_t tg_target_stride;
+  int64_t max_target_length;
+  std::vector<int64_t> tg_batch_offsets;
+  get_target_offsets(targets, target_lengths, batch_size, tg_batch_offsets, tg_target_stride, max_target_length);
+
+  int64_t max_num_positions = log_alpha.size(2);
+  scalar_t* log_probs_data = log_probs.data<scalar_t>();
+  const scalar_t* log_alpha_data = log_alpha.data<scalar_t>();
+  scalar_t* grad_data = grad.data<scalar_t>();
+  auto targets_data = targets.data<target_t>();
+  Tensor nll_contig = neg_log_likelihood.contiguous();
+  Tensor grad_out_contig = grad_out.contiguous();
+  const scalar_t* nll_data = nll_contig.data<scalar_t>();
+  const scalar_t* grad_out_data = grad_out_contig.data<scalar_t>();
+  // log_probs and grad are both contiguous input_len x batch_size x num_labels
+  int64_t input_stride = log_probs.stride(0);
+  int64_t batch_stride = log_probs.stride(1);
+
+  parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+    using Vec = vec256::Vec256<scalar_t>;
+    // reused across the batch items of the chunk
+    std::vector<int64_t> target_primes;
+    std::vector<scalar_t> skip;
+    std::vector<scalar_t> log_probs_prime(max_num_positions);
+    std::vector<scalar_t> log_beta_rows(2 * max_num_positions);
+    for (int64_t b = begin; b < end; b++) {
+      scalar_t* log_probs_b = log_probs_data + b * batch_stride;
+      const scalar_t* log_alpha_b = log_alpha_data + b * log_alpha.stride(0);
+      scalar_t* grad_b = grad_data + b * batch_stride;
+      int64_t input_length = input_lengths[b];
+      int64_t target_length = target_lengths[b];
+      int64_t num_positions = 2*target_length+1;
+      get_target_primes(targets_data, tg_batch_offsets[b], tg_target_stride, target_length, BLANK, target_primes, skip);
+      // the beta of the time step being computed and of the one after it
+      scalar_t* log_beta = log_beta_rows.data();
+      scalar_t* log_beta_next = log_beta_rows.data() + max_num_positions;
+
+      // the initialization of beta before eq (10)
+      // here we do the fill for each batch item separately, as the input lengths will differ, so the t in which
+      // we start varies
+      if (input_length > 0) {
+        const scalar_t* lp_t = log_probs_b + (input_length-1) * input_stride;
+        const scalar_t* la_t = log_alpha_b + (input_length-1) * max_num_positions;
+        scalar_t* grad_t = grad_b + (input_length-1) * input_stride;
+        std::fill(log_beta_next, log_beta_next + max_num_positions, neginf);
+        log_beta_next[2*target_length] = lp_t[BLANK];
+        grad_t[BLANK] = la_t[2*target_length] + log_beta_next[2*target_length];
+
+        if (target_length > 0) {
+          auto current_target_prime = target_primes[2*target_length-1];
+          log_beta_next[2*target_length-1] = lp_t[current_target_prime];
+
+          // the first two are a blank and a non-blank, so we know they are different and we don't need to do log+
+          grad_t[current_target_prime] = la_t[2*target_length-1] + log_beta_next[2*target_length-1];
+        }
+      }
+
+      // now loop applying eq (10) / (11)
+      for (int64_t t=input_length-2; t>=0; t--) {
+        const scalar_t* lp_t = log_probs_b + t * input_stride;
+        const scalar_t* la_t = log_alpha_b + t * max_num_positions;
+        scalar_t* grad_t = grad_b + t * input_stride;
+        for (int64_t s=0; s<num_positions; s++) {
+          log_probs_prime[s] = lp_t[target_primes[s]];
+        }
+        // the last two positions have fewer summands lb1,2,3
+        log_beta[2*target_length] =
+            log_sum_exp(log_beta_next[2*target_length], neginf, neginf) + log_probs_prime[2*target_length];
+        if (target_length > 0)
+          log_beta[2*target_length-1] =
+              log_sum_exp(log_beta_next[2*target_length-1], log_beta_next[2*target_length], neginf) +
+              log_probs_prime[2*target_length-1];
+        ctc_step(log_beta, log_beta_next, skip.data() + 2, log_probs_prime.data(), 0, 2*target_length-1, 1);
+
+        // now that we have beta, we fill in the sum of alpha*beta in eq (16)
+        // in contrast to the cuda implementation, we only parallelize over the batch, so we don't have a concurrency
+        // issue (several s can map to the same target character)
+        // collected[b, t, target'[s]] "log+=" log_alpha[t, s]+log_beta[t, s]
+        for (int64_t s=2*target_length; s>=0; s--) {
+          scalar_t log_alpha_beta = la_t[s] + log_beta[s];
+          scalar_t &lcab = grad_t[target_primes[s]];
+          if (lcab == neginf) {
+            lcab = log_alpha_beta;
+          } else {
+            scalar_t max = std::max(lcab, log_alpha_beta);
+            lcab = std::log(std::exp(lcab-max)+std::exp(log_alpha_beta-max))+max;
+          }
+        }
+        std::swap(log_beta, log_beta_next);
+      }
+
+      // now grad has the sum of eq (16)
+      // now we wrap up the calculation by adding in the remaining items of eq (16)
+      // grad is the output gradient, nll is the loss. Note that the likelihood -nll is the Z of eq (16)
+      scalar_t nll = nll_data[b];
+      scalar_t gr = grad_out_data[b];
+      for (int64_t t = 0; t < input_length; t++) { // or go for the full thing?
+        scalar_t* grad_t = grad_b + t * input_stride;
+        vec256::map2(
+            [nll, gr](Vec res, Vec lp) { return (lp.exp() - (res + Vec(nll) - lp).exp()) * Vec(gr); },
+            grad_t, grad_t, log_probs_b + t * input_stride, num_labels);
+      }
+      // zero the remainder
+      for (int64_t t = input_length; t < max_input_length; t++) {
+        std::fill(grad_b + t * input_stride, grad_b + t * input_stride + num_labels, scalar_t(0));
+      }
+    }
+  });
+  return grad;
+}
+
+std::tuple<Tensor, Tensor> ctc_loss_kernel(const Tensor& log_probs, const Tensor& targets, IntList input_lengths, IntList target_lengths, int64_t BLANK) {
+  return AT_DISPATCH_FLOATING_TYPES(log_probs.type(), "ctc_loss", [&] {
+      if (targets.type().scalarType() == kLong) {
+        return ctc_loss_cpu_template<scalar_t, kLong>(log_probs, targets, input_lengths, target_lengths, BLANK);
+      } else {
+        return ctc_loss_cpu_template<scalar_t, kInt>(log_probs, targets, input_lengths, target_lengths, BLANK);
+      }
+  });
+}
+
+Tensor ctc_loss_backward_kernel(const Tensor& grad, const Tensor& log_probs, const Tensor& targets, IntList input_lengths, IntList target_lengths,
+                                const Tensor& neg_log_likelihood, const Tensor& log_alpha, int64_t BLANK) {
+  return AT_DISPATCH_FLOATING_TYPES(log_probs.type(), "ctc_loss_backward", [&] {
+      if (targets.type().scalarType() == kLong) {
+        return ctc_loss_backward_cpu_template<scalar_t,kLong>(grad, log_probs, targets, input_lengths, target_lengths, neg_log_likelihood, log_alpha, BLANK);
+      } else {
+        return ctc_loss_backward_cpu_template<scalar_t,kInt>(grad, log_probs, targets, input_lengths, target_lengths, neg_log_likelihood, log_alpha, BLANK);
+      }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(ctc_loss_stub, &ctc_loss_kernel);
+REGISTER_DISPATCH(ctc_loss_backward_stub, &ctc_loss_backward_kernel);
+
+}} // namespace at::native
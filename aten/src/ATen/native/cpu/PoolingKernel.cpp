@@ -0,0 +1,212 @@
+#include "ATen/native/Pooling.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+#include "ATen/native/ChannelsLast.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// The input elements an output element pools along a dimension: from start
+// to end, every dilation, clipped to the input, and the size of the window
+// counting the padded elements, as averages divide by
+struct Window {
+  int64_t start;
+  int64_t end;
+  int64_t padded_size;
+};
+
+static inline Window window(
+    int64_t output_index, int64_t input_size, int64_t kernel, int64_t stride,
+    int64_t pad, int64_t dilation) {
+  Window w;
+  w.start = output_index * stride - pad;
+  w.end = std::min(w.start + (kernel - 1) * dilation + 1, input_size);
+  w.padded_size = std::min(w.start + kernel, input_size + pad) - w.start;
+  while (w.start < 0) {
+    w.start += dilation;
+  }
+  return w;
+}
+
+// The max, in which NaNs propagate as in THNN
+template <typename scalar_t>
+struct MaxOp {
+  using Vec = Vec256<scalar_t>;
+  static scalar_t init() {
+    return -std::numeric_limits<scalar_t>::infinity();
+  }
+  static scalar_t combine(scalar_t acc, scalar_t value) {
+    return (value > acc || value != value) ? value : acc;
+  }
+  // Vec256 comparisons are ordered, false if an operand is NaN, so the NaN
+  // lanes of value are those not equal to themselves
+  static Vec combine(const Vec& acc, const Vec& value) {
+    return Vec::blendv(value, Vec::blendv(acc, value, value > acc), value == value);
+  }
+  template <typename T>
+  static T finalize(const T& acc, int64_t /*divisor*/) {
+    return acc;
+  }
+};
+
+template <typename scalar_t>
+struct AvgOp {
+  using Vec = Vec256<scalar_t>;
+  static scalar_t init() {
+    return 0;
+  }
+  static scalar_t combine(scalar_t acc, scalar_t value) {
+    return acc + value;
+  }
+  static Vec combine(const Vec& acc, const Vec& value) {
+    return acc + value;
+  }
+  static scalar_t finalize(scalar_t acc, int64_t divisor) {
+    return acc / divisor;
+  }
+  static Vec finalize(const Vec& acc, int64_t divisor) {
+    return acc / Vec(static_cast<scalar_t>(divisor));
+  }
+};
+
+static inline int64_t divisor(
+    const Window& h, const Window& w, const PoolingParams2d& p) {
+  return p.count_include_pad ? h.padded_size * w.padded_size
+                             : (h.end - h.start) * (w.end - w.start);
+}
+
+// Pools the planes [begin, end) of a contiguous input. The windows of
+// consecutive outputs of a row are consecutive when the stride and the
+// dilation along the width are 1, so that the outputs whose windows are
+// inside the input are computed a vector at a time.
+template <typename scalar_t, typename Op>
+void pool_planes(
+    scalar_t* output, const scalar_t* input, int64_t begin, int64_t end,
+    int64_t input_h, int64_t input_w, int64_t output_h, int64_t output_w,
+    const PoolingParams2d& p) {
+  using Vec = Vec256<scalar_t>;
+  const bool vectorize = p.stride_w == 1 && p.dilation_w == 1;
+  // The outputs whose windows are inside the input along the width
+  const int64_t inner_begin = std::min(p.pad_w, output_w);
+  const int64_t inner_end = std::max(
+      inner_begin, std::min(input_w - p.kernel_w + p.pad_w + 1, output_w));
+  for (int64_t plane = begin; plane < end; plane++) {
+    const scalar_t* in = input + plane * input_h * input_w;
+    scalar_t* out = output + plane * output_h * output_w;
+    for (int64_t oh = 0; oh < output_h; oh++) {
+      const Window h = window(oh, input_h, p.kernel_h, p.stride_h, p.pad_h, p.dilation_h);
+      int64_t ow = 0;
+      while (ow < output_w) {
+        if (vectorize && ow >= inner_begin && ow + Vec::size <= inner_end) {
+          const int64_t iw0 = ow - p.pad_w;
+          Vec acc(Op::init());
+          for (int64_t ih = h.start; ih < h.end; ih += p.dilation_h) {
+            for (int64_t kw = 0; kw < p.kernel_w; kw++) {
+              acc = Op::combine(acc, Vec::loadu(in + ih * input_w + iw0 + kw));
+            }
+          }
+          const int64_t div = (p.count_include_pad ? h.padded_size : h.end - h.start) * p.kernel_w;
+          Op::finalize(acc, div).store(out + oh * output_w + ow);
+          ow += Vec::size;
+          continue;
+        }
+        const Window w = window(ow, input_w, p.kernel_w, p.stride_w, p.pad_w, p.dilation_w);
+        scalar_t acc = Op::init();
+        for (int64_t ih = h.start; ih < h.end; ih += p.dilation_h) {
+          for (int64_t iw = w.start; iw < w.end; iw += p.dilation_w) {
+            acc = Op::combine(acc, in[ih * input_w + iw]);
+          }
+        }
+        out[oh * output_w + ow] = Op::finalize(acc, divisor(h, w, p));
+        ow++;
+      }
+    }
+  }
+}
+
+// Pools the rows [begin, end), of index n * output_h + oh, of a channels last
+// input, a vector of channels at a time
+template <typename scalar_t, typename Op>
+void pool_rows_channels_last(
+    scalar_t* output, const scalar_t* input, int64_t begin, int64_t end,
+    int64_t channels, int64_t input_h, int64_t input_w, int64_t output_h,
+    int64_t output_w, const PoolingParams2d& p) {
+  using Vec = Vec256<scalar_t>;
+  for (int64_t row = begin; row < end; row++) {
+    const int64_t n = row / output_h;
+    const int64_t oh = row % output_h;
+    const scalar_t* in = input + n * input_h * input_w * channels;
+    const Window h = window(oh, input_h, p.kernel_h, p.stride_h, p.pad_h, p.dilation_h);
+    for (int64_t ow = 0; ow < output_w; ow++) {
+      const Window w = window(ow, input_w, p.kernel_w, p.stride_w, p.pad_w, p.dilation_w);
+      const int64_t div = divisor(h, w, p);
+      scalar_t* out = output + (row * output_w + ow) * channels;
+      for (int64_t c = 0; c < channels; c += Vec::size) {
+        const int64_t count = std::min<int64_t>(Vec::size, channels - c);
+        Vec acc(Op::init());
+        for (int64_t ih = h.start; ih < h.end; ih += p.dilation_h) {
+          for (int64_t iw = w.start; iw < w.end; iw += p.dilation_w) {
+            const scalar_t* ptr = in + (ih * input_w + iw) * channels + c;
+            acc = Op::combine(
+                acc, count == Vec::size ? Vec::loadu(ptr) : Vec::loadu(ptr, count));
+          }
+        }
+        Op::finalize(acc, div).store(out + c, count);
+      }
+    }
+  }
+}
+
+template <template <typename> class Op>
+void pool_kernel(Tensor& output, const Tensor& input, const PoolingParams2d& p) {
+  const int64_t batch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t input_h = input.size(2);
+  const int64_t input_w = input.size(3);
+  const int64_t output_h = output.size(2);
+  const int64_t output_w = output.size(3);
+  const int64_t window_size = p.kernel_h * p.kernel_w;
+  const bool channels_last = is_channels_last(input);
+
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "pool2d", [&] {
+    scalar_t* out = output.data<scalar_t>();
+    const scalar_t* in = input.data<scalar_t>();
+    if (channels_last) {
+      const int64_t grain_size = std::max<int64_t>(
+          1, internal::GRAIN_SIZE / (output_w * channels * window_size));
+      parallel_for(0, batch * output_h, grain_size, [&](int64_t begin, int64_t end) {
+        pool_rows_channels_last<scalar_t, Op<scalar_t>>(
+            out, in, begin, end, channels, input_h, input_w, output_h, output_w, p);
+      });
+    } else {
+      const int64_t grain_size = std::max<int64_t>(
+          1, internal::GRAIN_SIZE / (output_h * output_w * window_size));
+      parallel_for(0, batch * channels, grain_size, [&](int64_t begin, int64_t end) {
+        pool_planes<scalar_t, Op<scalar_t>>(
+            out, in, begin, end, input_h, input_w, output_h, output_w, p);
+      });
+    }
+  });
+}
+
+static void max_pool2d_kernel_impl(Tensor& output, const Tensor& input, const PoolingParams2d& params) {
+  pool_kernel<MaxOp>(output, input, params);
+}
+
+static void avg_pool2d_kernel_impl(Tensor& output, const Tensor& input, const PoolingParams2d& params) {
+  pool_kernel<AvgOp>(output, input, params);
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(max_pool2d_kernel, &max_pool2d_kernel_impl);
+REGISTER_DISPATCH(avg_pool2d_kernel, &avg_pool2d_kernel_impl);
+
+}} // namespace at::native
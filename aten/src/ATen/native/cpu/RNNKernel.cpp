@@ -0,0 +1,333 @@
+#include "ATen/native/RNN.h"
+
+#include <cmath>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// The cell ops below are written once for a single element (scalar_t) and for
+// Vec256<scalar_t>::size consecutive elements of a row (Vec256<scalar_t>), so
+// that the vectorized loop and its scalar tail compute the same thing.
+
+template <typename scalar_t>
+inline scalar_t load(const scalar_t* ptr, scalar_t /* tag */) {
+  return *ptr;
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> load(const scalar_t* ptr, Vec256<scalar_t> /* tag */) {
+  return Vec256<scalar_t>::loadu(ptr);
+}
+
+// Biases are optional: a missing one reads as zero
+template <typename vec_t, typename scalar_t>
+inline vec_t load_or_zero(const scalar_t* ptr) {
+  return ptr ? load(ptr, vec_t()) : vec_t(0);
+}
+
+template <typename scalar_t>
+inline void store(scalar_t* ptr, scalar_t value) {
+  *ptr = value;
+}
+
+template <typename scalar_t>
+inline void store(scalar_t* ptr, Vec256<scalar_t> value) {
+  value.store(ptr);
+}
+
+template <typename scalar_t>
+inline scalar_t sigmoid(scalar_t x) {
+  return scalar_t(1) / (scalar_t(1) + std::exp(-x));
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> sigmoid(Vec256<scalar_t> x) {
+  return (Vec256<scalar_t>(1) + x.neg().exp()).reciprocal();
+}
+
+template <typename scalar_t>
+inline scalar_t tanh(scalar_t x) {
+  return std::tanh(x);
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> tanh(Vec256<scalar_t> x) {
+  return x.tanh();
+}
+
+// Runs op.apply<vec_t>(b, j) over the elements j of the hidden state (of
+// size hidden_size) of every batch row b: Vec256::size elements at a time,
+// then one at a time for the rest of the row. The rows are processed in
+// parallel, with about GRAIN_SIZE elements per task.
+template <typename scalar_t, typename op_t>
+void cell_kernel(const op_t& op, int64_t batch_size, int64_t hidden_size) {
+  using Vec = Vec256<scalar_t>;
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, hidden_size));
+  parallel_for(0, batch_size, grain_size, [&](int64_t start, int64_t end) {
+    for (int64_t b = start; b < end; b++) {
+      int64_t j = 0;
+      for (; j + Vec::size <= hidden_size; j += Vec::size) {
+        op.template apply<Vec>(b, j);
+      }
+      for (; j < hidden_size; j++) {
+        op.template apply<scalar_t>(b, j);
+      }
+    }
+  });
+}
+
+// workspace: the gates i, f, c, o (4 * hidden_size per row)
+template <typename scalar_t>
+struct LSTMCellOp {
+  LSTMCellOp(Tensor& hy, Tensor& cy, Tensor& workspace,
+             const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& cx,
+             const Tensor& input_bias, const Tensor& hidden_bias)
+    : hsz(cx.size(1))
+    , igates(input_gates.data<scalar_t>())
+    , hgates(hidden_gates.data<scalar_t>())
+    , cx(cx.data<scalar_t>())
+    , b1(input_bias.defined() ? input_bias.data<scalar_t>() : nullptr)
+    , b2(hidden_bias.defined() ? hidden_bias.data<scalar_t>() : nullptr)
+    , hy(hy.data<scalar_t>())
+    , cy(cy.data<scalar_t>())
+    , ws(workspace.data<scalar_t>()) {}
+
+  int64_t hsz;
+  const scalar_t* igates;
+  const scalar_t* hgates;
+  const scalar_t* cx;
+  const scalar_t* b1;
+  const scalar_t* b2;
+  scalar_t* hy;
+  scalar_t* cy;
+  scalar_t* ws;
+
+  template <typename vec_t>
+  vec_t gate(int64_t b, int64_t k, int64_t j) const {
+    int64_t g = b * 4 * hsz + k * hsz + j;
+    int64_t idx = k * hsz + j;
+    return load(igates + g, vec_t()) + load(hgates + g, vec_t()) +
+           load_or_zero<vec_t>(b1 ? b1 + idx : nullptr) +
+           load_or_zero<vec_t>(b2 ? b2 + idx : nullptr);
+  }
+
+  template <typename vec_t>
+  void apply(int64_t b, int64_t j) const {
+    vec_t ig = sigmoid(gate<vec_t>(b, 0, j));
+    vec_t fg = sigmoid(gate<vec_t>(b, 1, j));
+    vec_t cg = tanh(gate<vec_t>(b, 2, j));
+    vec_t og = sigmoid(gate<vec_t>(b, 3, j));
+
+    int64_t idx = b * hsz + j;
+    vec_t c = fg * load(cx + idx, vec_t()) + ig * cg;
+    store(cy + idx, c);
+    store(hy + idx, og * tanh(c));
+
+    scalar_t* ws_row = ws + b * 4 * hsz;
+    store(ws_row + 0 * hsz + j, ig);
+    store(ws_row + 1 * hsz + j, fg);
+    store(ws_row + 2 * hsz + j, cg);
+    store(ws_row + 3 * hsz + j, og);
+  }
+};
+
+// A missing grad_hy or grad_cy reads as zero
+template <typename scalar_t>
+struct LSTMCellBackwardOp {
+  LSTMCellBackwardOp(Tensor& grad_gates, Tensor& grad_cx,
+                     const Tensor& grad_hy, const Tensor& grad_cy,
+                     const Tensor& cx, const Tensor& cy, const Tensor& workspace)
+    : hsz(cx.size(1))
+    , ghy(grad_hy.defined() ? grad_hy.data<scalar_t>() : nullptr)
+    , gcy(grad_cy.defined() ? grad_cy.data<scalar_t>() : nullptr)
+    , cx(cx.data<scalar_t>())
+    , cy(cy.data<scalar_t>())
+    , ws(workspace.data<scalar_t>())
+    , ggates(grad_gates.data<scalar_t>())
+    , gcx(grad_cx.data<scalar_t>()) {}
+
+  int64_t hsz;
+  const scalar_t* ghy;
+  const scalar_t* gcy;
+  const scalar_t* cx;
+  const scalar_t* cy;
+  const scalar_t* ws;
+  scalar_t* ggates;
+  scalar_t* gcx;
+
+  template <typename vec_t>
+  void apply(int64_t b, int64_t j) const {
+    int64_t idx = b * hsz + j;
+    const scalar_t* ws_row = ws + b * 4 * hsz;
+    vec_t one = vec_t(1);
+    vec_t ig = load(ws_row + 0 * hsz + j, vec_t());
+    vec_t fg = load(ws_row + 1 * hsz + j, vec_t());
+    vec_t cg = load(ws_row + 2 * hsz + j, vec_t());
+    vec_t og = load(ws_row + 3 * hsz + j, vec_t());
+    vec_t go = load_or_zero<vec_t>(ghy ? ghy + idx : nullptr);
+    vec_t goc = load_or_zero<vec_t>(gcy ? gcy + idx : nullptr);
+
+    vec_t tanh_cy = tanh(load(cy + idx, vec_t()));
+    vec_t grad_c = go * og * (one - tanh_cy * tanh_cy) + goc;
+
+    scalar_t* gg_row = ggates + b * 4 * hsz;
+    store(gg_row + 0 * hsz + j, grad_c * cg * (one - ig) * ig);
+    store(gg_row + 1 * hsz + j, grad_c * load(cx + idx, vec_t()) * (one - fg) * fg);
+    store(gg_row + 2 * hsz + j, grad_c * ig * (one - cg * cg));
+    store(gg_row + 3 * hsz + j, go * tanh_cy * (one - og) * og);
+    store(gcx + idx, grad_c * fg);
+  }
+};
+
+// workspace: the gates r, i, n, the previous hidden state and the hidden part
+// of the new gate (including its bias), 5 * hidden_size per row
+template <typename scalar_t>
+struct GRUCellOp {
+  GRUCellOp(Tensor& hy, Tensor& workspace,
+            const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& hx,
+            const Tensor& input_bias, const Tensor& hidden_bias)
+    : hsz(hx.size(1))
+    , igates(input_gates.data<scalar_t>())
+    , hgates(hidden_gates.data<scalar_t>())
+    , hx(hx.data<scalar_t>())
+    , b1(input_bias.defined() ? input_bias.data<scalar_t>() : nullptr)
+    , b2(hidden_bias.defined() ? hidden_bias.data<scalar_t>() : nullptr)
+    , hy(hy.data<scalar_t>())
+    , ws(workspace.data<scalar_t>()) {}
+
+  int64_t hsz;
+  const scalar_t* igates;
+  const scalar_t* hgates;
+  const scalar_t* hx;
+  const scalar_t* b1;
+  const scalar_t* b2;
+  scalar_t* hy;
+  scalar_t* ws;
+
+  template <typename vec_t>
+  vec_t input_gate(int64_t b, int64_t k, int64_t j) const {
+    int64_t idx = k * hsz + j;
+    return load(igates + b * 3 * hsz + idx, vec_t()) + load_or_zero<vec_t>(b1 ? b1 + idx : nullptr);
+  }
+
+  template <typename vec_t>
+  vec_t hidden_gate(int64_t b, int64_t k, int64_t j) const {
+    int64_t idx = k * hsz + j;
+    return load(hgates + b * 3 * hsz + idx, vec_t()) + load_or_zero<vec_t>(b2 ? b2 + idx : nullptr);
+  }
+
+  template <typename vec_t>
+  void apply(int64_t b, int64_t j) const {
+    vec_t rg = sigmoid(input_gate<vec_t>(b, 0, j) + hidden_gate<vec_t>(b, 0, j));
+    vec_t ig = sigmoid(input_gate<vec_t>(b, 1, j) + hidden_gate<vec_t>(b, 1, j));
+    vec_t hn = hidden_gate<vec_t>(b, 2, j);
+    vec_t ng = tanh(input_gate<vec_t>(b, 2, j) + rg * hn);
+
+    int64_t idx = b * hsz + j;
+    vec_t h = load(hx + idx, vec_t());
+    store(hy + idx, ng + ig * (h - ng));
+
+    scalar_t* ws_row = ws + b * 5 * hsz;
+    store(ws_row + 0 * hsz + j, rg);
+    store(ws_row + 1 * hsz + j, ig);
+    store(ws_row + 2 * hsz + j, ng);
+    store(ws_row + 3 * hsz + j, h);
+    store(ws_row + 4 * hsz + j, hn);
+  }
+};
+
+template <typename scalar_t>
+struct GRUCellBackwardOp {
+  GRUCellBackwardOp(Tensor& grad_input_gates, Tensor& grad_hidden_gates, Tensor& grad_hx,
+                    const Tensor& grad_hy, const Tensor& workspace)
+    : hsz(grad_hy.size(1))
+    , ghy(grad_hy.data<scalar_t>())
+    , ws(workspace.data<scalar_t>())
+    , gigates(grad_input_gates.data<scalar_t>())
+    , ghgates(grad_hidden_gates.data<scalar_t>())
+    , ghx(grad_hx.data<scalar_t>()) {}
+
+  int64_t hsz;
+  const scalar_t* ghy;
+  const scalar_t* ws;
+  scalar_t* gigates;
+  scalar_t* ghgates;
+  scalar_t* ghx;
+
+  template <typename vec_t>
+  void apply(int64_t b, int64_t j) const {
+    int64_t idx = b * hsz + j;
+    const scalar_t* ws_row = ws + b * 5 * hsz;
+    vec_t one = vec_t(1);
+    vec_t rg = load(ws_row + 0 * hsz + j, vec_t());
+    vec_t ig = load(ws_row + 1 * hsz + j, vec_t());
+    vec_t ng = load(ws_row + 2 * hsz + j, vec_t());
+    vec_t hx = load(ws_row + 3 * hsz + j, vec_t());
+    vec_t hn = load(ws_row + 4 * hsz + j, vec_t());
+    vec_t go = load(ghy + idx, vec_t());
+
+    vec_t gig = go * (hx - ng) * (one - ig) * ig;
+    vec_t gin = go * (one - ig) * (one - ng * ng);
+    vec_t grg = gin * hn * (one - rg) * rg;
+
+    scalar_t* gi_row = gigates + b * 3 * hsz;
+    scalar_t* gh_row = ghgates + b * 3 * hsz;
+    store(gi_row + 0 * hsz + j, grg);
+    store(gi_row + 1 * hsz + j, gig);
+    store(gi_row + 2 * hsz + j, gin);
+    store(gh_row + 0 * hsz + j, grg);
+    store(gh_row + 1 * hsz + j, gig);
+    store(gh_row + 2 * hsz + j, gin * rg);
+    store(ghx + idx, go * ig);
+  }
+};
+
+static void lstm_cell_kernel(Tensor& hy, Tensor& cy, Tensor& workspace,
+                             const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& cx,
+                             const Tensor& input_bias, const Tensor& hidden_bias) {
+  AT_DISPATCH_FLOATING_TYPES(cx.type(), "lstm_cell", [&] {
+    LSTMCellOp<scalar_t> op(hy, cy, workspace, input_gates, hidden_gates, cx, input_bias, hidden_bias);
+    cell_kernel<scalar_t>(op, cx.size(0), cx.size(1));
+  });
+}
+
+static void lstm_cell_backward_kernel(Tensor& grad_gates, Tensor& grad_cx,
+                                      const Tensor& grad_hy, const Tensor& grad_cy,
+                                      const Tensor& cx, const Tensor& cy, const Tensor& workspace) {
+  AT_DISPATCH_FLOATING_TYPES(cx.type(), "lstm_cell_backward", [&] {
+    LSTMCellBackwardOp<scalar_t> op(grad_gates, grad_cx, grad_hy, grad_cy, cx, cy, workspace);
+    cell_kernel<scalar_t>(op, cx.size(0), cx.size(1));
+  });
+}
+
+static void gru_cell_kernel(Tensor& hy, Tensor& workspace,
+                            const Tensor& input_gates, const Tensor& hidden_gates, const Tensor& hx,
+                            const Tensor& input_bias, const Tensor& hidden_bias) {
+  AT_DISPATCH_FLOATING_TYPES(hx.type(), "gru_cell", [&] {
+    GRUCellOp<scalar_t> op(hy, workspace, input_gates, hidden_gates, hx, input_bias, hidden_bias);
+    cell_kernel<scalar_t>(op, hx.size(0), hx.size(1));
+  });
+}
+
+static void gru_cell_backward_kernel(Tensor& grad_input_gates, Tensor& grad_hidden_gates, Tensor& grad_hx,
+                                     const Tensor& grad_hy, const Tensor& workspace) {
+  AT_DISPATCH_FLOATING_TYPES(grad_hy.type(), "gru_cell_backward", [&] {
+    GRUCellBackwardOp<scalar_t> op(grad_input_gates, grad_hidden_gates, grad_hx, grad_hy, workspace);
+    cell_kernel<scalar_t>(op, grad_hy.size(0), grad_hy.size(1));
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_cell_stub, &lstm_cell_kernel);
+REGISTER_DISPATCH(lstm_cell_backward_stub, &lstm_cell_backward_kernel);
+REGISTER_DISPATCH(gru_cell_stub, &gru_cell_kernel);
+REGISTER_DISPATCH(gru_cell_backward_stub, &gru_cell_backward_kernel);
+
+}} // namespace at::native
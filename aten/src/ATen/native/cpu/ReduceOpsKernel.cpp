@@ -4,6 +4,7 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/cpu/vec256/vec256.h>
+#include <ATen/cpu/vec512/vec512.h>
 #include <ATen/native/ReduceOps.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Reduce.h>
@@ -13,7 +14,96 @@ namespace at { namespace native { namespace {
 
 using namespace vec256;
 
+// sum of n contiguous Half or BFloat16 values, accumulated in float
+template <typename scalar_t>
+static inline float sum_reduced_contiguous(const scalar_t* data, int64_t n) {
+  using Vec = Vec256<float>;
+  Vec acc[4] = { Vec(0), Vec(0), Vec(0), Vec(0) };
+  int64_t i = 0;
+  for (; i <= n - 4 * Vec::size; i += 4 * Vec::size) {
+    for (int j = 0; j < 4; j++) {
+      acc[j] = acc[j] + load_as_float(data + i + j * Vec::size);
+    }
+  }
+  for (; i <= n - Vec::size; i += Vec::size) {
+    acc[0] = acc[0] + load_as_float(data + i);
+  }
+  float buffer[Vec::size];
+  ((acc[0] + acc[1]) + (acc[2] + acc[3])).store(buffer);
+  float sum = 0;
+  for (int j = 0; j < Vec::size; j++) {
+    sum += buffer[j];
+  }
+  for (; i < n; i++) {
+    sum += static_cast<float>(data[i]);
+  }
+  return sum;
+}
+
+// sum of a Half or BFloat16 input into a float output, so that the values are
+// only read as such and the accumulation happens in float
+template <typename scalar_t>
+static void sum_reduced_kernel(TensorIterator& iter) {
+  using Vec = Vec256<float>;
+  iter.output().zero_();
+  auto loop = [](int ntensor, char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    int64_t outer_strides[] = { strides[2], strides[3] };
+    if (strides[0] == 0 && strides[1] == sizeof(scalar_t)) {
+      // input is contiguous in dim 0, output is reduced in dim 0
+      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+        *(float*)data[0] += sum_reduced_contiguous((const scalar_t*)data[1], size0);
+      });
+    } else if (strides[0] == sizeof(float) && strides[1] == sizeof(scalar_t)) {
+      // input and output are contiguous in dim 0
+      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+        float* out = (float*)data[0];
+        const scalar_t* in = (const scalar_t*)data[1];
+        int64_t i = 0;
+        for (; i <= size0 - Vec::size; i += Vec::size) {
+          (Vec::loadu(out + i) + load_as_float(in + i)).store(out + i);
+        }
+        for (; i < size0; i++) {
+          out[i] += static_cast<float>(in[i]);
+        }
+      });
+    } else {
+      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+        for (int64_t i = 0; i < size0; i++) {
+          *(float*)(data[0] + i * strides[0]) +=
+              static_cast<float>(*(const scalar_t*)(data[1] + i * strides[1]));
+        }
+      });
+    }
+  };
+
+  if (iter.num_output_elements() > 1) {
+    iter.parallel_reduce(loop);
+    return;
+  }
+  // The two pass reduction of parallel_reduce would combine the partial sums
+  // with the reduced type loop, so full reductions are split here instead
+  const Tensor& input = iter.tensor(1);
+  if (input.is_contiguous()) {
+    const scalar_t* data = input.data<scalar_t>();
+    *iter.output().data<float>() = at::parallel_reduce(
+        0, input.numel(), internal::GRAIN_SIZE, 0.f,
+        [=](int64_t begin, int64_t end, float ident) {
+          return ident + sum_reduced_contiguous(data + begin, end - begin);
+        },
+        std::plus<float>());
+  } else {
+    iter.serial_for_each(loop, {0, iter.numel()});
+  }
+}
+
 static void sum_kernel_impl(TensorIterator& iter) {
+  if (iter.dtype(1) == kHalf) {
+    sum_reduced_kernel<Half>(iter);
+    return;
+  } else if (iter.dtype(1) == kBFloat16) {
+    sum_reduced_kernel<BFloat16>(iter);
+    return;
+  }
   AT_DISPATCH_ALL_TYPES(iter.type(), "sum", [&] {
     binary_kernel_reduce_vec(
       iter,
@@ -201,10 +291,221 @@ static void norm_kernel_impl(
   });
 }
 
+template<typename scalar_t>
+struct StdVarReduction {
+#if defined(CPU_CAPABILITY_AVX512)
+  using Vec = vec512::Vec512<scalar_t>;
+#else
+  using Vec = Vec256<scalar_t>;
+#endif
+  // reduction width in number of scalar elements: four accumulators
+  static constexpr int WIDTH = 4 * Vec::size;
+  // rows are processed in chunks of this many elements, so that both passes
+  // over a chunk hit the cache
+  static constexpr int64_t CHUNK = 4096;
+
+  // count, mean and sum of squared deviations from the mean of a set of
+  // values; combined with the pairwise formula of Chan et al.
+  struct Moments {
+    int64_t n;
+    double mean;
+    double m2;
+
+    Moments combine(const Moments& other) const {
+      if (n == 0) {
+        return other;
+      }
+      if (other.n == 0) {
+        return *this;
+      }
+      int64_t total = n + other.n;
+      double delta = other.mean - mean;
+      double frac = (double)other.n / total;
+      return {total, mean + delta * frac, m2 + other.m2 + delta * delta * n * frac};
+    }
+  };
+
+  static void apply(
+      Tensor& res,
+      const Tensor& self,
+      c10::optional<int64_t> dim,
+      bool unbiased,
+      bool take_sqrt) {
+    auto out_ = res.data<scalar_t>();
+    auto data_ = self.data<scalar_t>();
+    auto numel = self.numel();
+    if (!dim.has_value()) {
+      Moments m = parallel_reduce(
+        0,
+        numel,
+        internal::GRAIN_SIZE,
+        Moments{0, 0, 0},
+        [=](int64_t begin, int64_t end, Moments init) {
+          return init.combine(row_moments(&data_[begin], end - begin));
+        },
+        [](Moments a, Moments b) { return a.combine(b); });
+      *out_ = finalize(m.n, m.m2, unbiased, take_sqrt);
+      return;
+    }
+    int64_t n = self.size(*dim);
+    int64_t stride = self.stride(*dim);
+    // A contiguous tensor does not need to hold a meaningful stride
+    // if the corresponding size is 1
+    if (n == 1) {
+      stride = 1;
+      for (int64_t i = self.ndimension() - 1; i > *dim; i--) {
+        stride *= self.size(i);
+      }
+    }
+    int64_t batch = numel / n;
+    if (stride == 1) {
+      parallel_for(0, batch, 1, [=](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          Moments m = row_moments(&data_[b * n], n);
+          out_[b] = finalize(m.n, m.m2, unbiased, take_sqrt);
+        }
+      });
+      return;
+    }
+    // The reduced dimension is not the innermost one: reduce Vec::size
+    // adjacent columns at a time.
+    int64_t outer = batch / stride;
+    int64_t groups = divup(stride, Vec::size);
+    parallel_for(0, outer * groups, 1, [=](int64_t begin, int64_t end) {
+      for (int64_t gi = begin; gi < end; gi++) {
+        int64_t b = gi / groups;
+        int64_t i = (gi % groups) * Vec::size;
+        const scalar_t* data = &data_[b * n * stride + i];
+        scalar_t* out = &out_[b * stride + i];
+        if (i + Vec::size <= stride) {
+          column_moments_vec(data, out, n, stride, unbiased, take_sqrt);
+        } else {
+          for (; i < stride; i++, data++, out++) {
+            Moments m = column_moments(data, n, stride);
+            *out = finalize(m.n, m.m2, unbiased, take_sqrt);
+          }
+        }
+      }
+    });
+  }
+
+  static scalar_t finalize(int64_t n, double m2, bool unbiased, bool take_sqrt) {
+    int64_t divisor = unbiased ? n - 1 : n;
+    double result = divisor > 0 ? m2 / divisor : NAN;
+    return take_sqrt ? std::sqrt(result) : result;
+  }
+
+  // Moments of a contiguous row, computed chunk by chunk with two passes:
+  // first the mean, then the squared deviations from it. This is as stable
+  // as Welford's algorithm but vectorizes.
+  static Moments row_moments(const scalar_t* data, int64_t n) {
+    Moments result{0, 0, 0};
+    for (int64_t begin = 0; begin < n; begin += CHUNK) {
+      int64_t len = n - begin < CHUNK ? n - begin : CHUNK;
+      const scalar_t* chunk = data + begin;
+      scalar_t mean = sum(chunk, len) / len;
+      result = result.combine({len, (double)mean, (double)sum_sq_dev(chunk, len, mean)});
+    }
+    return result;
+  }
+
+  static scalar_t sum(const scalar_t* data, int64_t n) {
+    int64_t n_rounded = round_down(n, WIDTH);
+    Vec acc[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int64_t k = 0; k < n_rounded; k += WIDTH) {
+      for (int j = 0; j != 4; j++) {
+        acc[j] = acc[j] + Vec::loadu(&data[k + j * Vec::size]);
+      }
+    }
+    scalar_t result = horizontal_sum(acc);
+    for (int64_t k = n_rounded; k < n; k++) {
+      result += data[k];
+    }
+    return result;
+  }
+
+  static scalar_t sum_sq_dev(const scalar_t* data, int64_t n, scalar_t mean) {
+    int64_t n_rounded = round_down(n, WIDTH);
+    Vec acc[4] = {0.0, 0.0, 0.0, 0.0};
+    Vec vmean(mean);
+    for (int64_t k = 0; k < n_rounded; k += WIDTH) {
+      for (int j = 0; j != 4; j++) {
+        auto delta = Vec::loadu(&data[k + j * Vec::size]) - vmean;
+        acc[j] = acc[j] + delta * delta;
+      }
+    }
+    scalar_t result = horizontal_sum(acc);
+    for (int64_t k = n_rounded; k < n; k++) {
+      scalar_t delta = data[k] - mean;
+      result += delta * delta;
+    }
+    return result;
+  }
+
+  static scalar_t horizontal_sum(const Vec (&acc)[4]) {
+    scalar_t buf[WIDTH];
+    for (int j = 0; j != 4; j++) {
+      acc[j].store(&buf[j * Vec::size]);
+    }
+    scalar_t result = 0;
+    for (int i = 0; i < WIDTH; i++) {
+      result += buf[i];
+    }
+    return result;
+  }
+
+  // Reduces Vec::size adjacent columns of a strided slice at once.
+  static void column_moments_vec(
+      const scalar_t* data, scalar_t* out, int64_t n, int64_t stride,
+      bool unbiased, bool take_sqrt) {
+    Vec acc(0);
+    for (int64_t k = 0; k < n; k++) {
+      acc = acc + Vec::loadu(&data[k * stride]);
+    }
+    Vec mean = acc / Vec((scalar_t)n);
+    Vec m2(0);
+    for (int64_t k = 0; k < n; k++) {
+      auto delta = Vec::loadu(&data[k * stride]) - mean;
+      m2 = m2 + delta * delta;
+    }
+    scalar_t buf[Vec::size];
+    m2.store(buf);
+    for (int i = 0; i < Vec::size; i++) {
+      out[i] = finalize(n, buf[i], unbiased, take_sqrt);
+    }
+  }
+
+  static Moments column_moments(const scalar_t* data, int64_t n, int64_t stride) {
+    scalar_t mean = 0;
+    for (int64_t k = 0; k < n; k++) {
+      mean += data[k * stride];
+    }
+    mean /= n;
+    scalar_t m2 = 0;
+    for (int64_t k = 0; k < n; k++) {
+      scalar_t delta = data[k * stride] - mean;
+      m2 += delta * delta;
+    }
+    return {n, (double)mean, (double)m2};
+  }
+};
+
+static void std_var_kernel_impl(
+    Tensor& result,
+    const Tensor& self,
+    c10::optional<int64_t> dim,
+    bool unbiased,
+    bool take_sqrt) {
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "std_var", [&] {
+    StdVarReduction<scalar_t>::apply(result, self, dim, unbiased, take_sqrt);
+  });
+}
+
 }  // anonymous namespace
 
 REGISTER_DISPATCH(sum_stub, &sum_kernel_impl);
 REGISTER_DISPATCH(prod_stub, &prod_kernel_impl);
 REGISTER_DISPATCH(norm_kernel, &norm_kernel_impl);
+REGISTER_DISPATCH(std_var_kernel, &std_var_kernel_impl);
 
 }}  // namespace at::native
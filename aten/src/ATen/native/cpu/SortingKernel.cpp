@@ -0,0 +1,288 @@
+#include <ATen/native/Sorting.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native { namespace {
+
+// The slices are sorted or selected one per task: each one is copied (sort,
+// kthvalue, large k) or scanned (small k) into a buffer of (value, index)
+// pairs owned by the task.
+template <typename scalar_t>
+using slice_buffer = std::vector<std::pair<scalar_t, int64_t>>;
+
+// topk keeps the k best values seen so far in a heap when k is at most this
+// fraction of the slice, and uses introselect on a copy of the slice otherwise
+constexpr int64_t kTopkHeapRatio = 16;
+
+template <typename scalar_t>
+inline bool _isnan(scalar_t val) {
+  return val != val;
+}
+
+// Orderings in which NaN is larger than every other value
+template <typename scalar_t>
+struct Ascending {
+  bool operator()(scalar_t a, scalar_t b) const {
+    return a < b || (!_isnan(a) && _isnan(b));
+  }
+};
+
+template <typename scalar_t>
+struct Descending {
+  bool operator()(scalar_t a, scalar_t b) const {
+    return a > b || (_isnan(a) && !_isnan(b));
+  }
+};
+
+template <typename comp_t>
+struct ByValue {
+  comp_t comp;
+  template <typename pair_t>
+  bool operator()(const pair_t& a, const pair_t& b) const {
+    return comp(a.first, b.first);
+  }
+};
+
+// Where each slice along dim starts in self and in the outputs
+struct SliceOffsets {
+  SliceOffsets(const Tensor& self, const Tensor& values, const Tensor& indices, int64_t dim) {
+    for (int64_t d = 0; d < self.dim(); d++) {
+      if (d != dim) {
+        sizes.push_back(self.size(d));
+        self_strides.push_back(self.stride(d));
+        values_strides.push_back(values.stride(d));
+        indices_strides.push_back(indices.stride(d));
+      }
+    }
+  }
+
+  int64_t num_slices() const {
+    int64_t n = 1;
+    for (auto size : sizes) {
+      n *= size;
+    }
+    return n;
+  }
+
+  void get(int64_t slice, int64_t& self_offset, int64_t& values_offset, int64_t& indices_offset) const {
+    self_offset = values_offset = indices_offset = 0;
+    for (int64_t d = sizes.size() - 1; d >= 0; d--) {
+      int64_t i = slice % sizes[d];
+      slice /= sizes[d];
+      self_offset += i * self_strides[d];
+      values_offset += i * values_strides[d];
+      indices_offset += i * indices_strides[d];
+    }
+  }
+
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> self_strides;
+  std::vector<int64_t> values_strides;
+  std::vector<int64_t> indices_strides;
+};
+
+// Calls f(in, in_stride, values, values_stride, indices, indices_stride,
+// buffer) on every slice of self along dim, in parallel over the slices.
+template <typename scalar_t, typename func_t>
+void parallel_slices(Tensor& values, Tensor& indices, const Tensor& self, int64_t dim, const func_t& f) {
+  SliceOffsets offsets(self, values, indices, dim);
+  const scalar_t* self_data = self.data<scalar_t>();
+  scalar_t* values_data = values.data<scalar_t>();
+  int64_t* indices_data = indices.data<int64_t>();
+  int64_t self_stride = self.stride(dim);
+  int64_t values_stride = values.stride(dim);
+  int64_t indices_stride = indices.stride(dim);
+  int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, self.size(dim)));
+  parallel_for(0, offsets.num_slices(), grain_size, [&](int64_t begin, int64_t end) {
+    slice_buffer<scalar_t> buffer;
+    for (int64_t slice = begin; slice < end; slice++) {
+      int64_t self_offset, values_offset, indices_offset;
+      offsets.get(slice, self_offset, values_offset, indices_offset);
+      f(self_data + self_offset, self_stride,
+        values_data + values_offset, values_stride,
+        indices_data + indices_offset, indices_stride,
+        buffer);
+    }
+  });
+}
+
+template <typename scalar_t>
+inline void load_slice(const scalar_t* in, int64_t stride, int64_t n, slice_buffer<scalar_t>& buffer) {
+  buffer.resize(n);
+  for (int64_t i = 0; i < n; i++) {
+    buffer[i] = std::make_pair(in[i * stride], i);
+  }
+}
+
+template <typename scalar_t>
+inline void store_slice(const slice_buffer<scalar_t>& buffer, int64_t n,
+                        scalar_t* values, int64_t values_stride,
+                        int64_t* indices, int64_t indices_stride) {
+  for (int64_t i = 0; i < n; i++) {
+    values[i * values_stride] = buffer[i].first;
+    indices[i * indices_stride] = buffer[i].second;
+  }
+}
+
+// Index of the first of in[i], ..., in[n - 1] that may beat the threshold,
+// in the ordering of topk. Only the floating types are compared a vector at
+// a time, as candidates are rare once the heap is full.
+template <typename scalar_t>
+inline int64_t next_candidate(const scalar_t* in, int64_t i, int64_t n, scalar_t threshold, bool largest) {
+  return i;
+}
+
+template <typename scalar_t>
+inline int64_t next_candidate_vec(const scalar_t* in, int64_t i, int64_t n, scalar_t threshold, bool largest) {
+  using Vec = vec256::Vec256<scalar_t>;
+  Vec threshold_vec(threshold);
+  for (; i + Vec::size <= n; i += Vec::size) {
+    Vec v = Vec::loadu(in + i);
+    // the ordered comparison is false for NaN, which is a candidate if largest
+    int candidates = (largest ? v <= threshold_vec : v >= threshold_vec).zero_mask();
+    if (candidates != 0) {
+      int lane = 0;
+      while (!(candidates & (1 << lane))) {
+        lane++;
+      }
+      return i + lane;
+    }
+  }
+  return i;
+}
+
+template <>
+inline int64_t next_candidate(const float* in, int64_t i, int64_t n, float threshold, bool largest) {
+  return next_candidate_vec(in, i, n, threshold, largest);
+}
+
+template <>
+inline int64_t next_candidate(const double* in, int64_t i, int64_t n, double threshold, bool largest) {
+  return next_candidate_vec(in, i, n, threshold, largest);
+}
+
+// The k best values of a slice in a heap whose top is the worst of them, so
+// that most values are rejected with one comparison and the input is read
+// only once.
+template <typename scalar_t, typename comp_t>
+void topk_heap(const scalar_t* in, int64_t stride, int64_t n, int64_t k, bool largest, bool sorted,
+               comp_t better, slice_buffer<scalar_t>& heap) {
+  ByValue<comp_t> heap_comp{better};
+  heap.clear();
+  for (int64_t i = 0; i < k; i++) {
+    heap.emplace_back(in[i * stride], i);
+  }
+  std::make_heap(heap.begin(), heap.end(), heap_comp);
+  for (int64_t i = k; i < n; i++) {
+    if (stride == 1) {
+      i = next_candidate(in, i, n, heap.front().first, largest);
+      if (i == n) {
+        break;
+      }
+    }
+    scalar_t value = in[i * stride];
+    if (better(value, heap.front().first)) {
+      std::pop_heap(heap.begin(), heap.end(), heap_comp);
+      heap.back() = std::make_pair(value, i);
+      std::push_heap(heap.begin(), heap.end(), heap_comp);
+    }
+  }
+  if (sorted) {
+    std::sort_heap(heap.begin(), heap.end(), heap_comp);
+  }
+}
+
+template <typename scalar_t, typename comp_t>
+void topk_slices(Tensor& values, Tensor& indices, const Tensor& self, int64_t k, int64_t dim,
+                 bool largest, bool sorted, comp_t better) {
+  int64_t n = self.size(dim);
+  ByValue<comp_t> comp{better};
+  parallel_slices<scalar_t>(values, indices, self, dim,
+      [&](const scalar_t* in, int64_t in_stride,
+          scalar_t* values, int64_t values_stride,
+          int64_t* indices, int64_t indices_stride,
+          slice_buffer<scalar_t>& buffer) {
+        if (k * kTopkHeapRatio <= n) {
+          topk_heap(in, in_stride, n, k, largest, sorted, better, buffer);
+        } else {
+          load_slice(in, in_stride, n, buffer);
+          if (k < n) {
+            std::nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end(), comp);
+          }
+          if (sorted) {
+            std::sort(buffer.begin(), buffer.begin() + k, comp);
+          }
+        }
+        store_slice(buffer, k, values, values_stride, indices, indices_stride);
+      });
+}
+
+template <typename scalar_t, typename comp_t>
+void sort_slices(Tensor& values, Tensor& indices, const Tensor& self, int64_t dim, comp_t order) {
+  int64_t n = self.size(dim);
+  ByValue<comp_t> comp{order};
+  parallel_slices<scalar_t>(values, indices, self, dim,
+      [&](const scalar_t* in, int64_t in_stride,
+          scalar_t* values, int64_t values_stride,
+          int64_t* indices, int64_t indices_stride,
+          slice_buffer<scalar_t>& buffer) {
+        load_slice(in, in_stride, n, buffer);
+        std::sort(buffer.begin(), buffer.end(), comp);
+        store_slice(buffer, n, values, values_stride, indices, indices_stride);
+      });
+}
+
+static void sort_kernel(Tensor& values, Tensor& indices, const Tensor& self, int64_t dim, bool descending) {
+  AT_DISPATCH_ALL_TYPES(self.type(), "sort", [&] {
+    if (descending) {
+      sort_slices<scalar_t>(values, indices, self, dim, Descending<scalar_t>());
+    } else {
+      sort_slices<scalar_t>(values, indices, self, dim, Ascending<scalar_t>());
+    }
+  });
+}
+
+static void topk_kernel(Tensor& values, Tensor& indices, const Tensor& self,
+                        int64_t k, int64_t dim, bool largest, bool sorted) {
+  if (k == 0) {
+    return;
+  }
+  AT_DISPATCH_ALL_TYPES(self.type(), "topk", [&] {
+    if (largest) {
+      topk_slices<scalar_t>(values, indices, self, k, dim, largest, sorted, Descending<scalar_t>());
+    } else {
+      topk_slices<scalar_t>(values, indices, self, k, dim, largest, sorted, Ascending<scalar_t>());
+    }
+  });
+}
+
+static void kthvalue_kernel(Tensor& values, Tensor& indices, const Tensor& self, int64_t k, int64_t dim) {
+  AT_DISPATCH_ALL_TYPES(self.type(), "kthvalue", [&] {
+    int64_t n = self.size(dim);
+    ByValue<Ascending<scalar_t>> comp{Ascending<scalar_t>()};
+    parallel_slices<scalar_t>(values, indices, self, dim,
+        [&](const scalar_t* in, int64_t in_stride,
+            scalar_t* values, int64_t values_stride,
+            int64_t* indices, int64_t indices_stride,
+            slice_buffer<scalar_t>& buffer) {
+          load_slice(in, in_stride, n, buffer);
+          std::nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end(), comp);
+          *values = buffer[k - 1].first;
+          *indices = buffer[k - 1].second;
+        });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(sort_stub, &sort_kernel);
+REGISTER_DISPATCH(topk_stub, &topk_kernel);
+REGISTER_DISPATCH(kthvalue_stub, &kthvalue_kernel);
+
+}} // namespace at::native
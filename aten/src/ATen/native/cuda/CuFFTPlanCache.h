@@ -5,6 +5,7 @@
 #include "ATen/native/utils/ParamsHash.h"
 
 #include <list>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <stdexcept>
@@ -352,10 +353,13 @@ static_assert(CUFFT_MAX_PLAN_NUM >= 0 && CUFFT_MAX_PLAN_NUM <= std::numeric_limi
               "CUFFT_MAX_PLAN_NUM not in size_t range");
 
 // This cache assumes that the mapping from key to value never changes.
-// This is **NOT** thread-safe. Please use a mutex when using it **AND** the
+// This is **NOT** thread-safe. Please lock its mutex when using it **AND** the
 // value returned from try_emplace_value.
 // The contract of using this cache is that try_emplace_value should only be
 // used when the max_size is positive.
+//
+// Since plans can only be executed on the device they were created on, there
+// is one cache per device, see cufft_get_plan_cache.
 class CuFFTParamsLRUCache {
 public:
   using kv_t = typename std::pair<CuFFTParams, CuFFTConfig>;
@@ -384,17 +388,20 @@ public:
     map_kkv_iter_t map_it = _cache_map.find(key);
     // Hit, put to list front
     if (map_it != _cache_map.end()) {
+      _hits++;
       _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
       return map_it->second->second;
     }
 
     // Miss
+    _misses++;
     // remove if needed
     if (_usage_list.size() >= _max_size) {
       auto last = _usage_list.end();
       last--;
       _cache_map.erase(last->first);
       _usage_list.pop_back();
+      _evictions++;
     }
 
     // construct new plan at list front, then insert into _cache_map
@@ -408,9 +415,13 @@ public:
     return kv_it->second;
   }
 
+  // Also resets the statistics
   void clear() {
     _cache_map.clear();
     _usage_list.clear();
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
   }
 
   void resize(int64_t new_size) {
@@ -423,6 +434,7 @@ public:
         _cache_map.erase(delete_it->first);
       }
       _usage_list.erase(delete_it, _usage_list.end());
+      _evictions += cur_size - _max_size;
     }
   }
 
@@ -430,6 +442,14 @@ public:
 
   size_t max_size() const noexcept { return _max_size; }
 
+  // The number of lookups that found their plan in the cache, that had to
+  // create it, and the number of plans dropped to make room for others.
+  int64_t hits() const { return _hits; }
+  int64_t misses() const { return _misses; }
+  int64_t evictions() const { return _evictions; }
+
+  std::mutex mutex;
+
 private:
   // Only sets size and does value check. Does not resize the data structures.
   void _set_max_size(int64_t new_size) {
@@ -443,6 +463,9 @@ private:
   std::list<kv_t> _usage_list;
   map_t _cache_map;
   size_t _max_size;
+  int64_t _hits = 0;
+  int64_t _misses = 0;
+  int64_t _evictions = 0;
 };
 
 // Since ATen is separated into CPU build and CUDA build, we need a way to call
@@ -450,10 +473,13 @@ private:
 // (at cuda/detail/CUDAHooks.cpp), and call the hooked functions from the actual
 // native function counterparts (at native/SpectralOps.cpp), i.e.,
 // _cufft_get_plan_cache_max_size, _cufft_set_plan_cache_max_size
-// _cufft_get_plan_cache_size, and _cufft_clear_plan_cache.
-int64_t cufft_get_plan_cache_max_size_impl();
-void cufft_set_plan_cache_max_size_impl(int64_t max_size);
-int64_t cufft_get_plan_cache_size_impl();
-void cufft_clear_plan_cache_impl();
+// _cufft_get_plan_cache_size, _cufft_clear_plan_cache and
+// _cufft_get_plan_cache_{hits,misses,evictions}.
+int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index);
+void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size);
+int64_t cufft_get_plan_cache_size_impl(int64_t device_index);
+void cufft_clear_plan_cache_impl(int64_t device_index);
+void cufft_get_plan_cache_stats_impl(int64_t device_index, int64_t* hits,
+                                     int64_t* misses, int64_t* evictions);
 
 }}} // namespace at::native::detail
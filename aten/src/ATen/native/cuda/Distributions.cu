@@ -178,6 +178,22 @@ void bernoulli_scalar_cuda_kernel(
     );
 }
 
+template <typename scalar_t>
+__global__ void multinomial_alias_draw_kernel(
+    int64_t* result, const scalar_t* q, const int64_t* J,
+    int64_t K, int64_t num_samples, std::pair<uint64_t, uint64_t> seeds) {
+  const int64_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  curandStatePhilox4_32_10_t state;
+  curand_init(seeds.first, idx, seeds.second, &state);
+  for (int64_t i = idx; i < num_samples; i += blockDim.x * gridDim.x) {
+    // curand_uniform_double is in (0, 1]
+    int64_t k = static_cast<int64_t>((1 - curand_uniform_double(&state)) * K);
+    k = k < K ? k : K - 1;
+    const double uniform = 1 - curand_uniform_double(&state);
+    result[i] = uniform < static_cast<double>(q[k]) ? k : J[k];
+  }
+}
+
 } // namespace
 
 namespace at { namespace native {
@@ -229,4 +245,33 @@ Tensor& bernoulli_scalar_cuda_(Tensor &self, double p, Generator* gen) {
 }
 
 
+Tensor _multinomial_alias_draw_cuda(const Tensor& q, const Tensor& J, int64_t num_samples, Generator* gen) {
+  AT_CHECK(q.dim() == 1 && J.dim() == 1 && q.numel() == J.numel() && q.numel() > 0,
+           "_multinomial_alias_draw expects the 1-D tables of _multinomial_alias_setup");
+  AT_CHECK(J.type().scalarType() == kLong, "_multinomial_alias_draw expects J to be a LongTensor");
+  AT_CHECK(num_samples >= 0, "_multinomial_alias_draw expects a non-negative number of samples, but got ",
+           num_samples);
+  auto result = at::empty({num_samples}, J.options());
+  if (num_samples == 0) {
+    return result;
+  }
+  auto q_contig = q.contiguous();
+  auto J_contig = J.contiguous();
+  const int64_t block_size = 256;
+  const int64_t blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor / block_size;
+  const int64_t grid_size = std::min(
+      (num_samples + block_size - 1) / block_size,
+      at::cuda::getCurrentDeviceProperties()->multiProcessorCount * blocks_per_sm);
+  // each sample takes two doubles, of two numbers each, from the stream of its thread
+  const int64_t samples_per_thread = (num_samples - 1) / (block_size * grid_size) + 1;
+  auto seeds = next_philox_seed(gen, 4 * samples_per_thread);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(q.type(), "_multinomial_alias_draw_cuda", [&] {
+    multinomial_alias_draw_kernel<scalar_t><<<grid_size, block_size, 0, at::cuda::getCurrentCUDAStream()>>>(
+        result.data<int64_t>(), q_contig.data<scalar_t>(), J_contig.data<int64_t>(),
+        q.numel(), num_samples, seeds);
+  });
+  THCudaCheck(cudaGetLastError());
+  return result;
+}
+
 }} // namespace at::native
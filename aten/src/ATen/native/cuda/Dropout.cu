@@ -3,6 +3,7 @@
 #include "ATen/cuda/CUDAApplyUtils.cuh"
 #include "ATen/cuda/detail/IndexUtils.cuh"
 #include "ATen/cuda/detail/TensorInfo.cuh"
+#include "ATen/native/FusedDropout.h"
 #include "curand_kernel.h"
 
 #include <THC/THCGeneral.h>
@@ -92,6 +93,174 @@ void masked_scale_kernel(at::Tensor& ret, const at::Tensor src, const at::Tensor
        ret_val = (float)mask_val * src_val * scale;
   });
 }
+
+template <typename T>
+__device__ __forceinline__ T fused_activation(T x, FusedActivation activation) {
+  switch (activation) {
+    case FusedActivation::ReLU:
+      return x > T(0) ? x : T(0);
+    case FusedActivation::GELU:
+      return x * T(0.5) * (T(1) + ::erf(x * T(M_SQRT1_2)));
+    default:
+      return x;
+  }
+}
+
+template <typename T>
+__device__ __forceinline__ T fused_activation_derivative(T x, FusedActivation activation) {
+  switch (activation) {
+    case FusedActivation::ReLU:
+      return x > T(0) ? T(1) : T(0);
+    case FusedActivation::GELU:
+      return T(0.5) * (T(1) + ::erf(x * T(M_SQRT1_2))) +
+          x * T(0.5 * M_2_SQRTPI * M_SQRT1_2) * ::exp(T(-0.5) * x * x);
+    default:
+      return T(1);
+  }
+}
+
+// What the fused dropouts with a packed mask compute from an element of the
+// input, given its scale, pinv or 0 depending on the mask
+template <typename scalar_t, typename accscalar_t, typename IndexType>
+struct DropoutAddEpilogue {
+  const scalar_t* residual;
+
+  __device__ __forceinline__ accscalar_t operator()(accscalar_t x, IndexType li, accscalar_t scale) const {
+    return x * scale + static_cast<accscalar_t>(residual[li]);
+  }
+};
+
+template <typename scalar_t, typename accscalar_t, typename IndexType>
+struct BiasActivationDropoutEpilogue {
+  const scalar_t* bias;
+  IndexType bias_size;
+  FusedActivation activation;
+
+  __device__ __forceinline__ accscalar_t operator()(accscalar_t x, IndexType li, accscalar_t scale) const {
+    return fused_activation(x + static_cast<accscalar_t>(bias[li % bias_size]), activation) * scale;
+  }
+};
+
+// Each thread makes a byte of the mask at a time: the 8 elements it covers
+// take the 8 uniforms of two calls of curand_uniform4, and the byte is
+// written once, instead of a byte per element.
+template <typename scalar_t, typename accscalar_t, typename IndexType, typename Epilogue>
+#if __CUDA_ARCH__ >= 350
+__launch_bounds__(256,8)
+#endif
+__global__ void
+fused_dropout_packed_kernel(const scalar_t* __restrict__ a, scalar_t* __restrict__ b, uint8_t* __restrict__ mask,
+                            IndexType totalElements, accscalar_t p, std::pair<uint64_t, uint64_t> seeds,
+                            Epilogue epilogue) {
+  accscalar_t pinv = accscalar_t(1)/p;
+  IndexType idx = blockIdx.x * blockDim.x + threadIdx.x;
+  curandStatePhilox4_32_10_t state;
+  curand_init(seeds.first, idx, seeds.second, &state);
+  IndexType maskBytes = (totalElements + 7) / 8;
+  for (IndexType byte = idx; byte < maskBytes; byte += gridDim.x * blockDim.x) {
+    float4 rand[2];
+    rand[0] = curand_uniform4(&state);
+    rand[1] = curand_uniform4(&state);
+    uint8_t bits = 0;
+#pragma unroll
+    for (int ii = 0; ii < 2 * UNROLL; ii++) {
+      IndexType li = byte * 8 + ii;
+      if (li < totalElements) {
+        bool keep = (&rand[ii / UNROLL].x)[ii % UNROLL] < p;
+        bits |= static_cast<uint8_t>(keep) << ii;
+        b[li] = static_cast<scalar_t>(
+            epilogue(static_cast<accscalar_t>(a[li]), li, keep ? pinv : accscalar_t(0)));
+      }
+    }
+    mask[byte] = bits;
+  }
+}
+
+// The gradient of the fused dropouts with a packed mask: grad * mask * scale,
+// times the derivative of the activation at self + bias
+template <typename scalar_t, typename accscalar_t, typename IndexType>
+__global__ void
+packed_dropout_backward_kernel(const scalar_t* __restrict__ grad, const scalar_t* __restrict__ self,
+                               const scalar_t* __restrict__ bias, IndexType bias_size,
+                               const uint8_t* __restrict__ mask, scalar_t* __restrict__ ret,
+                               IndexType totalElements, accscalar_t scale, FusedActivation activation) {
+  for (IndexType li = blockIdx.x * blockDim.x + threadIdx.x;
+       li < totalElements;
+       li += gridDim.x * blockDim.x) {
+    accscalar_t g = static_cast<accscalar_t>(grad[li]) *
+        (((mask[li >> 3] >> (li & 7)) & 1) ? scale : accscalar_t(0));
+    if (activation != FusedActivation::None) {
+      g *= fused_activation_derivative(
+          static_cast<accscalar_t>(self[li]) + static_cast<accscalar_t>(bias[li % bias_size]), activation);
+    }
+    ret[li] = static_cast<scalar_t>(g);
+  }
+}
+
+template <typename scalar_t, typename accscalar_t, typename IndexType, typename Epilogue>
+void launch_fused_dropout_packed(const Tensor& self, Tensor& ret, Tensor& mask, double p, Generator* gen,
+                                 Epilogue epilogue) {
+  const int64_t nbytes = mask.numel();
+  const int64_t block_size = 256;
+  unsigned int blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor/block_size;
+  dim3 dim_block(block_size);
+  dim3 grid((nbytes + block_size -1)/block_size);
+  grid.x = std::min((unsigned int)at::cuda::getCurrentDeviceProperties()->multiProcessorCount * blocks_per_sm, grid.x);
+  // two curand_uniform4 per byte of the mask
+  int64_t counter_offset = ((nbytes - 1)/(block_size*grid.x)+1)*2*UNROLL;
+  fused_dropout_packed_kernel<scalar_t, accscalar_t, IndexType, Epilogue>
+      <<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(
+          self.data<scalar_t>(), ret.data<scalar_t>(), mask.data<uint8_t>(),
+          static_cast<IndexType>(self.numel()), static_cast<accscalar_t>(p),
+          next_philox_seed(gen, counter_offset), epilogue);
+  THCudaCheck(cudaGetLastError());
+}
+
+template <typename scalar_t, typename IndexType>
+void launch_packed_dropout_backward(const Tensor& grad, const Tensor& self, const Tensor& bias, const Tensor& mask,
+                                    Tensor& ret, double scale, FusedActivation activation) {
+  using accscalar_t = acc_type<scalar_t, true>;
+  const int64_t nelem = grad.numel();
+  const int64_t block_size = 256;
+  unsigned int blocks_per_sm = at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor/block_size;
+  dim3 dim_block(block_size);
+  dim3 grid((nelem + block_size -1)/block_size);
+  grid.x = std::min((unsigned int)at::cuda::getCurrentDeviceProperties()->multiProcessorCount * blocks_per_sm, grid.x);
+  const bool has_bias = activation != FusedActivation::None;
+  packed_dropout_backward_kernel<scalar_t, accscalar_t, IndexType>
+      <<<grid, dim_block, 0, at::cuda::getCurrentCUDAStream()>>>(
+          grad.data<scalar_t>(),
+          has_bias ? self.data<scalar_t>() : nullptr,
+          has_bias ? bias.data<scalar_t>() : nullptr,
+          has_bias ? static_cast<IndexType>(bias.numel()) : IndexType(1),
+          mask.data<uint8_t>(), ret.data<scalar_t>(),
+          static_cast<IndexType>(nelem), static_cast<accscalar_t>(scale), activation);
+  THCudaCheck(cudaGetLastError());
+}
+
+Tensor packed_dropout_backward_cuda(const Tensor& grad, const Tensor& self, const Tensor& bias, const Tensor& mask,
+                                    double scale, FusedActivation activation) {
+  check_packed_mask(grad, mask);
+  auto grad_ = grad.contiguous();
+  auto mask_ = mask.contiguous();
+  Tensor self_, bias_;
+  if (activation != FusedActivation::None) {
+    self_ = self.contiguous();
+    bias_ = bias.contiguous();
+  }
+  Tensor ret = at::empty_like(grad_);
+  if (ret.numel() == 0) {
+    return ret;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(ret.type(), "packed_dropout_backward", [&] {
+    if (cuda::detail::canUse32BitIndexMath(grad_)) {
+      launch_packed_dropout_backward<scalar_t, unsigned int>(grad_, self_, bias_, mask_, ret, scale, activation);
+    } else {
+      launch_packed_dropout_backward<scalar_t, uint64_t>(grad_, self_, bias_, mask_, ret, scale, activation);
+    }
+  });
+  return ret;
+}
 } //anonymous namespace
 
 std::tuple<Tensor,Tensor>
@@ -158,5 +327,69 @@ Tensor masked_scale_cuda(const Tensor& self, const Tensor& mask, double scale){
   return ret;
 }
 
+std::tuple<Tensor,Tensor>
+fused_dropout_add_cuda(const Tensor& self, const Tensor& residual, double p, Generator * gen){
+  check_fused_dropout_args(self, p);
+  AT_CHECK(residual.sizes() == self.sizes() && residual.type() == self.type(),
+           "expected a residual of type ", self.type(), " and sizes ", self.sizes(),
+           " but got ", residual.type(), " of sizes ", residual.sizes());
+  auto self_ = self.contiguous();
+  auto residual_ = residual.contiguous();
+  Tensor ret = at::empty_like(self_);
+  Tensor mask = at::empty({packed_mask_size(self.numel())}, self.options().dtype(kByte));
+  if (self.numel() == 0) {
+    return std::tuple<Tensor,Tensor>(ret, mask);
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "fused_dropout_add", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (cuda::detail::canUse32BitIndexMath(self_)) {
+      DropoutAddEpilogue<scalar_t, accscalar_t, unsigned int> epilogue{residual_.data<scalar_t>()};
+      launch_fused_dropout_packed<scalar_t, accscalar_t, unsigned int>(self_, ret, mask, p, gen, epilogue);
+    } else {
+      DropoutAddEpilogue<scalar_t, accscalar_t, uint64_t> epilogue{residual_.data<scalar_t>()};
+      launch_fused_dropout_packed<scalar_t, accscalar_t, uint64_t>(self_, ret, mask, p, gen, epilogue);
+    }
+  });
+  return std::tuple<Tensor,Tensor>(ret, mask);
+}
+
+std::tuple<Tensor,Tensor>
+fused_bias_activation_dropout_cuda(const Tensor& self, const Tensor& bias, int64_t activation, double p, Generator * gen){
+  check_fused_dropout_args(self, p);
+  check_fused_bias(self, bias);
+  auto act = check_fused_activation(activation);
+  auto self_ = self.contiguous();
+  auto bias_ = bias.contiguous();
+  Tensor ret = at::empty_like(self_);
+  Tensor mask = at::empty({packed_mask_size(self.numel())}, self.options().dtype(kByte));
+  if (self.numel() == 0) {
+    return std::tuple<Tensor,Tensor>(ret, mask);
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "fused_bias_activation_dropout", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (cuda::detail::canUse32BitIndexMath(self_)) {
+      BiasActivationDropoutEpilogue<scalar_t, accscalar_t, unsigned int> epilogue{
+          bias_.data<scalar_t>(), static_cast<unsigned int>(bias_.numel()), act};
+      launch_fused_dropout_packed<scalar_t, accscalar_t, unsigned int>(self_, ret, mask, p, gen, epilogue);
+    } else {
+      BiasActivationDropoutEpilogue<scalar_t, accscalar_t, uint64_t> epilogue{
+          bias_.data<scalar_t>(), static_cast<uint64_t>(bias_.numel()), act};
+      launch_fused_dropout_packed<scalar_t, accscalar_t, uint64_t>(self_, ret, mask, p, gen, epilogue);
+    }
+  });
+  return std::tuple<Tensor,Tensor>(ret, mask);
+}
+
+Tensor fused_bias_activation_dropout_backward_cuda(const Tensor& grad, const Tensor& self, const Tensor& bias,
+                                                   const Tensor& mask, int64_t activation, double p){
+  check_fused_bias(self, bias);
+  AT_CHECK(grad.sizes() == self.sizes(), "expected a gradient of sizes ", self.sizes(), " but got ", grad.sizes());
+  return packed_dropout_backward_cuda(grad, self, bias, mask, 1. / p, check_fused_activation(activation));
+}
+
+Tensor packed_masked_scale_cuda(const Tensor& self, const Tensor& mask, double scale){
+  return packed_dropout_backward_cuda(self, Tensor(), Tensor(), mask, scale, FusedActivation::None);
+}
+
 }
 }
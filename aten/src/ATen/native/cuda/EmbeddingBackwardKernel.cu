@@ -0,0 +1,225 @@
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/cuda/CUDAContext.h"
+
+#include <THC/THCDeviceUtils.cuh>
+#include <THC/THCThrustAllocator.cuh>
+
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/scan.h>
+#include <thrust/unique.h>
+
+// The sorted indices are split into segments of equal indices, one per weight
+// row to update, and the segments into partial segments of at most
+// NROWS_PER_THREAD indices. A thread sums the gradient of one feature over a
+// partial segment, then another sums the partial sums of a segment in order
+// and writes them to its weight row. A row looked up many times, as the
+// frequent ids of a power law distribution are, is thus summed by many
+// threads instead of a single warp walking all its occurrences, and every
+// weight row is written by a single thread, without atomics.
+
+namespace at { namespace native {
+
+namespace {
+
+constexpr int64_t NROWS_PER_THREAD = 10;
+constexpr int kNumThreads = 128;
+
+// The number of partial segments of each segment
+__global__ void krn_partials_per_segment(
+    int64_t* partials_per_segment, const int64_t* segment_offsets,
+    int64_t num_of_segments, int64_t numel) {
+  const int64_t id = blockIdx.x * blockDim.x + threadIdx.x;
+  if (id < num_of_segments) {
+    const int64_t idx_start = segment_offsets[id];
+    const int64_t idx_end = (id == num_of_segments - 1) ? numel : segment_offsets[id + 1];
+    partials_per_segment[id] = THCCeilDiv(idx_end - idx_start, NROWS_PER_THREAD);
+  }
+}
+
+// The index into the sorted indices each partial segment starts at
+__global__ void krn_partial_segment_offset(
+    int64_t* partial_segment_offset, const int64_t* partials_per_segment,
+    const int64_t* partials_per_segment_offset, const int64_t* segment_offsets,
+    int64_t num_of_segments) {
+  const int64_t id = blockIdx.x * blockDim.x + threadIdx.x;
+  if (id < num_of_segments) {
+    int64_t idx = partials_per_segment_offset[id];
+    const int64_t num_partials = partials_per_segment[id];
+    const int64_t segment_offset = segment_offsets[id];
+    for (int64_t i = 0; i < num_partials; i++) {
+      partial_segment_offset[idx++] = segment_offset + i * NROWS_PER_THREAD;
+    }
+  }
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void compute_grad_weight(
+    const int64_t* orig_indices, const scalar_t* grad, const int64_t* count,
+    const int64_t* offset2bag, const int64_t* bag_size,
+    int64_t numel, int64_t stride,
+    const int64_t* partial_segment_offset, int64_t num_of_partial_segments,
+    accscalar_t* grad_weight_per_segment) {
+  const int64_t id = blockIdx.x * blockDim.x + threadIdx.x;
+  if (id >= num_of_partial_segments * stride) {
+    return;
+  }
+  const int64_t partial = id / stride;
+  const int64_t feature = id % stride;
+  const int64_t idx_begin = partial_segment_offset[partial];
+  const int64_t idx_end = (partial == num_of_partial_segments - 1)
+      ? numel : partial_segment_offset[partial + 1];
+
+  accscalar_t weight = 0;
+  for (int64_t idx = idx_begin; idx < idx_end; idx++) {
+    int64_t row = orig_indices[idx];
+    if (offset2bag != nullptr) {
+      row = offset2bag[row];
+    }
+    accscalar_t gradient = static_cast<accscalar_t>(grad[row * stride + feature]);
+    if (bag_size != nullptr) {
+      gradient /= bag_size[row];
+    }
+    weight += gradient;
+  }
+  if (count != nullptr) {
+    // all the indices of a segment have the same count
+    weight /= count[idx_begin];
+  }
+  grad_weight_per_segment[id] = weight;
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void sum_and_scatter(
+    const int64_t* sorted_indices, scalar_t* grad_weight, int64_t stride,
+    const int64_t* segment_offsets, int64_t num_of_segments,
+    const accscalar_t* grad_weight_per_segment,
+    const int64_t* partials_per_segment_offset, int64_t num_of_partial_segments,
+    int64_t padding_idx) {
+  const int64_t id = blockIdx.x * blockDim.x + threadIdx.x;
+  if (id >= num_of_segments * stride) {
+    return;
+  }
+  const int64_t segment = id / stride;
+  const int64_t feature = id % stride;
+  const int64_t target_row = sorted_indices[segment_offsets[segment]];
+  if (target_row == padding_idx) {
+    return;
+  }
+  const int64_t idx_begin = partials_per_segment_offset[segment];
+  const int64_t idx_end = (segment == num_of_segments - 1)
+      ? num_of_partial_segments : partials_per_segment_offset[segment + 1];
+
+  accscalar_t weight = 0;
+  for (int64_t idx = idx_begin; idx < idx_end; idx++) {
+    weight += grad_weight_per_segment[idx * stride + feature];
+  }
+  grad_weight[target_row * stride + feature] = static_cast<scalar_t>(weight);
+}
+
+} // anonymous namespace
+
+Tensor embedding_backward_cuda_kernel(
+    const Tensor& grad,
+    const Tensor& orig_indices,
+    const Tensor& sorted_indices,
+    const Tensor& count,
+    int64_t num_weights,
+    int64_t padding_idx,
+    const Tensor& offset2bag,
+    const Tensor& bag_size) {
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+  auto policy = thrust::cuda::par(allocator).on(stream);
+  using device_ptr = thrust::device_ptr<int64_t>;
+
+  const int64_t numel = sorted_indices.numel();
+  const int64_t stride = grad.size(1);
+  auto grad_weight = at::zeros({num_weights, stride}, grad.options());
+  if (numel == 0 || stride == 0) {
+    return grad_weight;
+  }
+
+  // The segments start where the sorted indices change:
+  // sorted_indices:  2 5 5 5 7 7 8 9 9
+  // segment_offsets: 0 1 4 6 7
+  auto segment_offsets = at::empty({numel}, orig_indices.options());
+  int64_t num_of_segments;
+  {
+    auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
+    auto offsets_data = device_ptr(segment_offsets.data<int64_t>());
+    auto ends = thrust::unique_by_key_copy(
+        policy, sorted_data, sorted_data + numel,
+        thrust::make_counting_iterator<int64_t>(0),
+        thrust::make_discard_iterator(), offsets_data);
+    num_of_segments = ends.second - offsets_data;
+  }
+
+  // With NROWS_PER_THREAD = 2:
+  // partials_per_segment:        1 2 1 1 1
+  // partials_per_segment_offset: 0 1 3 4 5
+  // partial_segment_offset:      0 1 3 4 6 7
+  auto partials_per_segment = at::empty({num_of_segments}, orig_indices.options());
+  krn_partials_per_segment<<<THCCeilDiv(num_of_segments, (int64_t)kNumThreads), kNumThreads, 0, stream>>>(
+      partials_per_segment.data<int64_t>(), segment_offsets.data<int64_t>(),
+      num_of_segments, numel);
+  THCudaCheck(cudaGetLastError());
+
+  auto partials_per_segment_offset = at::empty({num_of_segments}, orig_indices.options());
+  thrust::exclusive_scan(
+      policy,
+      device_ptr(partials_per_segment.data<int64_t>()),
+      device_ptr(partials_per_segment.data<int64_t>() + num_of_segments),
+      device_ptr(partials_per_segment_offset.data<int64_t>()));
+
+  const int64_t num_of_partial_segments =
+      partials_per_segment_offset[num_of_segments - 1].item<int64_t>() +
+      partials_per_segment[num_of_segments - 1].item<int64_t>();
+
+  auto partial_segment_offset = at::empty({num_of_partial_segments}, orig_indices.options());
+  krn_partial_segment_offset<<<THCCeilDiv(num_of_segments, (int64_t)kNumThreads), kNumThreads, 0, stream>>>(
+      partial_segment_offset.data<int64_t>(), partials_per_segment.data<int64_t>(),
+      partials_per_segment_offset.data<int64_t>(), segment_offsets.data<int64_t>(),
+      num_of_segments);
+  THCudaCheck(cudaGetLastError());
+
+  // for half gradients, the partial sums are kept as float
+  auto grad_weight_per_segment = at::empty(
+      {num_of_partial_segments, stride},
+      grad.options().dtype(
+          grad.type().scalarType() == at::kHalf ? at::kFloat : grad.type().scalarType()));
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "embedding_backward", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    compute_grad_weight<scalar_t, accscalar_t>
+        <<<THCCeilDiv(num_of_partial_segments * stride, (int64_t)kNumThreads), kNumThreads, 0, stream>>>(
+        orig_indices.data<int64_t>(),
+        grad.data<scalar_t>(),
+        count.defined() ? count.data<int64_t>() : nullptr,
+        offset2bag.defined() ? offset2bag.data<int64_t>() : nullptr,
+        bag_size.defined() ? bag_size.data<int64_t>() : nullptr,
+        numel, stride,
+        partial_segment_offset.data<int64_t>(), num_of_partial_segments,
+        grad_weight_per_segment.data<accscalar_t>());
+    THCudaCheck(cudaGetLastError());
+
+    sum_and_scatter<scalar_t, accscalar_t>
+        <<<THCCeilDiv(num_of_segments * stride, (int64_t)kNumThreads), kNumThreads, 0, stream>>>(
+        sorted_indices.data<int64_t>(),
+        grad_weight.data<scalar_t>(),
+        stride,
+        segment_offsets.data<int64_t>(), num_of_segments,
+        grad_weight_per_segment.data<accscalar_t>(),
+        partials_per_segment_offset.data<int64_t>(), num_of_partial_segments,
+        padding_idx);
+    THCudaCheck(cudaGetLastError());
+  });
+
+  return grad_weight;
+}
+
+}} // namespace at::native
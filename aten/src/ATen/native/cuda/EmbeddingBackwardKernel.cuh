@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+namespace at { namespace native {
+
+// Computes the gradient of an embedding weight of num_weights rows from the
+// gradient of the rows looked up, given the sorted indices and their original
+// positions. The gradient of each weight row is summed in index order with no
+// atomics, so that the result is deterministic.
+//
+// count, when defined, holds the number of occurrences of each sorted index,
+// by which its gradient is divided (scale_grad_by_freq). offset2bag, when
+// defined, maps the original positions to the rows of grad, and the gradient
+// of a row is then also divided by bag_size when it is defined (mode="mean").
+// The gradient of padding_idx is left zero.
+Tensor embedding_backward_cuda_kernel(
+    const Tensor& grad,
+    const Tensor& orig_indices,
+    const Tensor& sorted_indices,
+    const Tensor& count,
+    int64_t num_weights,
+    int64_t padding_idx = -1,
+    const Tensor& offset2bag = Tensor(),
+    const Tensor& bag_size = Tensor());
+
+}} // namespace at::native
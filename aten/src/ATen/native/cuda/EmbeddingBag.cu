@@ -4,17 +4,16 @@
 #include "ATen/NativeFunctions.h"
 
 #include "ATen/AccumulateType.h"
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
 
 #include <THC/THCDeviceUtils.cuh>
 #include <THC/THCTensorMathReduce.cuh>
 #include <THC/THCTensorSort.cuh>
 #include <THC/THCThrustAllocator.cuh>
-#include <THC/THCAtomics.cuh>
 
 #include <thrust/execution_policy.h>
 #include <thrust/unique.h>
 
-const int WARP_SIZE = 32;
 const int MODE_SUM = 0;
 const int MODE_MEAN = 1;
 const int MODE_MAX = 2;
@@ -101,78 +100,31 @@ __global__ void EmbeddingBag_updateOutputKernel(
 // does not need EmbeddingBag (LookupTable + Sum works fine), but would
 // still be nice to not be slow in that case.
 
-// This kernel assumes that all input tensors are contiguous.
-template <typename scalar_t>
-__global__ void EmbeddingBag_accGradParametersKernel_sum_avg(
-    int64_t *input, int64_t *indices, scalar_t *gradOutput,
-    scalar_t *gradWeight, int64_t *offset2bag, int64_t *count, ptrdiff_t numel,
-    int64_t stride, int mode, const int64_t *bag_size) {
-
-  using accscalar_t = acc_type<scalar_t, true>;
-  int idx = blockIdx.x * 4 + threadIdx.y;
-
-  // Each warp is responsible for an input into the LookupTable.
-  // If the preceding input has the same as this input, then the warp
-  // exits immediately. The warp also processes subsequent inputs with the
-  // same value.  //
-  // Input Warp
-  // 1     <warp 1>
-  // 1     <warp 1> (<warp 2> exits without doing any work)
-  // 5     <warp 3>
-  // 8     <warp 4>
-
-  // Number of values proceessed by each thread (grain size)
-  const int SZ = 4;
-
-  if (idx < numel && (idx == 0 || input[idx] != input[idx - 1])) {
-    do {
-      const int startFeature = threadIdx.x + blockIdx.y * blockDim.x * SZ;
-      const int weightRow = ((int)input[idx]) * stride;
-
-      // Note: only this line changes from LookupTable_accgradParametersKernel
-      const int origRow = ((int)indices[idx]);
-      const int seq_number = offset2bag[origRow];
-      const int gradOutputRow = ((int)seq_number) * stride;
-
-      const accscalar_t scale = count ? (accscalar_t)1.0 / count[idx] : 1.0;
-
-      accscalar_t gradient[SZ];
-      accscalar_t weight[SZ];
-
-#pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int featureDim = startFeature + ii * WARP_SIZE;
-        if (featureDim < stride) {
-          gradient[ii] =
-              static_cast<accscalar_t>(gradOutput[gradOutputRow + featureDim]);
-          if (mode == MODE_MEAN) {
-            gradient[ii] /= bag_size[seq_number];
-          }
-          weight[ii] =
-              static_cast<accscalar_t>(gradWeight[weightRow + featureDim]);
-        }
-      }
+// Sorts the indices into sorted_indices, with their original positions in
+// orig_indices
+void sort_indices(const Tensor &indices, Tensor &sorted_indices,
+                  Tensor &orig_indices) {
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+  auto policy = thrust::cuda::par(allocator).on(stream);
+  using device_ptr = thrust::device_ptr<int64_t>;
+  ptrdiff_t numel = indices.numel();
 
-#pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        weight[ii] += gradient[ii] * scale;
-      }
+  sorted_indices = at::empty_like(indices);
+  orig_indices = at::empty_like(indices);
+  sorted_indices.copy_(indices);
 
-#pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int featureDim = startFeature + ii * WARP_SIZE;
-        if (featureDim < stride) {
-          gradWeight[weightRow + featureDim] =
-              static_cast<scalar_t>(weight[ii]);
-        }
-      }
+  // Fill sortedOrigIndices with sequential indices
+  auto count_iter = thrust::counting_iterator<int64_t>(0);
+  auto orig_data = device_ptr(orig_indices.data<int64_t>());
+  thrust::copy(policy, count_iter, count_iter + numel, orig_data);
 
-      idx++;
-    } while (idx < numel && input[idx] == input[idx - 1]);
-  }
+  // Sort; a stable sort is not required. The default ordering lets Thrust
+  // radix sort the indices
+  auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
+  thrust::sort_by_key(policy, sorted_data, sorted_data + numel, orig_data);
 }
 
-
 Tensor embedding_bag_backward_cuda_sum_avg(
                                    const Tensor &grad,
                                    const Tensor &indices,
@@ -181,43 +133,20 @@ Tensor embedding_bag_backward_cuda_sum_avg(
                                    int64_t num_weights,
                                    bool scale_grad_by_freq, int64_t mode) {
 
-  auto grad_weight = at::zeros({num_weights, grad.size(1)}, grad.options());
-
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
   ptrdiff_t numel = indices.numel();
 
   if (numel == 0) {
     // all empty bags
-    return grad_weight;
+    return at::zeros({num_weights, grad.size(1)}, grad.options());
   }
 
-  int64_t stride = grad_weight.stride(0);
-
-  auto sorted_indices = at::empty_like(indices);
-  auto orig_indices = at::empty_like(indices);
+  Tensor sorted_indices;
+  Tensor orig_indices;
+  sort_indices(indices, sorted_indices, orig_indices);
   using device_ptr = thrust::device_ptr<int64_t>;
 
-  // Sort the inputs into sorted with the corresponding indices; we
-  // don't need a stable or multidimensional sort, so just use Thrust
-  // directly
-  {
-    sorted_indices.copy_(indices);
-
-    auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
-    auto policy = thrust::cuda::par(allocator).on(stream);
-
-    // Fill sortedOrigIndices with sequential indices
-    auto count_iter = thrust::counting_iterator<int64_t>(0);
-    auto orig_data = device_ptr(orig_indices.data<int64_t>());
-    thrust::copy(policy, count_iter, count_iter + numel, orig_data);
-
-    // Sort; a stable sort is not required
-    auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
-    thrust::sort_by_key(policy, sorted_data, sorted_data + numel, orig_data,
-                        ThrustLTOp<int64_t>());
-  }
-
   Tensor count;
   if (scale_grad_by_freq) {
     count = at::empty_like(indices);
@@ -245,74 +174,35 @@ Tensor embedding_bag_backward_cuda_sum_avg(
         thrust::equal_to<int64_t>(), thrust::maximum<int64_t>());
   }
 
-  dim3 grid(THCCeilDiv(numel, (ptrdiff_t)4), THCCeilDiv(stride, (int64_t)128));
-  dim3 block(32, 4);
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      grad.type(), "embedding_bag_backward_cuda_sum_avg_kernel", [&] {
-        EmbeddingBag_accGradParametersKernel_sum_avg<
-            scalar_t><<<grid, block, 0, stream>>>(
-            sorted_indices.data<int64_t>(), orig_indices.data<int64_t>(),
-            grad.data<scalar_t>(), grad_weight.data<scalar_t>(),
-            offset2bag.data<int64_t>(),
-            count.defined() ? count.data<int64_t>() : nullptr, numel, stride,
-            mode, bag_size.data<int64_t>());
-      });
-
-  THCudaCheck(cudaGetLastError());
-  return grad_weight;
-}
-
-template <typename scalar_t>
-__global__ void EmbeddingBag_accGradParametersKernel_max(
-    int64_t *max_indices, scalar_t *gradOutput,
-    scalar_t *gradWeight, int64_t stride, int64_t numBags) {
-
-  using accscalar_t = acc_type<scalar_t, true>;
-
-  int64_t chunksPerBag = THCCeilDiv(stride, (int64_t)blockDim.x);
-  int64_t numChunks = numBags * chunksPerBag;
-  int64_t chunkOffset = blockIdx.x * blockDim.y + threadIdx.y;
-  int64_t chunkStride = gridDim.x * blockDim.y;
-
-  for (int64_t chunk = chunkOffset; chunk < numChunks; chunk += chunkStride) {
-    int64_t featureDim = (chunk % chunksPerBag) * blockDim.x + threadIdx.x;
-    if (featureDim < stride) {
-      int64_t bag = chunk / chunksPerBag;
-
-      int64_t word_idx = max_indices[bag * stride + featureDim];
-      if (word_idx >= 0) {
-        // If bag is empty, we have max_indices[idx] set to -1 in forward.
-        atomicAdd(&(gradWeight[word_idx * stride + featureDim]), gradOutput[bag * stride + featureDim]);
-      }
-    }
-  }
+  return embedding_backward_cuda_kernel(
+      grad, orig_indices, sorted_indices, count, num_weights,
+      /*padding_idx=*/-1, offset2bag,
+      mode == MODE_MEAN ? bag_size : Tensor());
 }
 
+// Each feature of a bag gets the gradient of the same feature of a single
+// word, so this is the backward of an embedding of num_weights * stride rows
+// of a single feature, looked up at word * stride + feature. Empty bags have
+// max_indices of -1 from the forward, which are looked up at -1 and skipped
+// as the padding_idx.
 Tensor embedding_bag_backward_cuda_max(const Tensor &grad,
                                    const Tensor &max_indices,
                                    int64_t num_weights) {
 
-  auto grad_weight = at::zeros({num_weights, grad.size(1)}, grad.options());
-
-  int64_t stride = grad_weight.stride(0);
+  int64_t stride = grad.size(1);
 
-  int64_t numBags = grad.size(0);
+  auto features = at::arange(stride, max_indices.options());
+  auto indices = (max_indices * stride + features)
+      .masked_fill_(max_indices.lt(0), -1);
 
-  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
-
-  dim3 block = dim3(32, 8);
-  int grid = 1024;
-
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      grad.type(), "embedding_bag_backward_cuda_max", [&] {
-        EmbeddingBag_accGradParametersKernel_max<
-            scalar_t><<<grid, block, 0, stream>>>(
-            max_indices.data<int64_t>(), grad.data<scalar_t>(),
-            grad_weight.data<scalar_t>(), stride, numBags);
-      });
+  Tensor sorted_indices;
+  Tensor orig_indices;
+  sort_indices(indices, sorted_indices, orig_indices);
 
-  THCudaCheck(cudaGetLastError());
-  return grad_weight;
+  auto grad_weight = embedding_backward_cuda_kernel(
+      grad.view({-1, 1}), orig_indices, sorted_indices, Tensor(),
+      num_weights * stride, /*padding_idx=*/-1);
+  return grad_weight.view({num_weights, stride});
 }
 }
 
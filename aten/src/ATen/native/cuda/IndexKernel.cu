@@ -0,0 +1,141 @@
+#include <ATen/native/Indexing.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
+#include <ATen/cuda/Array.h>
+#include <ATen/cuda/detail/OffsetCalculator.cuh>
+#include <THC/THCAtomics.cuh>
+
+// NOTE: CUDA 8 does not allow __device__ lambdas (GPU_LAMBDA) to be defined
+// inside other lambdas. CUDA on Windows requires that the enclosing function
+// of a __device__ lambda not have internal linkage.
+
+namespace at { namespace native {
+
+static constexpr int MAX_INDEXED_DIMS = 25;
+
+// Offsets of the output, the input and the indices. The indices share their
+// strides (see AdvancedIndex in Indexing.cpp), so one offset covers them all.
+static OffsetCalculator<3> index_make_offset_calculator(const TensorIterator& iter) {
+  AT_ASSERT(iter.ntensors() >= 3);
+  std::array<const int64_t*, 3> strides;
+  for (int i = 0; i < 3; i++) {
+    strides[i] = iter.strides(i).data();
+  }
+  return OffsetCalculator<3>(iter.ndim(), iter.shape().data(), strides.data());
+}
+
+// Calls f(out, in, offset) for every element of the iterator, where offset is
+// the offset of the indexed element (see cpu/IndexKernel.cpp). Consecutive
+// threads handle consecutive elements of the output, so the accesses of
+// non-indexed dimensions are coalesced.
+template <typename func_t>
+void gpu_index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride, const func_t& f) {
+  int num_indices = index_size.size();
+  AT_ASSERT(num_indices == (int)index_stride.size());
+  AT_ASSERT(num_indices == iter.ntensors() - 2);
+  AT_CHECK(num_indices <= MAX_INDEXED_DIMS,
+           "indexing a CUDA tensor supports up to ", MAX_INDEXED_DIMS,
+           " indexed dimensions, but got ", num_indices);
+
+  if (iter.numel() == 0) {
+    return;
+  }
+
+  if (!iter.can_use_32bit_indexing()) {
+    for (auto& sub_iter : iter.with_32bit_indexing()) {
+      gpu_index_kernel(sub_iter, index_size, index_stride, f);
+    }
+    return;
+  }
+
+  if (num_indices == 0) {
+    // Nothing is indexed: the result is a copy of self
+    auto offset_calc = make_offset_calculator<2>(iter);
+    char* out_ptr = (char*)iter.data_ptr(0);
+    char* in_ptr = (char*)iter.data_ptr(1);
+    launch_kernel<128, 4>(iter.numel(), [=]__device__(int idx) {
+      auto offsets = offset_calc.get(idx);
+      f(out_ptr + offsets[0], in_ptr + offsets[1], 0);
+    });
+    return;
+  }
+
+  auto sizes = cuda::Array<int64_t, MAX_INDEXED_DIMS>(0);
+  auto strides = cuda::Array<int64_t, MAX_INDEXED_DIMS>(0);
+  auto index_ptrs = cuda::Array<char*, MAX_INDEXED_DIMS>(nullptr);
+  for (int i = 0; i < num_indices; i++) {
+    sizes[i] = index_size[i];
+    strides[i] = index_stride[i];
+    index_ptrs[i] = (char*)iter.data_ptr(i + 2);
+  }
+
+  char* out_ptr = (char*)iter.data_ptr(0);
+  char* in_ptr = (char*)iter.data_ptr(1);
+
+  auto offset_calc = index_make_offset_calculator(iter);
+  launch_kernel<128, 4>(iter.numel(), [=]__device__(int idx) {
+    auto offsets = offset_calc.get(idx);
+    char* out_data = out_ptr + offsets[0];
+    char* in_data = in_ptr + offsets[1];
+
+    int64_t offset = 0;
+    #pragma unroll
+    for (int i = 0; i < num_indices; i++) {
+      int64_t index = *(int64_t*)(index_ptrs[i] + offsets[2]);
+      assert(index >= -sizes[i] && index < sizes[i] && "index out of bounds");
+      if (index < 0) {
+        index += sizes[i];
+      }
+      offset += index * strides[i];
+    }
+
+    f(out_data, in_data, offset);
+  });
+}
+
+template <typename scalar_t>
+void index_kernel_impl(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  gpu_index_kernel(iter, index_size, index_stride, []GPU_LAMBDA(char* out_data, char* in_data, int64_t offset) {
+    *(scalar_t*)out_data = *(scalar_t*)(in_data + offset);
+  });
+}
+
+template <typename scalar_t>
+void index_put_kernel_impl(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  gpu_index_kernel(iter, index_size, index_stride, []GPU_LAMBDA(char* out_data, char* in_data, int64_t offset) {
+    *(scalar_t*)(out_data + offset) = *(scalar_t*)in_data;
+  });
+}
+
+template <typename scalar_t>
+void index_put_accumulate_kernel_impl(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  gpu_index_kernel(iter, index_size, index_stride, []GPU_LAMBDA(char* out_data, char* in_data, int64_t offset) {
+    atomicAdd((scalar_t*)(out_data + offset), *(scalar_t*)in_data);
+  });
+}
+
+static void index_kernel(TensorIterator& iter, IntList index_size, IntList index_stride) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(0), "index", [&] {
+    index_kernel_impl<scalar_t>(iter, index_size, index_stride);
+  });
+}
+
+static void index_put_kernel(TensorIterator& iter, IntList index_size, IntList index_stride, bool accumulate) {
+  AT_DISPATCH_ALL_TYPES_AND_HALF(iter.type(0), "index_put", [&] {
+    if (accumulate) {
+      // The order of the atomic additions of duplicate indices is not
+      // deterministic, which makes a difference for floating point types
+      index_put_accumulate_kernel_impl<scalar_t>(iter, index_size, index_stride);
+    } else {
+      index_put_kernel_impl<scalar_t>(iter, index_size, index_stride);
+    }
+  });
+}
+
+REGISTER_DISPATCH(index_stub, &index_kernel);
+REGISTER_DISPATCH(index_put_stub, &index_put_kernel);
+
+}} // namespace at::native
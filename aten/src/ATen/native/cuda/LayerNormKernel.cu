@@ -0,0 +1,252 @@
+#include <ATen/native/LayerNorm.h>
+
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/cuda/Reduce.cuh>
+#include <THC/THCDeviceUtils.cuh>
+
+#include <type_traits>
+
+// The rows of the input are normalized by one block each: the threads of the
+// block compute the Welford statistics of their share of the row, which are
+// combined with warp shuffles and shared memory, then normalize it, so that
+// the input is read from global memory once (the second read mostly hits in
+// cache) and the output written once. Backward computes the two sums of a row
+// it needs the same way, then dX, and the gradients of gamma and beta in a
+// single pass over the columns.
+
+namespace at { namespace native {
+namespace {
+
+constexpr int kCUDANumThreads = 256;
+// upper bound of the number of warps of a block
+constexpr int kMaxWarps = kCUDANumThreads / 32;
+constexpr int kColwiseReduceTileSize = 32;
+constexpr int kColwiseReduceRows = 16;
+
+template <typename acc_t>
+struct SumOps {
+  C10_DEVICE acc_t combine(acc_t a, acc_t b) const {
+    return a + b;
+  }
+
+  C10_DEVICE acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return WARP_SHFL_DOWN(acc, offset);
+  }
+};
+
+// Combines the values of all the threads of the block, with the combine and
+// warp_shfl_down of an ops_t of Reduce.cuh. Every thread gets the result.
+template <typename acc_t, typename ops_t>
+__device__ acc_t block_reduce(acc_t value, const ops_t& ops, acc_t ident, acc_t* shared) {
+  const int lane = threadIdx.x % warpSize;
+  const int warp = threadIdx.x / warpSize;
+  for (int offset = warpSize / 2; offset > 0; offset >>= 1) {
+    value = ops.combine(value, ops.warp_shfl_down(value, offset));
+  }
+  if (lane == 0) {
+    shared[warp] = value;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    value = lane < blockDim.x / warpSize ? shared[lane] : ident;
+    for (int offset = warpSize / 2; offset > 0; offset >>= 1) {
+      value = ops.combine(value, ops.warp_shfl_down(value, offset));
+    }
+    if (lane == 0) {
+      shared[0] = value;
+    }
+  }
+  __syncthreads();
+  value = shared[0];
+  // shared may be reused as soon as this returns
+  __syncthreads();
+  return value;
+}
+
+template <typename scalar_t, typename acc_t>
+__global__ void layer_norm_forward_kernel(
+    int64_t N, acc_t eps,
+    const scalar_t* X, const scalar_t* gamma, const scalar_t* beta,
+    scalar_t* Y, acc_t* mean, acc_t* rstd) {
+  using welford_t = WelfordData<acc_t>;
+  // WelfordData has a constructor, which __shared__ variables can't have
+  __shared__ typename std::aligned_storage<sizeof(welford_t), alignof(welford_t)>::type
+      shared[kMaxWarps];
+  const int64_t i = blockIdx.x;
+  const scalar_t* X_row = X + i * N;
+  scalar_t* Y_row = Y + i * N;
+
+  WelfordOps<scalar_t, acc_t> ops { /*unbiased=*/false, /*take_sqrt=*/false };
+  welford_t stats;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    stats = ops.reduce(stats, X_row[j], j);
+  }
+  stats = block_reduce(stats, ops, welford_t(), reinterpret_cast<welford_t*>(shared));
+
+  const acc_t row_mean = stats.mean;
+  const acc_t row_rstd = acc_t(1) / ::sqrt(stats.m2 / N + eps);
+  if (threadIdx.x == 0) {
+    mean[i] = row_mean;
+    rstd[i] = row_rstd;
+  }
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    acc_t y = (static_cast<acc_t>(X_row[j]) - row_mean) * row_rstd;
+    if (gamma != nullptr) {
+      y *= static_cast<acc_t>(gamma[j]);
+    }
+    if (beta != nullptr) {
+      y += static_cast<acc_t>(beta[j]);
+    }
+    Y_row[j] = static_cast<scalar_t>(y);
+  }
+}
+
+// With a = dY * gamma and X_hat = (X - mean) * rstd,
+// dX = rstd * (a - mean(a) - X_hat * mean(a * X_hat)),
+// which is computed as rstd * a + b * X + c for each row, from the sums of a
+// and of a * (X - mean).
+template <typename scalar_t, typename acc_t>
+__global__ void layer_norm_backward_input_kernel(
+    int64_t N,
+    const scalar_t* dY, const scalar_t* X, const acc_t* mean, const acc_t* rstd,
+    const scalar_t* gamma, scalar_t* dX) {
+  __shared__ acc_t shared[kMaxWarps];
+  const int64_t i = blockIdx.x;
+  const scalar_t* dY_row = dY + i * N;
+  const scalar_t* X_row = X + i * N;
+  scalar_t* dX_row = dX + i * N;
+
+  acc_t ds = 0;
+  acc_t db = 0;
+  const acc_t row_mean = mean[i];
+  const acc_t row_rstd = rstd[i];
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    acc_t a = static_cast<acc_t>(dY_row[j]);
+    if (gamma != nullptr) {
+      a *= static_cast<acc_t>(gamma[j]);
+    }
+    ds += a * (static_cast<acc_t>(X_row[j]) - row_mean);
+    db += a;
+  }
+  SumOps<acc_t> ops;
+  ds = block_reduce(ds, ops, acc_t(0), shared);
+  db = block_reduce(db, ops, acc_t(0), shared);
+
+  const acc_t b = -ds * row_rstd * row_rstd * row_rstd / N;
+  const acc_t c = -b * row_mean - db * row_rstd / N;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    acc_t a = static_cast<acc_t>(dY_row[j]);
+    if (gamma != nullptr) {
+      a *= static_cast<acc_t>(gamma[j]);
+    }
+    dX_row[j] = static_cast<scalar_t>(row_rstd * a + b * static_cast<acc_t>(X_row[j]) + c);
+  }
+}
+
+// dgamma = sum(dY * X_hat) and dbeta = sum(dY) over the rows. Each block sums
+// kColwiseReduceTileSize columns, its rows of threads taking every
+// kColwiseReduceRows-th row of the input, so that the loads are coalesced.
+template <typename scalar_t, typename acc_t>
+__global__ void layer_norm_backward_weight_kernel(
+    int64_t M, int64_t N,
+    const scalar_t* dY, const scalar_t* X, const acc_t* mean, const acc_t* rstd,
+    scalar_t* dgamma, scalar_t* dbeta) {
+  __shared__ acc_t dgamma_shared[kColwiseReduceRows][kColwiseReduceTileSize];
+  __shared__ acc_t dbeta_shared[kColwiseReduceRows][kColwiseReduceTileSize];
+  const int64_t j = blockIdx.x * kColwiseReduceTileSize + threadIdx.x;
+
+  acc_t dg = 0;
+  acc_t db = 0;
+  if (j < N) {
+    for (int64_t i = threadIdx.y; i < M; i += kColwiseReduceRows) {
+      const acc_t dy = static_cast<acc_t>(dY[i * N + j]);
+      dg += dy * (static_cast<acc_t>(X[i * N + j]) - mean[i]) * rstd[i];
+      db += dy;
+    }
+  }
+  dgamma_shared[threadIdx.y][threadIdx.x] = dg;
+  dbeta_shared[threadIdx.y][threadIdx.x] = db;
+  __syncthreads();
+
+  if (threadIdx.y == 0 && j < N) {
+    for (int k = 1; k < kColwiseReduceRows; k++) {
+      dg += dgamma_shared[k][threadIdx.x];
+      db += dbeta_shared[k][threadIdx.x];
+    }
+    if (dgamma != nullptr) {
+      dgamma[j] = static_cast<scalar_t>(dg);
+    }
+    if (dbeta != nullptr) {
+      dbeta[j] = static_cast<scalar_t>(db);
+    }
+  }
+}
+
+template <typename scalar_t>
+void layer_norm_kernel_impl(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta,
+    int64_t M, int64_t N, double eps,
+    Tensor& Y, Tensor& mean, Tensor& rstd) {
+  using acc_t = acc_type<scalar_t, true>;
+  auto stream = at::cuda::getCurrentCUDAStream();
+  layer_norm_forward_kernel<scalar_t, acc_t><<<M, kCUDANumThreads, 0, stream>>>(
+      N, static_cast<acc_t>(eps),
+      X.data<scalar_t>(),
+      gamma.defined() ? gamma.data<scalar_t>() : nullptr,
+      beta.defined() ? beta.data<scalar_t>() : nullptr,
+      Y.data<scalar_t>(), mean.data<acc_t>(), rstd.data<acc_t>());
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+template <typename scalar_t>
+void layer_norm_backward_kernel_impl(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta) {
+  using acc_t = acc_type<scalar_t, true>;
+  auto stream = at::cuda::getCurrentCUDAStream();
+  if (dX.defined()) {
+    layer_norm_backward_input_kernel<scalar_t, acc_t><<<M, kCUDANumThreads, 0, stream>>>(
+        N, dY.data<scalar_t>(), X.data<scalar_t>(), mean.data<acc_t>(), rstd.data<acc_t>(),
+        gamma.defined() ? gamma.data<scalar_t>() : nullptr,
+        dX.data<scalar_t>());
+    AT_CUDA_CHECK(cudaGetLastError());
+  }
+  if (dgamma.defined() || dbeta.defined()) {
+    const int64_t blocks = (N + kColwiseReduceTileSize - 1) / kColwiseReduceTileSize;
+    layer_norm_backward_weight_kernel<scalar_t, acc_t>
+        <<<blocks, dim3(kColwiseReduceTileSize, kColwiseReduceRows), 0, stream>>>(
+        M, N, dY.data<scalar_t>(), X.data<scalar_t>(), mean.data<acc_t>(), rstd.data<acc_t>(),
+        dgamma.defined() ? dgamma.data<scalar_t>() : nullptr,
+        dbeta.defined() ? dbeta.data<scalar_t>() : nullptr);
+    AT_CUDA_CHECK(cudaGetLastError());
+  }
+}
+
+static void layer_norm_kernel_cuda(
+    const Tensor& X, const Tensor& gamma, const Tensor& beta,
+    int64_t M, int64_t N, double eps,
+    Tensor& Y, Tensor& mean, Tensor& rstd) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(X.type(), "layer_norm", [&] {
+    layer_norm_kernel_impl<scalar_t>(X, gamma, beta, M, N, eps, Y, mean, rstd);
+  });
+}
+
+static void layer_norm_backward_kernel_cuda(
+    const Tensor& dY, const Tensor& X, const Tensor& mean, const Tensor& rstd,
+    const Tensor& gamma, int64_t M, int64_t N,
+    Tensor& dX, Tensor& dgamma, Tensor& dbeta) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(X.type(), "layer_norm_backward", [&] {
+    layer_norm_backward_kernel_impl<scalar_t>(
+        dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(layer_norm_stub, &layer_norm_kernel_cuda);
+REGISTER_DISPATCH(layer_norm_backward_stub, &layer_norm_backward_kernel_cuda);
+
+}} // namespace at::native
@@ -6,6 +6,8 @@
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/TensorIterator.h>
 
+#include <cstdint>
+
 
 // Marks a lambda as executable on both the host and device. The __host__
 // attribute is important so that we can access static type information from
@@ -61,6 +63,40 @@ static void launch_kernel(int64_t N, const func_t& f) {
   elementwise_kernel<nt, vt, func_t><<<grid, block, 0, stream>>>(N, f);
 }
 
+// The fast path for contiguous tensors loads and stores vectors of vec_size
+// elements, with 128-bit accesses to the tensor with the widest type when
+// possible. Each thread handles one vector, and the last one the remaining
+// elements if numel isn't a multiple of vec_size.
+template<typename scalar_t, int vec_size>
+struct alignas(sizeof(scalar_t) * vec_size) aligned_vector {
+  scalar_t val[vec_size];
+};
+
+constexpr int vectorized_num_elements(int max_element_size) {
+  return max_element_size >= 16 ? 1 : (16 / max_element_size > 8 ? 8 : 16 / max_element_size);
+}
+
+template<typename scalar_t, int vec_size>
+static bool can_vectorize(const void* data, int64_t stride) {
+  return stride == sizeof(scalar_t) &&
+         reinterpret_cast<uintptr_t>(data) % sizeof(aligned_vector<scalar_t, vec_size>) == 0;
+}
+
+template<typename scalar_t, int vec_size>
+__device__ __forceinline__ aligned_vector<scalar_t, vec_size> load_vector(const scalar_t* data) {
+  return *reinterpret_cast<const aligned_vector<scalar_t, vec_size>*>(data);
+}
+
+template<typename scalar_t, int vec_size>
+__device__ __forceinline__ void store_vector(scalar_t* data, const aligned_vector<scalar_t, vec_size>& vec) {
+  *reinterpret_cast<aligned_vector<scalar_t, vec_size>*>(data) = vec;
+}
+
+template<int vec_size, typename func_t>
+static void launch_vectorized_kernel(int64_t N, const func_t& f) {
+  launch_kernel<512, 1>((N + vec_size - 1) / vec_size, f);
+}
+
 template<typename func_t>
 void gpu_nullary_kernel(TensorIterator& iter, const func_t& f) {
   ASSERT_HOST_DEVICE_LAMBDA(func_t);
@@ -81,7 +117,27 @@ void gpu_nullary_kernel(TensorIterator& iter, const func_t& f) {
   if (numel == 0) {
     return;
   }
-  if (iter.is_trivial_1d()) {
+  constexpr int vec_size = vectorized_num_elements(sizeof(arg0_t));
+  if (iter.is_trivial_1d() &&
+      can_vectorize<arg0_t, vec_size>(out_data, iter.get_inner_strides()[0])) {
+    int n = numel;
+    launch_vectorized_kernel<vec_size>(numel, [=]__device__(int idx) {
+      int base = idx * vec_size;
+      arg0_t* out = (arg0_t*)out_data + base;
+      if (base + vec_size <= n) {
+        aligned_vector<arg0_t, vec_size> result;
+        #pragma unroll
+        for (int i = 0; i < vec_size; i++) {
+          result.val[i] = f();
+        }
+        store_vector<arg0_t, vec_size>(out, result);
+      } else {
+        for (int i = 0; base + i < n; i++) {
+          out[i] = f();
+        }
+      }
+    });
+  } else if (iter.is_trivial_1d()) {
     auto strides = iter.get_inner_strides();
     int stride0 = strides[0];
     launch_kernel<512, 1>(numel, [=]__device__(int idx) {
@@ -115,6 +171,8 @@ void gpu_unary_kernel(TensorIterator& iter, const func_t& f) {
   using traits = unary_function_traits<func_t>;
   using arg0_t = typename traits::result_type;
   using arg1_t = typename traits::arg1_t;
+  constexpr int vec_size = vectorized_num_elements(
+      sizeof(arg0_t) > sizeof(arg1_t) ? sizeof(arg0_t) : sizeof(arg1_t));
 
   int64_t numel = iter.numel();
   if (numel == 0) {
@@ -126,6 +184,28 @@ void gpu_unary_kernel(TensorIterator& iter, const func_t& f) {
     gpu_nullary_kernel(iter, [=]GPU_LAMBDA(void) {
       return f(a);
     });
+  } else if (iter.is_trivial_1d() &&
+             can_vectorize<arg0_t, vec_size>(out_data, iter.get_inner_strides()[0]) &&
+             can_vectorize<arg1_t, vec_size>(in1_data, iter.get_inner_strides()[1])) {
+    int n = numel;
+    launch_vectorized_kernel<vec_size>(numel, [=]__device__(int idx) {
+      int base = idx * vec_size;
+      arg0_t* out = (arg0_t*)out_data + base;
+      const arg1_t* in1 = (const arg1_t*)in1_data + base;
+      if (base + vec_size <= n) {
+        auto a = load_vector<arg1_t, vec_size>(in1);
+        aligned_vector<arg0_t, vec_size> result;
+        #pragma unroll
+        for (int i = 0; i < vec_size; i++) {
+          result.val[i] = f(a.val[i]);
+        }
+        store_vector<arg0_t, vec_size>(out, result);
+      } else {
+        for (int i = 0; base + i < n; i++) {
+          out[i] = f(in1[i]);
+        }
+      }
+    });
   } else if (iter.is_trivial_1d()) {
     auto strides = iter.get_inner_strides();
     int stride0 = strides[0];
@@ -165,6 +245,10 @@ void gpu_binary_kernel(TensorIterator& iter, const func_t& f) {
   using arg0_t = typename traits::result_type;
   using arg1_t = typename traits::arg1_t;
   using arg2_t = typename traits::arg2_t;
+  constexpr int max_element_size = sizeof(arg0_t) > sizeof(arg1_t)
+      ? (sizeof(arg0_t) > sizeof(arg2_t) ? sizeof(arg0_t) : sizeof(arg2_t))
+      : (sizeof(arg1_t) > sizeof(arg2_t) ? sizeof(arg1_t) : sizeof(arg2_t));
+  constexpr int vec_size = vectorized_num_elements(max_element_size);
 
   int numel = iter.numel();
   if (numel == 0) {
@@ -182,6 +266,30 @@ void gpu_binary_kernel(TensorIterator& iter, const func_t& f) {
     gpu_unary_kernel(iter, [=]GPU_LAMBDA(arg1_t a) {
       return f(a, b);
     });
+  } else if (iter.is_trivial_1d() &&
+             can_vectorize<arg0_t, vec_size>(out_data, iter.get_inner_strides()[0]) &&
+             can_vectorize<arg1_t, vec_size>(in1_data, iter.get_inner_strides()[1]) &&
+             can_vectorize<arg2_t, vec_size>(in2_data, iter.get_inner_strides()[2])) {
+    launch_vectorized_kernel<vec_size>(numel, [=]__device__(int idx) {
+      int base = idx * vec_size;
+      arg0_t* out = (arg0_t*)out_data + base;
+      const arg1_t* in1 = (const arg1_t*)in1_data + base;
+      const arg2_t* in2 = (const arg2_t*)in2_data + base;
+      if (base + vec_size <= numel) {
+        auto a = load_vector<arg1_t, vec_size>(in1);
+        auto b = load_vector<arg2_t, vec_size>(in2);
+        aligned_vector<arg0_t, vec_size> result;
+        #pragma unroll
+        for (int i = 0; i < vec_size; i++) {
+          result.val[i] = f(a.val[i], b.val[i]);
+        }
+        store_vector<arg0_t, vec_size>(out, result);
+      } else {
+        for (int i = 0; base + i < numel; i++) {
+          out[i] = f(in1[i], in2[i]);
+        }
+      }
+    });
   } else if (iter.is_trivial_1d()) {
     auto strides = iter.get_inner_strides();
     int stride0 = strides[0];
@@ -9,7 +9,11 @@
 #include <THC/THCGeneral.hpp>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cuda/Loops.cuh>
+#include <thrust/pair.h>
+#include <cmath>
 #include <iosfwd>
+#include <type_traits>
+#include <utility>
 
 namespace at { namespace native {
 
@@ -146,21 +150,23 @@ __global__ void reduce_kernel(R reduction) {
   reduction.run();
 }
 
-static OffsetCalculator<2> make_output_calculator(const TensorIterator& iter) {
+template <int num_outputs>
+static OffsetCalculator<num_outputs + 1> make_output_calculator(const TensorIterator& iter) {
   int num_reduce_dims = iter.num_reduce_dims();
   int num_output_dims = iter.ndim() - num_reduce_dims;
-  std::array<const int64_t*, 2> strides = {
-    iter.strides(0).data() + num_reduce_dims,
-    iter.strides(1).data() + num_reduce_dims,
-  };
+  std::array<const int64_t*, num_outputs + 1> strides;
+  for (int i = 0; i <= num_outputs; i++) {
+    strides[i] = iter.strides(i).data() + num_reduce_dims;
+  }
   auto shape = iter.shape().data() + num_reduce_dims;
-  return OffsetCalculator<2>(num_output_dims, shape, strides.data());
+  return OffsetCalculator<num_outputs + 1>(num_output_dims, shape, strides.data());
 }
 
+template <int num_outputs>
 static OffsetCalculator<1> make_input_calculator(const TensorIterator& iter) {
   int num_reduce_dims = iter.num_reduce_dims();
   std::array<const int64_t*, 1> strides = {
-    iter.strides(1).data(),
+    iter.strides(num_outputs).data(),
   };
   return OffsetCalculator<1>(num_reduce_dims, iter.shape().data(), strides.data());
 }
@@ -197,30 +203,152 @@ __device__ Array<type_t, vt> load_memory(const type_t* in, int begin, int end, i
   return load_memory<vt>(in, begin, end, stride, [](int idx) { return idx; });
 }
 
+// A reduction is described by an ops_t with the following members, where
+// arg_t is the type of the accumulator and out_t the type of the result:
+//
+//   arg_t reduce(arg_t acc, scalar_t value, int idx)
+//     accumulates the input value, at position idx along the reduced
+//     dimensions, into acc
+//   arg_t combine(arg_t a, arg_t b)
+//     merges the accumulators of two disjoint sets of inputs
+//   out_t project(arg_t acc)
+//     computes the result from the accumulator of all the inputs
+//   arg_t warp_shfl_down(arg_t acc, int offset)
+//     WARP_SHFL_DOWN of each field of acc
+//
+// The accumulator can be any trivially copyable struct, e.g. to compute several
+// statistics in a single pass over the input, like the mean and variance in
+// WelfordOps. If out_t is a thrust::pair, the reduction writes its first and
+// second values to the first and second outputs of the TensorIterator.
+//
+// gpu_reduce_ops_kernel runs the reduction of an ops_t, gpu_reduce_kernel the
+// reduction of a binary function whose accumulator is the result, like sum.
+template <typename scalar_t, typename func_t>
+struct func_wrapper_t {
+  using arg_t = typename binary_function_traits<func_t>::arg2_t;
+  func_t op;
+
+  func_wrapper_t(const func_t& op) : op(op) {}
+
+  C10_DEVICE arg_t reduce(arg_t acc, arg_t value, int /*idx*/) const {
+    return op(acc, value);
+  }
+
+  C10_DEVICE arg_t combine(arg_t a, arg_t b) const {
+    return op(a, b);
+  }
+
+  C10_DEVICE scalar_t project(arg_t acc) const {
+    return (scalar_t)acc;
+  }
+
+  C10_DEVICE arg_t warp_shfl_down(arg_t acc, int offset) const {
+    return WARP_SHFL_DOWN(acc, offset);
+  }
+};
+
 template <typename scalar_t, typename func_t>
+func_wrapper_t<scalar_t, func_t> func_wrapper(const func_t& op) {
+  return func_wrapper_t<scalar_t, func_t>(op);
+}
+
+// Running mean and sum of squared differences from the mean of n values
+template <typename acc_t>
+struct WelfordData {
+  acc_t mean;
+  acc_t m2;
+  int64_t n;
+
+  C10_HOST_DEVICE WelfordData() : mean(0), m2(0), n(0) {}
+  C10_HOST_DEVICE WelfordData(acc_t mean, acc_t m2, int64_t n) : mean(mean), m2(m2), n(n) {}
+};
+
+// Variance, or standard deviation if take_sqrt, computed in a single pass with
+// Welford's algorithm, which unlike the sum of squares doesn't lose precision
+// when the mean is large compared to the deviations.
+template <typename scalar_t, typename acc_t>
+struct WelfordOps {
+  bool unbiased;
+  bool take_sqrt;
+
+  C10_DEVICE WelfordData<acc_t> reduce(WelfordData<acc_t> acc, scalar_t value, int /*idx*/) const {
+    acc_t delta = (acc_t)value - acc.mean;
+    acc_t new_mean = acc.mean + delta / (acc.n + 1);
+    return WelfordData<acc_t>(new_mean, acc.m2 + delta * ((acc_t)value - new_mean), acc.n + 1);
+  }
+
+  C10_DEVICE WelfordData<acc_t> combine(WelfordData<acc_t> a, WelfordData<acc_t> b) const {
+    if (a.n == 0) {
+      return b;
+    }
+    if (b.n == 0) {
+      return a;
+    }
+    acc_t delta = b.mean - a.mean;
+    int64_t new_n = a.n + b.n;
+    acc_t nb_over_n = (acc_t)b.n / new_n;
+    return WelfordData<acc_t>(
+      a.mean + delta * nb_over_n,
+      a.m2 + b.m2 + delta * delta * a.n * nb_over_n,
+      new_n);
+  }
+
+  C10_DEVICE scalar_t project(WelfordData<acc_t> acc) const {
+    int64_t divisor = unbiased ? acc.n - 1 : acc.n;
+    acc_t var = divisor > 0 ? acc.m2 / divisor : NAN;
+    return (scalar_t)(take_sqrt ? ::sqrt(var) : var);
+  }
+
+  C10_DEVICE WelfordData<acc_t> warp_shfl_down(WelfordData<acc_t> acc, int offset) const {
+    return WelfordData<acc_t>(
+      WARP_SHFL_DOWN(acc.mean, offset),
+      WARP_SHFL_DOWN(acc.m2, offset),
+      WARP_SHFL_DOWN(acc.n, offset));
+  }
+};
+
+template <typename out_t>
+struct reduce_outputs {
+  static constexpr int num = 1;
+  using scalar_t = out_t;
+};
+
+template <typename T1, typename T2>
+struct reduce_outputs<thrust::pair<T1, T2>> {
+  static constexpr int num = 2;
+  using scalar_t = T1;
+  static_assert(std::is_same<T1, T2>::value, "the outputs of a reduction must have the same type");
+};
+
+template <typename scalar_t, typename ops_t, typename arg_t>
 struct ReduceOp {
-  using traits = binary_function_traits<func_t>;
-  using arg_t = typename traits::arg2_t;
+  using out_t = decltype(std::declval<ops_t>().project(std::declval<arg_t>()));
+  using out_scalar_t = typename reduce_outputs<out_t>::scalar_t;
+  static constexpr int num_outputs = reduce_outputs<out_t>::num;
+  // Partial results can only be accumulated in the output, when the iterator
+  // is split to use 32-bit indexing, if the result is the accumulator itself
+  static constexpr bool can_accumulate_in_output =
+    num_outputs == 1 && std::is_convertible<out_t, arg_t>::value;
 
   using InputCalculator = OffsetCalculator<1>;
-  using OutputCalculator = OffsetCalculator<2>;
+  using OutputCalculator = OffsetCalculator<num_outputs + 1>;
 
   static constexpr int vt0 = 4;
 
-  func_t op;
+  ops_t ops;
   arg_t ident;
   ReduceConfig config;
   InputCalculator input_calc;
   OutputCalculator output_calc;
   const void* src;
-  void* dst;
+  Array<void*, num_outputs> dst;
   void* buffer;
   int* semaphores;
   bool accumulate;
 
-  ReduceOp(func_t op, ReduceConfig config, InputCalculator input_calc, OutputCalculator output_calc,
-           const void* src, void* dst, void* buffer, int* semaphores)
-    : op(op)
+  ReduceOp(ops_t ops, ReduceConfig config, InputCalculator input_calc, OutputCalculator output_calc,
+           const void* src, Array<void*, num_outputs> dst, void* buffer, int* semaphores)
+    : ops(ops)
     , config(config)
     , input_calc(input_calc)
     , output_calc(output_calc)
@@ -237,7 +365,7 @@ struct ReduceOp {
 
     arg_t value = ident;
     if (output_idx < config.num_outputs && input_idx < config.num_inputs) {
-      auto input_slice = (const char*)src + base_offsets[1];
+      auto input_slice = (const char*)src + base_offsets[num_outputs];
       value = thread_reduce((const scalar_t*)input_slice);
     }
     bool should_block_reduce = config.should_block_reduce();
@@ -248,14 +376,10 @@ struct ReduceOp {
       value = warp_reduce(value);
     }
 
-    auto out = (scalar_t*)((char*)dst + base_offsets[0]);
     if (config.should_global_reduce()) {
-      value = global_reduce(value, out);
+      global_reduce(value, base_offsets);
     } else if (config.should_store(output_idx)) {
-      if (accumulate) {
-        value = op(*out, value);
-      }
-      *out = value;
+      set_results(value, base_offsets);
     }
   }
 
@@ -273,23 +397,14 @@ struct ReduceOp {
     }
   }
 
-  C10_DEVICE arg_t thread_reduce_once(const scalar_t* data, int offset) const {
-    auto values = load_inputs(data, offset);
-
-    arg_t value;
-    strided_iterate<vt0>([&](int i, int idx) {
-      value = i == 0 ? (arg_t)values[0] : op(value, values[i]);
-    }, offset, config.num_inputs, config.step_input);
-
-    return value;
-  }
-
   C10_DEVICE arg_t thread_reduce(const scalar_t* data) const {
     arg_t value = ident;
     int idx = config.input_idx();
     while (idx < config.num_inputs) {
-      arg_t next = thread_reduce_once(data, idx);
-      value = op(value, next);
+      auto values = load_inputs(data, idx);
+      strided_iterate<vt0>([&](int i, int input_idx) {
+        value = ops.reduce(value, values[i], input_idx);
+      }, idx, config.num_inputs, config.step_input);
       idx += config.step_input * vt0;
     }
     return value;
@@ -297,8 +412,8 @@ struct ReduceOp {
 
   C10_DEVICE arg_t warp_reduce(arg_t value) const {
     for (int offset = 1; offset < warpSize; offset <<= 1) {
-      arg_t other = WARP_SHFL_DOWN(value, offset);
-      value = op(value, other);
+      arg_t other = ops.warp_shfl_down(value, offset);
+      value = ops.combine(value, other);
     }
     return value;
   }
@@ -312,13 +427,37 @@ struct ReduceOp {
       __syncthreads();
       if (threadIdx.y < offset && threadIdx.y + offset < num_warps) {
         arg_t other = shared[config.shared_memory_offset(offset)];
-        value = op(value, other);
+        value = ops.combine(value, other);
         shared[config.shared_memory_offset(0)] = value;
       }
     }
     return value;
   }
 
+  template <bool can_accumulate = can_accumulate_in_output>
+  C10_DEVICE typename std::enable_if<can_accumulate>::type
+  set_results(arg_t value, typename OutputCalculator::offset_type offsets) const {
+    auto out = (out_scalar_t*)((char*)dst[0] + offsets[0]);
+    if (accumulate) {
+      value = ops.combine((arg_t)*out, value);
+    }
+    *out = ops.project(value);
+  }
+
+  template <bool can_accumulate = can_accumulate_in_output>
+  C10_DEVICE typename std::enable_if<!can_accumulate && num_outputs == 1>::type
+  set_results(arg_t value, typename OutputCalculator::offset_type offsets) const {
+    *(out_scalar_t*)((char*)dst[0] + offsets[0]) = ops.project(value);
+  }
+
+  template <bool can_accumulate = can_accumulate_in_output>
+  C10_DEVICE typename std::enable_if<!can_accumulate && num_outputs == 2>::type
+  set_results(arg_t value, typename OutputCalculator::offset_type offsets) const {
+    auto result = ops.project(value);
+    *(out_scalar_t*)((char*)dst[0] + offsets[0]) = result.first;
+    *(out_scalar_t*)((char*)dst[1] + offsets[1]) = result.second;
+  }
+
   C10_DEVICE bool mark_block_finished() const {
     extern __shared__ int is_last_block_done_shared[];
 
@@ -335,7 +474,7 @@ struct ReduceOp {
     return is_last_block_done;
   }
 
-  C10_DEVICE arg_t global_reduce(arg_t value, scalar_t* out) const {
+  C10_DEVICE void global_reduce(arg_t value, typename OutputCalculator::offset_type offsets) const {
     arg_t* reduce_buffer = (arg_t*)buffer;
 
     bool should_store = config.should_store(config.output_idx());
@@ -349,14 +488,14 @@ struct ReduceOp {
     bool is_last_block_done = mark_block_finished();
 
     if (is_last_block_done) {
-      value = 0;
+      value = ident;
       if (config.should_warp_reduce()) {
         int input_offset = threadIdx.x + threadIdx.y * blockDim.x;
         int step = blockDim.x * blockDim.y;
         for (; input_offset < config.ctas_per_output; input_offset += step) {
           int idx = config.staging_memory_offset(input_offset);
           arg_t next = reduce_buffer[idx];
-          value = op(value, next);
+          value = ops.combine(value, next);
         }
       } else {
         int input_offset = threadIdx.y;
@@ -364,7 +503,7 @@ struct ReduceOp {
         for (; input_offset < config.ctas_per_output; input_offset += step) {
           int idx = config.staging_memory_offset(input_offset);
           arg_t next = reduce_buffer[idx];
-          value = op(value, next);
+          value = ops.combine(value, next);
         }
       }
       value = block_reduce(value);
@@ -372,14 +511,9 @@ struct ReduceOp {
         value = warp_reduce(value);
       }
       if (should_store) {
-        if (accumulate) {
-          value = op(*out, value);
-        }
-        *out = value;
+        set_results(value, offsets);
       }
     }
-
-    return value;
   }
 };
 
@@ -393,35 +527,38 @@ static void launch_reduce_kernel(const ReduceConfig& config, const R& reduction)
   AT_CUDA_CHECK(cudaGetLastError());
 }
 
-template <typename scalar_t, typename func_t, typename ident_t=double>
-inline void gpu_reduce_kernel(TensorIterator& iter, const func_t& op, ident_t ident=0) {
-  ASSERT_HOST_DEVICE_LAMBDA(func_t);
-  AT_ASSERT(iter.numel() > 0 && iter.ntensors() == 2);
+template <typename scalar_t, typename arg_t, typename ops_t>
+inline void gpu_reduce_kernel_impl(TensorIterator& iter, const ops_t& ops, arg_t ident) {
+  using R = ReduceOp<scalar_t, ops_t, arg_t>;
+  constexpr int num_outputs = R::num_outputs;
+  AT_ASSERT(iter.numel() > 0 && iter.ntensors() == num_outputs + 1);
 
   if (!iter.can_use_32bit_indexing()) {
     for (auto& sub_iter : iter.with_32bit_indexing()) {
-      gpu_reduce_kernel<scalar_t>(sub_iter, op);
+      AT_CHECK(R::can_accumulate_in_output || !sub_iter.should_accumulate(),
+               "this reduction can't be split along the reduced dimensions to use 32-bit indexing");
+      gpu_reduce_kernel_impl<scalar_t>(sub_iter, ops, ident);
     }
     return;
   }
 
-  char* out_data = (char*)iter.data_ptr(0);
-  const char* in_data = (char*)iter.data_ptr(1);
-
-  using traits = binary_function_traits<func_t>;
-  using arg_t = typename traits::arg2_t;
+  Array<void*, num_outputs> out_data;
+  for (int i = 0; i < num_outputs; i++) {
+    out_data[i] = iter.data_ptr(i);
+  }
+  const char* in_data = (char*)iter.data_ptr(num_outputs);
 
   int warp_size = at::cuda::warp_size();
   int warps_per_cta = ReduceConfig::NUM_THREADS / warp_size;
 
   // Start by assuming that each thread handles a single output and all
   // the inputs for that output.
-  int64_t num_outputs = iter.num_output_elements();
-  int64_t inputs_per_output = iter.numel() / num_outputs;
+  int64_t num_outputs_elements = iter.num_output_elements();
+  int64_t inputs_per_output = iter.numel() / num_outputs_elements;
 
-  auto config = ReduceConfig(sizeof(arg_t), num_outputs, inputs_per_output);
+  auto config = ReduceConfig(sizeof(arg_t), num_outputs_elements, inputs_per_output);
 
-  if (iter.ndim() == 0 || iter.strides(/*arg=*/1)[0] == sizeof(scalar_t)) {
+  if (iter.ndim() == 0 || iter.strides(/*arg=*/num_outputs)[0] == sizeof(scalar_t)) {
     // Split the input across lanes if the input is contiguous in the reduced
     // dimension. This will require reduction between threads using warp
     // shuffle instructions.
@@ -441,7 +578,7 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const func_t& op, ident_t id
     config.output_mult[1] = config.split_output(warps_per_cta);
   }
 
-  if (config.values_per_thread() >= 256 && num_outputs <= 4096) {
+  if (config.values_per_thread() >= 256 && num_outputs_elements <= 4096) {
     // Divide the input across thread-blocks if the amount of work per-thread
     // is large enough and the size of the output is small enough. This will
     // require a reduction using global memory.
@@ -452,8 +589,8 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const func_t& op, ident_t id
     config.input_mult[2] = config.split_input(config.ctas_per_output);
   }
 
-  auto output_calc = make_output_calculator(iter);
-  auto input_calc = make_input_calculator(iter);
+  auto output_calc = make_output_calculator<num_outputs>(iter);
+  auto input_calc = make_input_calculator<num_outputs>(iter);
 
   at::DataPtr buffer;
   at::DataPtr semaphores;
@@ -465,8 +602,8 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const func_t& op, ident_t id
     auto stream = at::cuda::getCurrentCUDAStream();
     AT_CUDA_CHECK(cudaMemsetAsync(semaphores.get(), 0, config.semaphore_size(), stream));
   }
-  auto reduce = ReduceOp<scalar_t, func_t>(
-      op,
+  auto reduce = R(
+      ops,
       config,
       input_calc,
       output_calc,
@@ -480,4 +617,18 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const func_t& op, ident_t id
   launch_reduce_kernel<ReduceConfig::NUM_THREADS>(config, reduce);
 }
 
+// Reduction with a binary function, e.g. sum, whose result is its accumulator
+template <typename scalar_t, typename func_t, typename ident_t=double>
+inline void gpu_reduce_kernel(TensorIterator& iter, const func_t& op, ident_t ident=0) {
+  ASSERT_HOST_DEVICE_LAMBDA(func_t);
+  using arg_t = typename binary_function_traits<func_t>::arg2_t;
+  gpu_reduce_kernel_impl<scalar_t>(iter, func_wrapper<scalar_t>(op), (arg_t)ident);
+}
+
+// Reduction described by an ops_t, see ReduceOp
+template <typename scalar_t, typename ops_t, typename arg_t>
+inline void gpu_reduce_ops_kernel(TensorIterator& iter, const ops_t& ops, arg_t ident) {
+  gpu_reduce_kernel_impl<scalar_t>(iter, ops, ident);
+}
+
 }} // namespace at::native
@@ -38,6 +38,33 @@ void prod_kernel_impl(TensorIterator& iter) {
   }, 1);
 }
 
+template <typename scalar_t>
+void std_var_kernel_impl(TensorIterator& iter, bool unbiased, bool take_sqrt) {
+  using acc_t = acc_type<scalar_t, true>;
+  gpu_reduce_ops_kernel<scalar_t>(iter, WelfordOps<scalar_t, acc_t> { unbiased, take_sqrt }, WelfordData<acc_t>());
+}
+
+static void std_var_kernel_cuda(Tensor& result, const Tensor& self, optional<int64_t> dim, bool unbiased, bool take_sqrt) {
+  // result is already the size of the reduction with keepdim
+  auto viewed_result = dim.has_value() ? result : result.view(std::vector<int64_t>(self.dim(), 1));
+  auto iter = TensorIterator::reduce_op(viewed_result, self);
+  if (!iter->can_use_32bit_indexing()) {
+    // The Welford accumulators of the splits of a reduction can't be combined
+    // in the output
+    if (dim.has_value() && take_sqrt) {
+      at::_th_std_out(result, self, dim.value(), unbiased, /*keepdim=*/true);
+    } else if (dim.has_value()) {
+      at::_th_var_out(result, self, dim.value(), unbiased, /*keepdim=*/true);
+    } else {
+      result.copy_(take_sqrt ? at::_th_std(self, unbiased) : at::_th_var(self, unbiased));
+    }
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter->type(), "std_var", [&]() {
+    std_var_kernel_impl<scalar_t>(*iter, unbiased, take_sqrt);
+  });
+}
+
 static void sum_kernel_cuda(TensorIterator& iter) {
   if (iter.type().scalarType() == kHalf) {
     return sum_kernel_impl<at::Half, float>(iter);
@@ -58,5 +85,6 @@ static void prod_kernel_cuda(TensorIterator& iter) {
 
 REGISTER_DISPATCH(sum_stub, &sum_kernel_cuda);
 REGISTER_DISPATCH(prod_stub, &prod_kernel_cuda);
+REGISTER_DISPATCH(std_var_kernel, &std_var_kernel_cuda);
 
 }} // namespace at::native
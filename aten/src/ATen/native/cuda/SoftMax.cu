@@ -9,6 +9,9 @@
 
 #include "ATen/AccumulateType.h"
 #include "ATen/cuda/NumericLimits.cuh"
+#include "ATen/cuda/detail/OffsetCalculator.cuh"
+#include "ATen/ExpandUtils.h"
+#include <limits>
 #include <type_traits>
 
 namespace at {
@@ -403,9 +406,9 @@ cunn_SoftMaxForward(outscalar_t *output, scalar_t *input, int classes)
 
   // find the max
   accscalar_t threadMax = ilpReduce<MaxFloat, ILP, scalar_t, accscalar_t>(
-      input, classes, MaxFloat<scalar_t, accscalar_t>(), -at::numeric_limits<accscalar_t>::max());
+      input, classes, MaxFloat<scalar_t, accscalar_t>(), at::numeric_limits<accscalar_t>::lowest());
   accscalar_t max_k = blockReduce<Max, accscalar_t>(
-      sdata, threadMax, Max<accscalar_t>(), -at::numeric_limits<accscalar_t>::max());
+      sdata, threadMax, Max<accscalar_t>(), at::numeric_limits<accscalar_t>::lowest());
 
   // reduce all values
   accscalar_t threadExp = ilpReduce<SumExpFloat, ILP, scalar_t, accscalar_t>(
@@ -469,10 +472,310 @@ cunn_SoftMaxBackward(scalar_t *gradInput, outscalar_t *output, outscalar_t *grad
     gradInput[offset] = epilogue(gradOutput[offset], output[offset]);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Fused softmax(input * scale + mask) over the last dimension
+////////////////////////////////////////////////////////////////////////////////
+
+// Rows of up to 2^kMaxPersistentLog2Elements elements are handled by a single
+// warp, with the row kept in registers: the input and the mask are read once
+// and the output written once, instead of the round trips of materializing the
+// scaled and masked input and of the passes of cunn_SoftMaxForward.
+constexpr int kMaxPersistentLog2Elements = 11;
+constexpr int kPersistentThreadsPerBlock = 128;
+
+template <typename T>
+__device__ __forceinline__ T warpReduceMax(T value, int width) {
+  for (int offset = width / 2; offset > 0; offset >>= 1) {
+    T other = WARP_SHFL_XOR(value, offset, width);
+    value = value < other ? other : value;
+  }
+  return value;
+}
+
+template <typename T>
+__device__ __forceinline__ T warpReduceSum(T value, int width) {
+  for (int offset = width / 2; offset > 0; offset >>= 1) {
+    value += WARP_SHFL_XOR(value, offset, width);
+  }
+  return value;
+}
+
+// mask_calc maps the index of a row to the byte offset of its row of the mask,
+// which may be broadcast along any of the dimensions but the last one.
+template <typename scalar_t, typename accscalar_t, int log2_elements>
+__global__ void
+scaled_masked_softmax_warp_forward(scalar_t *output, const scalar_t *input, const scalar_t *mask,
+                                   OffsetCalculator<1> mask_calc, accscalar_t scale,
+                                   int64_t rows, int classes)
+{
+  constexpr int next_power_of_two = 1 << log2_elements;
+  constexpr int WARP_SIZE = next_power_of_two < 32 ? next_power_of_two : 32;
+  constexpr int WARP_ITERATIONS = next_power_of_two / WARP_SIZE;
+
+  int64_t row = (int64_t)blockIdx.x * blockDim.y + threadIdx.y;
+  if (row >= rows) {
+    return;
+  }
+  int lane = threadIdx.x;
+  input += row * classes;
+  output += row * classes;
+  const scalar_t *mask_row = mask == nullptr ? nullptr :
+      (const scalar_t*)((const char*)mask + mask_calc.get(row)[0]);
+
+  accscalar_t elements[WARP_ITERATIONS];
+  accscalar_t max_value = at::numeric_limits<accscalar_t>::lowest();
+  #pragma unroll
+  for (int i = 0; i < WARP_ITERATIONS; ++i) {
+    int idx = lane + i * WARP_SIZE;
+    if (idx < classes) {
+      accscalar_t value = static_cast<accscalar_t>(input[idx]) * scale;
+      if (mask_row != nullptr) {
+        value += static_cast<accscalar_t>(mask_row[idx]);
+      }
+      elements[i] = value;
+      max_value = value > max_value ? value : max_value;
+    }
+  }
+  max_value = warpReduceMax(max_value, WARP_SIZE);
+
+  accscalar_t sum = 0;
+  #pragma unroll
+  for (int i = 0; i < WARP_ITERATIONS; ++i) {
+    if (lane + i * WARP_SIZE < classes) {
+      elements[i] = std::exp(elements[i] - max_value);
+      sum += elements[i];
+    }
+  }
+  sum = warpReduceSum(sum, WARP_SIZE);
 
+  #pragma unroll
+  for (int i = 0; i < WARP_ITERATIONS; ++i) {
+    int idx = lane + i * WARP_SIZE;
+    if (idx < classes) {
+      output[idx] = static_cast<scalar_t>(elements[i] / sum);
+    }
+  }
+}
 
+// grad_input = scale * output * (grad_output - sum(grad_output * output))
+template <typename scalar_t, typename accscalar_t, int log2_elements>
+__global__ void
+scaled_masked_softmax_warp_backward(scalar_t *gradInput, const scalar_t *output,
+                                    const scalar_t *gradOutput, accscalar_t scale,
+                                    int64_t rows, int classes)
+{
+  constexpr int next_power_of_two = 1 << log2_elements;
+  constexpr int WARP_SIZE = next_power_of_two < 32 ? next_power_of_two : 32;
+  constexpr int WARP_ITERATIONS = next_power_of_two / WARP_SIZE;
 
+  int64_t row = (int64_t)blockIdx.x * blockDim.y + threadIdx.y;
+  if (row >= rows) {
+    return;
+  }
+  int lane = threadIdx.x;
+  gradInput += row * classes;
+  output += row * classes;
+  gradOutput += row * classes;
+
+  accscalar_t out[WARP_ITERATIONS];
+  accscalar_t grad[WARP_ITERATIONS];
+  accscalar_t sum = 0;
+  #pragma unroll
+  for (int i = 0; i < WARP_ITERATIONS; ++i) {
+    int idx = lane + i * WARP_SIZE;
+    if (idx < classes) {
+      out[i] = static_cast<accscalar_t>(output[idx]);
+      grad[i] = static_cast<accscalar_t>(gradOutput[idx]);
+      sum += out[i] * grad[i];
+    }
+  }
+  sum = warpReduceSum(sum, WARP_SIZE);
 
+  #pragma unroll
+  for (int i = 0; i < WARP_ITERATIONS; ++i) {
+    int idx = lane + i * WARP_SIZE;
+    if (idx < classes) {
+      gradInput[idx] = static_cast<scalar_t>(scale * out[i] * (grad[i] - sum));
+    }
+  }
+}
+
+// Longer rows are handled by a block each. The maximum and the normalizer are
+// computed together in a single pass over the input, rescaling the partial
+// sum whenever the maximum grows, so the input is read twice rather than three
+// times.
+template <typename accscalar_t>
+struct MaxAndSum {
+  accscalar_t max;
+  accscalar_t sum;
+};
+
+template <typename accscalar_t>
+__device__ __forceinline__ MaxAndSum<accscalar_t>
+combineMaxAndSum(MaxAndSum<accscalar_t> a, MaxAndSum<accscalar_t> b) {
+  if (a.sum == 0) {
+    return b;
+  }
+  if (b.sum == 0) {
+    return a;
+  }
+  if (a.max < b.max) {
+    MaxAndSum<accscalar_t> tmp = a;
+    a = b;
+    b = tmp;
+  }
+  // the maxima are compared first so that fully masked (-inf) values don't
+  // turn the sum into a NaN
+  accscalar_t b_sum = b.max == a.max ? b.sum : b.sum * std::exp(b.max - a.max);
+  return { a.max, a.sum + b_sum };
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+scaled_masked_softmax_block_forward(scalar_t *output, const scalar_t *input, const scalar_t *mask,
+                                    OffsetCalculator<1> mask_calc, accscalar_t scale,
+                                    int classes)
+{
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<MaxAndSum<accscalar_t>*>(smem);
+
+  int64_t row = blockIdx.x;
+  input += row * classes;
+  output += row * classes;
+  const scalar_t *mask_row = mask == nullptr ? nullptr :
+      (const scalar_t*)((const char*)mask + mask_calc.get(row)[0]);
+
+  auto load = [&](int idx) {
+    accscalar_t value = static_cast<accscalar_t>(input[idx]) * scale;
+    if (mask_row != nullptr) {
+      value += static_cast<accscalar_t>(mask_row[idx]);
+    }
+    return value;
+  };
+
+  MaxAndSum<accscalar_t> partial = { at::numeric_limits<accscalar_t>::lowest(), 0 };
+  for (int idx = threadIdx.x; idx < classes; idx += blockDim.x) {
+    partial = combineMaxAndSum(partial, MaxAndSum<accscalar_t>{ load(idx), 1 });
+  }
+
+  sdata[threadIdx.x] = partial;
+  __syncthreads();
+  for (int offset = blockDim.x / 2; offset > 0; offset >>= 1) {
+    if (threadIdx.x < offset) {
+      sdata[threadIdx.x] = combineMaxAndSum(sdata[threadIdx.x], sdata[threadIdx.x + offset]);
+    }
+    __syncthreads();
+  }
+  MaxAndSum<accscalar_t> total = sdata[0];
+
+  for (int idx = threadIdx.x; idx < classes; idx += blockDim.x) {
+    output[idx] = static_cast<scalar_t>(std::exp(load(idx) - total.max) / total.sum);
+  }
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+scaled_masked_softmax_block_backward(scalar_t *gradInput, const scalar_t *output,
+                                     const scalar_t *gradOutput, accscalar_t scale,
+                                     int classes)
+{
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<accscalar_t*>(smem);
+
+  int64_t row = blockIdx.x;
+  gradInput += row * classes;
+  output += row * classes;
+  gradOutput += row * classes;
+
+  accscalar_t partial = 0;
+  for (int idx = threadIdx.x; idx < classes; idx += blockDim.x) {
+    partial += static_cast<accscalar_t>(output[idx]) * static_cast<accscalar_t>(gradOutput[idx]);
+  }
+  accscalar_t sum = blockReduce<Add, accscalar_t>(sdata, partial, Add<accscalar_t>(), 0);
+
+  for (int idx = threadIdx.x; idx < classes; idx += blockDim.x) {
+    accscalar_t out = static_cast<accscalar_t>(output[idx]);
+    gradInput[idx] = static_cast<scalar_t>(
+        scale * out * (static_cast<accscalar_t>(gradOutput[idx]) - sum));
+  }
+}
+
+inline int log2_ceil(int value) {
+  int log2_value = 0;
+  while ((1 << log2_value) < value) ++log2_value;
+  return log2_value;
+}
+
+// Grid and blocks of the warp per row kernels, for rows of up to
+// 2^log2_elements elements
+inline void persistent_softmax_launch_sizes(int log2_elements, int64_t rows, dim3& grid, dim3& block) {
+  int warp_size = std::min(1 << log2_elements, 32);
+  int rows_per_block = kPersistentThreadsPerBlock / warp_size;
+  grid = dim3((rows + rows_per_block - 1) / rows_per_block);
+  block = dim3(warp_size, rows_per_block);
+}
+
+template <typename scalar_t, typename accscalar_t>
+void launch_scaled_masked_softmax_forward(
+    scalar_t *output, const scalar_t *input, const scalar_t *mask,
+    const OffsetCalculator<1>& mask_calc, accscalar_t scale, int64_t rows, int classes) {
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  if (classes <= (1 << kMaxPersistentLog2Elements)) {
+    int log2_elements = log2_ceil(classes);
+    dim3 grid, block;
+    persistent_softmax_launch_sizes(log2_elements, rows, grid, block);
+    switch (log2_elements) {
+#define LAUNCH_FORWARD(L)                                                              \
+      case L:                                                                          \
+        scaled_masked_softmax_warp_forward<scalar_t, accscalar_t, L>                   \
+          <<<grid, block, 0, stream>>>(output, input, mask, mask_calc, scale, rows, classes); \
+        break;
+      LAUNCH_FORWARD(0) LAUNCH_FORWARD(1) LAUNCH_FORWARD(2) LAUNCH_FORWARD(3)
+      LAUNCH_FORWARD(4) LAUNCH_FORWARD(5) LAUNCH_FORWARD(6) LAUNCH_FORWARD(7)
+      LAUNCH_FORWARD(8) LAUNCH_FORWARD(9) LAUNCH_FORWARD(10) LAUNCH_FORWARD(11)
+#undef LAUNCH_FORWARD
+      default:
+        AT_ERROR("unexpected row size ", classes);
+    }
+  } else {
+    dim3 block = SoftMax_getBlockSize(2, classes);
+    scaled_masked_softmax_block_forward<scalar_t, accscalar_t>
+      <<<rows, block, block.x * sizeof(MaxAndSum<accscalar_t>), stream>>>(
+        output, input, mask, mask_calc, scale, classes);
+  }
+  THCudaCheck(cudaGetLastError());
+}
+
+template <typename scalar_t, typename accscalar_t>
+void launch_scaled_masked_softmax_backward(
+    scalar_t *gradInput, const scalar_t *output, const scalar_t *gradOutput,
+    accscalar_t scale, int64_t rows, int classes) {
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  if (classes <= (1 << kMaxPersistentLog2Elements)) {
+    int log2_elements = log2_ceil(classes);
+    dim3 grid, block;
+    persistent_softmax_launch_sizes(log2_elements, rows, grid, block);
+    switch (log2_elements) {
+#define LAUNCH_BACKWARD(L)                                                             \
+      case L:                                                                          \
+        scaled_masked_softmax_warp_backward<scalar_t, accscalar_t, L>                  \
+          <<<grid, block, 0, stream>>>(gradInput, output, gradOutput, scale, rows, classes); \
+        break;
+      LAUNCH_BACKWARD(0) LAUNCH_BACKWARD(1) LAUNCH_BACKWARD(2) LAUNCH_BACKWARD(3)
+      LAUNCH_BACKWARD(4) LAUNCH_BACKWARD(5) LAUNCH_BACKWARD(6) LAUNCH_BACKWARD(7)
+      LAUNCH_BACKWARD(8) LAUNCH_BACKWARD(9) LAUNCH_BACKWARD(10) LAUNCH_BACKWARD(11)
+#undef LAUNCH_BACKWARD
+      default:
+        AT_ERROR("unexpected row size ", classes);
+    }
+  } else {
+    dim3 block = SoftMax_getBlockSize(2, classes);
+    scaled_masked_softmax_block_backward<scalar_t, accscalar_t>
+      <<<rows, block, block.x * sizeof(accscalar_t), stream>>>(
+        gradInput, output, gradOutput, scale, classes);
+  }
+  THCudaCheck(cudaGetLastError());
+}
 
 template<template<typename, typename, typename> class Epilogue>
 Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_to_float){
@@ -644,5 +947,84 @@ Tensor softmax_backward_cuda(const Tensor &grad, const Tensor &output, int64_t d
   return host_softmax_backward<SoftMaxBackwardEpilogue>(tmp, output, dim, half_to_float);
 }
 
+Tensor scaled_masked_softmax_cuda(const Tensor &input_, const Tensor &mask_, double scale) {
+  AT_CHECK(input_.dim() > 0, "_scaled_masked_softmax: expected an input with at least one dimension");
+  auto input = input_.contiguous();
+  Tensor output = at::empty_like(input);
+  if (input.numel() == 0) {
+    return output;
+  }
+  int64_t classes = input.size(-1);
+  int64_t rows = input.numel() / classes;
+  int64_t row_dims = input.dim() - 1;
+
+  // The mask is read through the strides of its expansion to the input, in
+  // bytes, for the rows indexed by uint32_t
+  Tensor mask;
+  std::vector<int64_t> row_sizes(row_dims);
+  std::vector<int64_t> mask_strides(row_dims);
+  bool use_offset_calculator = rows <= std::numeric_limits<uint32_t>::max() &&
+      row_dims <= OffsetCalculator<1>::MAX_DIMS;
+  if (mask_.defined()) {
+    AT_CHECK(mask_.type() == input.type(),
+             "_scaled_masked_softmax: expected mask of type ", input.type().toString(),
+             " but got ", mask_.type().toString());
+    AT_CHECK(is_expandable_to(mask_.sizes(), input.sizes()),
+             "_scaled_masked_softmax: mask of size ", mask_.sizes(),
+             " can't be broadcast to the input of size ", input.sizes());
+    mask = mask_.expand(input.sizes());
+    if (mask.stride(-1) != 1) {
+      mask = mask.contiguous();
+    }
+    int64_t max_offset = 0;
+    for (int64_t i = 0; i < row_dims; i++) {
+      // OffsetCalculator takes the innermost dimension first
+      row_sizes[i] = input.size(row_dims - 1 - i);
+      mask_strides[i] = mask.stride(row_dims - 1 - i) * mask.type().elementSizeInBytes();
+      max_offset += (row_sizes[i] - 1) * mask_strides[i];
+    }
+    use_offset_calculator = use_offset_calculator &&
+        max_offset <= std::numeric_limits<uint32_t>::max();
+  }
+  if (!use_offset_calculator || classes > std::numeric_limits<int>::max()) {
+    auto scaled = input * scale;
+    return at::_softmax(mask.defined() ? scaled.add_(mask) : scaled, -1, false);
+  }
+
+  const int64_t* strides[] = { mask_strides.data() };
+  OffsetCalculator<1> mask_calc(row_dims, row_sizes.data(), strides);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "scaled_masked_softmax", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    launch_scaled_masked_softmax_forward<scalar_t, accscalar_t>(
+        output.data<scalar_t>(), input.data<scalar_t>(),
+        mask.defined() ? mask.data<scalar_t>() : nullptr,
+        mask_calc, static_cast<accscalar_t>(scale), rows, classes);
+  });
+  return output;
+}
+
+Tensor scaled_masked_softmax_backward_cuda(const Tensor &grad_, const Tensor &output_, double scale) {
+  TensorArg grad_arg{grad_, "grad", 1}, output_arg{output_, "output", 2};
+  checkSameSize("_scaled_masked_softmax_backward", grad_arg, output_arg);
+  auto grad = grad_.contiguous();
+  auto output = output_.contiguous();
+  Tensor gI = at::empty_like(grad);
+  if (grad.numel() == 0) {
+    return gI;
+  }
+  int64_t classes = grad.size(-1);
+  int64_t rows = grad.numel() / classes;
+  if (classes > std::numeric_limits<int>::max()) {
+    return at::_softmax_backward_data(grad, output, -1, output).mul_(scale);
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "scaled_masked_softmax_backward", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    launch_scaled_masked_softmax_backward<scalar_t, accscalar_t>(
+        gI.data<scalar_t>(), output.data<scalar_t>(), grad.data<scalar_t>(),
+        static_cast<accscalar_t>(scale), rows, classes);
+  });
+  return gI;
+}
+
 }
 }
@@ -15,6 +15,8 @@
 #include <cufft.h>
 #include <cufftXt.h>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 namespace at { namespace native {
 
@@ -259,36 +261,67 @@ static inline Tensor _run_cufft(
   return output;
 }
 
-// The cuFFT plan cache, defined in CuFFTUtils.h
-struct CuFFTParamsLRUCache plan_cache;
-std::mutex plan_cache_mutex;
+// The cuFFT plan caches, defined in CuFFTPlanCache.h, one per device. They
+// are created on first use, and stay at the same address afterwards.
+std::vector<std::unique_ptr<CuFFTParamsLRUCache>> plan_caches;
+std::mutex plan_caches_mutex;
+
+static CuFFTParamsLRUCache &cufft_get_plan_cache(int64_t device_index) {
+  AT_CHECK(0 <= device_index && device_index < at::cuda::getNumGPUs(),
+           "cuFFT plan cache: invalid device index ", device_index);
+  std::lock_guard<std::mutex> guard(plan_caches_mutex);
+  if (device_index >= static_cast<int64_t>(plan_caches.size())) {
+    plan_caches.resize(device_index + 1);
+  }
+  if (!plan_caches[device_index]) {
+    plan_caches[device_index].reset(new CuFFTParamsLRUCache());
+  }
+  return *plan_caches[device_index];
+}
 
 namespace detail {
 
-int64_t cufft_get_plan_cache_max_size_impl() {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index) {
+  auto &plan_cache = cufft_get_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
   return plan_cache.max_size();
 }
 
-void cufft_set_plan_cache_max_size_impl(int64_t max_size) {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size) {
+  auto &plan_cache = cufft_get_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
   plan_cache.resize(max_size);
 }
 
-int64_t cufft_get_plan_cache_size_impl() {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+int64_t cufft_get_plan_cache_size_impl(int64_t device_index) {
+  auto &plan_cache = cufft_get_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
   return plan_cache.size();
 }
 
-void cufft_clear_plan_cache_impl() {
-  std::lock_guard<std::mutex> guard(plan_cache_mutex);
+void cufft_clear_plan_cache_impl(int64_t device_index) {
+  auto &plan_cache = cufft_get_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
   return plan_cache.clear();
 }
 
+void cufft_get_plan_cache_stats_impl(int64_t device_index, int64_t* hits,
+                                     int64_t* misses, int64_t* evictions) {
+  auto &plan_cache = cufft_get_plan_cache(device_index);
+  std::lock_guard<std::mutex> guard(plan_cache.mutex);
+  *hits = plan_cache.hits();
+  *misses = plan_cache.misses();
+  *evictions = plan_cache.evictions();
+}
+
 } // namespace at::native::detail
 
 // cuFFT
 // Currently not utilizing multi GPUs so this can be potentially sped up.
+//
+// The work area of a plan isn't owned by the plan: it is allocated from the
+// caching allocator for each execution (see _run_cufft), so that the plans of
+// a device share the same cached blocks instead of holding one each.
 Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
                   bool complex_input, bool complex_output, bool inverse,
                   IntList checked_signal_sizes, bool normalized, bool onesided,
@@ -321,19 +354,21 @@ Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
   // futher cuFFT parameter computation and plan creation to the helper class
   // CuFFTConfig in CuFFTUtils.h.
 
-  // If plan caching is enabled, we check the cache. Note that this accesses
-  // plan_cache.max_size() and thus makes this function less functional.
+  // If plan caching is enabled, we check the cache of the input's device.
+  // Note that this accesses plan_cache.max_size() and thus makes this function
+  // less functional.
   // However, integrating additional arguments into the "public" level c++ APIs,
   // e.g., irfft, is difficult as we have a long call sequence looking like
   //   irfft --> _fft --> _fft_with_size --dispatching-to-> _fft_cufft
 
   // This read is not locked for perf reason. Shouldn't matter too much because
   // we check again after acquiring the lock.
+  auto &plan_cache = cufft_get_plan_cache(input.get_device());
   if (plan_cache.max_size() > 0) {
     CuFFTParams params;
     setCuFFTParams(&params, input, signal_ndim, complex_input,
       complex_output, checked_signal_sizes, onesided);
-    std::lock_guard<std::mutex> guard(plan_cache_mutex);
+    std::lock_guard<std::mutex> guard(plan_cache.mutex);
     if (plan_cache.max_size() > 0) {  // check again after acquiring the lock
       const CuFFTConfig &config = plan_cache.try_emplace_value(std::move(params),
                                              input, signal_ndim, complex_input,
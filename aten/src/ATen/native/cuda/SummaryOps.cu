@@ -152,7 +152,8 @@ inline int64_t getFreeGlobalMemory() {
   See `help torch.bincount` for details on the math.
 
   3 implementations based of input size and memory usage:
-    case: #bins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM and enough shared mem
+    case: enough shared mem, and #bins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM
+          or each block counting at least as many elements as there are bins
         SHARED: Each block atomically adds to it's own **shared** hist copy,
         then atomically updates the global tensor.
     case: #bins < THRESH_NUMBER_BINS_FOR_GLOBAL_MEM and enough global mem
@@ -190,8 +191,12 @@ bool CUDA_tensor_histogram(
   auto maxGlobalMem = getFreeGlobalMemory();
   auto multiBlockMem = nbins * grid.x * sizeof(output_t) + 8; // 8 guard bytes
   // determine memory type to use in the kernel
-  if (nbins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM &&
-      sharedMem < maxSharedMem) {
+  // Privatizing more bins costs each block more atomics to merge them, which
+  // the contention it saves on the global bins pays for when the block counts
+  // at least as many elements
+  if (sharedMem < maxSharedMem &&
+      (nbins < THRESH_NUMBER_BINS_FOR_MULTI_BLOCK_MEM ||
+       totalElements >= nbins * static_cast<int64_t>(grid.x))) {
     memType = CUDAHistogramMemoryType::SHARED;
   } else if (
       nbins < THRESH_NUMBER_BINS_FOR_GLOBAL_MEM &&
@@ -4,36 +4,237 @@
 #include <THC/THCThrustAllocator.cuh>
 #include <thrust/execution_policy.h>
 
+#include <limits>
 #include <tuple>
-#include <thrust/unique.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
 #include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/transform_scan.h>
+#include <thrust/unique.h>
 
 namespace at {
 namespace native{
 
 namespace {
+// Unique values of data, in which equal values are next to each other: the
+// first value of each run of equal values is written to output, the number of
+// values of each run to counts, and the index in output of the run of each
+// value to inverse_indices, at position perm[i] for the i-th value when perm
+// is given. Returns the number of runs.
+template <typename scalar_t, typename policy_t>
+int64_t unique_of_runs(
+    const policy_t& policy,
+    const scalar_t* data,
+    int64_t num_inp,
+    const int64_t* perm,
+    Tensor& output,
+    Tensor& inverse_indices,
+    Tensor& counts,
+    const bool return_inverse,
+    const bool return_counts) {
+  scalar_t* output_data = output.data<scalar_t>();
+  int64_t num_out;
+  if (return_counts) {
+    // the runs are counted from the positions where they start
+    Tensor starts = at::empty({num_inp + 1}, output.options().dtype(kLong));
+    int64_t* starts_data = starts.data<int64_t>();
+    auto ends = thrust::unique_by_key_copy(policy,
+      data, data + num_inp, thrust::counting_iterator<int64_t>(0),
+      output_data, starts_data);
+    num_out = ends.first - output_data;
+    starts.narrow(0, num_out, 1).fill_(num_inp);
+    counts.resize_({num_out});
+    thrust::transform(policy,
+      starts_data + 1, starts_data + num_out + 1, starts_data,
+      counts.data<int64_t>(), thrust::minus<int64_t>());
+  } else {
+    num_out = thrust::unique_copy(policy, data, data + num_inp, output_data) - output_data;
+  }
+  output.resize_({num_out});
+
+  if (return_inverse) {
+    // the index of the run of a value is the number of runs starting up
+    // to it, minus one
+    Tensor runs = perm == nullptr ? inverse_indices : at::empty({num_inp}, inverse_indices.options());
+    int64_t* runs_data = runs.data<int64_t>();
+    thrust::transform(policy,
+      thrust::counting_iterator<int64_t>(0), thrust::counting_iterator<int64_t>(num_inp),
+      runs_data,
+      [=] __device__ (int64_t i) -> int64_t {
+        return i > 0 && data[i] != data[i - 1];
+      });
+    thrust::inclusive_scan(policy, runs_data, runs_data + num_inp, runs_data);
+    if (perm != nullptr) {
+      thrust::scatter(policy, runs_data, runs_data + num_inp, perm, inverse_indices.data<int64_t>());
+    }
+  }
+  return num_out;
+}
+
+// Unsorted unique values are found with a hash table instead of sorting the
+// input. The table has a power of two number of slots, at least twice the
+// number of distinct values there may be, each holding the index of the first
+// value inserted in it, and is filled with linear probing. Its occupied slots
+// are then numbered with a scan, which gives the indices of the unique values.
+constexpr int32_t kUniqueEmptySlot = -1;
+constexpr int kUniqueThreads = 512;
+
+// Equal values must have the same bits to be hashed together: -0.0 is
+// hashed as 0.0. NaNs aren't equal to anything, and each gets a slot.
+template <typename scalar_t>
+__device__ __forceinline__ scalar_t unique_hash_key(scalar_t value) {
+  return value == scalar_t(0) ? scalar_t(0) : value;
+}
+
+template <typename scalar_t>
+__device__ __forceinline__ uint64_t unique_hash(scalar_t key) {
+  uint64_t h = 0;
+  memcpy(&h, &key, sizeof(scalar_t));
+  // finalizer of MurmurHash3
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
 template <typename scalar_t>
-__global__ void inverse_indices_kernel(
+__global__ void unique_hash_insert_kernel(
     const scalar_t* input_data,
-    const scalar_t* output_data,
-    int64_t* inverse_indices_data,
     int64_t num_inp,
-    int64_t num_out) {
-    int64_t idx = blockIdx.x * blockDim.x + threadIdx.x;
-    int64_t stride = blockDim.x * gridDim.x;
-
-    for (int64_t i = idx; i < num_inp * num_out; i += stride) {
-      if (input_data[i / num_out] == output_data[i % num_out]){
-        inverse_indices_data[i / num_out] = i % num_out;
+    int32_t* table,
+    int64_t table_mask,
+    int32_t* slots) {
+  for (int64_t i = blockIdx.x * (int64_t) blockDim.x + threadIdx.x; i < num_inp;
+       i += (int64_t) blockDim.x * gridDim.x) {
+    const scalar_t key = unique_hash_key(input_data[i]);
+    int64_t slot = unique_hash(key) & table_mask;
+    while (true) {
+      int32_t entry = table[slot];
+      if (entry == kUniqueEmptySlot) {
+        entry = atomicCAS(&table[slot], kUniqueEmptySlot, static_cast<int32_t>(i));
+        if (entry == kUniqueEmptySlot) {
+          break;
+        }
       }
+      // an occupied slot never changes
+      if (unique_hash_key(input_data[entry]) == key) {
+        break;
+      }
+      slot = (slot + 1) & table_mask;
+    }
+    slots[i] = static_cast<int32_t>(slot);
+  }
+}
+
+template <typename scalar_t>
+__global__ void unique_hash_gather_kernel(
+    const scalar_t* input_data,
+    const int32_t* table,
+    const int32_t* ranks,
+    int64_t table_size,
+    scalar_t* output_data) {
+  for (int64_t slot = blockIdx.x * (int64_t) blockDim.x + threadIdx.x; slot < table_size;
+       slot += (int64_t) blockDim.x * gridDim.x) {
+    int32_t entry = table[slot];
+    if (entry != kUniqueEmptySlot) {
+      output_data[ranks[slot] - 1] = input_data[entry];
+    }
+  }
+}
+
+__global__ void unique_hash_inverse_kernel(
+    const int32_t* slots,
+    const int32_t* ranks,
+    int64_t num_inp,
+    int64_t* inverse_indices_data,
+    int64_t* counts_data) {
+  for (int64_t i = blockIdx.x * (int64_t) blockDim.x + threadIdx.x; i < num_inp;
+       i += (int64_t) blockDim.x * gridDim.x) {
+    int64_t index = ranks[slots[i]] - 1;
+    if (inverse_indices_data != nullptr) {
+      inverse_indices_data[i] = index;
     }
+    if (counts_data != nullptr) {
+      atomicAdd(reinterpret_cast<unsigned long long*>(&counts_data[index]), 1ULL);
+    }
+  }
+}
+
+inline int unique_grid_size(int64_t n) {
+  return std::max<int64_t>(std::min<int64_t>((n + kUniqueThreads - 1) / kUniqueThreads, 4096), 1);
+}
+
+template <typename scalar_t, typename policy_t>
+void unique_by_hashing(
+    const policy_t& policy,
+    cudaStream_t stream,
+    const Tensor& input,
+    Tensor& output,
+    Tensor& inverse_indices,
+    Tensor& counts,
+    const bool return_inverse,
+    const bool return_counts) {
+  int64_t num_inp = input.numel();
+  const scalar_t* input_data = input.data<scalar_t>();
+
+  // there are at most 2^8 or 2^16 distinct values of the narrow types
+  int64_t max_distinct = num_inp;
+  if (sizeof(scalar_t) < 4) {
+    max_distinct = std::min<int64_t>(max_distinct, int64_t(1) << (8 * sizeof(scalar_t)));
   }
+  int64_t table_size = 1;
+  while (table_size < 2 * max_distinct) {
+    table_size *= 2;
+  }
+
+  auto int_options = input.options().dtype(kInt);
+  Tensor table = at::empty({table_size}, int_options).fill_(kUniqueEmptySlot);
+  Tensor slots = at::empty({num_inp}, int_options);
+  int32_t* table_data = table.data<int32_t>();
+  int32_t* slots_data = slots.data<int32_t>();
+  unique_hash_insert_kernel<scalar_t>
+    <<<unique_grid_size(num_inp), kUniqueThreads, 0, stream>>>(
+      input_data, num_inp, table_data, table_size - 1, slots_data);
+
+  // ranks[slot] is the number of occupied slots up to slot, included
+  Tensor ranks = at::empty({table_size}, int_options);
+  int32_t* ranks_data = ranks.data<int32_t>();
+  thrust::transform_inclusive_scan(policy,
+    table_data, table_data + table_size, ranks_data,
+    [] __device__ (int32_t entry) -> int32_t {
+      return entry != kUniqueEmptySlot;
+    },
+    thrust::plus<int32_t>());
+  int64_t num_out = ranks[table_size - 1].item<int32_t>();
 
+  output.resize_({num_out});
+  unique_hash_gather_kernel<scalar_t>
+    <<<unique_grid_size(table_size), kUniqueThreads, 0, stream>>>(
+      input_data, table_data, ranks_data, table_size, output.data<scalar_t>());
+
+  if (return_inverse || return_counts) {
+    if (return_counts) {
+      counts.resize_({num_out}).zero_();
+    }
+    unique_hash_inverse_kernel
+      <<<unique_grid_size(num_inp), kUniqueThreads, 0, stream>>>(
+        slots_data, ranks_data, num_inp,
+        return_inverse ? inverse_indices.data<int64_t>() : nullptr,
+        return_counts ? counts.data<int64_t>() : nullptr);
+  }
+  THCudaCheck(cudaGetLastError());
+}
 
 template <typename scalar_t>
-  std::tuple<Tensor, Tensor> _unique_cuda_template(
+  std::tuple<Tensor, Tensor, Tensor> _unique_cuda_template(
     const Tensor& self,
-    const bool return_inverse) {
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
 
     cudaStream_t stream = at::cuda::getCurrentCUDAStream();
     auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
@@ -41,31 +242,67 @@ template <typename scalar_t>
 
     const Tensor& input = self.contiguous();
     int64_t num_inp = input.numel();
-    const scalar_t* input_data = input.data<scalar_t>();
 
-    //sort & unique
-    Tensor output = input.clone();
-    output = output.view(-1);
-    scalar_t* output_data = output.data<scalar_t>();
-    thrust::sort(policy, output_data, output_data + num_inp);
-    scalar_t* output_end = thrust::unique(policy, output_data, output_data + num_inp);
-    int64_t num_out = output_end - output_data;
-    output.resize_(num_out);
+    Tensor output = at::empty({num_inp}, input.options());
+    Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+    Tensor counts = at::empty({0}, self.options().dtype(kLong));
+    if (return_inverse) {
+      inverse_indices.resize_(input.sizes());
+    }
+    if (num_inp == 0) {
+      return std::make_tuple(output, inverse_indices, counts);
+    }
 
-    Tensor inverse_indices = at::empty({0}, self.type().toScalarType(kLong));
+    if (!sorted && num_inp <= std::numeric_limits<int32_t>::max()) {
+      unique_by_hashing<scalar_t>(policy, stream, input, output, inverse_indices, counts,
+                                   return_inverse, return_counts);
+      return std::make_tuple(output, inverse_indices, counts);
+    }
 
+    // sort, keeping the positions of the values for the inverse indices
+    Tensor sorted_input = input.view(-1).clone();
+    scalar_t* sorted_data = sorted_input.data<scalar_t>();
+    Tensor perm;
     if (return_inverse) {
-      inverse_indices.resize_(input.sizes());
-      int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
-      int block = 512;
-      int grid = std::min<int64_t>((num_inp * num_out + block - 1) / block, 2048L);
-      inverse_indices_kernel<<<grid, block, 0, stream>>>(
-        input_data, output_data, inverse_indices_data, num_inp, num_out);
+      perm = at::arange(0, num_inp, self.options().dtype(kLong));
+      thrust::sort_by_key(policy, sorted_data, sorted_data + num_inp, perm.data<int64_t>());
+    } else {
+      thrust::sort(policy, sorted_data, sorted_data + num_inp);
     }
+    unique_of_runs(policy, sorted_data, num_inp,
+                   return_inverse ? perm.data<int64_t>() : nullptr,
+                   output, inverse_indices, counts, return_inverse, return_counts);
 
     THCudaCheck(cudaGetLastError());
-    return std::tuple<Tensor, Tensor>(output, inverse_indices);
+    return std::make_tuple(output, inverse_indices, counts);
+  }
+
+template <typename scalar_t>
+  std::tuple<Tensor, Tensor, Tensor> _unique_consecutive_cuda_template(
+    const Tensor& self,
+    const bool return_inverse,
+    const bool return_counts) {
 
+    cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+    auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+    auto policy = thrust::cuda::par(allocator).on(stream);
+
+    const Tensor& input = self.contiguous();
+    int64_t num_inp = input.numel();
+
+    Tensor output = at::empty({num_inp}, input.options());
+    Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+    Tensor counts = at::empty({0}, self.options().dtype(kLong));
+    if (return_inverse) {
+      inverse_indices.resize_(input.sizes());
+    }
+    if (num_inp > 0) {
+      unique_of_runs(policy, input.data<scalar_t>(), num_inp, nullptr,
+                     output, inverse_indices, counts, return_inverse, return_counts);
+    }
+
+    THCudaCheck(cudaGetLastError());
+    return std::make_tuple(output, inverse_indices, counts);
   }
 
 template <typename scalar_t>
@@ -158,9 +395,24 @@ template <typename scalar_t>
 std::tuple<Tensor, Tensor>
 _unique_cuda(const Tensor& self, const bool sorted, const bool return_inverse) {
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    // The current CUDA implementation of unique always sort due to the
-    // lack of hashtable implementation in thrust
-    return _unique_cuda_template<scalar_t>(self, return_inverse);
+    Tensor output, inverse_indices, counts;
+    std::tie(output, inverse_indices, counts) =
+      _unique_cuda_template<scalar_t>(self, sorted, return_inverse, false);
+    return std::make_tuple(output, inverse_indices);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique2_cuda(const Tensor& self, const bool sorted, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
+    return _unique_cuda_template<scalar_t>(self, sorted, return_inverse, return_counts);
+  });
+}
+
+std::tuple<Tensor, Tensor, Tensor>
+_unique_consecutive_cuda(const Tensor& self, const bool return_inverse, const bool return_counts) {
+  return AT_DISPATCH_ALL_TYPES(self.type(), "unique_consecutive", [&] {
+    return _unique_consecutive_cuda_template<scalar_t>(self, return_inverse, return_counts);
   });
 }
 
@@ -77,14 +77,18 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
 
 #include "THC/THC.h"
 
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cudnn/ConvBenchmarkCache.h>
 #include <ATen/cudnn/cudnn-wrapper.h>
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
 #include <ATen/cudnn/Utils.h>
+#include "ATen/native/ChannelsLast.h"
 #include "ATen/native/utils/ParamsHash.h"
 
 #include <ATen/TensorUtils.h>
 
+#include <fstream>
 #include <functional>
 #include <iterator>
 #include <sstream>
@@ -93,6 +97,8 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
 #include <mutex>
 #include <stdint.h>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace at { namespace native {
 
@@ -177,6 +183,27 @@ Tensor narrowGroup(const Tensor& t, int dim, int group_idx, int64_t groups) {
   return t.narrow(dim, group_idx * group_size, group_size);
 }
 
+// Convolutions of channels last (NHWC) inputs are run by cuDNN in that
+// layout, with the weight, the output and the gradients laid out channels
+// last as well, so that half convolutions run on Tensor Cores without
+// transposes. Old versions of cuDNN, which need the groups split, only get
+// contiguous tensors.
+static bool use_channels_last(const Tensor& input) {
+#if CUDNN_VERSION >= 7000
+  return is_channels_last(input);
+#else
+  return false;
+#endif
+}
+
+static Tensor contiguous_as(const Tensor& t, bool channels_last) {
+  return channels_last ? channels_last_contiguous(t) : t.contiguous();
+}
+
+static Tensor empty_as(IntList sizes, const TensorOptions& options, bool channels_last) {
+  return channels_last ? empty_channels_last(sizes, options) : at::empty(sizes, options);
+}
+
 // ---------------------------------------------------------------------
 //
 // Checking
@@ -256,11 +283,14 @@ struct ConvolutionParams
   int input_size[2 + max_dim];
   int input_stride[2 + max_dim];
   int weight_size[2 + max_dim];
+  int weight_stride[2 + max_dim];
   int padding[max_dim];
   int stride[max_dim];
   int dilation[max_dim];
   int64_t groups;
   bool deterministic;
+  // The cap on the workspace of the chosen algorithm, 0 if unlimited
+  int64_t workspace_limit;
   // NB: transposed purposely omitted: transposed just swaps
   // forward and backward, so you can reuse the benchmark entry,
 };
@@ -284,6 +314,7 @@ void setConvolutionParams(
     params->input_size[i] = (int) input.size(i);
     params->input_stride[i] = (int) input.stride(i);
     params->weight_size[i] = (int) weight.size(i);
+    params->weight_stride[i] = (int) weight.stride(i);
   }
   // ASSERT(padding.size() == stride.size())
   // ASSERT(padding.size() == dilation.size())
@@ -296,6 +327,7 @@ void setConvolutionParams(
   // CuDNN, but it doesn't seem worth the effort to actually do this.
   params->groups = groups;
   params->deterministic = deterministic;
+  params->workspace_limit = globalContext().workspaceLimitCuDNN();
 }
 
 // Convenience struct for passing around descriptors and data
@@ -338,12 +370,146 @@ struct BenchmarkCache {
     std::lock_guard<std::mutex> guard(mutex);
     map[params] = results;
   }
+
+  std::vector<std::pair<ConvolutionParams, T>> entries() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return std::vector<std::pair<ConvolutionParams, T>>(map.begin(), map.end());
+  }
 };
 
 BenchmarkCache<cudnnConvolutionFwdAlgo_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgo_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgo_t> bwd_filter_algos;
 
+// ---------------------------------------------------------------------
+//
+// Benchmark cache persistence
+//
+// ---------------------------------------------------------------------
+
+// The file is made of sections, each starting with a line identifying the
+// cuDNN version and the GPU model the algorithms were chosen on, e.g.
+//
+//   device 7401 Tesla V100-SXM2-16GB
+//
+// followed by a line per cache entry, with the kind of algorithm, the
+// fields of its ConvolutionParams and the algorithm:
+//
+//   fwd 0 32 64 56 56 0 ... 1 0 0 1
+//
+// Lines starting with # are comments.
+
+constexpr const char* kDeviceTag = "device";
+
+std::string currentDeviceKey() {
+  std::ostringstream key;
+  key << cudnnGetVersion() << " " << at::cuda::getCurrentDeviceProperties()->name;
+  return key.str();
+}
+
+template <typename T, size_t N>
+void writeFields(std::ostream& out, const T (&fields)[N]) {
+  for (const auto& field : fields) {
+    out << " " << field;
+  }
+}
+
+template <typename T, size_t N>
+void readFields(std::istream& in, T (&fields)[N]) {
+  for (auto& field : fields) {
+    in >> field;
+  }
+}
+
+template <typename algo_t>
+void writeEntries(std::ostream& out, const char* kind, BenchmarkCache<algo_t>& cache) {
+  for (const auto& entry : cache.entries()) {
+    const auto& params = entry.first;
+    out << kind << " " << static_cast<int>(params.dataType);
+    writeFields(out, params.input_size);
+    writeFields(out, params.input_stride);
+    writeFields(out, params.weight_size);
+    writeFields(out, params.padding);
+    writeFields(out, params.stride);
+    writeFields(out, params.dilation);
+    out << " " << params.groups << " " << params.deterministic
+        << " " << params.workspace_limit
+        << " " << static_cast<int>(entry.second) << "\n";
+  }
+}
+
+bool readEntry(std::istream& in, ConvolutionParams* params, int* algo) {
+  // Zero the padding too, as the cache hashes and compares the raw bytes
+  memset(params, 0, sizeof(ConvolutionParams));
+  int dataType = 0;
+  int deterministic = 0;
+  in >> dataType;
+  readFields(in, params->input_size);
+  readFields(in, params->input_stride);
+  readFields(in, params->weight_size);
+  readFields(in, params->padding);
+  readFields(in, params->stride);
+  readFields(in, params->dilation);
+  in >> params->groups >> deterministic >> params->workspace_limit >> *algo;
+  params->dataType = static_cast<cudnnDataType_t>(dataType);
+  params->deterministic = deterministic != 0;
+  return !in.fail() && (in >> std::ws).eof();
+}
+
+void exportConvolutionBenchmarkCache(const std::string& path) {
+  std::ofstream out(path);
+  AT_CHECK(out, "could not open ", path, " to export the convolution benchmark cache");
+  out << kDeviceTag << " " << currentDeviceKey() << "\n";
+  writeEntries(out, "fwd", fwd_algos);
+  writeEntries(out, "bwd_data", bwd_data_algos);
+  writeEntries(out, "bwd_filter", bwd_filter_algos);
+  out.close();
+  AT_CHECK(out, "could not write the convolution benchmark cache to ", path);
+}
+
+int64_t importConvolutionBenchmarkCache(const std::string& path) {
+  std::ifstream in(path);
+  AT_CHECK(in, "could not open ", path, " to import the convolution benchmark cache");
+  const std::string key = currentDeviceKey();
+  bool matching_section = false;
+  int64_t count = 0;
+  std::string line;
+  for (int64_t line_number = 1; std::getline(in, line); ++line_number) {
+    std::istringstream fields(line);
+    std::string kind;
+    if (!(fields >> kind) || kind[0] == '#') {
+      continue;
+    }
+    if (kind == kDeviceTag) {
+      std::string device;
+      std::getline(fields >> std::ws, device);
+      matching_section = device == key;
+      continue;
+    }
+    ConvolutionParams params;
+    int algo = 0;
+    AT_CHECK(readEntry(fields, &params, &algo),
+             path, ":", line_number, ": malformed convolution benchmark cache entry");
+    if (kind == "fwd") {
+      if (matching_section) {
+        fwd_algos.insert(params, static_cast<cudnnConvolutionFwdAlgo_t>(algo));
+      }
+    } else if (kind == "bwd_data") {
+      if (matching_section) {
+        bwd_data_algos.insert(params, static_cast<cudnnConvolutionBwdDataAlgo_t>(algo));
+      }
+    } else if (kind == "bwd_filter") {
+      if (matching_section) {
+        bwd_filter_algos.insert(params, static_cast<cudnnConvolutionBwdFilterAlgo_t>(algo));
+      }
+    } else {
+      AT_ERROR(path, ":", line_number, ": unknown convolution algorithm kind ", kind);
+    }
+    count += matching_section;
+  }
+  return count;
+}
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -421,6 +587,9 @@ size_t getMaxWorkspaceSize(
     size_t free_gpu_mem = 0;
 
     THCudaCheck(THCudaMemGetInfo(state, &free_gpu_mem, &total_gpu_mem, &max_block_size));
+    if (args.params.workspace_limit > 0) {
+      max_block_size = std::min(max_block_size, static_cast<size_t>(args.params.workspace_limit));
+    }
 
     for (int i = 0; i < n_algo; i++) {
         cudnnStatus_t err;
@@ -434,21 +603,23 @@ size_t getMaxWorkspaceSize(
 }
 
 template<typename perf_t>
-perf_t getBestAlgorithm(perf_t *perfResults, bool deterministic, int n_algo) {
-  if (deterministic) {
-    // iterate over perf results of all algorithms and find the best deterministic algo
-    for (int i = 0; i < n_algo; i++) {
-      // TODO: Shouldn't all returned results be successful?
-      // Double check documentation for cudnnFindConvolutionForwardAlgorithmEx
-      if (perfResults[i].status == CUDNN_STATUS_SUCCESS &&
-          perfResults[i].determinism == CUDNN_DETERMINISTIC) {
-        return perfResults[i];
-      }
+perf_t getBestAlgorithm(perf_t *perfResults, const ConvolutionParams& params, int n_algo) {
+  // The perf results are sorted by time, so the first algorithm that
+  // satisfies the constraints is the fastest one
+  for (int i = 0; i < n_algo; i++) {
+    // TODO: Shouldn't all returned results be successful?
+    // Double check documentation for cudnnFindConvolutionForwardAlgorithmEx
+    if (perfResults[i].status == CUDNN_STATUS_SUCCESS &&
+        (!params.deterministic || perfResults[i].determinism == CUDNN_DETERMINISTIC) &&
+        (params.workspace_limit <= 0 ||
+         perfResults[i].memory <= static_cast<size_t>(params.workspace_limit))) {
+      return perfResults[i];
     }
+  }
+  if (params.deterministic) {
     AT_ERROR("no deterministic convolution algorithms available in CuDNN");
-  } else {
-    return perfResults[0];
   }
+  return perfResults[0];
 }
 
 template<>
@@ -488,14 +659,16 @@ struct algorithm_search<cudnnConvolutionFwdAlgo_t> {
         perf_results.get(),
         ws.data,
         ws.size));
-    return getBestAlgorithm(perf_results.get(), args.params.deterministic, perf_count);
+    return getBestAlgorithm(perf_results.get(), args.params, perf_count);
   }
 
   static void getAlgorithm(
     const ConvolutionArgs& args,
     algo_t* algo)
   {
-    cudnnConvolutionFwdPreference_t pref = CUDNN_CONVOLUTION_FWD_PREFER_FASTEST;
+    cudnnConvolutionFwdPreference_t pref = args.params.workspace_limit > 0
+        ? CUDNN_CONVOLUTION_FWD_SPECIFY_WORKSPACE_LIMIT
+        : CUDNN_CONVOLUTION_FWD_PREFER_FASTEST;
     AT_CUDNN_CHECK(cudnnGetConvolutionForwardAlgorithm(
         args.handle,
         args.idesc.desc(),
@@ -503,7 +676,7 @@ struct algorithm_search<cudnnConvolutionFwdAlgo_t> {
         args.cdesc.desc(),
         args.odesc.desc(),
         pref,
-        0,
+        args.params.workspace_limit,
         algo));
   }
 
@@ -557,7 +730,7 @@ struct algorithm_search<cudnnConvolutionBwdDataAlgo_t> {
         perf_results.get(),
         ws.data,
         ws.size));
-    return getBestAlgorithm(perf_results.get(), args.params.deterministic, perf_count);
+    return getBestAlgorithm(perf_results.get(), args.params, perf_count);
   }
 
   static void getAlgorithm(const ConvolutionArgs& args, algo_t* algo) {
@@ -567,8 +740,10 @@ struct algorithm_search<cudnnConvolutionBwdDataAlgo_t> {
         args.odesc.desc(),
         args.cdesc.desc(),
         args.idesc.desc(),
-        CUDNN_CONVOLUTION_BWD_DATA_PREFER_FASTEST,
-        0,
+        args.params.workspace_limit > 0
+            ? CUDNN_CONVOLUTION_BWD_DATA_SPECIFY_WORKSPACE_LIMIT
+            : CUDNN_CONVOLUTION_BWD_DATA_PREFER_FASTEST,
+        args.params.workspace_limit,
         algo));
   }
 
@@ -627,7 +802,7 @@ struct algorithm_search<cudnnConvolutionBwdFilterAlgo_t> {
         perf_results.get(),
         ws.data,
         ws.size));
-    return getBestAlgorithm<perf_t>(perf_results.get(), args.params.deterministic, perf_count);
+    return getBestAlgorithm<perf_t>(perf_results.get(), args.params, perf_count);
   }
 
   static void getAlgorithm(const ConvolutionArgs& args, algo_t* algo) {
@@ -637,8 +812,10 @@ struct algorithm_search<cudnnConvolutionBwdFilterAlgo_t> {
         args.odesc.desc(),
         args.cdesc.desc(),
         args.wdesc.desc(),
-        CUDNN_CONVOLUTION_BWD_FILTER_PREFER_FASTEST,
-        0,
+        args.params.workspace_limit > 0
+            ? CUDNN_CONVOLUTION_BWD_FILTER_SPECIFY_WORKSPACE_LIMIT
+            : CUDNN_CONVOLUTION_BWD_FILTER_PREFER_FASTEST,
+        args.params.workspace_limit,
         algo)
     );
   }
@@ -680,6 +857,10 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
     return;
   }
 
+  int device;
+  THCudaCheck(cudaGetDevice(&device));
+  const uint64_t cached_before = THCCachingAllocator_currentMemoryCached(device);
+
   auto perfResults = search::findAlgorithm(args);
   // for deterministic algo, look at all the perf results and return the best
   // deterministic algo
@@ -691,10 +872,13 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
   }
   cache.insert(args.params, *algo);
 
-  // Free the cached blocks in our caching allocator. They are
-  // needed here because the above benchmarking uses a huge amount of memory,
-  // e.g. a few GBs.
-  THCCachingAllocator_emptyCache();
+  // The benchmarking uses a huge amount of memory, e.g. a few GBs.  When
+  // the workspace fit in a free cached block, it went back to the cache
+  // and is reused by the next allocations.  Otherwise, free the segments
+  // the search added to our caching allocator.
+  if (THCCachingAllocator_currentMemoryCached(device) > cached_before) {
+    THCCachingAllocator_emptyCache();
+  }
 }
 
 template<typename algo_t>
@@ -804,7 +988,7 @@ void raw_cudnn_convolution_forward_out(
   args.handle = getCudnnHandle();
   setConvolutionParams(&args.params, input, weight, padding, stride, dilation, groups, deterministic);
   args.idesc.set(input);
-  args.wdesc.set(weight);
+  args.wdesc.set(weight, 0, use_channels_last(input));
   args.odesc.set(output);
   args.cdesc.set(dataType, input.dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
 
@@ -836,17 +1020,18 @@ Tensor cudnn_convolution_forward(
   checkAllSameType(c, {input, weight});
   checkAllSameGPU(c, {input, weight});
 
-  auto output_t = at::empty(
+  bool channels_last = use_channels_last(*input);
+  auto output_t = empty_as(
                     conv_output_size(input->sizes(), weight->sizes(),
                                      padding, stride, dilation, groups),
-                    input->options());
+                    input->options(), channels_last);
 
   // Avoid ambiguity of "output" when this is being used as backwards
   TensorArg output{ output_t, "result", 0 };
   convolution_shape_check(c, input, weight, output, padding, stride, dilation, groups);
 
   // See #4500
-  Tensor weight_contig = weight->contiguous();
+  Tensor weight_contig = contiguous_as(*weight, channels_last);
 
 #if CUDNN_VERSION < 7000
   for (int i = 0; i < groups; i++) {
@@ -903,7 +1088,7 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
     IntList padding, IntList output_padding, IntList stride, IntList dilation, int64_t groups,
     bool benchmark, bool deterministic, std::array<bool,3> output_mask) {
 
-  Tensor grad_output = grad_output_t.contiguous();
+  Tensor grad_output = contiguous_as(grad_output_t, use_channels_last(input));
 
   Tensor grad_input, grad_weight, grad_bias;
   if (output_mask[0]) {
@@ -938,7 +1123,7 @@ void raw_cudnn_convolution_backward_input_out(
   args.handle = getCudnnHandle();
   setConvolutionParams(&args.params, grad_input, weight, padding, stride, dilation, groups, deterministic);
   args.idesc.set(grad_input);
-  args.wdesc.set(weight);
+  args.wdesc.set(weight, 0, use_channels_last(grad_output));
   args.odesc.set(grad_output);
   args.cdesc.set(dataType, grad_output.dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
 
@@ -977,14 +1162,15 @@ Tensor cudnn_convolution_backward_input(
   checkAllSameType(c, {grad_output, weight});
   checkAllSameGPU(c, {grad_output, weight});
 
-  auto grad_input_t = at::empty(input_size, grad_output->options());
+  bool channels_last = use_channels_last(*grad_output);
+  auto grad_input_t = empty_as(input_size, grad_output->options(), channels_last);
 
   // Avoid "grad_input" when this is being used as transposed convolution
   TensorArg grad_input{ grad_input_t, "result", 0 };
   convolution_shape_check(c, grad_input, weight, grad_output, padding, stride, dilation, groups);
 
   // See #4500
-  Tensor weight_contig = weight->contiguous();
+  Tensor weight_contig = contiguous_as(*weight, channels_last);
 
 #if CUDNN_VERSION < 7000
   for (int i = 0; i < groups; i++) {
@@ -1034,7 +1220,7 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_backward(
     IntList padding, IntList stride, IntList dilation, int64_t groups,
     bool benchmark, bool deterministic, std::array<bool,3> output_mask) {
 
-  Tensor grad_output = grad_output_t.contiguous();
+  Tensor grad_output = contiguous_as(grad_output_t, use_channels_last(input));
 
   Tensor grad_input, grad_weight, grad_bias;
   if (output_mask[0]) {
@@ -1084,7 +1270,7 @@ void raw_cudnn_convolution_backward_weight_out(
   args.handle = getCudnnHandle();
   setConvolutionParams(&args.params, input, grad_weight, padding, stride, dilation, groups, deterministic);
   args.idesc.set(input);
-  args.wdesc.set(grad_weight);
+  args.wdesc.set(grad_weight, 0, use_channels_last(input));
   args.odesc.set(grad_output);
   args.cdesc.set(dataType, input.dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
 
@@ -1112,7 +1298,7 @@ Tensor cudnn_convolution_backward_weight(
   checkAllSameType(c, {grad_output, input});
   checkAllSameGPU(c, {grad_output, input});
 
-  auto grad_weight_t = at::empty(weight_size, grad_output->options());
+  auto grad_weight_t = empty_as(weight_size, grad_output->options(), use_channels_last(*input));
 
   // For uniformity with everything else, although it seems grad_weight
   // would be unambiguous too.
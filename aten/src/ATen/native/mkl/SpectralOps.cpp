@@ -24,11 +24,18 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include "ATen/Dispatch.h"
 #include "ATen/Utils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/utils/ParamsHash.h"
 
 #include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <numeric>
 #include <cmath>
+#include <cstring>
 
 #include <mkl_dfti.h>
 #include <ATen/mkl/Exceptions.h>
@@ -159,6 +166,164 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+// MKL DFTI plan cache
+//
+// Creating and committing a DFTI descriptor costs much more than running it
+// on a small signal, so committed descriptors are kept in an LRU cache keyed
+// on everything that went into them. A committed descriptor may be used by
+// several threads at once, and the cache hands out shared_ptrs so that an
+// evicted descriptor lives until the transforms using it are done.
+
+constexpr int64_t mkl_fft_max_rank = 3;
+
+// The signals of a batch are split across the intra-op threads, each running
+// one single-threaded descriptor on its part of the batch, when they have at
+// most this many elements; larger signals keep MKL's own threading.
+constexpr int64_t MKL_FFT_MAX_BATCH_PARALLEL_NUMEL = 4096;
+
+constexpr size_t MKL_FFT_MAX_PLAN_NUM = 1024;
+
+// This POD struct is the **key** to the plan cache, see CuFFTParams.
+struct MklFFTParams {
+  DFTI_CONFIG_VALUE precision_;
+  DFTI_CONFIG_VALUE signal_type_;
+  bool complex_input_;
+  bool complex_output_;
+  bool inverse_;
+  bool normalized_;
+  bool single_threaded_;
+  int64_t signal_ndim_;
+  MKL_LONG signal_sizes_[mkl_fft_max_rank];
+  MKL_LONG istrides_[mkl_fft_max_rank + 1];  // istrides_[0] is the batch distance
+  MKL_LONG ostrides_[mkl_fft_max_rank + 1];
+  MKL_LONG batch_;
+};
+
+// NB: This can't be a constructor, because then MklFFTParams would not be a
+// POD anymore.
+static inline void setMklFFTParams(MklFFTParams* params, const Tensor& input,
+    const Tensor& output, int64_t signal_ndim, bool complex_input,
+    bool complex_output, bool inverse, IntList checked_signal_sizes,
+    bool normalized, DFTI_CONFIG_VALUE precision) {
+  AT_CHECK(signal_ndim >= 1 && signal_ndim <= mkl_fft_max_rank,
+           "MKL FFT: signal_ndim must be between 1 and ", mkl_fft_max_rank, ", but got ", signal_ndim);
+  memset(params, 0, sizeof(MklFFTParams));
+  params->precision_ = precision;
+  if (!inverse) {
+    params->signal_type_ = complex_input ? DFTI_COMPLEX : DFTI_REAL;
+  } else {
+    params->signal_type_ = complex_output ? DFTI_COMPLEX : DFTI_REAL;
+  }
+  params->complex_input_ = complex_input;
+  params->complex_output_ = complex_output;
+  params->inverse_ = inverse;
+  params->normalized_ = normalized;
+  params->signal_ndim_ = signal_ndim;
+  // strides are in elements of the complex type on the complex side
+  for (int64_t i = 0; i <= signal_ndim; i++) {
+    params->istrides_[i] = complex_input ? input.stride(i) >> 1 : input.stride(i);
+    params->ostrides_[i] = complex_output ? output.stride(i) >> 1 : output.stride(i);
+  }
+  for (int64_t i = 0; i < signal_ndim; i++) {
+    params->signal_sizes_[i] = checked_signal_sizes[i];
+  }
+  params->batch_ = input.size(0);
+}
+
+static std::shared_ptr<DftiDescriptor> _make_mkl_fft_plan(const MklFFTParams& params) {
+  auto descriptor = std::make_shared<DftiDescriptor>();
+  // create descriptor with signal size
+  std::vector<MKL_LONG> mkl_signal_sizes(params.signal_sizes_, params.signal_sizes_ + params.signal_ndim_);
+  descriptor->init(params.precision_, params.signal_type_, params.signal_ndim_, mkl_signal_sizes.data());
+  // out of place FFT
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+  // batch mode
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_NUMBER_OF_TRANSFORMS, params.batch_));
+  // batch dim stride, i.e., dist between each data
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_DISTANCE, params.istrides_[0]));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_DISTANCE, params.ostrides_[0]));
+  // signal strides
+  // first val is offset, set to zero (ignored)
+  std::vector<MKL_LONG> mkl_istrides(params.istrides_, params.istrides_ + params.signal_ndim_ + 1);
+  std::vector<MKL_LONG> mkl_ostrides(params.ostrides_, params.ostrides_ + params.signal_ndim_ + 1);
+  mkl_istrides[0] = mkl_ostrides[0] = 0;
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+  // if conjugate domain of real is involved, set standard CCE storage type
+  // this will become default in MKL in future
+  if (!params.complex_input_ || !params.complex_output_) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  }
+  // rescale if needed by normalized flag or inverse transform
+  if (params.normalized_ || params.inverse_) {
+    int64_t signal_numel = 1;
+    for (int64_t i = 0; i < params.signal_ndim_; i++) {
+      signal_numel *= params.signal_sizes_[i];
+    }
+    double double_scale;
+    if (params.normalized_) {
+      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+    } else {
+      double_scale = 1.0 / static_cast<double>(signal_numel);
+    }
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(),
+      params.inverse_ ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+      params.precision_ == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  }
+  // the threads of the batch split must not start more threads each
+  if (params.single_threaded_) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_THREAD_LIMIT, 1));
+  }
+  // finalize
+  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor->get()));
+  return descriptor;
+}
+
+class MklFFTPlanCache {
+public:
+  using kv_t = std::pair<MklFFTParams, std::shared_ptr<DftiDescriptor>>;
+  using map_t = std::unordered_map<MklFFTParams, std::list<kv_t>::iterator,
+                                   ParamsHash<MklFFTParams>, ParamsEqual<MklFFTParams>>;
+
+  // Returns the committed descriptor for params, creating it if needed. The
+  // descriptor is created without holding the lock, so that a miss doesn't
+  // stall the threads that hit.
+  std::shared_ptr<DftiDescriptor> get(const MklFFTParams& params) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto map_it = cache_map_.find(params);
+      if (map_it != cache_map_.end()) {
+        usage_list_.splice(usage_list_.begin(), usage_list_, map_it->second);
+        return map_it->second->second;
+      }
+    }
+    auto plan = _make_mkl_fft_plan(params);
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto map_it = cache_map_.find(params);
+    if (map_it != cache_map_.end()) {
+      // another thread created it in the meantime
+      return map_it->second->second;
+    }
+    if (usage_list_.size() >= MKL_FFT_MAX_PLAN_NUM) {
+      cache_map_.erase(usage_list_.back().first);
+      usage_list_.pop_back();
+    }
+    usage_list_.emplace_front(params, plan);
+    cache_map_.emplace(params, usage_list_.begin());
+    return plan;
+  }
+
+private:
+  std::list<kv_t> usage_list_;
+  map_t cache_map_;
+  std::mutex mutex_;
+};
+
+static MklFFTPlanCache& mkl_fft_plan_cache() {
+  static MklFFTPlanCache cache;
+  return cache;
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
@@ -208,6 +373,9 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
     }
   }
   Tensor output = at::empty(output_sizes, input.options());
+  if (batch == 0) {
+    return output;
+  }
 
   // precision
   DFTI_CONFIG_VALUE prec;
@@ -221,64 +389,49 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
        << toString(input.type().scalarType());
     AT_ERROR(ss.str());
   }
-  // signal type
-  DFTI_CONFIG_VALUE signal_type;
-  if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
-  } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
-  }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
 
-  auto istrides = input.strides();
-  auto ostrides = output.strides();
-  // batch dim stride, i.e., dist between each data
-  MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
-  MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
-  // signal strides
-  // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
-  for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  // Many small signals are split into one chunk of the batch per thread.
+  // There are at most two descriptors: one for the full chunks, and one for
+  // the last chunk if it is shorter.
+  int64_t num_chunks = 1;
+  if (batch > 1 && at::prod_intlist(checked_signal_sizes) <= MKL_FFT_MAX_BATCH_PARALLEL_NUMEL &&
+      !at::in_parallel_region()) {
+    num_chunks = std::min<int64_t>(batch, at::get_max_threads());
   }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
-    } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
-    }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  int64_t chunk_size = divup(batch, num_chunks);
+  num_chunks = divup(batch, chunk_size);
+  int64_t last_chunk_size = batch - (num_chunks - 1) * chunk_size;
+
+  MklFFTParams params;
+  setMklFFTParams(&params, input, output, signal_ndim, complex_input, complex_output,
+                  inverse, checked_signal_sizes, normalized, prec);
+  params.single_threaded_ = num_chunks > 1;
+  params.batch_ = chunk_size;
+  auto plan = mkl_fft_plan_cache().get(params);
+  auto last_plan = plan;
+  if (last_chunk_size != chunk_size) {
+    params.batch_ = last_chunk_size;
+    last_plan = mkl_fft_plan_cache().get(params);
   }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+
   // run
-  if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
-  } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
-  }
+  char* input_data = static_cast<char*>(input.data_ptr());
+  char* output_data = static_cast<char*>(output.data_ptr());
+  int64_t element_size = input.type().elementSizeInBytes();
+  int64_t input_chunk_bytes = chunk_size * input.stride(0) * element_size;
+  int64_t output_chunk_bytes = chunk_size * output.stride(0) * element_size;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      DFTI_DESCRIPTOR* descriptor = (chunk == num_chunks - 1 ? last_plan : plan)->get();
+      void* chunk_input = input_data + chunk * input_chunk_bytes;
+      void* chunk_output = output_data + chunk * output_chunk_bytes;
+      if (!inverse) {
+        MKL_DFTI_CHECK(DftiComputeForward(descriptor, chunk_input, chunk_output));
+      } else {
+        MKL_DFTI_CHECK(DftiComputeBackward(descriptor, chunk_input, chunk_output));
+      }
+    }
+  });
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
     auto size_last_signal_dim = checked_signal_sizes[signal_ndim - 1];
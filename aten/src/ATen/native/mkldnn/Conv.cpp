@@ -1,11 +1,20 @@
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/Config.h>
+#include <ATen/mkldnn/ConvPrimitiveCache.h>
 
 #if !AT_MKLDNN_ENABLED()
 
 namespace at { namespace native {
 
+ConvPrimitiveCacheStats mkldnnConvPrimitiveCacheStats() {
+  return ConvPrimitiveCacheStats{0, 0, 0, 0};
+}
+
+void setMkldnnConvPrimitiveCacheCapacity(size_t capacity) {}
+
+void clearMkldnnConvPrimitiveCache() {}
+
 at::Tensor mkldnn_convolution(
     const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
     IntList padding, IntList stride, IntList dilation, int64_t groups) {
@@ -34,7 +43,16 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
 
 #else // AT_MKLDNN_EBABLED
 
+#include <ATen/CPUGeneral.h>
 #include <ATen/mkldnn/Runtime.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 using namespace mkldnn;
 
@@ -66,13 +84,200 @@ static std::vector<int64_t> conv_output_size(
   return output_size;
 }
 
-at::Tensor mkldnn_convolution(
-    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
-    IntList padding, IntList stride, IntList dilation, int64_t groups)
+// ---------------------------------------------------------------------
+//
+// Primitive cache
+//
+// ---------------------------------------------------------------------
+
+// Creating the primitive descriptors of a convolution makes MKL-DNN pick an
+// implementation and the blocked layouts it runs in, which costs more than
+// running it on small inputs. The primitives, the reorders around them and
+// the buffers they keep the blocked tensors in are thus created once per
+// shape, and the NCHW memories at their ends are pointed to the tensors of
+// each call. The implementation MKL-DNN picks also depends on the number of
+// threads it runs with, which is part of the key.
+struct ConvolutionParams
 {
-  auto output = at::empty(conv_output_size(
-    input.sizes(), weight.sizes(), padding, stride, dilation, groups), input.options());
+  int32_t input_size[2 + max_dim];
+  int32_t weight_size[2 + max_dim];
+  int32_t padding[max_dim];
+  int32_t stride[max_dim];
+  int32_t dilation[max_dim];
+  int32_t groups;
+  int32_t num_threads;
+  ScalarType dtype;
+  bool bias_defined;
+};
+
+static ConvolutionParams conv_params(
+    const Tensor& t, IntList input_size, IntList weight_size,
+    IntList padding, IntList stride, IntList dilation, int64_t groups,
+    bool bias_defined)
+{
+  ConvolutionParams params;
+  // ParamsHash and ParamsEqual read the padding bytes too
+  memset(&params, 0, sizeof(params));
+  for (size_t i = 0; i < input_size.size(); ++i) {
+    params.input_size[i] = input_size[i];
+    params.weight_size[i] = weight_size[i];
+  }
+  for (size_t i = 0; i < padding.size(); ++i) {
+    params.padding[i] = padding[i];
+    params.stride[i] = stride[i];
+    params.dilation[i] = dilation[i];
+  }
+  params.groups = groups;
+  params.num_threads = at::get_num_threads();
+  params.dtype = t.type().scalarType();
+  params.bias_defined = bias_defined;
+  return params;
+}
+
+struct ConvolutionNet
+{
+  std::vector<primitive> net;
+  // the memories of the tensors passed in and out, in the order of the
+  // data pointers given to run()
+  std::vector<memory> usr_memories;
+  // held while the net runs, as it writes its buffers
+  std::mutex mutex;
+
+  void run(std::initializer_list<void*> data) {
+    AT_ASSERT(data.size() == usr_memories.size());
+    auto usr_memory = usr_memories.begin();
+    for (void* ptr : data) {
+      (usr_memory++)->set_data_handle(ptr);
+    }
+    Stream::Instance().get_stream().submit(net);
+  }
+};
+
+constexpr size_t default_cache_capacity = 1024;
+
+// TODO: Use something less heavy duty than a big honking mutex
+struct ConvolutionNetCache
+{
+  using Entry = std::pair<ConvolutionParams, std::shared_ptr<ConvolutionNet>>;
+
+  std::mutex mutex;
+  // most recently used first
+  std::list<Entry> entries;
+  std::unordered_map<ConvolutionParams, std::list<Entry>::iterator,
+    ParamsHash<ConvolutionParams>, ParamsEqual<ConvolutionParams>> map;
+  size_t capacity = default_cache_capacity;
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t evictions = 0;
+
+  template <typename Create>
+  std::shared_ptr<ConvolutionNet> get(const ConvolutionParams& params, const Create& create) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      auto it = map.find(params);
+      if (it != map.end()) {
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+      }
+      misses++;
+    }
+    // created without the lock, so that the other shapes don't wait for it
+    std::shared_ptr<ConvolutionNet> net = create();
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = map.find(params);
+    if (it != map.end()) {
+      // another thread created it meanwhile
+      return net;
+    }
+    entries.emplace_front(params, net);
+    map.emplace(params, entries.begin());
+    evict();
+    return net;
+  }
+
+  void set_capacity(size_t new_capacity) {
+    std::lock_guard<std::mutex> guard(mutex);
+    capacity = new_capacity;
+    evict();
+  }
 
+  void clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    map.clear();
+    entries.clear();
+  }
+
+  void add_stats(ConvPrimitiveCacheStats& stats) {
+    std::lock_guard<std::mutex> guard(mutex);
+    stats.hits += hits;
+    stats.misses += misses;
+    stats.evictions += evictions;
+    stats.size += entries.size();
+  }
+
+ private:
+  void evict() {
+    while (entries.size() > capacity) {
+      map.erase(entries.back().first);
+      entries.pop_back();
+      evictions++;
+    }
+  }
+};
+
+// Never destroyed, as the primitives could outlive the engine at exit
+static ConvolutionNetCache& forward_nets = *new ConvolutionNetCache();
+static ConvolutionNetCache& backward_input_nets = *new ConvolutionNetCache();
+static ConvolutionNetCache& backward_weights_nets = *new ConvolutionNetCache();
+
+// Runs the net of params, creating it if needed. A net busy on another
+// thread is not waited for: the call runs a net of its own instead, which
+// is dropped afterwards.
+template <typename Create>
+static void run_cached(
+    ConvolutionNetCache& cache, const ConvolutionParams& params,
+    const Create& create, std::initializer_list<void*> data)
+{
+  auto net = cache.get(params, create);
+  std::unique_lock<std::mutex> lock(net->mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    create()->run(data);
+    return;
+  }
+  net->run(data);
+}
+
+ConvPrimitiveCacheStats mkldnnConvPrimitiveCacheStats() {
+  ConvPrimitiveCacheStats stats = {0, 0, 0, 0};
+  forward_nets.add_stats(stats);
+  backward_input_nets.add_stats(stats);
+  backward_weights_nets.add_stats(stats);
+  return stats;
+}
+
+void setMkldnnConvPrimitiveCacheCapacity(size_t capacity) {
+  forward_nets.set_capacity(capacity);
+  backward_input_nets.set_capacity(capacity);
+  backward_weights_nets.set_capacity(capacity);
+}
+
+void clearMkldnnConvPrimitiveCache() {
+  forward_nets.clear();
+  backward_input_nets.clear();
+  backward_weights_nets.clear();
+}
+
+// ---------------------------------------------------------------------
+//
+// Convolution
+//
+// ---------------------------------------------------------------------
+
+static std::unique_ptr<ConvolutionNet> create_forward_net(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const at::Tensor& output, IntList padding, IntList stride, int64_t groups)
+{
   auto cpu_engine = CpuEngine::Instance().get_engine();
 
   int32_t g = groups;
@@ -134,7 +339,8 @@ at::Tensor mkldnn_convolution(
   auto output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
     output.data_ptr());
 
-  std::vector<primitive> net;
+  std::unique_ptr<ConvolutionNet> conv_net(new ConvolutionNet());
+  auto& net = conv_net->net;
 
   auto input_pd = conv_forward_pd->src_primitive_desc();
   auto input_memory = input_usr_memory;
@@ -156,13 +362,15 @@ at::Tensor mkldnn_convolution(
     output_memory = memory(output_pd);
   }
 
+  conv_net->usr_memories = {input_usr_memory, weight_usr_memory, output_usr_memory};
+
   std::shared_ptr<convolution_forward> conv_forward;
-  std::shared_ptr<memory> bias_usr_memory;
   if (bias.defined()) {
-    bias_usr_memory.reset(new memory({{{bias_tz}, data_t, format_x}, cpu_engine},
-      bias.data_ptr()));
+    auto bias_usr_memory = memory({{{bias_tz}, data_t, format_x}, cpu_engine},
+      bias.data_ptr());
+    conv_net->usr_memories.push_back(bias_usr_memory);
     conv_forward.reset(new convolution_forward(*conv_forward_pd, input_memory,
-      weight_memory, *bias_usr_memory, output_memory));
+      weight_memory, bias_usr_memory, output_memory));
   } else {
     conv_forward.reset(new convolution_forward(*conv_forward_pd, input_memory,
       weight_memory, output_memory));
@@ -173,17 +381,36 @@ at::Tensor mkldnn_convolution(
     net.push_back(reorder(output_memory, output_usr_memory));
   }
 
-  Stream::Instance().get_stream().submit(net);
+  return conv_net;
+}
+
+at::Tensor mkldnn_convolution(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntList padding, IntList stride, IntList dilation, int64_t groups)
+{
+  auto output = at::empty(conv_output_size(
+    input.sizes(), weight.sizes(), padding, stride, dilation, groups), input.options());
+
+  auto params = conv_params(input,
+    input.sizes(), weight.sizes(), padding, stride, dilation, groups, bias.defined());
+  auto create = [&] {
+    return create_forward_net(input, weight, bias, output, padding, stride, groups);
+  };
+  if (bias.defined()) {
+    run_cached(forward_nets, params, create,
+      {input.data_ptr(), weight.data_ptr(), output.data_ptr(), bias.data_ptr()});
+  } else {
+    run_cached(forward_nets, params, create,
+      {input.data_ptr(), weight.data_ptr(), output.data_ptr()});
+  }
 
   return output;
 }
 
-Tensor mkldnn_convolution_backward_input(
-    IntList input_size, const at::Tensor& grad_output, const at::Tensor& weight,
-    IntList padding, IntList stride, IntList dilation, int64_t groups, bool bias_defined)
+static std::unique_ptr<ConvolutionNet> create_backward_input_net(
+    const at::Tensor& grad_input, const at::Tensor& grad_output, const at::Tensor& weight,
+    IntList padding, IntList stride, int64_t groups, bool bias_defined)
 {
-  auto grad_input = at::empty(input_size, grad_output.options());
-
   auto cpu_engine = CpuEngine::Instance().get_engine();
 
   int32_t g = groups;
@@ -254,7 +481,8 @@ Tensor mkldnn_convolution_backward_input(
   auto grad_input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
     grad_input.data_ptr());
 
-  std::vector<primitive> net;
+  std::unique_ptr<ConvolutionNet> conv_net(new ConvolutionNet());
+  auto& net = conv_net->net;
 
   auto grad_output_pd = conv_backward_data_pd->diff_dst_primitive_desc();
   auto grad_output_memory = grad_output_usr_memory;
@@ -285,22 +513,34 @@ Tensor mkldnn_convolution_backward_input(
     net.push_back(reorder(grad_input_memory, grad_input_usr_memory));
   }
 
-  Stream::Instance().get_stream().submit(net);
+  conv_net->usr_memories = {grad_output_usr_memory, weight_usr_memory, grad_input_usr_memory};
 
-  return grad_input;
+  return conv_net;
 }
 
-std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
-    IntList weight_size, const at::Tensor& grad_output, const at::Tensor& input,
+Tensor mkldnn_convolution_backward_input(
+    IntList input_size, const at::Tensor& grad_output, const at::Tensor& weight,
     IntList padding, IntList stride, IntList dilation, int64_t groups, bool bias_defined)
 {
-  auto grad_weight = at::empty(weight_size, grad_output.options());
+  auto grad_input = at::empty(input_size, grad_output.options());
 
-  Tensor grad_bias;
-  if (bias_defined) {
-    grad_bias = at::empty({grad_output.size(1)}, grad_output.options());
-  }
+  auto params = conv_params(grad_output,
+    input_size, weight.sizes(), padding, stride, dilation, groups, bias_defined);
+  auto create = [&] {
+    return create_backward_input_net(
+      grad_input, grad_output, weight, padding, stride, groups, bias_defined);
+  };
+  run_cached(backward_input_nets, params, create,
+    {grad_output.data_ptr(), weight.data_ptr(), grad_input.data_ptr()});
+
+  return grad_input;
+}
 
+static std::unique_ptr<ConvolutionNet> create_backward_weights_net(
+    const at::Tensor& grad_weight, const at::Tensor& grad_bias,
+    const at::Tensor& grad_output, const at::Tensor& input,
+    IntList padding, IntList stride, int64_t groups, bool bias_defined)
+{
   auto cpu_engine = CpuEngine::Instance().get_engine();
 
   int32_t g = groups;
@@ -377,9 +617,9 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
     grad_output.data_ptr());
   auto grad_weight_usr_memory = memory({{{weight_tz}, data_t, format_weight}, cpu_engine},
     grad_weight.data_ptr());
-  std::shared_ptr<memory> grad_bias_memory;
 
-  std::vector<primitive> net;
+  std::unique_ptr<ConvolutionNet> conv_net(new ConvolutionNet());
+  auto& net = conv_net->net;
 
   auto input_pd = conv_backward_weight_pd->src_primitive_desc();
   auto input_memory = input_usr_memory;
@@ -401,12 +641,15 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
     grad_weight_memory = memory(grad_weight_pd);
   }
 
+  conv_net->usr_memories = {input_usr_memory, grad_output_usr_memory, grad_weight_usr_memory};
+
   std::shared_ptr<convolution_backward_weights> conv_backward_weight;
   if (bias_defined) {
-    grad_bias_memory.reset(new memory({{{bias_tz}, data_t, format_x}, cpu_engine},
-      grad_bias.data_ptr()));
+    auto grad_bias_usr_memory = memory({{{bias_tz}, data_t, format_x}, cpu_engine},
+      grad_bias.data_ptr());
+    conv_net->usr_memories.push_back(grad_bias_usr_memory);
     conv_backward_weight.reset(new convolution_backward_weights(*conv_backward_weight_pd,
-      input_memory, grad_output_memory, grad_weight_memory, *grad_bias_memory));
+      input_memory, grad_output_memory, grad_weight_memory, grad_bias_usr_memory));
   } else {
     conv_backward_weight.reset(new convolution_backward_weights(*conv_backward_weight_pd,
       input_memory, grad_output_memory, grad_weight_memory));
@@ -418,7 +661,33 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
     net.push_back(reorder(grad_weight_memory, grad_weight_usr_memory));
   }
 
-  Stream::Instance().get_stream().submit(net);
+  return conv_net;
+}
+
+std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
+    IntList weight_size, const at::Tensor& grad_output, const at::Tensor& input,
+    IntList padding, IntList stride, IntList dilation, int64_t groups, bool bias_defined)
+{
+  auto grad_weight = at::empty(weight_size, grad_output.options());
+
+  Tensor grad_bias;
+  if (bias_defined) {
+    grad_bias = at::empty({grad_output.size(1)}, grad_output.options());
+  }
+
+  auto params = conv_params(input,
+    input.sizes(), weight_size, padding, stride, dilation, groups, bias_defined);
+  auto create = [&] {
+    return create_backward_weights_net(
+      grad_weight, grad_bias, grad_output, input, padding, stride, groups, bias_defined);
+  };
+  if (bias_defined) {
+    run_cached(backward_weights_nets, params, create,
+      {input.data_ptr(), grad_output.data_ptr(), grad_weight.data_ptr(), grad_bias.data_ptr()});
+  } else {
+    run_cached(backward_weights_nets, params, create,
+      {input.data_ptr(), grad_output.data_ptr(), grad_weight.data_ptr()});
+  }
 
   return std::tuple<at::Tensor, at::Tensor>{grad_weight, grad_bias};
 }
@@ -5,10 +5,15 @@
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/InitialTensorOptions.h>
+#include <ATen/Parallel.h>
 #include <ATen/SparseTensorUtils.h>
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -50,6 +55,11 @@ Tensor &_coalesced_sparse_(SparseTensor& self, bool coalesced) {
   return self;
 }
 
+Tensor &_unique_indices_sparse_(SparseTensor& self, bool unique_indices) {
+  get_sparse_impl(self)->set_unique_indices(unique_indices);
+  return self;
+}
+
 Tensor indices_sparse(const Tensor& self) {
   AT_CHECK(self.is_coalesced(),
            "Cannot get indices on an uncoalesced tensor, please call .coalesce() first");
@@ -251,6 +261,7 @@ Tensor _sparse_coo_tensor_unsafe(const Tensor& indices, const Tensor& values_, A
 SparseTensor clone_sparse(const SparseTensor& self) {
   SparseTensor other = new_with_dims_sparse(self.sparse_dim(), self.dense_dim(), self.sizes(), self.options());
   copy_into_sparse(other, self._indices(), self._values(), true);
+  get_sparse_impl(other)->set_unique_indices(get_sparse_impl(self)->unique_indices());
   return other._coalesced_(self.is_coalesced());
 }
 
@@ -324,9 +335,84 @@ SparseTensor& copy_sparse_(SparseTensor& self, const SparseTensor& src, bool non
   if (is_same_tensor(self, src)) return self;
   get_sparse_impl(self)->resize_(src.sparse_dim(), src.dense_dim(), src.sizes());
   copy_into_sparse(self, src._indices(), src._values(), non_blocking);
+  get_sparse_impl(self)->set_unique_indices(get_sparse_impl(src)->unique_indices());
   return self._coalesced_(src.is_coalesced());
 }
 
+namespace {
+
+// The keys of coalesce are split in chunks of at least this many for the
+// threads, fewer than that being faster to sort and merge on one thread
+constexpr int64_t kCoalesceChunkSize = 1 << 15;
+constexpr int kRadixBits = 8;
+constexpr int64_t kRadix = 1 << kRadixBits;
+
+// Splits [0, n) into the chunks of at most one per thread
+std::vector<int64_t> coalesce_chunk_bounds(int64_t n) {
+  int64_t num_chunks = std::max<int64_t>(1, std::min<int64_t>(get_max_threads(), n / kCoalesceChunkSize));
+  std::vector<int64_t> bounds(num_chunks + 1);
+  for (int64_t c = 0; c <= num_chunks; c++) {
+    bounds[c] = n * c / num_chunks;
+  }
+  return bounds;
+}
+
+// Sorts the keys, and the positions of the entries they come from along with
+// them, by a stable least significant digit radix sort. Each pass counts the
+// digits of every chunk of keys in parallel, and then moves each chunk to the
+// offsets given by the counts of the chunks before it. The passes over
+// digits that all the keys share are skipped.
+void radix_sort_keys(std::vector<int64_t>& keys, std::vector<int64_t>& positions, int64_t max_key) {
+  const int64_t n = keys.size();
+  const auto bounds = coalesce_chunk_bounds(n);
+  const int64_t num_chunks = bounds.size() - 1;
+  std::vector<int64_t> keys_out(n);
+  std::vector<int64_t> positions_out(n);
+  std::vector<int64_t> offsets(num_chunks * kRadix);
+  for (int shift = 0; shift < 64 && (max_key >> shift) != 0; shift += kRadixBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* counts = &offsets[c * kRadix];
+        for (int64_t j = bounds[c]; j < bounds[c + 1]; j++) {
+          counts[(keys[j] >> shift) & (kRadix - 1)]++;
+        }
+      }
+    });
+    // the counts are turned into offsets in digit major, chunk minor order,
+    // which keeps the sort stable
+    int64_t offset = 0;
+    bool single_digit = false;
+    for (int64_t d = 0; d < kRadix; d++) {
+      int64_t digit_count = 0;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * kRadix + d];
+        offsets[c * kRadix + d] = offset;
+        offset += count;
+        digit_count += count;
+      }
+      single_digit = single_digit || digit_count == n;
+    }
+    if (single_digit) {
+      continue;
+    }
+    parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* chunk_offsets = &offsets[c * kRadix];
+        for (int64_t j = bounds[c]; j < bounds[c + 1]; j++) {
+          int64_t dst = chunk_offsets[(keys[j] >> shift) & (kRadix - 1)]++;
+          keys_out[dst] = keys[j];
+          positions_out[dst] = positions[j];
+        }
+      }
+    });
+    keys.swap(keys_out);
+    positions.swap(positions_out);
+  }
+}
+
+} // namespace
+
 SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   AT_ASSERT(self.defined());
   AT_ASSERT(!self.is_variable());
@@ -348,54 +434,99 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   int64_t sparse_dim = self.sparse_dim();
   int64_t dense_dim = self.dense_dim();
   int64_t nnz = self._nnz();
-
-  LongTensor indices_scalar = flatten_indices(indices, self.sizes());
+  bool unique_indices = get_sparse_impl(self)->unique_indices();
+
+  LongTensor indices_scalar = flatten_indices(indices, self.sizes()).contiguous();
+  std::vector<int64_t> keys(indices_scalar.data<int64_t>(), indices_scalar.data<int64_t>() + nnz);
+  std::vector<int64_t> positions(nnz);
+  std::iota(positions.begin(), positions.end(), 0);
+
+  // Entries that are already in order, as produced by many ops, don't need to
+  // be sorted. The keys are within [0, numel of the sparse dims).
+  bool sorted = true;
+  int64_t max_key = 0;
+  for (int64_t j = 0; j < nnz; j++) {
+    sorted = sorted && (j == 0 || keys[j - 1] <= keys[j]);
+    max_key = std::max(max_key, keys[j]);
+  }
+  if (!sorted) {
+    radix_sort_keys(keys, positions, max_key);
+  }
 
   SparseTensor dst = new_sparse(self.options());
   get_sparse_impl(dst)->resize_(sparse_dim, dense_dim, self.sizes());
+
+  if (unique_indices) {
+    // the entries only need to be moved to their sorted order
+    LongTensor permutation = at::empty({nnz}, indices.options());
+    std::copy(positions.begin(), positions.end(), permutation.data<int64_t>());
+    alias_into_sparse(dst, indices.index_select(1, permutation), values.index_select(0, permutation));
+    return dst._coalesced_(true);
+  }
+
   // TODO: is there a more idiomatic way to do this?
   LongTensor newIndices = at::empty(indices.sizes(), indices.options());
   Tensor newValues = at::empty(values.sizes(), values.options());
   alias_into_sparse(dst, newIndices, newValues);
 
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  // The duplicates are summed in parallel, over chunks that start at a new
+  // key so that each entry of dst is written by a single thread. The entries
+  // of a chunk go after those of the chunks before it, whose number is
+  // counted first.
+  auto bounds = coalesce_chunk_bounds(nnz);
+  const int64_t num_chunks = bounds.size() - 1;
+  for (int64_t c = 1; c < num_chunks; c++) {
+    bounds[c] = std::max(bounds[c], bounds[c - 1]);
+    while (bounds[c] < nnz && keys[bounds[c]] == keys[bounds[c] - 1]) {
+      bounds[c]++;
+    }
+  }
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t unique = 0;
+      for (int64_t j = bounds[c]; j < bounds[c + 1]; j++) {
+        unique += (j == bounds[c] || keys[j] != keys[j - 1]);
+      }
+      chunk_offsets[c + 1] = unique;
+    }
+  });
+  std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
 
-  int64_t i = -1;
   AT_DISPATCH_ALL_TYPES(
       values.type(), "coalesce", [&] {
-        int64_t prev = -1;
         int64_t blockSize = values.stride(0);
         scalar_t* values_ptr = values.data<scalar_t>();
         scalar_t* newValues_ptr = newValues.data<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-            }
-          } else {
-            ++i;
-            for (int64_t d = 0; d < sparse_dim; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
-            }
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+        parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+          for (int64_t c = begin; c < end; c++) {
+            int64_t i = chunk_offsets[c] - 1;
+            for (int64_t j = bounds[c]; j < bounds[c + 1]; j++) {
+              int64_t pos = positions[j];
+              if (j != bounds[c] && keys[j] == keys[j - 1]) {
+                if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+                  THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+                }
+              } else {
+                ++i;
+                for (int64_t d = 0; d < sparse_dim; d++) {
+                  newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+                }
+                if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+                  THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+                }
+              }
             }
           }
-          prev = curr;
-        }
+        });
     });
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
+  get_sparse_impl(dst)->set_nnz_and_narrow(chunk_offsets[num_chunks]);
 
   return dst;
 }
@@ -3,10 +3,13 @@
 #include <ATen/ExpandUtils.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/InitialTensorOptions.h>
+#include <ATen/Parallel.h>
 #include <ATen/SparseTensorUtils.h>
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -36,6 +39,20 @@ namespace {
     return csr;
   }
 
+  // The compressed row indices of the coalesced matrix `sparse`, converted
+  // by the first product with it and kept for the next ones
+  LongTensor _csr_row_indices(const SparseTensor& sparse) {
+    AT_ASSERT(sparse.is_coalesced() && sparse.sparse_dim() == 2);
+    auto impl = get_sparse_impl(sparse);
+    LongTensor csr = impl->csr_indices().first;
+    if (!csr.defined()) {
+      LongTensor indices = sparse._indices();
+      csr = _to_csr(indices.data<int64_t>(), sparse.size(0), sparse._nnz());
+      impl->set_csr_indices(csr, indices.select(0, 1));
+    }
+    return csr;
+  }
+
 }
 
 // --------------------------------------------------------------------
@@ -459,11 +476,8 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // addmm(Tensor, SparseTensorRef, Tensor, Scalar, Scalar)  [broadcasts]
 // --------------------------------------------------------------------
 
-// NB: OMP pragmas have to get their own functions; can't put them in lambdas
 template <typename scalar_t>
 void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& csr, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t h, i;
-
   // r_ = alpha * sparse * dense
   scalar_t cast_alpha = alpha.to<scalar_t>();
   scalar_t cast_beta = beta.to<scalar_t>();
@@ -477,7 +491,7 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
     at::mul_out(r, t, scalar_to_tensor(beta));
   }
 
-  auto csr_accessor = csr.accessor<int64_t, 1>();
+  const int64_t* csr_ptr = csr.data<int64_t>();
   auto indices_accessor = indices.accessor<int64_t, 2>();
 
   auto values_accessor = values.accessor<scalar_t, 1>();
@@ -488,23 +502,44 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   int64_t dense_stride1 = dense.stride(1);
   int64_t r_stride0 = r.stride(0);
   int64_t r_stride1 = r.stride(1);
-#pragma omp parallel for private(h, i) schedule(static) if (nnz > 10000)
-  for (h = 0; h < dim_i; h++) {
-    int64_t i_start = csr_accessor[h];
-    int64_t i_end = csr_accessor[h+1];
-    for (i = i_start; i < i_end; i++) {
-      scalar_t val = values_accessor[i];
-      int64_t col = indices_accessor[1][i];
-      if (col >= 0 && col < dim_j) {
-        THBlas_axpy<scalar_t>(dim_k,
-            cast_alpha * val,
-            dense_ptr + col * dense_stride0, dense_stride1,
-            r_ptr + h * r_stride0, r_stride1);
-      } else {
-        AT_ERROR("addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+
+  // The nnz are split in chunks of about the same number of flops, rather
+  // than the rows, whose nnz can differ by orders of magnitude (e.g. in the
+  // adjacency matrices of graphs). A chunk computes the rows that start in
+  // its range of nnz, so that each row of r is written by a single thread.
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, dim_k));
+  parallel_for(0, nnz, grain_size, [&](int64_t begin, int64_t end) {
+    int64_t h_begin = std::lower_bound(csr_ptr, csr_ptr + dim_i, begin) - csr_ptr;
+    int64_t h_end = std::lower_bound(csr_ptr + h_begin, csr_ptr + dim_i, end) - csr_ptr;
+    for (int64_t h = h_begin; h < h_end; h++) {
+      int64_t i_start = csr_ptr[h];
+      int64_t i_end = csr_ptr[h+1];
+      if (dim_k == 1) {
+        // a sparse matrix-vector product: one dot product per row
+        scalar_t sum = 0;
+        for (int64_t i = i_start; i < i_end; i++) {
+          int64_t col = indices_accessor[1][i];
+          AT_CHECK(col >= 0 && col < dim_j,
+              "addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+          sum += values_accessor[i] * dense_ptr[col * dense_stride0];
+        }
+        r_ptr[h * r_stride0] += cast_alpha * sum;
+        continue;
+      }
+      for (int64_t i = i_start; i < i_end; i++) {
+        scalar_t val = values_accessor[i];
+        int64_t col = indices_accessor[1][i];
+        if (col >= 0 && col < dim_j) {
+          THBlas_axpy<scalar_t>(dim_k,
+              cast_alpha * val,
+              dense_ptr + col * dense_stride0, dense_stride1,
+              r_ptr + h * r_stride0, r_stride1);
+        } else {
+          AT_ERROR("addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+        }
       }
     }
-  }
+  });
 };
 
 Tensor& s_addmm_out_sparse_dense_cpu(
@@ -550,7 +585,7 @@ Tensor& s_addmm_out_sparse_dense_cpu(
 
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
-  LongTensor csr = _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  LongTensor csr = _csr_row_indices(sparse);
 
   AT_DISPATCH_ALL_TYPES(
       values.type(), "addmm_sparse_dense", [&] {
@@ -710,7 +745,7 @@ SparseTensor& _sspaddmm_out_cpu(
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
 
-  LongTensor csr = _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  LongTensor csr = _csr_row_indices(sparse);
 
   int64_t t_nnz = t._nnz();
   int64_t r_nnz = nnz * dim_k + t_nnz;
@@ -32,6 +32,24 @@ namespace {
     sparse::cuda::Xcoo2csr(rowIndicesInt.data<int32_t>(), nnz, dim, csr.data<int32_t>());
     return csr;
   }
+
+  // The int32 compressed row and column indices of the coalesced matrix
+  // `sparse` that cuSPARSE takes, converted by the first product with it and
+  // kept for the next ones
+  std::pair<IntTensor, IntTensor> _csr_indices_int(const SparseTensor& sparse) {
+    AT_ASSERT(sparse.is_coalesced() && sparse.sparse_dim() == 2);
+    auto impl = get_sparse_impl(sparse);
+    auto csr_indices = impl->csr_indices();
+    if (!csr_indices.first.defined()) {
+      LongTensor indices = sparse._indices();
+      LongTensor colIndices = indices.select(0, 1);
+      csr_indices.first = _to_csr_int(indices.select(0, 0), sparse.size(0), sparse._nnz());
+      csr_indices.second = at::empty({colIndices.size(0)}, indices.options().dtype(kInt));
+      csr_indices.second.copy_(colIndices);
+      impl->set_csr_indices(csr_indices.first, csr_indices.second);
+    }
+    return csr_indices;
+  }
 }
 
 // NB: Deleted spaddcmul (aka addcmul_, but not actually wired up), spaddcdiv (not
@@ -70,14 +88,10 @@ Tensor& s_addmm_out_sparse_dense_cuda(Tensor& r_, const Tensor& t, const SparseT
   SparseTensor sparse = sparse_.coalesce();
 
   int64_t nnz = sparse._nnz();
-  LongTensor indices = sparse._indices();
   Tensor values = sparse._values();
 
-  LongTensor rowIndices = indices.select(0, 0);
-  LongTensor colIndices = indices.select(0, 1);
-  IntTensor csr = _to_csr_int(rowIndices, m, nnz);
-  IntTensor colIndicesInt = at::empty({colIndices.size(0)}, indices.options().dtype(kInt));
-  colIndicesInt.copy_(colIndices);
+  IntTensor csr, colIndicesInt;
+  std::tie(csr, colIndicesInt) = _csr_indices_int(sparse);
 
   // No half support, so we don't have to use CUDATypeConversion
   Tensor r__;
@@ -137,6 +137,41 @@ def has_sparse_dispatches(dispatches):
     return False
 
 
+def derive_out_declaration(declaration, declarations_by_name):
+    # Declares name_out(Tensor out, ...) for a function marked with
+    # out_from_inplace: True, implemented by copying self into out and
+    # running the in-place variant name_ on it (see the README).
+    name = declaration['name']
+    inplace_name = name + '_'
+    inplace = declarations_by_name.get(inplace_name)
+    if inplace is None:
+        raise RuntimeError("{} is declared with out_from_inplace, but {} doesn't exist".format(name, inplace_name))
+    if name + '_out' in declarations_by_name:
+        raise RuntimeError("{} is declared with out_from_inplace, but already has an _out variant".format(name))
+    arguments = declaration['arguments']
+    if (len(declaration['return']) != 1 or declaration['return'][0]['type'] != 'Tensor' or
+            not arguments or arguments[0]['name'] != 'self' or arguments[0]['type'] != 'Tensor'):
+        raise RuntimeError("out_from_inplace requires {} to take Tensor self first and to return "
+                           "a single Tensor".format(name))
+    if [(a['type'], a['name']) for a in arguments] != [(a['type'], a['name']) for a in inplace['arguments']]:
+        raise RuntimeError("out_from_inplace requires {} and {} to take the same arguments".format(
+            name, inplace_name))
+    out = {'type': 'Tensor', 'name': 'out', 'is_nullable': False, 'output': True}
+    derived = dict(declaration)
+    derived['name'] = name + '_out'
+    derived['inplace'] = False
+    derived['variants'] = ['function']
+    derived['arguments'] = [out] + [dict(a) for a in arguments]
+    derived['return'] = [out]
+    derived['type_method_definition_dispatch'] = derived['name']
+    derived['aten_sparse'] = False
+    derived['out_from_inplace'] = {
+        'name': inplace_name,
+        'method': 'method' in inplace['variants'],
+    }
+    return derived
+
+
 def parse_native_yaml(path):
     with open(path, 'r') as f:
         return yaml.load(f, Loader=Loader)
@@ -144,6 +179,7 @@ def parse_native_yaml(path):
 
 def run(paths):
     declarations = []
+    out_from_inplace = []
     for path in paths:
         for func in parse_native_yaml(path):
             declaration = {'mode': 'native'}
@@ -163,6 +199,7 @@ def run(paths):
                 declaration['variants'] = func.get('variants', ['function'])
                 declaration['requires_tensor'] = func.get('requires_tensor', False)
                 declaration['cpu_half'] = func.get('cpu_half', False)
+                declaration['cpu_bfloat16'] = func.get('cpu_bfloat16', False)
                 declaration['deprecated'] = func.get('deprecated', False)
                 declaration['device_guard'] = func.get('device_guard', True)
                 declaration['arguments'] = func.get('arguments', arguments)
@@ -171,6 +208,8 @@ def run(paths):
                 declaration['aten_sparse'] = has_sparse_dispatches(
                     declaration['type_method_definition_dispatch'])
                 declarations.append(declaration)
+                if func.get('out_from_inplace', False):
+                    out_from_inplace.append(declaration)
             except Exception as e:
                 msg = '''Exception raised in processing function:
 {func}
@@ -179,4 +218,7 @@ Generated partial declaration:
                 print(msg, file=sys.stderr)
                 raise e
 
+    declarations_by_name = {d['name']: d for d in declarations}
+    for declaration in out_from_inplace:
+        declarations.append(derive_out_declaration(declaration, declarations_by_name))
     return declarations
@@ -8,6 +8,7 @@ type_map = {
         'Float',
         'Double',
         'Half',
+        'BFloat16',
     ],
     'integral': [
         'Byte',
@@ -65,6 +66,14 @@ def process_types_and_backends(option):
     if not option.get('cpu_half', False):
         pairs.discard(('CPU', 'Half'))
 
+    # BFloat16 only exists for cpu, where it has no TH implementation: it is
+    # only enabled explicitly, for native functions
+    pairs.discard(('CUDA', 'BFloat16'))
+    pairs.discard(('SparseCPU', 'BFloat16'))
+    pairs.discard(('SparseCUDA', 'BFloat16'))
+    if not option.get('cpu_bfloat16', False):
+        pairs.discard(('CPU', 'BFloat16'))
+
     # sort the result for easy reading
     option['backend_type_pairs'] = sorted([p for p in pairs])
 
@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 
 #include "ATen/ATen.h"
+#include "ATen/cuda/CUDAContext.h"
+#include "ATen/cuda/CUDAGuard.h"
 #include "ATen/cudnn/Descriptors.h"
 #include "ATen/cudnn/Handle.h"
 #include "test_seed.h"
@@ -25,3 +27,21 @@ TEST(CUDNNTest, CUDNNTestCUDA) {
   ASSERT_TRUE(isEQ);
 #endif
 }
+
+TEST(CUDNNTest, CUDNNHandlePerStreamTestCUDA) {
+  const auto stream0 = at::cuda::getStreamFromPool();
+  const auto stream1 = at::cuda::getStreamFromPool();
+  const auto device = stream0.device_index();
+
+  const auto handle0 = getCudnnHandle(device, stream0.stream());
+  ASSERT_TRUE(getCudnnHandle(device, stream0.stream()) == handle0);
+  ASSERT_FALSE(getCudnnHandle(device, stream1.stream()) == handle0);
+  {
+    at::cuda::CUDAStreamGuard guard(stream0);
+    ASSERT_TRUE(getCudnnHandle() == handle0);
+  }
+
+  cudaStream_t bound_stream;
+  ASSERT_TRUE(cudnnGetStream(handle0, &bound_stream) == CUDNN_STATUS_SUCCESS);
+  ASSERT_TRUE(bound_stream == stream0.stream());
+}
@@ -19,3 +19,15 @@ TEST(TestDlconvertor, TestDlconvertor) {
 
   ASSERT_TRUE(a.equal(b));
 }
+
+TEST(TestDlconvertor, TestDlconvertorStreamIgnoredOnCPU) {
+  manual_seed(123, at::kCPU);
+
+  Tensor a = rand({3, 4});
+  DLManagedTensor* dlMTensor = toDLPack(a, nullptr);
+
+  Tensor b = fromDLPack(dlMTensor, nullptr);
+
+  ASSERT_TRUE(a.equal(b));
+  ASSERT_EQ(a.data_ptr(), b.data_ptr());
+}
@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+
+#include "ATen/ATen.h"
+#include "ATen/mkldnn/ConvPrimitiveCache.h"
+#include "test_seed.h"
+
+using namespace at;
+using namespace at::native;
+
+static Tensor conv(const Tensor& input, const Tensor& weight, const Tensor& bias) {
+  return at::mkldnn_convolution(input, weight, bias, {1, 1}, {1, 1}, {1, 1}, 1);
+}
+
+TEST(MKLDNNTest, ConvPrimitiveCache) {
+  manual_seed(123, at::kCPU);
+  clearMkldnnConvPrimitiveCache();
+  setMkldnnConvPrimitiveCacheCapacity(1024);
+
+  auto weight = at::randn({8, 4, 3, 3});
+  auto bias = at::randn({8});
+  auto input = at::randn({2, 4, 10, 10});
+  auto expected = at::thnn_conv2d(input, weight, {3, 3}, bias, {1, 1}, {1, 1});
+
+  auto before = mkldnnConvPrimitiveCacheStats();
+  ASSERT_TRUE(conv(input, weight, bias).allclose(expected, 1e-4, 1e-4));
+
+  // the cached primitives run on the tensors of each call
+  auto other = at::randn({2, 4, 10, 10});
+  ASSERT_TRUE(conv(other, weight, bias).allclose(
+      at::thnn_conv2d(other, weight, {3, 3}, bias, {1, 1}, {1, 1}), 1e-4, 1e-4));
+  auto after = mkldnnConvPrimitiveCacheStats();
+  ASSERT_EQ(after.misses - before.misses, 1);
+  ASSERT_EQ(after.hits - before.hits, 1);
+  ASSERT_EQ(after.size, 1);
+
+  // a new shape is a miss, and evicts the least recently used with capacity 1
+  setMkldnnConvPrimitiveCacheCapacity(1);
+  conv(at::randn({1, 4, 10, 10}), weight, bias);
+  auto evicted = mkldnnConvPrimitiveCacheStats();
+  ASSERT_EQ(evicted.misses - after.misses, 1);
+  ASSERT_EQ(evicted.evictions - after.evictions, 1);
+  ASSERT_EQ(evicted.size, 1);
+
+  clearMkldnnConvPrimitiveCache();
+  ASSERT_EQ(mkldnnConvPrimitiveCacheStats().size, 0);
+  setMkldnnConvPrimitiveCacheCapacity(1024);
+}
@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+
+#include "ATen/native/Philox.h"
+
+#include <cstdint>
+#include <vector>
+
+using at::native::Philox4x32;
+
+TEST(PhiloxTest, KnownAnswer) {
+  // from the known answer tests of Random123
+  Philox4x32 philox(/*seed=*/0);
+  ASSERT_EQ(philox(), 0x6627e8d5u);
+  ASSERT_EQ(philox(), 0xe169c58du);
+  ASSERT_EQ(philox(), 0xbc57ac4cu);
+  ASSERT_EQ(philox(), 0x9b00dbd8u);
+}
+
+TEST(PhiloxTest, OffsetAndSkip) {
+  Philox4x32 philox(/*seed=*/42);
+  std::vector<uint32_t> stream;
+  for (int i = 0; i < 40; i++) {
+    stream.push_back(philox());
+  }
+  for (int offset = 0; offset < 20; offset++) {
+    for (int drawn = 0; drawn < 10; drawn++) {
+      Philox4x32 at_offset(42, offset);
+      Philox4x32 skipped_after(42);
+      for (int i = 0; i < drawn; i++) {
+        at_offset();
+        skipped_after();
+      }
+      skipped_after.skip(offset);
+      ASSERT_EQ(at_offset(), stream[offset + drawn]);
+      ASSERT_EQ(skipped_after(), stream[offset + drawn]);
+    }
+  }
+  // another subsequence is another stream
+  Philox4x32 other(/*seed=*/42, /*offset=*/0, /*subsequence=*/1);
+  ASSERT_NE(other(), stream[0]);
+}
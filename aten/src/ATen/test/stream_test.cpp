@@ -191,6 +191,55 @@ TEST(TestStream, StreamPoolTest) {
   ASSERT_TRUE(hasDuplicates);
 }
 
+// Reserved streams are skipped by the round robin until they are released
+TEST(TestStream, ReservedStreamTest) {
+  at::cuda::CUDAStream reserved = at::cuda::reserveStreamFromPool();
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_NE_CUDA(at::cuda::getStreamFromPool(), reserved);
+  }
+
+  auto stats = at::cuda::getStreamPoolStats();
+  ASSERT_EQ(stats.size(), 64);
+  int num_reserved = 0;
+  for (const auto& stream_stats : stats) {
+    if (stream_stats.is_reserved) {
+      num_reserved++;
+      ASSERT_EQ_CUDA(stream_stats.stream, reserved);
+      ASSERT_FALSE(stream_stats.is_high_priority);
+    }
+  }
+  ASSERT_EQ(num_reserved, 1);
+
+  // A thread binds its reserved stream without affecting the others
+  auto current = at::cuda::getCurrentCUDAStream();
+  std::thread thread([reserved] {
+    at::cuda::setCurrentCUDAStream(reserved);
+    ASSERT_EQ_CUDA(at::cuda::getCurrentCUDAStream(), reserved);
+  });
+  thread.join();
+  ASSERT_EQ_CUDA(at::cuda::getCurrentCUDAStream(), current);
+  reserved.synchronize();
+  ASSERT_TRUE(reserved.query());
+
+  at::cuda::releaseReservedStream(reserved);
+  ASSERT_ANY_THROW(at::cuda::releaseReservedStream(reserved));
+  bool handed_out = false;
+  for (int i = 0; i < 32; ++i) {
+    handed_out |= at::cuda::getStreamFromPool() == reserved;
+  }
+  ASSERT_TRUE(handed_out);
+
+  // One stream is always left to the round robin
+  std::vector<at::cuda::CUDAStream> streams;
+  for (int i = 0; i < 31; ++i) {
+    streams.push_back(at::cuda::reserveStreamFromPool(true));
+  }
+  ASSERT_ANY_THROW(at::cuda::reserveStreamFromPool(true));
+  for (const auto& stream : streams) {
+    at::cuda::releaseReservedStream(stream);
+  }
+}
+
 // Multi-GPU
 TEST(TestStream, MultiGPUTest) {
   if (at::cuda::getNumGPUs() < 2)
@@ -251,3 +300,33 @@ TEST(TestStream, CrossDeviceTest) {
   cudaStreamSynchronize(stream0);
   ASSERT_TRUE(event0.happened());
 }
+
+// cuBLAS handles come one per stream, bound to it
+TEST(TestStream, BlasHandlePerStreamTest) {
+  const auto stream0 = at::cuda::getStreamFromPool();
+  const auto stream1 = at::cuda::getStreamFromPool();
+  const auto device = stream0.device_index();
+  ASSERT_NE_CUDA(stream0.stream(), stream1.stream());
+
+  const auto handle0 = at::cuda::getCUDABlasHandle(device, stream0.stream());
+  ASSERT_EQ_CUDA(at::cuda::getCUDABlasHandle(device, stream0.stream()), handle0);
+  ASSERT_NE_CUDA(at::cuda::getCUDABlasHandle(device, stream1.stream()), handle0);
+
+  cudaStream_t bound_stream;
+  ASSERT_EQ_CUDA(cublasGetStream(handle0, &bound_stream), CUBLAS_STATUS_SUCCESS);
+  ASSERT_EQ_CUDA(bound_stream, stream0.stream());
+
+  {
+    at::cuda::CUDAStreamGuard guard(stream0);
+    ASSERT_EQ_CUDA(at::cuda::getCurrentCUDABlasHandle(), handle0);
+  }
+
+  // A raw stream, as the caffe2 CUDAContext creates them
+  cudaStream_t raw_stream;
+  ASSERT_EQ_CUDA(cudaStreamCreateWithFlags(&raw_stream, cudaStreamNonBlocking), cudaSuccess);
+  const auto raw_handle = at::cuda::getCUDABlasHandle(device, raw_stream);
+  ASSERT_EQ_CUDA(cublasGetStream(raw_handle, &bound_stream), CUBLAS_STATUS_SUCCESS);
+  ASSERT_EQ_CUDA(bound_stream, raw_stream);
+  at::cuda::releaseCUDABlasHandle(device, raw_stream);
+  ASSERT_EQ_CUDA(cudaStreamDestroy(raw_stream), cudaSuccess);
+}
@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "ATen/ATen.h"
+#include "ATen/native/TensorIterator.h"
+#include "test_seed.h"
+
+using namespace at;
+
+// contiguous operands of the same shape are iterated as a single dimension
+TEST(TensorIteratorTest, ContiguousFastPath) {
+  manual_seed(123, at::kCPU);
+  auto a = randn({3, 4, 5}, CPU(kFloat));
+  auto b = randn({3, 4, 5}, CPU(kFloat));
+  Tensor out;
+  auto iter = TensorIterator::binary_op(out, a, b);
+  ASSERT_EQ(iter->ndim(), 1);
+  ASSERT_EQ(iter->numel(), 60);
+  ASSERT_TRUE(iter->output().sizes().equals({3, 4, 5}));
+  ASSERT_TRUE(iter->output().is_contiguous());
+  for (int arg = 0; arg < iter->ntensors(); arg++) {
+    ASSERT_TRUE(iter->strides(arg).equals({sizeof(float)}));
+  }
+  ASSERT_TRUE((a + b).equal(a.add(b.clone())));
+}
+
+// a zero-dim operand is broadcast with a zero stride
+TEST(TensorIteratorTest, ScalarFastPath) {
+  manual_seed(123, at::kCPU);
+  auto a = randn({3, 4}, CPU(kFloat));
+  auto s = ones({}, CPU(kDouble));
+  Tensor out;
+  auto iter = TensorIterator::binary_op(out, a, s);
+  ASSERT_EQ(iter->ndim(), 1);
+  ASSERT_TRUE(iter->strides(2).equals({0}));
+  ASSERT_TRUE(iter->is_scalar(2));
+  ASSERT_EQ(iter->dtype(0), kFloat);
+  ASSERT_TRUE((a + 1).equal(a + ones({3, 4}, CPU(kFloat))));
+  ASSERT_TRUE((2 * a).equal(a + a));
+}
+
+// broadcasting, non-contiguous operands and resized outputs take the
+// general path and give the same results
+TEST(TensorIteratorTest, GeneralPath) {
+  manual_seed(123, at::kCPU);
+  auto a = randn({4, 3}, CPU(kFloat));
+  auto t = a.t();
+  auto b = randn({3, 4}, CPU(kFloat));
+  ASSERT_TRUE((t + b).equal(t.contiguous() + b));
+
+  auto row = randn({4}, CPU(kFloat));
+  ASSERT_TRUE((b + row).equal(b + row.expand({3, 4}).contiguous()));
+
+  auto out = empty({0}, CPU(kFloat));
+  add_out(out, b, b);
+  ASSERT_TRUE(out.sizes().equals({3, 4}));
+  ASSERT_TRUE(out.equal(b * 2));
+
+  auto in_place = b.clone();
+  in_place.add_(b);
+  ASSERT_TRUE(in_place.equal(b * 2));
+}
@@ -4,7 +4,10 @@
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
 
+#include <atomic>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <string.h>
 #include <sstream>
 #include "test_seed.h"
@@ -52,3 +55,65 @@ TEST(TestParallel, Exceptions) {
     }),
     std::runtime_error);
 }
+
+TEST(TestParallel, NestedCoverage) {
+  // every index must be visited exactly once, also when chunks are claimed
+  // dynamically and the inner loop runs on the same pool as the outer one
+  std::vector<std::atomic<int>> visits(1 << 16);
+  at::parallel_for(0, visits.size(), 1024, [&](int64_t begin, int64_t end) {
+    at::parallel_for(begin, end, 16, [&](int64_t b, int64_t e) {
+      for (int64_t i = b; i < e; i++) {
+        visits[i]++;
+      }
+    });
+  });
+  for (auto& v : visits) {
+    ASSERT_EQ(v.load(), 1);
+  }
+}
+
+TEST(TestParallel, ParallelReduce) {
+  int64_t n = 1 << 20;
+  int64_t sum = at::parallel_reduce(
+      0, n, 1000, (int64_t)0,
+      [](int64_t begin, int64_t end, int64_t ident) {
+        int64_t partial = ident;
+        for (int64_t i = begin; i < end; i++) {
+          partial += i;
+        }
+        return partial;
+      },
+      std::plus<int64_t>());
+  ASSERT_EQ(sum, n * (n - 1) / 2);
+}
+
+TEST(TestParallel, Launch) {
+  ASSERT_GT(at::get_num_interop_threads(), 0);
+  std::vector<std::future<int64_t>> results;
+  for (int64_t i = 0; i < 8; i++) {
+    auto task = std::make_shared<std::packaged_task<int64_t()>>(
+        [i]() { return at::ones({16}).sum().item<int64_t>() + i; });
+    results.push_back(task->get_future());
+    at::launch([task]() { (*task)(); });
+  }
+  for (int64_t i = 0; i < 8; i++) {
+    ASSERT_EQ(results[i].get(), 16 + i);
+  }
+}
+
+#if AT_PARALLEL_NATIVE()
+TEST(TestParallel, IntraopPoolStats) {
+  auto before = at::get_intraop_pool_stats();
+  std::atomic<int64_t> sum{0};
+  at::parallel_for(0, 1 << 16, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      sum += i;
+    }
+  });
+  ASSERT_EQ(sum.load(), (int64_t(1) << 16) * ((1 << 16) - 1) / 2);
+  auto after = at::get_intraop_pool_stats();
+  ASSERT_GE(after.tasks_run, before.tasks_run);
+  ASSERT_GE(after.busy_nanoseconds, before.busy_nanoseconds);
+  ASSERT_LE(after.tasks_stolen, after.tasks_run);
+}
+#endif
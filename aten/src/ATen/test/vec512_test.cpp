@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+
+#include "ATen/cpu/vec512/vec512.h"
+
+#include <cmath>
+#include <cstdint>
+
+using namespace at::vec512;
+
+// These tests exercise whichever Vec512 implementation the file is compiled
+// with: the emulated one by default, the AVX-512 one with -mavx512f.
+
+template <typename T>
+class Vec512Test : public ::testing::Test {};
+
+using Vec512Types = ::testing::Types<float, double, int32_t, int64_t>;
+TYPED_TEST_CASE(Vec512Test, Vec512Types);
+
+template <typename T>
+static void fill(T* values, int64_t n, T offset) {
+  for (int64_t i = 0; i < n; i++) {
+    values[i] = static_cast<T>((i % 5) * (i % 2 ? 1 : -1)) + offset;
+  }
+}
+
+TYPED_TEST(Vec512Test, LoadStore) {
+  using T = TypeParam;
+  using Vec = Vec512<T>;
+  ASSERT_EQ(Vec::size * sizeof(T), 64);
+  T a[Vec::size];
+  fill(a, Vec::size, static_cast<T>(3));
+  for (int count = 0; count <= Vec::size; count++) {
+    T out[Vec::size] = {0};
+    Vec::loadu(a, count).store(out, count);
+    for (int i = 0; i < Vec::size; i++) {
+      ASSERT_EQ(out[i], i < count ? a[i] : 0);
+    }
+  }
+}
+
+TYPED_TEST(Vec512Test, Arithmetic) {
+  using T = TypeParam;
+  using Vec = Vec512<T>;
+  T a[Vec::size], b[Vec::size], out[Vec::size];
+  fill(a, Vec::size, static_cast<T>(7));
+  fill(b, Vec::size, static_cast<T>(2));
+  auto va = Vec::loadu(a);
+  auto vb = Vec::loadu(b);
+
+  (va + vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], a[i] + b[i]);
+  (va - vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], a[i] - b[i]);
+  (va * vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], a[i] * b[i]);
+  max(va, vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], std::max(a[i], b[i]));
+  min(va, vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], std::min(a[i], b[i]));
+  vb.abs().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], b[i] < 0 ? -b[i] : b[i]);
+  vb.neg().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], -b[i]);
+
+  T sum = 0;
+  for (int i = 0; i < Vec::size; i++) sum += a[i];
+  ASSERT_EQ(reduce_add(va), sum);
+}
+
+TYPED_TEST(Vec512Test, CompareAndBlend) {
+  using T = TypeParam;
+  using Vec = Vec512<T>;
+  T a[Vec::size], b[Vec::size], out[Vec::size];
+  fill(a, Vec::size, static_cast<T>(0));
+  fill(b, Vec::size, static_cast<T>(1));
+  auto va = Vec::loadu(a);
+  auto vb = Vec::loadu(b);
+  // the bits of a comparison result are all set for true lanes
+  Vec::blendv(va, vb, va < vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], a[i] < b[i] ? b[i] : a[i]);
+  Vec::blendv(va, vb, va == vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], a[i] == b[i] ? b[i] : a[i]);
+  Vec::template blend<5>(va, vb).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], (i == 0 || i == 2) ? b[i] : a[i]);
+  Vec::set(va, vb, 3).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], i < 3 ? b[i] : a[i]);
+  Vec::arange(1, 2).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], 1 + 2 * i);
+}
+
+template <typename T>
+class Vec512FloatingTest : public ::testing::Test {};
+
+using Vec512FloatingTypes = ::testing::Types<float, double>;
+TYPED_TEST_CASE(Vec512FloatingTest, Vec512FloatingTypes);
+
+TYPED_TEST(Vec512FloatingTest, Math) {
+  using T = TypeParam;
+  using Vec = Vec512<T>;
+  T a[Vec::size], out[Vec::size];
+  for (int i = 0; i < Vec::size; i++) {
+    a[i] = static_cast<T>(0.75 * i - 4.5);
+  }
+  auto va = Vec::loadu(a);
+  va.floor().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], std::floor(a[i]));
+  va.ceil().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], std::ceil(a[i]));
+  va.trunc().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], std::trunc(a[i]));
+  va.abs().sqrt().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_NEAR(out[i], std::sqrt(std::abs(a[i])), 1e-6);
+  va.exp().store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_NEAR(out[i], std::exp(a[i]), 1e-5);
+  fmadd(va, va, Vec(1)).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_NEAR(out[i], a[i] * a[i] + 1, 1e-5);
+  (va / Vec(2)).store(out);
+  for (int i = 0; i < Vec::size; i++) ASSERT_EQ(out[i], a[i] / 2);
+}
@@ -30,8 +30,15 @@ struct THDefaultAllocator final : public at::Allocator {
 };
 
 static THDefaultAllocator th_default_allocator;
+
+static std::atomic<at::Allocator*> th_allocator{&th_default_allocator};
+
 at::Allocator* getTHDefaultAllocator() {
-  return &th_default_allocator;
+  return th_allocator.load();
+}
+
+void THSetDefaultAllocator(at::Allocator* allocator) {
+  th_allocator.store(allocator ? allocator : &th_default_allocator);
 }
 
 #if defined(_WIN32) || defined(HAVE_MMAP)
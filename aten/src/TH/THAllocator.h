@@ -27,6 +27,15 @@ typedef struct at_THAllocator THAllocator;
  */
 TH_API THAllocator* getTHDefaultAllocator(void);
 
+#ifdef __cplusplus
+/* replaces the allocator returned by getTHDefaultAllocator(); nullptr restores
+ * the malloc/free one. Memory that is already allocated keeps its deleter.
+ * caffe2's pooled CPU allocator installs itself through this when
+ * ATEN_CPU_ALLOCATOR=pooled (see caffe2/core/pooled_allocator.h).
+ */
+TH_API void THSetDefaultAllocator(THAllocator* allocator);
+#endif
+
 #ifdef __cplusplus
 // Sentinel value/type to help distinguish the file descriptor constructor from
 // the non-file descriptor constructor
@@ -1,5 +1,11 @@
 #include "THCAllocator.h"
 
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
 THCIpcDeleter::~THCIpcDeleter() {
   int prev_device;
   THCudaCheck(cudaGetDevice(&prev_device));
@@ -22,3 +28,92 @@ at::DataPtr THCIpcDeleter::makeDataPtr(void* data, int device) {
 
 THCIpcDeleter::THCIpcDeleter(void* data, int device)
     : data_(data), device_(device) {}
+
+namespace {
+
+// The key of a mapping: the device and the bytes of the handle
+using IpcMappingKey = std::pair<int, std::string>;
+
+struct IpcMapping {
+  void* data;
+  int uses;
+  // The position in IpcMappings::unused, when uses is 0
+  std::list<IpcMappingKey>::iterator unused;
+};
+
+// The number of unused mappings kept open
+constexpr size_t kMaxUnusedIpcMappings = 64;
+
+struct IpcMappings {
+  std::mutex mutex;
+  std::map<IpcMappingKey, IpcMapping> mappings;
+  // Least recently used first
+  std::list<IpcMappingKey> unused;
+};
+
+// Leaked, as storages can be freed during static destruction
+IpcMappings& ipcMappings() {
+  static IpcMappings* mappings = new IpcMappings();
+  return *mappings;
+}
+
+void closeIpcMapping(const IpcMappingKey& key, void* data) {
+  int prev_device;
+  THCudaCheck(cudaGetDevice(&prev_device));
+  THCudaCheck(cudaSetDevice(key.first));
+  THCudaCheck(cudaIpcCloseMemHandle(data));
+  THCudaCheck(cudaSetDevice(prev_device));
+}
+
+// Closes the least recently used mappings above the given number
+void trimUnusedIpcMappings(IpcMappings& state, size_t max_unused) {
+  while (state.unused.size() > max_unused) {
+    auto it = state.mappings.find(state.unused.front());
+    state.unused.pop_front();
+    closeIpcMapping(it->first, it->second.data);
+    state.mappings.erase(it);
+  }
+}
+
+void releaseIpcMapping(void* ptr) {
+  auto* key = static_cast<IpcMappingKey*>(ptr);
+  {
+    auto& state = ipcMappings();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto& mapping = state.mappings.at(*key);
+    if (--mapping.uses == 0) {
+      mapping.unused = state.unused.insert(state.unused.end(), *key);
+      trimUnusedIpcMappings(state, kMaxUnusedIpcMappings);
+    }
+  }
+  delete key;
+}
+
+} // namespace
+
+at::DataPtr THCIpcOpenMemHandle(const cudaIpcMemHandle_t& handle, int device) {
+  IpcMappingKey key(device, std::string(reinterpret_cast<const char*>(&handle), sizeof(handle)));
+  auto& state = ipcMappings();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto it = state.mappings.find(key);
+  if (it == state.mappings.end()) {
+    int prev_device;
+    THCudaCheck(cudaGetDevice(&prev_device));
+    THCudaCheck(cudaSetDevice(device));
+    void* data = nullptr;
+    THCudaCheck(cudaIpcOpenMemHandle(&data, handle, cudaIpcMemLazyEnablePeerAccess));
+    THCudaCheck(cudaSetDevice(prev_device));
+    it = state.mappings.emplace(key, IpcMapping{data, 0, state.unused.end()}).first;
+  } else if (it->second.uses == 0) {
+    state.unused.erase(it->second.unused);
+  }
+  it->second.uses++;
+  return {it->second.data, new IpcMappingKey(std::move(key)), &releaseIpcMapping,
+          at::Device(at::DeviceType::CUDA, device)};
+}
+
+void THCIpcCloseUnusedMemHandles() {
+  auto& state = ipcMappings();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  trimUnusedIpcMappings(state, 0);
+}
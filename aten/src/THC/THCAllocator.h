@@ -15,6 +15,15 @@ private:
   void* data_;
   int device_;
 };
+
+// Opens the memory of another process from its IPC handle, on the given
+// device. The storages rebuilt from the same handle share its mapping, which
+// is kept open for a while after the last of them is freed, as the caching
+// allocator of the sender tends to send the same allocations over and over.
+CAFFE2_API at::DataPtr THCIpcOpenMemHandle(const cudaIpcMemHandle_t& handle, int device);
+
+// Closes the mappings opened by THCIpcOpenMemHandle which are no longer used
+CAFFE2_API void THCIpcCloseUnusedMemHandles();
 #endif
 
 #endif
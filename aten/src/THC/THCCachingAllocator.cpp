@@ -3,14 +3,19 @@
 #include <ATen/Context.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/Exceptions.h>
+#include <c10/util/Backtrace.h>
 
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -38,6 +43,29 @@
 // ensure that the block is not reused before each recorded stream completes
 // work.
 //
+// By default all streams draw from one shared pool. A stream, or the
+// allocations of a thread, can instead be routed to a private pool (see
+// THCCachingAllocator_setStreamPool and THCCachingAllocator_setThreadPool).
+// Blocks of a private pool are only ever reused by allocations routed to the
+// same pool, so e.g. NCCL or side-stream copy buffers kept in their own pool
+// never compete with, or wait on, the compute stream's blocks.
+//
+// Long-running jobs with varying allocation sizes can fragment the cache.
+// The THC_CACHING_ALLOCATOR_CONF environment variable takes a comma separated
+// list of <option>:<value> pairs to tune the policy for such workloads:
+//
+// - max_split_size_mb: cached blocks of at least this size are never split
+//   to serve smaller requests, and requests of at least this size only reuse
+//   blocks that are at most kLargeBuffer bigger. Keeps a few big blocks from
+//   being whittled down by small tensors. Unlimited by default.
+// - roundup_power2_divisions: rounds large requests up to one of N evenly
+//   spaced size classes between consecutive powers of two (N must be a power
+//   of two), so similarly sized requests map to the same class and freed
+//   blocks are reused rather than split. Off by default (128 KiB rounding).
+// - large_segment_size_mb: large requests up to half this size are carved out
+//   of segments of this size instead of getting their own cudaMalloc, so
+//   freed neighbours coalesce back into one reusable range. Off by default.
+//
 
 namespace {
 
@@ -47,16 +75,80 @@ typedef std::set<THCStreamPtr> stream_set;
 const size_t kRoundSmall = 512;     // round up small allocs to 512 bytes
 const size_t kRoundLarge = 131072;  // round up large allocs to 128 KiB
 const size_t kSmallAlloc = 1048576; // largest "small" allocation is 1 MiB
+const size_t kLargeBuffer = 20971520; // slack allowed when reusing oversized blocks
+
+struct AllocatorConfig {
+  size_t max_split_size;           // 0: blocks of any size may be split
+  size_t roundup_power2_divisions; // 0: round large allocs to kRoundLarge
+  size_t large_segment_size;       // 0: one cudaMalloc per large alloc
+
+  AllocatorConfig() :
+      max_split_size(0), roundup_power2_divisions(0), large_segment_size(0) { }
+};
+
+static size_t parse_config_value(const std::string& key, const std::string& value)
+{
+  char* end = nullptr;
+  unsigned long long result = std::strtoull(value.c_str(), &end, 10);
+  AT_CHECK(!value.empty() && *end == '\0',
+           "THC_CACHING_ALLOCATOR_CONF: invalid value '", value, "' for ", key);
+  return static_cast<size_t>(result);
+}
+
+static AllocatorConfig parse_config(const char* env)
+{
+  AllocatorConfig config;
+  if (!env) {
+    return config;
+  }
+  std::istringstream options(env);
+  std::string option;
+  while (std::getline(options, option, ',')) {
+    if (option.empty()) {
+      continue;
+    }
+    auto colon = option.find(':');
+    AT_CHECK(colon != std::string::npos,
+             "THC_CACHING_ALLOCATOR_CONF: expected <option>:<value>, got '", option, "'");
+    std::string key = option.substr(0, colon);
+    size_t value = parse_config_value(key, option.substr(colon + 1));
+    if (key == "max_split_size_mb") {
+      AT_CHECK(value * 1048576 > kSmallAlloc,
+               "THC_CACHING_ALLOCATOR_CONF: max_split_size_mb must exceed ",
+               kSmallAlloc / 1048576, " MiB");
+      config.max_split_size = value * 1048576;
+    } else if (key == "roundup_power2_divisions") {
+      AT_CHECK((value & (value - 1)) == 0,
+               "THC_CACHING_ALLOCATOR_CONF: roundup_power2_divisions must be a power of two");
+      config.roundup_power2_divisions = value;
+    } else if (key == "large_segment_size_mb") {
+      AT_CHECK(value * 1048576 > 2 * kSmallAlloc,
+               "THC_CACHING_ALLOCATOR_CONF: large_segment_size_mb must exceed ",
+               2 * kSmallAlloc / 1048576, " MiB");
+      config.large_segment_size = value * 1048576;
+    } else {
+      AT_ERROR("THC_CACHING_ALLOCATOR_CONF: unrecognized option '", key, "'");
+    }
+  }
+  AT_CHECK(config.max_split_size == 0 || config.large_segment_size == 0 ||
+           config.large_segment_size < config.max_split_size,
+           "THC_CACHING_ALLOCATOR_CONF: large_segment_size_mb must be smaller "
+           "than max_split_size_mb, or its segments could never be split");
+  return config;
+}
 
-struct DeviceStats {
-  uint64_t   amount_allocated;      // total amount allocated in bytes
-  uint64_t   max_amount_allocated;  // max total amount allocated in bytes
-  uint64_t   amount_cached;         // total amount in cache in bytes
-  uint64_t   max_amount_cached;     // max total amount in cache in bytes
+struct DeviceStats : THCCachingAllocatorStats {
+  DeviceStats() : THCCachingAllocatorStats() { }
 
-  DeviceStats() :
-      amount_allocated(0), max_amount_allocated(0),
-      amount_cached(0), max_amount_cached(0) { }
+  void recordRequest(size_t size) {
+    int size_class = 0;
+    while (size_class < THC_CACHING_ALLOCATOR_NUM_SIZE_CLASSES - 1 &&
+           size > (kRoundSmall << size_class)) {
+      size_class++;
+    }
+    num_allocs++;
+    size_histogram[size_class]++;
+  }
 
   void increaseAllocated(size_t delta) {
     amount_allocated += delta;
@@ -79,6 +171,7 @@ struct DeviceStats {
 
 struct Block {
   int           device;      // gpu
+  uint64_t      pool_id;     // private pool, or 0 for the shared pool
   cudaStream_t  stream;      // allocation stream
   stream_set    stream_uses; // streams on which the block was used
   size_t        size;        // block size in bytes
@@ -88,16 +181,22 @@ struct Block {
   Block*        next;        // next block if split from a larger allocation
   int           event_count; // number of outstanding CUDA events
 
-  Block(int device, cudaStream_t stream, size_t size, char* ptr=NULL) :
-      device(device), stream(stream), stream_uses(), size(size), ptr(ptr),
+  Block(int device, cudaStream_t stream, size_t size, char* ptr=NULL, uint64_t pool_id=0) :
+      device(device), pool_id(pool_id), stream(stream), stream_uses(), size(size), ptr(ptr),
       allocated(0), prev(NULL), next(NULL), event_count(0) { }
 };
 
+// private pool that allocations of the current thread are routed to
+thread_local uint64_t thread_pool_id = 0;
+
 static bool BlockComparator(const Block* a, const Block* b)
 {
   if (a->device != b->device) {
     return a->device < b->device;
   }
+  if (a->pool_id != b->pool_id) {
+    return a->pool_id < b->pool_id;
+  }
   if (a->stream != b->stream) {
     return (uintptr_t)a->stream < (uintptr_t)b->stream;
   }
@@ -154,9 +253,29 @@ struct THCCachingAllocator
   // outstanding cuda events
   std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
 
+  // policy knobs from THC_CACHING_ALLOCATOR_CONF, parsed on first malloc so
+  // that a malformed value surfaces as a regular error
+  AllocatorConfig config;
+  bool config_parsed;
+
+  // private pools that streams have been routed to
+  std::unordered_map<cudaStream_t, uint64_t> stream_pools;
+
+  // ring buffer of the last trace_capacity events; empty unless enabled
+  std::vector<THCCachingAllocatorTraceEntry> trace;
+  size_t trace_capacity;
+  size_t trace_next;
+  bool trace_backtraces;
+  std::unordered_map<std::string, int64_t> backtrace_ids;
+  std::vector<std::string> backtraces;
+
   THCCachingAllocator() :
       large_blocks(BlockComparator),
-      small_blocks(BlockComparator) {}
+      small_blocks(BlockComparator),
+      config_parsed(false),
+      trace_capacity(0),
+      trace_next(0),
+      trace_backtraces(false) {}
 
   DeviceStats &get_stats_for_device(int device) {
     THAssert(device >= 0);
@@ -174,6 +293,11 @@ struct THCCachingAllocator
     int device;
     AT_CUDA_CHECK(cudaGetDevice(&device));
 
+    if (!config_parsed) {
+      config = parse_config(std::getenv("THC_CACHING_ALLOCATOR_CONF"));
+      config_parsed = true;
+    }
+
     // process outstanding cudaEvents
     process_events();
 
@@ -181,20 +305,23 @@ struct THCCachingAllocator
     bool small = size <= kSmallAlloc;
 
     DeviceStats &stats = get_stats_for_device(device);
+    stats.recordRequest(size);
 
-    Block search_key(device, stream, size);
+    uint64_t pool_id = get_pool_id(stream);
+    Block search_key(device, stream, size, NULL, pool_id);
     auto& free_blocks = small ? small_blocks : large_blocks;
 
     Block* block = NULL;
     Block* remaining = NULL;
 
     auto it = free_blocks.lower_bound(&search_key);
-    if (it != free_blocks.end() && (*it)->device == device && (*it)->stream == stream) {
+    if (it != free_blocks.end() && (*it)->device == device && (*it)->pool_id == pool_id &&
+        (*it)->stream == stream && !is_oversized(size, (*it)->size)) {
       block = *it;
       free_blocks.erase(it);
     } else {
       void* ptr;
-      size_t alloc_size = small ? kSmallAlloc : size;
+      size_t alloc_size = get_allocation_size(size);
       cudaError_t err = cuda_malloc_retry(device, &ptr, alloc_size);
       if (err != cudaSuccess) {
         if (err == cudaErrorMemoryAllocation) {
@@ -234,13 +361,15 @@ struct THCCachingAllocator
         }
       }
       stats.increaseCached(alloc_size);
-      block = new Block(device, stream, alloc_size, (char*)ptr);
+      stats.num_cuda_mallocs++;
+      block = new Block(device, stream, alloc_size, (char*)ptr, pool_id);
+      record_trace(THCCachingAllocatorTraceEntry::SEGMENT_ALLOC, block);
     }
 
-    if (block->size - size >= (small ? kRoundSmall : kSmallAlloc + 1)) {
+    if (should_split(block, size)) {
       remaining = block;
 
-      block = new Block(device, stream, size, block->ptr);
+      block = new Block(device, stream, size, block->ptr, pool_id);
       block->prev = remaining->prev;
       if (block->prev) {
         block->prev->next = block;
@@ -251,6 +380,7 @@ struct THCCachingAllocator
       remaining->ptr += size;
       remaining->size -= size;
       free_blocks.insert(remaining);
+      stats.num_splits++;
     }
 
     block->allocated = true;
@@ -259,6 +389,7 @@ struct THCCachingAllocator
     *devPtr = (void*)block->ptr;
 
     stats.increaseAllocated(block->size);
+    record_trace(THCCachingAllocatorTraceEntry::ALLOC, block);
   }
 
   void free(void* ptr)
@@ -277,7 +408,10 @@ struct THCCachingAllocator
     allocated_blocks.erase(it);
     block->allocated = false;
 
-    get_stats_for_device(block->device).decreaseAllocated(block->size);
+    DeviceStats& stats = get_stats_for_device(block->device);
+    stats.decreaseAllocated(block->size);
+    stats.num_frees++;
+    record_trace(THCCachingAllocatorTraceEntry::FREE, block);
     if (!block->stream_uses.empty()) {
       insert_events(block);
     } else {
@@ -384,6 +518,7 @@ struct THCCachingAllocator
     dst->size += src->size;
     free_blocks.erase(src);
     delete src;
+    get_stats_for_device(dst->device).num_merges++;
   }
 
   size_t round_size(size_t size)
@@ -393,11 +528,56 @@ struct THCCachingAllocator
     } else if (size < kSmallAlloc) {
       size += kRoundSmall - 1 - (size - 1) % kRoundSmall;
     } else {
-      size += kRoundLarge - 1 - (size - 1) % kRoundLarge;
+      size_t round = kRoundLarge;
+      if (config.roundup_power2_divisions > 0) {
+        // size class step: 1/N of the largest power of two not above size
+        size_t power2_floor = kSmallAlloc;
+        while (power2_floor <= size / 2) {
+          power2_floor *= 2;
+        }
+        round = std::max(round, power2_floor / config.roundup_power2_divisions);
+      }
+      size += round - 1 - (size - 1) % round;
+    }
+    return size;
+  }
+
+  /** size of the cudaMalloc backing a request that missed the cache */
+  size_t get_allocation_size(size_t size)
+  {
+    if (size <= kSmallAlloc) {
+      return kSmallAlloc;
+    }
+    if (config.large_segment_size > 0 && size <= config.large_segment_size / 2) {
+      return config.large_segment_size;
     }
     return size;
   }
 
+  /** whether a cached block is too large to be worth using for a request */
+  bool is_oversized(size_t size, size_t block_size)
+  {
+    if (config.max_split_size == 0) {
+      return false;
+    }
+    if (size < config.max_split_size) {
+      return block_size >= config.max_split_size;
+    }
+    return block_size >= size + kLargeBuffer;
+  }
+
+  bool should_split(const Block* block, size_t size)
+  {
+    size_t remaining = block->size - size;
+    if (block->size <= kSmallAlloc) {
+      return remaining >= kRoundSmall;
+    }
+    if (config.max_split_size > 0 && block->size >= config.max_split_size) {
+      return false;
+    }
+    return remaining > kSmallAlloc;
+  }
+
   cudaError_t cuda_malloc_retry(int device, void** devPtr, size_t size)
   {
     // Try cudaMalloc. If cudaMalloc fails, frees all non-split cached blocks
@@ -405,6 +585,7 @@ struct THCCachingAllocator
     cudaError_t err = cudaMalloc(devPtr, size);
     if (err != cudaSuccess) {
       cudaGetLastError();  // reset the last CUDA error
+      get_stats_for_device(device).num_alloc_retries++;
       free_cached_blocks(device);
       err = cudaMalloc(devPtr, size);
       if (err != cudaSuccess) {
@@ -436,19 +617,190 @@ struct THCCachingAllocator
     std::lock_guard<std::mutex> lock(cuda_free_mutex);
     while (it != end) {
       Block* block = *it;
+      ++it;
       if (!block->prev && !block->next) {
-        AT_CUDA_CHECK(cudaFree((void*)block->ptr));
-        get_stats_for_device(block->device).decreaseCached(block->size);
-        auto cur = it;
-        ++it;
-        blocks.erase(cur);
-        delete block;
-      } else {
-        ++it;
+        free_segment(blocks, block);
       }
     }
   }
 
+  /** cudaFrees an unsplit cached block; requires cuda_free_mutex */
+  void free_segment(FreeBlocks& blocks, Block* block)
+  {
+    AT_CUDA_CHECK(cudaFree((void*)block->ptr));
+    DeviceStats& stats = get_stats_for_device(block->device);
+    stats.decreaseCached(block->size);
+    stats.num_cuda_frees++;
+    record_trace(THCCachingAllocatorTraceEntry::SEGMENT_FREE, block);
+    blocks.erase(block);
+    delete block;
+  }
+
+  uint64_t get_pool_id(cudaStream_t stream)
+  {
+    if (thread_pool_id != 0) {
+      return thread_pool_id;
+    }
+    auto it = stream_pools.find(stream);
+    return it == stream_pools.end() ? 0 : it->second;
+  }
+
+  void setStreamPool(cudaStream_t stream, uint64_t pool_id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pool_id == 0) {
+      stream_pools.erase(stream);
+    } else {
+      stream_pools[stream] = pool_id;
+    }
+  }
+
+  /** returns the unsplit cached blocks of a private pool to the system */
+  void releasePool(uint64_t pool_id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (FreeBlocks* blocks : {&large_blocks, &small_blocks}) {
+      std::vector<Block*> pool_blocks;
+      for (Block* block : *blocks) {
+        if (block->pool_id == pool_id) {
+          pool_blocks.push_back(block);
+        }
+      }
+      std::lock_guard<std::mutex> free_lock(cuda_free_mutex);
+      for (Block* block : pool_blocks) {
+        if (!block->prev && !block->next) {
+          free_segment(*blocks, block);
+        }
+      }
+    }
+  }
+
+  THCCachingAllocatorStats getStats(int device)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return get_stats_for_device(device);
+  }
+
+  /** returns all segments and the state of the blocks they are split into */
+  std::vector<THCCachingAllocatorSegmentInfo> snapshot()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Every block is either allocated, cached, or waiting on events; walk
+    // back from each to the first block of its segment.
+    std::set<Block*, Comparison> heads(BlockComparator);
+    auto add_head = [&](Block* block) {
+      while (block->prev) {
+        block = block->prev;
+      }
+      heads.insert(block);
+    };
+    for (auto& it : allocated_blocks) {
+      add_head(it.second);
+    }
+    for (Block* block : large_blocks) {
+      add_head(block);
+    }
+    for (Block* block : small_blocks) {
+      add_head(block);
+    }
+    for (auto& e : cuda_events) {
+      add_head(e.second);
+    }
+
+    std::vector<THCCachingAllocatorSegmentInfo> segments;
+    segments.reserve(heads.size());
+    for (Block* head : heads) {
+      THCCachingAllocatorSegmentInfo segment;
+      segment.device = head->device;
+      segment.pool_id = head->pool_id;
+      segment.address = (uintptr_t)head->ptr;
+      segment.total_size = 0;
+      segment.allocated_size = 0;
+      segment.stream = head->stream;
+      for (Block* block = head; block; block = block->next) {
+        THCCachingAllocatorBlockInfo info;
+        info.size = block->size;
+        info.allocated = block->allocated;
+        info.pending_free = !block->allocated && block->event_count > 0;
+        segment.blocks.push_back(info);
+        segment.total_size += block->size;
+        if (block->allocated) {
+          segment.allocated_size += block->size;
+        }
+      }
+      segments.push_back(std::move(segment));
+    }
+    std::sort(segments.begin(), segments.end(),
+      [](const THCCachingAllocatorSegmentInfo& a, const THCCachingAllocatorSegmentInfo& b) {
+        return a.address < b.address;
+      });
+    return segments;
+  }
+
+  void setTraceCapacity(size_t capacity, bool record_backtraces)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    trace.clear();
+    trace.shrink_to_fit();
+    trace.reserve(capacity);
+    trace_capacity = capacity;
+    trace_next = 0;
+    trace_backtraces = capacity > 0 && record_backtraces;
+    backtrace_ids.clear();
+    backtraces.clear();
+  }
+
+  std::vector<THCCachingAllocatorTraceEntry> getTrace()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (trace.size() < trace_capacity) {
+      return trace;
+    }
+    // the buffer is full; trace_next points at the oldest entry
+    std::vector<THCCachingAllocatorTraceEntry> result;
+    result.reserve(trace.size());
+    result.insert(result.end(), trace.begin() + trace_next, trace.end());
+    result.insert(result.end(), trace.begin(), trace.begin() + trace_next);
+    return result;
+  }
+
+  std::vector<std::string> getTraceBacktraces()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return backtraces;
+  }
+
+  void record_trace(THCCachingAllocatorTraceEntry::Action action, const Block* block)
+  {
+    if (trace_capacity == 0) {
+      return;
+    }
+    THCCachingAllocatorTraceEntry entry;
+    entry.action = action;
+    entry.device = block->device;
+    entry.ptr = (uintptr_t)block->ptr;
+    entry.size = block->size;
+    entry.stream = block->stream;
+    entry.backtrace_id = -1;
+    if (trace_backtraces) {
+      // skip record_trace and the allocator method that called it
+      std::string backtrace = c10::get_backtrace(/*frames_to_skip=*/2);
+      auto it = backtrace_ids.find(backtrace);
+      if (it == backtrace_ids.end()) {
+        it = backtrace_ids.emplace(backtrace, (int64_t)backtraces.size()).first;
+        backtraces.push_back(std::move(backtrace));
+      }
+      entry.backtrace_id = it->second;
+    }
+    if (trace.size() < trace_capacity) {
+      trace.push_back(entry);
+    } else {
+      trace[trace_next] = entry;
+    }
+    trace_next = (trace_next + 1) % trace_capacity;
+  }
+
   Block* find_allocated_block(void *ptr) {
     auto it = allocated_blocks.find(ptr);
     if (it == allocated_blocks.end()) {
@@ -590,3 +942,45 @@ THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device) {
   assertValidDevice(device);
   return caching_allocator.get_stats_for_device(device).max_amount_cached;
 }
+
+THC_API uint64_t THCCachingAllocator_newPoolId() {
+  static std::atomic<uint64_t> next_pool_id(1);
+  return next_pool_id++;
+}
+
+THC_API void THCCachingAllocator_setStreamPool(THCStream* stream, uint64_t pool_id) {
+  caching_allocator.setStreamPool(THCStream_stream(stream), pool_id);
+}
+
+THC_API void THCCachingAllocator_setThreadPool(uint64_t pool_id) {
+  thread_pool_id = pool_id;
+}
+
+THC_API uint64_t THCCachingAllocator_getThreadPool() {
+  return thread_pool_id;
+}
+
+THC_API void THCCachingAllocator_releasePool(uint64_t pool_id) {
+  caching_allocator.releasePool(pool_id);
+}
+
+THC_API THCCachingAllocatorStats THCCachingAllocator_getStats(int device) {
+  assertValidDevice(device);
+  return caching_allocator.getStats(device);
+}
+
+THC_CLASS std::vector<THCCachingAllocatorSegmentInfo> THCCachingAllocator_snapshot() {
+  return caching_allocator.snapshot();
+}
+
+THC_API void THCCachingAllocator_setTraceCapacity(size_t capacity, bool record_backtraces) {
+  caching_allocator.setTraceCapacity(capacity, record_backtraces);
+}
+
+THC_CLASS std::vector<THCCachingAllocatorTraceEntry> THCCachingAllocator_getTrace() {
+  return caching_allocator.getTrace();
+}
+
+THC_CLASS std::vector<std::string> THCCachingAllocator_getTraceBacktraces() {
+  return caching_allocator.getTraceBacktraces();
+}
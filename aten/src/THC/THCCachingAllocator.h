@@ -20,6 +20,98 @@ THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device);
 
 #if (__cplusplus >= 201103L) || (defined(_MSC_VER) && defined(__cplusplus))
 THC_API std::mutex* THCCachingAllocator_getCudaFreeMutex();
+
+#include <string>
+#include <vector>
+
+// Number of buckets in THCCachingAllocatorStats::size_histogram. Bucket i
+// counts requests of at most (512 << i) bytes after rounding; the last
+// bucket also counts everything larger.
+#define THC_CACHING_ALLOCATOR_NUM_SIZE_CLASSES 24
+
+struct THCCachingAllocatorStats {
+  uint64_t amount_allocated;      // total amount allocated in bytes
+  uint64_t max_amount_allocated;  // max total amount allocated in bytes
+  uint64_t amount_cached;         // total amount in cache in bytes
+  uint64_t max_amount_cached;     // max total amount in cache in bytes
+  uint64_t num_allocs;            // number of malloc requests
+  uint64_t num_frees;             // number of free requests
+  uint64_t num_cuda_mallocs;      // number of successful cudaMalloc calls
+  uint64_t num_cuda_frees;        // number of cudaFree calls
+  uint64_t num_alloc_retries;     // cudaMalloc failures that flushed the cache
+  uint64_t num_splits;            // cached blocks split to serve a request
+  uint64_t num_merges;            // freed blocks merged with a neighbour
+  uint64_t size_histogram[THC_CACHING_ALLOCATOR_NUM_SIZE_CLASSES];
+};
+
+struct THCCachingAllocatorBlockInfo {
+  size_t size;
+  bool allocated;
+  bool pending_free;  // freed, but waiting on events of recorded streams
+};
+
+// A cudaMalloc'd region and the blocks it is currently split into, in
+// address order.
+struct THCCachingAllocatorSegmentInfo {
+  int device;
+  uint64_t pool_id;
+  uintptr_t address;
+  size_t total_size;
+  size_t allocated_size;
+  cudaStream_t stream;
+  std::vector<THCCachingAllocatorBlockInfo> blocks;
+};
+
+struct THCCachingAllocatorTraceEntry {
+  enum Action {
+    ALLOC,          // block handed out by malloc
+    FREE,           // block returned through free
+    SEGMENT_ALLOC,  // cudaMalloc
+    SEGMENT_FREE,   // cudaFree
+  };
+  Action action;
+  int device;
+  uintptr_t ptr;
+  size_t size;
+  cudaStream_t stream;
+  // Index into THCCachingAllocator_getTraceBacktraces(), or -1 if
+  // backtraces are not recorded.
+  int64_t backtrace_id;
+};
+
+// Private pools. Pool 0 is the shared pool every stream uses by default.
+// Blocks of a private pool are only reused by allocations routed to that
+// pool, on the stream that allocated them. The thread-level routing takes
+// precedence over the stream-level one.
+THC_API uint64_t THCCachingAllocator_newPoolId();
+THC_API void THCCachingAllocator_setStreamPool(THCStream* stream, uint64_t pool_id);
+THC_API void THCCachingAllocator_setThreadPool(uint64_t pool_id);
+THC_API uint64_t THCCachingAllocator_getThreadPool();
+// Returns the cached, unsplit segments of a pool to the driver.
+THC_API void THCCachingAllocator_releasePool(uint64_t pool_id);
+
+// Routes the current thread's allocations to a private pool for its scope.
+struct THCCachingAllocatorPoolGuard {
+  explicit THCCachingAllocatorPoolGuard(uint64_t pool_id)
+      : prev_pool_id(THCCachingAllocator_getThreadPool()) {
+    THCCachingAllocator_setThreadPool(pool_id);
+  }
+  ~THCCachingAllocatorPoolGuard() {
+    THCCachingAllocator_setThreadPool(prev_pool_id);
+  }
+  uint64_t prev_pool_id;
+};
+
+THC_API THCCachingAllocatorStats THCCachingAllocator_getStats(int device);
+THC_CLASS std::vector<THCCachingAllocatorSegmentInfo> THCCachingAllocator_snapshot();
+
+// Starts recording the last `capacity` allocator events in a ring buffer,
+// optionally with deduplicated backtraces. A capacity of 0 stops recording
+// and drops the buffer.
+THC_API void THCCachingAllocator_setTraceCapacity(size_t capacity, bool record_backtraces);
+// Recorded events, oldest first.
+THC_CLASS std::vector<THCCachingAllocatorTraceEntry> THCCachingAllocator_getTrace();
+THC_CLASS std::vector<std::string> THCCachingAllocator_getTraceBacktraces();
 #endif
 
 #endif
@@ -14,6 +14,29 @@ namespace {
 
 typedef std::shared_ptr<THCStream> THCStreamPtr;
 
+// Requests are rounded up to one of four size classes per power of two (at
+// least kMinBlockSize) so that batches of slightly different shapes map to
+// the same cached block, while pinning at most 25% more than requested.
+const size_t kMinBlockSize = 4096;
+const size_t kSizeClassesPerPower2 = 4;
+
+static size_t round_size(size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+  if (size <= kMinBlockSize) {
+    return kMinBlockSize;
+  }
+  // size class step: 1/4 of the largest power of two not above size
+  size_t power2_floor = kMinBlockSize;
+  while (power2_floor <= size / 2) {
+    power2_floor *= 2;
+  }
+  size_t round = power2_floor / kSizeClassesPerPower2;
+  return size + round - 1 - (size - 1) % round;
+}
+
 struct BlockSize
 {
   size_t  size; // allocation size
@@ -57,43 +80,109 @@ struct HostAllocator
   // outstanding cuda events
   std::deque<std::pair<cudaEvent_t, void*>> cuda_events;
 
-  HostAllocator() : available(BlockComparator) {}
+  // user buffers pinned through registerHostBuffer, by pointer
+  std::unordered_map<void*, size_t> registered_buffers;
+
+  THCCachingHostAllocatorStats stats;
+
+  HostAllocator() : available(BlockComparator), stats() {}
 
   cudaError_t malloc(void** ptr, size_t size)
   {
-    std::lock_guard<std::mutex> lock(mutex);
+    size = round_size(size);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
 
-    // process outstanding cuda events which may have occurred
-    cudaError_t err = processEvents();
-    if (err != cudaSuccess) {
-      return err;
-    }
+      // process outstanding cuda events which may have occurred
+      cudaError_t err = processEvents();
+      if (err != cudaSuccess) {
+        return err;
+      }
 
-    // search for the smallest block which can hold this allocation
-    BlockSize search_key(size);
-    auto it = available.lower_bound(search_key);
-    if (it != available.end()) {
-      Block& block = blocks.at(it->ptr);
-      THAssert(!block.allocated && block.event_count == 0);
-      block.allocated = true;
-      *ptr = block.ptr;
-      available.erase(it);
-      return cudaSuccess;
+      // search for the smallest block which can hold this allocation
+      BlockSize search_key(size);
+      auto it = available.lower_bound(search_key);
+      if (it != available.end()) {
+        Block& block = blocks.at(it->ptr);
+        THAssert(!block.allocated && block.event_count == 0);
+        block.allocated = true;
+        *ptr = block.ptr;
+        available.erase(it);
+        stats.num_hits++;
+        stats.amount_allocated += block.size;
+        return cudaSuccess;
+      }
     }
 
     // note that cudaHostAlloc may not touch pointer if size is 0
     *ptr = 0;
 
-    // allocate a new block if no cached allocation is found
-    err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
+    // Allocate a new block if no cached allocation is found. cudaHostAlloc
+    // can take milliseconds, so it runs without holding the lock.
+    cudaError_t err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
     if (err != cudaSuccess) {
       return err;
     }
 
+    std::lock_guard<std::mutex> lock(mutex);
     blocks.insert({*ptr, Block(size, *ptr, true)});
+    stats.num_misses++;
+    stats.amount_allocated += size;
+    stats.amount_cached += size;
     return cudaSuccess;
   }
 
+  /** pins `count` blocks of the given size class ahead of time */
+  cudaError_t reserve(size_t size, size_t count)
+  {
+    size = round_size(size);
+    if (size == 0) {
+      return cudaSuccess;
+    }
+    for (size_t i = 0; i < count; i++) {
+      void* ptr = 0;
+      cudaError_t err = cudaHostAlloc(&ptr, size, cudaHostAllocDefault);
+      if (err != cudaSuccess) {
+        return err;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      auto inserted = blocks.insert({ptr, Block(size, ptr, false)});
+      available.insert(inserted.first->second);
+      stats.amount_cached += size;
+    }
+    return cudaSuccess;
+  }
+
+  cudaError_t registerHostBuffer(void* ptr, size_t size)
+  {
+    cudaError_t err = cudaHostRegister(ptr, size, cudaHostRegisterDefault);
+    if (err != cudaSuccess) {
+      return err;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    registered_buffers[ptr] = size;
+    stats.amount_registered += size;
+    return cudaSuccess;
+  }
+
+  cudaError_t unregisterHostBuffer(void* ptr)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = registered_buffers.find(ptr);
+      THAssert(it != registered_buffers.end());
+      stats.amount_registered -= it->second;
+      registered_buffers.erase(it);
+    }
+    return cudaHostUnregister(ptr);
+  }
+
+  THCCachingHostAllocatorStats getStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+  }
+
   cudaError_t free(void* ptr)
   {
     std::lock_guard<std::mutex> lock(mutex);
@@ -117,6 +206,7 @@ struct HostAllocator
     // free (on valid memory) shouldn't fail, so mark unallocated before
     // we process the streams.
     block.allocated = false;
+    stats.amount_allocated -= block.size;
 
     // insert CUDA events for each stream on which this block was used. This
     err = insertEvents(block);
@@ -208,6 +298,7 @@ struct HostAllocator
       Block& block = it->second;
       if (!block.allocated) {
         THCudaCheckWarn(cudaFreeHost(block.ptr));
+        stats.amount_cached -= block.size;
         it = blocks.erase(it);
       } else {
         ++it;
@@ -260,6 +351,26 @@ void THCCachingHostAllocator_emptyCache()
   allocator.emptyCache();
 }
 
+cudaError_t THCCachingHostAllocator_reserve(size_t size, size_t count)
+{
+  return allocator.reserve(size, count);
+}
+
+cudaError_t THCCachingHostAllocator_registerHostBuffer(void* ptr, size_t size)
+{
+  return allocator.registerHostBuffer(ptr, size);
+}
+
+cudaError_t THCCachingHostAllocator_unregisterHostBuffer(void* ptr)
+{
+  return allocator.unregisterHostBuffer(ptr);
+}
+
+THCCachingHostAllocatorStats THCCachingHostAllocator_getStats()
+{
+  return allocator.getStats();
+}
+
 static void THCCachingHostDeleter(void* ptr) {
   allocator.free(ptr);
 }
@@ -17,10 +17,21 @@
 // and tensors in THCTensor_(copyAsyncCPU) and THCTensor_(copyAsyncCuda).
 //
 // Note that this allocator does not split larger allocations into smaller
-// blocks, unlike the caching device allocator.
+// blocks, unlike the caching device allocator. Instead, requests are rounded
+// up to one of four size classes per power of two, so that changing batch
+// shapes keep hitting the cache rather than paying for a fresh cudaHostAlloc
+// each time.
 //
 THC_API THAllocator* getTHCCachingHostAllocator(void);
 
+struct THCCachingHostAllocatorStats {
+  uint64_t num_hits;           // allocations served from the cache
+  uint64_t num_misses;         // allocations that needed a cudaHostAlloc
+  uint64_t amount_allocated;   // bytes currently handed out
+  uint64_t amount_cached;      // bytes pinned by the allocator, incl. allocated
+  uint64_t amount_registered;  // bytes of user buffers pinned via registerHostBuffer
+};
+
 // Records an event in the specified stream. The allocation 'ptr' will not be
 // re-used until the event has occurred.
 THC_API cudaError_t THCCachingHostAllocator_recordEvent(void *ptr, THCStream *stream);
@@ -28,4 +39,17 @@ THC_API cudaError_t THCCachingHostAllocator_recordEvent(void *ptr, THCStream *st
 // Releases cached pinned memory allocations via cudaHostFree
 THC_API void THCCachingHostAllocator_emptyCache(void);
 
+// Pins `count` blocks of size `size` (rounded up to its size class) so that
+// later allocations of that class are cache hits. Safe to call from a
+// background thread while other threads allocate.
+THC_API cudaError_t THCCachingHostAllocator_reserve(size_t size, size_t count);
+
+// Page-locks an existing host buffer via cudaHostRegister so that it can be
+// used for asynchronous copies without staging. The caller keeps ownership
+// and must unregister the buffer before releasing it.
+THC_API cudaError_t THCCachingHostAllocator_registerHostBuffer(void* ptr, size_t size);
+THC_API cudaError_t THCCachingHostAllocator_unregisterHostBuffer(void* ptr);
+
+THC_API THCCachingHostAllocatorStats THCCachingHostAllocator_getStats(void);
+
 #endif
@@ -5,6 +5,7 @@
 #include "THCTensorRandom.h"
 #include "THCGeneral.hpp"
 
+#include "ATen/cuda/CUDAContext.h"
 #include "ATen/cuda/CUDAStream.h"
 
 #include "THCCachingAllocator.h"
@@ -126,11 +127,6 @@ void THCudaShutdown(THCState* state)
     THCudaCheck(cudaSetDevice(dev));
     THCCudaResourcesPerDevice* res = &(state->resourcesPerDevice[dev]);
 
-    // Frees BLAS handle
-    if (res->blasHandle) {
-      THCublasCheck(cublasDestroy(res->blasHandle));
-    }
-
     // Frees sparse handle
     if (res->sparseHandle) {
       THCusparseCheck(cusparseDestroy(res->sparseHandle));
@@ -257,16 +253,8 @@ cublasHandle_t THCState_getCurrentBlasHandle(THCState *state)
     return NULL;
   }
 
-  int device;
-  THCudaCheck(cudaGetDevice(&device));
-
-  // Creates the BLAS handle if not created yet
-  THCCudaResourcesPerDevice* res = THCState_getDeviceResourcePtr(state, device);
-  if (!res->blasHandle) {
-    THCublasCheck(cublasCreate(&res->blasHandle));
-  }
-
-  return res->blasHandle;
+  // The handle of the current stream, from the pool shared with caffe2
+  return at::cuda::getCurrentCUDABlasHandle();
 }
 
 cusparseHandle_t THCState_getCurrentSparseHandle(THCState *state)
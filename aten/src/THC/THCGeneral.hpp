@@ -6,9 +6,9 @@
 struct THCState {
   struct THCRNGState* rngState;
   struct cudaDeviceProp* deviceProperties;
-  /* Set of all allocated resources. blasHandles and sparseHandles do not have
-     a default and must be explicitly initialized. We always initialize 1
-     blasHandle and 1 sparseHandle but we can use more.
+  /* Set of all allocated resources. sparseHandles do not have a default and
+     must be explicitly initialized. We always initialize 1 sparseHandle but
+     we can use more. cuBLAS handles are in the pool of ATen/cuda/CUDAContext.h.
   */
   THCCudaResourcesPerDevice* resourcesPerDevice;
   /* Captured number of devices upon startup; convenience for bounds checking */
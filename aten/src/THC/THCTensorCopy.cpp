@@ -3,5 +3,128 @@
 #include "THCStream.h"
 #include "THCCachingHostAllocator.h"
 
+#include <algorithm>
+#include <cstring>
+
+// Copies between pageable host memory and a device go through a ring of
+// pinned buffers from the caching host allocator, chunk by chunk, so that
+// the host memcpy of one chunk overlaps the DMA of the others. Left to
+// itself, the driver stages pageable copies through its own small buffers
+// and blocks the host until the whole copy is done.
+static const size_t kStagingChunkSize = 4 << 20;
+static const int kNumStagingBuffers = 4;
+
+static bool THC_isPinnedHostPtr(const void* ptr)
+{
+  cudaPointerAttributes attr;
+  cudaError_t err = cudaPointerGetAttributes(&attr, ptr);
+  if (err != cudaSuccess) {
+    // pageable memory the driver doesn't know about
+    cudaGetLastError();
+    return false;
+  }
+  return attr.memoryType == cudaMemoryTypeHost;
+}
+
+// Copies are only staged when there is more than one chunk to overlap
+static bool THC_shouldStageCopy(const void* host_ptr, size_t size)
+{
+  return size > kStagingChunkSize && !THC_isPinnedHostPtr(host_ptr);
+}
+
+// Returns once src has been copied to pinned memory: the last DMAs may still
+// be running on the stream, which keeps the buffers alive until they end.
+static void THC_stagedCopyHostToDevice(void* dst, const void* src, size_t size, THCStream* stream)
+{
+  at::Allocator* allocator = getTHCCachingHostAllocator();
+  cudaStream_t cuda_stream = THCStream_stream(stream);
+  at::DataPtr buffers[kNumStagingBuffers];
+  cudaEvent_t events[kNumStagingBuffers];
+  int num_buffers = 0;
+
+  for (size_t offset = 0, chunk = 0; offset < size; offset += kStagingChunkSize, chunk++) {
+    int b = chunk % kNumStagingBuffers;
+    if (b == num_buffers) {
+      buffers[b] = allocator->allocate(kStagingChunkSize);
+      THCudaCheck(cudaEventCreateWithFlags(&events[b], cudaEventDisableTiming));
+      num_buffers++;
+    } else {
+      // wait for the DMA that last read this buffer
+      THCudaCheck(cudaEventSynchronize(events[b]));
+    }
+    size_t n = std::min(kStagingChunkSize, size - offset);
+    memcpy(buffers[b].get(), (const char*)src + offset, n);
+    THCudaCheck(cudaMemcpyAsync((char*)dst + offset, buffers[b].get(), n,
+                                cudaMemcpyHostToDevice, cuda_stream));
+    THCudaCheck(cudaEventRecord(events[b], cuda_stream));
+  }
+
+  for (int b = 0; b < num_buffers; b++) {
+    THCudaCheck(THCCachingHostAllocator_recordEvent(buffers[b].get(), stream));
+    THCudaCheck(cudaEventDestroy(events[b]));
+  }
+}
+
+// Blocks until dst holds all of src, as for any copy to pageable memory, but
+// copies each chunk out of pinned memory while the next ones are in flight.
+static void THC_stagedCopyDeviceToHost(void* dst, const void* src, size_t size, THCStream* stream)
+{
+  at::Allocator* allocator = getTHCCachingHostAllocator();
+  cudaStream_t cuda_stream = THCStream_stream(stream);
+  at::DataPtr buffers[kNumStagingBuffers];
+  cudaEvent_t events[kNumStagingBuffers];
+  size_t num_chunks = (size + kStagingChunkSize - 1) / kStagingChunkSize;
+  int num_buffers = std::min<size_t>(kNumStagingBuffers, num_chunks);
+
+  auto chunk_size = [&](size_t chunk) {
+    return std::min(kStagingChunkSize, size - chunk * kStagingChunkSize);
+  };
+  auto start_chunk = [&](size_t chunk) {
+    int b = chunk % kNumStagingBuffers;
+    THCudaCheck(cudaMemcpyAsync(buffers[b].get(),
+                                (const char*)src + chunk * kStagingChunkSize,
+                                chunk_size(chunk), cudaMemcpyDeviceToHost,
+                                cuda_stream));
+    THCudaCheck(cudaEventRecord(events[b], cuda_stream));
+  };
+
+  for (int b = 0; b < num_buffers; b++) {
+    buffers[b] = allocator->allocate(kStagingChunkSize);
+    THCudaCheck(cudaEventCreateWithFlags(&events[b], cudaEventDisableTiming));
+    start_chunk(b);
+  }
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    int b = chunk % kNumStagingBuffers;
+    THCudaCheck(cudaEventSynchronize(events[b]));
+    memcpy((char*)dst + chunk * kStagingChunkSize, buffers[b].get(), chunk_size(chunk));
+    if (chunk + kNumStagingBuffers < num_chunks) {
+      start_chunk(chunk + kNumStagingBuffers);
+    }
+  }
+  for (int b = 0; b < num_buffers; b++) {
+    THCudaCheck(cudaEventDestroy(events[b]));
+  }
+}
+
+static void THC_copyHostToDevice(void* dst, const void* src, size_t size, THCStream* stream)
+{
+  if (THC_shouldStageCopy(src, size)) {
+    THC_stagedCopyHostToDevice(dst, src, size, stream);
+  } else {
+    THCudaCheck(cudaMemcpyAsync(dst, src, size, cudaMemcpyHostToDevice,
+                                THCStream_stream(stream)));
+  }
+}
+
+static void THC_copyDeviceToHost(void* dst, const void* src, size_t size, THCStream* stream)
+{
+  if (THC_shouldStageCopy(dst, size)) {
+    THC_stagedCopyDeviceToHost(dst, src, size, stream);
+  } else {
+    THCudaCheck(cudaMemcpyAsync(dst, src, size, cudaMemcpyDeviceToHost,
+                                THCStream_stream(stream)));
+  }
+}
+
 #include "generic/THCTensorCopy.cpp"
 #include "THCGenerateAllTypes.h"
@@ -7,10 +7,17 @@
 #include "THCSortUtils.cuh"
 #include "THCTensorCopy.h"
 #include "THCTensorTypeUtils.cuh"
+#include "THCAsmUtils.cuh"
+#include "THCScanUtils.cuh"
+#include "THCTensorMathReduce.cuh"
+// for TopKTypeConfig
+#include "THCTensorTopK.cuh"
 
 #include "THCThrustAllocator.cuh"
 #include <thrust/device_ptr.h>
+#include <thrust/gather.h>
 #include <thrust/sort.h>
+#include <thrust/transform.h>
 #if CUDA_VERSION >= 7000 || defined(__HIP_PLATFORM_HCC__)
 #include <thrust/system/cuda/execution_policy.h>
 #endif
@@ -55,17 +62,33 @@ fillSliceWithIndex(TensorInfo<int64_t, IndexType> out,
   }
 }
 
+// For sorting in Thrust; maps values to the sorted int format of
+// TopKTypeConfig, inverted for a descending sort, which Thrust sorts with
+// a radix sort rather than the merge sort of a comparison functor
+template <typename T>
+struct ValueToRadixKey {
+  typedef typename TopKTypeConfig<T>::RadixType RadixType;
+
+  ValueToRadixKey(bool descending) : descending(descending) {}
+
+  __device__ inline RadixType operator()(const T& v) const {
+    RadixType key = TopKTypeConfig<T>::convert(v);
+    return descending ? ~key : key;
+  }
+
+  const bool descending;
+};
+
 // For slice sorting in Thrust; extracts a slice index from a linear
-// index and uses that for comparison
-struct SliceComp {
-  SliceComp(int64_t size) : sliceSize(size) {}
+// index, which is sorted on as an integer key
+template <typename SliceType>
+struct GlobalIndexToSlice {
+  GlobalIndexToSlice(int64_t size) : sliceSize(size) {}
 
-  __device__ bool operator()(const int64_t& a, const int64_t& b) const {
+  __device__ inline SliceType operator()(const int64_t& v) const {
     // Since the slices are guaranteed to be innermost,
     // the segment is just via int64_t division
-    int64_t segA = a / sliceSize;
-    int64_t segB = b / sliceSize;
-    return segA < segB;
+    return v / sliceSize;
   }
 
   const int64_t sliceSize;
@@ -488,6 +488,137 @@ __global__ void gatherTopK(TensorInfo<T, IndexType> input,
   }
 }
 
+// Small slices are selected by a warp each, with several warps per block.
+// The warp keeps its slice in registers, ItemsPerThread values per lane, and
+// finds the k-th value one bit of its radix representation at a time with
+// warp votes, without shared memory or block-wide synchronization. With one
+// block per slice, gatherTopK would leave most threads of its blocks idle
+// and reload the slice once per radix digit.
+#define TOPK_SMALL_SLICE_WARP_SIZE 32
+#define TOPK_SMALL_SLICE_MAX_ITEMS 32
+#define TOPK_SMALL_SLICE_WARPS_PER_BLOCK 4
+
+__device__ __forceinline__ int countWarpVotes(bool vote) {
+#if defined (__HIP_PLATFORM_HCC__)
+  return __popcll(WARP_BALLOT(vote));
+#else
+  return __popc(WARP_BALLOT(vote));
+#endif
+}
+
+__device__ __forceinline__ int countWarpVotesBelowLane(bool vote) {
+#if defined (__HIP_PLATFORM_HCC__)
+  return __popcll(WARP_BALLOT(vote) & getLaneMaskLt());
+#else
+  return __popc(WARP_BALLOT(vote) & getLaneMaskLt());
+#endif
+}
+
+template <typename T, typename IndexType, int Dim, bool Order, int ItemsPerThread>
+__global__ void gatherTopKSmallSlices(TensorInfo<T, IndexType> input,
+                                      IndexType inputSliceSize,
+                                      IndexType outputSliceSize, // aka `k`
+
+                                      IndexType numInputSlices,
+                                      IndexType inputWithinSliceStride,
+
+                                      TensorInfo<T, IndexType> topK,
+                                      IndexType topKWithinSliceStride,
+
+                                      TensorInfo<int64_t, IndexType> indices,
+                                      IndexType indicesWithinSliceStride) {
+  typedef typename TopKTypeConfig<T>::RadixType RadixType;
+
+  // One warp per slice; the whole warp returns or none of it
+  IndexType slice = getLinearBlockId<IndexType>() * blockDim.y + threadIdx.y;
+  if (slice >= numInputSlices) {
+    return;
+  }
+
+  T* inputSliceStart =
+    &input.data[IndexToOffset<T, IndexType, Dim>::get(slice, input)];
+  T* topKSliceStart =
+    &topK.data[IndexToOffset<T, IndexType, Dim>::get(slice, topK)];
+  int64_t* indicesSliceStart =
+    &indices.data[IndexToOffset<int64_t, IndexType, Dim>::get(slice, indices)];
+
+  // Element j * warpSize + lane of the slice is held by the lane as its j-th
+  // value, in the sorted int format
+  RadixType vals[ItemsPerThread];
+  bool inRange[ItemsPerThread];
+#pragma unroll
+  for (int j = 0; j < ItemsPerThread; ++j) {
+    IndexType i = j * TOPK_SMALL_SLICE_WARP_SIZE + threadIdx.x;
+    inRange[j] = i < inputSliceSize;
+    vals[j] = inRange[j] ?
+      TopKTypeConfig<T>::convert(doLdg(&inputSliceStart[i * inputWithinSliceStride])) : 0;
+  }
+
+  // Find the k-th value from its most significant bit down: among the values
+  // matching the bits found so far, count those whose next bit is set (clear
+  // when selecting the smallest values). If there are at least kToFind of
+  // them, the k-th value is one of them.
+  RadixType desired = 0;
+  RadixType desiredMask = 0;
+  int kToFind = outputSliceSize;
+  for (int bit = sizeof(RadixType) * 8 - 1; bit >= 0; --bit) {
+    RadixType bitMask = RadixType(1) << bit;
+    int count = 0;
+#pragma unroll
+    for (int j = 0; j < ItemsPerThread; ++j) {
+      bool vote = inRange[j] && (vals[j] & desiredMask) == desired &&
+        ((vals[j] & bitMask) != 0) == Order;
+      count += countWarpVotes(vote);
+    }
+    if (count >= kToFind) {
+      if (Order) {
+        desired |= bitMask;
+      }
+    } else {
+      kToFind -= count;
+      if (!Order) {
+        desired |= bitMask;
+      }
+    }
+    desiredMask |= bitMask;
+  }
+
+  // Write the values strictly before the k-th value in the selection order,
+  // then as many of those equal to it as needed, in the order of the slice
+  int writeIndexStart = 0;
+#pragma unroll
+  for (int j = 0; j < ItemsPerThread; ++j) {
+    bool hasTopK = inRange[j] && (Order ? vals[j] > desired : vals[j] < desired);
+    int index = countWarpVotesBelowLane(hasTopK);
+    if (hasTopK) {
+      IndexType writeIndex = writeIndexStart + index;
+      topKSliceStart[writeIndex * topKWithinSliceStride] = TopKTypeConfig<T>::deconvert(vals[j]);
+      indicesSliceStart[writeIndex * indicesWithinSliceStride] =
+        j * TOPK_SMALL_SLICE_WARP_SIZE + threadIdx.x + TH_INDEX_BASE; // to Lua index
+    }
+    writeIndexStart += countWarpVotes(hasTopK);
+  }
+
+  int topKRemaining = outputSliceSize - writeIndexStart;
+#pragma unroll
+  for (int j = 0; j < ItemsPerThread; ++j) {
+    if (topKRemaining <= 0) {
+      break;
+    }
+    bool hasTopK = inRange[j] && vals[j] == desired;
+    int index = countWarpVotesBelowLane(hasTopK);
+    if (hasTopK && index < topKRemaining) {
+      IndexType writeIndex = writeIndexStart + index;
+      topKSliceStart[writeIndex * topKWithinSliceStride] = TopKTypeConfig<T>::deconvert(vals[j]);
+      indicesSliceStart[writeIndex * indicesWithinSliceStride] =
+        j * TOPK_SMALL_SLICE_WARP_SIZE + threadIdx.x + TH_INDEX_BASE; // to Lua index
+    }
+    int carry = countWarpVotes(hasTopK);
+    writeIndexStart += carry;
+    topKRemaining -= carry;
+  }
+}
+
 #undef RADIX_BITS
 #undef RADIX_SIZE
 #undef RADIX_MASK
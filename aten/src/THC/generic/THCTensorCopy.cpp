@@ -12,13 +12,12 @@ void THCTensor_(copyCPU)(THCState *state, THCTensor *self, struct THTensor *src)
     THCTensor *selfc = THCTensor_(newContiguous)(state, self);
     src = THTensor_(newContiguous)(src);
 
-    cudaStream_t stream = THCState_getCurrentStream(state);
-    THCudaCheck(cudaMemcpyAsync(THCTensor_(data)(state,selfc),
-                                src->data<scalar_t>(),
-                                THTensor_(nElement)(src) * sizeof(scalar_t),
-                                cudaMemcpyHostToDevice,
-                                stream));
-    THCudaCheck(cudaStreamSynchronize(stream));
+    THCStream *stream = THCState_getStream(state);
+    THC_copyHostToDevice(THCTensor_(data)(state,selfc),
+                         src->data<scalar_t>(),
+                         THTensor_(nElement)(src) * sizeof(scalar_t),
+                         stream);
+    THCudaCheck(cudaStreamSynchronize(THCStream_stream(stream)));
 
     c10::raw::intrusive_ptr::decref(src);
     THCTensor_(freeCopyTo)(state, selfc, self);
@@ -71,13 +70,12 @@ void THTensor_(copyCuda)(THCState *state, THTensor *self, struct THCTensor *src)
     }
     src = THCTensor_(newContiguous)(state, src);
 
-    cudaStream_t stream = THCState_getCurrentStream(state);
-    THCudaCheck(cudaMemcpyAsync(selfc->data<scalar_t>(),
-                                THCTensor_(data)(state, src),
-                                THCTensor_(nElement)(state, src) * sizeof(scalar_t),
-                                cudaMemcpyDeviceToHost,
-                                stream));
-    THCudaCheck(cudaStreamSynchronize(stream));
+    THCStream *stream = THCState_getStream(state);
+    THC_copyDeviceToHost(selfc->data<scalar_t>(),
+                         THCTensor_(data)(state, src),
+                         THCTensor_(nElement)(state, src) * sizeof(scalar_t),
+                         stream);
+    THCudaCheck(cudaStreamSynchronize(THCStream_stream(stream)));
 
     if (currentDevice != tensorDevice) {
       THCudaCheck(cudaSetDevice(currentDevice));
@@ -141,12 +139,13 @@ void THCTensor_(copyAsyncCPU)(THCState *state, THCTensor *self, struct THTensor
     THCudaCheck(cudaSetDevice(tensorDevice));
   }
 
+  // A pageable src is staged through pinned memory, so the copy is only
+  // asynchronous with respect to the host once src has been read.
   THCStream *stream  = THCState_getStream(state);
-  THCudaCheck(cudaMemcpyAsync(THCTensor_(data)(state, self),
-                              src->data<scalar_t>(),
-                              THTensor_(nElement)(src) * sizeof(scalar_t),
-                              cudaMemcpyHostToDevice,
-                              THCStream_stream(stream)));
+  THC_copyHostToDevice(THCTensor_(data)(state, self),
+                       src->data<scalar_t>(),
+                       THTensor_(nElement)(src) * sizeof(scalar_t),
+                       stream);
 
   THCudaCheck(THCCachingHostAllocator_recordEvent(THStorage_(data)(THTensor_getStoragePtr(src)), stream));
 
@@ -172,12 +171,13 @@ void THTensor_(copyAsyncCuda)(THCState *state, THTensor *self, struct THCTensor
     THCudaCheck(cudaSetDevice(tensorDevice));
   }
 
+  // A pageable self can't be written asynchronously, so this blocks until
+  // the copy is done, as cudaMemcpyAsync does for pageable memory.
   THCStream *stream = THCState_getStream(state);
-  THCudaCheck(cudaMemcpyAsync(self->data<scalar_t>(),
-                              THCTensor_(data)(state, src),
-                              THCTensor_(nElement)(state, src) * sizeof(scalar_t),
-                              cudaMemcpyDeviceToHost,
-                              THCStream_stream(stream)));
+  THC_copyDeviceToHost(self->data<scalar_t>(),
+                       THCTensor_(data)(state, src),
+                       THCTensor_(nElement)(state, src) * sizeof(scalar_t),
+                       stream);
 
   THCudaCheck(THCCachingHostAllocator_recordEvent(THCStorage_(data)(state, THTensor_getStoragePtr(src)), stream));
 
@@ -156,11 +156,12 @@ void THCTensor_(sortViaThrust)(THCState* state,
                                THCudaLongTensor* indices,
                                THCTensor* input,
                                int dim, bool dir) {
+  typedef typename TopKTypeConfig<scalar_t>::RadixType RadixType;
+
   int nDims = THCTensor_(nDimensionLegacyAll)(state, input);
 
   ptrdiff_t totalElements = THCTensor_(nElement)(state, input);
   int64_t sliceSize = THCTensor_(sizeLegacyNoScalars)(state, input, dim);
-  int64_t sliceStride = THTensor_strideLegacyNoScalars(input, dim);
 
   // We perform a vectorized segmented sort in Thrust.
   // Say we are sorting a (2, 3) tensor. We have in flattened form:
@@ -181,42 +182,48 @@ void THCTensor_(sortViaThrust)(THCState* state,
   // values 5.3 1.2 0.4 6.2 2.3 1.3
   // indices  3   2   1   1   3   2
 
+  // Both sorts are on integer keys with the default ordering, which
+  // Thrust sorts with a radix sort: the values are sorted in the sorted
+  // int format of TopKTypeConfig (inverted for a descending sort), and the
+  // segments as integers written over those keys once they are no longer
+  // needed. The sorted values are gathered from the input by index at the
+  // end.
+
   // This method can only work if the slice we are sorting (`dim`) is
   // innermost, and both values and indices are contiguous. We do this
   // by re-arranging the input into this form as needed, which will
   // unfortunately allocate memory if the request is not in this form.
-  // Vectorized sort is slower than iterated sort if the number of
-  // slices is small (since we're sorting twice, instead of invoking a
-  // smaller sort `numSlices` times), but the Thrust sort
-  // implementation here is a catch-all, so we're not looking for
-  // efficiency, but instead correctness.
-  THCTensor_(copy)(state, sorted, input);
-  THCTensor* trKeys = THCTensor_(newWithTensor)(state, sorted);
-  THCudaLongTensor* trIndices = THCudaLongTensor_newWithTensor(state, indices);
+  THCTensor* trInput = THCTensor_(newWithTensor)(state, input);
 
   // Transpose dim to innermost
   if (dim != nDims - 1) {
-    THCTensor_(transpose)(state, trKeys, NULL, dim, nDims - 1);
-    THCudaLongTensor_transpose(state, trIndices, NULL, dim, nDims - 1);
+    THCTensor_(transpose)(state, trInput, NULL, dim, nDims - 1);
   }
 
   // Thrust must operate on a contiguous layout
-  THCTensor* trContigKey = THCTensor_(newContiguous)(state, trKeys);
-  THCudaLongTensor* trContigIndices = THCudaLongTensor_newContiguous(state, trIndices);
+  THCTensor* trContigInput = THCTensor_(newContiguous)(state, trInput);
+  THCTensor_(free)(state, trInput);
 
-  THCTensor_(free)(state, trKeys);
-  THCudaLongTensor_free(state, trIndices);
+  THCTensor* trContigKey = THCTensor_(new)(state);
+  THCTensor_(resizeAs)(state, trContigKey, trContigInput);
+  THCudaLongTensor* trContigIndices = THCudaLongTensor_new(state);
+  THCudaLongTensor_resize(state, trContigIndices, trContigInput->sizes(), {});
 
   THCThrustAllocator thrustAlloc(state);
 
+  thrust::device_ptr<scalar_t> inputIter(THCTensor_(data)(state, trContigInput));
   thrust::device_ptr<scalar_t> keyIter(THCTensor_(data)(state, trContigKey));
-
-  // Since we are composing a global index across all segments rather
-  // than a per-segment index, we treat the memory as int so we don't
-  // have problems sorting slices < 2^24 but where the entire tensor
-  // has more than 2^24 elements
   thrust::device_ptr<int64_t>
     indexIter((int64_t*) THCudaLongTensor_data(state, trContigIndices));
+  thrust::device_ptr<RadixType> radixIter(static_cast<RadixType*>(
+    THCudaMalloc(state, totalElements * sizeof(RadixType))));
+
+  thrust::transform(
+#if CUDA_VERSION >= 7000
+    thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
+#endif
+    inputIter, inputIter + totalElements, radixIter,
+    ValueToRadixKey<scalar_t>(dir));
 
   // Fill the indices with a global index across all slices
   thrust::counting_iterator<int64_t> countIter(0);
@@ -229,30 +236,40 @@ void THCTensor_(sortViaThrust)(THCState* state,
 
   // First, we sort globally (across all slices) according to key
   // (the values we're sorting)
-  if (dir) {
-    thrust::stable_sort_by_key(
-#if CUDA_VERSION >= 7000
-      thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
-#endif
-      keyIter, keyIter + totalElements, indexIter, ThrustGTOp<scalar_t>());
-  } else {
-    thrust::stable_sort_by_key(
+  thrust::stable_sort_by_key(
 #if CUDA_VERSION >= 7000
-      thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
+    thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
 #endif
-      keyIter, keyIter + totalElements, indexIter, ThrustLTOp<scalar_t>());
-  }
+    radixIter, radixIter + totalElements, indexIter);
 
   // Then, re-sort according to slice that each index is
   // in. This completes the segment sort in Thrust, since we're
   // stably sorting here, preserving the relative order of values
-  // per each slice
+  // per each slice. Slices hold more than the 2048 elements of the
+  // in-place sort, so their number fits in RadixType.
+  thrust::transform(
+#if CUDA_VERSION >= 7000
+    thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
+#endif
+    indexIter, indexIter + totalElements, radixIter,
+    GlobalIndexToSlice<RadixType>(sliceSize));
+
   thrust::stable_sort_by_key(
 #if CUDA_VERSION >= 7000
     thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
 #endif
-    indexIter, indexIter + totalElements, keyIter,
-    SliceComp(sliceSize));
+    radixIter, radixIter + totalElements, indexIter);
+
+  THCudaFree(state, thrust::raw_pointer_cast(radixIter));
+
+  // Gather the sorted values
+  thrust::gather(
+#if CUDA_VERSION >= 7000
+    thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
+#endif
+    indexIter, indexIter + totalElements, inputIter, keyIter);
+
+  THCTensor_(free)(state, trContigInput);
 
   // Translate the global integer 0-based index to a per-slice real
   // Lua index
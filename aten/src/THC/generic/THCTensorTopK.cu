@@ -118,17 +118,107 @@ void THCTensor_(topk)(THCState* state,
                                                                         \
   RUN_DIM(INDEX_T);
 
+  // Slices of up to TOPK_SMALL_SLICE_MAX_ITEMS values per lane of a warp are
+  // selected by a warp each, the slice held in registers; only the generic
+  // 32-bit indexing version is instantiated for them, as the offsets of a
+  // slice are computed once per warp.
+#define RUN_SMALL_SLICES_DIR(ITEMS, DIR)                                \
+  gatherTopKSmallSlices<scalar_t, uint32_t, -1, DIR, ITEMS>                 \
+    <<<grid, block, 0, THCState_getCurrentStream(state)>>>(             \
+      inputInfo,                                                        \
+      static_cast<uint32_t>(sliceSize),                                 \
+      static_cast<uint32_t>(k),                                         \
+      static_cast<uint32_t>(inputSlices),                               \
+      static_cast<uint32_t>(inputInfo.strides[collapseInputDim]),       \
+      topKInfo,                                                         \
+      static_cast<uint32_t>(topKInfo.strides[collapseTopKDim]),         \
+      indicesInfo,                                                      \
+      static_cast<uint32_t>(indicesInfo.strides[collapseIndicesDim]))
+
+#define RUN_SMALL_SLICES(ITEMS)                 \
+  if (dir) {                                    \
+    RUN_SMALL_SLICES_DIR(ITEMS, true);          \
+  } else {                                      \
+    RUN_SMALL_SLICES_DIR(ITEMS, false);         \
+  }
+
+#ifdef __HIP_PLATFORM_HCC__
+  const bool useSmallSlices = false;
+#else
+  const bool useSmallSlices =
+    sliceSize <= TOPK_SMALL_SLICE_WARP_SIZE * TOPK_SMALL_SLICE_MAX_ITEMS;
+#endif
+
   if (THCTensor_nElement(state, input) > 0) {
     // Based on required index size, run the algorithm with the
     // appropriate index type
     if (THCTensor_canUse32BitIndexMath(state, input) &&
         THCTensor_canUse32BitIndexMath(state, topK) &&
         THCTensor_canUse32BitIndexMath(state, indices)) {
-      RUN_T(uint32_t);
+      if (useSmallSlices) {
+        TensorInfo<scalar_t, uint32_t> inputInfo =
+          getTensorInfo<scalar_t, THCTensor, uint32_t>(state, input);
+        TensorInfo<scalar_t, uint32_t> topKInfo =
+          getTensorInfo<scalar_t, THCTensor, uint32_t>(state, topK);
+        TensorInfo<int64_t, uint32_t> indicesInfo =
+          getTensorInfo<int64_t, THCudaLongTensor, uint32_t>(state, indices);
+
+        inputInfo.sizes[dim] = 1;
+        topKInfo.sizes[dim] = 1;
+        indicesInfo.sizes[dim] = 1;
+
+        int collapseInputDim = inputInfo.collapseDims(dim);
+        int collapseTopKDim = topKInfo.collapseDims(dim);
+        int collapseIndicesDim = indicesInfo.collapseDims(dim);
+
+        int64_t inputSlices = 1;
+        for (int i = 0; i < inputInfo.dims; ++i) {
+          inputSlices *= inputInfo.sizes[i];
+        }
+
+        dim3 grid;
+        if (!THC_getGridFromTiles(
+              THCCeilDiv(inputSlices, (int64_t) TOPK_SMALL_SLICE_WARPS_PER_BLOCK), grid)) {
+          THError("Slice to sort is too large");
+        }
+        dim3 block(TOPK_SMALL_SLICE_WARP_SIZE, TOPK_SMALL_SLICE_WARPS_PER_BLOCK);
+
+        // Values held by each lane, rounded up to a power of 2
+        int64_t itemsPerThread = 1;
+        while (itemsPerThread * TOPK_SMALL_SLICE_WARP_SIZE < sliceSize) {
+          itemsPerThread *= 2;
+        }
+        switch (itemsPerThread) {
+          case 1:
+            RUN_SMALL_SLICES(1);
+            break;
+          case 2:
+            RUN_SMALL_SLICES(2);
+            break;
+          case 4:
+            RUN_SMALL_SLICES(4);
+            break;
+          case 8:
+            RUN_SMALL_SLICES(8);
+            break;
+          case 16:
+            RUN_SMALL_SLICES(16);
+            break;
+          case 32:
+            RUN_SMALL_SLICES(32);
+            break;
+          default:
+            THError("Unexpected topk slice size");
+        }
+      } else {
+        RUN_T(uint32_t);
+      }
     } else {
       RUN_T(uint64_t);
     }
   }
+#undef RUN_SMALL_SLICES
+#undef RUN_SMALL_SLICES_DIR
 #undef RUN_T
 #undef RUN_DIM
 #undef RUN_DIR
@@ -139,12 +229,19 @@ void THCTensor_(topk)(THCState* state,
   // selection routine does not ensure sorting
   if (sorted) {
     // FIXME: the k/v inplace sort along slice only works for size <=
-    // 2048 at the moment
+    // 2048 at the moment. The slices being sorted are the k selected
+    // values, however large the input slices are.
+#if CUDA_VERSION >= 8000 && (defined(THC_REAL_IS_DOUBLE) || defined(THC_REAL_IS_LONG))
+    // See THCTensor_(sort) for the limit of the double word types
+    int64_t maxSortSize = 1024;
+#else
+    int64_t maxSortSize = 2048;
+#endif
 #ifdef __HIP_PLATFORM_HCC__
     // TODO bitonicSortKVInPlace hangs on ROCm currently.
     if (0) {
 #else
-    if (sliceSize <= 2048) {
+    if (k <= maxSortSize) {
 #endif
       // This avoids any memory allocations and performs all sorting
       // work inplace along the slice
@@ -0,0 +1,114 @@
+// Compares the batched linear algebra functions of ATen to a loop over the
+// matrices of the batch calling the single matrix functions, which is how a
+// batch was computed before the batched functions ran in parallel:
+//
+//   BM_BatchedGesv / BM_LoopGesv          gesv, with 4 right hand sides
+//   BM_BatchedInverse / BM_LoopInverse    inverse
+//   BM_BatchedCholesky / BM_LoopCholesky  cholesky
+//
+// The arguments of each benchmark are the number of rows of the matrices,
+// from the tiny ones factorized without LAPACK to ones large enough for
+// LAPACK to be worth calling, and the number of matrices in the batch.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+
+#include <vector>
+
+namespace {
+
+at::Tensor make_matrices(const benchmark::State& state) {
+  const int64_t n = state.range(0);
+  const int64_t batch = state.range(1);
+  // diagonally dominant, so non singular
+  return at::rand({batch, n, n}, at::kDouble) +
+      at::eye(n, at::kDouble).mul_(n);
+}
+
+at::Tensor make_rhs(const benchmark::State& state) {
+  return at::rand({state.range(1), state.range(0), 4}, at::kDouble);
+}
+
+at::Tensor make_pd_matrices(const benchmark::State& state) {
+  at::Tensor a = make_matrices(state);
+  return at::matmul(a, a.transpose(-2, -1));
+}
+
+void batch_arguments(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {2, 4, 8, 16, 32, 64}) {
+    for (int64_t batch : {16, 1024}) {
+      b->Args({n, batch});
+    }
+  }
+}
+
+void set_items_processed(benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+} // namespace
+
+static void BM_BatchedGesv(benchmark::State& state) {
+  at::Tensor a = make_matrices(state);
+  at::Tensor b = make_rhs(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::gesv(b, a));
+  }
+  set_items_processed(state);
+}
+BENCHMARK(BM_BatchedGesv)->Apply(batch_arguments);
+
+static void BM_LoopGesv(benchmark::State& state) {
+  at::Tensor a = make_matrices(state);
+  at::Tensor b = make_rhs(state);
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < a.size(0); i++) {
+      benchmark::DoNotOptimize(at::gesv(b[i], a[i]));
+    }
+  }
+  set_items_processed(state);
+}
+BENCHMARK(BM_LoopGesv)->Apply(batch_arguments);
+
+static void BM_BatchedInverse(benchmark::State& state) {
+  at::Tensor a = make_matrices(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::inverse(a));
+  }
+  set_items_processed(state);
+}
+BENCHMARK(BM_BatchedInverse)->Apply(batch_arguments);
+
+static void BM_LoopInverse(benchmark::State& state) {
+  at::Tensor a = make_matrices(state);
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < a.size(0); i++) {
+      benchmark::DoNotOptimize(at::inverse(a[i]));
+    }
+  }
+  set_items_processed(state);
+}
+BENCHMARK(BM_LoopInverse)->Apply(batch_arguments);
+
+static void BM_BatchedCholesky(benchmark::State& state) {
+  at::Tensor a = make_pd_matrices(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::cholesky(a));
+  }
+  set_items_processed(state);
+}
+BENCHMARK(BM_BatchedCholesky)->Apply(batch_arguments);
+
+static void BM_LoopCholesky(benchmark::State& state) {
+  at::Tensor a = make_pd_matrices(state);
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < a.size(0); i++) {
+      benchmark::DoNotOptimize(at::cholesky(a[i]));
+    }
+  }
+  set_items_processed(state);
+}
+BENCHMARK(BM_LoopCholesky)->Apply(batch_arguments);
+
+BENCHMARK_MAIN();
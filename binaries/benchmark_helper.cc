@@ -20,6 +20,7 @@
 #include <thread>
 
 #include "binaries/benchmark_helper.h"
+#include "binaries/benchmark_op_stats.h"
 #include "caffe2/core/blob_serialization.h"
 #ifdef __CUDA_ARCH__
 #include "caffe2/core/context_gpu.h"
@@ -34,6 +35,10 @@
 #include "observers/net_observer_reporter_print.h"
 #include "observers/observer_config.h"
 #include "observers/perf_observer.h"
+#ifdef CAFFE2_BENCHMARK_TORCHSCRIPT
+#include <torch/csrc/autograd/grad_mode.h>
+#include <torch/script.h>
+#endif
 
 using std::map;
 using std::shared_ptr;
@@ -313,6 +318,92 @@ void runNetwork(
   }
 }
 
+void runOperatorStats(
+    shared_ptr<caffe2::Workspace> workspace,
+    caffe2::NetDef& net_def,
+    map<string, caffe2::TensorProtos>& tensor_protos_map,
+    const bool wipe_cache,
+    const int iter,
+    const RooflineOptions& roofline,
+    const string& json_output) {
+  caffe2::NetBase* net = workspace->GetNet(net_def.name());
+  CHECK_NOTNULL(net);
+  auto before_run = [&](int i) {
+    fillInputBlob(workspace, tensor_protos_map, i);
+    if (wipe_cache) {
+      caffe2::wipe_cache();
+    }
+  };
+  LOG(INFO) << "Operator stats runs.";
+  auto net_latency = timeRuns(iter, before_run, [&](int i) {
+    CAFFE_ENFORCE(net->Run(), "Main run ", i, " has failed.");
+  });
+  auto op_stats = collectOperatorStats(net, iter, roofline, before_run);
+  printLatencyStats("Net " + net_def.name(), net_latency);
+  printOperatorStats(op_stats);
+  if (json_output.size()) {
+    writeStatsJson(json_output, net_def.name(), net_latency, op_stats);
+  }
+}
+
+void benchmarkTorchScript(
+    const string& model,
+    const string& input_dims,
+    const string& input_type,
+    const int warmup,
+    const int iter,
+    const bool wipe_cache,
+    const string& json_output) {
+#ifdef CAFFE2_BENCHMARK_TORCHSCRIPT
+  auto module = torch::jit::load(model);
+  CHECK_NOTNULL(module);
+  // The inputs are passed to forward() in order, so they have no names
+  vector<torch::jit::IValue> inputs;
+  if (input_dims.size()) {
+    vector<string> input_dims_list = caffe2::split(';', input_dims);
+    vector<string> input_type_list = caffe2::split(';', input_type);
+    CAFFE_ENFORCE_EQ(
+        input_dims_list.size(),
+        input_type_list.size(),
+        "Input dims and type should have the same number of items.");
+    for (size_t i = 0; i < input_dims_list.size(); ++i) {
+      vector<int64_t> dims;
+      for (const string& s : caffe2::split(',', input_dims_list[i])) {
+        dims.push_back(c10::stoi(s));
+      }
+      if (input_type_list[i] == "uint8_t") {
+        inputs.push_back(torch::randint(256, dims, torch::kUInt8));
+      } else if (input_type_list[i] == "float") {
+        inputs.push_back(torch::randn(dims));
+      } else {
+        CAFFE_THROW("Unsupported input type: ", input_type_list[i]);
+      }
+    }
+  }
+
+  torch::autograd::AutoGradMode no_grad(false);
+  LOG(INFO) << "Running warmup runs.";
+  for (int i = 0; i < warmup; ++i) {
+    module->forward(inputs);
+  }
+  LOG(INFO) << "Main runs.";
+  auto latency = timeRuns(
+      iter,
+      [&](int) {
+        if (wipe_cache) {
+          caffe2::wipe_cache();
+        }
+      },
+      [&](int) { module->forward(inputs); });
+  printLatencyStats("Model " + model, latency);
+  if (json_output.size()) {
+    writeStatsJson(json_output, model, latency, {});
+  }
+#else
+  CAFFE_THROW("This benchmark was built without TorchScript support.");
+#endif
+}
+
 void writeOutput(
     shared_ptr<caffe2::Workspace> workspace,
     const bool run_on_gpu,
@@ -374,7 +465,26 @@ int benchmark(
     int FLAGS_sleep_between_net_and_operator,
     bool FLAGS_text_output,
     int FLAGS_warmup,
-    bool FLAGS_wipe_cache) {
+    bool FLAGS_wipe_cache,
+    bool FLAGS_op_stats,
+    double FLAGS_peak_gflops,
+    double FLAGS_peak_gbps,
+    double FLAGS_roofline_threshold,
+    const string& FLAGS_json_output,
+    const string& FLAGS_model) {
+  caffe2::ShowLogInfoToStderr();
+  if (FLAGS_model.size()) {
+    benchmarkTorchScript(
+        FLAGS_model,
+        FLAGS_input_dims,
+        FLAGS_input_type,
+        FLAGS_warmup,
+        FLAGS_iter,
+        FLAGS_wipe_cache,
+        FLAGS_json_output);
+    return 0;
+  }
+
   // Check arguments to be correct
   {
     // Need to check whether file exists, as the file reader does not assert if
@@ -398,7 +508,6 @@ int benchmark(
   }
 
   observerConfig();
-  caffe2::ShowLogInfoToStderr();
 
   auto workspace = std::make_shared<caffe2::Workspace>(new caffe2::Workspace());
   bool run_on_gpu = backendCudaSet(FLAGS_backend);
@@ -436,6 +545,21 @@ int benchmark(
       FLAGS_sleep_between_iteration,
       FLAGS_sleep_between_net_and_operator);
 
+  if (FLAGS_op_stats) {
+    RooflineOptions roofline;
+    roofline.peak_gflops = FLAGS_peak_gflops;
+    roofline.peak_gbps = FLAGS_peak_gbps;
+    roofline.threshold = FLAGS_roofline_threshold;
+    runOperatorStats(
+        workspace,
+        net_def,
+        tensor_protos_map,
+        FLAGS_wipe_cache,
+        FLAGS_iter,
+        roofline,
+        FLAGS_json_output);
+  }
+
   writeOutput(
       workspace,
       run_on_gpu,
@@ -24,6 +24,8 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/utils/string_utils.h"
 
+struct RooflineOptions;
+
 using std::map;
 using std::shared_ptr;
 using std::string;
@@ -115,6 +117,22 @@ void runNetwork(
     const int,
     const int,
     const int);
+void runOperatorStats(
+    shared_ptr<caffe2::Workspace>,
+    caffe2::NetDef&,
+    map<string, caffe2::TensorProtos>&,
+    const bool,
+    const int,
+    const RooflineOptions&,
+    const string&);
+void benchmarkTorchScript(
+    const string&,
+    const string&,
+    const string&,
+    const int,
+    const int,
+    const bool,
+    const string&);
 int benchmark(
     int argc,
     char* argv[],
@@ -134,4 +152,10 @@ int benchmark(
     int FLAGS_sleep_between_net_and_operator,
     bool FLAGS_text_output,
     int FLAGS_warmup,
-    bool FLAGS_wipe_cache);
+    bool FLAGS_wipe_cache,
+    bool FLAGS_op_stats,
+    double FLAGS_peak_gflops,
+    double FLAGS_peak_gbps,
+    double FLAGS_roofline_threshold,
+    const string& FLAGS_json_output,
+    const string& FLAGS_model);
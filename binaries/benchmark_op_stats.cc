@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "binaries/benchmark_op_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// The nearest-rank percentile of sorted times
+float percentile(const vector<float>& sorted, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+bool allShapesKnown(const vector<caffe2::TensorShape>& shapes) {
+  return std::all_of(
+      shapes.begin(), shapes.end(), [](const caffe2::TensorShape& shape) {
+        return !shape.unknown_shape();
+      });
+}
+
+void fillThroughput(OperatorStats& stats, const RooflineOptions& roofline) {
+  if (!stats.has_cost || stats.latency.p50_ms <= 0) {
+    return;
+  }
+  const double bytes = static_cast<double>(stats.cost.bytes_read) +
+      stats.cost.bytes_written + stats.cost.params_bytes;
+  const double flops = static_cast<double>(stats.cost.flops);
+  // x / (ms * 1e6) is x / 1e9 per second
+  stats.gflops = flops / (stats.latency.p50_ms * 1e6);
+  stats.gbps = bytes / (stats.latency.p50_ms * 1e6);
+  if (roofline.peak_gflops <= 0 || roofline.peak_gbps <= 0) {
+    return;
+  }
+  if (flops > 0 && bytes > 0) {
+    const double attainable =
+        std::min(roofline.peak_gflops, flops / bytes * roofline.peak_gbps);
+    stats.roofline_fraction = stats.gflops / attainable;
+  } else if (flops > 0) {
+    stats.roofline_fraction = stats.gflops / roofline.peak_gflops;
+  } else if (bytes > 0) {
+    // Operators that only move data are bound by the bandwidth
+    stats.roofline_fraction = stats.gbps / roofline.peak_gbps;
+  } else {
+    return;
+  }
+  stats.below_roofline = stats.roofline_fraction < roofline.threshold;
+}
+
+string jsonEscape(const string& str) {
+  std::stringstream escaped;
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        escaped << "\\\"";
+        break;
+      case '\\':
+        escaped << "\\\\";
+        break;
+      case '\n':
+        escaped << "\\n";
+        break;
+      case '\t':
+        escaped << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                  << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+          escaped << c;
+        }
+    }
+  }
+  return escaped.str();
+}
+
+void writeLatencyJson(std::ostream& out, const LatencyStats& latency) {
+  out << "\"runs\": " << latency.runs << ", \"mean_ms\": " << latency.mean_ms
+      << ", \"p50_ms\": " << latency.p50_ms
+      << ", \"p90_ms\": " << latency.p90_ms
+      << ", \"p99_ms\": " << latency.p99_ms;
+}
+
+} // namespace
+
+LatencyStats computeLatencyStats(vector<float> times_ms) {
+  LatencyStats stats;
+  stats.runs = times_ms.size();
+  if (times_ms.empty()) {
+    return stats;
+  }
+  std::sort(times_ms.begin(), times_ms.end());
+  stats.mean_ms = std::accumulate(times_ms.begin(), times_ms.end(), 0.0) /
+      times_ms.size();
+  stats.p50_ms = percentile(times_ms, 0.5);
+  stats.p90_ms = percentile(times_ms, 0.9);
+  stats.p99_ms = percentile(times_ms, 0.99);
+  return stats;
+}
+
+LatencyStats timeRuns(
+    int iter,
+    const std::function<void(int)>& before_run,
+    const std::function<void(int)>& run) {
+  vector<float> times_ms;
+  times_ms.reserve(iter);
+  caffe2::Timer timer;
+  for (int i = 0; i < iter; ++i) {
+    before_run(i);
+    timer.Start();
+    run(i);
+    times_ms.push_back(timer.MilliSeconds());
+  }
+  return computeLatencyStats(std::move(times_ms));
+}
+
+vector<OperatorStats> collectOperatorStats(
+    caffe2::NetBase* net,
+    int iter,
+    const RooflineOptions& roofline,
+    const std::function<void(int)>& before_run) {
+  CAFFE_ENFORCE(
+      iter > 0, "Number of runs should be positive, provided ", iter, ".");
+  const auto operators = net->GetOperators();
+  vector<OperatorStats> stats(operators.size());
+  vector<vector<float>> times_ms(operators.size());
+  caffe2::Timer timer;
+  for (int i = 0; i < iter; ++i) {
+    before_run(i);
+    for (size_t idx = 0; idx < operators.size(); ++idx) {
+      auto* op = operators[idx];
+      const auto& def = op->debug_def();
+      if (i == 0) {
+        // The inputs only all have shapes once the operators before have run
+        auto* schema = caffe2::OpSchemaRegistry::Schema(def.type());
+        if (schema && schema->HasCostInferenceFunction()) {
+          const auto shapes = op->InputTensorShapes();
+          if (allShapesKnown(shapes)) {
+            stats[idx].cost = schema->InferCost(def, shapes);
+            stats[idx].has_cost = true;
+          }
+        }
+      }
+      timer.Start();
+      CAFFE_ENFORCE(
+          op->Run(),
+          "operator ",
+          def.name(),
+          "(",
+          def.type(),
+          ") has failed.");
+      times_ms[idx].push_back(timer.MilliSeconds());
+    }
+  }
+
+  for (size_t idx = 0; idx < operators.size(); ++idx) {
+    const auto& def = operators[idx]->debug_def();
+    stats[idx].name = def.name().size()
+        ? def.name()
+        : (def.output_size() ? def.output(0) : "NO_OUTPUT");
+    stats[idx].type = def.type();
+    stats[idx].latency = computeLatencyStats(std::move(times_ms[idx]));
+    fillThroughput(stats[idx], roofline);
+  }
+  return stats;
+}
+
+void printLatencyStats(const string& name, const LatencyStats& latency) {
+  /* Use std::cout because logging may be disabled */
+  std::cout << name << ": mean " << latency.mean_ms << " ms, p50 "
+            << latency.p50_ms << " ms, p90 " << latency.p90_ms << " ms, p99 "
+            << latency.p99_ms << " ms over " << latency.runs << " runs"
+            << std::endl;
+}
+
+void printOperatorStats(const vector<OperatorStats>& stats) {
+  /* Use std::cout because logging may be disabled */
+  for (size_t idx = 0; idx < stats.size(); ++idx) {
+    const auto& op = stats[idx];
+    std::cout << "Operator #" << idx << " (" << op.name << ", " << op.type
+              << ") p50 " << op.latency.p50_ms << " ms, p90 "
+              << op.latency.p90_ms << " ms, p99 " << op.latency.p99_ms
+              << " ms";
+    if (op.has_cost) {
+      std::cout << " (" << 1.0e-9 * op.cost.flops << " GFLOP, " << op.gflops
+                << " GFLOPS, " << op.gbps << " GB/s)";
+    }
+    if (op.roofline_fraction >= 0) {
+      std::cout << " " << 100.0 * op.roofline_fraction << "% of roofline";
+      if (op.below_roofline) {
+        std::cout << " [BELOW ROOFLINE]";
+      }
+    }
+    std::cout << std::endl;
+  }
+}
+
+void writeStatsJson(
+    const string& path,
+    const string& name,
+    const LatencyStats& latency,
+    const vector<OperatorStats>& op_stats) {
+  std::ofstream out(path);
+  CAFFE_ENFORCE(out.good(), "Cannot open ", path, " for writing.");
+  out << "{\"name\": \"" << jsonEscape(name) << "\", ";
+  writeLatencyJson(out, latency);
+  out << ", \"operators\": [";
+  for (size_t idx = 0; idx < op_stats.size(); ++idx) {
+    const auto& op = op_stats[idx];
+    out << (idx ? ",\n  " : "\n  ") << "{\"index\": " << idx
+        << ", \"name\": \"" << jsonEscape(op.name) << "\", \"type\": \""
+        << jsonEscape(op.type) << "\", ";
+    writeLatencyJson(out, op.latency);
+    if (op.has_cost) {
+      out << ", \"flops\": " << op.cost.flops
+          << ", \"bytes_read\": " << op.cost.bytes_read
+          << ", \"bytes_written\": " << op.cost.bytes_written
+          << ", \"params_bytes\": " << op.cost.params_bytes
+          << ", \"gflops\": " << op.gflops << ", \"gbps\": " << op.gbps;
+    }
+    if (op.roofline_fraction >= 0) {
+      out << ", \"roofline_fraction\": " << op.roofline_fraction
+          << ", \"below_roofline\": " << (op.below_roofline ? "true" : "false");
+    }
+    out << "}";
+  }
+  out << "]}" << std::endl;
+  CAFFE_ENFORCE(out.good(), "Failed to write ", path, ".");
+}
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator_schema.h"
+
+// Latency percentiles over the runs of a benchmark, in milliseconds.
+struct LatencyStats {
+  int runs{0};
+  float mean_ms{0};
+  float p50_ms{0};
+  float p90_ms{0};
+  float p99_ms{0};
+};
+
+LatencyStats computeLatencyStats(std::vector<float> times_ms);
+
+// Times run(i) for every run i in [0, iter), after calling before_run(i),
+// which is not timed.
+LatencyStats timeRuns(
+    int iter,
+    const std::function<void(int)>& before_run,
+    const std::function<void(int)>& run);
+
+// The peak compute and memory bandwidth of the device the net runs on. When
+// both are given, every operator is placed on the roofline they make: its
+// attainable throughput is the smaller of the peak compute and of its
+// arithmetic intensity (FLOP per byte moved) times the peak bandwidth.
+struct RooflineOptions {
+  double peak_gflops{0};
+  double peak_gbps{0};
+  // Operators below this fraction of their attainable throughput are flagged
+  double threshold{0.1};
+};
+
+struct OperatorStats {
+  std::string name;
+  std::string type;
+  LatencyStats latency;
+  // Whether the schema of the operator has a cost inference function and the
+  // shapes of all inputs are known.
+  bool has_cost{false};
+  caffe2::OpSchema::Cost cost;
+  // Throughputs at the median latency
+  double gflops{0};
+  double gbps{0};
+  // Fraction of the attainable throughput, negative without a roofline or a
+  // cost.
+  double roofline_fraction{-1};
+  bool below_roofline{false};
+};
+
+// Times every operator of the net on its own for iter runs, after calling
+// before_run(i) for every run i, and infers its cost from its schema.
+std::vector<OperatorStats> collectOperatorStats(
+    caffe2::NetBase* net,
+    int iter,
+    const RooflineOptions& roofline,
+    const std::function<void(int)>& before_run);
+
+// Prints the latency percentiles of what is called name.
+void printLatencyStats(const std::string& name, const LatencyStats& latency);
+
+void printOperatorStats(const std::vector<OperatorStats>& stats);
+
+// Writes the latency of the whole net or model, and the stats of its
+// operators if there are any, as JSON to the file at path.
+void writeStatsJson(
+    const std::string& path,
+    const std::string& name,
+    const LatencyStats& latency,
+    const std::vector<OperatorStats>& op_stats);
@@ -80,6 +80,38 @@ C10_DEFINE_bool(
     wipe_cache,
     false,
     "Whether to evict the cache before running network.");
+C10_DEFINE_bool(
+    op_stats,
+    false,
+    "Whether to time every operator on its own for iter more runs, and "
+    "report the p50, p90 and p99 latency of the net and of every operator, "
+    "with the throughput inferred from the operator schema's cost.");
+C10_DEFINE_double(
+    peak_gflops,
+    0,
+    "The peak GFLOP/s of the device, to flag operators far from the "
+    "roofline in op_stats. Requires peak_gbps.");
+C10_DEFINE_double(
+    peak_gbps,
+    0,
+    "The peak memory bandwidth of the device in GB/s, to flag operators far "
+    "from the roofline in op_stats. Requires peak_gflops.");
+C10_DEFINE_double(
+    roofline_threshold,
+    0.1,
+    "The fraction of their attainable throughput under which operators are "
+    "flagged in op_stats.");
+C10_DEFINE_string(
+    json_output,
+    "",
+    "The file to write the latency percentiles, and the op_stats if any, to "
+    "as JSON.");
+C10_DEFINE_string(
+    model,
+    "",
+    "A TorchScript model to benchmark instead of a net. Its inputs are "
+    "random tensors of the input_dims and input_type, passed to forward() "
+    "in order.");
 
 int main(int argc, char** argv) {
   caffe2::GlobalInit(&argc, &argv);
@@ -102,5 +134,11 @@ int main(int argc, char** argv) {
       FLAGS_sleep_between_net_and_operator,
       FLAGS_text_output,
       FLAGS_warmup,
-      FLAGS_wipe_cache);
+      FLAGS_wipe_cache,
+      FLAGS_op_stats,
+      FLAGS_peak_gflops,
+      FLAGS_peak_gbps,
+      FLAGS_roofline_threshold,
+      FLAGS_json_output,
+      FLAGS_model);
 }
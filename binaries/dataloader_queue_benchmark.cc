@@ -0,0 +1,54 @@
+// Measures the throughput of the DataLoader queue with as many producer as
+// consumer threads. The argument of the benchmark is the number of threads on
+// each side; every iteration moves kElements elements through a queue with
+// room for 16 of them.
+
+#include "benchmark/benchmark.h"
+
+#include <torch/data/detail/queue.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kElements = 1 << 16;
+
+} // namespace
+
+static void BM_QueueManyProducersAndConsumers(benchmark::State& state) {
+  const size_t workers = state.range(0);
+  while (state.KeepRunning()) {
+    torch::data::detail::Queue<size_t> queue(16);
+    std::atomic<size_t> sum(0);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+      threads.emplace_back([&queue, w, workers] {
+        for (size_t i = w; i < kElements; i += workers) {
+          queue.push(i);
+        }
+      });
+      threads.emplace_back([&queue, &sum, w, workers] {
+        size_t local = 0;
+        for (size_t i = w; i < kElements; i += workers) {
+          local += queue.pop();
+        }
+        sum += local;
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    benchmark::DoNotOptimize(sum.load());
+  }
+  state.SetItemsProcessed(state.iterations() * kElements);
+}
+BENCHMARK(BM_QueueManyProducersAndConsumers)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
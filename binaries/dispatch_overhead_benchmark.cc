@@ -0,0 +1,135 @@
+// Measures the per op cost of each layer an ATen op goes through, from the
+// native function itself to the JIT interpreter. The ops are run on empty,
+// scalar and small tensors, so that the time of a benchmark is mostly
+// overhead, and the difference between two benchmarks is the cost of a layer:
+//
+//   BM_NativeAdd           at::native::add, not dispatched on the type
+//   BM_TypeDispatchAdd     at::add, dispatched through the Type of the tensor
+//   BM_VariableAdd         at::add on variables, through VariableType
+//   BM_VariableAddGrad     the same, recording the autograd graph
+//   BM_ProfiledVariableAdd the same as BM_VariableAdd with the profiler on,
+//                          which times the RecordFunction of every op
+//   BM_InterpreterAdd      a script function, run by the JIT interpreter
+//
+// The argument of each benchmark selects the tensor: 0 for an empty tensor,
+// 1 for a scalar (0-dim) tensor, and 64 for an 8x8 tensor.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+
+#include "torch/csrc/autograd/profiler.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/script/compiler.h"
+#include "torch/csrc/jit/script/module.h"
+#include "torch/csrc/jit/stack.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+at::Tensor make_input(const benchmark::State& state) {
+  switch (state.range(0)) {
+    case 0:
+      return at::ones({0}, at::kFloat);
+    case 1:
+      return at::ones({}, at::kFloat);
+    default:
+      return at::ones({8, state.range(0) / 8}, at::kFloat);
+  }
+}
+
+at::Tensor make_variable_input(const benchmark::State& state, bool requires_grad) {
+  return torch::autograd::make_variable(make_input(state), requires_grad);
+}
+
+// The profiler keeps the events of every op, which are dropped once in a
+// while without timing it
+constexpr int64_t kEventsPerProfile = 1 << 16;
+
+} // namespace
+
+static void BM_NativeAdd(benchmark::State& state) {
+  at::Tensor a = make_input(state);
+  at::Tensor b = make_input(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::native::add(a, b));
+  }
+}
+BENCHMARK(BM_NativeAdd)->Arg(0)->Arg(1)->Arg(64);
+
+static void BM_TypeDispatchAdd(benchmark::State& state) {
+  at::Tensor a = make_input(state);
+  at::Tensor b = make_input(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::add(a, b));
+  }
+}
+BENCHMARK(BM_TypeDispatchAdd)->Arg(0)->Arg(1)->Arg(64);
+
+static void BM_VariableAdd(benchmark::State& state) {
+  at::Tensor a = make_variable_input(state, /*requires_grad=*/false);
+  at::Tensor b = make_variable_input(state, /*requires_grad=*/false);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::add(a, b));
+  }
+}
+BENCHMARK(BM_VariableAdd)->Arg(0)->Arg(1)->Arg(64);
+
+static void BM_VariableAddGrad(benchmark::State& state) {
+  at::Tensor a = make_variable_input(state, /*requires_grad=*/true);
+  at::Tensor b = make_variable_input(state, /*requires_grad=*/true);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::add(a, b));
+  }
+}
+BENCHMARK(BM_VariableAddGrad)->Arg(0)->Arg(1)->Arg(64);
+
+static void BM_ProfiledVariableAdd(benchmark::State& state) {
+  namespace profiler = torch::autograd::profiler;
+  at::Tensor a = make_variable_input(state, /*requires_grad=*/false);
+  at::Tensor b = make_variable_input(state, /*requires_grad=*/false);
+  profiler::enableProfiler(profiler::ProfilerState::CPU);
+  int64_t events = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(at::add(a, b));
+    if (++events == kEventsPerProfile) {
+      state.PauseTiming();
+      profiler::disableProfiler();
+      profiler::enableProfiler(profiler::ProfilerState::CPU);
+      events = 0;
+      state.ResumeTiming();
+    }
+  }
+  profiler::disableProfiler();
+}
+BENCHMARK(BM_ProfiledVariableAdd)->Arg(0)->Arg(1)->Arg(64);
+
+static void BM_InterpreterAdd(benchmark::State& state) {
+  using namespace torch::jit;
+  auto module = std::make_shared<script::Module>();
+  script::defineMethodsInModule(
+      module,
+      R"JIT(
+def add(a, b):
+    return a + b
+)JIT",
+      script::nativeResolver,
+      /*self=*/nullptr);
+  script::Method& method = module->get_method("add");
+
+  at::Tensor a = make_variable_input(state, /*requires_grad=*/false);
+  at::Tensor b = make_variable_input(state, /*requires_grad=*/false);
+  Stack stack;
+  while (state.KeepRunning()) {
+    stack.clear();
+    push(stack, a, b);
+    method.run(stack);
+    benchmark::DoNotOptimize(stack);
+  }
+}
+BENCHMARK(BM_InterpreterAdd)->Arg(0)->Arg(1)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,100 @@
+// Measures the time the JIT takes to copy a graph and to run a few graph
+// passes over it, which is mostly the time to allocate, free, and hash nodes
+// and values:
+//
+//   BM_GraphCopy                      Graph::copy, then destroying the copy
+//   BM_EliminateCommonSubexpression   CSE, which hashes every node
+//   BM_EliminateDeadCode              DCE, which frees the unused nodes
+//   BM_ConstantPooling                pooling the repeated constants
+//
+// The argument of each benchmark is the number of statements of the script
+// function the graph is compiled from. Each statement computes the same
+// expression twice, from repeated constants, and an unused value, so that
+// every pass has something to do. The passes run on a copy of the graph,
+// which isn't timed.
+
+#include "benchmark/benchmark.h"
+
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/passes/common_subexpression_elimination.h"
+#include "torch/csrc/jit/passes/constant_pooling.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/script/compiler.h"
+#include "torch/csrc/jit/script/module.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using namespace torch::jit;
+
+std::shared_ptr<Graph> make_graph(int64_t statements) {
+  std::ostringstream source;
+  source << "def f(x):\n";
+  source << "    a0 = x\n";
+  for (int64_t i = 1; i <= statements; i++) {
+    source << "    b = a" << i - 1 << " * 2 + 1\n";
+    source << "    c = a" << i - 1 << " * 2 + 1\n";
+    source << "    unused = a" << i - 1 << " - 3\n";
+    source << "    a" << i << " = b + c\n";
+  }
+  source << "    return a" << statements << "\n";
+
+  auto module = std::make_shared<script::Module>();
+  script::defineMethodsInModule(
+      module, source.str(), script::nativeResolver, /*self=*/nullptr);
+  return module->get_method("f").graph()->copy();
+}
+
+template <typename Pass>
+void run_pass(benchmark::State& state, Pass pass) {
+  auto graph = make_graph(state.range(0));
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto copy = graph->copy();
+    state.ResumeTiming();
+    pass(copy);
+    state.PauseTiming();
+    copy.reset();
+    state.ResumeTiming();
+  }
+}
+
+void graph_arguments(benchmark::internal::Benchmark* b) {
+  b->Arg(100)->Arg(1000)->Arg(10000);
+}
+
+} // namespace
+
+static void BM_GraphCopy(benchmark::State& state) {
+  auto graph = make_graph(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(graph->copy());
+  }
+}
+BENCHMARK(BM_GraphCopy)->Apply(graph_arguments);
+
+static void BM_EliminateCommonSubexpression(benchmark::State& state) {
+  run_pass(state, [](std::shared_ptr<Graph>& graph) {
+    EliminateCommonSubexpression(graph);
+  });
+}
+BENCHMARK(BM_EliminateCommonSubexpression)->Apply(graph_arguments);
+
+static void BM_EliminateDeadCode(benchmark::State& state) {
+  run_pass(state, [](std::shared_ptr<Graph>& graph) {
+    EliminateDeadCode(graph);
+  });
+}
+BENCHMARK(BM_EliminateDeadCode)->Apply(graph_arguments);
+
+static void BM_ConstantPooling(benchmark::State& state) {
+  run_pass(state, [](std::shared_ptr<Graph>& graph) {
+    ConstantPooling(graph);
+  });
+}
+BENCHMARK(BM_ConstantPooling)->Apply(graph_arguments);
+
+BENCHMARK_MAIN();
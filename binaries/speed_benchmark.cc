@@ -16,6 +16,7 @@
 
 #include <string>
 
+#include "binaries/benchmark_op_stats.h"
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/init.h"
 #include "caffe2/core/logging.h"
@@ -71,6 +72,32 @@ C10_DEFINE_bool(
     false,
     "Whether to benchmark individual operators.");
 
+C10_DEFINE_bool(
+    op_stats,
+    false,
+    "Whether to time every operator on its own for iter more runs, and "
+    "report the p50, p90 and p99 latency of the net and of every operator, "
+    "with the throughput inferred from the operator schema's cost.");
+C10_DEFINE_double(
+    peak_gflops,
+    0,
+    "The peak GFLOP/s of the device, to flag operators far from the "
+    "roofline in op_stats. Requires peak_gbps.");
+C10_DEFINE_double(
+    peak_gbps,
+    0,
+    "The peak memory bandwidth of the device in GB/s, to flag operators far "
+    "from the roofline in op_stats. Requires peak_gflops.");
+C10_DEFINE_double(
+    roofline_threshold,
+    0.1,
+    "The fraction of their attainable throughput under which operators are "
+    "flagged in op_stats.");
+C10_DEFINE_string(
+    json_output,
+    "",
+    "The file to write the op_stats to as JSON.");
+
 C10_DEFINE_bool(force_engine, false, "Force engine field for all operators");
 C10_DEFINE_string(engine, "", "Forced engine field value");
 C10_DEFINE_bool(force_algo, false, "Force algo arg for all operators");
@@ -187,6 +214,23 @@ int main(int argc, char** argv) {
   CHECK_NOTNULL(net);
   CAFFE_ENFORCE(net->Run());
   net->TEST_Benchmark(FLAGS_warmup, FLAGS_iter, FLAGS_run_individual);
+  if (FLAGS_op_stats) {
+    RooflineOptions roofline;
+    roofline.peak_gflops = FLAGS_peak_gflops;
+    roofline.peak_gbps = FLAGS_peak_gbps;
+    roofline.threshold = FLAGS_roofline_threshold;
+    auto no_setup = [](int) {};
+    auto net_latency = timeRuns(FLAGS_iter, no_setup, [&](int i) {
+      CAFFE_ENFORCE(net->Run(), "Main run ", i, " has failed.");
+    });
+    auto op_stats =
+        collectOperatorStats(net, FLAGS_iter, roofline, no_setup);
+    printLatencyStats("Net " + net_def.name(), net_latency);
+    printOperatorStats(op_stats);
+    if (FLAGS_json_output.size()) {
+      writeStatsJson(FLAGS_json_output, net_def.name(), net_latency, op_stats);
+    }
+  }
 
   string output_prefix =
       FLAGS_output_folder.size() ? FLAGS_output_folder + "/" : "";
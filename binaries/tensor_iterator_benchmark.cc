@@ -0,0 +1,33 @@
+// Measures the per call cost of small element-wise ops, which is dominated by
+// building the TensorIterator rather than by the loop over the elements:
+//
+//   BM_AddOut        add_out on contiguous operands of the same shape
+//   BM_MulScalarOut  mul_out by a zero-dim tensor
+//
+// The argument of each benchmark is the number of elements of the operands.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+
+static void BM_AddOut(benchmark::State& state) {
+  auto a = at::ones({state.range(0)}, at::kFloat);
+  auto b = at::ones({state.range(0)}, at::kFloat);
+  auto out = at::empty({state.range(0)}, at::kFloat);
+  while (state.KeepRunning()) {
+    at::add_out(out, a, b);
+  }
+}
+BENCHMARK(BM_AddOut)->Arg(1)->Arg(16)->Arg(256)->Arg(1024);
+
+static void BM_MulScalarOut(benchmark::State& state) {
+  auto a = at::ones({state.range(0)}, at::kFloat);
+  auto two = at::full({}, 2, at::kFloat);
+  auto out = at::empty({state.range(0)}, at::kFloat);
+  while (state.KeepRunning()) {
+    at::mul_out(out, a, two);
+  }
+}
+BENCHMARK(BM_MulScalarOut)->Arg(1)->Arg(16)->Arg(256)->Arg(1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+// Measures the latency of the caffe2 thread pool against the CPU it burns
+// waiting, when jobs come one after another or with a gap between them, as
+// between the ops of a net:
+//
+//   BM_ThreadPoolFixedSpin     workers spinning for a fixed number of cycles
+//   BM_ThreadPoolAdaptiveSpin  workers spinning for about as long as their
+//                              recent waits took
+//
+// The arguments of each benchmark are the gap between two jobs in
+// microseconds and the number of threads of the pool. The time reported is
+// the latency of a job, the cpu_us counter is the CPU time of the process,
+// all threads included, per job and the gap before it.
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/core/logging.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+C10_DECLARE_bool(caffe2_threadpool_adaptive_spin);
+
+namespace {
+
+double process_cpu_us() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 +
+      usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void run_jobs(benchmark::State& state, bool adaptive_spin) {
+  const auto gap = std::chrono::microseconds(state.range(0));
+  FLAGS_caffe2_threadpool_adaptive_spin = adaptive_spin;
+  caffe2::ThreadPool pool(state.range(1));
+  std::atomic<int> items{0};
+  const auto fn = [&items](int, size_t) { items++; };
+  // Creates the workers
+  pool.run(fn, state.range(1));
+
+  const double start_cpu_us = process_cpu_us();
+  while (state.KeepRunning()) {
+    if (gap.count()) {
+      std::this_thread::sleep_for(gap);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    pool.run(fn, state.range(1));
+    state.SetIterationTime(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count());
+  }
+  state.counters["cpu_us"] =
+      (process_cpu_us() - start_cpu_us) / state.iterations();
+}
+
+void pool_arguments(benchmark::internal::Benchmark* b) {
+  for (int64_t gap_us : {0, 100, 1000, 10000}) {
+    for (int64_t threads : {2, 4}) {
+      b->Args({gap_us, threads});
+    }
+  }
+  b->UseManualTime();
+}
+
+} // namespace
+
+static void BM_ThreadPoolFixedSpin(benchmark::State& state) {
+  run_jobs(state, false);
+}
+BENCHMARK(BM_ThreadPoolFixedSpin)->Apply(pool_arguments);
+
+static void BM_ThreadPoolAdaptiveSpin(benchmark::State& state) {
+  run_jobs(state, true);
+}
+BENCHMARK(BM_ThreadPoolAdaptiveSpin)->Apply(pool_arguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,65 @@
+#pragma once
+
+/// Defines the BFloat16 type (brain floating-point), which is the upper half
+/// of an IEEE float32: it has the 8 exponent bits of float, and so its range,
+/// but only 7 bits of mantissa. Conversions to float are exact, conversions
+/// from float round to the nearest even BFloat16. Like Half, arithmetic
+/// operations convert to float and compute in float32; kernels accumulate in
+/// float as well.
+
+#include <c10/macros/Macros.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <limits>
+
+namespace c10 {
+
+namespace detail {
+
+inline C10_HOST_DEVICE float f32_from_bf16_bits(uint16_t bits) {
+  uint32_t tmp = static_cast<uint32_t>(bits) << 16;
+  float res;
+  std::memcpy(&res, &tmp, sizeof(tmp));
+  return res;
+}
+
+// Rounds to the nearest even BFloat16, and maps all NaNs to the quiet NaN so
+// that rounding cannot turn a NaN to an infinity.
+inline C10_HOST_DEVICE uint16_t bf16_bits_from_f32(float value) {
+  if (value != value) {
+    return 0x7FC0;
+  }
+  uint32_t tmp;
+  std::memcpy(&tmp, &value, sizeof(tmp));
+  uint32_t rounding_bias = ((tmp >> 16) & 1) + 0x7FFF;
+  return static_cast<uint16_t>((tmp + rounding_bias) >> 16);
+}
+
+} // namespace detail
+
+struct alignas(2) BFloat16 {
+  uint16_t x;
+
+  struct from_bits_t {};
+  static constexpr from_bits_t from_bits = from_bits_t();
+
+  // HIP wants __host__ __device__ tag, CUDA does not
+#ifdef __HIP_PLATFORM_HCC__
+  C10_HOST_DEVICE BFloat16() = default;
+#else
+  BFloat16() = default;
+#endif
+
+  constexpr C10_HOST_DEVICE BFloat16(uint16_t bits, from_bits_t) : x(bits){};
+  inline C10_HOST_DEVICE BFloat16(float value);
+  inline C10_HOST_DEVICE operator float() const;
+};
+
+C10_API std::ostream& operator<<(std::ostream& out, const BFloat16& value);
+
+} // namespace c10
+
+#include "c10/BFloat16-inl.h"
@@ -3,12 +3,15 @@
 #include <c10/core/dispatch/OpSchema.h>
 #include <c10/util/LeftRight.h>
 #include <c10/util/Metaprogramming.h>
+#include <c10/util/TensorTypeId.h>
 #include <c10/util/flat_hash_map.h>
 
 #include <array>
 #include <atomic>
 #include <iostream>
+#include <limits>
 #include <mutex>
+#include <sstream>
 #include <type_traits>
 #include <unordered_map>
 
@@ -58,6 +61,62 @@ class ThreadsafeOperatorTable_ final {
  private:
   LeftRight<ska::flat_hash_map<Key, void*>> map_;
 };
+
+/// Kernel implementations of an operator dispatched on a single TensorTypeId,
+/// in a flat table indexed by the id, so that a lookup is a single load
+/// instead of hashing and probing a map. Like the map, the table is read
+/// through a LeftRight, which registering kernels never blocks.
+template <>
+class ThreadsafeOperatorTable_<TensorTypeId> final {
+ public:
+  void emplace(TensorTypeId key, void* value) {
+    bool res = table_.write([&](Table& table) -> bool {
+      void*& entry = table.kernels[key.index()];
+      if (entry != nullptr) {
+        return false;
+      }
+      entry = value;
+      return true;
+    });
+    if (!res) {
+      std::ostringstream msg;
+      msg << "Tried to register conflicting kernels to the dispatcher: " << key;
+      throw std::logic_error(msg.str());
+    }
+  }
+
+  void erase(TensorTypeId key) {
+    bool res = table_.write([&](Table& table) -> bool {
+      void*& entry = table.kernels[key.index()];
+      if (entry == nullptr) {
+        return false;
+      }
+      entry = nullptr;
+      return true;
+    });
+    if (!res) {
+      throw std::logic_error(
+          "Tried to deregister a kernel that isn't registered.");
+    }
+  }
+
+  void* lookup(TensorTypeId key) const {
+    return table_.read([&](const Table& table) -> void* {
+      return table.kernels[key.index()];
+    });
+  }
+
+ private:
+  struct Table final {
+    // one entry for each possible TensorTypeId, null where no kernel is
+    // registered
+    std::array<
+        void*,
+        std::numeric_limits<details::_tensorTypeId_underlyingType>::max() + 1>
+        kernels{};
+  };
+  LeftRight<Table> table_;
+};
 } // namespace details
 
 /**
@@ -129,11 +188,10 @@ class DispatchTable final {
     auto dispatch_key = Schema::dispatch::dispatch_key(args...);
     void* found = kernels_.lookup(dispatch_key);
     if (found == nullptr) {
-      // TODO Better error message - include op name and dispatch key (i.e.
-      // argument types)
-      throw std::logic_error(
-          std::string() + "Didn't find kernel to dispatch to for operator '" +
-          Schema::metadata::name() + "'");
+      std::ostringstream msg;
+      msg << "Didn't find kernel to dispatch to for operator '"
+          << Schema::metadata::name() << "' and dispatch key " << dispatch_key;
+      throw std::logic_error(msg.str());
     }
     return reinterpret_cast<typename Schema::signature::func_type*>(found);
   }
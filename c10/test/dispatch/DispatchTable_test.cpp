@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "c10/core/dispatch/KernelRegistration.h"
+#include "c10/core/dispatch/OpSchemaRegistration.h"
+#include "c10/util/TensorTypeIdRegistration.h"
+
+using namespace c10;
+
+namespace {
+
+struct FakeTensor final {
+  TensorTypeId type_id;
+};
+
+// dispatches on the TensorTypeId of its argument, with a flat table
+struct TypeIdSchemaDef final {
+  static constexpr const char* name = "type_id_op";
+  using Signature = int(const FakeTensor& tensor, int value);
+  static constexpr guts::array<const char*, 2> parameter_names = {
+      {"tensor", "value"}};
+  static TensorTypeId dispatch_key(const FakeTensor& tensor, int value) {
+    return tensor.type_id;
+  }
+};
+constexpr const char* TypeIdSchemaDef::name;
+constexpr guts::array<const char*, 2> TypeIdSchemaDef::parameter_names;
+
+int cpu_kernel(const FakeTensor& tensor, int value) {
+  return value + 1;
+}
+
+int cuda_kernel(const FakeTensor& tensor, int value) {
+  return value + 2;
+}
+
+} // namespace
+
+C10_DEFINE_OP_SCHEMA(TypeIdSchemaDef);
+
+static_assert(
+    std::is_same<
+        TensorTypeId,
+        OpSchema<TypeIdSchemaDef>::dispatch::dispatch_key_type>::value,
+    "");
+
+TEST(DispatchTableTest, DispatchesOnTensorTypeId) {
+  Dispatcher<TypeIdSchemaDef>::registerKernel(&cpu_kernel, CPUTensorId());
+  Dispatcher<TypeIdSchemaDef>::registerKernel(&cuda_kernel, CUDATensorId());
+  EXPECT_EQ(4, Dispatcher<TypeIdSchemaDef>::call(FakeTensor{CPUTensorId()}, 3));
+  EXPECT_EQ(5, Dispatcher<TypeIdSchemaDef>::call(FakeTensor{CUDATensorId()}, 3));
+  EXPECT_THROW(
+      Dispatcher<TypeIdSchemaDef>::call(FakeTensor{SparseCPUTensorId()}, 3),
+      std::logic_error);
+
+  // a second kernel for the same id conflicts
+  EXPECT_THROW(
+      Dispatcher<TypeIdSchemaDef>::registerKernel(&cuda_kernel, CPUTensorId()),
+      std::logic_error);
+
+  Dispatcher<TypeIdSchemaDef>::deregisterKernel(CUDATensorId());
+  EXPECT_THROW(
+      Dispatcher<TypeIdSchemaDef>::call(FakeTensor{CUDATensorId()}, 3),
+      std::logic_error);
+  EXPECT_THROW(
+      Dispatcher<TypeIdSchemaDef>::deregisterKernel(CUDATensorId()),
+      std::logic_error);
+  Dispatcher<TypeIdSchemaDef>::deregisterKernel(CPUTensorId());
+}
+
+TEST(DispatchTableTest, RegistersKernelsForTheirLifetime) {
+  {
+    KernelRegistrar<TypeIdSchemaDef> registrar =
+        KernelRegistrationBuilder<TypeIdSchemaDef, 0>()
+            .kernel(&cpu_kernel)
+            .dispatchKey(CPUTensorId());
+    EXPECT_EQ(1, Dispatcher<TypeIdSchemaDef>::call(FakeTensor{CPUTensorId()}, 0));
+  }
+  EXPECT_THROW(
+      Dispatcher<TypeIdSchemaDef>::call(FakeTensor{CPUTensorId()}, 0),
+      std::logic_error);
+}
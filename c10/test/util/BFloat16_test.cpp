@@ -0,0 +1,68 @@
+#include <c10/BFloat16.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+float float_from_bits(uint32_t bits) {
+  float res;
+  std::memcpy(&res, &bits, sizeof(res));
+  return res;
+}
+
+TEST(BFloat16Test, ConversionToFloatIsExact) {
+  for (uint32_t bits = 0; bits <= 0xFFFF; bits++) {
+    c10::BFloat16 value(static_cast<uint16_t>(bits), c10::BFloat16::from_bits);
+    float f = value;
+    if (std::isnan(f)) {
+      continue;
+    }
+    EXPECT_EQ(c10::BFloat16(f).x, bits);
+    EXPECT_EQ(f, float_from_bits(bits << 16));
+  }
+}
+
+TEST(BFloat16Test, RoundsToNearestEven) {
+  // 1 + 2^-8 is halfway between 1 and 1 + 2^-7, and rounds to the even 1
+  EXPECT_EQ(c10::BFloat16(float_from_bits(0x3F808000)).x, 0x3F80);
+  // 1 + 3 * 2^-8 is halfway between 1 + 2^-7 and 1 + 2^-6
+  EXPECT_EQ(c10::BFloat16(float_from_bits(0x3F818000)).x, 0x3F82);
+  EXPECT_EQ(c10::BFloat16(float_from_bits(0x3F808001)).x, 0x3F81);
+  EXPECT_EQ(c10::BFloat16(float_from_bits(0x3F807FFF)).x, 0x3F80);
+  EXPECT_EQ(c10::BFloat16(-1.0f).x, 0xBF80);
+}
+
+TEST(BFloat16Test, SpecialValues) {
+  EXPECT_TRUE(std::isnan(static_cast<float>(c10::BFloat16(NAN))));
+  // NaNs whose payload is only in the low bits must not round to infinity
+  EXPECT_TRUE(std::isnan(
+      static_cast<float>(c10::BFloat16(float_from_bits(0x7F800001)))));
+  EXPECT_EQ(static_cast<float>(c10::BFloat16(INFINITY)), INFINITY);
+  EXPECT_EQ(static_cast<float>(c10::BFloat16(-INFINITY)), -INFINITY);
+  // values past the largest BFloat16 round to infinity
+  EXPECT_EQ(static_cast<float>(c10::BFloat16(3.4e38f)), INFINITY);
+}
+
+TEST(BFloat16Test, NumericLimits) {
+  using limits = std::numeric_limits<c10::BFloat16>;
+  EXPECT_EQ(static_cast<float>(limits::max()), float_from_bits(0x7F7F0000));
+  EXPECT_EQ(static_cast<float>(limits::lowest()), -static_cast<float>(limits::max()));
+  EXPECT_EQ(static_cast<float>(limits::min()), std::numeric_limits<float>::min());
+  EXPECT_EQ(static_cast<float>(limits::epsilon()), std::ldexp(1.0f, -7));
+  EXPECT_EQ(static_cast<float>(limits::infinity()), INFINITY);
+  EXPECT_TRUE(std::isnan(static_cast<float>(limits::quiet_NaN())));
+}
+
+TEST(BFloat16Test, ArithmeticComputesInFloat) {
+  c10::BFloat16 a(1.5f), b(0.25f);
+  EXPECT_EQ(static_cast<float>(a + b), 1.75f);
+  EXPECT_EQ(static_cast<float>(a * b), 0.375f);
+  EXPECT_EQ(static_cast<float>(a - b), 1.25f);
+  EXPECT_EQ(static_cast<float>(a / b), 6.0f);
+  EXPECT_EQ(a * 2.0f, 3.0f);
+  EXPECT_EQ(static_cast<float>(a + 1), 2.5f);
+}
+
+} // namespace
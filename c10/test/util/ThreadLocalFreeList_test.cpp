@@ -0,0 +1,48 @@
+#include <c10/util/ThreadLocalFreeList.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace {
+
+struct Tag {};
+using FreeList = c10::ThreadLocalFreeList<Tag, 64, /*MaxBlocks=*/2>;
+
+} // namespace
+
+TEST(ThreadLocalFreeListTest, ReusesFreedBlocks) {
+  void* a = FreeList::allocate();
+  void* b = FreeList::allocate();
+  FreeList::deallocate(a);
+  FreeList::deallocate(b);
+  EXPECT_EQ(b, FreeList::allocate());
+  EXPECT_EQ(a, FreeList::allocate());
+  FreeList::deallocate(a);
+  FreeList::deallocate(b);
+}
+
+TEST(ThreadLocalFreeListTest, KeepsAtMostMaxBlocks) {
+  void* a = FreeList::allocate();
+  void* b = FreeList::allocate();
+  void* c = FreeList::allocate();
+  FreeList::deallocate(a);
+  FreeList::deallocate(b);
+  // the cache is full, so c is deleted
+  FreeList::deallocate(c);
+  EXPECT_EQ(b, FreeList::allocate());
+  EXPECT_EQ(a, FreeList::allocate());
+  FreeList::deallocate(a);
+  FreeList::deallocate(b);
+}
+
+TEST(ThreadLocalFreeListTest, BlocksCanBeFreedOnAnotherThread) {
+  void* a = FreeList::allocate();
+  void* reused = nullptr;
+  std::thread t([&] {
+    FreeList::deallocate(a);
+    reused = FreeList::allocate();
+    FreeList::deallocate(reused);
+  });
+  t.join();
+  EXPECT_EQ(a, reused);
+}
@@ -0,0 +1,62 @@
+#include <c10/util/TraceContext.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using c10::TraceContext;
+using c10::TraceContextGuard;
+
+TEST(TraceContextTest, NoRequestByDefault) {
+  EXPECT_FALSE(TraceContext::current().hasRequest());
+}
+
+TEST(TraceContextTest, GuardSetsAndRestores) {
+  TraceContext outer;
+  outer.request_id = 7;
+  {
+    TraceContextGuard guard(outer);
+    EXPECT_EQ(TraceContext::current().request_id, 7);
+    TraceContext inner;
+    inner.request_id = 8;
+    {
+      TraceContextGuard inner_guard(inner);
+      EXPECT_EQ(TraceContext::current().request_id, 8);
+    }
+    EXPECT_EQ(TraceContext::current().request_id, 7);
+  }
+  EXPECT_FALSE(TraceContext::current().hasRequest());
+}
+
+TEST(TraceContextTest, NewRequestsOnlyOutsideOfOne) {
+  auto first = TraceContext::currentOrNewRequest();
+  auto second = TraceContext::currentOrNewRequest();
+  EXPECT_TRUE(first.hasRequest());
+  EXPECT_TRUE(second.hasRequest());
+  EXPECT_NE(first.request_id, second.request_id);
+
+  TraceContextGuard guard(first);
+  EXPECT_EQ(TraceContext::currentOrNewRequest().request_id, first.request_id);
+}
+
+TEST(TraceContextTest, TasksRunWithTheContextOfTheirCreator) {
+  TraceContext context;
+  context.request_id = 42;
+  std::function<void()> task;
+  int64_t seen = -1;
+  {
+    TraceContextGuard guard(context);
+    task = c10::withCurrentTraceContext(
+        [&seen]() { seen = TraceContext::current().request_id; });
+  }
+  std::thread worker(task);
+  worker.join();
+  EXPECT_EQ(seen, 42);
+  // The worker thread is left as it was
+  EXPECT_FALSE(TraceContext::current().hasRequest());
+}
+
+TEST(TraceContextTest, ClockIsMonotonic) {
+  auto before = c10::getTraceTimeNs();
+  auto after = c10::getTraceTimeNs();
+  EXPECT_LE(before, after);
+}
@@ -25,6 +25,11 @@ class C10_API TensorTypeId final
   // https://reviews.llvm.org/D41223
   constexpr TensorTypeId() noexcept : IdWrapper(0) {}
 
+  // For tables with one entry per id, such as the flat dispatch tables
+  constexpr details::_tensorTypeId_underlyingType index() const noexcept {
+    return underlyingId();
+  }
+
  private:
   constexpr explicit TensorTypeId(
       details::_tensorTypeId_underlyingType id) noexcept
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace c10 {
+
+// A per thread cache of freed blocks of BlockSize bytes, for classes that are
+// allocated and freed at a high rate, such as the TensorImpl and StorageImpl
+// of short lived tensors. Each thread keeps up to MaxBlocks blocks, which are
+// handed out again by allocate() without calling ::operator new. A block can
+// be freed on another thread than the one that allocated it, it then goes to
+// the cache of the freeing thread.
+//
+// The blocks cached by a thread are returned to ::operator delete when it
+// exits; the blocks freed after that, e.g. by the destructors of static
+// objects, are deleted right away.
+template <typename Tag, size_t BlockSize, size_t MaxBlocks = 256>
+class ThreadLocalFreeList final {
+ public:
+  static void* allocate() {
+    State& s = state();
+    if (s.head != nullptr) {
+      Node* node = s.head;
+      s.head = node->next;
+      s.size--;
+      return node;
+    }
+    return ::operator new(BlockSize);
+  }
+
+  static void deallocate(void* ptr) {
+    State& s = state();
+    if (s.exited || s.size >= MaxBlocks) {
+      ::operator delete(ptr);
+      return;
+    }
+    // registers the destructor that drains the cache at thread exit
+    static thread_local Drain drain;
+    (void)drain;
+    Node* node = static_cast<Node*>(ptr);
+    node->next = s.head;
+    s.head = node;
+    s.size++;
+  }
+
+ private:
+  static_assert(BlockSize >= sizeof(void*), "blocks must hold a pointer");
+
+  struct Node {
+    Node* next;
+  };
+
+  // trivially destructible, so that it can still be used after Drain ran
+  struct State {
+    Node* head;
+    size_t size;
+    bool exited;
+  };
+
+  struct Drain {
+    ~Drain() {
+      State& s = state();
+      while (s.head != nullptr) {
+        Node* node = s.head;
+        s.head = node->next;
+        ::operator delete(node);
+      }
+      s.size = 0;
+      s.exited = true;
+    }
+  };
+
+  static State& state() {
+    static thread_local State s = {nullptr, 0, false};
+    return s;
+  }
+};
+
+} // namespace c10
@@ -0,0 +1,68 @@
+#include "c10/util/TraceContext.h"
+
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <ctime>
+#endif
+
+namespace c10 {
+
+namespace {
+thread_local TraceContext current_context;
+std::atomic<int64_t> next_request_id{1};
+} // namespace
+
+TraceContext TraceContext::current() {
+  return current_context;
+}
+
+TraceContext TraceContext::currentOrNewRequest() {
+  if (current_context.hasRequest()) {
+    return current_context;
+  }
+  TraceContext context;
+  context.request_id = next_request_id.fetch_add(1);
+  return context;
+}
+
+TraceContextGuard::TraceContextGuard(TraceContext context)
+    : previous_(current_context) {
+  current_context = context;
+}
+
+TraceContextGuard::~TraceContextGuard() {
+  current_context = previous_;
+}
+
+std::function<void()> withCurrentTraceContext(std::function<void()> task) {
+  auto context = current_context;
+  if (!context.hasRequest()) {
+    return task;
+  }
+  return [context, task]() {
+    TraceContextGuard guard(context);
+    task();
+  };
+}
+
+int64_t getTraceTimeNs() {
+#ifdef _WIN32
+  using namespace std::chrono;
+  using clock = std::conditional<
+      high_resolution_clock::is_steady,
+      high_resolution_clock,
+      steady_clock>::type;
+  return duration_cast<nanoseconds>(clock::now().time_since_epoch()).count();
+#else
+  // clock_gettime is much faster than the std::chrono clocks on Linux
+  struct timespec t {};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<int64_t>(t.tv_sec) * 1000000000 +
+      static_cast<int64_t>(t.tv_nsec);
+#endif
+}
+
+} // namespace c10
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "c10/macros/Macros.h"
+
+namespace c10 {
+
+// The request a thread is doing work for, so that the tracers of caffe2 nets
+// and the autograd profiler can tell which events belong to one request. It
+// is set at the entry points that serve requests, Predictor::operator() and
+// script::Method::run(), and is carried over to the tasks that the thread
+// pools (at::launch, at::parallel_for, the pools of async nets) run for it.
+struct C10_API TraceContext {
+  // 0 if the thread is not doing work for a request
+  int64_t request_id = 0;
+
+  bool hasRequest() const {
+    return request_id != 0;
+  }
+
+  // The context of the calling thread
+  static TraceContext current();
+
+  // The context of the calling thread if it is doing work for a request, or
+  // else a context for a new request. Callers that have their own request
+  // ids set them with a TraceContextGuard before calling the entry points.
+  static TraceContext currentOrNewRequest();
+};
+
+// Sets the context of the calling thread for the lifetime of the guard.
+class C10_API TraceContextGuard final {
+ public:
+  explicit TraceContextGuard(TraceContext context);
+  ~TraceContextGuard();
+
+ private:
+  TraceContext previous_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(TraceContextGuard);
+};
+
+// Wraps task so that it runs with the context of the thread that wraps it,
+// for thread pools to call before queueing a task. Tasks queued outside of a
+// request are returned as they are.
+C10_API std::function<void()> withCurrentTraceContext(
+    std::function<void()> task);
+
+// The clock the timestamps of all the tracers are taken on, in nanoseconds:
+// it is monotonic and shared by all the threads of the process, so that the
+// events they record are ordered in one trace.
+C10_API int64_t getTraceTimeNs();
+
+} // namespace c10
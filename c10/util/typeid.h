@@ -18,6 +18,7 @@
 #include <exception>
 
 #include "c10/util/Backtrace.h"
+#include "c10/BFloat16.h"
 #include "c10/Half.h"
 #include "c10/macros/Macros.h"
 #include "c10/util/C++17.h"
@@ -42,11 +43,14 @@
 // called.  This requires us to fix all of the call-sites, which I want to do
 // later.  So the namespace is not fixed at the moment.
 
-// Make at::Half a fundamental type.
+// Make at::Half and at::BFloat16 fundamental types.
 namespace std {
 template<>
 struct is_fundamental<at::Half> : std::true_type {
 };
+template<>
+struct is_fundamental<at::BFloat16> : std::true_type {
+};
 }  // namespace std
 
 namespace caffe2 {
@@ -606,5 +610,9 @@ CAFFE_DECLARE_PREALLOCATED_KNOWN_TYPE(
     26,
     detail::_guard_long_unique<std::vector<long>>)
 
-CAFFE_DECLARE_PREALLOCATED_KNOWN_TYPE(27, _CaffeHighestPreallocatedTypeId)
+// at::BFloat16 comes after the ids in use when it was added, and so does not
+// line up with at::ScalarType::BFloat16
+CAFFE_DECLARE_PREALLOCATED_KNOWN_TYPE(27, at::BFloat16)
+
+CAFFE_DECLARE_PREALLOCATED_KNOWN_TYPE(28, _CaffeHighestPreallocatedTypeId)
 } // namespace caffe2
@@ -1,5 +1,9 @@
 #include "caffe2/contrib/tensorrt/tensorrt_op_trt.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <numeric>
 #include <unordered_map>
 
@@ -41,6 +45,15 @@ int64_t CheckDims(
   return chw;
 }
 
+std::shared_ptr<nvinfer1::ICudaEngine> DeserializeTrtEngine(
+    const std::string& engine_string,
+    tensorrt::TrtLogger* logger) {
+  auto trt_runtime = tensorrt::TrtObject(nvinfer1::createInferRuntime(*logger));
+  // TODO(support trt plugin factory)
+  return tensorrt::TrtObject(trt_runtime->deserializeCudaEngine(
+      engine_string.data(), engine_string.size(), nullptr));
+}
+
 } // namespace
 
 // Upon construction, we build the inference engine by deserializing from
@@ -53,23 +66,28 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
               "log_verbosity",
               FLAGS_minloglevel))),
       max_batch_size_(
-          OperatorBase::GetSingleArgument<int>("max_batch_size", 1)) {
+          OperatorBase::GetSingleArgument<int>("max_batch_size", 1)),
+      max_workspace_size_(OperatorBase::GetSingleArgument<int>(
+          "max_workspace_size",
+          1024 * 1024 * 2)),
+      debug_builder_(
+          OperatorBase::GetSingleArgument<int>("debug_builder", 0)),
+      engine_cache_dir_(OperatorBase::GetSingleArgument<std::string>(
+          "engine_cache_dir",
+          "")),
+      bucket_batch_size_(
+          OperatorBase::GetSingleArgument<int>("bucket_batch_size", 0)) {
   {
     auto engine_string =
         OperatorBase::GetSingleArgument<std::string>("backend_buffer", "");
     if (!engine_string.empty()) {
-      auto trt_runtime =
-          tensorrt::TrtObject(nvinfer1::createInferRuntime(logger_));
-      // TODO(support trt plugin factory)
-      trt_engine_ = tensorrt::TrtObject(trt_runtime->deserializeCudaEngine(
-          engine_string.data(), engine_string.size(), nullptr));
+      trt_engine_ = DeserializeTrtEngine(engine_string, &logger_);
+      // There is no model to build the engines of the other buckets from
+      bucket_batch_size_ = false;
     } else {
       auto onnx_model_str =
           OperatorBase::GetSingleArgument<std::string>("onnx_model", "");
       CAFFE_ENFORCE(!onnx_model_str.empty(), "onnx_model cannot be empty");
-      auto debug_builder = OperatorBase::GetSingleArgument<int>("debug_builder", 0);
-      auto max_workspace_size = OperatorBase::GetSingleArgument<int>(
-          "max_workspace_size", 1024 * 1024 * 2);
 
       // Pull the weights from workspace and assembly it back to the onnx model,
       // notice that since we may have rewritten the net, we need to map the
@@ -88,16 +106,15 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
       ::ONNX_NAMESPACE::ModelProto onnx_model;
       ParseProtoFromLargeString(onnx_model_str, &onnx_model);
       BuildInitializationList(&mapped_ws, onnx_model.mutable_graph(), &initializer_set);
-      onnx_model_str.clear();
-      onnx_model.SerializeToString(&onnx_model_str);
+      onnx_model_str_.clear();
+      onnx_model.SerializeToString(&onnx_model_str_);
+      onnx_model_hash_ = c10::str(std::hash<std::string>()(onnx_model_str_));
 
       // Build the trt engine
-      trt_engine_ = tensorrt::BuildTrtEngine(
-          onnx_model_str,
-          &logger_,
-          max_batch_size_,
-          max_workspace_size,
-          debug_builder);
+      trt_engine_ = BuildEngine(max_batch_size_);
+      if (!bucket_batch_size_) {
+        onnx_model_str_.clear();
+      }
     }
   }
 
@@ -126,6 +143,68 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
   }
 
   trt_executor_ = tensorrt::TrtObject(trt_engine_->createExecutionContext());
+  bucket_engines_.emplace(max_batch_size_, TrtEngine{trt_engine_, trt_executor_});
+}
+
+std::shared_ptr<nvinfer1::ICudaEngine> TensorRTOp::BuildEngine(
+    int max_batch_size) {
+  // The engines are only valid for the GPU and the TensorRT version that
+  // built them, which the cache directory is expected to be specific to.
+  std::string cache_file;
+  if (!engine_cache_dir_.empty()) {
+    cache_file = c10::str(
+        engine_cache_dir_, "/", onnx_model_hash_, "_", max_batch_size, ".trt");
+    std::ifstream in(cache_file, std::ios::binary);
+    if (in) {
+      std::string engine_string(
+          (std::istreambuf_iterator<char>(in)),
+          std::istreambuf_iterator<char>());
+      VLOG(1) << "Loading TensorRT engine from " << cache_file;
+      return DeserializeTrtEngine(engine_string, &logger_);
+    }
+  }
+
+  VLOG(1) << "Building TensorRT engine for max batch size " << max_batch_size;
+  auto engine = tensorrt::BuildTrtEngine(
+      onnx_model_str_,
+      &logger_,
+      max_batch_size,
+      max_workspace_size_,
+      debug_builder_);
+
+  if (engine && !cache_file.empty()) {
+    auto serialized = tensorrt::TrtObject(engine->serialize());
+    // Written to a temporary file first, so that other processes sharing the
+    // cache don't load a partial engine
+    const auto tmp_file = c10::str(cache_file, ".tmp");
+    std::ofstream out(tmp_file, std::ios::binary);
+    out.write(static_cast<const char*>(serialized->data()), serialized->size());
+    out.close();
+    if (!out || std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+      LOG(WARNING) << "Cannot write TensorRT engine to " << cache_file;
+      std::remove(tmp_file.c_str());
+    }
+  }
+  return engine;
+}
+
+nvinfer1::IExecutionContext* TensorRTOp::GetExecutor(int batch_size) {
+  if (!bucket_batch_size_) {
+    return trt_executor_.get();
+  }
+  int bucket = 1;
+  while (bucket < batch_size) {
+    bucket <<= 1;
+  }
+  bucket = std::min(bucket, max_batch_size_);
+  auto it = bucket_engines_.find(bucket);
+  if (it == bucket_engines_.end()) {
+    auto engine = BuildEngine(bucket);
+    CAFFE_ENFORCE(engine, "Cannot build TensorRT engine!");
+    auto executor = tensorrt::TrtObject(engine->createExecutionContext());
+    it = bucket_engines_.emplace(bucket, TrtEngine{engine, executor}).first;
+  }
+  return it->second.executor.get();
 }
 
 void TensorRTOp::MaybeAdjustOutputShape(
@@ -223,7 +302,7 @@ bool TensorRTOp::RunOnDevice() {
     }
 
     CAFFE_ENFORCE_EQ(bindings.size(), InputSize() + OutputSize());
-    if (!trt_executor_->execute(batch_size, bindings.data())) {
+    if (!GetExecutor(batch_size)->execute(batch_size, bindings.data())) {
       CAFFE_THROW("Error running the TensorRT executor");
     }
   }
@@ -252,7 +331,18 @@ This is a GPU only operator.
         "max_batch_size",
         "(int default 0) Batch size set by the TensorRT engine builder."
         "It must be no larger than the max_batch_size of the engine builder so "
-        "it is better not to edit this manually.");
+        "it is better not to edit this manually.")
+    .Arg(
+        "bucket_batch_size",
+        "(int default 0) If set, an engine is built on first use for each "
+        "power of two up to max_batch_size, and the batches run in the "
+        "engine of the smallest of them that fits, which is faster for "
+        "batches much smaller than max_batch_size.")
+    .Arg(
+        "engine_cache_dir",
+        "(string default=\"\") If set, the engines are serialized to this "
+        "directory when built, and loaded from it by the next operators "
+        "built from the same model, which skips the slow engine building.");
 
 REGISTER_CUDA_OPERATOR(TensorRT, TensorRTOp);
 } // namespace caffe2
@@ -5,6 +5,7 @@
 #include "caffe2/core/operator.h"
 
 #include <NvInfer.h>
+#include <map>
 #include <unordered_map>
 
 namespace caffe2 {
@@ -17,7 +18,16 @@ class TensorRTOp final : public Operator<CUDAContext> {
   virtual ~TensorRTOp() noexcept {}
 
  private:
+  struct TrtEngine {
+    std::shared_ptr<nvinfer1::ICudaEngine> engine;
+    std::shared_ptr<nvinfer1::IExecutionContext> executor;
+  };
+
   void MaybeAdjustOutputShape(int output_idx, std::vector<int64_t>* dims);
+  // The executor to run a batch of batch_size, of the engine of its bucket
+  nvinfer1::IExecutionContext* GetExecutor(int batch_size);
+  // Builds an engine, or loads it from the engine_cache_dir
+  std::shared_ptr<nvinfer1::ICudaEngine> BuildEngine(int max_batch_size);
 
   tensorrt::TrtLogger logger_;
   int max_batch_size_;
@@ -27,6 +37,16 @@ class TensorRTOp final : public Operator<CUDAContext> {
   std::shared_ptr<nvinfer1::ICudaEngine> trt_engine_{nullptr};
   std::shared_ptr<nvinfer1::IExecutionContext> trt_executor_{nullptr};
   bool batch_warning_issued_{false};
+
+  // The ONNX model with its weights, to build the engines of the buckets
+  std::string onnx_model_str_;
+  std::string onnx_model_hash_;
+  int max_workspace_size_;
+  bool debug_builder_;
+  std::string engine_cache_dir_;
+  bool bucket_batch_size_;
+  // The engines built for the powers of two batch sizes below max_batch_size
+  std::map<int, TrtEngine> bucket_engines_;
 };
 
 } // namespace caffe2
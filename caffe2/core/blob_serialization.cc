@@ -16,11 +16,23 @@ C10_DEFINE_int(
     16,
     "Maximal number of threads that can be used for tensor serialization");
 
+C10_DEFINE_int(
+    caffe2_max_tensor_deserializer_threads,
+    16,
+    "Maximal number of threads that can be used by the Load op for tensor "
+    "deserialization");
+
 C10_DEFINE_bool(
     caffe2_serialize_fp16_as_bytes,
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+C10_DEFINE_bool(
+    caffe2_serialize_using_raw_data,
+    false,
+    "Serialize the content of tensors of fixed width types as raw bytes in "
+    "the raw_data field, rather than element by element in the typed fields");
+
 namespace caffe2 {
 /**
  * @brief StringSerializer is the serializer for String.
@@ -223,6 +235,31 @@ void TensorSerializer::Serialize(
   proto.set_data_type(data_type);
   StoreDeviceDetail(input, &proto);
   auto uniq_ptr = CreateContext(input.GetDevice());
+  if (FLAGS_caffe2_serialize_using_raw_data &&
+      data_type != TensorProto_DataType_STRING &&
+      data_type != TensorProto_DataType_UNDEFINED) {
+    // A single copy of the bytes of the chunk, with neither a cast nor the
+    // encoding of a repeated field per element.
+    const int kValue = 1;
+    CAFFE_ENFORCE_EQ(
+        reinterpret_cast<const char*>(&kValue)[0],
+        1,
+        "Serialization of raw data on big endian platform "
+        "is not written yet.");
+    proto.set_storage_type(TensorProto_StorageType_RAW);
+    const size_t nbytes = chunkSize * input.itemsize();
+    std::string* raw_data = proto.mutable_raw_data();
+    raw_data->resize(nbytes);
+    if (nbytes > 0) {
+      uniq_ptr->CopyBytesToCPU(
+          nbytes,
+          static_cast<const char*>(input.raw_data()) +
+              chunkBegin * input.itemsize(),
+          &(*raw_data)[0]);
+      uniq_ptr->FinishDeviceComputation();
+    }
+    return;
+  }
   // A lot of copypaste is error prone. Should we create a macro for this?
   switch (data_type) {
     case TensorProto_DataType_FLOAT:
@@ -386,7 +423,7 @@ void DeserializeBlob(const BlobProto& blob_proto, Blob* result) {
 }
 
 void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
-  auto tensor_proto = blob_proto.tensor();
+  const auto& tensor_proto = blob_proto.tensor();
   Deserialize(
       tensor_proto,
       BlobGetMutableTensor(
@@ -394,6 +431,21 @@ void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
           static_cast<DeviceType>(tensor_proto.device_detail().device_type())));
 }
 
+void TensorDeserializer::Prepare(const TensorProto& proto, Tensor* tensor) {
+  auto uniq_ptr = CreateContext(OptionToDevice(proto.device_detail()));
+  uniq_ptr->SwitchToDevice(0);
+  vector<int64_t> dims;
+  for (const int64_t d : proto.dims()) {
+    dims.push_back(d);
+  }
+  tensor->Resize(dims);
+  CAFFE_ENFORCE(
+      proto.data_type() != TensorProto_DataType_UNDEFINED &&
+          proto.data_type() != TensorProto_DataType_BYTE,
+      "Cannot prepare a tensor of undefined or BYTE type.");
+  tensor->raw_mutable_data(DataTypeToTypeMeta(proto.data_type()));
+}
+
 void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
   // We create a local context for deserializing. Since Caffe2 contexts are
   // usually lightweight, this should not involve too much overhead.
@@ -404,7 +456,11 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
   for (const int64_t d : proto.dims()) {
     dims.push_back(d);
   }
-  tensor->Resize(dims);
+  // A tensor prepared by Prepare() is left as is, so that the chunks of a
+  // tensor can be deserialized into it concurrently.
+  if (tensor->sizes() != dims) {
+    tensor->Resize(dims);
+  }
 
   int64_t chunkBegin = 0;
   auto chunkEnd = tensor->numel();
@@ -422,6 +478,33 @@ void TensorDeserializer::Deserialize(const TensorProto& proto, Tensor* tensor) {
       tensor->numel());
   auto chunkSize = chunkEnd - chunkBegin;
 
+  if (proto.storage_type() == TensorProto_StorageType_RAW) {
+    CAFFE_ENFORCE(
+        proto.data_type() != TensorProto_DataType_STRING &&
+            proto.data_type() != TensorProto_DataType_UNDEFINED &&
+            proto.data_type() != TensorProto_DataType_BYTE,
+        "Only tensors of fixed width types can be stored as raw data.");
+    const int kValue = 1;
+    CAFFE_ENFORCE_EQ(
+        reinterpret_cast<const char*>(&kValue)[0],
+        1,
+        "Serialization of raw data on big endian platform "
+        "is not written yet.");
+    const TypeMeta& meta = DataTypeToTypeMeta(proto.data_type());
+    const size_t nbytes = chunkSize * meta.itemsize();
+    CAFFE_ENFORCE_EQ(
+        nbytes, proto.raw_data().size(), "Incorrect proto field size.");
+    char* data = static_cast<char*>(tensor->raw_mutable_data(meta));
+    if (nbytes > 0) {
+      context->CopyBytesFromCPU(
+          nbytes,
+          proto.raw_data().data(),
+          data + chunkBegin * meta.itemsize());
+    }
+    context->FinishDeviceComputation();
+    return;
+  }
+
   switch (proto.data_type()) {
     case TensorProto_DataType_FLOAT:
       detail::CopyFromProtoAsIs(
@@ -15,7 +15,9 @@
 
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_int(caffe2_max_tensor_serializer_threads);
+C10_DECLARE_int(caffe2_max_tensor_deserializer_threads);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+C10_DECLARE_bool(caffe2_serialize_using_raw_data);
 
 namespace caffe2 {
 
@@ -107,6 +109,12 @@ class CAFFE2_API TensorDeserializer : public BlobDeserializerBase {
  public:
   void Deserialize(const BlobProto& proto, Blob* blob) override;
   void Deserialize(const TensorProto& proto, Tensor* tensor);
+  /**
+   * Resizes and allocates the tensor that proto, or a chunk of it, is
+   * deserialized into. Deserialize neither resizes nor reallocates a prepared
+   * tensor, so that its chunks can then be deserialized concurrently.
+   */
+  void Prepare(const TensorProto& proto, Tensor* tensor);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
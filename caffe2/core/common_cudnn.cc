@@ -3,8 +3,28 @@
 
 #include "caffe2/core/init.h"
 
+#include <THC/THCCachingAllocator.h>
+
 namespace caffe2 {
 
+void* CuDNNWorkspace::get(size_t nbytes) {
+  if (nbytes_ < nbytes) {
+    reset();
+    data_ = THCCachingAllocator_get()->allocate(nbytes);
+    nbytes_ = nbytes;
+  }
+  CAFFE_ENFORCE_GE(nbytes_, nbytes);
+  return data_.get();
+}
+
+void CuDNNWorkspace::reset() {
+  if (data_.get()) {
+    CUDA_ENFORCE(cudaDeviceSynchronize());
+  }
+  data_.clear();
+  nbytes_ = 0;
+}
+
 CuDNNWrapper::PerGPUCuDNNStates& CuDNNWrapper::cudnn_states() {
   // New it (never delete) to avoid calling the destructors on process
   // exit and racing against the CUDA shutdown sequence.
@@ -18,9 +18,15 @@
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/core/init.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/static_tracepoint.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/utils/string_utils.h"
 
+#include <ATen/cuda/CUDAContext.h>
+#ifdef CAFFE2_USE_CUDNN
+#include <ATen/cudnn/Handle.h>
+#endif // CAFFE2_USE_CUDNN
+
 C10_DEFINE_string(
     caffe2_cuda_memory_pool,
     "",
@@ -77,6 +83,33 @@ ThreadLocalCUDAObjects& CUDAContext::getCudaObjects() {
   return cuda_objects_;
 }
 
+cublasHandle_t ThreadLocalCUDAObjects::GetHandle(int gpu, int stream_id) {
+  // The handles of the pool are created with CUBLAS_POINTER_MODE_HOST, the
+  // default. You can override it after obtaining the cublas handle, but do
+  // that with caution.
+  return at::cuda::getCUDABlasHandle(gpu, GetStream(gpu, stream_id));
+}
+
+#ifdef CAFFE2_USE_CUDNN
+cudnnHandle_t ThreadLocalCUDAObjects::GetCudnnHandle(int gpu, int stream_id) {
+  return at::native::getCudnnHandle(gpu, GetStream(gpu, stream_id));
+}
+#endif // CAFFE2_USE_CUDNN
+
+ThreadLocalCUDAObjects::~ThreadLocalCUDAObjects() noexcept {
+  for (int i = 0; i < CAFFE2_COMPILE_TIME_MAX_GPUS; ++i) {
+    for (auto& stream : cuda_streams_[i]) {
+      if (stream) {
+        at::cuda::releaseCUDABlasHandle(i, stream);
+#ifdef CAFFE2_USE_CUDNN
+        at::native::releaseCudnnHandle(i, stream);
+#endif // CAFFE2_USE_CUDNN
+        CUDA_CHECK(cudaStreamDestroy(stream));
+      }
+    }
+  }
+}
+
 // TODO(jiayq): these variables shouldn't be currently accessed during static
 // initialization. We should consider moving them to a Mayer's singleton to
 // be totally safe against SIOF.
@@ -344,7 +377,7 @@ struct DefaultCUDAAllocator final : public at::Allocator {
           g_size_map[ptr] = nbytes;
           g_cuda_device_affiliation[ptr] = CaffeCudaGetDevice();
         }
-        return {ptr, ptr, &Delete, at::Device(CUDA, CaffeCudaGetDevice())};
+        break;
       case CudaMemoryPoolType::CUB:
         CUDA_ENFORCE(g_cub_allocator->DeviceAllocate(&ptr, nbytes));
         g_cuda_device_affiliation[ptr] = CaffeCudaGetDevice();
@@ -353,16 +386,20 @@ struct DefaultCUDAAllocator final : public at::Allocator {
         if (FLAGS_caffe2_gpu_memory_tracking) {
           g_size_map[ptr] = nbytes;
         }
-        return {ptr, ptr, &Delete, at::Device(CUDA, CaffeCudaGetDevice())};
+        break;
       case CudaMemoryPoolType::THC:
         CUDA_ENFORCE(g_thc_allocator->Alloc(&ptr, nbytes, 0 /* stream */));
         if (FLAGS_caffe2_gpu_memory_tracking) {
           g_size_map[ptr] = nbytes;
           g_cuda_device_affiliation[ptr] = CaffeCudaGetDevice();
         }
-        return {ptr, ptr, &Delete, at::Device(CUDA, CaffeCudaGetDevice())};
+        break;
     }
-    return {nullptr, nullptr, &Delete, at::Device(CUDA, CaffeCudaGetDevice())};
+#ifdef CAFFE2_ENABLE_SDT
+    int device = CaffeCudaGetDevice();
+    CAFFE_SDT(cuda_alloc, ptr, nbytes, device);
+#endif
+    return {ptr, ptr, &Delete, at::Device(CUDA, CaffeCudaGetDevice())};
   }
 
   at::DeleterFnPtr raw_deleter() const override {
@@ -373,6 +410,9 @@ struct DefaultCUDAAllocator final : public at::Allocator {
   static void Delete(void* ptr) {
     // lock the mutex
     std::lock_guard<std::mutex> lock(CUDAContext::mutex());
+#ifdef CAFFE2_ENABLE_SDT
+    CAFFE_SDT(cuda_free, ptr);
+#endif
     if (FLAGS_caffe2_gpu_memory_tracking) {
       auto sz_it = g_size_map.find(ptr);
       DCHECK(sz_it != g_size_map.end());
@@ -41,8 +41,9 @@ CAFFE2_CUDA_API CudaMemoryPoolType GetCudaMemoryPoolType();
  * In Caffe2, each thread has its own non-default cuda stream as well as
  * related objects such as cublas and curand handles. This is achieved by
  * having the ThreadLocalCUDAObjects wrapper that takes care of allocating
- * and deallocating these objects at the thread scope. This class is solely
- * used inside CUDAContext and should not be used externally.
+ * and deallocating these objects at the thread scope. The handles of a
+ * stream are those ATen uses for it. This class is solely used inside
+ * CUDAContext and should not be used externally.
  */
 class CAFFE2_CUDA_API ThreadLocalCUDAObjects {
   friend class CUDAContext;
@@ -51,10 +52,6 @@ class CAFFE2_CUDA_API ThreadLocalCUDAObjects {
   ThreadLocalCUDAObjects() {
     for (int i = 0; i < CAFFE2_COMPILE_TIME_MAX_GPUS; ++i) {
       cuda_streams_[i] = vector<cudaStream_t>();
-      cublas_handles_[i] = vector<cublasHandle_t>();
-#ifdef CAFFE2_USE_CUDNN
-      cudnn_handles_[i] = vector<cudnnHandle_t>();
-#endif // CAFFE2_USE_CUDNN
       current_stream_id_[i] = 0;
     }
   }
@@ -95,24 +92,11 @@ class CAFFE2_CUDA_API ThreadLocalCUDAObjects {
     return GetHandle(gpu, current_stream_id_[gpu]);
   }
 
-  cublasHandle_t GetHandle(int gpu, int stream_id) {
-    DeviceGuard guard(gpu);
-    vector<cublasHandle_t>& gpu_handles = cublas_handles_[gpu];
-    if (gpu_handles.size() <= (unsigned)stream_id) {
-      gpu_handles.resize(stream_id + 1, nullptr);
-    }
-    if (!gpu_handles[stream_id]) {
-      CUBLAS_ENFORCE(cublasCreate(&gpu_handles[stream_id]));
-      // The default is CUBLAS_POINTER_MODE_HOST. You can override
-      // it after obtaining the cublas handle, but do that with
-      // caution.
-      CUBLAS_ENFORCE(cublasSetPointerMode(
-          gpu_handles[stream_id], CUBLAS_POINTER_MODE_HOST));
-      CUBLAS_ENFORCE(
-          cublasSetStream(gpu_handles[stream_id], GetStream(gpu, stream_id)));
-    }
-    return gpu_handles[stream_id];
-  }
+  // The cuBLAS and cuDNN handles come from the pools shared with ATen, keyed
+  // by device and stream (see ATen/cuda/detail/DeviceStreamHandlePool.h), so
+  // that caffe2 and ATen ops running in the same process and on the same
+  // streams share them.
+  cublasHandle_t GetHandle(int gpu, int stream_id);
 
 #ifdef CAFFE2_USE_CUDNN
   // Uses the logical stream id from the thread local to pick the stream
@@ -122,48 +106,14 @@ class CAFFE2_CUDA_API ThreadLocalCUDAObjects {
     return GetCudnnHandle(gpu, current_stream_id_[gpu]);
   }
 
-  cudnnHandle_t GetCudnnHandle(int gpu, int stream_id) {
-    DeviceGuard guard(gpu);
-    vector<cudnnHandle_t>& gpu_handles = cudnn_handles_[gpu];
-    if (gpu_handles.size() <= (unsigned)stream_id) {
-      gpu_handles.resize(stream_id + 1, nullptr);
-    }
-    if (!gpu_handles[stream_id]) {
-      CUDNN_ENFORCE(cudnnCreate(&gpu_handles[stream_id]));
-      CUDNN_ENFORCE(
-          cudnnSetStream(gpu_handles[stream_id], GetStream(gpu, stream_id)));
-    }
-    return gpu_handles[stream_id];
-  }
+  cudnnHandle_t GetCudnnHandle(int gpu, int stream_id);
 #endif // CAFFE2_USE_CUDNN
 
-  ~ThreadLocalCUDAObjects() noexcept {
-    for (int i = 0; i < CAFFE2_COMPILE_TIME_MAX_GPUS; ++i) {
-      for (auto& handle : cublas_handles_[i]) {
-        if (handle) {
-          CUBLAS_CHECK(cublasDestroy(handle));
-        }
-      }
-      for (auto& stream : cuda_streams_[i]) {
-        if (stream) {
-          CUDA_CHECK(cudaStreamDestroy(stream));
-        }
-      }
+  // Releases the handles of the streams to their pools, and destroys the
+  // streams.
+  ~ThreadLocalCUDAObjects() noexcept;
 
-#ifdef CAFFE2_USE_CUDNN
-      for (auto& handle : cudnn_handles_[i]) {
-        if (handle) {
-          CUDNN_CHECK(cudnnDestroy(handle));
-        }
-      }
-#endif // CAFFE2_USE_CUDNN
-    }
-  }
   vector<cudaStream_t> cuda_streams_[CAFFE2_COMPILE_TIME_MAX_GPUS];
-  vector<cublasHandle_t> cublas_handles_[CAFFE2_COMPILE_TIME_MAX_GPUS];
-#ifdef CAFFE2_USE_CUDNN
-  vector<cudnnHandle_t> cudnn_handles_[CAFFE2_COMPILE_TIME_MAX_GPUS];
-#endif // CAFFE2_USE_CUDNN
   int current_stream_id_[CAFFE2_COMPILE_TIME_MAX_GPUS];
 };
 
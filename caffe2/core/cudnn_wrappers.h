@@ -6,6 +6,8 @@
 #include "caffe2/core/common_cudnn.h"
 #include "caffe2/core/context_gpu.h"
 
+#include <ATen/cudnn/Handle.h>
+
 namespace caffe2 {
 
 class CuDNNWrapper;
@@ -17,24 +19,19 @@ class CuDNNWrapper;
  * cudnn function calls are usually very efficient, hence one probably does not
  * want to run multiple cudnn calls at the same time. As a result, one should
  * not need more than one cudnn workspace per device.
+ *
+ * The scratch space is allocated from the caching allocator of ATen, which
+ * ATen allocates its own cudnn workspaces from, so that memory given back by
+ * one can be used by the other.
  */
 struct CuDNNWorkspace {
   ~CuDNNWorkspace() noexcept {}
 
-  void* get(size_t nbytes) {
-    if (nbytes_ < nbytes) {
-      reset();
-      data_ = CUDAContext::New(nbytes);
-      nbytes_ = nbytes;
-    }
-    CAFFE_ENFORCE_GE(nbytes_, nbytes);
-    return data_.get();
-  }
+  void* get(size_t nbytes);
 
-  void reset() {
-    data_.clear();
-    nbytes_ = 0;
-  }
+  // Waits for the device to be done with the scratch space, which the caching
+  // allocator may hand out for another stream right away, and frees it.
+  void reset();
 
  private:
   at::DataPtr data_{nullptr, nullptr, &NoDelete, at::Device(CUDA)};
@@ -49,16 +46,16 @@ class CuDNNState {
  public:
   explicit CuDNNState(size_t gpu_id) : gpu_id_(gpu_id) {
     DeviceGuard g(gpu_id_);
-    CUDNN_ENFORCE(cudnnCreate(&cudnn_handle_));
     CUDA_ENFORCE(cudaEventCreate(&before_));
     CUDA_ENFORCE(cudaEventCreate(&after_));
     CUDA_ENFORCE(cudaStreamCreate(&stream_));
-    CUDNN_ENFORCE(cudnnSetStream(cudnn_handle_, stream_));
+    // the handle of the stream in the pool shared with ATen
+    cudnn_handle_ = at::native::getCudnnHandle(gpu_id_, stream_);
   }
 
   ~CuDNNState() noexcept {
     DeviceGuard g(gpu_id_);
-    CUDNN_CHECK(cudnnDestroy(cudnn_handle_));
+    at::native::releaseCudnnHandle(gpu_id_, stream_);
     CUDA_CHECK(cudaStreamDestroy(stream_));
     CUDA_CHECK(cudaEventDestroy(after_));
     CUDA_CHECK(cudaEventDestroy(before_));
@@ -77,6 +77,11 @@ class MiniDBCursor : public Cursor {
     return string(value_.data(), value_len_);
   }
 
+  c10::ArrayRef<char> valueView() override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    return c10::ArrayRef<char>(value_.data(), value_len_);
+  }
+
   bool Valid() override { return valid_; }
 
  private:
@@ -169,6 +174,142 @@ class MiniDB : public DB {
 REGISTER_CAFFE2_DB(MiniDB, MiniDB);
 REGISTER_CAFFE2_DB(minidb, MiniDB);
 
+PrefetchingCursor::PrefetchingCursor(
+    std::unique_ptr<Cursor> cursor,
+    size_t read_ahead)
+    : cursor_(std::move(cursor)),
+      read_ahead_(read_ahead),
+      zero_copy_(cursor_ && cursor_->ViewsOutliveNext()) {
+  CAFFE_ENFORCE(cursor_, "Passed null cursor");
+  CAFFE_ENFORCE_GT(read_ahead_, 0);
+  StartPrefetching();
+}
+
+PrefetchingCursor::~PrefetchingCursor() {
+  StopPrefetching();
+}
+
+void PrefetchingCursor::Seek(const string& key) {
+  StopPrefetching();
+  cursor_->Seek(key);
+  StartPrefetching();
+}
+
+void PrefetchingCursor::SeekToFirst() {
+  StopPrefetching();
+  cursor_->SeekToFirst();
+  StartPrefetching();
+}
+
+void PrefetchingCursor::Next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (Current(lock).valid) {
+    records_.pop_front();
+    cv_.notify_all();
+  }
+}
+
+string PrefetchingCursor::key() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return Current(lock).key;
+}
+
+string PrefetchingCursor::value() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto view = Current(lock).view();
+  return string(view.data(), view.size());
+}
+
+c10::ArrayRef<char> PrefetchingCursor::valueView() {
+  // Only Next() and Seek() remove the current record
+  std::unique_lock<std::mutex> lock(mutex_);
+  return Current(lock).view();
+}
+
+bool PrefetchingCursor::Valid() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return Current(lock).valid;
+}
+
+const PrefetchingCursor::Record& PrefetchingCursor::Current(
+    std::unique_lock<std::mutex>& lock) {
+  cv_.wait(lock, [this] { return !records_.empty() || error_; });
+  if (records_.empty()) {
+    std::rethrow_exception(error_);
+  }
+  return records_.front();
+}
+
+void PrefetchingCursor::StartPrefetching() {
+  records_.clear();
+  error_ = nullptr;
+  stop_ = false;
+  thread_ = std::thread([this] { Prefetch(); });
+}
+
+void PrefetchingCursor::StopPrefetching() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  records_.clear();
+}
+
+void PrefetchingCursor::Prefetch() {
+  // Touches one byte per page of the views, to read them from disk
+  constexpr size_t kPageSize = 4096;
+  try {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // The front of the buffer is the current record
+        cv_.wait(lock, [this] {
+          return stop_ || records_.size() < read_ahead_ + 1;
+        });
+        if (stop_) {
+          return;
+        }
+      }
+      Record record;
+      record.valid = cursor_->Valid();
+      if (record.valid) {
+        record.key = cursor_->key();
+        if (zero_copy_) {
+          auto view = cursor_->valueView();
+          record.data = view.data();
+          record.size = view.size();
+          volatile char touched = 0;
+          for (size_t i = 0; i < record.size; i += kPageSize) {
+            touched = record.data[i];
+          }
+          (void)touched;
+        } else {
+          record.value = cursor_->value();
+        }
+      }
+      const bool valid = record.valid;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.push_back(std::move(record));
+      }
+      cv_.notify_all();
+      if (!valid) {
+        // The end of the db, until the next seek
+        return;
+      }
+      cursor_->Next();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+    cv_.notify_all();
+  }
+}
+
 void DBReaderSerializer::Serialize(
     const void* pointer,
     TypeMeta typeMeta,
@@ -1,8 +1,13 @@
 #ifndef CAFFE2_CORE_DB_H_
 #define CAFFE2_CORE_DB_H_
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
 
+#include "c10/util/ArrayRef.h"
 #include "c10/util/Registry.h"
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/proto/caffe2_pb.h"
@@ -46,6 +51,18 @@ class CAFFE2_API Cursor {
    * Returns the current value.
    */
   virtual string value() = 0;
+  /**
+   * Returns a view of the current value, which avoids copying it for dbs that
+   * hand out their own memory (e.g. LMDB, whose values point into its memory
+   * map). The view is valid until the cursor moves, or, if
+   * ViewsOutliveNext(), as long as the cursor exists. In default, the value
+   * is copied into a buffer of the cursor.
+   */
+  virtual c10::ArrayRef<char> valueView() {
+    value_buffer_ = value();
+    return c10::ArrayRef<char>(value_buffer_.data(), value_buffer_.size());
+  }
+  virtual bool ViewsOutliveNext() { return false; }
   /**
    * Returns whether the current location is valid - for example, if we have
    * reached the end of the database, return false.
@@ -53,6 +70,68 @@ class CAFFE2_API Cursor {
   virtual bool Valid() = 0;
 
   C10_DISABLE_COPY_AND_ASSIGN(Cursor);
+
+ private:
+  string value_buffer_;
+};
+
+/**
+ * A cursor that reads ahead of another one in a background thread, so that
+ * readers do not wait for the disk. Up to `read_ahead` records after the
+ * current one are buffered; if the underlying cursor's views outlive Next(),
+ * the buffered values are views too, and the thread only touches their pages
+ * to bring them into memory.
+ *
+ * Like other cursors, a PrefetchingCursor is not thread safe. Seek() and
+ * SeekToFirst() drop the records read ahead.
+ */
+class CAFFE2_API PrefetchingCursor : public Cursor {
+ public:
+  PrefetchingCursor(std::unique_ptr<Cursor> cursor, size_t read_ahead);
+  ~PrefetchingCursor() override;
+
+  void Seek(const string& key) override;
+  bool SupportsSeek() override { return cursor_->SupportsSeek(); }
+  void SeekToFirst() override;
+  void Next() override;
+  string key() override;
+  string value() override;
+  c10::ArrayRef<char> valueView() override;
+  bool ViewsOutliveNext() override { return false; }
+  bool Valid() override;
+
+ private:
+  struct Record {
+    bool valid = false;
+    string key;
+    // the value, or a view of it if the views of cursor_ outlive Next()
+    string value;
+    const char* data = nullptr;
+    size_t size = 0;
+
+    c10::ArrayRef<char> view() const {
+      return data ? c10::ArrayRef<char>(data, size)
+                  : c10::ArrayRef<char>(value.data(), value.size());
+    }
+  };
+
+  void StartPrefetching();
+  void StopPrefetching();
+  void Prefetch();
+  // Waits for the current record to be read. Requires mutex_.
+  const Record& Current(std::unique_lock<std::mutex>& lock);
+
+  std::unique_ptr<Cursor> cursor_;
+  const size_t read_ahead_;
+  const bool zero_copy_;
+  std::mutex mutex_; // protects records_, stop_ and error_
+  std::condition_variable cv_;
+  std::deque<Record> records_; // the current record is at the front
+  bool stop_ = false;
+  std::exception_ptr error_;
+  std::thread thread_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(PrefetchingCursor);
 };
 
 /**
@@ -151,8 +230,9 @@ class CAFFE2_API DBReader {
       const string& db_type,
       const string& source,
       const int32_t num_shards = 1,
-      const int32_t shard_id = 0) {
-    Open(db_type, source, num_shards, shard_id);
+      const int32_t shard_id = 0,
+      const int32_t read_ahead = 0) {
+    Open(db_type, source, num_shards, shard_id, read_ahead);
   }
 
   explicit DBReader(const DBReaderProto& proto) {
@@ -175,11 +255,16 @@ class CAFFE2_API DBReader {
     cursor_ = db_->NewCursor();
   }
 
+  /**
+   * Opens the db. With a positive `read_ahead`, the reader reads up to that
+   * many records ahead in a background thread (see PrefetchingCursor).
+   */
   void Open(
       const string& db_type,
       const string& source,
       const int32_t num_shards = 1,
-      const int32_t shard_id = 0) {
+      const int32_t shard_id = 0,
+      const int32_t read_ahead = 0) {
     // Note(jiayq): resetting is needed when we re-open e.g. leveldb where no
     // concurrent access is allowed.
     cursor_.reset();
@@ -188,18 +273,19 @@ class CAFFE2_API DBReader {
     source_ = source;
     db_ = CreateDB(db_type_, source_, READ);
     CAFFE_ENFORCE(db_, "Cannot open db: ", source_, " of type ", db_type_);
-    InitializeCursor(num_shards, shard_id);
+    InitializeCursor(num_shards, shard_id, read_ahead);
   }
 
   void Open(
       unique_ptr<DB>&& db,
       const int32_t num_shards = 1,
-      const int32_t shard_id = 0) {
+      const int32_t shard_id = 0,
+      const int32_t read_ahead = 0) {
     cursor_.reset();
     db_.reset();
     db_ = std::move(db);
     CAFFE_ENFORCE(db_.get(), "Passed null db");
-    InitializeCursor(num_shards, shard_id);
+    InitializeCursor(num_shards, shard_id, read_ahead);
   }
 
  public:
@@ -223,7 +309,9 @@ class CAFFE2_API DBReader {
     CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
     *key = cursor_->key();
-    *value = cursor_->value();
+    // Copies the value once, into the buffer of the caller's string
+    auto view = cursor_->valueView();
+    value->assign(view.data(), view.size());
 
     // In sharded mode, each read skips num_shards_ records
     for (uint32_t s = 0; s < num_shards_; s++) {
@@ -258,13 +346,21 @@ class CAFFE2_API DBReader {
   }
 
  private:
-  void InitializeCursor(const int32_t num_shards, const int32_t shard_id) {
+  void InitializeCursor(
+      const int32_t num_shards,
+      const int32_t shard_id,
+      const int32_t read_ahead) {
     CAFFE_ENFORCE(num_shards >= 1);
     CAFFE_ENFORCE(shard_id >= 0);
     CAFFE_ENFORCE(shard_id < num_shards);
+    CAFFE_ENFORCE(read_ahead >= 0);
     num_shards_ = num_shards;
     shard_id_ = shard_id;
     cursor_ = db_->NewCursor();
+    if (read_ahead > 0) {
+      cursor_ =
+          make_unique<PrefetchingCursor>(std::move(cursor_), read_ahead);
+    }
     SeekToFirst();
   }
 
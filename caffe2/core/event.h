@@ -4,6 +4,7 @@
 #include <chrono>
 
 #include <c10/DeviceType.h>
+#include <c10/util/TraceContext.h>
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/proto/caffe2_pb.h"
@@ -134,10 +135,13 @@ class CAFFE2_API Event {
     return event_callback_setter_[type_] != nullptr;
   }
 
+  // The callback runs with the trace context of the caller, on the thread
+  // that finishes the event
   void SetCallback(EventCallbackFunction callback) {
     CAFFE_ENFORCE(
         event_callback_setter_[type_], "Event does not support callbacks");
-    event_callback_setter_[type_](this, callback);
+    event_callback_setter_[type_](
+        this, c10::withCurrentTraceContext(std::move(callback)));
   }
 
   // If parent op has succeeded, then we can run any child op;
@@ -12,11 +12,16 @@
 
 #include "caffe2/core/init.h"
 
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+#include <ATen/CPUGeneral.h>
+#endif // CAFFE2_USE_ATEN_THREADPOOL
+
 C10_DEFINE_int(
     caffe2_omp_num_threads,
     0,
     "The number of openmp threads. 0 to use default value. "
-    "Does not have effect if OpenMP is disabled.");
+    "Does not have effect if OpenMP is disabled. With the ATen thread pool, "
+    "this is also the number of intra-op threads.");
 C10_DEFINE_int(
     caffe2_mkl_num_threads,
     0,
@@ -47,6 +52,22 @@ REGISTER_CAFFE2_INIT_FUNCTION(Caffe2SetOpenMPThreads,
                               "Set OpenMP threads.");
 #endif // _OPENMP
 
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+bool Caffe2SetIntraOpThreads(int*, char***) {
+  // Takes effect as long as no intra-op work has run yet
+  if (FLAGS_caffe2_omp_num_threads > 0) {
+    VLOG(1) << "Setting the intra-op threads to "
+            << FLAGS_caffe2_omp_num_threads;
+    at::set_num_threads(FLAGS_caffe2_omp_num_threads);
+  }
+  return true;
+}
+REGISTER_CAFFE2_INIT_FUNCTION(
+    Caffe2SetIntraOpThreads,
+    &Caffe2SetIntraOpThreads,
+    "Set the threads of the ATen intra-op pool.");
+#endif // CAFFE2_USE_ATEN_THREADPOOL
+
 #ifdef CAFFE2_USE_MKL
 bool Caffe2SetMKLThreads(int*, char***) {
   if (!getenv("MKL_NUM_THREADS")) {
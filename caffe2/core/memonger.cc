@@ -3,6 +3,7 @@
 #include <set>
 #include <unordered_set>
 
+#include "caffe2/core/net_dag_utils.h"
 #include "caffe2/utils/proto_utils.h"
 
 namespace caffe2 {
@@ -11,6 +12,10 @@ namespace memonger {
 NetDef optimize_inference_net(
     const NetDef& net,
     const std::set<string>& static_blobs) {
+  if (net.type() == "dag" || net.type() == "async_dag" ||
+      net.type() == "async_scheduling") {
+    return optimize_inference_net_for_dag(net, static_blobs);
+  }
   if (net.type() != "" && net.type() != "simple") {
     LOG(INFO) << "Cannot optimize memory for nets of type: " << net.type();
     return net;
@@ -123,6 +128,157 @@ NetDef optimize_inference_net(
   return optim_net;
 }
 
+NetDef optimize_inference_net_for_dag(
+    const NetDef& net,
+    const std::set<string>& static_blobs) {
+  for (auto& op : net.op()) {
+    if (op.type() == "RecurrentNetwork") {
+      LOG(INFO) << "Memonger does not support RecurrentNetwork yet";
+      return net;
+    }
+  }
+  const int num_ops = net.op_size();
+
+  // Step 1: the ancestors of each operator in the dependency graph that the
+  // DAG executors build. Parents always precede their children in the net.
+  auto op_nodes = dag_utils::prepareOpGraphNodes(net);
+  std::vector<std::vector<bool>> ancestors(num_ops);
+  for (int i = 0; i < num_ops; i++) {
+    ancestors[i].resize(num_ops, false);
+    for (int parent : op_nodes[i].parents_) {
+      ancestors[i][parent] = true;
+      for (int j = 0; j < parent; j++) {
+        if (ancestors[parent][j]) {
+          ancestors[i][j] = true;
+        }
+      }
+    }
+  }
+
+  // Step 2: find the operators that use each blob. A blob can be shared if
+  // the net creates it, i.e. it is written before it is read.
+  std::unordered_set<std::string> all_blobs;
+  std::unordered_set<std::string> not_shareable(
+      static_blobs.begin(), static_blobs.end());
+  not_shareable.insert(net.external_input().begin(), net.external_input().end());
+  not_shareable.insert(
+      net.external_output().begin(), net.external_output().end());
+  std::unordered_map<std::string, int> first_writer;
+  std::unordered_map<std::string, std::vector<int>> users;
+  for (int i = 0; i < num_ops; i++) {
+    const auto& op = net.op(i);
+    auto read = [&](const std::string& blob) {
+      all_blobs.insert(blob);
+      if (first_writer.find(blob) == first_writer.end()) {
+        not_shareable.insert(blob);
+      }
+      users[blob].push_back(i);
+    };
+    for (auto& inp : op.input()) {
+      read(inp);
+    }
+    for (auto& inp : op.control_input()) {
+      read(inp);
+    }
+    for (auto& outp : op.output()) {
+      all_blobs.insert(outp);
+      first_writer.emplace(outp, i);
+      users[outp].push_back(i);
+    }
+  }
+
+  // Step 3: pass over ops in order, and put each blob the op creates into the
+  // first shared blob whose operators are all ancestors of the op. These
+  // operators finished before the op starts under any schedule of the DAG,
+  // so renaming adds no dependencies that the DAG does not have already.
+  struct SharedBlob {
+    std::vector<std::string> blobs;
+    std::vector<int> users;
+    DeviceOption device_option;
+  };
+  std::vector<SharedBlob> shared;
+  std::unordered_map<std::string, int> mapping;
+  for (int i = 0; i < num_ops; i++) {
+    const auto& op = net.op(i);
+    const auto& device_option =
+        op.has_device_option() ? op.device_option() : net.device_option();
+    for (auto& outp : op.output()) {
+      if (first_writer[outp] != i || not_shareable.count(outp) ||
+          mapping.count(outp)) {
+        continue;
+      }
+      int idx = 0;
+      for (; idx < (int)shared.size(); idx++) {
+        if (!IsSameDevice(shared[idx].device_option, device_option)) {
+          continue;
+        }
+        bool finished = true;
+        for (int user : shared[idx].users) {
+          if (!ancestors[i][user]) {
+            finished = false;
+            break;
+          }
+        }
+        if (finished) {
+          break;
+        }
+      }
+      if (idx == (int)shared.size()) {
+        shared.emplace_back();
+        shared.back().device_option = device_option;
+      }
+      auto& blob = shared[idx];
+      blob.blobs.push_back(outp);
+      blob.users.insert(
+          blob.users.end(), users[outp].begin(), users[outp].end());
+      mapping[outp] = idx;
+    }
+  }
+
+  // Step 4: rename the blobs that share memory with others
+  std::unordered_map<std::string, std::string> renaming;
+  int num_shared = 0;
+  for (const auto& blob : shared) {
+    if (blob.blobs.size() < 2) {
+      continue;
+    }
+    string shared_blob = "__m" + c10::to_string(num_shared++) + "_shared";
+    // Safety check to prevent double-memongering nets.
+    if (all_blobs.find(shared_blob) != all_blobs.end()) {
+      LOG(INFO) << "Net was already memongered!";
+      return net;
+    }
+    for (const auto& name : blob.blobs) {
+      renaming[name] = shared_blob;
+    }
+  }
+
+  NetDef optim_net = net;
+  for (auto& op : *optim_net.mutable_op()) {
+    for (int i = 0; i < op.input_size(); i++) {
+      auto it = renaming.find(op.input(i));
+      if (it != renaming.end()) {
+        op.set_input(i, it->second);
+      }
+    }
+    for (int i = 0; i < op.control_input_size(); i++) {
+      auto it = renaming.find(op.control_input(i));
+      if (it != renaming.end()) {
+        op.set_control_input(i, it->second);
+      }
+    }
+    for (int i = 0; i < op.output_size(); i++) {
+      auto it = renaming.find(op.output(i));
+      if (it != renaming.end()) {
+        op.set_output(i, it->second);
+      }
+    }
+  }
+
+  VLOG(1) << "optimized DAG net using " << num_shared << " shared blobs";
+  return optim_net;
+}
+
 class ComputeBlobRecyclingForDag {
  public:
   explicit ComputeBlobRecyclingForDag(const int size)
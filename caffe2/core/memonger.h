@@ -1,6 +1,7 @@
 #ifndef CAFFE2_CORE_MEMONGER_H_
 #define CAFFE2_CORE_MEMONGER_H_
 
+#include <set>
 #include <unordered_set>
 
 #include "caffe2/core/common.h"
@@ -14,6 +15,15 @@ CAFFE2_API NetDef optimize_inference_net(
     const NetDef& net,
     const std::set<string>& static_blobs);
 
+// Variant of optimize_inference_net for nets that run on the DAG executors
+// (dag, async_scheduling), which may run operators out of order. A blob
+// reuses the memory of another only if all operators using the other one are
+// dependencies of the operator that creates it, so that the rewritten net
+// has the same parallelism as the original one.
+CAFFE2_API NetDef optimize_inference_net_for_dag(
+    const NetDef& net,
+    const std::set<string>& static_blobs);
+
 CAFFE2_API NetDef compute_blob_recycling_for_dag(
     const NetDef& net,
     const std::vector<string>& heads,
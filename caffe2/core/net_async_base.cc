@@ -2,6 +2,7 @@
 
 #include "caffe2/core/net_async_tracing.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/core/static_tracepoint.h"
 #include "caffe2/core/timer.h"
 
 // experimental support for multiple streams per worker per GPU
@@ -387,9 +388,18 @@ bool AsyncNetBase::run(int task_id, int stream_id) {
     if (!options_.finish_chain_) {
       asyncWait(task_id, stream_id, parents(task_id));
     }
+#ifdef CAFFE2_ENABLE_SDT
+    const auto& net_name = name_.c_str();
+    CAFFE_SDT(task_start, net_name, this, task_id, stream_id);
+#endif
     for (auto& op_id : chains_[task_id]) {
       op = operators_[op_id];
       bool success = false;
+#ifdef CAFFE2_ENABLE_SDT
+      const auto& op_name = op->debug_def().name().c_str();
+      const auto& op_type = op->debug_def().type().c_str();
+      CAFFE_SDT(operator_start, net_name, op_name, op_type, op);
+#endif
       if (!options_.report_stats_) {
         TRACE_EVENT(
             tracing::TRACE_OP,
@@ -407,6 +417,9 @@ bool AsyncNetBase::run(int task_id, int stream_id) {
         }
         counters_.AddPerOpEndTime(op_id);
       }
+#ifdef CAFFE2_ENABLE_SDT
+      CAFFE_SDT(operator_done, net_name, op_name, op_type, op);
+#endif
 
       if (!success) {
         handleChainError(task_id, op, "Failed to execute an op");
@@ -418,6 +431,9 @@ bool AsyncNetBase::run(int task_id, int stream_id) {
     if (options_.finish_chain_) {
       operators_[chains_[task_id].back()]->event().Finish();
     }
+#ifdef CAFFE2_ENABLE_SDT
+    CAFFE_SDT(task_done, net_name, this, task_id, stream_id);
+#endif
   } catch (const std::exception& e) {
     handleChainError(task_id, op, e.what(), /* save_exception */ true);
     return false;
@@ -541,6 +557,10 @@ ExecutionOptions::ExecutionOptions(
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
     }
+    if (arg.has_name() && arg.name() == "critical_path_scheduling") {
+      CAFFE_ENFORCE(arg.has_i(), "critical_path_scheduling should be an int");
+      use_critical_path_scheduling_ = arg.i() == 1;
+    }
   }
 
   run_root_tasks_inline_ = FLAGS_caffe2_net_async_run_root_tasks_inline;
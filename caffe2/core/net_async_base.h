@@ -44,6 +44,9 @@ struct ExecutionOptions {
   bool report_stats_ = false;
   bool use_dfs_scheduling_ = false;
   bool run_root_tasks_inline_ = false;
+  // Dispatch ready tasks in order of the estimated cost of their longest
+  // path to the end of the net (async_scheduling only)
+  bool use_critical_path_scheduling_ = false;
 };
 
 class CAFFE2_API AsyncNetBase : public NetBase {
@@ -24,6 +24,12 @@ C10_DEFINE_bool(
     false,
     "Use multiple streams per thread");
 
+C10_DEFINE_bool(
+    caffe2_async_dag_stream_affinity,
+    true,
+    "With multiple streams, run a chain on the stream of a parent chain "
+    "when possible instead of the next stream");
+
 C10_DECLARE_bool(caffe2_dag_net_collect_stats);
 
 C10_DECLARE_int(caffe2_streams_per_gpu);
@@ -103,6 +109,26 @@ AsyncDAGNet::AsyncDAGNet(
       events_.push_back(&operator_nodes_[tail_op_idx].operator_->event());
     }
   }
+  // Only the events of the chain tails are waited on, the ones of the inner
+  // ops would just be recorded on every run; keep them in case of profiling
+  if (!FLAGS_caffe2_dag_net_collect_stats) {
+    for (const auto& chain : execution_chains_) {
+      for (const auto op_idx : chain.second) {
+        if (op_idx == chain.second.back() || op_idx == chain.second.front()) {
+          continue;
+        }
+        operator_nodes_[op_idx].operator_->DisableEvent();
+      }
+    }
+  }
+
+  tailStreamId_.resize(net_def->op_size(), -1);
+  tailThreadId_.resize(net_def->op_size());
+  tailStreamTaken_.reset(new std::atomic<bool>[net_def->op_size()]);
+  for (int i = 0; i < net_def->op_size(); ++i) {
+    tailStreamTaken_[i] = false;
+  }
+
   VLOG(1) << "Total " << execution_chains_.size()
           << " chains, final waiting on " << events_.size() << " events";
 }
@@ -124,6 +150,32 @@ int AsyncDAGNet::stream(const DeviceOption& device_option) {
   return stream_id;
 }
 
+int AsyncDAGNet::parentStream(int source_idx) {
+  const auto& device_option =
+      operator_nodes_[source_idx].operator_->event().GetDeviceOption();
+  if (device_option.device_type() != PROTO_CUDA) {
+    return -1;
+  }
+  // CUDA streams are per thread, the stream id of a parent only names the
+  // same stream on the thread that ran it
+  const auto thread_id = std::this_thread::get_id();
+  for (auto parent_idx : operator_nodes_[source_idx].parents_) {
+    const auto& parent_option =
+        operator_nodes_[parent_idx].operator_->event().GetDeviceOption();
+    if (tailStreamId_[parent_idx] < 0 ||
+        tailThreadId_[parent_idx] != thread_id ||
+        parent_option.device_type() != PROTO_CUDA ||
+        parent_option.device_id() != device_option.device_id()) {
+      continue;
+    }
+    // Only one child can take over the stream, the others run concurrently
+    if (!tailStreamTaken_[parent_idx].exchange(true)) {
+      return tailStreamId_[parent_idx];
+    }
+  }
+  return -1;
+}
+
 bool AsyncDAGNet::RunAt(int chain_id, const std::vector<int>& chain) {
   CAFFE_ENFORCE(!chain.empty(), "Chain should not be empty.");
   const auto source_idx = chain.front();
@@ -140,8 +192,12 @@ bool AsyncDAGNet::RunAt(int chain_id, const std::vector<int>& chain) {
 
   int stream_id = 0;
   if (FLAGS_caffe2_async_dag_use_multiple_streams) {
-    stream_id = stream(
-        operator_nodes_[source_idx].operator_->event().GetDeviceOption());
+    const int parent_stream_id =
+        FLAGS_caffe2_async_dag_stream_affinity ? parentStream(source_idx) : -1;
+    stream_id = parent_stream_id >= 0
+        ? parent_stream_id
+        : stream(
+              operator_nodes_[source_idx].operator_->event().GetDeviceOption());
   }
 
   std::vector<const Event*> parent_events;
@@ -188,6 +244,8 @@ bool AsyncDAGNet::RunAt(int chain_id, const std::vector<int>& chain) {
       sink_idx,
       " should not be recorded.");
   eventRecorded_[sink_idx] = 1;
+  tailStreamId_[sink_idx] = stream_id;
+  tailThreadId_[sink_idx] = std::this_thread::get_id();
 
   if (FLAGS_caffe2_dag_net_collect_stats) {
     const auto& device_option =
@@ -203,6 +261,10 @@ bool AsyncDAGNet::RunAt(int chain_id, const std::vector<int>& chain) {
 bool AsyncDAGNet::DoRunAsync() {
   // Reset the event tracking at each iteration
   eventRecorded_.assign(eventRecorded_.size(), 0);
+  tailStreamId_.assign(tailStreamId_.size(), -1);
+  for (size_t i = 0; i < tailStreamId_.size(); ++i) {
+    tailStreamTaken_[i] = false;
+  }
 
   const auto result = DAGNetBase::DoRunAsync();
   return result;
@@ -1,6 +1,10 @@
 #ifndef CAFFE2_CORE_NET_ASYNC_DAG_GPU_H_
 #define CAFFE2_CORE_NET_ASYNC_DAG_GPU_H_
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include "caffe2/core/common.h"
 #include "caffe2/core/net_dag.h"
 #include "caffe2/core/workspace.h"
@@ -11,7 +15,10 @@ namespace caffe2 {
 // Run an event-driven graph - before each operator chain, wait on each parent
 // operator for the chain source, then execute each operator. Due to the chain
 // construction mechanism, operators in the same chain implicitly runs on the
-// same stream.
+// same stream. With multiple streams, a chain runs on the stream of one of
+// its parent chains when the same worker thread ran it, so that waiting on
+// that parent doesn't sync two streams; otherwise it takes the next of the
+// FLAGS_caffe2_streams_per_gpu streams of its device.
 // AsyncDAGNet is only registered in gpu mode, because CPU code is always sync
 // and a CPU only AsyncDAG net is essentially a DAG net.
 class AsyncDAGNet : public DAGNetBase {
@@ -30,6 +37,16 @@ class AsyncDAGNet : public DAGNetBase {
   std::vector<int32_t> eventRecorded_;
 
   int stream(const DeviceOption& device_option);
+  // Returns the stream of a parent of the chain starting at `source_idx`
+  // that can be reused by the chain, or -1 if there is none.
+  int parentStream(int source_idx);
+
+  // The stream and the thread each chain tail ran on in the current run,
+  // and whether a child chain has already taken over that stream.
+  std::vector<int> tailStreamId_;
+  std::vector<std::thread::id> tailThreadId_;
+  std::unique_ptr<std::atomic<bool>[]> tailStreamTaken_;
+
   static thread_local std::vector<int> stream_counters_;
 
   C10_DISABLE_COPY_AND_ASSIGN(AsyncDAGNet);
@@ -1,17 +1,154 @@
 #include "caffe2/core/net_async_scheduling.h"
 
+#include <algorithm>
+
 #include "caffe2/core/net_async_tracing.h"
+#include "caffe2/core/operator_schema.h"
+#include "caffe2/core/static_tracepoint.h"
 
 namespace caffe2 {
 
 AsyncSchedulingNet::AsyncSchedulingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false) {}
+    : AsyncNetBase(net_def, ws), ws_(ws), running_(false) {}
 
 void AsyncSchedulingNet::reset() {
   AsyncNetBase::reset();
   processed_tasks_num_ = 0;
+  // Estimates the costs on the first run, when the inputs are fed, and again
+  // once there are measured times
+  if (options_.use_critical_path_scheduling_ &&
+      (task_priorities_.empty() ||
+       (!priorities_from_stats_ && options_.report_stats_))) {
+    computePriorities();
+  }
+}
+
+std::vector<float> AsyncSchedulingNet::estimateOpCosts() {
+  if (options_.report_stats_) {
+    auto mean_times = counters_.GetPerOperatorMeanTime();
+    if (!mean_times.empty()) {
+      priorities_from_stats_ = true;
+      return mean_times;
+    }
+  }
+
+  // Uses flops and bytes accessed from the cost inference, where the schema
+  // has one and the input shapes are known. Other operators take the average
+  // cost of the estimated ones, or a unit cost if no cost is known.
+  std::vector<float> costs(operators_.size(), -1);
+  NetDef net_def = debug_def();
+  TensorShapes shapes;
+  try {
+    shapes = InferBlobShapesAndTypesFromWorkspace(ws_, {&net_def});
+  } catch (const std::exception& e) {
+    VLOG(1) << "Shape inference failed for net " << Name() << ": " << e.what();
+  }
+  CaffeMap<std::string, TensorShape> shape_map;
+  for (const auto& shape : shapes.shapes()) {
+    if (!shape.unknown_shape()) {
+      shape_map[shape.name()] = shape;
+    }
+  }
+  float known_cost = 0;
+  int num_known = 0;
+  for (size_t op_id = 0; op_id < operators_.size(); ++op_id) {
+    const auto& op_def = net_def.op(op_id);
+    const auto* schema = OpSchemaRegistry::Schema(op_def.type());
+    if (!schema || !schema->HasCostInferenceFunction()) {
+      continue;
+    }
+    vector<TensorShape> input_shapes;
+    for (const auto& input : op_def.input()) {
+      auto it = shape_map.find(input);
+      if (it == shape_map.end()) {
+        break;
+      }
+      input_shapes.push_back(it->second);
+    }
+    if (input_shapes.size() != (size_t)op_def.input_size()) {
+      continue;
+    }
+    try {
+      auto cost = schema->InferCost(op_def, input_shapes);
+      costs[op_id] = cost.flops + cost.bytes_read + cost.bytes_written;
+      known_cost += costs[op_id];
+      ++num_known;
+    } catch (const std::exception& e) {
+      VLOG(1) << "Cost inference failed for " << op_def.type() << ": "
+              << e.what();
+    }
+  }
+  float default_cost = num_known > 0 ? known_cost / num_known : 1;
+  for (auto& cost : costs) {
+    if (cost < 0) {
+      cost = default_cost;
+    }
+  }
+  return costs;
+}
+
+void AsyncSchedulingNet::computePriorities() {
+  auto op_costs = estimateOpCosts();
+  const int num_tasks = tasksNum();
+
+  // Processes the tasks from the end of the net, a task once all of its
+  // children are done: its priority is its cost plus the largest priority of
+  // its children
+  task_priorities_.assign(num_tasks, 0);
+  std::vector<int> pending_children(num_tasks);
+  std::vector<int> ready;
+  for (int task_id = 0; task_id < num_tasks; ++task_id) {
+    pending_children[task_id] = children(task_id).size();
+    if (pending_children[task_id] == 0) {
+      ready.push_back(task_id);
+    }
+  }
+  while (!ready.empty()) {
+    int task_id = ready.back();
+    ready.pop_back();
+    float max_child = 0;
+    for (auto child_id : children(task_id)) {
+      max_child = std::max(max_child, task_priorities_[child_id]);
+    }
+    float cost = 0;
+    for (auto op_id : chains_[task_id]) {
+      cost += op_costs[op_id];
+    }
+    task_priorities_[task_id] = cost + max_child;
+    for (auto parent_id : parents(task_id)) {
+      if (--pending_children[parent_id] == 0) {
+        ready.push_back(parent_id);
+      }
+    }
+  }
+
+  auto by_priority = [this](int a, int b) {
+    return task_priorities_[a] > task_priorities_[b];
+  };
+  prioritized_children_.resize(num_tasks);
+  prioritized_roots_.clear();
+  for (int task_id = 0; task_id < num_tasks; ++task_id) {
+    prioritized_children_[task_id] = children(task_id);
+    std::stable_sort(
+        prioritized_children_[task_id].begin(),
+        prioritized_children_[task_id].end(),
+        by_priority);
+    if (parents(task_id).empty()) {
+      prioritized_roots_.push_back(task_id);
+    }
+  }
+  std::stable_sort(
+      prioritized_roots_.begin(), prioritized_roots_.end(), by_priority);
+}
+
+const std::vector<int>& AsyncSchedulingNet::scheduledChildren(
+    int task_id) const {
+  if (options_.use_critical_path_scheduling_) {
+    return prioritized_children_[task_id];
+  }
+  return children(task_id);
 }
 
 void AsyncSchedulingNet::Wait() {
@@ -36,6 +173,9 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
   if (!testAndSetScheduled(task_id)) {
     return;
   }
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(task_schedule, name_.c_str(), this, task_id, run_inline);
+#endif
   auto schedule_func = [this, task_id]() {
     if (success_) {
       int stream_id = 0;
@@ -57,7 +197,23 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
       }
     }
 
-    for (auto child_id : children(task_id)) {
+    // With critical path scheduling, the children are dispatched by
+    // decreasing priority, and only the first one that can run inline does
+    // so, after the others are dispatched
+    int inline_child_id = -1;
+    auto schedule_child = [this, task_id, &inline_child_id](int child_id) {
+      bool run_inline = isInlineTask(task_id, child_id);
+      if (run_inline && options_.use_critical_path_scheduling_) {
+        if (inline_child_id < 0) {
+          inline_child_id = child_id;
+          return;
+        }
+        run_inline = false;
+      }
+      schedule(child_id, run_inline);
+    };
+
+    for (auto child_id : scheduledChildren(task_id)) {
       int parent_count = updateParentCount(child_id);
       if (parent_count == 0) {
         // Schedule a child if:
@@ -70,7 +226,7 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
             options_.finish_chain_ || canSchedule(child_id)) {
           // if DFS scheduling is enabled, run children inline,
           // ignore DFS scheduling in callbacks
-          schedule(child_id, isInlineTask(task_id, child_id));
+          schedule_child(child_id);
         } else {
           bool parent_failed = false;
           bool parent_needs_polling = false;
@@ -108,7 +264,7 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
           if (parent_failed) {
             // one of parents failed, set failure flag and wrap up execution
             success_ = false;
-            schedule(child_id, isInlineTask(task_id, child_id));
+            schedule_child(child_id);
           } else if (parent_needs_polling) {
             // some parents are blocking us from scheduling a child and don't
             // support callbacks, using polling
@@ -125,12 +281,16 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) {
             }
           } else {
             // we're ready to schedule a child
-            schedule(child_id, isInlineTask(task_id, child_id));
+            schedule_child(child_id);
           }
         }
       }
     }
 
+    if (inline_child_id >= 0) {
+      schedule(inline_child_id, /* run_inline */ true);
+    }
+
     // In case of net's failure, make sure all pending tasks are finished
     if (!success_) {
       // Simple logic to capture all pending tasks - check all tasks
@@ -171,7 +331,7 @@ void AsyncSchedulingNet::parentCallback(int parent_id) {
   if (event(parent_id).Query() != EventStatus::EVENT_SUCCESS) {
     success_ = false;
   }
-  for (auto child_id : children(parent_id)) {
+  for (auto child_id : scheduledChildren(parent_id)) {
     int parent_count = getParentCount(child_id);
     if (parent_count == 0) {
       if (!success_ || canSchedule(child_id)) {
@@ -209,6 +369,10 @@ void AsyncSchedulingNet::finishRun() {
   }
   // notify observers and waiters
   StopAllObservers();
+#ifdef CAFFE2_ENABLE_SDT
+  bool success = success_;
+  CAFFE_SDT(net_done, name_.c_str(), this, success);
+#endif
   running_ = false;
   running_cv_.notify_all();
 }
@@ -225,16 +389,25 @@ bool AsyncSchedulingNet::RunAsync() {
       reset();
 
       StartAllObservers();
+#ifdef CAFFE2_ENABLE_SDT
+      CAFFE_SDT(net_start, name_.c_str(), this);
+#endif
       tracing::startIter(tracer_);
       if (options_.report_stats_) {
         counters_.ReportRunStart();
       }
     }
 
-    for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
-      if (parents(task_id).empty()) {
+    if (options_.use_critical_path_scheduling_) {
+      for (auto task_id : prioritized_roots_) {
         schedule(task_id, options_.run_root_tasks_inline_);
       }
+    } else {
+      for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
+        if (parents(task_id).empty()) {
+          schedule(task_id, options_.run_root_tasks_inline_);
+        }
+      }
     }
   } catch (const std::exception& e) {
     LOG(ERROR) << "Exception while starting an async run: " << e.what();
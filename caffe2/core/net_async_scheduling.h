@@ -24,6 +24,20 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
   void parentCallback(int parent_id);
   bool isInlineTask(int parent_id, int child_id) const;
 
+  // Critical path scheduling: estimates the cost of each task, from the
+  // measured times of its operators once the net ran with profiling, or from
+  // the operators' cost inference, and orders the roots and the children of
+  // each task by the cost of their longest path to the end of the net.
+  void computePriorities();
+  std::vector<float> estimateOpCosts();
+  const std::vector<int>& scheduledChildren(int task_id) const;
+
+  Workspace* ws_;
+  std::vector<float> task_priorities_;
+  std::vector<std::vector<int>> prioritized_children_;
+  std::vector<int> prioritized_roots_;
+  bool priorities_from_stats_ = false;
+
   std::mutex running_mutex_;
   std::condition_variable running_cv_;
   std::atomic<bool> running_;
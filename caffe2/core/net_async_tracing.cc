@@ -16,6 +16,7 @@
 
 #include "caffe2/core/net_async_tracing.h"
 
+#include "c10/util/TraceContext.h"
 #include "caffe2/utils/proto_utils.h"
 #include "caffe2/utils/string_utils.h"
 
@@ -53,6 +54,13 @@ int getCounterForNetName(const std::string& net_name) {
   return counter;
 }
 
+// Microseconds on the clock of the other tracers of the process, such as the
+// autograd profiler, so that the traces of all nets line up with the ones of
+// the profiler
+long traceTimestamp() {
+  return static_cast<long>(c10::getTraceTimeNs() / 1000);
+}
+
 Tracer::Tracer(
     const NetBase* net,
     const std::string& net_name,
@@ -65,7 +73,6 @@ Tracer::Tracer(
   std::replace(filename_.begin(), filename_.end(), '/', '_');
   filename_ = this->config().filepath + "/" + filename_ + "_id_" +
       c10::to_string(getCounterForNetName(net_name));
-  timer_.Start();
 }
 
 void Tracer::recordEvent(const TracerEvent& event) {
@@ -116,7 +123,7 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
   }
 
   if (event.is_beginning_) {
-    std::unordered_map<std::string, int> int_args;
+    std::unordered_map<std::string, int64_t> int_args;
     std::unordered_map<std::string, std::string> string_args;
     if (event.name_) {
       serialized_event << " \"name\": \"" << event.name_ << "\",\n";
@@ -149,6 +156,10 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
       int_args["stream_id"] = event.stream_id_;
     }
 
+    if (event.request_id_ != 0) {
+      int_args["request_id"] = event.request_id_;
+    }
+
     serialized_event << " \"ph\": \"B\"";
     if (!int_args.empty() || !string_args.empty()) {
       serialized_event << ",\n \"args\": {\n";
@@ -341,7 +352,8 @@ void TracerGuard::recordEventStart() {
       event_.tid_ = std::this_thread::get_id();
     }
     event_.is_beginning_ = true;
-    event_.timestamp_ = (long)caffe2::round(tracer_->timer_.MicroSeconds());
+    event_.request_id_ = c10::TraceContext::current().request_id;
+    event_.timestamp_ = traceTimestamp();
     tracer_->recordEvent(event_);
   }
 }
@@ -349,7 +361,7 @@ void TracerGuard::recordEventStart() {
 TracerGuard::~TracerGuard() {
   if (enabled_) {
     event_.is_beginning_ = false;
-    event_.timestamp_ = (long)caffe2::round(tracer_->timer_.MicroSeconds());
+    event_.timestamp_ = traceTimestamp();
     tracer_->recordEvent(event_);
   }
 }
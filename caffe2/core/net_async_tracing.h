@@ -39,6 +39,9 @@ struct CAFFE2_API TracerEvent {
   bool is_beginning_ = false;
   long thread_label_ = -1;
   std::thread::id tid_;
+  // The request the thread was doing work for, 0 if none (see
+  // c10/util/TraceContext.h)
+  int64_t request_id_ = 0;
 };
 
 enum TracingField {
@@ -100,7 +103,6 @@ class CAFFE2_API Tracer {
   std::vector<TracerEvent> events_;
   std::mutex tracer_mutex_;
   bool enabled_ = false;
-  Timer timer_;
   int iter_;
   int dumping_iter_;
   TracingConfig config_;
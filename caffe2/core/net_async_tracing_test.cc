@@ -37,6 +37,20 @@ TEST(NetAsyncTracingTest, ExtractShardId) {
   testExtractShardId("FC:shard:15", 15);
 }
 
+TEST(NetAsyncTracingTest, SerializesRequestId) {
+  Tracer tracer(nullptr, "request_id_test");
+  TracerEvent event;
+  event.name_ = "task";
+  event.is_beginning_ = true;
+  event.request_id_ = 12345678901;
+  auto serialized = tracer.serializeEvent(event);
+  EXPECT_NE(serialized.find("\"request_id\": 12345678901"), std::string::npos);
+
+  event.request_id_ = 0;
+  serialized = tracer.serializeEvent(event);
+  EXPECT_EQ(serialized.find("request_id"), std::string::npos);
+}
+
 TEST(NetAsyncTracingTest, EveryKIteration) {
   const auto spec = R"DOC(
       name: "example"
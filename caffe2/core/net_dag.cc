@@ -99,6 +99,9 @@ DAGNetBase::~DAGNetBase() {
 
 bool DAGNetBase::DoRunAsync() {
   StartAllObservers();
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(net_start, name_.c_str(), this);
+#endif
 
   tracing::startIter(tracer_);
 
@@ -153,6 +156,9 @@ bool DAGNetBase::DoRunAsync() {
     }
     workers_.clear();
     job_queue_.reset(nullptr);
+#ifdef CAFFE2_ENABLE_SDT
+    CAFFE_SDT(net_done, name_.c_str(), this, false);
+#endif
 #ifdef CAFFE2_USE_EXCEPTION_PTR
     if (caught_exception_) {
       // Reset flag here in case Net gets run again
@@ -174,6 +180,9 @@ bool DAGNetBase::DoRunAsync() {
   }
 
   StopAllObservers();
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(net_done, name_.c_str(), this, true);
+#endif
   // If the above while loop finished, we know that the current run finished.
   return success_;
 }
@@ -369,28 +369,12 @@ ExecutionChains singleChains(std::vector<OperatorNode>& nodes) {
   return chains;
 }
 
-std::vector<OperatorNode> prepareOperatorNodes(
-    const std::shared_ptr<const NetDef>& net_def,
-    Workspace* ws) {
-  std::vector<OperatorNode> operator_nodes(net_def->op_size());
+std::vector<OpGraphNode> prepareOpGraphNodes(const NetDef& net_def) {
+  std::vector<OpGraphNode> op_nodes(net_def.op_size());
   std::map<string, int> blob_creator;
   std::map<string, std::set<int>> blob_readers;
-  bool net_def_has_device_option = net_def->has_device_option();
-  // Initialize the operators
-  for (int idx = 0; idx < net_def->op_size(); ++idx) {
-    const OperatorDef& op_def = net_def->op(idx);
-    VLOG(1) << "Creating operator #" << idx << ": " << op_def.name() << ": "
-            << op_def.type();
-    if (!op_def.has_device_option() && net_def_has_device_option) {
-      OperatorDef temp_def(op_def);
-      temp_def.mutable_device_option()->CopyFrom(net_def->device_option());
-      operator_nodes[idx].operator_ = CreateOperator(temp_def, ws, idx);
-    } else {
-      auto op = CreateOperator(op_def, ws, idx);
-      op->set_debug_def(
-          std::shared_ptr<const OperatorDef>{net_def, &(net_def->op(idx))});
-      operator_nodes[idx].operator_ = std::move(op);
-    }
+  for (int idx = 0; idx < net_def.op_size(); ++idx) {
+    const OperatorDef& op_def = net_def.op(idx);
     // Check the inputs, and set up parents if necessary. This addressese the
     // read after write case.
     auto checkInputs =
@@ -403,8 +387,8 @@ std::vector<OperatorNode> prepareOperatorNodes(
               int parent = blob_creator[input];
               VLOG(1) << "op dependency (RaW " << input << "): " << parent
                       << "->" << idx;
-              operator_nodes[idx].parents_.push_back(parent);
-              operator_nodes[parent].children_.push_back(idx);
+              op_nodes[idx].parents_.push_back(parent);
+              op_nodes[parent].children_.push_back(idx);
             }
             // Add the current idx to the readers of this input.
             blob_readers[input].insert(idx);
@@ -421,16 +405,16 @@ std::vector<OperatorNode> prepareOperatorNodes(
         int waw_parent = blob_creator[output];
         VLOG(1) << "op dependency (WaW " << output << "): " << waw_parent
                 << "->" << idx;
-        operator_nodes[idx].parents_.push_back(waw_parent);
-        operator_nodes[waw_parent].children_.push_back(idx);
+        op_nodes[idx].parents_.push_back(waw_parent);
+        op_nodes[waw_parent].children_.push_back(idx);
       }
       // This addresses the write after read case - we will assume that writes
       // should only occur after all previous reads are finished.
       for (const int war_parent : blob_readers[output]) {
         VLOG(1) << "op dependency (WaR " << output << "): " << war_parent
                 << "->" << idx;
-        operator_nodes[idx].parents_.push_back(war_parent);
-        operator_nodes[war_parent].children_.push_back(idx);
+        op_nodes[idx].parents_.push_back(war_parent);
+        op_nodes[war_parent].children_.push_back(idx);
       }
       // Renew the creator of the output name.
       blob_creator[output] = idx;
@@ -444,8 +428,8 @@ std::vector<OperatorNode> prepareOperatorNodes(
 
   // Now, make sure that the parent list and the children list do not contain
   // duplicated items.
-  for (int i = 0; i < (int)operator_nodes.size(); ++i) {
-    auto& node = operator_nodes[i];
+  for (int i = 0; i < (int)op_nodes.size(); ++i) {
+    auto& node = op_nodes[i];
     // Sort, remove duplicates, and delete self dependency.
     auto& p = node.parents_;
     std::sort(p.begin(), p.end());
@@ -456,6 +440,38 @@ std::vector<OperatorNode> prepareOperatorNodes(
     std::sort(c.begin(), c.end());
     c.erase(std::unique(c.begin(), c.end()), c.end());
     c.erase(std::remove(c.begin(), c.end(), i), c.end());
+    node.num_orig_parents = p.size();
+  }
+
+  return op_nodes;
+}
+
+std::vector<OperatorNode> prepareOperatorNodes(
+    const std::shared_ptr<const NetDef>& net_def,
+    Workspace* ws) {
+  std::vector<OperatorNode> operator_nodes(net_def->op_size());
+  bool net_def_has_device_option = net_def->has_device_option();
+  // Initialize the operators
+  for (int idx = 0; idx < net_def->op_size(); ++idx) {
+    const OperatorDef& op_def = net_def->op(idx);
+    VLOG(1) << "Creating operator #" << idx << ": " << op_def.name() << ": "
+            << op_def.type();
+    if (!op_def.has_device_option() && net_def_has_device_option) {
+      OperatorDef temp_def(op_def);
+      temp_def.mutable_device_option()->CopyFrom(net_def->device_option());
+      operator_nodes[idx].operator_ = CreateOperator(temp_def, ws, idx);
+    } else {
+      auto op = CreateOperator(op_def, ws, idx);
+      op->set_debug_def(
+          std::shared_ptr<const OperatorDef>{net_def, &(net_def->op(idx))});
+      operator_nodes[idx].operator_ = std::move(op);
+    }
+  }
+
+  auto op_nodes = prepareOpGraphNodes(*net_def);
+  for (int idx = 0; idx < (int)operator_nodes.size(); ++idx) {
+    operator_nodes[idx].parents_ = std::move(op_nodes[idx].parents_);
+    operator_nodes[idx].children_ = std::move(op_nodes[idx].children_);
   }
 
   return operator_nodes;
@@ -55,6 +55,12 @@ C10_EXPORT ExecutionChains computeGroups(std::vector<OperatorNode>& orig_nodes);
 
 C10_EXPORT ExecutionChains singleChains(std::vector<OperatorNode>& nodes);
 
+// The dependencies between the operators of the net: an operator depends on
+// the last writer of each of its inputs and outputs (RaW, WaW), and on the
+// readers of its outputs since their last write (WaR). Does not create the
+// operators.
+C10_EXPORT std::vector<OpGraphNode> prepareOpGraphNodes(const NetDef& net_def);
+
 C10_EXPORT std::vector<OperatorNode> prepareOperatorNodes(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws);
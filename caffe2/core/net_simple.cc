@@ -50,6 +50,9 @@ SimpleNet::SimpleNet(
 bool SimpleNet::Run() {
   StartAllObservers();
   VLOG(1) << "Running net " << name_;
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(net_start, name_.c_str(), this);
+#endif
   for (auto& op : operators_) {
     VLOG(1) << "Running operator " << op->debug_def().name() << "("
             << op->debug_def().type() << ").";
@@ -66,10 +69,16 @@ bool SimpleNet::Run() {
 #endif
     if (!res) {
       LOG(ERROR) << "Operator failed: " << ProtoDebugString(op->debug_def());
+#ifdef CAFFE2_ENABLE_SDT
+      CAFFE_SDT(net_done, name_.c_str(), this, false);
+#endif
       return false;
     }
   }
   StopAllObservers();
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(net_done, name_.c_str(), this, true);
+#endif
   return true;
 }
 
@@ -59,13 +59,29 @@ SimpleRefCountNet::SimpleRefCountNet(
 bool SimpleRefCountNet::Run() {
   StartAllObservers();
   VLOG(1) << "Running net " << name_;
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(net_start, name_.c_str(), this);
+#endif
   for (int op_id = 0; op_id < operators_.size(); ++op_id) {
     auto& op = operators_[op_id];
     VLOG(1) << "Running operator " << op->debug_def().name() << "("
             << op->debug_def().type() << ").";
+#ifdef CAFFE2_ENABLE_SDT
+    const auto& op_name = op->debug_def().name().c_str();
+    const auto& op_type = op->debug_def().type().c_str();
+    auto* op_ptr = op.get();
+    const auto& net_name = name_.c_str();
+    CAFFE_SDT(operator_start, net_name, op_name, op_type, op_ptr);
+#endif
     bool res = op->Run();
+#ifdef CAFFE2_ENABLE_SDT
+    CAFFE_SDT(operator_done, net_name, op_name, op_type, op_ptr);
+#endif
     if (!res) {
       LOG(ERROR) << "Operator failed: " << ProtoDebugString(op->debug_def());
+#ifdef CAFFE2_ENABLE_SDT
+      CAFFE_SDT(net_done, net_name, this, false);
+#endif
       return false;
     }
     for (Blob* blob : delete_list_[op_id]) {
@@ -73,6 +89,9 @@ bool SimpleRefCountNet::Run() {
     }
   }
   StopAllObservers();
+#ifdef CAFFE2_ENABLE_SDT
+  CAFFE_SDT(net_done, name_.c_str(), this, true);
+#endif
   return true;
 }
 
@@ -1058,4 +1058,65 @@ TEST(NetTest, ChainErrorTest) {
   ASSERT_FALSE(net->Run());
 }
 
+std::mutex execution_order_mutex;
+std::vector<std::string> execution_order;
+
+class RecordExecutionOp final : public Operator<CPUContext> {
+ public:
+  RecordExecutionOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+
+  bool RunOnDevice() override {
+    std::lock_guard<std::mutex> lock(execution_order_mutex);
+    execution_order.push_back(debug_def().output(0));
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(RecordExecutionOp, RecordExecutionOp);
+
+OPERATOR_SCHEMA(RecordExecutionOp).NumInputs(0, INT_MAX).NumOutputs(1);
+
+TEST(NetTest, CriticalPathScheduling) {
+  // Runs on a single thread, so that the tasks run in the order in which they
+  // are dispatched; the root of the longer tower goes first
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        num_workers: 1
+        arg {
+          name: "critical_path_scheduling"
+          i: 1
+        }
+        op {
+          output: "short"
+          type: "RecordExecutionOp"
+        }
+        op {
+          output: "long1"
+          type: "RecordExecutionOp"
+        }
+        op {
+          input: "long1"
+          output: "long2"
+          type: "RecordExecutionOp"
+        }
+        op {
+          input: "long2"
+          output: "long3"
+          type: "RecordExecutionOp"
+        }
+)DOC";
+
+  NetDef net_def;
+  CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+
+  Workspace ws;
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  execution_order.clear();
+  ASSERT_TRUE(net->Run());
+  ASSERT_EQ(execution_order.size(), 4);
+  EXPECT_EQ(execution_order.front(), "long1");
+}
+
 } // namespace caffe2
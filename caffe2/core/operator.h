@@ -416,6 +416,12 @@ class CAFFE2_API OperatorBase : public Observable<OperatorBase> {
     CAFFE_NOT_IMPLEMENTED;
   }
 
+  // The memory pool the CPU allocations of the operator come from, if its
+  // workspace has one
+  WorkspaceMemoryPool* workspace_memory_pool() const {
+    return operator_ws_ ? operator_ws_->memory_pool() : nullptr;
+  }
+
   void SetEventFinished(const char* err_msg = nullptr) {
     if (event_) {
       event_->SetFinished(err_msg);
@@ -530,6 +536,7 @@ class Operator : public OperatorBase {
   // Note: Run does not update operator's event and can be used only with
   // non-async executors that do not rely on events
   bool Run(int stream_id = 0) final {
+    ThreadLocalAllocatorGuard pool_guard(CPU, workspace_memory_pool());
     try {
       StartAllObservers();
 
@@ -560,6 +567,7 @@ class Operator : public OperatorBase {
   }
 
   bool RunAsync(int stream_id = 0) final {
+    ThreadLocalAllocatorGuard pool_guard(CPU, workspace_memory_pool());
     try {
       StartAllObservers();
 
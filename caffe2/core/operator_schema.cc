@@ -189,6 +189,26 @@ OpSchema& OpSchema::InputsCanCrossDevices() {
   return *this;
 }
 
+OpSchema& OpSchema::StorageOrderDependent(
+    std::vector<int> inputs,
+    std::vector<int> outputs) {
+  CAFFE_ENFORCE(
+      !storage_order_agnostic_,
+      "An operator can't be both storage order dependent and agnostic");
+  storage_order_dependent_ = true;
+  storage_order_inputs_ = std::move(inputs);
+  storage_order_outputs_ = std::move(outputs);
+  return *this;
+}
+
+OpSchema& OpSchema::StorageOrderAgnostic() {
+  CAFFE_ENFORCE(
+      !storage_order_dependent_,
+      "An operator can't be both storage order dependent and agnostic");
+  storage_order_agnostic_ = true;
+  return *this;
+}
+
 OpSchema& OpSchema::TensorInferenceFunction(
     TensorInferenceFunctionType function) {
   tensor_inference_function_ = function;
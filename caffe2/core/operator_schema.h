@@ -289,6 +289,17 @@ class CAFFE2_API OpSchema {
   // This op can pass data across devices
   OpSchema& InputsCanCrossDevices();
 
+  // This op runs in the storage order of its "order" argument, NCHW or NHWC,
+  // which applies to the given inputs and outputs (e.g. the data and the
+  // filter of a convolution, but not its bias).
+  OpSchema& StorageOrderDependent(
+      std::vector<int> inputs,
+      std::vector<int> outputs);
+
+  // This op computes elementwise over inputs and outputs of the same shape, so
+  // they can be in either storage order, as long as they all are in the same.
+  OpSchema& StorageOrderAgnostic();
+
   /**
    * @brief A function to allow one to get the number of outputs based on the
    * number of inputs, if this schema supports it.
@@ -353,6 +364,18 @@ class CAFFE2_API OpSchema {
   bool inputs_can_cross_devices() const {
     return inputs_can_cross_devices_;
   }
+  bool storage_order_dependent() const {
+    return storage_order_dependent_;
+  }
+  const std::vector<int>& storage_order_inputs() const {
+    return storage_order_inputs_;
+  }
+  const std::vector<int>& storage_order_outputs() const {
+    return storage_order_outputs_;
+  }
+  bool storage_order_agnostic() const {
+    return storage_order_agnostic_;
+  }
 
   /**
    * @brief Returns the required device location of inputs and outputs.
@@ -425,6 +448,10 @@ class CAFFE2_API OpSchema {
   int max_output_ = std::numeric_limits<int>::max();
   bool private_ = false;
   bool inputs_can_cross_devices_ = false;
+  bool storage_order_dependent_ = false;
+  std::vector<int> storage_order_inputs_{};
+  std::vector<int> storage_order_outputs_{};
+  bool storage_order_agnostic_ = false;
   std::function<bool(int)> num_inputs_allowed_ = [](int) { return true; };
   std::function<bool(int)> num_outputs_allowed_ = [](int) { return true; };
   std::function<bool(int, int)> num_inputs_outputs_allowed_ = [](int, int) {
@@ -1,6 +1,8 @@
 #include "caffe2/core/plan_executor.h"
 
+#include <algorithm>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -148,6 +150,71 @@ const string WorkspaceIdInjector::GLOBAL_WORKSPACE_ID = "GLOBAL_WORKSPACE_ID";
 
 struct CompiledExecutionStep;
 
+/**
+ * The queue between two stages of a pipeline. An item holds the blobs that
+ * a stage passes to the next one after one of its iterations. Pushes block
+ * while the queue is full, so that a fast stage waits for the next ones
+ * rather than piling up items.
+ */
+class PipelineQueue {
+ public:
+  using Item = std::vector<Blob>;
+
+  explicit PipelineQueue(size_t capacity) : capacity_(capacity) {}
+
+  // Returns false if the queue got closed, and the item is dropped.
+  bool Push(Item&& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(
+        lock, [this]() { return closed_ || items_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    notEmpty_.notify_one();
+    return true;
+  }
+
+  // Returns false if the queue got closed, or is empty after Finish().
+  bool Pop(Item* item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notEmpty_.wait(lock, [this]() {
+      return closed_ || finished_ || !items_.empty();
+    });
+    if (closed_ || items_.empty()) {
+      return false;
+    }
+    *item = std::move(items_.front());
+    items_.pop_front();
+    notFull_.notify_one();
+    return true;
+  }
+
+  // No more items will be pushed.
+  void Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+    notEmpty_.notify_all();
+  }
+
+  // No more items will be pushed or popped.
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+  }
+
+ private:
+  const size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable notEmpty_;
+  std::condition_variable notFull_;
+  std::deque<Item> items_;
+  bool finished_{false};
+  bool closed_{false};
+};
+
 /**
  * Controls compilation and runtime cloning of execution steps.
  *
@@ -202,6 +269,10 @@ struct ExecutionStepWrapper {
       return compiledRef_;
     }
 
+    CompiledExecutionStep* get() {
+      return compiledRef_;
+    }
+
    private:
     CompiledGuard() {}
     std::unique_ptr<CompiledExecutionStep> compiled_;
@@ -234,6 +305,45 @@ struct ExecutionStepWrapper {
   WorkspaceIdInjector* ws_id_injector_;
 };
 
+/**
+ * A stage of a pipeline, which runs in a number of threads. Each of them runs
+ * its own copy of the stage, in a child workspace that holds the blobs passed
+ * from and to the neighbouring stages, so that the copies don't share them.
+ */
+struct PipelineStage {
+  struct Worker {
+    std::unique_ptr<Workspace> workspace;
+    std::unique_ptr<ExecutionStepWrapper> stepWrapper;
+  };
+
+  explicit PipelineStage(const ExecutionStep* step) : step(step) {}
+
+  void reset(int numRunning) {
+    nextIter = 0;
+    stopped = false;
+    running = numRunning;
+    items = 0;
+    busyMicros = 0;
+    inputWaitMicros = 0;
+    outputWaitMicros = 0;
+  }
+
+  const ExecutionStep* step;
+  // the pipeline_output_blob of the previous stage
+  vector<string> inputBlobs;
+  vector<Worker> workers;
+
+  // the iterations of the first stage are shared by its copies
+  std::atomic<int64_t> nextIter{0};
+  std::atomic<bool> stopped{false};
+  std::atomic<int> running{0};
+
+  std::atomic<int64_t> items{0};
+  std::atomic<int64_t> busyMicros{0};
+  std::atomic<int64_t> inputWaitMicros{0};
+  std::atomic<int64_t> outputWaitMicros{0};
+};
+
 struct CompiledExecutionStep {
   typedef std::function<bool(int)> ShouldContinue;
 
@@ -277,7 +387,8 @@ struct CompiledExecutionStep {
 
     if (step->substep_size()) {
       ShouldContinue substepShouldContinue;
-      if (!step->concurrent_substeps() || step->substep().size() <= 1) {
+      if ((!step->concurrent_substeps() || step->substep().size() <= 1) &&
+          !step->pipeline_substeps()) {
         substepShouldContinue = externalShouldContinue;
       } else {
         substepShouldContinue = [this, externalShouldContinue](int64_t it) {
@@ -285,14 +396,15 @@ struct CompiledExecutionStep {
         };
       }
 
-      for (const auto& ss : step->substep()) {
-        auto compiledSubstep = std::make_shared<ExecutionStepWrapper>(
-            &ss, workspace, substepShouldContinue, netDefs, ws_id_injector);
-        if (ss.has_run_every_ms()) {
-          reportSubsteps.push_back(compiledSubstep);
-        } else {
-          recurringSubsteps.push_back(compiledSubstep);
-        }
+      if (step->pipeline_substeps()) {
+        CAFFE_ENFORCE(
+            !step->concurrent_substeps(),
+            "ExecutionStep ",
+            step->name(),
+            " cannot have both pipeline_substeps and concurrent_substeps");
+        compilePipeline(substepShouldContinue, netDefs, ws_id_injector);
+      } else {
+        compileSubsteps(substepShouldContinue, netDefs, ws_id_injector);
       }
     } else {
       for (const string& network_name : step->network()) {
@@ -325,6 +437,7 @@ struct CompiledExecutionStep {
   Workspace* workspace;
   vector<std::shared_ptr<ExecutionStepWrapper>> reportSubsteps;
   vector<std::shared_ptr<ExecutionStepWrapper>> recurringSubsteps;
+  vector<std::unique_ptr<PipelineStage>> pipelineStages;
 
   vector<NetBase*> networks;
   NetBase* reportNet;
@@ -334,6 +447,69 @@ struct CompiledExecutionStep {
   std::atomic<bool> gotFailure{false};
 
  private:
+  void compileSubsteps(
+      ShouldContinue substepShouldContinue,
+      NetDefMap* netDefs,
+      WorkspaceIdInjector* ws_id_injector) {
+    for (const auto& ss : step->substep()) {
+      auto compiledSubstep = std::make_shared<ExecutionStepWrapper>(
+          &ss, workspace, substepShouldContinue, netDefs, ws_id_injector);
+      if (ss.has_run_every_ms()) {
+        reportSubsteps.push_back(compiledSubstep);
+      } else {
+        recurringSubsteps.push_back(compiledSubstep);
+      }
+    }
+  }
+
+  void compilePipeline(
+      ShouldContinue stageShouldContinue,
+      NetDefMap* netDefs,
+      WorkspaceIdInjector* ws_id_injector) {
+    for (int i = 0; i < step->substep_size(); ++i) {
+      const auto& ss = step->substep(i);
+      bool sequential = !ss.concurrent_substeps() &&
+          !ss.pipeline_substeps() && !ss.has_report_net() &&
+          !ss.has_run_every_ms();
+      for (const auto& sss : ss.substep()) {
+        sequential = sequential && !sss.has_run_every_ms();
+      }
+      CAFFE_ENFORCE(
+          sequential,
+          "Pipeline stage ",
+          ss.name(),
+          " must run its nets or substeps sequentially, without reporters");
+
+      std::unique_ptr<PipelineStage> stage(new PipelineStage(&ss));
+      if (i > 0) {
+        const auto& inputBlobs = step->substep(i - 1).pipeline_output_blob();
+        stage->inputBlobs.assign(inputBlobs.begin(), inputBlobs.end());
+      }
+      int numWorkers = std::max(ss.num_concurrent_instances(), 1);
+      for (int w = 0; w < numWorkers; ++w) {
+        PipelineStage::Worker worker;
+        worker.workspace.reset(new Workspace(workspace));
+        ws_id_injector->InjectWorkspaceId(worker.workspace.get());
+        // Created before the nets, so that they use these rather than the
+        // blobs of the same name of the parent workspace
+        for (const string& name : stage->inputBlobs) {
+          worker.workspace->CreateLocalBlob(name);
+        }
+        for (const string& name : ss.pipeline_output_blob()) {
+          worker.workspace->CreateLocalBlob(name);
+        }
+        worker.stepWrapper.reset(new ExecutionStepWrapper(
+            &ss,
+            worker.workspace.get(),
+            stageShouldContinue,
+            netDefs,
+            ws_id_injector));
+        stage->workers.push_back(std::move(worker));
+      }
+      pipelineStages.push_back(std::move(stage));
+    }
+  }
+
   std::unique_ptr<Workspace> localWorkspace_;
 };
 
@@ -353,6 +529,191 @@ std::unique_ptr<CompiledExecutionStep> ExecutionStepWrapper::doCompile() {
     return true;                                                  \
   }
 
+bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper);
+
+// Runs the nets, or the substeps, of a step once, as an iteration of
+// ExecuteStepRecursive would. Sets `stopped` if its should_stop_blob is set.
+bool ExecuteStepIteration(CompiledExecutionStep* compiledStep, bool* stopped) {
+  const auto& step = *compiledStep->step;
+  if (step.substep_size()) {
+    for (auto& substepWrapper : compiledStep->recurringSubsteps) {
+      if (!ExecuteStepRecursive(*substepWrapper)) {
+        return false;
+      }
+      if (getShouldStop(compiledStep->shouldStop)) {
+        *stopped = true;
+        return true;
+      }
+    }
+  } else {
+    for (NetBase* network : compiledStep->networks) {
+      if (!network->Run()) {
+        return false;
+      }
+      if (getShouldStop(compiledStep->shouldStop)) {
+        *stopped = true;
+        return true;
+      }
+    }
+  }
+  return true;
+}
+
+// Runs the iterations of a copy of a stage of a pipeline, one per item, which
+// comes from `input` and goes to `output` unless they are null, at the ends
+// of the pipeline.
+bool RunPipelineStage(
+    PipelineStage& stage,
+    PipelineStage::Worker& worker,
+    PipelineQueue* input,
+    PipelineQueue* output,
+    const std::atomic<bool>& gotFailure) {
+  const auto& step = *stage.step;
+  auto compiledStage = worker.stepWrapper->compiled();
+  Workspace* ws = worker.workspace.get();
+  PipelineQueue::Item item;
+  while (!stage.stopped && !gotFailure) {
+    Timer timer;
+    if (input) {
+      if (!input->Pop(&item)) {
+        break;
+      }
+      for (size_t i = 0; i < item.size(); ++i) {
+        ws->GetBlob(stage.inputBlobs[i])->swap(item[i]);
+      }
+      stage.inputWaitMicros += static_cast<int64_t>(timer.MicroSeconds());
+      timer.Start();
+    } else if (!compiledStage->shouldContinue(stage.nextIter++)) {
+      break;
+    }
+
+    VLOG(1) << "Executing pipeline stage " << step.name();
+    bool stopped = false;
+    if (!ExecuteStepIteration(compiledStage.get(), &stopped)) {
+      return false;
+    }
+    stage.busyMicros += static_cast<int64_t>(timer.MicroSeconds());
+    if (stopped) {
+      VLOG(1) << "Pipeline stage " << step.name() << " stopped by "
+              << step.should_stop_blob();
+      stage.stopped = true;
+      break;
+    }
+
+    if (output) {
+      timer.Start();
+      PipelineQueue::Item produced(step.pipeline_output_blob_size());
+      for (size_t i = 0; i < produced.size(); ++i) {
+        produced[i].swap(*ws->GetBlob(step.pipeline_output_blob(i)));
+      }
+      if (!output->Push(std::move(produced))) {
+        // the next stage stopped
+        break;
+      }
+      stage.outputWaitMicros += static_cast<int64_t>(timer.MicroSeconds());
+    }
+    stage.items++;
+  }
+  return true;
+}
+
+bool ExecutePipeline(CompiledExecutionStep* compiledStep) {
+  const auto& step = *compiledStep->step;
+  auto& stages = compiledStep->pipelineStages;
+
+  std::vector<std::unique_ptr<PipelineQueue>> queues;
+  for (size_t s = 1; s < stages.size(); ++s) {
+    int capacity = step.has_pipeline_queue_capacity()
+        ? step.pipeline_queue_capacity()
+        : 2 * stages[s]->workers.size();
+    CAFFE_ENFORCE_GT(
+        capacity, 0, "Invalid pipeline_queue_capacity of step ", step.name());
+    queues.emplace_back(new PipelineQueue(capacity));
+  }
+  auto closeQueues = [&]() {
+    for (auto& queue : queues) {
+      queue->Close();
+    }
+  };
+
+  std::mutex exception_mutex;
+  string first_exception;
+  auto worker = [&](size_t s, size_t w) {
+    auto& stage = *stages[s];
+    PipelineQueue* input = s > 0 ? queues[s - 1].get() : nullptr;
+    PipelineQueue* output = s + 1 < stages.size() ? queues[s].get() : nullptr;
+    try {
+      if (!RunPipelineStage(
+              stage, stage.workers[w], input, output, compiledStep->gotFailure)) {
+        compiledStep->gotFailure = true;
+      }
+    } catch (const std::exception& ex) {
+      std::lock_guard<std::mutex> guard(exception_mutex);
+      if (!first_exception.size()) {
+        first_exception = c10::GetExceptionString(ex);
+        LOG(ERROR) << "Pipeline worker exception:\n" << first_exception;
+      }
+      compiledStep->gotFailure = true;
+      if (!FLAGS_caffe2_handle_executor_threads_exceptions) {
+        closeQueues();
+        throw;
+      }
+    }
+    if (compiledStep->gotFailure) {
+      closeQueues();
+    } else if (--stage.running == 0) {
+      // let the next stage drain its input, and stop the previous one
+      if (output) {
+        output->Finish();
+      }
+      if (input) {
+        input->Close();
+      }
+    }
+  };
+
+  VLOG(1) << "Executing step " << step.name() << " as a pipeline of "
+          << stages.size() << " stages";
+  for (auto& stage : stages) {
+    stage->reset(stage->workers.size());
+  }
+  Timer timer;
+  std::vector<std::thread> threads;
+  for (size_t s = 0; s < stages.size(); ++s) {
+    for (size_t w = 0; w < stages[s]->workers.size(); ++w) {
+      threads.emplace_back(worker, s, w);
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  float micros = timer.MicroSeconds();
+
+  if (compiledStep->gotFailure) {
+    LOG(ERROR) << "One of the pipeline workers failed.";
+    if (first_exception.size()) {
+      CAFFE_THROW(
+          "One of the pipeline workers died with an unhandled exception ",
+          first_exception);
+    }
+    return false;
+  }
+
+  // The share of the time each stage spent running, and waiting for the
+  // others: the stage that is the most busy is the one to give more threads.
+  for (auto& stage : stages) {
+    float total = std::max(micros * stage->workers.size(), 1.f);
+    LOG(INFO) << "Pipeline stage " << stage->step->name() << " of step "
+              << step.name() << " processed " << stage->items << " items in "
+              << stage->workers.size() << " threads, busy "
+              << 100 * stage->busyMicros / total << "% of the time, waiting "
+              << 100 * stage->inputWaitMicros / total << "% for input and "
+              << 100 * stage->outputWaitMicros / total
+              << "% for the next stage.";
+  }
+  return true;
+}
+
 bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
   const auto& step = stepWrapper.step();
   auto compiledStep = stepWrapper.compiled();
@@ -383,7 +744,15 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
 
   const Blob* shouldStop = compiledStep->shouldStop;
 
-  if (step.substep_size()) {
+  if (step.pipeline_substeps()) {
+    for (int64_t iter = 0; compiledStep->shouldContinue(iter); ++iter) {
+      if (!ExecutePipeline(compiledStep.get())) {
+        return false;
+      }
+      CHECK_SHOULD_STOP(step, shouldStop);
+    }
+    return true;
+  } else if (step.substep_size()) {
     bool sequential =
         (!step.concurrent_substeps() || step.substep().size() <= 1) &&
         (!step.has_num_concurrent_instances() ||
@@ -0,0 +1,414 @@
+#include "caffe2/core/pooled_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#include "TH/THAllocator.h"
+#include "caffe2/core/init.h"
+
+C10_DEFINE_bool(
+    caffe2_cpu_allocator_pooled,
+    false,
+    "If set, use the pooled, NUMA-aware allocator as the CPU allocator");
+
+C10_DEFINE_string(
+    caffe2_cpu_allocator_numa_policy,
+    "first_touch",
+    "NUMA placement policy of the pooled CPU allocator: none, first_touch "
+    "or bind. Has no effect unless caffe2_cpu_numa_enabled is set.");
+
+namespace caffe2 {
+
+namespace {
+
+// Size classes are the powers of two from 64 bytes to 64 MiB.
+constexpr int kMinSizeClassLog2 = 6;
+constexpr int kMaxSizeClassLog2 = 26;
+constexpr int kNumSizeClasses = kMaxSizeClassLog2 - kMinSizeClassLog2 + 1;
+// Size class of requests larger than the largest size class.
+constexpr int32_t kUncached = -1;
+
+// Thread caches hold up to kThreadCacheBlocks blocks of each size class up
+// to 1 MiB; larger blocks always go through the arena.
+constexpr int kNumThreadCachedClasses = 20 - kMinSizeClassLog2 + 1;
+constexpr size_t kThreadCacheBlocks = 8;
+
+// Every block is preceded by a header recording where it belongs, padded so
+// that the data stays gCaffe2Alignment-aligned.
+struct BlockHeader {
+  int32_t size_class;
+  int32_t node;
+  size_t size;
+};
+constexpr size_t kHeaderSize = gCaffe2Alignment;
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "block header too large");
+
+inline BlockHeader* header_of(void* ptr) {
+  return reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - kHeaderSize);
+}
+
+inline void* data_of(BlockHeader* header) {
+  return reinterpret_cast<char*>(header) + kHeaderSize;
+}
+
+int32_t size_class_of(size_t nbytes) {
+  int log2 = kMinSizeClassLog2;
+  while (log2 <= kMaxSizeClassLog2 && (size_t(1) << log2) < nbytes) {
+    log2++;
+  }
+  return log2 > kMaxSizeClassLog2 ? kUncached : log2 - kMinSizeClassLog2;
+}
+
+inline size_t class_size(int32_t size_class) {
+  return size_t(1) << (size_class + kMinSizeClassLog2);
+}
+
+void* system_alloc(size_t nbytes) {
+  void* data = nullptr;
+#ifdef __ANDROID__
+  data = memalign(gCaffe2Alignment, nbytes);
+#elif defined(_MSC_VER)
+  data = _aligned_malloc(nbytes, gCaffe2Alignment);
+#else
+  CAFFE_ENFORCE_EQ(posix_memalign(&data, gCaffe2Alignment, nbytes), 0);
+#endif
+  CAFFE_ENFORCE(data, "Failed to allocate ", nbytes, " bytes on CPU");
+  return data;
+}
+
+void system_free(void* data) {
+#ifdef _MSC_VER
+  _aligned_free(data);
+#else
+  free(data);
+#endif
+}
+
+// -1 until SetNUMAPolicy() is called, in which case the flag is used.
+std::atomic<int> numa_policy_override{-1};
+
+NUMAPolicy current_numa_policy() {
+  int policy = numa_policy_override.load();
+  if (policy >= 0) {
+    return static_cast<NUMAPolicy>(policy);
+  }
+  return ParseNUMAPolicy(FLAGS_caffe2_cpu_allocator_numa_policy);
+}
+
+struct Arena {
+  std::mutex mutex;
+  std::vector<void*> free_blocks[kNumSizeClasses];
+  // bytes cached for this node, in the arena and in thread caches
+  std::atomic<uint64_t> amount_cached{0};
+};
+
+struct ThreadCache;
+
+class CPUPool {
+ public:
+  static CPUPool& get() {
+    // Leaked on purpose: thread caches are flushed into the pool from
+    // thread_local destructors, which may run after static destructors.
+    static CPUPool* pool = new CPUPool();
+    return *pool;
+  }
+
+  void* allocate(size_t nbytes);
+  void free(void* ptr);
+
+  void flush(ThreadCache& cache);
+  void emptyCache();
+  PooledCPUAllocatorStats getStats();
+
+ private:
+  CPUPool();
+
+  int currentNode() const {
+    if (arenas_.size() == 1) {
+      return 0;
+    }
+    int node = GetCurrentNUMANode();
+    return node >= 0 ? node % static_cast<int>(arenas_.size()) : 0;
+  }
+
+  void* allocateFromSystem(int32_t size_class, size_t size, int node);
+
+  std::vector<std::unique_ptr<Arena>> arenas_;
+
+  std::atomic<uint64_t> num_allocs_{0};
+  std::atomic<uint64_t> num_thread_cache_hits_{0};
+  std::atomic<uint64_t> num_arena_hits_{0};
+  std::atomic<uint64_t> num_system_allocs_{0};
+  std::atomic<uint64_t> amount_allocated_{0};
+};
+
+struct ThreadCache {
+  // node the cached blocks live on, -1 if the thread has not allocated yet
+  int node = -1;
+  std::vector<void*> blocks[kNumThreadCachedClasses];
+
+  ~ThreadCache();
+};
+
+thread_local ThreadCache thread_cache;
+// Set once thread_cache has been destroyed, so that frees issued by later
+// thread_local destructors bypass it. Trivially destructible, so it can be
+// read at any point during thread exit.
+thread_local bool thread_cache_destroyed = false;
+
+ThreadCache::~ThreadCache() {
+  CPUPool::get().flush(*this);
+  thread_cache_destroyed = true;
+}
+
+CPUPool::CPUPool() {
+  size_t num_arenas = 1;
+  if (current_numa_policy() != NUMAPolicy::NONE && IsNUMAEnabled()) {
+    num_arenas = std::max(GetNumNUMANodes(), 1);
+  }
+  for (size_t i = 0; i < num_arenas; i++) {
+    arenas_.emplace_back(new Arena());
+  }
+}
+
+void* CPUPool::allocateFromSystem(int32_t size_class, size_t size, int node) {
+  auto* header = static_cast<BlockHeader*>(system_alloc(kHeaderSize + size));
+  if (arenas_.size() > 1 && current_numa_policy() == NUMAPolicy::BIND) {
+    NUMAMove(header, kHeaderSize + size, node);
+  }
+  header->size_class = size_class;
+  header->node = node;
+  header->size = size;
+  num_system_allocs_++;
+  amount_allocated_ += size;
+  return data_of(header);
+}
+
+void* CPUPool::allocate(size_t nbytes) {
+  num_allocs_++;
+  int32_t size_class = size_class_of(nbytes);
+  if (size_class == kUncached) {
+    return allocateFromSystem(kUncached, nbytes, currentNode());
+  }
+  size_t size = class_size(size_class);
+
+  ThreadCache* cache = thread_cache_destroyed ? nullptr : &thread_cache;
+  if (cache && size_class < kNumThreadCachedClasses &&
+      !cache->blocks[size_class].empty()) {
+    void* ptr = cache->blocks[size_class].back();
+    cache->blocks[size_class].pop_back();
+    arenas_[cache->node]->amount_cached -= size;
+    num_thread_cache_hits_++;
+    amount_allocated_ += size;
+    return ptr;
+  }
+
+  int node = currentNode();
+  if (cache && cache->node != node) {
+    // The thread moved to another node; its cached blocks are remote now.
+    flush(*cache);
+    cache->node = node;
+  }
+
+  Arena& arena = *arenas_[node];
+  {
+    std::lock_guard<std::mutex> lock(arena.mutex);
+    auto& free_blocks = arena.free_blocks[size_class];
+    if (!free_blocks.empty()) {
+      void* ptr = free_blocks.back();
+      free_blocks.pop_back();
+      arena.amount_cached -= size;
+      num_arena_hits_++;
+      amount_allocated_ += size;
+      return ptr;
+    }
+  }
+  return allocateFromSystem(size_class, size, node);
+}
+
+void CPUPool::free(void* ptr) {
+  BlockHeader* header = header_of(ptr);
+  amount_allocated_ -= header->size;
+  if (header->size_class == kUncached) {
+    system_free(header);
+    return;
+  }
+
+  Arena& arena = *arenas_[header->node];
+  ThreadCache* cache = thread_cache_destroyed ? nullptr : &thread_cache;
+  if (cache && header->size_class < kNumThreadCachedClasses &&
+      header->node == cache->node &&
+      cache->blocks[header->size_class].size() < kThreadCacheBlocks) {
+    cache->blocks[header->size_class].push_back(ptr);
+    arena.amount_cached += header->size;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  arena.free_blocks[header->size_class].push_back(ptr);
+  arena.amount_cached += header->size;
+}
+
+void CPUPool::flush(ThreadCache& cache) {
+  if (cache.node < 0) {
+    return;
+  }
+  // amount_cached is unchanged: the blocks stay cached for the same node.
+  Arena& arena = *arenas_[cache.node];
+  std::lock_guard<std::mutex> lock(arena.mutex);
+  for (int32_t size_class = 0; size_class < kNumThreadCachedClasses;
+       size_class++) {
+    auto& blocks = cache.blocks[size_class];
+    arena.free_blocks[size_class].insert(
+        arena.free_blocks[size_class].end(), blocks.begin(), blocks.end());
+    blocks.clear();
+  }
+}
+
+void CPUPool::emptyCache() {
+  if (!thread_cache_destroyed) {
+    flush(thread_cache);
+  }
+  for (auto& arena : arenas_) {
+    std::lock_guard<std::mutex> lock(arena->mutex);
+    for (int32_t size_class = 0; size_class < kNumSizeClasses; size_class++) {
+      for (void* ptr : arena->free_blocks[size_class]) {
+        system_free(header_of(ptr));
+      }
+      arena->amount_cached -=
+          arena->free_blocks[size_class].size() * class_size(size_class);
+      arena->free_blocks[size_class].clear();
+    }
+  }
+}
+
+PooledCPUAllocatorStats CPUPool::getStats() {
+  PooledCPUAllocatorStats stats;
+  stats.num_allocs = num_allocs_;
+  stats.num_thread_cache_hits = num_thread_cache_hits_;
+  stats.num_arena_hits = num_arena_hits_;
+  stats.num_system_allocs = num_system_allocs_;
+  stats.amount_allocated = amount_allocated_;
+  stats.amount_cached = 0;
+  for (auto& arena : arenas_) {
+    stats.amount_cached_per_node.push_back(arena->amount_cached);
+    stats.amount_cached += stats.amount_cached_per_node.back();
+  }
+  return stats;
+}
+
+} // namespace
+
+NUMAPolicy ParseNUMAPolicy(const std::string& name) {
+  if (name == "none") {
+    return NUMAPolicy::NONE;
+  } else if (name == "first_touch") {
+    return NUMAPolicy::FIRST_TOUCH;
+  } else if (name == "bind") {
+    return NUMAPolicy::BIND;
+  }
+  CAFFE_THROW(
+      "Unknown NUMA policy '",
+      name,
+      "', expected one of none, first_touch or bind");
+}
+
+at::DataPtr PooledCPUAllocator::allocate(size_t nbytes) const {
+  if (nbytes == 0) {
+    return {nullptr, nullptr, &Delete, at::Device(at::DeviceType::CPU)};
+  }
+  void* data = CPUPool::get().allocate(nbytes);
+  if (apply_fill_flags_) {
+    CHECK(
+        !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
+        !FLAGS_caffe2_cpu_allocator_do_junk_fill)
+        << "Cannot request both zero-fill and junk-fill at the same time";
+    if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+      memset(data, 0, nbytes);
+    } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+      memset_junk(data, nbytes);
+    }
+  }
+  return {data, data, &Delete, at::Device(at::DeviceType::CPU)};
+}
+
+void PooledCPUAllocator::Delete(void* ptr) {
+  if (ptr) {
+    CPUPool::get().free(ptr);
+  }
+}
+
+void PooledCPUAllocator::SetNUMAPolicy(NUMAPolicy policy) {
+  numa_policy_override = static_cast<int>(policy);
+}
+
+void PooledCPUAllocator::EmptyCache() {
+  CPUPool::get().emptyCache();
+}
+
+PooledCPUAllocatorStats PooledCPUAllocator::GetStats() {
+  return CPUPool::get().getStats();
+}
+
+at::Allocator* GetPooledCPUAllocator() {
+  static PooledCPUAllocator allocator;
+  return &allocator;
+}
+
+bool Caffe2SetPooledCPUAllocator(int*, char***) {
+  if (FLAGS_caffe2_cpu_allocator_pooled) {
+    // Keeps honoring the zero- and junk-fill flags of the default allocator.
+    static PooledCPUAllocator allocator(true);
+    SetCPUAllocator(&allocator);
+  }
+  return true;
+}
+
+REGISTER_CAFFE2_INIT_FUNCTION(
+    Caffe2SetPooledCPUAllocator,
+    &Caffe2SetPooledCPUAllocator,
+    "Use the pooled CPU allocator if requested.");
+
+namespace {
+
+// ATEN_CPU_ALLOCATOR=pooled makes the pooled allocator ATen's default CPU
+// allocator when the library is loaded, without waiting for GlobalInit(),
+// which ATen users never call. ATEN_CPU_NUMA_POLICY=first_touch or bind
+// additionally gives it one arena per NUMA node. Unknown values are reported
+// and leave ATen on its default allocator, since throwing here would abort
+// the process while the library is being loaded.
+struct THPooledAllocatorRegisterer {
+  THPooledAllocatorRegisterer() {
+    const char* allocator = std::getenv("ATEN_CPU_ALLOCATOR");
+    if (!allocator || std::string(allocator) == "default") {
+      return;
+    }
+    if (std::string(allocator) != "pooled") {
+      LOG(ERROR) << "ATEN_CPU_ALLOCATOR must be 'default' or 'pooled', got '"
+                 << allocator << "'";
+      return;
+    }
+    const char* numa_policy = std::getenv("ATEN_CPU_NUMA_POLICY");
+    if (numa_policy) {
+      NUMAPolicy policy;
+      try {
+        policy = ParseNUMAPolicy(numa_policy);
+      } catch (const c10::Error& e) {
+        LOG(ERROR) << "ATEN_CPU_NUMA_POLICY: " << e.msg_without_backtrace();
+        return;
+      }
+      if (policy != NUMAPolicy::NONE) {
+        FLAGS_caffe2_cpu_numa_enabled = true;
+      }
+      PooledCPUAllocator::SetNUMAPolicy(policy);
+    }
+    THSetDefaultAllocator(GetPooledCPUAllocator());
+  }
+};
+
+THPooledAllocatorRegisterer g_th_pooled_allocator_registerer;
+
+} // namespace
+
+} // namespace caffe2
@@ -0,0 +1,91 @@
+#ifndef CAFFE2_CORE_POOLED_ALLOCATOR_H_
+#define CAFFE2_CORE_POOLED_ALLOCATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "caffe2/core/allocator.h"
+
+C10_DECLARE_bool(caffe2_cpu_allocator_pooled);
+C10_DECLARE_string(caffe2_cpu_allocator_numa_policy);
+
+namespace caffe2 {
+
+// How the pooled allocator places the memory it obtains from the system.
+enum class NUMAPolicy {
+  // One arena for the whole process; page placement is left to the OS.
+  NONE,
+  // One arena per NUMA node. Fresh memory is not moved, so pages land on the
+  // node of the thread that first touches them, which is usually the
+  // allocating thread.
+  FIRST_TOUCH,
+  // One arena per NUMA node. Fresh memory is explicitly bound to the node of
+  // the allocating thread with NUMAMove().
+  BIND,
+};
+
+CAFFE2_API NUMAPolicy ParseNUMAPolicy(const std::string& name);
+
+struct PooledCPUAllocatorStats {
+  uint64_t num_allocs;
+  // allocations served from the calling thread's cache without locking
+  uint64_t num_thread_cache_hits;
+  // allocations served from a NUMA node arena
+  uint64_t num_arena_hits;
+  // allocations that had to go to the system allocator
+  uint64_t num_system_allocs;
+  // bytes currently handed out, rounded up to size classes
+  uint64_t amount_allocated;
+  // bytes held by arenas and thread caches, not handed out
+  uint64_t amount_cached;
+  // amount_cached broken down by NUMA node (a single entry for NUMAPolicy::NONE)
+  std::vector<uint64_t> amount_cached_per_node;
+};
+
+// A caching CPU allocator.
+//
+// Requests are rounded up to a power of two and served from a small
+// per-thread cache first, then from the arena of the NUMA node the calling
+// thread runs on, and only then from posix_memalign. Freed blocks go back to
+// the freeing thread's cache if it runs on the block's node, and to the arena
+// of the block's node otherwise, so a block is only ever reused on the node
+// its pages live on. Requests larger than the largest size class are not
+// cached.
+//
+// All instances share the same pool; an instance only decides whether newly
+// allocated memory is zero- or junk-filled according to the
+// caffe2_cpu_allocator_do_{zero,junk}_fill flags.
+struct CAFFE2_API PooledCPUAllocator final : at::Allocator {
+  explicit PooledCPUAllocator(bool apply_fill_flags = false)
+      : apply_fill_flags_(apply_fill_flags) {}
+  ~PooledCPUAllocator() override {}
+
+  at::DataPtr allocate(size_t nbytes) const override;
+
+  static void Delete(void* ptr);
+
+  at::DeleterFnPtr raw_deleter() const override {
+    return &Delete;
+  }
+
+  // Selects the NUMA placement policy. Takes effect for memory obtained from
+  // the system after the call; must be called before the first allocation to
+  // change the number of arenas.
+  static void SetNUMAPolicy(NUMAPolicy policy);
+
+  // Returns the cached blocks of all arenas, and of the calling thread's
+  // cache, to the system. Blocks cached by other threads are kept.
+  static void EmptyCache();
+
+  static PooledCPUAllocatorStats GetStats();
+
+ private:
+  bool apply_fill_flags_;
+};
+
+// The pooled allocator without fill, as used by ATen.
+CAFFE2_API at::Allocator* GetPooledCPUAllocator();
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_POOLED_ALLOCATOR_H_
@@ -0,0 +1,66 @@
+#include <thread>
+
+#include <gtest/gtest.h>
+#include "caffe2/core/pooled_allocator.h"
+
+namespace caffe2 {
+
+TEST(PooledCPUAllocatorTest, Alignment) {
+  PooledCPUAllocator allocator;
+  for (size_t nbytes : {1, 63, 64, 65, 4097, 1 << 20, (1 << 26) + 1}) {
+    auto data = allocator.allocate(nbytes);
+    EXPECT_EQ(reinterpret_cast<size_t>(data.get()) % gCaffe2Alignment, 0);
+    memset(data.get(), 0, nbytes);
+  }
+}
+
+TEST(PooledCPUAllocatorTest, ReusesBlocks) {
+  PooledCPUAllocator allocator;
+  PooledCPUAllocator::EmptyCache();
+  void* first = nullptr;
+  {
+    auto data = allocator.allocate(1000);
+    first = data.get();
+  }
+  auto before = PooledCPUAllocator::GetStats();
+  // 1000 and 1024 bytes share a size class
+  auto data = allocator.allocate(1024);
+  auto after = PooledCPUAllocator::GetStats();
+  EXPECT_EQ(data.get(), first);
+  EXPECT_EQ(after.num_thread_cache_hits, before.num_thread_cache_hits + 1);
+  EXPECT_EQ(after.num_system_allocs, before.num_system_allocs);
+  EXPECT_EQ(after.amount_allocated, before.amount_allocated + 1024);
+  EXPECT_EQ(after.amount_cached + 1024, before.amount_cached);
+}
+
+TEST(PooledCPUAllocatorTest, CrossThreadFree) {
+  PooledCPUAllocator allocator;
+  PooledCPUAllocator::EmptyCache();
+  auto data = allocator.allocate(1 << 16);
+  void* ptr = data.get();
+  // Blocks freed on a thread without a cache for their node go to the arena,
+  // where any thread on that node can pick them up.
+  std::thread([&]() { data.clear(); }).join();
+  auto before = PooledCPUAllocator::GetStats();
+  std::thread([&]() {
+    auto reused = allocator.allocate(1 << 16);
+    EXPECT_EQ(reused.get(), ptr);
+  }).join();
+  auto after = PooledCPUAllocator::GetStats();
+  EXPECT_EQ(after.num_arena_hits, before.num_arena_hits + 1);
+}
+
+TEST(PooledCPUAllocatorTest, EmptyCache) {
+  PooledCPUAllocator allocator;
+  {
+    auto small = allocator.allocate(100);
+    auto large = allocator.allocate(1 << 24);
+  }
+  EXPECT_GT(PooledCPUAllocator::GetStats().amount_cached, 0);
+  PooledCPUAllocator::EmptyCache();
+  auto stats = PooledCPUAllocator::GetStats();
+  EXPECT_EQ(stats.amount_cached, 0);
+  EXPECT_EQ(stats.amount_allocated, 0);
+}
+
+} // namespace caffe2
@@ -125,6 +125,18 @@ ProfDAGProtos ProfDAGCounters::GetPerOperatorCost() const {
   return prof_dag_protos;
 }
 
+std::vector<float> ProfDAGCounters::GetPerOperatorMeanTime() const {
+  std::vector<float> mean_times;
+  if (num_runs_ <= 1) {
+    return mean_times;
+  }
+  mean_times.reserve(op_types_.size());
+  for (const auto& stats : time_per_op_total_) {
+    mean_times.push_back(stats.cnt() > 0 ? stats.sum() / stats.cnt() : 0);
+  }
+  return mean_times;
+}
+
 void ProfDAGCounters::PrintStats() {
   if (num_runs_ <= 1) {
     LOG(INFO) << "Insufficient number of runs";
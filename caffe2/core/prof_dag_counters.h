@@ -63,6 +63,10 @@ class ProfDAGCounters {
   // formatted as a map: (netName__opIndex__opType, cost)
   ProfDAGProtos GetPerOperatorCost() const;
 
+  // Mean execution time (ms) of each operator of the net, or an empty vector
+  // if there are no measured runs yet
+  std::vector<float> GetPerOperatorMeanTime() const;
+
   // ReportRunStart/End are called at the beginning and at the end of
   // each net's run
   void ReportRunStart();
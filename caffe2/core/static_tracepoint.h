@@ -1,5 +1,15 @@
 #pragma once
 
+// USDT probes of the caffe2 provider. Each probe is a nop until a tracer
+// (perf, bcc, systemtap) attaches to it. Probes whose arguments take work to
+// compute are guarded by CAFFE2_ENABLE_SDT, which the USE_SDT build option
+// sets. These are:
+//   net_start(net_name, net), net_done(net_name, net, success)
+//   operator_start / operator_done(net_name, op_name, op_type, op)
+//   task_schedule(net_name, net, task_id, run_inline) for async_scheduling
+//   task_start / task_done(net_name, net, task_id, stream_id) for async nets
+//   cuda_alloc(ptr, nbytes, device), cuda_free(ptr)
+
 #if defined(__ELF__) && (defined(__x86_64__) || defined(__i386__))
 #include <caffe2/core/static_tracepoint_elfx86.h>
 
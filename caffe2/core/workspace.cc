@@ -66,6 +66,19 @@ void Workspace::PrintBlobSizes() {
               << "%";
   }
   LOG(INFO) << "Total;;" << cumtotal << ";100%";
+
+  if (memory_pool_) {
+    const auto stats = memory_pool_->GetStats();
+    LOG(INFO) << "---- Workspace memory pool: ---- ";
+    LOG(INFO) << "runs;allocations;pool hits;system allocations;releases;"
+              << "shrinks";
+    LOG(INFO) << stats.num_runs << ";" << stats.num_allocs << ";"
+              << stats.num_pool_hits << ";" << stats.num_system_allocs << ";"
+              << stats.num_releases << ";" << stats.num_shrinks;
+    LOG(INFO) << "allocated bytes;peak allocated bytes;cached bytes";
+    LOG(INFO) << stats.amount_allocated << ";" << stats.peak_allocated << ";"
+              << stats.amount_cached;
+  }
 }
 
 vector<string> Workspace::LocalBlobs() const {
@@ -267,7 +280,9 @@ bool Workspace::RunNet(const string& name) {
     LOG(ERROR) << "Network " << name << " does not exist yet.";
     return false;
   }
-  return net_map_[name]->Run();
+  bool result = net_map_[name]->Run();
+  FinishMemoryPoolRun();
+  return result;
 }
 
 bool Workspace::RunOperatorOnce(const OperatorDef& op_def) {
@@ -289,7 +304,9 @@ bool Workspace::RunNetOnce(const NetDef& net_def) {
         "Could not create net: " + net_def.name() + " of type " +
         net_def.type());
   }
-  if (!net->Run()) {
+  bool result = net->Run();
+  FinishMemoryPoolRun();
+  if (!result) {
     LOG(ERROR) << "Error when running network " << net_def.name();
     return false;
   }
@@ -308,6 +325,24 @@ ThreadPool* Workspace::GetThreadPool() {
   return thread_pool_.get();
 }
 
+void Workspace::EnableMemoryPool(int max_idle_runs) {
+  memory_pool_.reset(new WorkspaceMemoryPool(max_idle_runs));
+}
+
+void Workspace::FinishMemoryPoolRun() {
+  if (!memory_pool_) {
+    return;
+  }
+  std::vector<TensorImpl*> tensors;
+  for (const auto& entry : blob_map_) {
+    if (BlobIsTensorType(*entry.second, CPU)) {
+      tensors.push_back(
+          BlobGetMutableTensor(entry.second.get(), CPU)->unsafeGetTensorImpl());
+    }
+  }
+  memory_pool_->FinishRun(tensors);
+}
+
 std::shared_ptr<Workspace::Bookkeeper> Workspace::bookkeeper() {
   static auto shared = std::make_shared<Workspace::Bookkeeper>();
   return shared;
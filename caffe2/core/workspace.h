@@ -14,6 +14,7 @@
 #include "c10/util/Registry.h"
 #include "caffe2/core/blob.h"
 #include "caffe2/core/net.h"
+#include "caffe2/core/workspace_memory_pool.h"
 #include "caffe2/proto/caffe2_pb.h"
 #include "caffe2/utils/signal_handler.h"
 #include "caffe2/utils/threadpool/ThreadPool.h"
@@ -100,6 +101,9 @@ class CAFFE2_API Workspace {
    */
   Workspace(const string& root_folder, const Workspace* shared)
       : root_folder_(root_folder), shared_(shared), bookkeeper_(bookkeeper()) {
+    if (FLAGS_caffe2_workspace_memory_pool) {
+      EnableMemoryPool();
+    }
     std::lock_guard<std::mutex> guard(bookkeeper_->wsmutex);
     bookkeeper_->workspaces.insert(this);
   }
@@ -284,6 +288,22 @@ class CAFFE2_API Workspace {
    */
   ThreadPool* GetThreadPool();
 
+  /**
+   * Makes the operators run by this workspace allocate their CPU tensors from
+   * a memory pool of its own, which keeps the memory of the tensors they
+   * free for later runs of the nets. See WorkspaceMemoryPool for how the
+   * pool releases memory. Must not be called while a net is running.
+   */
+  void EnableMemoryPool(
+      int max_idle_runs = FLAGS_caffe2_workspace_memory_pool_max_idle_runs);
+
+  /*
+   * Returns the memory pool of the workspace, or nullptr if it has none.
+   */
+  WorkspaceMemoryPool* memory_pool() const {
+    return memory_pool_.get();
+  }
+
   // RunOperatorOnce and RunNetOnce runs an operator or net once. The difference
   // between RunNet and RunNetOnce lies in the fact that RunNet allows you to
   // have a persistent net object, while RunNetOnce creates a net and discards
@@ -318,6 +338,12 @@ class CAFFE2_API Workspace {
 
   static std::shared_ptr<Bookkeeper> bookkeeper();
 
+  // Tells the memory pool that a run has finished
+  void FinishMemoryPoolRun();
+
+  // Declared before the blobs, so that it is destroyed after they have given
+  // their memory back
+  std::unique_ptr<WorkspaceMemoryPool> memory_pool_;
   BlobMap blob_map_;
   NetMap net_map_;
   const string root_folder_;
@@ -0,0 +1,248 @@
+#include "caffe2/core/workspace_memory_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+C10_DEFINE_bool(
+    caffe2_workspace_memory_pool,
+    false,
+    "If set, every workspace serves the CPU allocations of the operators it "
+    "runs from a memory pool of its own");
+
+C10_DEFINE_int(
+    caffe2_workspace_memory_pool_max_idle_runs,
+    10,
+    "Number of runs after which a workspace memory pool releases a cached "
+    "block no allocation took, and shrinks a tensor held in a block of a "
+    "larger size class than it needs. Negative to never release.");
+
+namespace caffe2 {
+
+namespace {
+
+// Four size classes per power of two, from 64 bytes on.
+constexpr int kMinSizeClassLog2 = 6;
+constexpr int kSizeClassesPerLog2 = 4;
+
+int size_class_of(size_t nbytes) {
+  if (nbytes <= (size_t(1) << kMinSizeClassLog2)) {
+    return 0;
+  }
+  // 2^log2 < nbytes <= 2^(log2 + 1)
+  int log2 = kMinSizeClassLog2;
+  while ((size_t(2) << log2) < nbytes) {
+    log2++;
+  }
+  const size_t step = (size_t(1) << log2) / kSizeClassesPerLog2;
+  const size_t sub = ((nbytes - (size_t(1) << log2)) + step - 1) / step;
+  return (log2 - kMinSizeClassLog2) * kSizeClassesPerLog2 +
+      static_cast<int>(sub);
+}
+
+size_t class_size(int size_class) {
+  const int log2 = kMinSizeClassLog2 + size_class / kSizeClassesPerLog2;
+  const size_t sub = size_class % kSizeClassesPerLog2;
+  return (size_t(1) << log2) / kSizeClassesPerLog2 *
+      (kSizeClassesPerLog2 + sub);
+}
+
+} // namespace
+
+struct WorkspaceMemoryPool::State {
+  struct Block {
+    at::DataPtr memory;
+    size_t size;
+    int size_class;
+    // the run the block was last handed out or freed in, counting from 1
+    uint64_t last_used_run;
+    // consecutive runs in which the tensor holding the block needed a
+    // smaller size class
+    int oversized_runs;
+    // set while the block is handed out
+    std::shared_ptr<State> pool;
+  };
+
+  explicit State(at::Allocator* base) : base(base) {}
+
+  at::Allocator* base;
+
+  mutable std::mutex mutex;
+  // the cached blocks of each size class, most recently freed last
+  std::vector<std::vector<Block*>> free_blocks;
+  // set once the pool is destroyed; blocks are then freed right away
+  bool closed = false;
+  WorkspaceMemoryPoolStats stats{};
+
+  void free(Block* block);
+};
+
+void WorkspaceMemoryPool::State::free(Block* block) {
+  std::unique_lock<std::mutex> lock(mutex);
+  stats.amount_allocated -= block->size;
+  if (closed) {
+    lock.unlock();
+    delete block;
+    return;
+  }
+  block->last_used_run = stats.num_runs + 1;
+  if (free_blocks.size() <= static_cast<size_t>(block->size_class)) {
+    free_blocks.resize(block->size_class + 1);
+  }
+  free_blocks[block->size_class].push_back(block);
+  stats.amount_cached += block->size;
+}
+
+WorkspaceMemoryPool::WorkspaceMemoryPool(int max_idle_runs)
+    : max_idle_runs_(max_idle_runs),
+      state_(std::make_shared<State>(GetGlobalAllocator(CPU))) {}
+
+WorkspaceMemoryPool::~WorkspaceMemoryPool() {
+  {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    state_->closed = true;
+  }
+  EmptyCache();
+}
+
+size_t WorkspaceMemoryPool::RoundUp(size_t nbytes) {
+  return class_size(size_class_of(nbytes));
+}
+
+at::DataPtr WorkspaceMemoryPool::allocate(size_t nbytes) const {
+  const int size_class = size_class_of(nbytes);
+  const size_t size = class_size(size_class);
+  State::Block* block = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    auto& stats = state_->stats;
+    stats.num_allocs++;
+    stats.amount_allocated += size;
+    stats.peak_allocated =
+        std::max(stats.peak_allocated, stats.amount_allocated);
+    if (state_->free_blocks.size() > static_cast<size_t>(size_class) &&
+        !state_->free_blocks[size_class].empty()) {
+      block = state_->free_blocks[size_class].back();
+      state_->free_blocks[size_class].pop_back();
+      stats.num_pool_hits++;
+      stats.amount_cached -= size;
+    } else {
+      stats.num_system_allocs++;
+    }
+    if (block) {
+      block->last_used_run = stats.num_runs + 1;
+    }
+  }
+  if (block) {
+    // The global allocator only fills the memory it hands out
+    if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+      memset(block->memory.get(), 0, nbytes);
+    } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+      memset_junk(block->memory.get(), nbytes);
+    }
+  } else {
+    auto memory = state_->base->allocate(size);
+    block = new State::Block{
+        std::move(memory), size, size_class, 0, 0, nullptr};
+  }
+  block->oversized_runs = 0;
+  block->pool = state_;
+  return {block->memory.get(), block, &Delete, at::Device(CPU)};
+}
+
+void WorkspaceMemoryPool::Delete(void* ctx) {
+  auto* block = static_cast<State::Block*>(ctx);
+  // Keeps the state alive while the block goes back to it
+  auto pool = std::move(block->pool);
+  pool->free(block);
+}
+
+void WorkspaceMemoryPool::FinishRun(
+    const std::vector<at::TensorImpl*>& tensors) {
+  if (max_idle_runs_ >= 0) {
+    for (auto* tensor : tensors) {
+      if (!tensor->storage_initialized()) {
+        continue;
+      }
+      const auto& storage = tensor->storage();
+      // Tensors sharing their storage may need more of it
+      if (!storage.unique() || storage.itemsize() == 0) {
+        continue;
+      }
+      auto* block =
+          storage.data_ptr().cast_context<State::Block>(&Delete);
+      if (block == nullptr || block->pool != state_) {
+        continue;
+      }
+      const size_t nbytes =
+          (tensor->storage_offset() + tensor->numel()) * storage.itemsize();
+      if (size_class_of(nbytes) >= block->size_class) {
+        block->oversized_runs = 0;
+        continue;
+      }
+      if (++block->oversized_runs < std::max(max_idle_runs_, 1)) {
+        continue;
+      }
+      auto memory = allocate(nbytes);
+      memcpy(memory.get(), storage.data(), nbytes);
+      const auto size =
+          static_cast<State::Block*>(memory.get_context())->size;
+      // Frees the old block, which is released in turn if no tensor needs it
+      storage.set_data_ptr(std::move(memory));
+      storage.set_numel(size / storage.itemsize());
+      std::lock_guard<std::mutex> guard(state_->mutex);
+      state_->stats.num_shrinks++;
+    }
+  }
+
+  std::vector<State::Block*> released;
+  {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    auto& stats = state_->stats;
+    stats.num_runs++;
+    if (max_idle_runs_ >= 0) {
+      for (auto& blocks : state_->free_blocks) {
+        auto it = blocks.begin();
+        for (auto* block : blocks) {
+          if (stats.num_runs - block->last_used_run >=
+              static_cast<uint64_t>(max_idle_runs_)) {
+            released.push_back(block);
+            stats.amount_cached -= block->size;
+          } else {
+            *it++ = block;
+          }
+        }
+        blocks.erase(it, blocks.end());
+      }
+      stats.num_releases += released.size();
+    }
+  }
+  for (auto* block : released) {
+    delete block;
+  }
+}
+
+void WorkspaceMemoryPool::EmptyCache() {
+  std::vector<State::Block*> released;
+  {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    for (auto& blocks : state_->free_blocks) {
+      for (auto* block : blocks) {
+        released.push_back(block);
+        state_->stats.amount_cached -= block->size;
+      }
+      blocks.clear();
+    }
+    state_->stats.num_releases += released.size();
+  }
+  for (auto* block : released) {
+    delete block;
+  }
+}
+
+WorkspaceMemoryPoolStats WorkspaceMemoryPool::GetStats() const {
+  std::lock_guard<std::mutex> guard(state_->mutex);
+  return state_->stats;
+}
+
+} // namespace caffe2
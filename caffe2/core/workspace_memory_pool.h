@@ -0,0 +1,91 @@
+#ifndef CAFFE2_CORE_WORKSPACE_MEMORY_POOL_H_
+#define CAFFE2_CORE_WORKSPACE_MEMORY_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "caffe2/core/allocator.h"
+#include "caffe2/core/tensor.h"
+
+C10_DECLARE_bool(caffe2_workspace_memory_pool);
+C10_DECLARE_int(caffe2_workspace_memory_pool_max_idle_runs);
+
+namespace caffe2 {
+
+struct WorkspaceMemoryPoolStats {
+  // completed runs
+  uint64_t num_runs;
+  uint64_t num_allocs;
+  // allocations served from a cached block
+  uint64_t num_pool_hits;
+  // allocations that had to go to the global CPU allocator
+  uint64_t num_system_allocs;
+  // cached blocks given back to the global CPU allocator
+  uint64_t num_releases;
+  // tensors moved to a block of a smaller size class
+  uint64_t num_shrinks;
+  // bytes currently handed out, rounded up to size classes
+  uint64_t amount_allocated;
+  // largest amount_allocated so far
+  uint64_t peak_allocated;
+  // bytes held by the pool, not handed out
+  uint64_t amount_cached;
+};
+
+// A CPU memory pool owned by a Workspace, from which the operators it runs
+// allocate their tensors.
+//
+// Requests are rounded up to a size class, four per power of two from 64
+// bytes on, so that a size class is at most 25% larger than the requests it
+// serves, and freed blocks are cached for the next request of their class.
+// After the first runs of a net, the tensors it resizes find a block of the
+// right class in the pool and no run allocates.
+//
+// The pool is kept bounded by FinishRun(), which the workspace calls after
+// each run:
+//   - a cached block that no request took for max_idle_runs runs is given
+//     back to the global CPU allocator;
+//   - a tensor that has been in a block of a larger class than its size
+//     needs for max_idle_runs runs, as Tensor::Resize keeps the memory of
+//     shrunk tensors, is copied to a block of the right class.
+//
+// Blocks outlive the pool: a block freed after the pool is destroyed goes
+// straight back to the global CPU allocator.
+class CAFFE2_API WorkspaceMemoryPool final : public at::Allocator {
+ public:
+  explicit WorkspaceMemoryPool(int max_idle_runs);
+  ~WorkspaceMemoryPool() override;
+
+  at::DataPtr allocate(size_t nbytes) const override;
+
+  static void Delete(void* ctx);
+
+  // Ends a run: shrinks the oversized tensors among `tensors` that own their
+  // storage, and releases the blocks that have been idle for too long.
+  void FinishRun(const std::vector<at::TensorImpl*>& tensors);
+
+  // Returns all cached blocks to the global CPU allocator.
+  void EmptyCache();
+
+  WorkspaceMemoryPoolStats GetStats() const;
+
+  int max_idle_runs() const {
+    return max_idle_runs_;
+  }
+
+  // Size of the class that serves requests of nbytes.
+  static size_t RoundUp(size_t nbytes);
+
+ private:
+  struct State;
+
+  const int max_idle_runs_;
+  std::shared_ptr<State> state_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(WorkspaceMemoryPool);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_WORKSPACE_MEMORY_POOL_H_
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "caffe2/core/operator.h"
+#include "caffe2/core/workspace_memory_pool.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Resizes its output to the number of floats given by its input, after
+// using a temporary of the same size.
+class WorkspaceMemoryPoolTestOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  using Operator<CPUContext>::Operator;
+
+  bool RunOnDevice() override {
+    const int64_t size = Input(0).data<int64_t>()[0];
+    Tensor temp(std::vector<int64_t>{size}, CPU);
+    temp.mutable_data<float>();
+    auto* output = Output(0, {size}, at::dtype<float>());
+    output->mutable_data<float>();
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(WorkspaceMemoryPoolTest, WorkspaceMemoryPoolTestOp);
+OPERATOR_SCHEMA(WorkspaceMemoryPoolTest).NumInputs(1).NumOutputs(1);
+
+void SetSize(Workspace* ws, int64_t size) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob("size"), CPU);
+  tensor->Resize(1);
+  tensor->mutable_data<int64_t>()[0] = size;
+}
+
+NetBase* CreateTestNet(Workspace* ws) {
+  NetDef net_def;
+  net_def.set_name("test");
+  auto* op = net_def.add_op();
+  op->set_type("WorkspaceMemoryPoolTest");
+  op->add_input("size");
+  op->add_output("out");
+  SetSize(ws, 0);
+  return ws->CreateNet(net_def);
+}
+
+size_t OutputCapacity(Workspace* ws) {
+  return ws->GetBlob("out")
+      ->Get<Tensor>()
+      .unsafeGetTensorImpl()
+      ->storage()
+      .capacity();
+}
+
+} // namespace
+
+TEST(WorkspaceMemoryPoolTest, SizeClasses) {
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(0), 64);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(64), 64);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(65), 80);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(128), 128);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(129), 160);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(1000), 1024);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp(1025), 1280);
+  EXPECT_EQ(WorkspaceMemoryPool::RoundUp((1 << 20) + 1), 5 << 18);
+}
+
+TEST(WorkspaceMemoryPoolTest, ReleasesIdleBlocks) {
+  WorkspaceMemoryPool pool(2);
+  pool.allocate(1000).clear();
+  EXPECT_EQ(pool.GetStats().amount_cached, 1024);
+  pool.FinishRun({});
+  pool.FinishRun({});
+  EXPECT_EQ(pool.GetStats().amount_cached, 1024);
+  // Unused in the second and third runs
+  pool.FinishRun({});
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.amount_cached, 0);
+  EXPECT_EQ(stats.num_releases, 1);
+  EXPECT_EQ(stats.amount_allocated, 0);
+}
+
+TEST(WorkspaceMemoryPoolTest, OutlivesPool) {
+  at::DataPtr data;
+  {
+    WorkspaceMemoryPool pool(2);
+    data = pool.allocate(100);
+  }
+  memset(data.get(), 0, 100);
+  data.clear();
+}
+
+TEST(WorkspaceMemoryPoolTest, NoAllocationInSteadyState) {
+  Workspace ws;
+  ws.EnableMemoryPool(2);
+  auto* net = CreateTestNet(&ws);
+  ASSERT_NE(net, nullptr);
+  SetSize(&ws, 1000);
+  ASSERT_TRUE(ws.RunNet("test"));
+  auto stats = ws.memory_pool()->GetStats();
+  EXPECT_EQ(stats.num_runs, 1);
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_EQ(stats.num_system_allocs, 2);
+  // The sizes change, but stay within the same size classes
+  for (int64_t size : {990, 1000, 1010, 1000}) {
+    SetSize(&ws, size);
+    ASSERT_TRUE(ws.RunNet("test"));
+  }
+  stats = ws.memory_pool()->GetStats();
+  EXPECT_EQ(stats.num_system_allocs, 2);
+  EXPECT_EQ(stats.num_pool_hits, stats.num_allocs - 2);
+  EXPECT_EQ(stats.amount_allocated, 4096);
+  EXPECT_EQ(stats.amount_cached, 4096);
+}
+
+TEST(WorkspaceMemoryPoolTest, ShrinksOversizedTensors) {
+  Workspace ws;
+  ws.EnableMemoryPool(2);
+  ASSERT_NE(CreateTestNet(&ws), nullptr);
+  SetSize(&ws, 100000);
+  ASSERT_TRUE(ws.RunNet("test"));
+  EXPECT_EQ(OutputCapacity(&ws), 400000);
+
+  // Resize keeps the memory of the output
+  SetSize(&ws, 10);
+  ASSERT_TRUE(ws.RunNet("test"));
+  EXPECT_EQ(OutputCapacity(&ws), 400000);
+  auto* output = BlobGetMutableTensor(ws.GetBlob("out"), CPU);
+  for (int i = 0; i < 10; ++i) {
+    output->mutable_data<float>()[i] = i;
+  }
+  ASSERT_TRUE(ws.RunNet("test"));
+  EXPECT_EQ(OutputCapacity(&ws), 64);
+  EXPECT_EQ(ws.memory_pool()->GetStats().num_shrinks, 1);
+  // The output keeps its values
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(output->data<float>()[i], i);
+  }
+
+  // The large blocks are released once idle
+  ASSERT_TRUE(ws.RunNet("test"));
+  ASSERT_TRUE(ws.RunNet("test"));
+  auto stats = ws.memory_pool()->GetStats();
+  EXPECT_LT(stats.amount_cached + stats.amount_allocated, 1024);
+}
+
+TEST(WorkspaceMemoryPoolTest, OnlyServesOperators) {
+  Workspace ws;
+  ws.EnableMemoryPool(2);
+  Tensor tensor(std::vector<int64_t>{100}, CPU);
+  tensor.mutable_data<float>();
+  EXPECT_EQ(ws.memory_pool()->GetStats().num_allocs, 0);
+}
+
+} // namespace caffe2
@@ -19,13 +19,15 @@ class CreateDBOp final : public Operator<Context> {
         num_shards_(
             OperatorBase::template GetSingleArgument<int>("num_shards", 1)),
         shard_id_(
-            OperatorBase::template GetSingleArgument<int>("shard_id", 0)) {
+            OperatorBase::template GetSingleArgument<int>("shard_id", 0)),
+        read_ahead_(
+            OperatorBase::template GetSingleArgument<int>("read_ahead", 0)) {
     CAFFE_ENFORCE_GT(db_name_.size(), 0, "Must specify a db name.");
   }
 
   bool RunOnDevice() final {
     OperatorBase::Output<db::DBReader>(0)->Open(
-        db_type_, db_name_, num_shards_, shard_id_);
+        db_type_, db_name_, num_shards_, shard_id_, read_ahead_);
     return true;
   }
 
@@ -34,6 +36,8 @@ class CreateDBOp final : public Operator<Context> {
   string db_name_;
   uint32_t num_shards_;
   uint32_t shard_id_;
+  // Number of records that the reader reads ahead in a background thread
+  int32_t read_ahead_;
   C10_DISABLE_COPY_AND_ASSIGN(CreateDBOp);
 };
 
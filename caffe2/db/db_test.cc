@@ -86,6 +86,36 @@ TEST(DBSeekTest, LMDB) {
   DBSeekTestWrapper("lmdb");
 }
 
+static void PrefetchingDBSeekTestWrapper(const string& db_type) {
+  std::string name = std::tmpnam(nullptr);
+  if (!CreateAndFill(db_type, name)) {
+    EXPECT_TRUE(0);
+  } else {
+    std::unique_ptr<DB> db(CreateDB(db_type, name, READ));
+    for (size_t read_ahead : {1, 3, 20}) {
+      PrefetchingCursor cursor(db->NewCursor(), read_ahead);
+      TestCursor(&cursor);
+      // Reads the whole db through the views
+      cursor.SeekToFirst();
+      for (int i = 0; i < kMaxItems; ++i) {
+        ASSERT_TRUE(cursor.Valid());
+        auto view = cursor.valueView();
+        EXPECT_EQ(string(view.data(), view.size()), cursor.key());
+        cursor.Next();
+      }
+      EXPECT_FALSE(cursor.Valid());
+    }
+  }
+}
+
+TEST(DBSeekTest, PrefetchingLevelDB) {
+  PrefetchingDBSeekTestWrapper("leveldb");
+}
+
+TEST(DBSeekTest, PrefetchingLMDB) {
+  PrefetchingDBSeekTestWrapper("lmdb");
+}
+
 TEST(DBReaderTest, Reader) {
   std::string name = std::tmpnam(nullptr);
   CreateAndFill("leveldb", name);
@@ -196,5 +226,19 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+TEST(DBReaderShardedTest, ReadAhead) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("leveldb", name);
+
+  DBReader reader("leveldb", name, 3, 1, /* read_ahead */ 2);
+  string key;
+  string value;
+  for (const char* expected : {"01", "04", "07", "01", "04"}) {
+    reader.Read(&key, &value);
+    EXPECT_EQ(key, expected);
+    EXPECT_EQ(value, expected);
+  }
+}
+
 }  // namespace db
 }  // namespace caffe2
@@ -25,6 +25,10 @@ class LevelDBCursor : public Cursor {
   void Next() override { iter_->Next(); }
   string key() override { return iter_->key().ToString(); }
   string value() override { return iter_->value().ToString(); }
+  c10::ArrayRef<char> valueView() override {
+    auto value = iter_->value();
+    return c10::ArrayRef<char>(value.data(), value.size());
+  }
   bool Valid() override { return iter_->Valid(); }
 
  private:
@@ -68,6 +68,15 @@ class LMDBCursor : public Cursor {
         mdb_value_.mv_size);
   }
 
+  // The values point into the memory map, and stay valid until the read
+  // transaction of the cursor ends.
+  c10::ArrayRef<char> valueView() override {
+    return c10::ArrayRef<char>(
+        static_cast<const char*>(mdb_value_.mv_data), mdb_value_.mv_size);
+  }
+
+  bool ViewsOutliveNext() override { return true; }
+
   bool Valid() override { return valid_; }
 
  private:
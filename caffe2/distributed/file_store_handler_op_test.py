@@ -57,6 +57,9 @@ class TestFileStoreHandlerOp(TestCase):
     def test_set_get(self):
         StoreOpsTests.test_set_get(self.create_store_handler)
 
+    def test_multi_set_get(self):
+        StoreOpsTests.test_multi_set_get(self.create_store_handler)
+
     def test_get_timeout(self):
         with self.assertRaises(StoreHandlerTimeoutError):
             StoreOpsTests.test_get_timeout(self.create_store_handler)
@@ -1,9 +1,10 @@
 #include "redis_store_handler.h"
 
+#include <c10/util/string_utils.h>
 #include <caffe2/core/logging.h>
 
 #include <chrono>
-#include <thread>
+#include <numeric>
 #include <vector>
 
 namespace caffe2 {
@@ -31,69 +32,145 @@ std::string RedisStoreHandler::compoundKey(const std::string& name) {
   return prefix_ + name;
 }
 
+std::string RedisStoreHandler::readyKey(const std::string& name) {
+  return prefix_ + name + "/__ready__";
+}
+
+std::vector<RedisStoreHandler::Reply> RedisStoreHandler::pipeline(
+    const std::vector<std::vector<std::string>>& commands) {
+  // hiredis buffers the appended commands, and sends them all with the
+  // first call for a reply
+  for (const auto& command : commands) {
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    for (const auto& arg : command) {
+      argv.push_back(arg.c_str());
+      argvlen.push_back(arg.length());
+    }
+    auto status = redisAppendCommandArgv(
+        redis_, argv.size(), argv.data(), argvlen.data());
+    CAFFE_ENFORCE_EQ(status, REDIS_OK, redis_->errstr);
+  }
+  std::vector<Reply> replies;
+  replies.reserve(commands.size());
+  for (size_t i = 0; i < commands.size(); ++i) {
+    void* ptr = nullptr;
+    auto status = redisGetReply(redis_, &ptr);
+    CAFFE_ENFORCE_EQ(status, REDIS_OK, redis_->errstr);
+    replies.emplace_back(static_cast<redisReply*>(ptr));
+    CAFFE_ENFORCE_NE(
+        replies.back()->type,
+        REDIS_REPLY_ERROR,
+        std::string(replies.back()->str, replies.back()->len));
+  }
+  return replies;
+}
+
+void RedisStoreHandler::appendReadyCommands(
+    const std::string& name,
+    std::vector<std::vector<std::string>>& commands) {
+  auto key = readyKey(name);
+  commands.push_back({"RPUSH", key, "1"});
+  // Keep a single element however many times the key is set or added to
+  commands.push_back({"LTRIM", key, "0", "0"});
+}
+
 void RedisStoreHandler::set(const std::string& name, const std::string& data) {
-  auto key = compoundKey(name);
-  void* ptr = redisCommand(
-      redis_,
-      "SETNX %b %b",
-      key.c_str(),
-      (size_t)key.size(),
-      data.c_str(),
-      (size_t)data.size());
-  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
-  CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
+  multiSet({name}, {data});
+}
+
+void RedisStoreHandler::multiSet(
+    const std::vector<std::string>& names,
+    const std::vector<std::string>& data) {
   CAFFE_ENFORCE_EQ(
-      reply->integer,
-      1,
-      "Value at ",
-      name,
-      " was already set",
-      " (perhaps you reused a run ID you have used before?)");
+      names.size(), data.size(), "Expected as many values as names");
+  std::vector<std::vector<std::string>> commands;
+  // The key is set before it is marked as ready, so that waiters never
+  // find a ready key without a value
+  for (size_t i = 0; i < names.size(); ++i) {
+    commands.push_back({"SETNX", compoundKey(names[i]), data[i]});
+    appendReadyCommands(names[i], commands);
+  }
+  auto replies = pipeline(commands);
+  for (size_t i = 0; i < names.size(); ++i) {
+    const auto& reply = replies[3 * i];
+    CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
+    CAFFE_ENFORCE_EQ(
+        reply->integer,
+        1,
+        "Value at ",
+        names[i],
+        " was already set",
+        " (perhaps you reused a run ID you have used before?)");
+  }
 }
 
 std::string RedisStoreHandler::get(
     const std::string& name,
     const std::chrono::milliseconds& timeout) {
-  // Block until key is set
-  wait({name}, timeout);
-
-  auto key = compoundKey(name);
-  void* ptr = redisCommand(redis_, "GET %b", key.c_str(), (size_t)key.size());
-  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
-  CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_STRING);
-  return std::string(reply->str, reply->len);
+  return multiGet({name}, timeout)[0];
+}
+
+std::vector<std::string> RedisStoreHandler::multiGet(
+    const std::vector<std::string>& names,
+    const std::chrono::milliseconds& timeout) {
+  std::vector<std::string> data(names.size());
+  if (names.empty()) {
+    return data;
+  }
+  auto mget = [&](const std::vector<size_t>& indices) {
+    std::vector<std::string> command = {"MGET"};
+    for (auto i : indices) {
+      command.push_back(compoundKey(names[i]));
+    }
+    auto reply = std::move(pipeline({command})[0]);
+    CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_ARRAY);
+    CAFFE_ENFORCE_EQ(reply->elements, indices.size());
+    std::vector<size_t> missing;
+    for (size_t j = 0; j < indices.size(); ++j) {
+      const auto* element = reply->element[j];
+      if (element->type == REDIS_REPLY_STRING) {
+        data[indices[j]] = std::string(element->str, element->len);
+      } else {
+        CAFFE_ENFORCE_EQ(element->type, REDIS_REPLY_NIL);
+        missing.push_back(indices[j]);
+      }
+    }
+    return missing;
+  };
+
+  // The keys which are already set are read without waiting
+  std::vector<size_t> indices(names.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  auto missing = mget(indices);
+  if (missing.empty()) {
+    return data;
+  }
+  std::vector<std::string> missingNames;
+  for (auto i : missing) {
+    missingNames.push_back(names[i]);
+  }
+  wait(missingNames, timeout);
+  missing = mget(missing);
+  CAFFE_ENFORCE(missing.empty(), "Keys were removed while being read");
+  return data;
 }
 
 int64_t RedisStoreHandler::add(const std::string& name, int64_t value) {
-  auto key = compoundKey(name);
-  void* ptr = redisCommand(
-      redis_, "INCRBY %b %ld", key.c_str(), (size_t)key.size(), value);
-  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
-  CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
-  return reply->integer;
+  std::vector<std::vector<std::string>> commands;
+  commands.push_back({"INCRBY", compoundKey(name), c10::to_string(value)});
+  appendReadyCommands(name, commands);
+  auto replies = pipeline(commands);
+  CAFFE_ENFORCE_EQ(replies[0]->type, REDIS_REPLY_INTEGER);
+  return replies[0]->integer;
 }
 
 bool RedisStoreHandler::check(const std::vector<std::string>& names) {
-  std::vector<std::string> args;
-  args.push_back("EXISTS");
+  std::vector<std::string> command = {"EXISTS"};
   for (const auto& name : names) {
-    args.push_back(compoundKey(name));
-  }
-
-  std::vector<const char*> argv;
-  std::vector<size_t> argvlen;
-  for (const auto& arg : args) {
-    argv.push_back(arg.c_str());
-    argvlen.push_back(arg.length());
+    command.push_back(compoundKey(name));
   }
-
-  auto argc = argv.size();
-  void* ptr = redisCommandArgv(redis_, argc, argv.data(), argvlen.data());
-  CAFFE_ENFORCE_NE(ptr, (void*)nullptr, redis_->errstr);
-  redisReply* reply = static_cast<redisReply*>(ptr);
+  auto reply = std::move(pipeline({command})[0]);
   CAFFE_ENFORCE_EQ(reply->type, REDIS_REPLY_INTEGER);
   return reply->integer == names.size();
 }
@@ -101,20 +178,41 @@ bool RedisStoreHandler::check(const std::vector<std::string>& names) {
 void RedisStoreHandler::wait(
     const std::vector<std::string>& names,
     const std::chrono::milliseconds& timeout) {
-  // Simple approach: poll...
-  // Complex approach: use pub/sub.
-  // Polling is fine for the typical rendezvous use case, as it is
-  // only done at initialization time and  not at run time.
+  // Instead of polling the keys, the waiter blocks on the ready list of
+  // every missing key in turn. BRPOPLPUSH of a list onto itself returns its
+  // element as soon as there is one and leaves it there, so the keys stay
+  // ready for all other waiters.
+  std::vector<std::vector<std::string>> commands;
+  for (const auto& name : names) {
+    commands.push_back({"EXISTS", compoundKey(name)});
+  }
+  auto replies = pipeline(commands);
+
   const auto start = std::chrono::steady_clock::now();
-  while (!check(names)) {
-    const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-        std::chrono::steady_clock::now() - start);
-    if (timeout != kNoTimeout && elapsed > timeout) {
+  for (size_t i = 0; i < names.size(); ++i) {
+    CAFFE_ENFORCE_EQ(replies[i]->type, REDIS_REPLY_INTEGER);
+    if (replies[i]->integer == 1) {
+      continue;
+    }
+    // Redis block timeouts are in seconds, where 0 blocks forever
+    int64_t seconds = 0;
+    if (timeout != kNoTimeout) {
+      const auto remaining = timeout -
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - start);
+      if (remaining <= std::chrono::milliseconds::zero()) {
+        STORE_HANDLER_TIMEOUT(
+            "Wait timeout for name(s): ", c10::Join(" ", names));
+      }
+      seconds = (remaining.count() + 999) / 1000;
+    }
+    auto key = readyKey(names[i]);
+    auto reply = std::move(
+        pipeline({{"BRPOPLPUSH", key, key, c10::to_string(seconds)}})[0]);
+    if (reply->type == REDIS_REPLY_NIL) {
       STORE_HANDLER_TIMEOUT(
           "Wait timeout for name(s): ", c10::Join(" ", names));
     }
-    /* sleep override */
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
   }
 }
 } // namespace caffe2
@@ -6,7 +6,9 @@ extern "C" {
 #include <hiredis/hiredis.h>
 }
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace caffe2 {
 
@@ -21,6 +23,14 @@ class CAFFE2_API RedisStoreHandler : public StoreHandler {
       const std::string& name,
       const std::chrono::milliseconds& timeout = kDefaultTimeout) override;
 
+  virtual void multiSet(
+      const std::vector<std::string>& names,
+      const std::vector<std::string>& data) override;
+
+  virtual std::vector<std::string> multiGet(
+      const std::vector<std::string>& names,
+      const std::chrono::milliseconds& timeout = kDefaultTimeout) override;
+
   virtual int64_t add(const std::string& name, int64_t value) override;
 
   virtual bool check(const std::vector<std::string>& names) override;
@@ -36,7 +46,27 @@ class CAFFE2_API RedisStoreHandler : public StoreHandler {
 
   redisContext* redis_;
 
+  struct ReplyDeleter {
+    void operator()(redisReply* reply) const {
+      freeReplyObject(reply);
+    }
+  };
+  using Reply = std::unique_ptr<redisReply, ReplyDeleter>;
+
   std::string compoundKey(const std::string& name);
+
+  // Every key set or added to has a list of one element, under the key
+  // with this suffix, which waiters block on until it exists.
+  std::string readyKey(const std::string& name);
+
+  // Sends all commands in one round trip and returns their replies, in order.
+  std::vector<Reply> pipeline(
+      const std::vector<std::vector<std::string>>& commands);
+
+  // The commands that mark the key as ready.
+  void appendReadyCommands(
+      const std::string& name,
+      std::vector<std::vector<std::string>>& commands);
 };
 
 } // namespace caffe2
@@ -34,6 +34,25 @@ class CAFFE2_API StoreHandler {
       const std::string& name,
       const std::chrono::milliseconds& timeout = kDefaultTimeout) = 0;
 
+  /*
+   * Set data for several keys, as set() does for each of them.
+   * By default the keys are set one at a time; stores which can batch
+   * requests override this to set them at once.
+   */
+  virtual void multiSet(
+      const std::vector<std::string>& names,
+      const std::vector<std::string>& data);
+
+  /*
+   * Get the data for several keys, as get() does for each of them, waiting
+   * until all of them are stored with the specified timeout.
+   * By default the keys are read one at a time; stores which can batch
+   * requests override this to read them at once.
+   */
+  virtual std::vector<std::string> multiGet(
+      const std::vector<std::string>& names,
+      const std::chrono::milliseconds& timeout = kDefaultTimeout);
+
   /*
    * Does an atomic add operation on the key and returns the latest updated
    * value.
@@ -7,58 +7,81 @@ namespace caffe2 {
 constexpr auto kBlobName = "blob_name";
 constexpr auto kAddValue = "add_value";
 
+namespace {
+// The keys of the blobs are their names, or blob_name for a single blob
+std::vector<std::string> storeBlobNames(
+    const OperatorBase& op,
+    const google::protobuf::RepeatedPtrField<std::string>& blobs) {
+  if (op.HasArgument(kBlobName)) {
+    CAFFE_ENFORCE_EQ(
+        blobs.size(), 1, "blob_name can only be given for a single blob");
+    return {op.GetSingleArgument<std::string>(kBlobName, "")};
+  }
+  return std::vector<std::string>(blobs.begin(), blobs.end());
+}
+} // namespace
+
 StoreSetOp::StoreSetOp(const OperatorDef& operator_def, Workspace* ws)
-    : Operator<CPUContext>(operator_def, ws),
-      blobName_(
-          GetSingleArgument<std::string>(kBlobName, operator_def.input(DATA))) {
+    : Operator<CPUContext>(operator_def, ws) {
+  // The first input is the handler
+  google::protobuf::RepeatedPtrField<std::string> blobs(
+      operator_def.input().begin() + DATA, operator_def.input().end());
+  blobNames_ = storeBlobNames(*this, blobs);
 }
 
 bool StoreSetOp::RunOnDevice() {
-  // Serialize and pass to store
+  // Serialize and pass to store, all blobs at once
   auto* handler =
       OperatorBase::Input<std::unique_ptr<StoreHandler>>(HANDLER).get();
-  handler->set(blobName_, SerializeBlob(InputBlob(DATA), blobName_));
+  std::vector<std::string> data;
+  for (size_t i = 0; i < blobNames_.size(); ++i) {
+    data.push_back(SerializeBlob(InputBlob(DATA + i), blobNames_[i]));
+  }
+  handler->multiSet(blobNames_, data);
   return true;
 }
 
 REGISTER_CPU_OPERATOR(StoreSet, StoreSetOp);
 OPERATOR_SCHEMA(StoreSet)
-    .NumInputs(2)
+    .NumInputs(2, INT_MAX)
     .NumOutputs(0)
     .SetDoc(R"DOC(
-Set a blob in a store. The key is the input blob's name and the value
-is the data in that blob. The key can be overridden by specifying the
-'blob_name' argument.
+Set blobs in a store. The key of each blob is the input blob's name and
+the value is the data in that blob. The key of a single blob can be
+overridden by specifying the 'blob_name' argument. Stores which support it
+set all blobs in one request.
 )DOC")
-    .Arg("blob_name", "alternative key for the blob (optional)")
+    .Arg("blob_name", "alternative key for a single blob (optional)")
     .Input(0, "handler", "unique_ptr<StoreHandler>")
-    .Input(1, "data", "data blob");
+    .Input(1, "data", "data blobs");
 
 StoreGetOp::StoreGetOp(const OperatorDef& operator_def, Workspace* ws)
     : Operator<CPUContext>(operator_def, ws),
-      blobName_(GetSingleArgument<std::string>(
-          kBlobName,
-          operator_def.output(DATA))) {}
+      blobNames_(storeBlobNames(*this, operator_def.output())) {}
 
 bool StoreGetOp::RunOnDevice() {
-  // Get from store and deserialize
+  // Get from store, all blobs at once, and deserialize
   auto* handler =
       OperatorBase::Input<std::unique_ptr<StoreHandler>>(HANDLER).get();
-  DeserializeBlob(handler->get(blobName_), OperatorBase::Outputs()[DATA]);
+  auto data = handler->multiGet(blobNames_);
+  for (size_t i = 0; i < data.size(); ++i) {
+    DeserializeBlob(data[i], OperatorBase::Outputs()[DATA + i]);
+  }
   return true;
 }
 
 REGISTER_CPU_OPERATOR(StoreGet, StoreGetOp);
 OPERATOR_SCHEMA(StoreGet)
     .NumInputs(1)
-    .NumOutputs(1)
+    .NumOutputs(1, INT_MAX)
     .SetDoc(R"DOC(
-Get a blob from a store. The key is the output blob's name. The key
-can be overridden by specifying the 'blob_name' argument.
+Get blobs from a store. The key of each blob is the output blob's name.
+The key of a single blob can be overridden by specifying the 'blob_name'
+argument. Stores which support it read all blobs in one request.
 )DOC")
-    .Arg("blob_name", "alternative key for the blob (optional)")
+    .Arg("blob_name", "alternative key for a single blob (optional)")
     .Input(0, "handler", "unique_ptr<StoreHandler>")
-    .Output(0, "data", "data blob");
+    .Output(0, "data", "data blobs");
 
 StoreAddOp::StoreAddOp(const OperatorDef& operator_def, Workspace* ws)
     : Operator<CPUContext>(operator_def, ws),
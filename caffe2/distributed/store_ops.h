@@ -12,7 +12,7 @@ class StoreSetOp final : public Operator<CPUContext> {
   bool RunOnDevice() override;
 
  private:
-  std::string blobName_;
+  std::vector<std::string> blobNames_;
 
   INPUT_TAGS(HANDLER, DATA);
 };
@@ -23,7 +23,7 @@ class StoreGetOp final : public Operator<CPUContext> {
   bool RunOnDevice() override;
 
  private:
-  std::string blobName_;
+  std::vector<std::string> blobNames_;
 
   INPUT_TAGS(HANDLER);
   OUTPUT_TAGS(DATA);
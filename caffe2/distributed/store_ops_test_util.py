@@ -74,3 +74,70 @@ class StoreOpsTests(object):
         net = core.Net('get_missing_blob')
         net.StoreGet([store_handler], 1, blob_name='blob')
         workspace.RunNetOnce(net)
+
+    @classmethod
+    def _test_multi_set_get(
+            cls, queue, create_store_handler_fn, index, num_procs):
+        store_handler = create_store_handler_fn()
+        blobs = ["blob_{}".format(i) for i in range(num_procs)]
+
+        # Every process sets its own blob and then gets all of them, which
+        # blocks on the blobs of the processes that have not set them yet.
+        workspace.FeedBlob(blobs[index], np.full(1, index, np.float32))
+        workspace.RunOperatorOnce(
+            core.CreateOperator(
+                "StoreSet",
+                [store_handler, blobs[index]],
+                []))
+        workspace.RunOperatorOnce(
+            core.CreateOperator(
+                "StoreGet",
+                [store_handler],
+                blobs))
+
+        try:
+            for i, blob in enumerate(blobs):
+                np.testing.assert_array_equal(workspace.FetchBlob(blob), i)
+        except AssertionError as err:
+            queue.put(err)
+
+        workspace.ResetWorkspace()
+
+    @classmethod
+    def test_multi_set_get(cls, create_store_handler_fn):
+        queue = Queue()
+
+        num_procs = 4
+        procs = []
+        for index in range(num_procs):
+            proc = Process(
+                target=cls._test_multi_set_get,
+                args=(queue, create_store_handler_fn, index, num_procs, ))
+            proc.start()
+            procs.append(proc)
+
+        for proc in procs:
+            proc.join()
+
+        if not queue.empty():
+            raise queue.get()
+
+        # Several blobs are set at once as well
+        store_handler = create_store_handler_fn()
+        blobs = ["batch_blob_{}".format(i) for i in range(3)]
+        for i, blob in enumerate(blobs):
+            workspace.FeedBlob(blob, np.full(2, i, np.float32))
+        workspace.RunOperatorOnce(
+            core.CreateOperator(
+                "StoreSet",
+                [store_handler] + blobs,
+                []))
+        workspace.ResetWorkspace()
+        store_handler = create_store_handler_fn()
+        workspace.RunOperatorOnce(
+            core.CreateOperator(
+                "StoreGet",
+                [store_handler],
+                blobs))
+        for i, blob in enumerate(blobs):
+            np.testing.assert_array_equal(workspace.FetchBlob(blob), i)
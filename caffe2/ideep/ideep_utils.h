@@ -6,6 +6,7 @@
 #include <ideep.hpp>
 #include <caffe2/ideep/utils/ideep_context.h>
 #include <caffe2/ideep/utils/ideep_operator.h>
+#include <caffe2/ideep/utils/ideep_weights_cache.h>
 
 namespace caffe2 {
 
@@ -41,6 +41,11 @@ class IDEEPConvFusionOp final : public IDEEPConvPoolOpBase {
           "If you are doing convolution, you will need to set "
           "explicitly the kernel size.");
     }
+    if (OperatorBase::GetSingleArgument<int>("share_weights_cache", 0)) {
+      weights_cache_ =
+          ws->CreateBlob(IDEEPWeightsCacheName(operator_def.input(FILTER)))
+              ->GetMutable<IDEEPWeightsCache>();
+    }
   }
   virtual ~IDEEPConvFusionOp() {}
 
@@ -83,7 +88,9 @@ class IDEEPConvFusionOp final : public IDEEPConvPoolOpBase {
       auto expected_descriptor =
           ideep::convolution_forward::expected_weights_descriptor(
               filter.get_dims());
-      if (filter_.get_descriptor() != expected_descriptor) {
+      if (weights_cache_) {
+        filter_ = weights_cache_->Get(filter, expected_descriptor);
+      } else if (filter_.get_descriptor() != expected_descriptor) {
         filter_.init<ideep::utils::allocator, ideep::convolution_forward>(
             expected_descriptor);
         ideep::reorder::compute(filter, filter_);
@@ -132,6 +139,8 @@ class IDEEPConvFusionOp final : public IDEEPConvPoolOpBase {
   bool training_mode_;
   ideep::tensor filter_;
   ideep::tensor::descriptor cached_weights_descriptor_;
+  // Shared with the operators of the other nets using the same filter
+  IDEEPWeightsCache* weights_cache_{nullptr};
 
   INPUT_TAGS(INPUT_X, FILTER, BIAS_OR_INPUT_S, INPUT_S);
   OUTPUT_TAGS(OUTPUT);
@@ -204,6 +213,10 @@ OPERATOR_SCHEMA(ConvFusion)
     .CostInferenceFunction(OpSchema::CostInferenceFunctionType(
         ConvPoolOpBase<CPUContext>::CostInferenceForConv))
     .Arg("fusion_type", "Which fusion type is used")
+    .Arg(
+        "share_weights_cache",
+        "Whether the reordered filter is shared with the operators of all "
+        "nets in the workspace using the same filter")
     .AllowInplace({{2, 0}, {3, 0}})
     .FillUsing(ConvFusionDocGenerator(""));
 
@@ -14,6 +14,11 @@ class IDEEPConvOp final : public IDEEPConvPoolOpBase {
     OPERATOR_NEEDS_FEATURE(
         pad_l() == pad_r() && pad_t() == pad_b(),
         "Uneven padding not supported.");
+    if (OperatorBase::GetSingleArgument<int>("share_weights_cache", 0)) {
+      weights_cache_ =
+          ws->CreateBlob(IDEEPWeightsCacheName(operator_def.input(FILTER)))
+              ->GetMutable<IDEEPWeightsCache>();
+    }
   }
   virtual ~IDEEPConvOp() {}
 
@@ -51,9 +56,13 @@ class IDEEPConvOp final : public IDEEPConvPoolOpBase {
               pad_br(),
               dilation_,
               group_);
-      filter_.init<ideep::utils::allocator, ideep::convolution_forward>(
-          expected_descriptor);
-      ideep::reorder::compute(filter_in, filter_);
+      if (weights_cache_) {
+        filter_ = weights_cache_->Get(filter_in, expected_descriptor);
+      } else {
+        filter_.init<ideep::utils::allocator, ideep::convolution_forward>(
+            expected_descriptor);
+        ideep::reorder::compute(filter_in, filter_);
+      }
     }
 
     // NB: actually, in the case when `group_ > 1`, IDEEP will create
@@ -97,6 +106,8 @@ class IDEEPConvOp final : public IDEEPConvPoolOpBase {
   bool training_mode_;
   ideep::tensor filter_;
   ideep::tensor::descriptor cached_weights_descriptor_;
+  // Shared with the operators of the other nets using the same filter
+  IDEEPWeightsCache* weights_cache_{nullptr};
 };
 
 class IDEEPConvGradientOp final : public IDEEPConvPoolOpBase {
@@ -1,4 +1,5 @@
 #include <caffe2/ideep/ideep_utils.h>
+#include <caffe2/operators/fc_inference.h>
 
 namespace caffe2 {
 
@@ -29,10 +30,23 @@ class IDEEPFullyConnectedOp final : public IDEEPOperator {
   USE_IDEEP_DEF_ALIASES();
   USE_IDEEP_OPERATOR_FUNCTIONS();
 
+  enum FusionType {
+    FUSION_NONE = 0,
+    FUSION_FC_RELU = 1,
+    FUSION_MAX = FUSION_FC_RELU + 1,
+  };
+
   IDEEPFullyConnectedOp(const OperatorDef& operator_def, Workspace* ws)
       : IDEEPOperator(operator_def, ws),
         axis_(OperatorBase::GetSingleArgument<int32_t>("axis", 1)),
-        axis_w_(OperatorBase::GetSingleArgument<int32_t>("axis_w", 1)) {}
+        axis_w_(OperatorBase::GetSingleArgument<int32_t>("axis_w", 1)),
+        fusion_type_(static_cast<FusionType>(
+            OperatorBase::GetSingleArgument<int>("fusion_type", 0))) {
+    OPERATOR_NEEDS_FEATURE(
+        fusion_type_ >= FUSION_NONE && fusion_type_ < FUSION_MAX,
+        "Undefined FC fusion type.",
+        fusion_type_);
+  }
   virtual ~IDEEPFullyConnectedOp() {}
 
   bool RunOnDevice() override {
@@ -58,12 +72,18 @@ class IDEEPFullyConnectedOp final : public IDEEPOperator {
       ideep::inner_product_forward::compute(X_in, filter_in, *Y);
     }
 
+    if (fusion_type_ == FUSION_FC_RELU) {
+      // In place, while the output is still in cache
+      ideep::eltwise_forward::compute(*Y, *Y);
+    }
+
     return true;
   }
 
  private:
   size_t axis_{1};
   size_t axis_w_{1};
+  FusionType fusion_type_;
 
   INPUT_TAGS(INPUT, FILTER, BIAS);
   OUTPUT_TAGS(OUTPUT);
@@ -118,6 +138,24 @@ class IDEEPFullyConnectedGradientOp final : public IDEEPOperator {
 };
 
 REGISTER_IDEEP_OPERATOR(FC, IDEEPFullyConnectedOp);
+REGISTER_IDEEP_OPERATOR(FCFusion, IDEEPFullyConnectedOp);
 REGISTER_IDEEP_OPERATOR(FCGradient, IDEEPFullyConnectedGradientOp);
 
+OPERATOR_SCHEMA(FCFusion)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .TensorInferenceFunction(std::bind(
+        FCShapeInference,
+        std::placeholders::_1,
+        std::placeholders::_2,
+        false))
+    .CostInferenceFunction(
+        OpSchema::CostInferenceFunctionType(CostInferenceForFC))
+    .Arg("fusion_type", "Which fusion type is used: 1 for FC+Relu")
+    .SetDoc(R"DOC(
+The FC fusion operator computes the output of the FC operator, and applies the
+activation it is fused with to it, without another operator and blob for the
+activation.
+)DOC");
+
 } // namespace caffe2
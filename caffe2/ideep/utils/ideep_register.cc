@@ -3,6 +3,7 @@
 #include <caffe2/proto/caffe2_pb.h>
 #include <ideep_pin_singletons.hpp>
 #include "ideep_context.h"
+#include "ideep_weights_cache.h"
 
 namespace at {
 REGISTER_CONTEXT(DeviceType::IDEEP, caffe2::IDEEPContext);
@@ -10,6 +11,7 @@ REGISTER_CONTEXT(DeviceType::IDEEP, caffe2::IDEEPContext);
 namespace caffe2 {
 
 CAFFE_KNOWN_TYPE(ideep::tensor);
+CAFFE_KNOWN_TYPE(IDEEPWeightsCache);
 
 C10_DEFINE_REGISTRY(
     IDEEPOperatorRegistry,
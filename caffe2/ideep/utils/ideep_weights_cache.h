@@ -0,0 +1,79 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ideep.hpp>
+
+namespace caffe2 {
+
+// The name of the workspace blob that caches the reordered copies of the
+// weights in the blob named weights.
+inline std::string IDEEPWeightsCacheName(const std::string& weights) {
+  return "__IDEEP_WEIGHTS_CACHE_" + weights + "__";
+}
+
+// Convolution weights reordered into the blocked layouts the primitives
+// expect. It lives in a workspace blob, so that the inference operators of
+// all the nets of a workspace sharing weights reorder them once, rather than
+// once per operator.
+//
+// Like the caches the operators keep themselves, it takes the weights as
+// constant once cached: a reorder is only redone for weights with another
+// descriptor or buffer, and passes that rewrite the weights in place have to
+// Clear() it.
+class IDEEPWeightsCache {
+ public:
+  // Returns the weights in the expected layout, and reorders them into it
+  // only if they are not cached in it yet.
+  ideep::tensor Get(
+      const ideep::tensor& weights,
+      const ideep::tensor::descriptor& expected) {
+    if (weights.get_descriptor() == expected) {
+      return weights;
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& entry : entries_) {
+      if (entry.expected == expected) {
+        if (entry.source != weights.get_descriptor() ||
+            entry.handle != weights.get_data_handle()) {
+          entry = Reorder(weights, expected);
+        }
+        return entry.reordered;
+      }
+    }
+    entries_.push_back(Reorder(weights, expected));
+    return entries_.back().reordered;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    ideep::tensor::descriptor expected;
+    ideep::tensor::descriptor source;
+    void* handle;
+    ideep::tensor reordered;
+  };
+
+  static Entry Reorder(
+      const ideep::tensor& weights,
+      const ideep::tensor::descriptor& expected) {
+    // A new buffer, as operators may still be running with the former one
+    ideep::tensor reordered;
+    reordered.init<ideep::utils::allocator, ideep::convolution_forward>(
+        expected);
+    ideep::reorder::compute(weights, reordered);
+    return {expected, weights.get_descriptor(), weights.get_data_handle(),
+            reordered};
+  }
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+};
+
+} // namespace caffe2
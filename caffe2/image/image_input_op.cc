@@ -9,6 +9,11 @@ bool ImageInputOp<CPUContext>::ApplyTransformOnGPU(
   return false;
 }
 
+template <>
+bool ImageInputOp<CPUContext>::ApplyResizeOnGPU() {
+  return false;
+}
+
 REGISTER_CPU_OPERATOR(ImageInput, ImageInputOp<CPUContext>);
 
 OPERATOR_SCHEMA(ImageInput)
@@ -93,6 +98,10 @@ The dimension of the output image will always be cropxcrop
     .Arg("use_caffe_datum", "1 if the input is in Caffe format. Defaults to 0")
     .Arg("use_gpu_transform", "1 if GPU acceleration should be used."
          " Defaults to 0. Can only be 1 in a CUDAContext")
+    .Arg("use_gpu_resize", "1 if the GPU should also resize, crop and mirror"
+         " the images, which leaves only decoding to the CPU threads. Large"
+         " JPEGs are decoded at a reduced size when the scale argument allows"
+         " it. Defaults to 0. Requires use_gpu_transform")
     .Arg("decode_threads", "Number of CPU decode/transform threads."
          " Defaults to 4")
     .Arg("output_type", "If gpu_transform, can set to FLOAT or FLOAT16.")
@@ -77,12 +77,23 @@ class ImageInputOp final
   bool GetImageAndLabelAndInfoFromDBValue(
       const string& value, cv::Mat* img, PerImageArg& info, int item_id,
       std::mt19937* randgen);
+  cv::Mat DecodeImage(const char* data, int size, PerImageArg* info);
+  int DecodeReduction(int rows, int cols, const PerImageArg& info) const;
+  bool ScaledSize(
+      int rows, int cols, std::mt19937* randgen, int* scaled_height,
+      int* scaled_width) const;
+  ImageCropParams GetCropParams(
+      const cv::Mat& img, std::mt19937* randgen,
+      std::bernoulli_distribution* mirror_this_image) const;
   void DecodeAndTransform(
       const std::string& value, float *image_data, int item_id,
       const int channels, std::size_t thread_index);
   void DecodeAndTransposeOnly(
       const std::string& value, uint8_t *image_data, int item_id,
       const int channels, std::size_t thread_index);
+  void DecodeOnly(
+      const std::string& value, int item_id, std::size_t thread_index);
+  bool ApplyResizeOnGPU();
   bool ApplyTransformOnGPU(
       const std::vector<std::int64_t>& dims,
       const c10::Device& type);
@@ -128,6 +139,16 @@ class ImageInputOp final
   bool gpu_transform_;
   bool mean_std_copied_ = false;
 
+  // With gpu_resize_, the decode threads only decode the images, which are
+  // resized, cropped and mirrored on the GPU
+  bool gpu_resize_;
+  std::vector<cv::Mat> decoded_images_;
+  std::vector<ImageCropParams> crop_params_;
+  Tensor prefetched_decoded_images_{CPU};
+  Tensor prefetched_crop_params_{CPU};
+  Tensor decoded_images_on_device_;
+  Tensor crop_params_on_device_;
+
   // thread pool for parse + decode
   int num_decode_threads_;
   int additional_inputs_offset_;
@@ -196,6 +217,9 @@ ImageInputOp<Context>::ImageInputOp(
       gpu_transform_(OperatorBase::template GetSingleArgument<int>(
           "use_gpu_transform",
           0)),
+      gpu_resize_(OperatorBase::template GetSingleArgument<int>(
+          "use_gpu_resize",
+          0)),
       num_decode_threads_(
           OperatorBase::template GetSingleArgument<int>("decode_threads", 4)),
       additional_output_sizes_(OperatorBase::template GetRepeatedArgument<int>(
@@ -299,6 +323,11 @@ ImageInputOp<Context>::ImageInputOp(
       !use_caffe_datum_ || OutputSize() == 2,
       "There can only be 2 outputs if the Caffe datum format is used");
 
+  CAFFE_ENFORCE(
+      !gpu_resize_ ||
+          (gpu_transform_ && !std::is_same<Context, CPUContext>::value),
+      "use_gpu_resize requires use_gpu_transform and a GPU");
+
   CAFFE_ENFORCE(random_scale_.size() == 2,
       "Must provide [scale_min, scale_max]");
   CAFFE_ENFORCE_GE(random_scale_[1], random_scale_[0],
@@ -324,6 +353,9 @@ ImageInputOp<Context>::ImageInputOp(
   if (gpu_transform_) {
     LOG(INFO) << "    Performing transformation on GPU";
   }
+  if (gpu_resize_) {
+    LOG(INFO) << "    Resizing, cropping and mirroring on GPU";
+  }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " images;";
   LOG(INFO) << "    Treating input image as "
             << (color_ ? "color " : "grayscale ") << "image;";
@@ -393,23 +425,67 @@ ImageInputOp<Context>::ImageInputOp(
     prefetched_additional_outputs_.emplace_back();
   }
 
+  if (gpu_resize_) {
+    decoded_images_.resize(batch_size_);
+    crop_params_.resize(batch_size_);
+  }
 }
 
-// Inception-stype scale jittering
+// Reads the size of a JPEG image from its frame header, without decoding
+// it. Returns false for other formats.
+inline bool JPEGImageSize(const char* data, int size, int* rows, int* cols) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+  if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+    return false;
+  }
+  int pos = 2;
+  while (pos + 4 <= size) {
+    if (bytes[pos] != 0xFF) {
+      return false;
+    }
+    const uint8_t marker = bytes[pos + 1];
+    if (marker == 0xFF) {
+      // fill byte
+      ++pos;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      // markers without a segment
+      pos += 2;
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA) {
+      // end of image or start of scan, before a frame header
+      return false;
+    }
+    // Start of frame markers, which leave out DHT, JPG and DAC
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+        marker != 0xCC) {
+      if (pos + 9 > size) {
+        return false;
+      }
+      *rows = (bytes[pos + 5] << 8) | bytes[pos + 6];
+      *cols = (bytes[pos + 7] << 8) | bytes[pos + 8];
+      return *rows > 0 && *cols > 0;
+    }
+    pos += 2 + ((bytes[pos + 2] << 8) | bytes[pos + 3]);
+  }
+  return false;
+}
+
+// Random region of an image for Inception-style scale jittering, with 8% -
+// 100% of the image area and an aspect ratio in [3/4, 4/3]
 template <class Context>
-bool RandomSizedCropping(
-  cv::Mat* img,
-  const int crop,
-  std::mt19937* randgen
+bool RandomSizedRegion(
+  const int im_height,
+  const int im_width,
+  std::mt19937* randgen,
+  cv::Rect* region
 ) {
-  cv::Mat scaled_img;
-  bool inception_scale_jitter = false;
-  int im_height = img->rows, im_width = img->cols;
   int area = im_height * im_width;
   std::uniform_real_distribution<> area_dis(0.08, 1.0);
   std::uniform_real_distribution<> aspect_ratio_dis(3.0 / 4.0, 4.0 / 3.0);
 
-  cv::Mat cropping;
   for (int i = 0; i < 10; ++i) {
     int target_area = int(ceil(area_dis(*randgen) * area));
     float aspect_ratio = aspect_ratio_dis(*randgen);
@@ -420,21 +496,121 @@ bool RandomSizedCropping(
         0, im_height - nh)(*randgen);
       int width_offset = std::uniform_int_distribution<>(
         0,im_width - nw)(*randgen);
-      cv::Rect ROI(width_offset, height_offset, nw, nh);
-      cropping = (*img)(ROI);
-      cv::resize(
-          cropping,
-          scaled_img,
-          cv::Size(crop, crop),
-          0,
-          0,
-          cv::INTER_AREA);
-      *img = scaled_img;
-      inception_scale_jitter = true;
-      break;
+      *region = cv::Rect(width_offset, height_offset, nw, nh);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Inception-stype scale jittering
+template <class Context>
+bool RandomSizedCropping(
+  cv::Mat* img,
+  const int crop,
+  std::mt19937* randgen
+) {
+  cv::Rect ROI;
+  if (!RandomSizedRegion<Context>(img->rows, img->cols, randgen, &ROI)) {
+    return false;
+  }
+  cv::Mat scaled_img;
+  cv::resize(
+      (*img)(ROI),
+      scaled_img,
+      cv::Size(crop, crop),
+      0,
+      0,
+      cv::INTER_AREA);
+  *img = scaled_img;
+  return true;
+}
+
+// Decodes an encoded image, and counts the images that fail to decode. With
+// gpu_resize_, JPEGs larger than what the crop needs are decoded at a
+// fraction of their size, which libjpeg does in the DCT domain, and the
+// bounding box of the image is scaled with them.
+template <class Context>
+cv::Mat ImageInputOp<Context>::DecodeImage(
+    const char* data,
+    int size,
+    PerImageArg* info) {
+  int flags = color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE;
+  int rows = 0, cols = 0, reduction = 1;
+#if CV_MAJOR_VERSION > 3 || (CV_MAJOR_VERSION == 3 && CV_MINOR_VERSION >= 2)
+  if (gpu_resize_ && JPEGImageSize(data, size, &rows, &cols)) {
+    reduction = DecodeReduction(rows, cols, *info);
+    if (reduction == 2) {
+      flags = color_ ? cv::IMREAD_REDUCED_COLOR_2
+                     : cv::IMREAD_REDUCED_GRAYSCALE_2;
+    } else if (reduction == 4) {
+      flags = color_ ? cv::IMREAD_REDUCED_COLOR_4
+                     : cv::IMREAD_REDUCED_GRAYSCALE_4;
+    } else if (reduction == 8) {
+      flags = color_ ? cv::IMREAD_REDUCED_COLOR_8
+                     : cv::IMREAD_REDUCED_GRAYSCALE_8;
+    }
+  }
+#endif
+
+  cv::Mat src;
+  // We use a cv::Mat to wrap the encoded data so we do not need a copy.
+  // count the number of exceptions from opencv imdecode
+  try {
+    src = cv::imdecode(
+        cv::Mat(1, size, CV_8UC1, const_cast<char*>(data)), flags);
+    if (src.rows == 0 || src.cols == 0) {
+      num_decode_errors_in_batch_++;
+      src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
+    }
+  } catch (cv::Exception& e) {
+    num_decode_errors_in_batch_++;
+    src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
+  }
+
+  if (reduction > 1 && info->bounding_params.valid) {
+    // Compares the shorter sides, as imdecode applies the EXIF orientation
+    const float factor = static_cast<float>(std::min(src.rows, src.cols)) /
+        std::min(rows, cols);
+    auto& box = info->bounding_params;
+    box.ymin = static_cast<int>(box.ymin * factor);
+    box.xmin = static_cast<int>(box.xmin * factor);
+    box.height = static_cast<int>(box.height * factor);
+    box.width = static_cast<int>(box.width * factor);
+  }
+  return src;
+}
+
+// The factor (1, 2, 4 or 8) by which a JPEG of rows x cols pixels can be
+// decoded smaller, while each pixel of the crop still covers at least one
+// pixel of the decoded image
+template <class Context>
+int ImageInputOp<Context>::DecodeReduction(
+    int rows,
+    int cols,
+    const PerImageArg& info) const {
+  const auto& box = info.bounding_params;
+  if (box.valid && box.ymin + box.height <= rows &&
+      box.xmin + box.width <= cols) {
+    rows = box.height;
+    cols = box.width;
+  }
+  if (scale_ <= 0) {
+    // minsize_ only enlarges images, so large images are cropped one to one
+    return 1;
+  }
+  float bound = static_cast<float>(std::min(rows, cols)) / scale_;
+  if (scale_jitter_type_ == INCEPTION_STYLE && !is_test_) {
+    // The sides of the random region are at least sqrt(0.08 * 3 / 4) of the
+    // geometric mean of the sides of the image
+    bound = std::min(bound, std::sqrt(0.06f * rows * cols) / crop_);
+  }
+  for (int reduction = 8; reduction > 1; reduction /= 2) {
+    if (reduction <= bound) {
+      return reduction;
     }
   }
-  return inception_scale_jitter;
+  return 1;
 }
 
 template <class Context>
@@ -461,23 +637,7 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     prefetched_label_.mutable_data<int>()[item_id] = datum.label();
     if (datum.encoded()) {
       // encoded image in datum.
-      // count the number of exceptions from opencv imdecode
-      try {
-        src = cv::imdecode(
-            cv::Mat(
-                1,
-                datum.data().size(),
-                CV_8UC1,
-                const_cast<char*>(datum.data().data())),
-            color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-        if (src.rows == 0 || src.cols == 0) {
-          num_decode_errors_in_batch_++;
-          src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-        }
-      } catch (cv::Exception& e) {
-        num_decode_errors_in_batch_++;
-        src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-      }
+      src = DecodeImage(datum.data().data(), datum.data().size(), &info);
     } else {
       // Raw image in datum.
       CAFFE_ENFORCE(datum.channels() == 3 || datum.channels() == 1);
@@ -534,25 +694,8 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
       // encoded image string.
       DCHECK_EQ(image_proto.string_data_size(), 1);
       const string& encoded_image_str = image_proto.string_data(0);
-      int encoded_size = encoded_image_str.size();
-      // We use a cv::Mat to wrap the encoded str so we do not need a copy.
-      // count the number of exceptions from opencv imdecode
-      try {
-        src = cv::imdecode(
-            cv::Mat(
-                1,
-                &encoded_size,
-                CV_8UC1,
-                const_cast<char*>(encoded_image_str.data())),
-            color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-        if (src.rows == 0 || src.cols == 0) {
-          num_decode_errors_in_batch_++;
-          src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-        }
-      } catch (cv::Exception& e) {
-        num_decode_errors_in_batch_++;
-        src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-      }
+      src = DecodeImage(
+          encoded_image_str.data(), encoded_image_str.size(), &info);
     } else if (image_proto.data_type() == TensorProto::BYTE) {
       // raw image content.
       int src_c = (image_proto.dims_size() == 3) ? image_proto.dims(2) : 1;
@@ -718,6 +861,11 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     // LOG(INFO) << "No bounding\n";
   }
 
+  if (gpu_resize_) {
+    // Scale jitter, rescaling and cropping happen on the GPU
+    return true;
+  }
+
   cv::Mat scaled_img;
   bool inception_scale_jitter = false;
   if (scale_jitter_type_ == INCEPTION_STYLE) {
@@ -731,31 +879,8 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
   if ((scale_jitter_type_ == NO_SCALE_JITTER) ||
     (scale_jitter_type_ == INCEPTION_STYLE && !inception_scale_jitter)) {
       int scaled_width, scaled_height;
-      int scale_to_use = scale_ > 0 ? scale_ : minsize_;
-
-      // set the random minsize
-      if (random_scaling_) {
-        scale_to_use = std::uniform_int_distribution<>(random_scale_[0],
-                                                       random_scale_[1])(*randgen);
-      }
-
-      if (warp_) {
-        scaled_width = scale_to_use;
-        scaled_height = scale_to_use;
-      } else if (img->rows > img->cols) {
-        scaled_width = scale_to_use;
-        scaled_height =
-            static_cast<float>(img->rows) * scale_to_use / img->cols;
-      } else {
-        scaled_height = scale_to_use;
-        scaled_width =
-            static_cast<float>(img->cols) * scale_to_use / img->rows;
-      }
-      if ((scale_ > 0 &&
-           (scaled_height != img->rows || scaled_width != img->cols))
-          || (scaled_height > img->rows || scaled_width > img->cols)) {
-        // We rescale in all cases if we are using scale_
-        // but only to make the image bigger if using minsize_
+      if (ScaledSize(
+              img->rows, img->cols, randgen, &scaled_height, &scaled_width)) {
         /*
         LOG(INFO) << "Scaling to " << scaled_width << " x " << scaled_height
                   << " From " << img->cols << " x " << img->rows;
@@ -775,6 +900,92 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
   return true;
 }
 
+// The size that an image is rescaled to without scale jittering, and whether
+// it is rescaled at all
+template <class Context>
+bool ImageInputOp<Context>::ScaledSize(
+    int rows,
+    int cols,
+    std::mt19937* randgen,
+    int* scaled_height,
+    int* scaled_width) const {
+  int scale_to_use = scale_ > 0 ? scale_ : minsize_;
+
+  // set the random minsize
+  if (random_scaling_) {
+    scale_to_use = std::uniform_int_distribution<>(random_scale_[0],
+                                                   random_scale_[1])(*randgen);
+  }
+
+  if (warp_) {
+    *scaled_width = scale_to_use;
+    *scaled_height = scale_to_use;
+  } else if (rows > cols) {
+    *scaled_width = scale_to_use;
+    *scaled_height = static_cast<float>(rows) * scale_to_use / cols;
+  } else {
+    *scaled_height = scale_to_use;
+    *scaled_width = static_cast<float>(cols) * scale_to_use / rows;
+  }
+  // We rescale in all cases if we are using scale_
+  // but only to make the image bigger if using minsize_
+  return (scale_ > 0 && (*scaled_height != rows || *scaled_width != cols)) ||
+      (*scaled_height > rows || *scaled_width > cols);
+}
+
+// The region of a decoded image that the GPU resizes to the crop. This makes
+// the random choices of the CPU path, which resizes the image and crops it.
+template <class Context>
+ImageCropParams ImageInputOp<Context>::GetCropParams(
+    const cv::Mat& img,
+    std::mt19937* randgen,
+    std::bernoulli_distribution* mirror_this_image) const {
+  ImageCropParams params;
+  params.offset = 0;
+  params.rows = img.rows;
+  params.cols = img.cols;
+
+  cv::Rect region;
+  if (scale_jitter_type_ == INCEPTION_STYLE && !is_test_ &&
+      RandomSizedRegion<Context>(img.rows, img.cols, randgen, &region)) {
+    params.roi_y = region.y;
+    params.roi_x = region.x;
+    params.roi_h = region.height;
+    params.roi_w = region.width;
+  } else {
+    int scaled_height, scaled_width;
+    if (!ScaledSize(
+            img.rows, img.cols, randgen, &scaled_height, &scaled_width)) {
+      scaled_height = img.rows;
+      scaled_width = img.cols;
+    }
+    CAFFE_ENFORCE_GE(
+        scaled_height, crop_, "Image height must be bigger than crop.");
+    CAFFE_ENFORCE_GE(
+        scaled_width, crop_, "Image width must be bigger than crop.");
+
+    int width_offset, height_offset;
+    if (is_test_) {
+      width_offset = (scaled_width - crop_) / 2;
+      height_offset = (scaled_height - crop_) / 2;
+    } else {
+      width_offset =
+        std::uniform_int_distribution<>(0, scaled_width - crop_)(*randgen);
+      height_offset =
+        std::uniform_int_distribution<>(0, scaled_height - crop_)(*randgen);
+    }
+    // The crop of the rescaled image, in pixels of the decoded image
+    const float scale_y = static_cast<float>(img.rows) / scaled_height;
+    const float scale_x = static_cast<float>(img.cols) / scaled_width;
+    params.roi_y = height_offset * scale_y;
+    params.roi_x = width_offset * scale_x;
+    params.roi_h = crop_ * scale_y;
+    params.roi_w = crop_ * scale_x;
+  }
+  params.mirror = mirror_ && (*mirror_this_image)(*randgen);
+  return params;
+}
+
 // assume HWC order and color channels BGR
 template <class Context>
 void Saturation(
@@ -1104,6 +1315,23 @@ void ImageInputOp<Context>::DecodeAndTransposeOnly(
                               randgen, &mirror_this_image, is_test_);
 }
 
+// Parse datum and decode image, for the GPU to resize and crop it
+template <class Context>
+void ImageInputOp<Context>::DecodeOnly(
+    const std::string& value, int item_id, std::size_t thread_index) {
+
+  CAFFE_ENFORCE((int)thread_index < num_decode_threads_);
+
+  std::bernoulli_distribution mirror_this_image(0.5f);
+  std::mt19937* randgen = &(randgen_per_thread_[thread_index]);
+
+  // Decode the image
+  PerImageArg info;
+  cv::Mat& img = decoded_images_[item_id];
+  CHECK(
+      GetImageAndLabelAndInfoFromDBValue(value, &img, info, item_id, randgen));
+  crop_params_[item_id] = GetCropParams(img, randgen, &mirror_this_image);
+}
 
 template <class Context>
 bool ImageInputOp<Context>::Prefetch() {
@@ -1115,7 +1343,9 @@ bool ImageInputOp<Context>::Prefetch() {
   }
   const int channels = color_ ? 3 : 1;
   // Call mutable_data() once to allocate the underlying memory.
-  if (gpu_transform_) {
+  if (gpu_resize_) {
+    // the decoded images are packed once they are all decoded
+  } else if (gpu_transform_) {
     // we'll transfer up in int8, then convert later
     prefetched_image_.mutable_data<uint8_t>();
   } else {
@@ -1176,7 +1406,14 @@ bool ImageInputOp<Context>::Prefetch() {
 
     // launch into thread pool for processing
     // TODO: support color jitter and color lighting in gpu_transform
-    if (gpu_transform_) {
+    if (gpu_resize_) {
+      thread_pool_->runTaskWithID(std::bind(
+          &ImageInputOp<Context>::DecodeOnly,
+          this,
+          std::string(value),
+          item_id,
+          std::placeholders::_1));
+    } else if (gpu_transform_) {
       // output of decode will still be int8
       uint8_t* image_data = prefetched_image_.mutable_data<uint8_t>() +
           crop_ * crop_ * channels * item_id;
@@ -1212,13 +1449,44 @@ bool ImageInputOp<Context>::Prefetch() {
         c10::to_string(max_decode_error_ratio_));
   }
 
+  if (gpu_resize_) {
+    // Packs the decoded images, which have different sizes, for the GPU
+    int64_t total_bytes = 0;
+    for (int item_id = 0; item_id < batch_size_; ++item_id) {
+      const auto& img = decoded_images_[item_id];
+      crop_params_[item_id].offset = total_bytes;
+      total_bytes += img.total() * img.elemSize();
+    }
+    prefetched_decoded_images_.Resize(total_bytes);
+    auto* data = prefetched_decoded_images_.mutable_data<uint8_t>();
+    for (int item_id = 0; item_id < batch_size_; ++item_id) {
+      auto& img = decoded_images_[item_id];
+      // The image can be a region of the decoded image, so it is copied row
+      // by row
+      img.copyTo(cv::Mat(
+          img.rows, img.cols, img.type(), data + crop_params_[item_id].offset));
+      img.release();
+    }
+    prefetched_crop_params_.Resize(batch_size_ * sizeof(ImageCropParams));
+    memcpy(
+        prefetched_crop_params_.mutable_data<uint8_t>(),
+        crop_params_.data(),
+        batch_size_ * sizeof(ImageCropParams));
+  }
+
   // If the context is not CPUContext, we will need to do a copy in the
   // prefetch function as well.
   auto device = at::device(Context::GetDeviceType());
   if (!std::is_same<Context, CPUContext>::value) {
     // do sync copies
-    ReinitializeAndCopyFrom(
-        &prefetched_image_on_device_, device, prefetched_image_);
+    if (gpu_resize_) {
+      if (!ApplyResizeOnGPU()) {
+        return false;
+      }
+    } else {
+      ReinitializeAndCopyFrom(
+          &prefetched_image_on_device_, device, prefetched_image_);
+    }
     ReinitializeAndCopyFrom(
         &prefetched_label_on_device_, device, prefetched_label_);
 
@@ -33,6 +33,26 @@ bool ImageInputOp<CUDAContext>::ApplyTransformOnGPU(
   return true;
 }
 
+template <>
+bool ImageInputOp<CUDAContext>::ApplyResizeOnGPU() {
+  auto device = at::device(CUDA);
+  ReinitializeAndCopyFrom(
+      &decoded_images_on_device_, device, prefetched_decoded_images_);
+  ReinitializeAndCopyFrom(
+      &crop_params_on_device_, device, prefetched_crop_params_);
+  ReinitializeTensor(
+      &prefetched_image_on_device_,
+      {batch_size_, crop_, crop_, color_ ? 3 : 1},
+      at::dtype<uint8_t>().device(CUDA));
+  // This runs on the stream of the prefetching thread, so it overlaps with
+  // the nets that consume the previous batch
+  return ResizeCropMirrorOnGPU<CUDAContext>(
+      decoded_images_on_device_,
+      crop_params_on_device_,
+      &prefetched_image_on_device_,
+      &context_);
+}
+
 REGISTER_CUDA_OPERATOR(ImageInput, ImageInputOp<CUDAContext>);
 
 }  // namespace caffe2
@@ -46,8 +46,97 @@ __global__ void transform_kernel(
   }
 }
 
+// The source pixels of an output pixel are those covered by
+// [start, start + size). A box smaller than one pixel is widened to one pixel
+// around its center, which interpolates linearly between two pixels.
+__device__ void source_box(float start, float size, float* lo, float* hi) {
+  if (size < 1) {
+    start += 0.5f * (size - 1);
+    size = 1;
+  }
+  *lo = start;
+  *hi = start + size;
+}
+
+// input in (uint8, packed HWC images), output in (uint8, NHWC)
+__global__ void resize_crop_mirror_kernel(
+    const int crop,
+    const int C,
+    const ImageCropParams* params,
+    const uint8_t* in,
+    uint8_t* out) {
+  const int n = blockIdx.x;
+  const ImageCropParams p = params[n];
+
+  const uint8_t* input_ptr = &in[p.offset];
+  uint8_t* output_ptr = &out[n * crop * crop * C];
+  const float scale_y = p.roi_h / crop;
+  const float scale_x = p.roi_w / crop;
+
+  for (int h = threadIdx.y; h < crop; h += blockDim.y) {
+    float y_lo, y_hi;
+    source_box(p.roi_y + h * scale_y, scale_y, &y_lo, &y_hi);
+    const int y_begin = max(0, static_cast<int>(floorf(y_lo)));
+    const int y_end = min(p.rows, static_cast<int>(ceilf(y_hi)));
+    for (int w = threadIdx.x; w < crop; w += blockDim.x) {
+      const int w_in = p.mirror ? crop - 1 - w : w;
+      float x_lo, x_hi;
+      source_box(p.roi_x + w_in * scale_x, scale_x, &x_lo, &x_hi);
+      const int x_begin = max(0, static_cast<int>(floorf(x_lo)));
+      const int x_end = min(p.cols, static_cast<int>(ceilf(x_hi)));
+
+      // Averages the pixels, weighted by how much of them the box covers
+      float sum[3] = {0, 0, 0};
+      float total = 0;
+      for (int y = y_begin; y < y_end; ++y) {
+        const float wy = fminf(y_hi, y + 1.f) - fmaxf(y_lo, y);
+        for (int x = x_begin; x < x_end; ++x) {
+          const float weight = wy * (fminf(x_hi, x + 1.f) - fmaxf(x_lo, x));
+          const uint8_t* pixel = &input_ptr[(y * p.cols + x) * C];
+          for (int c = 0; c < C; ++c) {
+            sum[c] += weight * pixel[c];
+          }
+          total += weight;
+        }
+      }
+      uint8_t* output_pixel = &output_ptr[(h * crop + w) * C];
+      for (int c = 0; c < C; ++c) {
+        output_pixel[c] = total > 0
+            ? static_cast<uint8_t>(fminf(255.f, sum[c] / total + 0.5f))
+            : 0;
+      }
+    }
+  }
 }
 
+}
+
+template <class Context>
+bool ResizeCropMirrorOnGPU(
+    const Tensor& X,
+    const Tensor& params,
+    Tensor* Y,
+    Context* context) {
+  const int N = Y->dim32(0), crop = Y->dim32(1), C = Y->dim32(3);
+  CAFFE_ENFORCE_EQ(Y->dim32(2), crop);
+  CAFFE_ENFORCE_LE(C, 3);
+  CAFFE_ENFORCE_EQ(params.nbytes(), N * sizeof(ImageCropParams));
+
+  resize_crop_mirror_kernel<<<N, dim3(16, 16), 0, context->cuda_stream()>>>(
+      crop,
+      C,
+      reinterpret_cast<const ImageCropParams*>(params.data<uint8_t>()),
+      X.data<uint8_t>(),
+      Y->template mutable_data<uint8_t>());
+  return true;
+}
+
+template bool ResizeCropMirrorOnGPU<CUDAContext>(
+    const Tensor& X,
+    const Tensor& params,
+    Tensor* Y,
+    CUDAContext* context);
+
 template <typename T_IN, typename T_OUT, class Context>
 
 bool TransformOnGPU(
@@ -30,6 +30,32 @@
 
 namespace caffe2 {
 
+// Where the crop of an image of ResizeCropMirrorOnGPU comes from. The image
+// has rows x cols pixels (HWC, uint8) and starts at byte `offset` of the batch.
+// The region [roi_y, roi_y + roi_h) x [roi_x, roi_x + roi_w) of it is resized
+// to the crop, and mirrored if `mirror` is set.
+struct ImageCropParams {
+  int64_t offset;
+  int rows;
+  int cols;
+  float roi_y;
+  float roi_x;
+  float roi_h;
+  float roi_w;
+  int mirror;
+};
+
+// Resizes the regions of the packed images X, with one ImageCropParams per
+// image in `params`, to the N x crop x crop x C uint8 images of Y. Shrinking
+// averages the pixels covered by an output pixel, as cv::INTER_AREA does,
+// and enlarging interpolates linearly.
+template <class Context>
+bool ResizeCropMirrorOnGPU(
+    const Tensor& X,
+    const Tensor& params,
+    Tensor* Y,
+    Context* context);
+
 template <typename T_IN, typename T_OUT, class Context>
 bool TransformOnGPU(
     Tensor& X,
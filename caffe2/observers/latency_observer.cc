@@ -0,0 +1,178 @@
+#include "caffe2/observers/latency_observer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace caffe2 {
+
+constexpr int LatencyHistogram::kSubBucketBits;
+constexpr int LatencyHistogram::kMaxBits;
+constexpr int LatencyHistogram::kNumBuckets;
+
+namespace {
+
+// Position of the most significant set bit of a positive value
+int highestBit(uint64_t value) {
+  int bit = 0;
+  for (int shift = 32; shift > 0; shift /= 2) {
+    if (value >> shift) {
+      value >>= shift;
+      bit += shift;
+    }
+  }
+  return bit;
+}
+
+} // namespace
+
+int LatencyHistogram::bucketIndex(int64_t nanos) {
+  constexpr int64_t kSubBuckets = 1 << kSubBucketBits;
+  if (nanos < kSubBuckets) {
+    return nanos < 0 ? 0 : nanos;
+  }
+  const int bit = highestBit(nanos);
+  if (bit >= kMaxBits) {
+    return kNumBuckets - 1;
+  }
+  // The range of the highest bit, and the next kSubBucketBits bits below it
+  const int shift = bit - kSubBucketBits;
+  return ((shift + 1) << kSubBucketBits) +
+      ((nanos >> shift) & (kSubBuckets - 1));
+}
+
+int64_t LatencyHistogram::bucketLowest(int index) {
+  constexpr int kSubBuckets = 1 << kSubBucketBits;
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const int shift = (index >> kSubBucketBits) - 1;
+  return static_cast<int64_t>(kSubBuckets + (index & (kSubBuckets - 1)))
+      << shift;
+}
+
+int64_t LatencyHistogram::bucketHighest(int index) {
+  if (index == kNumBuckets - 1) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return bucketLowest(index + 1) - 1;
+}
+
+int64_t LatencyHistogram::count() const {
+  int64_t total = 0;
+  for (const auto& bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+int64_t LatencyHistogram::percentile(double q) const {
+  std::array<int64_t, kNumBuckets> counts;
+  int64_t total = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  // The rank of the sample, from 1
+  const int64_t rank = std::min(
+      total, std::max<int64_t>(1, static_cast<int64_t>(std::ceil(q * total))));
+  int64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      // The middle of the bucket, or its start for the overflow bucket
+      if (i == kNumBuckets - 1) {
+        return bucketLowest(i);
+      }
+      return bucketLowest(i) + (bucketHighest(i) - bucketLowest(i)) / 2;
+    }
+  }
+  return bucketLowest(kNumBuckets - 1);
+}
+
+void LatencyHistogram::reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LatencyStats::update(const LatencyHistogram& histogram) {
+  CAFFE_EVENT((*this), count, histogram.count());
+  CAFFE_EVENT((*this), p50_us, histogram.percentile(0.5) / 1000);
+  CAFFE_EVENT((*this), p90_us, histogram.percentile(0.9) / 1000);
+  CAFFE_EVENT((*this), p99_us, histogram.percentile(0.99) / 1000);
+  CAFFE_EVENT((*this), p999_us, histogram.percentile(0.999) / 1000);
+}
+
+LatencyOperatorObserver::LatencyOperatorObserver(
+    OperatorBase* subject,
+    LatencyObserver* netObserver)
+    : ObserverBase<OperatorBase>(subject),
+      histogram_(std::make_shared<LatencyHistogram>()) {
+  CAFFE_ENFORCE(netObserver, "Observers can't operate outside of the net");
+}
+
+LatencyOperatorObserver::LatencyOperatorObserver(
+    OperatorBase* subject,
+    std::shared_ptr<LatencyHistogram> histogram)
+    : ObserverBase<OperatorBase>(subject), histogram_(std::move(histogram)) {}
+
+void LatencyOperatorObserver::Start() {
+  timer_.Start();
+}
+
+void LatencyOperatorObserver::Stop() {
+  histogram_->record(static_cast<int64_t>(timer_.NanoSeconds()));
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>> LatencyOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int /* unused */) const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new LatencyOperatorObserver(subject, histogram_));
+}
+
+LatencyObserver::LatencyObserver(NetBase* subject, int export_interval)
+    : OperatorAttachingNetObserver<LatencyOperatorObserver, LatencyObserver>(
+          subject,
+          this),
+      export_interval_(export_interval),
+      stats_("latency/" + subject->Name()) {
+  const auto& operators = subject->GetOperators();
+  for (size_t i = 0; i < operators.size(); ++i) {
+    operator_stats_.push_back(caffe2::make_unique<LatencyStats>(
+        stats_.groupName + "/" + c10::to_string(i) + "_" +
+        operators[i]->type()));
+  }
+}
+
+void LatencyObserver::exportStats() {
+  stats_.update(histogram_);
+  for (size_t i = 0; i < operator_observers_.size(); ++i) {
+    operator_stats_[i]->update(operator_observers_[i]->histogram());
+  }
+}
+
+std::string LatencyObserver::debugInfo() {
+  return "p50: " + c10::to_string(histogram_.percentile(0.5) / 1000) +
+      " us, p90: " + c10::to_string(histogram_.percentile(0.9) / 1000) +
+      " us, p99: " + c10::to_string(histogram_.percentile(0.99) / 1000) +
+      " us, p999: " + c10::to_string(histogram_.percentile(0.999) / 1000) +
+      " us over " + c10::to_string(histogram_.count()) + " runs";
+}
+
+void LatencyObserver::Start() {
+  timer_.Start();
+}
+
+void LatencyObserver::Stop() {
+  histogram_.record(static_cast<int64_t>(timer_.NanoSeconds()));
+  if (export_interval_ > 0 && ++runs_ % export_interval_ == 0) {
+    exportStats();
+  }
+}
+
+} // namespace caffe2
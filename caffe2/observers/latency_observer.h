@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+namespace caffe2 {
+
+/**
+ * @brief A lock-free histogram of latencies in nanoseconds.
+ *
+ * Buckets are log-linear, as in HdrHistogram: each power of two range is
+ * split into 2^kSubBucketBits buckets of equal width, so that a percentile is
+ * off by at most 1/2^kSubBucketBits of its value (about 3%). Latencies from
+ * 2^kMaxBits ns (about 18 minutes) on fall into the last bucket.
+ *
+ * record() is one relaxed atomic increment, so observers can record every run
+ * from any thread. Percentiles read the buckets without stopping the writers,
+ * and are approximate while samples are being recorded.
+ */
+class CAFFE2_API LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kMaxBits = 40;
+  static constexpr int kNumBuckets = (kMaxBits - kSubBucketBits + 1)
+      << kSubBucketBits;
+
+  void record(int64_t nanos) {
+    buckets_[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Number of recorded samples
+  int64_t count() const;
+
+  // The latency below which fraction q, in [0, 1], of the samples fall, or 0
+  // without samples
+  int64_t percentile(double q) const;
+
+  void reset();
+
+  static int bucketIndex(int64_t nanos);
+  // The smallest and the largest latency of a bucket
+  static int64_t bucketLowest(int index);
+  static int64_t bucketHighest(int index);
+
+ private:
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_{};
+};
+
+/**
+ * @brief Stats that a LatencyObserver exports per net and per operator.
+ *
+ * The percentiles are in microseconds, and are refreshed every
+ * export_interval runs of the net, or by LatencyObserver::exportStats().
+ */
+struct CAFFE2_API LatencyStats {
+  CAFFE_STAT_CTOR(LatencyStats);
+  CAFFE_STATIC_STAT(count);
+  CAFFE_STATIC_STAT(p50_us);
+  CAFFE_STATIC_STAT(p90_us);
+  CAFFE_STATIC_STAT(p99_us);
+  CAFFE_STATIC_STAT(p999_us);
+
+  void update(const LatencyHistogram& histogram);
+};
+
+class LatencyObserver;
+
+class CAFFE2_API LatencyOperatorObserver final
+    : public ObserverBase<OperatorBase> {
+ public:
+  explicit LatencyOperatorObserver(OperatorBase* subject) = delete;
+  LatencyOperatorObserver(OperatorBase* subject, LatencyObserver* netObserver);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+  const LatencyHistogram& histogram() const {
+    return *histogram_;
+  }
+
+ private:
+  // Copies of the observer for the steps of a recurrent net record into the
+  // histogram of the original
+  LatencyOperatorObserver(
+      OperatorBase* subject,
+      std::shared_ptr<LatencyHistogram> histogram);
+
+  void Start() override;
+  void Stop() override;
+
+  Timer timer_;
+  std::shared_ptr<LatencyHistogram> histogram_;
+};
+
+/**
+ * @brief Keeps histograms of the latency of a net and of each of its
+ * operators, and exports their percentiles to the StatRegistry.
+ *
+ * The stats of the net are in the group "latency/<net name>", those of the
+ * operator at position i in "latency/<net name>/<i>_<operator type>".
+ */
+class CAFFE2_API LatencyObserver final
+    : public OperatorAttachingNetObserver<
+          LatencyOperatorObserver,
+          LatencyObserver> {
+ public:
+  explicit LatencyObserver(NetBase* subject, int export_interval = 100);
+
+  const LatencyHistogram& histogram() const {
+    return histogram_;
+  }
+
+  const std::vector<const LatencyOperatorObserver*>& operator_observers()
+      const {
+    return operator_observers_;
+  }
+
+  // Refreshes the exported percentiles of the net and of its operators
+  void exportStats();
+
+  std::string debugInfo() override;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  const int export_interval_;
+  std::atomic<int64_t> runs_{0};
+  Timer timer_;
+  LatencyHistogram histogram_;
+  LatencyStats stats_;
+  // In the order of operator_observers_
+  std::vector<std::unique_ptr<LatencyStats>> operator_stats_;
+};
+
+} // namespace caffe2
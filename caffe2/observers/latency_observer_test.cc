@@ -0,0 +1,109 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/observers/latency_observer.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+class LatencySleepOp final : public OperatorBase {
+ public:
+  using OperatorBase::OperatorBase;
+  bool Run(int /* unused */) override {
+    StartAllObservers();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    StopAllObservers();
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(LatencySleepOp, LatencySleepOp);
+
+OPERATOR_SCHEMA(LatencySleepOp).NumInputs(0, INT_MAX).NumOutputs(0, INT_MAX);
+
+unique_ptr<NetBase> CreateNetTestHelper(Workspace* ws) {
+  NetDef net_def;
+  net_def.set_name("latency_test");
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("LatencySleepOp");
+    op.add_input("in");
+    op.add_output("hidden");
+  }
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("LatencySleepOp");
+    op.add_input("hidden");
+    op.add_output("out");
+  }
+  net_def.add_external_input("in");
+  net_def.add_external_output("out");
+
+  return CreateNet(net_def, ws);
+}
+
+} // namespace
+
+TEST(LatencyHistogramTest, Buckets) {
+  // Buckets are contiguous, and each holds the values between its bounds
+  for (int i = 0; i + 1 < LatencyHistogram::kNumBuckets; ++i) {
+    EXPECT_EQ(
+        LatencyHistogram::bucketHighest(i) + 1,
+        LatencyHistogram::bucketLowest(i + 1));
+    EXPECT_EQ(
+        LatencyHistogram::bucketIndex(LatencyHistogram::bucketLowest(i)), i);
+    EXPECT_EQ(
+        LatencyHistogram::bucketIndex(LatencyHistogram::bucketHighest(i)), i);
+  }
+  EXPECT_EQ(
+      LatencyHistogram::bucketIndex(std::numeric_limits<int64_t>::max()),
+      LatencyHistogram::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(0.5), 0);
+  for (int64_t i = 1; i <= 10000; ++i) {
+    histogram.record(i * 1000);
+  }
+  EXPECT_EQ(histogram.count(), 10000);
+  const std::vector<std::pair<double, int64_t>> expected = {
+      {0.5, 5000000}, {0.9, 9000000}, {0.99, 9900000}, {0.999, 9990000}};
+  for (const auto& e : expected) {
+    const auto value = histogram.percentile(e.first);
+    EXPECT_LE(std::abs(value - e.second), e.second / 32) << e.first;
+  }
+  histogram.reset();
+  EXPECT_EQ(histogram.count(), 0);
+}
+
+TEST(LatencyObserverTest, ExportsPercentiles) {
+  Workspace ws;
+  ws.CreateBlob("in");
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws));
+  auto net_ob = caffe2::make_unique<LatencyObserver>(net.get(), 2);
+  const auto* ob = net_ob.get();
+  net->AttachObserver(std::move(net_ob));
+  for (int i = 0; i < 4; ++i) {
+    net->Run();
+  }
+  EXPECT_EQ(ob->histogram().count(), 4);
+  ASSERT_EQ(ob->operator_observers().size(), 2);
+  for (const auto* op_ob : ob->operator_observers()) {
+    EXPECT_EQ(op_ob->histogram().count(), 4);
+    EXPECT_GE(op_ob->histogram().percentile(0.5), 10000000 * 31 / 32);
+  }
+
+  auto stats = toMap(StatRegistry::get().publish());
+  EXPECT_EQ(stats["latency/latency_test/count"], 4);
+  EXPECT_GE(stats["latency/latency_test/p99_us"], 20000 * 31 / 32);
+  EXPECT_EQ(stats["latency/latency_test/0_LatencySleepOp/count"], 4);
+  EXPECT_GE(stats["latency/latency_test/1_LatencySleepOp/p50_us"], 9000);
+}
+
+} // namespace caffe2
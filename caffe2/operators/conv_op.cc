@@ -169,6 +169,7 @@ REGISTER_CPU_OPERATOR(Conv, ConvOp<float, CPUContext>);
 OPERATOR_SCHEMA(Conv)
     .NumInputs(2, 3)
     .NumOutputs(1)
+    .StorageOrderDependent({0, 1}, {0})
     .TensorInferenceFunction(ConvPoolOpBase<CPUContext>::TensorInferenceForConv)
     .CostInferenceFunction(OpSchema::CostInferenceFunctionType(
         ConvPoolOpBase<CPUContext>::CostInferenceForConv))
@@ -180,6 +181,7 @@ REGISTER_CPU_OPERATOR(Conv1D, ConvOp<float, CPUContext>);
 OPERATOR_SCHEMA(Conv1D)
     .NumInputs(2, 3)
     .NumOutputs(1)
+    .StorageOrderDependent({0, 1}, {0})
     .TensorInferenceFunction(ConvPoolOpBase<CPUContext>::TensorInferenceForConv)
     .FillUsing(ConvDocGenerator("1D "))
     .InheritOnnxSchema("Conv");
@@ -189,6 +191,7 @@ REGISTER_CPU_OPERATOR(Conv2D, ConvOp<float, CPUContext>);
 OPERATOR_SCHEMA(Conv2D)
     .NumInputs(2, 3)
     .NumOutputs(1)
+    .StorageOrderDependent({0, 1}, {0})
     .CostInferenceFunction(OpSchema::CostInferenceFunctionType(
         ConvPoolOpBase<CPUContext>::CostInferenceForConv))
     .TensorInferenceFunction(ConvPoolOpBase<CPUContext>::TensorInferenceForConv)
@@ -200,6 +203,7 @@ REGISTER_CPU_OPERATOR(Conv3D, ConvOp<float, CPUContext>);
 OPERATOR_SCHEMA(Conv3D)
     .NumInputs(2, 3)
     .NumOutputs(1)
+    .StorageOrderDependent({0, 1}, {0})
     .CostInferenceFunction(OpSchema::CostInferenceFunctionType(
         ConvPoolOpBase<CPUContext>::CostInferenceForConv))
     .TensorInferenceFunction(ConvPoolOpBase<CPUContext>::TensorInferenceForConv)
@@ -25,7 +25,9 @@ class ConvOp final : public ConvPoolOpBase<Context> {
 
     // Create shared buffer mutex in the constructor
     // to avoid race-condition in DAGNet.
-    if (FLAGS_caffe2_force_shared_col_buffer || shared_buffer_) {
+    if (std::is_same<Context, CPUContext>::value) {
+      createSharedBufferPool(ws_);
+    } else if (FLAGS_caffe2_force_shared_col_buffer || shared_buffer_) {
       createSharedBuffer<Context>(ws_);
     }
   }
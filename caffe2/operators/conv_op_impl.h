@@ -83,11 +83,13 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
         N, C, X_HxW, M, X_data, filter_data, bias_data, Y_data);
   }
 
-  const auto func = [&](Tensor* col_buffer) {
+  // Im2Col, followed by gemm, of the images in [begin, end).
+  const auto func = [&](int64_t begin, int64_t end, Tensor* col_buffer) {
     col_buffer->Resize(buffer_shape);
     T* col_buffer_data = col_buffer->template mutable_data<T>();
-    // Im2Col, followed by gemm.
-    for (int image_id = 0; image_id < N; ++image_id) {
+    const T* X_data = X.template data<T>() + begin * X_stride;
+    T* Y_data = Y->template mutable_data<T>() + begin * Y_stride;
+    for (int64_t image_id = begin; image_id < end; ++image_id) {
       if (kernel_.size() == 2) {
         math::Im2Col<T, Context, StorageOrder::NCHW>(
             C,
@@ -173,10 +175,19 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
       Y_data += Y_stride;
     }
   };
-  if (FLAGS_caffe2_force_shared_col_buffer || shared_buffer_) {
-    runWithSharedBuffer<Context>(ws_, func);
+  const bool use_shared_buffer =
+      FLAGS_caffe2_force_shared_col_buffer || shared_buffer_;
+  if (std::is_same<Context, CPUContext>::value) {
+    // The images run in parallel, each chunk of them with a col buffer of its
+    // own. Where the col buffer would be shared, every chunk takes one from
+    // the pool instead, which ops running at the same time do not wait for.
+    runInParallelWithPooledBuffers(
+        ws_, N, use_shared_buffer ? nullptr : &col_buffer_, func);
+  } else if (use_shared_buffer) {
+    runWithSharedBuffer<Context>(
+        ws_, [&](Tensor* col_buffer) { func(0, N, col_buffer); });
   } else {
-    func(&col_buffer_);
+    func(0, N, &col_buffer_);
   }
   return true;
 }
@@ -261,11 +272,13 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
     ConvPoolOpBase<Context>::template SetBiasMultiplier<T>(
         Y_HxW, &bias_multiplier_);
   }
-  auto f = [&](Tensor* col_buffer) {
+  // Im2Col, followed by gemm, of the images in [begin, end).
+  auto f = [&](int64_t begin, int64_t end, Tensor* col_buffer) {
     col_buffer->Resize(buffer_shape);
     T* col_buffer_data = col_buffer->template mutable_data<T>();
-    // Im2Col, followed by gemm.
-    for (int image_id = 0; image_id < N; ++image_id) {
+    const T* X_data = X.template data<T>() + begin * input_offset;
+    T* Y_data = Y->template mutable_data<T>() + begin * output_offset;
+    for (int64_t image_id = begin; image_id < end; ++image_id) {
       if (kernel_.size() <= 2) {
         math::Im2Col<T, Context, StorageOrder::NHWC>(
             C,
@@ -339,10 +352,18 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
       Y_data += output_offset;
     }
   };
-  if (FLAGS_caffe2_force_shared_col_buffer || shared_buffer_) {
-    runWithSharedBuffer<Context>(ws_, f);
+  const bool use_shared_buffer =
+      FLAGS_caffe2_force_shared_col_buffer || shared_buffer_;
+  if (std::is_same<Context, CPUContext>::value) {
+    // As for NCHW, the chunks of images run in parallel with col buffers of
+    // their own.
+    runInParallelWithPooledBuffers(
+        ws_, N, use_shared_buffer ? nullptr : &col_buffer_, f);
+  } else if (use_shared_buffer) {
+    runWithSharedBuffer<Context>(
+        ws_, [&](Tensor* col_buffer) { f(0, N, col_buffer); });
   } else {
-    f(&col_buffer_);
+    f(0, N, &col_buffer_);
   }
   return true;
 }
@@ -358,73 +379,84 @@ bool ConvOp<T, Context>::Run1x1ConvOnDeviceWithOrderNCHW(
     const T* bias,
     T* Y) {
   const int G = group_;
-  if (G == 1) {
-    math::GemmStridedBatched<T, Context>(
-        CblasNoTrans,
-        CblasNoTrans,
-        N,
-        M,
-        HxW,
-        C,
-        1.0f,
-        filter,
-        0,
-        X,
-        C * HxW,
-        0.0f,
-        Y,
-        M * HxW,
-        &context_);
-  } else {
-    const int batch_size = N * G;
-    const int D_X = C / G;
-    const int D_Y = M / G;
-    const int X_stride = D_X * HxW;
-    const int W_stride = D_Y * D_X;
-    const int Y_stride = D_Y * HxW;
-    std::vector<const T*> X_ptr(N * G);
-    std::vector<const T*> W_ptr(N * G);
-    std::vector<T*> Y_ptr(N * G);
-    for (int i = 0; i < N; ++i) {
-      for (int j = 0; j < G; ++j) {
-        const int index = i * G + j;
-        X_ptr[index] = X + index * X_stride;
-        W_ptr[index] = filter + j * W_stride;
-        Y_ptr[index] = Y + index * Y_stride;
+  // The images in [begin, end) are the matrices of the GEMMs, without im2col.
+  const auto func = [&](int64_t begin, int64_t end) {
+    const int n = end - begin;
+    const T* X_data = X + begin * C * HxW;
+    T* Y_data = Y + begin * M * HxW;
+    if (G == 1) {
+      math::GemmStridedBatched<T, Context>(
+          CblasNoTrans,
+          CblasNoTrans,
+          n,
+          M,
+          HxW,
+          C,
+          1.0f,
+          filter,
+          0,
+          X_data,
+          C * HxW,
+          0.0f,
+          Y_data,
+          M * HxW,
+          &context_);
+    } else {
+      const int batch_size = n * G;
+      const int D_X = C / G;
+      const int D_Y = M / G;
+      const int X_stride = D_X * HxW;
+      const int W_stride = D_Y * D_X;
+      const int Y_stride = D_Y * HxW;
+      std::vector<const T*> X_ptr(n * G);
+      std::vector<const T*> W_ptr(n * G);
+      std::vector<T*> Y_ptr(n * G);
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < G; ++j) {
+          const int index = i * G + j;
+          X_ptr[index] = X_data + index * X_stride;
+          W_ptr[index] = filter + j * W_stride;
+          Y_ptr[index] = Y_data + index * Y_stride;
+        }
       }
+      math::GemmBatched<T, Context>(
+          CblasNoTrans,
+          CblasNoTrans,
+          batch_size,
+          D_Y,
+          HxW,
+          D_X,
+          1.0f,
+          W_ptr.data(),
+          X_ptr.data(),
+          0.0f,
+          Y_ptr.data(),
+          &context_);
     }
-    math::GemmBatched<T, Context>(
-        CblasNoTrans,
-        CblasNoTrans,
-        batch_size,
-        D_Y,
-        HxW,
-        D_X,
-        1.0f,
-        W_ptr.data(),
-        X_ptr.data(),
-        0.0f,
-        Y_ptr.data(),
-        &context_);
-  }
-  if (bias != nullptr) {
-    const T* bias_multiplier_data = bias_multiplier_.template data<T>();
-    math::GemmStridedBatched<T, Context>(
-        CblasNoTrans,
-        CblasNoTrans,
-        N,
-        M,
-        HxW,
-        1,
-        1.0f,
-        bias,
-        0,
-        bias_multiplier_data,
-        0,
-        1.0f,
-        Y,
-        M * HxW,
-        &context_);
+    if (bias != nullptr) {
+      const T* bias_multiplier_data = bias_multiplier_.template data<T>();
+      math::GemmStridedBatched<T, Context>(
+          CblasNoTrans,
+          CblasNoTrans,
+          n,
+          M,
+          HxW,
+          1,
+          1.0f,
+          bias,
+          0,
+          bias_multiplier_data,
+          0,
+          1.0f,
+          Y_data,
+          M * HxW,
+          &context_);
+    }
+  };
+  if (std::is_same<Context, CPUContext>::value) {
+    runInParallel(N, func);
+  } else {
+    func(0, N);
   }
   return true;
 }
@@ -3,6 +3,8 @@
 #include "caffe2/core/flags.h"
 #include "caffe2/core/workspace.h"
 
+#include <ATen/Parallel.h>
+
 C10_DEFINE_bool(
     caffe2_force_shared_col_buffer,
     false,
@@ -31,4 +33,102 @@ void runWithSharedBuffer<CPUContext>(
       ws->GetBlob("__CAFFE2_SHARED_CONV_BUFFER_CPU__"), CPU);
   f(buffer);
 }
+
+// The buffers of the pool not in use
+class SharedBufferPool {
+ public:
+  std::unique_ptr<Tensor> Acquire() {
+    std::lock_guard<std::mutex> g(mutex_);
+    if (buffers_.empty()) {
+      return caffe2::make_unique<Tensor>(CPU);
+    }
+    auto buffer = std::move(buffers_.back());
+    buffers_.pop_back();
+    return buffer;
+  }
+
+  void Release(std::unique_ptr<Tensor> buffer) {
+    std::lock_guard<std::mutex> g(mutex_);
+    buffers_.push_back(std::move(buffer));
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Tensor>> buffers_;
+};
+
+namespace {
+
+constexpr const char* kSharedBufferPoolName =
+    "__CAFFE2_SHARED_CONV_BUFFER_POOL_CPU__";
+
+// Runs f(chunk, begin, end) over at most one chunk of [0, n) per thread,
+// unless already in a parallel region, where it runs f(0, 0, n) at once.
+void runOverChunks(
+    int64_t n,
+    const std::function<void(int64_t chunk, int64_t begin, int64_t end)>& f) {
+  if (n <= 0) {
+    return;
+  }
+  const int64_t num_chunks = at::in_parallel_region()
+      ? 1
+      : std::min<int64_t>(at::get_max_threads(), n);
+  if (num_chunks == 1) {
+    f(0, 0, n);
+    return;
+  }
+  const int64_t chunk_size = at::divup(n, num_chunks);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+      const int64_t begin = chunk * chunk_size;
+      if (begin < n) {
+        f(chunk, begin, std::min(n, begin + chunk_size));
+      }
+    }
+  });
+}
+
+} // namespace
+
+CAFFE_KNOWN_TYPE(std::unique_ptr<SharedBufferPool>);
+
+void createSharedBufferPool(Workspace* ws) {
+  auto* poolPtr = ws->CreateBlob(kSharedBufferPoolName)
+                      ->GetMutable<std::unique_ptr<SharedBufferPool>>();
+  if (!*poolPtr) {
+    poolPtr->reset(new SharedBufferPool());
+  }
+}
+
+void runInParallelWithPooledBuffers(
+    Workspace* ws,
+    int64_t n,
+    Tensor* buffer,
+    std::function<void(int64_t begin, int64_t end, Tensor* buffer)> f) {
+  auto* poolBlob = ws->GetBlob(kSharedBufferPoolName);
+  CAFFE_ENFORCE(poolBlob, "Must call createSharedBufferPool() first");
+  auto* pool = poolBlob->GetMutable<std::unique_ptr<SharedBufferPool>>()->get();
+  runOverChunks(n, [&](int64_t chunk, int64_t begin, int64_t end) {
+    if (chunk == 0 && buffer) {
+      f(begin, end, buffer);
+      return;
+    }
+    auto pooled = pool->Acquire();
+    try {
+      f(begin, end, pooled.get());
+    } catch (...) {
+      pool->Release(std::move(pooled));
+      throw;
+    }
+    pool->Release(std::move(pooled));
+  });
+}
+
+void runInParallel(
+    int64_t n,
+    std::function<void(int64_t begin, int64_t end)> f) {
+  runOverChunks(n, [&](int64_t /* chunk */, int64_t begin, int64_t end) {
+    f(begin, end);
+  });
 }
+} // namespace caffe2
@@ -20,6 +20,35 @@ void createSharedBuffer(Workspace* ws);
  */
 template <typename Context>
 void runWithSharedBuffer(Workspace* ws, std::function<void(Tensor* buffer)> f);
+
+/**
+ * Creates a pool of CPU buffers in the workspace, which the operators running
+ * at the same time share without waiting for each other.
+ * Not thread-safe, must be called from the constructor.
+ */
+CAFFE2_API void createSharedBufferPool(Workspace* ws);
+
+/**
+ * Thread-safe, can be invoked from RunOnDevice() of CPU operators to run
+ * f(begin, end, buffer) over chunks that together cover [0, n), in parallel.
+ * Each chunk gets a buffer of its own: the first one gets buffer, and the
+ * others, or all of them if buffer is nullptr, get one taken from the pool,
+ * which returns to the pool afterwards.
+ */
+CAFFE2_API void runInParallelWithPooledBuffers(
+    Workspace* ws,
+    int64_t n,
+    Tensor* buffer,
+    std::function<void(int64_t begin, int64_t end, Tensor* buffer)> f);
+
+/**
+ * Runs f(begin, end) over chunks that together cover [0, n), in parallel on
+ * CPU.
+ */
+CAFFE2_API void runInParallel(
+    int64_t n,
+    std::function<void(int64_t begin, int64_t end)> f);
+
 } // namespace caffe2
 
 #endif // CAFFE2_OPERATORS_CONV_OP_SHARED_H_
@@ -1,23 +1,15 @@
 #include "caffe2/operators/flexible_top_k.h"
 
-#include "caffe2/proto/caffe2_pb.h"
-
-namespace caffe2 {
+#include <algorithm>
+#include <utility>
+#include <vector>
 
-namespace {
+#include <ATen/Parallel.h>
 
-template <typename T>
-struct ValueCmp {
-  bool operator()(
-      const std::pair<T, int64_t>& lhs,
-      const std::pair<T, int64_t>& rhs) {
-    return (
-        lhs.first > rhs.first ||
-        (lhs.first == rhs.first && lhs.second < rhs.second));
-  }
-};
+#include "caffe2/operators/top_k_cpu_selection.h"
+#include "caffe2/proto/caffe2_pb.h"
 
-} // namespace
+namespace caffe2 {
 
 template <typename T, class Context>
 bool FlexibleTopKOp<T, Context>::RunOnDevice() {
@@ -39,7 +31,8 @@ bool FlexibleTopKOp<T, Context>::RunOnDevice() {
       k.numel(),
       "first n-1 dims of input data and K does not match.");
 
-  int64_t output_size = 0;
+  // The rows write their top k from the offset of the row in the outputs
+  vector<int64_t> output_offsets(linear_shape[0] + 1, 0);
   for (int64_t i = 0; i < linear_shape[0]; ++i) {
     CAFFE_ENFORCE(
         linear_shape[1] >= k_data[i],
@@ -53,42 +46,32 @@ bool FlexibleTopKOp<T, Context>::RunOnDevice() {
         i,
         ",  with value: ",
         k_data[i]);
-    output_size += k_data[i];
+    output_offsets[i + 1] = output_offsets[i] + k_data[i];
   }
+  const int64_t output_size = output_offsets.back();
   values->Resize(output_size);
   indices->Resize(output_size);
   T* values_data = values->template mutable_data<T>();
   int64_t* indices_data = indices->template mutable_data<int64_t>();
 
-  int64_t output_offset = 0;
-  // Sort preserving indices
-  for (int64_t i = 0; i < linear_shape[0]; ++i) {
-    // Build a min-heap, the heap element is pair of (value, idx)
-    // the top of the heap is the smallest value
-    std::priority_queue<
-        std::pair<T, int64_t>,
-        std::vector<std::pair<T, int64_t>>,
-        ValueCmp<T>>
-        PQ;
-
-    int64_t k_ = k_data[i];
-    for (int64_t j = 0; j < linear_shape[1]; ++j) {
-      const T value = input_data[i * linear_shape[1] + j];
-      if (PQ.size() < k_ || value > PQ.top().first) {
-        PQ.push(std::make_pair(value, j));
-      }
-      if (PQ.size() > k_) {
-        PQ.pop();
-      }
-    }
-    for (int64_t j = 0; j < k_; ++j) {
-      auto& pqElem = PQ.top();
-      values_data[output_offset + k_ - j - 1] = pqElem.first;
-      indices_data[output_offset + k_ - j - 1] = pqElem.second;
-      PQ.pop();
-    }
-    output_offset += k_;
-  }
+  // Sort preserving indices, the rows in parallel, in chunks of about
+  // GRAIN_SIZE values
+  const int64_t n = linear_shape[1];
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(n, 1));
+  at::parallel_for(
+      0, linear_shape[0], grain_size, [&](int64_t begin, int64_t end) {
+        std::vector<std::pair<T, int64_t>> selected;
+        for (int64_t i = begin; i < end; ++i) {
+          top_k_cpu::SelectTopK(input_data + i * n, n, k_data[i], 1, &selected);
+          int64_t output_offset = output_offsets[i];
+          for (const auto& item : selected) {
+            values_data[output_offset] = item.first;
+            indices_data[output_offset] = item.second;
+            ++output_offset;
+          }
+        }
+      });
 
   return true;
 }
@@ -0,0 +1,154 @@
+#include "caffe2/operators/fused_rowwise_nbit_conversion_ops.h"
+#include <fp16.h>
+#include "c10/util/Registry.h"
+
+namespace caffe2 {
+
+namespace {
+void convertfp32fp32(float* dst, const float* src, size_t N) {
+  memcpy(dst, src, sizeof(float) * N);
+}
+
+void convertfp16fp32(float* dst, const at::Half* src, size_t N) {
+  for (size_t i = 0; i < N; i++) {
+    dst[i] = fp16_ieee_to_fp32_value(src[i].x);
+  }
+}
+
+void convertfp32fp16(at::Half* dst, const float* src, size_t N) {
+  for (size_t i = 0; i < N; i++) {
+    uint16_t out = fp16_ieee_from_fp32_value(src[i]);
+    memcpy(dst + i, &out, sizeof(uint16_t));
+  }
+}
+
+template <int BIT_RATE>
+vector<TensorShape> QuantizedShape(
+    const OperatorDef& /* def */,
+    const vector<TensorShape>& in) {
+  constexpr int NUM_ELEM_PER_BYTE = 8 / BIT_RATE;
+  vector<TensorShape> out;
+  TensorShape X = in[0];
+  X.set_dims(
+      1, (X.dims(1) + NUM_ELEM_PER_BYTE - 1) / NUM_ELEM_PER_BYTE + 4);
+  out.push_back(std::move(X));
+  out[0].set_data_type(TensorProto_DataType_UINT8);
+  return out;
+}
+
+template <int BIT_RATE, TensorProto_DataType DATA_TYPE>
+vector<TensorShape> DequantizedShape(
+    const OperatorDef& /* def */,
+    const vector<TensorShape>& in) {
+  constexpr int NUM_ELEM_PER_BYTE = 8 / BIT_RATE;
+  vector<TensorShape> out;
+  TensorShape X = in[0];
+  X.set_dims(1, (X.dims(1) - 4) * NUM_ELEM_PER_BYTE);
+  out.push_back(std::move(X));
+  out[0].set_data_type(DATA_TYPE);
+  return out;
+}
+} // namespace
+
+#define REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS(bit_rate)                   \
+  REGISTER_CPU_OPERATOR(                                                       \
+      FloatToFused##bit_rate##BitRowwiseQuantized,                             \
+      FloatToFusedNBitRowwiseQuantizedOp<                                      \
+          bit_rate,                                                            \
+          float,                                                               \
+          convertfp32fp32,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(FloatToFused##bit_rate##BitRowwiseQuantized)                 \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction(QuantizedShape<bit_rate>)                       \
+      .SetDoc(                                                                 \
+          "Applies " #bit_rate "-bit row-wise quantization by determining "    \
+          "the range (maximum - minimum) and offset (minimum value) of each "  \
+          "row in the input matrix, and then scaling each element to a "       \
+          #bit_rate "-bit number between 0 and 2^" #bit_rate " - 1. To later " \
+          "de-quantize values, the scale (range / (2^" #bit_rate " - 1)) and " \
+          "offset (bias) are stored alongside the data. More precisely, each " \
+          "byte of a row in the output matrix packs 8 / " #bit_rate " "        \
+          "quantized values, the first one in its least significant bits, "    \
+          "and the last 4 bytes of the row store the scale and the bias as "   \
+          "16-bit floats.")                                                    \
+      .Input(0, "input", "Float32 input data")                                 \
+      .Output(0, "output", "Fused scale, bias and quantized data");            \
+  NO_GRADIENT(FloatToFused##bit_rate##BitRowwiseQuantized);                    \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      HalfFloatToFused##bit_rate##BitRowwiseQuantized,                         \
+      FloatToFusedNBitRowwiseQuantizedOp<                                      \
+          bit_rate,                                                            \
+          at::Half,                                                            \
+          convertfp16fp32,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(HalfFloatToFused##bit_rate##BitRowwiseQuantized)             \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction(QuantizedShape<bit_rate>)                       \
+      .SetDoc(                                                                 \
+          "Same as FloatToFused" #bit_rate "BitRowwiseQuantized, but with "    \
+          "Float16 input data.")                                               \
+      .Input(0, "input", "Float16 input data")                                 \
+      .Output(0, "output", "Fused scale, bias and quantized data");            \
+  NO_GRADIENT(HalfFloatToFused##bit_rate##BitRowwiseQuantized);                \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      Fused##bit_rate##BitRowwiseQuantizedToFloat,                             \
+      FusedNBitRowwiseQuantizedToFloatOp<                                      \
+          bit_rate,                                                            \
+          float,                                                               \
+          convertfp32fp32,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(Fused##bit_rate##BitRowwiseQuantizedToFloat)                 \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction(                                                \
+          DequantizedShape<bit_rate, TensorProto_DataType_FLOAT>)              \
+      .SetDoc(                                                                 \
+          "De-quantizes the result of the FloatToFused" #bit_rate              \
+          "BitRowwiseQuantized operator. The input is expected to pack "       \
+          "8 / " #bit_rate " quantized values per byte, followed by the "      \
+          "scale and the bias of the row as 16-bit floats in its last 4 "      \
+          "bytes. The output is a matrix containing only the values, but "     \
+          "de-quantized, by multiplying each value by its row's scale and "    \
+          "adding the bias. Its number of columns is the original one "        \
+          "rounded up to a multiple of 8 / " #bit_rate ", the padding "        \
+          "values being equal to the bias.")                                   \
+      .Input(                                                                  \
+          0,                                                                   \
+          "scale_bias_quantized_input",                                        \
+          "Fused scale, bias and quantized data")                              \
+      .Output(0, "float_output", "Float32 data");                              \
+  NO_GRADIENT(Fused##bit_rate##BitRowwiseQuantizedToFloat);                    \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      Fused##bit_rate##BitRowwiseQuantizedToHalfFloat,                         \
+      FusedNBitRowwiseQuantizedToFloatOp<                                      \
+          bit_rate,                                                            \
+          at::Half,                                                            \
+          convertfp32fp16,                                                     \
+          CPUContext>);                                                        \
+  OPERATOR_SCHEMA(Fused##bit_rate##BitRowwiseQuantizedToHalfFloat)             \
+      .NumInputs(1)                                                            \
+      .NumOutputs(1)                                                           \
+      .TensorInferenceFunction(                                                \
+          DequantizedShape<bit_rate, TensorProto_DataType_FLOAT16>)            \
+      .SetDoc(                                                                 \
+          "Same as Fused" #bit_rate "BitRowwiseQuantizedToFloat, but with "    \
+          "Float16 output data.")                                              \
+      .Input(                                                                  \
+          0,                                                                   \
+          "scale_bias_quantized_input",                                        \
+          "Fused scale, bias and quantized data")                              \
+      .Output(0, "float16_output", "Float16 data");                            \
+  NO_GRADIENT(Fused##bit_rate##BitRowwiseQuantizedToHalfFloat);
+
+REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS(4);
+REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS(2);
+
+#undef REGISTER_FUSED_NBIT_ROWWISE_CONVERSION_OPS
+
+} // namespace caffe2
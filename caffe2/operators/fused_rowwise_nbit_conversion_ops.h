@@ -0,0 +1,168 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
+#define CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
+
+namespace caffe2 {
+
+#define IS_LITTLE_ENDIAN                                      \
+  [] {                                                        \
+    const int32_t kValue = 1;                                 \
+    return reinterpret_cast<const uint8_t*>(&kValue)[0] == 1; \
+  }()
+
+template <
+    int BIT_RATE,
+    typename T,
+    void (*convert)(float* dst, const T* src, size_t N),
+    class Context>
+class FloatToFusedNBitRowwiseQuantizedOp : public Operator<Context> {
+ public:
+  static_assert(BIT_RATE == 2 || BIT_RATE == 4, "Unsupported bit rate");
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(FloatToFusedNBitRowwiseQuantizedOp)
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE(IS_LITTLE_ENDIAN, "Unsupported endianness");
+
+    const auto& input = Input(DATA_FLOAT);
+    auto* output = Output(DATA_FUSED_SCALE_BIAS);
+
+    CAFFE_ENFORCE_EQ(input.dim(), 2, "Expect input to be a matrix");
+    const auto input_rows = input.size(0);
+    const auto input_columns = input.size(1);
+    CAFFE_ENFORCE_GT(input_columns, 0, "Expect input to have columns");
+
+    // The "fused" representation stores the scale and bias with the row-wise
+    // quantized data in one tensor. Each byte packs NUM_ELEM_PER_BYTE values,
+    // the first one in the least significant bits, and the last 4 bytes of
+    // each row hold the scale (2 bytes) and bias (2 bytes) as 16-bit floats.
+    // | ... packed data ... | scale | bias |
+    // |  ceil(#columns / N) |  2B   |  2B  |
+    constexpr int NUM_ELEM_PER_BYTE = 8 / BIT_RATE;
+    const auto packed_columns =
+        (input_columns + NUM_ELEM_PER_BYTE - 1) / NUM_ELEM_PER_BYTE;
+    const std::vector<int64_t> output_dimensions = {
+        input_rows, packed_columns + 2 * static_cast<int64_t>(sizeof(at::Half))};
+    output->Resize(output_dimensions);
+
+    const auto* input_data = input.template data<T>();
+    auto* output_data = output->template mutable_data<uint8_t>();
+    const auto output_columns = output->size(1);
+    memset(output_data, 0, output->numel());
+
+    vector<float> tmp(input_columns);
+    for (int64_t row = 0; row < input_rows; ++row) {
+      convert(tmp.data(), input_data + row * input_columns, input_columns);
+      uint8_t* output_row = output_data + row * output_columns;
+      at::Half* output_row_scale_bias =
+          reinterpret_cast<at::Half*>(output_row + packed_columns);
+
+      // Quantize against the bias and scale rounded to fp16, so that
+      // de-quantizing with their stored values is as accurate as possible.
+      const auto minmax = std::minmax_element(tmp.begin(), tmp.end());
+      const at::Half minimum(*minmax.first);
+      const at::Half scale(
+          (*minmax.second - minimum) / ((1 << BIT_RATE) - 1));
+      float inverse_scale = 1.0f / scale;
+      if (scale == 0.0f || std::isinf(inverse_scale)) {
+        output_row_scale_bias[0] = 1.0f;
+        inverse_scale = 1.0f;
+      } else {
+        output_row_scale_bias[0] = scale;
+      }
+      output_row_scale_bias[1] = minimum;
+
+      for (int64_t col = 0; col < input_columns; ++col) {
+        const float quantized = std::max(
+            0.0f,
+            std::min<float>(
+                std::nearbyint((tmp[col] - minimum) * inverse_scale),
+                (1 << BIT_RATE) - 1));
+        output_row[col / NUM_ELEM_PER_BYTE] |= static_cast<uint8_t>(quantized)
+            << ((col % NUM_ELEM_PER_BYTE) * BIT_RATE);
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  INPUT_TAGS(DATA_FLOAT);
+  OUTPUT_TAGS(DATA_FUSED_SCALE_BIAS);
+};
+
+template <
+    int BIT_RATE,
+    typename T,
+    void (*convert)(T* dst, const float* src, size_t N),
+    class Context>
+class FusedNBitRowwiseQuantizedToFloatOp : public Operator<Context> {
+ public:
+  static_assert(BIT_RATE == 2 || BIT_RATE == 4, "Unsupported bit rate");
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(FusedNBitRowwiseQuantizedToFloatOp)
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE(IS_LITTLE_ENDIAN, "Unsupported endianness");
+
+    const auto& input = Input(DATA_FUSED_SCALE_BIAS);
+    auto* output = Output(DATA_FLOAT);
+
+    CAFFE_ENFORCE_EQ(input.dim(), 2, "Expect input to be a matrix");
+    const auto input_rows = input.size(0);
+    const auto input_columns = input.size(1);
+    CAFFE_ENFORCE_GT(input_columns, 4, "Expect input to have scale and bias");
+
+    // The last 4 bytes per row are the scale and the bias. The rest of
+    // input_columns holds the packed values of the original row, whose number
+    // of columns is rounded up to a multiple of NUM_ELEM_PER_BYTE.
+    constexpr int NUM_ELEM_PER_BYTE = 8 / BIT_RATE;
+    const auto packed_columns =
+        input_columns - 2 * static_cast<int64_t>(sizeof(at::Half));
+    const std::vector<int64_t> output_dimensions = {
+        input_rows, packed_columns * NUM_ELEM_PER_BYTE};
+    output->Resize(output_dimensions);
+    const auto output_columns = output->size(1);
+
+    const auto* input_data = input.template data<uint8_t>();
+    T* output_data = output->template mutable_data<T>();
+
+    vector<float> tmp(output_columns);
+    for (int64_t row = 0; row < input_rows; ++row) {
+      const uint8_t* input_row = input_data + row * input_columns;
+      const at::Half* input_row_scale_bias =
+          reinterpret_cast<const at::Half*>(input_row + packed_columns);
+      const float scale = input_row_scale_bias[0];
+      const float bias = input_row_scale_bias[1];
+
+      for (int64_t col = 0; col < output_columns; ++col) {
+        const uint8_t quantized = (input_row[col / NUM_ELEM_PER_BYTE] >>
+                                   ((col % NUM_ELEM_PER_BYTE) * BIT_RATE)) &
+            ((1 << BIT_RATE) - 1);
+        tmp[col] = scale * quantized + bias;
+      }
+
+      convert(output_data + row * output_columns, tmp.data(), output_columns);
+    }
+    return true;
+  }
+
+ private:
+  INPUT_TAGS(DATA_FUSED_SCALE_BIAS);
+  OUTPUT_TAGS(DATA_FLOAT);
+};
+
+#undef IS_LITTLE_ENDIAN
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
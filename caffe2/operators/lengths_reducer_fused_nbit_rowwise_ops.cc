@@ -0,0 +1,126 @@
+#include "caffe2/operators/lengths_reducer_fused_nbit_rowwise_ops.h"
+#include "c10/util/Registry.h"
+
+namespace caffe2 {
+
+#define REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS(bit_rate)                \
+  REGISTER_CPU_OPERATOR(                                                       \
+      SparseLengthsSumFused##bit_rate##BitRowwise,                             \
+      SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext>);                  \
+  OPERATOR_SCHEMA(SparseLengthsSumFused##bit_rate##BitRowwise)                 \
+      .NumInputs(3)                                                            \
+      .NumOutputs(1)                                                           \
+      .ValueKeyLengthInputFillers(                                             \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext>::DATA,         \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext>::INDICES,      \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext>::LENGTHS)      \
+      .SetDoc(                                                                 \
+          "Performs the same operation as SparseLengthsSum, but operating on " \
+          #bit_rate "-bit rowwise quantized matrices with fused storage "      \
+          "(where each row stores quantized values, and then 2-byte fp16 "     \
+          "scale and bias).")                                                  \
+      .Input(                                                                  \
+          0,                                                                   \
+          "DATA",                                                              \
+          "uint8 tensor obtained with operator FloatToFused" #bit_rate         \
+          "BitRowwiseQuantized")                                               \
+      .Input(                                                                  \
+          1,                                                                   \
+          "INDICES",                                                           \
+          "Integer vector containing indices of the first "                    \
+          "dimension of DATA for the slices that are being aggregated")        \
+      .Input(                                                                  \
+          2,                                                                   \
+          "LENGTHS",                                                           \
+          "Vector with the same sum of elements as the first dimension of "    \
+          "DATA")                                                              \
+      .Output(0, "output", "output");                                          \
+  NO_GRADIENT(SparseLengthsSumFused##bit_rate##BitRowwise);                    \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      SparseLengthsWeightedSumFused##bit_rate##BitRowwise,                     \
+      SparseLengthsFusedNBitRowwiseOp<                                         \
+          bit_rate,                                                            \
+          CPUContext,                                                          \
+          /*with_weights=*/true>);                                             \
+  OPERATOR_SCHEMA(SparseLengthsWeightedSumFused##bit_rate##BitRowwise)         \
+      .NumInputs(4)                                                            \
+      .NumOutputs(1)                                                           \
+      .WeightedValueKeyLengthInputFillers(                                     \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, true>::DATA,   \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, true>::INDICES, \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, true>::LENGTHS, \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, true>::WEIGHTS) \
+      .SetDoc(                                                                 \
+          "Performs the same operation as SparseLengthsWeightedSum, but "      \
+          "operating on " #bit_rate "-bit rowwise quantized matrices with "    \
+          "fused storage (where each row stores quantized values, and then "   \
+          "2-byte fp16 scale and bias).")                                      \
+      .Input(                                                                  \
+          0,                                                                   \
+          "DATA",                                                              \
+          "uint8 tensor obtained with operator FloatToFused" #bit_rate         \
+          "BitRowwiseQuantized")                                               \
+      .Input(                                                                  \
+          1,                                                                   \
+          "INDICES",                                                           \
+          "Integer vector containing indices of the first "                    \
+          "dimension of DATA for the slices that are being aggregated")        \
+      .Input(                                                                  \
+          2,                                                                   \
+          "LENGTHS",                                                           \
+          "Vector with the same sum of elements as the first dimension of "    \
+          "DATA")                                                              \
+      .Input(                                                                  \
+          3,                                                                   \
+          "WEIGHTS",                                                           \
+          "Vector of weights to scale rows of DATA with before reduction")     \
+      .Output(0, "output", "output");                                          \
+  NO_GRADIENT(SparseLengthsWeightedSumFused##bit_rate##BitRowwise);            \
+                                                                               \
+  REGISTER_CPU_OPERATOR(                                                       \
+      SparseLengthsMeanFused##bit_rate##BitRowwise,                            \
+      SparseLengthsFusedNBitRowwiseOp<                                         \
+          bit_rate,                                                            \
+          CPUContext,                                                          \
+          /*with_weights=*/false,                                              \
+          /*is_mean=*/true>);                                                  \
+  OPERATOR_SCHEMA(SparseLengthsMeanFused##bit_rate##BitRowwise)                \
+      .NumInputs(3)                                                            \
+      .NumOutputs(1)                                                           \
+      .ValueKeyLengthInputFillers(                                             \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, false, true>:: \
+              DATA,                                                            \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, false, true>:: \
+              INDICES,                                                         \
+          SparseLengthsFusedNBitRowwiseOp<bit_rate, CPUContext, false, true>:: \
+              LENGTHS)                                                         \
+      .SetDoc(                                                                 \
+          "Performs the same operation as SparseLengthsMean, but operating "   \
+          "on " #bit_rate "-bit rowwise quantized matrices with fused "        \
+          "storage (where each row stores quantized values, and then 2-byte "  \
+          "fp16 scale and bias).")                                             \
+      .Input(                                                                  \
+          0,                                                                   \
+          "DATA",                                                              \
+          "uint8 tensor obtained with operator FloatToFused" #bit_rate         \
+          "BitRowwiseQuantized")                                               \
+      .Input(                                                                  \
+          1,                                                                   \
+          "INDICES",                                                           \
+          "Integer vector containing indices of the first "                    \
+          "dimension of DATA for the slices that are being aggregated")        \
+      .Input(                                                                  \
+          2,                                                                   \
+          "LENGTHS",                                                           \
+          "Vector with the same sum of elements as the first dimension of "    \
+          "DATA")                                                              \
+      .Output(0, "output", "output");                                          \
+  NO_GRADIENT(SparseLengthsMeanFused##bit_rate##BitRowwise);
+
+REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS(4);
+REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS(2);
+
+#undef REGISTER_SPARSE_LENGTHS_FUSED_NBIT_ROWWISE_OPS
+
+} // namespace caffe2
@@ -29,6 +29,15 @@ weights are accessed by indices [0..L-1], where L is the length of given row.
 This is basically a fused operator of LengthsRangeFill + Gather +
 SparseWeightedSum
 )DOC")
+    .Arg(
+        "dedup_indices",
+        "(bool, default false) Sort the indices of each segment and merge "
+        "the duplicates before the lookup, which reads each distinct row once "
+        "per segment. Results may differ by rounding.")
+    .Arg(
+        "use_thread_pool",
+        "(bool, default false) Split the segments across the threads of the "
+        "workspace's thread pool, in ranges of about the same total length.")
     .Input(
         0,
         "DATA",
@@ -78,6 +87,15 @@ OPERATOR_SCHEMA(SparseLengthsSum)
         SparseLengthsSumOp::INDICES,
         SparseLengthsSumOp::LENGTHS)
     .SetDoc(FormatDoc<SparseLengthsSumDef>())
+    .Arg(
+        "dedup_indices",
+        "(bool, default false) Sort the indices of each segment and merge "
+        "the duplicates before the lookup, which reads each distinct row once "
+        "per segment. Results may differ by rounding.")
+    .Arg(
+        "use_thread_pool",
+        "(bool, default false) Split the segments across the threads of the "
+        "workspace's thread pool, in ranges of about the same total length.")
     .Output(0, "OUTPUT", "Aggregated tensor")
     .FillUsing(SparseLengthsSumDef::PopulateSchema)
     .InheritOnnxSchema();
@@ -105,6 +123,15 @@ OPERATOR_SCHEMA(SparseLengthsWeightedSum)
         SparseLengthsWeightedSumOp::LENGTHS,
         SparseLengthsWeightedSumOp::WEIGHT)
     .SetDoc(FormatDoc<SparseLengthsWeightedSumDef>())
+    .Arg(
+        "dedup_indices",
+        "(bool, default false) Sort the indices of each segment and merge "
+        "the duplicates before the lookup, which reads each distinct row once "
+        "per segment. Results may differ by rounding.")
+    .Arg(
+        "use_thread_pool",
+        "(bool, default false) Split the segments across the threads of the "
+        "workspace's thread pool, in ranges of about the same total length.")
     .Output(0, "OUTPUT", "Aggregated tensor")
     .FillUsing(SparseLengthsWeightedSumDef::PopulateSchema)
     .InheritOnnxSchema();
@@ -133,6 +160,15 @@ OPERATOR_SCHEMA(SparseLengthsMean)
         SparseLengthsMeanOp::INDICES,
         SparseLengthsMeanOp::LENGTHS)
     .SetDoc(FormatDoc<SparseLengthsMeanDef>())
+    .Arg(
+        "dedup_indices",
+        "(bool, default false) Sort the indices of each segment and merge "
+        "the duplicates before the lookup, which reads each distinct row once "
+        "per segment. Results may differ by rounding.")
+    .Arg(
+        "use_thread_pool",
+        "(bool, default false) Split the segments across the threads of the "
+        "workspace's thread pool, in ranges of about the same total length.")
     .Output(0, "OUTPUT", "Aggregated tensor")
     .FillUsing(SparseLengthsMeanDef::PopulateSchema);
 REGISTER_CPU_OPERATOR(
@@ -1,7 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <exception>
+#include <utility>
+#include <vector>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/perfkernels/embedding_lookup.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
 
 namespace caffe2 {
 
@@ -19,7 +25,12 @@ class CPUSparseLengthsReductionOp : public Operator<CPUContext> {
  public:
   USE_OPERATOR_FUNCTIONS(CPUContext);
   CPUSparseLengthsReductionOp(const OperatorDef& operator_def, Workspace* ws)
-      : Operator<CPUContext>(operator_def, ws) {
+      : Operator<CPUContext>(operator_def, ws),
+        ws_(ws),
+        dedup_indices_(
+            this->template GetSingleArgument<bool>("dedup_indices", false)),
+        use_thread_pool_(
+            this->template GetSingleArgument<bool>("use_thread_pool", false)) {
     static_assert(
         !(USE_WEIGHT & USE_MEAN), "Cannot both specify weight and mean.");
   }
@@ -76,18 +87,28 @@ class CPUSparseLengthsReductionOp : public Operator<CPUContext> {
       in_weight = weightInput.template data<T>();
     }
 
-    // delegate work to perfkernel that branches based on architecture
-    EmbeddingLookup<IndexType, InputType, T, USE_POSITIONAL_WEIGHT>(
-        D,
-        M,
-        indices_size,
-        N,
-        in_data,
-        indices,
-        lengths,
-        in_weight,
-        nullptr, // scale_bias field is only used in SparseLengths8BitsRowwiseOp
-        USE_MEAN,
+    if (dedup_indices_) {
+      static_assert(
+          std::is_same<T, float>::value, "Weights must be float to dedup");
+      DedupIndices(indices, lengths, M, indices_size, in_weight);
+      // The merged weights already include the positional weights and the
+      // normalization by the lengths
+      Lookup<InputType, int64_t, false>(
+          D,
+          M,
+          dedup_indices_buffer_.size(),
+          N,
+          in_data,
+          dedup_indices_buffer_.data(),
+          dedup_lengths_.data(),
+          dedup_weights_.data(),
+          false,
+          out_data);
+      return true;
+    }
+
+    Lookup<InputType, IndexType, USE_POSITIONAL_WEIGHT>(
+        D, M, indices_size, N, in_data, indices, lengths, in_weight, USE_MEAN,
         out_data);
     return true;
   }
@@ -100,6 +121,173 @@ class CPUSparseLengthsReductionOp : public Operator<CPUContext> {
     LENGTHS = 2 + USE_WEIGHT, // 2 in SparseLengths[Sum, Mean],
                               // 3 in SparseLengthsWeightedSum
   };
+
+ private:
+  // Chunks smaller than this aren't worth dispatching to another thread
+  static constexpr int64_t kMinIndicesPerChunk = 1024;
+
+  // Runs the embedding lookup, splitting the segments across the threads of
+  // the workspace's pool if use_thread_pool is set. Each thread gets a range
+  // of consecutive segments, so that it writes a contiguous part of the
+  // output, with about the same total length as the others.
+  template <typename InputType, typename IndexType, bool IS_WEIGHT_POSITIONAL>
+  void Lookup(
+      int64_t block_size,
+      int64_t output_size,
+      int64_t index_size,
+      int64_t data_size,
+      const InputType* input,
+      const IndexType* indices,
+      const int* lengths,
+      const T* weights,
+      bool normalize_by_lengths,
+      T* out) {
+    ThreadPool* pool = use_thread_pool_ ? ws_->GetThreadPool() : nullptr;
+    const int64_t num_chunks = pool == nullptr
+        ? 1
+        : std::min<int64_t>(
+              {static_cast<int64_t>(pool->getNumThreads()),
+               output_size,
+               index_size / kMinIndicesPerChunk});
+    if (num_chunks <= 1) {
+      // delegate work to perfkernel that branches based on architecture
+      EmbeddingLookup<IndexType, InputType, T, IS_WEIGHT_POSITIONAL>(
+          block_size,
+          output_size,
+          index_size,
+          data_size,
+          input,
+          indices,
+          lengths,
+          weights,
+          nullptr, // scale_bias is only used in SparseLengths8BitsRowwiseOp
+          normalize_by_lengths,
+          out);
+      return;
+    }
+
+    // Chunk k covers the segments from chunk_segments_[k] to
+    // chunk_segments_[k + 1], whose indices start at chunk_indices_[k]. The
+    // boundaries are where the prefix sums of the lengths cross multiples of
+    // index_size / num_chunks.
+    chunk_segments_.assign(num_chunks + 1, output_size);
+    chunk_indices_.assign(num_chunks + 1, index_size);
+    chunk_segments_[0] = 0;
+    chunk_indices_[0] = 0;
+    int64_t total_length = 0;
+    int64_t chunk = 1;
+    for (int64_t m = 0; m < output_size; ++m) {
+      total_length += lengths[m];
+      while (chunk < num_chunks &&
+             total_length * num_chunks >= chunk * index_size) {
+        chunk_segments_[chunk] = m + 1;
+        chunk_indices_[chunk] = total_length;
+        ++chunk;
+      }
+    }
+    CAFFE_ENFORCE_EQ(
+        total_length,
+        index_size,
+        "Your input seems to be incorrect: the sum of lengths values should be "
+        "the size of the indices tensor, but it appears not.");
+
+    // Exceptions can't leave the worker threads
+    std::vector<std::exception_ptr> errors(num_chunks);
+    pool->run(
+        [&](int /* unused */, size_t k) {
+          try {
+            const int64_t first_segment = chunk_segments_[k];
+            const int64_t first_index = chunk_indices_[k];
+            EmbeddingLookup<IndexType, InputType, T, IS_WEIGHT_POSITIONAL>(
+                block_size,
+                chunk_segments_[k + 1] - first_segment,
+                chunk_indices_[k + 1] - first_index,
+                data_size,
+                input,
+                indices + first_index,
+                lengths + first_segment,
+                // Positional weights are indexed by the position in a segment
+                weights == nullptr || IS_WEIGHT_POSITIONAL
+                    ? weights
+                    : weights + first_index,
+                nullptr,
+                normalize_by_lengths,
+                out + first_segment * block_size);
+          } catch (...) {
+            errors[k] = std::current_exception();
+          }
+        },
+        num_chunks);
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  // Sorts the indices of each segment and merges the duplicates, summing
+  // their weights, so that the lookup reads each distinct row once per segment
+  // and in the order of the addresses.
+  template <typename IndexType>
+  void DedupIndices(
+      const IndexType* indices,
+      const int* lengths,
+      int64_t num_segments,
+      int64_t indices_size,
+      const T* weights) {
+    dedup_indices_buffer_.clear();
+    dedup_weights_.clear();
+    dedup_lengths_.resize(num_segments);
+    int64_t current = 0;
+    for (int64_t m = 0; m < num_segments; ++m) {
+      CAFFE_ENFORCE_LE(
+          current + lengths[m],
+          indices_size,
+          "The sum of LENGTHS must be the size of INDICES");
+      segment_.clear();
+      for (int i = 0; i < lengths[m]; ++i, ++current) {
+        T weight = 1;
+        if (USE_WEIGHT) {
+          weight = weights[USE_POSITIONAL_WEIGHT ? i : current];
+        }
+        if (USE_MEAN) {
+          weight /= lengths[m];
+        }
+        segment_.emplace_back(indices[current], weight);
+      }
+      std::sort(
+          segment_.begin(),
+          segment_.end(),
+          [](const std::pair<int64_t, T>& a, const std::pair<int64_t, T>& b) {
+            return a.first < b.first;
+          });
+      const auto segment_start = dedup_indices_buffer_.size();
+      for (const auto& entry : segment_) {
+        if (dedup_indices_buffer_.size() > segment_start &&
+            dedup_indices_buffer_.back() == entry.first) {
+          dedup_weights_.back() += entry.second;
+        } else {
+          dedup_indices_buffer_.push_back(entry.first);
+          dedup_weights_.push_back(entry.second);
+        }
+      }
+      dedup_lengths_[m] = dedup_indices_buffer_.size() - segment_start;
+    }
+    CAFFE_ENFORCE_EQ(
+        current,
+        indices_size,
+        "The sum of LENGTHS must be the size of INDICES");
+  }
+
+  Workspace* ws_;
+  bool dedup_indices_;
+  bool use_thread_pool_;
+  std::vector<int64_t> chunk_segments_;
+  std::vector<int64_t> chunk_indices_;
+  std::vector<std::pair<int64_t, T>> segment_;
+  std::vector<int64_t> dedup_indices_buffer_;
+  std::vector<T> dedup_weights_;
+  std::vector<int> dedup_lengths_;
 };
 
 } // namespace caffe2
@@ -1,8 +1,14 @@
 #ifndef CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 
+#include <algorithm>
 #include <cstdio>
+#include <exception>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 
 #include "caffe2/core/blob_serialization.h"
@@ -30,6 +36,89 @@ struct BlobState {
         current_size(current_size),
         is_tensor(is_tensor) {}
 };
+
+// Runs the tasks of a LoadOp on up to caffe2_max_tensor_deserializer_threads
+// threads, started with the first task, or right away on the calling thread
+// if there is at most one.
+class DeserializationQueue {
+ public:
+  DeserializationQueue() = default;
+
+  ~DeserializationQueue() {
+    try {
+      Finish();
+    } catch (...) {
+      // Only hit while unwinding from an error of the calling thread.
+    }
+  }
+
+  void Push(std::function<void()> task) {
+#ifndef __ANDROID__
+    if (FLAGS_caffe2_max_tensor_deserializer_threads > 1) {
+      if (futures_.empty()) {
+        for (int i = 0; i < FLAGS_caffe2_max_tensor_deserializer_threads;
+             ++i) {
+          futures_.emplace_back(
+              std::async(std::launch::async, [this]() { Run(); }));
+        }
+      }
+      bool failed;
+      {
+        std::lock_guard<std::mutex> guard(error_mutex_);
+        failed = static_cast<bool>(error_);
+      }
+      if (failed) {
+        // No point reading the rest of the db
+        Finish();
+      }
+      queue_.Push(task);
+      return;
+    }
+#endif
+    task();
+  }
+
+  // Waits for the tasks pushed so far, and rethrows the first exception
+  // raised by any of them.
+  void Finish() {
+#ifndef __ANDROID__
+    if (!futures_.empty()) {
+      queue_.NoMoreJobs();
+      for (auto& future : futures_) {
+        future.wait();
+      }
+      futures_.clear();
+    }
+    if (error_) {
+      std::exception_ptr error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+#endif
+  }
+
+ private:
+#ifndef __ANDROID__
+  void Run() {
+    std::function<void()> task;
+    while (queue_.Pop(&task)) {
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(error_mutex_);
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+      }
+    }
+  }
+
+  SimpleQueue<std::function<void()>> queue_;
+  std::vector<std::future<void>> futures_;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+#endif
+};
 } // namespace
 
 using db::Cursor;
@@ -206,6 +295,8 @@ class LoadOp final : public Operator<Context> {
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
     int loaded_blobs = 0;
+    const DeviceOption device_detail = currentDeviceDetail();
+    DeserializationQueue queue;
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = buildBlobNameFromDbKey(cursor->key());
       if (key_to_dbid_.count(key) && key_to_dbid_[key] != db_id) {
@@ -214,17 +305,17 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
-      BlobProto proto;
-      CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
-      if (!keep_device_) {
-        // If we are not keeping the device as the one specified in the
-        // proto, we will set the current device.
-        SetCurrentDevice(&proto);
-      }
       Blob* blob = ws_->CreateBlob(key);
-      ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+      LoadBlob(
+          &queue,
+          blob,
+          key,
+          cursor->value(),
+          device_detail,
+          blob_states,
+          &loaded_blobs);
     }
+    queue.Finish();
     *total_loaded_blobs += loaded_blobs;
   }
 
@@ -236,6 +327,8 @@ class LoadOp final : public Operator<Context> {
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor);
     int loaded_blobs = 0;
+    const DeviceOption device_detail = currentDeviceDetail();
+    DeserializationQueue queue;
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = buildBlobNameFromDbKey(cursor->key());
       if (!output_indices_.count(key)) {
@@ -248,26 +341,94 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
-        if (!keep_device_) {
-          // If we are not keeping the device as the one specified in the
-          // proto, we will set the current device.
-          SetCurrentDevice(&proto);
-        }
         auto blobIndex = output_indices_[key];
         Blob* blob = outputs.at(blobIndex);
-        ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
-
+        LoadBlob(
+            &queue,
+            blob,
+            key,
+            cursor->value(),
+            device_detail,
+            blob_states,
+            &loaded_blobs);
+
+        // The blobs still in the queue are not counted yet, so that this
+        // may read a few more keys than needed.
+        std::lock_guard<std::mutex> guard(state_mutex_);
         if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
           break;
         }
       }
     }
 
+    queue.Finish();
     *total_loaded_blobs += loaded_blobs;
   }
 
+  // The device detail SetCurrentDevice sets in the protos, computed on the
+  // thread running the op as it can depend on its current device.
+  DeviceOption currentDeviceDetail() {
+    BlobProto proto;
+    proto.mutable_tensor();
+    SetCurrentDevice(&proto);
+    return proto.tensor().device_detail();
+  }
+
+  // Parses and deserializes the blob read from a db on the threads of queue.
+  // The chunks of a tensor are copied concurrently into its memory, which the
+  // first of them to be processed allocates.
+  void LoadBlob(
+      DeserializationQueue* queue,
+      Blob* blob,
+      const string& key,
+      const string& value,
+      const DeviceOption& device_detail,
+      std::unordered_map<string, BlobState>* blob_states,
+      int* loaded_blobs) {
+    auto serialized = std::make_shared<const string>(value);
+    queue->Push([=]() {
+      BlobProto proto;
+      CAFFE_ENFORCE(proto.ParseFromString(*serialized), "Couldn't parse Proto");
+      if (!keep_device_ && proto.has_tensor()) {
+        // If we are not keeping the device as the one specified in the
+        // proto, we will set the current device.
+        *proto.mutable_tensor()->mutable_device_detail() = device_detail;
+      }
+      std::unique_lock<std::mutex> lock(state_mutex_);
+      ProcessBlob(blob, proto, blob_states, key, loaded_blobs);
+      if (isPrepared(*blob, proto)) {
+        lock.unlock();
+      }
+      DeserializeBlob(proto, blob);
+    });
+  }
+
+  // Whether proto is a chunk of a tensor that Deserialize can copy into blob
+  // without resizing or reallocating it, i.e. concurrently with the other
+  // chunks of the tensor.
+  static bool isPrepared(const Blob& blob, const BlobProto& proto) {
+    if (proto.type() != kTensorBlobType || !canPrepare(proto.tensor())) {
+      return false;
+    }
+    const auto& tensor_proto = proto.tensor();
+    const auto device_type =
+        static_cast<DeviceType>(tensor_proto.device_detail().device_type());
+    if (!BlobIsTensorType(blob, device_type)) {
+      return false;
+    }
+    const auto& tensor = blob.template Get<Tensor>();
+    const auto sizes = tensor.sizes();
+    return tensor.dtype_initialized() && tensor.storage_initialized() &&
+        tensor.dtype() == DataTypeToTypeMeta(tensor_proto.data_type()) &&
+        sizes.size() == tensor_proto.dims_size() &&
+        std::equal(sizes.begin(), sizes.end(), tensor_proto.dims().begin());
+  }
+
+  static bool canPrepare(const TensorProto& proto) {
+    return proto.data_type() != TensorProto_DataType_UNDEFINED &&
+        proto.data_type() != TensorProto_DataType_BYTE;
+  }
+
   string buildBlobNameFromDbKey(const string& dbKey) {
     string key = dbKey.substr(0, dbKey.find(kChunkIdSeparator));
     if (!strip_prefix_.empty()) {
@@ -283,6 +444,7 @@ class LoadOp final : public Operator<Context> {
  private:
   // We are tracking sizes of already read tensor parts while reading data
   // chunks. This way we can make sure that all chunks were loaded in the end.
+  // Called with state_mutex_ held, before the deserialization of proto.
   void ProcessBlob(
       Blob* blob,
       const BlobProto& proto,
@@ -297,8 +459,18 @@ class LoadOp final : public Operator<Context> {
       // into an existing TensorCUDA that has pre-allocated memory on a
       // different GPU.
       blob->Reset();
+      if (proto.type() == kTensorBlobType && canPrepare(proto.tensor())) {
+        // So that the other chunks of the tensor can be deserialized into it
+        // concurrently with this one.
+        const auto& tensor_proto = proto.tensor();
+        TensorDeserializer().Prepare(
+            tensor_proto,
+            BlobGetMutableTensor(
+                blob,
+                static_cast<DeviceType>(
+                    tensor_proto.device_detail().device_type())));
+      }
     }
-    DeserializeBlob(proto, blob);
     if (proto.has_content_num_chunks()) {
       if (!blob_states.count(key)) {
         blob_states[key] = BlobState(proto.content_num_chunks());
@@ -402,6 +574,9 @@ class LoadOp final : public Operator<Context> {
   std::map<string, int> output_indices_;
   std::map<string, int> key_to_dbid_;
   std::vector<std::string> blob_names_;
+  // Guards the blob states, and the blobs but for the concurrent
+  // deserialization of the chunks of prepared tensors.
+  std::mutex state_mutex_;
 };
 
 template <class Context>
@@ -1,5 +1,7 @@
 #include "caffe2/operators/onnxifi_op.h"
 
+#include <cstring>
+
 namespace caffe2 {
 
 namespace {
@@ -119,22 +121,63 @@ OnnxifiOp<float, CPUContext>::BuildInitializationList(
 template <>
 bool OnnxifiOp<float, CPUContext>::RunOnDevice() {
   CAFFE_ENFORCE_EQ(input_desc_.size(), InputSize());
+  // The buckets of the batch size, which the inputs are padded up to
+  onnxGraph graph = graph_;
+  int64_t batch_size = 0;
+  int64_t bucket = 0;
+  if (max_batch_size_ > 0) {
+    CAFFE_ENFORCE_GT(InputSize(), 0);
+    for (unsigned i = 0U; i < InputSize(); ++i) {
+      CAFFE_ENFORCE_GT(Input(i).ndim(), 0, "Input ", i, " has 0 dim");
+      if (i == 0) {
+        batch_size = Input(i).size(0);
+      } else {
+        CAFFE_ENFORCE_EQ(
+            batch_size, Input(i).size(0), "Mismatched batch size of inputs");
+      }
+    }
+    bucket = BatchBucket(batch_size);
+    graph = BucketGraph(bucket);
+  }
+  const bool padded = bucket != batch_size;
+
+  // The descriptors point into these
+  input_shapes_.clear();
+  input_shapes_.reserve(InputSize());
+  output_shapes_.clear();
+  output_shapes_.reserve(OutputSize());
+
   for (unsigned i = 0U; i < InputSize(); ++i) {
-    const auto& input_tensor = Input(i);
-    const auto tensor_dims = input_tensor.sizes();
+    const Tensor* input_tensor = &Input(i);
+    if (padded) {
+      auto& padded_tensor = padded_inputs_[i];
+      auto dims = input_tensor->sizes().vec();
+      dims.front() = bucket;
+      padded_tensor.Resize(dims);
+      auto* data = static_cast<char*>(
+          padded_tensor.raw_mutable_data(input_tensor->dtype()));
+      context_.CopyBytesSameDevice(
+          input_tensor->nbytes(), input_tensor->raw_data(), data);
+      std::memset(
+          data + input_tensor->nbytes(),
+          0,
+          padded_tensor.nbytes() - input_tensor->nbytes());
+      input_tensor = &padded_tensor;
+    }
+    const auto tensor_dims = input_tensor->sizes();
     auto& tensor_descriptor = input_desc_[i];
     tensor_descriptor.tag = ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1;
     tensor_descriptor.memoryType = ONNXIFI_MEMORY_TYPE_CPU;
     tensor_descriptor.dimensions = tensor_dims.size();
     input_shapes_.emplace_back(tensor_dims.cbegin(), tensor_dims.cend());
     tensor_descriptor.shape = input_shapes_.back().data();
-    SetInputTensorDescriptorTypeAndBuffer(input_tensor, &tensor_descriptor);
+    SetInputTensorDescriptorTypeAndBuffer(*input_tensor, &tensor_descriptor);
   }
 
   CAFFE_ENFORCE_EQ(output_desc_.size(), OutputSize());
   for (unsigned i = 0U; i < OutputSize(); ++i) {
     std::vector<size_t> tensor_dims;
-    uint64_t type = SetOutputShapeAndType(i, &tensor_dims);
+    uint64_t type = SetOutputShapeAndType(i, &tensor_dims, bucket);
     auto& tensor_descriptor = output_desc_[i];
     tensor_descriptor.tag = ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1;
     tensor_descriptor.memoryType = ONNXIFI_MEMORY_TYPE_CPU;
@@ -147,14 +190,23 @@ bool OnnxifiOp<float, CPUContext>::RunOnDevice() {
     tensor_descriptor.shape = output_shapes_.back().data();
     std::vector<int64_t> tensor_dims_int64;
     std::copy(tensor_dims.cbegin(), tensor_dims.cend(), std::back_inserter(tensor_dims_int64));
-    auto* output_tensor = Output(i, tensor_dims_int64, at::dtype(OnnixfiTypeToDataType(type)).device(CPU));
+    Tensor* output_tensor = nullptr;
+    if (padded) {
+      output_tensor = &padded_outputs_[i];
+      output_tensor->Resize(tensor_dims_int64);
+    } else {
+      output_tensor = Output(
+          i,
+          tensor_dims_int64,
+          at::dtype(OnnixfiTypeToDataType(type)).device(CPU));
+    }
     SetOutputTensorDescriptorTypeAndBuffer(
         type, output_tensor, &tensor_descriptor);
   }
 
   CAFFE_ENFORCE_EQ(
       lib_->onnxSetGraphIO(
-          graph_,
+          graph,
           input_desc_.size(),
           input_desc_.data(),
           output_desc_.size(),
@@ -176,7 +228,7 @@ bool OnnxifiOp<float, CPUContext>::RunOnDevice() {
   CAFFE_ENFORCE_EQ(
       lib_->onnxSignalEvent(input_fence.event), ONNXIFI_STATUS_SUCCESS);
   CAFFE_ENFORCE_EQ(
-      lib_->onnxRunGraph(graph_, &input_fence, &output_fence),
+      lib_->onnxRunGraph(graph, &input_fence, &output_fence),
       ONNXIFI_STATUS_SUCCESS);
   CAFFE_ENFORCE_EQ(
       lib_->onnxWaitEvent(output_fence.event), ONNXIFI_STATUS_SUCCESS);
@@ -187,6 +239,20 @@ bool OnnxifiOp<float, CPUContext>::RunOnDevice() {
   CAFFE_ENFORCE_EQ(
       lib_->onnxReleaseEvent(output_fence.event), ONNXIFI_STATUS_SUCCESS);
 
+  // Cut the outputs back to the batch size of the inputs
+  if (padded) {
+    for (unsigned i = 0U; i < OutputSize(); ++i) {
+      const auto& padded_tensor = padded_outputs_[i];
+      auto dims = padded_tensor.sizes().vec();
+      dims.front() = batch_size;
+      auto* output_tensor =
+          Output(i, dims, at::dtype(padded_tensor.dtype()).device(CPU));
+      context_.CopyBytesSameDevice(
+          output_tensor->nbytes(),
+          padded_tensor.raw_data(),
+          output_tensor->raw_mutable_data(padded_tensor.dtype()));
+    }
+  }
   return true;
 }
 
@@ -202,5 +268,11 @@ OPERATOR_SCHEMA(Onnxifi)
         "(string default=\"\") Serialized ONNX model to be converted to backend representation")
     .Arg(
         "initializers",
-        "Initialization pair indicating the mapping of the name between NetDef and ONNX model");
+        "Initialization pair indicating the mapping of the name between NetDef and ONNX model")
+    .Arg(
+        "max_batch_size",
+        "(int default 0) If set, the first dimension of the inputs and the "
+        "outputs is the batch size, which can vary up to max_batch_size. A "
+        "graph is built and cached for each power of two batch size, and "
+        "the inputs are padded with zeros up to the next power of two.");
 } // namespace caffe2
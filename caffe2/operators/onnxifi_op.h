@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "onnx/onnx_pb.h"
 
@@ -8,6 +10,7 @@
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/onnx/onnxifi_init.h"
+#include "caffe2/utils/proto_utils.h"
 #include "caffe2/utils/string_utils.h"
 
 namespace caffe2 {
@@ -25,7 +28,9 @@ class OnnxifiOp final : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   OnnxifiOp(const OperatorDef& operator_def, Workspace* ws)
-      : Operator<Context>(operator_def, ws) {
+      : Operator<Context>(operator_def, ws),
+        max_batch_size_(
+            this->template GetSingleArgument<int>("max_batch_size", 0)) {
     lib_ = onnx::initOnnxifiLibrary();
     CAFFE_ENFORCE(lib_, "Cannot initialize ONNXIFI library");
     auto onnx_model_str =
@@ -42,11 +47,13 @@ class OnnxifiOp final : public Operator<Context> {
     for (const auto& input : input_names_) {
       input_desc_.push_back(onnxTensorDescriptorV1());
       input_desc_.back().name = input.c_str();
+      padded_inputs_.emplace_back(CPU);
     }
     int output_idx = 0;
     for (const auto& output : output_names_) {
       output_desc_.push_back(onnxTensorDescriptorV1());
       output_desc_.back().name = output.c_str();
+      padded_outputs_.emplace_back(CPU);
 
       // For output, we try to get its output size hint
       const std::string key = c10::str("output_shape_hint_", output_idx);
@@ -83,10 +90,8 @@ class OnnxifiOp final : public Operator<Context> {
       initializer_set.emplace(key);
     }
     Workspace mapped_ws(ws, input_mapping);
-    std::vector<std::string> weight_names;
-    std::vector<std::vector<uint64_t>> weight_shapes;
-    auto weight_descs = BuildInitializationList(
-        &mapped_ws, &initializer_set, &weight_names, &weight_shapes);
+    weight_descs_ = BuildInitializationList(
+        &mapped_ws, &initializer_set, &weight_names_, &weight_shapes_);
 
     // Build the Onnxifi engine
     // TODO: In spec, backends are hot-pluggable, so two calls to
@@ -107,16 +112,16 @@ class OnnxifiOp final : public Operator<Context> {
         lib_->onnxInitBackend(
             backend_ids_[0], property_pointers.data(), &backend_),
         ONNXIFI_STATUS_SUCCESS);
-    CAFFE_ENFORCE_EQ(
-        lib_->onnxInitGraph(
-            backend_,
-            nullptr,
-            onnx_model_str.size(),
-            (void*)(onnx_model_str.c_str()),
-            weight_descs.size(),
-            weight_descs.data(),
-            &graph_),
-        ONNXIFI_STATUS_SUCCESS);
+
+    // With a max_batch_size, the graphs are built on first use, for the
+    // bucket of the batch size of the inputs
+    if (max_batch_size_ > 0) {
+      CAFFE_ENFORCE(
+          ParseProtoFromLargeString(onnx_model_str, &onnx_model_),
+          "Cannot parse onnx_model");
+    } else {
+      graph_ = InitGraph(onnx_model_str);
+    }
   }
 
   ~OnnxifiOp() {
@@ -126,6 +131,12 @@ class OnnxifiOp final : public Operator<Context> {
       }
       graph_ = nullptr;
     }
+    for (const auto& kv : bucket_graphs_) {
+      if (lib_->onnxReleaseGraph(kv.second) != ONNXIFI_STATUS_SUCCESS) {
+        LOG(ERROR) << "Error when calling onnxReleaseGraph";
+      }
+    }
+    bucket_graphs_.clear();
     if (backend_) {
       if (lib_->onnxReleaseBackend(backend_) != ONNXIFI_STATUS_SUCCESS) {
         LOG(ERROR) << "Error when calling onnxReleaseBackend";
@@ -142,7 +153,11 @@ class OnnxifiOp final : public Operator<Context> {
   bool RunOnDevice() override;
 
  private:
-  uint64_t SetOutputShapeAndType(int output_idx, std::vector<size_t>* dims) {
+  // With a batch_size, the first dimension of the hint is replaced by it
+  uint64_t SetOutputShapeAndType(
+      int output_idx,
+      std::vector<size_t>* dims,
+      int64_t batch_size = 0) {
     uint64_t type = ONNXIFI_DATATYPE_FLOAT32;
     const auto it = output_shape_hints_.find(output_idx);
     if (it != output_shape_hints_.end()) {
@@ -151,10 +166,77 @@ class OnnxifiOp final : public Operator<Context> {
           it->second.dims.end(),
           std::back_inserter(*dims));
       type = it->second.onnxifi_type;
+      if (batch_size > 0 && !dims->empty()) {
+        dims->front() = batch_size;
+      }
     }
     return type;
   }
 
+  onnxGraph InitGraph(const std::string& onnx_model_str) {
+    onnxGraph graph{nullptr};
+    CAFFE_ENFORCE_EQ(
+        lib_->onnxInitGraph(
+            backend_,
+            nullptr,
+            onnx_model_str.size(),
+            (void*)(onnx_model_str.c_str()),
+            weight_descs_.size(),
+            weight_descs_.data(),
+            &graph),
+        ONNXIFI_STATUS_SUCCESS);
+    return graph;
+  }
+
+  // The batch sizes are rounded up to powers of two, so that there are only
+  // a few graphs to build however the batch size varies. The inputs are
+  // padded with zeros to the size of their bucket.
+  int64_t BatchBucket(int64_t batch_size) const {
+    CAFFE_ENFORCE_LE(
+        batch_size,
+        max_batch_size_,
+        "Batch size is larger than the max_batch_size of the Onnxifi op");
+    int64_t bucket = 1;
+    while (bucket < batch_size) {
+      bucket <<= 1;
+    }
+    return std::min(bucket, max_batch_size_);
+  }
+
+  // Builds the graph for a bucket on first use, from the ONNX model with the
+  // first dimension of its inputs and outputs set to the bucket.
+  onnxGraph BucketGraph(int64_t bucket) {
+    const auto it = bucket_graphs_.find(bucket);
+    if (it != bucket_graphs_.end()) {
+      return it->second;
+    }
+    VLOG(1) << "Building Onnxifi graph for batch size " << bucket;
+    ::ONNX_NAMESPACE::ModelProto model(onnx_model_);
+    std::unordered_set<std::string> weights(
+        weight_names_.begin(), weight_names_.end());
+    auto set_batch_size = [bucket](::ONNX_NAMESPACE::ValueInfoProto* info) {
+      auto* shape =
+          info->mutable_type()->mutable_tensor_type()->mutable_shape();
+      if (shape->dim_size() > 0) {
+        shape->mutable_dim(0)->set_dim_value(bucket);
+      }
+    };
+    auto* graph = model.mutable_graph();
+    for (auto& input : *graph->mutable_input()) {
+      if (!weights.count(input.name())) {
+        set_batch_size(&input);
+      }
+    }
+    for (auto& output : *graph->mutable_output()) {
+      set_batch_size(&output);
+    }
+    std::string model_str;
+    model.SerializeToString(&model_str);
+    auto bucket_graph = InitGraph(model_str);
+    bucket_graphs_.emplace(bucket, bucket_graph);
+    return bucket_graph;
+  }
+
   void BuildPropertyList(
       const OperatorDef& /* unused */,
       std::vector<uint64_t>* property_list,
@@ -177,6 +259,17 @@ class OnnxifiOp final : public Operator<Context> {
   onnxGraph graph_{nullptr};
   size_t num_backends_{0};
 
+  // The model and the graphs built from it for each batch size bucket, if
+  // the batch size is allowed to vary up to max_batch_size
+  int64_t max_batch_size_;
+  ::ONNX_NAMESPACE::ModelProto onnx_model_;
+  std::unordered_map<int64_t, onnxGraph> bucket_graphs_;
+
+  // The weights, which the descriptors point into, kept for these builds
+  std::vector<std::string> weight_names_;
+  std::vector<std::vector<uint64_t>> weight_shapes_;
+  std::vector<onnxTensorDescriptorV1> weight_descs_;
+
   // input/output descriptors
   std::vector<onnxTensorDescriptorV1> input_desc_;
   std::vector<onnxTensorDescriptorV1> output_desc_;
@@ -191,6 +284,11 @@ class OnnxifiOp final : public Operator<Context> {
   std::vector<std::vector<uint64_t>> input_shapes_;
   std::vector<std::vector<uint64_t>> output_shapes_;
 
+  // The inputs padded up to the batch size of their bucket, and the outputs
+  // before they are cut back to the batch size of the inputs.
+  std::vector<Tensor> padded_inputs_;
+  std::vector<Tensor> padded_outputs_;
+
   // output shape hints
   std::unordered_map<int, TensorInfo> output_shape_hints_;
 };
@@ -78,6 +78,7 @@ REGISTER_CPU_GRADIENT_OPERATOR(
 OPERATOR_SCHEMA(Relu)
     .NumInputs(1)
     .NumOutputs(1)
+    .StorageOrderAgnostic()
     .AllowInplace({{0, 0}})
     .CostInferenceFunction(CostInferenceForRelu)
     .IdenticalTypeAndShape()
@@ -1,5 +1,8 @@
 #include "caffe2/operators/rnn/recurrent_network_executor.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "caffe2/core/timer.h"
 
 namespace caffe2 {
@@ -35,21 +38,7 @@ bool ThreadedRecurrentNetworkExecutor::Run(int T) {
   if (T == 0) {
     return true;
   }
-
-  CAFFE_ENFORCE(timestep_ops_.size() >= T);
-  countdown_ = T * timestep_ops_[0].size();
-  finished_timesteps_ = 0;
-
-  CHECK(task_queue_.size() == 0);
-
-  for (auto& rnn_op : timestep_ops_[0]) {
-    // Launch "frontier"-ops first.
-    if (rnn_op.frontier) {
-      task_queue_.Push(OpTask(0, rnn_op.order, T, 1));
-    }
-  }
-
-  _Exec();
+  _ExecRange(0, T);
   return true;
 }
 
@@ -61,22 +50,40 @@ bool ThreadedRecurrentNetworkExecutor::RunBackwards(int T) {
   if (T == 0) {
     return true;
   }
+  _ExecRange(T - 1, -1);
+  return true;
+}
 
-  CAFFE_ENFORCE(timestep_ops_.size() >= T);
-  countdown_ = T * timestep_ops_[0].size();
+bool ThreadedRecurrentNetworkExecutor::RunRange(int from, int to) {
+  CAFFE_ENFORCE_GE(from, -1, "Negative timestep");
+  CAFFE_ENFORCE_GE(to, -1, "Negative timestep");
+  if (from == to) {
+    return true;
+  }
+  _ExecRange(from, to);
+  return true;
+}
+
+/**
+ * Launches the frontier ops of the first timestep, and waits until all
+ * the ops of the range have run.
+ */
+void ThreadedRecurrentNetworkExecutor::_ExecRange(int from, int to) {
+  const int direction = to > from ? 1 : -1;
+  CAFFE_ENFORCE(timestep_ops_.size() >= std::max(from, to - direction) + 1);
+  countdown_ = std::abs(to - from) * timestep_ops_[from].size();
   finished_timesteps_ = 0;
 
-  // Frontier
   CHECK(task_queue_.size() == 0);
 
-  for (auto& rnn_op : timestep_ops_[T - 1]) {
+  for (auto& rnn_op : timestep_ops_[from]) {
+    // Launch "frontier"-ops first.
     if (rnn_op.frontier) {
-      task_queue_.Push(OpTask(T - 1, rnn_op.order, T, -1));
+      task_queue_.Push(OpTask(from, rnn_op.order, from, to));
     }
   }
 
   _Exec();
-  return true;
 }
 
 /**
@@ -84,12 +91,8 @@ bool ThreadedRecurrentNetworkExecutor::RunBackwards(int T) {
  * dependent ops are ready to run, adds them to the task_queue.
  */
 void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
-  bool first_timestep =
-      ((job.forward() && job.timestep == 0) ||
-       (job.backward() && job.timestep == job.T - 1));
-  bool last_timestep =
-      ((job.backward() && job.timestep == 0) ||
-       (job.forward() && job.timestep == job.T - 1));
+  bool first_timestep = job.first_timestep();
+  bool last_timestep = job.last_timestep();
   auto& rnn_op = timestep_ops_[job.timestep][job.op_idx];
   if (rnn_op.num_dynamic_inputs > 0 && !rnn_op.frontier) {
     CAFFE_ENFORCE_EQ(
@@ -100,8 +103,10 @@ void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
         job.op_idx,
         " on timestep ",
         job.timestep,
-        " T=",
-        job.T,
+        " from=",
+        job.from,
+        " to=",
+        job.to,
         " first =",
         first_timestep);
   }
@@ -134,7 +139,7 @@ void ThreadedRecurrentNetworkExecutor::RunOp(OpTask job, int /*thread_id*/) {
     }
 
     if (proc_inputs == num_req_inputs || num_req_inputs == 0) {
-      task_queue_.Push(OpTask(t, depidx, job.T, job.direction));
+      task_queue_.Push(OpTask(t, depidx, job.from, job.to));
     }
   }
 
@@ -165,7 +170,7 @@ void ThreadedRecurrentNetworkExecutor::WorkerFunction() {
     // Check for limited timestep parallelism, and if too many timesteps would
     // be started concurrently, return the task to task queue.
     if (max_parallel_timesteps_ > 0) {
-      int t = (job.direction == 1 ? job.timestep : job.T - job.timestep + 1);
+      int t = (job.timestep - job.from) * job.direction;
       if (t - finished_timesteps_ >= max_parallel_timesteps_) {
         // Return to queue
         task_queue_.Push(job);
@@ -195,7 +200,7 @@ void ThreadedRecurrentNetworkExecutor::WorkerFunction() {
 
 /**
  * Start worker threads if not started yet, wait until all tasks
- * finished, or a failure. Called by Run() and RunBackwards().
+ * finished, or a failure. Called by _ExecRange().
  */
 void ThreadedRecurrentNetworkExecutor::_Exec() {
   CAFFE_ENFORCE_EQ(
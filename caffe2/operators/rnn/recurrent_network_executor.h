@@ -55,6 +55,15 @@ class RecurrentNetworkExecutorBase {
 
   virtual bool RunBackwards(int T) = 0;
 
+  /**
+   * Runs the timesteps from, from + 1, ..., to - 1 if from < to, or from,
+   * from - 1, ..., to + 1 otherwise. The recurrent inputs of the first of
+   * them must have been computed by a previous execution. This is used to run
+   * the backward pass one segment of timesteps at a time, when the forward
+   * activations of each segment are recomputed before its backward pass.
+   */
+  virtual bool RunRange(int from, int to) = 0;
+
   /**
    * Callers must call EnsureTimestepInitialized before starting execution
    * for each of the relevant timesteps. If timestep was initialized before,
@@ -487,6 +496,8 @@ class CAFFE2_API ThreadedRecurrentNetworkExecutor : public RecurrentNetworkExecu
 
   bool RunBackwards(int T) override;
 
+  bool RunRange(int from, int to) override;
+
   bool ignoreLinkDependencies() override {
     return false;
   }
@@ -51,8 +51,7 @@ void CUDARecurrentNetworkExecutor::_ExecRange(int from, int to) {
   // Loop over timesteps
   for (int t = from; t != to; t += direction) {
     bool first_timestep = t == from;
-    bool last_timestep =
-        (direction == -1 && t == 0) || (direction == 1 && t == to - 1);
+    bool last_timestep = t == to - direction;
     auto& ops = timestep_ops_[t];
     int stream_id = stream_seq % max_streams;
 
@@ -152,4 +151,14 @@ bool CUDARecurrentNetworkExecutor::RunBackwards(int T) {
   _ExecRange(T - 1, -1);
   return true;
 }
+
+bool CUDARecurrentNetworkExecutor::RunRange(int from, int to) {
+  CAFFE_ENFORCE_GE(from, -1, "Negative timestep");
+  CAFFE_ENFORCE_GE(to, -1, "Negative timestep");
+  if (from == to) {
+    return true;
+  }
+  _ExecRange(from, to);
+  return true;
+}
 }
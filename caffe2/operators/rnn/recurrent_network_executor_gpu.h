@@ -24,6 +24,8 @@ class CUDARecurrentNetworkExecutor : public RecurrentNetworkExecutorBase {
 
   bool RunBackwards(int T) override;
 
+  bool RunRange(int from, int to) override;
+
   bool ignoreLinkDependencies() override {
     return true;
   }
@@ -51,14 +51,20 @@ struct RNNNetOperator {
 struct OpTask {
   int timestep;
   int op_idx; // matches RNNNetOperator.order
-  int T; // number of timesteps in this execution
+  int from; // first timestep of this execution
+  int to; // timestep following the last one of this execution
   int direction; // +1 for forward, -1 for backward pass
   int stream_id = -1; // only used by gpu version
   OpTask() {}
-  OpTask(int _timestep, int _op_idx, int _T, int _direction)
-      : timestep(_timestep), op_idx(_op_idx), T(_T), direction(_direction) {
-    CAFFE_ENFORCE(direction == 1 || direction == -1);
-    CAFFE_ENFORCE(timestep >= 0 && timestep < _T);
+  OpTask(int _timestep, int _op_idx, int _from, int _to)
+      : timestep(_timestep),
+        op_idx(_op_idx),
+        from(_from),
+        to(_to),
+        direction(_to > _from ? 1 : -1) {
+    CAFFE_ENFORCE(from != to);
+    CAFFE_ENFORCE(
+        (timestep - from) * direction >= 0 && (to - timestep) * direction > 0);
   }
 
   inline bool backward() {
@@ -67,6 +73,12 @@ struct OpTask {
   inline bool forward() {
     return direction == 1;
   }
+  inline bool first_timestep() {
+    return timestep == from;
+  }
+  inline bool last_timestep() {
+    return timestep == to - direction;
+  }
 };
 
 } // namespace caffe2
@@ -191,6 +191,8 @@ class RecurrentNetworkOp final : public Operator<Context> {
         timestep_(this->template GetSingleArgument<std::string>(
             "timestep",
             "timestep")),
+        recomputeInterval_(
+            this->template GetSingleArgument<int>("recompute_interval", 0)),
         operator_def_(operator_def) {
     CAFFE_ENFORCE(ws);
 
@@ -321,7 +323,16 @@ class RecurrentNetworkOp final : public Operator<Context> {
     // have to be stored in step workspaces but can be shared.
     initializeBlobsToRecomputeOnBackward(sharedBlobsWs.get());
 
-    if (has_backward_pass && seqLen > stepWorkspaces.size()) {
+    // With a recompute_interval of k, only the activations of the last k
+    // timesteps are kept, in k step workspaces that the timesteps cycle
+    // over. The gradient op recomputes the activations of each segment of k
+    // timesteps from the recurrent states before running its backward pass.
+    const bool recompute = has_backward_pass && recomputeInterval_ > 0;
+    if (recompute) {
+      if (recomputeInterval_ > stepWorkspaces.size()) {
+        stepWorkspaces.resize(recomputeInterval_);
+      }
+    } else if (has_backward_pass && seqLen > stepWorkspaces.size()) {
       stepWorkspaces.resize(seqLen);
     }
 
@@ -338,16 +349,19 @@ class RecurrentNetworkOp final : public Operator<Context> {
     }
 
     for (auto t = 0; t < seqLen; ++t) {
-      auto& currentStepWorkspace =
-          (has_backward_pass ? stepWorkspaces[t] :
-              stepWorkspaces[t % num_workspaces_on_fwd_only]);
+      auto& currentStepWorkspace = recompute
+          ? stepWorkspaces[t % recomputeInterval_]
+          : (has_backward_pass ? stepWorkspaces[t]
+                               : stepWorkspaces[t % num_workspaces_on_fwd_only]);
       if (!currentStepWorkspace) {
         currentStepWorkspace = std::make_shared<Workspace>(sharedBlobsWs.get());
       }
 
       if (rnnExecutor_) {
-        if (!has_backward_pass) {
-          // Need to limit timestep parallelism because we cycle over workspaces
+        // Need to limit timestep parallelism when we cycle over workspaces
+        if (recompute) {
+          rnnExecutor_->SetMaxParallelTimesteps(recomputeInterval_);
+        } else if (!has_backward_pass) {
           rnnExecutor_->SetMaxParallelTimesteps(num_workspaces_on_fwd_only);
         }
         rnnExecutor_->EnsureTimestepInitialized(
@@ -400,6 +414,7 @@ class RecurrentNetworkOp final : public Operator<Context> {
   std::vector<detail::OffsetAlias> aliases_;
   std::vector<detail::RecurrentInput> recurrentInputs_;
   std::string timestep_;
+  int recomputeInterval_;
   OperatorDef operator_def_;
 
  private:
@@ -425,11 +440,31 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
         timestep_(this->template GetSingleArgument<std::string>(
             "timestep",
             "timestep")),
+        recomputeInterval_(
+            this->template GetSingleArgument<int>("recompute_interval", 0)),
         gradInputs_(this->template GetRepeatedArgument<int32_t>(
             "outputs_with_grads")) {
     CAFFE_ENFORCE(ws);
 
     stepNetDef_ = detail::extractNetDef(operator_def, "backward_step_net");
+    if (recomputeInterval_ > 0) {
+      // The forward step net, as run by RecurrentNetworkOp, to recompute the
+      // activations of the forward pass.
+      forwardStepNetDef_ = detail::extractNetDef(operator_def, "step_net");
+      detail::extractLinks(
+          this,
+          "link_internal",
+          "link_external",
+          "link_offset",
+          "link_window",
+          &forwardLinks_);
+      forwardStepNetDef_.add_external_input(timestep_);
+      detail::AddApplyLinkOps(
+          forwardLinks_,
+          timestep_,
+          operator_def.device_option(),
+          &forwardStepNetDef_);
+    }
 
     links_ = constructLinks();
     params_ = constructParams(operator_def);
@@ -577,6 +612,81 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
     auto recurrent_map = detail::GetRecurrentMapping(links_, true /* backward */);
     rnnExecutor_ = createRNNExecutor<Context>(
       stepNetDef_, recurrent_map, timestep_, ArgumentHelper(operator_def));
+    if (recomputeInterval_ > 0) {
+      auto forward_recurrent_map =
+          detail::GetRecurrentMapping(forwardLinks_, false /* backward */);
+      forwardExecutor_ = createRNNExecutor<Context>(
+          forwardStepNetDef_,
+          forward_recurrent_map,
+          timestep_,
+          ArgumentHelper(operator_def));
+    }
+  }
+
+  Workspace* stepWorkspace(
+      const std::vector<std::shared_ptr<Workspace>>& stepWorkspaces,
+      int32_t t) {
+    return stepWorkspaces[recomputeInterval_ > 0 ? t % recomputeInterval_ : t]
+        .get();
+  }
+
+  /**
+    * Runs the forward step net over the timesteps [begin, end), to recompute
+    * their activations in the step workspaces.
+    */
+  void RecomputeForward(
+      int32_t begin,
+      int32_t end,
+      const std::vector<std::shared_ptr<Workspace>>& stepWorkspaces) {
+    for (int32_t t = begin; t < end; ++t) {
+      Workspace* stepWs = stepWorkspace(stepWorkspaces, t);
+      if (forwardExecutor_) {
+        forwardExecutor_->EnsureTimestepInitialized(
+            t, stepWs, this->observers_list_);
+      } else {
+        detail::UpdateTimestepBlob(stepWs, timestep_, t);
+        auto* stepNet = stepWs->GetNet(forwardStepNetDef_.name());
+        if (stepNet == nullptr) {
+          stepNet = stepWs->CreateNet(forwardStepNetDef_);
+        }
+        CAFFE_ENFORCE(stepNet, "Step Net construction failure");
+        stepNet->RunAsync();
+      }
+    }
+    if (forwardExecutor_) {
+      forwardExecutor_->RunRange(begin, end);
+    }
+  }
+
+  /**
+    * Runs the backward step net over the timesteps [begin, end), from the
+    * last one, given the gradients of the recurrent states at end.
+    */
+  void RunBackward(
+      int32_t begin,
+      int32_t end,
+      const std::vector<std::shared_ptr<Workspace>>& stepWorkspaces) {
+    for (int32_t t = end - 1; t >= begin; --t) {
+      Workspace* stepWs = stepWorkspace(stepWorkspaces, t);
+      if (rnnExecutor_) {
+        rnnExecutor_->EnsureTimestepInitialized(
+            t, stepWs, this->observers_list_);
+      } else {
+        if (recomputeInterval_ > 0) {
+          // The workspace was last used by another timestep
+          detail::UpdateTimestepBlob(stepWs, timestep_, t);
+        }
+        auto* stepNet = stepWs->GetNet(stepNetDef_.name());
+        if (stepNet == nullptr) {
+          stepNet = stepWs->CreateNet(stepNetDef_);
+        }
+        CAFFE_ENFORCE(stepNet);
+        stepNet->RunAsync();
+      }
+    }
+    if (rnnExecutor_) {
+      rnnExecutor_->RunRange(end - 1, begin - 1);
+    }
   }
 
   void AddGradientInputAccumulationOps(const OperatorDef& operator_def) {
@@ -664,7 +774,10 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
         this->template Input<detail::ScratchWorkspaces>(InputSize() - 1);
     const std::vector<std::shared_ptr<Workspace>>& stepWorkspaces =
         scratch.stepWorkspaces;
-    CAFFE_ENFORCE_GE(stepWorkspaces.size(), seqLen);
+    CAFFE_ENFORCE_GE(
+        stepWorkspaces.size(),
+        recomputeInterval_ > 0 ? std::min(seqLen, recomputeInterval_)
+                               : seqLen);
     Workspace& sharedBlobsWs = *scratch.sharedBlobsWs.get();
 
     const auto batchSize = Input(0).dim32(1);
@@ -761,22 +874,20 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
     if (stepWorkspaces.size() > 0) {
       CreateSharedBlobs(stepWorkspaces[0], &sharedBlobsWs);
     }
-    for (int32_t t = seqLen - 1; t >= 0; --t) {
-      if (rnnExecutor_) {
-        rnnExecutor_->EnsureTimestepInitialized(
-            t, stepWorkspaces[t].get(), this->observers_list_);
-      } else {
-        auto* stepNet = stepWorkspaces[t].get()->GetNet(stepNetDef_.name());
-        if (stepNet == nullptr) {
-          stepNet = stepWorkspaces[t].get()->CreateNet(stepNetDef_);
-        }
-        CAFFE_ENFORCE(stepNet);
-        stepNet->RunAsync();
+    if (recomputeInterval_ > 0) {
+      // The step workspaces only hold the activations of recomputeInterval_
+      // timesteps. Recompute those of each segment of that many timesteps,
+      // from the last one, before running its backward pass. The forward
+      // step net has to be deterministic for this.
+      for (int32_t end = seqLen; end > 0;) {
+        const int32_t begin =
+            (end - 1) / recomputeInterval_ * recomputeInterval_;
+        RecomputeForward(begin, end, stepWorkspaces);
+        RunBackward(begin, end, stepWorkspaces);
+        end = begin;
       }
-    }
-
-    if (rnnExecutor_) {
-      rnnExecutor_->RunBackwards(seqLen);
+    } else {
+      RunBackward(0, seqLen, stepWorkspaces);
     }
 
     CAFFE_ENFORCE_EQ(recurrentInputIds_.size(), recurrentGradients_.size());
@@ -840,6 +951,12 @@ class RecurrentNetworkGradientOp final : public Operator<Context> {
   std::vector<detail::Param> params_;
   std::vector<detail::RecurrentGradient> recurrentGradients_;
   std::string timestep_;
+  // Recomputation of the activations of the forward pass, see
+  // RecurrentNetworkOp
+  int recomputeInterval_;
+  NetDef forwardStepNetDef_;
+  std::vector<detail::Link> forwardLinks_;
+  std::unique_ptr<RecurrentNetworkExecutorBase> forwardExecutor_;
   // For now we support only one input sequence
   const int numSequences_{1};
   std::vector<int32_t> recurrentInputIds_;
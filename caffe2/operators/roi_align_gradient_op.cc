@@ -3,6 +3,8 @@
 #include "caffe2/utils/eigen_utils.h"
 #include "caffe2/utils/math.h"
 
+#include <ATen/Parallel.h>
+
 namespace caffe2 {
 namespace {
 
@@ -74,11 +76,12 @@ inline void add(const T& val, T* address) {
   *address += val;
 }
 
+// Scatters the gradient of the RoIs in [roi_begin, roi_end) into bottom_diff.
 template <typename T>
-void ROIAlignBackwardFeature(
-    const int nthreads,
+void ROIAlignBackwardRoIs(
+    const int roi_begin,
+    const int roi_end,
     const T* top_diff,
-    const int /*num_rois*/,
     const T& spatial_scale,
     const int channels,
     const int height,
@@ -89,15 +92,7 @@ void ROIAlignBackwardFeature(
     T* bottom_diff,
     const T* bottom_rois,
     int rois_cols) {
-  DCHECK(rois_cols == 4 || rois_cols == 5);
-
-  for (int index = 0; index < nthreads; index++) {
-    // (n, c, ph, pw) is an element in the pooled output
-    int pw = index % pooled_width;
-    int ph = (index / pooled_width) % pooled_height;
-    int c = (index / pooled_width / pooled_height) % channels;
-    int n = index / pooled_width / pooled_height / channels;
-
+  for (int n = roi_begin; n < roi_end; n++) {
     const T* offset_bottom_rois = bottom_rois + n * rois_cols;
     int roi_batch_ind = 0;
     if (rois_cols == 5) {
@@ -110,10 +105,6 @@ void ROIAlignBackwardFeature(
     T roi_start_h = offset_bottom_rois[1] * spatial_scale;
     T roi_end_w = offset_bottom_rois[2] * spatial_scale;
     T roi_end_h = offset_bottom_rois[3] * spatial_scale;
-    // T roi_start_w = round(offset_bottom_rois[0] * spatial_scale);
-    // T roi_start_h = round(offset_bottom_rois[1] * spatial_scale);
-    // T roi_end_w = round(offset_bottom_rois[2] * spatial_scale);
-    // T roi_end_h = round(offset_bottom_rois[3] * spatial_scale);
 
     // Force malformed ROIs to be 1x1
     T roi_width = std::max(roi_end_w - roi_start_w, (T)1.);
@@ -121,13 +112,6 @@ void ROIAlignBackwardFeature(
     T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
     T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
 
-    T* offset_bottom_diff =
-        bottom_diff + (roi_batch_ind * channels + c) * height * width;
-
-    int top_offset = (n * channels + c) * pooled_height * pooled_width;
-    const T* offset_top_diff = top_diff + top_offset;
-    const T top_diff_this_bin = offset_top_diff[ph * pooled_width + pw];
-
     // We use roi_bin_grid to sample the grid and mimic integral
     int roi_bin_grid_h = (sampling_ratio > 0)
         ? sampling_ratio
@@ -138,48 +122,126 @@ void ROIAlignBackwardFeature(
     // We do average (integral) pooling inside a bin
     const T count = roi_bin_grid_h * roi_bin_grid_w; // e.g. = 4
 
-    for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-      const T y = roi_start_h + ph * bin_size_h +
-          static_cast<T>(iy + .5f) * bin_size_h /
-              static_cast<T>(roi_bin_grid_h); // e.g., 0.5, 1.5
-      for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-        const T x = roi_start_w + pw * bin_size_w +
-            static_cast<T>(ix + .5f) * bin_size_w /
-                static_cast<T>(roi_bin_grid_w);
-
-        T w1, w2, w3, w4;
-        int x_low, x_high, y_low, y_high;
-
-        bilinear_interpolate_gradient(
-            height,
-            width,
-            y,
-            x,
-            w1,
-            w2,
-            w3,
-            w4,
-            x_low,
-            x_high,
-            y_low,
-            y_high,
-            index);
-
-        T g1 = top_diff_this_bin * w1 / count;
-        T g2 = top_diff_this_bin * w2 / count;
-        T g3 = top_diff_this_bin * w3 / count;
-        T g4 = top_diff_this_bin * w4 / count;
-
-        if (x_low >= 0 && x_high >= 0 && y_low >= 0 && y_high >= 0) {
-          // atomic add is not needed for now since it is single threaded
-          add(static_cast<T>(g1), offset_bottom_diff + y_low * width + x_low);
-          add(static_cast<T>(g2), offset_bottom_diff + y_low * width + x_high);
-          add(static_cast<T>(g3), offset_bottom_diff + y_high * width + x_low);
-          add(static_cast<T>(g4), offset_bottom_diff + y_high * width + x_high);
-        } // if
-      } // ix
-    } // iy
-  } // for
+    for (int c = 0; c < channels; c++) {
+      T* offset_bottom_diff =
+          bottom_diff + (roi_batch_ind * channels + c) * height * width;
+
+      int top_offset = (n * channels + c) * pooled_height * pooled_width;
+      const T* offset_top_diff = top_diff + top_offset;
+
+      for (int ph = 0; ph < pooled_height; ph++) {
+        for (int pw = 0; pw < pooled_width; pw++) {
+          const T top_diff_this_bin = offset_top_diff[ph * pooled_width + pw];
+
+          for (int iy = 0; iy < roi_bin_grid_h; iy++) {
+            const T y = roi_start_h + ph * bin_size_h +
+                static_cast<T>(iy + .5f) * bin_size_h /
+                    static_cast<T>(roi_bin_grid_h); // e.g., 0.5, 1.5
+            for (int ix = 0; ix < roi_bin_grid_w; ix++) {
+              const T x = roi_start_w + pw * bin_size_w +
+                  static_cast<T>(ix + .5f) * bin_size_w /
+                      static_cast<T>(roi_bin_grid_w);
+
+              T w1, w2, w3, w4;
+              int x_low, x_high, y_low, y_high;
+
+              bilinear_interpolate_gradient(
+                  height,
+                  width,
+                  y,
+                  x,
+                  w1,
+                  w2,
+                  w3,
+                  w4,
+                  x_low,
+                  x_high,
+                  y_low,
+                  y_high,
+                  top_offset + ph * pooled_width + pw);
+
+              T g1 = top_diff_this_bin * w1 / count;
+              T g2 = top_diff_this_bin * w2 / count;
+              T g3 = top_diff_this_bin * w3 / count;
+              T g4 = top_diff_this_bin * w4 / count;
+
+              if (x_low >= 0 && x_high >= 0 && y_low >= 0 && y_high >= 0) {
+                // atomic add is not needed: each thread scatters into a
+                // bottom_diff of its own
+                add(static_cast<T>(g1),
+                    offset_bottom_diff + y_low * width + x_low);
+                add(static_cast<T>(g2),
+                    offset_bottom_diff + y_low * width + x_high);
+                add(static_cast<T>(g3),
+                    offset_bottom_diff + y_high * width + x_low);
+                add(static_cast<T>(g4),
+                    offset_bottom_diff + y_high * width + x_high);
+              } // if
+            } // ix
+          } // iy
+        } // pw
+      } // ph
+    } // c
+  } // n
+}
+
+template <typename T>
+void ROIAlignBackwardFeature(
+    const int nthreads,
+    const T* top_diff,
+    const int num_rois,
+    const T& spatial_scale,
+    const int channels,
+    const int height,
+    const int width,
+    const int pooled_height,
+    const int pooled_width,
+    const int sampling_ratio,
+    const int bottom_size,
+    T* bottom_diff,
+    const T* bottom_rois,
+    int rois_cols) {
+  DCHECK(rois_cols == 4 || rois_cols == 5);
+
+  // RoIs overlap, so they are split in chunks which accumulate into buffers
+  // of their own, summed into bottom_diff after. There is at most one chunk
+  // per thread, and only as many as there are samples to scatter for the
+  // buffers to be worth zeroing and reducing.
+  const int64_t num_chunks = std::max<int64_t>(
+      1,
+      std::min<int64_t>(
+          std::min<int64_t>(at::get_max_threads(), num_rois),
+          nthreads / std::max<int64_t>(bottom_size, at::internal::GRAIN_SIZE)));
+  std::vector<T> buffers((num_chunks - 1) * bottom_size, T(0));
+
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      // The first chunk accumulates into bottom_diff itself
+      T* chunk_diff = chunk == 0
+          ? bottom_diff
+          : buffers.data() + (chunk - 1) * bottom_size;
+      ROIAlignBackwardRoIs<T>(
+          num_rois * chunk / num_chunks,
+          num_rois * (chunk + 1) / num_chunks,
+          top_diff,
+          spatial_scale,
+          channels,
+          height,
+          width,
+          pooled_height,
+          pooled_width,
+          sampling_ratio,
+          chunk_diff,
+          bottom_rois,
+          rois_cols);
+    }
+  });
+
+  EigenVectorMap<T> bottom_diff_vec(bottom_diff, bottom_size);
+  for (int64_t chunk = 1; chunk < num_chunks; chunk++) {
+    bottom_diff_vec += ConstEigenVectorMap<T>(
+        buffers.data() + (chunk - 1) * bottom_size, bottom_size);
+  }
 } // ROIAlignBackward
 
 } // namespace
@@ -216,6 +278,7 @@ bool RoIAlignGradientOp<float, CPUContext>::RunOnDevice() {
         pooled_height_,
         pooled_width_,
         sampling_ratio_,
+        dX->numel(),
         dX->template mutable_data<float>(),
         R.data<float>(),
         R.dim32(1));
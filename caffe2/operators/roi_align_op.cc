@@ -3,6 +3,8 @@
 #include "caffe2/utils/eigen_utils.h"
 #include "caffe2/utils/math.h"
 
+#include <ATen/Parallel.h>
+
 namespace caffe2 {
 namespace {
 
@@ -133,134 +135,136 @@ void ROIAlignForward(
 
   int n_rois = nthreads / channels / pooled_width / pooled_height;
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int n = 0; n < n_rois; n++) {
-    int index_n = n * channels * pooled_width * pooled_height;
-
-    // roi could have 4 or 5 columns
-    const T* offset_bottom_rois = bottom_rois + n * roi_cols;
-    int roi_batch_ind = 0;
-    if (roi_cols == 5) {
-      roi_batch_ind = offset_bottom_rois[0];
-      offset_bottom_rois++;
-    }
+  // RoIs write disjoint slices of the output, so they are pooled in parallel
+  at::parallel_for(0, n_rois, 1, [&](int64_t begin, int64_t end) {
+    std::vector<PreCalc<T>> pre_calc;
+    for (int n = begin; n < end; n++) {
+      int index_n = n * channels * pooled_width * pooled_height;
+
+      // roi could have 4 or 5 columns
+      const T* offset_bottom_rois = bottom_rois + n * roi_cols;
+      int roi_batch_ind = 0;
+      if (roi_cols == 5) {
+        roi_batch_ind = offset_bottom_rois[0];
+        offset_bottom_rois++;
+      }
+
+      // Do not using rounding; this implementation detail is critical
+      T roi_start_w = offset_bottom_rois[0] * spatial_scale;
+      T roi_start_h = offset_bottom_rois[1] * spatial_scale;
+      T roi_end_w = offset_bottom_rois[2] * spatial_scale;
+      T roi_end_h = offset_bottom_rois[3] * spatial_scale;
+      // T roi_start_w = round(offset_bottom_rois[0] * spatial_scale);
+      // T roi_start_h = round(offset_bottom_rois[1] * spatial_scale);
+      // T roi_end_w = round(offset_bottom_rois[2] * spatial_scale);
+      // T roi_end_h = round(offset_bottom_rois[3] * spatial_scale);
+
+      // Force malformed ROIs to be 1x1
+      T roi_width = std::max(roi_end_w - roi_start_w, (T)1.);
+      T roi_height = std::max(roi_end_h - roi_start_h, (T)1.);
+      T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
+      T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+
+      // We use roi_bin_grid to sample the grid and mimic integral
+      int roi_bin_grid_h = (sampling_ratio > 0)
+          ? sampling_ratio
+          : ceil(roi_height / pooled_height); // e.g., = 2
+      int roi_bin_grid_w = (sampling_ratio > 0)
+          ? sampling_ratio
+          : ceil(roi_width / pooled_width);
+
+      // We do average (integral) pooling inside a bin
+      const T count = roi_bin_grid_h * roi_bin_grid_w; // e.g. = 4
+
+      // we want to precalculate indeces and weights shared by all chanels,
+      // this is the key point of optimiation
+      pre_calc.resize(
+          roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
+      pre_calc_for_bilinear_interpolate(
+          height,
+          width,
+          pooled_height,
+          pooled_width,
+          roi_bin_grid_h,
+          roi_bin_grid_w,
+          roi_start_h,
+          roi_start_w,
+          bin_size_h,
+          bin_size_w,
+          roi_bin_grid_h,
+          roi_bin_grid_w,
+          pre_calc);
+
+      if (order == StorageOrder::NCHW) {
+        for (int c = 0; c < channels; c++) {
+          int index_n_c = index_n + c * pooled_width * pooled_height;
+          const T* offset_bottom_data =
+              bottom_data + (roi_batch_ind * channels + c) * height * width;
+          int pre_calc_index = 0;
+
+          for (int ph = 0; ph < pooled_height; ph++) {
+            for (int pw = 0; pw < pooled_width; pw++) {
+              int index = index_n_c + ph * pooled_width + pw;
+
+              T output_val = 0.;
+              for (int iy = 0; iy < roi_bin_grid_h; iy++) {
+                for (int ix = 0; ix < roi_bin_grid_w; ix++) {
+                  PreCalc<T> pc = pre_calc[pre_calc_index];
+                  output_val += pc.w1 * offset_bottom_data[pc.pos1] +
+                      pc.w2 * offset_bottom_data[pc.pos2] +
+                      pc.w3 * offset_bottom_data[pc.pos3] +
+                      pc.w4 * offset_bottom_data[pc.pos4];
+
+                  pre_calc_index += 1;
+                }
+              }
+              output_val /= count;
+
+              top_data[index] = output_val;
+            } // for pw
+          } // for ph
+        } // for c
+      } // if nchw
 
-    // Do not using rounding; this implementation detail is critical
-    T roi_start_w = offset_bottom_rois[0] * spatial_scale;
-    T roi_start_h = offset_bottom_rois[1] * spatial_scale;
-    T roi_end_w = offset_bottom_rois[2] * spatial_scale;
-    T roi_end_h = offset_bottom_rois[3] * spatial_scale;
-    // T roi_start_w = round(offset_bottom_rois[0] * spatial_scale);
-    // T roi_start_h = round(offset_bottom_rois[1] * spatial_scale);
-    // T roi_end_w = round(offset_bottom_rois[2] * spatial_scale);
-    // T roi_end_h = round(offset_bottom_rois[3] * spatial_scale);
-
-    // Force malformed ROIs to be 1x1
-    T roi_width = std::max(roi_end_w - roi_start_w, (T)1.);
-    T roi_height = std::max(roi_end_h - roi_start_h, (T)1.);
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int roi_bin_grid_h = (sampling_ratio > 0)
-        ? sampling_ratio
-        : ceil(roi_height / pooled_height); // e.g., = 2
-    int roi_bin_grid_w =
-        (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
-
-    // We do average (integral) pooling inside a bin
-    const T count = roi_bin_grid_h * roi_bin_grid_w; // e.g. = 4
-
-    // we want to precalculate indeces and weights shared by all chanels,
-    // this is the key point of optimiation
-    std::vector<PreCalc<T>> pre_calc(
-        roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
-    pre_calc_for_bilinear_interpolate(
-        height,
-        width,
-        pooled_height,
-        pooled_width,
-        roi_bin_grid_h,
-        roi_bin_grid_w,
-        roi_start_h,
-        roi_start_w,
-        bin_size_h,
-        bin_size_w,
-        roi_bin_grid_h,
-        roi_bin_grid_w,
-        pre_calc);
-
-    if (order == StorageOrder::NCHW) {
-      for (int c = 0; c < channels; c++) {
-        int index_n_c = index_n + c * pooled_width * pooled_height;
+      if (order == StorageOrder::NHWC) {
         const T* offset_bottom_data =
-            bottom_data + (roi_batch_ind * channels + c) * height * width;
+            bottom_data + roi_batch_ind * channels * height * width;
         int pre_calc_index = 0;
 
         for (int ph = 0; ph < pooled_height; ph++) {
           for (int pw = 0; pw < pooled_width; pw++) {
-            int index = index_n_c + ph * pooled_width + pw;
+            // Samples are accumulated across all channels at once, into the
+            // output itself
+            int index_nhw = index_n + (ph * pooled_width + pw) * channels;
+            EigenVectorMap<T> output_vals(top_data + index_nhw, channels);
+            output_vals.setZero();
 
-            T output_val = 0.;
             for (int iy = 0; iy < roi_bin_grid_h; iy++) {
               for (int ix = 0; ix < roi_bin_grid_w; ix++) {
                 PreCalc<T> pc = pre_calc[pre_calc_index];
-                output_val += pc.w1 * offset_bottom_data[pc.pos1] +
-                    pc.w2 * offset_bottom_data[pc.pos2] +
-                    pc.w3 * offset_bottom_data[pc.pos3] +
-                    pc.w4 * offset_bottom_data[pc.pos4];
+
+                ConstEigenVectorMap<T> data_1(
+                    offset_bottom_data + channels * pc.pos1, channels);
+                ConstEigenVectorMap<T> data_2(
+                    offset_bottom_data + channels * pc.pos2, channels);
+                ConstEigenVectorMap<T> data_3(
+                    offset_bottom_data + channels * pc.pos3, channels);
+                ConstEigenVectorMap<T> data_4(
+                    offset_bottom_data + channels * pc.pos4, channels);
+
+                output_vals += pc.w1 * data_1 + pc.w2 * data_2 +
+                    pc.w3 * data_3 + pc.w4 * data_4;
 
                 pre_calc_index += 1;
               }
             }
-            output_val /= count;
-
-            top_data[index] = output_val;
+            output_vals /= count;
           } // for pw
         } // for ph
-      } // for c
-    } // if nchw
-
-    if (order == StorageOrder::NHWC) {
-      const T* offset_bottom_data =
-          bottom_data + roi_batch_ind * channels * height * width;
-      int pre_calc_index = 0;
-
-      for (int ph = 0; ph < pooled_height; ph++) {
-        for (int pw = 0; pw < pooled_width; pw++) {
-          EVecXf output_vals = EVecXf::Zero(channels);
-
-          for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-            for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-              PreCalc<T> pc = pre_calc[pre_calc_index];
-
-              ConstEigenVectorMap<T> data_1(
-                  offset_bottom_data + channels * pc.pos1, channels);
-              ConstEigenVectorMap<T> data_2(
-                  offset_bottom_data + channels * pc.pos2, channels);
-              ConstEigenVectorMap<T> data_3(
-                  offset_bottom_data + channels * pc.pos3, channels);
-              ConstEigenVectorMap<T> data_4(
-                  offset_bottom_data + channels * pc.pos4, channels);
-
-              output_vals += pc.w1 * data_1 + pc.w2 * data_2 + pc.w3 * data_3 +
-                  pc.w4 * data_4;
-
-              pre_calc_index += 1;
-            }
-          }
-          output_vals /= count;
-
-          int index_nhw = index_n + (ph * pooled_width + pw) * channels;
-          std::memcpy(
-              top_data + index_nhw, output_vals.data(), channels * sizeof(T));
-        } // for pw
-      } // for ph
-    } // if nhwc
+      } // if nhwc
 
-  } // for n
+    } // for n
+  });
 }
 
 } // namespace
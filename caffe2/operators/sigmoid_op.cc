@@ -24,6 +24,7 @@ REGISTER_CPU_OPERATOR(
 OPERATOR_SCHEMA(Sigmoid)
     .NumInputs(1)
     .NumOutputs(1)
+    .StorageOrderAgnostic()
     .AllowInplace({{0, 0}})
     .IdenticalTypeAndShape()
     .SetDoc(R"DOC(
@@ -0,0 +1,108 @@
+#include "caffe2/operators/sparse_feature_transform_op.h"
+
+namespace caffe2 {
+
+SparseFeatureTransformOp::SparseFeatureTransformOp(
+    const OperatorDef& operator_def,
+    Workspace* ws)
+    : Operator<CPUContext>(operator_def, ws),
+      ws_(ws),
+      seed_(static_cast<uint32_t>(
+          this->template GetSingleArgument<int64_t>("seed", 0))),
+      modulo_(this->template GetSingleArgument<int64_t>("modulo", 0)),
+      boundaries_(this->template GetRepeatedArgument<int64_t>("boundaries")),
+      clip_min_(this->template GetSingleArgument<int64_t>(
+          "clip_min", std::numeric_limits<int64_t>::lowest())),
+      clip_max_(this->template GetSingleArgument<int64_t>(
+          "clip_max", std::numeric_limits<int64_t>::max())),
+      use_thread_pool_(
+          this->template GetSingleArgument<bool>("use_thread_pool", false)) {
+  const auto names =
+      this->template GetRepeatedArgument<std::string>("transforms");
+  CAFFE_ENFORCE(!names.empty(), "transforms must name at least one transform");
+  for (const auto& name : names) {
+    if (name == "hash") {
+      transforms_.push_back(Transform::HASH);
+    } else if (name == "modulo") {
+      CAFFE_ENFORCE_GT(modulo_, 0, "modulo should be > 0");
+      transforms_.push_back(Transform::MODULO);
+    } else if (name == "bucketize") {
+      CAFFE_ENFORCE(
+          std::is_sorted(boundaries_.begin(), boundaries_.end()),
+          "boundaries should be sorted");
+      transforms_.push_back(Transform::BUCKETIZE);
+    } else if (name == "clip") {
+      CAFFE_ENFORCE_LE(
+          clip_min_, clip_max_, "clip_min should be <= clip_max");
+      transforms_.push_back(Transform::CLIP);
+    } else if (name == "dedup") {
+      transforms_.push_back(Transform::DEDUP);
+      has_dedup_ = true;
+    } else {
+      CAFFE_THROW(
+          "Unknown transform ",
+          name,
+          ", expected one of hash, modulo, bucketize, clip and dedup");
+    }
+  }
+}
+
+REGISTER_CPU_OPERATOR(SparseFeatureTransform, SparseFeatureTransformOp);
+
+OPERATOR_SCHEMA(SparseFeatureTransform)
+    .NumInputs(2)
+    .NumOutputs(2)
+    .AllowInplace({{0, 0}, {1, 1}})
+    .SetDoc(R"DOC(
+Applies a sequence of transforms to the ids of sparse features, given as
+LENGTHS and VALUES, in a single pass over the ids. The transforms run in the
+order of the `transforms` argument:
+
+- `hash`: replaces each id by the MurmurHash3 (x64, 128 bits) of its bytes
+  with `seed`, keeping the low bits that fit in a non-negative id.
+- `modulo`: replaces each id by its non-negative remainder modulo `modulo`.
+- `bucketize`: replaces each id by the index of its bucket in the sorted
+  `boundaries`, that is the number of boundaries smaller than the id, so that
+  the buckets are (-inf, b_0], (b_0, b_1], ..., (b_n-1, inf).
+- `clip`: clamps each id to [`clip_min`, `clip_max`].
+- `dedup`: removes the repeated ids of each segment, keeping the first one.
+
+For example, `transforms=["hash", "modulo", "dedup"]` does what IndexHash
+(with another hash function) followed by a deduplication would, without the
+intermediate tensors. With `use_thread_pool`, the segments are split across
+the threads of the workspace's pool.
+)DOC")
+    .Input(0, "LENGTHS", "int32 lengths of the segments.")
+    .Input(1, "VALUES", "int32 or int64 ids, of all the segments.")
+    .Output(0, "OUT_LENGTHS", "Lengths of the transformed segments.")
+    .Output(1, "OUT_VALUES", "Transformed ids, of the same type as VALUES.")
+    .Arg("transforms", "(list of strings) the transforms, in order")
+    .Arg("seed", "(int) seed of the hash function")
+    .Arg("modulo", "(int) must be > 0 with modulo")
+    .Arg("boundaries", "(list of ints) sorted boundaries of the buckets")
+    .Arg("clip_min", "(int) smallest id after clip")
+    .Arg("clip_max", "(int) largest id after clip")
+    .Arg(
+        "use_thread_pool",
+        "(bool) split the segments across the workspace's thread pool")
+    .TensorInferenceFunction([](const OperatorDef& def,
+                                const vector<TensorShape>& in) {
+      ArgumentHelper helper(def);
+      const auto transforms =
+          helper.GetRepeatedArgument<std::string>("transforms");
+      const bool dedup =
+          std::find(transforms.begin(), transforms.end(), "dedup") !=
+          transforms.end();
+      std::vector<TensorShape> out(2);
+      out[0] = in[0];
+      out[1] = in[1];
+      if (dedup) {
+        // The number of ids left is only known when running
+        out[1].set_unknown_shape(true);
+      }
+      return out;
+    });
+
+SHOULD_NOT_DO_GRADIENT(SparseFeatureTransform);
+
+} // namespace caffe2
@@ -0,0 +1,285 @@
+#ifndef CAFFE2_OPERATORS_SPARSE_FEATURE_TRANSFORM_OP_H_
+#define CAFFE2_OPERATORS_SPARSE_FEATURE_TRANSFORM_OP_H_
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "caffe2/core/asan.h"
+#include "caffe2/core/context.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/murmur_hash3.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+namespace caffe2 {
+
+// Applies a sequence of transforms to the ids of a batch of sparse features
+// (a lengths and a values vector), in a single pass: each segment is copied to
+// the output and goes through all the transforms while it is in the cache,
+// rather than every transform making a pass over all the ids with an
+// allocation of its own, as chaining IndexHash, Clip, Bucketize and the like
+// does. The segments can be split across the threads of the workspace's pool.
+class SparseFeatureTransformOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  SparseFeatureTransformOp(const OperatorDef& operator_def, Workspace* ws);
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(VALUES));
+  }
+
+  template <typename T>
+  bool DoRunWithType();
+
+ private:
+  enum class Transform { HASH, MODULO, BUCKETIZE, CLIP, DEDUP };
+
+  // Chunks smaller than this aren't worth dispatching to another thread
+  static constexpr int64_t kMinValuesPerChunk = 4096;
+  // Segments up to this length are deduplicated without a hash set
+  static constexpr int64_t kMaxLengthForLinearDedup = 16;
+
+  // Transforms a segment in place and returns its new length
+  template <typename T>
+  int64_t TransformSegment(T* values, int64_t length, std::unordered_set<T>* seen)
+      const;
+
+  template <typename T>
+  T Hash(T id) const {
+    uint64_t out[2];
+    MurmurHash3_x64_128(&id, sizeof(T), seed_, out);
+    // Keeps the hashed ids non-negative
+    return static_cast<T>(out[0] & std::numeric_limits<T>::max());
+  }
+
+  template <typename T>
+  CAFFE2_NO_SANITIZE("signed-integer-overflow")
+  T Modulo(T id) const {
+    const auto remainder = static_cast<int64_t>(id) % modulo_;
+    return static_cast<T>(remainder >= 0 ? remainder : remainder + modulo_);
+  }
+
+  template <typename T>
+  T Bucketize(T id) const {
+    return static_cast<T>(
+        std::lower_bound(
+            boundaries_.begin(), boundaries_.end(), static_cast<int64_t>(id)) -
+        boundaries_.begin());
+  }
+
+  template <typename T>
+  static int64_t Dedup(T* values, int64_t length, std::unordered_set<T>* seen);
+
+  INPUT_TAGS(LENGTHS, VALUES);
+  OUTPUT_TAGS(OUT_LENGTHS, OUT_VALUES);
+
+  Workspace* ws_;
+  std::vector<Transform> transforms_;
+  bool has_dedup_ = false;
+  uint32_t seed_;
+  int64_t modulo_;
+  std::vector<int64_t> boundaries_;
+  int64_t clip_min_;
+  int64_t clip_max_;
+  bool use_thread_pool_;
+
+  // The segments and the values of each chunk, as in
+  // CPUSparseLengthsReductionOp
+  std::vector<int64_t> chunk_segments_;
+  std::vector<int64_t> chunk_values_;
+  // The number of values each chunk wrote, at the offset of its input values
+  std::vector<int64_t> chunk_sizes_;
+};
+
+template <typename T>
+bool SparseFeatureTransformOp::DoRunWithType() {
+  auto& lengths = Input(LENGTHS);
+  auto& values = Input(VALUES);
+  CAFFE_ENFORCE_EQ(1, lengths.dim(), "LENGTHS must be a vector");
+  CAFFE_ENFORCE_EQ(1, values.dim(), "VALUES must be a vector");
+  for (const auto transform : transforms_) {
+    if (transform == Transform::MODULO) {
+      CAFFE_ENFORCE_GE(
+          static_cast<int64_t>(std::numeric_limits<T>::max()),
+          modulo_,
+          "modulo shouldn't be larger than the numeric limit of the values");
+    }
+    if (transform == Transform::BUCKETIZE) {
+      CAFFE_ENFORCE_GE(
+          static_cast<int64_t>(std::numeric_limits<T>::max()),
+          static_cast<int64_t>(boundaries_.size()),
+          "There are more buckets than values of the type of the ids");
+    }
+  }
+
+  const int64_t num_segments = lengths.numel();
+  const int64_t num_values = values.numel();
+  const auto* lengths_data = lengths.template data<int32_t>();
+  const auto* values_data = values.template data<T>();
+
+  ThreadPool* pool = use_thread_pool_ ? ws_->GetThreadPool() : nullptr;
+  const int64_t num_chunks = std::max<int64_t>(
+      1,
+      pool == nullptr ? 1
+                      : std::min<int64_t>(
+                            {static_cast<int64_t>(pool->getNumThreads()),
+                             num_segments,
+                             num_values / kMinValuesPerChunk}));
+
+  // Chunk k covers the segments from chunk_segments_[k] to
+  // chunk_segments_[k + 1], whose values start at chunk_values_[k]
+  chunk_segments_.assign(num_chunks + 1, num_segments);
+  chunk_values_.assign(num_chunks + 1, num_values);
+  chunk_segments_[0] = 0;
+  chunk_values_[0] = 0;
+  int64_t total_length = 0;
+  int64_t chunk = 1;
+  for (int64_t i = 0; i < num_segments; ++i) {
+    CAFFE_ENFORCE_GE(lengths_data[i], 0, "Lengths must be non-negative");
+    total_length += lengths_data[i];
+    while (chunk < num_chunks &&
+           total_length * num_chunks >= chunk * num_values) {
+      chunk_segments_[chunk] = i + 1;
+      chunk_values_[chunk] = total_length;
+      ++chunk;
+    }
+  }
+  CAFFE_ENFORCE_EQ(
+      total_length,
+      num_values,
+      "The sum of the lengths should be the number of values");
+
+  // The outputs may be the inputs, when the operator runs in place
+  auto* out_lengths = Output(OUT_LENGTHS, {num_segments}, at::dtype<int32_t>());
+  auto* out_values = Output(OUT_VALUES, {num_values}, at::dtype<T>());
+  auto* out_lengths_data = out_lengths->template mutable_data<int32_t>();
+  auto* out_values_data = out_values->template mutable_data<T>();
+
+  chunk_sizes_.assign(num_chunks, 0);
+  const auto run_chunk = [&](int64_t k) {
+    std::unordered_set<T> seen;
+    int64_t offset = chunk_values_[k];
+    T* out = out_values_data + offset;
+    for (int64_t i = chunk_segments_[k]; i < chunk_segments_[k + 1]; ++i) {
+      const int64_t length = lengths_data[i];
+      if (out != values_data + offset) {
+        std::memmove(out, values_data + offset, length * sizeof(T));
+      }
+      offset += length;
+      const int64_t new_length = TransformSegment(out, length, &seen);
+      out_lengths_data[i] = static_cast<int32_t>(new_length);
+      out += new_length;
+    }
+    chunk_sizes_[k] = out - (out_values_data + chunk_values_[k]);
+  };
+
+  if (num_chunks == 1) {
+    run_chunk(0);
+  } else {
+    // Exceptions can't leave the worker threads
+    std::vector<std::exception_ptr> errors(num_chunks);
+    pool->run(
+        [&](int /* unused */, size_t k) {
+          try {
+            run_chunk(k);
+          } catch (...) {
+            errors[k] = std::current_exception();
+          }
+        },
+        num_chunks);
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  if (has_dedup_) {
+    // Moves the values of each chunk right after those of the chunk before it
+    int64_t size = chunk_sizes_[0];
+    for (int64_t k = 1; k < num_chunks; ++k) {
+      if (size != chunk_values_[k]) {
+        std::memmove(
+            out_values_data + size,
+            out_values_data + chunk_values_[k],
+            chunk_sizes_[k] * sizeof(T));
+      }
+      size += chunk_sizes_[k];
+    }
+    out_values->ShrinkTo(size);
+  }
+  return true;
+}
+
+template <typename T>
+int64_t SparseFeatureTransformOp::TransformSegment(
+    T* values,
+    int64_t length,
+    std::unordered_set<T>* seen) const {
+  for (const auto transform : transforms_) {
+    switch (transform) {
+      case Transform::HASH:
+        for (int64_t j = 0; j < length; ++j) {
+          values[j] = Hash(values[j]);
+        }
+        break;
+      case Transform::MODULO:
+        for (int64_t j = 0; j < length; ++j) {
+          values[j] = Modulo(values[j]);
+        }
+        break;
+      case Transform::BUCKETIZE:
+        for (int64_t j = 0; j < length; ++j) {
+          values[j] = Bucketize(values[j]);
+        }
+        break;
+      case Transform::CLIP: {
+        const auto lo = static_cast<T>(std::max<int64_t>(
+            clip_min_, std::numeric_limits<T>::lowest()));
+        const auto hi = static_cast<T>(
+            std::min<int64_t>(clip_max_, std::numeric_limits<T>::max()));
+        for (int64_t j = 0; j < length; ++j) {
+          values[j] = std::min(std::max(values[j], lo), hi);
+        }
+      } break;
+      case Transform::DEDUP:
+        length = Dedup(values, length, seen);
+        break;
+    }
+  }
+  return length;
+}
+
+template <typename T>
+int64_t SparseFeatureTransformOp::Dedup(
+    T* values,
+    int64_t length,
+    std::unordered_set<T>* seen) {
+  int64_t new_length = 0;
+  if (length <= kMaxLengthForLinearDedup) {
+    for (int64_t j = 0; j < length; ++j) {
+      if (std::find(values, values + new_length, values[j]) ==
+          values + new_length) {
+        values[new_length++] = values[j];
+      }
+    }
+    return new_length;
+  }
+  seen->clear();
+  for (int64_t j = 0; j < length; ++j) {
+    if (seen->insert(values[j]).second) {
+      values[new_length++] = values[j];
+    }
+  }
+  return new_length;
+}
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_SPARSE_FEATURE_TRANSFORM_OP_H_
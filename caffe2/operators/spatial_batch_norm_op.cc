@@ -29,6 +29,7 @@ REGISTER_CPU_OPERATOR(SpatialBN, SpatialBNOp<CPUContext>);
 OPERATOR_SCHEMA(SpatialBN)
     .NumInputs({5, 7})
     .NumOutputs({1, 5})
+    .StorageOrderDependent({0}, {0})
     .AllowInplace({{0, 0}, {5, 3}, {6, 4}})
     .EnforceInplace({{3, 1}, {4, 2}})
     .CostInferenceFunction(CostInferenceForSpatialBN)
@@ -27,6 +27,7 @@ REGISTER_CPU_OPERATOR(
 OPERATOR_SCHEMA(Tanh)
     .NumInputs(1)
     .NumOutputs(1)
+    .StorageOrderAgnostic()
     .AllowInplace({{0, 0}})
     .IdenticalTypeAndShape()
     .SetDoc(R"DOC(
@@ -2,10 +2,12 @@
 
 #include <algorithm>
 #include <functional>
-#include <queue>
 #include <utility>
 #include <vector>
 
+#include <ATen/Parallel.h>
+
+#include "caffe2/operators/top_k_cpu_selection.h"
 #include "caffe2/proto/caffe2_pb.h"
 #include "caffe2/utils/math.h"
 
@@ -13,16 +15,6 @@ namespace caffe2 {
 
 namespace {
 
-template <typename T>
-struct ValueComp {
-  bool operator()(
-      const std::pair<T, int64_t>& lhs,
-      const std::pair<T, int64_t>& rhs) const {
-    return lhs.first > rhs.first ||
-        (lhs.first == rhs.first && lhs.second < rhs.second);
-  }
-};
-
 template <typename T>
 void GetTopK(
     const T* input,
@@ -33,36 +25,17 @@ void GetTopK(
     const int64_t stride,
     T* values,
     int64_t* indices,
-    int64_t* flatten_indices) {
-  const T* src_ptr = input + src_offset;
-  std::vector<std::pair<T, int64_t>> heap_data;
-  heap_data.reserve(k);
-  for (int64_t i = 0; i < k && i < n; ++i) {
-    heap_data.emplace_back(*src_ptr, i);
-    src_ptr += stride;
-  }
-  std::priority_queue<
-      std::pair<T, int64_t>,
-      std::vector<std::pair<T, int64_t>>,
-      ValueComp<T>>
-      pq(ValueComp<T>(), std::move(heap_data));
-  for (int64_t i = k; i < n; ++i) {
-    if (pq.top().first < *src_ptr) {
-      pq.pop();
-      pq.emplace(*src_ptr, i);
-    }
-    src_ptr += stride;
-  }
-  int64_t dst_pos = dst_offset + (std::min(k, n) - 1) * stride;
-  while (!pq.empty()) {
-    const auto& item = pq.top();
+    int64_t* flatten_indices,
+    std::vector<std::pair<T, int64_t>>* selected) {
+  top_k_cpu::SelectTopK(input + src_offset, n, k, stride, selected);
+  int64_t dst_pos = dst_offset;
+  for (const auto& item : *selected) {
     values[dst_pos] = item.first;
     indices[dst_pos] = item.second;
     if (flatten_indices != nullptr) {
       flatten_indices[dst_pos] = src_offset + item.second * stride;
     }
-    pq.pop();
-    dst_pos -= stride;
+    dst_pos += stride;
   }
 }
 
@@ -133,26 +106,32 @@ bool TopKOp<T, Context>::RunOnDevice() {
       input_dims.cend(),
       int64_t(1),
       std::multiplies<int64_t>());
-  const int64_t src_offset_stride = input_dims[axis_] * next_size;
+  const int64_t n = input_dims[axis_];
+  const int64_t src_offset_stride = n * next_size;
   const int64_t dst_offset_stride = k_ * next_size;
-  int64_t src_offset = 0;
-  int64_t dst_offset = 0;
-  for (int64_t i = 0; i < prev_size; ++i) {
-    for (int64_t j = 0; j < next_size; ++j) {
-      GetTopK(
-          input_data,
-          input_dims[axis_],
-          k_,
-          src_offset + j,
-          dst_offset + j,
-          next_size,
-          values_data,
-          indices_data,
-          flatten_indices_data);
-    }
-    src_offset += src_offset_stride;
-    dst_offset += dst_offset_stride;
-  }
+  // The rows write disjoint outputs, so they are selected in parallel, in
+  // chunks of about GRAIN_SIZE values
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(n, 1));
+  at::parallel_for(
+      0, prev_size * next_size, grain_size, [&](int64_t begin, int64_t end) {
+        std::vector<std::pair<T, int64_t>> selected;
+        for (int64_t row = begin; row < end; ++row) {
+          const int64_t i = row / next_size;
+          const int64_t j = row % next_size;
+          GetTopK(
+              input_data,
+              n,
+              k_,
+              i * src_offset_stride + j,
+              i * dst_offset_stride + j,
+              next_size,
+              values_data,
+              indices_data,
+              flatten_indices_data,
+              &selected);
+        }
+      });
   return true;
 }
 
@@ -0,0 +1,116 @@
+#ifndef CAFFE2_OPERATORS_TOP_K_CPU_SELECTION_H_
+#define CAFFE2_OPERATORS_TOP_K_CPU_SELECTION_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace caffe2 {
+
+namespace top_k_cpu {
+
+// Orders (value, index) pairs by decreasing value, then by increasing index.
+template <typename T>
+struct ValueComp {
+  bool operator()(
+      const std::pair<T, int64_t>& lhs,
+      const std::pair<T, int64_t>& rhs) const {
+    return lhs.first > rhs.first ||
+        (lhs.first == rhs.first && lhs.second < rhs.second);
+  }
+};
+
+// Contiguous values are filtered against the threshold a block at a time.
+constexpr int64_t kFilterBlockSize = 64;
+
+// Keeps the k first candidates in the order of ValueComp, and returns the
+// value of the last of them, which later values have to be greater than to
+// be among the top k.
+template <typename T>
+T KeepTopK(const int64_t k, std::vector<std::pair<T, int64_t>>* candidates) {
+  std::nth_element(
+      candidates->begin(),
+      candidates->begin() + (k - 1),
+      candidates->end(),
+      ValueComp<T>());
+  candidates->resize(k);
+  return (*candidates)[k - 1].first;
+}
+
+/**
+ * Selects the k largest of the n values src[0], src[stride], ...,
+ * src[(n - 1) * stride] into selected, in the order of ValueComp: min(k, n)
+ * (value, index) pairs, whose storage is reused from call to call.
+ *
+ * The values are scanned once. Candidates are kept until there are 2k of
+ * them, when nth_element, an introselect, keeps the top k and sets the
+ * threshold the next values have to exceed. Once the threshold is high
+ * enough, most values are rejected by it: for contiguous values, that is a
+ * branch-free count over blocks, which compilers vectorize, and only the
+ * blocks with values above it are looked at one by one. That is linear in n,
+ * where a heap of k takes n log(k) for values in increasing order.
+ */
+template <typename T>
+void SelectTopK(
+    const T* src,
+    const int64_t n,
+    const int64_t k,
+    const int64_t stride,
+    std::vector<std::pair<T, int64_t>>* selected) {
+  selected->clear();
+  const int64_t m = std::min(k, n);
+  if (m <= 0) {
+    return;
+  }
+  const int64_t capacity = std::min(2 * m, n);
+  selected->reserve(capacity);
+  int64_t i = 0;
+  for (; i < m; ++i) {
+    selected->emplace_back(src[i * stride], i);
+  }
+  if (n == m) {
+    std::sort(selected->begin(), selected->end(), ValueComp<T>());
+    return;
+  }
+  // The smallest of the first m values, which come before the values after
+  // them that are equal to it
+  T threshold = std::max_element(
+                    selected->cbegin(), selected->cend(), ValueComp<T>())
+                    ->first;
+  const auto consider = [&](const int64_t index) {
+    const T value = src[index * stride];
+    if (value > threshold) {
+      selected->emplace_back(value, index);
+      if (static_cast<int64_t>(selected->size()) == capacity) {
+        threshold = KeepTopK(m, selected);
+      }
+    }
+  };
+  if (stride == 1) {
+    for (; i + kFilterBlockSize <= n; i += kFilterBlockSize) {
+      int count = 0;
+      for (int64_t j = i; j < i + kFilterBlockSize; ++j) {
+        count += src[j] > threshold;
+      }
+      if (count > 0) {
+        for (int64_t j = i; j < i + kFilterBlockSize; ++j) {
+          consider(j);
+        }
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    consider(i);
+  }
+  if (static_cast<int64_t>(selected->size()) > m) {
+    KeepTopK(m, selected);
+  }
+  std::sort(selected->begin(), selected->end(), ValueComp<T>());
+}
+
+} // namespace top_k_cpu
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_TOP_K_CPU_SELECTION_H_
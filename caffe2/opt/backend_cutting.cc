@@ -1,5 +1,7 @@
 #include "caffe2/opt/backend_cutting.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
 #include "caffe2/opt/converter.h"
 #include "nomnigraph/Converters/Dot.h"
 #include "nomnigraph/Representations/NeuralNet.h"
@@ -341,12 +343,119 @@ void PruneUnrefereredNodes(NNModule* nn) {
   }
 }
 
+struct RooflineCost {
+  // The cost of an op from its cost inference function, false if unknown
+  bool OpCost(const caffe2::OperatorDef& op, OpSchema::Cost* cost) const {
+    const auto* schema = OpSchemaRegistry::Schema(op.type());
+    if (!schema || !schema->HasCostInferenceFunction()) {
+      return false;
+    }
+    std::vector<TensorShape> inputs;
+    for (const auto& input : op.input()) {
+      const auto it = shapes.find(input);
+      if (it == shapes.end() || it->second.unknown_shape()) {
+        return false;
+      }
+      inputs.push_back(it->second);
+    }
+    try {
+      *cost = schema->InferCost(op, inputs);
+    } catch (const std::exception& e) {
+      VLOG(1) << "Cost inference failed for " << op.type() << ": " << e.what();
+      return false;
+    }
+    return true;
+  }
+
+  bool BlobBytes(const std::string& name, double* bytes) const {
+    const auto it = shapes.find(name);
+    if (it == shapes.end() || it->second.unknown_shape()) {
+      return false;
+    }
+    double numel = 1;
+    for (const auto d : it->second.dims()) {
+      numel *= d;
+    }
+    *bytes = numel * DataTypeToTypeMeta(it->second.data_type()).itemsize();
+    return true;
+  }
+
+  static double Time(const OpSchema::Cost& cost, const DeviceThroughput& device) {
+    return std::max(
+        cost.flops / device.flops_per_second,
+        (cost.bytes_read + cost.bytes_written) / device.bytes_per_second);
+  }
+
+  bool operator()(
+      const caffe2::NetDef& subnet,
+      const caffe2::NetDef& opt_subnet) const {
+    double cpu_time = 0;
+    double backend_time = 0;
+    for (const auto& op : subnet.op()) {
+      OpSchema::Cost cost;
+      if (!OpCost(op, &cost)) {
+        VLOG(1) << "Unknown cost of " << op.type() << ", transforming";
+        return true;
+      }
+      cpu_time += Time(cost, cpu);
+      backend_time += Time(cost, backend);
+    }
+    // The weights absorbed by the transformation are not transferred
+    double transfer_bytes = 0;
+    for (const auto& blobs :
+         {&opt_subnet.external_input(), &opt_subnet.external_output()}) {
+      for (const auto& name : *blobs) {
+        double bytes;
+        if (!BlobBytes(name, &bytes)) {
+          VLOG(1) << "Unknown shape of " << name << ", transforming";
+          return true;
+        }
+        transfer_bytes += bytes;
+      }
+    }
+    backend_time += transfer_bytes / transfer_bytes_per_second;
+    VLOG(1) << "Subgraph of " << subnet.op_size() << " ops takes " << cpu_time
+            << "s on the CPU and " << backend_time
+            << "s on the backend, including transfers";
+    return backend_time < cpu_time;
+  }
+
+  std::unordered_map<std::string, TensorShape> shapes;
+  DeviceThroughput cpu;
+  DeviceThroughput backend;
+  double transfer_bytes_per_second;
+};
+
 } // namespace
 
+BackendCostFunction RooflineCostFunction(
+    const caffe2::NetDef& net,
+    const CaffeMap<std::string, std::vector<int64_t>>& input_dims,
+    const DeviceThroughput& cpu,
+    const DeviceThroughput& backend,
+    double transfer_bytes_per_second) {
+  CAFFE_ENFORCE_GT(cpu.flops_per_second, 0);
+  CAFFE_ENFORCE_GT(cpu.bytes_per_second, 0);
+  CAFFE_ENFORCE_GT(backend.flops_per_second, 0);
+  CAFFE_ENFORCE_GT(backend.bytes_per_second, 0);
+  CAFFE_ENFORCE_GT(transfer_bytes_per_second, 0);
+  RooflineCost cost;
+  caffe2::NetDef net_copy(net);
+  const auto shapes = InferBlobShapesAndTypesFromMap(input_dims, {&net_copy});
+  for (const auto& shape : shapes.shapes()) {
+    cost.shapes.emplace(shape.name(), shape);
+  }
+  cost.cpu = cpu;
+  cost.backend = backend;
+  cost.transfer_bytes_per_second = transfer_bytes_per_second;
+  return cost;
+}
+
 caffe2::NetDef OptimizeForBackend(
     caffe2::NetDef& net,
     std::function<bool(const caffe2::OperatorDef&)> supports,
-    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func) {
+    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func,
+    BackendCostFunction worth_transforming) {
   auto nn = convertToNNModule(net);
   auto& dfg = nn.dataFlow;
 
@@ -404,7 +513,12 @@ caffe2::NetDef OptimizeForBackend(
     caffe2::NetDef subnet = ConvertToC2Net(g, context.infos);
     // Transform the subgraph protobuf def, note that we can have less external
     // inputs/outputs but not more
-    opt_subnets.emplace_back(transform_func(subnet));
+    auto opt_subnet = transform_func(subnet);
+    if (worth_transforming && !worth_transforming(subnet, opt_subnet)) {
+      VLOG(1) << "Keeping group " << g.group_id << " on the CPU";
+      continue;
+    }
+    opt_subnets.emplace_back(std::move(opt_subnet));
 
     ReplaceSubgraph(g, opt_subnets.back(), &dfg);
   }
@@ -5,13 +5,43 @@
 #include "caffe2/proto/caffe2_pb.h"
 
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace caffe2 {
 namespace opt {
 
+// Decides whether to replace a subgraph of ops supported by the backend,
+// `subnet`, by the net it got transformed into, `opt_subnet`, or to leave it
+// on the CPU, e.g. when it is too small to be worth moving its inputs and
+// outputs to and from the backend.
+using BackendCostFunction = std::function<
+    bool(const caffe2::NetDef& subnet, const caffe2::NetDef& opt_subnet)>;
+
 CAFFE2_API caffe2::NetDef OptimizeForBackend(
     caffe2::NetDef& net,
     std::function<bool(const caffe2::OperatorDef&)> supports,
-    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func);
+    std::function<caffe2::NetDef(const caffe2::NetDef&)> transform_func,
+    BackendCostFunction worth_transforming = nullptr);
+
+struct CAFFE2_API DeviceThroughput {
+  double flops_per_second;
+  // Memory bandwidth
+  double bytes_per_second;
+};
+
+// A BackendCostFunction that moves a subgraph to the backend if it runs faster
+// there than on the CPU, counting the time to transfer the external inputs
+// and outputs of the transformed subgraph. The time of an op on a device is
+// the roofline estimate from the FLOPs and bytes of its OpSchema cost
+// inference, with the shapes inferred from `input_dims`, the dims of the
+// external inputs of `net`. Subgraphs with ops or transfers of unknown cost
+// are always moved.
+CAFFE2_API BackendCostFunction RooflineCostFunction(
+    const caffe2::NetDef& net,
+    const CaffeMap<std::string, std::vector<int64_t>>& input_dims,
+    const DeviceThroughput& cpu,
+    const DeviceThroughput& backend,
+    double transfer_bytes_per_second);
 }
 } // namespace caffe2
@@ -152,3 +152,45 @@ TEST(BackendCuttingTest, skipPath) {
   auto net_opt = caffe2::opt::OptimizeForBackend(net, Supports, Transform);
   EXPECT_EQ(4, net_opt.op_size());
 }
+
+// X -> Relu -> Sigmoid -> Relu -> Y, where only Relu is supported
+TEST(BackendCuttingTest, costFunction) {
+  caffe2::NetDef net;
+  net.add_external_input("X");
+  net.add_external_output("Y");
+  const char* types[] = {"Relu", "Sigmoid", "Relu"};
+  for (int i = 0; i < 3; ++i) {
+    auto* op = net.add_op();
+    op->set_type(types[i]);
+    op->add_input(i == 0 ? "X" : "N" + c10::to_string(i));
+    op->add_output(i == 2 ? "Y" : "N" + c10::to_string(i + 1));
+  }
+  auto supports = [](const caffe2::OperatorDef& op) {
+    return op.type() == "Relu";
+  };
+  const caffe2::CaffeMap<std::string, std::vector<int64_t>> input_dims{
+      {"X", {128, 1024}}};
+  const caffe2::opt::DeviceThroughput cpu{1e10, 1e10};
+  const caffe2::opt::DeviceThroughput backend{1e12, 1e12};
+
+  // The Relus don't make up for moving their inputs and outputs around
+  auto slow_transfers = caffe2::opt::RooflineCostFunction(
+      net, input_dims, cpu, backend, 1e9);
+  auto net_opt = caffe2::opt::OptimizeForBackend(
+      net, supports, Transform, slow_transfers);
+  EXPECT_EQ(3, net_opt.op_size());
+  for (const auto& op : net_opt.op()) {
+    EXPECT_NE("BigOpt", op.type());
+  }
+
+  auto fast_transfers = caffe2::opt::RooflineCostFunction(
+      net, input_dims, cpu, backend, 1e12);
+  net_opt = caffe2::opt::OptimizeForBackend(
+      net, supports, Transform, fast_transfers);
+  EXPECT_EQ(3, net_opt.op_size());
+  int num_transformed = 0;
+  for (const auto& op : net_opt.op()) {
+    num_transformed += op.type() == "BigOpt";
+  }
+  EXPECT_EQ(2, num_transformed);
+}
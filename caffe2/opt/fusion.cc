@@ -1,8 +1,11 @@
 #include "caffe2/opt/fusion.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/passes.h"
 
+#include <unordered_set>
+
 namespace caffe2 {
 namespace opt {
 
@@ -119,7 +122,199 @@ void fuseConvBN(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
   }
 }
 
+namespace {
+
+const caffe2::OperatorDef* getOperatorDef(repr::NNGraph::NodeRef node) {
+  auto annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<caffe2::Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  auto c2_annotation = dyn_cast<caffe2::Caffe2Annotation>(annotation);
+  return c2_annotation->hasOperatorDef() ? &c2_annotation->getOperatorDef()
+                                         : nullptr;
+}
+
+// The Caffe2 type of an operator node, which may differ from the name of its
+// nomnigraph class (e.g. SpatialBN and BatchNormalization)
+std::string getOperatorType(repr::NNGraph::NodeRef node) {
+  auto op = getOperatorDef(node);
+  return op ? op->type()
+            : repr::nn::get<repr::NeuralNetOperator>(node)->getName();
+}
+
+int getDeviceType(repr::NNGraph::NodeRef node) {
+  auto annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<caffe2::Caffe2Annotation>(annotation)) {
+    return caffe2::PROTO_CPU;
+  }
+  return dyn_cast<caffe2::Caffe2Annotation>(annotation)->getDeviceType();
+}
+
+repr::nn::NNMatchPredicate matchAnyTensor(int count) {
+  repr::nn::NNMatchPredicate predicate(repr::nn::is<repr::Tensor>);
+  predicate.count(count).nonTerminal().excludeFromSubgraph();
+  return predicate;
+}
+
+// The inputs of the fused operator. The chained outputs, which disappear, are
+// added to chained if given.
+std::vector<repr::NNGraph::NodeRef> getFusedInputs(
+    const std::vector<repr::NNGraph::NodeRef>& ops,
+    std::vector<repr::NNGraph::NodeRef>* chained) {
+  std::vector<repr::NNGraph::NodeRef> inputs = repr::nn::getInputs(ops[0]);
+  for (size_t i = 1; i < ops.size(); ++i) {
+    auto previous_output = repr::nn::getOutputs(ops[i - 1]).front();
+    if (chained) {
+      chained->push_back(previous_output);
+    }
+    for (auto input : repr::nn::getInputs(ops[i])) {
+      if (input != previous_output) {
+        inputs.push_back(input);
+      }
+    }
+  }
+  return inputs;
+}
+
+bool canFuse(
+    const FusionPattern& pattern,
+    const std::vector<repr::NNGraph::NodeRef>& ops) {
+  const int device_type = getDeviceType(ops.front());
+  for (auto op : ops) {
+    NOM_REQUIRE_OR_RET_FALSE(getDeviceType(op) == device_type);
+    auto def = getOperatorDef(op);
+    NOM_REQUIRE_OR_RET_FALSE(!def || def->engine().empty());
+  }
+  auto registry = gDeviceTypeRegistry()->find(ProtoToType(device_type));
+  NOM_REQUIRE_OR_RET_FALSE(registry != gDeviceTypeRegistry()->end());
+  NOM_REQUIRE_OR_RET_FALSE(registry->second->Has(pattern.fused_type));
+
+  std::unordered_set<std::string> input_names;
+  for (auto input : getFusedInputs(ops, nullptr)) {
+    input_names.insert(repr::nn::get<repr::NeuralNetData>(input)->getName());
+  }
+  for (auto output : repr::nn::getOutputs(ops.back())) {
+    NOM_REQUIRE_OR_RET_FALSE(!input_names.count(
+        repr::nn::get<repr::NeuralNetData>(output)->getName()));
+  }
+  return !pattern.should_fuse || pattern.should_fuse(ops);
+}
+
+void fuse(
+    repr::NNGraph& graph,
+    const FusionPattern& pattern,
+    const std::vector<repr::NNGraph::NodeRef>& ops) {
+  std::vector<repr::NNGraph::NodeRef> chained;
+  auto inputs = getFusedInputs(ops, &chained);
+  auto outputs = repr::nn::getOutputs(ops.back());
+
+  auto first = repr::nn::get<repr::NeuralNetOperator>(ops[0]);
+  auto annotation = util::make_unique<caffe2::Caffe2Annotation>();
+  auto def = getOperatorDef(ops[0]);
+  caffe2::OperatorDef fused_def = def ? *def : caffe2::OperatorDef();
+  fused_def.set_type(pattern.fused_type);
+  annotation->setOperatorDef(fused_def);
+  annotation->setDeviceType(getDeviceType(ops[0]));
+  auto fused_op = util::make_unique<repr::GenericOperator>(pattern.fused_type);
+  fused_op->setLayout(first->getLayout());
+  fused_op->setAnnotation(std::move(annotation));
+
+  auto fused_node = graph.createNode(std::move(fused_op));
+  for (auto input : inputs) {
+    graph.createEdge(input, fused_node);
+  }
+  for (auto output : outputs) {
+    graph.createEdge(fused_node, output);
+  }
+  for (auto op : ops) {
+    graph.deleteNode(op);
+  }
+  for (auto tensor : chained) {
+    graph.deleteNode(tensor);
+  }
+}
+
+void fusePattern(repr::NNModule* nn, const FusionPattern& pattern) {
+  CAFFE_ENFORCE_GE(pattern.types.size(), 2, "Nothing to fuse");
+  CAFFE_ENFORCE(
+      pattern.chained_inputs.empty() ||
+          pattern.chained_inputs.size() + 1 == pattern.types.size(),
+      "Expected one chained input for each operator after the first");
+
+  // The operators are matched from the last one, up through their inputs
+  repr::nn::NNMatchGraph mg;
+  std::vector<repr::nn::NNMatchGraph::NodeRef> op_criteria;
+  for (size_t i = 0; i < pattern.types.size(); ++i) {
+    const auto type = pattern.types[i];
+    const bool last = i + 1 == pattern.types.size();
+    auto op = mg.createNode(
+        repr::nn::NNMatchPredicate([type, last](repr::NNGraph::NodeRef node) {
+          return repr::nn::is<repr::NeuralNetOperator>(node) &&
+              getOperatorType(node) == type &&
+              (last || repr::nn::hasSingleOutputAndConsumer(node));
+        }));
+    if (i == 0) {
+      mg.createEdge(mg.createNode(matchAnyTensor(-1)), op);
+    } else {
+      const int position =
+          pattern.chained_inputs.empty() ? 0 : pattern.chained_inputs[i - 1];
+      if (position > 0) {
+        mg.createEdge(mg.createNode(matchAnyTensor(position)), op);
+      }
+      auto chained = mg.createNode(
+          repr::nn::NNMatchPredicate([nn](repr::NNGraph::NodeRef node) {
+            return repr::nn::is<repr::Tensor>(node) && !nn->outputs.count(node);
+          }));
+      mg.createEdge(op_criteria.back(), chained);
+      mg.createEdge(chained, op);
+      mg.createEdge(mg.createNode(matchAnyTensor(-1)), op);
+    }
+    op_criteria.push_back(op);
+  }
+
+  mg.replaceSubgraph(
+      nn->dataFlow,
+      op_criteria.back(),
+      [&](repr::NNGraph& graph,
+          repr::NNGraph::NodeRef /* unused */,
+          const repr::nn::NNMatchGraph::SubgraphMatchResultType& result) {
+        std::vector<repr::NNGraph::NodeRef> ops;
+        for (auto criteria : op_criteria) {
+          ops.push_back(result.getMatchNodeMap()->at(criteria));
+        }
+        if (canFuse(pattern, ops)) {
+          fuse(graph, pattern, ops);
+        }
+        return true;
+      });
+}
+
+} // namespace
+
+void fusePatterns(
+    repr::NNModule* nn,
+    const std::vector<FusionPattern>& patterns) {
+  for (const auto& pattern : patterns) {
+    fusePattern(nn, pattern);
+  }
+}
+
+const std::vector<FusionPattern>& defaultFusionPatterns() {
+  static const std::vector<FusionPattern> patterns = {
+      {{"Conv", "Relu"}, "ConvRelu", {}, nullptr},
+      {{"Sum", "Relu"}, "SumRelu", {}, nullptr},
+  };
+  return patterns;
+}
+
+void fuseDefaultPatterns(repr::NNModule* nn) {
+  fusePatterns(nn, defaultFusionPatterns());
+}
+
 REGISTER_WS_OPT_PASS_FROM_FUNC(FuseConvBN, fuseConvBN);
+REGISTER_OPT_PASS_FROM_FUNC(FuseDefaultPatterns, fuseDefaultPatterns);
 
 } // namespace opt
 } // namespace caffe2
@@ -20,6 +20,10 @@
 #include "caffe2/core/workspace.h"
 #include "nomnigraph/Representations/NeuralNet.h"
 
+#include <functional>
+#include <string>
+#include <vector>
+
 namespace caffe2 {
 namespace opt {
 
@@ -27,6 +31,42 @@ using namespace nom;
 
 CAFFE2_API void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws);
 
+// A chain of operators to be replaced by a single fused operator, e.g.
+// Conv followed by Relu with ConvRelu.
+//
+// Each operator but the last must have a single output, consumed only by the
+// next operator of the chain and not an external output of the net. The fused
+// operator takes the inputs of the first operator, then the inputs of the
+// following ones other than the chained outputs, in order. It produces the
+// outputs of the last operator, and keeps the arguments of the first one.
+struct CAFFE2_API FusionPattern {
+  // The types of the chained operators, first to last
+  std::vector<std::string> types;
+  // The type of the fused operator
+  std::string fused_type;
+  // For each operator after the first, the position of the output of the
+  // previous operator in its inputs. Empty means 0 everywhere.
+  std::vector<int> chained_inputs;
+  // Application specific check of the matched operators, first to last
+  std::function<bool(const std::vector<repr::NNGraph::NodeRef>&)> should_fuse;
+};
+
+// Fuses the matches of each pattern, in order, using the subgraph matcher.
+// A match is only fused if all of its operators are on the same device type,
+// none of them asks for an engine (the fused operator may lack it), the fused
+// operator is registered for that device type, and the output of the fused
+// operator isn't one of its inputs.
+CAFFE2_API void fusePatterns(
+    repr::NNModule* nn,
+    const std::vector<FusionPattern>& patterns);
+
+// The fusions into fused operators of this tree: Conv + Relu into ConvRelu and
+// Sum + Relu into SumRelu. Patterns whose fused operator is not built are
+// skipped by fusePatterns.
+CAFFE2_API const std::vector<FusionPattern>& defaultFusionPatterns();
+
+CAFFE2_API void fuseDefaultPatterns(repr::NNModule* nn);
+
 // Generic activation fusion helper.
 //
 // \tparam OperationT The operator to be fused.
@@ -0,0 +1,137 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/fusion.h"
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+class FusionTestDummyOp final : public OperatorBase {
+ public:
+  using OperatorBase::OperatorBase;
+  bool Run(int /* unused */) override {
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(FusionTestConvRelu, FusionTestDummyOp);
+REGISTER_CPU_OPERATOR(FusionTestConvAddRelu, FusionTestDummyOp);
+
+OperatorDef* addOp(
+    NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::string& output) {
+  OperatorDef* def = net->add_op();
+  def->set_type(type);
+  for (const auto& input : inputs) {
+    def->add_input(input);
+  }
+  def->add_output(output);
+  return def;
+}
+
+NetDef fuse(const NetDef& net, const std::vector<opt::FusionPattern>& patterns) {
+  auto nn = convertToNNModule(net);
+  opt::fusePatterns(&nn, patterns);
+  return convertToCaffe2Proto(nn, net);
+}
+
+} // namespace
+
+TEST(FusionTest, ChainWithInPlaceActivation) {
+  NetDef net;
+  addOp(&net, "FusionTestConv", {"X", "W"}, "Y");
+  addOp(&net, "Relu", {"Y"}, "Y");
+  addOp(&net, "Sigmoid", {"Y"}, "Z");
+  net.add_external_input("X");
+  net.add_external_input("W");
+  net.add_external_output("Z");
+
+  auto fused =
+      fuse(net, {{{"FusionTestConv", "Relu"}, "FusionTestConvRelu", {}, {}}});
+  ASSERT_EQ(fused.op_size(), 2);
+  EXPECT_EQ(fused.op(0).type(), "FusionTestConvRelu");
+  ASSERT_EQ(fused.op(0).input_size(), 2);
+  EXPECT_EQ(fused.op(0).input(0), "X");
+  EXPECT_EQ(fused.op(0).input(1), "W");
+  ASSERT_EQ(fused.op(0).output_size(), 1);
+  EXPECT_EQ(fused.op(0).output(0), "Y");
+  EXPECT_EQ(fused.op(1).type(), "Sigmoid");
+}
+
+TEST(FusionTest, ChainedInputPosition) {
+  NetDef net;
+  addOp(&net, "FusionTestConv", {"X", "W"}, "C");
+  addOp(&net, "Add", {"S", "C"}, "A");
+  addOp(&net, "Relu", {"A"}, "Y");
+  net.add_external_input("X");
+  net.add_external_input("W");
+  net.add_external_input("S");
+  net.add_external_output("Y");
+
+  const opt::FusionPattern pattern = {
+      {"FusionTestConv", "Add", "Relu"}, "FusionTestConvAddRelu", {1, 0}, {}};
+  auto fused = fuse(net, {pattern});
+  ASSERT_EQ(fused.op_size(), 1);
+  EXPECT_EQ(fused.op(0).type(), "FusionTestConvAddRelu");
+  ASSERT_EQ(fused.op(0).input_size(), 3);
+  EXPECT_EQ(fused.op(0).input(0), "X");
+  EXPECT_EQ(fused.op(0).input(1), "W");
+  EXPECT_EQ(fused.op(0).input(2), "S");
+  EXPECT_EQ(fused.op(0).output(0), "Y");
+
+  // The output of the convolution isn't the first input of the Add
+  auto wrong_position = pattern;
+  wrong_position.chained_inputs = {0, 0};
+  EXPECT_EQ(fuse(net, {wrong_position}).op_size(), 3);
+}
+
+TEST(FusionTest, NoFusion) {
+  const opt::FusionPattern pattern = {
+      {"FusionTestConv", "Relu"}, "FusionTestConvRelu", {}, {}};
+
+  // The intermediate output has another consumer
+  {
+    NetDef net;
+    addOp(&net, "FusionTestConv", {"X", "W"}, "C");
+    addOp(&net, "Relu", {"C"}, "Y");
+    addOp(&net, "Sigmoid", {"C"}, "Z");
+    net.add_external_input("X");
+    net.add_external_input("W");
+    net.add_external_output("Y");
+    net.add_external_output("Z");
+    EXPECT_EQ(fuse(net, {pattern}).op_size(), 3);
+  }
+
+  // The fused operator isn't registered
+  {
+    NetDef net;
+    addOp(&net, "FusionTestConv", {"X", "W"}, "C");
+    addOp(&net, "Relu", {"C"}, "Y");
+    net.add_external_input("X");
+    net.add_external_input("W");
+    net.add_external_output("Y");
+    auto unregistered = pattern;
+    unregistered.fused_type = "FusionTestUnregistered";
+    EXPECT_EQ(fuse(net, {unregistered}).op_size(), 2);
+
+    // An engine is requested
+    net.mutable_op(0)->set_engine("FUSION_TEST");
+    EXPECT_EQ(fuse(net, {pattern}).op_size(), 2);
+
+    // Application specific check
+    net.mutable_op(0)->clear_engine();
+    auto rejected = pattern;
+    rejected.should_fuse = [](const std::vector<nom::repr::NNGraph::NodeRef>&) {
+      return false;
+    };
+    EXPECT_EQ(fuse(net, {rejected}).op_size(), 2);
+    EXPECT_EQ(fuse(net, {pattern}).op_size(), 1);
+  }
+}
+
+} // namespace caffe2
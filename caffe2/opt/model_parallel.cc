@@ -0,0 +1,274 @@
+#include "caffe2/opt/model_parallel.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace caffe2 {
+namespace opt {
+
+namespace {
+
+struct OpInfo {
+  double cost{0};
+  // The blobs read and written by the op, without duplicates, with their size
+  std::vector<std::pair<std::string, double>> inputs;
+  std::vector<std::pair<std::string, double>> outputs;
+};
+
+double DefaultOpCost(
+    const caffe2::OperatorDef& op,
+    const std::vector<TensorShape>& inputs) {
+  const auto* schema = OpSchemaRegistry::Schema(op.type());
+  if (!schema || !schema->HasCostInferenceFunction()) {
+    return 0;
+  }
+  for (const auto& input : inputs) {
+    if (input.unknown_shape()) {
+      return 0;
+    }
+  }
+  try {
+    return schema->InferCost(op, inputs).flops;
+  } catch (const std::exception& e) {
+    VLOG(1) << "Cost inference failed for " << op.type() << ": " << e.what();
+    return 0;
+  }
+}
+
+std::vector<OpInfo> GetOpInfos(
+    const caffe2::NetDef& net,
+    const CaffeMap<std::string, std::vector<int64_t>>& input_dims,
+    const ModelParallelOptions& options) {
+  caffe2::NetDef net_copy(net);
+  std::unordered_map<std::string, TensorShape> shapes;
+  for (const auto& shape :
+       InferBlobShapesAndTypesFromMap(input_dims, {&net_copy}).shapes()) {
+    shapes.emplace(shape.name(), shape);
+  }
+  auto shape_of = [&shapes](const std::string& name) {
+    const auto it = shapes.find(name);
+    if (it != shapes.end()) {
+      return it->second;
+    }
+    TensorShape unknown;
+    unknown.set_unknown_shape(true);
+    return unknown;
+  };
+  auto bytes_of = [](const TensorShape& shape) {
+    if (shape.unknown_shape()) {
+      return 0.0;
+    }
+    double numel = 1;
+    for (const auto d : shape.dims()) {
+      numel *= d;
+    }
+    return numel * DataTypeToTypeMeta(shape.data_type()).itemsize();
+  };
+
+  const auto& op_cost = options.op_cost ? options.op_cost : DefaultOpCost;
+  std::vector<OpInfo> infos(net.op_size());
+  for (int i = 0; i < net.op_size(); ++i) {
+    const auto& op = net.op(i);
+    auto& info = infos[i];
+    std::vector<TensorShape> input_shapes;
+    std::unordered_set<std::string> seen;
+    for (const auto& input : op.input()) {
+      const auto shape = shape_of(input);
+      input_shapes.push_back(shape);
+      if (seen.insert(input).second) {
+        info.inputs.emplace_back(input, bytes_of(shape));
+      }
+    }
+    // In-place outputs are already counted as inputs
+    for (const auto& output : op.output()) {
+      if (seen.insert(output).second) {
+        info.outputs.emplace_back(output, bytes_of(shape_of(output)));
+      }
+    }
+    info.cost = op_cost(op, input_shapes);
+  }
+  return infos;
+}
+
+// Assigns the ops to the devices in order, moving on to the next device when
+// the next op would take the current one over `max_cost` or out of memory.
+// Returns false if the ops don't fit on the devices.
+bool AssignDevices(
+    const std::vector<OpInfo>& ops,
+    const ModelParallelOptions& options,
+    double max_cost,
+    std::vector<int>* devices) {
+  const int num_devices = options.device_memory.size();
+  devices->assign(ops.size(), 0);
+  // The blobs that have been placed or produced on some device
+  std::unordered_set<std::string> placed;
+  // The blobs on the current device
+  std::unordered_set<std::string> resident;
+  int device = 0;
+  double cost = 0;
+  double memory = 0;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    const auto& op = ops[i];
+    double op_cost;
+    double op_memory;
+    while (true) {
+      op_cost = op.cost;
+      op_memory = 0;
+      for (const auto& input : op.inputs) {
+        if (resident.count(input.first)) {
+          continue;
+        }
+        op_memory += input.second;
+        if (placed.count(input.first)) {
+          op_cost += input.second * options.transfer_cost_per_byte;
+        }
+      }
+      for (const auto& output : op.outputs) {
+        if (!resident.count(output.first)) {
+          op_memory += output.second;
+        }
+      }
+      if (cost + op_cost <= max_cost &&
+          memory + op_memory <= options.device_memory[device]) {
+        break;
+      }
+      // Doesn't fit even on a device of its own
+      if (resident.empty() || ++device == num_devices) {
+        return false;
+      }
+      cost = 0;
+      memory = 0;
+      resident.clear();
+    }
+
+    cost += op_cost;
+    memory += op_memory;
+    for (const auto* blobs : {&op.inputs, &op.outputs}) {
+      for (const auto& blob : *blobs) {
+        placed.insert(blob.first);
+        resident.insert(blob.first);
+      }
+    }
+    (*devices)[i] = device;
+  }
+  return true;
+}
+
+} // namespace
+
+caffe2::NetDef PartitionForModelParallel(
+    const caffe2::NetDef& net,
+    const CaffeMap<std::string, std::vector<int64_t>>& input_dims,
+    const ModelParallelOptions& options,
+    std::map<std::string, int>* input_devices) {
+  CAFFE_ENFORCE(!options.device_memory.empty(), "No devices to partition on");
+  if (net.op_size() == 0) {
+    return net;
+  }
+  const auto ops = GetOpInfos(net, input_dims, options);
+
+  // Binary search of the cost of the most expensive partition, which can't
+  // be more than the cost of all the ops with all their inputs transferred
+  double low = 0;
+  double high = 1;
+  for (const auto& op : ops) {
+    high += op.cost;
+    for (const auto& input : op.inputs) {
+      high += input.second * options.transfer_cost_per_byte;
+    }
+  }
+  std::vector<int> devices;
+  CAFFE_ENFORCE(
+      AssignDevices(ops, options, high, &devices),
+      "Net ",
+      net.name(),
+      " doesn't fit in the memory of the ",
+      options.device_memory.size(),
+      " devices");
+  for (int iter = 0; iter < 64 && low < high * (1 - 1e-6); ++iter) {
+    const double mid = (low + high) / 2;
+    if (AssignDevices(ops, options, mid, &devices)) {
+      high = mid;
+    } else {
+      low = mid;
+    }
+  }
+  AssignDevices(ops, options, high, &devices);
+
+  // The copies to run after each op, or before all of them for the copies of
+  // the external inputs
+  std::vector<std::vector<caffe2::OperatorDef>> copies_after(net.op_size() + 1);
+  // The device of the current version of each blob and the op producing it
+  std::unordered_map<std::string, std::pair<int, int>> locations;
+  // The copies of the current version of each blob on the other devices
+  std::map<std::pair<std::string, int>, std::string> copies;
+  std::vector<caffe2::OperatorDef> partitioned_ops(
+      net.op().begin(), net.op().end());
+  for (int i = 0; i < net.op_size(); ++i) {
+    auto& op = partitioned_ops[i];
+    const int device = devices[i];
+    op.mutable_device_option()->set_device_type(options.device_type);
+    op.mutable_device_option()->set_device_id(device);
+
+    for (int j = 0; j < op.input_size(); ++j) {
+      const auto name = op.input(j);
+      auto location = locations.find(name);
+      if (location == locations.end()) {
+        location =
+            locations.emplace(name, std::make_pair(device, -1)).first;
+        if (input_devices) {
+          (*input_devices)[name] = device;
+        }
+      }
+      if (location->second.first == device) {
+        continue;
+      }
+      const auto key = std::make_pair(name, device);
+      auto copy = copies.find(key);
+      if (copy == copies.end()) {
+        const auto copy_name = c10::str(name, "_gpu", device);
+        caffe2::OperatorDef copy_op;
+        copy_op.set_type("Copy");
+        copy_op.add_input(name);
+        copy_op.add_output(copy_name);
+        copy_op.mutable_device_option()->set_device_type(options.device_type);
+        copy_op.mutable_device_option()->set_device_id(device);
+        copies_after[location->second.second + 1].push_back(copy_op);
+        copy = copies.emplace(key, copy_name).first;
+      }
+      op.set_input(j, copy->second);
+    }
+
+    for (const auto& output : op.output()) {
+      locations[output] = std::make_pair(device, i);
+      for (int d = 0; d < static_cast<int>(options.device_memory.size());
+           ++d) {
+        copies.erase(std::make_pair(output, d));
+      }
+    }
+  }
+
+  caffe2::NetDef partitioned_net(net);
+  partitioned_net.clear_op();
+  for (const auto& copy_op : copies_after[0]) {
+    partitioned_net.add_op()->CopyFrom(copy_op);
+  }
+  for (int i = 0; i < net.op_size(); ++i) {
+    partitioned_net.add_op()->CopyFrom(partitioned_ops[i]);
+    for (const auto& copy_op : copies_after[i + 1]) {
+      partitioned_net.add_op()->CopyFrom(copy_op);
+    }
+  }
+  VLOG(1) << "Partitioned net " << net.name() << " on "
+          << devices.back() + 1 << " devices with a cost of at most "
+          << high;
+  return partitioned_net;
+}
+
+} // namespace opt
+} // namespace caffe2
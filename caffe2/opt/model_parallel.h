@@ -0,0 +1,50 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/operator_schema.h"
+#include "caffe2/proto/caffe2_pb.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace caffe2 {
+namespace opt {
+
+struct CAFFE2_API ModelParallelOptions {
+  // The memory available to the net on each of the devices, in bytes
+  std::vector<size_t> device_memory;
+  int32_t device_type{PROTO_CUDA};
+  // The cost of running an op given the shapes of its inputs. Defaults to
+  // the FLOPs of its cost inference function, or 0 if it has none.
+  std::function<double(const OperatorDef&, const std::vector<TensorShape>&)>
+      op_cost;
+  // The cost of moving a byte between two devices, in the unit of op_cost:
+  // by default about the FLOPs a GPU does while a byte goes over PCIe.
+  double transfer_cost_per_byte{1000};
+};
+
+// Splits a net that doesn't fit on one device across the devices of
+// options.device_memory. The ops are cut, in their order, into one contiguous
+// partition per device, so that only the blobs live across a cut move between
+// devices. The cuts are chosen so that the most expensive partition, counting
+// its ops and the transfers of its inputs, is as cheap as possible, while the
+// blobs it produces or reads fit in the memory of its device. The memory of a
+// blob is never counted as reused, and the blobs of unknown shape, inferred
+// from `input_dims`, count as empty.
+//
+// Returns the net with the device option of each op set to its partition, and
+// a Copy of each blob read on another device than the one it is on, right
+// after the op that produced it so that async nets overlap it with compute.
+// `input_devices` receives the device of each external input, which is the
+// one of its first reader and where the caller must put its blob, e.g. by
+// running the init net with the same placement.
+CAFFE2_API caffe2::NetDef PartitionForModelParallel(
+    const caffe2::NetDef& net,
+    const CaffeMap<std::string, std::vector<int64_t>>& input_dims,
+    const ModelParallelOptions& options,
+    std::map<std::string, int>* input_devices = nullptr);
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,97 @@
+#include "caffe2/core/common.h"
+#include "caffe2/opt/model_parallel.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// X -> FC -> N1 -> FC -> N2 -> FC -> N3 -> FC -> Y
+caffe2::NetDef FCChain(
+    int num_fcs,
+    caffe2::CaffeMap<std::string, std::vector<int64_t>>* input_dims) {
+  caffe2::NetDef net;
+  net.add_external_input("X");
+  (*input_dims)["X"] = {16, 256};
+  for (int i = 0; i < num_fcs; ++i) {
+    auto* op = net.add_op();
+    op->set_type("FC");
+    op->add_input(i == 0 ? "X" : "N" + c10::to_string(i));
+    op->add_input("W" + c10::to_string(i));
+    op->add_input("b" + c10::to_string(i));
+    op->add_output(i == num_fcs - 1 ? "Y" : "N" + c10::to_string(i + 1));
+    net.add_external_input("W" + c10::to_string(i));
+    net.add_external_input("b" + c10::to_string(i));
+    (*input_dims)["W" + c10::to_string(i)] = {256, 256};
+    (*input_dims)["b" + c10::to_string(i)] = {256};
+  }
+  net.add_external_output("Y");
+  return net;
+}
+
+void ExpectDevices(
+    const caffe2::NetDef& net,
+    const std::vector<int>& fc_devices,
+    int num_copies) {
+  std::vector<int> devices;
+  int copies = 0;
+  for (const auto& op : net.op()) {
+    EXPECT_EQ(caffe2::PROTO_CUDA, op.device_option().device_type());
+    if (op.type() == "FC") {
+      devices.push_back(op.device_option().device_id());
+    } else {
+      EXPECT_EQ("Copy", op.type());
+      copies++;
+    }
+  }
+  EXPECT_EQ(fc_devices, devices);
+  EXPECT_EQ(num_copies, copies);
+}
+
+} // namespace
+
+TEST(ModelParallelTest, balancesCompute) {
+  caffe2::CaffeMap<std::string, std::vector<int64_t>> input_dims;
+  auto net = FCChain(4, &input_dims);
+  caffe2::opt::ModelParallelOptions options;
+  options.device_memory = {1 << 30, 1 << 30};
+  options.transfer_cost_per_byte = 1;
+  std::map<std::string, int> input_devices;
+  auto net_opt = caffe2::opt::PartitionForModelParallel(
+      net, input_dims, options, &input_devices);
+  ExpectDevices(net_opt, {0, 0, 1, 1}, 1);
+  EXPECT_EQ(0, input_devices.at("X"));
+  EXPECT_EQ(0, input_devices.at("W1"));
+  EXPECT_EQ(1, input_devices.at("W2"));
+  // The copy of N2 to the second device goes right after its producer
+  EXPECT_EQ("Copy", net_opt.op(2).type());
+  EXPECT_EQ("N2", net_opt.op(2).input(0));
+  EXPECT_EQ(net_opt.op(2).output(0), net_opt.op(3).input(0));
+}
+
+TEST(ModelParallelTest, expensiveTransfers) {
+  caffe2::CaffeMap<std::string, std::vector<int64_t>> input_dims;
+  auto net = FCChain(4, &input_dims);
+  caffe2::opt::ModelParallelOptions options;
+  options.device_memory = {1 << 30, 1 << 30};
+  options.transfer_cost_per_byte = 1000;
+  auto net_opt =
+      caffe2::opt::PartitionForModelParallel(net, input_dims, options);
+  ExpectDevices(net_opt, {0, 0, 0, 0}, 0);
+}
+
+TEST(ModelParallelTest, memoryLimit) {
+  caffe2::CaffeMap<std::string, std::vector<int64_t>> input_dims;
+  auto net = FCChain(4, &input_dims);
+  caffe2::opt::ModelParallelOptions options;
+  // Room for the weights of two FCs
+  options.device_memory = {700 * 1024, 700 * 1024};
+  options.transfer_cost_per_byte = 1000;
+  auto net_opt =
+      caffe2::opt::PartitionForModelParallel(net, input_dims, options);
+  ExpectDevices(net_opt, {0, 0, 1, 1}, 1);
+
+  options.device_memory = {300 * 1024, 300 * 1024};
+  EXPECT_THROW(
+      caffe2::opt::PartitionForModelParallel(net, input_dims, options),
+      caffe2::EnforceNotMet);
+}
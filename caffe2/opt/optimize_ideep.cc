@@ -99,6 +99,26 @@ void resetConvForFusion(repr::NNGraph::NodeRef convNode, int fusion_type) {
   arg->set_i(fusion_type);
 }
 
+void resetFCForFusion(repr::NNGraph::NodeRef fcNode) {
+  // Fusion types:
+  // FUSION_FC_RELU = 1
+  auto fc = repr::nn::get<repr::FC>(fcNode);
+  auto annotation = fc->getMutableAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return;
+  }
+
+  auto* op = getMutableOpDef(*fc);
+  if (op == nullptr) {
+    return;
+  }
+
+  op->set_type("FCFusion");
+  auto* arg = op->add_arg();
+  arg->set_name("fusion_type");
+  arg->set_i(1);
+}
+
 bool fuseConvBNAndAffChHelperForIdeep(repr::NNModule* nn, caffe2::Workspace* ws) {
   auto isAffineChannelNode = [](const repr::NNGraph::NodeRef& node) {
     if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
@@ -219,6 +239,12 @@ bool fuseConvBNAndAffChHelperForIdeep(repr::NNModule* nn, caffe2::Workspace* ws)
 
     filter->reorder_from(filterTensor);
     biasConv->reorder_from(biasConvTensor);
+    // The filter is rewritten in place, in the buffer it was cached from
+    auto cacheName = IDEEPWeightsCacheName(
+        repr::nn::get<repr::Tensor>(convInputs[1])->getName());
+    if (ws->HasBlob(cacheName)) {
+      getTensor<IDEEPWeightsCache>(ws->GetBlob(cacheName))->Clear();
+    }
     nn->dataFlow.replaceNode(convOutput, bnOrAffChOutput);
 
     nn->dataFlow.deleteNode(bnOrAffChNode);
@@ -334,6 +360,10 @@ void fuseActivationForIdeep(repr::NNModule* nn) {
   auto should_fuse = shouldFuseConv;
   auto postprocess = std::bind(resetConvForFusion, std::placeholders::_1, 1);
   fuseActivation<repr::Conv, repr::Relu>(nn, should_fuse, postprocess);
+
+  // FC+Relu fusion
+  auto should_fuse_fc = [](const repr::FC& fc) { return isOnIdeepDevice(fc); };
+  fuseActivation<repr::FC, repr::Relu>(nn, should_fuse_fc, resetFCForFusion);
 }
 
 void enforceFusionInplaceForIdeep(repr::NNModule* nn) {
@@ -420,6 +450,37 @@ void setPoolingInferenceMode(repr::NNModule *nn) {
   }
 }
 
+void shareWeightsCacheForIdeep(repr::NNModule* nn) {
+  // Inference weights are constant, so the reordered ones are shared by the
+  // convolutions of all the nets of the workspace.
+  for (auto node_pair : repr::nn::dataIterator<repr::Conv>(nn->dataFlow)) {
+    repr::NNGraph::NodeRef convNode;
+    repr::Conv* conv;
+    std::tie(conv, convNode) = node_pair;
+
+    if (!isOnIdeepDevice(*conv)) {
+      LOG(WARNING) << "Not a IDEEP operator";
+      continue;
+    }
+
+    auto* op = getMutableOpDef(*conv);
+    bool found_share_weights_cache = false;
+    for (auto& arg : *op->mutable_arg()) {
+      if (arg.name() == "share_weights_cache") {
+        arg.set_i(1);
+        found_share_weights_cache = true;
+        break;
+      }
+    }
+
+    if (!found_share_weights_cache) {
+      auto* arg = op->add_arg();
+      arg->set_name("share_weights_cache");
+      arg->set_i(1);
+    }
+  }
+}
+
 void OptimizeForIdeep(
     repr::NNModule* nn,
     caffe2::Workspace* ws,
@@ -438,6 +499,8 @@ void OptimizeForIdeep(
   enforceFusionInplaceForIdeep(nn);
 
   setPoolingInferenceMode(nn);
+
+  shareWeightsCacheForIdeep(nn);
 }
 
 #endif // CAFFE2_USE_MKLDNN
@@ -24,6 +24,7 @@ void graphOptimzations(nom::repr::NNModule* nn, int level) {
       opt::addNNPACK(nn, false);
       opt::fuseNNPACKConvRelu(nn);
 #endif
+      opt::fuseDefaultPatterns(nn);
     case 0:
     default:
       break;
@@ -0,0 +1,523 @@
+#include "caffe2/opt/storage_order.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator_schema.h"
+#include "caffe2/opt/annotations.h"
+#include "caffe2/opt/passes.h"
+
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace caffe2 {
+namespace opt {
+
+using namespace nom;
+
+namespace {
+
+using NodeRef = repr::NNGraph::NodeRef;
+using EdgeRef = repr::NNGraph::EdgeRef;
+using NNLayout = repr::NeuralNetOperator::NNLayout;
+
+const char* const kNCHW2NHWC = "NCHW2NHWC";
+const char* const kNHWC2NCHW = "NHWC2NCHW";
+
+const caffe2::Caffe2Annotation* getCaffe2Annotation(NodeRef node) {
+  auto annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<caffe2::Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return dyn_cast<caffe2::Caffe2Annotation>(annotation);
+}
+
+std::string getOperatorType(NodeRef node) {
+  auto annotation = getCaffe2Annotation(node);
+  return annotation && annotation->hasOperatorDef()
+      ? annotation->getOperatorDef().type()
+      : repr::nn::get<repr::NeuralNetOperator>(node)->getName();
+}
+
+int getDeviceType(NodeRef node) {
+  auto annotation = getCaffe2Annotation(node);
+  return annotation ? annotation->getDeviceType() : caffe2::PROTO_CPU;
+}
+
+std::string getEngine(NodeRef node) {
+  auto annotation = getCaffe2Annotation(node);
+  return annotation && annotation->hasOperatorDef()
+      ? annotation->getOperatorDef().engine()
+      : "";
+}
+
+NNLayout getStorageOrder(NodeRef node) {
+  return repr::nn::get<repr::NeuralNetOperator>(node)->getLayout() ==
+          NNLayout::NHWC
+      ? NNLayout::NHWC
+      : NNLayout::NCHW;
+}
+
+// The operator converting data from one order to the other
+const char* getOrderSwitch(NNLayout from) {
+  return from == NNLayout::NCHW ? kNCHW2NHWC : kNHWC2NCHW;
+}
+
+// Whether node is a CPU operator of the given type with a single input and a
+// single output.
+bool isOrderSwitch(NodeRef node, const char* type) {
+  return repr::nn::is<repr::NeuralNetOperator>(node) &&
+      getOperatorType(node) == type &&
+      getDeviceType(node) == caffe2::PROTO_CPU &&
+      node->getInEdges().size() == 1 && node->getOutEdges().size() == 1;
+}
+
+// The inputs and the outputs of an operator that are in its storage order.
+struct OrderSlots {
+  bool dependent;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+
+  bool hasInput(int index) const {
+    return !dependent ||
+        std::find(inputs.begin(), inputs.end(), index) != inputs.end();
+  }
+
+  bool hasOutput(int index) const {
+    return !dependent ||
+        std::find(outputs.begin(), outputs.end(), index) != outputs.end();
+  }
+};
+
+using OrderSlotsMap = std::unordered_map<NodeRef, OrderSlots>;
+
+// The operators that can run in both orders
+OrderSlotsMap getOrderSlots(repr::NNModule* nn) {
+  OrderSlotsMap slots;
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    NOM_REQUIRE_OR_CONT(repr::nn::is<repr::NeuralNetOperator>(node));
+    NOM_REQUIRE_OR_CONT(getDeviceType(node) == caffe2::PROTO_CPU);
+    // The DNNLOWP engines run in both orders, most others in only one
+    const auto engine = getEngine(node);
+    NOM_REQUIRE_OR_CONT(engine.empty() || engine.compare(0, 7, "DNNLOWP") == 0);
+    auto schema = OpSchemaRegistry::Schema(getOperatorType(node));
+    NOM_REQUIRE_OR_CONT(schema);
+    if (schema->storage_order_dependent()) {
+      slots[node] = {
+          true, schema->storage_order_inputs(), schema->storage_order_outputs()};
+    } else if (schema->storage_order_agnostic()) {
+      slots[node] = {false, {}, {}};
+    }
+  }
+  return slots;
+}
+
+int getInputIndex(EdgeRef edge) {
+  const auto& edges = edge->head()->getInEdges();
+  return std::find(edges.begin(), edges.end(), edge) - edges.begin();
+}
+
+int getOutputIndex(EdgeRef edge) {
+  const auto& edges = edge->tail()->getOutEdges();
+  return std::find(edges.begin(), edges.end(), edge) - edges.begin();
+}
+
+// Whether the tensor -> operator edge is an input in the storage order
+bool isOrderInput(const OrderSlotsMap& slots, EdgeRef edge) {
+  auto it = slots.find(edge->head());
+  return it != slots.end() && it->second.hasInput(getInputIndex(edge));
+}
+
+// Whether the operator -> tensor edge is an output in the storage order
+bool isOrderOutput(const OrderSlotsMap& slots, EdgeRef edge) {
+  auto it = slots.find(edge->tail());
+  return it != slots.end() && it->second.hasOutput(getOutputIndex(edge));
+}
+
+// Points edge, whose head is an operator, to the tensor input
+void setInput(EdgeRef edge, NodeRef input) {
+  edge->tail()->removeOutEdge(edge);
+  edge->setTail(input);
+  input->addOutEdge(edge);
+}
+
+// Points edge, whose tail is an operator, to the tensor output
+void setOutput(EdgeRef edge, NodeRef output) {
+  edge->head()->removeInEdge(edge);
+  edge->setHead(output);
+  output->addInEdge(edge);
+}
+
+// The number of versions of each tensor name, to tell which tensor nodes
+// hold the only value of their blob.
+class TensorNames {
+ public:
+  explicit TensorNames(repr::NNModule* nn) {
+    for (auto node : nn->dataFlow.getMutableNodes()) {
+      if (repr::nn::is<repr::NeuralNetData>(node)) {
+        ++counts_[repr::nn::getName(node)];
+      }
+    }
+  }
+
+  bool isOnlyVersion(NodeRef tensor) const {
+    return counts_.at(repr::nn::getName(tensor)) == 1;
+  }
+
+  std::string createName(const std::string& base) {
+    std::string name = base;
+    for (int i = 1; counts_.count(name); ++i) {
+      name = base + "_" + c10::to_string(i);
+    }
+    counts_[name] = 1;
+    return name;
+  }
+
+ private:
+  std::unordered_map<std::string, int> counts_;
+};
+
+NodeRef createTensor(
+    repr::NNModule* nn,
+    NodeRef like,
+    NNLayout order,
+    TensorNames* names) {
+  const auto suffix = order == NNLayout::NHWC ? "_nhwc" : "_nchw";
+  return nn->dataFlow.createNode(util::make_unique<repr::Tensor>(
+      names->createName(repr::nn::getName(like) + suffix)));
+}
+
+void insertOrderSwitch(
+    repr::NNModule* nn,
+    NodeRef input,
+    NodeRef output,
+    NNLayout from) {
+  const char* type = getOrderSwitch(from);
+  caffe2::OperatorDef def;
+  def.set_type(type);
+  auto annotation = util::make_unique<caffe2::Caffe2Annotation>();
+  annotation->setOperatorDef(def);
+  annotation->setDeviceType(caffe2::PROTO_CPU);
+  auto op = util::make_unique<repr::GenericOperator>(type);
+  op->setAnnotation(std::move(annotation));
+  auto node = nn->dataFlow.createNode(std::move(op));
+  nn->dataFlow.createEdge(input, node);
+  nn->dataFlow.createEdge(node, output);
+}
+
+// A tensor used in the storage order by a region without being produced in
+// it, and how to get it in the other order.
+struct RegionInput {
+  NodeRef tensor;
+  std::vector<EdgeRef> uses;
+  // The input of the order switch producing tensor, if it has the other order
+  NodeRef source;
+  // Whether the region is the only user of that switch
+  bool remove_switch;
+};
+
+// A tensor produced in the storage order by a region and used outside of it.
+struct RegionOutput {
+  EdgeRef edge;
+  std::vector<EdgeRef> inside_uses;
+  // The order switches consuming the tensor, which become useless
+  std::vector<NodeRef> switches;
+  // Whether the tensor is also needed in the current order
+  bool convert_back;
+};
+
+class Region {
+ public:
+  Region(repr::NNModule* nn, const OrderSlotsMap& slots)
+      : nn_(nn), slots_(slots) {}
+
+  void add(NodeRef node) {
+    ops_.push_back(node);
+    members_.insert(node);
+  }
+
+  bool contains(NodeRef node) const {
+    return members_.count(node);
+  }
+
+  const std::vector<NodeRef>& ops() const {
+    return ops_;
+  }
+
+  // The order of the region, or Undefined if it has no order dependent
+  // operators or they don't agree.
+  NNLayout getOrder() const {
+    NNLayout order = NNLayout::Undefined;
+    for (auto op : ops_) {
+      NOM_REQUIRE_OR_CONT(slots_.at(op).dependent);
+      const auto op_order = getStorageOrder(op);
+      if (order != NNLayout::Undefined && order != op_order) {
+        return NNLayout::Undefined;
+      }
+      order = op_order;
+    }
+    return order;
+  }
+
+  // Collects the boundaries of the region, and returns the change in the
+  // number of order switches of the net if the region changed order.
+  int plan(NNLayout order, const TensorNames& names) {
+    inputs_.clear();
+    outputs_.clear();
+    const char* to_order = getOrderSwitch(flip(order));
+    const char* from_order = getOrderSwitch(order);
+    int cost = 0;
+
+    std::unordered_map<NodeRef, size_t> input_index;
+    for (auto op : ops_) {
+      for (auto edge : op->getInEdges()) {
+        NOM_REQUIRE_OR_CONT(isOrderInput(slots_, edge));
+        auto tensor = edge->tail();
+        if (repr::nn::hasProducer(tensor)) {
+          auto producer_edge = tensor->getInEdges().front();
+          NOM_REQUIRE_OR_CONT(
+              !contains(producer_edge->tail()) ||
+              !isOrderOutput(slots_, producer_edge));
+        }
+        auto it = input_index.find(tensor);
+        if (it == input_index.end()) {
+          it = input_index.emplace(tensor, inputs_.size()).first;
+          inputs_.push_back({tensor, {}, nullptr, false});
+        }
+        inputs_[it->second].uses.push_back(edge);
+      }
+    }
+    for (auto& input : inputs_) {
+      if (repr::nn::hasProducer(input.tensor)) {
+        auto producer = repr::nn::getProducer(input.tensor);
+        auto source = producer->getInEdges().front()->tail();
+        if (isOrderSwitch(producer, to_order) && names.isOnlyVersion(source)) {
+          input.source = source;
+          input.remove_switch =
+              input.tensor->getOutEdges().size() == input.uses.size() &&
+              !nn_->outputs.count(input.tensor);
+        }
+      }
+      cost += input.source ? (input.remove_switch ? -1 : 0) : 1;
+    }
+
+    for (auto op : ops_) {
+      for (auto edge : op->getOutEdges()) {
+        NOM_REQUIRE_OR_CONT(isOrderOutput(slots_, edge));
+        auto tensor = edge->head();
+        RegionOutput output{edge, {}, {}, nn_->outputs.count(tensor) > 0};
+        for (auto use : tensor->getOutEdges()) {
+          auto consumer = use->head();
+          if (contains(consumer) && isOrderInput(slots_, use)) {
+            output.inside_uses.push_back(use);
+          } else if (
+              isOrderSwitch(consumer, from_order) &&
+              !nn_->outputs.count(repr::nn::getOutputs(consumer).front())) {
+            output.switches.push_back(consumer);
+          } else {
+            output.convert_back = true;
+          }
+        }
+        NOM_REQUIRE_OR_CONT(
+            output.convert_back || !output.switches.empty());
+        cost += (output.convert_back ? 1 : 0) -
+            static_cast<int>(output.switches.size());
+        outputs_.push_back(std::move(output));
+      }
+    }
+    return cost;
+  }
+
+  // Changes the order of the region according to the last plan
+  void convert(
+      NNLayout order,
+      TensorNames* names,
+      std::unordered_map<NodeRef, NodeRef>* converted) {
+    const auto new_order = flip(order);
+    for (auto op : ops_) {
+      if (slots_.at(op).dependent) {
+        repr::nn::get<repr::NeuralNetOperator>(op)->setLayout(new_order);
+      }
+    }
+
+    for (const auto& input : inputs_) {
+      NodeRef new_input = input.source;
+      if (!new_input) {
+        auto it = converted->find(input.tensor);
+        if (it == converted->end()) {
+          auto tensor = createTensor(nn_, input.tensor, new_order, names);
+          insertOrderSwitch(nn_, input.tensor, tensor, order);
+          it = converted->emplace(input.tensor, tensor).first;
+        }
+        new_input = it->second;
+      }
+      for (auto use : input.uses) {
+        setInput(use, new_input);
+      }
+      if (input.remove_switch) {
+        nn_->dataFlow.deleteNode(repr::nn::getProducer(input.tensor));
+        nn_->dataFlow.deleteNode(input.tensor);
+      }
+    }
+
+    for (const auto& output : outputs_) {
+      auto tensor = output.edge->head();
+      auto new_output = createTensor(nn_, tensor, new_order, names);
+      setOutput(output.edge, new_output);
+      for (auto use : output.inside_uses) {
+        setInput(use, new_output);
+      }
+      for (auto order_switch : output.switches) {
+        auto switched = repr::nn::getOutputs(order_switch).front();
+        repr::nn::replaceAllUsesWith(switched, new_output);
+        nn_->dataFlow.deleteNode(order_switch);
+        nn_->dataFlow.deleteNode(switched);
+      }
+      if (output.convert_back) {
+        // The other users keep the original tensor, now written by the switch
+        insertOrderSwitch(nn_, new_output, tensor, new_order);
+      } else {
+        nn_->dataFlow.deleteNode(tensor);
+      }
+    }
+  }
+
+ private:
+  static NNLayout flip(NNLayout order) {
+    return order == NNLayout::NCHW ? NNLayout::NHWC : NNLayout::NCHW;
+  }
+
+  repr::NNModule* nn_;
+  const OrderSlotsMap& slots_;
+  std::vector<NodeRef> ops_;
+  std::unordered_set<NodeRef> members_;
+  std::vector<RegionInput> inputs_;
+  std::vector<RegionOutput> outputs_;
+};
+
+// Groups the operators that run in both orders with those they exchange data
+// in the storage order with.
+std::vector<Region> getRegions(
+    repr::NNModule* nn,
+    const OrderSlotsMap& slots) {
+  std::vector<Region> regions;
+  std::unordered_set<NodeRef> visited;
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    NOM_REQUIRE_OR_CONT(slots.count(node) && !visited.count(node));
+    Region region(nn, slots);
+    std::queue<NodeRef> queue;
+    queue.push(node);
+    visited.insert(node);
+    while (!queue.empty()) {
+      auto op = queue.front();
+      queue.pop();
+      region.add(op);
+      std::vector<NodeRef> neighbors;
+      for (auto edge : op->getInEdges()) {
+        NOM_REQUIRE_OR_CONT(isOrderInput(slots, edge));
+        auto tensor = edge->tail();
+        NOM_REQUIRE_OR_CONT(repr::nn::hasProducer(tensor));
+        auto producer_edge = tensor->getInEdges().front();
+        NOM_REQUIRE_OR_CONT(isOrderOutput(slots, producer_edge));
+        neighbors.push_back(producer_edge->tail());
+      }
+      for (auto edge : op->getOutEdges()) {
+        NOM_REQUIRE_OR_CONT(isOrderOutput(slots, edge));
+        for (auto use : edge->head()->getOutEdges()) {
+          NOM_REQUIRE_OR_CONT(isOrderInput(slots, use));
+          neighbors.push_back(use->head());
+        }
+      }
+      for (auto neighbor : neighbors) {
+        if (visited.insert(neighbor).second) {
+          queue.push(neighbor);
+        }
+      }
+    }
+    regions.push_back(std::move(region));
+  }
+  return regions;
+}
+
+bool removeRedundantOrderSwitch(repr::NNModule* nn) {
+  TensorNames names(nn);
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    NOM_REQUIRE_OR_CONT(
+        isOrderSwitch(node, kNCHW2NHWC) || isOrderSwitch(node, kNHWC2NCHW));
+    const char* inverse =
+        getOperatorType(node) == kNCHW2NHWC ? kNHWC2NCHW : kNCHW2NHWC;
+    auto input = repr::nn::getInputs(node).front();
+    auto output = repr::nn::getOutputs(node).front();
+    // The consumers of the inverse switch read the input instead, which must
+    // not be overwritten in between.
+    NOM_REQUIRE_OR_CONT(names.isOnlyVersion(input));
+    for (auto consumer : repr::nn::getConsumers(output)) {
+      NOM_REQUIRE_OR_CONT(isOrderSwitch(consumer, inverse));
+      auto switched = repr::nn::getOutputs(consumer).front();
+      NOM_REQUIRE_OR_CONT(!nn->outputs.count(switched));
+      repr::nn::replaceAllUsesWith(switched, input);
+      nn->dataFlow.deleteNode(consumer);
+      nn->dataFlow.deleteNode(switched);
+      if (!repr::nn::hasConsumer(output) && !nn->outputs.count(output)) {
+        nn->dataFlow.deleteNode(node);
+        nn->dataFlow.deleteNode(output);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isDNNLowPOperator(NodeRef node) {
+  return getEngine(node).compare(0, 7, "DNNLOWP") == 0;
+}
+
+void optimizeStorageOrderForDNNLowP(repr::NNModule* nn) {
+  optimizeStorageOrder(nn, isDNNLowPOperator);
+}
+
+} // namespace
+
+void optimizeStorageOrder(
+    repr::NNModule* nn,
+    std::function<bool(repr::NNGraph::NodeRef)> prefers_nhwc) {
+  // Conversions inserted by hand may cancel out without changing any order
+  removeRedundantOrderSwitches(nn);
+
+  const auto slots = getOrderSlots(nn);
+  TensorNames names(nn);
+  std::unordered_map<NodeRef, NodeRef> converted;
+  for (auto& region : getRegions(nn, slots)) {
+    const auto order = region.getOrder();
+    NOM_REQUIRE_OR_CONT(order != NNLayout::Undefined);
+    bool prefers = false;
+    if (prefers_nhwc) {
+      for (auto op : region.ops()) {
+        prefers = prefers || prefers_nhwc(op);
+      }
+    }
+    const int cost = region.plan(order, names);
+    const bool change = order == NNLayout::NCHW ? cost < 0 || prefers
+                                                : cost < 0 && !prefers;
+    if (change) {
+      region.convert(order, &names, &converted);
+    }
+  }
+}
+
+void removeRedundantOrderSwitches(repr::NNModule* nn) {
+  while (removeRedundantOrderSwitch(nn)) {
+  }
+}
+
+REGISTER_OPT_PASS_FROM_FUNC(
+    OptimizeStorageOrder,
+    optimizeStorageOrderForDNNLowP);
+REGISTER_OPT_PASS_FROM_FUNC(
+    RemoveRedundantOrderSwitches,
+    removeRedundantOrderSwitches);
+
+} // namespace opt
+} // namespace caffe2
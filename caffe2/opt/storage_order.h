@@ -0,0 +1,37 @@
+#ifndef CAFFE2_OPT_STORAGE_ORDER_H_
+#define CAFFE2_OPT_STORAGE_ORDER_H_
+
+#include "caffe2/core/common.h"
+#include "nomnigraph/Representations/NeuralNet.h"
+
+#include <functional>
+
+namespace caffe2 {
+namespace opt {
+
+// Chooses the storage order, NCHW or NHWC, of every region of CPU operators
+// that support both, and converts data only at the boundaries of the regions.
+//
+// The supported orders are those of the operator schemas: a region is a set
+// of StorageOrderDependent operators (e.g. Conv, MaxPool, SpatialBN) connected
+// directly or through StorageOrderAgnostic ones (e.g. Relu, Sum), on the
+// inputs and outputs that the schemas say are in the storage order. A region
+// can't contain operators with an engine, except the DNNLOWP ones.
+//
+// A region changes order if that reduces the number of NCHW2NHWC and
+// NHWC2NCHW operators needed, e.g. because the net converts its data by hand
+// around it, or if it is in the NCHW order and prefers_nhwc is true for one
+// of its operators. Conversions are then inserted for its inputs and outputs
+// that are used in the old order, including the filters of convolutions.
+CAFFE2_API void optimizeStorageOrder(
+    nom::repr::NNModule* nn,
+    std::function<bool(nom::repr::NNGraph::NodeRef)> prefers_nhwc = nullptr);
+
+// Removes the pairs of NCHW2NHWC and NHWC2NCHW that cancel out, having the
+// consumers of the second one use the input of the first one.
+CAFFE2_API void removeRedundantOrderSwitches(nom::repr::NNModule* nn);
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_STORAGE_ORDER_H_
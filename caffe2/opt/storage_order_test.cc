@@ -0,0 +1,149 @@
+#include "caffe2/core/common.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/storage_order.h"
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+OperatorDef* addOp(
+    NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::string& output) {
+  OperatorDef* def = net->add_op();
+  def->set_type(type);
+  for (const auto& input : inputs) {
+    def->add_input(input);
+  }
+  def->add_output(output);
+  return def;
+}
+
+OperatorDef* addConv(NetDef* net, const std::string& order) {
+  auto def = addOp(net, "Conv", {"X", "W", "b"}, "Y");
+  auto arg = def->add_arg();
+  arg->set_name("kernel");
+  arg->set_i(3);
+  arg = def->add_arg();
+  arg->set_name("order");
+  arg->set_s(order);
+  return def;
+}
+
+std::string getOrder(const OperatorDef& def) {
+  for (const auto& arg : def.arg()) {
+    if (arg.name() == "order") {
+      return arg.s();
+    }
+  }
+  return "";
+}
+
+NetDef optimize(
+    const NetDef& net,
+    std::function<bool(nom::repr::NNGraph::NodeRef)> prefers_nhwc = nullptr) {
+  auto nn = convertToNNModule(net);
+  opt::optimizeStorageOrder(&nn, prefers_nhwc);
+  return convertToCaffe2Proto(nn, net);
+}
+
+NetDef removeRedundantOrderSwitches(const NetDef& net) {
+  auto nn = convertToNNModule(net);
+  opt::removeRedundantOrderSwitches(&nn);
+  return convertToCaffe2Proto(nn, net);
+}
+
+} // namespace
+
+TEST(StorageOrderTest, NoChange) {
+  NetDef net;
+  addConv(&net, "NCHW");
+  addOp(&net, "Relu", {"Y"}, "Y");
+  net.add_external_input("X");
+  net.add_external_input("W");
+  net.add_external_input("b");
+  net.add_external_output("Y");
+
+  auto optimized = optimize(net);
+  ASSERT_EQ(optimized.op_size(), 2);
+  EXPECT_EQ(getOrder(optimized.op(0)), "NCHW");
+}
+
+TEST(StorageOrderTest, PreferNHWC) {
+  NetDef net;
+  addConv(&net, "NCHW");
+  addOp(&net, "Relu", {"Y"}, "Y");
+  net.add_external_input("X");
+  net.add_external_input("W");
+  net.add_external_input("b");
+  net.add_external_output("Y");
+
+  auto optimized =
+      optimize(net, [](nom::repr::NNGraph::NodeRef) { return true; });
+  // The data and the filter are converted, but not the bias
+  ASSERT_EQ(optimized.op_size(), 5);
+  EXPECT_EQ(optimized.op(0).type(), "NCHW2NHWC");
+  EXPECT_EQ(optimized.op(1).type(), "NCHW2NHWC");
+  const auto& conv = optimized.op(2);
+  EXPECT_EQ(conv.type(), "Conv");
+  EXPECT_EQ(getOrder(conv), "NHWC");
+  EXPECT_EQ(conv.input(2), "b");
+  EXPECT_EQ(optimized.op(3).type(), "Relu");
+  EXPECT_EQ(optimized.op(3).input(0), conv.output(0));
+  const auto& back = optimized.op(4);
+  EXPECT_EQ(back.type(), "NHWC2NCHW");
+  EXPECT_EQ(back.input(0), optimized.op(3).output(0));
+  EXPECT_EQ(back.output(0), "Y");
+}
+
+TEST(StorageOrderTest, RemoveManualSwitches) {
+  // The data is in NHWC order, but is converted for a convolution in NCHW
+  NetDef net;
+  addOp(&net, "NHWC2NCHW", {"X_nhwc"}, "X");
+  addConv(&net, "NCHW");
+  addOp(&net, "NCHW2NHWC", {"Y"}, "Y_nhwc");
+  addOp(&net, "Sigmoid", {"Y_nhwc"}, "Z");
+  net.add_external_input("X_nhwc");
+  net.add_external_input("W");
+  net.add_external_input("b");
+  net.add_external_output("Z");
+
+  // Only the filter needs to be converted in NHWC order
+  auto optimized = optimize(net);
+  ASSERT_EQ(optimized.op_size(), 3);
+  EXPECT_EQ(optimized.op(0).type(), "NCHW2NHWC");
+  EXPECT_EQ(optimized.op(0).input(0), "W");
+  const auto& conv = optimized.op(1);
+  EXPECT_EQ(conv.type(), "Conv");
+  EXPECT_EQ(getOrder(conv), "NHWC");
+  EXPECT_EQ(conv.input(0), "X_nhwc");
+  EXPECT_EQ(conv.input(1), optimized.op(0).output(0));
+  EXPECT_EQ(optimized.op(2).type(), "Sigmoid");
+  EXPECT_EQ(optimized.op(2).input(0), conv.output(0));
+}
+
+TEST(StorageOrderTest, RemoveRedundantOrderSwitches) {
+  NetDef net;
+  addOp(&net, "Relu", {"X"}, "A");
+  addOp(&net, "NCHW2NHWC", {"A"}, "B");
+  addOp(&net, "NHWC2NCHW", {"B"}, "C");
+  addOp(&net, "Sigmoid", {"C"}, "Y");
+  net.add_external_input("X");
+  net.add_external_output("Y");
+
+  auto optimized = removeRedundantOrderSwitches(net);
+  ASSERT_EQ(optimized.op_size(), 2);
+  EXPECT_EQ(optimized.op(1).type(), "Sigmoid");
+  EXPECT_EQ(optimized.op(1).input(0), "A");
+
+  // The intermediate value is an output of the net
+  net.add_external_output("B");
+  optimized = removeRedundantOrderSwitches(net);
+  ASSERT_EQ(optimized.op_size(), 3);
+  EXPECT_EQ(optimized.op(2).input(0), "A");
+}
+
+} // namespace caffe2
@@ -6,8 +6,19 @@
 #include "caffe2/utils/eigen_utils.h"
 #include "caffe2/utils/math.h"
 
+C10_DEFINE_int(
+    caffe2_embedding_lookup_prefetch_distance,
+    16,
+    "The number of indices ahead of the current one whose rows the embedding "
+    "lookup kernels prefetch. Tables much larger than the caches may benefit "
+    "from a larger distance.");
+
 namespace caffe2 {
 
+int EmbeddingLookupPrefetchDistance() {
+  return std::max(FLAGS_caffe2_embedding_lookup_prefetch_distance, 0);
+}
+
 // Base implementation does runtime dispatch for each segment of reduction
 template <
     typename IndexType,
@@ -48,4 +48,14 @@ void EmbeddingLookup(
     bool normalize_by_lengths,
     OutType* out);
 
+/**
+ * The number of indices ahead of the current one whose rows the AVX2 embedding
+ * lookup kernels prefetch, set with --caffe2_embedding_lookup_prefetch_distance.
+ *
+ * The prefetches follow the flattened index stream, across segments, so a
+ * larger distance keeps more cache misses in flight on tables much larger than
+ * the caches, which are bound by the latency of the memory.
+ */
+CAFFE2_API int EmbeddingLookupPrefetchDistance();
+
 } // namespace caffe2
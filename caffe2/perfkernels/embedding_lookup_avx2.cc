@@ -7,6 +7,7 @@
 
 #include <caffe2/core/common.h>
 #include <caffe2/core/types.h>
+#include <caffe2/perfkernels/embedding_lookup.h>
 #include <immintrin.h>
 
 namespace caffe2 {
@@ -24,7 +25,7 @@ static void EmbeddingLookup_int32_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int32_t fused_block_size = block_size + 0;
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
@@ -439,7 +440,7 @@ static void EmbeddingLookup_int64_t_float_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int64_t fused_block_size = block_size + 0;
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
@@ -854,7 +855,7 @@ static void EmbeddingLookup_int32_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int32_t fused_block_size = block_size + 0;
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
@@ -1395,7 +1396,7 @@ static void EmbeddingLookup_int64_t_half_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int64_t fused_block_size = block_size + 0;
   CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");
   if (block_size == 128) {
@@ -1936,7 +1937,7 @@ static void EmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int32_t fused_block_size = block_size + 0;
   CAFFE_ENFORCE(scale_bias != nullptr, "scale_bias must not be nullptr");
   if (block_size == 128) {
@@ -2495,7 +2496,7 @@ static void EmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
     const float* scale_bias,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int64_t fused_block_size = block_size + 0;
   CAFFE_ENFORCE(scale_bias != nullptr, "scale_bias must not be nullptr");
   if (block_size == 128) {
@@ -7,6 +7,7 @@
 
 #include <caffe2/core/common.h>
 #include <caffe2/core/types.h>
+#include <caffe2/perfkernels/embedding_lookup.h>
 #include <immintrin.h>
 
 namespace caffe2 {
@@ -23,7 +24,7 @@ static void Fused8BitRowwiseEmbeddingLookup_int32_t_float_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int32_t fused_block_size = block_size + 2;
   if (block_size == 128) {
     // unrolling 16 times
@@ -432,7 +433,7 @@ static void Fused8BitRowwiseEmbeddingLookup_int64_t_float_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int64_t fused_block_size = block_size + 2;
   if (block_size == 128) {
     // unrolling 16 times
@@ -841,7 +842,7 @@ static void Fused8BitRowwiseEmbeddingLookup_int32_t_half_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int32_t fused_block_size = block_size + 4;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1376,7 +1377,7 @@ static void Fused8BitRowwiseEmbeddingLookup_int64_t_half_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int64_t fused_block_size = block_size + 4;
   if (block_size == 128) {
     // unrolling 16 times
@@ -1911,7 +1912,7 @@ static void Fused8BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int32_t prefdist_T0 = 16;
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int32_t fused_block_size = block_size + 8;
   if (block_size == 128) {
     // unrolling 16 times
@@ -2473,7 +2474,7 @@ static void Fused8BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
     const float* weights,
     bool normalize_by_lengths,
     float* out) {
-  const int64_t prefdist_T0 = 16;
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
   const int64_t fused_block_size = block_size + 8;
   if (block_size == 128) {
     // unrolling 16 times
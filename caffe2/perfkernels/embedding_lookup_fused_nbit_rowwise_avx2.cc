@@ -0,0 +1,804 @@
+//// --------------------------
+//// ATTENTION:
+//// THIS CODE IS AUTOGENERATED
+//// BY hp_emblookup_codegen.py
+//// DO NOT MODIFY!!!
+//// --------------------------
+
+#include <caffe2/core/common.h>
+#include <caffe2/core/types.h>
+#include <caffe2/perfkernels/embedding_lookup.h>
+#include <immintrin.h>
+#include <cstring>
+
+namespace caffe2 {
+
+// Loads 32 bits holding 8 values of up to 4 bits. With fewer bits per
+// value, the bits above the values are masked out by the callers.
+static inline int32_t LoadPacked8(const uint8_t* ip) {
+  int32_t packed;
+  memcpy(&packed, ip, sizeof(packed));
+  return packed;
+}
+
+template <bool IS_WEIGHT_POSITIONAL>
+static void FusedNBitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  const int32_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
+  const int num_elem_per_byte = 8 / bit_rate;
+  const int64_t packed_block_size = (block_size + num_elem_per_byte - 1) / num_elem_per_byte;
+  const int64_t fused_block_size = packed_block_size + 2 * sizeof(at::Half);
+  const __m256i vshift = _mm256_set_epi32(7 * bit_rate, 6 * bit_rate, 5 * bit_rate, 4 * bit_rate, 3 * bit_rate, 2 * bit_rate, bit_rate, 0);
+  const uint8_t mask = (1 << bit_rate) - 1;
+  const __m256i vmask = _mm256_set1_epi32(mask);
+  if (block_size == 128) {
+    // unrolling 16 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      __m256 vop64 = _mm256_setzero_ps();
+      __m256 vop72 = _mm256_setzero_ps();
+      __m256 vop80 = _mm256_setzero_ps();
+      __m256 vop88 = _mm256_setzero_ps();
+      __m256 vop96 = _mm256_setzero_ps();
+      __m256 vop104 = _mm256_setzero_ps();
+      __m256 vop112 = _mm256_setzero_ps();
+      __m256 vop120 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+        vop16 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (2) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop16, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[8])
+        vop24 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (3) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop24, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[12])
+        vop32 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (4) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop32, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[16])
+        vop40 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (5) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop40, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[20])
+        vop48 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (6) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop48, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[24])
+        vop56 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (7) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop56, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[28])
+        vop64 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (8) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop64, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[32])
+        vop72 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (9) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop72, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[36])
+        vop80 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (10) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop80, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[40])
+        vop88 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (11) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop88, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[44])
+        vop96 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (12) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop96, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[48])
+        vop104 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (13) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop104, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[52])
+        vop112 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (14) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop112, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[56])
+        vop120 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (15) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop120, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[60])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+        _mm256_storeu_ps(&op[16], vop16);
+        _mm256_storeu_ps(&op[24], vop24);
+        _mm256_storeu_ps(&op[32], vop32);
+        _mm256_storeu_ps(&op[40], vop40);
+        _mm256_storeu_ps(&op[48], vop48);
+        _mm256_storeu_ps(&op[56], vop56);
+        _mm256_storeu_ps(&op[64], vop64);
+        _mm256_storeu_ps(&op[72], vop72);
+        _mm256_storeu_ps(&op[80], vop80);
+        _mm256_storeu_ps(&op[88], vop88);
+        _mm256_storeu_ps(&op[96], vop96);
+        _mm256_storeu_ps(&op[104], vop104);
+        _mm256_storeu_ps(&op[112], vop112);
+        _mm256_storeu_ps(&op[120], vop120);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+        _mm256_storeu_ps(&op[16], _mm256_mul_ps(vop16, vlen_inv));
+        _mm256_storeu_ps(&op[24], _mm256_mul_ps(vop24, vlen_inv));
+        _mm256_storeu_ps(&op[32], _mm256_mul_ps(vop32, vlen_inv));
+        _mm256_storeu_ps(&op[40], _mm256_mul_ps(vop40, vlen_inv));
+        _mm256_storeu_ps(&op[48], _mm256_mul_ps(vop48, vlen_inv));
+        _mm256_storeu_ps(&op[56], _mm256_mul_ps(vop56, vlen_inv));
+        _mm256_storeu_ps(&op[64], _mm256_mul_ps(vop64, vlen_inv));
+        _mm256_storeu_ps(&op[72], _mm256_mul_ps(vop72, vlen_inv));
+        _mm256_storeu_ps(&op[80], _mm256_mul_ps(vop80, vlen_inv));
+        _mm256_storeu_ps(&op[88], _mm256_mul_ps(vop88, vlen_inv));
+        _mm256_storeu_ps(&op[96], _mm256_mul_ps(vop96, vlen_inv));
+        _mm256_storeu_ps(&op[104], _mm256_mul_ps(vop104, vlen_inv));
+        _mm256_storeu_ps(&op[112], _mm256_mul_ps(vop112, vlen_inv));
+        _mm256_storeu_ps(&op[120], _mm256_mul_ps(vop120, vlen_inv));
+      }
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+        vop16 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (2) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop16, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[8])
+        vop24 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (3) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop24, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[12])
+        vop32 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (4) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop32, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[16])
+        vop40 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (5) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop40, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[20])
+        vop48 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (6) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop48, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[24])
+        vop56 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (7) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop56, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[28])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+        _mm256_storeu_ps(&op[16], vop16);
+        _mm256_storeu_ps(&op[24], vop24);
+        _mm256_storeu_ps(&op[32], vop32);
+        _mm256_storeu_ps(&op[40], vop40);
+        _mm256_storeu_ps(&op[48], vop48);
+        _mm256_storeu_ps(&op[56], vop56);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+        _mm256_storeu_ps(&op[16], _mm256_mul_ps(vop16, vlen_inv));
+        _mm256_storeu_ps(&op[24], _mm256_mul_ps(vop24, vlen_inv));
+        _mm256_storeu_ps(&op[32], _mm256_mul_ps(vop32, vlen_inv));
+        _mm256_storeu_ps(&op[40], _mm256_mul_ps(vop40, vlen_inv));
+        _mm256_storeu_ps(&op[48], _mm256_mul_ps(vop48, vlen_inv));
+        _mm256_storeu_ps(&op[56], _mm256_mul_ps(vop56, vlen_inv));
+      }
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+        vop16 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (2) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop16, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[8])
+        vop24 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (3) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop24, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[12])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+        _mm256_storeu_ps(&op[16], vop16);
+        _mm256_storeu_ps(&op[24], vop24);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+        _mm256_storeu_ps(&op[16], _mm256_mul_ps(vop16, vlen_inv));
+        _mm256_storeu_ps(&op[24], _mm256_mul_ps(vop24, vlen_inv));
+      }
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+      }
+    }
+  } else {
+    // generic code
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      int64_t j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(op + j, _mm256_setzero_ps());
+      }
+      for (; j < block_size; j++) {
+        op[j] = 0.0f;
+      }
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(&op[j], _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(&ip[j / num_elem_per_byte])), vshift), vmask)), _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+          _mm_prefetch((&ip_next_T0[j / num_elem_per_byte]), _MM_HINT_T0);
+        }
+        for (; j < block_size; j++) {
+          op[j] += wgt * ((float)((ip[j / num_elem_per_byte] >> ((j % num_elem_per_byte) * bit_rate)) & mask)) + bio;
+        }
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        float len_inv = 1.0f / lengths[rangeIndex];
+        __m256 vlen_inv = _mm256_set1_ps(len_inv);
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(&op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));
+        }
+        for (; j < block_size; j++) {
+          op[j] = len_inv * op[j];
+        }
+      }
+    }
+  }
+}
+void FusedNBitRowwiseEmbeddingLookup_int32_t_uint8_t_float_false__avx2_fma(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  FusedNBitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma<false>(
+      bit_rate,
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+void FusedNBitRowwiseEmbeddingLookup_int32_t_uint8_t_float_true__avx2_fma(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  FusedNBitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma<true>(
+      bit_rate,
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+
+template <bool IS_WEIGHT_POSITIONAL>
+static void FusedNBitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  const int64_t prefdist_T0 = EmbeddingLookupPrefetchDistance();
+  const int num_elem_per_byte = 8 / bit_rate;
+  const int64_t packed_block_size = (block_size + num_elem_per_byte - 1) / num_elem_per_byte;
+  const int64_t fused_block_size = packed_block_size + 2 * sizeof(at::Half);
+  const __m256i vshift = _mm256_set_epi32(7 * bit_rate, 6 * bit_rate, 5 * bit_rate, 4 * bit_rate, 3 * bit_rate, 2 * bit_rate, bit_rate, 0);
+  const uint8_t mask = (1 << bit_rate) - 1;
+  const __m256i vmask = _mm256_set1_epi32(mask);
+  if (block_size == 128) {
+    // unrolling 16 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      __m256 vop64 = _mm256_setzero_ps();
+      __m256 vop72 = _mm256_setzero_ps();
+      __m256 vop80 = _mm256_setzero_ps();
+      __m256 vop88 = _mm256_setzero_ps();
+      __m256 vop96 = _mm256_setzero_ps();
+      __m256 vop104 = _mm256_setzero_ps();
+      __m256 vop112 = _mm256_setzero_ps();
+      __m256 vop120 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+        vop16 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (2) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop16, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[8])
+        vop24 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (3) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop24, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[12])
+        vop32 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (4) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop32, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[16])
+        vop40 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (5) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop40, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[20])
+        vop48 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (6) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop48, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[24])
+        vop56 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (7) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop56, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[28])
+        vop64 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (8) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop64, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[32])
+        vop72 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (9) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop72, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[36])
+        vop80 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (10) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop80, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[40])
+        vop88 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (11) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop88, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[44])
+        vop96 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (12) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop96, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[48])
+        vop104 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (13) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop104, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[52])
+        vop112 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (14) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop112, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[56])
+        vop120 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (15) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop120, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[60])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+        _mm256_storeu_ps(&op[16], vop16);
+        _mm256_storeu_ps(&op[24], vop24);
+        _mm256_storeu_ps(&op[32], vop32);
+        _mm256_storeu_ps(&op[40], vop40);
+        _mm256_storeu_ps(&op[48], vop48);
+        _mm256_storeu_ps(&op[56], vop56);
+        _mm256_storeu_ps(&op[64], vop64);
+        _mm256_storeu_ps(&op[72], vop72);
+        _mm256_storeu_ps(&op[80], vop80);
+        _mm256_storeu_ps(&op[88], vop88);
+        _mm256_storeu_ps(&op[96], vop96);
+        _mm256_storeu_ps(&op[104], vop104);
+        _mm256_storeu_ps(&op[112], vop112);
+        _mm256_storeu_ps(&op[120], vop120);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+        _mm256_storeu_ps(&op[16], _mm256_mul_ps(vop16, vlen_inv));
+        _mm256_storeu_ps(&op[24], _mm256_mul_ps(vop24, vlen_inv));
+        _mm256_storeu_ps(&op[32], _mm256_mul_ps(vop32, vlen_inv));
+        _mm256_storeu_ps(&op[40], _mm256_mul_ps(vop40, vlen_inv));
+        _mm256_storeu_ps(&op[48], _mm256_mul_ps(vop48, vlen_inv));
+        _mm256_storeu_ps(&op[56], _mm256_mul_ps(vop56, vlen_inv));
+        _mm256_storeu_ps(&op[64], _mm256_mul_ps(vop64, vlen_inv));
+        _mm256_storeu_ps(&op[72], _mm256_mul_ps(vop72, vlen_inv));
+        _mm256_storeu_ps(&op[80], _mm256_mul_ps(vop80, vlen_inv));
+        _mm256_storeu_ps(&op[88], _mm256_mul_ps(vop88, vlen_inv));
+        _mm256_storeu_ps(&op[96], _mm256_mul_ps(vop96, vlen_inv));
+        _mm256_storeu_ps(&op[104], _mm256_mul_ps(vop104, vlen_inv));
+        _mm256_storeu_ps(&op[112], _mm256_mul_ps(vop112, vlen_inv));
+        _mm256_storeu_ps(&op[120], _mm256_mul_ps(vop120, vlen_inv));
+      }
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+        vop16 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (2) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop16, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[8])
+        vop24 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (3) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop24, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[12])
+        vop32 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (4) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop32, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[16])
+        vop40 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (5) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop40, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[20])
+        vop48 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (6) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop48, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[24])
+        vop56 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (7) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop56, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[28])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+        _mm256_storeu_ps(&op[16], vop16);
+        _mm256_storeu_ps(&op[24], vop24);
+        _mm256_storeu_ps(&op[32], vop32);
+        _mm256_storeu_ps(&op[40], vop40);
+        _mm256_storeu_ps(&op[48], vop48);
+        _mm256_storeu_ps(&op[56], vop56);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+        _mm256_storeu_ps(&op[16], _mm256_mul_ps(vop16, vlen_inv));
+        _mm256_storeu_ps(&op[24], _mm256_mul_ps(vop24, vlen_inv));
+        _mm256_storeu_ps(&op[32], _mm256_mul_ps(vop32, vlen_inv));
+        _mm256_storeu_ps(&op[40], _mm256_mul_ps(vop40, vlen_inv));
+        _mm256_storeu_ps(&op[48], _mm256_mul_ps(vop48, vlen_inv));
+        _mm256_storeu_ps(&op[56], _mm256_mul_ps(vop56, vlen_inv));
+      }
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+        vop16 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (2) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop16, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[8])
+        vop24 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (3) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop24, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[12])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+        _mm256_storeu_ps(&op[16], vop16);
+        _mm256_storeu_ps(&op[24], vop24);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+        _mm256_storeu_ps(&op[16], _mm256_mul_ps(vop16, vlen_inv));
+        _mm256_storeu_ps(&op[24], _mm256_mul_ps(vop24, vlen_inv));
+      }
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (0) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(ip + (1) * bit_rate)), vshift), vmask)), _mm256_add_ps(vop8, vbio));
+        // skip unnecessary prefetch of (&ip_next_T0[4])
+      }
+      if (normalize_by_lengths == false) {
+        _mm256_storeu_ps(&op[0], vop0);
+        _mm256_storeu_ps(&op[8], vop8);
+      } else if (lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        _mm256_storeu_ps(&op[0], _mm256_mul_ps(vop0, vlen_inv));
+        _mm256_storeu_ps(&op[8], _mm256_mul_ps(vop8, vlen_inv));
+      }
+    }
+  } else {
+    // generic code
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      int64_t j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(op + j, _mm256_setzero_ps());
+      }
+      for (; j < block_size; j++) {
+        op[j] = 0.0f;
+      }
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(idx >= 0 && idx < data_size, "Index ", dataInd, " is out of bounds: ", idx, ", range 0 to ", data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const at::Half* scale_bias = reinterpret_cast<const at::Half*>(&input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * float(scale_bias[1]);
+        wgt = wgt * float(scale_bias[0]);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0) ? (dataInd + prefdist_T0) : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(&op[j], _mm256_fmadd_ps(vwgt, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(LoadPacked8(&ip[j / num_elem_per_byte])), vshift), vmask)), _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+          _mm_prefetch((&ip_next_T0[j / num_elem_per_byte]), _MM_HINT_T0);
+        }
+        for (; j < block_size; j++) {
+          op[j] += wgt * ((float)((ip[j / num_elem_per_byte] >> ((j % num_elem_per_byte) * bit_rate)) & mask)) + bio;
+        }
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        float len_inv = 1.0f / lengths[rangeIndex];
+        __m256 vlen_inv = _mm256_set1_ps(len_inv);
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(&op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));
+        }
+        for (; j < block_size; j++) {
+          op[j] = len_inv * op[j];
+        }
+      }
+    }
+  }
+}
+void FusedNBitRowwiseEmbeddingLookup_int64_t_uint8_t_float_false__avx2_fma(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  FusedNBitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma<false>(
+      bit_rate,
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+void FusedNBitRowwiseEmbeddingLookup_int64_t_uint8_t_float_true__avx2_fma(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  FusedNBitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma<true>(
+      bit_rate,
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+
+} // namespace caffe2
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * Embedding lookup with reduction on N-bit row-wise quantized data.
+ *
+ * `input` of size data_size * (ceil(block_size * bit_rate / 8) + 4B)
+ * `indices` of size index_size
+ * `lengths` of size output_size
+ * `weights` nullptr or array of size index_size
+ * `out` of size output_size * block_size
+ * sum(lengths[i]) == index_size
+ *
+ * bit_rate is the number of bits per quantized value, 2 or 4. Each byte of a
+ * row packs 8 / bit_rate values, the first one in the least significant bits.
+ * The packed values of a row are followed by its scale and bias, as 16-bit
+ * floats.
+ *
+ * Note that block_size should be the number of quantized values per row in the
+ * data, i.e. excluding the scale and bias.
+ *
+ * Behavior is roughly equivalent to pseudocode:
+ *
+ * pos = 0
+ * fused_block_size = ceil(block_size * bit_rate / 8) + 4B
+ * for (i = 0..index_size-1)
+ *   for (k = 0..block_size-1)
+ *     out[i*block_size + k] = 0
+ *   for (j = 0..lengths[i]-1)
+ *     row = input + indices[pos] * fused_block_size
+ *     for (k = 0..block_size-1)
+ *       out[i*block_size + k] += (unpack(row, k) * scale(row) + bias(row)) *
+ *           (weights ? weights[IS_WEIGHT_POSITIONAL ? j : pos] : 1.0)
+ *     pos += 1
+ *   if (normalize_weights && lengths[i] > 0)
+ *     for (k = 0..block_size-1)
+ *       out[i*block_size + k] /= lengths[i]
+ *
+ */
+
+template <
+    typename IndexType,
+    typename OutType,
+    bool IS_WEIGHT_POSITIONAL = false>
+void FusedNBitRowwiseEmbeddingLookup(
+    const int bit_rate,
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const uint8_t* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights, // optional, can be null for non-weighted sum
+    bool normalize_by_lengths,
+    OutType* out);
+} // namespace caffe2
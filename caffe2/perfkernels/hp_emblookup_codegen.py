@@ -8,11 +8,20 @@ import sys
 sizeof = {'float': 4, 'at::Half': 2, 'uint8_t': 1}
 
 
-def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused):
+def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused, nbit=False):
     def compute(regid, InType, use_weights, isa, prefetch):
         code = []
 
-        if InType == "float":
+        if nbit:
+            # 8 values are packed in bit_rate bytes
+            code.append(
+                "vop%d = _mm256_fmadd_ps(vwgt,  \
+                   _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32( \
+                     _mm256_set1_epi32(LoadPacked8(ip + (%d) * bit_rate)), vshift), vmask)), \
+                   _mm256_add_ps(vop%d, vbio));"
+                                                 % (regid, regid // 8, regid)
+            )
+        elif InType == "float":
             code.append(
                 "vop%d = _mm256_fmadd_ps(vwgt,  \
                   _mm256_loadu_ps(ip + (%d)), vop%d);"
@@ -35,10 +44,12 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused):
         else:
             assert False
 
+        # ip_next_T0 points to bytes
+        offset = regid // 2 if nbit else regid
         if prefetch:
-            code.append("_mm_prefetch((&ip_next_T0[%d]), _MM_HINT_T0);" % (regid))
+            code.append("_mm_prefetch((&ip_next_T0[%d]), _MM_HINT_T0);" % (offset))
         else:
-            code.append("// skip unnecessary prefetch of (&ip_next_T0[%d])" % (regid))
+            code.append("// skip unnecessary prefetch of (&ip_next_T0[%d])" % (offset))
 
         return code
 
@@ -67,7 +78,14 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused):
         code.append(
             "wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];")
         code.append("}")
-        if fused:
+        if nbit:
+            code.append(
+                'const at::Half* scale_bias = reinterpret_cast<'
+                'const at::Half*>(&input[idx * fused_block_size + packed_block_size]);'
+            )
+            code.append("bio = wgt * float(scale_bias[1]);")
+            code.append("wgt = wgt * float(scale_bias[0]);")
+        elif fused:
             code.append(
                 'const float* scale_bias = reinterpret_cast<'
                 'const float*>(&input[idx * fused_block_size + block_size]);'
@@ -103,7 +121,9 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused):
     for i in range(0, uf):
         j = 8 * i
         cachelinesize = 64
-        byteoffset = sizeof[InType] * j
+        # 4-bit values take half a byte, 2-bit ones prefetch a bit more often
+        # than needed
+        byteoffset = j // 2 if nbit else sizeof[InType] * j
         prefetch = (byteoffset % cachelinesize) == 0
         code.extend(compute(j, InType, use_weights, isa, prefetch))
     code.append("}")
@@ -127,11 +147,23 @@ def unroll(uf, IndexType, InType, OutType, use_weights, isa, fused):
     return code
 
 
-def generic(IndexType, InType, OutType, use_weights, isa, fused):
+def generic(IndexType, InType, OutType, use_weights, isa, fused, nbit=False):
 
     def compute(InType, use_weights, isa):
         code = []
-        if InType == "float":
+        if nbit:
+            code.append(
+                "_mm256_storeu_ps(&op[j], \
+                   _mm256_fmadd_ps(vwgt, \
+                     _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32( \
+                       _mm256_set1_epi32(LoadPacked8(&ip[j / num_elem_per_byte])), vshift), vmask)), \
+                     _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio) ) \
+                                   );"
+            )
+            code.append(
+                "_mm_prefetch((&ip_next_T0[j / num_elem_per_byte]), _MM_HINT_T0);")
+            return code
+        elif InType == "float":
             code.append(
                 "_mm256_storeu_ps(&op[j], \
                                  _mm256_fmadd_ps(vwgt,_mm256_loadu_ps(&ip[j]), _mm256_loadu_ps(&op[j])) \
@@ -189,7 +221,14 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused):
         code.append(
             "wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];")
         code.append("}")
-        if fused:
+        if nbit:
+            code.append(
+                'const at::Half* scale_bias = reinterpret_cast<'
+                'const at::Half*>(&input[idx * fused_block_size + packed_block_size]);'
+            )
+            code.append("bio = wgt * float(scale_bias[1]);")
+            code.append("wgt = wgt * float(scale_bias[0]);")
+        elif fused:
             code.append(
                 'const float* scale_bias = reinterpret_cast<'
                 'const float*>(&input[idx * fused_block_size + block_size]);'
@@ -231,7 +270,11 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused):
     if InType == "at::Half":
         code.append("at::Half vtmp1[8] CAFFE2_ALIGNED(64);")
     code.append("for(; j < block_size; j++) {")
-    if InType == "float":
+    if nbit:
+        code.append(
+            "op[j] += wgt * ((float)((ip[j / num_elem_per_byte] >> "
+            "((j % num_elem_per_byte) * bit_rate)) & mask)) + bio;")
+    elif InType == "float":
         code.append("op[j] += wgt * ip[j];")
     elif InType == "at::Half":
         code.append("vtmp1[0] = ip[j];")
@@ -268,9 +311,12 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused):
 parser = argparse.ArgumentParser()
 parser.add_argument('-f', '--filename', help="file name")
 parser.add_argument('--fused', action='store_true')
+parser.add_argument('--fused-nbit', action='store_true')
 opts = parser.parse_args()
 if opts.filename:
     filename = opts.filename
+elif opts.fused_nbit:
+    filename = "embedding_lookup_fused_nbit_rowwise_avx2.cc"
 elif opts.fused:
     filename = "embedding_lookup_fused_8bit_rowwise_avx2.cc"
 else:
@@ -281,8 +327,11 @@ options = [["int32_t", "int32_t", "float", "float", "float", "float"],
            ["int64_t", "int64_t", "float", "float", "float", "float"],
            ["int32_t", "int32_t", "half", "at::Half", "float", "float"],
            ["int64_t", "int64_t", "half", "at::Half", "float", "float"],
-           ["int32_t", "int32_t", "uint8_t", "uint8_t", "float"],
-           ["int64_t", "int64_t", "uint8_t", "uint8_t", "float"]]
+           ["int32_t", "int32_t", "uint8_t", "uint8_t", "float", "float"],
+           ["int64_t", "int64_t", "uint8_t", "uint8_t", "float", "float"]]
+if opts.fused_nbit:
+    options = [["int32_t", "int32_t", "uint8_t", "uint8_t", "float", "float"],
+               ["int64_t", "int64_t", "uint8_t", "uint8_t", "float", "float"]]
 
 code = []
 # includes
@@ -295,14 +344,30 @@ code.append("//// --------------------------\n\n")
 
 code.append("#include <caffe2/core/types.h>")
 code.append("#include <caffe2/core/common.h>")
+code.append("#include <caffe2/perfkernels/embedding_lookup.h>")
 code.append("#include <immintrin.h>")
+if opts.fused_nbit:
+    code.append("#include <cstring>")
 code.append("\n")
 
 code.append("namespace caffe2 {\n")
+if opts.fused_nbit:
+    code.append("// Loads 32 bits holding 8 values of up to 4 bits. With fewer bits per")
+    code.append("// value, the bits above the values are masked out by the callers.")
+    code.append("static inline int32_t LoadPacked8(const uint8_t* ip) {")
+    code.append("int32_t packed;")
+    code.append("memcpy(&packed, ip, sizeof(packed));")
+    code.append("return packed;")
+    code.append("}\n")
 for o in options:
     [IndexTypeName, IndexType, InTypeName, InType, OutTypeName, OutType] = o
 
-    prefix = 'Fused8BitRowwise' if opts.fused else ''
+    if opts.fused_nbit:
+        prefix = 'FusedNBitRowwise'
+    elif opts.fused:
+        prefix = 'Fused8BitRowwise'
+    else:
+        prefix = ''
     code.append('template <bool IS_WEIGHT_POSITIONAL>')
     fn_base = '{}EmbeddingLookup_{}_{}_{}'.format(
         prefix, IndexTypeName, InTypeName, OutTypeName
@@ -312,6 +377,8 @@ for o in options:
     code.append(fn + "(")
 
     args = []
+    if opts.fused_nbit:
+        args.append("const int bit_rate,")
     args.append("const int64_t block_size,")
     args.append("const int64_t output_size,")
     args.append("const int64_t index_size,")
@@ -320,24 +387,46 @@ for o in options:
     args.append("const " + IndexType + "* indices,")
     args.append("const int* lengths,")
     args.append("const float* weights,")
-    if not opts.fused:
+    if not opts.fused and not opts.fused_nbit:
         args.append("const float* scale_bias,")
     args.append("bool normalize_by_lengths,")
     args.append(OutType + "* out)")
     code += args
 
     code.append("{")
-    code.append("const " + IndexType + " prefdist_T0 = 16;")
+    code.append(
+        "const " + IndexType +
+        " prefdist_T0 = EmbeddingLookupPrefetchDistance();")
     # block_size is the number of elements and fused_block_size is the size of
     # an entire row, including scale and bias.
-    offset = (8 // sizeof[InType]) if opts.fused else 0
-    code.append(
-        "const {} fused_block_size = block_size + {};".
-        format(IndexType, offset)
-    )
+    if opts.fused_nbit:
+        # Each row packs 8 / bit_rate values per byte, followed by a 16-bit
+        # scale and bias.
+        code.append("const int num_elem_per_byte = 8 / bit_rate;")
+        code.append(
+            "const int64_t packed_block_size = "
+            "(block_size + num_elem_per_byte - 1) / num_elem_per_byte;"
+        )
+        code.append(
+            "const int64_t fused_block_size = "
+            "packed_block_size + 2 * sizeof(at::Half);"
+        )
+        code.append(
+            "const __m256i vshift = _mm256_set_epi32(7 * bit_rate, "
+            "6 * bit_rate, 5 * bit_rate, 4 * bit_rate, 3 * bit_rate, "
+            "2 * bit_rate, bit_rate, 0);"
+        )
+        code.append("const uint8_t mask = (1 << bit_rate) - 1;")
+        code.append("const __m256i vmask = _mm256_set1_epi32(mask);")
+    else:
+        offset = (8 // sizeof[InType]) if opts.fused else 0
+        code.append(
+            "const {} fused_block_size = block_size + {};".
+            format(IndexType, offset)
+        )
 
     #code.append("printf(\"calling " + fn + "\\n\");");
-    if not opts.fused:
+    if not opts.fused and not opts.fused_nbit:
         if InType != "uint8_t":
             code.append(
                 'CAFFE_ENFORCE(scale_bias == nullptr,'
@@ -350,16 +439,25 @@ for o in options:
             )
 
     code.append("if (block_size == 128) {")
-    code += unroll(16, IndexType, InType, OutType, True, "AVX2", opts.fused)
+    code += unroll(
+        16, IndexType, InType, OutType, True, "AVX2", opts.fused,
+        opts.fused_nbit)
     code.append("} else if (block_size == 64) {")
-    code += unroll(8, IndexType, InType, OutType, True, "AVX2", opts.fused)
+    code += unroll(
+        8, IndexType, InType, OutType, True, "AVX2", opts.fused,
+        opts.fused_nbit)
     code.append("} else if (block_size == 32) {")
-    code += unroll(4, IndexType, InType, OutType, True, "AVX2", opts.fused)
+    code += unroll(
+        4, IndexType, InType, OutType, True, "AVX2", opts.fused,
+        opts.fused_nbit)
     code.append("} else if (block_size == 16) {")
-    code += unroll(2, IndexType, InType, OutType, True, "AVX2", opts.fused)
+    code += unroll(
+        2, IndexType, InType, OutType, True, "AVX2", opts.fused,
+        opts.fused_nbit)
     code.append("} else {")
     code.append("// generic code")
-    code += generic(IndexType, InType, OutType, True, "AVX2", opts.fused)
+    code += generic(
+        IndexType, InType, OutType, True, "AVX2", opts.fused, opts.fused_nbit)
     code.append("}")
 
     code.append("}")
@@ -370,6 +468,8 @@ for o in options:
         code += args
         code.append("{")
         code.append(fn_base + suffix + "<" + is_weight_positional + ">(")
+        if opts.fused_nbit:
+            code.append("bit_rate,")
         code.append("block_size,")
         code.append("output_size,")
         code.append("index_size,")
@@ -378,7 +478,7 @@ for o in options:
         code.append("indices,")
         code.append("lengths,")
         code.append("weights,")
-        if not opts.fused:
+        if not opts.fused and not opts.fused_nbit:
             code.append("scale_bias,")
         code.append("normalize_by_lengths,")
         code.append("out);")
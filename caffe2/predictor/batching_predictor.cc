@@ -0,0 +1,316 @@
+#include "caffe2/predictor/batching_predictor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+namespace caffe2 {
+
+struct BatchingPredictor::Request {
+  const TensorMap* inputs;
+  TensorMap* outputs;
+  int64_t rows;
+  Clock::time_point enqueued;
+  bool has_deadline;
+  Clock::time_point deadline;
+  std::promise<bool> done;
+};
+
+namespace {
+
+int64_t microsecondsBetween(
+    BatchingPredictor::Clock::time_point start,
+    BatchingPredictor::Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+      .count();
+}
+
+void copyItems(const TypeMeta& meta, size_t n, const void* src, void* dst) {
+  if (meta.copy()) {
+    meta.copy()(src, dst, n);
+  } else {
+    std::memcpy(dst, src, n * meta.itemsize());
+  }
+}
+
+int64_t batchSize(const Predictor::TensorMap& inputs) {
+  CAFFE_ENFORCE(!inputs.empty(), "BatchingPredictor requires inputs");
+  int64_t rows = -1;
+  for (const auto& input : inputs) {
+    const auto& tensor = input.second;
+    CAFFE_ENFORCE_GE(
+        tensor.dim(),
+        1,
+        "Input ",
+        input.first,
+        " has no batch dimension");
+    if (rows < 0) {
+      rows = tensor.size(0);
+    }
+    CAFFE_ENFORCE_EQ(
+        tensor.size(0),
+        rows,
+        "Inputs must have the same batch size, but ",
+        input.first,
+        " has ",
+        tensor.size(0),
+        " rows instead of ",
+        rows);
+  }
+  CAFFE_ENFORCE_GT(rows, 0, "BatchingPredictor requires non-empty inputs");
+  return rows;
+}
+
+// Whether the inputs can be concatenated along their batch dimension
+bool compatible(
+    const Predictor::TensorMap& a,
+    const Predictor::TensorMap& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (const auto& input : a) {
+    auto it = b.find(input.first);
+    if (it == b.end()) {
+      return false;
+    }
+    const auto& x = input.second;
+    const auto& y = it->second;
+    if (x.dtype() != y.dtype() || x.dim() != y.dim()) {
+      return false;
+    }
+    for (int i = 1; i < x.dim(); ++i) {
+      if (x.size(i) != y.size(i)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::unique_ptr<Predictor> predictor,
+    BatchingPredictorOptions options,
+    const std::string& name)
+    : predictor_(std::move(predictor)), options_(options), stats_(name) {
+  CAFFE_ENFORCE(predictor_);
+  CAFFE_ENFORCE_GT(options_.max_batch_size, 0);
+  CAFFE_ENFORCE_GE(options_.max_batch_delay.count(), 0);
+  worker_ = std::thread([this] { workerLoop(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+bool BatchingPredictor::operator()(
+    const TensorMap& inputs,
+    TensorMap* outputs,
+    std::chrono::microseconds latency_budget) {
+  CAFFE_ENFORCE(outputs);
+  auto request = std::make_shared<Request>();
+  request->inputs = &inputs;
+  request->outputs = outputs;
+  request->rows = batchSize(inputs);
+  request->enqueued = Clock::now();
+  // Avoids overflowing the time point for the default, unlimited budget
+  request->has_deadline = latency_budget <
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::time_point::max() - request->enqueued);
+  if (request->has_deadline) {
+    request->deadline = request->enqueued + latency_budget;
+  }
+  auto done = request->done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CAFFE_ENFORCE(!stop_, "BatchingPredictor is shutting down");
+    queue_.push_back(request);
+  }
+  cv_.notify_one();
+  CAFFE_EVENT(stats_, num_requests);
+  return done.get();
+}
+
+BatchingPredictor::Clock::time_point BatchingPredictor::batchDeadline() const {
+  const auto& front = queue_.front();
+  auto deadline = front->enqueued + options_.max_batch_delay;
+  for (const auto& request : queue_) {
+    if (request->has_deadline && request->deadline < deadline &&
+        compatible(*front->inputs, *request->inputs)) {
+      deadline = request->deadline;
+    }
+  }
+  return deadline;
+}
+
+bool BatchingPredictor::batchFull() const {
+  const auto& front = queue_.front();
+  int64_t rows = 0;
+  for (const auto& request : queue_) {
+    if (compatible(*front->inputs, *request->inputs)) {
+      rows += request->rows;
+      if (rows >= options_.max_batch_size) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::vector<BatchingPredictor::RequestPtr> BatchingPredictor::takeBatch(
+    Clock::time_point cutoff) {
+  std::vector<RequestPtr> batch;
+  int64_t rows = 0;
+  for (auto it = queue_.begin(); it != queue_.end();) {
+    const auto& request = *it;
+    if (request->has_deadline && request->deadline < cutoff) {
+      CAFFE_EVENT(stats_, num_timeouts);
+      request->done.set_value(false);
+      it = queue_.erase(it);
+      continue;
+    }
+    if (batch.empty() ||
+        (rows + request->rows <= options_.max_batch_size &&
+         compatible(*batch.front()->inputs, *request->inputs))) {
+      rows += request->rows;
+      batch.push_back(request);
+      it = queue_.erase(it);
+      if (rows >= options_.max_batch_size) {
+        break;
+      }
+      continue;
+    }
+    ++it;
+  }
+  return batch;
+}
+
+void BatchingPredictor::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // stop_ is set, and there is nothing left to run
+      return;
+    }
+    // Waits for the batch to fill up, or for its deadline. New requests can
+    // make the batch full, or bring its deadline forward.
+    auto cutoff = Clock::now();
+    auto waited_for = Clock::time_point::min();
+    while (!stop_ && !batchFull()) {
+      auto deadline = batchDeadline();
+      cutoff = Clock::now();
+      if (cutoff >= deadline) {
+        // The requests due at the deadline the worker waited for still run
+        if (deadline == waited_for) {
+          cutoff = deadline;
+        }
+        break;
+      }
+      waited_for = deadline;
+      cv_.wait_until(lock, deadline);
+    }
+    auto batch = takeBatch(cutoff);
+    if (batch.empty()) {
+      continue;
+    }
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+  }
+}
+
+void BatchingPredictor::runBatch(const std::vector<RequestPtr>& batch) {
+  const auto start = Clock::now();
+  int64_t total_rows = 0;
+  for (const auto& request : batch) {
+    total_rows += request->rows;
+    CAFFE_EVENT(
+        stats_, queue_time_us, microsecondsBetween(request->enqueued, start));
+  }
+  CAFFE_EVENT(stats_, num_batches);
+  CAFFE_EVENT(stats_, batch_rows, total_rows);
+  CAFFE_EVENT(stats_, batch_requests, batch.size());
+
+  bool success = false;
+  try {
+    // Concatenates the inputs along the batch dimension. A single request
+    // runs on its own inputs.
+    TensorMap batched_inputs;
+    if (batch.size() > 1) {
+      for (const auto& input : *batch.front()->inputs) {
+        auto dims = input.second.sizes().vec();
+        dims[0] = total_rows;
+        Tensor batched(dims, CPU);
+        const auto& meta = input.second.dtype();
+        auto* dst = static_cast<char*>(batched.raw_mutable_data(meta));
+        for (const auto& request : batch) {
+          const auto& src = request->inputs->at(input.first);
+          copyItems(meta, src.numel(), src.raw_data(), dst);
+          dst += src.nbytes();
+        }
+        batched_inputs.emplace(input.first, std::move(batched));
+      }
+    }
+
+    Predictor::TensorList batched_outputs;
+    success = (*predictor_)(
+        batch.size() > 1 ? batched_inputs : *batch.front()->inputs,
+        &batched_outputs);
+
+    if (success) {
+      // Copies each request's rows out of the outputs, which belong to the
+      // workspace of the predictor
+      const auto& def = predictor_->def();
+      for (size_t i = 0; i < batched_outputs.size(); ++i) {
+        const auto& output = batched_outputs[i];
+        const auto& name = def.external_output(i);
+        CAFFE_ENFORCE(
+            output.dim() >= 1 && output.size(0) == total_rows,
+            "Output ",
+            name,
+            " must have the batch size of the inputs (",
+            total_rows,
+            " rows) to be split between requests");
+        const auto& meta = output.dtype();
+        const auto row_numel = output.size_from_dim(1);
+        const auto* src = static_cast<const char*>(output.raw_data());
+        for (const auto& request : batch) {
+          auto dims = output.sizes().vec();
+          dims[0] = request->rows;
+          Tensor result(dims, CPU);
+          copyItems(
+              meta,
+              request->rows * row_numel,
+              src,
+              result.raw_mutable_data(meta));
+          src += request->rows * row_numel * meta.itemsize();
+          (*request->outputs)[name] = std::move(result);
+        }
+      }
+    }
+  } catch (...) {
+    CAFFE_EVENT(stats_, num_failures);
+    auto error = std::current_exception();
+    for (const auto& request : batch) {
+      request->done.set_exception(error);
+    }
+    return;
+  }
+
+  if (!success) {
+    CAFFE_EVENT(stats_, num_failures);
+  }
+  CAFFE_EVENT(stats_, run_time_us, microsecondsBetween(start, Clock::now()));
+  for (const auto& request : batch) {
+    request->done.set_value(success);
+  }
+}
+
+} // namespace caffe2
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "caffe2/core/stats.h"
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+struct CAFFE2_API BatchingPredictorOptions {
+  // Largest number of rows (the sum of the batch dimensions of the requests)
+  // that run in one execution of the predict net. A single request with more
+  // rows still runs, on its own.
+  int64_t max_batch_size = 32;
+  // How long the oldest queued request waits for others to join its batch
+  std::chrono::microseconds max_batch_delay{1000};
+};
+
+/**
+ * @brief Coalesces concurrent requests into batched runs of a Predictor.
+ *
+ * Callers from any number of threads submit a TensorMap whose tensors all
+ * share their first (batch) dimension. A worker thread concatenates the
+ * inputs of compatible queued requests (same input names, types and
+ * per-row shapes) along that dimension, until max_batch_size rows are queued
+ * or the oldest request waited for max_batch_delay, runs the predict net
+ * once, and splits every output of the net back into the rows of each
+ * request. Requests may pass a latency budget: the batch runs early enough
+ * for the request, and a request still queued when its budget runs out fails
+ * without running.
+ *
+ * Example:
+ *
+ *   BatchingPredictor predictor(
+ *       caffe2::make_unique<Predictor>(makePredictorConfig(init, run)));
+ *   // in each serving thread
+ *   Predictor::TensorMap outputs;
+ *   if (!predictor(inputs, &outputs, std::chrono::milliseconds(5))) {
+ *     // net failed, or timed out in the queue
+ *   }
+ */
+class CAFFE2_API BatchingPredictor {
+ public:
+  using TensorMap = Predictor::TensorMap;
+  using Clock = std::chrono::steady_clock;
+
+  explicit BatchingPredictor(
+      std::unique_ptr<Predictor> predictor,
+      BatchingPredictorOptions options = BatchingPredictorOptions(),
+      const std::string& name = "batching_predictor");
+
+  // Runs the requests that are still queued, then stops the worker
+  ~BatchingPredictor();
+
+  // Runs the inputs as part of a batch, and blocks until it ran. `outputs`
+  // maps the names of the external outputs of the predict net to this
+  // request's rows of them. They own their memory, unlike the outputs of
+  // Predictor.
+  //
+  // Returns false if the net failed, or if the request was still queued
+  // after `latency_budget`. Errors thrown while running the batch are
+  // rethrown to each of its callers.
+  bool operator()(
+      const TensorMap& inputs,
+      TensorMap* outputs,
+      std::chrono::microseconds latency_budget =
+          std::chrono::microseconds::max());
+
+  const Predictor& predictor() const {
+    return *predictor_;
+  }
+
+ private:
+  struct Request;
+  using RequestPtr = std::shared_ptr<Request>;
+
+  void workerLoop();
+  // Moves the requests of the next batch out of the queue; requests whose
+  // deadline is before `cutoff` are failed instead. Requires mutex_.
+  std::vector<RequestPtr> takeBatch(Clock::time_point cutoff);
+  // The time at which the batch that the front of the queue starts has to
+  // run, and whether it is full already. Requires mutex_.
+  Clock::time_point batchDeadline() const;
+  bool batchFull() const;
+  void runBatch(const std::vector<RequestPtr>& batch);
+
+  std::unique_ptr<Predictor> predictor_;
+  const BatchingPredictorOptions options_;
+
+  std::mutex mutex_; // protects queue_ and stop_
+  std::condition_variable cv_;
+  std::deque<RequestPtr> queue_;
+  bool stop_{false};
+  std::thread worker_;
+
+  struct BatchingPredictorStats {
+    CAFFE_STAT_CTOR(BatchingPredictorStats);
+    CAFFE_EXPORTED_STAT(num_requests);
+    CAFFE_EXPORTED_STAT(num_batches);
+    CAFFE_EXPORTED_STAT(num_timeouts);
+    CAFFE_EXPORTED_STAT(num_failures);
+    CAFFE_AVG_EXPORTED_STAT(batch_rows);
+    CAFFE_AVG_EXPORTED_STAT(batch_requests);
+    CAFFE_AVG_EXPORTED_STAT(queue_time_us);
+    CAFFE_AVG_EXPORTED_STAT(run_time_us);
+  } stats_;
+};
+
+} // namespace caffe2
@@ -0,0 +1,192 @@
+#include "caffe2/core/stats.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/batching_predictor.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+// y = FC(data, W = 2, b = 2), so each row of y is 2 * sum(data row) + 2
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "dag"
+        op {
+          type: "ConstantFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 10
+            ints: 4
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+std::unique_ptr<Predictor> makePredictor() {
+  return caffe2::make_unique<Predictor>(
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec)));
+}
+
+// `rows` rows of `cols` elements, all equal to `value`
+Predictor::TensorMap makeInputs(int64_t rows, float value, int64_t cols = 4) {
+  Predictor::TensorMap inputs;
+  Tensor data(std::vector<int64_t>{rows, cols}, CPU);
+  auto* ptr = data.mutable_data<float>();
+  for (int64_t i = 0; i < data.numel(); ++i) {
+    ptr[i] = value;
+  }
+  inputs.emplace("data", std::move(data));
+  return inputs;
+}
+
+void expectOutputs(const Predictor::TensorMap& outputs, int64_t rows, float value) {
+  ASSERT_EQ(outputs.count("y"), 1);
+  const auto& y = outputs.at("y");
+  ASSERT_EQ(y.dim(), 2);
+  EXPECT_EQ(y.size(0), rows);
+  EXPECT_EQ(y.size(1), 10);
+  for (int64_t i = 0; i < y.numel(); ++i) {
+    EXPECT_FLOAT_EQ(y.data<float>()[i], 2 * 4 * value + 2);
+  }
+}
+
+int64_t statValue(const std::string& name) {
+  auto stats = toMap(StatRegistry::get().publish());
+  auto it = stats.find(name);
+  return it == stats.end() ? 0 : it->second;
+}
+
+} // namespace
+
+TEST(BatchingPredictorTest, CoalescesConcurrentRequests) {
+  const int kNumRequests = 4;
+  BatchingPredictorOptions options;
+  // Each request has i + 1 rows
+  options.max_batch_size = kNumRequests * (kNumRequests + 1) / 2;
+  options.max_batch_delay = std::chrono::seconds(60);
+  BatchingPredictor predictor(makePredictor(), options, "batching_test_full");
+
+  std::vector<Predictor::TensorMap> inputs, outputs(kNumRequests);
+  for (int i = 0; i < kNumRequests; ++i) {
+    inputs.push_back(makeInputs(i + 1, i));
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back(
+        [&, i] { EXPECT_TRUE(predictor(inputs[i], &outputs[i])); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumRequests; ++i) {
+    expectOutputs(outputs[i], i + 1, i);
+  }
+  // The batch only ran once it was full
+  EXPECT_EQ(statValue("batching_test_full/num_batches"), 1);
+  EXPECT_EQ(statValue("batching_test_full/num_requests"), kNumRequests);
+}
+
+TEST(BatchingPredictorTest, RunsAfterDelay) {
+  BatchingPredictorOptions options;
+  options.max_batch_size = 1000;
+  options.max_batch_delay = std::chrono::milliseconds(1);
+  BatchingPredictor predictor(makePredictor(), options);
+
+  for (int i = 0; i < 3; ++i) {
+    auto inputs = makeInputs(2, 1.5);
+    Predictor::TensorMap outputs;
+    EXPECT_TRUE(predictor(inputs, &outputs));
+    expectOutputs(outputs, 2, 1.5);
+  }
+}
+
+TEST(BatchingPredictorTest, LatencyBudget) {
+  BatchingPredictorOptions options;
+  options.max_batch_size = 1000;
+  options.max_batch_delay = std::chrono::seconds(60);
+  BatchingPredictor predictor(makePredictor(), options, "batching_test_budget");
+
+  // A budget shorter than the batch delay makes the batch run early
+  auto inputs = makeInputs(3, 1);
+  Predictor::TensorMap outputs;
+  EXPECT_TRUE(predictor(inputs, &outputs, std::chrono::milliseconds(100)));
+  expectOutputs(outputs, 3, 1);
+
+  // A budget that ran out before the request could run fails it
+  EXPECT_FALSE(predictor(inputs, &outputs, std::chrono::microseconds(-1)));
+  EXPECT_EQ(statValue("batching_test_budget/num_timeouts"), 1);
+}
+
+TEST(BatchingPredictorTest, PropagatesErrors) {
+  BatchingPredictorOptions options;
+  options.max_batch_delay = std::chrono::microseconds(0);
+  BatchingPredictor predictor(makePredictor(), options);
+
+  // W expects rows of 4 elements
+  auto inputs = makeInputs(2, 1, /*cols=*/5);
+  Predictor::TensorMap outputs;
+  bool failed = false;
+  try {
+    failed = !predictor(inputs, &outputs);
+  } catch (const EnforceNotMet&) {
+    failed = true;
+  }
+  EXPECT_TRUE(failed);
+
+  // Inputs need a batch dimension
+  Predictor::TensorMap scalar;
+  scalar.emplace("data", Tensor(std::vector<int64_t>{}, CPU));
+  EXPECT_THROW(predictor(scalar, &outputs), EnforceNotMet);
+
+  // The predictor still serves requests after an error
+  inputs = makeInputs(1, 2);
+  EXPECT_TRUE(predictor(inputs, &outputs));
+  expectOutputs(outputs, 1, 2);
+}
+
+} // namespace caffe2
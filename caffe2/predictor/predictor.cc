@@ -1,5 +1,6 @@
 #include "caffe2/predictor/predictor.h"
 #include <unordered_set>
+#include "c10/util/TraceContext.h"
 #include "caffe2/core/init.h"
 
 namespace caffe2 {
@@ -24,6 +25,51 @@ const Tensor& getTensor(Workspace* ws, const std::string& name) {
   return *BlobGetMutableTensor(getBlob(ws, name), CPU);
 }
 
+// Makes an output blob hold the tensor of the caller while the net runs, and
+// gives the blob its own tensor back afterwards.
+class ScopedOutputBinding {
+ public:
+  ScopedOutputBinding(Workspace* ws, const std::string& name, Tensor target)
+      : blob_(ws->GetBlob(name)), name_(name), target_(std::move(target)) {
+    CAFFE_ENFORCE(blob_, "Blob: ", name, " does not exist");
+    CAFFE_ENFORCE(
+        target_ && target_.GetDeviceType() == CPU,
+        "Output tensor is not a CPU Tensor: ",
+        name);
+    if (BlobIsTensorType(*blob_, CPU)) {
+      previous_ = blob_->Get<Tensor>();
+    }
+    BlobSetTensor(blob_, target_);
+  }
+
+  ~ScopedOutputBinding() {
+    if (previous_) {
+      BlobSetTensor(blob_, previous_);
+    } else {
+      blob_->Reset();
+    }
+  }
+
+  // Copies the output into the tensor of the caller, if the net replaced
+  // the tensor of the blob rather than writing it.
+  void finish() {
+    CAFFE_ENFORCE(
+        BlobIsTensorType(*blob_, CPU), "Blob is not a CPU Tensor: ", name_);
+    const auto& result = blob_->Get<Tensor>();
+    if (result.unsafeGetTensorImpl() != target_.unsafeGetTensorImpl()) {
+      target_.CopyFrom(result);
+    }
+  }
+
+ private:
+  Blob* blob_;
+  std::string name_;
+  Tensor target_;
+  Tensor previous_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(ScopedOutputBinding);
+};
+
 } // namespace
 
 Predictor::Predictor(
@@ -53,6 +99,7 @@ Predictor::Predictor(PredictorConfig config) : config_(std::move(config)) {
 }
 
 bool Predictor::operator()(const TensorList& inputs, TensorList* outputs) {
+  c10::TraceContextGuard trace_guard(c10::TraceContext::currentOrNewRequest());
   CAFFE_ENFORCE(
       inputs.size() <=
       static_cast<unsigned>(config_.predict_net->external_input_size()));
@@ -92,6 +139,7 @@ bool Predictor::run_map_workspace(const TensorMap& inputs) {
 }
 
 bool Predictor::operator()(const TensorMap& inputs, TensorList* outputs) {
+  c10::TraceContextGuard trace_guard(c10::TraceContext::currentOrNewRequest());
   if (!run_map_workspace(inputs)) {
     return false;
   }
@@ -104,6 +152,7 @@ bool Predictor::operator()(const TensorMap& inputs, TensorList* outputs) {
 }
 
 bool Predictor::operator()(const TensorMap& inputs, TensorMap* outputs) {
+  c10::TraceContextGuard trace_guard(c10::TraceContext::currentOrNewRequest());
   if (!run_map_workspace(inputs)) {
     return false;
   }
@@ -114,4 +163,28 @@ bool Predictor::operator()(const TensorMap& inputs, TensorMap* outputs) {
   return true;
 }
 
+bool Predictor::run_into(const TensorMap& inputs, const TensorMap& outputs) {
+  c10::TraceContextGuard trace_guard(c10::TraceContext::currentOrNewRequest());
+  std::vector<std::unique_ptr<ScopedOutputBinding>> bindings;
+  for (const auto& output : outputs) {
+    if (!output_names().empty()) {
+      CAFFE_ENFORCE(
+          std::find(
+              output_names().begin(), output_names().end(), output.first) !=
+              output_names().end(),
+          "Output can't be found: ",
+          output.first);
+    }
+    bindings.emplace_back(caffe2::make_unique<ScopedOutputBinding>(
+        config_.ws.get(), output.first, output.second));
+  }
+  if (!run_map_workspace(inputs)) {
+    return false;
+  }
+  for (auto& binding : bindings) {
+    binding->finish();
+  }
+  return true;
+}
+
 } // namespace caffe2
@@ -38,6 +38,11 @@ class CAFFE2_API Predictor {
   // NOTE: output is a part of thread local workspace
   // and is only valid until the next predictor execution.
 
+  // Every run is a request for tracing: the events the nets and operators
+  // trace while running are tagged with its id (see c10/util/TraceContext.h).
+  // Callers with their own request ids set them with a c10::TraceContextGuard
+  // around the call.
+
   // Returns true on success
   bool operator()(const TensorList& inputs, TensorList* outputs);
 
@@ -48,6 +53,15 @@ class CAFFE2_API Predictor {
   // string name to tensor.
   bool operator()(const TensorMap& inputs, TensorMap* outputs);
 
+  // Similar to the TensorMap run fns, except that the net writes the outputs
+  // named in `outputs` into the tensors given there instead of tensors of the
+  // workspace. An output tensor that already holds memory of the size and
+  // type of the output is filled in place, so that the outputs can go
+  // straight to buffers of the caller (see Tensor::ShareExternalPointer); the
+  // others are resized, or copied into if the net replaces the output.
+  // The inputs are shared with the net, as in the other run fns.
+  bool run_into(const TensorMap& inputs, const TensorMap& outputs);
+
   const NetDef& def() const {
     return *config_.predict_net;
   };
@@ -0,0 +1,162 @@
+#include "caffe2/predictor/predictor_pool.h"
+
+#include <algorithm>
+
+namespace caffe2 {
+
+namespace {
+
+bool contains(const std::vector<std::string>& names, const std::string& name) {
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+void copyOutputs(const Predictor::TensorList& from, Predictor::TensorList* to) {
+  to->clear();
+  to->reserve(from.size());
+  for (const auto& tensor : from) {
+    to->push_back(tensor.Clone());
+  }
+}
+
+} // namespace
+
+PredictorPool::PredictorPool(
+    const NetDef& init_net,
+    const NetDef& run_net,
+    size_t num_warm,
+    Workspace* parent,
+    int optimization)
+    : PredictorPool(
+          makePredictorConfig(init_net, run_net, parent, true, optimization),
+          num_warm) {}
+
+PredictorPool::PredictorPool(PredictorConfig config, size_t num_warm)
+    : parameters_ws_(std::move(config.ws)),
+      predict_net_(std::move(config.predict_net)),
+      input_names_(std::move(config.input_names)),
+      output_names_(std::move(config.output_names)) {
+  CAFFE_ENFORCE(parameters_ws_);
+  CAFFE_ENFORCE(predict_net_);
+
+  // The inputs are the declared ones or, without declaration, the external
+  // inputs that are no parameters
+  if (!input_names_.empty()) {
+    local_inputs_ = input_names_;
+  } else {
+    for (const auto& name : predict_net_->external_input()) {
+      if (!parameters_ws_->HasBlob(name)) {
+        local_inputs_.push_back(name);
+      }
+    }
+  }
+
+  for (const auto& op : predict_net_->op()) {
+    for (const auto& output : op.output()) {
+      CAFFE_ENFORCE(
+          !parameters_ws_->HasBlob(output) || contains(local_inputs_, output),
+          "Operator ",
+          op.type(),
+          " of ",
+          predict_net_->name(),
+          " writes to ",
+          output,
+          ", which is shared between the Predictors of the pool");
+    }
+  }
+
+  for (size_t i = 0; i < num_warm; ++i) {
+    idle_.push_back(makePredictor());
+  }
+  size_ = num_warm;
+}
+
+std::unique_ptr<Predictor> PredictorPool::makePredictor() const {
+  PredictorConfig config;
+  config.ws = std::make_shared<Workspace>(parameters_ws_.get());
+  for (const auto& name : local_inputs_) {
+    BlobGetMutableTensor(config.ws->CreateLocalBlob(name), CPU);
+  }
+  config.predict_net = predict_net_;
+  config.input_names = input_names_;
+  config.output_names = output_names_;
+  return caffe2::make_unique<Predictor>(std::move(config));
+}
+
+PredictorPool::Handle PredictorPool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_.empty()) {
+      auto predictor = std::move(idle_.back());
+      idle_.pop_back();
+      return Handle(this, std::move(predictor));
+    }
+    ++size_;
+  }
+  // Creates the nets outside of the lock
+  try {
+    return Handle(this, makePredictor());
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --size_;
+    throw;
+  }
+}
+
+void PredictorPool::release(std::unique_ptr<Predictor> predictor) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_.push_back(std::move(predictor));
+}
+
+PredictorPool::Handle::~Handle() {
+  if (predictor_) {
+    pool_->release(std::move(predictor_));
+  }
+}
+
+bool PredictorPool::operator()(const TensorList& inputs, TensorList* outputs) {
+  CAFFE_ENFORCE(
+      inputs.size() <= static_cast<size_t>(predict_net_->external_input_size()));
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    CAFFE_ENFORCE(
+        contains(local_inputs_, predict_net_->external_input(i)),
+        "External input ",
+        predict_net_->external_input(i),
+        " is a parameter shared between the Predictors of the pool");
+  }
+  auto predictor = acquire();
+  TensorList results;
+  if (!(*predictor)(inputs, &results)) {
+    return false;
+  }
+  copyOutputs(results, outputs);
+  return true;
+}
+
+bool PredictorPool::operator()(const TensorMap& inputs, TensorList* outputs) {
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE(
+        contains(local_inputs_, input.first),
+        "Input ",
+        input.first,
+        " is a parameter shared between the Predictors of the pool");
+  }
+  auto predictor = acquire();
+  TensorList results;
+  if (!(*predictor)(inputs, &results)) {
+    return false;
+  }
+  copyOutputs(results, outputs);
+  return true;
+}
+
+size_t PredictorPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+size_t PredictorPool::idle() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+} // namespace caffe2
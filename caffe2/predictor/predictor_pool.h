@@ -0,0 +1,112 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "caffe2/predictor/predictor.h"
+
+namespace caffe2 {
+
+/**
+ * @brief A pool of Predictors that share one copy of the parameters.
+ *
+ * init_net runs once, in a parameter workspace. Each Predictor of the pool
+ * runs predict_net in its own child workspace of it: the child holds the
+ * inputs and the activations of the net, and reads the parameters from the
+ * parent. Predictors are checked out for the duration of a request, so that
+ * concurrent requests run on different workspaces; the pool grows when all
+ * of them are busy.
+ *
+ * The parameters are shared read-only: predict_net may not write to a blob
+ * of the parameter workspace.
+ *
+ * Example:
+ *
+ *   PredictorPool pool(init_net, predict_net, num_threads);
+ *   // in each serving thread
+ *   Predictor::TensorList outputs;
+ *   pool(inputs, &outputs);
+ */
+class CAFFE2_API PredictorPool {
+ public:
+  using TensorList = Predictor::TensorList;
+  using TensorMap = Predictor::TensorMap;
+
+  // Runs init_net in a child workspace of `parent` (if given), and creates
+  // `num_warm` Predictors, with their nets, ahead of the first request.
+  PredictorPool(
+      const NetDef& init_net,
+      const NetDef& run_net,
+      size_t num_warm = 1,
+      Workspace* parent = nullptr,
+      int optimization = 1);
+
+  // Takes the parameters from the workspace of `config`, whose init net has
+  // run already.
+  explicit PredictorPool(PredictorConfig config, size_t num_warm = 1);
+
+  /**
+   * @brief A Predictor checked out of the pool, which returns it when
+   * destroyed. The outputs of the predictor are valid until it runs again or
+   * is returned.
+   */
+  class CAFFE2_API Handle {
+   public:
+    Handle(Handle&& other) noexcept
+        : pool_(other.pool_), predictor_(std::move(other.predictor_)) {}
+    ~Handle();
+
+    Predictor& operator*() const {
+      return *predictor_;
+    }
+    Predictor* operator->() const {
+      return predictor_.get();
+    }
+
+   private:
+    friend class PredictorPool;
+    Handle(PredictorPool* pool, std::unique_ptr<Predictor> predictor)
+        : pool_(pool), predictor_(std::move(predictor)) {}
+
+    PredictorPool* pool_;
+    std::unique_ptr<Predictor> predictor_;
+    C10_DISABLE_COPY_AND_ASSIGN(Handle);
+  };
+
+  // Checks out an idle Predictor, or creates one if all of them are busy
+  Handle acquire();
+
+  // Run predict_net on a Predictor of the pool. Unlike the outputs of
+  // Predictor, the outputs own their memory.
+  bool operator()(const TensorList& inputs, TensorList* outputs);
+  bool operator()(const TensorMap& inputs, TensorList* outputs);
+
+  // The workspace that holds the parameters
+  const Workspace& parameters() const {
+    return *parameters_ws_;
+  }
+
+  // Number of Predictors the pool created, and how many of them are idle
+  size_t size() const;
+  size_t idle() const;
+
+ private:
+  std::unique_ptr<Predictor> makePredictor() const;
+  void release(std::unique_ptr<Predictor> predictor);
+
+  std::shared_ptr<Workspace> parameters_ws_;
+  std::shared_ptr<NetDef> predict_net_;
+  std::vector<std::string> input_names_;
+  std::vector<std::string> output_names_;
+  // Inputs of predict_net that each child workspace holds itself, even if
+  // the parameter workspace has a blob of the same name
+  std::vector<std::string> local_inputs_;
+
+  mutable std::mutex mutex_; // protects idle_ and size_
+  std::vector<std::unique_ptr<Predictor>> idle_;
+  size_t size_{0};
+};
+
+} // namespace caffe2
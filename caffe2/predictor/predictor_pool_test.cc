@@ -0,0 +1,158 @@
+#include "caffe2/core/tensor.h"
+#include "caffe2/predictor/predictor_pool.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+// y = FC(data, W = 2, b = 2), so each row of y is 2 * sum(data row) + 2
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "dag"
+        op {
+          type: "ConstantFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 10
+            ints: 4
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 10
+          }
+          arg {
+            name: "value"
+            f: 2.0
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+Predictor::TensorList makeInputs(int64_t rows, float value) {
+  Predictor::TensorList inputs;
+  inputs.emplace_back(std::vector<int64_t>{rows, 4}, CPU);
+  auto* ptr = inputs.back().mutable_data<float>();
+  for (int64_t i = 0; i < inputs.back().numel(); ++i) {
+    ptr[i] = value;
+  }
+  return inputs;
+}
+
+void expectOutputs(const Predictor::TensorList& outputs, int64_t rows, float value) {
+  ASSERT_EQ(outputs.size(), 1);
+  const auto& y = outputs.front();
+  ASSERT_EQ(y.dim(), 2);
+  EXPECT_EQ(y.size(0), rows);
+  EXPECT_EQ(y.size(1), 10);
+  for (int64_t i = 0; i < y.numel(); ++i) {
+    EXPECT_FLOAT_EQ(y.data<float>()[i], 2 * 4 * value + 2);
+  }
+}
+
+} // namespace
+
+TEST(PredictorPoolTest, SharesParameters) {
+  PredictorPool pool(parseNetDef(initSpec), parseNetDef(predictSpec), 2);
+  EXPECT_EQ(pool.size(), 2);
+  EXPECT_EQ(pool.idle(), 2);
+
+  auto a = pool.acquire();
+  auto b = pool.acquire();
+  EXPECT_EQ(pool.idle(), 0);
+  EXPECT_NE(a->ws(), b->ws());
+  for (const auto& name : {"W", "b"}) {
+    const Blob* param = pool.parameters().GetBlob(name);
+    ASSERT_TRUE(param);
+    EXPECT_EQ(a->ws()->GetBlob(name), param);
+    EXPECT_EQ(b->ws()->GetBlob(name), param);
+  }
+  // Inputs and activations live in the child workspaces
+  EXPECT_NE(a->ws()->GetBlob("data"), b->ws()->GetBlob("data"));
+  EXPECT_FALSE(pool.parameters().HasBlob("data"));
+
+  Predictor::TensorList outputs;
+  EXPECT_TRUE((*a)(makeInputs(3, 1), &outputs));
+  expectOutputs(outputs, 3, 1);
+  EXPECT_FALSE(pool.parameters().HasBlob("y"));
+
+  // All predictors are busy, so the pool grows
+  EXPECT_TRUE(pool(makeInputs(2, 2), &outputs));
+  expectOutputs(outputs, 2, 2);
+  EXPECT_EQ(pool.size(), 3);
+  EXPECT_EQ(pool.idle(), 1);
+}
+
+TEST(PredictorPoolTest, ConcurrentRequests) {
+  const int kNumThreads = 4;
+  PredictorPool pool(parseNetDef(initSpec), parseNetDef(predictSpec), kNumThreads);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&pool, i] {
+      for (int j = 0; j < 20; ++j) {
+        Predictor::TensorList outputs;
+        EXPECT_TRUE(pool(makeInputs(i + 1, i + j), &outputs));
+        expectOutputs(outputs, i + 1, i + j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(pool.size(), kNumThreads);
+  EXPECT_EQ(pool.idle(), kNumThreads);
+}
+
+TEST(PredictorPoolTest, RejectsWritesToParameters) {
+  auto predict_net = parseNetDef(predictSpec);
+  predict_net.mutable_op(0)->set_output(0, "W");
+  EXPECT_THROW(
+      PredictorPool(parseNetDef(initSpec), predict_net), EnforceNotMet);
+
+  // Parameters can't be passed as inputs either
+  PredictorPool pool(parseNetDef(initSpec), parseNetDef(predictSpec));
+  auto inputs = makeInputs(1, 1);
+  inputs.push_back(inputs.front());
+  Predictor::TensorList outputs;
+  EXPECT_THROW(pool(inputs, &outputs), EnforceNotMet);
+}
+
+} // namespace caffe2
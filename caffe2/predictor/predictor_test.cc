@@ -209,4 +209,36 @@ TEST_F(PredictorTest, SimpleBatchSizedMapInput) {
   EXPECT_NEAR(output.front().data<float>()[4], 0.1209, 1E-4);
 }
 
+TEST_F(PredictorTest, RunIntoCallerBuffers) {
+  auto inputData = randomTensor({1, 4}, ctx_.get());
+  Predictor::TensorMap input;
+  input.emplace("data", BlobGetMutableTensor(inputData.get(), CPU)->Clone());
+
+  std::vector<float> buffer(10);
+  Predictor::TensorMap output;
+  auto iter = output.emplace("y", Tensor(CPU));
+  iter.first->second.Resize(1, 10);
+  iter.first->second.ShareExternalPointer(
+      buffer.data(), buffer.size() * sizeof(float));
+  EXPECT_TRUE(p_->run_into(input, output));
+  EXPECT_EQ(output.at("y").data<float>(), buffer.data());
+  EXPECT_NEAR(buffer[4], 0.1209, 1E-4);
+
+  // The workspace doesn't write into the buffer of the caller afterwards
+  buffer[4] = 0;
+  Predictor::TensorList results;
+  EXPECT_TRUE((*p_)(input, &results));
+  EXPECT_NE(results.front().data<float>(), buffer.data());
+  EXPECT_NEAR(results.front().data<float>()[4], 0.1209, 1E-4);
+  EXPECT_EQ(buffer[4], 0);
+
+  // An output of another size is resized
+  Predictor::TensorMap resized;
+  resized.emplace("y", Tensor(std::vector<int64_t>{3}, CPU));
+  resized.at("y").mutable_data<float>();
+  EXPECT_TRUE(p_->run_into(input, resized));
+  EXPECT_EQ(resized.at("y").sizes(), (std::vector<int64_t>{1, 10}));
+  EXPECT_NEAR(resized.at("y").data<float>()[4], 0.1209, 1E-4);
+}
+
 } // namespace caffe2
@@ -2634,6 +2634,21 @@ class ExecutionStep(object):
         self._assert_can_mutate()
         self._step.num_concurrent_instances = num_concurrent_instances
 
+    def SetPipelineSubsteps(self, pipeline_substeps):
+        self._assert_can_mutate()
+        assert not self.HasNets(), 'Cannot have both network and substeps.'
+        self._step.pipeline_substeps = pipeline_substeps
+
+    def SetPipelineOutputBlobs(self, pipeline_output_blobs):
+        self._assert_can_mutate()
+        del self._step.pipeline_output_blob[:]
+        self._step.pipeline_output_blob.extend(
+            [str(b) for b in pipeline_output_blobs])
+
+    def SetPipelineQueueCapacity(self, pipeline_queue_capacity):
+        self._assert_can_mutate()
+        self._step.pipeline_queue_capacity = pipeline_queue_capacity
+
     def SetOnlyOnce(self, only_once):
         self._assert_can_mutate()
         self._step.only_once = only_once
@@ -2738,6 +2753,11 @@ class ExecutionStep(object):
             step_proto.HasField('create_workspace') else None
         run_every_ms = step_proto.run_every_ms if\
             step_proto.HasField('run_every_ms') else None
+        pipeline_substeps = step_proto.pipeline_substeps if\
+            step_proto.HasField('pipeline_substeps') else None
+        pipeline_output_blobs = list(step_proto.pipeline_output_blob) or None
+        pipeline_queue_capacity = step_proto.pipeline_queue_capacity if\
+            step_proto.HasField('pipeline_queue_capacity') else None
 
         return execution_step(
             step_proto.name,
@@ -2750,7 +2770,10 @@ class ExecutionStep(object):
             only_once=only_once,
             num_concurrent_instances=num_concurrent_instances,
             create_workspace=create_workspace,
-            run_every_ms=run_every_ms)
+            run_every_ms=run_every_ms,
+            pipeline_substeps=pipeline_substeps,
+            pipeline_output_blobs=pipeline_output_blobs,
+            pipeline_queue_capacity=pipeline_queue_capacity)
 
 
 def add_nets_in_order(step, net_list):
@@ -2869,7 +2892,10 @@ def execution_step(default_name,
                    only_once=None,
                    num_concurrent_instances=None,
                    create_workspace=False,
-                   run_every_ms=None):
+                   run_every_ms=None,
+                   pipeline_substeps=None,
+                   pipeline_output_blobs=None,
+                   pipeline_queue_capacity=None):
     """
     Helper for creating an ExecutionStep.
     - steps_or_nets can be:
@@ -2883,6 +2909,13 @@ def execution_step(default_name,
       - If specified and true, then this step will return immediately.
       - Be sure to handle race conditions if setting from concurrent threads.
     - if no should_stop_blob or num_iter is provided, defaults to num_iter=1
+    - if pipeline_substeps is true, the substeps are run concurrently as the
+      stages of a pipeline, each in num_concurrent_instances threads.
+      - An iteration of a stage passes its pipeline_output_blobs to an
+        iteration of the next stage, through a queue of at most
+        pipeline_queue_capacity items.
+      - num_iter and should_stop_blob of the first stage bound the number of
+        items, the other stages run until they processed all of them.
     """
     assert should_stop_blob is None or num_iter is None, (
         'Cannot set both should_stop_blob and num_iter.')
@@ -2907,6 +2940,12 @@ def execution_step(default_name,
         step.SetCreateWorkspace(True)
     if run_every_ms:
         step.RunEveryMillis(run_every_ms)
+    if pipeline_substeps is not None:
+        step.SetPipelineSubsteps(pipeline_substeps)
+    if pipeline_output_blobs is not None:
+        step.SetPipelineOutputBlobs(pipeline_output_blobs)
+    if pipeline_queue_capacity is not None:
+        step.SetPipelineQueueCapacity(pipeline_queue_capacity)
 
     if isinstance(steps_or_nets, ExecutionStep):
         step.AddSubstep(steps_or_nets)
@@ -573,5 +573,95 @@ class ConvFusionTest(hu.HypothesisTestCase):
 
         workspace.SwitchWorkspace(old_ws_name)
 
+    @given(stride=st.integers(1, 3),
+           pad=st.integers(0, 3),
+           kernel=st.integers(3, 5),
+           size=st.integers(8, 20),
+           input_channels=st.integers(1, 16),
+           output_channels=st.integers(1, 16),
+           batch_size=st.integers(1, 3),
+           **mu.gcs)
+    def test_convolution_bn_relu_fusion_across_nets(
+            self, stride, pad, kernel, size, input_channels,
+            output_channels, batch_size, gc, dc):
+        conv = core.CreateOperator(
+            "Conv",
+            ["X0", "w0", "b0"],
+            ["X1"],
+            stride=stride,
+            pad=pad,
+            kernel=kernel,
+            device_option=dc[1]
+        )
+        bn = core.CreateOperator(
+            "SpatialBN",
+            ["X1", "scale", "bias", "mean", "var"],
+            ["X2"],
+            is_test=True,
+            device_option=dc[1]
+        )
+        relu = core.CreateOperator(
+            "Relu",
+            ["X2"],
+            ["Y"],
+            device_option=dc[1]
+        )
+
+        X = np.random.rand(
+            batch_size, input_channels, size, size).astype(np.float32) - 0.5
+        w = np.random.rand(
+            output_channels, input_channels, kernel, kernel) \
+            .astype(np.float32) - 0.5
+        b = np.random.rand(output_channels).astype(np.float32) - 0.5
+        scale = np.random.rand(output_channels).astype(np.float32) + 0.5
+        bias = np.random.rand(output_channels).astype(np.float32) - 0.5
+        mean = np.random.randn(output_channels).astype(np.float32)
+        var = np.absolute(np.random.rand(output_channels).astype(np.float32)) + 0.5
+
+        def feed_blobs():
+            workspace.FeedBlob('X0', X, dc[1])
+            workspace.FeedBlob('w0', w, dc[1])
+            workspace.FeedBlob('b0', b, dc[1])
+            workspace.FeedBlob('scale', scale, dc[1])
+            workspace.FeedBlob('bias', bias, dc[1])
+            workspace.FeedBlob('mean', mean, dc[1])
+            workspace.FeedBlob('var', var, dc[1])
+
+        old_ws_name = workspace.CurrentWorkspace()
+        workspace.SwitchWorkspace("_device_check_", True)
+        feed_blobs()
+        workspace.RunOperatorOnce(conv)
+        workspace.RunOperatorOnce(bn)
+        workspace.RunOperatorOnce(relu)
+        Y = workspace.FetchBlob('Y')
+
+        workspace.ResetWorkspace()
+        feed_blobs()
+        old_net = caffe2_pb2.NetDef()
+        old_net.op.extend([conv, bn, relu])
+        net = core.Net("net")
+        net.Proto().CopyFrom(old_net)
+        optimizeForIDEEP(net)
+        self.assertTrue(len(net.Proto().op) == 1)
+        self.assertTrue(net.Proto().op[0].type == "ConvFusion")
+        # Two nets running the same fused op share the reordered filter
+        net1 = core.Net("net1")
+        net1.Proto().CopyFrom(net.Proto())
+        net1.Proto().name = "net1"
+        workspace.CreateNet(net)
+        workspace.CreateNet(net1)
+        for n in [net, net1]:
+            workspace.FeedBlob('Y', np.zeros(1, dtype=np.float32), dc[1])
+            workspace.RunNet(n)
+            Y1 = workspace.FetchBlob('Y')
+            if not np.allclose(Y, Y1, atol=0.01, rtol=0.01):
+                print(Y.flatten())
+                print(Y1.flatten())
+                print(np.max(np.abs(Y - Y1)))
+                self.assertTrue(False)
+        self.assertTrue(workspace.HasBlob("__IDEEP_WEIGHTS_CACHE_w0__"))
+
+        workspace.SwitchWorkspace(old_ws_name)
+
 if __name__ == "__main__":
     unittest.main()
@@ -8,7 +8,9 @@ from functools import reduce
 import hypothesis.strategies as st
 from hypothesis import given, settings
 import numpy as np
+from caffe2.proto import caffe2_pb2
 from caffe2.python import core, workspace
+from caffe2.python.transformations import optimizeForIDEEP
 import caffe2.python.hypothesis_test_util as hu
 import caffe2.python.ideep_test_util as mu
 
@@ -222,6 +224,56 @@ class FcTest(hu.HypothesisTestCase):
             print(np.max(np.abs(db1 - db0)))
             self.assertTrue(False)
 
+    @given(n=st.integers(1, 5), m=st.integers(1, 5),
+           k=st.integers(1, 5), **mu.gcs)
+    def test_fc_relu_fusion(self, n, m, k, gc, dc):
+        X = np.random.rand(m, k).astype(np.float32) - 0.5
+        W = np.random.rand(n, k).astype(np.float32) - 0.5
+        b = np.random.rand(n).astype(np.float32) - 0.5
+
+        fc = core.CreateOperator(
+            'FC',
+            ['X', 'W', 'b'],
+            ["Y0"],
+            device_option=dc[1]
+        )
+        relu = core.CreateOperator(
+            'Relu',
+            ['Y0'],
+            ['Y'],
+            device_option=dc[1]
+        )
+
+        old_ws_name = workspace.CurrentWorkspace()
+        workspace.SwitchWorkspace("_device_check_", True)
+        workspace.FeedBlob('X', X, dc[1])
+        workspace.FeedBlob('W', W, dc[1])
+        workspace.FeedBlob('b', b, dc[1])
+        workspace.RunOperatorOnce(fc)
+        workspace.RunOperatorOnce(relu)
+        Y0 = workspace.FetchBlob('Y')
+
+        workspace.ResetWorkspace()
+        workspace.FeedBlob('X', X, dc[1])
+        workspace.FeedBlob('W', W, dc[1])
+        workspace.FeedBlob('b', b, dc[1])
+        old_net = caffe2_pb2.NetDef()
+        old_net.op.extend([fc, relu])
+        net = core.Net("net")
+        net.Proto().CopyFrom(old_net)
+        optimizeForIDEEP(net)
+        self.assertTrue(len(net.Proto().op) == 1)
+        self.assertTrue(net.Proto().op[0].type == "FCFusion")
+        workspace.RunOperatorOnce(net.Proto().op[0])
+        Y1 = workspace.FetchBlob('Y')
+        if not np.allclose(Y0, Y1, atol=0.01, rtol=0.01):
+            print(Y1.flatten())
+            print(Y0.flatten())
+            print(np.max(np.abs(Y1 - Y0)))
+            self.assertTrue(False)
+
+        workspace.SwitchWorkspace(old_ws_name)
+
 
 if __name__ == "__main__":
     unittest.main()
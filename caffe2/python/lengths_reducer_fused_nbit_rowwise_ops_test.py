@@ -0,0 +1,183 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+from caffe2.python import core, workspace
+import caffe2.python.hypothesis_test_util as hu
+
+import numpy as np
+from hypothesis import given
+import hypothesis.strategies as st
+
+
+def fused_rowwise_nbit_quantize_dequantize_reference(data, bit_rate):
+    data = data.astype(np.float32)
+    # The bias and the scale are stored as float16
+    bias = np.min(data, axis=1).astype(np.float16).astype(np.float32)
+    span = np.max(data, axis=1) - bias
+    scale = (span / (2**bit_rate - 1)).astype(np.float16).astype(np.float32)
+    with np.errstate(divide='ignore'):
+        inverse_scale = np.float32(1) / scale
+    invalid = np.logical_or(scale == 0, np.isinf(inverse_scale))
+    scale[invalid] = 1
+    inverse_scale[invalid] = 1
+    quantized_data = np.clip(
+        np.round((data - bias[:, None]) * inverse_scale[:, None]),
+        0,
+        2**bit_rate - 1,
+    )
+    return quantized_data * scale[:, None] + bias[:, None]
+
+
+class TestLengthsReducerOpsFusedNBitRowwise(hu.HypothesisTestCase):
+    @given(
+        input_data=hu.tensor(min_dim=2, max_dim=2),
+        bit_rate=st.sampled_from([2, 4]),
+    )
+    def test_quantize_and_dequantize_op(self, input_data, bit_rate):
+        input_data = input_data.astype(np.float32)
+        quantize = core.CreateOperator(
+            'FloatToFused{}BitRowwiseQuantized'.format(bit_rate),
+            ['input_data'],
+            ['quantized_data'],
+        )
+        dequantize = core.CreateOperator(
+            'Fused{}BitRowwiseQuantizedToFloat'.format(bit_rate),
+            ['quantized_data'],
+            ['dequantized_data'],
+        )
+        workspace.FeedBlob('input_data', input_data)
+        workspace.RunOperatorOnce(quantize)
+        workspace.RunOperatorOnce(dequantize)
+
+        quantized_data = workspace.FetchBlob('quantized_data')
+        num_elem_per_byte = 8 // bit_rate
+        self.assertEqual(
+            quantized_data.shape[1],
+            (input_data.shape[1] + num_elem_per_byte - 1) // num_elem_per_byte
+            + 4,
+        )
+
+        # The number of columns is rounded up to the number of values per byte
+        dequantized_data = workspace.FetchBlob('dequantized_data')
+        self.assertEqual(dequantized_data.shape[1] % num_elem_per_byte, 0)
+        reference = fused_rowwise_nbit_quantize_dequantize_reference(
+            input_data, bit_rate
+        )
+        np.testing.assert_array_almost_equal(
+            dequantized_data[:, :input_data.shape[1]], reference
+        )
+
+    @given(
+        input_data=hu.tensor(min_dim=2, max_dim=2),
+        bit_rate=st.sampled_from([2, 4]),
+        weighted=st.booleans(),
+        seed=st.integers(0, 2**32 - 1),
+    )
+    def test_sparse_lengths_sum(self, input_data, bit_rate, weighted, seed):
+        net = core.Net("bench")
+
+        np.random.seed(seed)
+
+        input_data = input_data.astype(np.float32)
+        indices = np.random.randint(
+            low=0,
+            high=len(input_data),
+            size=[np.random.randint(len(input_data))],
+            dtype=np.int32
+        )
+        weights = np.random.uniform(size=[len(indices)]).astype(np.float32)
+        lengths_split = np.clip(1, len(indices) // 2, 10)
+        lengths = np.ones(
+            [len(indices) // lengths_split], dtype=np.int32
+        ) * lengths_split
+
+        quantized_data = net.__getattr__(
+            'FloatToFused{}BitRowwiseQuantized'.format(bit_rate)
+        )('input_data', 'quantized_data')
+        dequantized_data = net.__getattr__(
+            'Fused{}BitRowwiseQuantizedToFloat'.format(bit_rate)
+        )(quantized_data, 'dequantized_data')
+
+        if weighted:
+            net.SparseLengthsWeightedSum(
+                [dequantized_data, 'weights', 'indices', 'lengths'],
+                'sum_reference',
+            )
+            net.__getattr__(
+                'SparseLengthsWeightedSumFused{}BitRowwise'.format(bit_rate)
+            )(
+                [quantized_data, 'weights', 'indices', 'lengths'],
+                'sum_quantized'
+            )
+        else:
+            net.SparseLengthsSum(
+                [dequantized_data, 'indices', 'lengths'],
+                'sum_reference',
+            )
+            net.__getattr__(
+                'SparseLengthsSumFused{}BitRowwise'.format(bit_rate)
+            )([quantized_data, 'indices', 'lengths'], 'sum_quantized')
+
+        workspace.FeedBlob('input_data', input_data)
+        workspace.FeedBlob('weights', weights)
+        workspace.FeedBlob('indices', indices)
+        workspace.FeedBlob('lengths', lengths)
+
+        workspace.GlobalInit(['caffe2', '--caffe2_log_level=0'])
+        workspace.CreateNet(net)
+        workspace.RunNetOnce(net)
+
+        sum_reference = workspace.FetchBlob('sum_reference')
+        sum_quantized = workspace.FetchBlob('sum_quantized')
+        np.testing.assert_array_almost_equal(sum_reference, sum_quantized)
+
+    @given(
+        input_data=hu.tensor(min_dim=2, max_dim=2),
+        bit_rate=st.sampled_from([2, 4]),
+        seed=st.integers(0, 2**32 - 1),
+    )
+    def test_sparse_lengths_mean(self, input_data, bit_rate, seed):
+        net = core.Net("bench")
+
+        np.random.seed(seed)
+
+        input_data = input_data.astype(np.float32)
+        indices = np.random.randint(
+            low=0,
+            high=len(input_data),
+            size=[np.random.randint(len(input_data))],
+            dtype=np.int64
+        )
+        lengths_split = np.clip(1, len(indices) // 2, 10)
+        lengths = np.ones(
+            [len(indices) // lengths_split], dtype=np.int32
+        ) * lengths_split
+
+        quantized_data = net.__getattr__(
+            'FloatToFused{}BitRowwiseQuantized'.format(bit_rate)
+        )('input_data', 'quantized_data')
+        dequantized_data = net.__getattr__(
+            'Fused{}BitRowwiseQuantizedToFloat'.format(bit_rate)
+        )(quantized_data, 'dequantized_data')
+
+        net.SparseLengthsMean(
+            [dequantized_data, 'indices', 'lengths'],
+            'mean_reference',
+        )
+        net.__getattr__(
+            'SparseLengthsMeanFused{}BitRowwise'.format(bit_rate)
+        )([quantized_data, 'indices', 'lengths'], 'mean_quantized')
+
+        workspace.FeedBlob('input_data', input_data)
+        workspace.FeedBlob('indices', indices)
+        workspace.FeedBlob('lengths', lengths)
+
+        workspace.GlobalInit(['caffe2', '--caffe2_log_level=0'])
+        workspace.CreateNet(net)
+        workspace.RunNetOnce(net)
+
+        mean_reference = workspace.FetchBlob('mean_reference')
+        mean_quantized = workspace.FetchBlob('mean_quantized')
+        np.testing.assert_array_almost_equal(mean_reference, mean_quantized)
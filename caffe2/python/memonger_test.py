@@ -152,6 +152,40 @@ class MemongerTest(hu.HypothesisTestCase):
         for op in optimized_net.op:
             self.assertEqual(len(op.output), len(set(op.output)), str(op))
 
+    def test_fast_memonger_dag(self):
+        m = model_helper.ModelHelper()
+        m.net.Proto().type = "async_scheduling"
+        m.net.Proto().num_workers = 4
+        branches = []
+        for name in ["a", "b"]:
+            x = "data"
+            for i in range(4):
+                x = m.net.Relu(x, "{}{}".format(name, i))
+            branches.append(x)
+        m.net.Sum(branches, "out")
+
+        optimized_net = memonger.optimize_inference_fast(
+            m.Proto(), ["data", "out"])
+        # Each branch reuses its own blobs, but never those of the other
+        # branch, which may run at the same time
+        self.assertLess(count_blobs(optimized_net), count_blobs(m.Proto()))
+        a_blobs = set(optimized_net.op[i].output[0] for i in range(4))
+        b_blobs = set(optimized_net.op[i].output[0] for i in range(4, 8))
+        self.assertEqual(len(a_blobs & b_blobs), 0)
+
+        data = np.random.randn(3, 5).astype(np.float32)
+        workspace.FeedBlob("data", data)
+        workspace.RunNetOnce(m.net)
+        out = workspace.FetchBlob("out")
+        workspace.RunNetOnce(optimized_net)
+        np.testing.assert_almost_equal(out, workspace.FetchBlob("out"))
+
+        # The net is memongered already
+        self.assertEqual(
+            memonger.optimize_inference_fast(
+                optimized_net, ["data", "out"]),
+            optimized_net)
+
     @given(input_dim=st.integers(min_value=1, max_value=4),
            output_dim=st.integers(min_value=1, max_value=4),
            batch_size=st.integers(min_value=1, max_value=4))
@@ -263,3 +263,45 @@ class TestAdagrad(serial.SerializedTestCase):
             gc, op,
             [param, momentum, indices, grad, lr],
             ref_row_wise_sparse)
+
+    @given(num_rows=st.integers(1, 2000),
+           block_size=st.sampled_from([1, 8, 17]),
+           num_indices=st.integers(0, 2000),
+           consistency=st.sampled_from(
+               ["hogwild", "row_lock", "owner_computes"]),
+           **hu.gcs_cpu_only)
+    def test_sparse_adagrad_thread_pool(self, num_rows, block_size,
+                                        num_indices, consistency, gc, dc):
+        param = np.random.rand(num_rows, block_size).astype(np.float32)
+        momentum = np.random.rand(num_rows, block_size).astype(np.float32)
+        lr = np.array([0.1], dtype=np.float32)
+        if consistency == "owner_computes":
+            # The updates of a row are applied in the order of the indices
+            indices = np.random.randint(0, num_rows, size=num_indices)
+        else:
+            indices = np.random.permutation(num_rows)
+        grad = np.random.rand(len(indices), block_size).astype(np.float32)
+
+        def ref_sparse(param, momentum, indices, grad, lr):
+            param_out = np.copy(param)
+            momentum_out = np.copy(momentum)
+            for i, index in enumerate(indices):
+                param_out[index], momentum_out[index] = ref_adagrad(
+                    param_out[index],
+                    momentum_out[index],
+                    grad[i],
+                    lr,
+                    0.01,
+                )
+            return (param_out, momentum_out)
+
+        op = core.CreateOperator(
+            "SparseAdagrad",
+            ["param", "momentum", "indices", "grad", "lr"],
+            ["param", "momentum"],
+            epsilon=0.01,
+            use_thread_pool=True,
+            consistency=consistency,
+            device_option=gc)
+        self.assertReferenceChecks(
+            gc, op, [param, momentum, indices, grad, lr], ref_sparse)
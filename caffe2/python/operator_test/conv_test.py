@@ -643,6 +643,51 @@ class TestConvolution(serial.SerializedTestCase):
                 1763719461732352.0,
                 rtol=1e-5)
 
+    @given(batch_size=st.integers(1, 8),
+           num_workers=st.integers(1, 4),
+           order=st.sampled_from(["NCHW", "NHWC"]),
+           shared_buffer=st.booleans())
+    def test_convolution_parallel_col_buffers(
+            self, batch_size, num_workers, order, shared_buffer):
+        # Independent convs of a dag net run at the same time, each over the
+        # images of its batch in parallel, with col buffers from the pool.
+        num_convs = 4
+        C, M, H, W = 3, 2, 6, 5
+        np.random.seed(1701)
+        if order == "NCHW":
+            X = np.random.randn(batch_size, C, H, W).astype(np.float32)
+            w = np.random.randn(M, C, 3, 3).astype(np.float32)
+        else:
+            X = np.random.randn(batch_size, H, W, C).astype(np.float32)
+            w = np.random.randn(M, 3, 3, C).astype(np.float32)
+        b = np.random.randn(M).astype(np.float32)
+
+        def make_op(i, shared_buffer):
+            return core.CreateOperator(
+                "Conv", ["X", "w", "b"], ["Y_{}".format(i)],
+                kernel=3, stride=i % 2 + 1, pad=i // 2, order=order,
+                shared_buffer=int(shared_buffer))
+
+        self.ws.create_blob("X").feed(X)
+        self.ws.create_blob("w").feed(w)
+        self.ws.create_blob("b").feed(b)
+        expected = []
+        for i in range(num_convs):
+            self.ws.run(make_op(i, shared_buffer=False))
+            expected.append(self.ws.blobs["Y_{}".format(i)].fetch())
+
+        net = core.Net("parallel_convs")
+        net.Proto().type = "dag"
+        net.Proto().num_workers = num_workers
+        net.Proto().op.extend(
+            [make_op(i, shared_buffer) for i in range(num_convs)])
+        for _ in range(3):
+            self.ws.run(net)
+            for i in range(num_convs):
+                np.testing.assert_allclose(
+                    self.ws.blobs["Y_{}".format(i)].fetch(), expected[i],
+                    atol=1e-4, rtol=1e-4)
+
     def test_use_cudnn_engine_interactions(self):
         """Make sure the use_cudnn and engine kwargs work as expected."""
         for model_default in [None, True, False]:
@@ -237,7 +237,8 @@ def create_test(output_dir, width, height, default_bound, minsize, crop, means,
 
 def run_test(
         size_tuple, means, stds, label_type, num_labels, is_test, scale_jitter_type,
-        color_jitter, color_lighting, dc, validator, output1=None, output2_size=None):
+        color_jitter, color_lighting, dc, validator, output1=None, output2_size=None,
+        gpu_resize=False):
     # TODO: Does not test on GPU and does not test use_gpu_transform
     # WARNING: Using ModelHelper automatically does NHWC to NCHW
     # transformation if needed.
@@ -295,6 +296,7 @@ def run_test(
                 mean_per_channel=means,
                 std_per_channel=stds,
                 use_gpu_transform=(device_option.device_type == 1),
+                use_gpu_resize=gpu_resize,
                 label_type=label_type,
                 num_labels=num_labels,
                 output_sizes=output_sizes,
@@ -427,6 +429,38 @@ class TestImport(hu.HypothesisTestCase):
             validator, output1, output2_size)
     # End test_imageinput
 
+    @unittest.skipIf(not workspace.has_gpu_support, 'No GPU support')
+    @given(size_tuple=st.tuples(
+        st.integers(min_value=8, max_value=4096),
+        st.integers(min_value=8, max_value=4096)).flatmap(lambda t: st.tuples(
+            st.just(t[0]), st.just(t[1]),
+            st.just(min(t[0] - 6, t[1] - 4)),
+            st.integers(min_value=1, max_value=min(t[0] - 6, t[1] - 4)))),
+        means=st.tuples(st.integers(min_value=0, max_value=255),
+                        st.integers(min_value=0, max_value=255),
+                        st.integers(min_value=0, max_value=255)),
+        stds=st.tuples(st.floats(min_value=1, max_value=10),
+                       st.floats(min_value=1, max_value=10),
+                       st.floats(min_value=1, max_value=10)),
+        label_type=st.integers(0, 3),
+        num_labels=st.integers(min_value=8, max_value=4096),
+        is_test=st.integers(min_value=0, max_value=1),
+        scale_jitter_type=st.integers(min_value=0, max_value=1),
+        **hu.gcs_gpu_only)
+    @settings(verbosity=Verbosity.verbose)
+    def test_imageinput_gpu_resize(
+            self, size_tuple, means, stds, label_type,
+            num_labels, is_test, scale_jitter_type, gc, dc):
+        def validator(expected_images, device_option, count_images):
+            self.validate_image_and_label(
+                expected_images, device_option, count_images, label_type,
+                is_test, scale_jitter_type, 0, 0)
+        # End validator
+        run_test(
+            size_tuple, means, stds, label_type, num_labels, is_test,
+            scale_jitter_type, 0, 0, dc, validator, gpu_resize=True)
+    # End test_imageinput_gpu_resize
+
 
 if __name__ == '__main__':
     import unittest
@@ -4,7 +4,7 @@ from __future__ import print_function
 from __future__ import unicode_literals
 
 from caffe2.proto import caffe2_pb2
-from caffe2.python import model_helper, workspace, core, rnn_cell
+from caffe2.python import model_helper, workspace, core, rnn_cell, utils
 from caffe2.python.attention import AttentionType
 
 import numpy as np
@@ -217,6 +217,63 @@ class TestRNNExecutor(unittest.TestCase):
             model, _ = self.init_lstm_model(T, num_layers, forward_only)
             self._compare(model, forward_only)
 
+    @given(
+        num_layers=st.integers(1, 4),
+        T=st.integers(1, 40),
+        recompute_interval=st.integers(1, 8),
+        enable_executor=st.booleans(),
+        **hu.gcs)
+    def test_lstm_recompute_equal(
+            self, num_layers, T, recompute_interval, enable_executor, gc, dc):
+        '''
+        Test that recomputing the forward activations of each segment of
+        timesteps on the backward pass gives the same gradients as storing
+        the activations of all the timesteps.
+        '''
+        workspace.ResetWorkspace()
+        with core.DeviceScope(gc):
+            model, _ = self.init_lstm_model(T, num_layers, forward_only=False)
+            self.enable_rnn_executor(model.net, int(enable_executor), False)
+            workspace.RunNetOnce(model.param_init_net)
+            init_ws = {k: workspace.FetchBlob(k) for k in workspace.Blobs()}
+
+            grads = []
+            for interval in [0, recompute_interval]:
+                self.set_recompute_interval(model.net, interval)
+                workspace.ResetWorkspace()
+                for k, v in init_ws.items():
+                    workspace.FeedBlob(k, v)
+
+                np.random.seed(10022015)
+                input_shape = [T, self.batch_size, self.input_dim]
+                workspace.FeedBlob(
+                    "input", np.random.rand(*input_shape).astype(np.float32))
+                workspace.FeedBlob(
+                    "target",
+                    np.random.rand(
+                        T, self.batch_size, self.hidden_dim
+                    ).astype(np.float32))
+                workspace.RunNetOnce(model.net)
+                grads.append({
+                    k: workspace.FetchBlob(k)
+                    for k in workspace.Blobs() if k.endswith("_grad")
+                })
+
+        self.assertEqual(sorted(grads[0].keys()), sorted(grads[1].keys()))
+        for k in grads[0].keys():
+            np.testing.assert_allclose(
+                grads[0][k], grads[1][k], rtol=1e-4, atol=1e-6, err_msg=k)
+
+    def set_recompute_interval(self, net, value):
+        for op in net.Proto().op:
+            if op.type.startswith("RecurrentNetwork"):
+                args = [a for a in op.arg if a.name == 'recompute_interval']
+                if args:
+                    args[0].i = value
+                else:
+                    op.arg.extend([utils.MakeArgument(
+                        'recompute_interval', value)])
+
     def _compare(self, model, forward_only):
         # Store list of blobs that exist in the beginning
         workspace.RunNetOnce(model.param_init_net)
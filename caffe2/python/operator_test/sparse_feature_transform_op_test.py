@@ -0,0 +1,182 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+from caffe2.python import core
+from hypothesis import given
+import caffe2.python.hypothesis_test_util as hu
+import hypothesis.strategies as st
+import numpy as np
+
+
+_MASK64 = (1 << 64) - 1
+
+
+def _fmix64(k):
+    k ^= k >> 33
+    k = (k * 0xff51afd7ed558ccd) & _MASK64
+    k ^= k >> 33
+    k = (k * 0xc4ceb9fe1a85ec53) & _MASK64
+    k ^= k >> 33
+    return k
+
+
+def _murmur3_x64_128_low(key, seed):
+    # The first half of MurmurHash3_x64_128, for keys of less than 16 bytes
+    assert len(key) < 16
+    k1 = 0
+    for i, b in enumerate(bytearray(key[:8])):
+        k1 |= b << (8 * i)
+    k2 = 0
+    for i, b in enumerate(bytearray(key[8:])):
+        k2 |= b << (8 * i)
+    h1 = h2 = seed
+    if len(key) > 8:
+        k2 = (k2 * 0x4cf5ad432745937f) & _MASK64
+        k2 = ((k2 << 33) | (k2 >> 31)) & _MASK64
+        k2 = (k2 * 0x87c37b91114253d5) & _MASK64
+        h2 ^= k2
+    if len(key) > 0:
+        k1 = (k1 * 0x87c37b91114253d5) & _MASK64
+        k1 = ((k1 << 31) | (k1 >> 33)) & _MASK64
+        k1 = (k1 * 0x4cf5ad432745937f) & _MASK64
+        h1 ^= k1
+    h1 ^= len(key)
+    h2 ^= len(key)
+    h1 = (h1 + h2) & _MASK64
+    h2 = (h2 + h1) & _MASK64
+    h1 = _fmix64(h1)
+    h2 = _fmix64(h2)
+    return (h1 + h2) & _MASK64
+
+
+def sparse_feature_transform_ref(lengths, values, transforms, seed=0,
+                                 modulo=None, boundaries=None, clip_min=None,
+                                 clip_max=None):
+    dtype = values.dtype
+    max_value = np.iinfo(dtype).max
+    out_lengths = []
+    out_values = []
+    offset = 0
+    for length in lengths:
+        segment = [int(v) for v in values[offset:offset + length]]
+        offset += length
+        for transform in transforms:
+            if transform == "hash":
+                segment = [
+                    _murmur3_x64_128_low(
+                        np.array([v], dtype=dtype).tobytes(), seed) & max_value
+                    for v in segment]
+            elif transform == "modulo":
+                segment = [v % modulo for v in segment]
+            elif transform == "bucketize":
+                segment = [
+                    int(np.searchsorted(boundaries, v, side="left"))
+                    for v in segment]
+            elif transform == "clip":
+                segment = [min(max(v, clip_min), clip_max) for v in segment]
+            elif transform == "dedup":
+                seen = set()
+                deduped = []
+                for v in segment:
+                    if v not in seen:
+                        seen.add(v)
+                        deduped.append(v)
+                segment = deduped
+        out_lengths.append(len(segment))
+        out_values.extend(segment)
+    return [np.array(out_lengths, dtype=np.int32),
+            np.array(out_values, dtype=dtype)]
+
+
+def _lengths_and_values(max_length, max_segments, dtype, max_value):
+    return st.lists(
+        st.integers(min_value=0, max_value=max_length),
+        min_size=0, max_size=max_segments,
+    ).flatmap(
+        lambda lengths: st.tuples(
+            st.just(np.array(lengths, dtype=np.int32)),
+            hu.arrays([sum(lengths)], dtype=dtype,
+                      elements=st.integers(min_value=-max_value,
+                                           max_value=max_value)),
+        )
+    )
+
+
+class TestSparseFeatureTransformOp(hu.HypothesisTestCase):
+    @given(
+        dtype=st.sampled_from([np.int32, np.int64]),
+        data=st.data(),
+        transforms=st.lists(
+            st.sampled_from(["hash", "modulo", "bucketize", "clip", "dedup"]),
+            min_size=1, max_size=5),
+        seed=st.integers(min_value=0, max_value=10),
+        modulo=st.integers(min_value=1, max_value=50),
+        **hu.gcs_cpu_only
+    )
+    def test_sparse_feature_transform(self, dtype, data, transforms, seed,
+                                      modulo, gc, dc):
+        lengths, values = data.draw(_lengths_and_values(30, 10, dtype, 100))
+        boundaries = [-20, 0, 5, 25, 40]
+        kwargs = dict(seed=seed, modulo=modulo, boundaries=boundaries,
+                      clip_min=-10, clip_max=30)
+        op = core.CreateOperator(
+            "SparseFeatureTransform",
+            ["lengths", "values"],
+            ["out_lengths", "out_values"],
+            transforms=transforms,
+            **kwargs
+        )
+
+        def ref(lengths, values):
+            return sparse_feature_transform_ref(
+                lengths, values, transforms, **kwargs)
+
+        self.assertReferenceChecks(gc, op, [lengths, values], ref)
+
+    @given(
+        dtype=st.sampled_from([np.int32, np.int64]),
+        num_segments=st.integers(min_value=1, max_value=200),
+        **hu.gcs_cpu_only
+    )
+    def test_sparse_feature_transform_thread_pool(self, dtype, num_segments,
+                                                  gc, dc):
+        # Long enough segments for the work to be split across threads, with
+        # a few empty ones
+        lengths = np.random.randint(
+            0, 500, size=num_segments).astype(np.int32)
+        values = np.random.randint(
+            0, 1000, size=sum(lengths)).astype(dtype)
+        transforms = ["hash", "modulo", "dedup"]
+        self.ws.create_blob("lengths").feed(lengths)
+        self.ws.create_blob("values").feed(values)
+        for suffix, use_thread_pool in [("", False), ("_parallel", True)]:
+            self.ws.run(core.CreateOperator(
+                "SparseFeatureTransform",
+                ["lengths", "values"],
+                ["out_lengths" + suffix, "out_values" + suffix],
+                transforms=transforms,
+                seed=3,
+                modulo=100,
+                use_thread_pool=use_thread_pool))
+        expected = sparse_feature_transform_ref(
+            lengths, values, transforms, seed=3, modulo=100)
+        for name, value in zip(["out_lengths", "out_values"], expected):
+            np.testing.assert_array_equal(
+                self.ws.blobs[name].fetch(), value)
+            np.testing.assert_array_equal(
+                self.ws.blobs[name + "_parallel"].fetch(), value)
+
+    def test_sparse_feature_transform_unknown_transform(self):
+        with self.assertRaises(RuntimeError):
+            self.ws.run(core.CreateOperator(
+                "SparseFeatureTransform",
+                ["lengths", "values"],
+                ["out_lengths", "out_values"],
+                transforms=["sort"]))
+
+
+if __name__ == "__main__":
+    import unittest
+    unittest.main()
@@ -23,7 +23,8 @@ def benchmark_sparse_lengths_sum(
         embedding_size,
         average_len,
         batch_size,
-        iterations):
+        iterations,
+        dedup_indices=False):
     print('Preparing lookup table. ' + str(datetime.datetime.now()))
 
     # We will use a constant, but non-trivial value so we save initialization
@@ -60,7 +61,8 @@ def benchmark_sparse_lengths_sum(
     elif dtype_str == "uint8_fused":
         net.SparseLengthsSumFused8BitRowwise(["X", "indices", "lengths"], "Y")
     else:
-        net.SparseLengthsSum(["X", "indices", "lengths"], "Y")
+        net.SparseLengthsSum(
+            ["X", "indices", "lengths"], "Y", dedup_indices=dedup_indices)
     workspace.CreateNet(net)
 
     # Set random seed, so that repeated runs will keep the same sequence of
@@ -93,7 +95,19 @@ if __name__ == "__main__":
     parser.add_argument(
         '-i', "--iteration", type=int, default=100000,
         help="The number of iterations.")
+    parser.add_argument(
+        "--prefetch-distance", type=int, default=None,
+        help="The number of indices ahead whose rows are prefetched, "
+        "default is the one of the kernels.")
+    parser.add_argument(
+        "--dedup-indices", action="store_true",
+        help="Merge the duplicate indices of each segment before the lookup "
+        "(float and float16 only).")
     args, extra_args = parser.parse_known_args()
+    if args.prefetch_distance is not None:
+        extra_args.append(
+            '--caffe2_embedding_lookup_prefetch_distance={}'.format(
+                args.prefetch_distance))
     core.GlobalInit(['python'] + extra_args)
     benchmark_sparse_lengths_sum(
         args.dtype,
@@ -101,4 +115,5 @@ if __name__ == "__main__":
         args.embedding_dim,
         args.average_len,
         args.batch_size,
-        args.iteration)
+        args.iteration,
+        args.dedup_indices)
@@ -17,9 +17,11 @@ class TestSpecializedSegmentOps(hu.HypothesisTestCase):
            fptype=st.sampled_from([np.float16, np.float32]),
            fp16asint=st.booleans(),
            blocksize=st.sampled_from([8, 17, 32, 64, 85, 96, 128, 163]),
-           normalize_by_lengths=st.booleans(), **hu.gcs)
+           normalize_by_lengths=st.booleans(),
+           dedup_indices=st.booleans(), **hu.gcs)
     def test_sparse_lengths_sum_cpu(
-            self, batchsize, fptype, fp16asint, blocksize, normalize_by_lengths, gc, dc):
+            self, batchsize, fptype, fp16asint, blocksize, normalize_by_lengths,
+            dedup_indices, gc, dc):
 
         if normalize_by_lengths == False:
             print("<test_sparse_lengths_sum_cpu>")
@@ -47,10 +49,12 @@ class TestSpecializedSegmentOps(hu.HypothesisTestCase):
 
         if normalize_by_lengths == False:
             op = core.CreateOperator("SparseLengthsSum", [
-                                     "Tbl", "Indices", "Lengths"], "out")
+                                     "Tbl", "Indices", "Lengths"], "out",
+                                     dedup_indices=dedup_indices)
         else:
             op = core.CreateOperator("SparseLengthsMean", [
-                                     "Tbl", "Indices", "Lengths"], "out")
+                                     "Tbl", "Indices", "Lengths"], "out",
+                                     dedup_indices=dedup_indices)
 
         self.ws.create_blob("Tbl").feed(Tbl)
         self.ws.create_blob("Indices").feed(Indices)
@@ -77,9 +81,10 @@ class TestSpecializedSegmentOps(hu.HypothesisTestCase):
            fptype=st.sampled_from([np.float16, np.float32]),
            fp16asint=st.booleans(),
            blocksize=st.sampled_from([8, 17, 32, 64, 85, 96, 128, 163]),
-           **hu.gcs)
+           dedup_indices=st.booleans(), **hu.gcs)
     def test_sparse_lengths_weightedsum_cpu(
-            self, batchsize, fptype, fp16asint, blocksize, gc, dc):
+            self, batchsize, fptype, fp16asint, blocksize, dedup_indices, gc,
+            dc):
 
         print("<test_sparse_lengths_weightedsum_cpu>")
 
@@ -104,7 +109,8 @@ class TestSpecializedSegmentOps(hu.HypothesisTestCase):
         Weights = np.random.rand(sum(Lengths)).astype(np.float32)
 
         op = core.CreateOperator("SparseLengthsWeightedSum", [
-                                 "Tbl", "Weights", "Indices", "Lengths"], "out")
+                                 "Tbl", "Weights", "Indices", "Lengths"], "out",
+                                 dedup_indices=dedup_indices)
 
         self.ws.create_blob("Tbl").feed(Tbl)
         self.ws.create_blob("Indices").feed(Indices)
@@ -265,6 +271,41 @@ class TestSpecializedSegmentOps(hu.HypothesisTestCase):
         with self.assertRaises(RuntimeError):
             self.ws.run(op)
 
+    @given(batchsize=st.integers(1, 200),
+           blocksize=st.sampled_from([8, 17, 32, 64, 128]),
+           op_name=st.sampled_from(["SparseLengthsSum", "SparseLengthsMean",
+                                    "SparseLengthsWeightedSum",
+                                    "SparseLengthsPositionalWeightedSum"]),
+           **hu.gcs_cpu_only)
+    def test_sparse_lengths_thread_pool(
+            self, batchsize, blocksize, op_name, gc, dc):
+        tblsize = 300
+        Tbl = np.random.rand(tblsize, blocksize).astype(np.float32)
+        # Long enough segments for the work to be split across threads, with a
+        # few empty ones
+        Lengths = np.random.randint(0, 100, size=batchsize).astype(np.int32)
+        Indices = np.random.randint(
+            0, tblsize, size=sum(Lengths)).astype(np.int64)
+        if op_name == "SparseLengthsPositionalWeightedSum":
+            Weights = np.random.rand(max(Lengths)).astype(np.float32)
+        else:
+            Weights = np.random.rand(sum(Lengths)).astype(np.float32)
+        if "Weighted" in op_name:
+            inputs = ["Tbl", "Weights", "Indices", "Lengths"]
+        else:
+            inputs = ["Tbl", "Indices", "Lengths"]
+
+        self.ws.create_blob("Tbl").feed(Tbl)
+        self.ws.create_blob("Weights").feed(Weights)
+        self.ws.create_blob("Indices").feed(Indices)
+        self.ws.create_blob("Lengths").feed(Lengths)
+        self.ws.run(core.CreateOperator(op_name, inputs, "out"))
+        self.ws.run(core.CreateOperator(
+            op_name, inputs, "out_parallel", use_thread_pool=True))
+
+        np.testing.assert_allclose(self.ws.blobs[("out_parallel")].fetch(),
+                                   self.ws.blobs[("out")].fetch())
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -192,6 +192,32 @@ class TestTopK(serial.SerializedTestCase):
         self.assertReferenceChecks(gc, op, [X], bind_ref)
         self.assertDeviceChecks(dc, op, [X], [0])
 
+    @given(bs=st.integers(1, 4), n=st.integers(1000, 100000),
+           k=st.integers(1, 200), num_distinct=st.integers(1, 1000),
+           increasing=st.booleans(), **hu.gcs_cpu_only)
+    def test_top_k_large_rows(self, bs, n, k, num_distinct, increasing, gc,
+                              dc):
+        # Few distinct values make ties, which the smaller index wins, and
+        # increasing rows raise the threshold of the selection all the time.
+        X = np.random.randint(
+            num_distinct, size=(bs, n)).astype(dtype=np.float32)
+        if increasing:
+            X = np.sort(X, axis=1)
+        op = core.CreateOperator("TopK", ["X"], ["Values", "Indices"],
+                                 k=k, device_option=gc)
+
+        def top_k_ref(X):
+            m = min(k, n)
+            values = np.zeros((bs, k), dtype=np.float32)
+            indices = np.full((bs, k), -1, dtype=np.int64)
+            for i in range(bs):
+                order = np.lexsort((np.arange(n), -X[i]))[:m]
+                values[i, :m] = X[i, order]
+                indices[i, :m] = order
+            return (values, indices)
+
+        self.assertReferenceChecks(gc, op, [X], top_k_ref)
+
     @given(X=hu.tensor(dtype=np.float32), k=st.integers(1, 5),
            axis=st.integers(-1, 5), flatten_indices=st.booleans(),
            **hu.gcs)
@@ -14,6 +14,7 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/stats.h"
 #include "caffe2/core/transform.h"
+#include "caffe2/observers/latency_observer.h"
 #include "caffe2/observers/runcnt_observer.h"
 #include "caffe2/observers/time_observer.h"
 #include "caffe2/onnx/backend.h"
@@ -135,6 +136,46 @@ const TypeMeta& NumpyTypeToCaffe(int numpy_type) {
 #endif // USE_NUMPY
 }
 
+namespace {
+
+void decrefNumpyArray(void* array) {
+  // The interpreter may be gone when the workspaces are destroyed at exit
+  if (!Py_IsInitialized()) {
+    return;
+  }
+  // The storage holding the array may be freed on any thread
+  py::gil_scoped_acquire g;
+  Py_DECREF(static_cast<PyObject*>(array));
+}
+
+} // namespace
+
+bool ShareNumpyArray(PyArrayObject* array, Tensor* tensor) {
+#ifdef USE_NUMPY
+  if (tensor->GetDeviceType() != CPU || !PyArray_ISCARRAY(array) ||
+      !PyArray_ISNOTSWAPPED(array)) {
+    return false;
+  }
+  const TypeMeta& meta = NumpyTypeToCaffe(PyArray_TYPE(array));
+  if (meta.id() == TypeIdentifier::uninitialized() || meta.placementNew()) {
+    return false;
+  }
+  const int ndim = PyArray_NDIM(array);
+  const npy_intp* npy_dims = PyArray_DIMS(array);
+  std::vector<int64_t> dims(npy_dims, npy_dims + ndim);
+  tensor->Resize(dims);
+  Py_INCREF(array);
+  tensor->ShareExternalPointer(
+      at::DataPtr(
+          PyArray_DATA(array), array, &decrefNumpyArray, at::Device(CPU)),
+      meta,
+      PyArray_NBYTES(array));
+  return true;
+#else
+  CAFFE_THROW("Caffe2 compiled without NumPy support.");
+#endif // USE_NUMPY
+}
+
 template <typename Registry>
 std::function<const char*(const string&)> DefinitionGetter(
     const Registry* registry) {
@@ -341,7 +382,8 @@ void addObjectMethods(py::module& m) {
           "_feed",
           [](Blob* blob,
              const py::object& arg,
-             const py::object device_option) {
+             const py::object device_option,
+             bool zero_copy) {
             DeviceOption option;
             if (!device_option.is(py::none())) {
               // If we have a device option passed in, read it.
@@ -355,7 +397,7 @@ void addObjectMethods(py::module& m) {
               auto feeder = CreateFeeder(option.device_type());
               CAFFE_ENFORCE(
                   feeder, "Unknown device type encountered in FeedBlob.");
-              feeder->Feed(option, array, blob);
+              feeder->Feed(option, array, blob, zero_copy);
               return true;
             }
 #else
@@ -901,8 +943,9 @@ void addObjectMethods(py::module& m) {
                   "Input must be of type numpy array.");
               PyArrayObject* array =
                   reinterpret_cast<PyArrayObject*>(input.ptr());
+              // Like the C++ predictor, shares the inputs with the net
               TensorFeeder<CPUContext>().FeedTensor(
-                  DeviceOption(), array, &(tensors_data[i]));
+                  DeviceOption(), array, &(tensors_data[i]), true);
             }
 #else
             CAFFE_THROW("Caffe2 was compiled without NumPy support.");
@@ -931,7 +974,7 @@ void addObjectMethods(py::module& m) {
               PyArrayObject* array =
                   reinterpret_cast<PyArrayObject*>(input.ptr());
               TensorFeeder<CPUContext>().FeedTensor(
-                  DeviceOption(), array, &tensors_data.at(name));
+                  DeviceOption(), array, &tensors_data.at(name), true);
             }
 #else
             CAFFE_THROW("Caffe2 was compiled without NumPy support.");
@@ -1167,6 +1210,7 @@ void addGlobalMethods(py::module& m) {
   }
 
         REGISTER_PYTHON_EXPOSED_OBSERVER(TimeObserver);
+        REGISTER_PYTHON_EXPOSED_OBSERVER(LatencyObserver);
 #undef REGISTER_PYTHON_EXPOSED_OBSERVER
 
         if (observer_type.compare("RunCountObserver") == 0) {
@@ -1439,7 +1483,10 @@ void addGlobalMethods(py::module& m) {
   });
   m.def(
       "feed_blob",
-      [](const std::string& name, py::object arg, py::object device_option) {
+      [](const std::string& name,
+         py::object arg,
+         py::object device_option,
+         bool zero_copy) {
         DeviceOption option;
         if (!device_option.is(py::none())) {
           // If we have a device option passed in, read it.
@@ -1455,7 +1502,7 @@ void addGlobalMethods(py::module& m) {
               feeder,
               "Unknown device type encountered in FeedBlob: ",
               option.device_type());
-          feeder->Feed(option, array, blob);
+          feeder->Feed(option, array, blob, zero_copy);
           return true;
         }
 #else
@@ -1473,7 +1520,8 @@ void addGlobalMethods(py::module& m) {
       "",
       py::arg("name"),
       py::arg("arg"),
-      py::arg("device_option") = py::none());
+      py::arg("device_option") = py::none(),
+      py::arg("zero_copy") = false);
   m.def("serialize_blob", [](const std::string& name) {
     CAFFE_ENFORCE(gWorkspace);
     auto* blob = gWorkspace->GetBlob(name);
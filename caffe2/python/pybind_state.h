@@ -65,8 +65,13 @@ class C10_EXPORT BlobFetcherBase {
 class BlobFeederBase {
  public:
   virtual ~BlobFeederBase();
-  virtual void
-  Feed(const DeviceOption& option, PyArrayObject* array, Blob* blob) = 0;
+  // With zero_copy, the blob aliases the memory of the array instead of
+  // copying it, if the feeder and the array allow it; see ShareNumpyArray.
+  virtual void Feed(
+      const DeviceOption& option,
+      PyArrayObject* array,
+      Blob* blob,
+      bool zero_copy = false) = 0;
 };
 
 C10_DECLARE_TYPED_REGISTRY(
@@ -100,6 +105,13 @@ static_assert(
 int CaffeToNumpyType(const TypeMeta& meta);
 const TypeMeta& NumpyTypeToCaffe(int numpy_type);
 
+// Makes a CPU tensor alias the memory of a numpy array, holding a reference
+// to the array until the storage of the tensor is freed. Changes to the array
+// are then seen by the tensor, and the other way around. Returns false,
+// leaving the tensor untouched, unless the array is aligned, C-contiguous,
+// writeable and in native byte order, with a fundamental type.
+bool ShareNumpyArray(PyArrayObject* array, Tensor* tensor);
+
 class TensorFetcher : public BlobFetcherBase {
  public:
   pybind11::object Fetch(const Blob& blob) override {
@@ -179,8 +191,13 @@ class TensorFeeder : public BlobFeederBase {
   void FeedTensor(
       const DeviceOption& option,
       PyArrayObject* original_array,
-      Tensor* tensor) {
+      Tensor* tensor,
+      bool zero_copy = false) {
 #ifdef USE_NUMPY
+    if (zero_copy && Context::GetDeviceType() == CPU &&
+        ShareNumpyArray(original_array, tensor)) {
+      return;
+    }
     PyArrayObject* array = PyArray_GETCONTIGUOUS(original_array);
     auto g = MakeGuard([&]() { Py_XDECREF(array); });
 
@@ -250,12 +267,16 @@ class TensorFeeder : public BlobFeederBase {
 #endif // USE_NUMPY
   }
 
-  virtual void
-  Feed(const DeviceOption& option, PyArrayObject* original_array, Blob* blob) {
+  void Feed(
+      const DeviceOption& option,
+      PyArrayObject* original_array,
+      Blob* blob,
+      bool zero_copy = false) override {
     FeedTensor(
         option,
         original_array,
-        BlobGetMutableTensor(blob, Context::GetDeviceType()));
+        BlobGetMutableTensor(blob, Context::GetDeviceType()),
+        zero_copy);
   }
 };
 
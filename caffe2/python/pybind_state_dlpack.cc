@@ -69,5 +69,17 @@ const TypeMeta& DLTypeToCaffe(const DLDataType& dl_type) {
   }
 }
 
+void DLPackCapsuleDestructor(PyObject* capsule) {
+  if (!PyCapsule_IsValid(capsule, "dltensor")) {
+    // The DLPack tensor was consumed
+    return;
+  }
+  auto* dlMTensor =
+      static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+  if (dlMTensor->deleter) {
+    dlMTensor->deleter(dlMTensor);
+  }
+}
+
 } // namespace python
 } // namespace caffe2
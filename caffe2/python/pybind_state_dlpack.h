@@ -20,6 +20,27 @@ const DLDataType* CaffeToDLType(const TypeMeta& meta);
 
 const TypeMeta& DLTypeToCaffe(const DLDataType& dl_type);
 
+// Destructor of the capsules of the DLPack tensors, which deletes the tensor
+// unless it was consumed, when the capsule was renamed to "used_dltensor".
+void DLPackCapsuleDestructor(PyObject* capsule);
+
+// A DLPack tensor with a tensor sharing the data it points to, which keeps
+// the data alive for as long as the consumer of the DLPack tensor uses it,
+// even when the blob it came from is resized or freed.
+struct DLPackTensorHolder {
+  explicit DLPackTensorHolder(const Tensor& src) : tensor(src.GetDevice()) {
+    tensor.Resize(src.sizes().vec());
+    tensor.ShareData(src);
+    managed_tensor.manager_ctx = this;
+    managed_tensor.deleter = [](DLManagedTensor* self) {
+      delete static_cast<DLPackTensorHolder*>(self->manager_ctx);
+    };
+  }
+
+  Tensor tensor;
+  DLManagedTensor managed_tensor;
+};
+
 template <class Context>
 class DLPackWrapper {
  public:
@@ -52,29 +73,35 @@ class DLPackWrapper {
         tensor->dtype().name());
     DLDataType tensor_type = *type_ptr;
 
+    // The data is shared, not copied
+    auto* holder = new DLPackTensorHolder(*tensor);
     DLTensor dlTensor;
-    dlTensor.data = const_cast<void*>(tensor->raw_data());
+    dlTensor.data = const_cast<void*>(holder->tensor.raw_data());
     dlTensor.ctx = tensor_context;
-    dlTensor.ndim = tensor->dim();
+    dlTensor.ndim = holder->tensor.dim();
     dlTensor.dtype = tensor_type;
-    dlTensor.shape = const_cast<int64_t*>(&(tensor->sizes()[0]));
+    dlTensor.shape = const_cast<int64_t*>(holder->tensor.sizes().data());
     dlTensor.strides = nullptr;
     dlTensor.byte_offset = 0;
+    holder->managed_tensor.dl_tensor = dlTensor;
 
-    managed_tensor.dl_tensor = dlTensor;
-    // C2 Tensor memory is managed by C2
-    managed_tensor.manager_ctx = nullptr;
-    managed_tensor.deleter= [](DLManagedTensor*) {};
-
-    return py::reinterpret_steal<py::object>(
-        PyCapsule_New(&managed_tensor, "dltensor", nullptr));
+    PyObject* capsule = PyCapsule_New(
+        &holder->managed_tensor, "dltensor", DLPackCapsuleDestructor);
+    if (!capsule) {
+      delete holder;
+      throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::object>(capsule);
   }
 
   void feed(py::object obj) {
     CAFFE_ENFORCE(PyCapsule_CheckExact(obj.ptr()), "Expected DLPack capsule");
     DLManagedTensor* dlMTensor =
         (DLManagedTensor*)PyCapsule_GetPointer(obj.ptr(), "dltensor");
-    CAFFE_ENFORCE(dlMTensor, "Invalid DLPack capsule");
+    CAFFE_ENFORCE(
+        dlMTensor,
+        "Invalid DLPack capsule. Note that DLPack capsules can be consumed "
+        "only once.");
     DLTensor* dlTensor = &dlMTensor->dl_tensor;
     auto device_type_ptr = CaffeToDLDeviceType(device_option.device_type());
     CAFFE_ENFORCE(
@@ -123,11 +150,13 @@ class DLPackWrapper {
             device),
         meta,
         0);
+    // The tensor owns the DLPack tensor now, which the capsule must not
+    // delete anymore
+    PyCapsule_SetName(obj.ptr(), "used_dltensor");
   }
 
   Tensor* tensor;
   DeviceOption device_option;
-  DLManagedTensor managed_tensor;
 };
 
 } // namespace python
@@ -10,6 +10,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <ATen/detail/CUDAHooksInterface.h>
+
 #ifdef CAFFE2_USE_CUDNN
 #include "caffe2/core/common_cudnn.h"
 #endif // CAFFE2_USE_CUDNN
@@ -118,6 +120,30 @@ void addCUDAGlobalMethods(py::module& m) {
       });
 };
 
+namespace {
+
+// Makes the stream waiting wait for the work queued on the stream producing
+// so far, on the device of the tensor, without blocking the host. nullptr is
+// the stream caffe2 runs the operators of this thread on, and the others are
+// the cudaStream_t of a stream as an int.
+void waitDLPackStream(
+    const DLPackWrapper<CUDAContext>& t,
+    const py::object& waiting,
+    const py::object& producing) {
+  const auto streamHandle = [&t](const py::object& stream) -> void* {
+    if (stream.is_none()) {
+      return CUDAContext(t.device_option).cuda_stream();
+    }
+    return reinterpret_cast<void*>(stream.cast<uintptr_t>());
+  };
+  at::detail::getCUDAHooks().streamWaitStream(
+      streamHandle(waiting),
+      streamHandle(producing),
+      t.device_option.device_id());
+}
+
+} // namespace
+
 void addCUDAObjectMethods(py::module& m) {
   py::class_<DLPackWrapper<CUDAContext>>(m, "DLPackTensorCUDA")
       .def_property_readonly(
@@ -131,16 +157,41 @@ void addCUDAObjectMethods(py::module& m) {
             return t->data();
           },
           "Return DLPack tensor with tensor's data.")
+      .def(
+          "to_dlpack",
+          [](DLPackWrapper<CUDAContext>* t, py::object stream) -> py::object {
+            CAFFE_ENFORCE_EQ(
+                t->device_option.device_type(),
+                PROTO_CUDA,
+                "Expected CUDA device option for CUDA tensor");
+            if (!stream.is_none()) {
+              waitDLPackStream(*t, stream, py::none());
+            }
+            return t->data();
+          },
+          "Return DLPack tensor with tensor's data, for use on the given "
+          "stream (the cudaStream_t as an int), which waits for the work "
+          "queued on the stream of caffe2 so far.",
+          py::arg("stream") = py::none())
       .def(
           "feed",
-          [](DLPackWrapper<CUDAContext>* t, py::object obj) {
+          [](DLPackWrapper<CUDAContext>* t,
+             py::object obj,
+             py::object stream) {
             CAFFE_ENFORCE_EQ(
                 t->device_option.device_type(),
                 PROTO_CUDA,
                 "Expected CUDA device option for CUDA tensor");
+            if (!stream.is_none()) {
+              waitDLPackStream(*t, py::none(), stream);
+            }
             t->feed(obj);
           },
-          "Copy data from given DLPack tensor into this tensor.")
+          "Copy data from given DLPack tensor into this tensor. The stream "
+          "of caffe2 waits for the work queued so far on the given stream "
+          "(the cudaStream_t as an int) the DLPack tensor was produced on.",
+          py::arg("obj"),
+          py::arg("stream") = py::none())
       .def_property_readonly(
           "_shape",
           [](const DLPackWrapper<CUDAContext>& t) { return t.tensor->sizes(); })
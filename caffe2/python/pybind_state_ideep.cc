@@ -161,7 +161,7 @@ public:
   }
 
   void Feed(const DeviceOption &option, PyArrayObject *original_array,
-            Blob *blob) {
+            Blob *blob, bool zero_copy = false) override {
 #ifdef USE_NUMPY
     try {
       PyArrayObject *array = PyArray_GETCONTIGUOUS(original_array);
@@ -177,7 +177,10 @@ public:
         cpu_option.set_device_type(DeviceTypeProto::PROTO_CPU);
         TensorFeeder<CPUContext> cpu_tensor_feeder;
         cpu_tensor_feeder.FeedTensor(
-            cpu_option, original_array, BlobGetMutableTensor(blob, CPU));
+            cpu_option,
+            original_array,
+            BlobGetMutableTensor(blob, CPU),
+            zero_copy);
       }
     } catch (ideep::error &e) {
       LOG(ERROR) << "IDEEP error: " << e.message;
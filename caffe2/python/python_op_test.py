@@ -229,3 +229,17 @@ class PythonOpTest(hu.HypothesisTestCase):
 
         self.assertGradientChecks(gc, op, [x1, x2, x3], 0, [0, 2])
         self.assertDeviceChecks(dc, op, [x1, x2, x3], [0, 1, 2])
+
+    @given(x=hu.tensor())
+    def test_dlpack_feed_shares_data(self, x):
+        def f(inputs, outputs):
+            outputs[0].feed(inputs[0].data)
+
+        op = core.CreateOperator(
+            "PythonDLPack", ["x"], ["y"],
+            token=core._RegisterPythonImpl(f))
+        workspace.FeedBlob("x", x)
+        workspace.RunOperatorOnce(op)
+        # The data of y outlives the blob it came from
+        workspace.FeedBlob("x", np.zeros(1, dtype=np.float32))
+        np.testing.assert_almost_equal(x, workspace.FetchBlob("y"))
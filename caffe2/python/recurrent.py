@@ -12,6 +12,7 @@ def recurrent_net(
         net, cell_net, inputs, initial_cell_inputs,
         links, timestep=None, scope=None, outputs_with_grads=(0,),
         recompute_blobs_on_backward=None, forward_only=False,
+        recompute_interval=None,
 ):
     '''
     net: the main net operator should be added to
@@ -45,6 +46,11 @@ def recurrent_net(
                  stored for each forward timestep.
 
     forward_only: if True, only forward steps are executed
+
+    recompute_interval: if set to k, only the activations of k timesteps of
+                 cell_net are stored on the forward pass, and the backward
+                 pass recomputes them for each segment of k timesteps from
+                 the recurrent states. cell_net has to be deterministic.
     '''
     assert len(inputs) == 1, "Only one input blob is supported so far"
 
@@ -255,6 +261,8 @@ def recurrent_net(
             ],
             'param_grads': param_grads,
         }
+        if recompute_interval is not None:
+            backward_args['recompute_interval'] = recompute_interval
         if len(backward_cell_net.Proto().op) != 0:
             backward_args['backward_step_net'] = backward_cell_net.Proto()
 
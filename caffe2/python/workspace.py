@@ -302,7 +302,7 @@ def GetNetName(net):
     raise Exception("Not a Net object: {}".format(str(net)))
 
 
-def FeedBlob(name, arr, device_option=None):
+def FeedBlob(name, arr, device_option=None, zero_copy=False):
     """Feeds a blob into the workspace.
 
     Inputs:
@@ -310,11 +310,16 @@ def FeedBlob(name, arr, device_option=None):
       arr: either a TensorProto object or a numpy array object to be fed into
           the workspace.
       device_option (optional): the device option to feed the data with.
+      zero_copy (optional): if True and the blob is fed on CPU, the blob
+          shares the memory of arr instead of copying it, whenever arr is
+          aligned, C-contiguous, writeable and of a numeric type. The blob
+          then keeps arr alive, sees later changes to it, and operators
+          writing the blob in place change arr.
     Returns:
       True or False, stating whether the feed is successful.
     """
     ws = C.Workspace.current
-    return _Workspace_feed_blob(ws, name, arr, device_option)
+    return _Workspace_feed_blob(ws, name, arr, device_option, zero_copy)
 
 
 def FetchBlobs(names):
@@ -647,7 +652,7 @@ def _Workspace_run(ws, obj):
         "Don't know how to do Workspace.run() on {}".format(type(obj)))
 
 
-def _Workspace_feed_blob(ws, name, arr, device_option=None):
+def _Workspace_feed_blob(ws, name, arr, device_option=None, zero_copy=False):
     if type(arr) is caffe2_pb2.TensorProto:
         arr = utils.Caffe2TensorToNumpyArray(arr)
     if type(arr) is np.ndarray and arr.dtype.kind in 'SU':
@@ -668,9 +673,9 @@ def _Workspace_feed_blob(ws, name, arr, device_option=None):
 
     name = StringifyBlobName(name)
     if device_option is not None:
-        return ws.create_blob(name).feed(arr, device_option)
+        return ws.create_blob(name).feed(arr, device_option, zero_copy)
     else:
-        return ws.create_blob(name).feed(arr)
+        return ws.create_blob(name).feed(arr, zero_copy=zero_copy)
 
 
 def _Workspace_remove_blob(ws, blob):
@@ -686,10 +691,10 @@ Workspace.remove_blob = _Workspace_remove_blob
 
 # C.Blob methods.
 
-def _Blob_feed(blob, arg, device_option=None):
+def _Blob_feed(blob, arg, device_option=None, zero_copy=False):
     if device_option is not None:
         device_option = StringifyProto(device_option)
-    return blob._feed(arg, device_option)
+    return blob._feed(arg, device_option, zero_copy)
 
 
 C.Blob.feed = _Blob_feed
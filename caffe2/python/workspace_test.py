@@ -97,6 +97,45 @@ class TestWorkspace(unittest.TestCase):
         self.assertEqual(workspace.RunPlan(step), True)
         self.assertEqual(workspace.HasBlob("testblob"), True)
 
+    def testRunPipelinePlan(self):
+        init_net = core.Net("pipeline-init")
+        counter_mutex = init_net.CreateMutex([])
+        sum_mutex = init_net.CreateMutex([])
+        counter = init_net.ConstantFill(
+            [], shape=[], value=0, dtype=core.DataType.INT32)
+        total = init_net.ConstantFill(
+            [], shape=[], value=0, dtype=core.DataType.INT32)
+        one = init_net.ConstantFill(
+            [], shape=[], value=1, dtype=core.DataType.INT32)
+
+        produce = core.Net("pipeline-produce")
+        produce.AtomicFetchAdd(
+            [counter_mutex, counter, one], [counter, "item"])
+        square = core.Net("pipeline-square")
+        square.Mul(["item", "item"], "squared")
+        accumulate = core.Net("pipeline-accumulate")
+        accumulate.AtomicFetchAdd(
+            [sum_mutex, total, "squared"], [total, "previous_total"])
+
+        pipeline = core.execution_step("pipeline", [
+            core.execution_step(
+                "produce", produce, num_iter=100, num_concurrent_instances=2,
+                pipeline_output_blobs=["item"]),
+            core.execution_step(
+                "square", square, num_concurrent_instances=3,
+                pipeline_output_blobs=["squared"]),
+            core.execution_step("accumulate", accumulate),
+        ], pipeline_substeps=True, pipeline_queue_capacity=4)
+        plan = core.Plan("pipeline-plan")
+        plan.AddStep(core.execution_step("init", init_net))
+        plan.AddStep(pipeline)
+        self.assertEqual(workspace.RunPlan(plan), True)
+        self.assertEqual(workspace.FetchBlob(counter), 100)
+        # sum[i=0..99](i * i)
+        self.assertEqual(workspace.FetchBlob(total), 328350)
+        # the items are local to the workspaces of the stages
+        self.assertEqual(workspace.HasBlob("item"), False)
+
     def testResetWorkspace(self):
         self.assertEqual(
             workspace.RunNetOnce(self.net.Proto().SerializeToString()), True)
@@ -232,6 +271,28 @@ class TestWorkspace(unittest.TestCase):
         self.assertEqual(fetched_back.shape, (2, 0, 3))
         self.assertEqual(fetched_back.dtype, np.float32)
 
+    def testFeedBlobZeroCopy(self):
+        data = np.arange(6, dtype=np.float32).reshape(2, 3)
+        self.assertTrue(workspace.FeedBlob("testblob_shared", data,
+                                           zero_copy=True))
+        # The blob aliases the array
+        data[1, 2] = 42
+        np.testing.assert_array_equal(
+            workspace.FetchBlob("testblob_shared"), data)
+        # and keeps it alive
+        expected = data.copy()
+        del data
+        np.testing.assert_array_equal(
+            workspace.FetchBlob("testblob_shared"), expected)
+
+        # A non contiguous array is copied
+        strided = np.arange(12, dtype=np.float32).reshape(3, 4)[:, 1]
+        self.assertTrue(workspace.FeedBlob("testblob_copied", strided,
+                                           zero_copy=True))
+        strided[0] = 42
+        np.testing.assert_array_equal(
+            workspace.FetchBlob("testblob_copied"), [1, 5, 9])
+
     def testFetchFeedLongStringTensor(self):
         # long strings trigger array of object creation
         strs = np.array([
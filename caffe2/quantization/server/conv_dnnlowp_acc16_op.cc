@@ -11,6 +11,7 @@
 #endif
 
 #include "dnnlowp_partition.h"
+#include "fbgemm_pack_matrix_cache.h"
 #include "im2col_dnnlowp.h"
 
 C10_DECLARE_int32(dnnlowp_nbits_in_non_outlier);
@@ -157,12 +158,12 @@ bool ConvDNNLowPAcc16Op<ReluFused>::GetQuantizationParameters_() {
   if (packW && Wq_acc16_packed_.empty()) {
     Wq_acc16_packed_.resize(group_);
     for (int group_id = 0; group_id < group_; ++group_id) {
-      Wq_acc16_packed_[group_id].reset(new fbgemm::PackBMatrix<int8_t, int16_t>(
+      Wq_acc16_packed_[group_id] = GetOrCreateFbgemmPackBMatrix<int16_t>(
           fbgemm::matrix_op_t::Transpose,
           kernel_dim,
           M / group_,
           W_quantized_.data() + group_id * (M / group_) * kernel_dim,
-          kernel_dim));
+          kernel_dim);
     }
     vector<int8_t>().swap(W_quantized_);
   }
@@ -45,7 +45,7 @@ class ConvDNNLowPAcc16Op final : public ConvDNNLowPOp<std::uint8_t, ReluFused> {
       const std::uint8_t* col_buffer,
       vector<std::int32_t>* Y_int32);
 
-  std::vector<std::unique_ptr<fbgemm::PackBMatrix<std::int8_t, std::int16_t>>>
+  std::vector<std::shared_ptr<fbgemm::PackBMatrix<std::int8_t, std::int16_t>>>
       Wq_acc16_packed_;
 
   // Wq outlier in CSC format
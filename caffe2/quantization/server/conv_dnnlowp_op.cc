@@ -16,6 +16,7 @@
 #include <fbgemm/src/RefImplementations.h>
 
 #include "dnnlowp_partition.h"
+#include "fbgemm_pack_matrix_cache.h"
 #include "im2col_dnnlowp.h"
 #include "mmio.h"
 
@@ -351,16 +352,14 @@ void ConvDNNLowPOp<T, ReluFused>::QuantizeWeight_() {
       // fast path using fbgemm
       Wq_packed_.resize(group_);
       for (int group_id = 0; group_id < group_; ++group_id) {
-        Wq_packed_[group_id].reset(new fbgemm::PackBMatrix<int8_t>(
+        Wq_packed_[group_id] = GetOrCreateFbgemmPackBMatrix<int32_t>(
             fbgemm::matrix_op_t::Transpose,
             kernel_dim,
             M / group_,
             reinterpret_cast<const int8_t*>(W_quantized_.data()) +
                 group_id * (M / group_) * kernel_dim,
             kernel_dim, // ld
-            nullptr, // pmat
-            1, // groups
-            FilterQuantizationParams(group_id).zero_point));
+            FilterQuantizationParams(group_id).zero_point);
       }
     } else {
       string reason;
@@ -105,7 +105,7 @@ class ConvDNNLowPOp : public ConvPoolDNNLowPOpBase<T, ConvFp32Op> {
   std::vector<dnnlowp::RequantizationParams> requantization_params_;
 
   // used in fast path for T == uint8_t
-  std::vector<std::unique_ptr<fbgemm::PackBMatrix<std::int8_t>>> Wq_packed_;
+  std::vector<std::shared_ptr<fbgemm::PackBMatrix<std::int8_t>>> Wq_packed_;
 
   // For depthwise 3x3 conv
   std::unique_ptr<fbgemm::Packed3x3ConvMatrix> Wq_depthwise_3x3_packed_;
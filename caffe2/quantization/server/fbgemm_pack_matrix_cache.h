@@ -1,13 +1,17 @@
 #pragma once
 
+#include <memory>
+
 #include "fbgemm/Fbgemm.h"
 
 namespace caffe2 {
 
 /**
  * If there's an existing packed matrix for the same matrix, reuse it.
- * Create a new one otherwise. This can save memory usage if many threads are
- * sharing the same weight.
+ * Create a new one otherwise. This can save memory usage if many threads or
+ * nets are sharing the same weight: the packed matrices are cached process
+ * wide by the contents of the quantized matrix (see PrepackCache), so copies
+ * of a weight in different nets share a single packed matrix too.
  */
 template <typename ACC_T>
 std::shared_ptr<fbgemm::PackBMatrix<int8_t, ACC_T>>
@@ -15,9 +19,8 @@ GetOrCreateFbgemmPackBMatrix(
     fbgemm::matrix_op_t trans,
     std::int32_t m,
     std::int32_t n,
-    const void* orig_data,
     const std::int8_t* quantized_data,
     std::int32_t ld,
-    std::int32_t zero_point);
+    std::int32_t zero_point = 0);
 
 } // namespace caffe2
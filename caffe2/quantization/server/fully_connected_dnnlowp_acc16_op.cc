@@ -2,6 +2,8 @@
 
 #include <fbgemm/src/RefImplementations.h>
 
+#include "fbgemm_pack_matrix_cache.h"
+
 C10_DECLARE_int32(dnnlowp_nbits_in_non_outlier);
 C10_DECLARE_int32(dnnlowp_copy_to_32bit_frequency);
 
@@ -96,12 +98,21 @@ bool FullyConnectedDNNLowPAcc16Op::RunOnDevice() {
       LOG(INFO) << "copy_to_32bit_frequency " << copy_to_32bit_frequency_;
     }
 
-    Wq_acc16_packed_.reset(new fbgemm::PackBMatrix<int8_t, int16_t>(
-        fbgemm::matrix_op_t::Transpose,
-        K,
-        N,
-        reinterpret_cast<const int8_t*>(W_quantized_.data()),
-        K));
+    if (is_weight_constant_) {
+      Wq_acc16_packed_ = GetOrCreateFbgemmPackBMatrix<int16_t>(
+          fbgemm::matrix_op_t::Transpose,
+          K,
+          N,
+          reinterpret_cast<const int8_t*>(W_quantized_.data()),
+          K);
+    } else {
+      Wq_acc16_packed_.reset(new fbgemm::PackBMatrix<int8_t, int16_t>(
+          fbgemm::matrix_op_t::Transpose,
+          K,
+          N,
+          reinterpret_cast<const int8_t*>(W_quantized_.data()),
+          K));
+    }
 
     if (is_weight_constant_) {
       vector<T_signed>().swap(W_quantized_);
@@ -25,7 +25,7 @@ class FullyConnectedDNNLowPAcc16Op final
   using BaseType::W_quantized_;
 
  private:
-  std::unique_ptr<fbgemm::PackBMatrix<std::int8_t, std::int16_t>>
+  std::shared_ptr<fbgemm::PackBMatrix<std::int8_t, std::int16_t>>
       Wq_acc16_packed_;
 
   // Wq outlier in CSC format
@@ -444,7 +444,6 @@ bool FullyConnectedDNNLowPOp<T>::GetQuantizationParameters_() {
             fbgemm::matrix_op_t::Transpose,
             K,
             N,
-            W.raw_data(),
             reinterpret_cast<const int8_t*>(W_quantized_.data()),
             K, // ld
             in_qparams_[1].zero_point);
@@ -2,6 +2,8 @@
 #include <fbgemm/src/RefImplementations.h>
 #include <chrono>
 
+#include "fbgemm_pack_matrix_cache.h"
+
 namespace caffe2 {
 
 using namespace std;
@@ -270,15 +272,13 @@ bool FullyConnectedRowWiseDNNLowPOp<T>::GetQuantizationParameters_() {
         // fast path using fbgemm
         LOG(INFO)
             << "Using fast path with int8 fbgemm and generating Wq_packed_";
-        Wq_packed_.reset(new fbgemm::PackBMatrix<int8_t>(
+        Wq_packed_ = GetOrCreateFbgemmPackBMatrix<int32_t>(
             fbgemm::matrix_op_t::Transpose,
             K,
             N,
             reinterpret_cast<const int8_t*>(W_quantized_.data()),
             K, // ld
-            nullptr, // pmat
-            1, // groups
-            in_qparams_[1].zero_point));
+            in_qparams_[1].zero_point);
       } else {
         LOG(WARNING)
             << "Falling back to slow path because fbgemm doesn't support "
@@ -215,7 +215,10 @@ def fuse_first_relu(net, ignore_op_with_output=None):
         if next_.input[0] != current.output[0]:
             continue
 
-        if current.type not in ("Conv", "Sum") or next_.type != "Relu":
+        if current.type not in ("Conv", "Int8Conv", "Sum") or next_.type not in (
+            "Relu",
+            "Int8Relu",
+        ):
             continue
 
         if ignore_op_with_output and current.output[0] in ignore_op_with_output:
@@ -225,7 +228,7 @@ def fuse_first_relu(net, ignore_op_with_output=None):
         conv = current
         relu = next_
         fused_conv = copy.deepcopy(conv)
-        fused_conv.type = "ConvRelu" if current.type == "Conv" else "SumRelu"
+        fused_conv.type = current.type + "Relu"
         fused_conv.output[0] = relu.output[0]
 
         new_ops = net.op[:i] + [fused_conv] + net.op[j + 1 :]
@@ -240,7 +243,10 @@ def fuse_relu(net, ignore_failure, ignore_op_with_output=None):
     while True:
         next_net = fuse_first_relu(net, ignore_op_with_output)
         if len(next_net.op) == len(net.op):
-            if any(op.type == "Relu" for op in next_net.op) and not ignore_failure:
+            if (
+                any(op.type in ("Relu", "Int8Relu") for op in next_net.op)
+                and not ignore_failure
+            ):
                 raise Exception("Model contains Relu op after fusion: %s", next_net)
             return next_net
         net = next_net
@@ -374,6 +380,73 @@ def add_quantization_param_args(op, tensor, preserve_sparsity=False):
     return q_param
 
 
+def get_quantization_param_args(op):
+    scale = None
+    zero_point = None
+    for arg in op.arg:
+        if arg.name == "Y_scale":
+            scale = arg.f
+        elif arg.name == "Y_zero_point":
+            zero_point = arg.i
+    if scale is None or zero_point is None:
+        return None
+    return hardcode_scale_zp.QuantizationParam(scale, zero_point)
+
+
+# Ops whose output range is within the range of their first input, so that
+# they can keep its quantization parameters
+_QUANTIZATION_PRESERVING_OPS = (
+    "Relu",
+    "Int8Relu",
+    "MaxPool",
+    "Int8MaxPool",
+    "AveragePool",
+    "Int8AveragePool",
+)
+
+
+def propagate_quantization_params(net):
+    """
+    Gives each Relu, MaxPool and AveragePool op that has no Y_scale and
+    Y_zero_point arguments the quantization parameters of its input, when the
+    op producing the input has static ones. Without static parameters, a
+    DNNLOWP op runs its fp32 reference implementation on the dequantized input
+    to choose the parameters of its output; with the parameters of its input,
+    the op runs on the quantized values alone and a conv -> relu -> pool -> conv
+    chain needs no fp32 tensor in between.
+    """
+    net = copy.deepcopy(net)
+
+    q_params = {}
+    for op in net.op:
+        q_param = get_quantization_param_args(op)
+        if (
+            q_param is None
+            and op.type in _QUANTIZATION_PRESERVING_OPS
+            and op.input[0] in q_params
+        ):
+            q_param = q_params[op.input[0]]
+            add_quantization_param_args_(op, q_param)
+        for blob in op.output:
+            q_params.pop(blob, None)
+        if q_param is not None and len(op.output) > 0:
+            q_params[op.output[0]] = q_param
+    return net
+
+
+def fuse_requantization(net, ignore_op_with_output=None):
+    """
+    Prepares a quantized net for running without fp32 tensors between its
+    layers: fuses each Relu into the Conv or Sum before it, so that the relu is
+    applied while requantizing their output, then propagates the quantization
+    parameters to the remaining ops with propagate_quantization_params.
+    """
+    net = fuse_relu(
+        net, ignore_failure=True, ignore_op_with_output=ignore_op_with_output
+    )
+    return propagate_quantization_params(net)
+
+
 def create_int8_given_tensor_fill(tensor, out_blob_name, preserve_sparsity=False):
     """
     Create Int8GivenTensorFill op that quantizes the given tensor and outputs
@@ -0,0 +1,99 @@
+from __future__ import absolute_import, division, print_function, unicode_literals
+
+import unittest
+
+import caffe2.quantization.server.utils as dnnlowp_utils
+from caffe2.python import core, utils
+
+
+class DNNLowPUtilsTest(unittest.TestCase):
+    def _conv_relu_pool_conv_net(self):
+        net = core.Net("test_net")
+        ops = [
+            core.CreateOperator(
+                "Quantize",
+                ["X"],
+                ["X_q"],
+                engine="DNNLOWP",
+                Y_scale=0.1,
+                Y_zero_point=10,
+            ),
+            core.CreateOperator(
+                "Int8Conv",
+                ["X_q", "W1", "b1"],
+                ["Y1_q"],
+                kernel=3,
+                engine="DNNLOWP",
+                Y_scale=0.2,
+                Y_zero_point=0,
+            ),
+            core.CreateOperator("Relu", ["Y1_q"], ["Y1_q"], engine="DNNLOWP"),
+            core.CreateOperator(
+                "MaxPool", ["Y1_q"], ["P1_q"], kernel=2, engine="DNNLOWP"
+            ),
+            core.CreateOperator(
+                "AveragePool", ["P1_q"], ["P2_q"], kernel=2, engine="DNNLOWP"
+            ),
+            core.CreateOperator(
+                "Int8Conv",
+                ["P2_q", "W2", "b2"],
+                ["Y2_q"],
+                kernel=3,
+                engine="DNNLOWP",
+                Y_scale=0.3,
+                Y_zero_point=5,
+            ),
+            core.CreateOperator("Relu", ["Y2_q"], ["Y2"]),
+        ]
+        net.Proto().op.extend(ops)
+        return net.Proto()
+
+    def test_fuse_requantization(self):
+        net = dnnlowp_utils.fuse_requantization(self._conv_relu_pool_conv_net())
+        self.assertEqual(
+            [op.type for op in net.op],
+            [
+                "Quantize",
+                "Int8ConvRelu",
+                "MaxPool",
+                "AveragePool",
+                "Int8ConvRelu",
+            ],
+        )
+        self.assertEqual(net.op[4].output[0], "Y2")
+        q_params = [dnnlowp_utils.get_quantization_param_args(op) for op in net.op]
+        for q_param in q_params[2:4]:
+            self.assertAlmostEqual(q_param.scale, 0.2)
+            self.assertEqual(q_param.zero_point, 0)
+        self.assertAlmostEqual(q_params[4].scale, 0.3)
+        self.assertEqual(q_params[4].zero_point, 5)
+
+    def test_propagate_quantization_params(self):
+        net = self._conv_relu_pool_conv_net()
+        # Keeps the parameters of an op that has some
+        net.op[4].arg.extend(
+            [
+                utils.MakeArgument("Y_scale", 0.05),
+                utils.MakeArgument("Y_zero_point", 0),
+            ]
+        )
+        net = dnnlowp_utils.propagate_quantization_params(net)
+        q_params = [dnnlowp_utils.get_quantization_param_args(op) for op in net.op]
+        for q_param in q_params[2:4]:
+            self.assertAlmostEqual(q_param.scale, 0.2)
+            self.assertEqual(q_param.zero_point, 0)
+        self.assertAlmostEqual(q_params[4].scale, 0.05)
+        # The last Relu follows a Conv with static parameters
+        self.assertAlmostEqual(q_params[6].scale, 0.3)
+        self.assertEqual(q_params[6].zero_point, 5)
+
+    def test_propagate_quantization_params_dynamic_input(self):
+        net = self._conv_relu_pool_conv_net()
+        del net.op[1].arg[:]
+        net = dnnlowp_utils.propagate_quantization_params(net)
+        for op in net.op[2:5]:
+            self.assertIsNone(dnnlowp_utils.get_quantization_param_args(op))
+
+
+if __name__ == "__main__":
+    unittest.main()
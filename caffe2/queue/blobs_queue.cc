@@ -29,15 +29,17 @@ BlobsQueue::BlobsQueue(
     size_t numBlobs,
     bool enforceUniqueName,
     const std::vector<std::string>& fieldNames)
-    : numBlobs_(numBlobs), name_(queueName), stats_(queueName) {
+    : numBlobs_(numBlobs),
+      queue_(capacity),
+      name_(queueName),
+      stats_(queueName) {
   if (!fieldNames.empty()) {
     CAFFE_ENFORCE_EQ(
         fieldNames.size(), numBlobs, "Wrong number of fieldNames provided.");
     stats_.queue_dequeued_bytes.setDetails(fieldNames);
   }
-  queue_.reserve(capacity);
   for (auto i = 0; i < capacity; ++i) {
-    std::vector<Blob*> blobs;
+    auto& blobs = queue_[i].blobs;
     blobs.reserve(numBlobs);
     for (auto j = 0; j < numBlobs; ++j) {
       const auto blobName = queueName + "_" + to_string(i) + "_" + to_string(j);
@@ -49,7 +51,7 @@ BlobsQueue::BlobsQueue(
       }
       blobs.push_back(ws->CreateBlob(blobName));
     }
-    queue_.push_back(blobs);
+    queue_[i].sequence = 2 * i;
   }
   DCHECK_EQ(queue_.size(), capacity);
 }
@@ -57,49 +59,86 @@ BlobsQueue::BlobsQueue(
 bool BlobsQueue::blockingRead(
     const std::vector<Blob*>& inputs,
     float timeout_secs) {
+  return read(
+             1,
+             [&inputs](size_t /* unused */) -> const std::vector<Blob*>& {
+               return inputs;
+             },
+             timeout_secs) > 0;
+}
+
+size_t BlobsQueue::blockingRead(
+    const std::vector<std::vector<Blob*>>& inputs,
+    float timeout_secs) {
+  CAFFE_ENFORCE(!inputs.empty());
+  return read(
+      inputs.size(),
+      [&inputs](size_t i) -> const std::vector<Blob*>& { return inputs[i]; },
+      timeout_secs);
+}
+
+template <typename Outputs>
+size_t BlobsQueue::read(
+    size_t n,
+    const Outputs& outputs,
+    float timeout_secs) {
   Timer readTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  auto canRead = [this]() {
-    CAFFE_ENFORCE_LE(reader_, writer_);
-    return reader_ != writer_;
-  };
+  // Records are claimed before they are swapped out, so the outputs are
+  // checked first
+  for (size_t i = 0; i < n; ++i) {
+    CAFFE_ENFORCE(outputs(i).size() >= numBlobs_);
+  }
   // Decrease queue balance before reading to indicate queue read pressure
   // is being increased (-ve queue balance indicates more reads than writes)
-  CAFFE_EVENT(stats_, queue_balance, -1);
-  if (timeout_secs > 0) {
-    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
-        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
-  } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
+  CAFFE_EVENT(stats_, queue_balance, -static_cast<int64_t>(n));
+  const bool has_timeout = timeout_secs > 0;
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  int64_t first = 0;
+  size_t count = tryClaimRead(n, &first);
+  if (count == 0) {
+    Timer waitTimer;
+    while ((count = tryClaimRead(n, &first)) == 0 && !closing_) {
+      if (!wait([this]() { return canRead(); }, has_timeout, deadline)) {
+        count = tryClaimRead(n, &first);
+        break;
+      }
+    }
+    CAFFE_EVENT(stats_, read_wait_time_ns, waitTimer.NanoSeconds());
   }
-  if (!canRead()) {
-    if (timeout_secs > 0 && !closing_) {
+  if (count == 0) {
+    if (has_timeout && !closing_) {
       LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
     } else {
       CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
     }
-    return false;
+    return 0;
   }
-  DCHECK(canRead());
-  auto& result = queue_[reader_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
+  CAFFE_EVENT(stats_, queue_fill_level, writer_.load() - first);
+  for (size_t k = 0; k < count; ++k) {
+    auto& record = slot(first + k);
+    const auto& inputs = outputs(k);
+    for (auto i = 0; i < record.blobs.size(); ++i) {
+      auto bytes = BlobStat::sizeBytes(*record.blobs[i]);
+      CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+      using std::swap;
+      swap(*(inputs[i]), *(record.blobs[i]));
+    }
+    // Frees the slot for the write of the record one lap later
+    record.sequence.store(
+        2 * (first + static_cast<int64_t>(k + queue_.size())),
+        std::memory_order_release);
   }
-  CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
-  CAFFE_EVENT(stats_, queue_dequeued_records);
-  ++reader_;
-  cv_.notify_all();
+  CAFFE_SDT(
+      queue_read_end, name, (void*)this, writer_.load() - reader_.load());
+  CAFFE_EVENT(stats_, queue_dequeued_records, count);
+  notify();
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
-  return true;
+  return count;
 }
 
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
@@ -107,16 +146,16 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_NONBLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  if (!canWrite()) {
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  int64_t position = 0;
+  if (!tryClaimWrite(&position)) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(position, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -126,17 +165,26 @@ bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
-  if (!canWrite()) {
+  int64_t position = 0;
+  bool claimed = tryClaimWrite(&position);
+  if (!claimed) {
+    Timer waitTimer;
+    while (!(claimed = tryClaimWrite(&position)) && !closing_) {
+      wait([this]() { return canWrite(); },
+           false,
+           std::chrono::steady_clock::time_point());
+    }
+    CAFFE_EVENT(stats_, write_wait_time_ns, waitTimer.NanoSeconds());
+  }
+  if (!claimed) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
-  DCHECK(canWrite());
-  doWrite(inputs);
+  doWrite(position, inputs);
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
@@ -148,26 +196,116 @@ void BlobsQueue::close() {
   cv_.notify_all();
 }
 
+size_t BlobsQueue::tryClaimRead(size_t n, int64_t* first) {
+  auto position = reader_.load(std::memory_order_relaxed);
+  while (true) {
+    // The records written since `position`
+    size_t available = 0;
+    while (available < n && available < queue_.size() &&
+           slot(position + available)
+                   .sequence.load(std::memory_order_acquire) ==
+               2 * (position + static_cast<int64_t>(available)) + 1) {
+      ++available;
+    }
+    if (available == 0) {
+      // The queue is empty, unless other readers moved on meanwhile
+      auto current = reader_.load(std::memory_order_relaxed);
+      if (current == position) {
+        return 0;
+      }
+      position = current;
+      continue;
+    }
+    // On failure, position is updated to the current reader
+    if (reader_.compare_exchange_weak(position, position + available)) {
+      *first = position;
+      return available;
+    }
+  }
+}
+
+bool BlobsQueue::tryClaimWrite(int64_t* position) {
+  auto current = writer_.load(std::memory_order_relaxed);
+  while (true) {
+    auto sequence = slot(current).sequence.load(std::memory_order_acquire);
+    if (sequence == 2 * current) {
+      // On failure, current is updated to the current writer
+      if (writer_.compare_exchange_weak(current, current + 1)) {
+        *position = current;
+        return true;
+      }
+    } else if (sequence < 2 * current) {
+      // The slot still holds the record of the previous lap: the queue is
+      // full, unless other writers moved on meanwhile
+      auto latest = writer_.load(std::memory_order_relaxed);
+      if (latest == current) {
+        return false;
+      }
+      current = latest;
+    } else {
+      current = writer_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool BlobsQueue::canRead() {
+  auto position = reader_.load();
+  return slot(position).sequence.load(std::memory_order_acquire) ==
+      2 * position + 1;
+}
+
 bool BlobsQueue::canWrite() {
   // writer is always within [reader, reader + size)
-  // we can write if reader is within [reader, reader + size)
-  CAFFE_ENFORCE_LE(reader_, writer_);
-  CAFFE_ENFORCE_LE(writer_, reader_ + queue_.size());
-  return writer_ != reader_ + queue_.size();
+  // we can write if the slot of the writer was read in the previous lap
+  auto position = writer_.load();
+  return slot(position).sequence.load(std::memory_order_acquire) ==
+      2 * position;
 }
 
-void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
-  auto& result = queue_[writer_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
+void BlobsQueue::doWrite(int64_t position, const std::vector<Blob*>& inputs) {
+  auto& record = slot(position);
   const auto& name = name_.c_str();
-  for (auto i = 0; i < result.size(); ++i) {
+  for (auto i = 0; i < record.blobs.size(); ++i) {
     using std::swap;
-    swap(*(inputs[i]), *(result[i]));
+    swap(*(inputs[i]), *(record.blobs[i]));
   }
   CAFFE_SDT(
-      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
-  ++writer_;
-  cv_.notify_all();
+      queue_write_end,
+      name,
+      (void*)this,
+      reader_.load() + queue_.size() - writer_.load());
+  // Publishes the record to the readers
+  record.sequence.store(2 * position + 1, std::memory_order_release);
+  notify();
+}
+
+void BlobsQueue::notify() {
+  // Pairs with the fence in wait(): either the waiter sees the change of the
+  // queue before it blocks, or this sees the waiter
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> g(mutex_);
+    cv_.notify_all();
+  }
+}
+
+template <typename Ready>
+bool BlobsQueue::wait(
+    const Ready& ready,
+    bool timeout,
+    std::chrono::steady_clock::time_point deadline) {
+  std::unique_lock<std::mutex> g(mutex_);
+  ++waiters_;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto done = [this, &ready]() { return closing_ || ready(); };
+  bool ready_in_time = true;
+  if (timeout) {
+    ready_in_time = cv_.wait_until(g, deadline, done);
+  } else {
+    cv_.wait(g, done);
+  }
+  --waiters_;
+  return ready_in_time;
 }
 
 } // namespace caffe2
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 #include "caffe2/core/blob_stats.h"
 #include "caffe2/core/logging.h"
@@ -15,7 +17,12 @@
 namespace caffe2 {
 
 // A thread-safe, bounded, blocking queue.
-// Modelled as a circular buffer.
+// Modelled as a circular buffer of records. Readers and writers claim records
+// without locking: each slot of the buffer has a sequence number that tells
+// whether it holds the record of a given position, or is free for it (as in
+// D. Vyukov's bounded MPMC queue). The mutex and condition variable are only
+// used to block while the queue is empty or full, and are not touched when
+// nobody is waiting.
 
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
@@ -37,6 +44,12 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   bool blockingRead(
       const std::vector<Blob*>& inputs,
       float timeout_secs = 0.0f);
+  // Reads up to inputs.size() records at once, one per vector of blobs.
+  // Blocks until at least one record is available, and returns the number of
+  // records read, or 0 if the queue was closed or the read timed out.
+  size_t blockingRead(
+      const std::vector<std::vector<Blob*>>& inputs,
+      float timeout_secs = 0.0f);
   bool tryWrite(const std::vector<Blob*>& inputs);
   bool blockingWrite(const std::vector<Blob*>& inputs);
   void close();
@@ -45,17 +58,47 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   }
 
  private:
+  struct Slot {
+    // 2 * p + 1 when the slot holds the record of position p, and 2 * p when
+    // it is free for the write of position p. Unlike p + 1 and p, this tells
+    // both states apart even if the queue has a single slot.
+    std::atomic<int64_t> sequence{0};
+    std::vector<Blob*> blobs;
+  };
+
+  // Reads up to `n` records into outputs(0), ..., outputs(n - 1)
+  template <typename Outputs>
+  size_t read(size_t n, const Outputs& outputs, float timeout_secs);
+  // Claims up to `n` records to read, or a slot to write. The records at
+  // [*first, *first + count) belong to the caller until it releases their
+  // slots. Returns the number of records claimed.
+  size_t tryClaimRead(size_t n, int64_t* first);
+  bool tryClaimWrite(int64_t* position);
+  bool canRead();
   bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
+  void doWrite(int64_t position, const std::vector<Blob*>& inputs);
+  Slot& slot(int64_t position) {
+    return queue_[position % queue_.size()];
+  }
+  // Wakes up blocked readers and writers, if any
+  void notify();
+  // Blocks until `ready` holds, the queue is closed or `deadline` (if
+  // `timeout`) passes. Returns false on timeout.
+  template <typename Ready>
+  bool wait(
+      const Ready& ready,
+      bool timeout,
+      std::chrono::steady_clock::time_point deadline);
 
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
-  std::mutex mutex_; // protects all variables in the class.
+  std::mutex mutex_; // protects waiting on cv_
   std::condition_variable cv_;
-  int64_t reader_{0};
-  int64_t writer_{0};
-  std::vector<std::vector<Blob*>> queue_;
+  std::atomic<int> waiters_{0};
+  std::atomic<int64_t> reader_{0};
+  std::atomic<int64_t> writer_{0};
+  std::vector<Slot> queue_;
   const std::string name_;
 
   struct QueueStats {
@@ -65,6 +108,11 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
     CAFFE_DETAILED_EXPORTED_STAT(queue_dequeued_bytes);
     CAFFE_AVG_EXPORTED_STAT(read_time_ns);
     CAFFE_AVG_EXPORTED_STAT(write_time_ns);
+    // Number of records in the queue, sampled on each read
+    CAFFE_AVG_EXPORTED_STAT(queue_fill_level);
+    // Time that reads and writes spent blocked on an empty or full queue
+    CAFFE_AVG_EXPORTED_STAT(read_wait_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(write_wait_time_ns);
   } stats_;
 };
 } // namespace caffe2
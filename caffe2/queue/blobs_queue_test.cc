@@ -0,0 +1,144 @@
+#include "caffe2/queue/blobs_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+void setValue(Blob* blob, int value) {
+  auto* tensor = BlobGetMutableTensor(blob, CPU);
+  tensor->Resize(1);
+  tensor->mutable_data<int>()[0] = value;
+}
+
+int getValue(const Blob& blob) {
+  return blob.Get<Tensor>().data<int>()[0];
+}
+
+} // namespace
+
+TEST(BlobsQueueTest, BatchedRead) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "batched", 4, 1, true);
+
+  Blob input;
+  for (int i = 0; i < 4; ++i) {
+    setValue(&input, i);
+    EXPECT_TRUE(queue->tryWrite({&input}));
+  }
+  // The queue is full
+  setValue(&input, 4);
+  EXPECT_FALSE(queue->tryWrite({&input}));
+
+  // Reads the records that are available, up to the number of outputs
+  std::vector<Blob> blobs(6);
+  std::vector<std::vector<Blob*>> outputs;
+  for (auto& blob : blobs) {
+    outputs.push_back({&blob});
+  }
+  EXPECT_EQ(queue->blockingRead(std::vector<std::vector<Blob*>>(
+                outputs.begin(), outputs.begin() + 3)),
+            3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(getValue(blobs[i]), i);
+  }
+  EXPECT_TRUE(queue->tryWrite({&input}));
+  EXPECT_EQ(queue->blockingRead(outputs), 2);
+  EXPECT_EQ(getValue(blobs[0]), 3);
+  EXPECT_EQ(getValue(blobs[1]), 4);
+
+  // A read of the closed, empty queue returns nothing
+  queue->close();
+  EXPECT_EQ(queue->blockingRead(outputs), 0);
+  EXPECT_FALSE(queue->blockingRead({&input}));
+}
+
+TEST(BlobsQueueTest, ReadTimeout) {
+  Workspace ws;
+  auto queue = std::make_shared<BlobsQueue>(&ws, "timeout", 2, 1, true);
+  Blob output;
+  EXPECT_FALSE(queue->blockingRead({&output}, 0.01));
+}
+
+void testConcurrentReadersAndWriters(size_t capacity) {
+  const int kNumWriters = 4;
+  const int kNumReaders = 4;
+  const int kRecordsPerWriter = 1000;
+  Workspace ws;
+  auto queue =
+      std::make_shared<BlobsQueue>(&ws, "concurrent", capacity, 1, true);
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kNumWriters; ++w) {
+    writers.emplace_back([&queue, w]() {
+      Blob input;
+      for (int i = 0; i < kRecordsPerWriter; ++i) {
+        setValue(&input, w * kRecordsPerWriter + i);
+        EXPECT_TRUE(queue->blockingWrite({&input}));
+      }
+    });
+  }
+
+  std::mutex mutex;
+  std::vector<int> times_read(kNumWriters * kRecordsPerWriter, 0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kNumReaders; ++r) {
+    readers.emplace_back([&, r]() {
+      // Reader r reads up to r + 1 records at once
+      std::vector<Blob> blobs(r + 1);
+      std::vector<std::vector<Blob*>> outputs;
+      for (auto& blob : blobs) {
+        outputs.push_back({&blob});
+      }
+      while (true) {
+        auto count = queue->blockingRead(outputs);
+        if (count == 0) {
+          return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < count; ++i) {
+          ++times_read[getValue(blobs[i])];
+        }
+      }
+    });
+  }
+
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  // Waits for the readers to drain the queue before closing it
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      int total = 0;
+      for (auto n : times_read) {
+        total += n;
+      }
+      if (total >= kNumWriters * kRecordsPerWriter) {
+        break;
+      }
+    }
+    std::this_thread::yield();
+  }
+  queue->close();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  for (auto n : times_read) {
+    EXPECT_EQ(n, 1);
+  }
+}
+
+TEST(BlobsQueueTest, ConcurrentReadersAndWriters) {
+  testConcurrentReadersAndWriters(8);
+}
+
+TEST(BlobsQueueTest, ConcurrentReadersAndWritersSingleSlot) {
+  testConcurrentReadersAndWriters(1);
+}
+
+} // namespace caffe2
@@ -130,43 +130,56 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
   bool dequeueMany(std::shared_ptr<BlobsQueue>& queue) {
     auto size = queue->getNumBlobs();
 
-    if (blobs_.size() != size) {
-      blobs_.resize(size);
-      blobPtrs_.resize(size);
-      for (int col = 0; col < size; ++col) {
-        blobPtrs_.at(col) = &blobs_.at(col);
+    if (blobs_.size() != numRecords_ || blobs_.front().size() != size) {
+      blobs_.resize(numRecords_);
+      blobPtrs_.resize(numRecords_);
+      for (int row = 0; row < numRecords_; ++row) {
+        blobs_.at(row).resize(size);
+        blobPtrs_.at(row).resize(size);
+        for (int col = 0; col < size; ++col) {
+          blobPtrs_.at(row).at(col) = &blobs_.at(row).at(col);
+        }
       }
     }
 
     const int kTensorGrowthPct = 40;
-    for (int i = 0; i < numRecords_; ++i) {
-      if (!queue->blockingRead(blobPtrs_)) {
+    int numRead = 0;
+    while (numRead < numRecords_) {
+      // Takes all the records that are available at once
+      size_t count = numRead == 0
+          ? queue->blockingRead(blobPtrs_)
+          : queue->blockingRead(std::vector<std::vector<Blob*>>(
+                blobPtrs_.begin() + numRead, blobPtrs_.end()));
+      if (count == 0) {
         // if we read at least one record, status is still true
-        return i > 0;
+        return numRead > 0;
       }
-      for (int col = 0; col < size; ++col) {
-        auto* out = this->Output(col);
-        const auto& in = blobPtrs_.at(col)->template Get<Tensor>();
-        if (i == 0) {
-          out->CopyFrom(in);
-        } else {
-          auto oldSize = out->numel();
-
-          CAFFE_ENFORCE(
-              in.dim() > 0,
-              "Empty tensor to dequeue at column ",
-              col,
-              " within ",
-              size,
-              " total columns");
-
-          out->Extend(in.sizes()[0], kTensorGrowthPct, &context_);
-          auto* dst =
-              (char*)out->raw_mutable_data() + oldSize * in.dtype().itemsize();
-          context_.template CopyItems<Context, Context>(
-              in.meta(), in.numel(), in.raw_data(), dst);
+      for (int i = numRead; i < numRead + count; ++i) {
+        for (int col = 0; col < size; ++col) {
+          auto* out = this->Output(col);
+          const auto& in = blobPtrs_.at(i).at(col)->template Get<Tensor>();
+          if (i == 0) {
+            out->CopyFrom(in);
+          } else {
+            auto oldSize = out->numel();
+
+            CAFFE_ENFORCE(
+                in.dim() > 0,
+                "Empty tensor to dequeue at column ",
+                col,
+                " within ",
+                size,
+                " total columns");
+
+            out->Extend(in.sizes()[0], kTensorGrowthPct, &context_);
+            auto* dst = (char*)out->raw_mutable_data() +
+                oldSize * in.dtype().itemsize();
+            context_.template CopyItems<Context, Context>(
+                in.meta(), in.numel(), in.raw_data(), dst);
+          }
         }
       }
+      numRead += count;
     }
     return true;
   }
@@ -194,8 +207,8 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
 
  private:
   int numRecords_;
-  std::vector<Blob> blobs_;
-  std::vector<Blob*> blobPtrs_;
+  std::vector<std::vector<Blob>> blobs_;
+  std::vector<std::vector<Blob*>> blobPtrs_;
 };
 
 template <typename Context>
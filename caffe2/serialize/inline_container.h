@@ -4,11 +4,19 @@
 #include <cstring>
 #include <cerrno>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <fstream>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <ATen/core/Allocator.h>
 #include <ATen/core/Backend.h>
+#include <TH/THAllocator.h>
 
 #include "caffe2/core/logging.h"
 
@@ -96,11 +104,46 @@ constexpr uint64_t kMaxSupportedFileFormatVersion = 0x2L;
 constexpr uint64_t kFileFormatVersion = 0x2L;
 constexpr char kPadValue = -17; // 0xEF
 
+// Context of the DataPtr of a record in a memory-mapped file, which keeps
+// the mapping alive as long as the record is used
+void deleteMappedRecord(void* ctx) {
+  delete static_cast<std::shared_ptr<at::DataPtr>*>(ctx);
+}
+
 }  // namespace
 
+// Maps the whole file into memory, read-only (pages written to through the
+// mapping are copied, and never written back to the file). Unmodified pages
+// are shared with the page cache, and so with all other processes mapping
+// the same file. Returns nullptr for an empty file.
+inline std::shared_ptr<at::DataPtr> mapPyTorchFile(const std::string& filename) {
+  std::ifstream in(filename, std::ios_base::binary | std::ios_base::ate);
+  AT_ASSERTM(in.good(), "Could not open PyTorch file ", filename);
+  const auto size = static_cast<size_t>(in.tellg());
+  if (size == 0) {
+    return nullptr;
+  }
+  size_t mapped_size = 0;
+  auto mapping = std::make_shared<at::DataPtr>(THMapAllocator::makeDataPtr(
+      filename.c_str(), /*flags=*/0, size, &mapped_size));
+  AT_ASSERTM(
+      mapping->get() != nullptr && mapped_size == size,
+      "Failed to map PyTorch file ",
+      filename,
+      " into memory");
+  return mapping;
+}
+
 class PyTorchStreamReader final {
  public:
-  PyTorchStreamReader(std::istream* in) : in_(in) {
+  // If `mapping` is given, it must hold the same bytes as `in`, e.g. be the
+  // result of mapPyTorchFile() for the file `in` reads. The records returned
+  // then point into the mapping instead of being read into new buffers, and
+  // `in` is only used to read the file header, footer and record headers.
+  PyTorchStreamReader(
+      std::istream* in,
+      std::shared_ptr<at::DataPtr> mapping = nullptr)
+      : in_(in), mapping_(std::move(mapping)) {
     // Store file size so we know when we're done reading because the f* APIs
     // don't do a good job of that
     in_->seekg(0L, in_->end);
@@ -147,10 +190,23 @@ class PyTorchStreamReader final {
         "Attempted to read a record of non-storage type");
     auto size = read64BitIntegerLittleEndian();
     seekToNextAlignmentBoundary();
-    auto* ptr = malloc(size);
-    at::DataPtr retval(ptr, ptr, free, at::kCPU);
-
-    in_->read(static_cast<char*>(ptr), size);
+    AT_ASSERTM(
+        size <= file_size_ - cursor_,
+        "Record size is larger than the rest of the file."
+        " Is this file corrupted?");
+    at::DataPtr retval;
+    if (mapping_) {
+      void* ptr = static_cast<char*>(mapping_->get()) + cursor_;
+      retval = at::DataPtr(
+          ptr,
+          new std::shared_ptr<at::DataPtr>(mapping_),
+          &deleteMappedRecord,
+          at::kCPU);
+    } else {
+      auto* ptr = malloc(size);
+      retval = at::DataPtr(ptr, ptr, free, at::kCPU);
+      in_->read(static_cast<char*>(ptr), size);
+    }
     cursor_ += size;
     seekToNextAlignmentBoundary();
     return std::tuple<at::DataPtr, size_t, size_t>(
@@ -169,6 +225,7 @@ class PyTorchStreamReader final {
 
  private:
   std::istream* in_;
+  std::shared_ptr<at::DataPtr> mapping_;
   size_t cursor_ = 0;
   size_t file_size_;
   size_t last_record_offset_;
@@ -242,6 +299,8 @@ class PyTorchStreamReader final {
 
 class PyTorchStreamWriter final {
  public:
+  // If `out` is nullptr, nothing is written, but the records are laid out
+  // (and their keys returned) as if they were.
   PyTorchStreamWriter(std::ostream* out) : out_(out) {
     writeFileHeader();
     // In the case that we do not write any records into this file, the last
@@ -261,6 +320,29 @@ class PyTorchStreamWriter final {
     return record_offset;
   }
 
+  // Lays out a record of `size` bytes like writeRecord(), but skips over its
+  // payload instead of writing it. The payload is to be written at
+  // getPayloadOffset(key) later, e.g. with a PyTorchFilePayloadWriter, so the
+  // payloads of many records can be written in parallel. Requires an output
+  // stream that can seek past its end, like a std::ofstream.
+  uint64_t reserveRecord(size_t size) {
+    AT_ASSERTM(!finalized_, "should not be finalized!");
+    uint64_t record_offset = cursor_;
+    last_record_idx_ = record_offset;
+    write64BitIntegerLittleEndian(RecordTags::STORAGE);
+    write64BitIntegerLittleEndian(size);
+    padToNextAlignmentBoundary();
+    skipBuffer(size);
+    padToNextAlignmentBoundary();
+    return record_offset;
+  }
+
+  // The offset of the payload of the record with the given key in the file.
+  static uint64_t getPayloadOffset(uint64_t key) {
+    // The record header is padded to a full alignment boundary
+    return key + kFieldAlignment;
+  }
+
   void writeEndOfFile() {
     AT_ASSERTM(!finalized_, "cannot finalize again!");
     writeFileFooter();
@@ -290,14 +372,18 @@ class PyTorchStreamWriter final {
   // Utility functions
   void write64BitIntegerLittleEndian(const uint64_t value) {
     // TODO endian swap on platforms that need it?
-    out_->write(reinterpret_cast<const char*>(&value), 8);
+    if (out_) {
+      out_->write(reinterpret_cast<const char*>(&value), 8);
+    }
     cursor_ += 8u;
   }
 
   void writePad(const size_t num_bytes) {
     // TODO: move this buffer to the .cc file
     static std::vector<char> pad_buffer_(kFieldAlignment, kPadValue);
-    out_->write(pad_buffer_.data(), num_bytes);
+    if (out_) {
+      out_->write(pad_buffer_.data(), num_bytes);
+    }
     cursor_ += num_bytes;
   }
 
@@ -309,7 +395,17 @@ class PyTorchStreamWriter final {
   }
 
   void writeBuffer(const void* data, size_t size) {
-    out_->write(static_cast<const char*>(data), size);
+    if (out_) {
+      out_->write(static_cast<const char*>(data), size);
+    }
+    cursor_ += size;
+  }
+
+  void skipBuffer(size_t size) {
+    if (out_) {
+      out_->seekp(static_cast<std::streamoff>(size), std::ios_base::cur);
+      AT_ASSERTM(out_->good(), "cannot skip over a record in this stream");
+    }
     cursor_ += size;
   }
 
@@ -327,10 +423,13 @@ class PyTorchStreamWriter final {
   }
 };
 
+// Reads a PyTorch file through a memory mapping of it, so the records it
+// returns share the mapped pages instead of being copied.
 class PyTorchFileReader final {
  public:
   PyTorchFileReader(const std::string& filename)
-      : in_(filename, std::ios_base::binary), stream_reader_(&in_) {}
+      : in_(filename, std::ios_base::binary),
+        stream_reader_(&in_, mapPyTorchFile(filename)) {}
 
   bool hasNextRecord() const {
     return stream_reader_.hasNextRecord();
@@ -354,10 +453,85 @@ class PyTorchFileReader final {
   PyTorchStreamReader stream_reader_;
 };
 
+// Writes the payloads of records reserved with
+// PyTorchStreamWriter::reserveRecord() directly into a PyTorch file, at their
+// final offsets. The file must exist already. write() may be called from
+// several threads at once for different records.
+class PyTorchFilePayloadWriter final {
+ public:
+  PyTorchFilePayloadWriter(const std::string& filename)
+#ifdef _WIN32
+      : out_(filename, std::ios_base::binary | std::ios_base::in |
+                 std::ios_base::out) {
+    AT_ASSERTM(out_.good(), "Could not open PyTorch file ", filename);
+  }
+#else
+      : fd_(open(filename.c_str(), O_WRONLY)) {
+    AT_ASSERTM(
+        fd_ >= 0,
+        "Could not open PyTorch file ",
+        filename,
+        ": ",
+        std::strerror(errno));
+  }
+#endif
+
+  PyTorchFilePayloadWriter(const PyTorchFilePayloadWriter&) = delete;
+  PyTorchFilePayloadWriter& operator=(const PyTorchFilePayloadWriter&) =
+      delete;
+
+  // Writes the `size` bytes of payload of the record with the given key.
+  void write(uint64_t key, const void* data, size_t size) {
+    const uint64_t offset = PyTorchStreamWriter::getPayloadOffset(key);
+#ifdef _WIN32
+    // No positioned writes, so the writes of all threads are serialized
+    std::lock_guard<std::mutex> guard(mutex_);
+    out_.seekp(static_cast<std::streamoff>(offset));
+    out_.write(static_cast<const char*>(data), size);
+    out_.flush();
+    AT_ASSERTM(out_.good(), "Failed to write the record at ", key);
+#else
+    const char* buffer = static_cast<const char*>(data);
+    size_t written = 0;
+    while (written < size) {
+      // pwrite may write less than asked for (e.g. above 2 GB on Linux)
+      const ssize_t result =
+          pwrite(fd_, buffer + written, size - written, offset + written);
+      if (result < 0 && errno == EINTR) {
+        continue;
+      }
+      AT_ASSERTM(
+          result > 0,
+          "Failed to write the record at ",
+          key,
+          ": ",
+          std::strerror(errno));
+      written += static_cast<size_t>(result);
+    }
+#endif
+  }
+
+  ~PyTorchFilePayloadWriter() {
+#ifndef _WIN32
+    close(fd_);
+#endif
+  }
+
+ private:
+#ifdef _WIN32
+  std::mutex mutex_;
+  std::fstream out_;
+#else
+  int fd_;
+#endif
+};
+
 class PyTorchFileWriter final {
  public:
   PyTorchFileWriter(const std::string& filename)
-      : out_(filename, std::ios_base::binary), stream_writer_(&out_) {}
+      : out_(filename, std::ios_base::binary),
+        stream_writer_(&out_),
+        payload_writer_(filename) {}
 
   uint64_t writeRecord(const void* data, size_t size) {
     AT_ASSERTM(
@@ -366,6 +540,21 @@ class PyTorchFileWriter final {
     return stream_writer_.writeRecord(data, size);
   }
 
+  // Lays out a record of `size` bytes, whose payload is written with
+  // writeReservedRecord() later.
+  uint64_t reserveRecord(size_t size) {
+    AT_ASSERTM(
+        !stream_writer_.finalized(),
+        "cannot write to a finalized stream writer.");
+    return stream_writer_.reserveRecord(size);
+  }
+
+  // Writes the payload of a record returned by reserveRecord(). May be called
+  // from several threads at once, also after writeEndOfFile().
+  void writeReservedRecord(uint64_t key, const void* data, size_t size) {
+    payload_writer_.write(key, data, size);
+  }
+
   void writeEndOfFile() {
     AT_ASSERTM(
         !stream_writer_.finalized(),
@@ -393,5 +582,6 @@ class PyTorchFileWriter final {
  private:
   std::ofstream out_;
   PyTorchStreamWriter stream_writer_;
+  PyTorchFilePayloadWriter payload_writer_;
 };
 }}  // namespace torch::jit
@@ -1,6 +1,10 @@
 #include <cstdio>
 #include <string>
 #include <array>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -70,5 +74,94 @@ TEST(PyTorchFileWriterAndReader, SaveAndLoad) {
   std::remove(tmp_name.c_str());
 }
 
+TEST(PyTorchFileWriterAndReader, RecordsPointIntoFileMapping) {
+  int64_t kFieldAlignment = 64L;
+  std::string tmp_name = std::tmpnam(nullptr);
+
+  std::array<char, 100> data;
+  for (int i = 0; i < data.size(); ++i) {
+    data[i] = i;
+  }
+  uint64_t key;
+  {
+    torch::jit::PyTorchFileWriter writer{tmp_name};
+    key = writer.writeRecord(data.data(), data.size());
+    writer.writeEndOfFile();
+  }
+
+  auto mapping = torch::jit::mapPyTorchFile(tmp_name);
+  ASSERT_NE(mapping, nullptr);
+  at::DataPtr data_ptr;
+  size_t size;
+  {
+    std::ifstream in(tmp_name, std::ios_base::binary);
+    torch::jit::PyTorchStreamReader reader(&in, mapping);
+    std::tie(data_ptr, size) = reader.getRecordWithKey(key);
+  }
+  ASSERT_EQ(size, data.size());
+  ASSERT_EQ(
+      static_cast<char*>(data_ptr.get()),
+      static_cast<char*>(mapping->get()) + key + kFieldAlignment);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(data_ptr.get()) % kFieldAlignment, 0);
+
+  // The record keeps the mapping alive after the reader and the mapping are
+  // gone
+  mapping.reset();
+  std::remove(tmp_name.c_str());
+  ASSERT_EQ(memcmp(data_ptr.get(), data.data(), data.size()), 0);
+}
+
+TEST(PyTorchFileWriterAndReader, WritesReservedRecordsInParallel) {
+  std::string tmp_name = std::tmpnam(nullptr);
+
+  // sizes on, below and above an alignment boundary, and an empty record
+  std::vector<std::vector<char>> records;
+  for (size_t size : {64, 1000, 1, 0, 4096 + 3}) {
+    records.emplace_back(size);
+    for (size_t i = 0; i < size; ++i) {
+      records.back()[i] = static_cast<char>(records.size() * 31 + i);
+    }
+  }
+  std::vector<uint64_t> keys;
+  {
+    torch::jit::PyTorchFileWriter writer{tmp_name};
+    for (const auto& record : records) {
+      keys.push_back(writer.reserveRecord(record.size()));
+    }
+    // a record written directly after the reserved ones
+    const char last[] = "last";
+    writer.writeRecord(last, sizeof(last));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < records.size(); ++i) {
+      threads.emplace_back([&, i] {
+        writer.writeReservedRecord(keys[i], records[i].data(), records[i].size());
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    writer.writeEndOfFile();
+  }
+
+  // the layout is the same as if the records were written one by one
+  torch::jit::PyTorchFileReader reader{tmp_name};
+  at::DataPtr data_ptr;
+  int64_t key;
+  int64_t size;
+  for (size_t i = 0; i < records.size(); ++i) {
+    ASSERT_TRUE(reader.hasNextRecord());
+    std::tie(data_ptr, key, size) = reader.getNextRecord();
+    ASSERT_EQ(key, keys[i]);
+    ASSERT_EQ(size, records[i].size());
+    ASSERT_EQ(memcmp(data_ptr.get(), records[i].data(), size), 0);
+  }
+  size_t last_size;
+  std::tie(data_ptr, last_size) = reader.getLastRecord();
+  ASSERT_EQ(last_size, 5);
+  ASSERT_EQ(memcmp(data_ptr.get(), "last", 5), 0);
+
+  std::remove(tmp_name.c_str());
+}
+
 } // namespace
 } // namespace at
@@ -2,6 +2,38 @@
 
 namespace caffe2 {
 
+namespace {
+constexpr size_t kNumSparseRowLocks = 4096;
+
+struct alignas(64) PaddedRowLock {
+  std::atomic<bool> locked;
+};
+
+// Zero-initialized, i.e. unlocked, as a static
+PaddedRowLock sparse_row_locks[kNumSparseRowLocks];
+} // namespace
+
+SparseRowLock::SparseRowLock(const void* row) : lock_(nullptr) {
+  if (row == nullptr) {
+    return;
+  }
+  // Rows are at least a few floats apart, hash their addresses by cache line
+  const uint64_t line = reinterpret_cast<uintptr_t>(row) / 64;
+  lock_ = &sparse_row_locks[(line * 0x9E3779B97F4A7C15ULL >> 32) %
+                            kNumSparseRowLocks]
+               .locked;
+  while (lock_->exchange(true, std::memory_order_acquire)) {
+    while (lock_->load(std::memory_order_relaxed)) {
+    }
+  }
+}
+
+SparseRowLock::~SparseRowLock() {
+  if (lock_ != nullptr) {
+    lock_->store(false, std::memory_order_release);
+  }
+}
+
 REGISTER_CPU_OPERATOR(Adagrad, AdagradOp<float, CPUContext>);
 OPERATOR_SCHEMA(Adagrad)
     .NumInputs(4)
@@ -84,6 +116,17 @@ new_moment) as in the dense case.
     .Output(0, "output_param", "Updated parameters")
     .Output(1, "output_moment_1", "Updated moment")
     .Arg("epsilon", "Default 1e-5")
+    .Arg(
+        "use_thread_pool",
+        "Default false. Split the rows across the threads of the workspace's "
+        "thread pool.")
+    .Arg(
+        "consistency",
+        "Default \"hogwild\". How concurrent updates of a row are ordered: "
+        "\"hogwild\" doesn't order them, \"row_lock\" serializes them with "
+        "per-row spinlocks, also across operators updating the same "
+        "parameters, and \"owner_computes\" has each thread of the operator "
+        "update its own rows in the order of the indices.")
     .CostInferenceFunction(
         OpSchema::CostInferenceFunctionType(CostInferenceForSparseAdagrad));
 
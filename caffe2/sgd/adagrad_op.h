@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <exception>
+#include <vector>
+
 #include "caffe2/core/operator.h"
 #include "caffe2/perfkernels/adagrad.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
 
 namespace caffe2 {
 
@@ -149,13 +154,43 @@ class AdagradOp final : public Operator<Context> {
       OUTPUT_UPDATE);
 };
 
+// Spinlocks serializing the updates of the rows of sparse parameters, shared
+// by all the operators of the process. The rows are hashed on their address,
+// so that two updates of a row lock the same spinlock. Nothing is locked if
+// row is null.
+class CAFFE2_API SparseRowLock {
+ public:
+  explicit SparseRowLock(const void* row);
+  ~SparseRowLock();
+
+ private:
+  std::atomic<bool>* lock_;
+
+  C10_DISABLE_COPY_AND_ASSIGN(SparseRowLock);
+};
+
 template <typename T, class Context>
 class SparseAdagradOp final : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   SparseAdagradOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
-        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)),
+        use_thread_pool_(
+            this->template GetSingleArgument<bool>("use_thread_pool", false)),
+        ws_(ws) {
+    const auto consistency = this->template GetSingleArgument<std::string>(
+        "consistency", "hogwild");
+    if (consistency == "hogwild") {
+      consistency_ = Consistency::HOGWILD;
+    } else if (consistency == "row_lock") {
+      consistency_ = Consistency::ROW_LOCK;
+    } else if (consistency == "owner_computes") {
+      consistency_ = Consistency::OWNER_COMPUTES;
+    } else {
+      CAFFE_THROW("Unknown consistency mode: ", consistency);
+    }
+  }
 
   bool RunOnDevice() override {
     // Enforce shapes
@@ -185,8 +220,11 @@ class SparseAdagradOp final : public Operator<Context> {
     }
 
     auto block_size = Input(GRAD).numel() / n;
-    for (auto i = 0; i < n; ++i) {
+    auto update_row = [&](int64_t i) {
       auto idx = indices[i];
+      SparseRowLock lock(
+          consistency_ == Consistency::ROW_LOCK ? paramOut + idx * block_size
+                                                : nullptr);
       if (block_size == 1) {
         float gi = gradIn[i];
         float hi = momentOut[idx] = momentIn[idx] + gi * gi;
@@ -227,12 +265,70 @@ class SparseAdagradOp final : public Operator<Context> {
             lr,
             &context_);
       }
+    };
+
+    ThreadPool* pool = use_thread_pool_ ? ws_->GetThreadPool() : nullptr;
+    const int64_t num_threads = pool == nullptr
+        ? 1
+        : std::min<int64_t>(pool->getNumThreads(), n / kMinRowsPerThread);
+    if (num_threads <= 1) {
+      for (auto i = 0; i < n; ++i) {
+        update_row(i);
+      }
+      return true;
+    }
+
+    // Exceptions can't leave the worker threads
+    std::vector<std::exception_ptr> errors(num_threads);
+    pool->run(
+        [&](int /* unused */, size_t thread) {
+          try {
+            if (consistency_ == Consistency::OWNER_COMPUTES) {
+              // Each row is only updated by one thread, in the order of the
+              // indices
+              for (auto i = 0; i < n; ++i) {
+                if (static_cast<size_t>(indices[i] % num_threads) == thread) {
+                  update_row(i);
+                }
+              }
+            } else {
+              const int64_t begin = n * thread / num_threads;
+              const int64_t end = n * (thread + 1) / num_threads;
+              for (auto i = begin; i < end; ++i) {
+                update_row(i);
+              }
+            }
+          } catch (...) {
+            errors[thread] = std::current_exception();
+          }
+        },
+        num_threads);
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
     }
     return true;
   }
 
  protected:
+  // How the concurrent updates of a row are ordered, when several threads
+  // update the rows of an operator (use_thread_pool) or several operators
+  // update the same parameters:
+  //  - HOGWILD doesn't order them, updates of the same row may be lost.
+  //  - ROW_LOCK serializes the updates of each row, also across operators.
+  //  - OWNER_COMPUTES has the threads of the operator each update a disjoint
+  //    set of rows, in the order of the indices, which gives the same result
+  //    as a serial update. It doesn't order the updates across operators.
+  enum class Consistency { HOGWILD, ROW_LOCK, OWNER_COMPUTES };
+
+  // Threads updating fewer rows than this aren't worth the dispatch
+  static constexpr int64_t kMinRowsPerThread = 256;
+
   T epsilon_;
+  bool use_thread_pool_;
+  Consistency consistency_;
+  Workspace* ws_;
   INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR);
   OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
 };
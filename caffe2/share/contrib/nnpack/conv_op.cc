@@ -1,5 +1,8 @@
 
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
 
 #include "caffe2/core/common.h"
 
@@ -7,10 +10,12 @@
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
 #include "caffe2/operators/conv_op_shared.h"
 #include "caffe2/operators/conv_pool_op_base.h"
 
 #include "caffe2/utils/math.h"
+#include "caffe2/utils/prepack_cache.h"
 #include "nnpack.h"
 
 C10_DEFINE_bool(caffe2_profile_nnpack, false, "");
@@ -34,8 +39,14 @@ class NNPACKConvOp final : public ConvPoolOpBase<CPUContext> {
   NNPACKConvOp(const OperatorDef& operator_def, Workspace* ws)
       : ConvPoolOpBase<CPUContext>(operator_def, ws),
         algorithm_(getConvolutionAlgorithm()),
+        tuneAlgorithm_(
+            OperatorBase::GetSingleArgument<std::string>("algo", "") ==
+            "TUNE"),
         activation_(getActivationType()),
         transformStrategy_(getConvolutionTransformStrategy()),
+        precomputeKernels_(
+            transformStrategy_ ==
+            nnp_convolution_transform_strategy_precompute),
         ws_(ws) {
     OPERATOR_NEEDS_FEATURE(
         this->order_ == StorageOrder::NCHW,
@@ -59,17 +70,45 @@ class NNPACKConvOp final : public ConvPoolOpBase<CPUContext> {
   nnp_convolution_algorithm getConvolutionAlgorithm() const;
   nnp_convolution_transform_strategy getConvolutionTransformStrategy() const;
   nnp_activation getActivationType() const;
-
-  const nnp_convolution_algorithm algorithm_;
+  nnp_convolution_algorithm getTunedAlgorithm(
+      const std::string& shape,
+      size_t input_channels,
+      size_t output_channels,
+      nnp_size input_size,
+      nnp_padding padding,
+      nnp_size kernel_size,
+      nnp_size output_subsample,
+      const float* input,
+      const float* filter,
+      const float* bias,
+      float* output,
+      Tensor* buffer,
+      pthreadpool_t pool);
+
+  // Changed to the fastest algorithm for the shapes of the inputs when
+  // tuneAlgorithm_
+  nnp_convolution_algorithm algorithm_;
+  const bool tuneAlgorithm_;
+  // The shapes algorithm_ was tuned for
+  std::string tunedShape_;
   const nnp_activation activation_;
   // Modified after precomputing the kernels. State transitions are:
   // - precompute -> (first call to Run()) -> reuse (on successful precompute)
   //                                       -> compute (on failing precompute)
   // - compute
+  // and back to precompute from either when the filter, the shapes or the
+  // algorithm the kernels were precomputed for change.
   nnp_convolution_transform_strategy transformStrategy_;
+  const bool precomputeKernels_;
   Workspace* ws_;
-  // Per-group transformed filters
-  std::vector<TensorCPU*> transformedFilters_;
+  // Per-group transformed filters, shared by the operators transforming the
+  // same filters with the same parameters
+  std::vector<std::shared_ptr<TensorCPU>> transformedFilters_;
+  // The algorithm and shapes, and the filter, the kernels were precomputed
+  // for. A filter overwritten in place, in the same buffer and with the same
+  // shape, isn't detected.
+  std::string transformedParams_;
+  const float* transformedFilter_{nullptr};
   // Zero-filled bias for convolutions without bias
   // This may be needed because NNPACK interface always expects conv with bias
   std::vector<float> dummyBias_;
@@ -99,6 +138,10 @@ nnp_convolution_algorithm NNPACKConvOp::getConvolutionAlgorithm() const {
   if (algo == "AUTO") {
     return nnp_convolution_algorithm_auto;
   }
+  if (algo == "TUNE") {
+    // Until the first run times the algorithms for the shapes of the inputs
+    return nnp_convolution_algorithm_auto;
+  }
   if (algo == "WINOGRAD") {
     return nnp_convolution_algorithm_wt8x8;
   }
@@ -144,10 +187,93 @@ NNPACKConvOp::getActivationType() const {
   }
 }
 
-bool NNPACKConvOp::RunOnDeviceWithOrderNCHW() {
-  /* Global variable with a unique ID of the pre-transformed kernel blob */
-  volatile static uint32_t precomputed_transform_id = 0;
+// Times the algorithms NNPACK supports for the shape, computing the first
+// group of the first image, and returns the fastest. The choice is made once
+// per shape for all the operators, as the time of a convolution doesn't
+// depend on its data. The kernels are transformed on every run, so the
+// choice may underrate transforms that precomputed kernels make free.
+nnp_convolution_algorithm NNPACKConvOp::getTunedAlgorithm(
+    const std::string& shape,
+    size_t input_channels,
+    size_t output_channels,
+    nnp_size input_size,
+    nnp_padding padding,
+    nnp_size kernel_size,
+    nnp_size output_subsample,
+    const float* input,
+    const float* filter,
+    const float* bias,
+    float* output,
+    Tensor* buffer,
+    pthreadpool_t pool) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, nnp_convolution_algorithm> tuned;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = tuned.find(shape);
+  if (it != tuned.end()) {
+    return it->second;
+  }
+
+  constexpr int kTimedRuns = 3;
+  nnp_convolution_algorithm fastest = nnp_convolution_algorithm_auto;
+  float fastestTime = std::numeric_limits<float>::infinity();
+  for (const auto algorithm : {nnp_convolution_algorithm_wt8x8,
+                               nnp_convolution_algorithm_ft8x8,
+                               nnp_convolution_algorithm_ft16x16,
+                               nnp_convolution_algorithm_implicit_gemm,
+                               nnp_convolution_algorithm_direct}) {
+    size_t workspaceSize = 0;
+    auto run = [&](void* workspace) {
+      return nnp_convolution_inference(
+          algorithm,
+          nnp_convolution_transform_strategy_compute,
+          input_channels,
+          output_channels,
+          input_size,
+          padding,
+          kernel_size,
+          output_subsample,
+          workspace ? input : nullptr,
+          workspace ? filter : nullptr,
+          workspace ? bias : nullptr,
+          workspace ? output : nullptr,
+          workspace,
+          &workspaceSize,
+          activation_,
+          nullptr /* activation parameter */,
+          pool,
+          nullptr /* profile */);
+    };
+    // Query the workspace size, which fails for unsupported algorithms
+    if (run(nullptr) != nnp_status_success) {
+      continue;
+    }
+    buffer->Resize(
+        std::max<size_t>(1, (workspaceSize + sizeof(float) - 1) / sizeof(float)));
+    workspaceSize = buffer->nbytes();
+    void* workspace = buffer->template mutable_data<float>();
+    if (run(workspace) != nnp_status_success) {
+      continue;
+    }
+    float time = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < kTimedRuns; ++i) {
+      Timer timer;
+      run(workspace);
+      time = std::min(time, timer.MicroSeconds());
+    }
+    VLOG(1) << "NNPACK algorithm " << algorithm << " takes " << time
+            << "us for " << shape;
+    if (time < fastestTime) {
+      fastest = algorithm;
+      fastestTime = time;
+    }
+  }
+  VLOG(1) << "Using NNPACK algorithm " << fastest << " for " << shape;
+  tuned.emplace(shape, fastest);
+  return fastest;
+}
 
+bool NNPACKConvOp::RunOnDeviceWithOrderNCHW() {
   auto& X = Input(0);
   auto& filter = Input(1);
   auto* Y = Output(0);
@@ -197,7 +323,62 @@ bool NNPACKConvOp::RunOnDeviceWithOrderNCHW() {
   initNNPACK();
   pthreadpool_t pool = reinterpret_cast<pthreadpool_t>(ws_->GetThreadPool());
 
+  // Everything but the filter and the algorithm that the convolution
+  // depends on
+  const std::string shape = c10::str(
+      C / group_,
+      ",",
+      M / group_,
+      ",",
+      input_size.height,
+      "x",
+      input_size.width,
+      ",",
+      padding.top,
+      ",",
+      padding.right,
+      ",",
+      padding.bottom,
+      ",",
+      padding.left,
+      ",",
+      kernel_size.height,
+      "x",
+      kernel_size.width,
+      ",",
+      output_subsample.height,
+      "x",
+      output_subsample.width);
+
   runWithSharedBuffer<CPUContext>(ws_, [&](Tensor* buffer) {
+    if (tuneAlgorithm_ && shape != tunedShape_) {
+      algorithm_ = getTunedAlgorithm(
+          shape,
+          C / group_,
+          M / group_,
+          input_size,
+          padding,
+          kernel_size,
+          output_subsample,
+          X.template data<float>(),
+          filter.template data<float>(),
+          biasData,
+          Y->template mutable_data<float>(),
+          buffer,
+          pool);
+      tunedShape_ = shape;
+    }
+
+    if (precomputeKernels_) {
+      const std::string params = c10::str(algorithm_, ",", shape);
+      if (params != transformedParams_ ||
+          filter.template data<float>() != transformedFilter_) {
+        transformStrategy_ = nnp_convolution_transform_strategy_precompute;
+        transformedParams_ = params;
+        transformedFilter_ = filter.template data<float>();
+      }
+    }
+
     if (transformStrategy_ == nnp_convolution_transform_strategy_precompute) {
       transformedFilters_.resize(group_);
 
@@ -231,37 +412,41 @@ bool NNPACKConvOp::RunOnDeviceWithOrderNCHW() {
             (transformedFilterSize + sizeof(float) - 1) / sizeof(float);
 
         for (auto g = 0; g < group_; g++) {
-          transformedFilters_[g] = BlobGetMutableTensor(
-              ws_->CreateBlob(
-                  "__transformed_kernel_" +
-                  to_string(
-                      __sync_fetch_and_add(&precomputed_transform_id, 1))),
-              CPU);
-          transformedFilters_[g]->Resize(transformedFilterElements);
-
-          status = nnp_convolution_inference(
-              algorithm_,
-              nnp_convolution_transform_strategy_precompute,
-              C / group_,
-              M / group_,
-              input_size,
-              padding,
-              kernel_size,
-              output_subsample,
-              nullptr /* input */,
-              filter.template data<float>() + filter.size() / group_ * g,
-              nullptr /* bias */,
-              nullptr /* output */,
-              static_cast<void*>(
-                  transformedFilters_[g]->template mutable_data<float>()),
-              &transformedFilterSize,
-              nnp_activation_identity,
-              nullptr /* activation parameter */,
-              pool,
-              nullptr /* profile */);
-          CAFFE_ENFORCE(
-              nnp_status_success == status,
-              "NNPACK convolution filter pre-transformation return error");
+          const float* groupFilter =
+              filter.template data<float>() + filter.size() / group_ * g;
+          transformedFilters_[g] = PrepackCache<TensorCPU>::Get().GetOrCreate(
+              transformedParams_,
+              groupFilter,
+              filter.nbytes() / group_,
+              [&]() {
+                std::unique_ptr<TensorCPU> transformed(new TensorCPU(CPU));
+                transformed->Resize(transformedFilterElements);
+                size_t transformedSize = transformedFilterSize;
+                nnp_status status = nnp_convolution_inference(
+                    algorithm_,
+                    nnp_convolution_transform_strategy_precompute,
+                    C / group_,
+                    M / group_,
+                    input_size,
+                    padding,
+                    kernel_size,
+                    output_subsample,
+                    nullptr /* input */,
+                    groupFilter,
+                    nullptr /* bias */,
+                    nullptr /* output */,
+                    static_cast<void*>(
+                        transformed->template mutable_data<float>()),
+                    &transformedSize,
+                    nnp_activation_identity,
+                    nullptr /* activation parameter */,
+                    pool,
+                    nullptr /* profile */);
+                CAFFE_ENFORCE(
+                    nnp_status_success == status,
+                    "NNPACK convolution filter pre-transformation return error");
+                return transformed;
+              });
         }
 
         /*
@@ -358,6 +358,40 @@ TEST(NNPACK, Conv_NxNs_grouped_precompute) {
   }
 }
 
+TEST(NNPACK, Conv_NxNs_tune) {
+  for (int i = 0; i < kIters; ++i) {
+    int group = randInt(1, 2);
+    int kernel = randInt(1, 5);
+    runConv(
+        kernel,
+        kernel,
+        1,
+        1,
+        group,
+        "TUNE",
+        group * randInt(1, 6),
+        group * randInt(1, 6));
+  }
+}
+
+TEST(NNPACK, Conv_NxNs_tune_precompute) {
+  for (int i = 0; i < kIters; ++i) {
+    int group = randInt(1, 2);
+    int kernel = randInt(1, 5);
+    runConv(
+        kernel,
+        kernel,
+        1,
+        1,
+        group,
+        "TUNE",
+        group * randInt(1, 6),
+        group * randInt(1, 6),
+        1,
+        "PRECOMPUTE");
+  }
+}
+
 TEST(NNPACK, Conv_NxNsW) {
   for (int i = 0; i < 3; ++i) {
     int kernel = randInt(3, 5);
@@ -0,0 +1,21 @@
+#include "caffe2/utils/prepack_cache.h"
+
+#include <limits>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/utils/murmur_hash3.h"
+
+namespace caffe2 {
+
+ContentFingerprint ContentFingerprint::Of(const void* data, size_t nbytes) {
+  CAFFE_ENFORCE_LE(
+      nbytes,
+      std::numeric_limits<int>::max(),
+      "Can't fingerprint buffers of 2GB or more");
+  ContentFingerprint fingerprint;
+  fingerprint.size = nbytes;
+  MurmurHash3_x64_128(data, static_cast<int>(nbytes), 0, fingerprint.hash);
+  return fingerprint;
+}
+
+} // namespace caffe2
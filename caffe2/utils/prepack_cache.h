@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * Identifies the contents of a buffer by its size and 128-bit MurmurHash3.
+ */
+struct CAFFE2_API ContentFingerprint {
+  uint64_t size;
+  uint64_t hash[2];
+
+  static ContentFingerprint Of(const void* data, size_t nbytes);
+
+  bool operator<(const ContentFingerprint& other) const {
+    return std::tie(size, hash[0], hash[1]) <
+        std::tie(other.size, other.hash[0], other.hash[1]);
+  }
+};
+
+/**
+ * A process-wide cache of prepacked weights, e.g. of the fbgemm packed
+ * matrices or the NNPACK transformed kernels of FC and Conv operators.
+ *
+ * Operators of any net, in any workspace, that pack the same weights with the
+ * same parameters share a single copy. The entries are keyed on the contents
+ * of the weights rather than on their blob, so that the copies of shared
+ * weights that each net loads, e.g. several variants of a model with the same
+ * backbone, hit the cache too.
+ *
+ * The cache only holds weak references: packed weights are freed along with
+ * the last operator using them.
+ */
+template <typename T>
+class PrepackCache {
+ public:
+  static PrepackCache& Get() {
+    static PrepackCache cache;
+    return cache;
+  }
+
+  /**
+   * Returns the packing of the nbytes of weights at data with the given
+   * parameters, calling pack to create it if it isn't cached. params must
+   * identify everything but the weights that the packing depends on.
+   */
+  std::shared_ptr<T> GetOrCreate(
+      const std::string& params,
+      const void* data,
+      size_t nbytes,
+      const std::function<std::unique_ptr<T>()>& pack) {
+    const Key key(params, ContentFingerprint::Of(data, nbytes));
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      if (auto packed = it->second.lock()) {
+        return packed;
+      }
+    }
+    // Drop the entries of the weights that aren't used anymore
+    for (auto entry = entries_.begin(); entry != entries_.end();) {
+      if (entry->second.expired()) {
+        entry = entries_.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+    std::shared_ptr<T> packed(pack());
+    entries_[key] = packed;
+    return packed;
+  }
+
+  /**
+   * The number of packed weights in use.
+   */
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& entry : entries_) {
+      count += !entry.second.expired();
+    }
+    return count;
+  }
+
+ private:
+  using Key = std::pair<std::string, ContentFingerprint>;
+
+  PrepackCache() {}
+
+  std::mutex mutex_;
+  std::map<Key, std::weak_ptr<T>> entries_;
+};
+
+} // namespace caffe2
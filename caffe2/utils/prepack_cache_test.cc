@@ -0,0 +1,50 @@
+#include "caffe2/utils/prepack_cache.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+struct Packed {
+  std::vector<float> data;
+};
+
+std::shared_ptr<Packed> pack(
+    const std::vector<float>& weights,
+    const std::string& params,
+    int* count) {
+  return PrepackCache<Packed>::Get().GetOrCreate(
+      params, weights.data(), weights.size() * sizeof(float), [&]() {
+        ++*count;
+        return std::unique_ptr<Packed>(new Packed{weights});
+      });
+}
+
+} // namespace
+
+TEST(PrepackCacheTest, ShareByContent) {
+  int count = 0;
+  // Copies of the same weights, e.g. loaded by two nets
+  const std::vector<float> weights = {1, 2, 3, 4};
+  const std::vector<float> copy = weights;
+  auto packed = pack(weights, "2x2", &count);
+  EXPECT_EQ(pack(copy, "2x2", &count), packed);
+  EXPECT_EQ(count, 1);
+
+  // Other parameters or other weights
+  EXPECT_NE(pack(weights, "4x1", &count), packed);
+  EXPECT_NE(pack({1, 2, 3, 5}, "2x2", &count), packed);
+  EXPECT_EQ(count, 3);
+
+  // The packed weights are freed with their last user
+  const size_t size = PrepackCache<Packed>::Get().size();
+  packed.reset();
+  EXPECT_EQ(PrepackCache<Packed>::Get().size(), size - 1);
+  pack(weights, "2x2", &count);
+  EXPECT_EQ(count, 4);
+}
+
+} // namespace caffe2
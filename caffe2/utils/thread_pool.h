@@ -8,6 +8,7 @@
 #include <thread>
 #include <utility>
 
+#include "c10/util/TraceContext.h"
 #include "caffe2/core/numa.h"
 #include "caffe2/utils/thread_name.h"
 
@@ -86,13 +87,16 @@ class CAFFE2_API TaskThreadPool : public TaskThreadPoolBase {
   }
 
   /// @brief Add task to the thread pool if a thread is currently available.
+  /// The task runs with the trace context of the caller.
   template <typename Task>
   void runTask(Task task) {
+    auto func =
+        c10::withCurrentTraceContext(static_cast<std::function<void()>>(task));
     std::unique_lock<std::mutex> lock(mutex_);
 
     // Set task and signal condition variable so that a worker thread will
     // wake up and use the task.
-    tasks_.push(task_element_t(static_cast<std::function<void()>>(task)));
+    tasks_.push(task_element_t(func));
     complete_ = false;
     condition_.notify_one();
   }
@@ -4,6 +4,13 @@
 
 #include <cpuinfo.h>
 
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+#include <ATen/Parallel.h>
+#endif
+
+#include <fstream>
+#include <sstream>
+
 C10_DEFINE_bool(
     caffe2_threadpool_force_inline,
     false,
@@ -15,13 +22,60 @@ C10_DEFINE_int(caffe2_threadpool_android_cap, true, "");
 // Whether or not threadpool caps apply to iOS
 C10_DEFINE_int(caffe2_threadpool_ios_cap, true, "");
 
+C10_DEFINE_bool(
+    caffe2_threadpool_adaptive_spin,
+    true,
+    "Spin waiting for work for about as long as the recent waits took, "
+    "instead of for a fixed number of cycles");
+
+C10_DEFINE_bool(
+    caffe2_threadpool_pin_big_cores,
+    false,
+    "Pin the workers of the default thread pool to the fastest cores of "
+    "big.LITTLE CPUs");
+
 namespace caffe2 {
 
 // Default smallest amount of work that will be partitioned between
 // multiple threads; the runtime value is configurable
 constexpr size_t kDefaultMinWorkSize = 1;
 
+namespace {
+
+// Returns the processors with the highest maximum frequency, or nothing if
+// all of them have the same one or if the frequencies are unknown.
+std::vector<int> getBigCores(int numProcessors) {
+  std::vector<int> bigCores;
+  std::vector<uint64_t> frequencies(numProcessors);
+  for (int i = 0; i < numProcessors; ++i) {
+    std::ostringstream path;
+    path << "/sys/devices/system/cpu/cpu" << i << "/cpufreq/cpuinfo_max_freq";
+    std::ifstream file(path.str());
+    if (!(file >> frequencies[i])) {
+      return bigCores;
+    }
+  }
+  const auto minmax = std::minmax_element(frequencies.begin(), frequencies.end());
+  if (minmax.first == frequencies.end() || *minmax.first == *minmax.second) {
+    return bigCores;
+  }
+  for (int i = 0; i < numProcessors; ++i) {
+    if (frequencies[i] == *minmax.second) {
+      bigCores.push_back(i);
+    }
+  }
+  return bigCores;
+}
+
+} // namespace
+
 std::unique_ptr<ThreadPool> ThreadPool::defaultThreadPool() {
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+  // The threads are those of the intra-op pool, sized by at::set_num_threads()
+  LOG(INFO) << "Constructing thread pool on the " << at::get_max_threads()
+            << " threads of the ATen intra-op pool";
+  return caffe2::make_unique<ThreadPool>(at::get_max_threads());
+#endif
   CAFFE_ENFORCE(cpuinfo_initialize(), "cpuinfo initialization failed");
   int numThreads = cpuinfo_get_processors_count();
 
@@ -73,17 +127,36 @@ std::unique_ptr<ThreadPool> ThreadPool::defaultThreadPool() {
         break;
     }
   }
+
+  std::vector<int> bigCores;
+  if (FLAGS_caffe2_threadpool_pin_big_cores) {
+    bigCores = getBigCores(cpuinfo_get_processors_count());
+    if (!bigCores.empty()) {
+      numThreads = std::min<int>(numThreads, bigCores.size());
+    }
+  }
   LOG(INFO) << "Constructing thread pool with " << numThreads << " threads";
-  return caffe2::make_unique<ThreadPool>(numThreads);
+  auto pool = caffe2::make_unique<ThreadPool>(numThreads);
+  if (!bigCores.empty()) {
+    LOG(INFO) << "Pinning the thread pool to its " << bigCores.size()
+              << " big cores";
+    pool->setCpuAffinity(bigCores);
+  }
+  return pool;
 }
 
 ThreadPool::ThreadPool(int numThreads)
     : minWorkSize_(kDefaultMinWorkSize), numThreads_(numThreads),
-      workersPool_(std::make_shared<WorkersPool>()) {}
+      workersPool_(std::make_shared<WorkersPool>(
+          FLAGS_caffe2_threadpool_adaptive_spin)) {}
 
 ThreadPool::~ThreadPool() {}
 
 int ThreadPool::getNumThreads() const {
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+  // the thread ids passed to run() functions are at::get_thread_num()
+  return at::get_max_threads();
+#endif
   std::lock_guard<std::mutex> guard(executionMutex_);
   return numThreads_;
 }
@@ -96,6 +169,16 @@ void ThreadPool::setMinWorkSize(size_t size) {
   minWorkSize_ = size;
 }
 
+void ThreadPool::setCpuAffinity(const std::vector<int>& cpus) {
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+  LOG(WARNING) << "Ignoring the CPU affinity of a thread pool that runs on "
+               << "the ATen intra-op pool";
+  return;
+#endif
+  std::lock_guard<std::mutex> guard(executionMutex_);
+  workersPool_->SetCpuAffinity(cpus);
+}
+
 void ThreadPool::run(const std::function<void(int, size_t)>& fn, size_t range) {
   std::lock_guard<std::mutex> guard(executionMutex_);
   // If there are no worker threads, or if the range is too small (too
@@ -111,6 +194,19 @@ void ThreadPool::run(const std::function<void(int, size_t)>& fn, size_t range) {
     return;
   }
 
+#ifdef CAFFE2_USE_ATEN_THREADPOOL
+  // Work items are claimed in chunks by the threads of the intra-op pool,
+  // the calling thread among them, so that caffe2 operators, NNPACK and ATen
+  // operators share the same threads instead of oversubscribing the cores.
+  at::parallel_for(0, range, minWorkSize_, [&fn](int64_t begin, int64_t end) {
+    const int threadId = at::get_thread_num();
+    for (auto i = begin; i < end; ++i) {
+      fn(threadId, i);
+    }
+  });
+  return;
+#endif
+
   struct FnTask : public Task {
     FnTask(){};
     virtual ~FnTask(){};
@@ -42,6 +42,10 @@ class CAFFE2_API /*alignas(kCacheLineSize)*/ ThreadPool {
   // main (calling) thread
   void setMinWorkSize(size_t size);
   size_t getMinWorkSize() const { return minWorkSize_; }
+
+  // Restricts the worker threads created from now on to the given cores
+  void setCpuAffinity(const std::vector<int>& cpus);
+
   void run(const std::function<void(int, size_t)>& fn, size_t range);
 
   // Run an arbitrary function in a thread-safe manner accessing the Workers
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <thread>
+#include <vector>
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/utils/thread_name.h"
@@ -11,6 +14,10 @@
 #include <intrin.h>
 #endif
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 namespace caffe2 {
 
 // Uses code derived from gemmlowp,
@@ -24,6 +31,8 @@ namespace caffe2 {
 // - cache-line align Worker.
 // - use std::atomic instead of volatile and custom barriers.
 // - use std::mutex/std::condition_variable instead of raw pthreads.
+// - optionally calibrate the busy-waiting from the recent waits.
+// - optionally pin the workers to a set of cores.
 
 constexpr size_t kGEMMLOWPCacheLineSize = 64;
 
@@ -103,6 +112,37 @@ inline int Do256NOPs() {
 #undef GEMMLOWP_NOP4
 #undef GEMMLOWP_NOP
 
+// The longest a calibrated WaitForVariableChange busy-waits for.
+constexpr std::chrono::microseconds kMaxBusyWaitTime{2000};
+
+// Calibrates how long WaitForVariableChange busy-waits from the recent waits
+// of a thread: it spins for about twice as long as they took, and less and
+// less once they take longer than kMaxBusyWaitTime. A thread waiting for the
+// next of a quick succession of tasks then wakes up without having to be
+// scheduled again, while one idle between far apart tasks doesn't burn CPU.
+// Not thread-safe, each waiting thread needs its own.
+class SpinWaitCalibration {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  Clock::duration SpinTime() const {
+    return spin_time_;
+  }
+
+  // Takes into account a wait that took wait_time
+  void Update(Clock::duration wait_time) {
+    if (wait_time < kMaxBusyWaitTime) {
+      spin_time_ = std::min<Clock::duration>(
+          (spin_time_ + 2 * wait_time) / 2, kMaxBusyWaitTime);
+    } else {
+      spin_time_ /= 2;
+    }
+  }
+
+ private:
+  Clock::duration spin_time_{kMaxBusyWaitTime};
+};
+
 // Waits until *var != initial_value.
 //
 // Returns the new value of *var. The guarantee here is that
@@ -125,11 +165,16 @@ inline int Do256NOPs() {
 // (e.g. worker threads having finished a GEMM and waiting until the next GEMM)
 // so as to avoid permanently spinning.
 //
+// With a calibration, busy-waits for its spin time instead of a fixed number
+// of no-op cycles, and updates it with how long the wait took.
+//
 template <typename T>
 T WaitForVariableChange(std::atomic<T>* var,
                         T initial_value,
                         std::condition_variable* cond,
-                        std::mutex* mutex) {
+                        std::mutex* mutex,
+                        SpinWaitCalibration* calibration = nullptr) {
+  const auto start = SpinWaitCalibration::Clock::now();
   // If we are on a platform that supports it, spin for some time.
   {
     int nops = 0;
@@ -140,12 +185,25 @@ T WaitForVariableChange(std::atomic<T>* var,
       return new_value;
     }
     // Then try busy-waiting.
-    while (nops < kMaxBusyWaitNOPs) {
-      nops += Do256NOPs();
-      new_value = var->load(std::memory_order_relaxed);
-      if (new_value != initial_value) {
-        std::atomic_thread_fence(std::memory_order_acquire);
-        return new_value;
+    if (calibration) {
+      const auto deadline = start + calibration->SpinTime();
+      while (SpinWaitCalibration::Clock::now() < deadline) {
+        Do256NOPs();
+        new_value = var->load(std::memory_order_relaxed);
+        if (new_value != initial_value) {
+          std::atomic_thread_fence(std::memory_order_acquire);
+          calibration->Update(SpinWaitCalibration::Clock::now() - start);
+          return new_value;
+        }
+      }
+    } else {
+      while (nops < kMaxBusyWaitNOPs) {
+        nops += Do256NOPs();
+        new_value = var->load(std::memory_order_relaxed);
+        if (new_value != initial_value) {
+          std::atomic_thread_fence(std::memory_order_acquire);
+          return new_value;
+        }
       }
     }
   }
@@ -160,6 +218,9 @@ T WaitForVariableChange(std::atomic<T>* var,
       return new_value != initial_value;
     });
     DCHECK_NE(static_cast<size_t>(new_value), static_cast<size_t>(initial_value));
+    if (calibration) {
+      calibration->Update(SpinWaitCalibration::Clock::now() - start);
+    }
     return new_value;
   }
 }
@@ -194,9 +255,9 @@ class BlockingCounter {
 
   // Waits for the N other threads (N having been set by Reset())
   // to hit the BlockingCounter.
-  void Wait() {
+  void Wait(SpinWaitCalibration* calibration = nullptr) {
     while (size_t count_value = count_.load(std::memory_order_relaxed)) {
-      WaitForVariableChange(&count_, count_value, &cond_, &mutex_);
+      WaitForVariableChange(&count_, count_value, &cond_, &mutex_, calibration);
     }
   }
 
@@ -206,6 +267,24 @@ class BlockingCounter {
   std::atomic<std::size_t> count_{0};
 };
 
+// Restricts the calling thread to the given cores, if the platform supports
+// it. Returns false if it doesn't or if the cores are invalid.
+inline bool SetCurrentThreadAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
 // A workload for a worker.
 struct Task {
   Task() {}
@@ -223,10 +302,17 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
     ExitAsSoonAsPossible // Should exit at earliest convenience.
   };
 
-  explicit Worker(BlockingCounter* counter_to_decrement_when_ready)
+  // With adaptive_spin, calibrates how long the worker spins waiting for
+  // work. With cpus, restricts the worker thread to those cores.
+  explicit Worker(
+      BlockingCounter* counter_to_decrement_when_ready,
+      bool adaptive_spin = false,
+      const std::vector<int>& cpus = {})
       : task_(nullptr),
         state_(State::ThreadStartup),
-        counter_to_decrement_when_ready_(counter_to_decrement_when_ready) {
+        counter_to_decrement_when_ready_(counter_to_decrement_when_ready),
+        adaptive_spin_(adaptive_spin),
+        cpus_(cpus) {
     thread_ = caffe2::make_unique<std::thread>([this]() { this->ThreadFunc(); });
   }
 
@@ -264,6 +350,9 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
   // Thread entry point.
   void ThreadFunc() {
     setThreadName("CaffeWorkersPool");
+    if (!cpus_.empty() && !SetCurrentThreadAffinity(cpus_)) {
+      LOG(WARNING) << "Could not pin the worker thread to its cores";
+    }
     ChangeState(State::Ready);
 
     // Thread main loop
@@ -271,8 +360,12 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
       // Get a state to act on
       // In the 'Ready' state, we have nothing to do but to wait until
       // we switch to another state.
-      State state_to_act_upon =
-          WaitForVariableChange(&state_, State::Ready, &state_cond_, &state_mutex_);
+      State state_to_act_upon = WaitForVariableChange(
+          &state_,
+          State::Ready,
+          &state_cond_,
+          &state_mutex_,
+          adaptive_spin_ ? &calibration_ : nullptr);
 
       // We now have a state to act on, so act.
       switch (state_to_act_upon) {
@@ -322,11 +415,28 @@ class alignas(kGEMMLOWPCacheLineSize) Worker {
   // pointer to the master's thread BlockingCounter object, to notify the
   // master thread of when this worker switches to the 'Ready' state.
   BlockingCounter* const counter_to_decrement_when_ready_;
+
+  // How long the worker spins waiting for work, if adaptive_spin_.
+  const bool adaptive_spin_;
+  SpinWaitCalibration calibration_;
+
+  // The cores the worker runs on, or all of them if empty.
+  const std::vector<int> cpus_;
 };
 
 class WorkersPool {
  public:
-  WorkersPool() {}
+  // With adaptive_spin, the workers waiting for work and the master thread
+  // waiting for the workers spin for about as long as their recent waits
+  // took instead of for a fixed number of cycles.
+  explicit WorkersPool(bool adaptive_spin = false)
+      : adaptive_spin_(adaptive_spin) {}
+
+  // Restricts the workers created from now on to the given cores, e.g. to
+  // the big cores of a big.LITTLE CPU. The calling threads are unaffected.
+  void SetCpuAffinity(const std::vector<int>& cpus) {
+    cpus_ = cpus;
+  }
 
   void Execute(const std::vector<std::shared_ptr<Task>>& tasks) {
     CAFFE_ENFORCE_GE(tasks.size(), 1);
@@ -342,7 +452,8 @@ class WorkersPool {
     auto& task = tasks.front();
     task->Run();
     // Wait for the workers submitted above to finish.
-    counter_to_decrement_when_ready_.Wait();
+    counter_to_decrement_when_ready_.Wait(
+        adaptive_spin_ ? &calibration_ : nullptr);
   }
 
  private:
@@ -355,7 +466,8 @@ class WorkersPool {
     }
     counter_to_decrement_when_ready_.Reset(workers_count - workers_.size());
     while (workers_.size() < workers_count) {
-      workers_.push_back(MakeAligned<Worker>::make(&counter_to_decrement_when_ready_));
+      workers_.push_back(MakeAligned<Worker>::make(
+          &counter_to_decrement_when_ready_, adaptive_spin_, cpus_));
     }
     counter_to_decrement_when_ready_.Wait();
   }
@@ -364,5 +476,9 @@ class WorkersPool {
   std::vector<std::unique_ptr<Worker, AlignedDeleter<Worker>>> workers_;
   // The BlockingCounter used to wait for the workers.
   BlockingCounter counter_to_decrement_when_ready_;
+  const bool adaptive_spin_;
+  // How long Execute() spins waiting for the workers, if adaptive_spin_.
+  SpinWaitCalibration calibration_;
+  std::vector<int> cpus_;
 };
 } // namespace caffe2
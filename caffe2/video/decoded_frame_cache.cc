@@ -0,0 +1,111 @@
+#include <caffe2/video/decoded_frame_cache.h>
+
+#include <sstream>
+
+namespace caffe2 {
+
+namespace {
+
+// Whether the decoder outputs every frame of the video in order
+bool outputsAllFrames(const Params& params) {
+  return !params.keyFrames_ && params.intervals_.size() == 1 &&
+      params.intervals_[0].fps == SpecialFps::SAMPLE_ALL_FRAMES;
+}
+
+// FNV-1a hash of the encoded video
+uint64_t hashBytes(const char* data, int size) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+} // namespace
+
+DecodedFrameCache::DecodedFrameCache(size_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+std::string DecodedFrameCache::key(
+    const char* video_buffer,
+    const int encoded_size,
+    const std::string& video_filename,
+    const Params& params) {
+  std::ostringstream key;
+  if (video_buffer) {
+    key << "buffer:" << encoded_size << ":"
+        << hashBytes(video_buffer, encoded_size);
+  } else {
+    key << "file:" << video_filename;
+  }
+  // The parameters that change the decoded frames
+  key << "|" << params.pixelFormat_ << "|" << params.streamIndex_ << "|"
+      << params.video_res_type_ << "|" << params.crop_height_ << "x"
+      << params.crop_width_ << "|" << params.height_min_ << "x"
+      << params.width_min_ << "|" << params.scale_h_ << "x" << params.scale_w_
+      << "|" << params.keyFrames_;
+  for (const auto& interval : params.intervals_) {
+    key << "|" << interval.timestamp << ":" << interval.fps;
+  }
+  return key.str();
+}
+
+std::shared_ptr<const DecodedFrameCache::Frames> DecodedFrameCache::lookup(
+    const std::string& key,
+    const Params& params,
+    int start_frm,
+    int num_frames,
+    size_t* first) {
+  const bool all_frames = outputsAllFrames(params);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->key != key) {
+      continue;
+    }
+    const int size = it->frames->size();
+    bool hit;
+    if (num_frames < 0) {
+      hit = it->complete && it->start_frm == start_frm;
+    } else if (all_frames) {
+      hit = it->start_frm <= start_frm &&
+          start_frm - it->start_frm + num_frames <= size;
+    } else {
+      hit = it->start_frm == start_frm && num_frames <= size;
+    }
+    if (hit) {
+      *first = start_frm - it->start_frm;
+      entries_.splice(entries_.begin(), entries_, it);
+      return entries_.front().frames;
+    }
+  }
+  return nullptr;
+}
+
+void DecodedFrameCache::insert(
+    const std::string& key,
+    int start_frm,
+    bool complete,
+    std::shared_ptr<const Frames> frames) {
+  size_t bytes = 0;
+  for (const auto& frame : *frames) {
+    bytes += frame->size_;
+  }
+  if (bytes > capacity_bytes_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.push_front(
+      Entry{key, start_frm, complete, bytes, std::move(frames)});
+  size_bytes_ += bytes;
+  while (size_bytes_ > capacity_bytes_) {
+    size_bytes_ -= entries_.back().bytes;
+    entries_.pop_back();
+  }
+}
+
+size_t DecodedFrameCache::sizeBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_bytes_;
+}
+
+} // namespace caffe2
@@ -0,0 +1,77 @@
+#ifndef CAFFE2_VIDEO_DECODED_FRAME_CACHE_H_
+#define CAFFE2_VIDEO_DECODED_FRAME_CACHE_H_
+
+#include <caffe2/video/video_decoder.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace caffe2 {
+
+// Decoded frames of recently decoded videos, so that clips of a video that
+// overlap with frames decoded before do not decode the video again.
+//
+// An entry holds the frames that decoding a video from frame `start_frm`
+// output, in order. When the decoder outputs every frame (no fps sampling,
+// no key frame selection), the frames of an entry are consecutive frames of
+// the video, and any clip within them is served from the entry. Otherwise
+// only a decode from the same start frame is.
+//
+// The cache holds at most capacity_bytes of frames, and evicts the least
+// recently used entries first. It is thread safe.
+class DecodedFrameCache {
+ public:
+  using Frames = std::vector<std::unique_ptr<DecodedFrame>>;
+
+  explicit DecodedFrameCache(size_t capacity_bytes);
+
+  // The key of the frames that decoding a video, from a buffer or from a
+  // file, with params outputs
+  static std::string key(
+      const char* video_buffer,
+      const int encoded_size,
+      const std::string& video_filename,
+      const Params& params);
+
+  // Looks up num_frames frames from frame start_frm on, or with num_frames
+  // < 0, all frames of the video. On a hit, the frames start at index
+  // *first of the returned frames.
+  std::shared_ptr<const Frames> lookup(
+      const std::string& key,
+      const Params& params,
+      int start_frm,
+      int num_frames,
+      size_t* first);
+
+  // Adds the frames that a decode from frame start_frm output. complete
+  // tells whether the decode reached the end of the video.
+  void insert(
+      const std::string& key,
+      int start_frm,
+      bool complete,
+      std::shared_ptr<const Frames> frames);
+
+  size_t sizeBytes() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    int start_frm;
+    bool complete;
+    size_t bytes;
+    std::shared_ptr<const Frames> frames;
+  };
+
+  const size_t capacity_bytes_;
+  mutable std::mutex mutex_;
+  // most recently used first
+  std::list<Entry> entries_;
+  size_t size_bytes_ = 0;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_VIDEO_DECODED_FRAME_CACHE_H_
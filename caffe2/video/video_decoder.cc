@@ -13,8 +13,108 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+// Hardware decoding needs the hardware configurations of codecs of ffmpeg 4.0
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 18, 100)
+#define CAFFE2_VIDEO_HWACCEL
+extern "C" {
+#include <libavutil/hwcontext.h>
+}
+#include <unordered_map>
+#endif
+
 namespace caffe2 {
 
+namespace {
+
+#ifdef CAFFE2_VIDEO_HWACCEL
+// The hardware device of a type, created once per process, as creating it
+// (a CUDA context, say) costs more than decoding a clip. Null if the device
+// can not be created.
+AVBufferRef* hardwareDevice(const std::string& name) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, AVBufferRef*> devices;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = devices.find(name);
+  if (it != devices.end()) {
+    return it->second;
+  }
+  AVBufferRef* device = nullptr;
+  AVHWDeviceType type = av_hwdevice_find_type_by_name(name.c_str());
+  if (type == AV_HWDEVICE_TYPE_NONE) {
+    LOG(ERROR) << "Unknown hardware device type " << name
+               << ", decoding in software";
+  } else if (av_hwdevice_ctx_create(&device, type, nullptr, nullptr, 0) < 0) {
+    LOG(ERROR) << "Unable to create " << name
+               << " hardware device, decoding in software";
+    device = nullptr;
+  }
+  devices.emplace(name, device);
+  return device;
+}
+
+// get_format callback that picks the hardware format of the codec context,
+// which it keeps in opaque, if the decoder offers it for the stream
+AVPixelFormat getHardwareFormat(
+    AVCodecContext* context,
+    const AVPixelFormat* formats) {
+  auto hwFormat = static_cast<AVPixelFormat>(
+      reinterpret_cast<intptr_t>(context->opaque));
+  for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE;
+       ++format) {
+    if (*format == hwFormat) {
+      return *format;
+    }
+  }
+  // e.g. a profile that the hardware does not support
+  return avcodec_default_get_format(context, formats);
+}
+#endif
+
+// Sets up the codec context to decode on the hardware device named in
+// params, and returns the pixel format of the frames it decodes on the
+// device. AV_PIX_FMT_NONE when decoding in software.
+AVPixelFormat setupHardwareDecoding(
+    const Params& params,
+    AVCodec* codec,
+    AVCodecContext* context) {
+  if (params.hwAccel_.empty() || codec == nullptr) {
+    return AV_PIX_FMT_NONE;
+  }
+#ifdef CAFFE2_VIDEO_HWACCEL
+  AVBufferRef* device = hardwareDevice(params.hwAccel_);
+  if (device == nullptr) {
+    return AV_PIX_FMT_NONE;
+  }
+  auto type = reinterpret_cast<AVHWDeviceContext*>(device->data)->type;
+  for (int i = 0;; ++i) {
+    const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+    if (config == nullptr) {
+      VLOG(1) << "Decoder " << codec->name << " does not support "
+              << params.hwAccel_ << ", decoding in software";
+      return AV_PIX_FMT_NONE;
+    }
+    if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) &&
+        config->device_type == type) {
+      context->hw_device_ctx = av_buffer_ref(device);
+      context->opaque = reinterpret_cast<void*>(
+          static_cast<intptr_t>(config->pix_fmt));
+      context->get_format = getHardwareFormat;
+      return config->pix_fmt;
+    }
+  }
+#else
+  static const bool logged = [] {
+    LOG(ERROR) << "Hardware decoding needs ffmpeg 4.0 or newer, decoding in "
+                  "software";
+    return true;
+  }();
+  (void)logged;
+  return AV_PIX_FMT_NONE;
+#endif
+}
+
+} // namespace
+
 VideoDecoder::VideoDecoder() {
   static bool gInitialized = false;
   static std::mutex gMutex;
@@ -56,6 +156,8 @@ void VideoDecoder::decodeLoop(
   AVStream* videoStream_ = nullptr;
   AVCodecContext* videoCodecContext_ = nullptr;
   AVFrame* videoStreamFrame_ = nullptr;
+  // frames decoded on a hardware device, downloaded to memory
+  AVFrame* transferFrame_ = nullptr;
   AVPacket packet;
   av_init_packet(&packet); // init packet
   SwsContext* scaleContext_ = nullptr;
@@ -121,11 +223,11 @@ void VideoDecoder::decodeLoop(
     // Initialize codec
     AVDictionary* opts = nullptr;
     videoCodecContext_ = videoStream_->codec;
+    AVCodec* codec = avcodec_find_decoder(videoCodecContext_->codec_id);
+    const AVPixelFormat hwPixFormat =
+        setupHardwareDecoding(params, codec, videoCodecContext_);
     try {
-      ret = avcodec_open2(
-          videoCodecContext_,
-          avcodec_find_decoder(videoCodecContext_->codec_id),
-          &opts);
+      ret = avcodec_open2(videoCodecContext_, codec, &opts);
     } catch (const std::exception&) {
       LOG(ERROR) << "Exception during open video codec";
       return;
@@ -177,19 +279,8 @@ void VideoDecoder::decodeLoop(
 
     // Make sure that we have a valid format
     CAFFE_ENFORCE_NE(videoCodecContext_->pix_fmt, AV_PIX_FMT_NONE);
-
-    // Create a scale context
-    scaleContext_ = sws_getContext(
-        videoCodecContext_->width,
-        videoCodecContext_->height,
-        videoCodecContext_->pix_fmt,
-        outWidth,
-        outHeight,
-        pixFormat,
-        SWS_FAST_BILINEAR,
-        nullptr,
-        nullptr,
-        nullptr);
+    // The scale context is created for the format of the first frame, which
+    // frames decoded on a hardware device only have once downloaded
 
     // Getting video meta data
     VideoMeta videoMeta;
@@ -233,6 +324,9 @@ void VideoDecoder::decodeLoop(
     // Initialize frame and packet.
     // These will be reused across calls.
     videoStreamFrame_ = av_frame_alloc();
+    if (hwPixFormat != AV_PIX_FMT_NONE) {
+      transferFrame_ = av_frame_alloc();
+    }
 
     // frame index in video stream
     int frameIndex = -1;
@@ -450,12 +544,39 @@ void VideoDecoder::decodeLoop(
                   outWidth,
                   outHeight);
 
+              AVFrame* decodedFrame = videoStreamFrame_;
+#ifdef CAFFE2_VIDEO_HWACCEL
+              if (videoStreamFrame_->format == hwPixFormat) {
+                av_frame_unref(transferFrame_);
+                ret = av_hwframe_transfer_data(
+                    transferFrame_, videoStreamFrame_, 0);
+                CAFFE_ENFORCE_GE(
+                    ret,
+                    0,
+                    "Error downloading decoded frame : ",
+                    ffmpegErrorStr(ret));
+                decodedFrame = transferFrame_;
+              }
+#endif
+              scaleContext_ = sws_getCachedContext(
+                  scaleContext_,
+                  decodedFrame->width,
+                  decodedFrame->height,
+                  static_cast<AVPixelFormat>(decodedFrame->format),
+                  outWidth,
+                  outHeight,
+                  pixFormat,
+                  SWS_FAST_BILINEAR,
+                  nullptr,
+                  nullptr,
+                  nullptr);
+
               sws_scale(
                   scaleContext_,
-                  videoStreamFrame_->data,
-                  videoStreamFrame_->linesize,
+                  decodedFrame->data,
+                  decodedFrame->linesize,
                   0,
-                  videoCodecContext_->height,
+                  decodedFrame->height,
                   rgbFrame->data,
                   rgbFrame->linesize);
 
@@ -491,6 +612,7 @@ void VideoDecoder::decodeLoop(
     sws_freeContext(scaleContext_);
     av_packet_unref(&packet);
     av_frame_free(&videoStreamFrame_);
+    av_frame_free(&transferFrame_);
     avcodec_close(videoCodecContext_);
     avformat_close_input(&inputContext);
     avformat_free_context(inputContext);
@@ -500,6 +622,7 @@ void VideoDecoder::decodeLoop(
     sws_freeContext(scaleContext_);
     av_packet_unref(&packet);
     av_frame_free(&videoStreamFrame_);
+    av_frame_free(&transferFrame_);
     avcodec_close(videoCodecContext_);
     avformat_close_input(&inputContext);
     avformat_free_context(inputContext);
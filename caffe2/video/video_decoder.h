@@ -108,6 +108,10 @@ class Params {
   // fps must be either the 3 special fps defined in SpecialFps, or > 0
   std::vector<SampleInterval> intervals_ = {{0, SpecialFps::SAMPLE_ALL_FRAMES}};
 
+  // ffmpeg hardware device type to decode with, e.g. "cuda" or "vaapi".
+  // Empty decodes in software.
+  std::string hwAccel_;
+
   Params() {}
 
   /**
@@ -168,6 +172,15 @@ class Params {
     return *this;
   }
 
+  /**
+   * Decode with an ffmpeg hardware device ("cuda", "vaapi", ...), falling
+   * back to software decoding where the device or codec does not support it
+   */
+  Params& hwAccel(const std::string& device) {
+    hwAccel_ = device;
+    return *this;
+  }
+
   /**
    * Output frame width, default to video width
    */
@@ -102,6 +102,10 @@ class VideoInputOp final : public PrefetchOperator<Context> {
   bool get_optical_flow_;
   bool get_video_id_;
   bool do_multi_label_;
+  // ffmpeg hardware device to decode with, empty for software decoding
+  std::string hw_accel_;
+  // decoded frames of recent videos, null if disabled
+  std::unique_ptr<DecodedFrameCache> frame_cache_;
 
   // thread pool for parse + decode
   int num_decode_threads_;
@@ -195,6 +199,12 @@ void VideoInputOp<Context>::CheckParamsAndPrint() {
             << "random mirroring;";
   LOG(INFO) << "    Using " << (random_crop_ ? "random" : "center") << " crop";
   LOG(INFO) << "    Is multi-cropping enabled: " << multi_crop_;
+  if (!hw_accel_.empty()) {
+    LOG(INFO) << "    Decoding with the " << hw_accel_ << " hardware device";
+  }
+  if (frame_cache_) {
+    LOG(INFO) << "    Caching decoded frames of recent videos";
+  }
 
   if (get_rgb_) {
     LOG(INFO) << "    Using a clip of " << length_rgb_ << " rgb frames "
@@ -342,6 +352,9 @@ VideoInputOp<Context>::VideoInputOp(
       do_multi_label_(OperatorBase::template GetSingleArgument<bool>(
           "do_multi_label",
           false)),
+      hw_accel_(OperatorBase::template GetSingleArgument<std::string>(
+          "hw_accel",
+          "")),
       num_decode_threads_(OperatorBase::template GetSingleArgument<int>(
           "num_decode_threads",
           4)),
@@ -367,6 +380,13 @@ VideoInputOp<Context>::VideoInputOp(
 
   num_of_required_frame_ = 0;
 
+  const int frame_cache_mb = OperatorBase::template GetSingleArgument<int>(
+      "decoded_frame_cache_mb", 0);
+  if (frame_cache_mb > 0) {
+    frame_cache_.reset(
+        new DecodedFrameCache(static_cast<size_t>(frame_cache_mb) << 20));
+  }
+
   // mean and std for normalizing different optical flow data type;
   // Example statistics generated from SOA are shown below, and you may
   // want to change them if you are running on a different dataset;
@@ -572,6 +592,7 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
   params.scale_h_ = scale_h_;
   params.decode_type_ = decode_type_;
   params.num_of_required_frame_ = num_of_required_frame_;
+  params.hwAccel_ = hw_accel_;
 
   char* video_buffer = nullptr; // for decoding from buffer
   std::string video_filename; // for decoding from file
@@ -606,7 +627,8 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
       use_local_file_,
       height,
       width,
-      buffer_rgb);
+      buffer_rgb,
+      frame_cache_.get());
 
   return true;
 }
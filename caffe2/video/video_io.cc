@@ -506,38 +506,78 @@ bool DecodeMultipleClipsFromVideo(
     const bool use_local_file,
     int& height,
     int& width,
-    std::vector<unsigned char*>& buffer_rgb) {
-  std::vector<std::unique_ptr<DecodedFrame>> sampledFrames;
-  VideoDecoder decoder;
-
-  // decoding from buffer or file
-  if (!use_local_file) {
-    decoder.decodeMemory(
-        video_buffer, encoded_size, params, start_frm, sampledFrames);
-  } else {
-    decoder.decodeFile(video_filename, params, start_frm, sampledFrames);
-  }
-
+    std::vector<unsigned char*>& buffer_rgb,
+    DecodedFrameCache* frame_cache) {
   for (int i = 0; i < buffer_rgb.size(); i++) {
     unsigned char* buff = buffer_rgb[i];
     delete[] buff;
   }
   buffer_rgb.clear();
 
-  if (sampledFrames.size() < params.num_of_required_frame_) {
+  // Uniform sampling needs all frames, and the other types of decoding a
+  // clip. Temporal jittering starts at a random timestamp rather than at a
+  // frame, so its clips are not cached.
+  const bool use_cache = frame_cache != nullptr &&
+      params.decode_type_ != DecodeType::DO_TMP_JITTER;
+  const int first_frm =
+      params.decode_type_ == DecodeType::USE_START_FRM ? start_frm : 0;
+  const int num_frames = params.decode_type_ == DecodeType::DO_UNIFORM_SMP
+      ? -1
+      : params.num_of_required_frame_;
+  std::string key;
+  std::shared_ptr<const DecodedFrameCache::Frames> frames;
+  size_t first = 0;
+  if (use_cache) {
+    key = DecodedFrameCache::key(
+        use_local_file ? nullptr : video_buffer,
+        encoded_size,
+        video_filename,
+        params);
+    frames = frame_cache->lookup(key, params, first_frm, num_frames, &first);
+  }
+
+  if (!frames) {
+    Params decode_params = params;
+    if (use_cache && num_frames >= 0) {
+      // Decodes ahead, for the following clips of the video that overlap
+      // with this one
+      decode_params.num_of_required_frame_ = 2 * params.num_of_required_frame_;
+    }
+    auto sampledFrames = std::make_shared<DecodedFrameCache::Frames>();
+    VideoDecoder decoder;
+
+    // decoding from buffer or file
+    if (!use_local_file) {
+      decoder.decodeMemory(
+          video_buffer, encoded_size, decode_params, start_frm, *sampledFrames);
+    } else {
+      decoder.decodeFile(
+          video_filename, decode_params, start_frm, *sampledFrames);
+    }
+
+    if (use_cache) {
+      const bool complete = num_frames < 0 ||
+          sampledFrames->size() < decode_params.num_of_required_frame_;
+      frame_cache->insert(key, first_frm, complete, sampledFrames);
+    }
+    frames = std::move(sampledFrames);
+    first = 0;
+  }
+
+  const int num_decoded = frames->size() - first;
+  if (num_decoded < params.num_of_required_frame_) {
     // LOG(ERROR) << "The video seems faulty and we could not decode enough
     // frames: "
-    //            << sampledFrames.size() << " VS " <<
+    //            << num_decoded << " VS " <<
     //            params.num_of_required_frame_;
-    FreeDecodedData(sampledFrames);
     return true;
   }
 
-  height = sampledFrames[0]->height_;
-  width = sampledFrames[0]->width_;
+  height = (*frames)[first]->height_;
+  width = (*frames)[first]->width_;
   float sample_stepsz = (clip_per_video <= 1)
       ? 0
-      : (float(sampledFrames.size() - params.num_of_required_frame_) /
+      : (float(num_decoded - params.num_of_required_frame_) /
          (clip_per_video - 1));
 
   int image_size = 3 * height * width;
@@ -545,16 +585,15 @@ bool DecodeMultipleClipsFromVideo(
   // get the RGB frames for each clip
   for (int i = 0; i < clip_per_video; i++) {
     unsigned char* buffer_rgb_ptr = new unsigned char[clip_size];
-    int clip_start = floor(i * sample_stepsz);
+    int clip_start = first + floor(i * sample_stepsz);
     for (int j = 0; j < params.num_of_required_frame_; j++) {
       memcpy(
           buffer_rgb_ptr + j * image_size,
-          (unsigned char*)sampledFrames[j + clip_start]->data_.get(),
+          (unsigned char*)(*frames)[j + clip_start]->data_.get(),
           image_size * sizeof(unsigned char));
     }
     buffer_rgb.push_back(buffer_rgb_ptr);
   }
-  FreeDecodedData(sampledFrames);
 
   return true;
 }
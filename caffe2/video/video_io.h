@@ -2,6 +2,7 @@
 #define CAFFE2_VIDEO_VIDEO_IO_H_
 
 #include <caffe2/core/common.h>
+#include <caffe2/video/decoded_frame_cache.h>
 #include <caffe2/video/optical_flow.h>
 #include <caffe2/video/video_decoder.h>
 #include <opencv2/opencv.hpp>
@@ -72,7 +73,8 @@ bool DecodeMultipleClipsFromVideo(
     const bool use_local_file,
     int& height,
     int& width,
-    std::vector<unsigned char*>& buffer_rgb);
+    std::vector<unsigned char*>& buffer_rgb,
+    DecodedFrameCache* frame_cache = nullptr);
 
 } // namespace caffe2
 
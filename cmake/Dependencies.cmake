@@ -314,6 +314,7 @@ if(BUILD_TEST)
 endif()
 
 # ---[ FBGEMM
+set(AT_FBGEMM_ENABLED 0)
 if(USE_FBGEMM)
   set(CAFFE2_THIRD_PARTY_ROOT "${PROJECT_SOURCE_DIR}/third_party")
   if(NOT DEFINED FBGEMM_SOURCE_DIR)
@@ -341,6 +342,7 @@ if(USE_FBGEMM)
 
   if(USE_FBGEMM)
     list(APPEND Caffe2_DEPENDENCY_LIBS fbgemm)
+    set(AT_FBGEMM_ENABLED 1)
   endif()
 endif()
 
@@ -639,6 +641,27 @@ if(USE_OPENMP)
   endif()
 endif()
 
+# ---[ ATen intra-op parallelism backend
+if(ATEN_THREADING STREQUAL "NATIVE")
+  set(AT_PARALLEL_OPENMP 0)
+  set(AT_PARALLEL_NATIVE 1)
+  # caffe2::ThreadPool, and with it the pthreadpool users such as NNPACK,
+  # then runs on the same intra-op pool as at::parallel_for
+  set(CAFFE2_USE_ATEN_THREADPOOL ON)
+elseif(ATEN_THREADING STREQUAL "OMP")
+  set(AT_PARALLEL_OPENMP 1)
+  set(AT_PARALLEL_NATIVE 0)
+else()
+  message(FATAL_ERROR "Unknown ATEN_THREADING: ${ATEN_THREADING} (expected OMP or NATIVE)")
+endif()
+
+# ---[ caffe2 perfkernels, used by some ATen CPU kernels when they are built
+if(BUILD_ATEN_ONLY)
+  set(AT_CAFFE2_PERFKERNELS_ENABLED 0)
+else()
+  set(AT_CAFFE2_PERFKERNELS_ENABLED 1)
+endif()
+
 
 # ---[ Android specific ones
 if(ANDROID)
@@ -133,6 +133,19 @@ else()
   set(CAFFE2_DISABLE_NUMA 1)
 endif()
 
+# ---[ Check for static tracepoint support
+# The probes are nops until a tracer attaches to them, and are only
+# implemented for x86 ELF targets (see caffe2/core/static_tracepoint.h).
+if (USE_SDT)
+  if (CMAKE_SYSTEM_NAME STREQUAL "Linux" AND
+      CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|i.86)$")
+    message(STATUS "Static tracepoints are enabled")
+    set(CAFFE2_ENABLE_SDT 1)
+  else()
+    message(WARNING "Static tracepoints are not supported on this platform")
+  endif()
+endif()
+
 # ---[ Check if we want to turn off deprecated warning due to glog.
 # Note(jiayq): on ubuntu 14.04, the default glog install uses ext/hash_set that
 # is being deprecated. As a result, we will test if this is the environment we
@@ -4,18 +4,23 @@
 #include <torch/data/detail/sequencers.h>
 #include <torch/serialize.h>
 #include <torch/types.h>
+#include <torch/csrc/utils/tempfile.h>
 
 #include <test/cpp/api/support.h>
 
 #include <c10/util/ArrayRef.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <numeric>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -94,6 +99,125 @@ TEST(DataTest, InfiniteStreamDataset) {
   }
   ASSERT_EQ(batch_index, 3);
 }
+/// Chunk `i` holds the `i + 1` consecutive integers after `i * (i + 1) / 2`.
+struct DummyChunkDataReader : datasets::ChunkDataReader<int> {
+  explicit DummyChunkDataReader(size_t chunks) : chunks(chunks) {}
+
+  ChunkType read_chunk(size_t index) override {
+    ChunkType chunk(index + 1);
+    std::iota(
+        chunk.begin(), chunk.end(), static_cast<int>(index * (index + 1) / 2));
+    return chunk;
+  }
+
+  size_t chunk_count() override {
+    return chunks;
+  }
+
+  size_t chunks;
+};
+
+TEST(DataTest, ChunkDatasetReturnsEveryExampleOncePerPass) {
+  const size_t kChunks = 10;
+  const size_t kExamples = kChunks * (kChunks + 1) / 2;
+  // With a single preloader and no room for more than one chunk at a time,
+  // passes can't overlap
+  datasets::ChunkDataset<DummyChunkDataReader> dataset(
+      DummyChunkDataReader(kChunks),
+      datasets::ChunkDatasetOptions(/*preloader_count=*/1, /*cache_size=*/1)
+          .seed(123));
+  ASSERT_FALSE(dataset.size().has_value());
+
+  std::vector<int> expected(kExamples);
+  std::iota(expected.begin(), expected.end(), 0);
+  for (size_t pass = 0; pass < 2; ++pass) {
+    std::vector<int> examples;
+    while (examples.size() < kExamples) {
+      auto batch = dataset.get_batch(5);
+      ASSERT_EQ(batch.size(), 5);
+      examples.insert(examples.end(), batch.begin(), batch.end());
+    }
+    ASSERT_NE(examples, expected);
+    std::sort(examples.begin(), examples.end());
+    ASSERT_EQ(examples, expected);
+  }
+}
+
+TEST(DataTest, ChunkDatasetWithoutShuffleKeepsStorageOrder) {
+  datasets::ChunkDataset<DummyChunkDataReader> dataset(
+      DummyChunkDataReader(/*chunks=*/4),
+      datasets::ChunkDatasetOptions().cache_size(3).shuffle(false));
+  ASSERT_EQ(dataset.get_batch(4), std::vector<int>({0, 1, 2, 3}));
+  ASSERT_EQ(dataset.get_batch(6), std::vector<int>({4, 5, 6, 7, 8, 9}));
+  // The next pass starts from the first chunk again
+  ASSERT_EQ(dataset.get_batch(2), std::vector<int>({0, 1}));
+}
+
+TEST(DataTest, ChunkDatasetWorksWithDataLoader) {
+  const size_t kExamples = 6 * 7 / 2;
+  auto data_loader = torch::data::make_data_loader(
+      datasets::ChunkDataset<DummyChunkDataReader>(
+          DummyChunkDataReader(/*chunks=*/6),
+          datasets::ChunkDatasetOptions(/*preloader_count=*/2, 4)),
+      DataLoaderOptions().batch_size(4).workers(2),
+      samplers::StreamSampler(/*epoch_size=*/kExamples));
+
+  for (size_t epoch = 0; epoch < 2; ++epoch) {
+    size_t examples = 0;
+    for (auto& batch : *data_loader) {
+      ASSERT_LE(batch.size(), 4);
+      for (auto example : batch) {
+        ASSERT_LT(example, static_cast<int>(kExamples));
+      }
+      examples += batch.size();
+    }
+    ASSERT_EQ(examples, kExamples);
+  }
+}
+
+struct ThrowingChunkDataReader : datasets::ChunkDataReader<int> {
+  ChunkType read_chunk(size_t index) override {
+    if (index == 1) {
+      throw std::runtime_error("bad chunk");
+    }
+    return {1, 2, 3};
+  }
+
+  size_t chunk_count() override {
+    return 2;
+  }
+};
+
+TEST(DataTest, ChunkDatasetRethrowsExceptionsFromChunkReader) {
+  datasets::ChunkDataset<ThrowingChunkDataReader> dataset(
+      ThrowingChunkDataReader{},
+      datasets::ChunkDatasetOptions().cache_size(100));
+  ASSERT_THROWS_WITH(dataset.get_batch(10), "bad chunk");
+}
+
+TEST(DataTest, ChunkDatasetThrowsIfAllChunksAreEmpty) {
+  struct EmptyChunkDataReader : datasets::ChunkDataReader<int> {
+    ChunkType read_chunk(size_t /* index */) override {
+      return {};
+    }
+    size_t chunk_count() override {
+      return 3;
+    }
+  };
+  datasets::ChunkDataset<EmptyChunkDataReader> dataset(
+      EmptyChunkDataReader{}, datasets::ChunkDatasetOptions(2, 10));
+  ASSERT_THROWS_WITH(dataset.get_batch(1), "all chunks are empty");
+
+  struct NoChunkDataReader : EmptyChunkDataReader {
+    size_t chunk_count() override {
+      return 0;
+    }
+  };
+  ASSERT_THROWS_WITH(
+      datasets::ChunkDataset<NoChunkDataReader>(NoChunkDataReader{}),
+      "ChunkDataset requires at least one chunk");
+}
+
 TEST(DataTest, NoSequencerIsIdentity) {
   using namespace torch::data::detail::sequencers; // NOLINT
   NoSequencer<int> no_sequencer;
@@ -298,6 +422,52 @@ TEST(DataTest, SavingAndLoadingRandomSamplerYieldsSameSequence) {
   }
 }
 
+TEST(DataTest, LazyRandomSamplerReturnsAPermutation) {
+  for (size_t size : {0, 1, 2, 5, 16, 17, 1000}) {
+    samplers::LazyRandomSampler sampler(size);
+    std::vector<size_t> indices;
+    while (auto batch = sampler.next(7)) {
+      ASSERT_LE(batch->size(), 7);
+      indices.insert(indices.end(), batch->begin(), batch->end());
+    }
+    ASSERT_EQ(sampler.index(), size);
+    std::vector<size_t> expected(size);
+    std::iota(expected.begin(), expected.end(), size_t(0));
+    if (size == 1000) {
+      ASSERT_NE(indices, expected);
+    }
+    std::sort(indices.begin(), indices.end());
+    ASSERT_EQ(indices, expected);
+  }
+}
+
+TEST(DataTest, LazyRandomSamplerResetsToANewPermutation) {
+  samplers::LazyRandomSampler sampler(1000);
+  auto first = sampler.next(1000).value();
+  ASSERT_FALSE(sampler.next(2).has_value());
+  sampler.reset();
+  ASSERT_EQ(sampler.index(), 0);
+  auto second = sampler.next(1000).value();
+  ASSERT_NE(first, second);
+  std::sort(first.begin(), first.end());
+  std::sort(second.begin(), second.end());
+  ASSERT_EQ(first, second);
+}
+
+TEST(DataTest, SavingAndLoadingLazyRandomSamplerYieldsSameSequence) {
+  samplers::LazyRandomSampler a(100);
+  a.next(30);
+  std::stringstream stream;
+  torch::save(a, stream);
+
+  samplers::LazyRandomSampler b(100);
+  torch::load(b, stream);
+  ASSERT_EQ(b.index(), 30);
+  auto b_sequence = b.next(100).value();
+  ASSERT_EQ(b_sequence.size(), 70);
+  ASSERT_EQ(a.next(100).value(), b_sequence);
+}
+
 TEST(DataTest, StreamSamplerReturnsTheBatchSizeAndThenRemainder) {
   samplers::StreamSampler sampler(/*epoch_size=*/100);
   ASSERT_EQ(sampler.next(10).value(), 10);
@@ -329,6 +499,56 @@ TEST(DataTest, TensorDatasetConstructsFromInitializerListOfTensors) {
       torch::tensor({0, 0, 1, 0, 0}, torch::kFloat32).allclose(dataset.get(2)));
 }
 
+TEST(DataTest, MemoryMappedTensorDatasetReadsIndexedExamples) {
+  auto data_file = torch::utils::make_tempfile();
+  auto index_file = torch::utils::make_tempfile();
+  std::vector<torch::Tensor> tensors = {torch::randn({2, 3}),
+                                        torch::randn({5}),
+                                        torch::randn({4, 2}).t(),
+                                        torch::randn({})};
+  datasets::write_memory_mapped_tensors(
+      tensors, data_file.name, index_file.name);
+
+  datasets::MemoryMappedTensorDataset dataset(
+      data_file.name, index_file.name, torch::kFloat32);
+  ASSERT_EQ(dataset.size().value(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto example = dataset.get(i);
+    ASSERT_EQ(example.data.sizes(), tensors[i].sizes());
+    ASSERT_TRUE(example.data.equal(tensors[i]));
+  }
+  // examples are views into the mapping
+  ASSERT_EQ(
+      dataset.get(1).data.data<float>(), dataset.data().data<float>() + 6);
+  ASSERT_THROWS_WITH(dataset.get(4), "out of range");
+
+  // writes stay in memory
+  dataset.get(0).data.fill_(7);
+  datasets::MemoryMappedTensorDataset reread(
+      data_file.name, index_file.name, torch::kFloat32);
+  ASSERT_TRUE(reread.get(0).data.equal(tensors[0]));
+}
+
+TEST(DataTest, MemoryMappedTensorDatasetReadsFixedSizeExamples) {
+  auto data_file = torch::utils::make_tempfile();
+  auto index_file = torch::utils::make_tempfile();
+  auto tensor = torch::arange(30, torch::kInt64).view({5, 2, 3});
+  datasets::write_memory_mapped_tensors(
+      tensor.unbind(0), data_file.name, index_file.name);
+
+  datasets::MemoryMappedTensorDataset dataset(
+      data_file.name, torch::kInt64, {2, 3});
+  ASSERT_EQ(dataset.size().value(), 5);
+  auto batch = dataset.map(transforms::Stack<TensorExample>()).get_batch({3, 1});
+  ASSERT_TRUE(batch.data.equal(torch::stack({tensor[3], tensor[1]})));
+
+  std::ofstream(index_file.name) << "0 2 3\n28 2 3\n";
+  ASSERT_THROWS_WITH(
+      datasets::MemoryMappedTensorDataset(
+          data_file.name, index_file.name, torch::kInt64),
+      "out of bounds");
+}
+
 TEST(DataTest, StackTransformWorksForExample) {
   struct D : public datasets::Dataset<D> {
     Example<> get(size_t index) override {
@@ -364,6 +584,55 @@ TEST(DataTest, StackTransformWorksForTensorExample) {
   ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
 }
 
+TEST(DataTest, StackTransformCollatesIntoBufferPool) {
+  auto pool = std::make_shared<BufferPool>();
+  auto d = datasets::TensorDataset(torch::eye(4))
+               .map(transforms::Stack<TensorExample>(pool));
+
+  void* data = nullptr;
+  {
+    TensorExample first = d.get_batch({0, 1});
+    ASSERT_TRUE(first.data.allclose(torch::eye(4).slice(/*dim=*/0, 0, 2)));
+    data = first.data.data_ptr();
+  }
+  ASSERT_EQ(pool->cached_buffers(), 1);
+
+  // The buffer of the dropped batch is reused for the next one
+  TensorExample second = d.get_batch({2, 3});
+  ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
+  ASSERT_EQ(second.data.data_ptr(), data);
+  ASSERT_EQ(pool->cached_buffers(), 0);
+}
+
+TEST(DataTest, BufferPoolRecyclesBuffersOnceAllViewsAreDropped) {
+  BufferPool pool(/*pin_memory=*/false, /*max_cached_buffers=*/1);
+  auto tensor = pool.empty({2, 3}, torch::kFloat32);
+  ASSERT_EQ(tensor.sizes(), torch::IntList({2, 3}));
+  ASSERT_FALSE(tensor.requires_grad());
+  void* data = tensor.data_ptr();
+
+  auto view = tensor.narrow(/*dim=*/0, 0, 1);
+  tensor = torch::Tensor();
+  ASSERT_EQ(pool.cached_buffers(), 0);
+  view = torch::Tensor();
+  ASSERT_EQ(pool.cached_buffers(), 1);
+
+  // Buffers are reused for tensors of the same size in bytes
+  auto first = pool.empty({3, 2}, torch::kInt32);
+  ASSERT_EQ(first.data_ptr(), data);
+  auto second = pool.empty({6}, torch::kFloat32);
+  ASSERT_NE(second.data_ptr(), data);
+
+  // Only one buffer is kept around
+  first = torch::Tensor();
+  second = torch::Tensor();
+  ASSERT_EQ(pool.cached_buffers(), 1);
+
+  ASSERT_THROWS_WITH(
+      pool.stack({torch::ones(2), torch::ones(3)}),
+      "Sizes of tensors must match");
+}
+
 // Template classes cannot be nested in functions.
 template <typename Target>
 struct T : transforms::TensorTransform<Target> {
@@ -444,6 +713,27 @@ TEST(DataTest, MapDoesNotCopy) {
   ASSERT_EQ(data[0].item<float>(), 7);
 }
 
+TEST(DataTest, MapTensorsTraversesBatches) {
+  auto add_one = [](const torch::Tensor& tensor) { return tensor + 1; };
+
+  std::vector<Example<>> batch = {{torch::zeros(2), torch::ones(2)},
+                                  {torch::ones(2), torch::zeros(2)}};
+  batch = detail::map_tensors(std::move(batch), add_one);
+  ASSERT_TRUE(batch[0].data.allclose(torch::ones(2)));
+  ASSERT_TRUE(batch[0].target.allclose(torch::full({2}, 2)));
+  ASSERT_TRUE(batch[1].data.allclose(torch::full({2}, 2)));
+  ASSERT_TRUE(batch[1].target.allclose(torch::ones(2)));
+
+  TensorExample example(torch::zeros(2));
+  example = detail::map_tensors(std::move(example), add_one);
+  ASSERT_TRUE(example.data.allclose(torch::ones(2)));
+
+  // Values of other types are left alone
+  std::vector<int> values = {1, 2, 3};
+  values = detail::map_tensors(std::move(values), add_one);
+  ASSERT_EQ(values, std::vector<int>({1, 2, 3}));
+}
+
 TEST(DataTest, QueuePushAndPopFromSameThread) {
   torch::data::detail::Queue<int> queue;
   queue.push(1);
@@ -493,6 +783,106 @@ TEST(DataTest, QueueClearEmptiesTheQueue) {
   ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
 }
 
+TEST(DataTest, QueueRoundsCapacityUpToPowerOfTwo) {
+  using torch::data::detail::Queue;
+  ASSERT_EQ(Queue<int>(0).capacity(), 2);
+  ASSERT_EQ(Queue<int>(2).capacity(), 2);
+  ASSERT_EQ(Queue<int>(5).capacity(), 8);
+  ASSERT_EQ(Queue<int>(64).capacity(), 64);
+}
+
+TEST(DataTest, QueuePushBlocksWhileQueueIsFull) {
+  torch::data::detail::Queue<int> queue(2);
+  queue.push(1);
+  queue.push(2);
+  ASSERT_EQ(queue.size(), 2);
+
+  std::atomic<bool> pushed(false);
+  std::thread thread([&queue, &pushed] {
+    queue.push(3);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(20 * kMillisecond);
+  ASSERT_FALSE(pushed.load());
+
+  ASSERT_EQ(queue.pop(), 1);
+  thread.join();
+  ASSERT_TRUE(pushed.load());
+  ASSERT_EQ(queue.pop(), 2);
+  ASSERT_EQ(queue.pop(), 3);
+  ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(DataTest, QueueClearUnblocksProducers) {
+  torch::data::detail::Queue<int> queue(2);
+  queue.push(1);
+  queue.push(2);
+  std::thread thread([&queue] { queue.push(3); });
+  std::this_thread::sleep_for(20 * kMillisecond);
+  ASSERT_EQ(queue.clear(), 2);
+  thread.join();
+  ASSERT_EQ(queue.pop(), 3);
+}
+
+TEST(DataTest, QueuePushAndPopBatches) {
+  torch::data::detail::Queue<int> queue(4);
+  // More values than fit into the queue at once
+  std::thread thread(
+      [&queue] { queue.push_batch({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}); });
+  std::vector<int> values;
+  while (values.size() < 10) {
+    auto batch = queue.pop_batch(3);
+    ASSERT_GE(batch.size(), 1);
+    ASSERT_LE(batch.size(), 3);
+    values.insert(values.end(), batch.begin(), batch.end());
+  }
+  thread.join();
+  ASSERT_EQ(values, std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+  ASSERT_THROWS_WITH(
+      queue.pop_batch(3, 1 * kMillisecond),
+      "Timeout in DataLoader queue while waiting for next batch");
+}
+
+TEST(DataTest, QueueDestroysRemainingElements) {
+  auto value = std::make_shared<int>(1);
+  {
+    torch::data::detail::Queue<std::shared_ptr<int>> queue;
+    queue.push(value);
+    queue.push(value);
+    ASSERT_EQ(value.use_count(), 3);
+  }
+  ASSERT_EQ(value.use_count(), 1);
+}
+
+TEST(DataTest, QueueWorksWithManyProducersAndConsumers) {
+  using torch::data::detail::Queue;
+  const size_t kElements = 1 << 16;
+  for (size_t workers : {1, 2, 4, 8}) {
+    Queue<size_t> queue(16);
+    std::atomic<size_t> sum(0);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+      threads.emplace_back([&queue, w, workers, kElements] {
+        for (size_t i = w; i < kElements; i += workers) {
+          queue.push(i);
+        }
+      });
+      threads.emplace_back([&queue, &sum, w, workers, kElements] {
+        size_t local = 0;
+        for (size_t i = w; i < kElements; i += workers) {
+          local += queue.pop();
+        }
+        sum += local;
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(sum.load(), kElements * (kElements - 1) / 2);
+    ASSERT_EQ(queue.size(), 0);
+  }
+}
+
 TEST(DataTest, DataShuttleCanPushAndPopJob) {
   torch::data::detail::DataShuttle<int, int> shuttle;
   shuttle.push_job(1);
@@ -657,6 +1047,9 @@ TEST(DataLoaderTest, DataLoaderOptionsDefaultAsExpected) {
   ASSERT_EQ(full_options.max_jobs, 0);
   ASSERT_FALSE(full_options.timeout.has_value());
   ASSERT_TRUE(full_options.enforce_ordering);
+  ASSERT_FALSE(full_options.pin_memory);
+  ASSERT_FALSE(full_options.device.has_value());
+  ASSERT_EQ(full_options.prefetch_depth, 2);
 }
 
 TEST(DataLoaderTest, DataLoaderOptionsCoalesceOptionalValues) {
@@ -666,6 +1059,14 @@ TEST(DataLoaderTest, DataLoaderOptionsCoalesceOptionalValues) {
   ASSERT_EQ(full_options.max_jobs, 2 * 10);
 }
 
+TEST(DataLoaderTest, DataLoaderOptionsDeviceImpliesPinMemory) {
+  auto partial_options =
+      DataLoaderOptions().device(torch::Device(torch::kCUDA));
+  FullDataLoaderOptions full_options(partial_options);
+  ASSERT_TRUE(full_options.pin_memory);
+  ASSERT_EQ(*full_options.device, torch::Device(torch::kCUDA));
+}
+
 TEST(DataLoaderTest, MakeDataLoaderDefaultsAsExpected) {
   auto data_loader = torch::data::make_data_loader(
       DummyDataset().map(transforms::Lambda<int>([](int x) { return x + 1; })));
@@ -1054,3 +1455,63 @@ TEST(DataLoaderTest, TestExceptionsArePropagatedFromWorkers) {
         std::rethrow_exception(e.original_exception), std::invalid_argument);
   }
 }
+
+struct RangeDataset : datasets::Dataset<RangeDataset> {
+  Example<> get(size_t index) override {
+    return {torch::full({3}, static_cast<double>(index)),
+            torch::full({1}, static_cast<double>(index))};
+  }
+  torch::optional<size_t> size() const override {
+    return 10;
+  }
+};
+
+TEST(DataLoaderTest, PinsMemoryOfBatches_CUDA) {
+  auto data_loader = torch::data::make_data_loader(
+      RangeDataset(),
+      DataLoaderOptions(2).workers(2).pin_memory(true),
+      samplers::SequentialSampler(10));
+  size_t index = 0;
+  for (auto& batch : *data_loader) {
+    for (auto& example : batch) {
+      const auto value = static_cast<double>(index);
+      ASSERT_TRUE(example.data.device().is_cpu());
+      ASSERT_TRUE(example.data.allclose(torch::full({3}, value)));
+      ASSERT_TRUE(example.target.allclose(torch::full({1}, value)));
+      ++index;
+    }
+  }
+  ASSERT_EQ(index, 10);
+}
+
+TEST(DataLoaderTest, UsesPinnedBatchesFromBufferPool_CUDA) {
+  auto pool = std::make_shared<BufferPool>(/*pin_memory=*/true);
+  auto batch = pool->stack({torch::ones(3), torch::zeros(3)});
+  ASSERT_TRUE(batch.allclose(torch::stack({torch::ones(3), torch::zeros(3)})));
+  // Already pinned, so not copied again
+  ASSERT_EQ(detail::pin_memory(batch).data_ptr(), batch.data_ptr());
+  ASSERT_EQ(pool->cached_buffers(), 0);
+}
+
+TEST(DataLoaderTest, TransfersBatchesToDevice_CUDA) {
+  for (size_t workers : {0, 2}) {
+    auto data_loader = torch::data::make_data_loader(
+        RangeDataset(),
+        DataLoaderOptions(3).workers(workers).device(torch::Device(torch::kCUDA)),
+        samplers::SequentialSampler(10));
+    // Twice, to check that a new epoch starts without stale transfers
+    for (size_t epoch = 0; epoch < 2; ++epoch) {
+      size_t index = 0;
+      for (auto& batch : *data_loader) {
+        for (auto& example : batch) {
+          ASSERT_TRUE(example.data.device().is_cuda());
+          ASSERT_TRUE(example.target.device().is_cuda());
+          const auto value = static_cast<double>(index);
+          ASSERT_TRUE(example.data.cpu().allclose(torch::full({3}, value)));
+          ++index;
+        }
+      }
+      ASSERT_EQ(index, 10);
+    }
+  }
+}
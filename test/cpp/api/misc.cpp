@@ -20,6 +20,26 @@ TEST(NoGradTest, SetsGradModeCorrectly) {
   ASSERT_FALSE(model->weight.grad().defined());
 }
 
+TEST(InferenceModeTest, CreatesPlainTensors) {
+  torch::Tensor weight = torch::randn({5, 2});
+  torch::Tensor y;
+  {
+    torch::InferenceModeGuard guard;
+    auto x = torch::ones({10, 5});
+    ASSERT_FALSE(x.is_variable());
+    y = x.mm(torch::autograd::as_variable_ref(weight).data());
+    ASSERT_FALSE(y.is_variable());
+    ASSERT_THROWS_WITH(
+        torch::ones({10, 5}, torch::requires_grad()),
+        "tensors created in inference mode can't require grad");
+  }
+  ASSERT_TRUE(torch::ones({1}).is_variable());
+  ASSERT_TRUE(torch::ones({10, 5}).mm(weight).allclose(torch::autograd::make_variable(y)));
+  // the plain tensors can't flow into autograd
+  ASSERT_THROWS_WITH(weight.mm(y), "Expected object of type Variable");
+  ASSERT_THROWS_WITH(y.mm(weight), "Expected Tensor (not Variable)");
+}
+
 struct AutogradTest : torch::test::SeedingFixture {
   AutogradTest() {
     x = torch::randn({3, 3}, torch::requires_grad());
@@ -44,6 +64,63 @@ TEST_F(AutogradTest, CanPassCustomGradientInputs) {
   ASSERT_TRUE(x.grad().allclose(y * 2));
 }
 
+struct CheckpointTest : torch::test::SeedingFixture {};
+
+TEST_F(CheckpointTest, MatchesGradientsWithoutCheckpoint) {
+  torch::nn::Linear model(4, 3);
+  auto function = [&](const torch::autograd::variable_list& inputs) {
+    return torch::autograd::variable_list{
+        torch::tanh(model->forward(inputs[0])) * inputs[1]};
+  };
+  auto x = torch::randn({5, 4}, torch::requires_grad());
+  auto y = torch::randn({5, 3}, torch::requires_grad());
+
+  function({x, y})[0].sum().backward();
+  auto expected_x = x.grad().clone();
+  auto expected_y = y.grad().clone();
+  auto expected_weight = model->weight.grad().clone();
+  x.grad().zero_();
+  y.grad().zero_();
+  model->weight.grad().zero_();
+
+  auto output = torch::checkpoint(function, {x, y})[0];
+  ASSERT_TRUE(output.requires_grad());
+  output.sum().backward();
+  ASSERT_TRUE(x.grad().allclose(expected_x));
+  ASSERT_TRUE(y.grad().allclose(expected_y));
+  ASSERT_TRUE(model->weight.grad().allclose(expected_weight));
+}
+
+TEST_F(CheckpointTest, PreservesRandomState) {
+  auto function = [](const torch::autograd::variable_list& inputs) {
+    return torch::autograd::variable_list{
+        torch::dropout(inputs[0], /*p=*/0.5, /*train=*/true)};
+  };
+  auto x = torch::randn({100}, torch::requires_grad());
+  torch::manual_seed(1);
+  auto output = torch::checkpoint(function, {x})[0];
+  output.sum().backward();
+  // The gradient is 2 where the forward kept the value, and 0 where it dropped
+  // it, if the recomputation drew the same mask
+  ASSERT_TRUE(x.grad().eq(0).eq(output.eq(0)).all().item<uint8_t>());
+  // The recomputation doesn't change the numbers drawn after it
+  auto after = torch::rand({10});
+  torch::manual_seed(1);
+  torch::checkpoint(function, {x});
+  ASSERT_TRUE(torch::rand({10}).allclose(after));
+}
+
+TEST_F(CheckpointTest, RunsWithoutGrad) {
+  auto x = torch::randn({3}, torch::requires_grad());
+  torch::NoGradGuard no_grad;
+  auto output = torch::checkpoint(
+      [](const torch::autograd::variable_list& inputs) {
+        return torch::autograd::variable_list{inputs[0] * 2};
+      },
+      {x})[0];
+  ASSERT_FALSE(output.requires_grad());
+}
+
 TEST(NNInitTest, CanInitializeTensorThatRequiresGrad) {
   auto tensor = torch::empty({3, 4}, torch::requires_grad());
   ASSERT_THROWS_WITH(
@@ -7,6 +7,7 @@
 #include <torch/nn/modules/embedding.h>
 #include <torch/nn/modules/functional.h>
 #include <torch/nn/modules/linear.h>
+#include <torch/nn/modules/quantized.h>
 #include <torch/types.h>
 #include <torch/utils.h>
 
@@ -118,6 +119,24 @@ TEST_F(ModulesTest, Linear) {
   ASSERT_EQ(model->weight.grad().numel(), 2 * 5);
 }
 
+TEST_F(ModulesTest, QuantizedLinear) {
+  if (!torch::fbgemm_is_cpu_supported()) {
+    return;
+  }
+  Linear linear(16, 8);
+  QuantizedLinear model(*linear);
+  auto x = torch::randn({4, 3, 16});
+  auto y = model->forward(x);
+  ASSERT_EQ(y.sizes(), torch::IntList({4, 3, 8}));
+
+  torch::NoGradGuard no_grad;
+  auto expected = linear->forward(x);
+  ASSERT_LT((y - expected).abs().max().item<float>(), 0.1);
+
+  auto clone = std::dynamic_pointer_cast<QuantizedLinearImpl>(model->clone());
+  ASSERT_TRUE(clone->forward(x).allclose(y));
+}
+
 TEST_F(ModulesTest, SimpleContainer) {
   auto model = std::make_shared<SimpleContainer>();
   auto l1 = model->add(Linear(10, 3), "l1");
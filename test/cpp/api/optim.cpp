@@ -320,6 +320,47 @@ TEST(OptimTest, ExternalVectorOfParameters) {
   ASSERT_TRUE(parameters[2].allclose(original_parameters[2] - 1.0));
 }
 
+template <typename OptimizerClass, typename Options>
+void check_sparse_embedding_step(Options options) {
+  torch::manual_seed(0);
+
+  const auto indices = torch::tensor({1, 3, 3, 7, 1, 1}, torch::kLong);
+  auto dense = torch::randn({10, 4}).set_requires_grad(true);
+  auto sparse = dense.detach().clone().set_requires_grad(true);
+
+  OptimizerClass dense_optimizer(std::vector<torch::Tensor>{dense}, options);
+  OptimizerClass sparse_optimizer(std::vector<torch::Tensor>{sparse}, options);
+  for (size_t step = 0; step < 3; ++step) {
+    dense_optimizer.zero_grad();
+    sparse_optimizer.zero_grad();
+    torch::embedding(dense, indices, -1, false, /*sparse=*/false).pow(2).sum().backward();
+    torch::embedding(sparse, indices, -1, false, /*sparse=*/true).pow(2).sum().backward();
+
+    // One coalesced row of values per distinct index
+    ASSERT_TRUE(sparse.grad().is_sparse());
+    ASSERT_TRUE(sparse.grad().is_coalesced());
+    ASSERT_EQ(sparse.grad()._nnz(), 3);
+
+    dense_optimizer.step();
+    sparse_optimizer.step();
+    ASSERT_TRUE(dense.allclose(sparse, 1e-5, 1e-6));
+  }
+}
+
+TEST(OptimTest, SparseGradients_SGD) {
+  check_sparse_embedding_step<SGD>(SGDOptions(0.1));
+  ASSERT_THROWS_WITH(
+      check_sparse_embedding_step<SGD>(SGDOptions(0.1).momentum(0.9)),
+      "does not support sparse gradients");
+}
+
+TEST(OptimTest, SparseGradients_Adagrad) {
+  check_sparse_embedding_step<Adagrad>(AdagradOptions(0.1).lr_decay(1e-3));
+  ASSERT_THROWS_WITH(
+      check_sparse_embedding_step<Adagrad>(AdagradOptions(0.1).weight_decay(1e-2)),
+      "not compatible with sparse gradients");
+}
+
 TEST(OptimTest, AddParameter_LBFGS) {
   torch::manual_seed(0);
 
@@ -338,3 +379,88 @@ TEST(OptimTest, AddParameter_LBFGS) {
 
   // REQUIRE this doesn't throw
 }
+
+TEST(OptimTest, MasterWeights_MatchesPlainSGD) {
+  torch::manual_seed(0);
+
+  Linear model(4, 3);
+  Linear reference(4, 3);
+  {
+    torch::NoGradGuard guard;
+    reference->weight.copy_(model->weight);
+    reference->bias.copy_(model->bias);
+  }
+
+  MasterWeights master(model->parameters());
+  ASSERT_EQ(master.master_parameters().size(), 1);
+  ASSERT_EQ(master.master_parameters()[0].numel(), 4 * 3 + 3);
+
+  SGD optimizer(master.master_parameters(), SGDOptions(0.1).momentum(0.9));
+  SGD reference_optimizer(reference->parameters(), SGDOptions(0.1).momentum(0.9));
+  // loss scaling is undone before the step
+  DynamicLossScaler scaler(DynamicLossScalerOptions().init_scale(256));
+  for (size_t step = 0; step < 3; ++step) {
+    const auto input = torch::randn({5, 4});
+    master.zero_grad();
+    reference_optimizer.zero_grad();
+    scaler.scale(model->forward(input).pow(2).sum()).backward();
+    reference->forward(input).pow(2).sum().backward();
+    ASSERT_TRUE(master.step(optimizer, scaler));
+    reference_optimizer.step();
+    ASSERT_TRUE(model->weight.allclose(reference->weight, 1e-5, 1e-6));
+    ASSERT_TRUE(model->bias.allclose(reference->bias, 1e-5, 1e-6));
+  }
+}
+
+TEST(OptimTest, MasterWeights_SkipsStepOnOverflow) {
+  auto parameter = torch::ones({3});
+  MasterWeights master({parameter});
+  SGD optimizer(master.master_parameters(), 1.0);
+  DynamicLossScaler scaler(DynamicLossScalerOptions().init_scale(8));
+
+  parameter.grad() = torch::tensor({1.0f, INFINITY, 1.0f});
+  ASSERT_FALSE(master.step(optimizer, scaler));
+  ASSERT_TRUE(parameter.allclose(torch::ones({3})));
+  ASSERT_EQ(scaler.scale(), 4);
+
+  parameter.grad() = torch::full({3}, 4);
+  ASSERT_TRUE(master.step(optimizer, scaler));
+  ASSERT_TRUE(parameter.allclose(torch::zeros({3})));
+}
+
+TEST(OptimTest, DynamicLossScaler) {
+  DynamicLossScaler scaler(
+      DynamicLossScalerOptions().init_scale(16).growth_interval(2));
+  ASSERT_EQ(scaler.scale(), 16);
+  ASSERT_FALSE(scaler.update(/*found_overflow=*/true));
+  ASSERT_EQ(scaler.scale(), 8);
+  ASSERT_TRUE(scaler.update(/*found_overflow=*/false));
+  ASSERT_EQ(scaler.scale(), 8);
+  ASSERT_TRUE(scaler.update(/*found_overflow=*/false));
+  ASSERT_EQ(scaler.scale(), 16);
+  // an overflow restarts the count of steps without overflow
+  ASSERT_TRUE(scaler.update(/*found_overflow=*/false));
+  ASSERT_FALSE(scaler.update(/*found_overflow=*/true));
+  ASSERT_TRUE(scaler.update(/*found_overflow=*/false));
+  ASSERT_EQ(scaler.scale(), 8);
+}
+
+TEST(OptimTest, MasterWeights_HalfParameters_CUDA) {
+  torch::manual_seed(0);
+
+  Linear model(4, 3);
+  model->to(torch::kCUDA, torch::kHalf);
+  MasterWeights master(model->parameters());
+  ASSERT_EQ(master.master_parameters()[0].dtype(), torch::kFloat);
+  ASSERT_TRUE(master.master_parameters()[0].is_cuda());
+
+  SGD optimizer(master.master_parameters(), 0.1);
+  DynamicLossScaler scaler;
+  const auto before = model->weight.to(torch::kFloat);
+  master.zero_grad();
+  const auto input = torch::randn({5, 4}, torch::device(torch::kCUDA).dtype(torch::kHalf));
+  scaler.scale(model->forward(input).to(torch::kFloat).sum()).backward();
+  ASSERT_TRUE(master.step(optimizer, scaler));
+  ASSERT_EQ(model->weight.dtype(), torch::kHalf);
+  ASSERT_FALSE(model->weight.to(torch::kFloat).allclose(before));
+}
@@ -229,3 +229,50 @@ TEST_F(ParallelTest, DataParallelUsesAllAvailableCUDADevices_CUDA) {
     ASSERT_EQ(output[i].item<int32_t>(), i);
   }
 }
+
+TEST_F(ParallelTest, DataParallelKeepsReplicasInSync_MultiCUDA) {
+  Linear linear(3, 4);
+  linear->to({torch::kCUDA, 0});
+  parallel::DataParallel<Linear> parallel(
+      linear,
+      std::vector<torch::Device>{torch::Device(torch::kCUDA, 0),
+                                 torch::Device(torch::kCUDA, 1)});
+
+  auto input = torch::ones({10, 3});
+  auto output = parallel.forward(input);
+  ASSERT_EQ(output.device(), torch::Device(torch::kCUDA, 0));
+  ASSERT_TRUE(output.allclose(linear->forward(input.to({torch::kCUDA, 0}))));
+
+  // An update of the parameters of the module reaches the other replica
+  {
+    torch::NoGradGuard guard;
+    linear->weight.add_(1);
+  }
+  output = parallel.forward(input);
+  ASSERT_TRUE(output.allclose(linear->forward(input.to({torch::kCUDA, 0}))));
+}
+
+TEST_F(ParallelTest, DataParallelReducesGradients_MultiCUDA) {
+  Linear linear(3, 4);
+  linear->to({torch::kCUDA, 0});
+  parallel::DataParallel<Linear> parallel(
+      linear,
+      std::vector<torch::Device>{torch::Device(torch::kCUDA, 0),
+                                 torch::Device(torch::kCUDA, 1)});
+
+  auto input = torch::ones({10, 3});
+  parallel.forward(input).sum().backward();
+  parallel.reduce_gradients();
+
+  auto expected = [&] {
+    Linear reference(std::dynamic_pointer_cast<LinearImpl>(linear->clone()));
+    reference->zero_grad();
+    reference->forward(input.to({torch::kCUDA, 0})).sum().backward();
+    return reference->weight.grad();
+  }();
+  ASSERT_TRUE(linear->weight.grad().allclose(expected));
+
+  // The gradients of the other replica are zeroed out once reduced
+  parallel.reduce_gradients();
+  ASSERT_TRUE(linear->weight.grad().allclose(expected));
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <torch/nn/modules/functional.h>
+#include <torch/nn/modules/linear.h>
+#include <torch/nn/modules/sequential.h>
+#include <torch/nn/parallel/pipeline.h>
+#include <torch/types.h>
+#include <torch/utils.h>
+
+#include <test/cpp/api/support.h>
+
+#include <memory>
+#include <vector>
+
+using namespace torch::nn;
+using namespace torch::test;
+
+struct PipelineTest : torch::test::SeedingFixture {};
+
+namespace {
+Sequential make_model() {
+  return Sequential(
+      Linear(4, 8),
+      Functional(torch::tanh),
+      Linear(8, 8),
+      Functional(torch::tanh),
+      Linear(8, 2));
+}
+
+Sequential clone_model(const Sequential& model) {
+  return Sequential(
+      std::dynamic_pointer_cast<SequentialImpl>(model->clone()));
+}
+
+// Runs the model and the pipeline on the same batch, and checks that the
+// outputs and the gradients of the parameters are the same
+void check_pipeline(
+    const std::vector<torch::Device>& devices,
+    parallel::PipelineOptions options) {
+  auto model = make_model();
+  auto reference = clone_model(model);
+  parallel::PipelineParallel pipeline(model, devices, options);
+
+  auto input = torch::randn({10, 4}, torch::requires_grad());
+  auto expected = reference->forward(input);
+  expected.sum().backward();
+  auto expected_grad = input.grad().clone();
+  input.grad().zero_();
+
+  auto output = pipeline.forward(input.to(devices.front()));
+  ASSERT_EQ(output.device(), devices.back());
+  ASSERT_TRUE(output.to(torch::kCPU).allclose(expected, 1e-5, 1e-6));
+  output.sum().backward();
+  ASSERT_TRUE(input.grad().allclose(expected_grad, 1e-5, 1e-6));
+
+  auto parameters = model->parameters();
+  auto reference_parameters = reference->parameters();
+  ASSERT_EQ(parameters.size(), reference_parameters.size());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    ASSERT_TRUE(parameters[i].grad().defined());
+    ASSERT_TRUE(parameters[i].grad().to(torch::kCPU).allclose(
+        reference_parameters[i].grad(), 1e-5, 1e-6));
+  }
+}
+} // namespace
+
+TEST_F(PipelineTest, SplitsModulesEvenlyByDefault) {
+  parallel::PipelineParallel pipeline(
+      make_model(), {torch::kCPU, torch::kCPU});
+  ASSERT_EQ(pipeline.balance(), std::vector<size_t>({3, 2}));
+}
+
+TEST_F(PipelineTest, ChecksOptions) {
+  ASSERT_THROWS_WITH(
+      parallel::PipelineParallel(
+          make_model(),
+          {torch::kCPU, torch::kCPU},
+          parallel::PipelineOptions(2).balance({1, 2})),
+      "The balance adds up to 3 modules, but the Sequential has 5");
+  ASSERT_THROWS_WITH(
+      parallel::PipelineParallel(
+          make_model(),
+          {torch::kCPU, torch::kCPU},
+          parallel::PipelineOptions(2).balance({5})),
+      "Expected the balance to have an entry per device (2), but got 1");
+  ASSERT_THROWS_WITH(
+      parallel::PipelineParallel(
+          make_model(), {torch::kCPU}, parallel::PipelineOptions(0)),
+      "PipelineParallel expects a positive number of chunks, but got 0");
+}
+
+TEST_F(PipelineTest, MatchesSequential) {
+  check_pipeline(
+      {torch::kCPU, torch::kCPU, torch::kCPU},
+      parallel::PipelineOptions(/*chunks=*/4));
+}
+
+TEST_F(PipelineTest, MatchesSequentialWithMoreChunksThanRows) {
+  check_pipeline(
+      {torch::kCPU, torch::kCPU}, parallel::PipelineOptions(/*chunks=*/16));
+}
+
+TEST_F(PipelineTest, MatchesSequentialWithCheckpointing) {
+  check_pipeline(
+      {torch::kCPU, torch::kCPU},
+      parallel::PipelineOptions(/*chunks=*/3)
+          .balance({2, 3})
+          .checkpoint({true, false}));
+}
+
+TEST_F(PipelineTest, RunsWithoutGrad) {
+  auto model = make_model();
+  parallel::PipelineParallel pipeline(
+      model,
+      {torch::kCPU, torch::kCPU},
+      parallel::PipelineOptions(2).checkpoint({true, true}));
+  torch::NoGradGuard no_grad;
+  auto output = pipeline.forward(torch::randn({4, 4}));
+  ASSERT_FALSE(output.requires_grad());
+  ASSERT_EQ(output.sizes(), std::vector<int64_t>({4, 2}));
+}
+
+TEST_F(PipelineTest, MatchesSequential_MultiCUDA) {
+  check_pipeline(
+      {torch::Device(torch::kCUDA, 0), torch::Device(torch::kCUDA, 1)},
+      parallel::PipelineOptions(/*chunks=*/4));
+}
+
+TEST_F(PipelineTest, MatchesSequentialWithCheckpointing_MultiCUDA) {
+  check_pipeline(
+      {torch::Device(torch::kCUDA, 0), torch::Device(torch::kCUDA, 1)},
+      parallel::PipelineOptions(/*chunks=*/4).checkpoint({true, true}));
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <torch/nn/modules/linear.h>
+#include <torch/nn/modules/quantized.h>
 #include <torch/nn/modules/rnn.h>
 #include <torch/optim/adam.h>
 #include <torch/types.h>
@@ -209,6 +210,23 @@ TEST_F(RNNTest, Sizes_CUDA) {
   ASSERT_GT(diff.abs().sum().item<float>(), 1e-3);
 }
 
+TEST_F(RNNTest, QuantizedLSTM) {
+  if (!torch::fbgemm_is_cpu_supported()) {
+    return;
+  }
+  LSTM lstm(LSTMOptions(8, 16).layers(2).batch_first(true));
+  QuantizedLSTM model(*lstm);
+  auto x = torch::randn({3, 5, 8});
+  auto output = model->forward(x);
+  ASSERT_EQ(output.output.sizes(), torch::IntList({3, 5, 16}));
+  ASSERT_EQ(output.state.sizes(), torch::IntList({2, 2, 3, 16}));
+
+  torch::NoGradGuard no_grad;
+  auto expected = lstm->forward(x);
+  ASSERT_LT((output.output - expected.output).abs().max().item<float>(), 0.1);
+  ASSERT_LT((output.state - expected.state).abs().max().item<float>(), 0.1);
+}
+
 TEST_F(RNNTest, EndToEndLSTM_CUDA) {
   ASSERT_TRUE(test_RNN_xor<LSTM>(
       [](int s) { return LSTM(LSTMOptions(s, s).layers(2)); }, true));
@@ -12,6 +12,7 @@
 #include <test/cpp/api/support.h>
 
 #include <cstdio>
+#include <future>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -143,6 +144,91 @@ TEST(SerializeTest, XOR) {
   ASSERT_LT(loss.item<float>(), 0.1);
 }
 
+TEST(SerializeTest, SaveToAsync) {
+  torch::manual_seed(0);
+
+  auto x = torch::randn({5, 5});
+  auto tempfile = torch::utils::make_tempfile();
+  std::future<void> saved;
+  {
+    OutputArchive archive;
+    archive << x;
+    saved = archive.save_to_async(tempfile.name);
+  }
+  // The archive holds a snapshot of the data
+  auto expected = x.clone();
+  x.zero_();
+  saved.get();
+
+  torch::Tensor y;
+  torch::load(y, tempfile.name);
+  ASSERT_TRUE(y.defined());
+  ASSERT_TRUE(expected.allclose(y));
+}
+
+TEST(SerializeTest, IncrementalCheckpoint) {
+  torch::manual_seed(0);
+
+  auto model = Linear(5, 2);
+  auto model2 = Linear(5, 2);
+  auto tempfile = torch::utils::make_tempfile();
+  IncrementalCheckpoint checkpoint(tempfile.name);
+  auto save = [&] {
+    OutputArchive archive;
+    archive << model;
+    return checkpoint.save(archive);
+  };
+  auto assert_loaded_equal = [&] {
+    torch::load(model2, tempfile.name);
+    for (const auto& p : model->named_parameters()) {
+      ASSERT_TRUE(p->allclose(model2->named_parameters()[p.key()]));
+    }
+  };
+
+  // The first save writes all parameters, and later saves only the modified
+  // ones
+  ASSERT_EQ(save(), 2);
+  assert_loaded_equal();
+  ASSERT_EQ(save(), 0);
+  {
+    torch::NoGradGuard guard;
+    model->weight.add_(1);
+  }
+  ASSERT_EQ(save(), 1);
+  assert_loaded_equal();
+
+  // Replaced parameters are written as well
+  {
+    torch::NoGradGuard guard;
+    model->bias.set_data(torch::ones({2}));
+  }
+  ASSERT_EQ(save(), 1);
+  assert_loaded_equal();
+
+  // A different structure writes the whole file again
+  model = Linear(5, 3);
+  ASSERT_EQ(save(), 2);
+  model2 = Linear(5, 3);
+  assert_loaded_equal();
+
+  // Asynchronous saves work the same way
+  {
+    torch::NoGradGuard guard;
+    model->bias.add_(1);
+  }
+  OutputArchive archive;
+  archive << model;
+  auto saved = checkpoint.save_async(archive);
+  auto expected = model->bias.clone();
+  {
+    torch::NoGradGuard guard;
+    model->bias.add_(1);
+  }
+  saved.get();
+  torch::load(model2, tempfile.name);
+  ASSERT_TRUE(model2->bias.allclose(expected));
+}
+
 TEST(SerializeTest, Optim) {
   auto model1 = Linear(5, 2);
   auto model2 = Linear(5, 2);
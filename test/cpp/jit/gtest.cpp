@@ -18,9 +18,11 @@ JIT_TEST(ControlFlow)
 JIT_TEST(CreateAutodiffSubgraphs)
 JIT_TEST(CustomOperators)
 JIT_TEST(Differentiate)
+JIT_TEST(DifferentiateWithRecompute)
 JIT_TEST(DifferentiateWithRequiresGrad)
 JIT_TEST(DynamicDAG)
 JIT_TEST(FromQualString)
+JIT_TEST(FuseComparisons)
 JIT_TEST(InternedStrings)
 JIT_TEST(IValue)
 JIT_TEST(SchemaParser)
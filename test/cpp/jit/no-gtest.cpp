@@ -16,9 +16,11 @@ std::string runJITCPPTests() {
   testCreateAutodiffSubgraphs(out);
   testCustomOperators();
   testDifferentiate(out);
+  testDifferentiateWithRecompute();
   testDifferentiateWithRequiresGrad(out);
   testDynamicDAG();
   testFromQualString();
+  testFuseComparisons();
   testFusion();
   testGraphExecutor();
   testInternedStrings();
@@ -45,6 +45,7 @@
 #include "torch/csrc/jit/passes/constant_propagation.h"
 #include "torch/csrc/jit/passes/create_autodiff_subgraphs.h"
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/passes/graph_fuser.h"
 #include "torch/csrc/jit/passes/lower_grad_of.h"
 #include "torch/csrc/jit/passes/lower_tuples.h"
 #include "torch/csrc/jit/passes/requires_grad_analysis.h"
@@ -74,6 +75,7 @@
 #include <cstddef>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -271,6 +273,38 @@ void testFusion() {
   testConcat(2);
 }
 
+void testFuseComparisons() {
+  auto count = [](Graph& graph, NodeKind kind) {
+    return std::count_if(
+        graph.nodes().begin(), graph.nodes().end(), [&](Node* n) {
+          return n->kind() == kind;
+        });
+  };
+
+  // The gradient of relu, with its mask, goes in a single kernel
+  auto graph = std::make_shared<Graph>();
+  auto grad = SymbolicVariable::asNewInput(*graph);
+  auto output = SymbolicVariable::asNewInput(*graph);
+  graph->registerOutput(
+      (grad * (output > at::Scalar(0)).type_as(output)).value());
+  FuseGraph(graph);
+#ifndef _WIN32
+  ASSERT_EQ(count(*graph, prim::FusionGroup), 1);
+  ASSERT_EQ(count(*graph, aten::gt), 0);
+#endif
+
+  // A mask used outside of the group would be an output of the kernel, which
+  // only writes floating point values
+  auto other_graph = std::make_shared<Graph>();
+  grad = SymbolicVariable::asNewInput(*other_graph);
+  output = SymbolicVariable::asNewInput(*other_graph);
+  auto mask = output > at::Scalar(0);
+  other_graph->registerOutput((grad * mask.type_as(output)).value());
+  other_graph->registerOutput(mask.value());
+  FuseGraph(other_graph);
+  ASSERT_EQ(count(*other_graph, aten::gt), 1);
+}
+
 struct Attr : public Attributes<Attr> {};
 void testAttributes() {
   auto one = attr::alpha;
@@ -850,6 +884,51 @@ void testDifferentiate(std::ostream& out = std::cout) {
   out << "\n";
 }
 
+void testDifferentiateWithRecompute() {
+  auto graph = std::make_shared<Graph>();
+  auto a = SymbolicVariable::asNewInput(*graph);
+  auto b = SymbolicVariable::asNewInput(*graph);
+  auto c = a * b * a + b;
+  graph->registerOutput(c.value());
+
+  auto a_var = autograd::make_variable(at::randn({2, 3, 4}), true);
+  auto b_var = autograd::make_variable(at::randn({2, 3, 4}), true);
+  setInputTypes(*graph, ArgumentSpec(true, {a_var, b_var}, 2));
+  PropagateInputShapes(*graph);
+
+  const auto threshold = autodiffRecomputeThreshold();
+  setAutodiffRecomputeThreshold(0);
+  auto grad_spec = differentiate(graph);
+  setAutodiffRecomputeThreshold(threshold);
+  // a * b is computed again in df, from the inputs it captures anyway
+  ASSERT_EQ(grad_spec.f_real_outputs, 1);
+  ASSERT_EQ(grad_spec.df_input_captured_inputs, std::vector<size_t>({0, 1}));
+  ASSERT_TRUE(grad_spec.df_input_captured_outputs.empty());
+
+  Variable c_var = a_var * b_var * a_var + b_var;
+  auto c_grad = autograd::make_variable(at::randn({2, 3, 4}), false);
+  auto expected_grads = grad({c_var}, {a_var, b_var}, {c_grad});
+  tensor_list tensors_in = {a_var.data(), b_var.data()};
+  tensor_list tensor_grads_in = {c_grad.data()};
+  tensor_list tensors_out, tensor_grads_out;
+  std::tie(tensors_out, tensor_grads_out) =
+      runGradient(grad_spec, tensors_in, tensor_grads_in);
+  assertAllClose(tensors_out, {c_var.data()});
+  assertAllClose(
+      tensor_grads_out, {expected_grads[0].data(), expected_grads[1].data()});
+
+  // Without shapes, a * b is still recomputed, as df needs nothing else for it
+  auto untyped_graph = std::make_shared<Graph>();
+  auto x = SymbolicVariable::asNewInput(*untyped_graph);
+  auto y = SymbolicVariable::asNewInput(*untyped_graph);
+  untyped_graph->registerOutput((x * y * x + y).value());
+  setAutodiffRecomputeThreshold(std::numeric_limits<int64_t>::max());
+  auto untyped_spec = differentiate(untyped_graph);
+  setAutodiffRecomputeThreshold(threshold);
+  ASSERT_EQ(untyped_spec.f_real_outputs, 1);
+  ASSERT_TRUE(untyped_spec.df_input_captured_outputs.empty());
+}
+
 void testDifferentiateWithRequiresGrad(std::ostream& out = std::cout) {
   // Build up a fake graph
   auto graph = std::make_shared<Graph>();
@@ -202,6 +202,21 @@ class TestAutograd(TestCase):
         x_grad, x_grad_clone = compute_grad(create_graph=True)
         self.assertEqual(x_grad, x_grad_clone)
 
+    def test_input_buffer_accumulation(self):
+        # the gradients flowing into a function are summed in place only into
+        # tensors that nothing else holds or shares the storage of
+        x = torch.randn(5, requires_grad=True)
+        grad_output = torch.randn(5)
+        grad_output_clone = grad_output.clone()
+        y = x.exp()
+        z = y * 1
+        held = []
+        z.register_hook(held.append)
+        (y * 2 + z + y.view(5) + y).backward(grad_output)
+        self.assertEqual(grad_output, grad_output_clone)
+        self.assertEqual(held[0], grad_output_clone)
+        self.assertEqual(x.grad, grad_output_clone * 5 * x.detach().exp())
+
     def test_hessian_vector(self):
         x = torch.randn(2, 2, requires_grad=True)
         y = torch.randn(2, 2, requires_grad=True)
@@ -1427,6 +1442,19 @@ class TestAutograd(TestCase):
         gradcheck(func, [root, values])
         gradgradcheck(func, [root, values])
 
+    def test_index_put_accumulate(self):
+        root = torch.randn(4, 5, requires_grad=True)
+        values = torch.randn(6, 5, requires_grad=True)
+        idx = Variable(torch.LongTensor([1, 2, 3, 1, 2, 3]))
+
+        def func(root, values):
+            x = root.clone()
+            x.index_put_((idx,), values, accumulate=True)
+            return x
+
+        gradcheck(func, [root, values])
+        gradgradcheck(func, [root, values])
+
     def test_fill(self):
         root = torch.randn(4, 5, requires_grad=True)
 
@@ -1981,6 +2009,151 @@ class TestAutograd(TestCase):
         out.sum().backward()
         self.assertEqual(x.grad.data, y_data)
 
+    def test_num_cpu_threads(self):
+        # the engine threads are started by the first backward pass, so the
+        # number of threads can't be changed anymore
+        torch.ones(1, requires_grad=True).sum().backward()
+        self.assertGreaterEqual(torch.autograd.get_num_cpu_threads(), 1)
+        with self.assertRaisesRegex(RuntimeError, 'after the first backward'):
+            torch.autograd.set_num_cpu_threads(2)
+
+    def test_multithreaded_cpu_backward(self):
+        # independent branches and reentrant backward calls with several CPU
+        # workers, in a fresh process so that the threads can be configured
+        script = """
+import torch
+from torch.autograd import Function
+torch.autograd.set_num_cpu_threads(4)
+assert torch.autograd.get_num_cpu_threads() == 4
+
+class Reenter(Function):
+    @staticmethod
+    def forward(ctx, x):
+        with torch.enable_grad():
+            ctx.x = x.detach().requires_grad_()
+            ctx.output = ctx.x * 3
+        return ctx.output.detach()
+
+    @staticmethod
+    def backward(ctx, grad_output):
+        with torch.enable_grad():
+            ctx.output.sum().backward()
+        return ctx.x.grad * grad_output
+
+x = torch.randn(10, 10, requires_grad=True)
+for _ in range(20):
+    x.grad = None
+    branches = [(x * i).tanh() for i in range(16)]
+    branches += [Reenter.apply(x) for _ in range(4)]
+    sum(b.sum() for b in branches).backward()
+    expected = sum(i * (1 - (x * i).tanh() ** 2) for i in range(16)) + 12
+    assert (x.grad - expected).abs().max().item() < 1e-4
+"""
+        import subprocess
+        subprocess.check_call([sys.executable, '-c', script])
+
+    def test_function_priority(self):
+        a = torch.randn(5, requires_grad=True)
+        b = torch.randn(5, requires_grad=True)
+        order = []
+        a.register_hook(lambda grad: order.append('a'))
+        b.register_hook(lambda grad: order.append('b'))
+
+        def run_backward():
+            del order[:]
+            x = (a * 2).exp().sum()
+            y = (b * 3).exp().sum()
+            (x + y).backward()
+            return list(order)
+
+        # by default, functions created later run first
+        self.assertEqual(run_backward(), ['b', 'a'])
+
+        acc_a = a.expand_as(a).grad_fn.next_functions[0][0]
+        self.assertEqual(acc_a.priority, 0)
+        acc_a.priority = 1
+        self.assertEqual(acc_a.priority, 1)
+        self.assertEqual(run_backward(), ['a', 'b'])
+        acc_a.priority = 0
+        self.assertEqual(run_backward(), ['b', 'a'])
+
+        with self.assertRaisesRegex(TypeError, 'priority must be an int'):
+            acc_a.priority = 'high'
+
+    def test_saved_tensors_hooks(self):
+        packed = []
+        unpacked = []
+
+        def pack(tensor):
+            self.assertFalse(tensor.requires_grad)
+            packed.append(tensor)
+            return ('packed', tensor.clone())
+
+        def unpack(p):
+            self.assertEqual(p[0], 'packed')
+            unpacked.append(p[1])
+            return p[1]
+
+        x = torch.randn(5, 5, requires_grad=True)
+        with torch.autograd.saved_tensors_hooks(pack, unpack):
+            y = (x * x).exp().sum()
+        # x is saved twice by mul, the output of exp once
+        self.assertEqual(len(packed), 3)
+        z = (x * x).exp().sum()
+        self.assertEqual(len(packed), 3)
+
+        y.backward()
+        self.assertEqual(len(unpacked), 3)
+        grad = x.grad.clone()
+        x.grad.zero_()
+        z.backward()
+        self.assertEqual(x.grad, grad)
+
+        # hooks that keep some tensors as they are
+        with torch.autograd.saved_tensors_hooks(lambda t: None, unpack):
+            y = (x * x).sum()
+        x.grad.zero_()
+        y.backward()
+        self.assertEqual(x.grad, 2 * x)
+        self.assertEqual(len(unpacked), 3)
+
+        a = torch.randn(5, 5, requires_grad=True)
+        with torch.autograd.saved_tensors_hooks(pack, lambda p: 'not a tensor'):
+            y = (a * a).sum()
+        with self.assertRaisesRegex(TypeError, 'must return a Tensor'):
+            y.backward()
+
+    def test_saved_tensors_hooks_nesting_and_prefetch(self):
+        prefetched = []
+        x = torch.randn(10, requires_grad=True)
+        with torch.autograd.saved_tensors_hooks(lambda t: ('outer', t), lambda p: p[1],
+                                                lambda p: prefetched.append(p[0])):
+            with torch.autograd.saved_tensors_hooks(lambda t: ('inner', t), lambda p: p[1],
+                                                    lambda p: prefetched.append(p[0])):
+                y = x.sin()
+            z = y.cos()
+        (z.sum()).backward()
+        # the saved tensors are prefetched before the functions run
+        self.assertEqual(sorted(prefetched), ['inner', 'outer'])
+        self.assertEqual(x.grad, -(x.sin().sin()) * x.cos())
+
+    def test_save_as_half(self):
+        x = torch.randn(64, 64, requires_grad=True)
+        with torch.autograd.save_as_half(min_numel=1):
+            y = (x * x).sum()
+        y.backward()
+        self.assertEqual(x.grad, 2 * x, prec=1e-2)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA not available")
+    def test_save_on_cpu(self):
+        x = torch.randn(128, 128, device='cuda', requires_grad=True)
+        with torch.autograd.save_on_cpu(min_numel=1):
+            y = x.exp().mul(x).tanh().sum()
+        y.backward()
+        x_ = x.detach().requires_grad_()
+        x_.exp().mul(x_).tanh().sum().backward()
+        self.assertEqual(x.grad, x_.grad)
+
     def test_broadcast_tensors(self):
         f_args_variable = (torch.randn(3, requires_grad=True),
                            torch.randn(1, 2, 1, requires_grad=True),
@@ -2262,6 +2435,126 @@ class TestAutograd(TestCase):
             self.assertEqual(info.name, expected_name)
             last_end = info.cpu_interval.end
 
+    def test_profiler_sampling(self):
+        x = torch.randn(10, 10)
+
+        with profile(sample_period=3) as p:
+            for _ in range(9):
+                x.mul(2)
+
+        self.assertEqual(len(p.function_events), 3)
+        self.assertTrue(all(evt.name == 'mul' for evt in p.function_events))
+
+    def test_profiler_max_events(self):
+        x = torch.randn(10, 10)
+
+        with profile(max_events_per_thread=4) as p:
+            x.mul(2)
+            x.add(2)
+            x.sub(2)
+            x.div(2)
+
+        # each operation records a push and a pop
+        self.assertEqual([evt.name for evt in p.function_events], ['sub', 'div'])
+
+    def test_profiler_trace_path(self):
+        import json
+        import os
+        import tempfile
+        x = torch.randn(10, 10)
+
+        fd, path = tempfile.mkstemp(suffix='.json')
+        os.close(fd)
+        try:
+            with profile(trace_path=path, max_events_per_thread=2) as p:
+                for _ in range(5):
+                    x.mul(2)
+            self.assertEqual(len(p.function_events), 0)
+            with open(path) as f:
+                trace = json.load(f)
+        finally:
+            os.remove(path)
+        begins = [evt for evt in trace if evt['ph'] == 'B']
+        ends = [evt for evt in trace if evt['ph'] == 'E']
+        self.assertEqual([evt['name'] for evt in begins], ['mul'] * 5)
+        self.assertEqual(len(ends), 5)
+        for begin, end in zip(begins, ends):
+            self.assertLessEqual(begin['ts'], end['ts'])
+
+    def test_profiler_request_id(self):
+        @torch.jit.script
+        def f(x):
+            return x.mul(2)
+
+        x = torch.randn(10, 10)
+        with profile() as p:
+            x.mul(2)
+            f(x)
+            f(x)
+        request_ids = [evt.request_id for evt in p.function_events if evt.name == 'mul']
+        # outside of a script method, there is no request
+        self.assertEqual(request_ids[0], 0)
+        # every call of a script method is a request of its own
+        self.assertNotIn(0, request_ids[1:])
+        self.assertEqual(len(set(request_ids[1:])), 2)
+
+    def test_profiler_shapes(self):
+        a = torch.randn(4, 5)
+        b = torch.randn(5, 6)
+        c = torch.randn(8, 5)
+
+        with profile(record_shapes=True) as p:
+            a.mm(b)
+            c.mm(b)
+            c.mm(b)
+            a.add(1)
+
+        mms = [evt for evt in p.function_events if evt.name == 'mm']
+        self.assertEqual(mms[0].input_shapes, [[4, 5], [5, 6]])
+        self.assertEqual(mms[0].flops, 2 * 4 * 5 * 6)
+        self.assertEqual(mms[0].bytes, (4 * 5 + 5 * 6 + 4 * 6) * 4)
+        self.assertEqual(mms[1].flops, 2 * 8 * 5 * 6)
+
+        averages = p.key_averages(group_by_input_shape=True)
+        mm_averages = sorted((avg for avg in averages if avg.key == 'mm'),
+                             key=lambda avg: avg.count)
+        self.assertEqual(len(mm_averages), 2)
+        self.assertEqual(mm_averages[0].input_shapes, [[4, 5], [5, 6]])
+        self.assertEqual(mm_averages[1].input_shapes, [[8, 5], [5, 6]])
+        self.assertEqual(mm_averages[1].flops_total, 2 * 2 * 8 * 5 * 6)
+        self.assertIn('Input shapes', averages.table())
+
+        with profile() as p:
+            a.mm(b)
+        self.assertIsNone(p.function_events[0].input_shapes)
+
+    def test_profile_backward_memory(self):
+        x = torch.randn(4, 5, requires_grad=True)
+        w = torch.randn(5, 6, requires_grad=True)
+        y = x.mm(w).sum()
+
+        with torch.autograd.profiler.profile_backward_memory() as p:
+            y.backward()
+        self.assertFalse(Variable._execution_engine.is_memory_debug())
+
+        mm = [r for r in p.records if r.name == 'MmBackward']
+        self.assertEqual(len(mm), 1)
+        self.assertEqual(mm[0].device, -1)
+        self.assertEqual(mm[0].input_bytes, 4 * 6 * 4)
+        self.assertEqual(mm[0].output_bytes, (4 * 5 + 5 * 6) * 4)
+        self.assertEqual(mm[0].allocated_bytes, -1)
+        self.assertEqual(len([r for r in p.records if 'AccumulateGrad' in r.name]), 2)
+        # The gradients of x and w are in flight once MmBackward finished
+        self.assertEqual(p.peak().name, 'MmBackward')
+        self.assertIn('MmBackward', p.table())
+
+        # Nothing is recorded outside of the context manager
+        y = x.mm(w).sum()
+        y.backward()
+        with torch.autograd.profiler.profile_backward_memory() as p:
+            pass
+        self.assertEqual(p.records, [])
+
     def test_dir(self):
         x = torch.randn(10, 10)
         keys = dir(x)
@@ -38,7 +38,8 @@ TestSkip = namedtuple('TestSkip', 'exit_code, message')
 TEST_SKIPS = {
     "multi-gpu": TestSkip(75, "Need at least 2 CUDA devices"),
     "nccl": TestSkip(76, "c10d not compiled with NCCL support"),
-    "known_issues": TestSkip(77, "Test skipped due to known issues")
+    "known_issues": TestSkip(77, "Test skipped due to known issues"),
+    "nccl_abort": TestSkip(78, "Aborting NCCL communicators requires NCCL 2.4+"),
 }
 
 
@@ -64,6 +65,17 @@ def skip_if_not_nccl(func):
     return wrapper
 
 
+def skip_if_nccl_cannot_abort(func):
+    """Skips a test if NCCL is too old to abort communicators."""
+    @wraps(func)
+    def wrapper(*args, **kwargs):
+        if torch.cuda.nccl.version() >= 2400:
+            return func(*args, **kwargs)
+        sys.exit(TEST_SKIPS['nccl_abort'].exit_code)
+
+    return wrapper
+
+
 def skip_for_known_issues(func):
     """Skips a test due to known issues (for c10d)."""
     @wraps(func)
@@ -142,6 +154,14 @@ class StoreTestBase(object):
     def test_set_get(self):
         self._test_set_get(self._create_store())
 
+    def _test_multi_set_get(self, fs):
+        fs.multi_set(["mkey0", "mkey1"], ["value0", "value1"])
+        self.assertEqual([b"value0", b"value1"], fs.multi_get(["mkey0", "mkey1"]))
+        self.assertEqual(b"value1", fs.get("mkey1"))
+
+    def test_multi_set_get(self):
+        self._test_multi_set_get(self._create_store())
+
 
 class FileStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -204,6 +224,13 @@ class TCPStoreTest(TestCase, StoreTestBase):
             store1 = c10d.TCPStore(addr, port, True)  # noqa: F841
             store2 = c10d.TCPStore(addr, port, True)  # noqa: F841
 
+    def test_compare_set(self):
+        store = self._create_store()
+        self.assertEqual(b"first", store.compare_set("key", "", "first"))
+        self.assertEqual(b"first", store.compare_set("key", "wrong", "second"))
+        self.assertEqual(b"second", store.compare_set("key", "first", "second"))
+        self.assertEqual(b"second", store.get("key"))
+
 
 class PrefixTCPStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -635,6 +662,56 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         inputs = [torch.Tensor([i + self.rank]).cuda() for i in range(1000)]
         self._test_allreduce_stress(inputs)
 
+    def test_allreduce_multi_device_stress(self):
+        # Collectives are spread over one context per device
+        store = c10d.FileStore(self.file.name, self.world_size)
+        opts = self.opts(threads=1)
+        opts.devices = [
+            c10d.ProcessGroupGloo.create_tcp_device(interface="lo"),
+            c10d.ProcessGroupGloo.create_tcp_device(interface="lo"),
+        ]
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+        inputs = [torch.Tensor([i + self.rank]) for i in range(100)]
+        work_handles = [pg.allreduce(inputs[i]) for i in range(len(inputs))]
+        for i, work_handle in enumerate(work_handles):
+            work_handle.wait()
+            self.assertEqual(
+                torch.Tensor([
+                    (i * self.world_size) +
+                    (self.world_size * (self.world_size - 1) / 2)
+                ]),
+                inputs[i],
+                "Mismatch in iteration %d" % i,
+            )
+
+    def _test_allreduce_coalesced(self, fn):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+        opts = c10d.AllreduceCoalescedOptions()
+        # small enough for the tensors to be split over a few buckets
+        opts.bucketSize = 64
+        sizes = [[3], [2, 5], [1], [7], [4, 4]]
+        tensors = [fn(torch.full(size, self.rank + 1.0)) for size in sizes]
+        expected = float(self.world_size * (self.world_size + 1) / 2)
+
+        pg.allreduce_coalesced(tensors, opts).wait()
+        for size, tensor in zip(sizes, tensors):
+            self.assertEqual(torch.full(size, expected), tensor)
+
+        # the tensors now live in the flat buckets, and are reduced in place
+        data_ptrs = [t.data_ptr() for t in tensors]
+        pg.allreduce_coalesced(tensors, opts).wait()
+        self.assertEqual(data_ptrs, [t.data_ptr() for t in tensors])
+        for size, tensor in zip(sizes, tensors):
+            self.assertEqual(torch.full(size, expected * self.world_size), tensor)
+
+    def test_allreduce_coalesced(self):
+        self._test_allreduce_coalesced(lambda t: t)
+
+    @skip_if_not_multigpu
+    def test_allreduce_coalesced_cuda(self):
+        self._test_allreduce_coalesced(lambda t: t.cuda())
+
     def test_scatter_checks(self):
         store = c10d.FileStore(self.file.name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -754,22 +831,22 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
             opts.rootRank = 0
             pg.gather([], [t1, t1], opts)
 
-        with self.assertRaisesRegex(ValueError, "requires a single-element output list"):
+        with self.assertRaisesRegex(ValueError, "requires a single-element output tensor list"):
             opts = c10d.GatherOptions()
             opts.rootRank = self.rank
             pg.gather([], [t1], opts)
 
-        with self.assertRaisesRegex(ValueError, "requires a single-element output list"):
+        with self.assertRaisesRegex(ValueError, "requires a single-element output tensor list"):
             opts = c10d.GatherOptions()
             opts.rootRank = self.rank
             pg.gather([[t1] * self.world_size, [t1] * self.world_size], [t1], opts)
 
-        with self.assertRaisesRegex(ValueError, "requires a single-element output list"):
+        with self.assertRaisesRegex(ValueError, "requires a single-element output tensor list"):
             opts = c10d.GatherOptions()
             opts.rootRank = self.rank
             pg.gather([[t1] * (self.world_size - 1)], [t1], opts)
 
-        with self.assertRaisesRegex(ValueError, "requires a single-element output list"):
+        with self.assertRaisesRegex(ValueError, "requires a single-element output tensor list"):
             opts = c10d.GatherOptions()
             opts.rootRank = self.rank
             pg.gather([[t1] * (self.world_size + 1)], [t1], opts)
@@ -872,6 +949,88 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
             work.wait()
             self.assertEqual(expected_output, output)
 
+    def test_reduce_scatter_checks(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        t1 = torch.zeros([1], dtype=torch.float32)
+        t2 = torch.zeros([1], dtype=torch.float64)
+        t3 = torch.zeros([2], dtype=torch.float32)
+
+        with self.assertRaisesRegex(ValueError, "requires a single-element output tensor list"):
+            pg.reduce_scatter([t1, t1], [[t1] * self.world_size])
+
+        with self.assertRaisesRegex(ValueError, "requires a single-element input list"):
+            pg.reduce_scatter(t1, [t1] * (self.world_size + 1))
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor type"):
+            pg.reduce_scatter(t1, [t2] * self.world_size)
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor size"):
+            pg.reduce_scatter(t1, [t3] * self.world_size)
+
+    def test_reduce_scatter_basics(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Rank r receives the reduction of (j * world_size + r) over ranks j
+        n = self.world_size
+        tests = [
+            (c10d.ReduceOp.SUM, n * (n - 1) / 2 * n + n * self.rank),
+            (c10d.ReduceOp.MIN, self.rank),
+            (c10d.ReduceOp.MAX, (n - 1) * n + self.rank),
+        ]
+        for (op, expected) in tests:
+            inputs = [torch.Tensor([self.rank * n + i]) for i in range(n)]
+            output = torch.Tensor([-1])
+            work = pg.reduce_scatter(output, inputs, op)
+            work.wait()
+            self.assertEqual(torch.Tensor([expected]), output)
+
+    def test_alltoall_checks(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        t1 = torch.zeros([self.world_size], dtype=torch.float32)
+        t2 = torch.zeros([self.world_size], dtype=torch.float64)
+        t3 = torch.zeros([self.world_size + 1], dtype=torch.float32)
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor type"):
+            pg.alltoall(t1, t2)
+
+        with self.assertRaisesRegex(ValueError, "isn't divisible by the group size"):
+            pg.alltoall(t1, t3)
+
+        with self.assertRaisesRegex(ValueError, "requires one split size per process"):
+            pg.alltoall(t1, t1, [1], [1])
+
+        with self.assertRaisesRegex(ValueError, "split sizes don't add up"):
+            pg.alltoall(t1, t1, [2] * self.world_size, [1] * self.world_size)
+
+    def test_alltoall_basics(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Even splits: rank r sends row i to rank i
+        input = torch.Tensor([[100 * self.rank + i] * 2 for i in range(self.world_size)])
+        output = torch.zeros(self.world_size, 2)
+        pg.alltoall(output, input).wait()
+        expected = torch.Tensor([[100 * i + self.rank] * 2 for i in range(self.world_size)])
+        self.assertEqual(expected, output)
+
+        # Uneven splits: rank r sends i + 1 rows to rank i
+        input_splits = [i + 1 for i in range(self.world_size)]
+        output_splits = [self.rank + 1] * self.world_size
+        input = torch.cat([
+            torch.Tensor([100 * self.rank + i] * (i + 1)) for i in range(self.world_size)
+        ])
+        output = torch.zeros(sum(output_splits))
+        pg.alltoall(output, input, output_splits, input_splits).wait()
+        expected = torch.cat([
+            torch.Tensor([100 * i + self.rank] * (self.rank + 1)) for i in range(self.world_size)
+        ])
+        self.assertEqual(expected, output)
+
     def test_reduce_checks(self):
         store = c10d.FileStore(self.file.name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -971,6 +1130,163 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         self.assertFalse(pg.barrier().wait())
 
 
+class ProcessGroupHierarchicalTest(MultiProcessTestCase):
+    # Two "nodes" with two processes each
+    local_size = 2
+
+    @property
+    def world_size(self):
+        return 4
+
+    def _create_process_group(self):
+        opts = c10d.ProcessGroupGloo.Options()
+        opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        opts.timeout = 5.0
+        node = self.rank // self.local_size
+        local_rank = self.rank % self.local_size
+        # PrefixStore only holds a reference to the store it wraps
+        self.store = c10d.FileStore(self.file.name, self.world_size)
+        self.intra_store = c10d.PrefixStore("intra/%d" % node, self.store)
+        self.inter_store = c10d.PrefixStore("inter/%d" % local_rank, self.store)
+        intra = c10d.ProcessGroupGloo(
+            self.intra_store, local_rank, self.local_size, opts)
+        inter = c10d.ProcessGroupGloo(
+            self.inter_store, node, self.world_size // self.local_size, opts)
+        return c10d.ProcessGroupHierarchical(intra, inter)
+
+    def test_rank_and_size(self):
+        pg = self._create_process_group()
+        self.assertEqual(self.rank, pg.rank())
+        self.assertEqual(self.world_size, pg.size())
+
+    def test_allreduce(self):
+        pg = self._create_process_group()
+        for (op, input, output) in simple_reduce_tests(self.rank, self.world_size):
+            opts = c10d.AllreduceOptions()
+            opts.reduceOp = op
+            work = pg.allreduce([input], opts)
+            self.assertTrue(work.wait())
+            self.assertEqual(output, input)
+
+        # Sizes that don't split evenly between the processes of a node
+        for numel in [1, 3, 10]:
+            input = torch.arange(numel, dtype=torch.float).view(-1, 1) * (self.rank + 1)
+            expected = torch.arange(numel, dtype=torch.float).view(-1, 1) * 10
+            self.assertTrue(pg.allreduce([input]).wait())
+            self.assertEqual(expected, input)
+
+    def test_broadcast(self):
+        pg = self._create_process_group()
+        for root in range(self.world_size):
+            opts = c10d.BroadcastOptions()
+            opts.rootRank = root
+            tensor = torch.Tensor([self.rank, self.rank])
+            self.assertTrue(pg.broadcast([tensor], opts).wait())
+            self.assertEqual(torch.Tensor([root, root]), tensor)
+
+    def test_reduce(self):
+        pg = self._create_process_group()
+        for root in range(self.world_size):
+            opts = c10d.ReduceOptions()
+            opts.rootRank = root
+            tensor = torch.Tensor([self.rank + 1])
+            self.assertTrue(pg.reduce([tensor], opts).wait())
+            if self.rank == root:
+                self.assertEqual(torch.Tensor([10]), tensor)
+
+    def test_allgather(self):
+        pg = self._create_process_group()
+        input = [torch.Tensor([self.rank, -self.rank])]
+        output = [[torch.Tensor([0, 0]) for _ in range(self.world_size)]]
+        self.assertTrue(pg.allgather(output, input).wait())
+        self.assertEqual([[torch.Tensor([i, -i]) for i in range(self.world_size)]], output)
+
+    def test_barrier(self):
+        pg = self._create_process_group()
+        self.assertTrue(pg.barrier().wait())
+
+    def test_checks(self):
+        pg = self._create_process_group()
+        with self.assertRaisesRegex(ValueError, "requires a single-element tensor list"):
+            pg.allreduce([torch.zeros(1), torch.zeros(1)])
+
+        with self.assertRaisesRegex(ValueError, "invalid root rank"):
+            opts = c10d.BroadcastOptions()
+            opts.rootRank = self.world_size
+            pg.broadcast([torch.zeros(1)], opts)
+
+        with self.assertRaisesRegex(ValueError, "output tensor list"):
+            pg.allgather([[torch.zeros(1)]], [torch.zeros(1)])
+
+
+class EmbeddingServiceTest(MultiProcessTestCase):
+    # Ranks 0 and 1 serve, ranks 2 and 3 look rows up
+    servers = [0, 1]
+    clients = [2, 3]
+    tables = [(11, 2), (5, 3)]
+    lr = 0.5
+
+    def _create_process_group(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        opts = c10d.ProcessGroupGloo.Options()
+        opts.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        opts.timeout = 5.0
+        return c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+    # Row i of a table holds i everywhere
+    def _expected(self, table, indices):
+        dim = self.tables[table][1]
+        return indices.float().unsqueeze(1).expand(-1, dim)
+
+    def test_lookup_and_push(self):
+        from torch.distributed.embedding_service import (
+            EmbeddingClient, EmbeddingServer, ShardedEmbeddingBag)
+        pg = self._create_process_group()
+        if self.rank in self.servers:
+            server = EmbeddingServer(
+                self.tables, self.servers, self.clients, pg, lr=self.lr)
+            shard = self.servers.index(self.rank)
+            for weight in server.weights:
+                rows = torch.arange(weight.size(0)) * len(self.servers) + shard
+                weight.copy_(rows.float().unsqueeze(1).expand_as(weight))
+            server.serve()
+            return
+
+        # The clients only update rows the other one doesn't read
+        c = self.clients.index(self.rank)
+        client = EmbeddingClient(self.tables, self.servers, pg)
+
+        # Lookups of both tables, with repeated rows, queued together
+        indices = [torch.LongTensor([9, 10, 4, 10]), torch.LongTensor([4, 1])]
+        futures = [client.lookup_async(t, indices[t]) for t in range(2)]
+        for t, future in enumerate(futures):
+            self.assertEqual(self._expected(t, indices[t]), future.wait())
+
+        # Two pushes of the same row
+        row = torch.LongTensor([5 + c])
+        ones = torch.ones(1, 2)
+        client.push_gradients_async(0, row, ones)
+        client.push_gradients_async(0, row, ones).wait()
+        updated = client.lookup_async(0, row).wait()
+        self.assertEqual(self._expected(0, row) - 2 * self.lr, updated)
+
+        # The bag looks rows up through the client, and its backward pushes
+        # their gradients
+        bag = ShardedEmbeddingBag(client, 0, mode='sum')
+        input = torch.LongTensor([c, c + 2, c + 2])
+        offsets = torch.LongTensor([0, 1])
+        output = bag(input, offsets)
+        self.assertEqual(torch.Tensor([[c] * 2, [2 * (c + 2)] * 2]), output)
+        output.sum().backward()
+        updated = client.lookup_async(0, input).wait()
+        expected = torch.Tensor([c - self.lr] + [c + 2 - 2 * self.lr] * 2)
+        self.assertEqual(expected.unsqueeze(1).expand(-1, 2), updated)
+
+        with self.assertRaisesRegex(ValueError, "out of range"):
+            client.lookup_async(1, torch.LongTensor([5]))
+        client.shutdown()
+
+
 class ProcessGroupNCCLTest(TestCase):
     MAIN_PROCESS_RANK = 0
 
@@ -1144,6 +1460,42 @@ class ProcessGroupNCCLTest(TestCase):
                     tensors_list[i - 2][j])
 
 
+class ProcessGroupNCCLTimeoutTest(MultiProcessTestCase):
+
+    @property
+    def world_size(self):
+        return 2
+
+    @skip_if_not_multigpu
+    @skip_if_not_nccl
+    @skip_if_nccl_cannot_abort
+    def test_op_timeout(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size,
+                                   timeout=timedelta(seconds=1))
+        device = gpus_for_rank(self.world_size)[self.rank][0]
+        tensor = torch.ones(10).cuda(device)
+
+        # Both ranks create the communicator
+        pg.allreduce([tensor]).wait()
+        torch.cuda.synchronize(device)
+
+        if self.rank == 0:
+            # Rank 1 never joins, so this collective hangs until the
+            # watchdog aborts it
+            work = pg.allreduce([tensor])
+            while work.is_success():
+                time.sleep(0.1)
+            with self.assertRaisesRegex(RuntimeError, "timed out"):
+                work.wait()
+            # The group can't be used anymore
+            with self.assertRaisesRegex(RuntimeError, "timed out"):
+                pg.allreduce([tensor])
+            store.set("done", "1")
+        else:
+            store.wait(["done"])
+
+
 class Net(nn.Module):
     def __init__(self):
         super(Net, self).__init__()
@@ -1174,13 +1526,14 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def world_size(self):
         return 2
 
-    def _test_ddp_with_process_group(self, process_group, gpus):
+    def _test_ddp_with_process_group(self, process_group, gpus, comm_hook=None, prec=None):
         model = Net()
         ddp_model = DistributedDataParallel(
             copy.deepcopy(model).cuda(gpus[0]),
             device_ids=gpus,
             process_group=process_group,
-            bucket_cap_mb=0.001)
+            bucket_cap_mb=0.001,
+            comm_hook=comm_hook)
 
         model.cuda(gpus[0])
 
@@ -1215,7 +1568,7 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             update_parameters(ddp_model)
             self.assertEqual(len(list(model.parameters())), len(list(ddp_model.parameters())))
             for i, j in zip(model.parameters(), ddp_model.parameters()):
-                self.assertEqual(i, j)
+                self.assertEqual(i, j, prec)
 
             # Shuffle the input so that DDP input is different
             torch.manual_seed(1337 + iteration)
@@ -1240,6 +1593,33 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         self._test_ddp_with_process_group(process_group, gpus)
         self._test_ddp_with_process_group(process_group, list(map(lambda i: torch.device('cuda:' + str(i)), gpus)))
 
+    @skip_if_not_multigpu
+    def test_gloo_backend_fp16_compression_hook(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_tcp_device(interface="lo")]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+        gpus = gpus_for_rank(self.world_size)[self.rank]
+        self._test_ddp_with_process_group(
+            process_group, gpus, comm_hook=c10d.FP16CompressionHook(), prec=1e-2)
+
+    @skip_if_not_multigpu
+    @skip_if_not_nccl
+    def test_nccl_backend_fp16_compression_hook(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+        gpus = gpus_for_rank(self.world_size)[self.rank]
+        self._test_ddp_with_process_group(
+            process_group, gpus, comm_hook=c10d.FP16CompressionHook(), prec=1e-2)
+
+    def test_comm_hook_arguments(self):
+        if not hasattr(c10d, 'TopKCompressionHook'):
+            raise unittest.SkipTest("communication hooks require CUDA")
+        with self.assertRaisesRegex(ValueError, "ratio"):
+            c10d.TopKCompressionHook(0)
+        with self.assertRaisesRegex(ValueError, "rank"):
+            c10d.PowerSGDHook(0)
+
     @skip_if_not_multigpu
     @skip_if_not_nccl
     @skip_for_known_issues
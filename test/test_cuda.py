@@ -791,6 +791,124 @@ class TestCuda(TestCase):
         for _ in self._test_memory_stats_generator(self):
             pass
 
+    def test_memory_stats_counters(self):
+        torch.cuda.empty_cache()
+        before = torch.cuda.memory_stats()
+        x = torch.empty(1024, device='cuda')
+        y = torch.empty(1024 * 1024, device='cuda')
+        del x, y
+        after = torch.cuda.memory_stats()
+        self.assertEqual(after['num_allocs'] - before['num_allocs'], 2)
+        self.assertEqual(after['num_frees'] - before['num_frees'], 2)
+        self.assertEqual(sum(after['size_histogram']), after['num_allocs'])
+        self.assertEqual(after['allocated_bytes'], torch.cuda.memory_allocated())
+        self.assertEqual(after['cached_bytes'], torch.cuda.memory_cached())
+
+        snapshot = torch.cuda.memory_snapshot()
+        self.assertEqual(sum(s['total_size'] for s in snapshot),
+                         sum(torch.cuda.memory_cached(d) for d in range(torch.cuda.device_count())))
+        for segment in snapshot:
+            self.assertEqual(sum(b['size'] for b in segment['blocks']), segment['total_size'])
+
+    def test_caching_allocator_private_pools(self):
+        torch.cuda.empty_cache()
+        pool = torch.cuda._new_memory_pool()
+        side = torch.cuda.Stream()
+
+        def pool_segments(pool_id):
+            return [s for s in torch.cuda.memory_snapshot() if s['pool_id'] == pool_id]
+
+        # the guard routes the thread to the pool and restores the previous one
+        self.assertEqual(torch._C._cuda_getThreadPool(), 0)
+        with torch.cuda._memory_pool(pool):
+            self.assertEqual(torch._C._cuda_getThreadPool(), pool)
+            other = torch.cuda._new_memory_pool()
+            with torch.cuda._memory_pool(other):
+                self.assertEqual(torch._C._cuda_getThreadPool(), other)
+            self.assertEqual(torch._C._cuda_getThreadPool(), pool)
+            x = torch.empty(1024 * 1024, device='cuda')
+            ptr = x.data_ptr()
+            del x
+        self.assertEqual(torch._C._cuda_getThreadPool(), 0)
+        self.assertEqual(len(pool_segments(pool)), 1)
+
+        # a block freed in a private pool is not handed to the shared pool
+        y = torch.empty(1024 * 1024, device='cuda')
+        self.assertNotEqual(y.data_ptr(), ptr)
+        # nor to the same pool on another stream
+        with torch.cuda.stream(side), torch.cuda._memory_pool(pool):
+            z = torch.empty(1024 * 1024, device='cuda')
+            self.assertNotEqual(z.data_ptr(), ptr)
+            del z
+        # but it is reused by the same pool on the same stream
+        with torch.cuda._memory_pool(pool):
+            w = torch.empty(1024 * 1024, device='cuda')
+            self.assertEqual(w.data_ptr(), ptr)
+            del w
+
+        # a stream routed to a pool allocates from it
+        stream_pool = torch.cuda._new_memory_pool()
+        torch.cuda._set_stream_memory_pool(side, stream_pool)
+        try:
+            with torch.cuda.stream(side):
+                v = torch.empty(1024 * 1024, device='cuda')
+            self.assertEqual(len(pool_segments(stream_pool)), 1)
+            del v
+        finally:
+            torch.cuda._set_stream_memory_pool(side, 0)
+        torch.cuda.synchronize()
+
+        # releasing a pool returns its segments to the driver, and only those
+        cached = torch.cuda.memory_cached()
+        released = sum(s['total_size'] for s in pool_segments(pool))
+        self.assertEqual(len(pool_segments(pool)), 2)
+        torch.cuda._release_memory_pool(pool)
+        self.assertEqual(pool_segments(pool), [])
+        self.assertEqual(torch.cuda.memory_cached(), cached - released)
+        self.assertEqual(len(pool_segments(stream_pool)), 1)
+        torch.cuda._release_memory_pool(stream_pool)
+        self.assertEqual(pool_segments(stream_pool), [])
+        del y
+
+    def test_memory_trace(self):
+        torch.cuda._record_memory_trace(4)
+        try:
+            for _ in range(3):
+                x = torch.empty(16, device='cuda')
+                del x
+            trace = torch.cuda._memory_trace()
+            self.assertEqual(len(trace), 4)
+            self.assertEqual([e['action'] for e in trace[-2:]], ['alloc', 'free'])
+            self.assertEqual(trace[-1]['ptr'], trace[-2]['ptr'])
+        finally:
+            torch.cuda._record_memory_trace(0)
+
+    def test_host_memory_stats(self):
+        # sizes that round up to the same size class share reserved blocks
+        torch.cuda.reserve_host_memory(3000000, 2)
+        before = torch.cuda.host_memory_stats()
+        x = torch.empty(700000).pin_memory()
+        y = torch.empty(750000).pin_memory()
+        after = torch.cuda.host_memory_stats()
+        self.assertEqual(after['num_hits'] - before['num_hits'], 2)
+        self.assertEqual(after['num_misses'], before['num_misses'])
+        del x, y
+
+        # large requests pin at most 25% more than they ask for
+        before = torch.cuda.host_memory_stats()
+        x = torch.empty(65 * 1024 * 1024, dtype=torch.uint8).pin_memory()
+        after = torch.cuda.host_memory_stats()
+        if after['num_misses'] > before['num_misses']:
+            # not served by a bigger block cached by an earlier test
+            self.assertEqual(after['cached_bytes'] - before['cached_bytes'], 80 * 1024 * 1024)
+        del x
+
+        z = torch.empty(1000)
+        torch.cuda.host_register(z)
+        self.assertEqual(torch.cuda.host_memory_stats()['registered_bytes'],
+                         after['registered_bytes'] + 4000)
+        torch.cuda.host_unregister(z)
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_memory_stats_multigpu(self):
         # advance a generator with a end flag
@@ -1276,6 +1394,9 @@ class TestCuda(TestCase):
         _TestTorchMixin._test_bernoulli(self, torch.int64, torch.float64, 'cuda')
         _TestTorchMixin._test_bernoulli(self, torch.int64, torch.float16, 'cuda')
 
+    def test_multinomial_alias(self):
+        _TestTorchMixin._test_multinomial_alias(self, 'cuda')
+
     def test_cat_bad_input_sizes(self):
         x = torch.randn(2, 1).cuda()
         y = torch.randn(2, 1, 1).cuda()
@@ -1475,6 +1596,21 @@ class TestCuda(TestCase):
         x = torch.arange(0, 10).view((2, 5))
         self.assertEqual(x.t(), x.t().pin_memory())
 
+    def test_staged_pageable_copy(self):
+        # copies of more than one staging chunk of pageable memory go through
+        # pinned buffers, in several rounds of the buffer ring
+        cycles_per_ms = get_cycles_per_ms()
+        for non_blocking in (False, True):
+            x = torch.randn(9 * 1024 * 1024 + 3)
+            torch.cuda._sleep(int(50 * cycles_per_ms))  # delay the DMAs
+            y = x.cuda(non_blocking=non_blocking)
+            expected = x.clone()
+            x.zero_()  # src can be reused as soon as the copy returns
+            self.assertEqual(y.cpu(), expected)
+            z = torch.empty_like(x)
+            z.copy_(y, non_blocking=non_blocking)
+            self.assertEqual(z, expected)
+
     @skipIfRocm
     def test_caching_pinned_memory(self):
         cycles_per_ms = get_cycles_per_ms()
@@ -1610,6 +1746,19 @@ class TestCuda(TestCase):
     def test_rot90(self):
         _TestTorchMixin._test_rot90(self, use_cuda=True)
 
+    def test_elementwise_vectorized(self):
+        # Contiguous tensors of any length take the vectorized path, unless
+        # their data isn't aligned, e.g., after slicing off the first element
+        for dtype in [torch.half, torch.float, torch.double, torch.uint8]:
+            for n in [1, 7, 8, 9, 1023, 4097]:
+                for offset in [0, 1]:
+                    a = (torch.arange(n + offset) % 100).to('cuda', dtype)[offset:]
+                    b = torch.ones(n + offset, dtype=dtype, device='cuda')[offset:]
+                    expected = (a.cpu().double() + b.cpu().double()).to(dtype)
+                    self.assertEqual((a + b).cpu(), expected)
+                    self.assertEqual((a * 2).cpu(), (a.cpu().double() * 2).to(dtype))
+                    self.assertEqual(a.clone().fill_(3).cpu(), torch.full((n,), 3, dtype=dtype))
+
     def test_signal_window_functions(self):
         _TestTorchMixin._test_signal_window_functions(self, device=torch.device('cuda'))
 
@@ -1642,6 +1791,55 @@ class TestCuda(TestCase):
         with self.assertRaisesRegex(RuntimeError, r"read-only property"):
             torch.backends.cuda.cufft_plan_cache.size = -1
 
+        with self.assertRaisesRegex(RuntimeError, r"but got device with index"):
+            torch.backends.cuda.cufft_plan_cache[torch.cuda.device_count() + 10]
+
+    @skipIfRocm
+    def test_cufft_plan_cache_stats(self):
+        cache = torch.backends.cuda.cufft_plan_cache
+        original = cache.max_size
+        try:
+            cache.max_size = 2
+            cache.clear()
+            self.assertEqual((cache.hits, cache.misses, cache.evictions), (0, 0, 0))
+            x = torch.randn(3, 8, 2, device='cuda')
+            x.fft(1)
+            x.fft(1)
+            self.assertEqual((cache.hits, cache.misses, cache.evictions), (1, 1, 0))
+            torch.randn(3, 16, 2, device='cuda').fft(1)
+            torch.randn(3, 32, 2, device='cuda').fft(1)
+            self.assertEqual((cache.hits, cache.misses, cache.evictions), (1, 3, 1))
+            self.assertEqual(cache.size, 2)
+        finally:
+            cache.max_size = original
+
+    @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
+    @skipIfRocm
+    def test_cufft_plan_cache_multi_gpu(self):
+        # Each device caches its own plans, with its own capacity
+        caches = [torch.backends.cuda.cufft_plan_cache[i] for i in range(2)]
+        originals = [cache.max_size for cache in caches]
+        try:
+            caches[0].max_size = 10
+            caches[1].max_size = 11
+            for cache in caches:
+                cache.clear()
+            self.assertEqual(torch.backends.cuda.cufft_plan_cache[torch.device('cuda:1')].max_size, 11)
+            with torch.cuda.device(1):
+                self.assertEqual(torch.backends.cuda.cufft_plan_cache.max_size, 11)
+
+            x0 = torch.randn(3, 8, 2, device='cuda:0')
+            x1 = x0.to('cuda:1')
+            y0 = x0.fft(1)
+            # Runs on device 1 with the plan of the same geometry created there
+            y1 = x1.fft(1)
+            self.assertEqual(y0, y1.to('cuda:0'))
+            self.assertEqual([cache.misses for cache in caches], [1, 1])
+            self.assertEqual([cache.size for cache in caches], [1, 1])
+        finally:
+            for cache, original in zip(caches, originals):
+                cache.max_size = original
+
     def test_stft(self):
         _TestTorchMixin._test_stft(self, device=torch.device('cuda'))
 
@@ -1874,6 +2072,58 @@ class TestCuda(TestCase):
 
         self.assertEqual(tensor_cpu.var(2), tensor_cuda.var(2).cpu())
 
+    def test_var_std_strided(self):
+        # Reduced along strided dimensions and across several blocks per output
+        cpu_tensor = torch.randn(4, 100000, dtype=torch.double)
+        gpu_tensor = cpu_tensor.cuda()
+        self.assertEqual(gpu_tensor.var(), cpu_tensor.var())
+        self.assertEqual(gpu_tensor.std(unbiased=False), cpu_tensor.std(unbiased=False))
+        self.assertEqual(gpu_tensor.t().var(1), cpu_tensor.t().var(1))
+        self.assertEqual(gpu_tensor.var(0), cpu_tensor.var(0))
+        self.assertEqual(gpu_tensor.std(1, keepdim=True), cpu_tensor.std(1, keepdim=True))
+
+        half_tensor = gpu_tensor.half()
+        self.assertEqual(half_tensor.var(1).double(), half_tensor.double().var(1), 1e-2)
+
+    def test_topk_small_slices(self):
+        # Slices of up to 1024 elements are selected by a warp each
+        for n, k in [(1, 1), (7, 3), (33, 33), (100, 10), (1000, 100), (1024, 1000)]:
+            for dtype in [torch.float, torch.double, torch.long, torch.half]:
+                cpu_tensor = torch.randperm(300 * n).view(300, n).to(torch.long if dtype == torch.half else dtype)
+                if dtype == torch.half:
+                    # values exactly representable as halfs
+                    cpu_tensor = (cpu_tensor % 2048).float()
+                gpu_tensor = cpu_tensor.to('cuda', dtype)
+                for largest in [True, False]:
+                    for dim in [1, 0]:
+                        kk = min(k, gpu_tensor.size(dim))
+                        top_gpu, idx_gpu = gpu_tensor.topk(kk, dim, largest, True)
+                        top_cpu, _ = cpu_tensor.topk(kk, dim, largest, True)
+                        self.assertEqual(top_gpu.double().cpu(), top_cpu.double(), 0)
+                        self.assertEqual(gpu_tensor.gather(dim, idx_gpu).double(), top_gpu.double(), 0)
+
+    def test_sort_large_slices(self):
+        # Slices above the 2048 elements of the in-place sort are sorted
+        # with Thrust
+        cpu_tensor = torch.randn(5, 5000)
+        cpu_tensor[:, ::7] = 0.5  # ties are kept in their order
+        gpu_tensor = cpu_tensor.cuda()
+        for descending in [False, True]:
+            for dim in [1, 0]:
+                tensor = gpu_tensor if dim == 1 else gpu_tensor.t()
+                sorted_gpu, idx_gpu = tensor.sort(dim, descending)
+                sorted_cpu, _ = tensor.cpu().sort(dim, descending)
+                self.assertEqual(sorted_gpu.cpu(), sorted_cpu, 0)
+                self.assertEqual(tensor.gather(dim, idx_gpu), sorted_gpu, 0)
+                ties = (sorted_gpu == 0.5)
+                tie_idx = idx_gpu[ties].view(5, -1) if dim == 1 else idx_gpu.t()[ties.t()].view(5, -1)
+                self.assertTrue((tie_idx[:, 1:] > tie_idx[:, :-1]).all())
+
+        # k above 2048 selected from large slices
+        top_gpu, idx_gpu = gpu_tensor.topk(3000, 1)
+        self.assertEqual(top_gpu.cpu(), cpu_tensor.topk(3000, 1)[0], 0)
+        self.assertEqual(gpu_tensor.gather(1, idx_gpu), top_gpu, 0)
+
     def test_var_stability(self):
         tensor = torch.FloatTensor([2281.5, 2281.25]).cuda()
 
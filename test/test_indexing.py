@@ -524,6 +524,42 @@ class NumpyTests(TestCase):
 
         self.assertTrue((a[:3, :3] == tensor([2., 3., 4.])).all())
 
+    def test_index_non_adjacent(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.randn(3, 4, 5, 6, device=device).transpose(1, 3)
+            i = torch.tensor([[0, 2], [-1, 1]], device=device)
+            j = torch.tensor([4, -2], device=device)
+            result = x[i, :, j]
+            self.assertEqual(result.shape, (2, 2, 6, 4))
+            for a in range(2):
+                for b in range(2):
+                    self.assertEqual(result[a, b], x[i[a, b], :, j[b]])
+
+            y = torch.zeros_like(x)
+            y[i, :, j] = result
+            expected = torch.zeros_like(x)
+            for a in range(2):
+                for b in range(2):
+                    expected[i[a, b], :, j[b]] = result[a, b]
+            self.assertEqual(y, expected)
+
+    def test_index_put_accumulate(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x = torch.zeros(5, 3, device=device)
+            i = torch.tensor([0, 2, 0, -1, 2, 0], device=device)
+            v = torch.arange(6., device=device)[:, None].expand(6, 3)
+            x.index_put_((i,), v, accumulate=True)
+            expected = tensor([7., 0., 5., 0., 3.], device=device)[:, None].expand(5, 3)
+            self.assertEqual(x, expected)
+
+            # values broadcast over the indices
+            x = torch.zeros(5, 3, device=device)
+            x.index_put_((i, torch.tensor([1], device=device)), tensor(1., device=device), accumulate=True)
+            self.assertEqual(x[:, 1], tensor([3., 0., 2., 0., 1.], device=device))
+            self.assertEqual(x.sum(), 6)
+
     def test_broadcast_subspace(self):
         a = torch.zeros((100, 100))
         v = torch.arange(0., 100)[:, None]
@@ -621,6 +621,27 @@ class TestJit(JitTestCase):
         self.assertExpectedGraph(trace)
         self.assertExportImport(trace, (x, y))
 
+    def test_trace_replay_modules(self):
+        class Layer(nn.Module):
+            def __init__(self):
+                super(Layer, self).__init__()
+                self.linear = nn.Linear(4, 4)
+
+            def forward(self, x):
+                return torch.tanh(self.linear(x)) + x
+
+        model = nn.Sequential(*[Layer() for _ in range(5)])
+        x = torch.randn(3, 4)
+        traced = torch.jit.trace(model, x)
+        replayed = torch.jit.trace(model, x, replay_modules=(Layer,))
+
+        x = torch.randn(3, 4)
+        self.assertEqual(replayed(x), model(x))
+        self.assertEqual(replayed(x), traced(x))
+        # Each layer has its own copy of the nodes of the first, in its scope
+        self.assertEqual([(n.kind(), n.scopeName()) for n in replayed.graph.nodes()],
+                         [(n.kind(), n.scopeName()) for n in traced.graph.nodes()])
+
     def test_scopes_intermediate_node(self):
 
         class Net(nn.Module):
@@ -829,7 +850,6 @@ class TestJit(JitTestCase):
     @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     @skipIfRocm
-    @unittest.expectedFailure
     def test_comparison_gt_lt_cuda(self):
         x = torch.randn(4, 4, dtype=torch.float, device='cuda')
         y = torch.randn(4, 4, dtype=torch.float, device='cuda')
@@ -840,7 +860,6 @@ class TestJit(JitTestCase):
     @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     @skipIfRocm
-    @unittest.expectedFailure
     def test_comparison_ge_le_cuda(self):
         def f(x, y):
             mask = (x >= 0).type_as(x)
@@ -858,7 +877,6 @@ class TestJit(JitTestCase):
     @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     @skipIfRocm
-    @unittest.expectedFailure
     def test_comparison_eq_ne(self):
         def f(x, y):
             mask = (x == 0).type_as(x)
@@ -1513,6 +1531,55 @@ class TestJit(JitTestCase):
     def test_fused_abs_cuda(self):
         self._test_fused_abs(device="cuda")
 
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_fusion_reuses_kernels_across_sizes(self):
+        @torch.jit.script
+        def func(x, y):
+            return (x + y) * x
+
+        kernels = torch._C._jit_fuser_n_compiled_kernels()
+        for batch in [1, 2, 7, 32, 511]:
+            x = torch.randn(batch, 6)
+            y = torch.randn(batch, 6)
+            self.assertEqual(func(x, y), (x + y) * x)
+        # the stride of a dim of size 1 doesn't matter
+        x = torch.randn(6, 1).t()
+        self.assertEqual(func(x, y[:1]), (x + y[:1]) * x)
+        self.assertEqual(torch._C._jit_fuser_n_compiled_kernels() - kernels, 1)
+
+    def _test_fused_sum(self, device='cpu'):
+
+        @torch.jit.script
+        def func(x, y):
+            return (x * y + 1).sigmoid().sum(-1)
+
+        @torch.jit.script
+        def func_keepdim(x, y):
+            return torch.sum(x - y, dim=[2], keepdim=True)
+
+        x = torch.randn(4, 5, 6, device=device)
+        y = torch.randn(4, 5, 6, device=device)
+        self.assertEqual(func(x, y), (x * y + 1).sigmoid().sum(-1))
+        self.assertAllFused(func.graph_for(x, y))
+        self.assertEqual(func_keepdim(x, y), (x - y).sum(2, keepdim=True))
+        self.assertAllFused(func_keepdim.graph_for(x, y))
+
+        # the reduced dimension is the innermost one of the broadcasted inputs
+        y = torch.randn(6, device=device)
+        self.assertEqual(func(x, y), (x * y + 1).sigmoid().sum(-1))
+
+    @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
+    @enable_cpu_fuser
+    def test_fused_sum_cpu(self):
+        self._test_fused_sum()
+
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    @skipIfRocm
+    def test_fused_sum_cuda(self):
+        self._test_fused_sum(device="cuda")
+
     @unittest.skipIf(IS_WINDOWS or IS_SANDCASTLE, "NYI: fuser support for Windows or Sandcastle")
     @enable_cpu_fuser
     def test_ge_optimized(self):
@@ -1713,6 +1780,48 @@ class TestJit(JitTestCase):
         self.assertEqual(out_ref, out_test)
         self.assertExpected(canonical(addmm.graph))
 
+    def test_batch_mm_shared_operands(self):
+        def heads(x, w1, w2, w3, b1, b2):
+            q = torch.mm(x, w1)
+            k = torch.mm(x, w2)
+            v = torch.mm(x, w3)
+            o1 = torch.mm(w1.t(), q.t())
+            o2 = torch.mm(w2.t(), q.t())
+            a1 = torch.addmm(b1, x, w1)
+            a2 = torch.addmm(b2, x, w2)
+            # uses k, so it can't be batched with q, k and v
+            k2 = torch.mm(x, k.t())
+            return q, k, v, o1, o2, a1, a2, k2
+
+        scripted = torch.jit.script(heads)
+        inputs = (torch.randn(5, 4), torch.randn(4, 5), torch.randn(4, 5), torch.randn(4, 3),
+                  torch.randn(5), torch.randn(5))
+        self.assertEqual(scripted(*inputs), heads(*inputs))
+        graph = scripted.graph_for(*inputs)
+        kinds = [n.kind() for n in graph.nodes()]
+        self.assertEqual(kinds.count('prim::MMBatchSide'), 2)
+        self.assertEqual(kinds.count('prim::AddMMBatchSide'), 1)
+        self.assertEqual(kinds.count('aten::mm'), 1)
+        self.assertEqual(kinds.count('aten::addmm'), 0)
+
+        # 2-D biases can't be concatenated, so the addmms are run one by one
+        inputs = inputs[:4] + (torch.randn(5, 5), torch.randn(5, 5))
+        self.assertEqual(scripted(*inputs), heads(*inputs))
+
+    def test_batch_conv2d_shared_input(self):
+        def branches(x, w1, w2, b1, b2):
+            return torch.conv2d(x, w1, b1), torch.conv2d(x, w2, b2)
+
+        scripted = torch.jit.script(branches)
+        inputs = (torch.randn(2, 3, 8, 8), torch.randn(4, 3, 1, 1), torch.randn(6, 3, 1, 1),
+                  torch.randn(4), torch.randn(6))
+        self.assertEqual(scripted(*inputs), branches(*inputs))
+        self.assertGraphContains(scripted.graph_for(*inputs), 'prim::ConvBatchSide')
+
+        # weights of different kernel sizes can't be concatenated
+        inputs = (inputs[0], inputs[1], torch.randn(6, 3, 3, 3)) + inputs[3:]
+        self.assertEqual(scripted(*inputs), branches(*inputs))
+
     def test_index_put(self):
         ten = torch.zeros(3, 3)
         mask = torch.Tensor([[True, True, True],
@@ -2150,6 +2259,58 @@ class TestJit(JitTestCase):
         torch._C._jit_import_method(mod, "op_version_set = 0\n{}".format(r), [])
         self.assertExpected(mod.script.graph.pretty_print())
 
+    def test_import_method_lazily(self):
+        @torch.jit.script
+        def foo(x, y):
+            return 2 * x + y
+
+        r = foo.graph.pretty_print()
+        source = "op_version_set = 0\n{}\n{}".format(r, r.replace('def script', 'def script2'))
+        mod = torch.jit.ScriptModule()
+        torch._C._jit_import_method(mod, source, [])
+        x, y = torch.randn(3), torch.randn(3)
+        mod.define_methods(num_threads=2)
+        self.assertEqual(mod.script(x, y), foo(x, y))
+        self.assertEqual(mod.script2(x, y), foo(x, y))
+
+        with self.disableModuleHook():
+            # The methods are compiled when first used
+            mod = torch.jit.ScriptModule()
+            torch._C._jit_import_method(
+                mod, "op_version_set = 0\ndef bad(self, x):\n  return aten.not_an_op(x)\n", [])
+            with self.assertRaisesRegex(RuntimeError, "not_an_op"):
+                mod.define_methods()
+
+    def test_script_method_call_threads(self):
+        import threading
+
+        class M(torch.jit.ScriptModule):
+            def __init__(self):
+                super(M, self).__init__()
+                self.weight = nn.Parameter(torch.randn(4, 4))
+
+            @torch.jit.script_method
+            def forward(self, x, t):
+                # type: (Tensor, Tuple[Tensor, int]) -> Tuple[Tensor, Tensor]
+                a, n = t
+                return torch.mm(x, self.weight) + a * n, a
+
+        m = M()
+        inputs = [(torch.randn(4, 4), (torch.randn(4), i)) for i in range(8)]
+        expected = [m(*args) for args in inputs]
+        results = [None] * len(inputs)
+
+        def run(i):
+            for _ in range(20):
+                results[i] = m(*inputs[i])
+
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(len(inputs))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(results, expected)
+
     def test_function_default_values(self):
         outer_var = torch.tensor(20)
         outer_var2 = torch.tensor(30)
@@ -4072,6 +4233,21 @@ a")
         (hy + cy).sum().backward()
         self.assertExpectedGraph(backward_graph(module), subname='backward')
 
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
+    @skipIfRocm
+    def test_relu_backward_fusion_cuda(self):
+        def fn(x, y):
+            return (x * y + y).relu()
+
+        x = torch.randn(4, 4, dtype=torch.float, device='cuda', requires_grad=True)
+        y = torch.randn(4, 4, dtype=torch.float, device='cuda', requires_grad=True)
+
+        module = self.checkScript(fn, (x, y))
+        module(x, y).sum().backward()
+        # The mask of the gradient of relu is computed in the same kernel
+        self.assertAllFused(backward_graph(module))
+
     def test_dropout_script(self):
 
         eg = torch.zeros(1, 2, 3, requires_grad=True)
@@ -4150,6 +4326,23 @@ a")
         inputs = self._make_scalar_vars([1, 1, 10], torch.int64)
         self.checkScript(func, inputs, optimize=True)
 
+    def test_interpreter_inline_ops(self):
+        # constants, int and bool arithmetic and tuples are executed by the
+        # interpreter loop itself
+        def func(x, n):
+            # type: (Tensor, int) -> Tuple[Tensor, int]
+            acc = (x, 0)
+            for i in range(n):
+                t, k = acc
+                flag = i * 2 - 1 >= k and i != 3
+                if flag or k == 0:
+                    k = k + i
+                acc = (t + 1, k)
+            return acc
+
+        self.checkScript(func, (torch.ones(2), 6), optimize=True)
+        self.checkScript(func, (torch.ones(2), 0), optimize=True)
+
     def test_fibb(self):
         def func(lim):
             first = 1
@@ -6321,6 +6514,116 @@ a")
         torch._C._jit_pass_complete_shape_analysis(foo.graph, (a, b), False)
         self.assertExpected(canonical(foo.graph))
 
+    def test_memory_planning(self):
+        def foo(x, w):
+            a = torch.mm(x, w)
+            b = torch.tanh(a)
+            c = torch.mm(b, w)
+            d = torch.sigmoid(c)
+            return d + 1
+
+        foo_script = torch.jit.script(foo)
+        x = torch.randn(4, 4)
+        w = torch.randn(4, 4)
+        torch._C._jit_set_memory_planning_enabled(True)
+        try:
+            with torch.no_grad():
+                first = foo_script(x, w)
+                self.assertEqual(first, foo(x, w))
+                graph = foo_script.graph_for(x, w)
+                kinds = [n.kind() for n in graph.nodes()]
+                self.assertEqual(kinds.count('prim::MemoryArena'), 1)
+                self.assertEqual(kinds.count('prim::ArenaSlice'), 4)
+
+                # the outputs don't live in the arena, so reusing it
+                # leaves the results of earlier runs alone
+                expected = first.clone()
+                x2 = torch.randn(4, 4)
+                self.assertEqual(foo_script(x2, w), foo(x2, w))
+                self.assertEqual(first, expected)
+
+                # other sizes get a plan of their own
+                x3 = torch.randn(2, 4)
+                self.assertEqual(foo_script(x3, w), foo(x3, w))
+        finally:
+            torch._C._jit_set_memory_planning_enabled(False)
+
+    def test_memory_planning_out_from_inplace(self):
+        # relu has no hand written out= variant, its relu_out is derived
+        # from relu_ by the codegen
+        def foo(x, w):
+            a = torch.mm(x, w)
+            b = torch.relu(a)
+            return b + 1
+
+        foo_script = torch.jit.script(foo)
+        x = torch.randn(4, 4)
+        w = torch.randn(4, 4)
+        torch._C._jit_set_memory_planning_enabled(True)
+        try:
+            with torch.no_grad():
+                self.assertEqual(foo_script(x, w), foo(x, w))
+                graph = foo_script.graph_for(x, w)
+                kinds = [n.kind() for n in graph.nodes()]
+                self.assertEqual(kinds.count('prim::ArenaSlice'), 2)
+        finally:
+            torch._C._jit_set_memory_planning_enabled(False)
+
+    def test_shape_specialization(self):
+        def foo(x, y):
+            return (x * y + x).sum(0)
+
+        foo_script = torch.jit.script(foo)
+        x = torch.randn(4, 3)
+        y = torch.randn(4, 3)
+        torch._C._jit_set_shape_specialization_enabled(True)
+        try:
+            # the first runs use the generic plan, and record the shapes
+            for _ in range(7):
+                self.assertEqual(foo_script(x, y), foo(x, y))
+                self.assertNotIn('Float(4, 3)', str(foo_script.graph_for(x, y)))
+            self.assertEqual(foo_script(x, y), foo(x, y))
+            self.assertIn('Float(4, 3)', str(foo_script.graph_for(x, y)))
+            self.assertEqual(foo_script(x, y), foo(x, y))
+
+            # other shapes still run the generic plan
+            x2 = torch.randn(2, 3)
+            y2 = torch.randn(2, 3)
+            self.assertEqual(foo_script(x2, y2), foo(x2, y2))
+            self.assertNotIn('Float(2, 3)', str(foo_script.graph_for(x2, y2)))
+        finally:
+            torch._C._jit_set_shape_specialization_enabled(False)
+
+    @unittest.skipIf(not torch.fbgemm_is_cpu_supported(), "requires FBGEMM")
+    def test_calibration_observers(self):
+        def foo(x, w):
+            a = torch.mm(x, w)
+            return torch.relu(a) * 2
+
+        foo_script = torch.jit.script(foo)
+        calibration = torch._C.Calibration()
+        torch._C._jit_pass_insert_calibration_observers(
+            foo_script.graph, calibration, ['aten::mm', 'aten::relu'])
+        kinds = [n.kind() for n in foo_script.graph.nodes()]
+        self.assertEqual(kinds.count('prim::CalibrationObserver'), 2)
+        self.assertEqual(len(calibration.names()), 2)
+
+        w = torch.randn(4, 4)
+        with torch.no_grad():
+            for _ in range(4):
+                x = torch.randn(8, 4)
+                self.assertEqual(foo_script(x, w), foo(x, w))
+
+        for kind in ['min_max', 'l2', 'kl']:
+            qparams = calibration.quantization_params(kind)
+            self.assertEqual(set(qparams.keys()), set(calibration.names()))
+            for scale, zero_point in qparams.values():
+                self.assertGreater(scale, 0)
+                self.assertTrue(0 <= zero_point <= 255)
+        # the output of relu isn't negative, so zero maps to the lowest value
+        relu_name = calibration.names()[1]
+        self.assertEqual(calibration.quantization_params()[relu_name][1], 0)
+
     def test_onnx_export_speculate(self):
 
         class Foo(torch.jit.ScriptModule):
@@ -7486,6 +7789,26 @@ a")
         self.checkScriptRaisesRegex(test_indexing_out_of_bounds_pos, (), Exception,
                                     "out of range")
 
+    def test_tuple_unpack_shared(self):
+        # unpacking moves the elements only out of the tuples nothing else holds
+        @torch.jit.script
+        def unpack(t):
+            # type: (Tuple[Tensor, Tensor]) -> Tuple[Tensor, Tensor, Tensor]
+            a, b = t
+            c = t[1]
+            d = (a + 1, b)
+            e, f = d
+            g = [e, f]
+            h, i = g
+            return h, i, c
+
+        x, y = torch.zeros(2), torch.ones(2)
+        t = (x, y)
+        for _ in range(2):
+            self.assertEqual(unpack(t), (x + 1, y, y))
+        self.assertIs(t[0], x)
+        self.assertIs(t[1], y)
+
     def test_tuple_slicing(self):
         def tuple_slice(a):
             if bool(a):
@@ -8229,6 +8552,63 @@ a")
         self.assertEqual(script_result, script_result2)
         self.assertExpectedGraph(strong_mod.graph, "scope_test")
 
+    def test_freeze_module(self):
+        class ConvBN(torch.jit.ScriptModule):
+            def __init__(self):
+                super(ConvBN, self).__init__()
+                self.weight = torch.nn.Parameter(torch.randn(4, 3, 3, 3))
+                self.bias = torch.nn.Parameter(torch.randn(4))
+                self.bn_weight = torch.nn.Parameter(torch.rand(4) + 0.5)
+                self.bn_bias = torch.nn.Parameter(torch.randn(4))
+                self.register_buffer('running_mean', torch.randn(4))
+                self.register_buffer('running_var', torch.rand(4) + 0.5)
+                self.fc_weight = torch.nn.Parameter(torch.randn(5, 4))
+
+            @torch.jit.script_method
+            def forward(self, x):
+                y = torch.conv2d(x, self.weight, self.bias)
+                y = torch.batch_norm(y, self.bn_weight, self.bn_bias, self.running_mean,
+                                     self.running_var, False, 0.1, 1e-5, False)
+                y = torch.dropout(y, 0.5, False)
+                return torch.mm(y.sum(3).sum(2), self.fc_weight.t())
+
+        m = ConvBN()
+        x = torch.randn(2, 3, 4, 4)
+        with torch.no_grad():
+            expected = m(x)
+            m.freeze()
+            self.assertEqual(m(x), expected, prec=1e-4)
+        graph = m.graph
+        self.assertEqual(len(list(graph.inputs())), 1)
+        kinds = [n.kind() for n in graph.nodes()]
+        self.assertNotIn('aten::batch_norm', kinds)
+        self.assertNotIn('aten::dropout', kinds)
+        # the transpose of the weight is folded
+        self.assertNotIn('aten::t', kinds)
+        self.assertIn('aten::conv2d', kinds)
+
+    def test_freeze_module_prepack_linear_weights(self):
+        class MLP(torch.jit.ScriptModule):
+            def __init__(self):
+                super(MLP, self).__init__()
+                self.fc1 = torch.nn.Linear(16, 8)
+                self.fc2 = torch.nn.Linear(8, 4, bias=False)
+
+            @torch.jit.script_method
+            def forward(self, x):
+                return self.fc2(torch.relu(self.fc1(x)))
+
+        for fp16 in [False, True]:
+            m = MLP()
+            x = torch.randn(1, 16)
+            with torch.no_grad():
+                expected = m(x)
+                m.freeze(prepack_linear_weights=True, fp16=fp16)
+                self.assertEqual(m(x), expected, prec=1e-2 if fp16 else 1e-4)
+            kinds = [n.kind() for n in m.graph.nodes()]
+            self.assertNotIn('aten::linear', kinds)
+            self.assertEqual(kinds.count('aten::linear_prepacked'), 2)
+
     def test_weak_module_parameters_and_buffers(self):
         import math
         weights = torch.randn(10, 10)
@@ -10074,7 +10454,42 @@ class TestAsync(JitTestCase):
         fut = torch.jit._fork(foo, x)
         y_hat = foo(x)
         y = torch.jit._wait(fut)
-        # assert nothing; only to make sure the fake python path works
+        self.assertEqual(y, y_hat)
+
+    def test_async_python_fork_wait(self):
+        @torch.jit.script
+        def foo(x, y):
+            return torch.mm(x, y), x
+
+        def bar(x, scale=1):
+            return x * scale
+
+        x = torch.rand(3, 4)
+        y = torch.rand(4, 5)
+        # script functions run on the inter-op pool
+        futs = [torch.jit.fork(foo, x, y) for _ in range(4)]
+        for fut in futs:
+            self.assertEqual(torch.jit.wait(fut), (torch.mm(x, y), x))
+        # other functions run before fork returns
+        self.assertEqual(torch.jit.wait(torch.jit.fork(bar, x, scale=2)), x * 2)
+        # errors of the forked function are raised by wait
+        fut = torch.jit.fork(foo, x, x)
+        with self.assertRaisesRegex(RuntimeError, "size mismatch"):
+            torch.jit.wait(fut)
+
+    def test_async_script_public_names(self):
+        @torch.jit.script
+        def foo(x):
+            return torch.neg(x)
+
+        @torch.jit.script
+        def towers(x):
+            fut1 = torch.jit.fork(foo, x)
+            fut2 = torch.jit.fork(foo, x + 1)
+            return torch.jit.wait(fut1) + torch.jit.wait(fut2)
+
+        x = torch.rand(3, 4)
+        self.assertEqual(towers(x), -2 * x - 1)
 
     def test_async_script(self):
         @torch.jit.script
@@ -69,6 +69,13 @@ def sum_tensors(inq, outq):
                       tensor.numel(), tensor.storage().size()))
 
 
+def sum_and_free_tensors(inq, outq, count):
+    for _ in range(count):
+        tensor = inq.get()
+        outq.put(tensor.sum().item())
+        del tensor
+
+
 def queue_get_exception(inqueue, outqueue):
     os.close(2)  # hide expected error message
     try:
@@ -301,6 +308,20 @@ class TestMultiprocessing(TestCase):
             for _ in range(TEST_REPEATS):
                 queue_put()
 
+    @unittest.skipIf(not HAS_SHM_FILES, "don't not how to check if shm files exist")
+    def test_fs_reuses_segments(self):
+        with fs_sharing(), leak_checker(self):
+            x = torch.FloatStorage(1000).share_memory_()
+            _, name, _ = x._share_filename_()
+            del x
+            # The freed segment went back to the pool of the manager
+            y = torch.FloatStorage(1000).share_memory_()
+            self.assertEqual(y._share_filename_()[1], name)
+            # A segment in use isn't handed out again
+            z = torch.FloatStorage(1000).share_memory_()
+            self.assertNotEqual(z._share_filename_()[1], name)
+            del y, z
+
     def test_inherit_tensor(self):
         t = torch.zeros(5, 5)
         p = SubProcess(t.share_memory_())
@@ -352,6 +373,24 @@ class TestMultiprocessing(TestCase):
             #
             # self.assertEqual(storage_size, 5)
 
+    @unittest.skipIf(NO_MULTIPROCESSING_SPAWN, "Disabled for environments that \
+                     don't support multiprocessing with spawn start method")
+    @unittest.skipIf(not TEST_CUDA_IPC, 'CUDA IPC not available')
+    def test_cuda_resend_freed_tensor(self):
+        # The receiver frees each tensor before the next one arrives, so that
+        # it maps the same allocation again from its unused mappings
+        ctx = mp.get_context('spawn')
+        tensor = torch.ones(5, device='cuda')
+        inq = ctx.Queue()
+        outq = ctx.Queue()
+        p = ctx.Process(target=sum_and_free_tensors, args=(inq, outq, 3))
+        p.start()
+        for i in range(3):
+            inq.put(tensor)
+            self.assertEqual(outq.get(), 5 * (i + 1))
+            tensor.add_(1)
+        p.join()
+
     @unittest.skipIf(IS_WINDOWS, 'not applicable to Windows (only fails with fork)')
     @unittest.skipIf(not torch.cuda.is_available(), 'CUDA not available')
     def test_cuda_bad_call(self):
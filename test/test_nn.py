@@ -13,6 +13,7 @@ from operator import mul
 from collections import OrderedDict
 import hashlib
 import os
+import tempfile
 
 import torch
 from torch._six import inf, nan
@@ -23,7 +24,7 @@ import torch.nn.parallel as dp
 import torch.nn.init as init
 import torch.nn.utils.rnn as rnn_utils
 from torch.nn.utils import clip_grad_norm_, clip_grad_value_
-from torch.nn.utils import parameters_to_vector, vector_to_parameters
+from torch.nn.utils import parameters_to_vector, vector_to_parameters, allocate_flat_grads
 from torch.autograd import Variable, gradcheck
 from torch.autograd.gradcheck import gradgradcheck
 from torch.nn import Parameter
@@ -1660,6 +1661,34 @@ class TestNN(NNTestCase):
         sample = next(model.parameters())[0, 0, 0]
         self.assertTrue(torch.equal(sample.data, vec.data[:5]))
 
+    def test_allocate_flat_grads(self):
+        model = nn.Sequential(nn.Linear(10, 20), nn.ReLU(), nn.Linear(20, 5))
+        model[2].bias.requires_grad_(False)
+        reference = deepcopy(model)
+        model[0].bias.grad = torch.ones(20)
+        reference[0].bias.grad = torch.ones(20)
+        flat_grad, = allocate_flat_grads(model.parameters())
+        self.assertEqual(flat_grad.numel(), 10 * 20 + 20 + 20 * 5)
+        self.assertIsNone(model[2].bias.grad)
+
+        grads = [p.grad for p in model.parameters() if p.requires_grad]
+        ptr = flat_grad.data_ptr()
+        for _ in range(2):
+            x = torch.randn(3, 10)
+            model(x).sum().backward()
+            reference(x).sum().backward()
+            for p, r, g in zip(model.parameters(), reference.parameters(), grads):
+                if p.requires_grad:
+                    self.assertIs(p.grad, g)
+                    self.assertEqual(p.grad, r.grad)
+            self.assertEqual(flat_grad.data_ptr(), ptr)
+        self.assertEqual(flat_grad, parameters_to_vector(r.grad for r in reference.parameters() if r.requires_grad))
+
+        model.zero_grad()
+        self.assertEqual(flat_grad.abs().sum(), 0)
+        flat_grad.fill_(1)
+        self.assertEqual(model[0].weight.grad, torch.ones(20, 10))
+
     # We don't want to make propagating NaN a hard requirement on ops, but for
     # these easy ones, we should make them do so.
     def _test_nonlinearity_propagate_nan(self, device):
@@ -1983,6 +2012,22 @@ class TestNN(NNTestCase):
         self.assertTrue(embedding.weight.grad.is_sparse)
         self.assertEqual(embedding.weight.grad.shape, embedding.weight.shape)
 
+    def test_embedding_sparse_row_gradient(self):
+        # the sparse gradient holds one row per distinct index, already coalesced
+        for padding_idx in [None, 4]:
+            sparse = nn.Embedding(10, 5, sparse=True, padding_idx=padding_idx)
+            dense = nn.Embedding(10, 5, padding_idx=padding_idx)
+            dense.weight.data.copy_(sparse.weight.data)
+            input = torch.LongTensor([[0, 2, 4, 5], [4, 3, 0, 9], [9, 9, 9, 0]])
+            grad_output = torch.randn(3, 4, 5)
+            sparse(input).backward(grad_output)
+            dense(input).backward(grad_output)
+            grad = sparse.weight.grad
+            self.assertTrue(grad.is_coalesced())
+            expected_rows = [0, 2, 3, 5, 9] if padding_idx is not None else [0, 2, 3, 4, 5, 9]
+            self.assertEqual(grad._indices().view(-1).tolist(), expected_rows)
+            self.assertEqual(grad.to_dense(), dense.weight.grad)
+
     def test_embedding_sparse_empty_tensor(self):
         embedding = nn.Embedding(0, 0, sparse=True)
         input = torch.tensor([], dtype=torch.int64)
@@ -2094,6 +2139,98 @@ class TestNN(NNTestCase):
         # should be bitwise equal
         self.assertEqual(input.grad, inputf.grad.to(dtype), prec=0)
 
+    def _test_scaled_masked_softmax(self, device, dtype=torch.double):
+        scale = 0.125
+        # rows handled by a warp, up to 2048 elements, and by a block
+        for classes in [1, 7, 64, 1000, 2048, 3000]:
+            input = torch.randn(2, 3, 5, classes, device=device, dtype=dtype)
+            for mask_size in [None, (2, 3, 5, classes), (2, 1, 5, classes), (5, classes), (1, 1)]:
+                mask = None
+                ref = input.double() * scale
+                if mask_size is not None:
+                    mask = torch.randn(*mask_size, device=device, dtype=dtype)
+                    if classes > 1 and mask_size[-1] == classes:
+                        mask.masked_fill_(mask > 1, -inf)
+                    ref = ref + mask.double()
+                out = torch._scaled_masked_softmax(input, mask, scale)
+                prec = 1e-3 if dtype == torch.half else 1e-6
+                self.assertEqual(out.double(), ref.softmax(-1), prec)
+
+        input = torch.randn(3, 4, 9, device=device, dtype=torch.double, requires_grad=True)
+        mask = torch.randn(4, 1, device=device, dtype=torch.double, requires_grad=True)
+        fn = lambda input, mask: torch._scaled_masked_softmax(input, mask, scale)
+        self.assertTrue(gradcheck(fn, (input, mask)))
+        self.assertTrue(gradgradcheck(fn, (input, mask)))
+
+    def test_scaled_masked_softmax(self):
+        self._test_scaled_masked_softmax("cpu")
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @repeat_test_for_types(ALL_TENSORTYPES)
+    @skipIfRocm
+    def test_scaled_masked_softmax_cuda(self, dtype=torch.float):
+        self._test_scaled_masked_softmax("cuda", dtype)
+
+    def _test_fused_dropout_packed(self, device, dtype=torch.double):
+        p = 0.7
+        bit_values = torch.tensor([1 << i for i in range(8)], device=device)
+
+        def unpack(mask, like):
+            bits = mask.long().unsqueeze(1).div(bit_values).remainder(2)
+            return bits.view(-1)[:like.numel()].view_as(like).double()
+
+        def gelu(x):
+            return x * 0.5 * (1 + torch.erf(x / math.sqrt(2)))
+
+        # 105 elements, which do not fill the last byte of the mask
+        input = torch.randn(3, 5, 7, device=device, dtype=dtype)
+        residual = torch.randn(3, 5, 7, device=device, dtype=dtype)
+        bias = torch.randn(7, device=device, dtype=dtype)
+        prec = 1e-2 if dtype == torch.half else 1e-6
+        out, mask = torch._fused_dropout_add(input, residual, p)
+        self.assertEqual(mask.dtype, torch.uint8)
+        self.assertEqual(mask.numel(), 14)
+        keep = unpack(mask, input)
+        self.assertEqual(out.double(), input.double() * keep / p + residual.double(), prec)
+        for activation, fn in [(0, lambda x: x), (1, F.relu), (2, gelu)]:
+            out, mask = torch._fused_bias_activation_dropout(input, bias, activation, p)
+            keep = unpack(mask, input)
+            self.assertEqual(out.double(), fn(input.double() + bias.double()) * keep / p, prec)
+
+        ones = torch.ones(10000, device=device, dtype=dtype)
+        mask = torch._fused_dropout_add(ones, ones, p)[1]
+        self.assertLess(abs(unpack(mask, ones).mean().item() - p), 0.05)
+        self.assertRaises(RuntimeError, lambda: torch._fused_bias_activation_dropout(input, bias[:6], 1, p))
+        self.assertRaises(RuntimeError, lambda: torch._fused_bias_activation_dropout(input, bias, 3, p))
+
+        if dtype != torch.double:
+            return
+
+        # the same mask has to be drawn at each evaluation
+        def fused_dropout_add(input, residual):
+            with freeze_rng_state():
+                return torch._fused_dropout_add(input, residual, p)[0]
+
+        input.requires_grad_()
+        residual.requires_grad_()
+        bias.requires_grad_()
+        self.assertTrue(gradcheck(fused_dropout_add, (input, residual)))
+        self.assertTrue(gradgradcheck(fused_dropout_add, (input, residual)))
+        for activation in [0, 1, 2]:
+            def fused_bias_activation_dropout(input, bias):
+                with freeze_rng_state():
+                    return torch._fused_bias_activation_dropout(input, bias, activation, p)[0]
+            self.assertTrue(gradcheck(fused_bias_activation_dropout, (input, bias)))
+
+    def test_fused_dropout_packed(self):
+        self._test_fused_dropout_packed("cpu")
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @repeat_test_for_types(ALL_TENSORTYPES)
+    @skipIfRocm
+    def test_fused_dropout_packed_cuda(self, dtype=torch.float):
+        self._test_fused_dropout_packed("cuda", dtype)
+
     def _test_gumbel_softmax_st(self, cuda, dtype=torch.float):
         th = torch.cuda if cuda else torch
         """
@@ -2343,6 +2480,37 @@ class TestNN(NNTestCase):
         self._test_EmbeddingBag(False, 'sum', True)
         self._test_EmbeddingBag(False, 'mean', True)
 
+        # float embeddings go through a different kernel
+        for mode in ('sum', 'mean'):
+            for sparse in (False, True):
+                self._test_EmbeddingBag(False, mode, sparse, torch.float)
+
+    def test_embedding_bag_many_bags(self):
+        num_weights, dim = 50, 7
+        lengths = [i % 5 for i in range(40)]
+        offsets = torch.tensor([0] + lengths[:-1], dtype=torch.long).cumsum(0)
+        input = torch.randint(num_weights, (sum(lengths),), dtype=torch.long)
+        for dtype in (torch.float, torch.double):
+            for contiguous in (True, False):
+                weight = torch.randn(num_weights, dim, dtype=dtype)
+                if not contiguous:
+                    weight = torch.randn(dim, num_weights, dtype=dtype).t()
+                weight.requires_grad_()
+                for mode in ('sum', 'mean'):
+                    output = F.embedding_bag(input, weight, offsets, mode=mode)
+                    bags = [weight[input[o:o + l]] for o, l in zip(offsets.tolist(), lengths)]
+                    reduce = torch.sum if mode == 'sum' else torch.mean
+                    expected = torch.stack([reduce(b, 0) if len(b) else torch.zeros(dim, dtype=dtype) for b in bags])
+                    self.assertEqual(output, expected)
+
+                    grad = torch.randn_like(output)
+                    grad_weight, = torch.autograd.grad(output, weight, grad)
+                    expected_grad, = torch.autograd.grad(expected, weight, grad)
+                    self.assertEqual(grad_weight, expected_grad)
+
+        with self.assertRaisesRegex(RuntimeError, 'out of'):
+            F.embedding_bag(torch.tensor([0, num_weights]), torch.randn(num_weights, dim), torch.tensor([0]))
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     @repeat_test_for_types(ALL_TENSORTYPES)
     @skipIfRocm
@@ -2355,6 +2523,42 @@ class TestNN(NNTestCase):
             self._test_EmbeddingBag(True, 'sum', True, dtype)
             self._test_EmbeddingBag(True, 'mean', True, dtype)
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_embedding_backward_skewed_indices_cuda(self):
+        # a few rows are looked up most of the time, as with power law ids
+        num_weights, dim = 100, 37
+        indices = torch.cat([torch.zeros(3000, dtype=torch.long),
+                             torch.full((1000,), 7, dtype=torch.long),
+                             torch.randint(num_weights, (1000,), dtype=torch.long)])
+        indices = indices[torch.randperm(indices.numel())]
+        offsets = torch.arange(0, indices.numel(), 50, dtype=torch.long)
+        grad = torch.randn(indices.numel(), dim, dtype=torch.double)
+        bag_grad = torch.randn(offsets.numel(), dim, dtype=torch.double)
+
+        for scale_grad_by_freq, padding_idx in product([False, True], [None, 7]):
+            weight = torch.randn(num_weights, dim, dtype=torch.double)
+            results = []
+            for device in ['cpu', 'cuda', 'cuda']:
+                w = weight.to(device).requires_grad_()
+                F.embedding(indices.to(device), w, padding_idx=padding_idx,
+                            scale_grad_by_freq=scale_grad_by_freq).backward(grad.to(device))
+                results.append(w.grad.cpu())
+            self.assertEqual(results[0], results[1])
+            # deterministic
+            self.assertTrue(torch.equal(results[1], results[2]))
+
+        for mode in ['sum', 'mean', 'max']:
+            weight = torch.randn(num_weights, dim, dtype=torch.double)
+            results = []
+            for device in ['cpu', 'cuda', 'cuda']:
+                w = weight.to(device).requires_grad_()
+                F.embedding_bag(indices.to(device), w, offsets.to(device),
+                                mode=mode).backward(bag_grad.to(device))
+                results.append(w.grad.cpu())
+            self.assertEqual(results[0], results[1])
+            self.assertTrue(torch.equal(results[1], results[2]))
+
     def test_fractional_max_pool2d(self):
         x = torch.randn(1, 2, 7, 7, requires_grad=True)
         samples = x.new(1, 2, 2).uniform_()
@@ -2617,13 +2821,39 @@ class TestNN(NNTestCase):
         output.sum().backward()
         self.assertEqual(output.type(), input.type())
 
+    def _test_LayerNorm_numeric(self, device="cpu"):
+        # compare with the normalization by the mean and variance of each row,
+        # for rows that don't fill a whole number of vectors or warps
+        def reference(x, normalized_shape, weight, bias, eps):
+            x_rows = x.view(-1, weight.numel())
+            mean = x_rows.mean(-1, keepdim=True)
+            var = x_rows.var(-1, unbiased=False, keepdim=True)
+            out = (x_rows - mean) / (var + eps).sqrt()
+            return out.view_as(x) * weight + bias
+
+        for shape, normalized_shape in [((3, 37), (37,)), ((5, 2, 300), (2, 300)), ((2, 1025), (1025,))]:
+            x = torch.randn(*shape, device=device, dtype=torch.double) * 3 + 10
+            weight = torch.rand(*normalized_shape, device=device, dtype=torch.double) + 0.5
+            bias = torch.randn(*normalized_shape, device=device, dtype=torch.double)
+            grad = torch.randn(*shape, device=device, dtype=torch.double)
+            results = []
+            for fn in [F.layer_norm, reference]:
+                inputs = [t.clone().requires_grad_() for t in (x, weight, bias)]
+                out = fn(inputs[0], normalized_shape, inputs[1], inputs[2], 1e-5)
+                out.backward(grad)
+                results.append([out] + [t.grad for t in inputs])
+            for actual, expected in zip(*results):
+                self.assertEqual(actual, expected, prec=1e-8)
+
     def test_LayerNorm_general(self):
         self._test_LayerNorm_general()
+        self._test_LayerNorm_numeric()
 
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     @skipIfRocm
     def test_LayerNorm_general_cuda(self):
         self._test_LayerNorm_general("cuda")
+        self._test_LayerNorm_numeric("cuda")
         self._test_LayerNorm_cuda_half()
 
     def _test_GroupNorm_general(self, device="cpu", dtype=torch.float):
@@ -2852,6 +3082,38 @@ class TestNN(NNTestCase):
     def test_Conv2d_naive_groups_cuda(self, dtype=torch.float):
         self._test_Conv2d_naive_groups("cuda", dtype)
 
+    def _test_Conv2d_channels_last(self, device="cpu", dtype=torch.float):
+        conv = nn.Conv2d(8, 16, 3, padding=1).to(device, dtype)
+        # an NHWC image, viewed as NCHW
+        input = torch.randn(2, 10, 12, 8, device=device, dtype=dtype).permute(0, 3, 1, 2)
+        input.requires_grad_()
+        input_c = input.detach().contiguous().requires_grad_()
+
+        output = conv(input)
+        output_c = conv(input_c)
+        prec = dtype2prec[dtype]
+        self.assertEqual(output, output_c, prec)
+
+        grad = torch.randn_like(output_c)
+        grads = torch.autograd.grad(output, (input,) + tuple(conv.parameters()), grad)
+        grads_c = torch.autograd.grad(output_c, (input_c,) + tuple(conv.parameters()), grad)
+        for g, g_c in zip(grads, grads_c):
+            self.assertEqual(g, g_c, prec)
+        return output
+
+    def test_Conv2d_channels_last(self):
+        self._test_Conv2d_channels_last()
+
+    @unittest.skipIf(not TEST_CUDNN, "needs cudnn")
+    @repeat_test_for_types(ALL_TENSORTYPES)
+    @skipIfRocm
+    def test_Conv2d_channels_last_cudnn(self, dtype=torch.float):
+        output = self._test_Conv2d_channels_last("cuda", dtype)
+        if torch.backends.cudnn.version() >= 7000:
+            # cuDNN computes the output of a channels last input channels last
+            self.assertEqual(output.permute(0, 2, 3, 1).stride(),
+                             output.permute(0, 2, 3, 1).contiguous().stride())
+
     def test_batchnorm_grad(self):
         self._test_batchnorm_grad()
 
@@ -2955,6 +3217,31 @@ class TestNN(NNTestCase):
     def test_max_pool_nan(self, dtype=torch.float):
         self._test_max_pool_nan(self, device="cpu")
 
+    def test_pool2d_cpu_vectorized(self):
+        # 4-d CPU inputs are pooled by the vectorized kernels, in either layout,
+        # 3-d inputs by THNN, as are max poolings computing indices
+        for dtype in [torch.float, torch.double]:
+            x = torch.randn(2, 11, 9, 19, dtype=dtype)
+            x[0, 3, 4, 5] = nan
+            channels_last = x.permute(0, 2, 3, 1).contiguous().permute(0, 3, 1, 2)
+            for kernel, stride, padding, dilation, ceil_mode in product(
+                    [(1, 1), (2, 3), (3, 3)], [1, 2, (1, 3)], [0, 1], [1, 2], [False, True]):
+                if padding > min(kernel) // 2:
+                    continue
+                args = (kernel, stride, padding, dilation, ceil_mode)
+                expected = F.max_pool2d(x, *args)
+                self.assertEqual(torch.max_pool2d(x, *args), expected)
+                self.assertEqual(torch.max_pool2d(channels_last, *args), expected)
+                if dilation != 1:
+                    continue
+                for count_include_pad in [False, True]:
+                    args = (kernel, stride, padding, ceil_mode, count_include_pad)
+                    expected = torch.stack([F.avg_pool2d(x[n], *args) for n in range(x.size(0))])
+                    self.assertEqual(F.avg_pool2d(x, *args), expected)
+                    self.assertEqual(F.avg_pool2d(channels_last, *args), expected)
+            self.assertEqual(F.adaptive_avg_pool2d(x, 1), F.adaptive_avg_pool2d(x, (1, 2)).mean(-1, True))
+            self.assertEqual(F.adaptive_avg_pool2d(channels_last, 1), F.adaptive_avg_pool2d(x, 1))
+
     def _test_scatter(self, tensor):
         x = tensor.detach().requires_grad_()
         result = dp.scatter(x, (0, 1))
@@ -3713,6 +4000,39 @@ class TestNN(NNTestCase):
             self.assertEqual(conv1.bias.grad.data, conv2.bias.grad.data, prec=0.0)
             self.assertEqual(conv1.weight.grad.data, conv2.weight.grad.data, prec=0.0)
 
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    @skipIfRocm
+    def test_Conv2d_benchmark_cache_cudnn(self):
+        inputs = torch.randn(2, 3, 7, 7, device="cuda", requires_grad=True)
+        conv = torch.nn.Conv2d(3, 5, 3).to("cuda")
+        with cudnn.flags(enabled=True, benchmark=True):
+            conv(inputs).sum().backward()
+        with tempfile.NamedTemporaryFile() as f:
+            cudnn.export_benchmark_cache(f.name)
+            # The forward, backward data and backward filter algorithms
+            self.assertGreaterEqual(cudnn.import_benchmark_cache(f.name), 3)
+            with open(f.name, 'a') as cache:
+                cache.write('device 0 some other GPU\nfwd 0 1 2 3\n')
+            self.assertRaises(RuntimeError, lambda: cudnn.import_benchmark_cache(f.name))
+
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    @skipIfRocm
+    def test_Conv2d_workspace_limit_cudnn(self):
+        inputs = torch.randn(2, 3, 9, 9, device="cuda")
+        conv = torch.nn.Conv2d(3, 5, 3).to("cuda")
+        with cudnn.flags(enabled=False):
+            expected = conv(inputs)
+        for benchmark in [False, True]:
+            for limit in [1, 1 << 20]:
+                with cudnn.flags(enabled=True, benchmark=benchmark, workspace_limit=limit):
+                    self.assertEqual(cudnn.workspace_limit, limit)
+                    self.assertEqual(conv(inputs), expected)
+        with self.assertRaises(RuntimeError):
+            with cudnn.flags(enabled=True, workspace_limit=-1):
+                pass
+
     def test_Conv2d_missing_argument(self):
         c = nn.Conv2d(3, 3, 3)
         self.assertRaises(TypeError, lambda: c(None))
@@ -3873,27 +4193,24 @@ class TestNN(NNTestCase):
 
     # Very similar to test_Conv2d_naive_groups but with special care to handle
     # the number of groups == number of input channels
-    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
-    @skipIfRocm
-    @repeat_test_for_types(ALL_TENSORTYPES)
-    def test_Conv2d_depthwise_naive_groups_cuda(self, dtype=torch.float):
+    def _test_Conv2d_depthwise_naive_groups(self, device="cpu", dtype=torch.float, **kwargs):
         for depth_multiplier in [1, 2]:
-            m = nn.Conv2d(2, 2 * depth_multiplier, kernel_size=3, groups=2).to("cuda", dtype)
-            i = torch.randn(2, 2, 6, 6, device="cuda", dtype=dtype).div_(2).requires_grad_()
+            m = nn.Conv2d(2, 2 * depth_multiplier, kernel_size=3, groups=2, **kwargs).to(device, dtype)
+            i = torch.randn(2, 2, 7, 6, device=device, dtype=dtype).div_(2).requires_grad_()
             output = m(i)
-            grad_output = torch.randn(2, 2 * depth_multiplier, 4, 4, device="cuda", dtype=dtype) / 2
+            grad_output = torch.randn(output.size(), device=device, dtype=dtype) / 2
             output.backward(grad_output)
 
             offset = 1 * depth_multiplier
 
-            m1 = nn.Conv2d(1, 1 * depth_multiplier, kernel_size=3).to("cuda", dtype)
+            m1 = nn.Conv2d(1, 1 * depth_multiplier, kernel_size=3, **kwargs).to(device, dtype)
             m1.weight.data = m.weight.data[:offset].clone()
             m1.bias.data = m.bias.data[:offset].clone()
             i1 = i.detach()[:, :1].clone().requires_grad_()
             output1 = m1(i1)
             output1.backward(grad_output[:, :offset].contiguous())
 
-            m2 = nn.Conv2d(1, 1 * depth_multiplier, kernel_size=3).to("cuda", dtype)
+            m2 = nn.Conv2d(1, 1 * depth_multiplier, kernel_size=3, **kwargs).to(device, dtype)
             m2.weight.data.copy_(m.weight.data[offset:])
             m2.bias.data.copy_(m.bias.data[offset:])
             i2 = i.detach()[:, 1:].clone().requires_grad_()
@@ -3914,6 +4231,25 @@ class TestNN(NNTestCase):
                                         m2.weight.grad.data], 0),
                              prec=dtype2prec[dtype])
 
+    def test_Conv2d_depthwise_naive_groups(self):
+        self._test_Conv2d_depthwise_naive_groups()
+        self._test_Conv2d_depthwise_naive_groups(dtype=torch.double, stride=(2, 1), padding=(0, 2))
+        self._test_Conv2d_depthwise_naive_groups(stride=2, padding=1, dilation=(1, 2))
+
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @skipIfRocm
+    @repeat_test_for_types(ALL_TENSORTYPES)
+    def test_Conv2d_depthwise_naive_groups_cuda(self, dtype=torch.float):
+        self._test_Conv2d_depthwise_naive_groups("cuda", dtype)
+
+    def test_Conv2d_1x1(self):
+        for stride in [1, 2]:
+            m = nn.Conv2d(4, 5, kernel_size=1, stride=stride).double()
+            i = torch.randn(2, 4, 7, 6, dtype=torch.double, requires_grad=True)
+            # dilated convolutions always go through im2col
+            self.assertEqual(m(i), F.conv2d(i, m.weight, m.bias, stride, dilation=2))
+            self.assertTrue(gradcheck(lambda i, w, b: F.conv2d(i, w, b, stride), (i, m.weight, m.bias)))
+
     def test_MaxUnpool2d_output_size(self):
         m = nn.MaxPool2d(3, stride=2, return_indices=True)
         mu = nn.MaxUnpool2d(3, stride=2)
@@ -4241,6 +4577,95 @@ class TestNN(NNTestCase):
 
             (hx + cx).sum().backward()
 
+    def test_fused_rnn_cells(self):
+        # the cells use fused kernels for their pointwise parts; check them
+        # against the unfused formulas, and their backward with gradcheck
+        def lstm_cell_ref(input, hx, cx, w_ih, w_hh, b_ih, b_hh):
+            gates = F.linear(input, w_ih, b_ih) + F.linear(hx, w_hh, b_hh)
+            ingate, forgetgate, cellgate, outgate = gates.chunk(4, 1)
+            cy = forgetgate.sigmoid() * cx + ingate.sigmoid() * cellgate.tanh()
+            hy = outgate.sigmoid() * cy.tanh()
+            return hy, cy
+
+        def gru_cell_ref(input, hx, w_ih, w_hh, b_ih, b_hh):
+            i_r, i_i, i_n = F.linear(input, w_ih, b_ih).chunk(3, 1)
+            h_r, h_i, h_n = F.linear(hx, w_hh, b_hh).chunk(3, 1)
+            resetgate = (i_r + h_r).sigmoid()
+            inputgate = (i_i + h_i).sigmoid()
+            newgate = (i_n + resetgate * h_n).tanh()
+            return newgate + inputgate * (hx - newgate)
+
+        # a hidden size that isn't a multiple of the vector width
+        input_size, hidden_size = 5, 11
+        for bias in (True, False):
+            input = torch.randn(3, input_size, dtype=torch.double, requires_grad=True)
+            hx = torch.randn(3, hidden_size, dtype=torch.double, requires_grad=True)
+            cx = torch.randn(3, hidden_size, dtype=torch.double, requires_grad=True)
+
+            lstm = nn.LSTMCell(input_size, hidden_size, bias=bias).double()
+            params = (lstm.weight_ih, lstm.weight_hh, lstm.bias_ih, lstm.bias_hh)
+            self.assertEqual(lstm(input, (hx, cx)), lstm_cell_ref(input, hx, cx, *params))
+            gradcheck(lambda *args: lstm(args[0], args[1:]), (input, hx, cx))
+            # only one of the outputs is used
+            gradcheck(lambda *args: lstm(args[0], args[1:])[1], (input, hx, cx))
+
+            gru = nn.GRUCell(input_size, hidden_size, bias=bias).double()
+            params = (gru.weight_ih, gru.weight_hh, gru.bias_ih, gru.bias_hh)
+            self.assertEqual(gru(input, hx), gru_cell_ref(input, hx, *params))
+            gradcheck(gru, (input, hx))
+
+        # the layers project the inputs of all steps at once
+        input = torch.randn(4, 3, input_size)
+        for module in (nn.LSTM, nn.GRU, nn.RNN):
+            for bidirectional in (False, True):
+                rnn = module(input_size, hidden_size, bidirectional=bidirectional)
+                output, _ = rnn(input)
+                cell_type = {nn.LSTM: nn.LSTMCell, nn.GRU: nn.GRUCell, nn.RNN: nn.RNNCell}[module]
+                for direction, suffix in enumerate(['', '_reverse'][:1 + bidirectional]):
+                    cell = cell_type(input_size, hidden_size)
+                    cell.weight_ih = getattr(rnn, 'weight_ih_l0' + suffix)
+                    cell.weight_hh = getattr(rnn, 'weight_hh_l0' + suffix)
+                    cell.bias_ih = getattr(rnn, 'bias_ih_l0' + suffix)
+                    cell.bias_hh = getattr(rnn, 'bias_hh_l0' + suffix)
+                    steps = range(input.size(0))
+                    if direction == 1:
+                        steps = reversed(steps)
+                    hidden = None
+                    for t in steps:
+                        hidden = cell(input[t], hidden)
+                        h = hidden[0] if module is nn.LSTM else hidden
+                        self.assertEqual(output[t, :, direction * hidden_size:(direction + 1) * hidden_size], h)
+
+    def test_fused_rnn_cells_gradgrad(self):
+        # the fused cells fall back to a differentiable backward when the
+        # backward creates a graph
+        input_size, hidden_size = 3, 5
+        for bias in (True, False):
+            input = torch.randn(2, input_size, dtype=torch.double, requires_grad=True)
+            hx = torch.randn(2, hidden_size, dtype=torch.double, requires_grad=True)
+            cx = torch.randn(2, hidden_size, dtype=torch.double, requires_grad=True)
+
+            lstm = nn.LSTMCell(input_size, hidden_size, bias=bias).double()
+            params = tuple(lstm.parameters())
+
+            def lstm_fn(input, hx, cx, *params):
+                return torch._C._VariableFunctions.lstm_cell(input, (hx, cx), *params)
+            self.assertTrue(gradgradcheck(lstm_fn, (input, hx, cx) + params))
+            # only one of the outputs is used
+            self.assertTrue(gradgradcheck(lambda *args: lstm_fn(*args)[1], (input, hx, cx) + params))
+
+            gru = nn.GRUCell(input_size, hidden_size, bias=bias).double()
+            params = tuple(gru.parameters())
+
+            def gru_fn(input, hx, *params):
+                return torch._C._VariableFunctions.gru_cell(input, hx, *params)
+            self.assertTrue(gradgradcheck(gru_fn, (input, hx) + params))
+
+        input = torch.randn(3, 2, input_size, dtype=torch.double, requires_grad=True)
+        for module in (nn.LSTM, nn.GRU):
+            rnn = module(input_size, hidden_size).double()
+            self.assertTrue(gradgradcheck(lambda input: rnn(input)[0], (input,)))
+
     @unittest.skipIf(not (TEST_CUDNN and TEST_MULTIGPU), 'CUDNN or multi-gpu not available')
     def test_cudnn_rnn_dropout_states_device(self):
         rnn = nn.RNN(10, 20, num_layers=2, dropout=.5)
@@ -5610,6 +6035,60 @@ class TestNN(NNTestCase):
                     with cudnn.flags(enabled=False):
                         test(N, C, H, W, mode, padding_mode)
 
+    def test_grid_sample_cpu_tiles_and_channels_last(self):
+        # the CPU kernel splits the output in tiles of rows, and samples
+        # channels last inputs a vector of channels at a time
+        for dtype in [torch.float, torch.double]:
+            for N, C in [(1, 37), (3, 3), (2, 1)]:
+                input = torch.randn(N, C, 5, 7, dtype=dtype)
+                channels_last = input.permute(0, 2, 3, 1).contiguous().permute(0, 3, 1, 2)
+                # out of bounds locations too
+                grid = torch.randn(N, 9, 11, 2, dtype=dtype) * 1.5
+                for mode, padding_mode in product(['bilinear', 'nearest'], ['zeros', 'border', 'reflection']):
+                    expected = torch.cat([F.grid_sample(input[n:n + 1], grid[n:n + 1], mode=mode,
+                                                        padding_mode=padding_mode) for n in range(N)])
+                    out = F.grid_sample(input, grid, mode=mode, padding_mode=padding_mode)
+                    self.assertEqual(out, expected)
+                    out = F.grid_sample(channels_last, grid, mode=mode, padding_mode=padding_mode)
+                    self.assertEqual(out, expected)
+                    if C > 1:
+                        self.assertTrue(out.permute(0, 2, 3, 1).is_contiguous())
+
+    def test_roi_pooling_2d_cpu(self):
+        # the CPU kernel pools RoIs in parallel, and accumulates the gradient
+        # of chunks of RoIs in buffers of their own
+        N, C, H, W, PH, PW = 2, 8, 10, 12, 3, 4
+        # positive inputs, empty tiles pool to 0
+        input = (torch.rand(N, C, H, W) + 0.1).requires_grad_()
+        num_rois = 1000
+        starts = torch.randint(-2, 9, (num_rois, 2)).float()
+        # whole tiles, so that their bounds are exact in single precision
+        sizes = torch.randint(0, 3, (num_rois, 2)).float() * torch.tensor([PW, PH]).float()
+        rois = torch.cat([torch.randint(0, N, (num_rois, 1)).float(), starts, starts + sizes], 1)
+        out, argmaxes = torch.RoiPooling2d_forward(input, rois, PH, PW, 1.0)
+
+        expected = torch.zeros(num_rois, C, PH, PW)
+        for i, (n, x1, y1, x2, y2) in enumerate(rois.long().tolist()):
+            tile_h, tile_w = (y2 - y1) / float(PH), (x2 - x1) / float(PW)
+            for ph, pw in product(range(PH), range(PW)):
+                h1 = min(max(int(math.floor(ph * tile_h)) + y1, 0), H)
+                h2 = min(max(int(math.ceil((ph + 1) * tile_h)) + y1, 0), H)
+                w1 = min(max(int(math.floor(pw * tile_w)) + x1, 0), W)
+                w2 = min(max(int(math.ceil((pw + 1) * tile_w)) + x1, 0), W)
+                if h1 < h2 and w1 < w2:
+                    expected[i, :, ph, pw] = input.data[n, :, h1:h2, w1:w2].contiguous().view(C, -1).max(1)[0]
+        self.assertEqual(out, expected)
+
+        grad_output = torch.randn(num_rois, C, PH, PW)
+        out.backward(grad_output)
+        expected_grad = torch.zeros(N, C, H * W)
+        for i, n in enumerate(rois[:, 0].long().tolist()):
+            for c in range(C):
+                index = argmaxes[i, c].view(-1).long()
+                valid = index != -1
+                expected_grad[n, c].index_add_(0, index[valid], grad_output[i, c].view(-1)[valid])
+        self.assertEqual(input.grad, expected_grad.view(N, C, H, W))
+
     @skipIfRocm
     def test_grid_sample_3d(self):
         def test(N, C, D, H, W, mode, padding_mode):
@@ -7157,6 +7636,19 @@ new_criterion_tests = [
         check_half=False,
         convert_target=False,
     ),
+    dict(
+        module_name='CTCLoss',
+        desc='varying_lengths',
+        constructor_args=(0,),  # blank=0
+        extra_args=([50, 41, 23], [30, 17, 1]),  # input_lengths, target_lengths
+        input_fn=lambda: torch.randn(50, 3, 15).log_softmax(2),
+        target_fn=lambda: torch.randint(1, 15, (3, 30), dtype=torch.long),
+        reference_fn=lambda i, t, il, tl, m:
+            ctcloss_reference(i, t, il, tl, blank=0, reduction=get_reduction(m)),
+        check_sum_reduction=True,
+        check_gradgrad=False,
+        check_half=False,
+    ),
     dict(
         module_name='CTCLoss',
         desc='2d_lengths_tensors',
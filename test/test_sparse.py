@@ -633,6 +633,40 @@ class TestSparse(TestCase):
         test_shape(10, 20, 0, 0)
         test_shape(10, 20, 0, 20)
 
+    def test_coalesce_many_nnz(self):
+        # enough nnz for the entries to be sorted and summed in chunks
+        def check_coalesced(x, expected):
+            self.assertTrue(x.is_coalesced())
+            keys = x._indices()[0] * x.size(1) + x._indices()[1]
+            self.assertTrue((keys[1:] > keys[:-1]).all())
+            self.assertEqual(self.safeToDense(x), expected)
+
+        nnz = 100000
+        i = self.IndexTensor(2, nnz).random_(0, 300)
+        v = self.randn(nnz, 2)
+        x = self.SparseTensor(i, v, torch.Size([300, 300, 2]))
+        check_coalesced(x.coalesce(), self.safeToDense(x))
+
+        # already sorted, with duplicates
+        keys = (i[0] * 300 + i[1]).sort()[0]
+        i = torch.stack([keys / 300, keys % 300])
+        x = self.SparseTensor(i, v, torch.Size([300, 300, 2]))
+        check_coalesced(x.coalesce(), self.safeToDense(x))
+
+        # unique, but not sorted: the transpose of a coalesced tensor
+        x_t = x.coalesce().t()
+        self.assertFalse(x_t.is_coalesced())
+        check_coalesced(x_t.coalesce(), self.safeToDense(x).transpose(0, 1))
+
+        # the same, declared by the producer
+        i = self.IndexTensor(list(reversed(range(300)))).unsqueeze(0)
+        x = self.SparseTensor(i, self.randn(300), torch.Size([300]))._unique_indices_(True)
+        self.assertFalse(x.is_coalesced())
+        y = x.coalesce()
+        self.assertTrue(y.is_coalesced())
+        self.assertEqual(y._indices()[0], self.IndexTensor(list(range(300))))
+        self.assertEqual(self.safeToDense(y), self.safeToDense(x))
+
     def test_t_empty(self):
         def test_in_place(x):
             shape_original = x.shape
@@ -820,6 +854,31 @@ class TestSparse(TestCase):
         test_shape(1000, 100, 0, 0)
         test_shape(1000, 100, 0, 20)
 
+    @skipIfRocm
+    def test_mm_same_sparse_matrix(self):
+        # the CSR indices of a coalesced matrix are kept from a product to the
+        # next, and must follow the changes of its indices
+        x = self._gen_sparse(2, 40, [30, 20])[0].coalesce()
+        y = self.randn(20, 5)
+        for _ in range(3):
+            self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(x), y))
+
+        other = self._gen_sparse(2, 10, [30, 20])[0].coalesce()
+        x.add_(other)
+        self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(x), y))
+
+        x.sparse_resize_([40, 20], 2, 0)
+        self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(x), y))
+
+        # a matrix-vector product, rows with very different nnz and empty rows
+        i = self.IndexTensor([[0] * 50 + [3, 5, 5], list(range(50)) + [1, 2, 3]])
+        v = self.ValueTensor(53).uniform_()
+        x = self.SparseTensor(i, v, torch.Size([8, 50])).coalesce()
+        y = self.randn(50, 1)
+        self.assertEqual(torch.mm(x, y), torch.mm(self.safeToDense(x), y))
+        self.assertEqual(torch.addmm(y[:8], x, y, beta=2, alpha=0.5),
+                         torch.addmm(y[:8], self.safeToDense(x), y, beta=2, alpha=0.5))
+
     @skipIfRocm
     def test_hsmm(self):
         def test_shape(di, dj, dk, nnz):
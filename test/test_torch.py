@@ -1147,6 +1147,44 @@ class _TestTorchMixin(object):
                         self.assertEqual(expected.shape, actual.shape)
                         self.assertTrue(np.allclose(expected, actual.cpu().numpy()))
 
+    def test_cdist(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            for p in [0, 1, 2, 3, 1.5, float('inf')]:
+                x1 = torch.randn(5, 7, device=device, dtype=torch.double)
+                x2 = torch.randn(4, 7, device=device, dtype=torch.double).t()
+                expected = (x1.unsqueeze(1) - x2.t().unsqueeze(0)).norm(p, 2)
+                self.assertEqual(torch.cdist(x1, x2.t(), p), expected)
+
+            # the Euclidean distance of equal rows is not negative or nan
+            x = torch.randn(6, 3, device=device)
+            dist = torch.cdist(x, x)
+            self.assertTrue((dist >= 0).all())
+            self.assertEqual(dist.diag(), torch.zeros(6, device=device), 1e-3)
+
+            self.assertEqual(torch.cdist(torch.randn(0, 3, device=device), x).size(), (0, 6))
+            self.assertEqual(torch.cdist(torch.randn(2, 0, device=device), torch.randn(6, 0, device=device)),
+                             torch.zeros(2, 6, device=device))
+            self.assertRaises(RuntimeError, lambda: torch.cdist(x, torch.randn(6, 4, device=device)))
+
+            x1 = torch.randn(3, 4, device=device, dtype=torch.double, requires_grad=True)
+            x2 = torch.randn(5, 4, device=device, dtype=torch.double, requires_grad=True)
+            for p in [1, 2, 3]:
+                self.assertTrue(torch.autograd.gradcheck(lambda a, b: torch.cdist(a, b, p), (x1, x2)))
+
+    def test_cdist_topk(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            x1 = torch.randn(6, 5, device=device, dtype=torch.double)
+            x2 = torch.randn(20, 5, device=device, dtype=torch.double)
+            for p, largest in [(2, False), (1, False), (2, True)]:
+                values, indices = torch.cdist_topk(x1, x2, 3, p, largest)
+                expected_values, expected_indices = torch.cdist(x1, x2, p).topk(3, 1, largest)
+                self.assertEqual(values, expected_values)
+                self.assertEqual(indices, expected_indices)
+            self.assertEqual(torch.cdist_topk(x1, x2, 0)[0].size(), (6, 0))
+            self.assertRaises(RuntimeError, lambda: torch.cdist_topk(x1, x2, 21))
+
     @unittest.skipIf(not TEST_SCIPY, "Scipy not found")
     def test_logsumexp(self):
         from scipy.special import logsumexp
@@ -1411,6 +1449,36 @@ class _TestTorchMixin(object):
             res2[i, 3] = res2[i, 3] * 2
         self.assertEqual(res1, res2)
 
+    def test_binary_ops_mixed_layouts(self):
+        # operands laid out differently are run by blocked loops, with tiles
+        # that don't divide the sizes
+        nchw = torch.randn(2, 5, 37, 41)
+        nhwc = torch.randn(2, 37, 41, 5).permute(0, 3, 1, 2)
+        transposed = torch.randn(101, 67).t()
+        contiguous = torch.randn(67, 101)
+        for dtype in [torch.float, torch.double, torch.int]:
+            for x, y in [(nchw, nhwc), (nhwc, nchw), (contiguous, transposed), (transposed, contiguous)]:
+                x = x.to(dtype)
+                y = y.to(dtype)
+                x_c = x.contiguous()
+                y_c = y.contiguous()
+                self.assertEqual(x + y, x_c + y_c, 0)
+                self.assertEqual(x * y, x_c * y_c, 0)
+                self.assertEqual(x - y, x_c - y_c, 0)
+                # with a broadcast scalar along the way
+                self.assertEqual(x + y[..., :1], x_c + y_c[..., :1], 0)
+                out = torch.empty_like(y)
+                torch.add(x, y, out=out)
+                self.assertEqual(out, x_c + y_c, 0)
+
+    def test_elementwise_keeps_channels_last(self):
+        x = torch.randn(2, 6, 7, 3).permute(0, 3, 1, 2)
+        nhwc_strides = x.stride()
+        self.assertFalse(x.is_contiguous())
+        self.assertEqual((x + 1).stride(), nhwc_strides)
+        self.assertEqual((x * x).stride(), nhwc_strides)
+        self.assertEqual(torch.add(x, x, alpha=2).stride(), nhwc_strides)
+
     def test_div(self):
         m1 = torch.randn(10, 10)
         res1 = m1.clone()
@@ -1624,6 +1692,26 @@ class _TestTorchMixin(object):
             self.assertRaises(RuntimeError, lambda: torch.bmm(b1, b2.cuda()))
             self.assertRaises(RuntimeError, lambda: torch.bmm(b1.cuda(), b2))
 
+    def test_baddbmm_packed(self):
+        for dtype in [torch.float, torch.double]:
+            for M, N, O in [(1, 1, 1), (23, 8, 12), (5, 17, 33), (64, 64, 64)]:
+                b1 = torch.randn(6, M, N, dtype=dtype)
+                b2 = torch.randn(6, O, N, dtype=dtype).transpose(1, 2)
+                expected = torch.stack([torch.mm(b1[i], b2[i]) for i in range(6)])
+                res = torch.zeros(6, M, O, dtype=dtype)
+                torch._baddbmm_packed_(res, b1, b2, beta=0, alpha=1)
+                self.assertEqual(res, expected)
+                # non contiguous result, accumulated into
+                res2 = torch.ones(6, O, M, dtype=dtype).transpose(1, 2)
+                torch._baddbmm_packed_(res2, b1, b2, beta=.5, alpha=2)
+                self.assertEqual(res2, expected * 2 + .5)
+                # the same values through bmm, whichever backend it chooses
+                self.assertEqual(torch.bmm(b1, b2), expected)
+                self.assertEqual(torch.bmm(b1, b2), expected)
+        self.assertRaises(RuntimeError, lambda: torch._baddbmm_packed_(
+            torch.zeros(2, 3, 4, dtype=torch.long), torch.zeros(2, 3, 5, dtype=torch.long),
+            torch.zeros(2, 5, 4, dtype=torch.long)))
+
     def test_addbmm(self):
         # num_batches = 10
         # M, N, O = 12, 8, 5
@@ -1964,6 +2052,26 @@ class _TestTorchMixin(object):
         torch.sum(x, (2, 1), out=res2)
         self.assertEqual(res1, res2)
 
+    def test_out_from_inplace(self):
+        x = torch.randn(10, 10)
+        for fn in [torch.relu, torch.selu, lambda x, **kwargs: torch.celu(x, 0.5, **kwargs)]:
+            expected = fn(x)
+            res = torch.empty(10, 10)
+            data_ptr = res.data_ptr()
+            self.assertIs(fn(x, out=res), res)
+            self.assertEqual(res, expected)
+            # out of the right size is written in place
+            self.assertEqual(res.data_ptr(), data_ptr)
+
+            res = torch.Tensor()
+            fn(x, out=res)
+            self.assertEqual(res, expected)
+
+        y = torch.rand(5, 5) + 1
+        res = torch.Tensor()
+        torch.mvlgamma(y, 2, out=res)
+        self.assertEqual(res, torch.mvlgamma(y, 2))
+
     # TODO: these tests only check if it's possible to pass a return value
     # it'd be good to expand them
     def test_prod(self):
@@ -2094,6 +2202,26 @@ class _TestTorchMixin(object):
         z = torch.Tensor((0, 3, 0, 2, 1))
         self.assertEqual(y, z)
 
+    def test_histc_bincount_large(self):
+        # large enough inputs are counted in parallel, into bins of each thread
+        x = torch.randn(300000, dtype=torch.double)
+        for bins, min, max in [(1000, 0, 0), (10, -1, 1), (100000, -2, 3)]:
+            if min != max:
+                # NaNs are not counted, but would make the default range NaN
+                x[::7] = nan
+            hist = torch.histc(x, bins, min, max)
+            lo, hi = (x.min().item(), x.max().item()) if min == max else (min, max)
+            inside = x[(x >= lo) & (x <= hi)]
+            expected = torch.bincount(((inside - lo) / (hi - lo) * bins).long().clamp(max=bins - 1), minlength=bins)
+            self.assertEqual(hist, expected.double())
+            self.assertEqual(torch.histc(x.float(), bins, min, max).sum(), inside.numel())
+
+        i = torch.randint(0, 5000, (300000,))
+        w = torch.rand(300000, dtype=torch.double)
+        expected = torch.zeros(5000, dtype=torch.double).index_add_(0, i, w)
+        self.assertEqual(torch.bincount(i, w), expected)
+        self.assertEqual(torch.bincount(i), torch.zeros(5000, dtype=torch.long).index_add_(0, i, torch.ones_like(i)))
+
     def test_ones(self):
         res1 = torch.ones(100, 100)
         res2 = torch.Tensor()
@@ -2836,6 +2964,38 @@ class _TestTorchMixin(object):
     def test_multinomial(self):
         self._test_multinomial(self, torch.FloatTensor)
 
+    @staticmethod
+    def _test_multinomial_alias(self, device):
+        probs = torch.tensor([0.1, 0.0, 0.3, 0.6, 0.0, 1.0], device=device)
+        q, J = torch._multinomial_alias_setup(probs)
+        self.assertEqual(q.device, probs.device)
+        self.assertEqual(J.dtype, torch.int64)
+        # the table holds the whole mass of each category, normalized
+        mass = q.double().cpu().clone()
+        mass.index_add_(0, J.cpu(), 1 - q.double().cpu())
+        self.assertEqual(mass / 6, (probs / probs.sum()).double().cpu(), 1e-6)
+
+        samples = torch._multinomial_alias_draw(q, J, 100000)
+        self.assertEqual(samples.device, probs.device)
+        self.assertEqual(samples.size(), (100000,))
+        counts = torch.bincount(samples.cpu(), minlength=6).double()
+        self.assertEqual(counts[1], 0)
+        self.assertEqual(counts[4], 0)
+        self.assertEqual(counts / 100000, (probs / probs.sum()).double().cpu(), 0.01)
+
+        torch.manual_seed(123)
+        first = torch._multinomial_alias_draw(q, J, 1000)
+        torch.manual_seed(123)
+        self.assertEqual(first, torch._multinomial_alias_draw(q, J, 1000))
+
+        self.assertEqual(torch._multinomial_alias_draw(q, J, 0).numel(), 0)
+        self.assertRaises(RuntimeError, lambda: torch._multinomial_alias_setup(probs.view(2, 3)))
+        self.assertRaises(RuntimeError, lambda: torch._multinomial_alias_setup(-probs))
+        self.assertRaises(RuntimeError, lambda: torch._multinomial_alias_setup(torch.zeros(3, device=device)))
+
+    def test_multinomial_alias(self):
+        self._test_multinomial_alias(self, 'cpu')
+
     def _spawn_method(self, method, arg):
         try:
             mp.set_start_method('spawn')
@@ -3383,6 +3543,27 @@ class _TestTorchMixin(object):
         torch.zeros(5, 6).copy_(torch.zeros(6))
         self.assertRaises(RuntimeError, lambda: torch.zeros(5, 6).copy_(torch.zeros(30)))
 
+    def test_copy_convert(self):
+        # contiguous, transposed and broadcast sources of every pair of types,
+        # with sizes that aren't multiples of the vector widths or tiles
+        dtypes = [torch.uint8, torch.int8, torch.int16, torch.int32, torch.int64,
+                  torch.half, torch.float, torch.double]
+        base = (torch.arange(67 * 35) % 101).reshape(67, 35)
+        expected = base.tolist()
+        for src_dtype in dtypes:
+            src = base.to(src_dtype)
+            for dtype in dtypes:
+                self.assertEqual(torch.empty(67, 35, dtype=dtype).copy_(src).tolist(), expected)
+                dst = torch.empty(35, 67, dtype=dtype).copy_(src.t())
+                self.assertEqual(dst.t().tolist(), expected)
+                dst = torch.empty(35, 67, dtype=dtype).t().copy_(src)
+                self.assertEqual(dst.tolist(), expected)
+                dst = torch.empty(67, 35, dtype=dtype).copy_(src[:1])
+                self.assertEqual(dst.tolist(), expected[:1] * 67)
+        # negative floats wrap around when converted to uint8, see
+        # Note [Implicit conversion between signed and unsigned]
+        self.assertEqual(torch.tensor([-1., -2.5]).byte().tolist(), [255, 254])
+
     def test_randperm(self):
         _RNGState = torch.get_rng_state()
         res1 = torch.randperm(100)
@@ -3398,6 +3579,16 @@ class _TestTorchMixin(object):
         self.assertEqual(res1.numel(), 0)
         self.assertEqual(res2.numel(), 0)
 
+        # large permutations are generated in parallel
+        n = 3 * 2 ** 20 + 7
+        torch.set_rng_state(_RNGState)
+        res1 = torch.randperm(n)
+        torch.set_rng_state(_RNGState)
+        torch.randperm(n, out=res2)
+        self.assertEqual(res1, res2, 0)
+        self.assertEqual(res1.sort()[0], torch.arange(n), 0)
+        self.assertNotEqual(res1[:100], torch.arange(100))
+
     def test_random(self):
         # This test is flaky with p<=(2/(ub-lb))^200=6e-36
         t = torch.FloatTensor(200)
@@ -3588,6 +3779,40 @@ class _TestTorchMixin(object):
         self.assertEqual(top1, top2)
         self.assertEqual(idx1, idx2)
 
+    def test_topk_sort_kthvalue_nan(self):
+        # k much smaller than the slice selects with a heap, which skips
+        # vectors of rejected values for contiguous float and double slices
+        for dtype in (torch.float, torch.double, torch.long):
+            t = (torch.randn(7, 3000) * 100).to(dtype)
+            for dim, x in ((1, t), (0, t.t())):
+                for largest in (True, False):
+                    for k in (1, 10, 100, 2000):
+                        sortVal, sortInd = x.sort(dim, largest)
+                        topVal, topInd = x.topk(k, dim, largest, True)
+                        self.assertEqual(topVal, sortVal.narrow(dim, 0, k), 0)
+                        self.assertEqual(topVal, x.gather(dim, topInd), 0)
+                        topVal, topInd = x.topk(k, dim, largest, False)
+                        self.assertEqual(topVal.sort(dim, largest)[0], sortVal.narrow(dim, 0, k), 0)
+                        self.assertEqual(topVal, x.gather(dim, topInd), 0)
+
+        # NaN orders after every other value
+        nan = float('nan')
+        x = torch.randn(4, 1000)
+        x[:, 10] = nan
+        x[1, 500] = nan
+        values, indices = x.sort(1)
+        self.assertTrue(torch.isnan(values[:, -1]).all())
+        self.assertTrue(torch.isnan(values[1, -2]))
+        self.assertFalse(torch.isnan(values[:, :-2]).any())
+        values, indices = x.topk(2)
+        self.assertTrue(torch.isnan(values[:, 0]).all())
+        self.assertTrue(torch.isnan(values[1, 1]))
+        self.assertTrue(sorted(indices[1].tolist()) == [10, 500])
+        values, indices = x.topk(2, largest=False)
+        self.assertFalse(torch.isnan(values).any())
+        self.assertEqual(x.kthvalue(1000, 1)[1][0], 10)
+        self.assertFalse(torch.isnan(x.kthvalue(998, 1)[0]).any())
+
     def test_kthvalue(self):
         SIZE = 50
         x = torch.rand(SIZE, SIZE, SIZE)
@@ -3748,6 +3973,35 @@ class _TestTorchMixin(object):
         z = torch.randn(2, 2, 1)
         self.assertRaises(RuntimeError, lambda: torch.cat([x, y, z], dim=1))
 
+    def test_cat_out(self):
+        x = torch.randn(3, 4, 5)
+        y = torch.randn(3, 2, 5)
+        out = torch.empty(3, 6, 5)
+        data_ptr = out.data_ptr()
+        torch.cat([x, y], 1, out=out)
+        self.assertEqual(out.data_ptr(), data_ptr)
+        self.assertEqual(out, torch.cat([x, y], 1), 0)
+
+        # non-contiguous inputs and outputs
+        xt = x.transpose(0, 2)
+        yt = y.transpose(0, 2)
+        res = torch.cat([xt, yt], 1)
+        self.assertEqual(res, torch.cat([x, y], 1).transpose(0, 2), 0)
+        out = torch.empty(3, 6, 5).transpose(0, 2)
+        torch.cat([xt, yt], 1, out=out)
+        self.assertEqual(out, res, 0)
+
+        # many small inputs
+        inputs = [torch.randn(2, i % 3, 4) for i in range(300)]
+        res = torch.cat(inputs, 1)
+        offset = 0
+        for t in inputs:
+            self.assertEqual(res.narrow(1, offset, t.size(1)), t, 0)
+            offset += t.size(1)
+
+        with self.assertRaisesRegex(RuntimeError, 'Expected object of type'):
+            torch.cat([x, y.double()], 1)
+
     def test_cat_scalars(self):
         x = torch.tensor(0)
         y = torch.tensor(1)
@@ -3887,6 +4141,65 @@ class _TestTorchMixin(object):
                 self.assertEqual(x.select(dim, i), res[i])
                 self.assertEqual(x.select(dim, i), res2[i])
 
+    def test_quantize_linear(self):
+        x = torch.tensor([-1.0, 0.0, 0.5, 1.0, 200.0])
+        q = torch.quantize_linear(x, 0.5, 10)
+        self.assertEqual(q.dtype, torch.uint8)
+        self.assertEqual(q, torch.tensor([8, 10, 11, 12, 255], dtype=torch.uint8), 0)
+        self.assertEqual(torch.dequantize_linear(q, 0.5, 10),
+                         torch.tensor([-1.0, 0.0, 0.5, 1.0, 122.5]), 0)
+        self.assertRaises(RuntimeError, lambda: torch.quantize_linear(x, 0.5, 256))
+        self.assertRaises(RuntimeError, lambda: torch.dequantize_linear(x, 0.5, 10))
+
+        # Per channel, along the last dimension
+        x = torch.randn(3, 4)
+        scales = torch.tensor([0.1, 0.2, 0.3, 0.4])
+        zero_points = torch.tensor([0, 64, 128, 255])
+        q = torch.quantize_linear_per_channel(x, scales, zero_points, -1)
+        for j in range(4):
+            self.assertEqual(
+                q[:, j], torch.quantize_linear(x[:, j], scales[j].item(), zero_points[j].item()), 0)
+        self.assertEqual(
+            torch.dequantize_linear_per_channel(q, scales, zero_points, 1),
+            (q.float() - zero_points.float()) * scales, 0)
+
+    @unittest.skipIf(not torch.fbgemm_is_cpu_supported(),
+                     "PyTorch is built without FBGEMM, or the CPU does not support it")
+    def test_fbgemm_linear_int8_weight(self):
+        input = torch.randn(5, 3, 16)
+        weight = torch.randn(8, 16)
+        bias = torch.randn(8)
+        packed = torch.fbgemm_linear_pack_weight(weight)
+        expected = torch.nn.functional.linear(input, weight, bias)
+        output = torch.fbgemm_linear_int8_weight(input, packed, bias)
+        self.assertEqual(output.size(), expected.size())
+        self.assertEqual(output, expected, 0.2)
+        output = torch.fbgemm_linear_int8_weight(input, packed, bias, relu=True)
+        self.assertEqual(output, expected.clamp(min=0), 0.2)
+        self.assertRaises(RuntimeError,
+                          lambda: torch.fbgemm_linear_int8_weight(input, torch.zeros(100, dtype=torch.uint8), bias))
+
+    def test_linear_prepacked(self):
+        weight = torch.randn(8, 16)
+        bias = torch.randn(8)
+        for fp16 in [False, True]:
+            packed = torch.linear_prepack(weight, fp16)
+            # fp16 rounds the weight to 11 bits of mantissa
+            prec = 1e-2 if fp16 else 1e-4
+            for input in [torch.randn(1, 16), torch.randn(5, 3, 16), torch.randn(16)]:
+                expected = torch.nn.functional.linear(input, weight, bias)
+                output = torch.linear_prepacked(input, packed, bias)
+                self.assertEqual(output.size(), expected.size())
+                self.assertEqual(output, expected, prec)
+                self.assertEqual(torch.linear_prepacked(input, packed),
+                                 torch.nn.functional.linear(input, weight), prec)
+            self.assertEqual(torch.linear_prepacked(torch.randn(0, 16), packed, bias).size(),
+                             torch.Size([0, 8]))
+        self.assertRaises(RuntimeError, lambda: torch.linear_prepacked(
+            torch.randn(2, 15), torch.linear_prepack(weight), bias))
+        self.assertRaises(RuntimeError, lambda: torch.linear_prepacked(
+            torch.randn(2, 16), torch.zeros(100, dtype=torch.uint8), bias))
+
     def test_linspace(self):
         _from = random.random()
         to = _from + random.random()
@@ -5029,6 +5342,23 @@ class _TestTorchMixin(object):
     def test_fft_ifft_rfft_irfft(self):
         self._test_fft_ifft_rfft_irfft(self)
 
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    def test_fft_batched_small_signals(self):
+        # many small signals are split across threads, with cached plans for
+        # the full chunks and the shorter last one
+        for batch in (1, 2, 7, 1001):
+            x = torch.randn(batch, 64, dtype=torch.double)
+            for _ in range(2):
+                res = x.rfft(1, onesided=False)
+                for i in (0, batch // 2, batch - 1):
+                    self.assertEqual(res[i], x[i].rfft(1, onesided=False), 1e-10)
+                self.assertEqual(res.irfft(1, onesided=False, signal_sizes=(64,)), x, 1e-10)
+            # strided batches and signals
+            y = x.t().contiguous().t()
+            self.assertEqual(y.rfft(1), x.rfft(1), 1e-10)
+            z = torch.randn(batch, 8, 8, 2)
+            self.assertEqual(z.fft(2).ifft(2), z, 1e-4)
+
     @staticmethod
     def _test_stft(self, device='cpu'):
         if not TEST_LIBROSA:
@@ -5355,6 +5685,38 @@ class _TestTorchMixin(object):
     def test_cholesky_batched(self):
         self._test_cholesky_batched(self, lambda t: t)
 
+    @skipIfNoLapack
+    def test_batched_linalg_matrix_sizes(self):
+        from common_utils import random_fullrank_matrix_distinct_singular_value, random_symmetric_pd_matrix
+
+        # the matrices of up to 16 rows are factorized without LAPACK, and
+        # the batch in parallel: compare to the single matrix functions on
+        # both sides of the threshold
+        batch = 40
+        for n in [1, 2, 7, 16, 17]:
+            A = random_fullrank_matrix_distinct_singular_value(n, batch).double()
+            b = torch.randn(batch, n, 3).double()
+            x, LU = torch.gesv(b, A)
+            self.assertEqual(x, torch.stack([torch.gesv(b[i], A[i])[0] for i in range(batch)]))
+            self.assertEqual(LU, torch.stack([torch.gesv(b[i], A[i])[1] for i in range(batch)]))
+            self.assertEqual(torch.inverse(A), torch.stack([A[i].inverse() for i in range(batch)]))
+
+            S = random_symmetric_pd_matrix(n, batch).double()
+            for upper in [True, False]:
+                U = torch.cholesky(S, upper)
+                self.assertEqual(U, torch.stack([S[i].cholesky(upper) for i in range(batch)]))
+                self.assertEqual(torch.potrs(b, U, upper),
+                                 torch.stack([torch.potrs(b[i], U[i], upper) for i in range(batch)]))
+
+        # the first singular matrix of the batch is reported
+        A = random_fullrank_matrix_distinct_singular_value(4, batch)
+        A[25].zero_()
+        A[30].zero_()
+        with self.assertRaisesRegex(RuntimeError, 'For batch 25'):
+            torch.inverse(A)
+        with self.assertRaisesRegex(RuntimeError, 'For batch 25'):
+            torch.gesv(torch.randn(batch, 4, 1), A)
+
     @staticmethod
     def _test_potrs(self, cast):
         a = torch.Tensor(((6.80, -2.11, 5.66, 5.97, 8.23),
@@ -6606,6 +6968,21 @@ class _TestTorchMixin(object):
         self.assertEqual(tensor.std(), tensor.std(unbiased=True))
         self.assertEqual(tensor.std(unbiased=False), tensor.std(0, unbiased=False))
 
+    def test_std_var_vectorized(self):
+        # contiguous inputs take the vectorized kernel, transposed ones don't
+        for dtype in [torch.float, torch.double]:
+            for size in [(1, 7), (5, 1024), (3, 37, 9), (70000,)]:
+                x = torch.randn(*size, dtype=dtype) * 3 + 10
+                for dim in range(x.dim()):
+                    non_contig = x.transpose(0, -1).contiguous().transpose(0, -1)
+                    for unbiased in [True, False]:
+                        self.assertEqual(x.var(dim, unbiased), non_contig.var(dim, unbiased), 1e-3)
+                        self.assertEqual(x.std(dim, unbiased), non_contig.std(dim, unbiased), 1e-3)
+                self.assertEqual(x.var(), x.double().var(), 1e-3)
+                self.assertEqual(x.std(unbiased=False), x.double().std(unbiased=False), 1e-3)
+        self.assertTrue(math.isnan(torch.ones(3, 1).var(1).sum().item()))
+        self.assertEqual(torch.ones(3, 1).var(1, unbiased=False), torch.zeros(3))
+
     def test_var_stability(self):
         tensor = torch.FloatTensor([2281.5, 2281.25])
         self.assertEqual(tensor.var(dim=0), 0.03125)
@@ -7702,6 +8079,34 @@ class _TestTorchMixin(object):
         # test that it works with integral tensors
         self._test_bernoulli(self, torch.uint8, torch.float64, 'cpu')
 
+    def test_bernoulli_p_out_of_range(self):
+        for p in [1.5, -0.2, float('nan')]:
+            self.assertRaises(RuntimeError, lambda: torch.bernoulli(torch.tensor([0.5, p])))
+            self.assertRaises(RuntimeError, lambda: torch.empty(2).bernoulli_(torch.tensor([p, 0.5])))
+            self.assertRaises(RuntimeError, lambda: torch.empty(2).bernoulli_(p))
+        # the bounds themselves are valid
+        self.assertEqual(torch.bernoulli(torch.tensor([0., 1.])), torch.tensor([0., 1.]))
+
+    def test_bernoulli_independent_of_num_threads(self):
+        num_threads = torch.get_num_threads()
+        p = torch.rand(1000, 30)
+
+        def sample():
+            torch.manual_seed(123)
+            return torch.bernoulli(p.t()), torch.empty(30, 1000).bernoulli_(0.3)
+
+        try:
+            torch.set_num_threads(1)
+            expected = sample()
+            torch.set_num_threads(4)
+            actual = sample()
+        finally:
+            torch.set_num_threads(num_threads)
+        self.assertEqual(expected, actual)
+        # elements are sampled from the same distribution
+        self.assertEqual(expected[0].mean(), p.mean(), 0.02)
+        self.assertEqual(expected[1].mean(), 0.3, 0.02)
+
     def test_normal(self):
         q = torch.Tensor(100, 100)
         q.normal_()
@@ -7800,6 +8205,22 @@ class _TestTorchMixin(object):
                                "missing 1 required positional arguments",
                                lambda: torch.tensor().new_zeros((5, 5), 0))
 
+    def test_parsing_repeated_calls(self):
+        # the parser remembers which overload calls with the same argument
+        # types resolved to; properties of tensor arguments must still count
+        x = torch.randn(3)
+        for _ in range(3):
+            self.assertEqual(x.add(1), x + 1)
+            self.assertEqual(x.add(torch.tensor(1.)), x + 1)
+            self.assertEqual(x.add(torch.ones(3)), x + 1)
+            self.assertFalse(x.add(2, torch.tensor(3.)).requires_grad)
+            y = torch.tensor(3., requires_grad=True)
+            r = x.add(2, y)
+            self.assertTrue(r.requires_grad)
+            self.assertEqual(r, x + 6)
+            self.assertRaises(TypeError, lambda: torch.cumsum(torch.ones(5, 5), torch.tensor(0.)))
+            self.assertEqual(torch.cumsum(torch.ones(5, 5), torch.tensor(0)), torch.cumsum(torch.ones(5, 5), 0))
+
     def _test_serialization_data(self):
         a = [torch.randn(5, 5).float() for i in range(2)]
         b = [a[i % 2] for i in range(4)]  # 0-3
@@ -7939,6 +8360,92 @@ class _TestTorchMixin(object):
             xh2 = torch.load(f)
             self.assertEqual(xh.float(), xh2.float())
 
+    def test_half_tensor_ops(self):
+        # CPU Half is only stored as Half: the ops compute in float
+        for size in [(5, 5), (37, 19), (3, 1000)]:
+            x = torch.randn(*size).half()
+            y = torch.randn(*size).half()
+            xf, yf = x.float(), y.float()
+            self.assertEqual(torch.Tensor(*size).copy_(x), xf, 0)
+            self.assertEqual(xf.half().float(), xf, 0)
+
+            self.assertEqual((x + y).float(), (xf + yf).half().float(), 0)
+            self.assertEqual(x.add(y, alpha=2).float(), xf + 2 * yf, 1e-2)
+            self.assertEqual((x * y).float(), (xf * yf).half().float(), 0)
+            # transposed and broadcast operands
+            self.assertEqual((x.t() + y.t()).float(), (xf.t() + yf.t()).half().float(), 0)
+            self.assertEqual((x * y[0]).float(), (xf * yf[0]).half().float(), 0)
+
+            self.assertEqual(x.sum().float(), xf.sum(), 1e-1)
+            self.assertEqual(x.sum(dtype=torch.float), xf.sum(), 1e-3)
+            for dim in [0, 1]:
+                self.assertEqual(x.sum(dim).float(), xf.sum(dim), 1e-1)
+                self.assertEqual(x.t().sum(dim).float(), xf.t().sum(dim), 1e-1)
+                self.assertEqual(x.mean(dim).float(), xf.mean(dim), 1e-2)
+            self.assertEqual(x.mean().float(), xf.mean(), 1e-2)
+
+        # a full reduction split across threads
+        x = torch.randn(100000).half()
+        self.assertEqual(x.sum(dtype=torch.float), x.float().sum(), 1e-1)
+
+        weight = torch.randn(10, 7).half()
+        indices = torch.tensor([1, 2, 4, 5, 4, 3, 2, 9])
+        offsets = torch.tensor([0, 4])
+        for mode in ['sum', 'mean', 'max']:
+            out = torch.nn.functional.embedding_bag(indices, weight, offsets, mode=mode)
+            expected = torch.nn.functional.embedding_bag(indices, weight.float(), offsets, mode=mode)
+            self.assertEqual(out.dtype, torch.half)
+            self.assertEqual(out.float(), expected, 1e-2)
+
+    def test_bfloat16_tensor_ops(self):
+        # bfloat16 is CPU only and computes in float; it keeps the range of
+        # float but only 8 bits of precision
+        x = torch.tensor([1.0, 1.00390625, 1.01171875])
+        self.assertEqual(x.bfloat16().float(), torch.tensor([1.0, 1.0, 1.015625]), 0)
+        x = torch.tensor([3e38, -1e-38])
+        self.assertEqual(x.bfloat16().float() / x, torch.ones(2), 1e-2)
+        self.assertTrue(math.isinf(torch.tensor([float('inf')]).bfloat16().item()))
+        self.assertEqual(torch.zeros(3, dtype=torch.bfloat16).float(), torch.zeros(3), 0)
+        self.assertEqual(torch.ones(3, dtype=torch.bfloat16).float(), torch.ones(3), 0)
+        self.assertEqual(torch.tensor([0.5, 2], dtype=torch.bfloat16).tolist(), [0.5, 2])
+
+        for size in [(5, 5), (37, 19)]:
+            # exactly representable values, so float results round the same way
+            xf = torch.randn(*size).bfloat16().float()
+            yf = torch.randn(*size).bfloat16().float()
+            x, y = xf.bfloat16(), yf.bfloat16()
+            self.assertEqual(x.dtype, torch.bfloat16)
+            self.assertEqual(x.clone().float(), xf, 0)
+
+            self.assertEqual((x + y).float(), (xf + yf).bfloat16().float(), 0)
+            self.assertEqual((x * y).float(), (xf * yf).bfloat16().float(), 0)
+            self.assertEqual((x / y).float(), (xf / yf).bfloat16().float(), 0)
+            self.assertEqual((x.t() - y.t()).float(), (xf.t() - yf.t()).bfloat16().float(), 0)
+            self.assertEqual((x * y[0]).float(), (xf * yf[0]).bfloat16().float(), 0)
+
+            self.assertEqual(x.sum(dtype=torch.float), xf.sum(), 1e-3)
+            self.assertEqual(x.sum().float(), xf.sum(), 1)
+            for dim in [0, 1]:
+                self.assertEqual(x.sum(dim).float(), xf.sum(dim), 1e-1)
+                self.assertEqual(x.mean(dim).float(), xf.mean(dim), 1e-2)
+
+            self.assertEqual(torch.mm(x, y.t()).float(), torch.mm(xf, yf.t()), 1e-1)
+            self.assertEqual(torch.matmul(x.unsqueeze(0), y.t()).float(), torch.matmul(xf.unsqueeze(0), yf.t()), 1e-1)
+
+        x = torch.randn(2, 3, 8, 8).bfloat16()
+        weight = torch.randn(4, 3, 3, 3).bfloat16()
+        out = torch.nn.functional.conv2d(x, weight, padding=1)
+        self.assertEqual(out.dtype, torch.bfloat16)
+        self.assertEqual(out.float(), torch.nn.functional.conv2d(x.float(), weight.float(), padding=1), 1e-1)
+
+        linear = torch.nn.Linear(10, 5).to(torch.bfloat16)
+        self.assertEqual(linear.weight.dtype, torch.bfloat16)
+        x = torch.randn(3, 10).bfloat16()
+        linear(x).sum().backward()
+        self.assertEqual(linear.weight.grad.dtype, torch.bfloat16)
+        self.assertEqual(linear.bias.grad.float(), torch.full((5,), 3), 0)
+        self.assertEqual(linear.weight.grad.float(), x.float().sum(0).expand(5, 10), 1e-1)
+
     def test_serialize_device(self):
         device_str = ['cpu', 'cpu:0', 'cuda', 'cuda:0']
         device_obj = [torch.device(d) for d in device_str]
@@ -8646,6 +9153,78 @@ tensor([[[1., 1., 1.,  ..., 1., 1., 1.],
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "No CUDA")
+    def test_dlpack_cuda_stream(self):
+        producer = torch.cuda.Stream()
+        consumer = torch.cuda.Stream()
+        with torch.cuda.stream(producer):
+            torch.cuda._sleep(50000000)
+            x = torch.ones(1000, device='cuda')
+            x.mul_(2)
+            capsule = to_dlpack(x, consumer)
+        with torch.cuda.stream(consumer):
+            z = from_dlpack(capsule)
+            self.assertEqual(z.sum().item(), 2000)
+        # Importing waits for the stream of the producer too
+        with torch.cuda.stream(producer):
+            torch.cuda._sleep(50000000)
+            x.mul_(2)
+        with torch.cuda.stream(consumer):
+            z = from_dlpack(to_dlpack(x), producer)
+            self.assertEqual(z.sum().item(), 4000)
+        # CPU tensors ignore the stream
+        y = torch.randn(2, 3)
+        self.assertEqual(from_dlpack(to_dlpack(y, consumer), consumer), y)
+
+    def test_frombuffer(self):
+        import array
+        import gc
+        import weakref
+
+        # shares memory with the buffer
+        a = bytearray([1, 2, 3, 4])
+        t = torch.frombuffer(a, dtype=torch.uint8)
+        self.assertEqual(t, torch.tensor([1, 2, 3, 4], dtype=torch.uint8))
+        t[0] = 255
+        self.assertEqual(a[0], 255)
+        self.assertEqual(torch.frombuffer(a, dtype=torch.uint8, count=2, offset=1).tolist(), [2, 3])
+
+        # dtype
+        floats = array.array('f', [1.5, -2.0, 3.25])
+        t = torch.frombuffer(floats, dtype=torch.float32)
+        self.assertEqual(t, torch.tensor([1.5, -2.0, 3.25]))
+        t = torch.frombuffer(array.array('d', [1.0, 2.0]), dtype=torch.float64, requires_grad=True)
+        self.assertTrue(t.requires_grad)
+        self.assertEqual(torch.frombuffer(memoryview(floats), dtype=torch.float32, offset=4).tolist(), [-2.0, 3.25])
+
+        # keeps the exporter alive
+        class Buffer(bytearray):
+            pass
+        buf = Buffer(8)
+        ref = weakref.ref(buf)
+        t = torch.frombuffer(buf, dtype=torch.int64)
+        del buf
+        gc.collect()
+        self.assertIsNotNone(ref())
+        self.assertEqual(t.tolist(), [0])
+        del t
+        gc.collect()
+        self.assertIsNone(ref())
+
+        # read-only buffers
+        with warnings.catch_warnings(record=True) as w:
+            warnings.simplefilter("always")
+            t = torch.frombuffer(b'\x01\x00\x00\x00', dtype=torch.int32)
+            self.assertEqual(len(w), 1)
+        self.assertEqual(t.tolist(), [1])
+
+        # invalid arguments
+        self.assertRaises(TypeError, lambda: torch.frombuffer([1, 2], dtype=torch.uint8))
+        self.assertRaises(ValueError, lambda: torch.frombuffer(bytearray(), dtype=torch.uint8))
+        self.assertRaises(ValueError, lambda: torch.frombuffer(bytearray(6), dtype=torch.int32))
+        self.assertRaises(ValueError, lambda: torch.frombuffer(bytearray(4), dtype=torch.uint8, offset=4))
+        self.assertRaises(ValueError, lambda: torch.frombuffer(bytearray(4), dtype=torch.int32, count=2))
+
     @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
     def test_from_numpy(self):
         dtypes = [
@@ -9131,6 +9710,59 @@ tensor([[[1., 1., 1.,  ..., 1., 1., 1.],
         self.assertEqual(torch.ByteTensor([7, 42, 128, 133]), byte_unique)
         self.assertEqual(torch.LongTensor([3, 0, 0, 0, 1, 2]), byte_inverse)
 
+    def test_unique_counts_consecutive(self):
+        devices = ['cpu'] if not torch.cuda.is_available() else ['cpu', 'cuda']
+        for device in devices:
+            for dtype in [torch.uint8, torch.int, torch.long, torch.float, torch.double]:
+                x = torch.tensor([1, 2, 3, 2, 8, 5, 2, 3], dtype=dtype, device=device)
+                expected_unique = torch.tensor([1, 2, 3, 5, 8], dtype=dtype, device=device)
+                expected_inverse = torch.tensor([0, 1, 2, 1, 4, 3, 1, 2], device=device)
+                expected_counts = torch.tensor([1, 3, 2, 1, 1], device=device)
+
+                for sort in [True, False]:
+                    x_unique, x_inverse, x_counts = torch.unique(
+                        x, sorted=sort, return_inverse=True, return_counts=True)
+                    if sort:
+                        self.assertEqual(expected_unique, x_unique)
+                        self.assertEqual(expected_inverse, x_inverse)
+                        self.assertEqual(expected_counts, x_counts)
+                    else:
+                        # any order, consistent between the outputs
+                        self.assertEqual(expected_unique.tolist(), sorted(x_unique.tolist()))
+                        self.assertEqual(x, x_unique[x_inverse])
+                        self.assertEqual(x_counts, (x.unsqueeze(1) == x_unique).long().sum(0))
+
+                    x_unique, x_counts = x.unique(sorted=sort, return_counts=True)
+                    self.assertEqual(expected_counts.sum(), x_counts.sum())
+
+                y = torch.tensor([1, 1, 2, 2, 3, 1, 1, 2], dtype=dtype, device=device)
+                y_unique, y_inverse, y_counts = torch.unique_consecutive(
+                    y, return_inverse=True, return_counts=True)
+                self.assertEqual(torch.tensor([1, 2, 3, 1, 2], dtype=dtype, device=device), y_unique)
+                self.assertEqual(torch.tensor([0, 0, 1, 1, 2, 3, 3, 4], device=device), y_inverse)
+                self.assertEqual(torch.tensor([2, 2, 1, 2, 1], device=device), y_counts)
+                self.assertEqual(y_unique, y.view(2, 4).unique_consecutive())
+                self.assertEqual(torch.unique_consecutive(torch.tensor([], dtype=dtype, device=device)).numel(), 0)
+
+                z = torch.tensor([[1, 1, 2, 2], [1, 1, 2, 2], [3, 3, 1, 1]], dtype=dtype, device=device)
+                z_unique, z_inverse, z_counts = torch.unique_consecutive(
+                    z, return_inverse=True, return_counts=True, dim=1)
+                self.assertEqual(torch.tensor([[1, 2], [1, 2], [3, 1]], dtype=dtype, device=device), z_unique)
+                self.assertEqual(torch.tensor([0, 0, 1, 1], device=device), z_inverse)
+                self.assertEqual(torch.tensor([2, 2], device=device), z_counts)
+                z_unique, z_counts = z.unique(return_counts=True, dim=0)
+                self.assertEqual(torch.tensor([2, 1], device=device), z_counts)
+
+            # many values, with collisions in the hash table
+            x = torch.randint(0, 1000, (100000,), dtype=torch.long, device=device)
+            x_unique, x_inverse, x_counts = torch.unique(x, return_inverse=True, return_counts=True)
+            self.assertEqual(x, x_unique[x_inverse])
+            self.assertEqual(x_counts.sum(), x.numel())
+            sorted_unique, sorted_counts = torch.unique(x, sorted=True, return_counts=True)
+            order = x_unique.sort()[1]
+            self.assertEqual(sorted_unique, x_unique[order])
+            self.assertEqual(sorted_counts, x_counts[order])
+
     def test_unique_dim(self):
         def run_test(dtype=torch.float):
             x = torch.tensor([[[1., 1.],
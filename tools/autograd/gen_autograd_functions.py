@@ -17,6 +17,9 @@ struct ${op} : public ${superclass} {
   void release_variables() override {
     ${release_variables}
   }
+  void prefetch_saved_variables() override {
+    ${prefetch_saved_variables}
+  }
   ${will_release_variables}
   ${saved_variables}
   ${saved_list_sizes}
@@ -120,6 +123,7 @@ def process_function(func):
     env = {}
     saved_variables = []
     release_variables = []
+    prefetch_saved_variables = []
     saved_list_sizes = []
     unpack = []
 
@@ -138,11 +142,13 @@ def process_function(func):
             saved_variables.append('SavedVariable {}_;'.format(name))
             release_variables.append('{}_.reset_data();'.format(name))
             release_variables.append('{}_.reset_grad_function();'.format(name))
+            prefetch_saved_variables.append('{}_.prefetch();'.format(name))
             ptr = 'shared_from_this()' if is_output else ''
             unpack.append('auto {} = {}_.unpack({});'.format(name, name, ptr))
         elif arg['type'] == 'TensorList':
             saved_variables.append('std::vector<SavedVariable> {}_;'.format(name))
             release_variables.append('{}_.clear();'.format(name))
+            prefetch_saved_variables.append('for (auto& v : {}_) v.prefetch();'.format(name))
             unpack.append('auto {} = unpack_list({}_);'.format(name, name))
         elif arg['type'] == 'IntList':
             saved_variables.append('std::vector<int64_t> {};'.format(name))
@@ -157,6 +163,7 @@ def process_function(func):
         save_arg(arg, is_output=True)
     env['saved_variables'] = saved_variables
     env['release_variables'] = release_variables
+    env['prefetch_saved_variables'] = prefetch_saved_variables
     env['saved_list_sizes'] = saved_list_sizes
 
     if uses_retain_variables(func):
@@ -12,7 +12,7 @@ FUNCTION_TEMPLATE = CodeTemplate("""\
 inline at::Tensor ${name}(${formals}) {
   ${pre_record_trace}
   at::Tensor tensor = at::${name}(${actuals});
-  auto result = autograd::make_variable(tensor, /*requires_grad=*/${requires_grad});
+  auto result = detail::make_factory_result(tensor, /*requires_grad=*/${requires_grad});
   ${post_record_trace}
   return result;
 }
@@ -45,7 +45,7 @@ DONT_RECORD_TRACE = {
     'conv_transpose2d', 'conv_transpose3d', 'lstm_cell', 'gru_cell',
     'rnn_tanh_cell', 'rnn_relu_cell', 'linear',
     # FIXME: figure out a better way when we support sparse tensors in jit
-    '_coalesced_',
+    '_coalesced_', '_unique_indices_',
 }
 
 # These functions have their names recorded under trace renamed,
@@ -59,6 +59,12 @@ RENAME_ATTRIBUTES = {
     ('fill_', 'value'): 'fill_value'
 }
 
+# (declaration name, argument name) of the index lists of advanced indexing, in
+# which undefined tensors mark the dimensions that are not indexed
+INDEX_TENSOR_LISTS = {
+    ('index', 'indices'), ('index_put_', 'indices'),
+}
+
 # These functions are not worth profiling because they are very cheap and may
 # be called very often.
 DONT_PROFILE = {
@@ -76,8 +82,10 @@ DONT_REQUIRE_DERIVATIVE = {
     # These are only implemented on integral types
     '__and__', '__iand__', '__ilshift__', '__ior__', '__irshift__', '__ixor__',
     '__lshift__', '__or__', '__rshift__', '__xor__',
-    # This is an unsafe method that is meant to be out of reach of autograd.
-    '_coalesced_',
+    # These are unsafe methods that are meant to be out of reach of autograd.
+    '_coalesced_', '_unique_indices_',
+    # These sample categories, which have no gradient
+    '_multinomial_alias_setup', '_multinomial_alias_draw',
 }
 
 METHOD_DECLARATION = CodeTemplate("""\
@@ -128,7 +136,7 @@ if (${cond}) {
 """)
 
 RECORD_FUNCTION = CodeTemplate("""\
-profiler::RecordFunction profiler("${name}", Function::peek_at_next_sequence_nr());""")
+profiler::RecordFunction profiler("${name}", Function::peek_at_next_sequence_nr()${,profiled_args});""")
 
 PRE_RECORD_TRACE = CodeTemplate("""\
 torch::jit::Node* node = nullptr;
@@ -572,6 +580,8 @@ def emit_body(declaration):
         return ['increment_version({});'.format(arg['name']) for arg in differentiable_outputs]
 
     env = {}
+    # the profiler records the shapes of the inputs when asked to
+    env['profiled_args'] = [arg['name'] for arg in inputs]
     combined = nested_dict(env, declaration)
 
     body = []
@@ -619,6 +629,8 @@ def unpack_args(env, declaration):
             is_nullable = arg.get('is_nullable', False)
             ref = (not is_nullable) and dynamic_type not in ['TensorList', 'SparseTensorRef']
             suffix = '_opt' if is_nullable else ''
+            if (declaration['name'], arg['name']) in INDEX_TENSOR_LISTS:
+                suffix = '_idxs'
 
             body.append(UNPACK_TENSOR.substitute(
                 arg_name=arg['name'],
@@ -558,6 +558,17 @@ Tensor _fused_dropout_backward(Tensor grad, Tensor mask, double p1m) {
   }
 }
 
+std::tuple<Tensor, Tensor> fused_bias_activation_dropout_backward(
+    const Tensor& grad, const Tensor& self, const Tensor& bias, const Tensor& mask,
+    int64_t activation, double p, std::array<bool, 2> grad_input_mask) {
+  auto grad_input = at::_fused_bias_activation_dropout_backward(grad, self, bias, mask, activation, p);
+  Tensor grad_bias;
+  if (grad_input_mask[1]) {
+    grad_bias = grad_input.reshape({-1, bias.size(0)}).sum(0);
+  }
+  return std::tuple<Tensor, Tensor>{grad_input_mask[0] ? grad_input : Tensor(), grad_bias};
+}
+
 Tensor select_equals_backward(Tensor grad, const Tensor & input, const Tensor & value) {
   auto grad_input = zeros_like(input);
   grad_input.masked_fill_(input == value, grad);
@@ -805,6 +816,19 @@ Tensor softmax_double_backward(const Tensor & grad, const Tensor & grad_output,
   return gI_t0 - gI_t1 - gI_t2 + gI_t3;
 }
 
+// The mask may be undefined, so it is saved rather than its sizes
+Tensor scaled_masked_softmax_mask_backward(const Tensor & grad, const Tensor & output, const Tensor & mask) {
+  return at::sum_to(at::_scaled_masked_softmax_backward(grad, output, 1), mask.sizes());
+}
+
+// grad_input = scale * output * (grad_output - sum(grad_output * output)),
+// differentiated with respect to output
+Tensor scaled_masked_softmax_double_backward(const Tensor & grad, const Tensor & grad_output, const Tensor & output, double scale) {
+  auto gO_out_sum = (grad_output * output).sum(-1, true);
+  auto ggI_out_sum = (grad * output).sum(-1, true);
+  return (grad * (grad_output - gO_out_sum) - grad_output * ggI_out_sum).mul_(scale);
+}
+
 Tensor log_softmax_double_backward(const Tensor & grad, const Tensor & grad_output, int dim, const Tensor & output) {
   auto z = output.exp();
   return z * grad_output.sum(dim, true) * ((grad * z).sum(dim, true) - grad);
@@ -1997,6 +2021,84 @@ std::tuple<Tensor, Tensor, Tensor> batchnorm_double_backward(
 
 }
 
+std::tuple<Tensor, Tensor, Tensor> layer_norm_double_backward(
+    const Tensor & input,
+    const Tensor & gamma,
+    const Tensor & ggI,
+    const Tensor & ggG,
+    const Tensor & ggB,
+    const Tensor & gO,
+    const Tensor & save_mean,
+    const Tensor & save_rstd,
+    int64_t M,
+    int64_t N,
+    std::array<bool,3> output_mask) {
+
+  // The input is normalized by row when viewed as M x N, and the first
+  // backward is dX = rstd * P(gamma * gO), where
+  // P(v) = v - mean(v) - x_hat * mean(v * x_hat) along each row.
+  bool affine = gamma.defined();
+  auto gamma_expanded = affine ? gamma.reshape({1, N}) : at::ones({}, input.options());
+  // for half inputs, save_mean, save_rstd are float
+  auto mu = save_mean.to(input.type().scalarType()).reshape({M, 1});
+  auto rstd = save_rstd.to(input.type().scalarType()).reshape({M, 1});
+  auto x_hat = (input.reshape({M, N}) - mu) * rstd;
+  auto gO_rows = gO.reshape({M, N});
+  auto ggI_rows = ggI.defined() ? ggI.reshape({M, N}) : ggI;
+
+  auto project = [&](const Tensor& v) -> Tensor {
+    return v - v.mean(1, true) - x_hat * (v * x_hat).mean(1, true);
+  };
+
+  // calculate gI, through x_hat and rstd
+  Tensor gI;
+  if (ggI.defined()) {
+    auto a = gamma_expanded * gO_rows;
+    auto a_x_hat_sum = (a * x_hat).sum(1, true);
+    auto ggI_x_hat_sum = (ggI_rows * x_hat).sum(1, true);
+    auto a_ggI_sum = (a * ggI_rows).sum(1, true) - a.sum(1, true) * ggI_rows.sum(1, true) / N;
+    auto rstd2 = rstd * rstd;
+    gI = (rstd2 * x_hat / -N) * (a_ggI_sum - a_x_hat_sum * ggI_x_hat_sum / N) -
+        (rstd2 / N) * project(ggI_x_hat_sum * a + a_x_hat_sum * ggI_rows);
+  }
+  if (affine && ggG.defined()) {
+    auto gI_G_term = rstd * project(ggG.reshape({1, N}) * gO_rows);
+    gI = gI.defined() ? gI.add_(gI_G_term) : gI_G_term;
+  }
+
+  // calculate gG
+  Tensor gG;
+  if (affine && ggI.defined()) {
+    gG = (rstd * project(ggI_rows) * gO_rows).sum(0).view_as(gamma);
+  }
+
+  // calculate ggO
+  Tensor ggO;
+  if (ggI.defined()) {
+    ggO = gamma_expanded * rstd * project(ggI_rows);
+  }
+  if (ggG.defined()) {
+    auto ggO_G_term = ggG.reshape({1, N}) * x_hat;
+    ggO = ggO.defined() ? ggO.add_(ggO_G_term) : ggO_G_term;
+  }
+  if (ggB.defined()) {
+    auto ggO_B_term = ggB.reshape({1, N}).expand({M, N});
+    ggO = ggO.defined() ? ggO.add_(ggO_B_term) : ggO_B_term.contiguous();
+  }
+
+  if (output_mask[0] && !gI.defined()) gI = at::zeros_like(input);
+  if (output_mask[1] && !gG.defined()) {
+    AT_ASSERTM(affine, "gamma should always be defined when it requires grad");
+    gG = at::zeros_like(gamma);
+  }
+  if (output_mask[2] && !ggO.defined()) ggO = at::zeros_like(gO);
+
+  return std::tuple<Tensor, Tensor, Tensor>{
+      gI.defined() ? gI.view_as(input) : gI,
+      gG,
+      ggO.defined() ? ggO.view_as(gO) : ggO};
+}
+
 std::tuple<Tensor, Tensor, Tensor> _trilinear_backward(const Tensor& grad_out, const Tensor& i1, const Tensor& i2, const Tensor& i3,
                                                        IntList expand1, IntList expand2, IntList expand3,
                                                        IntList sumdim, int64_t unroll_dim, std::array<bool, 3> grad_mask) {
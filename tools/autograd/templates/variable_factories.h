@@ -2,6 +2,7 @@
 
 // ${generated_comment}
 
+#include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/jit/tracer.h>
 #include <ATen/ATen.h>
@@ -13,11 +14,23 @@
 
 namespace torch {
 
+namespace detail {
+// Wraps the result of a factory into a Variable, unless in inference mode,
+// where it is returned as a plain tensor.
+inline at::Tensor make_factory_result(at::Tensor tensor, bool requires_grad) {
+  if (autograd::InferenceMode::is_enabled()) {
+    AT_CHECK(!requires_grad, "tensors created in inference mode can't require grad");
+    return tensor;
+  }
+  return autograd::make_variable(std::move(tensor), requires_grad);
+}
+} // namespace detail
+
 #define TENSOR(T, S, _1)                                                    \
   inline at::Tensor tensor(                                                 \
       at::ArrayRef<T> values, const at::TensorOptions& options) {           \
     at::Tensor result = at::tensor(values, at::TensorOptions(options).is_variable(false)); \
-    return autograd::make_variable(result, options.requires_grad());        \
+    return detail::make_factory_result(result, options.requires_grad());    \
   }                                                                         \
   inline at::Tensor tensor(                                                 \
       std::initializer_list<T> values, const at::TensorOptions& options) {  \
@@ -45,7 +58,7 @@ inline at::Tensor from_blob(
     const at::TensorOptions& options = {}) {
   at::Tensor tensor =
       at::from_blob(data, sizes, deleter, at::TensorOptions(options).is_variable(false));
-  return autograd::make_variable(
+  return detail::make_factory_result(
       tensor, /*requires_grad=*/options.requires_grad());
 }
 
@@ -0,0 +1,49 @@
+"""
+Writes the ATen operators the methods of serialized TorchScript models call,
+one per line, in the format gen_jit_dispatch.py --selected-op-list reads
+(SELECTED_OP_LIST in CMake). To run this file from the root of the PyTorch
+repository, with a build of PyTorch that registers all the operators:
+
+python -m tools.jit.dump_model_ops model.pt [model2.pt ...] > ops.txt
+
+The list covers the graphs of the methods as serialized. The backward of
+differentiable graphs, and a few operators the optimization passes insert,
+are not part of them, so that lists for models run with gradients, or
+which fail to find an operator, can be extended by hand.
+"""
+
+import argparse
+
+import torch
+
+
+def block_ops(block, ops):
+    for node in block.nodes():
+        if node.kind().startswith('aten::'):
+            ops.add(node.kind())
+        for b in node.blocks():
+            block_ops(b, ops)
+
+
+def module_ops(module, ops):
+    for name in module._method_names():
+        block_ops(module._get_method(name).graph, ops)
+    for _, submodule in module._get_modules():
+        module_ops(submodule, ops)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='List the operators of TorchScript models')
+    parser.add_argument('models', metavar='MODEL', nargs='+',
+                        help='paths to models saved with torch.jit.save')
+    args = parser.parse_args()
+    ops = set()
+    for path in args.models:
+        module_ops(torch.jit.load(path), ops)
+    for op in sorted(ops):
+        print(op)
+
+
+if __name__ == '__main__':
+    main()
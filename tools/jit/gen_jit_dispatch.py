@@ -10,6 +10,10 @@ python -m tools.jit.gen_jit_dispatch \
 Where $OUTPUT_DIR is where you would like the files to be
 generated.  In the full build system, OUTPUT_DIR is
 torch/csrc/jit/generated/
+
+Pass --selected-op-list FILE to register only the operators listed in FILE,
+one name such as aten::add per line, for builds which only run some models
+(see tools/jit/dump_model_ops.py).
 """
 
 import os
@@ -209,7 +213,26 @@ def argument_order(decl):
     return decl.get('jit_argument_order') or list(range(len(decl['arguments'])))
 
 
-def gen_jit_dispatch(declarations, out, template_path):
+def load_op_list(path):
+    """Reads the operator names of a --selected-op-list file, ignoring blank
+    lines and # comments. The names are qualified (aten::add); unqualified
+    names are taken to be aten operators."""
+    ops = set()
+    with open(path) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                ops.add(line if '::' in line else 'aten::' + line)
+    return ops
+
+
+def jit_name(decl):
+    # the out variants are overloads of the functional operator
+    name = decl['name'] if not is_out_variant(decl) else decl['name'][:-4]
+    return 'aten::' + name
+
+
+def gen_jit_dispatch(declarations, out, template_path, selected_op_list=None):
     REGISTER_ATEN_OPS_CPP = CodeTemplate.from_file(template_path + '/register_aten_ops.cpp')
     ATEN_INTERNED_STRINGS_H = CodeTemplate.from_file(template_path + '/aten_interned_strings.h')
 
@@ -315,6 +338,9 @@ def gen_jit_dispatch(declarations, out, template_path):
     } for name in ['sizes', 'strides', 'dim']]
     aten_decls = load_aten_declarations(declarations) + tensor_impl_methods
     jit_decls = [d for d in aten_decls if is_jit_op(d)]
+    if selected_op_list is not None:
+        selected_ops = load_op_list(selected_op_list)
+        jit_decls = [d for d in jit_decls if jit_name(d) in selected_ops]
 
     # add arguments dtype and device for functions like zeros
     def expand_options(decl, i, arg):
@@ -456,8 +482,7 @@ def signature(decl):
         ret_list = jit_type_of(decl['returns'][0])
     else:
         ret_list = '({})'.format(', '.join(jit_type_of(r) for r in decl['returns']))
-    name = decl['name'] if not is_out_variant(decl) else decl['name'][:-4]
-    return 'aten::{}({}) -> {}'.format(name, arg_list, ret_list)
+    return '{}({}) -> {}'.format(jit_name(decl), arg_list, ret_list)
 
 
 def main():
@@ -469,8 +494,12 @@ def main():
                         help='path to output directory')
     parser.add_argument('template_path', metavar='TEMPLATE_PATH',
                         help='path to templates directory')
+    parser.add_argument('--selected-op-list', metavar='OP_LIST',
+                        help='path to a file of the operators to register, '
+                             'one per line (all of them by default)')
     args = parser.parse_args()
-    gen_jit_dispatch(args.declarations, args.out, args.template_path)
+    gen_jit_dispatch(args.declarations, args.out, args.template_path,
+                     args.selected_op_list)
 
 
 if __name__ == '__main__':
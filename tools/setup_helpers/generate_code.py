@@ -72,7 +72,8 @@ def generate_code_ninja(w):
 def generate_code(ninja_global=None,
                   declarations_path=None,
                   nn_path=None,
-                  install_dir=None):
+                  install_dir=None,
+                  selected_op_list=None):
     # if ninja is enabled, we just register this file as something
     # ninja will need to call if needed
     if ninja_global is not None:
@@ -97,7 +98,8 @@ def generate_code(ninja_global=None,
         if not os.path.exists(d):
             os.makedirs(d)
     gen_autograd(declarations_path or DECLARATIONS_PATH, autograd_gen_dir, 'tools/autograd')
-    gen_jit_dispatch(declarations_path or DECLARATIONS_PATH, jit_gen_dir, 'tools/jit/templates')
+    gen_jit_dispatch(declarations_path or DECLARATIONS_PATH, jit_gen_dir, 'tools/jit/templates',
+                     selected_op_list)
 
 
 def main():
@@ -106,11 +108,13 @@ def main():
     parser.add_argument('--nn-path')
     parser.add_argument('--ninja-global')
     parser.add_argument('--install_dir')
+    parser.add_argument('--selected-op-list')
     options = parser.parse_args()
     generate_code(options.ninja_global,
                   options.declarations_path,
                   options.nn_path,
-                  options.install_dir)
+                  options.install_dir,
+                  options.selected_op_list)
 
 
 if __name__ == "__main__":
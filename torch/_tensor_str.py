@@ -272,7 +272,12 @@ def _str(self):
         else:
             if not has_default_dtype:
                 suffixes.append('dtype=' + str(self.dtype))
-            tensor_str = _tensor_str(self, indent)
+            if self.dtype == torch.bfloat16:
+                # bfloat16 values are exact in float, which has the ops the
+                # formatter needs
+                tensor_str = _tensor_str(self.detach().float(), indent)
+            else:
+                tensor_str = _tensor_str(self, indent)
 
     if self.layout != torch.strided:
         suffixes.append('layout=' + str(self.layout))
@@ -780,6 +780,62 @@ Example::
              -0.5790,  0.1497]])
 """)
 
+add_docstr(torch.cdist,
+           r"""
+cdist(x1, x2, p=2) -> Tensor
+
+Computes the p-norm distance between each row of :attr:`x1` and each row of
+:attr:`x2`. The result is of size :math:`B \times N` for an :attr:`x1` of size
+:math:`B \times M` and an :attr:`x2` of size :math:`N \times M`.
+
+For :math:`p = 2` the distances are computed with a matrix multiplication, as
+:math:`\sqrt{\lVert x_1 \rVert^2 + \lVert x_2 \rVert^2 - 2 x_1 x_2^T}`,
+which is much faster but less accurate for rows very close to each other.
+
+Args:
+    x1 (Tensor): the first input tensor, of size :math:`B \times M`
+    x2 (Tensor): the second input tensor, of size :math:`N \times M`
+    p (float, optional): the norm of the distance, in :math:`[0, \infty]`
+
+Example::
+
+    >>> a = torch.tensor([[0., 0.], [3., 4.]])
+    >>> b = torch.tensor([[0., 0.], [0., 1.], [3., 0.]])
+    >>> torch.cdist(a, b)
+    tensor([[0.0000, 1.0000, 3.0000],
+            [5.0000, 4.2426, 4.0000]])
+    >>> torch.cdist(a, b, p=1)
+    tensor([[0., 1., 3.],
+            [7., 6., 4.]])
+""")
+
+add_docstr(torch.cdist_topk,
+           r"""
+cdist_topk(x1, x2, k, p=2, largest=False) -> (Tensor, LongTensor)
+
+Returns the :attr:`k` smallest distances, or the :attr:`k` largest if
+:attr:`largest` is ``True``, of :func:`torch.cdist(x1, x2, p) <torch.cdist>`
+along each row, sorted, and the indices into the rows of :attr:`x2` they
+are at. The distances are computed a block of rows of :attr:`x2` at a time,
+so that the whole :math:`B \times N` matrix of distances is never stored.
+
+Args:
+    x1 (Tensor): the queries, of size :math:`B \times M`
+    x2 (Tensor): the rows to search, of size :math:`N \times M`
+    k (int): the number of rows of :attr:`x2` to return for each query
+    p (float, optional): the norm of the distance, in :math:`[0, \infty]`
+    largest (bool, optional): whether to return the farthest rows instead
+
+Example::
+
+    >>> a = torch.tensor([[0., 0.], [3., 4.]])
+    >>> b = torch.tensor([[0., 0.], [0., 1.], [3., 0.]])
+    >>> torch.cdist_topk(a, b, 2)
+    (tensor([[0., 1.],
+            [4.0000, 4.2426]]), tensor([[0, 1],
+            [2, 1]]))
+""")
+
 add_docstr(torch.ceil,
            r"""
 ceil(input, out=None) -> Tensor
@@ -1732,6 +1788,45 @@ Example::
     array([-1,  2,  3])
 """)
 
+add_docstr(torch.frombuffer,
+           r"""
+frombuffer(buffer, dtype=None, count=-1, offset=0, requires_grad=False) -> Tensor
+
+Creates a 1-dimensional :class:`Tensor` from an object that implements the
+Python buffer protocol, e.g. :class:`bytes`, :class:`bytearray`,
+:class:`memoryview` or an Arrow buffer.
+
+The returned tensor and :attr:`buffer` share the same memory, without any copy.
+Modifications to the tensor will be reflected in the buffer and vice versa. The
+tensor keeps the buffer alive, and it is not resizable.
+
+If :attr:`buffer` is not writable, a warning is issued: writing to the returned
+tensor still writes to the buffer's memory.
+
+Args:
+    buffer (object): a Python object that exposes the buffer interface.
+    dtype (:class:`torch.dtype`, optional): the desired data type of returned tensor.
+        Default: if ``None``, uses a global default (see :func:`torch.set_default_tensor_type`).
+    count (int, optional): the number of elements to read. If negative, all
+        elements from :attr:`offset` to the end of the buffer are read.
+        Default: -1.
+    offset (int, optional): the number of bytes to skip at the start of the
+        buffer. Default: 0.
+    {requires_grad}
+
+Example::
+
+    >>> a = bytearray([1, 2, 3, 4])
+    >>> t = torch.frombuffer(a, dtype=torch.uint8)
+    >>> t
+    tensor([1, 2, 3, 4], dtype=torch.uint8)
+    >>> t[0] = 255
+    >>> a
+    bytearray(b'\xff\x02\x03\x04')
+    >>> torch.frombuffer(a, dtype=torch.int16, offset=2)
+    tensor([1027], dtype=torch.int16)
+""".format(**factory_common_args))
+
 add_docstr(torch.flatten,
            r"""
 flatten(input, start_dim=0, end_dim=-1) -> Tensor
@@ -5590,6 +5685,9 @@ The inverse of this function is :func:`~torch.ifft`.
     use ``torch.backends.cuda.cufft_plan_cache.size`` to query the number of
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Each device has its own cache: ``torch.backends.cuda.cufft_plan_cache[i]``
+    is the cache of CUDA device ``i``, and the attributes above apply to the
+    cache of the current device.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -5691,6 +5789,9 @@ The inverse of this function is :func:`~torch.fft`.
     use ``torch.backends.cuda.cufft_plan_cache.size`` to query the number of
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Each device has its own cache: ``torch.backends.cuda.cufft_plan_cache[i]``
+    is the cache of CUDA device ``i``, and the attributes above apply to the
+    cache of the current device.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -5781,6 +5882,9 @@ The inverse of this function is :func:`~torch.irfft`.
     use ``torch.backends.cuda.cufft_plan_cache.size`` to query the number of
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Each device has its own cache: ``torch.backends.cuda.cufft_plan_cache[i]``
+    is the cache of CUDA device ``i``, and the attributes above apply to the
+    cache of the current device.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -5863,6 +5967,9 @@ The inverse of this function is :func:`~torch.rfft`.
     use ``torch.backends.cuda.cufft_plan_cache.size`` to query the number of
     plans currently in cache, and
     ``torch.backends.cuda.cufft_plan_cache.clear()`` to clear the cache.
+    Each device has its own cache: ``torch.backends.cuda.cufft_plan_cache[i]``
+    is the cache of CUDA device ``i``, and the attributes above apply to the
+    cache of the current device.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
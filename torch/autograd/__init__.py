@@ -12,6 +12,7 @@ from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck, gradgradcheck
 from .grad_mode import no_grad, enable_grad, set_grad_enabled
 from .anomaly_mode import detect_anomaly, set_detect_anomaly
+from .saved_tensors import saved_tensors_hooks, save_on_cpu, save_as_half
 from . import profiler
 
 __all__ = ['Variable', 'Function', 'backward', 'grad_mode']
@@ -163,6 +164,29 @@ def _is_checkpoint_valid():
     return Variable._execution_engine.is_checkpoint_valid()
 
 
+def set_num_cpu_threads(num_threads):
+    r"""Sets the number of threads the autograd engine uses to execute the
+    CPU functions of the backward pass.
+
+    With more than one thread, independent branches of the backward graph are
+    evaluated in parallel. Each of these threads additionally uses the
+    intra-op thread pool, so you may want to reduce
+    :func:`torch.set_num_threads` accordingly.
+
+    This must be called before the first backward pass; the default is ``1``.
+
+    Arguments:
+        num_threads (int): number of CPU worker threads
+    """
+    Variable._execution_engine.set_num_cpu_threads(num_threads)
+
+
+def get_num_cpu_threads():
+    r"""Returns the number of threads the autograd engine uses to execute the
+    CPU functions of the backward pass. See :func:`set_num_cpu_threads`."""
+    return Variable._execution_engine.get_num_cpu_threads()
+
+
 def variable(*args, **kwargs):
     warnings.warn("torch.autograd.variable(...) is deprecated, use torch.tensor(...) instead")
     return torch.tensor(*args, **kwargs)
@@ -3,7 +3,7 @@ import re
 import os
 import sys
 import itertools
-from collections import defaultdict
+from collections import defaultdict, namedtuple
 
 import torch
 from torch._six import FileNotFoundError
@@ -56,6 +56,11 @@ class EventList(list):
             chrome_events = []
             next_id = 0
             for evt in self:
+                args = {}
+                if evt.input_shapes is not None:
+                    args = {'Input dims': evt.input_shapes, 'FLOPs': evt.flops, 'Bytes': evt.bytes}
+                if evt.request_id:
+                    args['request_id'] = evt.request_id
                 chrome_events.append(dict(
                     name=evt.name,
                     ph='X',
@@ -63,7 +68,7 @@ class EventList(list):
                     dur=evt.cpu_interval.elapsed_us(),
                     tid=evt.thread,
                     pid='CPU functions',
-                    args={},
+                    args=args,
                 ))
                 for k in evt.kernels:
                     # 's' and 'f' draw Flow arrows from
@@ -101,15 +106,24 @@ class EventList(list):
 
             json.dump(chrome_events, f)
 
-    def key_averages(self):
+    def key_averages(self, group_by_input_shape=False):
         """Averages all function events over their keys.
 
+        Arguments:
+            group_by_input_shape (bool, optional): Average the events of each
+                function separately for every combination of input shapes.
+                The shapes are only known if they were recorded with
+                ``record_shapes=True``. Default: ``False``
+
         Returns:
             An EventList containing FunctionEventAvg objects.
         """
         stats = defaultdict(FunctionEventAvg)
         for evt in self:
-            stats[evt.key] += evt
+            if group_by_input_shape:
+                stats[evt.key, str(evt.input_shapes)] += evt
+            else:
+                stats[evt.key] += evt
         return EventList(stats.values())
 
     def total_average(self):
@@ -137,6 +151,26 @@ class profile(object):
             Adds approximately 4us of overhead to each tensor operation.
             Default: ``False``
 
+        sample_period (int, optional): Only record one in every ``sample_period``
+            top-level operations of each thread, together with the operations
+            nested in them. Default: ``1``
+
+        max_events_per_thread (int, optional): Keep only the most recent events
+            of each thread, bounding the memory used by the profiler. When
+            ``trace_path`` is given, this is instead the number of events each
+            thread buffers before writing them out. Default: unbounded
+
+        trace_path (str, optional): Stream the events to this file in the Chrome
+            trace format while profiling instead of collecting them. The trace
+            only contains CPU times, and no summary is available afterwards.
+            Default: ``None``
+
+        record_shapes (bool, optional): Record the shapes and types of the inputs
+            of every operation, and estimate the number of floating point
+            operations and bytes moved by matrix products, convolutions and
+            element-wise operations. Use ``key_averages(group_by_input_shape=True)``
+            to find the shapes an operation is slow for. Default: ``False``
+
     .. warning:
         This context managers should not be called recursively, i.e. at most one
         instance should be enabled at any given time.
@@ -161,9 +195,14 @@ class profile(object):
         N5torch8autograd5CloneE                        4.088us          0.000us
     """
 
-    def __init__(self, enabled=True, use_cuda=False):
+    def __init__(self, enabled=True, use_cuda=False, sample_period=1,
+                 max_events_per_thread=None, trace_path=None, record_shapes=False):
         self.enabled = enabled
         self.use_cuda = use_cuda
+        self.sample_period = sample_period
+        self.max_events_per_thread = max_events_per_thread
+        self.trace_path = trace_path
+        self.record_shapes = record_shapes
         self.function_events = None
         if not self.enabled:
             return
@@ -177,14 +216,21 @@ class profile(object):
         self.entered = True
         profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
             else torch.autograd.ProfilerState.CPU
-        torch.autograd._enable_profiler(profiler_kind)
+        config = torch.autograd.ProfilerConfig(profiler_kind, self.sample_period,
+                                               self.max_events_per_thread or 0,
+                                               self.trace_path or "",
+                                               self.record_shapes)
+        torch.autograd._enable_profiler(config)
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
         if not self.enabled:
             return
         records = torch.autograd._disable_profiler()
-        self.function_events = EventList(parse_cpu_trace(records))
+        if self.trace_path is not None:
+            self.function_events = EventList()
+        else:
+            self.function_events = EventList(parse_cpu_trace(records))
         return False
 
     def __repr__(self):
@@ -211,9 +257,9 @@ class profile(object):
         return self.function_events.export_chrome_trace(path)
     export_chrome_trace.__doc__ = EventList.export_chrome_trace.__doc__
 
-    def key_averages(self):
+    def key_averages(self, group_by_input_shape=False):
         self._check_finish()
-        return self.function_events.key_averages()
+        return self.function_events.key_averages(group_by_input_shape)
     key_averages.__doc__ = EventList.key_averages.__doc__
 
     def total_average(self):
@@ -317,6 +363,87 @@ class emit_nvtx(object):
         return False
 
 
+BackwardMemoryRecord = namedtuple('BackwardMemoryRecord', [
+    'name', 'device', 'input_bytes', 'output_bytes', 'allocated_bytes',
+    'released_allocated_bytes'])
+
+
+class profile_backward_memory(object):
+    """Context manager that records the memory of every function the backward
+    passes run inside it, to find the functions at which the memory of a
+    backward pass peaks.
+
+    Each record is a :class:`BackwardMemoryRecord` of the name of a function,
+    its device (``-1`` for the CPU), the bytes of the gradients it consumed
+    and produced, and, for CUDA functions, the bytes allocated on its device
+    once it ran and how many of them releasing its saved tensors freed
+    (``-1`` and ``0`` for CPU functions). Saved tensors are only released when
+    the graph is not retained. Records are in the order the functions
+    finished.
+
+    .. warning:
+        This context manager should not be called recursively, and slows the
+        backward pass down.
+
+    Example:
+        >>> with torch.autograd.profiler.profile_backward_memory() as prof:
+        ...     loss.backward()
+        >>> print(prof.peak())
+    """
+
+    def __init__(self):
+        self.records = None
+
+    def __enter__(self):
+        engine = torch.autograd.Variable._execution_engine
+        # Drops the records of a previous use that raised
+        engine.take_memory_records()
+        engine.set_memory_debug(True)
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        engine = torch.autograd.Variable._execution_engine
+        engine.set_memory_debug(False)
+        self.records = [BackwardMemoryRecord(*r) for r in engine.take_memory_records()]
+        return False
+
+    def _check_finish(self):
+        if self.records is None:
+            raise RuntimeError("can't access the records before the context manager exits")
+
+    def peak(self):
+        """Returns the record of the function after which the most memory was
+        allocated on a GPU, or, when only CPU functions ran, at which the most
+        gradient bytes were in flight, counting the gradients produced by the
+        functions that finished before it and not yet consumed."""
+        self._check_finish()
+        if not self.records:
+            return None
+        if any(r.allocated_bytes >= 0 for r in self.records):
+            return max(self.records, key=lambda r: r.allocated_bytes)
+        in_flight = 0
+        peak, peak_bytes = None, -1
+        for r in self.records:
+            in_flight += r.output_bytes - r.input_bytes
+            if in_flight + r.input_bytes > peak_bytes:
+                peak, peak_bytes = r, in_flight + r.input_bytes
+        return peak
+
+    def table(self):
+        self._check_finish()
+        header = ['Name', 'Device', 'Input bytes', 'Output bytes', 'Allocated', 'Released']
+        rows = [[str(v) for v in r] for r in self.records]
+        widths = [max(len(v) for v in column) for column in zip(header, *rows)]
+        lines = []
+        for row in [header] + rows:
+            lines.append('  '.join(v.ljust(w) if i == 0 else v.rjust(w)
+                                   for i, (v, w) in enumerate(zip(row, widths))))
+        return '\n'.join(lines)
+
+    def __str__(self):
+        return self.table()
+
+
 def load_nvprof(path):
     """Opens an nvprof trace file and parses autograd annotations.
 
@@ -348,6 +475,19 @@ class FormattedTimesMixin(object):
     cpu_time_total_str = attr_formatter('cpu_time_total')
     cuda_time_total_str = attr_formatter('cuda_time_total')
 
+    def _throughput(self, total):
+        # per second, based on the CUDA time when there is one
+        time_us = self.cuda_time_total if self.cuda_time_total > 0 else self.cpu_time_total
+        return 0.0 if time_us == 0 else total / (time_us * 1e3)
+
+    @property
+    def gflops(self):
+        return self._throughput(self.flops_total)
+
+    @property
+    def gbytes_per_s(self):
+        return self._throughput(self.bytes_total)
+
     @property
     def cpu_time(self):
         return 0.0 if self.count == 0 else 1.0 * self.cpu_time_total / self.count
@@ -376,13 +516,19 @@ class Kernel(object):
 # TODO: record TID too
 class FunctionEvent(FormattedTimesMixin):
     """Profiling information about a single function."""
-    def __init__(self, id, name, thread, cpu_start, cpu_end):
+    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None,
+                 flops=0, bytes=0, request_id=0):
         self.id = id
         self.name = name
         self.cpu_interval = Interval(cpu_start, cpu_end)
         self.thread = thread
         self.kernels = []
         self.count = 1
+        self.input_shapes = input_shapes
+        self.flops = flops
+        self.bytes = bytes
+        # the request the function ran for, 0 if none
+        self.request_id = request_id
 
     def append_kernel(self, name, device, start, end):
         self.kernels.append(Kernel(name, device, Interval(start, end)))
@@ -395,6 +541,14 @@ class FunctionEvent(FormattedTimesMixin):
     def cpu_time_total(self):
         return self.cpu_interval.elapsed_us()
 
+    @property
+    def flops_total(self):
+        return self.flops
+
+    @property
+    def bytes_total(self):
+        return self.bytes
+
     @property
     def key(self):
         return self.name
@@ -408,15 +562,22 @@ class FunctionEventAvg(FormattedTimesMixin):
     """Used to average stats over multiple FunctionEvent objects."""
     def __init__(self):
         self.key = None
+        self.input_shapes = None
         self.count = self.cpu_time_total = self.cuda_time_total = 0
+        self.flops_total = self.bytes_total = 0
 
     def __iadd__(self, other):
         if self.key is None:
             self.key = other.key
+            self.input_shapes = other.input_shapes
         assert isinstance(other, FunctionEvent)
         assert other.key == self.key
+        if other.input_shapes != self.input_shapes:
+            self.input_shapes = None
         self.cpu_time_total += other.cpu_time
         self.cuda_time_total += other.cuda_time
+        self.flops_total += other.flops_total
+        self.bytes_total += other.bytes_total
         self.count += 1
         return self
 
@@ -471,13 +632,20 @@ def parse_cpu_trace(thread_records):
             record_stack.append((next_id, record))
             next_id += 1
         elif record.kind() == 'pop':
+            # the push may have been dropped when events per thread are bounded
+            if not record_stack or record_stack[-1][1].thread_id() != record.thread_id():
+                continue
             function_id, start = record_stack.pop()
             fe = FunctionEvent(
                 id=function_id,
                 name=string_table[start.name()],
                 thread=start.thread_id(),
                 cpu_start=start_record.cpu_elapsed_us(start),
-                cpu_end=start_record.cpu_elapsed_us(record))
+                cpu_end=start_record.cpu_elapsed_us(record),
+                input_shapes=start.input_shapes() if start.has_inputs() else None,
+                flops=start.flops(),
+                bytes=start.bytes(),
+                request_id=start.request_id())
             if start.has_cuda():
                 cuda_start = adjusted_time(start)
                 cuda_end = adjusted_time(record)
@@ -582,8 +750,15 @@ def build_table(events, sort_by=None, header=None):
     max_name_length += 4  # Add some nice padding
     col_width = 15
     col_format = '  {: >' + str(col_width) + '}'
-    row_format = '{: <' + str(max_name_length) + '}' + col_format * 5
-    header_sep = '-' * max_name_length + ('  ' + '-' * col_width) * 5
+    num_columns = 5
+    has_input_shapes = any(evt.input_shapes is not None for evt in events)
+    if has_input_shapes:
+        num_columns = 7
+    row_format = '{: <' + str(max_name_length) + '}' + col_format * num_columns
+    header_sep = '-' * max_name_length + ('  ' + '-' * col_width) * num_columns
+    if has_input_shapes:
+        row_format += '  {}'
+        header_sep += '  ' + '-' * col_width
 
     # Have to use a list because nonlocal is Py3 only...
     result = []
@@ -594,14 +769,21 @@ def build_table(events, sort_by=None, header=None):
 
     # Actual printing
     if header is not None:
-        line_length = max_name_length + (col_width + 2) * 5
+        line_length = max_name_length + (col_width + 2) * num_columns
         append('=' * line_length)
         append(header)
     append(header_sep)
-    append(row_format.format('Name', 'CPU time', 'CUDA time', 'Calls', 'CPU total', 'CUDA total'))
+    headers = ['Name', 'CPU time', 'CUDA time', 'Calls', 'CPU total', 'CUDA total']
+    if has_input_shapes:
+        headers += ['GFLOP/s', 'GB/s', 'Input shapes']
+    append(row_format.format(*headers))
     append(header_sep)
     for evt in events:
-        append(row_format.format(evt.key, evt.cpu_time_str, evt.cuda_time_str,
-                                 evt.count, evt.cpu_time_total_str, evt.cuda_time_total_str))
+        row = [evt.key, evt.cpu_time_str, evt.cuda_time_str,
+               evt.count, evt.cpu_time_total_str, evt.cuda_time_total_str]
+        if has_input_shapes:
+            row += ['{:.3f}'.format(evt.gflops), '{:.3f}'.format(evt.gbytes_per_s),
+                    str(evt.input_shapes)]
+        append(row_format.format(*row))
 
     return ''.join(result)
@@ -0,0 +1,164 @@
+import threading
+
+import torch
+
+
+class saved_tensors_hooks(object):
+    r"""Context-manager that sets hooks changing how tensors saved for backward
+    are stored.
+
+    Operations record some of their inputs and outputs to compute gradients
+    in the backward pass. Within this context manager, every such tensor is
+    passed to ``pack_hook`` when it is saved, and only the value it returns is
+    kept. When the tensor is needed in the backward pass, that value is passed
+    to ``unpack_hook``, which must return a tensor with the same contents as
+    the original one. If ``pack_hook`` returns ``None``, the tensor is saved as
+    is.
+
+    If ``prefetch_hook`` is given, the autograd engine calls it with the packed
+    value shortly before the function that saved the tensor runs, so that an
+    expensive unpacking (e.g. a copy back to the GPU) can be started ahead of
+    time. It may be called more than once, and from several threads.
+
+    The hooks only apply to the current thread, and the tensors saved while
+    the context manager is active. Operations inside the hooks don't have
+    their saved tensors packed.
+
+    Arguments:
+        pack_hook (callable): called with every saved tensor
+        unpack_hook (callable): called with the value returned by
+            ``pack_hook`` to get the tensor back
+        prefetch_hook (callable, optional): called with the value returned by
+            ``pack_hook`` ahead of ``unpack_hook``
+
+    Example::
+
+        >>> def pack(x):
+        ...     return x.half() if x.dtype == torch.float else None
+        >>> def unpack(x):
+        ...     return x.float()
+        >>> with torch.autograd.saved_tensors_hooks(pack, unpack):
+        ...     y = model(x)  # activations are saved as half
+        >>> y.sum().backward()
+    """
+
+    def __init__(self, pack_hook, unpack_hook, prefetch_hook=None):
+        self.pack_hook = pack_hook
+        self.unpack_hook = unpack_hook
+        self.prefetch_hook = prefetch_hook
+
+    def __enter__(self):
+        torch._C._push_saved_tensors_hooks(self.pack_hook, self.unpack_hook,
+                                           self.prefetch_hook)
+
+    def __exit__(self, *args):
+        torch._C._pop_saved_tensors_hooks()
+        return False
+
+
+class save_as_half(saved_tensors_hooks):
+    r"""Context-manager that saves floating point tensors for backward in half
+    precision, halving the memory they use at the cost of precision in the
+    gradients.
+
+    Arguments:
+        min_numel (int, optional): tensors with fewer elements are saved as
+            they are. Default: 1024
+    """
+
+    def __init__(self, min_numel=1024):
+        def pack(tensor):
+            if tensor.dtype not in (torch.float32, torch.float64) or tensor.numel() < min_numel:
+                return None
+            return (tensor.half(), tensor.dtype)
+
+        def unpack(packed):
+            tensor, dtype = packed
+            return tensor.to(dtype)
+
+        super(save_as_half, self).__init__(pack, unpack)
+
+
+class _HostCopy(object):
+    __slots__ = ['cpu_tensor', 'device', 'copied', 'cuda_tensor', 'prefetched']
+
+    def __init__(self, cpu_tensor, device, copied):
+        self.cpu_tensor = cpu_tensor
+        self.device = device
+        # event marking completion of the copy to the host
+        self.copied = copied
+        self.cuda_tensor = None
+        # event marking completion of the copy back to the device
+        self.prefetched = None
+
+
+class save_on_cpu(saved_tensors_hooks):
+    r"""Context-manager that offloads CUDA tensors saved for backward to host
+    memory, and copies them back when they are needed.
+
+    Both copies run asynchronously on a side stream of each device. The copy
+    back to the device is started ahead of use, when the engine is about to
+    run the function that needs the tensor, so that it overlaps with the
+    computation of other functions in the backward pass.
+
+    Arguments:
+        pin_memory (bool, optional): copy into pinned host memory, which is
+            required for the copies to be asynchronous. Default: ``True``
+        min_numel (int, optional): tensors with fewer elements stay on the
+            device. Default: 1024
+    """
+
+    def __init__(self, pin_memory=True, min_numel=1024):
+        streams = {}
+        prefetch_lock = threading.Lock()
+
+        def side_stream(device):
+            if device not in streams:
+                streams[device] = torch.cuda.Stream(device)
+            return streams[device]
+
+        def pack(tensor):
+            if not tensor.is_cuda or tensor.numel() < min_numel:
+                return None
+            device = tensor.device
+            with torch.cuda.device(device):
+                stream = side_stream(device)
+                stream.wait_stream(torch.cuda.current_stream())
+                with torch.cuda.stream(stream):
+                    cpu_tensor = torch.empty(tensor.size(), dtype=tensor.dtype)
+                    if pin_memory:
+                        cpu_tensor = cpu_tensor.pin_memory()
+                    cpu_tensor.copy_(tensor, non_blocking=pin_memory)
+                    copied = stream.record_event()
+                # the caching allocator must not reuse the memory of tensor
+                # before the copy on the side stream is done
+                tensor.record_stream(stream)
+            return _HostCopy(cpu_tensor, device, copied)
+
+        def prefetch(packed):
+            with prefetch_lock:
+                if packed.prefetched is None:
+                    copy_back(packed)
+
+        def copy_back(packed):
+            with torch.cuda.device(packed.device):
+                stream = side_stream(packed.device)
+                with torch.cuda.stream(stream):
+                    stream.wait_event(packed.copied)
+                    cuda_tensor = packed.cpu_tensor.to(packed.device, non_blocking=pin_memory)
+                    packed.cuda_tensor = cuda_tensor
+                    packed.prefetched = stream.record_event()
+
+        def unpack(packed):
+            if packed.prefetched is None:
+                prefetch(packed)
+            with torch.cuda.device(packed.device):
+                current = torch.cuda.current_stream()
+                current.wait_event(packed.prefetched)
+                tensor = packed.cuda_tensor
+                # tensor was allocated on the side stream but is used on the
+                # current one
+                tensor.record_stream(current)
+            return tensor
+
+        super(save_on_cpu, self).__init__(pack, unpack, prefetch)
@@ -16,12 +16,87 @@ class ContextProp(object):
         self.setter(val)
 
 
+class cuFFTPlanCacheAttrContextProp(object):
+    # Like regular ContextProp, but uses the `.device_index` attribute from the
+    # calling object as the only argument of the getter and setter.
+    def __init__(self, getter, setter):
+        self.getter = getter
+        self.setter = setter
+
+    def __get__(self, obj, objtype):
+        return self.getter(obj.device_index)
+
+    def __set__(self, obj, val):
+        if isinstance(self.setter, str):
+            raise RuntimeError(self.setter)
+        self.setter(obj.device_index, val)
+
+
 class cuFFTPlanCache(object):
-    size = ContextProp(torch._cufft_get_plan_cache_size,
-                       'cufft_plan_cache.size is a read-only property showing the current cache. '
-                       'To set the cache capacity, use cufft_plan_cache.max_size.')
-    max_size = ContextProp(torch._cufft_get_plan_cache_max_size, torch._cufft_set_plan_cache_max_size)
-    clear = torch._cufft_clear_plan_cache
+    r"""
+    Represents the cuFFT plan cache of a specific CUDA device. Since a plan can
+    only run on the device it was created on, each device has its own cache.
+    """
+    def __init__(self, device_index):
+        self.device_index = device_index
+
+    size = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_size,
+        '.size is a read-only property showing the number of plans currently in the '
+        'cache. To change the cache capacity, set cufft_plan_cache.max_size.')
+
+    max_size = cuFFTPlanCacheAttrContextProp(torch._cufft_get_plan_cache_max_size,
+                                             torch._cufft_set_plan_cache_max_size)
+
+    hits = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_hits,
+        '.hits is a read-only property counting the FFTs that found their plan in the cache.')
+
+    misses = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_misses,
+        '.misses is a read-only property counting the FFTs that created a new plan.')
+
+    evictions = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_evictions,
+        '.evictions is a read-only property counting the plans dropped to make room for others.')
+
+    def clear(self):
+        r"""Drops the plans of this cache, and resets its statistics."""
+        return torch._cufft_clear_plan_cache(self.device_index)
+
+
+class cuFFTPlanCacheManager(object):
+    r"""
+    Represents all cuFFT plan caches. When indexed, it returns the
+    :class:`cuFFTPlanCache` of a CUDA device, e.g.,
+    ``torch.backends.cuda.cufft_plan_cache[0]``. Its attributes are forwarded
+    to the cache of the current device, e.g.,
+    ``torch.backends.cuda.cufft_plan_cache.max_size``.
+    """
+    __initialized = False
+
+    def __init__(self):
+        self.caches = []
+        self.__initialized = True
+
+    def __getitem__(self, device):
+        index = torch.cuda._utils._get_device_index(device)
+        if index < 0 or index >= torch.cuda.device_count():
+            raise RuntimeError(
+                ("cufft_plan_cache: expected 0 <= device index < {}, but got "
+                 "device with index {}").format(torch.cuda.device_count(), index))
+        if len(self.caches) == 0:
+            self.caches.extend(cuFFTPlanCache(index) for index in range(torch.cuda.device_count()))
+        return self.caches[index]
+
+    def __getattr__(self, name):
+        return getattr(self[torch.cuda.current_device()], name)
+
+    def __setattr__(self, name, value):
+        if self.__initialized:
+            return setattr(self[torch.cuda.current_device()], name, value)
+        else:
+            return super(cuFFTPlanCacheManager, self).__setattr__(name, value)
 
 
 class CUDAModule(object):
@@ -32,7 +107,7 @@ class CUDAModule(object):
         # https://stackoverflow.com/questions/47540722/how-do-i-use-the-sys-modules-replacement-trick-in-init-py-on-python-2
         self.__old_mod = m
 
-    cufft_plan_cache = cuFFTPlanCache()
+    cufft_plan_cache = cuFFTPlanCacheManager()
 
 # This is the sys.modules replacement trick, see
 # https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
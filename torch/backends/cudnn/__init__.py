@@ -139,12 +139,15 @@ CUDNN_DEFAULT_MATH = 0
 CUDNN_TENSOR_OP_MATH = 1
 
 
-def set_flags(_enabled, _benchmark, _deterministic, _verbose):
+def set_flags(_enabled, _benchmark, _deterministic, _verbose, _workspace_limit=0):
     global benchmark, deterministic, verbose
     orig_flags = (torch._C._get_cudnn_enabled(),
                   torch._C._get_cudnn_benchmark(),
                   torch._C._get_cudnn_deterministic(),
-                  verbose)
+                  verbose,
+                  torch._C._get_cudnn_workspace_limit())
+    # First, since it is the only one that can reject its value
+    torch._C._set_cudnn_workspace_limit(_workspace_limit)
     verbose = _verbose
     torch._C._set_cudnn_enabled(_enabled)
     torch._C._set_cudnn_benchmark(_benchmark)
@@ -173,15 +176,36 @@ def __allow_nonbracketed_mutation():
 
 
 @contextmanager
-def flags(enabled=False, benchmark=False, deterministic=False, verbose=False):
+def flags(enabled=False, benchmark=False, deterministic=False, verbose=False, workspace_limit=0):
     with __allow_nonbracketed_mutation():
-        orig_flags = set_flags(enabled, benchmark, deterministic, verbose)
+        orig_flags = set_flags(enabled, benchmark, deterministic, verbose, workspace_limit)
     try:
         yield
     finally:
         # recover the previous values
         with __allow_nonbracketed_mutation():
-            set_flags(orig_flags[0], orig_flags[1], orig_flags[2], orig_flags[3])
+            set_flags(*orig_flags)
+
+
+def export_benchmark_cache(path):
+    r"""Writes the convolution algorithms chosen when :attr:`benchmark` is
+    enabled to the file at :attr:`path`, for a later
+    :func:`import_benchmark_cache`.
+
+    The algorithms are recorded along with the cuDNN version and the model of
+    the current GPU. The files exported on several kinds of GPUs can be
+    concatenated together, and the matching entries are picked on import.
+    """
+    torch._C._cudnn_export_benchmark_cache(path)
+
+
+def import_benchmark_cache(path):
+    r"""Loads the convolution algorithms exported to :attr:`path` by
+    :func:`export_benchmark_cache` on the same model of GPU and cuDNN version
+    as the current ones, so that convolutions of these shapes skip
+    benchmarking. Returns the number of algorithms loaded.
+    """
+    return torch._C._cudnn_import_benchmark_cache(path)
 
 
 class CuDNNHandle:
@@ -467,6 +491,7 @@ class CudnnModule(types.ModuleType):
     enabled = ContextProp(torch._C._get_cudnn_enabled, torch._C._set_cudnn_enabled)
     deterministic = ContextProp(torch._C._get_cudnn_deterministic, torch._C._set_cudnn_deterministic)
     benchmark = ContextProp(torch._C._get_cudnn_benchmark, torch._C._set_cudnn_benchmark)
+    workspace_limit = ContextProp(torch._C._get_cudnn_workspace_limit, torch._C._set_cudnn_workspace_limit)
 
 # This is the sys.modules replacement trick, see
 # https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
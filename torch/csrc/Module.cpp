@@ -41,6 +41,7 @@
 
 #ifdef USE_CUDNN
 #include "cudnn.h"
+#include <ATen/cudnn/ConvBenchmarkCache.h>
 #endif
 
 #ifdef USE_DISTRIBUTED
@@ -299,37 +300,74 @@ void DLPack_Capsule_Destructor(PyObject* data) {
   END_HANDLE_TH_ERRORS_RET()
 }
 
-PyObject *THPModule_toDLPack(PyObject *_unused, PyObject *data)
+// The stream argument of _to_dlpack and _from_dlpack is None, or the
+// cudaStream_t of the stream to synchronize with as an int.
+static bool THPModule_hasDLPackStream(PyObject* stream)
+{
+  return stream && stream != Py_None;
+}
+
+static void* THPModule_unpackDLPackStream(PyObject* stream)
+{
+  return reinterpret_cast<void*>(
+      static_cast<uintptr_t>(THPUtils_unpackLong(stream)));
+}
+
+PyObject *THPModule_toDLPack(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
+  PyObject* data = nullptr;
+  PyObject* stream = nullptr;
+  if (!PyArg_ParseTuple(args, "O|O", &data, &stream)) {
+    return nullptr;
+  }
   THPUtils_assert(THPVariable_Check(data), "data must be a Tensor");
-  DLManagedTensor* dlMTensor = at::toDLPack(THPVariable_UnpackData(data));
+  const auto& tensor = THPVariable_UnpackData(data);
+  DLManagedTensor* dlMTensor;
+  if (THPModule_hasDLPackStream(stream)) {
+    THPUtils_assert(THPUtils_checkLong(stream), "stream must be None or an "
+        "int, but got %s", THPUtils_typename(stream));
+    dlMTensor = at::toDLPack(tensor, THPModule_unpackDLPackStream(stream));
+  } else {
+    dlMTensor = at::toDLPack(tensor);
+  }
   return PyCapsule_New(dlMTensor, "dltensor", DLPack_Capsule_Destructor);
   END_HANDLE_TH_ERRORS
 }
 
-PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *data)
+PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *args)
 {
   using namespace torch::autograd;
   HANDLE_TH_ERRORS
+  PyObject* data = nullptr;
+  PyObject* stream = nullptr;
+  if (!PyArg_ParseTuple(args, "O|O", &data, &stream)) {
+    return nullptr;
+  }
   DLManagedTensor * dlMTensor = (DLManagedTensor *)PyCapsule_GetPointer(data, "dltensor");
   THPUtils_assert(dlMTensor, "from_dlpack received an invalid capsule. "
     "Note that DLTensor capsules can be consumed only once, "
     "so you might have already constructed a tensor from it once.")
-  // atensor steals the ownership of the underlying storage. It also passes a
-  // destructor function that will be called when the underlying storage goes
-  // out of scope. When the destructor is called, the dlMTensor is destructed too.
-  auto atensor = make_variable(at::fromDLPack(dlMTensor), false);
+  bool has_stream = THPModule_hasDLPackStream(stream);
+  THPUtils_assert(!has_stream || THPUtils_checkLong(stream), "stream must be "
+      "None or an int, but got %s", THPUtils_typename(stream));
 
   // It is possible that the call to at::fromDLPack is the very first
   // call to create a Tensor in PyTorch. If so, then _lazy_init has
   // not been called, and the attempt to call createPyObject will fail
   // because cuda ATen types have not been registered in Python yet.
   // so if we have a cuda tensor, then we need to make sure
-  // we have called _lazy_init here
-  if(atensor.is_cuda()) {
+  // we have called _lazy_init here, before waiting on the stream of
+  // the producer too
+  if (dlMTensor->dl_tensor.ctx.device_type == kDLGPU) {
     py::module::import("torch.cuda").attr("init")();
   }
+  // atensor steals the ownership of the underlying storage. It also passes a
+  // destructor function that will be called when the underlying storage goes
+  // out of scope. When the destructor is called, the dlMTensor is destructed too.
+  auto atensor = make_variable(has_stream
+      ? at::fromDLPack(dlMTensor, THPModule_unpackDLPackStream(stream))
+      : at::fromDLPack(dlMTensor), false);
   // Make sure this capsule will never be used again.
   PyCapsule_SetName(data, "used_dltensor");
   return THPVariable_Wrap(std::move(atensor));
@@ -378,6 +416,21 @@ PyObject *THPModule_benchmarkCuDNN(PyObject *_unused)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setWorkspaceLimitCuDNN(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "set_workspace_limit_cudnn expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setWorkspaceLimitCuDNN(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject *THPModule_workspaceLimitCuDNN(PyObject *_unused)
+{
+  return PyLong_FromLongLong(at::globalContext().workspaceLimitCuDNN());
+}
+
 PyObject *THPModule_setFlushDenormal(PyObject *_unused, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "flush_denormal expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -430,8 +483,10 @@ static PyMethodDef TorchMethods[] = {
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  nullptr},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  nullptr},
-  {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       nullptr},
-  {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_O,       nullptr},
+  {"_get_cudnn_workspace_limit", (PyCFunction)THPModule_workspaceLimitCuDNN, METH_NOARGS,     nullptr},
+  {"_set_cudnn_workspace_limit", (PyCFunction)THPModule_setWorkspaceLimitCuDNN, METH_O,  nullptr},
+  {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_VARARGS, nullptr},
+  {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_VARARGS, nullptr},
   {"set_flush_denormal", (PyCFunction)THPModule_setFlushDenormal, METH_O,     nullptr},
   {"get_default_dtype", (PyCFunction)THPModule_getDefaultDtype, METH_NOARGS,  nullptr},
   {"_is_default_type_cuda", (PyCFunction)THPModule_isDefaultTypeCuda, METH_NOARGS,  nullptr},
@@ -489,8 +544,30 @@ static PyObject * THCUDNN_cudnn_version(PyObject *self, PyObject *args)
   return PyLong_FromLong(CUDNN_VERSION);
 }
 
+static PyObject * THCUDNN_export_benchmark_cache(PyObject *self, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkString(arg), "export_benchmark_cache expects a "
+          "str, but got %s", THPUtils_typename(arg));
+  at::native::exportConvolutionBenchmarkCache(THPUtils_unpackString(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THCUDNN_import_benchmark_cache(PyObject *self, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkString(arg), "import_benchmark_cache expects a "
+          "str, but got %s", THPUtils_typename(arg));
+  return PyLong_FromLongLong(
+      at::native::importConvolutionBenchmarkCache(THPUtils_unpackString(arg)));
+  END_HANDLE_TH_ERRORS
+}
+
 static PyMethodDef _THCUDNN_methods[] = {
   {"_cudnn_version", (PyCFunction)THCUDNN_cudnn_version, METH_VARARGS, nullptr},
+  {"_cudnn_export_benchmark_cache", (PyCFunction)THCUDNN_export_benchmark_cache, METH_O, nullptr},
+  {"_cudnn_import_benchmark_cache", (PyCFunction)THCUDNN_import_benchmark_cache, METH_O, nullptr},
   {nullptr}
 };
 
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace torch {
+namespace data {
+
+/// A pool of CPU memory for the tensors of batches.
+///
+/// Tensors created by the pool are backed by buffers that go back to the pool
+/// when the last tensor (or view) using them is destroyed, and are handed out
+/// again for the next batch of the same size. Collating a batch into tensors
+/// from the pool thus writes every example into memory that was already
+/// allocated (and paged in) for an earlier batch.
+///
+/// With `pin_memory`, the buffers are allocated from the caching host
+/// allocator, which already recycles pinned memory once the copies from it
+/// have finished; such batches don't need to be pinned again by the
+/// `DataLoader`.
+///
+/// A pool may be shared by many threads, e.g. by the collation transforms of
+/// all `DataLoader` workers.
+class TORCH_API BufferPool {
+ public:
+  /// Constructs a pool that keeps at most `max_cached_buffers` unused buffers
+  /// around for reuse.
+  explicit BufferPool(bool pin_memory = false, size_t max_cached_buffers = 32);
+
+  /// Returns an uninitialized CPU tensor with the given `sizes` and the dtype
+  /// of `options`, backed by a buffer from the pool.
+  Tensor empty(IntList sizes, const TensorOptions& options);
+
+  /// Stacks the (CPU) `tensors` into a new tensor from the pool, like
+  /// `torch::stack(tensors)`.
+  Tensor stack(TensorList tensors);
+
+  /// Returns true if the pool allocates pinned memory.
+  bool pin_memory() const noexcept;
+
+  /// Returns the number of unused buffers kept for reuse.
+  size_t cached_buffers() const;
+
+ private:
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+} // namespace data
+} // namespace torch
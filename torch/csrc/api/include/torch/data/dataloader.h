@@ -3,6 +3,7 @@
 #include <torch/data/dataloader_options.h>
 #include <torch/data/detail/data_shuttle.h>
 #include <torch/data/detail/sequencers.h>
+#include <torch/data/detail/transfer.h>
 #include <torch/data/iterator.h>
 #include <torch/data/samplers/random.h>
 #include <torch/data/worker_exception.h>
@@ -14,6 +15,7 @@
 #include <c10/util/Exception.h>
 
 #include <cstddef>
+#include <deque>
 #include <exception>
 #include <memory>
 #include <thread>
@@ -35,6 +37,8 @@ class DataLoader {
   DataLoader(Dataset dataset, DataLoaderOptions options, Sampler sampler)
       : options_(std::move(options)),
         sampler_(std::move(sampler)),
+        // Room for every job in flight, plus one quit message per worker
+        shuttle_(options_.max_jobs + options_.workers),
         sequencer_(new_sequencer()) {
     for (size_t w = 0; w < options_.workers; ++w) {
       // Here we copy the dataset into the worker thread closure. Each worker
@@ -48,6 +52,13 @@ class DataLoader {
     if (options_.workers == 0) {
       main_thread_dataset_ = torch::make_unique<Dataset>(std::move(dataset));
     }
+    if (options_.device.has_value()) {
+      AT_CHECK(
+          options_.prefetch_depth > 0,
+          "Expected a positive prefetch depth to transfer batches to a device");
+      transfer_stream_ =
+          torch::make_unique<detail::TransferStream>(*options_.device);
+    }
   }
 
   virtual ~DataLoader() {
@@ -67,7 +78,7 @@ class DataLoader {
   /// output_iterator)`  are supported too.
   Iterator<Batch> begin() {
     AT_CHECK(
-        shuttle_.in_flight_jobs() == 0,
+        shuttle_.in_flight_jobs() == 0 && transfers_.empty(),
         "Attempted to get a new DataLoader iterator "
         "while another iterator is not yet exhausted");
     reset();
@@ -138,6 +149,13 @@ class DataLoader {
     optional<BatchRequest> batch_request;
   };
 
+  /// A batch whose copy to the device was queued on the transfer stream, and
+  /// the event to wait for before using it.
+  struct Transfer {
+    Batch batch;
+    std::shared_ptr<detail::TransferStream::Event> event;
+  };
+
   /// The finished result of a job.
   struct Result : Sequenced {
     Result() = default;
@@ -152,6 +170,7 @@ class DataLoader {
   /// new jobs.
   void reset(bool prefetch = true) {
     shuttle_.drain();
+    transfers_.clear();
     sampler_.reset();
     sequence_number_ = 0;
     sequencer_ = new_sequencer();
@@ -180,6 +199,34 @@ class DataLoader {
   /// Returns the next batch of data, or an empty `optional` if the `DataLoader`
   /// is exhausted. This operation will block until a batch is available.
   optional<Batch> next() {
+    if (!transfer_stream_) {
+      return next_batch();
+    }
+    // Keep `prefetch_depth` copies in flight, on the transfer stream
+    while (transfers_.size() < options_.prefetch_depth) {
+      auto batch = next_batch();
+      if (!batch) {
+        break;
+      }
+      auto copy = detail::map_tensors(
+          std::move(*batch),
+          [this](const Tensor& tensor) {
+            return this->transfer_stream_->copy(tensor);
+          });
+      transfers_.push_back({std::move(copy), transfer_stream_->record()});
+    }
+    if (transfers_.empty()) {
+      return nullopt;
+    }
+    auto transfer = std::move(transfers_.front());
+    transfers_.pop_front();
+    transfer_stream_->wait(*transfer.event);
+    return std::move(transfer.batch);
+  }
+
+  /// Returns the next batch of data from the worker threads (or the main
+  /// thread), before it is copied to the device.
+  optional<Batch> next_batch() {
     optional<Batch> batch;
     if (options_.workers > 0) {
       optional<Result> result = sequencer_->next(
@@ -195,11 +242,22 @@ class DataLoader {
       }
     } else if (auto batch_request = get_batch_request()) {
       AT_ASSERT(main_thread_dataset_ != nullptr);
-      batch = main_thread_dataset_->get_batch(std::move(*batch_request));
+      batch = maybe_pin_memory(
+          main_thread_dataset_->get_batch(std::move(*batch_request)));
     }
     return batch;
   }
 
+  /// Copies the tensors of the batch into pinned memory, if configured.
+  Batch maybe_pin_memory(Batch batch) {
+    if (!options_.pin_memory) {
+      return batch;
+    }
+    return detail::map_tensors(std::move(batch), [](const Tensor& tensor) {
+      return detail::pin_memory(tensor);
+    });
+  }
+
   /// The function that worker threads run.
   void worker_thread(Dataset dataset) {
     while (true) {
@@ -208,7 +266,8 @@ class DataLoader {
         break;
       }
       try {
-        auto batch = dataset.get_batch(std::move(*job.batch_request));
+        auto batch =
+            maybe_pin_memory(dataset.get_batch(std::move(*job.batch_request)));
         shuttle_.push_result({std::move(batch), job.sequence_number});
       } catch (...) {
         shuttle_.push_result({std::current_exception(), job.sequence_number});
@@ -264,6 +323,12 @@ class DataLoader {
   /// The `Sequencer`, which handles optional ordering of batches.
   std::unique_ptr<detail::sequencers::Sequencer<Result>> sequencer_;
 
+  /// The stream on which batches are copied to `options_.device`, if set.
+  std::unique_ptr<detail::TransferStream> transfer_stream_;
+
+  /// The batches whose copies to the device are in flight, oldest first.
+  std::deque<Transfer> transfers_;
+
   /// True if the `DataLoader` has joined its worker threads.
   bool joined_ = false;
 }; // namespace data
@@ -47,14 +47,28 @@ struct DataLoaderOptions {
   /// Whether to omit the last batch if it contains less than `batch_size`
   /// examples.
   TORCH_ARG(bool, drop_last) = false;
+
+  /// Whether to copy the (CPU) tensors of every batch into pinned memory, from
+  /// the caching host allocator. This is done by the worker threads, and lets
+  /// the batches be copied to a CUDA device asynchronously.
+  TORCH_ARG(bool, pin_memory) = false;
+
+  /// A CUDA device to copy the tensors of every batch to. The copies are
+  /// queued on a dedicated stream, `prefetch_depth` batches ahead of the batch
+  /// that is returned, so they overlap with the work on the current stream.
+  /// Implies `pin_memory`.
+  TORCH_ARG(optional<Device>, device);
+
+  /// The number of batches to copy to `device` ahead of time.
+  TORCH_ARG(size_t, prefetch_depth) = 2;
 };
 
 /// Like `DataLoaderOptions`, but without any unconfigured state.
 /// `DataLoaderOptions` has some options that depend on other options
-/// (`max_jobs` => `2 * workers`). In the spirit of properly using the C++ type
-/// system, `DataLoaderOptions` allows only setting values. To access values,
-/// you must create a `FullDataLoaderOptions` from a `DataLoaderOptions`
-/// instance, which will do any necessary coalescing.
+/// (`max_jobs` => `2 * workers`, `device` => `pin_memory`). In the spirit of
+/// properly using the C++ type system, `DataLoaderOptions` allows only setting
+/// values. To access values, you must create a `FullDataLoaderOptions` from a
+/// `DataLoaderOptions` instance, which will do any necessary coalescing.
 struct FullDataLoaderOptions {
   explicit FullDataLoaderOptions(DataLoaderOptions options)
       : batch_size(options.batch_size_),
@@ -62,7 +76,10 @@ struct FullDataLoaderOptions {
         max_jobs(options.max_jobs_.value_or(2 * workers)),
         timeout(options.timeout_),
         enforce_ordering(options.enforce_ordering_),
-        drop_last(options.drop_last_) {}
+        drop_last(options.drop_last_),
+        pin_memory(options.pin_memory_ || options.device_.has_value()),
+        device(options.device_),
+        prefetch_depth(options.prefetch_depth_) {}
 
   size_t batch_size;
   size_t workers;
@@ -70,6 +87,9 @@ struct FullDataLoaderOptions {
   optional<std::chrono::milliseconds> timeout;
   bool enforce_ordering;
   bool drop_last;
+  bool pin_memory;
+  optional<Device> device;
+  size_t prefetch_depth;
 };
 } // namespace data
 } // namespace torch
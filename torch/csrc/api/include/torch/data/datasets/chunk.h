@@ -0,0 +1,298 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// Reads the examples of a dataset that is stored in chunks, e.g. one chunk
+/// per record file (or per block of records in one file).
+///
+/// A chunk is the unit of I/O of a `ChunkDataset`: it is read sequentially,
+/// in one call, so that reading a dataset never seeks to individual examples.
+/// Every preloader thread of the `ChunkDataset` reads chunks with its own copy
+/// of the reader, so the reader must be copyable and its copies must be safe
+/// to use concurrently.
+template <typename SingleExample = Example<>>
+class ChunkDataReader {
+ public:
+  using ExampleType = SingleExample;
+  using ChunkType = std::vector<ExampleType>;
+
+  virtual ~ChunkDataReader() = default;
+
+  /// Returns all examples of the chunk at `index`, which is less than
+  /// `chunk_count()`.
+  virtual ChunkType read_chunk(size_t index) = 0;
+
+  /// Returns the number of chunks in the dataset.
+  virtual size_t chunk_count() = 0;
+};
+
+/// Options to configure a `ChunkDataset`.
+struct ChunkDatasetOptions {
+  ChunkDatasetOptions() = default;
+  ChunkDatasetOptions(size_t preloader_count, size_t cache_size)
+      : preloader_count_(preloader_count), cache_size_(cache_size) {}
+
+  /// The number of threads reading chunks in parallel.
+  TORCH_ARG(size_t, preloader_count) = 1;
+
+  /// The number of examples kept in memory to shuffle, i.e. the size of the
+  /// shuffle window. Preloaders stop reading chunks while the cache is full,
+  /// so up to `cache_size` plus `preloader_count` chunks of examples are held
+  /// in memory at a time.
+  TORCH_ARG(size_t, cache_size) = 2048;
+
+  /// Whether to read the chunks in a random order every pass, and to draw
+  /// examples from the cache at random. If `false`, the examples of a single
+  /// preloader are returned in the order they are stored in.
+  TORCH_ARG(bool, shuffle) = true;
+
+  /// The seed of the random order. Defaults to a nondeterministic seed.
+  TORCH_ARG(optional<uint64_t>, seed);
+};
+
+/// A dataset that streams examples from chunks, for datasets that are too
+/// large to be held in memory or to be read one example at a time.
+///
+/// A `ChunkDataset` starts `preloader_count` threads that read whole chunks
+/// with a `ChunkReader` into a cache of (at least) `cache_size` examples.
+/// `get_batch(n)` draws `n` examples at random from the full cache, which the
+/// preloaders then top up again. The shuffle is thus only approximate: an
+/// example is shuffled with the examples that are in the cache at the same
+/// time, so chunks should not hold runs of similar examples that are much
+/// longer than the cache.
+///
+/// The dataset is an endless stream: when all chunks have been read, the
+/// preloaders start another pass over them (in a new random order). Use a
+/// `StreamSampler` to set the number of examples per epoch, typically the
+/// total number of examples in the chunks:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   auto data_loader = torch::data::make_data_loader(
+///       ChunkDataset<MyReader>(MyReader(files), ChunkDatasetOptions(4, 8192)),
+///       /*batch_size=*/64,
+///       torch::data::samplers::StreamSampler(/*epoch_size=*/examples));
+/// \endrst
+///
+/// Copies of a `ChunkDataset` share its preloaders and cache, and
+/// `get_batch()` may be called from several threads, so it can be used from
+/// the worker threads of a `DataLoader` as well. As the preloaders already
+/// read in parallel, no workers are needed in most cases though.
+template <typename ChunkReader>
+class ChunkDataset
+    : public StreamDataset<
+          ChunkDataset<ChunkReader>,
+          std::vector<typename ChunkReader::ExampleType>> {
+ public:
+  using ExampleType = typename ChunkReader::ExampleType;
+  using BatchType = std::vector<ExampleType>;
+
+  /// Constructs a `ChunkDataset` reading the chunks of `chunk_reader`, and
+  /// starts its preloader threads.
+  explicit ChunkDataset(
+      ChunkReader chunk_reader,
+      ChunkDatasetOptions options = ChunkDatasetOptions())
+      : state_(std::make_shared<State>(std::move(chunk_reader), options)) {}
+
+  /// Returns the next `batch_size` examples from the cache, blocking until
+  /// the preloaders have read enough chunks. Rethrows the exception of a
+  /// preloader if reading a chunk failed.
+  BatchType get_batch(size_t batch_size) override {
+    return state_->get_batch(batch_size);
+  }
+
+  /// Returns an empty optional, since the dataset is an endless stream.
+  optional<size_t> size() const override {
+    return nullopt;
+  }
+
+  /// Returns the options the `ChunkDataset` was configured with.
+  const ChunkDatasetOptions& options() const noexcept {
+    return state_->options;
+  }
+
+ private:
+  /// The preloaders and the cache, shared by all copies of the dataset.
+  struct State {
+    State(ChunkReader chunk_reader, ChunkDatasetOptions dataset_options)
+        : options(std::move(dataset_options)),
+          chunk_count(chunk_reader.chunk_count()),
+          chunk_order(chunk_count),
+          generator(options.seed().value_or(std::random_device()())) {
+      AT_CHECK(
+          options.preloader_count() > 0,
+          "ChunkDataset requires at least one preloader thread");
+      AT_CHECK(options.cache_size() > 0, "ChunkDataset requires a cache");
+      AT_CHECK(chunk_count > 0, "ChunkDataset requires at least one chunk");
+      std::iota(chunk_order.begin(), chunk_order.end(), 0);
+      start_pass();
+      for (size_t p = 0; p < options.preloader_count(); ++p) {
+        // Every preloader reads with its own copy of the reader.
+        preloaders.emplace_back([this, chunk_reader]() mutable {
+          this->preload(std::move(chunk_reader));
+        });
+      }
+    }
+
+    ~State() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      space.notify_all();
+      for (auto& preloader : preloaders) {
+        preloader.join();
+      }
+    }
+
+    /// The function that preloader threads run.
+    void preload(ChunkReader chunk_reader) {
+      while (true) {
+        size_t index;
+        bool first_pass;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          space.wait(lock, [this] {
+            return stop || exception || cache.size() < options.cache_size();
+          });
+          if (stop || exception) {
+            return;
+          }
+          if (position == chunk_count) {
+            start_pass();
+          }
+          index = chunk_order[position++];
+          first_pass = (pass == 1);
+        }
+
+        typename ChunkReader::ChunkType chunk;
+        try {
+          chunk = chunk_reader.read_chunk(index);
+        } catch (...) {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            exception = std::current_exception();
+          }
+          ready.notify_all();
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          std::move(chunk.begin(), chunk.end(), std::back_inserter(cache));
+          if (first_pass) {
+            first_pass_examples += chunk.size();
+            // Nothing would ever fill the cache if all chunks are empty
+            if (++first_pass_chunks == chunk_count &&
+                first_pass_examples == 0 && !exception) {
+              exception = std::make_exception_ptr(
+                  std::runtime_error("ChunkDataset: all chunks are empty"));
+            }
+          }
+        }
+        ready.notify_all();
+      }
+    }
+
+    BatchType get_batch(size_t batch_size) {
+      BatchType batch;
+      batch.reserve(batch_size);
+      std::unique_lock<std::mutex> lock(mutex);
+      while (batch.size() < batch_size) {
+        // Only draw from a full cache when shuffling, so that examples are
+        // shuffled with as many other examples as possible.
+        ready.wait(lock, [this] {
+          return exception ||
+              (options.shuffle() ? cache.size() >= options.cache_size()
+                                : !cache.empty());
+        });
+        if (exception) {
+          std::rethrow_exception(exception);
+        }
+        while (batch.size() < batch_size && !cache.empty()) {
+          if (options.shuffle()) {
+            std::uniform_int_distribution<size_t> distribution(
+                0, cache.size() - 1);
+            std::swap(cache[distribution(generator)], cache.back());
+            batch.push_back(std::move(cache.back()));
+            cache.pop_back();
+          } else {
+            batch.push_back(std::move(cache.front()));
+            cache.pop_front();
+          }
+        }
+        space.notify_all();
+      }
+      return batch;
+    }
+
+    /// Starts a new pass over the chunks. Called with the mutex held.
+    void start_pass() {
+      if (options.shuffle()) {
+        std::shuffle(chunk_order.begin(), chunk_order.end(), generator);
+      }
+      position = 0;
+      ++pass;
+    }
+
+    const ChunkDatasetOptions options;
+    const size_t chunk_count;
+
+    std::vector<std::thread> preloaders;
+
+    /// Guards all members below, and is used by both condition variables.
+    std::mutex mutex;
+    /// Notified when examples were added to the cache (or reading failed).
+    std::condition_variable ready;
+    /// Notified when examples were taken from the cache (or on shutdown).
+    std::condition_variable space;
+
+    /// The examples read so far and not yet returned.
+    std::deque<ExampleType> cache;
+    /// The order in which chunks are read in the current pass, and the
+    /// position of the next chunk to read in it.
+    std::vector<size_t> chunk_order;
+    size_t position = 0;
+    /// The number of the current pass, starting at 1.
+    size_t pass = 0;
+    /// The number of chunks read in the first pass, and the examples in them.
+    size_t first_pass_chunks = 0;
+    size_t first_pass_examples = 0;
+
+    std::mt19937_64 generator;
+    std::exception_ptr exception;
+    bool stop = false;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+} // namespace datasets
+} // namespace data
+} // namespace torch
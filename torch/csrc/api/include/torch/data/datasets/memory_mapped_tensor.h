@@ -0,0 +1,85 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A dataset of tensors stored in a raw file, which is memory-mapped instead
+/// of being read. `get()` returns a view into the mapping, so examples are
+/// only read from disk (or the page cache, which all processes mapping the
+/// file share) when they are accessed, and datasets larger than memory can be
+/// sampled randomly.
+///
+/// The data file holds the elements of all examples back to back, in native
+/// byte order and with no header. Where each example is, and its shape, is
+/// either given by an index file, or is the same for all examples. The index
+/// file is text, with one line per example: the offset of the example in the
+/// data file, counted in elements of `dtype`, followed by its sizes. Both
+/// files are written by `write_memory_mapped_tensors()`.
+///
+/// The mapping is private: writing to a returned tensor gives it its own copy
+/// of the pages written to, and never changes the file.
+class TORCH_API MemoryMappedTensorDataset
+    : public Dataset<MemoryMappedTensorDataset, TensorExample> {
+ public:
+  /// Maps the examples listed by the index file at `index_path` from the data
+  /// file at `data_path`.
+  MemoryMappedTensorDataset(
+      const std::string& data_path,
+      const std::string& index_path,
+      Dtype dtype);
+
+  /// Maps the data file at `data_path` as examples of shape `example_sizes`,
+  /// stored one after the other. Trailing bytes that don't make a whole
+  /// example are ignored.
+  MemoryMappedTensorDataset(
+      const std::string& data_path,
+      Dtype dtype,
+      IntList example_sizes);
+
+  /// Returns a view of the `index`-th example into the mapping.
+  TensorExample get(size_t index) override;
+
+  /// Returns the number of examples in the dataset.
+  optional<size_t> size() const override;
+
+  /// Returns all elements of the data file as a one-dimensional tensor.
+  const Tensor& data() const;
+
+ private:
+  struct Entry {
+    int64_t offset;
+    std::vector<int64_t> sizes;
+  };
+
+  /// All elements of the data file.
+  Tensor data_;
+  /// The examples listed by the index file, if there was one.
+  std::vector<Entry> entries_;
+  bool indexed_;
+  /// The shape of every example if there was no index file.
+  std::vector<int64_t> example_sizes_;
+  int64_t example_numel_ = 0;
+};
+
+/// Writes `tensors` in the format read by `MemoryMappedTensorDataset`: their
+/// elements to the data file at `data_path`, and where they are to the index
+/// file at `index_path`. All tensors must be CPU tensors of the same dtype.
+TORCH_API void write_memory_mapped_tensors(
+    const std::vector<Tensor>& tensors,
+    const std::string& data_path,
+    const std::string& index_path);
+
+} // namespace datasets
+} // namespace data
+} // namespace torch
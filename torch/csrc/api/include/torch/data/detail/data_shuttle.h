@@ -22,9 +22,18 @@ namespace detail {
 /// dequeues a result is the count of in-flight jobs decremented. When the main
 /// thread attempts to dequeue a job but no jobs are in-flight, that means the
 /// epoch is complete and `pop_result` returns an empty optional.
+///
+/// Both queues are bounded by `capacity`, and pushing to a full queue blocks
+/// until the other side catches up. The `DataLoader` sizes the shuttle for
+/// the maximum number of jobs it keeps in flight.
 template <typename Job, typename Result>
 class DataShuttle {
  public:
+  /// Constructs a `DataShuttle` whose job and result queues each hold at
+  /// least `capacity` elements.
+  explicit DataShuttle(size_t capacity = Queue<Job>::kDefaultCapacity)
+      : new_jobs_(capacity), results_(capacity) {}
+
   /// Pushes a new job. Called by the main thread.
   void push_job(Job job) {
     new_jobs_.push(std::move(job));
@@ -4,21 +4,37 @@
 
 #include <c10/util/Exception.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace torch {
 namespace data {
 namespace detail {
 
-/// A basic locked, blocking MPMC queue.
+/// A bounded, blocking MPMC queue.
 ///
-/// Every `push` and `pop` is guarded by a mutex. A condition variable is used
-/// to communicate insertion of new elements, such that waiting threads will be
-/// woken up if they are currently waiting inside a call to `pop()`.
+/// Elements are stored in a ring buffer whose capacity is fixed at
+/// construction (and rounded up to a power of two). Every slot carries a
+/// sequence number, which producers and consumers use to claim slots with a
+/// single compare-and-swap, so `push` and `pop` do not take a lock as long as
+/// the queue is neither full nor empty (see Dmitry Vyukov's bounded MPMC
+/// queue).
+///
+/// When the queue is empty, `pop` blocks; when it is full, `push` blocks until
+/// a consumer makes room, which keeps fast producers from running arbitrarily
+/// far ahead of their consumers. Blocked threads wait on a condition
+/// variable after spinning briefly. The mutex guarding it is only taken when
+/// some thread is actually waiting, so it does not slow down the common case.
 ///
 /// Note that this data structure is written specifically for use with the
 /// `DataLoader`. Its behavior is tailored to this use case and may not be
@@ -26,14 +42,46 @@ namespace detail {
 template <typename T>
 class Queue {
  public:
-  /// Pushes a new value to the back of the `Queue` and notifies one thread on
-  /// the waiting side about this event.
+  /// The capacity of a default-constructed `Queue`.
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  /// Constructs a `Queue` that holds at least `capacity` elements.
+  explicit Queue(size_t capacity = kDefaultCapacity)
+      : capacity_(round_up_capacity(capacity)),
+        mask_(capacity_ - 1),
+        cells_(new Cell[capacity_]) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  Queue(const Queue&) = delete;
+  Queue& operator=(const Queue&) = delete;
+
+  ~Queue() {
+    clear();
+  }
+
+  /// Pushes a new value to the back of the `Queue`, blocking while the queue
+  /// is full, and notifies one thread on the waiting side about this event.
   void push(T value) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      queue_.push(std::move(value));
+    if (!try_push_or_spin(value)) {
+      wait_for_space(value);
     }
-    cv_.notify_one();
+    notify_consumers(/*all=*/false);
+  }
+
+  /// Pushes all `values` to the back of the `Queue` in order, blocking while
+  /// the queue is full. Waiting threads are notified once for the whole batch
+  /// (or whenever the queue fills up in between).
+  void push_batch(std::vector<T> values) {
+    for (auto& value : values) {
+      if (!try_push_or_spin(value)) {
+        notify_consumers(/*all=*/true);
+        wait_for_space(value);
+      }
+    }
+    notify_consumers(/*all=*/true);
   }
 
   /// Blocks until at least one element is ready to be popped from the front of
@@ -41,44 +89,247 @@ class Queue {
   /// spent waiting for an element. If the wait times out, an exception is
   /// raised.
   T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
+    T value = wait_for_value(timeout);
+    notify_producers(/*all=*/false);
+    return value;
+  }
+
+  /// Blocks until at least one element is ready to be popped, like `pop()`,
+  /// and then pops up to `max_size` elements without blocking any further.
+  std::vector<T> pop_batch(
+      size_t max_size,
+      optional<std::chrono::milliseconds> timeout = nullopt) {
+    AT_CHECK(max_size > 0, "Expected a positive batch size to pop");
+    std::vector<T> values;
+    values.push_back(wait_for_value(timeout));
+    while (values.size() < max_size) {
+      Storage storage;
+      if (!try_pop(&storage)) {
+        break;
+      }
+      values.push_back(take(&storage));
+    }
+    notify_producers(/*all=*/true);
+    return values;
+  }
+
+  /// Empties the queue and returns the number of elements that were popped.
+  /// Only producers waiting for space are notified about this event, as it is
+  /// assumed to be used to drain the queue during shutdown of a `DataLoader`.
+  size_t clear() {
+    size_t count = 0;
+    Storage storage;
+    while (try_pop(&storage)) {
+      take(&storage);
+      ++count;
+    }
+    if (count > 0) {
+      notify_producers(/*all=*/true);
+    }
+    return count;
+  }
+
+  /// Returns the number of elements in the queue. The value is only a
+  /// snapshot when other threads push or pop concurrently.
+  size_t size() const noexcept {
+    const auto head = head_.value.load(std::memory_order_acquire);
+    const auto tail = tail_.value.load(std::memory_order_acquire);
+    return tail > head ? std::min(tail - head, capacity_) : 0;
+  }
+
+  /// Returns the maximum number of elements the queue holds at once.
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+ private:
+  /// The number of times a blocking operation retries before it waits on the
+  /// condition variable.
+  static constexpr size_t kSpinCount = 64;
+
+  /// Uninitialized memory for one element.
+  using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  /// A slot of the ring buffer. `sequence` equals the position of the next
+  /// push into the slot while it is empty, and that position plus one while it
+  /// holds a value.
+  struct Cell {
+    std::atomic<size_t> sequence;
+    Storage storage;
+  };
+
+  /// A position counter on its own cache line, so that producers and
+  /// consumers don't contend on the same line.
+  struct alignas(64) Position {
+    std::atomic<size_t> value{0};
+  };
+
+  static size_t round_up_capacity(size_t capacity) {
+    // The sequence numbers can't tell a full slot from an empty one with a
+    // single slot, so there are always at least two.
+    size_t rounded = 2;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  /// Moves `value` into the queue if there is space, without blocking.
+  bool try_push(T& value) {
+    auto position = tail_.value.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+      if (difference == 0) {
+        if (tail_.value.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          new (&cell.storage) T(std::move(value));
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        // The slot still holds the value from one lap ago: the queue is full.
+        return false;
+      } else {
+        position = tail_.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Moves the front element into `storage` if there is one, without
+  /// blocking. The caller owns the constructed element afterwards.
+  bool try_pop(Storage* storage) {
+    auto position = head_.value.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<std::ptrdiff_t>(sequence - (position + 1));
+      if (difference == 0) {
+        if (head_.value.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          T* source = reinterpret_cast<T*>(&cell.storage);
+          new (storage) T(std::move(*source));
+          source->~T();
+          cell.sequence.store(position + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        // Nothing was pushed into the slot yet: the queue is empty.
+        return false;
+      } else {
+        position = head_.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Moves the element out of `storage` (filled by `try_pop`) and destroys it.
+  static T take(Storage* storage) {
+    T* pointer = reinterpret_cast<T*>(storage);
+    T value = std::move(*pointer);
+    pointer->~T();
+    return value;
+  }
+
+  bool try_push_or_spin(T& value) {
+    for (size_t spin = 0; spin < kSpinCount; ++spin) {
+      if (try_push(value)) {
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    return false;
+  }
+
+  /// Blocks until `value` could be moved into the queue.
+  void wait_for_space(T& value) {
     std::unique_lock<std::mutex> lock(mutex_);
-    if (timeout) {
-      if (!cv_.wait_for(
-              lock, *timeout, [this] { return !this->queue_.empty(); })) {
+    waiting_producers_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!try_push(value)) {
+      not_full_.wait(lock);
+    }
+    waiting_producers_.fetch_sub(1);
+  }
+
+  /// Blocks until an element could be popped, or raises if `timeout` expires.
+  T wait_for_value(optional<std::chrono::milliseconds> timeout) {
+    Storage storage;
+    for (size_t spin = 0; spin < kSpinCount; ++spin) {
+      if (try_pop(&storage)) {
+        return take(&storage);
+      }
+      std::this_thread::yield();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() +
+        timeout.value_or(std::chrono::milliseconds(0));
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_consumers_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!try_pop(&storage)) {
+      if (!timeout) {
+        not_empty_.wait(lock);
+      } else if (
+          not_empty_.wait_until(lock, deadline) == std::cv_status::timeout) {
+        if (try_pop(&storage)) {
+          break;
+        }
+        waiting_consumers_.fetch_sub(1);
         // clang-format off
         AT_ERROR(
             "Timeout in DataLoader queue while waiting for next batch"
             " (timeout was ", timeout->count(), " ms)");
         // clang-format on
       }
-    } else {
-      cv_.wait(lock, [this] { return !this->queue_.empty(); });
     }
-    AT_ASSERT(!queue_.empty());
-    T value = queue_.front();
-    queue_.pop();
-    lock.unlock();
-    return value;
+    waiting_consumers_.fetch_sub(1);
+    return take(&storage);
   }
 
-  /// Empties the queue and returns the number of elements that were present at
-  /// the start of the function. No threads are notified about this event as it
-  /// is assumed to be used to drain the queue during shutdown of a
-  /// `DataLoader`.
-  size_t clear() {
-    std::lock_guard<std::mutex> lock(this->mutex_);
-    const auto size = queue_.size();
-    while (!queue_.empty()) {
-      queue_.pop();
+  // The fences pair with the ones taken by waiting threads after registering
+  // themselves: either the waiter sees the new element (or free slot), or the
+  // notifying thread sees the waiter and wakes it up under the mutex.
+
+  void notify_consumers(bool all) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_consumers_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      all ? not_empty_.notify_all() : not_empty_.notify_one();
     }
-    return size;
   }
 
- private:
-  std::queue<T> queue_;
+  void notify_producers(bool all) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_producers_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      all ? not_full_.notify_all() : not_full_.notify_one();
+    }
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  /// The position of the next pop.
+  Position head_;
+  /// The position of the next push.
+  Position tail_;
+
+  std::atomic<size_t> waiting_producers_{0};
+  std::atomic<size_t> waiting_consumers_{0};
   std::mutex mutex_;
-  std::condition_variable cv_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
 };
+
+template <typename T>
+constexpr size_t Queue<T>::kDefaultCapacity;
+
+template <typename T>
+constexpr size_t Queue<T>::kSpinCount;
+
 } // namespace detail
 } // namespace data
 } // namespace torch
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// Applies `function` to every tensor in `value` and returns the result.
+/// Batches made of tensors, `Example`s and `std::vector`s of those are
+/// traversed; values of any other type are returned as is.
+template <typename T, typename F>
+T map_tensors(T value, const F& /* function */) {
+  return value;
+}
+
+template <typename F>
+Tensor map_tensors(Tensor tensor, const F& function) {
+  return function(tensor);
+}
+
+template <typename Data, typename Target, typename F>
+Example<Data, Target> map_tensors(
+    Example<Data, Target> example,
+    const F& function) {
+  return {map_tensors(std::move(example.data), function),
+          map_tensors(std::move(example.target), function)};
+}
+
+template <typename Data, typename F>
+Example<Data, example::NoTarget> map_tensors(
+    Example<Data, example::NoTarget> example,
+    const F& function) {
+  return {map_tensors(std::move(example.data), function)};
+}
+
+template <typename T, typename F>
+std::vector<T> map_tensors(std::vector<T> values, const F& function) {
+  for (auto& value : values) {
+    value = map_tensors(std::move(value), function);
+  }
+  return values;
+}
+
+/// Copies the tensor into pinned (page-locked) memory from the caching host
+/// allocator, so it can be copied to a CUDA device asynchronously. Tensors
+/// that are not dense CPU tensors, or that are pinned already, are returned as
+/// is.
+TORCH_API Tensor pin_memory(const Tensor& tensor);
+
+/// A dedicated CUDA stream for copying batches to a device, so that the
+/// copies run concurrently with the work queued on the current stream.
+///
+/// The copies are meant to be used on the stream that is current when they
+/// are queued, after `wait()` was called for an event recorded after them.
+class TORCH_API TransferStream {
+ public:
+  /// Marks a point on the transfer stream (an opaque CUDA event).
+  struct Event;
+
+  explicit TransferStream(Device device);
+  ~TransferStream();
+
+  /// Queues an asynchronous copy of the tensor to the device. Tensors already
+  /// on the device are returned as is. CPU tensors must be pinned for the copy
+  /// to be asynchronous.
+  Tensor copy(const Tensor& tensor);
+
+  /// Returns an event recorded after all the copies queued so far.
+  std::shared_ptr<Event> record();
+
+  /// Makes the current stream wait for all the copies queued before `event`.
+  void wait(Event& event);
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -2,6 +2,7 @@
 
 #include <torch/data/samplers/base.h>
 #include <torch/data/samplers/custom_batch_request.h>
+#include <torch/data/samplers/lazy_random.h>
 #include <torch/data/samplers/random.h>
 #include <torch/data/samplers/sequential.h>
 #include <torch/data/samplers/serialize.h>
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <torch/data/samplers/base.h>
+#include <torch/types.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace serialize {
+class OutputArchive;
+class InputArchive;
+} // namespace serialize
+} // namespace torch
+
+namespace torch {
+namespace data {
+namespace samplers {
+
+/// A `Sampler` that returns random indices, like `RandomSampler`, but without
+/// storing them.
+///
+/// The `i`-th index of an epoch is computed when it is requested, by a
+/// pseudorandom permutation of `0 ... size - 1` chosen by a random key: a
+/// Feistel network over the smallest power of four at least `size`, whose
+/// results are fed back into it until they are less than `size`. Memory use
+/// is constant in `size`, where `RandomSampler` stores a permutation of
+/// `size` indices. The permutations are not uniformly distributed over all
+/// the permutations of `size` indices, but are shuffled well enough to sample
+/// a dataset. A new key is drawn from the default generator on every reset.
+class LazyRandomSampler : public Sampler<> {
+ public:
+  /// Constructs a `LazyRandomSampler` of the indices `0 ... size - 1`.
+  TORCH_API explicit LazyRandomSampler(size_t size);
+
+  /// Resets the `LazyRandomSampler` to a new permutation of the indices.
+  TORCH_API void reset() override;
+
+  /// Returns the next batch of indices.
+  TORCH_API optional<std::vector<size_t>> next(size_t batch_size) override;
+
+  /// Serializes the `LazyRandomSampler` to the `archive`.
+  TORCH_API void save(serialize::OutputArchive& archive) const override;
+
+  /// Deserializes the `LazyRandomSampler` from the `archive`.
+  TORCH_API void load(serialize::InputArchive& archive) override;
+
+  /// Returns the current index of the `LazyRandomSampler`.
+  TORCH_API size_t index() const noexcept;
+
+ private:
+  /// Returns the `index`-th index of the permutation with the round `keys`.
+  size_t permute(size_t index, const int64_t* keys) const;
+
+  size_t size_;
+  size_t index_{0};
+  /// Each half of the Feistel network's blocks has this many bits.
+  uint64_t half_bits_;
+  /// The keys of the Feistel network's rounds, which choose the permutation.
+  Tensor keys_;
+};
+
+} // namespace samplers
+} // namespace data
+} // namespace torch
@@ -25,7 +25,8 @@ class RandomSampler : public Sampler<> {
   ///
   /// The constructor will eagerly allocate all required indices, which is the
   /// sequence `0 ... size - 1`. `index_dtype` is the data type of the stored
-  /// indices. You can change it to influence memory usage.
+  /// indices. You can change it to influence memory usage. For datasets too
+  /// large to store a permutation of, see `LazyRandomSampler`.
   TORCH_API explicit RandomSampler(int64_t size, Dtype index_dtype = torch::kInt64);
 
   /// Resets the `RandomSampler` to a new set of indices.
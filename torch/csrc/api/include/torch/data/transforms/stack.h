@@ -1,9 +1,11 @@
 #pragma once
 
+#include <torch/data/buffer_pool.h>
 #include <torch/data/example.h>
 #include <torch/data/transforms/collate.h>
 #include <torch/types.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -14,10 +16,26 @@ namespace transforms {
 template <typename T = Example<>>
 struct Stack;
 
+namespace detail {
+/// Stacks `tensors` into a tensor from `pool`, or a new tensor without one.
+inline Tensor stack(
+    const std::shared_ptr<BufferPool>& pool,
+    TensorList tensors) {
+  return pool ? pool->stack(tensors) : torch::stack(tensors);
+}
+} // namespace detail
+
 /// A `Collation` for `Example<Tensor, Tensor>` types that stacks all data
 /// tensors into one tensor, and all target (label) tensors into one tensor.
+///
+/// If constructed with a `BufferPool`, the examples (which must be CPU
+/// tensors) are copied straight into recycled (and optionally pinned) batch
+/// tensors from the pool.
 template <>
 struct Stack<Example<>> : public Collation<Example<>> {
+  Stack() = default;
+  explicit Stack(std::shared_ptr<BufferPool> pool) : pool(std::move(pool)) {}
+
   Example<> apply_batch(std::vector<Example<>> examples) override {
     std::vector<torch::Tensor> data, targets;
     data.reserve(examples.size());
@@ -26,23 +44,30 @@ struct Stack<Example<>> : public Collation<Example<>> {
       data.push_back(std::move(example.data));
       targets.push_back(std::move(example.target));
     }
-    return {torch::stack(data), torch::stack(targets)};
+    return {detail::stack(pool, data), detail::stack(pool, targets)};
   }
+
+  std::shared_ptr<BufferPool> pool;
 };
 
 /// A `Collation` for `Example<Tensor, NoTarget>` types that stacks all data
-/// tensors into one tensor.
+/// tensors into one tensor, optionally from a `BufferPool`.
 template <>
 struct Stack<TensorExample>
     : public Collation<Example<Tensor, example::NoTarget>> {
+  Stack() = default;
+  explicit Stack(std::shared_ptr<BufferPool> pool) : pool(std::move(pool)) {}
+
   TensorExample apply_batch(std::vector<TensorExample> examples) override {
     std::vector<torch::Tensor> data;
     data.reserve(examples.size());
     for (auto& example : examples) {
       data.push_back(std::move(example.data));
     }
-    return torch::stack(data);
+    return detail::stack(pool, data);
   }
+
+  std::shared_ptr<BufferPool> pool;
 };
 } // namespace transforms
 } // namespace data
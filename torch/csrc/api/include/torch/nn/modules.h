@@ -7,5 +7,6 @@
 #include <torch/nn/modules/embedding.h>
 #include <torch/nn/modules/functional.h>
 #include <torch/nn/modules/linear.h>
+#include <torch/nn/modules/quantized.h>
 #include <torch/nn/modules/rnn.h>
 #include <torch/nn/modules/sequential.h>
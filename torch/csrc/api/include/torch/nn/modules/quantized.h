@@ -0,0 +1,94 @@
+#pragma once
+
+#include <torch/nn/cloneable.h>
+#include <torch/nn/modules/linear.h>
+#include <torch/nn/modules/rnn.h>
+#include <torch/nn/pimpl.h>
+#include <torch/types.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace torch {
+namespace nn {
+
+/// A `Linear` module with dynamically quantized int8 weights, for inference on
+/// the CPU.
+///
+/// The weight of the original module is quantized and packed for FBGEMM once,
+/// upon construction. Every call to `forward()` then quantizes its input to
+/// uint8 with a scale and zero point computed from the range of that input,
+/// multiplies in int32 and returns the result in float. Use
+/// `torch::fbgemm_is_cpu_supported()` to check that the CPU has the
+/// instructions FBGEMM needs.
+///
+/// The packed weight is an opaque tensor: it cannot be trained or serialized,
+/// `to()` does not move it, and clones of the module share it.
+class TORCH_API QuantizedLinearImpl : public Cloneable<QuantizedLinearImpl> {
+ public:
+  explicit QuantizedLinearImpl(const LinearImpl& linear);
+
+  /// Registers the `bias` buffer.
+  void reset() override;
+
+  /// Transforms the `input` tensor like the `Linear` module this module was
+  /// made from.
+  Tensor forward(Tensor input);
+
+  /// The options of the original `Linear` module.
+  LinearOptions options;
+
+  /// The quantized weight, packed by `torch::fbgemm_linear_pack_weight()`.
+  Tensor packed_weight;
+
+  /// The float bias of the original module, or zeros if it had none.
+  Tensor bias;
+};
+
+/// A `ModuleHolder` subclass for `QuantizedLinearImpl`.
+/// See the documentation for `QuantizedLinearImpl` class to learn what methods
+/// it provides, or the documentation for `ModuleHolder` to learn about
+/// PyTorch's module storage semantics.
+TORCH_MODULE(QuantizedLinear);
+
+/// An `LSTM` module with dynamically quantized int8 weights, for inference on
+/// the CPU.
+///
+/// As for `QuantizedLinear`, the input and hidden weights of every layer are
+/// quantized once and the activations of every `forward()` call on the fly.
+/// The input projection of a layer is computed for the whole sequence in one
+/// matrix multiplication, so only the hidden projection remains in the loop
+/// over time steps. Dropout is never applied, and bidirectional LSTMs are not
+/// supported.
+class TORCH_API QuantizedLSTMImpl : public Cloneable<QuantizedLSTMImpl> {
+ public:
+  explicit QuantizedLSTMImpl(const LSTMImpl& lstm);
+
+  /// Registers the `bias` and `hidden_bias` buffers.
+  void reset() override;
+
+  /// Applies the LSTM to an input sequence and input state, with the same
+  /// layouts as `LSTMImpl::forward()`.
+  RNNOutput forward(Tensor input, Tensor state = {});
+
+  /// The options of the original `LSTM` module.
+  LSTMOptions options;
+
+  /// The packed weights for the `input x hidden` gates, per layer.
+  std::vector<Tensor> packed_w_ih;
+  /// The packed weights for the `hidden x hidden` gates, per layer.
+  std::vector<Tensor> packed_w_hh;
+  /// The sum of the `input x hidden` and `hidden x hidden` biases, per layer.
+  std::vector<Tensor> bias;
+  /// Zeros, the bias of the `hidden x hidden` projection.
+  Tensor hidden_bias;
+};
+
+/// A `ModuleHolder` subclass for `QuantizedLSTMImpl`.
+/// See the documentation for `QuantizedLSTMImpl` class to learn what methods
+/// it provides, or the documentation for `ModuleHolder` to learn about
+/// PyTorch's module storage semantics.
+TORCH_MODULE(QuantizedLSTM);
+
+} // namespace nn
+} // namespace torch
@@ -4,6 +4,7 @@
 #include <torch/nn/module.h>
 #include <torch/nn/pimpl.h>
 #include <torch/types.h>
+#include <torch/utils.h>
 
 #include <torch/csrc/autograd/functions/comm.h>
 #include <torch/csrc/cuda/comm.h>
@@ -16,15 +17,30 @@
 #include <c10/util/Exception.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 namespace torch {
 namespace nn {
 namespace parallel {
 
+namespace detail {
+inline std::vector<Device> all_cuda_devices() {
+  const auto device_count = torch::cuda::device_count();
+  AT_CHECK(device_count > 0, "Expected at least one CUDA device");
+  std::vector<Device> devices;
+  devices.reserve(device_count);
+  for (size_t index = 0; index < device_count; ++index) {
+    devices.emplace_back(kCUDA, index);
+  }
+  return devices;
+}
+} // namespace detail
+
 /// Replicates a module on the given list of devices.
 /// A replica is created by calling `clone()` on the module. For this, the
 /// module must inherit from `nn::Cloneable`, or define its own `clone()`
@@ -138,13 +154,7 @@ Tensor data_parallel(
     optional<Device> output_device = nullopt,
     int64_t dim = 0) {
   if (!devices) {
-    const auto device_count = torch::cuda::device_count();
-    AT_CHECK(device_count > 0, "Expected at least one CUDA device");
-    devices.emplace();
-    devices->reserve(device_count);
-    for (size_t index = 0; index < device_count; ++index) {
-      devices->emplace_back(kCUDA, index);
-    }
+    devices = detail::all_cuda_devices();
   }
   if (!output_device) {
     output_device = devices->front();
@@ -170,6 +180,236 @@ Tensor data_parallel(
 #endif
 }
 
+/// Evaluates a module in parallel across several CUDA devices, like
+/// `data_parallel()`, but keeps a replica of the module on each device from one
+/// call to the next, rather than cloning the module on every call. The module
+/// itself, which must be on the first of the `devices`, serves as the first
+/// replica. The parameters and buffers of the module are broadcast to the other
+/// replicas with `torch::cuda::broadcast_coalesced()` only when they changed
+/// since the last call, as seen from their version counters. Changes that don't
+/// bump the version, such as writes through `data<T>()`, have to be followed by
+/// a call to `replicate_parameters()`.
+///
+/// The gradients of the other replicas are not connected to the module, and
+/// have to be added to its gradients by `reduce_gradients()` after the backward
+/// pass:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::nn::parallel::DataParallel<Net> parallel(model);
+///   torch::optim::SGD optimizer(model->parameters(), 0.1);
+///   for (auto& batch : *data_loader) {
+///     optimizer.zero_grad();
+///     loss_function(parallel.forward(batch.data), batch.target).backward();
+///     parallel.reduce_gradients();
+///     optimizer.step();
+///   }
+/// \endrst
+template <typename ModuleType>
+class DataParallel {
+ public:
+  using ReplicaList = decltype(replicate(
+      std::declval<const ModuleType&>(),
+      std::declval<const std::vector<Device>&>()));
+
+  explicit DataParallel(
+      ModuleType module,
+      optional<std::vector<Device>> devices = nullopt,
+      optional<Device> output_device = nullopt,
+      int64_t dim = 0)
+      : module_(std::move(module)), dim_(dim) {
+    devices_ = devices ? std::move(*devices) : detail::all_cuda_devices();
+    AT_CHECK(!devices_.empty(), "DataParallel expects at least one device");
+    output_device_ = output_device ? *output_device : devices_.front();
+#ifdef USE_CUDA
+    for (const auto& tensor : module_tensors(module_)) {
+      AT_CHECK(
+          tensor.device() == devices_.front(),
+          "DataParallel expects the parameters and buffers of the module on ",
+          "the first device (", devices_.front(), "), but found one on ",
+          tensor.device());
+    }
+    replicas_ = replicate(
+        module_, std::vector<Device>(devices_.begin() + 1, devices_.end()));
+    replicas_.insert(
+        replicas_.begin(), typename ReplicaList::value_type(module_));
+    record_versions();
+#else
+    AT_CHECK(
+        devices_.size() == 1, "DataParallel not supported without CUDA");
+#endif
+  }
+
+  /// Scatters the input to the devices, evaluates each replica with its chunk
+  /// of the input and gathers the outputs on the `output_device`.
+  Tensor forward(Tensor input) {
+    if (devices_.size() == 1) {
+      OptionsGuard guard(devices_.front());
+      return module_->forward(std::move(input)).to(output_device_);
+    }
+
+#ifdef USE_CUDA
+    if (parameters_changed()) {
+      replicate_parameters();
+    }
+    autograd::Scatter scatter(devices_, /*chunk_sizes=*/nullopt, dim_);
+    auto scattered_inputs = fmap<Tensor>(scatter.apply({std::move(input)}));
+
+    // A small input can have fewer chunks than there are devices
+    const auto used = scattered_inputs.size();
+    ReplicaList replicas(replicas_.begin(), replicas_.begin() + used);
+    std::vector<Device> devices(devices_.begin(), devices_.begin() + used);
+    auto outputs = parallel_apply(replicas, scattered_inputs, devices);
+    return autograd::Gather(output_device_, dim_)
+        .apply(fmap<autograd::Variable>(std::move(outputs)))
+        .front();
+#else
+    AT_ERROR("DataParallel not supported without CUDA");
+    return Tensor();
+#endif
+  }
+
+  /// Broadcasts the parameters and buffers of the module to the other
+  /// replicas.
+  void replicate_parameters() {
+#ifdef USE_CUDA
+    NoGradGuard guard;
+    const auto tensors = module_tensors(module_);
+    const auto device_indices = fmap(
+        devices_, [](const Device& device) -> int64_t { return device.index(); });
+    const auto broadcast = torch::cuda::broadcast_coalesced(
+        tensors, device_indices, kBufferSize);
+    for (size_t replica = 1; replica < replicas_.size(); ++replica) {
+      auto replica_tensors = module_tensors(replicas_[replica]);
+      AT_ASSERT(replica_tensors.size() == tensors.size());
+      for (size_t index = 0; index < replica_tensors.size(); ++index) {
+        // Points the replica at the broadcast data rather than copying it
+        autograd::as_variable_ref(replica_tensors[index])
+            .set_data(autograd::as_variable_ref(broadcast[replica][index])
+                          .data());
+      }
+    }
+    record_versions();
+#endif
+  }
+
+  /// Adds the gradients of the other replicas to the gradients of the module,
+  /// and zeros them out. The parameters with a gradient on every replica are
+  /// summed together with `torch::cuda::reduce_add_coalesced()`.
+  void reduce_gradients() {
+#ifdef USE_CUDA
+    NoGradGuard guard;
+    std::vector<std::vector<Tensor>> replica_parameters;
+    replica_parameters.reserve(replicas_.size());
+    for (const auto& replica : replicas_) {
+      replica_parameters.push_back(replica->parameters());
+      AT_ASSERT(
+          replica_parameters.back().size() ==
+          replica_parameters.front().size());
+    }
+    auto& parameters = replica_parameters.front();
+
+    std::vector<size_t> reduced;
+    std::vector<std::vector<Tensor>> grads(replicas_.size());
+    for (size_t index = 0; index < parameters.size(); ++index) {
+      bool all_defined = true;
+      for (const auto& replica : replica_parameters) {
+        all_defined = all_defined && replica[index].grad().defined();
+      }
+      if (all_defined) {
+        reduced.push_back(index);
+        for (size_t replica = 0; replica < replicas_.size(); ++replica) {
+          grads[replica].push_back(replica_parameters[replica][index].grad());
+        }
+        continue;
+      }
+      for (size_t replica = 1; replica < replicas_.size(); ++replica) {
+        const auto& grad = replica_parameters[replica][index].grad();
+        if (grad.defined()) {
+          accumulate_grad(parameters[index], grad.to(devices_.front()));
+        }
+      }
+    }
+    if (!reduced.empty()) {
+      const auto sums = torch::cuda::reduce_add_coalesced(
+          grads, devices_.front().index(), kBufferSize);
+      for (size_t index = 0; index < reduced.size(); ++index) {
+        parameters[reduced[index]].grad() = sums[index];
+      }
+    }
+
+    for (size_t replica = 1; replica < replicas_.size(); ++replica) {
+      for (auto& parameter : replica_parameters[replica]) {
+        if (parameter.grad().defined()) {
+          parameter.grad().detach_();
+          parameter.grad().zero_();
+        }
+      }
+    }
+#endif
+  }
+
+  const ModuleType& module() const noexcept {
+    return module_;
+  }
+
+  const std::vector<Device>& devices() const noexcept {
+    return devices_;
+  }
+
+ private:
+  // The size of the chunks the parameters and gradients are coalesced in
+  static constexpr size_t kBufferSize = 10 * 1024 * 1024;
+
+  template <typename M>
+  static std::vector<Tensor> module_tensors(const M& module) {
+    auto tensors = module->parameters();
+    for (auto& buffer : module->buffers()) {
+      if (buffer.defined()) {
+        tensors.push_back(std::move(buffer));
+      }
+    }
+    return tensors;
+  }
+
+  static void accumulate_grad(Tensor& parameter, const Tensor& grad) {
+    auto& parameter_grad = parameter.grad();
+    if (parameter_grad.defined()) {
+      parameter_grad.add_(grad);
+    } else {
+      parameter_grad = grad.clone();
+    }
+  }
+
+  void record_versions() {
+    versions_ = fmap(module_tensors(module_), [](const Tensor& tensor) {
+      return autograd::as_variable_ref(tensor).current_version();
+    });
+  }
+
+  bool parameters_changed() const {
+    const auto tensors = module_tensors(module_);
+    if (tensors.size() != versions_.size()) {
+      return true;
+    }
+    for (size_t index = 0; index < tensors.size(); ++index) {
+      if (autograd::as_variable_ref(tensors[index]).current_version() !=
+          versions_[index]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  ModuleType module_;
+  std::vector<Device> devices_;
+  Device output_device_{kCPU};
+  int64_t dim_;
+  ReplicaList replicas_;
+  std::vector<uint32_t> versions_;
+};
+
 } // namespace parallel
 } // namespace nn
 } // namespace torch
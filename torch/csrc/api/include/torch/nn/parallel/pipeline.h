@@ -0,0 +1,118 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/nn/modules/sequential.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace nn {
+namespace parallel {
+
+/// Options for `PipelineParallel`.
+struct TORCH_API PipelineOptions {
+  /* implicit */ PipelineOptions(int64_t chunks = 1);
+
+  /// The number of micro-batches each batch is split into, along its first
+  /// dimension. A batch smaller than that is split into fewer.
+  TORCH_ARG(int64_t, chunks);
+
+  /// The number of modules of each stage, one stage per device. By default,
+  /// the modules are split as evenly as possible.
+  TORCH_ARG(std::vector<size_t>, balance);
+
+  /// Whether each stage discards the activations of its modules in the
+  /// forward pass, and computes them again for the backward pass (activation
+  /// checkpointing). Only the input of the stage is kept, for each
+  /// micro-batch. By default, no stage is checkpointed.
+  TORCH_ARG(std::vector<bool>, checkpoint);
+};
+
+/// Evaluates a `Sequential` split into stages across several devices, with
+/// each batch split into micro-batches that go through the stages in a
+/// pipeline (the GPipe schedule), so that every device works on a different
+/// micro-batch at the same time rather than waiting for the devices before
+/// it.
+///
+/// The modules of each stage are moved to its device. The micro-batches are
+/// copied from one stage to the next on a dedicated CUDA stream of the device
+/// they come from, so that the copies overlap with the work of both stages.
+/// Like in the forward pass, the backward pass of the micro-batches overlaps
+/// across devices, since autograd runs the backward of each device on a
+/// thread of its own. The outputs of the micro-batches are concatenated on
+/// the device of the last stage.
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::nn::parallel::PipelineParallel pipeline(
+///       model, {torch::Device("cuda:0"), torch::Device("cuda:1")},
+///       torch::nn::parallel::PipelineOptions(/*chunks=*/8));
+///   torch::optim::SGD optimizer(model->parameters(), 0.1);
+///   for (auto& batch : *data_loader) {
+///     optimizer.zero_grad();
+///     auto output = pipeline.forward(batch.data.to("cuda:0"));
+///     loss_function(output, batch.target.to("cuda:1")).backward();
+///     optimizer.step();
+///   }
+/// \endrst
+///
+/// The modules of a checkpointed stage run a second time in the backward
+/// pass, with the same input and the same random state (see
+/// `torch::autograd::checkpoint`), so `Dropout` drops the same values both
+/// times. Modules that depend on the whole batch, such as `BatchNorm` in
+/// training mode, see micro-batches instead, and checkpointed ones update
+/// their running statistics twice.
+class TORCH_API PipelineParallel {
+ public:
+  PipelineParallel(
+      Sequential sequential,
+      std::vector<Device> devices,
+      PipelineOptions options = {});
+  ~PipelineParallel();
+
+  /// Runs a batch through the pipeline and returns the concatenated outputs of
+  /// its micro-batches.
+  Tensor forward(Tensor input);
+
+  /// The devices of the stages.
+  const std::vector<Device>& devices() const noexcept {
+    return devices_;
+  }
+
+  /// The number of modules of each stage.
+  std::vector<size_t> balance() const;
+
+ private:
+  /// The modules `[begin, end)` of the `Sequential`.
+  struct Stage {
+    size_t begin;
+    size_t end;
+    bool checkpoint;
+  };
+
+  /// A stream per CUDA device to copy the micro-batches on.
+  struct CopyStreams;
+
+  /// Runs the modules of the stage on a micro-batch on its device.
+  Tensor run_stage(size_t stage, Tensor input);
+
+  /// Copies a micro-batch to the device of the stage.
+  Tensor copy_to_stage(size_t stage, Tensor input);
+
+  Sequential sequential_;
+  std::vector<Device> devices_;
+  PipelineOptions options_;
+  std::vector<Stage> stages_;
+  std::unique_ptr<CopyStreams> copy_streams_;
+};
+
+} // namespace parallel
+} // namespace nn
+} // namespace torch
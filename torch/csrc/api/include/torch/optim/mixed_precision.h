@@ -0,0 +1,105 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/optim/optimizer.h>
+#include <torch/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace optim {
+
+struct TORCH_API DynamicLossScalerOptions {
+  TORCH_ARG(double, init_scale) = 65536;
+  TORCH_ARG(double, growth_factor) = 2;
+  TORCH_ARG(double, backoff_factor) = 0.5;
+  /// The number of steps without overflow after which the scale grows.
+  TORCH_ARG(int64_t, growth_interval) = 2000;
+};
+
+/// Picks the factor to multiply the loss of fp16 models by before the
+/// backward pass, so that small gradients don't flush to zero. The scale is
+/// lowered whenever the gradients overflow, and raised again after
+/// `growth_interval` steps without overflow.
+class TORCH_API DynamicLossScaler {
+ public:
+  explicit DynamicLossScaler(
+      const DynamicLossScalerOptions& options = DynamicLossScalerOptions());
+
+  /// The current scale.
+  double scale() const noexcept;
+
+  /// Multiplies the loss by the current scale.
+  Tensor scale(const Tensor& loss) const;
+
+  /// Updates the scale after a backward pass, given whether its gradients
+  /// overflowed. Returns whether the step with these gradients can be taken.
+  bool update(bool found_overflow);
+
+  DynamicLossScalerOptions options;
+
+ private:
+  double scale_;
+  int64_t steps_without_overflow_{0};
+};
+
+/// Keeps an fp32 copy of the parameters of a model, most usefully of one with
+/// fp16 parameters, for an optimizer to update instead of the parameters
+/// themselves. The copy is a single flat tensor holding all the parameters,
+/// so that the optimizer runs its few ops once per step rather than once per
+/// parameter:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::optim::MasterWeights master(model->parameters());
+///   torch::optim::SGD optimizer(master.master_parameters(), 0.1);
+///   torch::optim::DynamicLossScaler scaler;
+///   for (auto& batch : *data_loader) {
+///     master.zero_grad();
+///     scaler.scale(loss_function(model->forward(batch.data))).backward();
+///     master.step(optimizer, scaler);
+///   }
+/// \endrst
+class TORCH_API MasterWeights {
+ public:
+  /// Copies the given parameters, which must all be dense and on the same
+  /// device, as fp32.
+  explicit MasterWeights(std::vector<Tensor> model_parameters);
+
+  /// The parameters for the optimizer to update: the flat fp32 copy.
+  std::vector<Tensor> master_parameters() const;
+
+  /// Zeros out the gradients of the model parameters.
+  void zero_grad();
+
+  /// Sets the gradient of the fp32 copy to the gradients of the model
+  /// parameters divided by `loss_scale`, a parameter without a gradient
+  /// counting as a zero gradient. Returns false if any of them is inf or nan.
+  bool copy_grads_to_master(double loss_scale = 1);
+
+  /// Copies the fp32 copy back to the model parameters.
+  void copy_master_to_model();
+
+  /// Runs a step of the optimizer on the gradients of the model parameters,
+  /// scaled by the current scale of `scaler`, and copies the result back to
+  /// the model parameters. The step is skipped if the gradients overflowed,
+  /// which is reported to `scaler`. Returns whether the step was taken.
+  bool step(Optimizer& optimizer, DynamicLossScaler& scaler);
+
+  /// Runs a step of the optimizer on the unscaled gradients of the model
+  /// parameters, and copies the result back to the model parameters.
+  void step(Optimizer& optimizer);
+
+  const std::vector<Tensor>& model_parameters() const noexcept;
+
+ private:
+  std::vector<Tensor> model_parameters_;
+  Tensor master_;
+};
+
+} // namespace optim
+} // namespace torch
@@ -2,6 +2,8 @@
 
 #include <torch/csrc/WindowsTorchApiMacro.h>
 
+#include <cstddef>
+#include <future>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -14,6 +16,7 @@ class Tensor;
 namespace torch {
 using at::Tensor;
 namespace jit {
+class IncrementalExporter;
 namespace script {
 struct Module;
 } // namespace script
@@ -22,6 +25,8 @@ struct Module;
 
 namespace torch {
 namespace serialize {
+class IncrementalCheckpoint;
+
 class TORCH_API OutputArchive final {
  public:
   /// Default-constructs the `OutputArchive`.
@@ -54,6 +59,13 @@ class TORCH_API OutputArchive final {
   /// `stream`.
   void save_to(std::ostream& stream);
 
+  /// Saves the `OutputArchive` into a file at `filename` in the background.
+  /// The data of all tensors is copied (to the CPU, if needed) before this
+  /// function returns, so they may be modified while the file is written.
+  /// The returned future becomes ready once the file is complete, or rethrows
+  /// the error that stopped the save.
+  std::future<void> save_to_async(const std::string& filename);
+
   /// Forwards all arguments to `write()`.
   /// Useful for generic code that can be re-used for both `OutputArchive` and
   /// `InputArchive` (where `operator()` forwards to `read()`).
@@ -63,7 +75,59 @@ class TORCH_API OutputArchive final {
   }
 
  private:
+  friend class IncrementalCheckpoint;
+
   std::shared_ptr<jit::script::Module> module_;
 };
+
+/// Saves `OutputArchive`s to the same file again and again, writing only the
+/// tensors that changed since the last save, e.g. to checkpoint a model
+/// whose parameters are mostly untouched between checkpoints:
+///
+/// \rst
+/// .. code-block:: cpp
+///
+///   torch::serialize::IncrementalCheckpoint checkpoint("model.pt");
+///   for (size_t epoch = 0; epoch < epochs; ++epoch) {
+///     train(model);
+///     torch::serialize::OutputArchive archive;
+///     archive << model;
+///     checkpoint.save(archive);
+///   }
+/// \endrst
+///
+/// The first save writes the whole file. As long as the archives saved after
+/// it hold the same tensors (with the same sizes and types, under the same
+/// keys), the file is then updated in place, and only the tensors that were
+/// replaced or modified since the last save are written. Modifications are
+/// detected through the versions of the tensors, which every in-place
+/// operation bumps (also under a `NoGradGuard`, as used by the optimizers).
+/// Tensors modified without bumping their version, e.g. through the tensor
+/// returned by `.data()`, are missed. As tensors loaded from a file map that
+/// file (and don't copy it), updates in place are also visible through the
+/// tensors loaded from the checkpoint file before, unless they were copied.
+///
+/// A save that fails leaves the file in an unknown state, and the next save
+/// writes it in full again.
+class TORCH_API IncrementalCheckpoint final {
+ public:
+  /// Constructs an `IncrementalCheckpoint` that saves to the file at
+  /// `filename`.
+  explicit IncrementalCheckpoint(std::string filename);
+
+  /// Waits for the last `save_async()` to finish.
+  ~IncrementalCheckpoint();
+
+  /// Saves the `archive` and returns the number of tensor storages written.
+  size_t save(OutputArchive& archive);
+
+  /// Saves the `archive` in the background, like
+  /// `OutputArchive::save_to_async()`. Only the tensors that are written are
+  /// copied before this function returns. Waits for the previous save first.
+  std::shared_future<void> save_async(OutputArchive& archive);
+
+ private:
+  std::unique_ptr<jit::IncrementalExporter> exporter_;
+};
 } // namespace serialize
 } // namespace torch
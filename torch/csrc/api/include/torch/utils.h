@@ -1,11 +1,14 @@
 #pragma once
 
+#include <torch/csrc/autograd/functions/checkpoint.h>
 #include <torch/csrc/autograd/grad_mode.h>
 
 #include <cstdint>
 
 namespace torch {
 using autograd::AutoGradMode;
+using autograd::AutoInferenceMode;
+using autograd::checkpoint;
 
 // A RAII, thread local (!) guard that stops future operations from building
 // gradients.
@@ -13,6 +16,13 @@ struct TORCH_API NoGradGuard : public AutoGradMode {
   NoGradGuard() : AutoGradMode(/*enabled=*/false) {}
 };
 
+// A RAII, thread local (!) guard that makes future factory calls return plain
+// tensors, whose ops skip the autograd layer entirely. See InferenceMode in
+// torch/csrc/autograd/grad_mode.h.
+struct TORCH_API InferenceModeGuard : public AutoInferenceMode {
+  InferenceModeGuard() : AutoInferenceMode(/*enabled=*/true) {}
+};
+
 /// Sets the global random seed for all newly created CPU and CUDA tensors.
 void TORCH_API manual_seed(uint64_t seed);
 } // namespace torch
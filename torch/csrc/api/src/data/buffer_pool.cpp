@@ -0,0 +1,116 @@
+#include <torch/data/buffer_pool.h>
+
+#include <torch/csrc/autograd/variable.h>
+#include <torch/types.h>
+
+#include <ATen/detail/CUDAHooksInterface.h>
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// The allocator behind the (pageable) tensors of a pool. Every allocation
+/// carries a `Buffer` as its context, which puts the memory back into the
+/// pool when the storage using it is freed.
+struct BufferPool::Impl : public at::Allocator,
+                          public std::enable_shared_from_this<Impl> {
+  struct Buffer {
+    std::shared_ptr<const Impl> pool;
+    at::DataPtr data;
+    size_t size;
+  };
+
+  Impl(bool pin_memory, size_t max_cached_buffers)
+      : pin_memory(pin_memory),
+        max_cached_buffers(max_cached_buffers),
+        allocator(
+            pin_memory ? at::detail::getCUDAHooks().getPinnedMemoryAllocator()
+                       : at::getCPUAllocator()) {}
+
+  at::DataPtr allocate(size_t size) const override {
+    at::DataPtr data;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto& buffers = free_buffers[size];
+      if (!buffers.empty()) {
+        data = std::move(buffers.back());
+        buffers.pop_back();
+        --cached_buffers;
+      }
+    }
+    if (!data) {
+      data = allocator->allocate(size);
+    }
+    void* pointer = data.get();
+    auto* buffer = new Buffer{shared_from_this(), std::move(data), size};
+    return {pointer, buffer, &Impl::release, at::Device(at::kCPU)};
+  }
+
+  static void release(void* context) {
+    // Destroying the buffer may drop the last reference to the pool, so it
+    // must outlive the lock
+    std::unique_ptr<Buffer> buffer(static_cast<Buffer*>(context));
+    const Impl& pool = *buffer->pool;
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.cached_buffers < pool.max_cached_buffers) {
+      pool.free_buffers[buffer->size].push_back(std::move(buffer->data));
+      ++pool.cached_buffers;
+    }
+  }
+
+  const bool pin_memory;
+  const size_t max_cached_buffers;
+  at::Allocator* const allocator;
+
+  mutable std::mutex mutex;
+  /// Unused buffers by size in bytes.
+  mutable std::unordered_map<size_t, std::vector<at::DataPtr>> free_buffers;
+  mutable size_t cached_buffers = 0;
+};
+
+BufferPool::BufferPool(bool pin_memory, size_t max_cached_buffers)
+    : impl_(std::make_shared<Impl>(pin_memory, max_cached_buffers)) {}
+
+Tensor BufferPool::empty(IntList sizes, const TensorOptions& options) {
+  AT_CHECK(
+      options.device().is_cpu(),
+      "BufferPool only allocates CPU tensors, but got ",
+      options.device());
+  // The caching host allocator recycles pinned memory itself, and knows to
+  // wait for pending copies from it before doing so. Allocating from it
+  // directly also lets `pin_memory()` tell that the tensor is pinned.
+  at::Allocator* allocator =
+      impl_->pin_memory ? impl_->allocator : impl_.get();
+  auto tensor = at::getType(at::TensorOptions(options).is_variable(false))
+                    .tensorWithAllocator(sizes, allocator);
+  return autograd::make_variable(tensor, /*requires_grad=*/false);
+}
+
+Tensor BufferPool::stack(TensorList tensors) {
+  AT_CHECK(!tensors.empty(), "Expected at least one tensor to stack");
+  std::vector<int64_t> sizes = {static_cast<int64_t>(tensors.size())};
+  const auto& first = tensors.front();
+  sizes.insert(sizes.end(), first.sizes().begin(), first.sizes().end());
+  auto result = empty(sizes, first.options());
+  // `stack_out` checks that the sizes of all tensors match
+  return torch::stack_out(result, tensors);
+}
+
+bool BufferPool::pin_memory() const noexcept {
+  return impl_->pin_memory;
+}
+
+size_t BufferPool::cached_buffers() const {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->cached_buffers;
+}
+
+} // namespace data
+} // namespace torch
@@ -0,0 +1,178 @@
+#include <torch/data/datasets/memory_mapped_tensor.h>
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <TH/THAllocator.h>
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+/// Maps the whole file at `path` as a one-dimensional tensor of `dtype`,
+/// privately, so that writes to the tensor never reach the file.
+Tensor map_data_file(const std::string& path, Dtype dtype) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  AT_CHECK(file, "Error opening data file at ", path);
+  const auto file_size = static_cast<size_t>(file.tellg());
+  const auto numel = static_cast<int64_t>(file_size / elementSize(dtype));
+  auto options = at::TensorOptions().dtype(dtype);
+  if (numel == 0) {
+    return autograd::make_variable(
+        at::empty({0}, options), /*requires_grad=*/false);
+  }
+
+  size_t mapped_size = 0;
+  auto data_ptr = THMapAllocator::makeDataPtr(
+      path.c_str(), /*flags=*/0, file_size, &mapped_size);
+  // clang-format off
+  AT_CHECK(data_ptr.get() != nullptr && mapped_size == file_size,
+      "Failed to map data file ", path, " into memory");
+  // clang-format on
+  at::Storage storage(
+      at::scalarTypeToTypeMeta(dtype),
+      numel,
+      std::move(data_ptr),
+      /*allocator=*/nullptr,
+      /*resizable=*/false);
+  auto tensor = at::empty({0}, options).set_(storage, 0, {numel}, {1});
+  return autograd::make_variable(tensor, /*requires_grad=*/false);
+}
+
+int64_t numel_of(const std::vector<int64_t>& sizes) {
+  int64_t numel = 1;
+  for (auto size : sizes) {
+    AT_CHECK(size >= 0, "Expected non-negative example sizes, but got ", size);
+    numel *= size;
+  }
+  return numel;
+}
+} // namespace
+
+MemoryMappedTensorDataset::MemoryMappedTensorDataset(
+    const std::string& data_path,
+    const std::string& index_path,
+    Dtype dtype)
+    : data_(map_data_file(data_path, dtype)), indexed_(true) {
+  std::ifstream index(index_path);
+  AT_CHECK(index, "Error opening index file at ", index_path);
+  std::string line;
+  while (std::getline(index, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream fields(line);
+    Entry entry;
+    AT_CHECK(
+        fields >> entry.offset,
+        "Expected an offset at the start of line ",
+        entries_.size() + 1,
+        " of index file ",
+        index_path);
+    int64_t size;
+    while (fields >> size) {
+      entry.sizes.push_back(size);
+    }
+    AT_CHECK(
+        fields.eof(),
+        "Unexpected text on line ",
+        entries_.size() + 1,
+        " of index file ",
+        index_path);
+    const auto numel = numel_of(entry.sizes);
+    // clang-format off
+    AT_CHECK(entry.offset >= 0 && entry.offset + numel <= data_.numel(),
+        "Example ", entries_.size(), " of index file ", index_path,
+        " with ", numel, " elements at offset ", entry.offset,
+        " is out of bounds for data file ", data_path,
+        " with ", data_.numel(), " elements");
+    // clang-format on
+    entries_.push_back(std::move(entry));
+  }
+}
+
+MemoryMappedTensorDataset::MemoryMappedTensorDataset(
+    const std::string& data_path,
+    Dtype dtype,
+    IntList example_sizes)
+    : data_(map_data_file(data_path, dtype)),
+      indexed_(false),
+      example_sizes_(example_sizes.vec()),
+      example_numel_(numel_of(example_sizes_)) {
+  AT_CHECK(
+      example_numel_ > 0,
+      "Expected examples with at least one element, but got sizes ",
+      example_sizes);
+}
+
+TensorExample MemoryMappedTensorDataset::get(size_t index) {
+  const auto count = *size();
+  AT_CHECK(
+      index < count,
+      "Index ",
+      index,
+      " is out of range for dataset of size ",
+      count);
+  if (indexed_) {
+    const auto& entry = entries_[index];
+    return data_.narrow(0, entry.offset, numel_of(entry.sizes))
+        .view(entry.sizes);
+  }
+  return data_.narrow(0, index * example_numel_, example_numel_)
+      .view(example_sizes_);
+}
+
+optional<size_t> MemoryMappedTensorDataset::size() const {
+  if (indexed_) {
+    return entries_.size();
+  }
+  return data_.numel() / example_numel_;
+}
+
+const Tensor& MemoryMappedTensorDataset::data() const {
+  return data_;
+}
+
+void write_memory_mapped_tensors(
+    const std::vector<Tensor>& tensors,
+    const std::string& data_path,
+    const std::string& index_path) {
+  std::ofstream data(data_path, std::ios::binary);
+  AT_CHECK(data, "Error opening data file at ", data_path);
+  std::ofstream index(index_path);
+  AT_CHECK(index, "Error opening index file at ", index_path);
+  int64_t offset = 0;
+  for (const auto& tensor : tensors) {
+    // clang-format off
+    AT_CHECK(tensor.device().is_cpu(),
+        "Expected CPU tensors, but got a tensor on ", tensor.device());
+    AT_CHECK(tensor.scalar_type() == tensors.front().scalar_type(),
+        "Expected all tensors to be of dtype ", tensors.front().scalar_type(),
+        ", but got a tensor of dtype ", tensor.scalar_type());
+    // clang-format on
+    const auto contiguous = tensor.contiguous();
+    data.write(
+        reinterpret_cast<const char*>(contiguous.data_ptr()),
+        contiguous.numel() * contiguous.type().elementSizeInBytes());
+    index << offset;
+    for (auto size : contiguous.sizes()) {
+      index << ' ' << size;
+    }
+    index << '\n';
+    offset += contiguous.numel();
+  }
+  AT_CHECK(data, "Error writing data file at ", data_path);
+  AT_CHECK(index, "Error writing index file at ", index_path);
+}
+
+} // namespace datasets
+} // namespace data
+} // namespace torch
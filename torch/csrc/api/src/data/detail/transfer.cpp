@@ -0,0 +1,117 @@
+#include <torch/data/detail/transfer.h>
+
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <ATen/cuda/CUDAGuard.h>
+#include <ATen/cuda/PinnedMemoryAllocator.h>
+#include <THC/THCCachingAllocator.h>
+#endif
+
+#include <memory>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+Tensor pin_memory(const Tensor& tensor) {
+  if (!tensor.device().is_cpu() || tensor.layout() != kStrided) {
+    return tensor;
+  }
+#ifdef USE_CUDA
+  // E.g. batches collated into a pinned `BufferPool`
+  if (tensor.storage().allocator() == at::cuda::getPinnedMemoryAllocator()) {
+    return tensor;
+  }
+#endif // USE_CUDA
+  return tensor.pin_memory();
+}
+
+#ifdef USE_CUDA
+
+struct TransferStream::Event {
+  at::cuda::CUDAEvent event;
+};
+
+struct TransferStream::Impl {
+  explicit Impl(Device device)
+      : device(device),
+        stream(at::cuda::getStreamFromPool(
+            /*isHighPriority=*/false,
+            device.index())) {}
+
+  Device device;
+  at::cuda::CUDAStream stream;
+};
+
+TransferStream::TransferStream(Device device) {
+  AT_CHECK(
+      device.is_cuda(),
+      "Expected a CUDA device to transfer batches to, but got ",
+      device);
+  if (!device.has_index()) {
+    device = at::cuda::getCurrentCUDAStream().device();
+  }
+  impl_.reset(new Impl(device));
+}
+
+TransferStream::~TransferStream() = default;
+
+Tensor TransferStream::copy(const Tensor& tensor) {
+  if (tensor.device() == impl_->device) {
+    return tensor;
+  }
+  auto consumer = at::cuda::getCurrentCUDAStream(impl_->device.index());
+  Tensor copy;
+  {
+    // Allocates the copy on the transfer stream
+    at::cuda::CUDAStreamGuard guard(impl_->stream);
+    copy = tensor.to(impl_->device, tensor.scalar_type(), /*non_blocking=*/true);
+  }
+  // Keeps the caching allocator from reusing its memory before the consumer
+  // is done with it
+  THCCachingAllocator_recordStream(copy.data_ptr(), consumer.internals());
+  return copy;
+}
+
+std::shared_ptr<TransferStream::Event> TransferStream::record() {
+  auto event = std::make_shared<Event>();
+  event->event.record(impl_->stream);
+  return event;
+}
+
+void TransferStream::wait(Event& event) {
+  event.event.block(at::cuda::getCurrentCUDAStream(impl_->device.index()));
+}
+
+#else
+
+struct TransferStream::Event {};
+
+struct TransferStream::Impl {};
+
+TransferStream::TransferStream(Device /* device */) {
+  AT_ERROR("Transferring batches to a device requires CUDA support");
+}
+
+TransferStream::~TransferStream() = default;
+
+Tensor TransferStream::copy(const Tensor& tensor) {
+  return tensor;
+}
+
+std::shared_ptr<TransferStream::Event> TransferStream::record() {
+  return std::make_shared<Event>();
+}
+
+void TransferStream::wait(Event& /* event */) {}
+
+#endif // USE_CUDA
+
+} // namespace detail
+} // namespace data
+} // namespace torch
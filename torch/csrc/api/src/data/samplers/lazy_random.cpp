@@ -0,0 +1,109 @@
+#include <torch/data/samplers/lazy_random.h>
+#include <torch/serialize/archive.h>
+#include <torch/types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace samplers {
+namespace {
+/// Rounds of the Feistel network. Each round changes one half of the block,
+/// and with three rounds every output bit already depends on every input bit.
+constexpr int64_t kRounds = 6;
+
+/// The round function: the splitmix64 finalizer of the half block and key.
+uint64_t round_function(uint64_t half, uint64_t key) {
+  uint64_t z = half ^ key;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+Tensor random_keys() {
+  return torch::empty(kRounds, torch::kInt64).random_();
+}
+} // namespace
+
+LazyRandomSampler::LazyRandomSampler(size_t size)
+    : size_(size), half_bits_(1), keys_(random_keys()) {
+  // The blocks have an even number of bits, and at most two more than
+  // needed for `size - 1`, so that less than four in a row have to be
+  // permuted again on average
+  while ((uint64_t(1) << (2 * half_bits_)) < size_) {
+    ++half_bits_;
+  }
+}
+
+void LazyRandomSampler::reset() {
+  keys_ = random_keys();
+  index_ = 0;
+}
+
+optional<std::vector<size_t>> LazyRandomSampler::next(size_t batch_size) {
+  AT_ASSERT(index_ <= size_);
+  const size_t remaining_indices = size_ - index_;
+  if (remaining_indices == 0) {
+    return nullopt;
+  }
+  std::vector<size_t> index_batch(std::min(batch_size, remaining_indices));
+  const auto* keys = keys_.data<int64_t>();
+  for (auto& i : index_batch) {
+    i = permute(index_++, keys);
+  }
+  return index_batch;
+}
+
+void LazyRandomSampler::save(serialize::OutputArchive& archive) const {
+  archive.write(
+      "index",
+      torch::tensor(static_cast<int64_t>(index_), torch::kInt64),
+      /*is_buffer=*/true);
+  archive.write(
+      "keys",
+      keys_,
+      /*is_buffer=*/true);
+}
+
+void LazyRandomSampler::load(serialize::InputArchive& archive) {
+  auto tensor = torch::empty(1, torch::kInt64);
+  archive.read(
+      "index",
+      tensor,
+      /*is_buffer=*/true);
+  index_ = tensor.item<int64_t>();
+  archive.read(
+      "keys",
+      keys_,
+      /*is_buffer=*/true);
+}
+
+size_t LazyRandomSampler::index() const noexcept {
+  return index_;
+}
+
+size_t LazyRandomSampler::permute(size_t index, const int64_t* keys) const {
+  const uint64_t mask = (uint64_t(1) << half_bits_) - 1;
+  uint64_t block = index;
+  // The network permutes the blocks, so feeding the blocks not less than
+  // `size` back into it (cycle walking) permutes `0 ... size - 1`
+  do {
+    uint64_t left = block >> half_bits_;
+    uint64_t right = block & mask;
+    for (int64_t round = 0; round < kRounds; ++round) {
+      const uint64_t next_right =
+          left ^ (round_function(right, keys[round]) & mask);
+      left = right;
+      right = next_right;
+    }
+    block = (left << half_bits_) | right;
+  } while (block >= size_);
+  return block;
+}
+
+} // namespace samplers
+} // namespace data
+} // namespace torch
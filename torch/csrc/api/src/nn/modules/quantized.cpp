@@ -0,0 +1,116 @@
+#include <torch/nn/modules/quantized.h>
+
+#include <torch/types.h>
+#include <torch/utils.h>
+
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace nn {
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ Linear ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+QuantizedLinearImpl::QuantizedLinearImpl(const LinearImpl& linear)
+    : options(linear.options) {
+  NoGradGuard no_grad;
+  packed_weight = torch::fbgemm_linear_pack_weight(linear.weight);
+  if (linear.bias.defined()) {
+    bias = linear.bias;
+  } else {
+    bias = torch::zeros({options.out_}, linear.weight.options());
+  }
+  reset();
+}
+
+void QuantizedLinearImpl::reset() {
+  // Clones get their own copy of the bias, but share the packed weight
+  bias = register_buffer("bias", bias.detach().clone());
+}
+
+Tensor QuantizedLinearImpl::forward(Tensor input) {
+  return torch::fbgemm_linear_int8_weight(input, packed_weight, bias);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ LSTM ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+QuantizedLSTMImpl::QuantizedLSTMImpl(const LSTMImpl& lstm)
+    : options(lstm.options) {
+  AT_CHECK(
+      !options.bidirectional_,
+      "QuantizedLSTM does not support bidirectional LSTMs");
+  NoGradGuard no_grad;
+  for (int64_t layer = 0; layer < options.layers_; ++layer) {
+    packed_w_ih.push_back(torch::fbgemm_linear_pack_weight(lstm.w_ih[layer]));
+    packed_w_hh.push_back(torch::fbgemm_linear_pack_weight(lstm.w_hh[layer]));
+    if (options.with_bias_) {
+      bias.push_back(lstm.b_ih[layer] + lstm.b_hh[layer]);
+    } else {
+      bias.push_back(
+          torch::zeros({4 * options.hidden_size_}, lstm.w_ih[layer].options()));
+    }
+  }
+  hidden_bias =
+      torch::zeros({4 * options.hidden_size_}, lstm.w_hh[0].options());
+  reset();
+}
+
+void QuantizedLSTMImpl::reset() {
+  for (size_t layer = 0; layer < bias.size(); ++layer) {
+    bias[layer] = register_buffer(
+        "bias_l" + std::to_string(layer), bias[layer].detach().clone());
+  }
+  hidden_bias = register_buffer("hidden_bias", hidden_bias.detach().clone());
+}
+
+RNNOutput QuantizedLSTMImpl::forward(Tensor input, Tensor state) {
+  if (options.batch_first_) {
+    input = input.transpose(0, 1);
+  }
+  const auto sequence_length = input.size(0);
+  if (!state.defined()) {
+    // 2 for hidden state and cell state, then #layers, batch size, state size
+    state = torch::zeros(
+        {2, options.layers_, input.size(1), options.hidden_size_},
+        input.options());
+  }
+  std::vector<Tensor> hidden_states, cell_states;
+  Tensor layer_input = input;
+  for (int64_t layer = 0; layer < options.layers_; ++layer) {
+    // The input projection does not depend on the previous time step, so it is
+    // one (sequence * batch, features) matrix multiplication per layer.
+    const auto input_gates = torch::fbgemm_linear_int8_weight(
+        layer_input, packed_w_ih[layer], bias[layer]);
+    auto hx = state[0][layer];
+    auto cx = state[1][layer];
+    std::vector<Tensor> outputs;
+    outputs.reserve(sequence_length);
+    for (int64_t t = 0; t < sequence_length; ++t) {
+      const auto hidden_gates =
+          torch::fbgemm_linear_int8_weight(hx, packed_w_hh[layer], hidden_bias);
+      const auto gates = input_gates[t] + hidden_gates;
+      // Gates are in (input, forget, cell, output) order, as in `torch::lstm`
+      const auto chunked_gates = gates.chunk(4, /*dim=*/1);
+      cx = torch::sigmoid(chunked_gates[1]) * cx +
+          torch::sigmoid(chunked_gates[0]) * torch::tanh(chunked_gates[2]);
+      hx = torch::sigmoid(chunked_gates[3]) * torch::tanh(cx);
+      outputs.push_back(hx);
+    }
+    layer_input = torch::stack(outputs);
+    hidden_states.push_back(hx);
+    cell_states.push_back(cx);
+  }
+  auto output = layer_input;
+  if (options.batch_first_) {
+    output = output.transpose(0, 1);
+  }
+  return {output,
+          torch::stack(
+              {torch::stack(hidden_states), torch::stack(cell_states)})};
+}
+} // namespace nn
+} // namespace torch
@@ -0,0 +1,234 @@
+#include <torch/nn/parallel/pipeline.h>
+
+#include <torch/types.h>
+#include <torch/utils.h>
+
+#include <torch/csrc/autograd/functions/checkpoint.h>
+#include <torch/csrc/autograd/grad_mode.h>
+
+#include <ATen/OptionsGuard.h>
+#include <c10/DeviceGuard.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
+
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <ATen/cuda/CUDAGuard.h>
+#include <THC/THCCachingAllocator.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace nn {
+namespace parallel {
+
+PipelineOptions::PipelineOptions(int64_t chunks) : chunks_(chunks) {}
+
+#ifdef USE_CUDA
+struct PipelineParallel::CopyStreams {
+  at::cuda::CUDAStream get(int64_t device_index) {
+    if (static_cast<size_t>(device_index) >= streams.size()) {
+      streams.resize(device_index + 1);
+    }
+    auto& stream = streams[device_index];
+    if (!stream) {
+      stream = at::cuda::getStreamFromPool(
+          /*isHighPriority=*/false, device_index);
+    }
+    return *stream;
+  }
+
+  // Indexed by device
+  std::vector<c10::optional<at::cuda::CUDAStream>> streams;
+};
+#else
+struct PipelineParallel::CopyStreams {};
+#endif // USE_CUDA
+
+PipelineParallel::PipelineParallel(
+    Sequential sequential,
+    std::vector<Device> devices,
+    PipelineOptions options)
+    : sequential_(std::move(sequential)),
+      devices_(std::move(devices)),
+      options_(std::move(options)),
+      copy_streams_(new CopyStreams) {
+  AT_CHECK(!devices_.empty(), "PipelineParallel expects at least one device");
+  AT_CHECK(
+      options_.chunks() > 0,
+      "PipelineParallel expects a positive number of chunks, but got ",
+      options_.chunks());
+  for (const auto& device : devices_) {
+    AT_CHECK(
+        !device.is_cuda() || device.has_index(),
+        "PipelineParallel expects CUDA devices with an index, but got ",
+        device);
+  }
+
+  const auto num_modules = sequential_->size();
+  const auto num_stages = devices_.size();
+  auto balance = options_.balance();
+  if (balance.empty()) {
+    AT_CHECK(
+        num_modules >= num_stages,
+        "Cannot split a Sequential of ",
+        num_modules,
+        " modules into ",
+        num_stages,
+        " stages");
+    for (size_t stage = 0; stage < num_stages; ++stage) {
+      balance.push_back(
+          num_modules / num_stages + (stage < num_modules % num_stages));
+    }
+  }
+  AT_CHECK(
+      balance.size() == num_stages,
+      "Expected the balance to have an entry per device (",
+      num_stages,
+      "), but got ",
+      balance.size());
+  auto checkpoint = options_.checkpoint();
+  if (checkpoint.empty()) {
+    checkpoint.resize(num_stages, false);
+  }
+  AT_CHECK(
+      checkpoint.size() == num_stages,
+      "Expected the checkpoint option to have an entry per device (",
+      num_stages,
+      "), but got ",
+      checkpoint.size());
+
+  size_t begin = 0;
+  for (size_t stage = 0; stage < num_stages; ++stage) {
+    AT_CHECK(balance[stage] > 0, "Every stage needs at least one module");
+    const size_t end = begin + balance[stage];
+    AT_CHECK(
+        end <= num_modules,
+        "The balance adds up to more modules than the Sequential has (",
+        num_modules,
+        ")");
+    for (size_t index = begin; index < end; ++index) {
+      sequential_->ptr(index)->to(devices_[stage]);
+    }
+    stages_.push_back({begin, end, checkpoint[stage]});
+    begin = end;
+  }
+  AT_CHECK(
+      begin == num_modules,
+      "The balance adds up to ",
+      begin,
+      " modules, but the Sequential has ",
+      num_modules);
+}
+
+PipelineParallel::~PipelineParallel() = default;
+
+std::vector<size_t> PipelineParallel::balance() const {
+  std::vector<size_t> balance;
+  balance.reserve(stages_.size());
+  for (const auto& stage : stages_) {
+    balance.push_back(stage.end - stage.begin);
+  }
+  return balance;
+}
+
+Tensor PipelineParallel::forward(Tensor input) {
+  auto batches = input.chunk(options_.chunks(), /*dim=*/0);
+  const size_t num_batches = batches.size();
+  const size_t num_stages = stages_.size();
+
+  // At every clock tick, each stage takes the next micro-batch from the stage
+  // before it: micro-batch i goes through stage j at tick i + j. The work is
+  // only queued on the devices, so that the stages of a tick run at the same
+  // time.
+  for (size_t clock = 0; clock < num_batches + num_stages - 1; ++clock) {
+    const size_t first = clock < num_stages ? 0 : clock - num_stages + 1;
+    const size_t last = std::min(clock, num_batches - 1);
+    for (size_t batch = first; batch <= last; ++batch) {
+      batches[batch] = run_stage(clock - batch, std::move(batches[batch]));
+    }
+  }
+  return torch::cat(batches, /*dim=*/0);
+}
+
+Tensor PipelineParallel::run_stage(size_t index, Tensor input) {
+  input = copy_to_stage(index, std::move(input));
+
+  const auto& stage = stages_[index];
+  const auto begin = stage.begin;
+  const auto end = stage.end;
+  const auto device = devices_[index];
+  auto sequential = sequential_;
+  // Holds on to the Sequential rather than to the pipeline, for the backward
+  // of checkpointed stages
+  std::function<Tensor(Tensor)> run =
+      [sequential, begin, end, device](Tensor input) mutable {
+        c10::DeviceGuard device_guard(device);
+        OptionsGuard options_guard(device);
+        auto iterator = sequential->begin();
+        for (auto module = iterator + begin; module != iterator + end;
+             ++module) {
+          input = module->forward<Tensor>(std::move(input));
+        }
+        return input;
+      };
+
+  if (!stage.checkpoint || !autograd::GradMode::is_enabled()) {
+    return run(std::move(input));
+  }
+
+  return autograd::checkpoint(
+      [run](const autograd::variable_list& inputs) mutable {
+        return autograd::variable_list{run(inputs[0])};
+      },
+      {std::move(input)})[0];
+}
+
+Tensor PipelineParallel::copy_to_stage(size_t index, Tensor input) {
+  const auto& device = devices_[index];
+  if (input.device() == device) {
+    return input;
+  }
+#ifdef USE_CUDA
+  if (input.is_cuda() && device.is_cuda()) {
+    const auto source = input.device().index();
+    auto copy_stream = copy_streams_->get(source);
+    // The copy waits for the work that produced the micro-batch, and for the
+    // work queued on the destination, whose freed memory the copy may get.
+    // The copy runs on a dedicated stream of the source device, since THC
+    // copies between devices on the current stream of the source.
+    at::cuda::CUDAEvent produced;
+    produced.record(at::cuda::getCurrentCUDAStream(source));
+    produced.block(copy_stream);
+    at::cuda::CUDAEvent destination_ready;
+    destination_ready.record(at::cuda::getCurrentCUDAStream(device.index()));
+    destination_ready.block(copy_stream);
+
+    Tensor copy;
+    {
+      at::cuda::CUDAStreamGuard guard(copy_stream);
+      copy = input.to(device, input.scalar_type(), /*non_blocking=*/true);
+    }
+    // Keeps the caching allocator from reusing the memory of the input before
+    // the copy is done with it
+    THCCachingAllocator_recordStream(input.data_ptr(), copy_stream.internals());
+
+    at::cuda::CUDAEvent copied;
+    copied.record(copy_stream);
+    copied.block(at::cuda::getCurrentCUDAStream(device.index()));
+    return copy;
+  }
+#endif // USE_CUDA
+  return input.to(device);
+}
+
+} // namespace parallel
+} // namespace nn
+} // namespace torch
@@ -5,7 +5,10 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <caffe2/perfkernels/adagrad.h>
 
+#include <algorithm>
 #include <functional>
 
 namespace torch {
@@ -14,6 +17,57 @@ namespace optim {
 AdagradOptions::AdagradOptions(double learning_rate)
     : learning_rate_(learning_rate) {}
 
+namespace {
+constexpr double kEpsilon = 1e-10;
+
+/// Updates the rows of `p` and `sum` that the coalesced sparse gradient
+/// `grad` touches, leaving all others alone.
+void sparse_adagrad_update(Tensor& p, Tensor& sum, const Tensor& grad, double clr) {
+  AT_CHECK(
+      grad.sparse_dim() == 1,
+      "Adagrad expects row-sparse gradients (with one sparse dimension), but got ",
+      grad.sparse_dim(), " sparse dimensions");
+  const auto rows = grad._indices()[0];
+  const auto values = grad._values();
+  if (rows.numel() == 0) {
+    return;
+  }
+  if (p.device().is_cpu() && p.scalar_type() == kFloat && p.is_contiguous() &&
+      sum.is_contiguous()) {
+    // Fused update of a row at a time. The rows are distinct, so they can be
+    // updated in parallel.
+    const auto values_contig = values.contiguous();
+    const auto rows_contig = rows.contiguous();
+    const int64_t* row_data = rows_contig.data<int64_t>();
+    const float* g = values_contig.data<float>();
+    float* w = p.data<float>();
+    float* h = sum.data<float>();
+    const int64_t num_rows = p.size(0);
+    const int64_t block_size = p.numel() / std::max<int64_t>(num_rows, 1);
+    at::parallel_for(
+        0, rows.numel(), at::internal::GRAIN_SIZE / std::max<int64_t>(block_size, 1),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const int64_t row = row_data[i];
+            AT_CHECK(
+                row >= 0 && row < num_rows,
+                "gradient row ", row, " is out of bounds for a parameter with ",
+                num_rows, " rows");
+            float* w_row = w + row * block_size;
+            float* h_row = h + row * block_size;
+            caffe2::adagrad_update(
+                block_size, w_row, g + i * block_size, h_row, w_row, h_row,
+                kEpsilon, /*decay=*/1.0f, -clr);
+          }
+        });
+    return;
+  }
+  sum.index_add_(0, rows, values * values);
+  const auto std_values = sum.index_select(0, rows).sqrt_().add_(kEpsilon);
+  p.index_add_(0, rows, values / std_values * -clr);
+}
+} // namespace
+
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 void Adagrad::step() {
@@ -23,7 +77,11 @@ void Adagrad::step() {
       continue;
     }
 
-    if (options.weight_decay_ > 0) {
+    if (p.grad().is_sparse()) {
+      AT_CHECK(
+          options.weight_decay_ == 0,
+          "weight_decay option is not compatible with sparse gradients");
+    } else if (options.weight_decay_ > 0) {
       p.grad() = p.grad() + options.weight_decay_ * p;
     }
 
@@ -32,6 +90,11 @@ void Adagrad::step() {
         (1.0 + (buffer_at(step_buffers, i) - 1.0) * options.lr_decay_);
 
     auto& sum = buffer_at(sum_buffers, i);
+    if (p.grad().is_sparse()) {
+      NoGradGuard guard;
+      sparse_adagrad_update(p, sum, p.grad().coalesce(), clr);
+      continue;
+    }
     sum.addcmul_(p.grad(), p.grad(), 1.0);
     const auto std = buffer_at(sum_buffers, i).sqrt().add_(1e-10);
 
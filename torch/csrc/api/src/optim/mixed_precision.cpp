@@ -0,0 +1,129 @@
+#include <torch/optim/mixed_precision.h>
+
+#include <torch/optim/optimizer.h>
+#include <torch/types.h>
+#include <torch/utils.h>
+
+#include <ATen/ATen.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace optim {
+
+DynamicLossScaler::DynamicLossScaler(const DynamicLossScalerOptions& options)
+    : options(options), scale_(options.init_scale_) {}
+
+double DynamicLossScaler::scale() const noexcept {
+  return scale_;
+}
+
+Tensor DynamicLossScaler::scale(const Tensor& loss) const {
+  return loss * scale_;
+}
+
+bool DynamicLossScaler::update(bool found_overflow) {
+  if (found_overflow) {
+    scale_ *= options.backoff_factor_;
+    steps_without_overflow_ = 0;
+    return false;
+  }
+  if (++steps_without_overflow_ == options.growth_interval_) {
+    scale_ *= options.growth_factor_;
+    steps_without_overflow_ = 0;
+  }
+  return true;
+}
+
+MasterWeights::MasterWeights(std::vector<Tensor> model_parameters)
+    : model_parameters_(std::move(model_parameters)) {
+  AT_CHECK(
+      !model_parameters_.empty(), "MasterWeights expects at least one parameter");
+  NoGradGuard guard;
+  std::vector<Tensor> flat;
+  flat.reserve(model_parameters_.size());
+  for (const auto& parameter : model_parameters_) {
+    AT_CHECK(
+        !parameter.is_sparse(), "MasterWeights expects dense parameters");
+    AT_CHECK(
+        parameter.device() == model_parameters_.front().device(),
+        "MasterWeights expects all parameters on the same device, but got ",
+        parameter.device(), " and ", model_parameters_.front().device());
+    flat.push_back(parameter.reshape({-1}).to(torch::kFloat));
+  }
+  master_ = torch::cat(flat);
+}
+
+std::vector<Tensor> MasterWeights::master_parameters() const {
+  return {master_};
+}
+
+void MasterWeights::zero_grad() {
+  for (auto& parameter : model_parameters_) {
+    if (parameter.grad().defined()) {
+      parameter.grad().detach_();
+      parameter.grad().zero_();
+    }
+  }
+}
+
+bool MasterWeights::copy_grads_to_master(double loss_scale) {
+  NoGradGuard guard;
+  std::vector<Tensor> grads;
+  grads.reserve(model_parameters_.size());
+  for (const auto& parameter : model_parameters_) {
+    if (parameter.grad().defined()) {
+      grads.push_back(parameter.grad().reshape({-1}).to(torch::kFloat));
+    } else {
+      grads.push_back(torch::zeros({parameter.numel()}, master_.options()));
+    }
+  }
+  // A single cat, rather than a copy per parameter
+  auto& grad = master_.grad();
+  if (grad.defined()) {
+    torch::cat_out(grad, grads);
+  } else {
+    grad = torch::cat(grads);
+  }
+  if (loss_scale != 1) {
+    grad.mul_(1 / loss_scale);
+  }
+  // The sum is inf or nan if any of the gradients is
+  return std::isfinite(grad.sum().item<double>());
+}
+
+void MasterWeights::copy_master_to_model() {
+  NoGradGuard guard;
+  int64_t offset = 0;
+  for (auto& parameter : model_parameters_) {
+    const auto numel = parameter.numel();
+    parameter.copy_(
+        master_.slice(/*dim=*/0, offset, offset + numel).view(parameter.sizes()));
+    offset += numel;
+  }
+}
+
+bool MasterWeights::step(Optimizer& optimizer, DynamicLossScaler& scaler) {
+  const bool finite = copy_grads_to_master(scaler.scale());
+  if (!scaler.update(/*found_overflow=*/!finite)) {
+    return false;
+  }
+  optimizer.step();
+  copy_master_to_model();
+  return true;
+}
+
+void MasterWeights::step(Optimizer& optimizer) {
+  copy_grads_to_master();
+  optimizer.step();
+  copy_master_to_model();
+}
+
+const std::vector<Tensor>& MasterWeights::model_parameters() const noexcept {
+  return model_parameters_;
+}
+
+} // namespace optim
+} // namespace torch
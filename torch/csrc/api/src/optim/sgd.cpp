@@ -8,13 +8,64 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 
+#include <algorithm>
 #include <functional>
 
 namespace torch {
 namespace optim {
 SGDOptions::SGDOptions(double learning_rate) : learning_rate_(learning_rate) {}
 
+namespace {
+/// Subtracts `learning_rate` times the coalesced sparse gradient `grad` from
+/// the rows of `p` it touches.
+void sparse_sgd_update(Tensor& p, const Tensor& grad, double learning_rate) {
+  AT_CHECK(
+      grad.sparse_dim() == 1,
+      "SGD expects row-sparse gradients (with one sparse dimension), but got ",
+      grad.sparse_dim(), " sparse dimensions");
+  const auto rows = grad._indices()[0];
+  const auto values = grad._values();
+  if (rows.numel() == 0) {
+    return;
+  }
+  if (!p.device().is_cpu() || !p.is_contiguous()) {
+    p.index_add_(0, rows, values * -learning_rate);
+    return;
+  }
+  // Fused update of a row at a time. The rows are distinct, so they can be
+  // updated in parallel.
+  const auto values_contig = values.contiguous();
+  const auto rows_contig = rows.contiguous();
+  const int64_t* row_data = rows_contig.data<int64_t>();
+  const int64_t num_rows = p.size(0);
+  const int64_t block_size = p.numel() / std::max<int64_t>(num_rows, 1);
+  AT_DISPATCH_FLOATING_TYPES(p.type(), "sparse_sgd_update", [&] {
+    const scalar_t* g = values_contig.data<scalar_t>();
+    scalar_t* w = p.data<scalar_t>();
+    const auto lr = static_cast<scalar_t>(learning_rate);
+    at::parallel_for(
+        0, rows.numel(), at::internal::GRAIN_SIZE / std::max<int64_t>(block_size, 1),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const int64_t row = row_data[i];
+            AT_CHECK(
+                row >= 0 && row < num_rows,
+                "gradient row ", row, " is out of bounds for a parameter with ",
+                num_rows, " rows");
+            scalar_t* w_row = w + row * block_size;
+            const scalar_t* g_row = g + i * block_size;
+            for (int64_t j = 0; j < block_size; ++j) {
+              w_row[j] -= lr * g_row[j];
+            }
+          }
+        });
+  });
+}
+} // namespace
+
 void SGD::step() {
   for (size_t i = 0; i < parameters_.size(); ++i) {
     Tensor p = parameters_.at(i);
@@ -23,6 +74,15 @@ void SGD::step() {
       continue;
     }
 
+    if (p.grad().is_sparse()) {
+      AT_CHECK(
+          options.weight_decay_ == 0 && options.momentum_ == 0,
+          "SGD with momentum or weight decay does not support sparse gradients");
+      NoGradGuard guard;
+      sparse_sgd_update(p, p.grad().coalesce(), options.learning_rate_);
+      continue;
+    }
+
     auto update = options.learning_rate_ * p.grad();
 
     if (options.weight_decay_ > 0) {
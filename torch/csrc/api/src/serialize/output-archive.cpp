@@ -8,9 +8,11 @@
 
 #include <c10/util/Exception.h>
 
+#include <future>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 
 namespace torch {
 namespace serialize {
@@ -39,5 +41,26 @@ void OutputArchive::save_to(std::ostream& stream) {
   AT_ASSERT(module_ != nullptr);
   jit::ExportModule(*module_, stream);
 }
+
+std::future<void> OutputArchive::save_to_async(const std::string& filename) {
+  AT_ASSERT(module_ != nullptr);
+  return jit::ExportModuleAsync(*module_, filename);
+}
+
+IncrementalCheckpoint::IncrementalCheckpoint(std::string filename)
+    : exporter_(new jit::IncrementalExporter(std::move(filename))) {}
+
+IncrementalCheckpoint::~IncrementalCheckpoint() = default;
+
+size_t IncrementalCheckpoint::save(OutputArchive& archive) {
+  AT_ASSERT(archive.module_ != nullptr);
+  return exporter_->exportModule(*archive.module_);
+}
+
+std::shared_future<void> IncrementalCheckpoint::save_async(
+    OutputArchive& archive) {
+  AT_ASSERT(archive.module_ != nullptr);
+  return exporter_->exportModuleAsync(*archive.module_);
+}
 } // namespace serialize
 } // namespace torch
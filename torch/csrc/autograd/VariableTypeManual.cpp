@@ -234,6 +234,24 @@ std::vector<at::Tensor> VariableType::unpack(at::TensorList tl, const char *name
   return ret;
 }
 
+// Like unpack(TensorList), but keeps undefined tensors, which mark the
+// dimensions that are not indexed
+std::vector<at::Tensor> VariableType::unpack_idxs(at::TensorList tl, const char *name, int pos) {
+  std::vector<at::Tensor> ret(tl.size());
+  for (size_t i = 0; i < tl.size(); ++i) {
+    const auto &t = tl[i];
+    if (!t.defined()) {
+      continue;
+    }
+    if (!isVariableType(t.type())) {
+      AT_ERROR("Expected object of type Variable but found type ", t.type().toString(), " at position #", i, " "
+                    "for iterable argument #", pos, " '", name, "'");
+    }
+    ret[i] = static_cast<const Variable&>(t).data();
+  }
+  return ret;
+}
+
 void VariableType::backward(
     Tensor& self,
     c10::optional<Tensor> gradient,
@@ -4,6 +4,7 @@
 #include "torch/csrc/autograd/functions/basic_ops.h"
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/anomaly_mode.h"
+#include "torch/csrc/autograd/saved_variable.h"
 #include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/utils/memory.h"
 
@@ -11,6 +12,7 @@
 #include <ATen/ExpandUtils.h>
 #include <c10/util/Exception.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -50,11 +52,13 @@ static thread_local int worker_device = NO_DEVICE;
 static thread_local bool checkpoint_valid = true;
 
 // XXX: Changes to the way multithreading works in execute should be done with
-// great care. Right now the implementation guarantees that a single function's
-// apply will never be entered concurrently (even if multiple graphs are
-// executed at the same time). Adding multiple threads per-device or removing
-// engine thread affinity to the device can break this invariant, and we depend
-// on it in a few places (e.g. AccumulateGrad function).
+// great care. A function is only ever queued once per GraphTask, so within a
+// single graph its apply is never entered concurrently. Device queues have a
+// single worker, so functions running on a GPU are also never entered
+// concurrently when multiple graphs are executed at the same time. The CPU
+// queue may have several workers (see Engine::set_num_cpu_threads), in which
+// case a CPU function shared by graphs executed at the same time can be
+// entered concurrently; AccumulateGrad takes a lock for this reason.
 
 struct FunctionTask {
   GraphTask* base;
@@ -63,6 +67,9 @@ struct FunctionTask {
   // gradients flowing here.  Once all the dependencies are finished, we
   // use the contents of this buffer to run the function.
   InputBuffer inputs;
+  // The priority of fn in this graph, see GraphTask::priorities. Set by
+  // ReadyQueue::push.
+  int64_t priority = 0;
 
   FunctionTask(GraphTask* base, std::shared_ptr<Function> fn, InputBuffer inputs)
     : base(base)
@@ -73,6 +80,9 @@ struct FunctionTask {
 // Returns true when t2 should be (weakly) BEFORE t1 in the queue.
 struct CompareFunctionTaskTime {
   bool operator()(FunctionTask const & t1, FunctionTask const & t2) {
+    if (t1.priority != t2.priority) {
+      return t1.priority < t2.priority;
+    }
     return t1.fn->sequence_nr() < t2.fn->sequence_nr();
   }
 };
@@ -83,7 +93,12 @@ struct ReadyQueue {
   std::mutex mutex;
 
   void push(FunctionTask item);
-  FunctionTask pop();
+  // Blocks until a task is available. If graph_task is given, also returns
+  // (an empty task) once graph_task has no outstanding tasks left.
+  FunctionTask pop(GraphTask* graph_task = nullptr);
+  // Wakes up all workers waiting in pop(), so that they can check whether
+  // the graph task they are waiting for has completed.
+  void wake_all();
 };
 
 // Note [Reentrant backwards]
@@ -95,9 +110,9 @@ struct ReadyQueue {
 //  differentiation finishes so that you can get the final result variables
 //  of the backwards pass.
 //
-//  2. The engine operates by having a single worker thread per work queue,
-//  and every work queue is pinned to a specific device where the
-//  operation is executed.
+//  2. The engine operates by having a fixed set of worker threads per work
+//  queue (a single one for every device queue), and every work queue is
+//  pinned to a specific device where the operation is executed.
 //
 // The problem is, suppose that you call backward() inside of a worker
 // thread.  By property (1), we're supposed to block until the nested task
@@ -119,8 +134,10 @@ struct ReadyQueue {
 //
 //  - When we finish a GraphTask, we have to make sure we wake up the worker
 //    thread so that it actually has a chance to exit the thread_main()
-//    loop.  Thus the faffing about in thread_main() after
-//    evaluate_function() completes.
+//    loop.  The owning worker waits in ReadyQueue::pop() for either more
+//    work or the completion of its graph_task, so whichever thread finishes
+//    the last task wakes up the workers of the owner's queue.  Thus the
+//    faffing about in thread_main() after evaluate_function() completes.
 
 
 // GraphTask holds metadata needed for a single execution of backward()
@@ -139,6 +156,11 @@ struct GraphTask {
   std::condition_variable not_done;
   std::unordered_map<Function*, InputBuffer> not_ready;
   std::unordered_map<Function*, int> dependencies;
+  // The priority of every function with a non-zero priority in this graph:
+  // the highest Function::priority() of the function itself and of all
+  // functions that depend on its outputs. Empty if no function in the graph
+  // has a priority set. Read-only once the graph is executing.
+  std::unordered_map<Function*, int64_t> priorities;
 
   struct ExecInfo {
     struct Capture {
@@ -163,6 +185,15 @@ struct GraphTask {
   std::vector<Variable> captured_vars;
 
   void init_to_execute(Function& graph_root, const edge_list& outputs);
+  void init_priorities(Function& graph_root);
+
+  int64_t priority(Function* fn) const {
+    if (priorities.empty()) {
+      return 0;
+    }
+    auto it = priorities.find(fn);
+    return it == priorities.end() ? 0 : it->second;
+  }
 
   // The value of worker_device in the thread that created this task.
   // See Note [Reentrant backwards]
@@ -184,19 +215,35 @@ auto ReadyQueue::push(FunctionTask item) -> void {
   {
     std::lock_guard<std::mutex> lock(mutex);
     ++item.base->outstanding_tasks;
+    item.priority = item.base->priority(item.fn.get());
     heap.push(std::move(item));
   }
   not_empty.notify_one();
 }
 
-auto ReadyQueue::pop() -> FunctionTask {
+auto ReadyQueue::pop(GraphTask* graph_task) -> FunctionTask {
   std::unique_lock<std::mutex> lock(mutex);
-  not_empty.wait(lock, [this]{ return !heap.empty(); });
+  auto graph_task_done = [graph_task] {
+    return graph_task && graph_task->outstanding_tasks.load() == 0;
+  };
+  not_empty.wait(lock, [&]{ return !heap.empty() || graph_task_done(); });
+  if (graph_task_done()) {
+    return FunctionTask(nullptr, nullptr, InputBuffer(0));
+  }
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<FunctionTask&>(heap.top())); heap.pop();
   return task;
 }
 
+auto ReadyQueue::wake_all() -> void {
+  // Taking the lock orders this with the predicate check in pop(), so a
+  // worker that is about to wait can't miss the notification.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+  }
+  not_empty.notify_all();
+}
+
 Engine::Engine() = default;
 
 // This Engine's ReadyQueues and their corresponding threads are leaked here
@@ -240,7 +287,11 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
   // Why the test on graph_task->outstanding_tasks?  See
   // Note [Reentrant backwards]
   while (!graph_task || graph_task->outstanding_tasks > 0) {
-    FunctionTask task = queue->pop();
+    FunctionTask task = queue->pop(graph_task);
+    // An empty task means that graph_task has completed
+    if (!task.base) {
+      break;
+    }
     if (task.fn && !task.base->has_error.load()) {
       GradMode::set_enabled(task.base->grad_mode);
       try {
@@ -259,22 +310,14 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
         std::lock_guard<std::mutex> lock(task.base->mutex);
         task.base->not_done.notify_all();
       }
-    } else {
-      // If it's a task initiated from this thread, decrease the counter, but
-      // don't do anything - loop condition will do all checks for us next.
-      if (base_owner == worker_device) {
-        --task.base->outstanding_tasks;
-      // Otherwise send a dummy function task to the owning thread just to
-      // ensure that it's not sleeping. If it has work, it might see that
-      // graph_task->outstanding_tasks == 0 before it gets to the task, but
-      // it's a no-op anyway.
-      } else if (base_owner != worker_device) {
-        if (--task.base->outstanding_tasks == 0) {
-          // Synchronize outstanding_tasks with queue mutex
-          std::atomic_thread_fence(std::memory_order_release);
-          ready_queue(base_owner).push(FunctionTask(task.base, nullptr, InputBuffer(0)));
-        }
-      }
+    } else if (--task.base->outstanding_tasks == 0) {
+      // The graph task is owned by a worker, which may be waiting for work
+      // in its queue; wake it up so that it can return. This can't push a
+      // task to the owner's queue, because with several workers on that
+      // queue the task might be picked up by another worker after the
+      // owner has returned. If this thread is the owner (it can't tell when
+      // the queue has several workers) the loop condition does the rest.
+      ready_queue(base_owner).wake_all();
     }
   }
 }
@@ -358,11 +401,38 @@ static void validate_outputs(const edge_list& edges, variable_list& grads, const
   }
 }
 
-static variable_list call_function(FunctionTask& task) {
+static int64_t dense_bytes(const variable_list& vars) {
+  int64_t bytes = 0;
+  for (const auto& var : vars) {
+    if (var.defined() && !var.is_sparse()) {
+      bytes += var.numel() * var.type().elementSizeInBytes();
+    }
+  }
+  return bytes;
+}
+
+// The bytes allocated on a GPU, and -1 for the CPU, whose allocations aren't
+// counted
+static int64_t allocated_bytes(int device) {
+#ifdef USE_CUDA
+  if (device >= 0) {
+    return THCCachingAllocator_currentMemoryAllocated(device);
+  }
+#endif
+  return -1;
+}
+
+// record is filled in, but for the output bytes, if the memory debug mode is on
+static variable_list call_function(FunctionTask& task, BackwardMemoryRecord* record) {
   bool prev_checkpoint_valid_state = checkpoint_valid;
   checkpoint_valid = task.base->can_checkpoint() && prev_checkpoint_valid_state;
   auto& fn = *task.fn;
   auto inputs = call_pre_hooks(fn, InputBuffer::variables(std::move(task.inputs)));
+  if (record) {
+    record->name = fn.name();
+    record->device = std::max(worker_device, -1);
+    record->input_bytes = dense_bytes(inputs);
+  }
 
   if(!task.base->keep_graph) {
     fn.will_release_variables();
@@ -378,6 +448,20 @@ static variable_list call_function(FunctionTask& task) {
     outputs = fn(std::move(inputs));
   }
 
+  if (record) {
+    record->allocated_bytes = allocated_bytes(record->device);
+  }
+  // Nothing uses the saved variables once the function ran, so they are freed
+  // before its outputs are checked and passed to the post hooks and the next
+  // functions, lowering the peak memory of the backward pass
+  if (!task.base->keep_graph) {
+    fn.release_variables();
+  }
+  if (record) {
+    record->released_allocated_bytes =
+        record->allocated_bytes - allocated_bytes(record->device);
+  }
+
   validate_outputs(fn.next_edges(), outputs, [&](const std::string& msg) {
     std::ostringstream ss;
     ss << "Function "  << fn.name() << " returned an " << msg;
@@ -406,11 +490,30 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
     if (!fn_info.needed) return;
   }
 
-  auto outputs = call_function(task);
+  if (saved_variable_hooks_used()) {
+    // Let the functions that run next start bringing back their saved
+    // variables while this one runs
+    for (const auto& next : task.fn->next_edges()) {
+      if (!next.is_valid()) continue;
+      if (!exec_info.empty()) {
+        auto it = exec_info.find(next.function.get());
+        if (it == exec_info.end() || !it->second.should_execute()) continue;
+      }
+      next.function->prefetch_saved_variables();
+    }
+  }
+
+  std::unique_ptr<BackwardMemoryRecord> record;
+  if (memory_debug_.load()) {
+    record = torch::make_unique<BackwardMemoryRecord>();
+  }
+  auto outputs = call_function(task, record.get());
 
   auto& fn = *task.fn;
-  if (!task.base->keep_graph) {
-    fn.release_variables();
+  if (record) {
+    record->output_bytes = dense_bytes(outputs);
+    std::lock_guard<std::mutex> lock(memory_records_mutex_);
+    memory_records_.push_back(std::move(*record));
   }
 
   int num_outputs = outputs.size();
@@ -489,8 +592,10 @@ auto Engine::compute_dependencies(Function* root, GraphTask& task) -> void {
   // Queue contains all nodes that will start propagating gradients.
   // We no longer have to expand functions that don't require grad.
   auto& dependencies = task.dependencies;
+  bool has_priorities = false;
   while (!queue.empty()) {
     auto fn = queue.back(); queue.pop_back();
+    has_priorities |= fn->priority() != 0;
     for (const auto& edge : fn->next_edges()) {
       if (auto next_ptr = edge.function.get()) {
         dependencies[next_ptr] += 1;
@@ -499,6 +604,9 @@ auto Engine::compute_dependencies(Function* root, GraphTask& task) -> void {
       }
     }
   }
+  if (has_priorities) {
+    task.init_priorities(*root);
+  }
 }
 
 struct ClearCallbacks {
@@ -611,6 +719,34 @@ bool Engine::is_checkpoint_valid() {
   return checkpoint_valid;
 }
 
+void Engine::set_num_cpu_threads(int num_threads) {
+  AT_CHECK(num_threads > 0, "Expected a positive number of threads, got ", num_threads);
+  AT_CHECK(
+      !threads_started.load(),
+      "Cannot set the number of autograd CPU threads after the first "
+      "backward pass");
+  num_cpu_workers = num_threads;
+}
+
+int Engine::num_cpu_threads() const {
+  return num_cpu_workers;
+}
+
+void Engine::set_memory_debug(bool enabled) {
+  memory_debug_.store(enabled);
+}
+
+bool Engine::memory_debug() const {
+  return memory_debug_.load();
+}
+
+std::vector<BackwardMemoryRecord> Engine::take_memory_records() {
+  std::lock_guard<std::mutex> lock(memory_records_mutex_);
+  std::vector<BackwardMemoryRecord> records;
+  records.swap(memory_records_);
+  return records;
+}
+
 auto Engine::ready_queue(int device) -> ReadyQueue& {
   return *ready_queues.at(device + 1);
 }
@@ -624,17 +760,54 @@ auto Engine::start_threads() -> void {
     num_devices = 0;
   }
 #endif
-  // One for CPU, plus one for every GPU device
-  int num_threads = num_devices + 1;
-  ready_queues = std::vector<std::shared_ptr<ReadyQueue>>(num_threads);
+  threads_started = true;
+  // One queue for CPU, plus one for every GPU device
+  int num_queues = num_devices + 1;
+  ready_queues = std::vector<std::shared_ptr<ReadyQueue>>(num_queues);
   for (auto& queue : ready_queues)
     queue.reset(new ReadyQueue());
-  for (int i = 0; i < num_threads; ++i) {
+  // The CPU queue is shared by num_cpu_workers threads, every device queue
+  // has a single thread
+  for (int i = 0; i < num_cpu_workers; ++i) {
+    std::thread t(&Engine::thread_init, this, -1);
+    t.detach();
+  }
+  for (int i = 1; i < num_queues; ++i) {
     std::thread t(&Engine::thread_init, this, i - 1);
     t.detach();
   }
 }
 
+void GraphTask::init_priorities(Function& graph_root) {
+  // Visit the functions in topological order (every function after all the
+  // functions that depend on its outputs), then propagate priorities from
+  // the leaves up in reverse order.
+  auto remaining = dependencies;
+  std::vector<Function*> order;
+  std::vector<Function*> stack { &graph_root };
+  while (!stack.empty()) {
+    auto fn = stack.back(); stack.pop_back();
+    order.push_back(fn);
+    for (const auto& edge : fn->next_edges()) {
+      if (auto next_ptr = edge.function.get()) {
+        if (--remaining[next_ptr] == 0) stack.push_back(next_ptr);
+      }
+    }
+  }
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    auto fn = *it;
+    int64_t fn_priority = fn->priority();
+    for (const auto& edge : fn->next_edges()) {
+      if (auto next_ptr = edge.function.get()) {
+        fn_priority = std::max(fn_priority, priority(next_ptr));
+      }
+    }
+    if (fn_priority != 0) {
+      priorities[fn] = fn_priority;
+    }
+  }
+}
+
 void GraphTask::init_to_execute(Function& graph_root, const edge_list& outputs) {
   exec_info[&graph_root].needed = true;
 
@@ -8,10 +8,13 @@
 #include "torch/csrc/autograd/input_buffer.h"
 #include "torch/csrc/autograd/anomaly_mode.h"
 
+#include <atomic>
 #include <deque>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -23,6 +26,21 @@ struct GraphTask;
 }} // namespace torch::autograd
 
 namespace torch { namespace autograd {
+
+// A function run by a backward pass while the memory debug mode of the engine
+// is on. The bytes of the gradients it consumed and produced are those of
+// dense tensors. The bytes allocated on its device, once it ran and once its
+// saved variables were released (only when the graph is not retained), are
+// those of the CUDA caching allocator, and -1 for CPU functions.
+struct BackwardMemoryRecord {
+  std::string name;
+  int device; // -1 for the CPU
+  int64_t input_bytes;
+  int64_t output_bytes;
+  int64_t allocated_bytes;
+  int64_t released_allocated_bytes;
+};
+
 // A single instance of this struct should be created through the whole process lifetime.
 // The worker thread creation logic and Engine's destructor rely on this.
 struct TORCH_API Engine {
@@ -51,6 +69,20 @@ struct TORCH_API Engine {
 
   bool is_checkpoint_valid();
 
+  // Sets the number of worker threads that execute CPU functions. With more
+  // than one worker, independent branches of the backward graph run in
+  // parallel. Must be called before the first backward pass.
+  void set_num_cpu_threads(int num_threads);
+  int num_cpu_threads() const;
+
+  // Records a BackwardMemoryRecord for every function the following backward
+  // passes run, until it's turned off. Meant for finding the functions at
+  // which backward memory peaks, as it slows the backward pass down.
+  void set_memory_debug(bool enabled);
+  bool memory_debug() const;
+  // Returns the records of the functions run so far, and forgets them.
+  std::vector<BackwardMemoryRecord> take_memory_records();
+
 protected:
   void compute_dependencies(Function* root, GraphTask& task);
   void evaluate_function(FunctionTask& task);
@@ -61,9 +93,14 @@ protected:
   virtual void thread_on_exception(FunctionTask& task, std::exception& e);
 
   std::once_flag start_threads_flag;
+  std::atomic<bool> threads_started{false};
+  int num_cpu_workers = 1;
   std::vector<std::shared_ptr<ReadyQueue>> ready_queues;
   std::vector<std::function<void()>> final_callbacks;
   std::mutex post_callbacks_lock;
+  std::atomic<bool> memory_debug_{false};
+  std::vector<BackwardMemoryRecord> memory_records_;
+  std::mutex memory_records_mutex_;
 };
 
 // allow python_engine to override the default engine when it loads
@@ -87,9 +87,9 @@ void deleteFunction(Function* function);
 struct TORCH_API Function : std::enable_shared_from_this<Function> {
  public:
   /// Construct a new `Function` with `num_inputs` inputs and the given
-  /// `next_edges`. sequence_nr is a (currently THE) hint to prioritization
-  /// in the backward() pass, with higher sequence numbers prioritized
-  /// before lower sequence numbers.
+  /// `next_edges`. sequence_nr is a hint to prioritization in the backward()
+  /// pass, with higher sequence numbers prioritized before lower sequence
+  /// numbers among functions of the same `priority()`.
   explicit Function(
       uint64_t sequence_nr,
       edge_list&& next_edges = edge_list())
@@ -200,6 +200,21 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
     return sequence_nr_;
   }
 
+  /// The priority of this `Function` in the backward pass. Among the
+  /// functions that are ready to run, the engine executes those with a higher
+  /// priority first and orders the rest by sequence number. The engine
+  /// propagates the priority of a function to all functions its inputs depend
+  /// on, so setting it on an `AccumulateGrad` makes the gradient of that leaf
+  /// ready as early as possible. Defaults to 0, and must not be changed while
+  /// a backward pass runs through this function.
+  int64_t priority() const noexcept {
+    return priority_;
+  }
+
+  void set_priority(int64_t priority) noexcept {
+    priority_ = priority;
+  }
+
   /// Returns a shared pointer to `this`. `PyFunction`s are not managed by
   /// `shared_ptr`s by default, but are bound to the lifetime of their Python
   /// object instead.
@@ -278,6 +293,11 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
   /// Releases saved variables if the operation won't be reused.
   virtual void release_variables() {}
 
+  /// Starts bringing back saved variables that `SavedVariableHooks` moved
+  /// out of their original representation. Called by the engine ahead of
+  /// `apply()`.
+  virtual void prefetch_saved_variables() {}
+
   /// Called before an apply if `release_variables()` is going to be called.
   /// Allows larger ops like `InterpreterAutogradFunction` to incrementally
   /// release variables as they run.
@@ -317,6 +337,7 @@ struct TORCH_API Function : std::enable_shared_from_this<Function> {
   // Since `Function`s are neither copyable nor moveable, we can have const
   // fields.
   const uint64_t sequence_nr_;
+  int64_t priority_ = 0;
 
   edge_list next_edges_;
   PyObject* pyobj_ = nullptr; // weak reference
@@ -3,6 +3,8 @@
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/autograd/variable.h"
 
+#include <mutex>
+
 namespace torch { namespace autograd {
 
 struct AccumulateGrad : public Function {
@@ -11,6 +13,11 @@ struct AccumulateGrad : public Function {
   variable_list apply(variable_list&& grads) override;
 
   Variable variable;
+
+ private:
+  // apply() can be entered concurrently when graphs that share this leaf are
+  // executed at the same time by several CPU workers of the engine.
+  std::mutex mutex_;
 };
 
 }} // namespace torch::autograd
@@ -0,0 +1,207 @@
+#include <torch/csrc/autograd/functions/checkpoint.h>
+
+#include <torch/csrc/autograd/edge.h>
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/functions/utils.h>
+#include <torch/csrc/autograd/grad_mode.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAGuard.h>
+#include <THC/THC.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace autograd {
+
+struct CheckpointBackward::RNGState {
+  /// Saves the state of the CPU generator and of those of the CUDA devices.
+  static std::unique_ptr<RNGState> capture(std::vector<int64_t> cuda_devices);
+
+  /// Sets the generators back to the saved states.
+  void restore() const;
+
+  std::unique_ptr<at::Generator> cpu;
+#ifdef USE_CUDA
+  // The state of the generator of each device, as THCRandom_getRNGState
+  // returns them
+  std::vector<std::pair<int64_t, at::Tensor>> cuda;
+#endif
+  std::vector<int64_t> cuda_devices;
+};
+
+std::unique_ptr<CheckpointBackward::RNGState> CheckpointBackward::RNGState::
+    capture(std::vector<int64_t> cuda_devices) {
+  std::unique_ptr<RNGState> state(new RNGState);
+  state->cpu = at::CPU(at::kFloat).generator();
+  state->cpu->copy(at::globalContext().defaultGenerator(at::kCPU));
+#ifdef USE_CUDA
+  for (auto device : cuda_devices) {
+    at::cuda::CUDAGuard guard(device);
+    auto saved = at::empty({0}, at::kByte);
+    THCRandom_getRNGState(
+        at::globalContext().getTHCState(),
+        static_cast<THByteTensor*>(saved.unsafeGetTensorImpl()));
+    state->cuda.emplace_back(device, std::move(saved));
+  }
+#endif
+  state->cuda_devices = std::move(cuda_devices);
+  return state;
+}
+
+void CheckpointBackward::RNGState::restore() const {
+  at::globalContext().defaultGenerator(at::kCPU).copy(*cpu);
+#ifdef USE_CUDA
+  for (const auto& saved : cuda) {
+    at::cuda::CUDAGuard guard(saved.first);
+    THCRandom_setRNGState(
+        at::globalContext().getTHCState(),
+        static_cast<THByteTensor*>(saved.second.unsafeGetTensorImpl()));
+  }
+#endif
+}
+
+namespace {
+std::vector<int64_t> cuda_devices(const variable_list& inputs) {
+  std::vector<int64_t> devices;
+  for (const auto& input : inputs) {
+    if (input.defined() && input.is_cuda() &&
+        std::find(devices.begin(), devices.end(), input.get_device()) ==
+            devices.end()) {
+      devices.push_back(input.get_device());
+    }
+  }
+  return devices;
+}
+} // namespace
+
+variable_list checkpoint(
+    std::function<variable_list(const variable_list&)> function,
+    const variable_list& inputs,
+    bool preserve_rng_state) {
+  if (!GradMode::is_enabled()) {
+    return function(inputs);
+  }
+
+  std::unique_ptr<CheckpointBackward::RNGState> rng_state;
+  if (preserve_rng_state) {
+    rng_state = CheckpointBackward::RNGState::capture(cuda_devices(inputs));
+  }
+  variable_list outputs;
+  {
+    AutoGradMode no_grad(false);
+    outputs = function(inputs);
+  }
+  for (auto& output : outputs) {
+    if (output.defined()) {
+      output = output.detach();
+    }
+  }
+
+  auto grad_fn = std::make_shared<CheckpointBackward>(
+      std::move(function), inputs, std::move(rng_state));
+  grad_fn->set_next_edges(collect_next_edges(inputs));
+  set_history(outputs, grad_fn);
+  return outputs;
+}
+
+CheckpointBackward::CheckpointBackward(
+    std::function<variable_list(const variable_list&)> function,
+    const variable_list& inputs,
+    std::unique_ptr<RNGState> rng_state)
+    : function_(std::move(function)), rng_state_(std::move(rng_state)) {
+  inputs_.reserve(inputs.size());
+  inputs_require_grad_.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    inputs_.push_back(input.defined() ? input.detach() : Variable());
+    inputs_require_grad_.push_back(input.defined() && input.requires_grad());
+  }
+}
+
+CheckpointBackward::~CheckpointBackward() = default;
+
+variable_list CheckpointBackward::apply(variable_list&& grads) {
+  AT_CHECK(
+      !released_,
+      "Trying to backward through a checkpoint a second time, which it ",
+      "doesn't support");
+  AT_CHECK(
+      Engine::get_default_engine().is_checkpoint_valid(),
+      "Checkpointing is not compatible with autograd::grad(), please use ",
+      "backward() instead");
+
+  variable_list inputs;
+  inputs.reserve(inputs_.size());
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (inputs_[i].defined()) {
+      inputs.push_back(inputs_[i].detach());
+      inputs.back().set_requires_grad(inputs_require_grad_[i]);
+    } else {
+      inputs.emplace_back();
+    }
+  }
+  std::unique_ptr<RNGState> rng_state = std::move(rng_state_);
+  release_variables();
+
+  variable_list outputs;
+  {
+    // Runs the function with the random state of the forward pass, and puts
+    // the current one back afterwards
+    std::unique_ptr<RNGState> current;
+    if (rng_state) {
+      current = RNGState::capture(rng_state->cuda_devices);
+      rng_state->restore();
+    }
+    AutoGradMode enable_grad(true);
+    outputs = function_(inputs);
+    if (current) {
+      current->restore();
+    }
+  }
+  AT_CHECK(
+      outputs.size() == grads.size(),
+      "The function of a checkpoint returned ",
+      outputs.size(),
+      " outputs when run again, but ",
+      grads.size(),
+      " the first time");
+
+  edge_list roots;
+  variable_list root_grads;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (grads[i].defined() && outputs[i].defined() &&
+        outputs[i].requires_grad()) {
+      roots.push_back(outputs[i].gradient_edge());
+      root_grads.push_back(std::move(grads[i]));
+    }
+  }
+  if (!roots.empty()) {
+    Engine::get_default_engine().execute(
+        roots, root_grads, /*keep_graph=*/false, /*create_graph=*/false);
+  }
+
+  variable_list grad_inputs(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs_require_grad_[i] && inputs[i].grad().defined()) {
+      grad_inputs[i] = as_variable_ref(inputs[i].grad());
+    }
+  }
+  return grad_inputs;
+}
+
+void CheckpointBackward::release_variables() {
+  inputs_.clear();
+  released_ = true;
+}
+
+} // namespace autograd
+} // namespace torch
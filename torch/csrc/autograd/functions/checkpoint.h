@@ -0,0 +1,59 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace autograd {
+
+/// Runs `function` on `inputs` without recording the graph of its operations,
+/// so that none of its intermediate values are kept for the backward pass, and
+/// returns its outputs, connected to a `CheckpointBackward` node. The backward
+/// pass runs `function` again on the same inputs, with grad enabled, and
+/// backpropagates through it. This trades compute for memory, like
+/// `torch.utils.checkpoint` in Python.
+///
+/// With `preserve_rng_state`, the state of the CPU generator, and of the
+/// generators of the CUDA devices of the inputs, is saved before the forward
+/// pass and restored for the recomputation (and set back after it), so that
+/// random operations such as dropout draw the same numbers both times.
+///
+/// The gradients of the values `function` uses without taking them as inputs,
+/// such as the parameters of modules, are accumulated by the inner backward
+/// pass. The backward pass must be an imperative `backward()` rather than
+/// `autograd::grad()`, which could not accumulate them. Outputs are returned
+/// detached from `inputs`, even when `function` returns one of them as is.
+TORCH_API variable_list checkpoint(
+    std::function<variable_list(const variable_list&)> function,
+    const variable_list& inputs,
+    bool preserve_rng_state = true);
+
+/// The backward of `checkpoint()`.
+struct TORCH_API CheckpointBackward : public Function {
+  /// The states of the generators saved by `checkpoint()`.
+  struct RNGState;
+
+  CheckpointBackward(
+      std::function<variable_list(const variable_list&)> function,
+      const variable_list& inputs,
+      std::unique_ptr<RNGState> rng_state);
+  ~CheckpointBackward() override;
+
+  variable_list apply(variable_list&& grads) override;
+  void release_variables() override;
+
+  std::function<variable_list(const variable_list&)> function_;
+  // Detached from the graph, so that they don't hold on to it
+  variable_list inputs_;
+  std::vector<bool> inputs_require_grad_;
+  std::unique_ptr<RNGState> rng_state_;
+  bool released_ = false;
+};
+
+} // namespace autograd
+} // namespace torch
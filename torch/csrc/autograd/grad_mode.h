@@ -21,4 +21,27 @@ struct TORCH_API AutoGradMode {
   bool prev_mode;
 };
 
+// In inference mode, the factory functions of the C++ API (torch::ones,
+// torch::from_blob, ...) return plain tensors instead of Variables. Ops on
+// them dispatch straight to the ATen types, skipping VariableType, and return
+// plain tensors too, so that a model whose inputs and weights are plain
+// tensors runs without any autograd bookkeeping. Such tensors can't require
+// grad, and passing one to an op along with a Variable is an error.
+struct TORCH_API InferenceMode {
+  static bool is_enabled();
+  static void set_enabled(bool enabled);
+};
+
+// A RAII, thread local (!) guard that enables or disables inference mode upon
+// construction, and sets it back to the original value upon destruction.
+struct TORCH_API AutoInferenceMode {
+  AutoInferenceMode(bool enabled) : prev_mode(InferenceMode::is_enabled()) {
+    InferenceMode::set_enabled(enabled);
+  }
+  ~AutoInferenceMode() {
+    InferenceMode::set_enabled(prev_mode);
+  }
+  bool prev_mode;
+};
+
 }}
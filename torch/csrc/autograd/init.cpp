@@ -5,6 +5,7 @@
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/python_function.h"
+#include "torch/csrc/autograd/python_saved_variable_hooks.h"
 #include "torch/csrc/autograd/function.h"
 
 PyObject * THPAutograd_initExtension(PyObject *_unused)
@@ -31,18 +32,64 @@ PyObject * THPAutograd_initExtension(PyObject *_unused)
           "name",
           [](const torch::autograd::profiler::Event& e) { return e.name(); })
       .def("thread_id", &torch::autograd::profiler::Event::thread_id)
+      .def("request_id", &torch::autograd::profiler::Event::request_id)
       .def("device", &torch::autograd::profiler::Event::device)
       .def("cpu_elapsed_us", &torch::autograd::profiler::Event::cpu_elapsed_us)
       .def(
           "cuda_elapsed_us", &torch::autograd::profiler::Event::cuda_elapsed_us)
-      .def("has_cuda", &torch::autograd::profiler::Event::has_cuda);
+      .def("has_cuda", &torch::autograd::profiler::Event::has_cuda)
+      .def(
+          "input_shapes",
+          [](const torch::autograd::profiler::Event& e) {
+            if (!e.inputs()) {
+              return std::vector<std::vector<int64_t>>();
+            }
+            return e.inputs()->shapes;
+          })
+      .def(
+          "dtypes",
+          [](const torch::autograd::profiler::Event& e) {
+            std::vector<std::string> dtypes;
+            if (e.inputs()) {
+              for (auto dtype : e.inputs()->dtypes) {
+                dtypes.emplace_back(at::toString(dtype));
+              }
+            }
+            return dtypes;
+          })
+      .def(
+          "has_inputs",
+          [](const torch::autograd::profiler::Event& e) {
+            return e.inputs() != nullptr;
+          })
+      .def(
+          "flops",
+          [](const torch::autograd::profiler::Event& e) {
+            return e.inputs() ? e.inputs()->flops : 0;
+          })
+      .def("bytes", [](const torch::autograd::profiler::Event& e) {
+        return e.inputs() ? e.inputs()->bytes : 0;
+      });
   py::enum_<torch::autograd::profiler::ProfilerState>(m,"ProfilerState")
   .value("Disabled", torch::autograd::profiler::ProfilerState::Disabled)
   .value("CPU", torch::autograd::profiler::ProfilerState::CPU)
   .value("CUDA", torch::autograd::profiler::ProfilerState::CUDA)
   .value("NVTX", torch::autograd::profiler::ProfilerState::NVTX);
 
-  m.def("_enable_profiler", torch::autograd::profiler::enableProfiler);
+  py::class_<torch::autograd::profiler::ProfilerConfig>(m, "ProfilerConfig")
+      .def(py::init<
+           torch::autograd::profiler::ProfilerState,
+           int64_t,
+           size_t,
+           std::string,
+           bool>());
+
+  m.def("_enable_profiler", [](torch::autograd::profiler::ProfilerConfig config) {
+    torch::autograd::profiler::enableProfiler(std::move(config));
+  });
+  m.def("_enable_profiler", [](torch::autograd::profiler::ProfilerState state) {
+    torch::autograd::profiler::enableProfiler(state);
+  });
   m.def("_disable_profiler", torch::autograd::profiler::disableProfiler);
 
   m.def("_push_range", [](std::string name) {
@@ -95,12 +142,33 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * push_saved_tensors_hooks(PyObject* _unused, PyObject *args) {
+  HANDLE_TH_ERRORS
+  PyObject *pack_hook = nullptr, *unpack_hook = nullptr, *prefetch_hook = Py_None;
+  if (!PyArg_ParseTuple(args, "OO|O", &pack_hook, &unpack_hook, &prefetch_hook)) {
+    return nullptr;
+  }
+  push_saved_variable_hooks(
+      std::make_shared<PySavedVariableHooks>(pack_hook, unpack_hook, prefetch_hook));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * pop_saved_tensors_hooks(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  pop_saved_variable_hooks();
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = {
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"_push_saved_tensors_hooks", (PyCFunction)push_saved_tensors_hooks, METH_VARARGS, nullptr},
+  {"_pop_saved_tensors_hooks", (PyCFunction)pop_saved_tensors_hooks, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
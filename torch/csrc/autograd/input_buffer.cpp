@@ -1,6 +1,7 @@
 #include "torch/csrc/autograd/input_buffer.h"
 
 #include "torch/csrc/autograd/functions/basic_ops.h"
+#include "torch/csrc/autograd/grad_mode.h"
 
 #include <ATen/DeviceGuard.h>
 
@@ -11,6 +12,20 @@
 namespace torch { namespace autograd {
 
 
+// Whether old_var + var can be computed in old_var, without allocating: the
+// buffer must be the only holder of old_var and of its storage, as gradients
+// are often passed on unchanged or as views to several functions, and the sum
+// must not be differentiated.
+static bool can_accumulate_in_place(const Variable& old_var, const Variable& var) {
+  return !GradMode::is_enabled() &&
+      !old_var.is_sparse() && !var.is_sparse() &&
+      old_var.type() == var.type() &&
+      old_var.sizes() == var.sizes() &&
+      old_var.use_count() == 1 &&
+      old_var.data().use_count() == 1 &&
+      old_var.storage().use_count() == 1;
+}
+
 void InputBuffer::add(size_t pos, Variable var) {
   AT_ASSERT(pos < buffer.size());
   if (!var.defined()) {
@@ -22,7 +37,9 @@ void InputBuffer::add(size_t pos, Variable var) {
   } else {
     at::OptionalDeviceGuard device_guard(device_of(var));
     // ATen doesn't route sparse additions correctly...
-    if (old_var.is_sparse()) {
+    if (can_accumulate_in_place(old_var, var)) {
+      old_var.data().add_(var.data());
+    } else if (old_var.is_sparse()) {
       buffer[pos] = var + old_var;
     } else {
       buffer[pos] = old_var + var;
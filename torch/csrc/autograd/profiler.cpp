@@ -5,16 +5,141 @@
 #include "ATen/cuda/CUDAGuard.h"
 #endif
 
+#include <fstream>
+#include <iomanip>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace torch { namespace autograd { namespace profiler {
 
+// Writes events to a file in the Chrome trace format as they are flushed out
+// of the per-thread lists. Ranges are written as separate begin and end
+// events, so that they don't need to be matched first, and the file remains
+// loadable if the process dies before the profiler is disabled.
+//
+// Timestamps are those of the trace clock, c10::getTraceTimeNs(), rather than
+// relative to the start of the profile, so that the events of caffe2 net
+// traces, which are on the same clock, can be merged in.
+struct ChromeTraceWriter {
+  explicit ChromeTraceWriter(const std::string& path)
+    : out_(path) {
+    if (!out_) {
+      throw std::runtime_error("can't open " + path + " to write the profiler trace");
+    }
+    out_ << "[";
+    out_ << std::fixed << std::setprecision(3);
+  }
+
+  void write(const std::vector<Event>& events) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto & e : events) {
+      out_ << (first_ ? "\n" : ",\n");
+      first_ = false;
+      out_ << "{\"ph\": ";
+      switch (e.event_kind()) {
+        case EventKind::Mark: out_ << "\"i\", \"s\": \"t\""; break;
+        case EventKind::PushRange: out_ << "\"B\""; break;
+        case EventKind::PopRange: out_ << "\"E\""; break;
+      }
+      if (e.event_kind() != EventKind::PopRange) {
+        out_ << ", \"name\": \"";
+        writeEscaped(e.name());
+        out_ << "\"";
+      }
+      out_ << ", \"ts\": " << e.cpu_ns() / 1000.0
+           << ", \"pid\": \"CPU functions\", \"tid\": " << e.thread_id();
+      if (e.request_id() != 0 || e.inputs()) {
+        out_ << ", \"args\": {";
+        if (e.request_id() != 0) {
+          out_ << "\"request_id\": " << e.request_id()
+               << (e.inputs() ? ", " : "");
+        }
+        if (auto inputs = e.inputs()) {
+          writeInputs(*inputs);
+        }
+        out_ << "}";
+      }
+      out_ << "}";
+    }
+    out_.flush();
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    out_ << "\n]\n";
+    out_.close();
+  }
+
+private:
+  void writeInputs(const EventInputs& inputs) {
+    out_ << "\"Input dims\": [";
+    for (size_t i = 0; i < inputs.shapes.size(); i++) {
+      out_ << (i == 0 ? "[" : ", [");
+      for (size_t j = 0; j < inputs.shapes[i].size(); j++) {
+        out_ << (j == 0 ? "" : ", ") << inputs.shapes[i][j];
+      }
+      out_ << "]";
+    }
+    out_ << "], \"FLOPs\": " << inputs.flops << ", \"Bytes\": " << inputs.bytes;
+  }
+
+  void writeEscaped(const char* str) {
+    for (; *str; str++) {
+      char c = *str;
+      if (c == '"' || c == '\\') {
+        out_ << '\\' << c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        out_ << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+             << static_cast<int>(c) << std::dec << std::setfill(' ');
+      } else {
+        out_ << c;
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::ofstream out_;
+  bool first_ = true;
+};
+
 ProfilerState state = ProfilerState::Disabled;
+ProfilerConfig config(ProfilerState::Disabled);
+// incremented every time the profiler is enabled, to reset the thread local
+// state below lazily
+uint64_t session_id = 0;
+std::unique_ptr<ChromeTraceWriter> trace_writer;
 uint16_t next_thread_id = 0;
 std::mutex all_event_lists_mutex;
 std::list<std::shared_ptr<RangeEventList>> all_event_lists;
 thread_local std::shared_ptr<RangeEventList> event_list;
 thread_local uint16_t thread_id;
+thread_local uint64_t event_list_session = 0;
+
+std::mutex interned_strings_mutex;
+std::unordered_set<std::string> interned_strings;
+
+// State of the sampling of top-level ranges
+thread_local uint64_t range_session = 0;
+thread_local int64_t range_depth = 0;
+thread_local int64_t num_top_level_ranges = 0;
+thread_local bool range_sampled = true;
+
+const char* internString(const std::string& name) {
+  // a thread local cache keeps threads from contending on the global table
+  thread_local std::unordered_map<std::string, const char*> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  const char* interned;
+  {
+    std::lock_guard<std::mutex> guard(interned_strings_mutex);
+    interned = interned_strings.insert(name).first->c_str();
+  }
+  cache.emplace(name, interned);
+  return interned;
+}
 
 RangeEventList& getEventList() {
   if (!event_list) {
@@ -23,9 +148,49 @@ RangeEventList& getEventList() {
     thread_id = next_thread_id++;
     all_event_lists.emplace_front(event_list);
   }
+  if (event_list_session != session_id) {
+    event_list_session = session_id;
+    size_t capacity = config.max_events_per_thread;
+    if (!config.trace_path.empty() && capacity == 0) {
+      capacity = 16 * 1024;
+    }
+    event_list->setCapacity(capacity);
+  }
   return *event_list;
 }
 
+static void recordEvent(EventKind kind, const char* name, bool record_cuda,
+                        std::shared_ptr<const EventInputs> inputs = nullptr) {
+  auto & list = getEventList();
+  if (trace_writer && kind != EventKind::Mark && list.full()) {
+    trace_writer->write(list.consolidate());
+  }
+  list.record(kind, name, thread_id, record_cuda, std::move(inputs));
+}
+
+// Returns true if the range that is being opened should be recorded. All the
+// ranges nested in a top-level range share its sampling decision.
+static bool enterRange() {
+  if (range_session != session_id) {
+    range_session = session_id;
+    range_depth = 0;
+    num_top_level_ranges = 0;
+  }
+  if (range_depth++ == 0) {
+    range_sampled = num_top_level_ranges++ % config.sample_period == 0;
+  }
+  return range_sampled;
+}
+
+static bool exitRange() {
+  // ranges opened before the profiler was enabled are closed as they used to
+  if (range_session != session_id || range_depth == 0) {
+    return true;
+  }
+  range_depth--;
+  return range_sampled;
+}
+
 void mark(std::string name, bool include_cuda /* = true */) {
   if (state == ProfilerState::Disabled) {
     return;
@@ -38,10 +203,9 @@ void mark(std::string name, bool include_cuda /* = true */) {
         "mark called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(
+    recordEvent(
         EventKind::Mark,
-        std::move(name),
-        thread_id,
+        internString(name),
         include_cuda && state == ProfilerState::CUDA);
   }
 }
@@ -50,11 +214,12 @@ const char* c_str(const char *str) { return str; }
 // NB: non-const to disallow temporaries (lifetime issues)
 const char* c_str(std::string& str) { return str.c_str(); }
 
+const char* intern(const char *str) { return str; }
+const char* intern(const std::string& str) { return internString(str); }
+
 template<typename T>
-void pushRangeImpl(T name, const char* msg="", int64_t sequence_nr=-1) {
-  if (state == ProfilerState::Disabled) {
-    return;
-  }
+void pushRangeImpl(T name, const char* msg="", int64_t sequence_nr=-1,
+                   std::shared_ptr<const EventInputs> inputs=nullptr) {
   if (state == ProfilerState::NVTX) {
 #ifdef USE_CUDA
     if(sequence_nr >= 0) {
@@ -69,20 +234,23 @@ void pushRangeImpl(T name, const char* msg="", int64_t sequence_nr=-1) {
         "pushRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(
+    recordEvent(
         EventKind::PushRange,
-        std::move(name),
-        thread_id,
-        state == ProfilerState::CUDA);
+        intern(name),
+        state == ProfilerState::CUDA,
+        std::move(inputs));
   }
 }
 
 void pushRange(std::string name) {
+  if (state == ProfilerState::Disabled || !enterRange()) {
+    return;
+  }
   pushRangeImpl(std::move(name));
 }
 
 void popRange() {
-  if (state == ProfilerState::Disabled) {
+  if (state == ProfilerState::Disabled || !exitRange()) {
     return;
   }
   if (state == ProfilerState::NVTX) {
@@ -93,10 +261,9 @@ void popRange() {
         "popRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(
+    recordEvent(
         EventKind::PopRange,
         "",
-        thread_id,
         state == ProfilerState::CUDA);
   }
 }
@@ -108,22 +275,163 @@ RecordFunction::RecordFunction(Function* fn) {
   // because they route through the same C++ side class.
   // fn->name() ensures that nvtx annotations for custom function backward() methods
   // receive a relevant, demangled name.
+  // The sampling decision is made first, so that skipped functions don't pay
+  // for computing their names.
+  if (state == ProfilerState::Disabled || !enterRange()) {
+    return;
+  }
   pushRangeImpl(fn->name(), ", stashed seq=", fn->sequence_nr());
 }
 
 RecordFunction::RecordFunction(std::string name) {
+  if (state == ProfilerState::Disabled || !enterRange()) {
+    return;
+  }
   pushRangeImpl(std::move(name));
 }
 
 RecordFunction::RecordFunction(const char* name) {
+  if (state == ProfilerState::Disabled || !enterRange()) {
+    return;
+  }
   pushRangeImpl<const char*>(name);
 }
 
 RecordFunction::RecordFunction(const char* name, int64_t current_sequence_nr)
 {
+  if (state == ProfilerState::Disabled || !enterRange()) {
+    return;
+  }
   pushRangeImpl<const char*>(name, ", seq=", current_sequence_nr);
 }
 
+bool RecordFunction::enter() {
+  return state != ProfilerState::Disabled && enterRange();
+}
+
+bool RecordFunction::recordsShapes() {
+  return state != ProfilerState::NVTX && config.record_shapes;
+}
+
+void RecordFunction::push(const char* name, int64_t current_sequence_nr,
+                          std::shared_ptr<const EventInputs> inputs) {
+  pushRangeImpl<const char*>(name, ", seq=", current_sequence_nr, std::move(inputs));
+}
+
+static int64_t numel(const std::vector<int64_t>& shape) {
+  int64_t result = 1;
+  for (auto size : shape) {
+    result *= size;
+  }
+  return result;
+}
+
+// Cost of a (batched) matrix product of a and b, with the broadcasting rules
+// of matmul. 1-d operands are treated as vectors.
+static int64_t matmulFlops(const std::vector<int64_t>& a, const std::vector<int64_t>& b) {
+  if (a.empty() || b.empty()) {
+    return 0;
+  }
+  int64_t k = a.back();
+  int64_t n = a.size() >= 2 ? a[a.size() - 2] : 1;
+  int64_t m = b.size() >= 2 ? b.back() : 1;
+  int64_t batch = std::max(
+      a.size() > 2 ? numel(a) / (n * k) : 1,
+      b.size() > 2 ? numel(b) / (k * m) : 1);
+  return 2 * batch * n * m * k;
+}
+
+static bool isElementwise(const std::string& name) {
+  static const std::unordered_set<std::string> elementwise_ops = {
+    "abs", "add", "addcdiv", "addcmul", "ceil", "clamp", "cos", "div",
+    "elu", "eq", "exp", "floor", "ge", "gt", "hardtanh", "le", "leaky_relu",
+    "log", "lt", "mul", "ne", "neg", "pow", "reciprocal", "relu", "rsqrt",
+    "sigmoid", "sign", "sin", "sqrt", "sub", "tanh", "threshold", "where",
+  };
+  return elementwise_ops.count(name) > 0;
+}
+
+void estimateCost(
+    const char* name,
+    const std::vector<std::vector<int64_t>>& int_args,
+    EventInputs& inputs) {
+  const auto& shapes = inputs.shapes;
+  if (shapes.empty() || inputs.dtypes[0] == at::ScalarType::Undefined) {
+    return;
+  }
+  int64_t element_size = at::elementSize(inputs.dtypes[0]);
+  int64_t input_numel = 0;
+  for (auto & shape : shapes) {
+    input_numel += numel(shape);
+  }
+
+  std::string op = name;
+  // in-place and out= variants do the same work
+  if (op.size() > 4 && op.compare(op.size() - 4, 4, "_out") == 0) {
+    op.resize(op.size() - 4);
+  } else if (op.size() > 1 && op.back() == '_' && op[op.size() - 2] != '_') {
+    op.pop_back();
+  }
+
+  int64_t output_numel = 0;
+  if (op == "mm" || op == "bmm" || op == "matmul" || op == "mv" || op == "dot") {
+    if (shapes.size() != 2) return;
+    inputs.flops = matmulFlops(shapes[0], shapes[1]);
+    output_numel = inputs.flops / (2 * std::max<int64_t>(shapes[0].back(), 1));
+  } else if (op == "addmm" || op == "baddbmm" || op == "addmv" || op == "addbmm") {
+    if (shapes.size() != 3) return;
+    inputs.flops = matmulFlops(shapes[1], shapes[2]);
+    output_numel = numel(shapes[0]);
+    inputs.flops += 2 * output_numel;
+  } else if (op == "_convolution") {
+    // input, weight and bias, then stride, padding, dilation, transposed,
+    // output_padding and groups in int_args
+    if (shapes.size() < 2 || int_args.size() < 6) return;
+    const auto& input = shapes[0];
+    const auto& weight = shapes[1];
+    if (input.size() < 3 || input.size() != weight.size()) return;
+    size_t spatial_dims = input.size() - 2;
+    for (size_t i = 0; i < 3; i++) {
+      if (int_args[i].size() != spatial_dims) return;
+    }
+    const auto& stride = int_args[0];
+    const auto& padding = int_args[1];
+    const auto& dilation = int_args[2];
+    bool transposed = int_args[3][0];
+    int64_t groups = int_args[5][0];
+    int64_t kernel_numel = 1;
+    for (size_t d = 0; d < spatial_dims; d++) {
+      kernel_numel *= weight[d + 2];
+    }
+    // Every output of a convolution, or every input of a transposed one, is
+    // a dot product with a slice of the weight of size weight[1] * kernel.
+    if (!transposed) {
+      output_numel = input[0] * weight[0];
+      for (size_t d = 0; d < spatial_dims; d++) {
+        output_numel *= (input[d + 2] + 2 * padding[d] - dilation[d] * (weight[d + 2] - 1) - 1) / stride[d] + 1;
+      }
+      inputs.flops = 2 * output_numel * weight[1] * kernel_numel;
+    } else {
+      const auto& output_padding = int_args[4];
+      if (output_padding.size() != spatial_dims) return;
+      output_numel = input[0] * weight[1] * groups;
+      for (size_t d = 0; d < spatial_dims; d++) {
+        output_numel *= (input[d + 2] - 1) * stride[d] - 2 * padding[d] +
+            dilation[d] * (weight[d + 2] - 1) + output_padding[d] + 1;
+      }
+      inputs.flops = 2 * numel(input) * weight[1] * kernel_numel;
+    }
+  } else if (isElementwise(op)) {
+    for (auto & shape : shapes) {
+      output_numel = std::max(output_numel, numel(shape));
+    }
+    inputs.flops = output_numel;
+  } else {
+    return;
+  }
+  inputs.bytes = (input_numel + output_numel) * element_size;
+}
+
 #ifdef USE_CUDA
 static void onEachDevice(std::function<void(int)> op) {
   at::cuda::OptionalCUDAGuard device_guard;
@@ -136,7 +444,8 @@ static void onEachDevice(std::function<void(int)> op) {
 }
 #endif
 
-void enableProfiler(ProfilerState new_state) {
+void enableProfiler(ProfilerConfig new_config) {
+  ProfilerState new_state = new_config.state;
   AT_ASSERT(new_state != ProfilerState::Disabled);
 #ifndef USE_CUDA
   if (new_state == ProfilerState::NVTX)
@@ -145,6 +454,19 @@ void enableProfiler(ProfilerState new_state) {
   if (state != ProfilerState::Disabled && new_state != state) {
       throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
   }
+  if (new_config.sample_period < 1) {
+    throw std::runtime_error("profiler sample period must be positive");
+  }
+  if (!new_config.trace_path.empty() && new_state != ProfilerState::CPU) {
+    throw std::runtime_error("streaming a trace is only supported by the CPU profiler");
+  }
+  if (state == ProfilerState::Disabled) {
+    config = std::move(new_config);
+    session_id++;
+    if (!config.trace_path.empty()) {
+      trace_writer.reset(new ChromeTraceWriter(config.trace_path));
+    }
+  }
   state = new_state;
 
 #ifdef USE_CUDA
@@ -169,6 +491,10 @@ void enableProfiler(ProfilerState new_state) {
   mark("__start_profile", false);
 }
 
+void enableProfiler(ProfilerState new_state) {
+  enableProfiler(ProfilerConfig(new_state));
+}
+
 thread_event_lists disableProfiler() {
   if (state == ProfilerState::Disabled) {
     throw std::runtime_error("can't disable profiler when it's not running");
@@ -178,6 +504,14 @@ thread_event_lists disableProfiler() {
   state = ProfilerState::Disabled;
   if (old_state == ProfilerState::NVTX) {
     return thread_event_lists();
+  } else if (trace_writer) {
+    std::lock_guard<std::mutex> guard(all_event_lists_mutex);
+    for (auto & list : all_event_lists) {
+      trace_writer->write(list->consolidate());
+    }
+    trace_writer->close();
+    trace_writer.reset();
+    return thread_event_lists();
   } else {
     thread_event_lists result;
     std::lock_guard<std::mutex> guard(all_event_lists_mutex);
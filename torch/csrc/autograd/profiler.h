@@ -14,16 +14,15 @@
 #include <sstream>
 #include <forward_list>
 #include <tuple>
+#include <initializer_list>
 #include "ATen/ATen.h"
+#include "c10/util/TraceContext.h"
 #include "torch/csrc/WindowsTorchApiMacro.h"
 #include "torch/csrc/cuda/cuda_check.h"
 #ifdef USE_CUDA
 #include "ATen/cuda/CUDAContext.h"
 #include <cuda_runtime.h>
 #endif
-#ifndef _WIN32
-#include <ctime>
-#endif
 
 namespace torch { namespace autograd {
 
@@ -35,17 +34,10 @@ constexpr inline size_t ceilToMultiple(size_t a, size_t b) {
   return ((a + b - 1) / b) * b;
 }
 
+// The clock of the tracers of caffe2 nets too, so that their traces line up
+// with the ones of the profiler
 inline int64_t getTime() {
-#ifdef _WIN32
-  using namespace std::chrono;
-  using clock = std::conditional<high_resolution_clock::is_steady, high_resolution_clock, steady_clock>::type;
-  return duration_cast<nanoseconds>(clock::now().time_since_epoch()).count();
-#else
-  // clock_gettime is *much* faster than std::chrono implementation on Linux
-  struct timespec t{};
-  clock_gettime(CLOCK_MONOTONIC, &t);
-  return static_cast<int64_t>(t.tv_sec) * 1000000000 + static_cast<int64_t>(t.tv_nsec);
-#endif
+  return c10::getTraceTimeNs();
 }
 
 enum class EventKind : uint16_t {
@@ -54,14 +46,35 @@ enum class EventKind : uint16_t {
   PopRange
 };
 
+// Shapes and types of the tensor inputs of a function, and estimates of the
+// work it does, recorded when the profiler is enabled with record_shapes.
+// flops and bytes are only estimated for matrix products, convolutions and
+// element-wise functions, and are 0 for the others.
+struct EventInputs {
+  std::vector<std::vector<int64_t>> shapes;
+  std::vector<at::ScalarType> dtypes;
+  int64_t flops = 0;
+  // bytes read from the inputs and written to the outputs
+  int64_t bytes = 0;
+};
+
+// Fills in inputs.flops and inputs.bytes for the function called name.
+// int_args are the integer, integer list and boolean arguments of the
+// function, in order.
+TORCH_API void estimateCost(
+    const char* name,
+    const std::vector<std::vector<int64_t>>& int_args,
+    EventInputs& inputs);
+
 struct Event final {
-  Event(EventKind kind, std::string name, uint16_t thread_id, bool record_cuda)
-  : owned_name_(new std::string(std::move(name)))
-  , name_ptr_(owned_name_->c_str())
-  , kind_(kind)
-  , thread_id_(thread_id) { record(record_cuda); }
-  Event(EventKind kind, const char* name, uint16_t thread_id, bool record_cuda)
+  // Events only keep a pointer to their name, which must outlive the
+  // profiler session. Names that are not string literals are interned
+  // using internString().
+  Event(EventKind kind, const char* name, uint16_t thread_id, bool record_cuda,
+        std::shared_ptr<const EventInputs> inputs = nullptr)
   : name_ptr_(name)
+  , inputs_(std::move(inputs))
+  , request_id_(c10::TraceContext::current().request_id)
   , kind_(kind)
   , thread_id_(thread_id) { record(record_cuda); }
 
@@ -92,6 +105,21 @@ struct Event final {
   uint16_t thread_id() const {
     return thread_id_;
   }
+  EventKind event_kind() const {
+    return kind_;
+  }
+  int64_t cpu_ns() const {
+    return cpu_ns_;
+  }
+  // The request the thread was doing work for, 0 if none (see
+  // c10/util/TraceContext.h)
+  int64_t request_id() const {
+    return request_id_;
+  }
+  // nullptr unless the input shapes were recorded
+  const EventInputs* inputs() const {
+    return inputs_.get();
+  }
   double cpu_elapsed_us(const Event & e) {
     return (e.cpu_ns_ - cpu_ns_)/(1000.0);
   }
@@ -124,11 +152,9 @@ struct Event final {
   }
 private:
   int64_t cpu_ns_ = 0; // signed to allow for negative intervals, initialized for safety.
-  // std::string is a very large object (usually around 32B),
-  // and this field is used only for user-created ranges, so
-  // it's better to save on size of Events.
-  std::unique_ptr<std::string> owned_name_;
   const char * name_ptr_;
+  std::shared_ptr<const EventInputs> inputs_;
+  int64_t request_id_;
   EventKind kind_;
   uint16_t thread_id_;
   int device_ = -1;
@@ -139,7 +165,11 @@ private:
 
 // a linked-list of fixed sized vectors, to avoid
 // a std::vector resize from taking a large amount of time inside
-// a profiling  event
+// a profiling  event.
+//
+// When a capacity is set, range events are instead kept in a ring buffer of
+// that many events, overwriting the oldest ones once it is full. Marks are
+// always kept, because the start of the profile is read from them.
 struct RangeEventList {
   constexpr static size_t MB = 1024 * 1024;
   constexpr static size_t event_block_size = 16 * MB;
@@ -149,38 +179,88 @@ struct RangeEventList {
                 "num_block_elements is calculated incorrectly");
   using block_type = std::vector<Event>;
 
+  static void touchPages(block_type& block, size_t num_elements) {
+    // Materialize all pages in the new block to release jitter when recording events.
+    const char * const end_ptr = reinterpret_cast<char*>(block.data() + num_elements);
+    for (volatile const char * ptr = reinterpret_cast<char*>(block.data());
+         ptr < end_ptr; ptr += 4 * 1024) {
+      (*ptr);
+    }
+  }
+
   void allocBlock() {
     blocks.emplace_front();
     auto & new_block = blocks.front();
     new_block.reserve(num_block_elements);
-    // Materialize all pages in the new block to release jitter when recording events.
-    const char * const end_ptr = reinterpret_cast<char*>(new_block.data() + num_block_elements);
-    for (volatile const char * ptr = reinterpret_cast<char*>(new_block.data());
-         ptr < end_ptr; ptr += 4 * 1024) {
-      (*ptr);
+    touchPages(new_block, num_block_elements);
+  }
+
+  // 0 means unbounded. Drops the events recorded so far.
+  void setCapacity(size_t new_capacity) {
+    blocks.clear();
+    ring = block_type();
+    ring_next = 0;
+    capacity = new_capacity;
+    if (capacity > 0) {
+      ring.reserve(capacity);
+      touchPages(ring, capacity);
     }
   }
 
-  template<typename... Args>
-  void record(Args&&... args) {
+  // true if the next range event overwrites the oldest one
+  bool full() const {
+    return capacity > 0 && ring.size() == capacity;
+  }
+
+  void record(EventKind kind, const char* name, uint16_t thread_id, bool record_cuda,
+              std::shared_ptr<const EventInputs> inputs = nullptr) {
+    if (kind == EventKind::Mark) {
+      marks.emplace_back(kind, name, thread_id, record_cuda);
+      return;
+    }
+    if (capacity > 0) {
+      if (ring.size() < capacity) {
+        ring.emplace_back(kind, name, thread_id, record_cuda, std::move(inputs));
+      } else {
+        ring[ring_next] = Event(kind, name, thread_id, record_cuda, std::move(inputs));
+        ring_next = (ring_next + 1) % capacity;
+      }
+      return;
+    }
     if (blocks.empty() || blocks.front().size() == num_block_elements) {
       allocBlock();
     }
-    blocks.front().emplace_back(std::forward<Args>(args)...);
+    blocks.front().emplace_back(kind, name, thread_id, record_cuda, std::move(inputs));
   }
 
+  // Returns the marks, followed by the range events in the order they were
+  // recorded.
   std::vector<Event> consolidate() {
-    std::vector<Event> result;
+    std::vector<Event> result = std::move(marks);
+    marks.clear();
+    auto range_begin = result.size();
     for (auto & block : blocks) {
-      result.insert(result.begin(),
+      result.insert(result.begin() + range_begin,
                     std::make_move_iterator(block.begin()),
                     std::make_move_iterator(block.end()));
     }
     blocks.clear();
+    result.insert(result.end(),
+                  std::make_move_iterator(ring.begin() + ring_next),
+                  std::make_move_iterator(ring.end()));
+    result.insert(result.end(),
+                  std::make_move_iterator(ring.begin()),
+                  std::make_move_iterator(ring.begin() + ring_next));
+    ring.clear();
+    ring_next = 0;
     return result;
   }
 
   std::forward_list<block_type> blocks;
+  std::vector<Event> marks;
+  block_type ring;
+  size_t ring_next = 0;
+  size_t capacity = 0;
 };
 
 enum class ProfilerState {
@@ -190,11 +270,75 @@ enum class ProfilerState {
     NVTX,  // only emit NVTX markers
 };
 
+struct TORCH_API ProfilerConfig {
+  ProfilerConfig(
+      ProfilerState state,
+      int64_t sample_period = 1,
+      size_t max_events_per_thread = 0,
+      std::string trace_path = "",
+      bool record_shapes = false)
+      : state(state),
+        sample_period(sample_period),
+        max_events_per_thread(max_events_per_thread),
+        trace_path(std::move(trace_path)),
+        record_shapes(record_shapes) {}
+  ProfilerState state;
+  // Only one in every sample_period top-level ranges of each thread is
+  // recorded, together with all the ranges nested in it.
+  int64_t sample_period;
+  // If non-zero, each thread keeps at most this many range events, dropping
+  // the oldest ones. When streaming a trace, events are written out every
+  // time this many have been recorded instead.
+  size_t max_events_per_thread;
+  // If non-empty, events are streamed to this file in the Chrome trace
+  // format while profiling, and disableProfiler() returns no events.
+  std::string trace_path;
+  // Record the shapes of the inputs of the functions that pass them to
+  // RecordFunction, see EventInputs.
+  bool record_shapes;
+};
+
+// Returns a pointer to a copy of name that lives as long as the process.
+TORCH_API const char* internString(const std::string& name);
+
 TORCH_API RangeEventList& getEventList();
 TORCH_API void mark(std::string name, bool include_cuda = true);
 TORCH_API void pushRange(std::string name);
 TORCH_API void popRange();
 
+// Gathers the arguments of a function for EventInputs. Arguments other than
+// tensors, integers and booleans are ignored.
+struct InputsCollector {
+  void add(const at::Tensor& tensor) {
+    if (tensor.defined()) {
+      inputs->shapes.emplace_back(tensor.sizes().begin(), tensor.sizes().end());
+      inputs->dtypes.push_back(tensor.type().scalarType());
+    } else {
+      inputs->shapes.emplace_back();
+      inputs->dtypes.push_back(at::ScalarType::Undefined);
+    }
+  }
+  void add(at::TensorList tensors) {
+    for (auto & tensor : tensors) {
+      add(tensor);
+    }
+  }
+  void add(at::IntList values) {
+    int_args.emplace_back(values.begin(), values.end());
+  }
+  void add(int64_t value) {
+    int_args.push_back({value});
+  }
+  void add(bool value) {
+    int_args.push_back({value});
+  }
+  template <typename T>
+  void add(const T&) {}
+
+  std::shared_ptr<EventInputs> inputs = std::make_shared<EventInputs>();
+  std::vector<std::vector<int64_t>> int_args;
+};
+
 struct TORCH_API RecordFunction {
   explicit RecordFunction(Function* fn);
 
@@ -204,14 +348,39 @@ struct TORCH_API RecordFunction {
 
   explicit RecordFunction(const char* name, int64_t current_sequence_nr);
 
+  // Also records the shapes of the inputs when the profiler was enabled
+  // with record_shapes. The arguments are only looked at in that case.
+  template <typename... Args>
+  explicit RecordFunction(const char* name, int64_t current_sequence_nr, const Args&... args) {
+    if (!enter()) {
+      return;
+    }
+    std::shared_ptr<EventInputs> inputs;
+    if (recordsShapes()) {
+      InputsCollector collector;
+      (void)std::initializer_list<int>{(collector.add(args), 0)...};
+      estimateCost(name, collector.int_args, *collector.inputs);
+      inputs = std::move(collector.inputs);
+    }
+    push(name, current_sequence_nr, std::move(inputs));
+  }
+
   ~RecordFunction() {
     popRange();
   }
+
+private:
+  // Returns true if the range of this function should be recorded.
+  static bool enter();
+  static bool recordsShapes();
+  static void push(const char* name, int64_t current_sequence_nr,
+                   std::shared_ptr<const EventInputs> inputs);
 };
 
 using thread_event_lists = std::vector<std::vector<Event>>;
 // NOTE: changing profiler modes is **NOT THREAD SAFE**. You should ensure that
 // there no autograd functions are being executed when these function are used.
+TORCH_API void enableProfiler(ProfilerConfig config);
 TORCH_API void enableProfiler(ProfilerState new_state);
 TORCH_API thread_event_lists disableProfiler();
 
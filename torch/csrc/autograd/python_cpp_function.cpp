@@ -11,6 +11,7 @@
 #include "torch/csrc/autograd/python_hook.h"
 #include "torch/csrc/autograd/python_anomaly_mode.h"
 #include "torch/csrc/utils/auto_gil.h"
+#include "torch/csrc/utils/python_numbers.h"
 #include "torch/csrc/utils/python_strings.h"
 #include "torch/csrc/DynamicTypes.h"
 #include "torch/csrc/Exceptions.h"
@@ -134,6 +135,21 @@ PyObject* THPCppFunction_requires_grad(THPCppFunction* self) {
   Py_RETURN_TRUE;
 }
 
+PyObject* THPCppFunction_priority(THPCppFunction* self, void *_unused) {
+  return PyLong_FromLongLong(self->cdata->priority());
+}
+
+int THPCppFunction_set_priority(THPCppFunction* self, PyObject* value, void *_unused) {
+  HANDLE_TH_ERRORS
+  if (!value || !THPUtils_checkLong(value)) {
+    PyErr_SetString(PyExc_TypeError, "priority must be an int");
+    return -1;
+  }
+  self->cdata->set_priority(THPUtils_unpackLong(value));
+  return 0;
+  END_HANDLE_TH_ERRORS_RET(-1)
+}
+
 PyObject* THPCppFunction_register_hook_dict(PyObject* self, PyObject* _var)
 {
   if (!THPVariable_Check(_var)) {
@@ -79,8 +79,10 @@ static void _maybe_reinitialize_engine_after_fork() {
   // backwards threads hold a lock, we'll probably deadlock in the engine
   // destructor.
   if (_reinitialize_engine) {
+    int num_cpu_threads = engine.num_cpu_threads();
     engine.~PythonEngine();
     new (&engine) torch::autograd::python::PythonEngine();
+    engine.set_num_cpu_threads(num_cpu_threads);
     _reinitialize_engine = false;
   }
 }
@@ -211,6 +213,59 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_set_num_cpu_threads(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  _maybe_reinitialize_engine_after_fork();
+  THPUtils_assert(THPUtils_checkLong(arg), "set_num_cpu_threads expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  engine.set_num_cpu_threads(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_get_num_cpu_threads(PyObject *self) {
+  HANDLE_TH_ERRORS
+  return PyLong_FromLong(engine.num_cpu_threads());
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_set_memory_debug(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyBool_Check(arg), "set_memory_debug expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  engine.set_memory_debug(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_is_memory_debug(PyObject *self) {
+  HANDLE_TH_ERRORS
+  if (engine.memory_debug()) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+  END_HANDLE_TH_ERRORS
+}
+
+// Returns the memory records as a list of tuples (name, device, input_bytes,
+// output_bytes, allocated_bytes, released_allocated_bytes)
+PyObject* THPEngine_take_memory_records(PyObject *self) {
+  HANDLE_TH_ERRORS
+  auto records = engine.take_memory_records();
+  THPObjectPtr list(PyList_New(records.size()));
+  if (!list) throw python_error();
+  for (size_t i = 0; i < records.size(); i++) {
+    const auto& record = records[i];
+    PyObject* tuple = Py_BuildValue("(siLLLL)", record.name.c_str(), record.device,
+        (long long)record.input_bytes, (long long)record.output_bytes,
+        (long long)record.allocated_bytes, (long long)record.released_allocated_bytes);
+    if (!tuple) throw python_error();
+    PyList_SET_ITEM(list.get(), i, tuple);
+  }
+  return list.release();
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -220,6 +275,11 @@ static struct PyMethodDef THPEngine_methods[] = {
   {(char*)"run_backward", (PyCFunction)THPEngine_run_backward, METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", (PyCFunction)THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", (PyCFunction)THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"set_num_cpu_threads", (PyCFunction)THPEngine_set_num_cpu_threads, METH_O, nullptr},
+  {(char*)"get_num_cpu_threads", (PyCFunction)THPEngine_get_num_cpu_threads, METH_NOARGS, nullptr},
+  {(char*)"set_memory_debug", (PyCFunction)THPEngine_set_memory_debug, METH_O, nullptr},
+  {(char*)"is_memory_debug", (PyCFunction)THPEngine_is_memory_debug, METH_NOARGS, nullptr},
+  {(char*)"take_memory_records", (PyCFunction)THPEngine_take_memory_records, METH_NOARGS, nullptr},
   {nullptr}
 };
 
@@ -214,6 +214,14 @@ auto PyFunction::release_variables() -> void {
   f->has_freed_buffers = 1;
 }
 
+auto PyFunction::prefetch_saved_variables() -> void {
+  AutoGIL gil;
+  auto f = (THPFunction*) obj;
+  for (const auto& saved_var : f->saved_variables) {
+    saved_var.prefetch();
+  }
+}
+
 auto PyFunction::name() const -> std::string {
   AutoGIL gil;
   auto f = (THPFunction*) obj;
@@ -956,6 +964,23 @@ PyObject *THPFunction_metadata(THPFunction *self, void *_unused)
   return metadata;
 }
 
+PyObject *THPFunction_priority(THPFunction *self, void *_unused)
+{
+  return PyLong_FromLongLong(self->cdata.priority());
+}
+
+int THPFunction_set_priority(THPFunction *self, PyObject *value, void *_unused)
+{
+  HANDLE_TH_ERRORS
+  if (!value || !THPUtils_checkLong(value)) {
+    PyErr_SetString(PyExc_TypeError, "priority must be an int");
+    return -1;
+  }
+  self->cdata.set_priority(THPUtils_unpackLong(value));
+  return 0;
+  END_HANDLE_TH_ERRORS_RET(-1)
+}
+
 typedef PyObject *(*getter)(PyObject *, void *);
 typedef int (*setter)(PyObject *, PyObject *, void *);
 
@@ -1012,6 +1037,7 @@ static struct PyGetSetDef THPFunction_properties[] = {
   {"needs_input_grad", &getObject<&THPFunction::needs_input_grad>, nullptr, nullptr, nullptr},
   {"requires_grad", getRequiresGrad, nullptr, nullptr, nullptr},
   {"metadata", (getter)THPFunction_metadata, nullptr, nullptr, nullptr},
+  {"priority", (getter)THPFunction_priority, (setter)THPFunction_set_priority, nullptr, nullptr},
   {nullptr}
 };
 
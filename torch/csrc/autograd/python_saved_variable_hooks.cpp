@@ -0,0 +1,103 @@
+#include "torch/csrc/autograd/python_saved_variable_hooks.h"
+
+#include "torch/csrc/Exceptions.h"
+#include "torch/csrc/autograd/python_variable.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/utils/auto_gil.h"
+#include "torch/csrc/utils/object_ptr.h"
+
+#include <c10/util/Exception.h>
+
+#include <vector>
+
+namespace torch { namespace autograd {
+
+namespace {
+
+struct PyPackedTensor : public PackedTensor {
+  PyPackedTensor(PyObject* packed, PyObject* unpack_hook, PyObject* prefetch_hook)
+    : packed_(packed)
+    , unpack_hook_(unpack_hook)
+    , prefetch_hook_(prefetch_hook) {
+    Py_INCREF(unpack_hook_);
+    Py_XINCREF(prefetch_hook_);
+  }
+
+  ~PyPackedTensor() override {
+    AutoGIL gil;
+    Py_DECREF(packed_);
+    Py_DECREF(unpack_hook_);
+    Py_XDECREF(prefetch_hook_);
+  }
+
+  void prefetch() override {
+    if (!prefetch_hook_) return;
+    AutoGIL gil;
+    THPObjectPtr res(PyObject_CallFunctionObjArgs(prefetch_hook_, packed_, nullptr));
+    if (!res) throw python_error();
+  }
+
+  at::Tensor unpack() override {
+    AutoGIL gil;
+    THPObjectPtr res(PyObject_CallFunctionObjArgs(unpack_hook_, packed_, nullptr));
+    if (!res) throw python_error();
+    if (!THPVariable_Check(res.get())) {
+      throw TypeError("unpack_hook of saved tensors hooks must return a Tensor "
+                      "(got %s)", Py_TYPE(res.get())->tp_name);
+    }
+    return ((THPVariable*)res.get())->cdata.data();
+  }
+
+ private:
+  // owned references
+  PyObject* packed_;
+  PyObject* unpack_hook_;
+  PyObject* prefetch_hook_;
+};
+
+thread_local std::vector<std::shared_ptr<SavedVariableHooks>> previous_hooks;
+
+} // namespace
+
+PySavedVariableHooks::PySavedVariableHooks(
+    PyObject* pack_hook, PyObject* unpack_hook, PyObject* prefetch_hook)
+  : pack_hook_(pack_hook)
+  , unpack_hook_(unpack_hook)
+  , prefetch_hook_(prefetch_hook == Py_None ? nullptr : prefetch_hook) {
+  Py_INCREF(pack_hook_);
+  Py_INCREF(unpack_hook_);
+  Py_XINCREF(prefetch_hook_);
+}
+
+PySavedVariableHooks::~PySavedVariableHooks() {
+  AutoGIL gil;
+  Py_DECREF(pack_hook_);
+  Py_DECREF(unpack_hook_);
+  Py_XDECREF(prefetch_hook_);
+}
+
+std::unique_ptr<PackedTensor> PySavedVariableHooks::pack(const at::Tensor& data) {
+  AutoGIL gil;
+  THPObjectPtr var(THPVariable_Wrap(make_variable(data, /*requires_grad=*/false)));
+  if (!var) throw python_error();
+  THPObjectPtr packed(PyObject_CallFunctionObjArgs(pack_hook_, var.get(), nullptr));
+  if (!packed) throw python_error();
+  if (packed.get() == Py_None) {
+    return nullptr;
+  }
+  return std::unique_ptr<PackedTensor>(
+      new PyPackedTensor(packed.release(), unpack_hook_, prefetch_hook_));
+}
+
+void push_saved_variable_hooks(std::shared_ptr<SavedVariableHooks> hooks) {
+  previous_hooks.push_back(get_saved_variable_hooks());
+  set_saved_variable_hooks(std::move(hooks));
+}
+
+void pop_saved_variable_hooks() {
+  AT_CHECK(!previous_hooks.empty(), "no saved tensors hooks to pop");
+  set_saved_variable_hooks(std::move(previous_hooks.back()));
+  previous_hooks.pop_back();
+}
+
+}} // namespace torch::autograd
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "torch/csrc/autograd/saved_variable.h"
+#include "torch/csrc/python_headers.h"
+
+namespace torch { namespace autograd {
+
+// SavedVariableHooks that call Python functions:
+//
+//   pack_hook(tensor) -> packed   (None to save the tensor as is)
+//   unpack_hook(packed) -> tensor
+//   prefetch_hook(packed)         (optional)
+struct PySavedVariableHooks : public SavedVariableHooks {
+  PySavedVariableHooks(PyObject* pack_hook, PyObject* unpack_hook, PyObject* prefetch_hook);
+  ~PySavedVariableHooks() override;
+
+  std::unique_ptr<PackedTensor> pack(const at::Tensor& data) override;
+
+ private:
+  PyObject* pack_hook_;
+  PyObject* unpack_hook_;
+  PyObject* prefetch_hook_;
+};
+
+// Installs hooks for the calling thread, saving the ones currently
+// installed; pop restores them.
+void push_saved_variable_hooks(std::shared_ptr<SavedVariableHooks> hooks);
+void pop_saved_variable_hooks();
+
+}} // namespace torch::autograd
@@ -6,12 +6,31 @@
 
 #include <ATen/Tensor.h>
 
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
 
 namespace torch { namespace autograd {
 
+static thread_local std::shared_ptr<SavedVariableHooks> saved_variable_hooks;
+static std::atomic<bool> saved_variable_hooks_were_used(false);
+
+void set_saved_variable_hooks(std::shared_ptr<SavedVariableHooks> hooks) {
+  if (hooks) {
+    saved_variable_hooks_were_used = true;
+  }
+  saved_variable_hooks = std::move(hooks);
+}
+
+std::shared_ptr<SavedVariableHooks> get_saved_variable_hooks() {
+  return saved_variable_hooks;
+}
+
+bool saved_variable_hooks_used() {
+  return saved_variable_hooks_were_used.load(std::memory_order_relaxed);
+}
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
   if (variable.defined()) {
     was_default_constructed_ = false;
@@ -21,6 +40,21 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
     // These copies are all shared_ptr copies, so slightly more expensive.
     // Do them here instead of in the init list in case data is undefined.
     data_ = variable.data();
+    if (saved_variable_hooks) {
+      // Uninstall the hooks while packing, so that tensors saved by pack()
+      // itself are kept as they are.
+      auto hooks = std::move(saved_variable_hooks);
+      try {
+        packed_ = hooks->pack(data_);
+      } catch (...) {
+        saved_variable_hooks = std::move(hooks);
+        throw;
+      }
+      saved_variable_hooks = std::move(hooks);
+      if (packed_) {
+        data_.reset();
+      }
+    }
     if (variable.is_leaf()) {
       grad_accumulator_ = variable.grad_accumulator();
     } else if (!is_output) {
@@ -32,7 +66,7 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output) {
 }
 
 Variable SavedVariable::unpack(std::shared_ptr<Function> saved_for) const {
-  if (!data_.defined()) {
+  if (!data_.defined() && !packed_) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
@@ -58,11 +92,12 @@ Variable SavedVariable::unpack(std::shared_ptr<Function> saved_for) const {
   // NB: saved views are unpacked as normal Variables (not views) even though
   // they still share the same storage. This works only because we never call
   // in-place functions on unpacked variables.
+  auto data = packed_ ? packed_->unpack() : data_;
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   var.set_version_counter(saved_version_);
 
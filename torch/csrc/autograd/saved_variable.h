@@ -16,6 +16,43 @@ struct Function;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
+/// A tensor saved for backward in a representation chosen by
+/// `SavedVariableHooks::pack()`, e.g. a copy in host memory or a compressed
+/// version of it.
+struct TORCH_API PackedTensor {
+  virtual ~PackedTensor() = default;
+
+  /// Starts converting the tensor back ahead of its use, e.g. with an
+  /// asynchronous copy on a side stream. The engine calls this shortly before
+  /// the function that saved the tensor runs. It may be called more than
+  /// once, and concurrently from several threads.
+  virtual void prefetch() {}
+
+  /// Returns the saved tensor. May be called more than once if the graph is
+  /// retained.
+  virtual at::Tensor unpack() = 0;
+};
+
+/// Hooks that change how tensors saved for backward are stored, to offload,
+/// compress or recompute activations. Hooks are installed per thread and
+/// apply to all `SavedVariable`s created on that thread while installed.
+struct TORCH_API SavedVariableHooks {
+  virtual ~SavedVariableHooks() = default;
+
+  /// Returns the packed representation of `data` (the tensor underlying the
+  /// saved Variable, which `PackedTensor::unpack()` must also return), or
+  /// nullptr to save `data` as is. Tensors saved by operations inside pack()
+  /// are never packed.
+  virtual std::unique_ptr<PackedTensor> pack(const at::Tensor& data) = 0;
+};
+
+/// Installs `hooks` (or removes them, if nullptr) for the calling thread.
+TORCH_API void set_saved_variable_hooks(std::shared_ptr<SavedVariableHooks> hooks);
+TORCH_API std::shared_ptr<SavedVariableHooks> get_saved_variable_hooks();
+/// True if hooks were ever installed, so the engine can skip prefetching
+/// otherwise.
+TORCH_API bool saved_variable_hooks_used();
+
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
 class TORCH_API SavedVariable {
@@ -30,7 +67,15 @@ class TORCH_API SavedVariable {
   /// circular reference.
   Variable unpack(std::shared_ptr<Function> saved_for = nullptr) const;
 
+  /// Starts converting the data back, if it was packed by hooks.
+  void prefetch() const {
+    if (packed_) {
+      packed_->prefetch();
+    }
+  }
+
   void reset_data() {
+    packed_.reset();
     return data_.reset();
   }
 
@@ -40,6 +85,8 @@ class TORCH_API SavedVariable {
 
  private:
   at::Tensor data_;
+  // Set instead of data_ if the data was packed by SavedVariableHooks.
+  std::unique_ptr<PackedTensor> packed_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
@@ -2,13 +2,16 @@
 
 #include <stdbool.h>
 #include <unordered_map>
+#include <memory>
 #include <thread>
 #include <chrono>
 #include <sstream>
 #include <TH/TH.h>
 #include <ATen/ATen.h>
 #include "ATen/cuda/CUDAContext.h"
+#include <THC/THCAllocator.h>
 #include <THC/THCCachingAllocator.h>
+#include <THC/THCCachingHostAllocator.h>
 #ifdef USE_NCCL
 #include <nccl.h>
 #endif
@@ -244,6 +247,7 @@ PyObject * THCPModule_emptyCache(PyObject *_unused)
 {
   HANDLE_TH_ERRORS
   THCCachingAllocator_emptyCache();
+  THCIpcCloseUnusedMemHandles();
   END_HANDLE_TH_ERRORS
   Py_RETURN_NONE;
 }
@@ -315,6 +319,129 @@ static void bindCudaDeviceProperties(PyObject* module) {
   }, py::return_value_policy::reference);
 }
 
+static void bindCachingAllocatorStats(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  m.def("_cuda_memoryStats", [](int device) {
+    THCCachingAllocatorStats stats = THCCachingAllocator_getStats(device);
+    py::dict result;
+    result["allocated_bytes"] = stats.amount_allocated;
+    result["max_allocated_bytes"] = stats.max_amount_allocated;
+    result["cached_bytes"] = stats.amount_cached;
+    result["max_cached_bytes"] = stats.max_amount_cached;
+    result["num_allocs"] = stats.num_allocs;
+    result["num_frees"] = stats.num_frees;
+    result["num_cuda_mallocs"] = stats.num_cuda_mallocs;
+    result["num_cuda_frees"] = stats.num_cuda_frees;
+    result["num_alloc_retries"] = stats.num_alloc_retries;
+    result["num_splits"] = stats.num_splits;
+    result["num_merges"] = stats.num_merges;
+    result["size_histogram"] = std::vector<uint64_t>(
+        stats.size_histogram,
+        stats.size_histogram + THC_CACHING_ALLOCATOR_NUM_SIZE_CLASSES);
+    return result;
+  });
+  m.def("_cuda_memorySnapshot", []() {
+    py::list result;
+    for (const auto& segment : THCCachingAllocator_snapshot()) {
+      py::list blocks;
+      for (const auto& block : segment.blocks) {
+        py::dict block_dict;
+        block_dict["size"] = block.size;
+        block_dict["state"] = block.allocated ? "allocated"
+            : (block.pending_free ? "pending_free" : "free");
+        blocks.append(block_dict);
+      }
+      py::dict segment_dict;
+      segment_dict["device"] = segment.device;
+      segment_dict["pool_id"] = segment.pool_id;
+      segment_dict["address"] = segment.address;
+      segment_dict["total_size"] = segment.total_size;
+      segment_dict["allocated_size"] = segment.allocated_size;
+      segment_dict["stream"] = (uintptr_t)segment.stream;
+      segment_dict["blocks"] = blocks;
+      result.append(segment_dict);
+    }
+    return result;
+  });
+  m.def("_cuda_hostMemoryStats", []() {
+    THCCachingHostAllocatorStats stats = THCCachingHostAllocator_getStats();
+    py::dict result;
+    result["num_hits"] = stats.num_hits;
+    result["num_misses"] = stats.num_misses;
+    result["allocated_bytes"] = stats.amount_allocated;
+    result["cached_bytes"] = stats.amount_cached;
+    result["registered_bytes"] = stats.amount_registered;
+    return result;
+  });
+  m.def("_cuda_reserveHostMemory", [](size_t size, size_t count) {
+    // cudaHostAlloc is slow; let other Python threads run meanwhile
+    py::gil_scoped_release no_gil;
+    THCudaCheck(THCCachingHostAllocator_reserve(size, count));
+  });
+  m.def("_cuda_hostRegister", [](uintptr_t ptr, size_t size) {
+    THCudaCheck(THCCachingHostAllocator_registerHostBuffer((void*)ptr, size));
+  });
+  m.def("_cuda_hostUnregister", [](uintptr_t ptr) {
+    THCudaCheck(THCCachingHostAllocator_unregisterHostBuffer((void*)ptr));
+  });
+  m.def("_cuda_setMemoryTraceCapacity", [](size_t capacity, bool record_backtraces) {
+    THCCachingAllocator_setTraceCapacity(capacity, record_backtraces);
+  });
+  m.def("_cuda_memoryTrace", []() {
+    static const char* action_names[] = {
+        "alloc", "free", "segment_alloc", "segment_free"};
+    auto backtraces = THCCachingAllocator_getTraceBacktraces();
+    py::list result;
+    for (const auto& entry : THCCachingAllocator_getTrace()) {
+      py::dict entry_dict;
+      entry_dict["action"] = action_names[entry.action];
+      entry_dict["device"] = entry.device;
+      entry_dict["ptr"] = entry.ptr;
+      entry_dict["size"] = entry.size;
+      entry_dict["stream"] = (uintptr_t)entry.stream;
+      if (entry.backtrace_id >= 0 && (size_t)entry.backtrace_id < backtraces.size()) {
+        entry_dict["backtrace"] = backtraces[entry.backtrace_id];
+      } else {
+        entry_dict["backtrace"] = py::none();
+      }
+      result.append(entry_dict);
+    }
+    return result;
+  });
+}
+
+// Routes the allocations of the current thread to a private pool within a
+// `with` block, through THCCachingAllocatorPoolGuard.
+struct PyCachingAllocatorPoolGuard {
+  explicit PyCachingAllocatorPoolGuard(uint64_t pool_id) : pool_id(pool_id) {}
+  uint64_t pool_id;
+  std::unique_ptr<THCCachingAllocatorPoolGuard> guard;
+};
+
+static void bindCachingAllocatorPools(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  m.def("_cuda_newPoolId", []() {
+    return THCCachingAllocator_newPoolId();
+  });
+  m.def("_cuda_setStreamPool", [](uintptr_t stream, uint64_t pool_id) {
+    THCCachingAllocator_setStreamPool((THCStream*)stream, pool_id);
+  });
+  m.def("_cuda_getThreadPool", []() {
+    return THCCachingAllocator_getThreadPool();
+  });
+  m.def("_cuda_releasePool", [](uint64_t pool_id) {
+    THCCachingAllocator_releasePool(pool_id);
+  });
+  py::class_<PyCachingAllocatorPoolGuard>(m, "_CudaPoolGuard")
+    .def(py::init<uint64_t>())
+    .def("__enter__", [](PyCachingAllocatorPoolGuard& self) {
+      self.guard.reset(new THCCachingAllocatorPoolGuard(self.pool_id));
+    })
+    .def("__exit__", [](PyCachingAllocatorPoolGuard& self, py::args) {
+      self.guard.reset();
+    });
+}
+
 // Callback for python part. Used for additional initialization of python classes
 static PyObject * THCPModule_initExtension(PyObject *self)
 {
@@ -356,6 +483,8 @@ static PyObject * THCPModule_initExtension(PyObject *self)
   set_module_attr("_state_cdata", _state_cdata.get());
 
   bindCudaDeviceProperties(m);
+  bindCachingAllocatorStats(m);
+  bindCachingAllocatorPools(m);
 
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
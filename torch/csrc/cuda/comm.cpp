@@ -12,10 +12,14 @@
 #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/CUDAGuard.h>
+#include <c10/cuda/CUDAFunctions.h>
 #include "c10/util/Optional.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/variable.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace torch { namespace cuda {
@@ -160,6 +164,118 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, size_t bu
   return outputs;
 }
 
+Tensor reduce_add(TensorList tensors, c10::optional<int64_t> destination) {
+  AT_CHECK(!tensors.empty(), "reduce_add expects at least one tensor");
+  const int64_t device = destination ? *destination : c10::cuda::current_device();
+  const auto sizes = tensors[0].sizes();
+  int64_t root = -1;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = tensors[i];
+    AT_CHECK(tensor.is_cuda(), "reduce_add expects all inputs to be on GPUs");
+    AT_CHECK(tensor.sizes() == sizes, "input ", i, " has invalid size: got ",
+             tensor.sizes(), ", but expected ", sizes);
+    if (tensor.get_device() == device) {
+      root = i;
+    }
+  }
+  AT_CHECK(root != -1, "reduce_add expects destination to be on the same GPU "
+           "with one of the tensors");
+
+  AutoGradMode grad_mode(false);
+  at::cuda::CUDAGuard device_guard(device);
+  if (tensors.size() == 1) {
+    return tensors[0].clone();
+  }
+#ifdef USE_NCCL
+  if (nccl::is_available(tensors)) {
+    std::vector<Tensor> outputs;
+    outputs.reserve(tensors.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      device_guard.set_index(tensors[i].get_device());
+      outputs.push_back(at::empty_like(tensors[i]));
+    }
+    nccl::reduce(tensors.vec(), outputs, root);
+    return outputs[root];
+  }
+#endif
+  // Sums the tensors pairwise in a tree rooted at the destination, so that the
+  // copies of a level, which go between different pairs of devices, can run
+  // at the same time.
+  std::vector<Tensor> partial_sums = tensors.vec();
+  std::swap(partial_sums[0], partial_sums[root]);
+  for (size_t stride = 1; stride < partial_sums.size(); stride *= 2) {
+    for (size_t i = 0; i + stride < partial_sums.size(); i += 2 * stride) {
+      auto& lhs = partial_sums[i];
+      device_guard.set_index(lhs.get_device());
+      lhs = lhs + partial_sums[i + stride].to(lhs.device(), /*non_blocking=*/true);
+    }
+  }
+  return partial_sums[0];
+}
+
+std::vector<Tensor> reduce_add_coalesced(const tensor_list2d& inputs,
+                                         c10::optional<int64_t> destination,
+                                         size_t buffer_size) {
+  AT_CHECK(!inputs.empty(), "reduce_add_coalesced expects at least one list of tensors");
+  const size_t num_tensors = inputs[0].size();
+  for (const auto& device_inputs : inputs) {
+    AT_CHECK(device_inputs.size() == num_tensors,
+             "reduce_add_coalesced expects as many tensors on each device");
+  }
+#ifdef USE_NCCL
+  buffer_size = std::min(torch::cuda::nccl::get_max_count(), buffer_size);
+#endif
+
+  std::vector<Tensor> outputs;
+  outputs.reserve(num_tensors);
+  // the order of the outputs, as a tensor of the same type as each
+  std::vector<Tensor> order;
+  order.reserve(num_tensors);
+  // sparse tensors may have different sizes on each device, so they are summed
+  // one by one, the dense ones are bucketed
+  tensor_list2d dense(inputs.size());
+  std::vector<Tensor> column(inputs.size());
+  for (size_t t = 0; t < num_tensors; ++t) {
+    bool all_sparse = true;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      column[i] = inputs[i][t];
+      all_sparse = all_sparse && column[i].is_sparse();
+    }
+    if (all_sparse) {
+      outputs.push_back(reduce_add(column, destination));
+      order.push_back(column[0]);
+    } else {
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        dense[i].push_back(column[i].is_sparse() ? column[i].to_dense() : column[i]);
+      }
+      order.push_back(dense[0].back());
+    }
+  }
+
+  std::vector<std::vector<utils::TensorGroup>> buckets;
+  buckets.reserve(inputs.size());
+  for (const auto& device_dense : dense) {
+    buckets.push_back(utils::take_tensors(device_dense, buffer_size));
+  }
+  std::vector<Tensor> flat(inputs.size());
+  for (size_t b = 0; b < buckets[0].size(); ++b) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      AT_ASSERT(b < buckets[i].size());
+      flat[i] = utils::flatten_dense_tensors(buckets[i][b].tensors);
+    }
+    const auto flat_sum = reduce_add(flat, destination);
+    for (auto& t : utils::unflatten_dense_tensors(flat_sum, buckets[0][b].tensors)) {
+      // See NOTE [ Version Counter in comm.*_coalesced ]
+      AT_ASSERT(t.is_variable());
+      Variable var = t;
+      outputs.push_back(make_variable(var.data(), false));
+    }
+  }
+
+  utils::reorder_tensors_like(outputs, order);
+  return outputs;
+}
+
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntList devices,
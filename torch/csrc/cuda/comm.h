@@ -17,6 +17,17 @@ std::vector<at::Tensor> broadcast(const at::Tensor& tensor, at::IntList devices)
 tensor_list2d broadcast_coalesced(at::TensorList tensors, at::IntList devices,
                                   size_t buffer_size);
 
+// Sums the tensors, which all have the same size and are on different
+// devices, into a tensor on `destination` (default: the current device), which
+// must be the device of one of them.
+at::Tensor reduce_add(at::TensorList tensors, c10::optional<int64_t> destination = c10::nullopt);
+// Sums the lists of tensors, one list per device, element by element, and
+// returns the sums on `destination`. Dense tensors are summed in flat buckets
+// of up to `buffer_size` bytes.
+std::vector<at::Tensor> reduce_add_coalesced(const tensor_list2d& inputs,
+                                             c10::optional<int64_t> destination,
+                                             size_t buffer_size);
+
 std::vector<at::Tensor> scatter(
     const at::Tensor& tensor,
     at::IntList devices,
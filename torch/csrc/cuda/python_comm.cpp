@@ -32,6 +32,26 @@ void initCommMethods(PyObject *module) {
             return broadcast(tensor, devices);
           },
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_reduce_add",
+          [](std::vector<at::Tensor>& tensors,
+             c10::optional<int64_t> destination) {
+            return reduce_add(tensors, destination);
+          },
+          py::arg("tensors"),
+          py::arg("destination"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_reduce_add_coalesced",
+          [](std::vector<std::vector<at::Tensor>>& inputs,
+             c10::optional<int64_t> destination,
+             size_t buffer_size) {
+            return reduce_add_coalesced(inputs, destination, buffer_size);
+          },
+          py::arg("inputs"),
+          py::arg("destination"),
+          py::arg("buffer_size"),
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "_scatter",
           [](at::Tensor& tensor,
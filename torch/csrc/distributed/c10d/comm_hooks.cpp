@@ -0,0 +1,234 @@
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace c10d {
+namespace {
+
+// Waits for the given collectives and then runs `finish`, which writes the
+// result back into the gradients (and may run more collectives itself).
+class CompletionWork : public ProcessGroup::Work {
+ public:
+  CompletionWork(
+      std::vector<std::shared_ptr<ProcessGroup::Work>> work,
+      std::function<void()> finish)
+      : work_(std::move(work)), finish_(std::move(finish)) {}
+
+  bool isCompleted() override {
+    if (finished_) {
+      return true;
+    }
+    for (auto& work : work_) {
+      if (!work->isCompleted()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool isSuccess() const override {
+    if (eptr_) {
+      return false;
+    }
+    for (const auto& work : work_) {
+      if (!work->isSuccess()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void synchronize() override {
+    for (auto& work : work_) {
+      work->synchronize();
+    }
+    complete();
+  }
+
+  bool wait() override {
+    for (auto& work : work_) {
+      if (!work->wait()) {
+        return false;
+      }
+    }
+    complete();
+    return !eptr_;
+  }
+
+  const std::exception& exception() const override {
+    if (eptr_) {
+      std::rethrow_exception(eptr_);
+    }
+    for (const auto& work : work_) {
+      if (!work->isSuccess()) {
+        return work->exception();
+      }
+    }
+    throw std::runtime_error("no exception");
+  }
+
+ private:
+  void complete() {
+    if (finished_) {
+      return;
+    }
+    finished_ = true;
+    try {
+      finish_();
+    } catch (...) {
+      eptr_ = std::current_exception();
+    }
+  }
+
+  std::vector<std::shared_ptr<ProcessGroup::Work>> work_;
+  std::function<void()> finish_;
+  bool finished_ = false;
+  std::exception_ptr eptr_;
+};
+
+void waitOrThrow(ProcessGroup::Work& work) {
+  if (!work.wait()) {
+    throw std::runtime_error(
+        std::string("collective in communication hook failed: ") +
+        work.exception().what());
+  }
+}
+
+// Orthonormalizes the columns of a (rows x rank) matrix in place
+// (Gram-Schmidt). The rank is small, so this is cheap compared to the
+// matrix products around it.
+void orthogonalize(at::Tensor& matrix) {
+  for (int64_t i = 0; i < matrix.size(1); ++i) {
+    auto col = matrix.select(1, i);
+    for (int64_t j = 0; j < i; ++j) {
+      auto prev = matrix.select(1, j);
+      col.sub_(prev * col.dot(prev));
+    }
+    col.div_(col.norm().add_(1e-8));
+  }
+}
+
+} // namespace
+
+CommHook::~CommHook() {}
+
+std::shared_ptr<ProcessGroup::Work> FP16CompressionHook::run(
+    ProcessGroup& processGroup,
+    size_t /* bucket */,
+    at::Tensor& grads) {
+  std::vector<at::Tensor> compressed = {grads.to(at::kHalf)};
+  auto work = processGroup.allreduce(compressed);
+  return std::make_shared<CompletionWork>(
+      std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+      [grads, compressed]() mutable { grads.copy_(compressed[0]); });
+}
+
+TopKCompressionHook::TopKCompressionHook(double ratio) : ratio_(ratio) {
+  if (ratio <= 0 || ratio > 1) {
+    throw std::invalid_argument("top-k ratio must be in (0, 1]");
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> TopKCompressionHook::run(
+    ProcessGroup& processGroup,
+    size_t bucket,
+    at::Tensor& grads) {
+  const auto numel = grads.numel();
+  const auto k = std::max<int64_t>(1, std::lround(numel * ratio_));
+
+  at::Tensor indices;
+  at::Tensor accumulated = grads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& residual = residuals_[bucket];
+    if (residual.defined() && residual.numel() == numel) {
+      accumulated = grads + residual;
+    }
+    indices = std::get<1>(accumulated.abs().topk(k, 0, true, false));
+    residual = accumulated.clone().index_fill_(0, indices, 0);
+  }
+
+  const auto size = processGroup.getSize();
+  std::vector<at::Tensor> values = {accumulated.take(indices)};
+  std::vector<at::Tensor> localIndices = {indices};
+  std::vector<std::vector<at::Tensor>> allValues(1);
+  std::vector<std::vector<at::Tensor>> allIndices(1);
+  for (int i = 0; i < size; ++i) {
+    allValues[0].push_back(at::empty_like(values[0]));
+    allIndices[0].push_back(at::empty_like(indices));
+  }
+  auto valuesWork = processGroup.allgather(allValues, values);
+  auto indicesWork = processGroup.allgather(allIndices, localIndices);
+  return std::make_shared<CompletionWork>(
+      std::vector<std::shared_ptr<ProcessGroup::Work>>{valuesWork,
+                                                       indicesWork},
+      [grads, values, localIndices, allValues, allIndices]() mutable {
+        grads.zero_();
+        for (size_t i = 0; i < allValues[0].size(); ++i) {
+          grads.index_add_(0, allIndices[0][i], allValues[0][i]);
+        }
+      });
+}
+
+PowerSGDHook::PowerSGDHook(int64_t rank) : rank_(rank) {
+  if (rank <= 0) {
+    throw std::invalid_argument("PowerSGD rank must be positive");
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> PowerSGDHook::run(
+    ProcessGroup& processGroup,
+    size_t bucket,
+    at::Tensor& grads) {
+  const auto numel = grads.numel();
+  const auto cols = static_cast<int64_t>(std::ceil(std::sqrt(numel)));
+  const auto rows = (numel + cols - 1) / cols;
+  const auto rank = std::min(rank_, std::min(rows, cols));
+
+  // Note: the state of a bucket is only used by one iteration at a time,
+  //  only the map needs to be locked
+  State* state;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state = &states_[bucket];
+  }
+  auto matrix = at::zeros({rows * cols}, grads.options());
+  matrix.narrow(0, 0, numel).copy_(grads);
+  matrix = matrix.view({rows, cols});
+  if (state->residual.defined() &&
+      state->residual.sizes().equals(matrix.sizes())) {
+    matrix.add_(state->residual);
+  }
+  if (!state->q.defined() || !state->q.sizes().equals({cols, rank})) {
+    // Every process must start from the same Q, so it is not random
+    state->q = at::arange(cols * rank, grads.options())
+                   .mul_(0.7)
+                   .sin_()
+                   .view({cols, rank});
+    orthogonalize(state->q);
+  }
+
+  std::vector<at::Tensor> p = {matrix.mm(state->q)};
+  auto pWork = processGroup.allreduce(p);
+  return std::make_shared<CompletionWork>(
+      std::vector<std::shared_ptr<ProcessGroup::Work>>{pWork},
+      [&processGroup, grads, matrix, p, state, numel]() mutable {
+        orthogonalize(p[0]);
+        std::vector<at::Tensor> q = {matrix.t().mm(p[0])};
+        waitOrThrow(*processGroup.allreduce(q));
+        auto approx = p[0].mm(q[0].t());
+        state->residual = matrix - approx;
+        state->q = q[0];
+        grads.copy_(approx.view({-1}).narrow(0, 0, numel));
+      });
+}
+
+} // namespace c10d
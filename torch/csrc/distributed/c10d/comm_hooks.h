@@ -0,0 +1,91 @@
+#pragma once
+
+#include <c10d/ProcessGroup.hpp>
+
+#include <ATen/ATen.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace c10d {
+
+// A communication hook replaces the allreduce of a bucket of gradients in
+// queueReduction, e.g. to compress the bucket before it is sent over the
+// network and decompress it afterwards.
+//
+// run() is called with the flat (and already averaged) gradients of a
+// bucket, on the worker stream used for the reduction. It returns a Work
+// whose wait() leaves the reduced gradients in `grads`; wait() is called by
+// syncReduction, again on a worker stream.
+//
+// Hooks may keep state across iterations for every bucket (e.g. the error
+// feedback of lossy compression), so the same hook must not be shared by
+// models with different buckets.
+class CommHook {
+ public:
+  virtual ~CommHook();
+
+  virtual std::shared_ptr<ProcessGroup::Work> run(
+      ProcessGroup& processGroup,
+      size_t bucket,
+      at::Tensor& grads) = 0;
+};
+
+// Sends the gradients as fp16, halving the traffic.
+class FP16CompressionHook : public CommHook {
+ public:
+  std::shared_ptr<ProcessGroup::Work> run(
+      ProcessGroup& processGroup,
+      size_t bucket,
+      at::Tensor& grads) override;
+};
+
+// Sends only the largest `ratio` of the gradients (by magnitude), with their
+// indices, and zeros the rest. What isn't sent is remembered and added to the
+// gradients of the next iteration (error feedback).
+class TopKCompressionHook : public CommHook {
+ public:
+  explicit TopKCompressionHook(double ratio);
+
+  std::shared_ptr<ProcessGroup::Work> run(
+      ProcessGroup& processGroup,
+      size_t bucket,
+      at::Tensor& grads) override;
+
+ private:
+  const double ratio_;
+  std::mutex mutex_;
+  std::unordered_map<size_t, at::Tensor> residuals_;
+};
+
+// PowerSGD-style low-rank compression: every bucket is viewed as a (padded)
+// matrix M, and only M Q (rows x rank) and M^T P (cols x rank) are
+// allreduced, where Q is warm-started from the previous iteration. The
+// approximation error is fed back into the next iteration.
+//
+// Note: the second allreduce depends on the result of the first one, so it
+//  is only issued when the Work is waited on.
+class PowerSGDHook : public CommHook {
+ public:
+  explicit PowerSGDHook(int64_t rank);
+
+  std::shared_ptr<ProcessGroup::Work> run(
+      ProcessGroup& processGroup,
+      size_t bucket,
+      at::Tensor& grads) override;
+
+ private:
+  struct State {
+    at::Tensor q;
+    at::Tensor residual;
+  };
+
+  const int64_t rank_;
+  std::mutex mutex_;
+  std::unordered_map<size_t, State> states_;
+};
+
+} // namespace c10d
@@ -128,7 +128,9 @@ void syncParams(
 std::tuple<std::shared_ptr<ProcessGroup::Work>, at::Tensor> queueReduction(
     ProcessGroup& processGroup,
     std::vector<std::vector<at::Tensor>>& gradsBatch,
-    const std::vector<int64_t>& devices) {
+    const std::vector<int64_t>& devices,
+    const std::shared_ptr<CommHook>& commHook,
+    size_t bucket) {
   AT_ASSERT(!gradsBatch.empty());
   AT_ASSERT(!devices.empty());
 
@@ -165,8 +167,14 @@ std::tuple<std::shared_ptr<ProcessGroup::Work>, at::Tensor> queueReduction(
 
   gradsBatchCoalesced[0] /= processGroup.getSize();
 
-  std::vector<at::Tensor> allreduceInput = {gradsBatchCoalesced[0]};
-  auto reductionWork = processGroup.allreduce(allreduceInput);
+  std::shared_ptr<ProcessGroup::Work> reductionWork;
+  if (commHook) {
+    // Runs on the worker stream, like the allreduce would
+    reductionWork = commHook->run(processGroup, bucket, gradsBatchCoalesced[0]);
+  } else {
+    std::vector<at::Tensor> allreduceInput = {gradsBatchCoalesced[0]};
+    reductionWork = processGroup.allreduce(allreduceInput);
+  }
 
   return std::make_tuple(reductionWork, gradsBatchCoalesced[0]);
 }
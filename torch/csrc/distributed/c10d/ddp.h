@@ -1,6 +1,7 @@
 #pragma once
 
 #include <c10d/ProcessGroup.hpp>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
 
 #include <ATen/ATen.h>
 #include "c10/util/Optional.h"
@@ -31,10 +32,14 @@ void syncParams(
     int64_t broadcastBucketSize,
     bool broadcastBuffers);
 
+// If commHook is given, it replaces the allreduce of the coalesced gradients
+// of the bucket (see CommHook).
 std::tuple<std::shared_ptr<ProcessGroup::Work>, at::Tensor> queueReduction(
     ProcessGroup& processGroup,
     std::vector<std::vector<at::Tensor>>& gradsBatch,
-    const std::vector<int64_t>& devices);
+    const std::vector<int64_t>& devices,
+    const std::shared_ptr<CommHook>& commHook = nullptr,
+    size_t bucket = 0);
 
 void syncReduction(
     std::shared_ptr<ProcessGroup::Work>& reductionWork,
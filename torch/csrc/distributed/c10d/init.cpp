@@ -1,8 +1,11 @@
 #include <torch/csrc/python_headers.h>
 
+#include <sstream>
+
 #include <c10d/FileStore.hpp>
 #include <c10d/ProcessGroup.hpp>
 #include <c10d/ProcessGroupGloo.hpp>
+#include <c10d/ProcessGroupHierarchical.hpp>
 
 #ifdef USE_C10D_NCCL
 #include <c10d/ProcessGroupNCCL.hpp>
@@ -50,6 +53,14 @@ PyObject* c10d_init(PyObject* _unused) {
       .def(py::init<>())
       .def_readwrite("reduceOp", &::c10d::AllreduceOptions::reduceOp);
 
+  py::class_<::c10d::AllreduceCoalescedOptions>(
+      module, "AllreduceCoalescedOptions")
+      .def(py::init<>())
+      .def_readwrite(
+          "reduceOp", &::c10d::AllreduceCoalescedOptions::reduceOp)
+      .def_readwrite(
+          "bucketSize", &::c10d::AllreduceCoalescedOptions::bucketSize);
+
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class of available reduce operations: ``SUM``, ``PRODUCT``,
 ``MIN``, and ``MAX``.
@@ -68,6 +79,13 @@ They are used in specifying strategies for reduction collectives, e.g.,
       .def_readwrite("rootRank", &::c10d::ReduceOptions::rootRank)
       .def_readwrite("rootTensor", &::c10d::ReduceOptions::rootTensor);
 
+  py::class_<::c10d::ReduceScatterOptions>(module, "ReduceScatterOptions")
+      .def(py::init<>())
+      .def_readwrite("reduceOp", &::c10d::ReduceScatterOptions::reduceOp);
+
+  py::class_<::c10d::AllToAllOptions>(module, "AllToAllOptions")
+      .def(py::init<>());
+
   py::class_<::c10d::ScatterOptions>(module, "ScatterOptions")
       .def(py::init<>())
       .def_readwrite("rootRank", &::c10d::ScatterOptions::rootRank);
@@ -102,6 +120,52 @@ They are used in specifying strategies for reduction collectives, e.g.,
               "add",
               &::c10d::Store::add,
               py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          // py::bytes must be created with the GIL held
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                std::vector<py::bytes> result;
+                result.reserve(values.size());
+                for (auto& value : values) {
+                  result.emplace_back(
+                      reinterpret_cast<char*>(value.data()), value.size());
+                }
+                return result;
+              })
+          .def(
+              "compare_set",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& expected,
+                 const std::string& desired) -> py::bytes {
+                std::vector<uint8_t> expected_(expected.begin(), expected.end());
+                std::vector<uint8_t> desired_(desired.begin(), desired.end());
+                std::vector<uint8_t> value;
+                {
+                  py::gil_scoped_release release;
+                  value = store.compareSet(key, expected_, desired_);
+                }
+                return py::bytes(
+                    reinterpret_cast<char*>(value.data()), value.size());
+              })
           .def(
               "set_timeout",
               &::c10d::Store::setTimeout,
@@ -177,6 +241,13 @@ They are used in specifying strategies for reduction collectives, e.g.,
               py::arg("op") = ::c10d::ReduceOp::SUM,
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "allreduce_coalesced",
+              &::c10d::ProcessGroup::allreduceCoalesced,
+              py::arg("tensors"),
+              py::arg("opts") = ::c10d::AllreduceCoalescedOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "reduce",
               &::c10d::ProcessGroup::reduce,
@@ -217,6 +288,41 @@ They are used in specifying strategies for reduction collectives, e.g.,
               py::arg("tensor"),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "reduce_scatter",
+              &::c10d::ProcessGroup::reduceScatter,
+              py::arg("output_tensors"),
+              py::arg("input_tensors"),
+              py::arg("opts") = ::c10d::ReduceScatterOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "reduce_scatter",
+              [](::c10d::ProcessGroup& pg,
+                 at::Tensor& output,
+                 std::vector<at::Tensor>& input,
+                 ::c10d::ReduceOp op) {
+                ::c10d::ReduceScatterOptions opts;
+                opts.reduceOp = op;
+                std::vector<at::Tensor> outputs = {output};
+                std::vector<std::vector<at::Tensor>> inputs = {input};
+                return pg.reduceScatter(outputs, inputs, opts);
+              },
+              py::arg("output_tensor"),
+              py::arg("input_tensors"),
+              py::arg("op") = ::c10d::ReduceOp::SUM,
+              py::call_guard<py::gil_scoped_release>())
+
+          .def(
+              "alltoall",
+              &::c10d::ProcessGroup::alltoall,
+              py::arg("output_tensor"),
+              py::arg("input_tensor"),
+              py::arg("output_split_sizes") = std::vector<int64_t>(),
+              py::arg("input_split_sizes") = std::vector<int64_t>(),
+              py::arg("opts") = ::c10d::AllToAllOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "gather",
               &::c10d::ProcessGroup::gather,
@@ -356,13 +462,25 @@ They are used in specifying strategies for reduction collectives, e.g.,
                       int size,
                       std::chrono::milliseconds timeout) {
             ::c10d::ProcessGroupGloo::Options options;
-            ::gloo::transport::tcp::attr attr;
             // First step, check "GLOO_SOCKET_IFNAME" environmental variable
-            // that can be set by the user
+            // that can be set by the user. It may name several interfaces,
+            // separated by commas, to use a device (and a context) for each.
             char* ifnameEnv = getenv(GLOO_SOCKET_IFNAME_ENV);
             if (ifnameEnv) {
-              attr.iface = std::string(ifnameEnv);
-            } else {
+              std::stringstream ifnames(ifnameEnv);
+              std::string ifname;
+              while (std::getline(ifnames, ifname, ',')) {
+                if (ifname.empty()) {
+                  continue;
+                }
+                ::gloo::transport::tcp::attr attr;
+                attr.iface = ifname;
+                options.devices.push_back(
+                    ::gloo::transport::tcp::CreateDevice(attr));
+              }
+            }
+            if (options.devices.empty()) {
+              ::gloo::transport::tcp::attr attr;
               // Use the hostname to resolve the network address to
               // use. Note: if the hostname does not resolve to an address (e.g.
               // because of misconfigured /etc/hosts file), this will not work.
@@ -372,9 +490,9 @@ They are used in specifying strategies for reduction collectives, e.g.,
                 throw std::system_error(errno, std::system_category());
               }
               attr.hostname = hostname.data();
+              options.devices.push_back(
+                  ::gloo::transport::tcp::CreateDevice(attr));
             }
-            options.devices.push_back(
-                ::gloo::transport::tcp::CreateDevice(attr));
             options.timeout = timeout;
             return std::make_shared<::c10d::ProcessGroupGloo>(
                 store, rank, size, options);
@@ -387,7 +505,16 @@ They are used in specifying strategies for reduction collectives, e.g.,
 #ifdef USE_C10D_NCCL
   shared_ptr_class_<::c10d::ProcessGroupNCCL>(
       module, "ProcessGroupNCCL", processGroup)
-      .def(py::init<const std::shared_ptr<::c10d::Store>&, int, int>());
+      .def(
+          py::init<
+              const std::shared_ptr<::c10d::Store>&,
+              int,
+              int,
+              const std::chrono::milliseconds&>(),
+          py::arg("store"),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("timeout") = ::c10d::ProcessGroupNCCL::kNoTimeout);
 #endif
 
 #ifdef USE_C10D_MPI
@@ -398,6 +525,15 @@ They are used in specifying strategies for reduction collectives, e.g.,
       }));
 #endif
 
+  shared_ptr_class_<::c10d::ProcessGroupHierarchical>(
+      module, "ProcessGroupHierarchical", processGroup)
+      .def(
+          py::init<
+              std::shared_ptr<::c10d::ProcessGroup>,
+              std::shared_ptr<::c10d::ProcessGroup>>(),
+          py::arg("intra_node"),
+          py::arg("inter_node"));
+
   shared_ptr_class_<::c10d::ProcessGroup::Work>(module, "Work")
       .def("is_completed", &::c10d::ProcessGroup::Work::isCompleted)
       .def("is_success", &::c10d::ProcessGroup::Work::isSuccess)
@@ -409,6 +545,25 @@ They are used in specifying strategies for reduction collectives, e.g.,
           py::call_guard<py::gil_scoped_release>());
 
 #ifdef USE_CUDA
+  auto commHook = shared_ptr_class_<::c10d::CommHook>(module, "CommHook", R"(
+A communication hook for :class:`~torch.nn.parallel.DistributedDataParallel`,
+which replaces the allreduce of every bucket of gradients (e.g. to compress
+it). Hooks keep state for every bucket, so they must not be shared between
+models.
+)");
+
+  shared_ptr_class_<::c10d::FP16CompressionHook>(
+      module, "FP16CompressionHook", commHook)
+      .def(py::init<>());
+
+  shared_ptr_class_<::c10d::TopKCompressionHook>(
+      module, "TopKCompressionHook", commHook)
+      .def(py::init<double>(), py::arg("ratio"));
+
+  shared_ptr_class_<::c10d::PowerSGDHook>(
+      module, "PowerSGDHook", commHook)
+      .def(py::init<int64_t>(), py::arg("rank"));
+
   module.def(
       "_dist_bucket_tensors",
       &::c10d::bucketTensors,
@@ -443,6 +598,8 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("process_group"),
       py::arg("grads_batch"),
       py::arg("devices"),
+      py::arg("comm_hook") = nullptr,
+      py::arg("bucket") = 0,
       py::call_guard<py::gil_scoped_release>());
 
   module.def(
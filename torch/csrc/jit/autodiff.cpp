@@ -9,6 +9,7 @@
 #include <torch/csrc/jit/assertions.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 
 namespace torch { namespace jit {
@@ -622,6 +623,144 @@ static void liftConstants(Gradient& grad_desc, ReverseDetails& rev_info) {
   }
 }
 
+namespace {
+std::atomic<int64_t> recompute_threshold{-1};
+
+// The pointwise ops recomputeCaptures may run again in the reverse graph:
+// deterministic, cheap next to the memory their output takes, and with no
+// input but tensors and scalars
+bool isRecomputable(Node* node) {
+  static const std::unordered_set<Symbol> recomputable = {
+      aten::add, aten::sub, aten::mul, aten::div, aten::neg, aten::abs,
+      aten::exp, aten::log, aten::sqrt, aten::rsqrt, aten::sigmoid,
+      aten::tanh, aten::relu, aten::sin, aten::cos, aten::type_as,
+  };
+  return recomputable.count(node->kind()) > 0 && node->outputs().size() == 1 &&
+      node->blocks().empty();
+}
+
+// The size of the tensor of a value, 0 for other types, and -1 when it's
+// unknown
+int64_t byteSize(Value* v) {
+  if (auto type = v->type()->cast<CompleteTensorType>()) {
+    int64_t numel = 1;
+    for (auto size : type->sizes()) {
+      numel *= size;
+    }
+    return numel * at::elementSize(type->scalarType());
+  }
+  if (v->type()->isSubtypeOf(DynamicType::get())) {
+    return -1;
+  }
+  return 0;
+}
+} // namespace
+
+int64_t autodiffRecomputeThreshold() {
+  return recompute_threshold;
+}
+
+void setAutodiffRecomputeThreshold(int64_t bytes) {
+  recompute_threshold = bytes;
+}
+
+// Rather than capturing every intermediate of f that df uses, df may compute
+// some of them again. This is done for the outputs of pointwise ops whose
+// inputs df has anyway: inputs of f, values df captures, the values it
+// recomputes and constants. It is also done for outputs of at least
+// autodiffRecomputeThreshold() bytes, when the tensors the op needs and that
+// df wouldn't capture otherwise are smaller than the output, which needs
+// complete tensor types. The recomputed nodes are simple maps, which the
+// fuser merges with the pointwise gradient formulas that use them.
+static void recomputeCaptures(Gradient& grad_desc, ReverseDetails& rev_info) {
+  const auto threshold = autodiffRecomputeThreshold();
+  if (threshold < 0) {
+    return;
+  }
+  auto& graph = *grad_desc.f;
+  auto primal_block = graph.block();
+  auto reverse_block = rev_info.reverse_block;
+
+  const auto used_in_reverse = [&](Value* v) {
+    return std::any_of(v->uses().begin(), v->uses().end(), [&](const Use& use) {
+      return use.user->owningBlock() != primal_block;
+    });
+  };
+  value_set available(graph.inputs().begin(), graph.inputs().end());
+  for (Node* node : graph.nodes()) {
+    for (Value* output : node->outputs()) {
+      if (used_in_reverse(output)) {
+        available.insert(output);
+      }
+    }
+  }
+
+  value_map recomputed; // primal value -> its copy in the reverse block
+  Node* insert_point = nullptr;
+  const auto insert = [&](Node* node) {
+    if (insert_point) {
+      node->insertAfter(insert_point);
+    } else {
+      reverse_block->prependNode(node);
+    }
+    insert_point = node;
+  };
+  for (Node* node : graph.nodes()) {
+    if (!isRecomputable(node) || !used_in_reverse(node->output())) {
+      continue;
+    }
+    // The tensors df would have to capture for the recomputation, and their
+    // size, or -1 when it's unknown
+    size_t num_extra = 0;
+    int64_t extra = 0;
+    for (Value* input : node->inputs()) {
+      if (available.count(input) > 0 || recomputed.count(input) > 0 ||
+          input->node()->kind() == prim::Constant ||
+          !input->type()->isSubtypeOf(DynamicType::get())) {
+        continue;
+      }
+      ++num_extra;
+      const int64_t input_size = byteSize(input);
+      extra = extra < 0 || input_size < 0 ? -1 : extra + input_size;
+    }
+    // When df has all the inputs anyway, recomputing only saves memory, and
+    // costs little once the fuser puts it in the kernel of the gradient, so
+    // the sizes don't matter
+    if (num_extra > 0) {
+      const int64_t size = byteSize(node->output());
+      if (size < 0 || size < threshold || extra < 0 || extra >= size) {
+        continue;
+      }
+    }
+
+    Node* copy = graph.createClone(node, [&](Value* input) -> Value* {
+      auto it = recomputed.find(input);
+      if (it != recomputed.end()) {
+        return it->second;
+      }
+      if (input->node()->kind() == prim::Constant) {
+        Node* constant = graph.createClone(input->node(), [](Value*) -> Value* {
+          throw std::runtime_error("unexpected input");
+        });
+        insert(constant);
+        return constant->output();
+      }
+      available.insert(input);
+      return input;
+    });
+    insert(copy);
+    Value* output = node->output();
+    recomputed[output] = copy->output();
+    available.erase(output);
+    const auto uses = output->uses();
+    for (const auto& use : uses) {
+      if (use.user->owningBlock() != primal_block && use.user != copy) {
+        use.user->replaceInput(use.offset, copy->output());
+      }
+    }
+  }
+}
+
 // Takes a grad_desc.f returned from `addReverseInline` and splits off the
 // reverse_block into its own graph, storing it in df.
 // All intermediates needed in the second stage are added to
@@ -764,6 +903,9 @@ Gradient differentiate(std::shared_ptr<Graph>& graph) {
   // require grad, but it will emit vjps for *all* outputs. Use DCE to remove
   // unnecessary nodes.
   EliminateDeadCode(rev_info.reverse_block);
+  // Computes some intermediates again in the reverse block rather than
+  // capturing them
+  recomputeCaptures(grad_desc, rev_info);
   // Fills in f, df, f_real_outputs, df_input_captures,
   // modifies df_input_vjps (new vjps are added for temporaries)
   lambdaLiftReverse(grad_desc, rev_info);
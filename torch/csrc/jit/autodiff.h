@@ -87,6 +87,16 @@ struct Gradient {
 };
 TORCH_API Gradient differentiate(std::shared_ptr<Graph>& graph);
 
+// The size, in bytes, from which differentiate() computes the outputs of
+// pointwise ops again in df rather than capturing them, when that takes less
+// memory: when the values df would have to capture for them, and doesn't
+// already, are smaller. Outputs that df can recompute from values it has
+// anyway are recomputed whatever their size. Negative (the default) turns
+// recomputation off. Graph executors that already differentiated a graph
+// keep their plans.
+TORCH_API int64_t autodiffRecomputeThreshold();
+TORCH_API void setAutodiffRecomputeThreshold(int64_t bytes);
+
 // can we take a derivative of this node symbolically?
 TORCH_API bool isDifferentiable(Node * n);
 TORCH_API bool isDifferentiable(Graph & g);
@@ -2,6 +2,7 @@
 #include <google/protobuf/util/type_resolver_util.h>
 
 #include "torch/csrc/jit/export.h"
+#include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/autograd/symbolic.h"
 #include "torch/csrc/onnx/onnx.h"
 
@@ -18,11 +19,21 @@
 #include <ATen/ATen.h>
 #include "c10/util/Optional.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stack>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace torch { namespace jit {
@@ -474,20 +485,115 @@ class MethodEncoder : public EncoderBase {
   size_t type_counter_ = 0;
 };
 
+// a record laid out by the ScriptModuleSerializer, whose content is written
+// later
+struct ReservedRecord {
+  uint64_t key;
+  // views the whole storage, or holds a copy of it in a snapshot
+  at::Tensor data;
+  // the version of the tensor the storage was written for, if it is a variable
+  c10::optional<uint32_t> version;
+};
+
+// copies the content of a record, so the tensors it was taken from can be
+// modified while it is written
+at::Tensor snapshotRecordData(const at::Tensor& data) {
+  return data.device().is_cpu() ? data.clone() : data.cpu();
+}
+
+// writes the content of the records into the file, each thread writing one
+// record at a time
+void writeRecordsInParallel(
+    PyTorchFilePayloadWriter& writer,
+    const std::vector<ReservedRecord>& records) {
+  if (records.empty()) {
+    return;
+  }
+  // max(...) since hardware_concurrency may return 0
+  const size_t numThreads = std::min<size_t>(
+      records.size(), std::max(std::thread::hardware_concurrency(), 1u));
+  std::atomic<size_t> next{0};
+  std::mutex mutex;
+  std::exception_ptr eptr;
+  auto writeRecords = [&]() {
+    try {
+      for (size_t i = next++; i < records.size(); i = next++) {
+        // NB: copies cuda tensors to the cpu, unless they were snapshotted
+        // already
+        const at::Tensor t = records[i].data.cpu();
+        const uint64_t size =
+            t.type().elementSizeInBytes() * t.storage().size();
+        AT_ASSERT(
+            size ==
+            records[i].data.type().elementSizeInBytes() *
+                records[i].data.storage().size());
+        writer.write(records[i].key, t.storage().data(), size);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (!eptr) {
+        eptr = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; ++i) {
+    threads.emplace_back(writeRecords);
+  }
+  writeRecords();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (eptr) {
+    std::rethrow_exception(eptr);
+  }
+}
+
 // this is a serializer class which saves script modules to pt files. the
 // content of the file is written using PyTorchStreamWriter, for details please
 // check caffe2/serialize/inline_container.h. all the records except the last
 // one are tensor data, and the last record is a serialized ModelProto, defined
 // in caffe2/proto/torch.proto. ModelProto contains all the metadata of the
 // model, and it is serialized as json.
+//
+// when writing to a file, the records of all tensors are laid out first, and
+// their content is then written into the file by several threads at once.
 class ScriptModuleSerializer final {
  public:
+  // lays out the records without writing anything. the content of the
+  // records is left in reservedRecords() by finish
+  ScriptModuleSerializer();
+
   ScriptModuleSerializer(const std::string& filename);
 
   ScriptModuleSerializer(std::ostream* ofs);
 
+  ~ScriptModuleSerializer();
+
   void serialize(const script::Module& module);
 
+  // the two halves of serialize(). prepare converts the module and writes
+  // or lays out the records of its tensors, and finish writes the content of
+  // the laid out records and the model. if `snapshot` is true, the content
+  // of all laid out records is copied by prepare, so the module may be
+  // modified (e.g. trained further) before finish is called
+  void prepare(const script::Module& module, bool snapshot);
+
+  void finish();
+
+  std::vector<ReservedRecord>& reservedRecords() {
+    return reservedRecords_;
+  }
+
+  const std::string& modelJson() const {
+    return modelJson_;
+  }
+
+  // the size of the file, once finish was called
+  int64_t fileSize() const {
+    return writer_.getCurrentSize();
+  }
+
   uint64_t lookupTensorId(const at::Tensor* tensor) const;
 
   const std::string& lookupParamName(const at::Tensor* tensor) const;
@@ -530,10 +636,23 @@ class ScriptModuleSerializer final {
       const script::Method& method,
       torch::MethodDef* method_def);
 
+  // when writing to a file, the file is written under a temporary name and
+  // only renamed to its final name by finish
+  std::string filename_;
+  std::string tmpFilename_;
   std::ofstream ofs_;
   PyTorchStreamWriter writer_;
+  // only set when writing to a file
+  std::unique_ptr<PyTorchFilePayloadWriter> payloadWriter_;
+  // whether the content of tensors is written with the rest of the file
+  // (when laying out records, or writing to a file), or right away
+  bool reserveRecords_;
   // storage_ptr => record_offset
   std::unordered_map<const void*, uint64_t> storageMap_;
+  // the records that were laid out but not written yet
+  std::vector<ReservedRecord> reservedRecords_;
+  bool snapshot_ = false;
+  std::string modelJson_;
   // tensor => param name
   std::unordered_map<const at::Tensor*, std::string> paramMap_;
   // tensor => tensor_id
@@ -715,18 +834,41 @@ void MethodEncoder::EncodeValueInfo(
 }
 
 // ScriptModuleSerializer's methods
+ScriptModuleSerializer::ScriptModuleSerializer()
+    : ofs_(), writer_(nullptr), reserveRecords_(true) {}
+
+// NB: the old file must not be overwritten in place, since the tensors loaded
+// from it may still map it (see mapPyTorchFile)
 ScriptModuleSerializer::ScriptModuleSerializer(const std::string& filename)
-    : ofs_(
-          filename,
+    : filename_(filename),
+      tmpFilename_(filename + ".tmp"),
+      ofs_(
+          tmpFilename_,
           std::ofstream::out | std::ofstream::trunc | std::ofstream::binary),
-      writer_(&ofs_) {
-  // TODO appropriate support for mmap, right now we still use stream writer
-}
+      writer_(&ofs_),
+      payloadWriter_(new PyTorchFilePayloadWriter(tmpFilename_)),
+      reserveRecords_(true) {}
 
 ScriptModuleSerializer::ScriptModuleSerializer(std::ostream* ofs)
-    : ofs_(), writer_(ofs) {}
+    : ofs_(), writer_(ofs), reserveRecords_(false) {}
+
+ScriptModuleSerializer::~ScriptModuleSerializer() {
+  if (!tmpFilename_.empty()) {
+    // finish was not called, or failed
+    ofs_.close();
+    std::remove(tmpFilename_.c_str());
+  }
+}
 
 void ScriptModuleSerializer::serialize(const script::Module& module) {
+  prepare(module, /*snapshot=*/false);
+  finish();
+}
+
+void ScriptModuleSerializer::prepare(
+    const script::Module& module,
+    bool snapshot) {
+  snapshot_ = snapshot;
   torch::ModelDef model_def;
   convertToModel(module, &model_def);
   std::string output;
@@ -747,9 +889,37 @@ void ScriptModuleSerializer::serialize(const script::Module& module) {
     ss << convert_result;
     AT_ERROR(ss.str());
   }
-  auto record_id = writer_.writeRecord(output.data(), output.size());
+  modelJson_ = std::move(output);
+}
+
+void ScriptModuleSerializer::finish() {
+  if (payloadWriter_) {
+    writeRecordsInParallel(*payloadWriter_, reservedRecords_);
+    reservedRecords_.clear();
+  }
+  auto record_id = writer_.writeRecord(modelJson_.data(), modelJson_.size());
   AT_ASSERT(record_id != 0);
   writer_.writeEndOfFile();
+  if (!tmpFilename_.empty()) {
+    // the file is complete once finish returns, even if the serializer lives
+    // on (e.g. in an asynchronous export)
+    ofs_.close();
+    AT_CHECK(ofs_.good(), "Failed to write ", tmpFilename_);
+    payloadWriter_.reset();
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    std::remove(filename_.c_str());
+#endif
+    AT_CHECK(
+        std::rename(tmpFilename_.c_str(), filename_.c_str()) == 0,
+        "Failed to rename ",
+        tmpFilename_,
+        " to ",
+        filename_,
+        ": ",
+        std::strerror(errno));
+    tmpFilename_.clear();
+  }
 }
 
 uint64_t ScriptModuleSerializer::lookupTensorId(
@@ -870,18 +1040,32 @@ void ScriptModuleSerializer::convertAndWriteTensor(
   if (storage_it == storageMap_.end()) {
     // TODO HIP support
     uint64_t record_id;
-    if (tensor.storage().device_type() == at::DeviceType::CUDA) {
-      // NB: This new tensor is created to support cuda tensors.
-      // Storages can be mutated when converting tensors from cuda to cpu,
-      // and we need a cpu tensor to copy data from.
-      at::Tensor t = at::getType(tensor)
-                         ._th_tensor(
-                             tensor.storage(),
-                             /* storageOffset = */ 0,
-                             /* size = */
-                             {static_cast<int64_t>(tensor.storage().size())},
-                             /* stride = */ {1})
-                         .cpu();
+    // NB: This new tensor is created to support cuda tensors.
+    // Storages can be mutated when converting tensors from cuda to cpu,
+    // and we need a cpu tensor to copy data from.
+    auto storageTensor = [&]() {
+      return at::getType(tensor)._th_tensor(
+          tensor.storage(),
+          /* storageOffset = */ 0,
+          /* size = */ {static_cast<int64_t>(tensor.storage().size())},
+          /* stride = */ {1});
+    };
+    if (reserveRecords_) {
+      // the content is written with all other records by finish once the
+      // layout is done
+      ReservedRecord record;
+      record.key = writer_.reserveRecord(record_size);
+      record.data = storageTensor();
+      if (snapshot_) {
+        record.data = snapshotRecordData(record.data);
+      }
+      if (tensor.is_variable()) {
+        record.version = autograd::as_variable_ref(tensor).current_version();
+      }
+      record_id = record.key;
+      reservedRecords_.push_back(std::move(record));
+    } else if (tensor.storage().device_type() == at::DeviceType::CUDA) {
+      at::Tensor t = storageTensor().cpu();
       AT_ASSERT(
           t.type().elementSizeInBytes() * t.storage().size() == record_size);
       record_id = writer_.writeRecord(
@@ -899,8 +1083,18 @@ void ScriptModuleSerializer::convertAndWriteTensor(
 }
 
 void ScriptModuleSerializer::writeTensorTable(torch::ModelDef* model_def) {
-  // NB: we don't reserve any order for tensors in the tensorTable_
-  for (const auto& kv : tensorTable_) {
+  // NB: tensors are written in the order of their ids, so that modules with
+  // the same structure are laid out the same way
+  std::vector<std::pair<const at::Tensor*, uint64_t>> tensors(
+      tensorTable_.begin(), tensorTable_.end());
+  std::sort(
+      tensors.begin(),
+      tensors.end(),
+      [](const std::pair<const at::Tensor*, uint64_t>& a,
+         const std::pair<const at::Tensor*, uint64_t>& b) {
+        return a.second < b.second;
+      });
+  for (const auto& kv : tensors) {
     auto* tensor_proto = model_def->add_tensors();
     convertAndWriteTensor(*kv.first, tensor_proto);
   }
@@ -1166,4 +1360,139 @@ void ExportModule(const script::Module& module, const std::string &filename) {
   serializer.serialize(module);
 }
 
+std::future<void> ExportModuleAsync(
+    const script::Module& module,
+    const std::string& filename) {
+  auto serializer = std::make_shared<ScriptModuleSerializer>(filename);
+  serializer->prepare(module, /*snapshot=*/true);
+  return std::async(
+      std::launch::async, [serializer]() { serializer->finish(); });
+}
+
+namespace {
+int64_t getFileSize(const std::string& filename) {
+  std::ifstream in(filename, std::ios_base::binary | std::ios_base::ate);
+  return in.good() ? static_cast<int64_t>(in.tellg()) : -1;
+}
+
+c10::weak_intrusive_ptr<at::StorageImpl> getWeakStorage(at::Storage storage) {
+  return c10::weak_intrusive_ptr<at::StorageImpl>(
+      c10::intrusive_ptr<at::StorageImpl>::reclaim(
+          storage.unsafeReleaseStorageImpl()));
+}
+} // namespace
+
+struct IncrementalExporter::State {
+  // what the last export wrote for the storage of a record
+  struct Record {
+    c10::weak_intrusive_ptr<at::StorageImpl> storage;
+    c10::optional<uint32_t> version;
+  };
+
+  explicit State(std::string filename) : filename(std::move(filename)) {}
+
+  const std::string filename;
+  // the model record of the last export, or empty if the file has to be
+  // written from scratch
+  std::string modelJson;
+  int64_t fileSize = -1;
+  std::vector<Record> records;
+};
+
+IncrementalExporter::IncrementalExporter(std::string filename)
+    : state_(std::make_shared<State>(std::move(filename))) {}
+
+IncrementalExporter::~IncrementalExporter() {
+  if (pending_.valid()) {
+    pending_.wait();
+  }
+}
+
+size_t IncrementalExporter::exportModule(const script::Module& module) {
+  size_t numRecords = 0;
+  prepare(module, /*snapshot=*/false, &numRecords)();
+  return numRecords;
+}
+
+std::shared_future<void> IncrementalExporter::exportModuleAsync(
+    const script::Module& module) {
+  auto write = prepare(module, /*snapshot=*/true, /*numRecords=*/nullptr);
+  pending_ = std::async(std::launch::async, std::move(write)).share();
+  return pending_;
+}
+
+std::function<void()> IncrementalExporter::prepare(
+    const script::Module& module,
+    bool snapshot,
+    size_t* numRecords) {
+  // the state is only up to date once the previous export is done
+  if (pending_.valid()) {
+    pending_.wait();
+    pending_ = std::shared_future<void>();
+  }
+
+  // lay out the module without writing anything, to find out whether the
+  // file of the last export can be updated in place
+  ScriptModuleSerializer layout;
+  layout.prepare(module, /*snapshot=*/false);
+  layout.finish();
+  auto& records = layout.reservedRecords();
+  std::vector<State::Record> written;
+  written.reserve(records.size());
+  for (const auto& record : records) {
+    written.push_back({getWeakStorage(record.data.storage()), record.version});
+  }
+
+  auto state = state_;
+  std::function<void()> write;
+  if (!state->modelJson.empty() && state->modelJson == layout.modelJson() &&
+      state->fileSize == getFileSize(state->filename)) {
+    // same layout, so only the content of the storages that were modified
+    // (or replaced) since is written
+    AT_ASSERT(records.size() == state->records.size());
+    auto changed = std::make_shared<std::vector<ReservedRecord>>();
+    for (size_t i = 0; i < records.size(); ++i) {
+      const auto& last = state->records[i];
+      const bool unchanged = last.version && records[i].version &&
+          *last.version == *records[i].version &&
+          last.storage.lock().get() ==
+              records[i].data.storage().unsafeGetStorageImpl();
+      if (!unchanged) {
+        if (snapshot) {
+          records[i].data = snapshotRecordData(records[i].data);
+        }
+        changed->push_back(std::move(records[i]));
+      }
+    }
+    if (numRecords) {
+      *numRecords = changed->size();
+    }
+    write = [state, changed]() {
+      PyTorchFilePayloadWriter writer(state->filename);
+      writeRecordsInParallel(writer, *changed);
+    };
+  } else {
+    auto serializer = std::make_shared<ScriptModuleSerializer>(
+        state->filename);
+    serializer->prepare(module, snapshot);
+    if (numRecords) {
+      *numRecords = records.size();
+    }
+    write = [serializer]() { serializer->finish(); };
+  }
+  state->modelJson = layout.modelJson();
+  state->fileSize = layout.fileSize();
+  state->records = std::move(written);
+
+  return [state, write]() {
+    try {
+      write();
+    } catch (...) {
+      // the file is in an unknown state now
+      state->modelJson.clear();
+      throw;
+    }
+  };
+}
+
 }}
@@ -4,7 +4,12 @@
 #include "torch/csrc/jit/script/module.h"
 #include "torch/csrc/onnx/onnx.h"
 
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
 #include <ostream>
+#include <string>
 
 namespace torch { namespace jit {
 
@@ -44,4 +49,55 @@ TORCH_API void ExportModule(
     const script::Module& module,
     const std::string& filename);
 
+// Exports the module to a file like ExportModule, but only copies the data
+// of its tensors (from the device, if needed) before returning. The file is
+// written in the background, and the returned future becomes ready once it
+// is complete (or rethrows the error that stopped the export). Destroying the
+// future waits for the export to finish.
+TORCH_API std::future<void> ExportModuleAsync(
+    const script::Module& module,
+    const std::string& filename);
+
+// Exports modules to the same file again and again, e.g. to checkpoint a
+// model during training. If the module has the same structure as in the last
+// export (the same tensors, with the same sizes and types), the file is
+// updated in place: only the storages of tensors that were replaced or
+// modified since are written. Modifications are detected through the version
+// counters of variables, so data modified in place without bumping their
+// version (e.g. through `.data()`) is missed. Tensors that are not variables
+// are always written.
+//
+// Unlike other exports, which replace the file with a new one, updates in
+// place are visible through the tensors loaded from the file (as they map
+// it), unless they were copied.
+//
+// A failed export leaves the file in an unknown state, and the next export
+// then writes it from scratch.
+class TORCH_API IncrementalExporter {
+ public:
+  explicit IncrementalExporter(std::string filename);
+
+  // Waits for an asynchronous export that is still running.
+  ~IncrementalExporter();
+
+  // Exports the module and returns the number of storages that were written.
+  size_t exportModule(const script::Module& module);
+
+  // Exports the module like ExportModuleAsync, only copying the storages to
+  // be written before returning. An export waits for the previous one.
+  std::shared_future<void> exportModuleAsync(const script::Module& module);
+
+ private:
+  struct State;
+
+  // Lays out the export and returns the function that writes it.
+  std::function<void()> prepare(
+      const script::Module& module,
+      bool snapshot,
+      size_t* numRecords);
+
+  std::shared_ptr<State> state_;
+  std::shared_future<void> pending_;
+};
+
 }}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// Allocates objects of a single size from chunks, reusing the slots of the
+// objects freed first. The nodes and values of a graph are allocated from
+// arenas of the graph, which saves a malloc and a free per object and keeps
+// the objects of a graph close to each other in memory. The chunks grow from
+// a few objects, so that small graphs stay small.
+//
+// The arena doesn't construct or destroy the objects, and only frees its
+// memory when destroyed, which the objects must not outlive.
+struct FixedSizeArena {
+  explicit FixedSizeArena(size_t object_size)
+  : slot_size_(alignedSize(object_size > sizeof(FreeSlot) ? object_size : sizeof(FreeSlot))) {}
+  FixedSizeArena(const FixedSizeArena&) = delete;
+  FixedSizeArena& operator=(const FixedSizeArena&) = delete;
+
+  void* allocate() {
+    if (free_list_) {
+      FreeSlot* slot = free_list_;
+      free_list_ = slot->next;
+      return slot;
+    }
+    if (used_in_chunk_ == chunk_size_) {
+      if (chunks_.empty()) {
+        chunk_size_ = kFirstChunkSize;
+      } else if (2 * chunk_size_ <= kMaxChunkSize) {
+        chunk_size_ *= 2;
+      }
+      // new char[] is aligned for any object that fits
+      chunks_.emplace_back(new char[chunk_size_ * slot_size_]);
+      used_in_chunk_ = 0;
+    }
+    return chunks_.back().get() + slot_size_ * used_in_chunk_++;
+  }
+
+  void deallocate(void* object) {
+    FreeSlot* slot = static_cast<FreeSlot*>(object);
+    slot->next = free_list_;
+    free_list_ = slot;
+  }
+
+private:
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+  // in objects
+  enum : size_t { kFirstChunkSize = 8, kMaxChunkSize = 256 };
+
+  static size_t alignedSize(size_t size) {
+    constexpr size_t alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  const size_t slot_size_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  size_t chunk_size_ = 0;
+  size_t used_in_chunk_ = 0;
+  FreeSlot* free_list_ = nullptr;
+};
+
+}} // namespace torch::jit
@@ -33,6 +33,18 @@ size_t ${tensor}_dimIndex${d} = ${tensor}_linearIndex ${mod_sizes};
 ${tensor}_offset += ${tensor}_dimIndex${d} ${times_stride};
 )");
 
+// Template for accumulating a row of the input of a trailing reduction.
+// Intermediate values are computed (and accumulated) as floats.
+static auto reduction_loop = CodeTemplate(R"(
+float ${node}_accumulator = 0.f;
+for (IndexType reductionIndex = 0; reductionIndex < reductionSize; ++reductionIndex) {
+  IndexType inputIndex = linearIndex * reductionSize + reductionIndex;
+  ${rowOffsets}
+  ${rowBody}
+  ${node}_accumulator += ${reduced};
+}
+auto ${node} = ${node}_accumulator;
+)");
 
 static std::string valueName(const Value* n) {
   return "n" + std::to_string(n->unique());
@@ -186,15 +198,36 @@ static Node* usedInFusedChunk(const Value* input) {
   return nullptr;
 }
 
+// If the graph ends in a sum over the innermost dimension, returns the
+// sum node. Returns nullptr otherwise.
+static const Node* trailingReduction(const Graph& graph) {
+  const auto outputs = graph.outputs();
+  if (outputs.size() == 1 && outputs[0]->node()->kind() == aten::sum) {
+    return outputs[0]->node();
+  }
+  return nullptr;
+}
+
+// Returns true if n is a constant that is only used by the reduction
+static bool isReductionArgument(const Node* n, const Node* reduction) {
+  if (n->kind() != prim::Constant) return false;
+  for (const auto& use : n->output()->uses()) {
+    if (use.user != reduction) return false;
+  }
+  return true;
+}
+
 static void emitIndexingFor(
   std::ostream& out
 , const std::string& tensor
 , const int ndim
-, const bool last_is_cont) {
+, const bool last_is_cont
+, const std::string& index) {
   TemplateEnv env;
   env.s("tensor",tensor);
+  env.s("index",index);
   out << format("IndexType ${tensor}_offset = 0;\n",env);
-  out << format("IndexType ${tensor}_linearIndex = linearIndex;\n",env);
+  out << format("IndexType ${tensor}_linearIndex = ${index};\n",env);
   for (int d = ndim - 1; d >= 0; --d) {
     env.d("d",d);
     env.s("mod_sizes", d > 0 ? format("% ${tensor}.sizes[${d}]",env) : "");
@@ -228,11 +261,21 @@ generateKernel(
   std::vector<std::string> formals;
   std::vector<std::string> argument_loads;
 
+  // Kernels ending in a reduction compute one output element per iteration,
+  // looping over a row of the inputs (see below). Input offsets are then
+  // computed from the index into the inputs for every element of the row.
+  const Node* reduction = trailingReduction(graph);
+  std::stringstream reductionOffsets;
+
   // Lambda for writing arguments
-  auto emitFormal = [&](const Value* n, const TensorDesc& desc) {
+  auto emitFormal = [&](const Value* n, const TensorDesc& desc, const bool is_input) {
     std::string tensor = "t" + std::to_string(formals.size()); //can't be unique() because Param may be an output
     const auto nDim = desc.nDim();
-    emitIndexingFor(tensorOffsets, tensor, nDim,  desc.lastIsContiguous());
+    if (reduction && is_input) {
+      emitIndexingFor(reductionOffsets, tensor, nDim, desc.lastIsContiguous(), "inputIndex");
+    } else {
+      emitIndexingFor(tensorOffsets, tensor, nDim, desc.lastIsContiguous(), "linearIndex");
+    }
     env.s("tensor", tensor);
     env.d("formal_index", formals.size() + 1); // + 1 because the first argument is the linearIndex
     env.d("nDim", nDim);
@@ -260,7 +303,7 @@ generateKernel(
       }
     }
     for (const auto& input : flat_inputs) {
-      emitFormal(input.first, input.second);
+      emitFormal(input.first, input.second, true);
     }
   }
 
@@ -272,14 +315,14 @@ generateKernel(
     for (const auto& o : graph.outputs()) {
       const auto& desc = output_desc[i++];
       if (o->node()->kind() != prim::FusedConcat) {
-        emitFormal(o, desc);
+        emitFormal(o, desc, false);
         concat_desc.emplace_back();
         flat_output_nodes.emplace_back(o, desc);
       } else {
         const auto cat = o->node();
         concat_desc.emplace_back(desc, cat->inputs().size(), cat->i(attr::dim));
         for(const auto& c : cat->inputs()) {
-          emitFormal(c, *concat_desc.back().subTensorDesc());
+          emitFormal(c, *concat_desc.back().subTensorDesc(), false);
           flat_output_nodes.emplace_back(c, desc);
         }
       }
@@ -321,6 +364,9 @@ generateKernel(
     // Note: FusedConcat nodes work by narrowing the output Tensors before the kernel runs
     if (n->kind() == prim::FusedConcat) continue;
     if (n->kind() == prim::ConstantChunk) continue;
+    // Note: the reduction and its (constant) dim and keepdim arguments are
+    //  generated after the loop over the reduced row
+    if (reduction && (n == reduction || isReductionArgument(n, reduction))) continue;
     if (n->kind() == aten::rand_like) {
       JIT_ASSERT(use_cuda);
       has_random = true;
@@ -330,6 +376,20 @@ generateKernel(
     body << format("auto ${node} = ${rhs};\n",env);
   }
 
+  // Wraps the loads and the computation of all intermediate values into a
+  // loop over the reduced row, and accumulates the input of the reduction
+  if (reduction) {
+    env.s("rowBody", body.str());
+    env.s("rowOffsets", reductionOffsets.str());
+    env.s("reduced", valueName(reduction->namedInput(attr::self)));
+    env.s("node", valueName(reduction->output()));
+    env.d("formal_index", formals.size() + 1);
+    formals.push_back("IndexType reductionSize");
+    argument_loads.push_back(format("*static_cast<IndexType*>(args[${formal_index}])", env));
+    body.str("");
+    body << reduction_loop.format(env);
+  }
+
   // Generates writes to output tensors
   for (const auto& output : flat_output_nodes) {
     const auto& o = output.first;
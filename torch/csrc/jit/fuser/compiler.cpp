@@ -70,6 +70,15 @@ static void setInputChunkDescriptors(KernelSpec& spec) {
   }
 }
 
+static void setReductionDescriptor(KernelSpec& spec) {
+  const auto outputs = (spec.graph())->outputs();
+  if (outputs.size() == 1 && outputs[0]->node()->kind() == aten::sum) {
+    const auto keepdim = outputs[0]->node()->get<bool>(attr::keepdim);
+    JIT_ASSERT(keepdim);
+    spec.reduction() = ReductionInfo(*keepdim);
+  }
+}
+
 // Run a DFS traversal to find all inputs that affect a given output value
 static std::vector<int64_t> getInputDependencies(const Value* output) {
   std::vector<const Value*> queue{output};
@@ -120,9 +129,12 @@ static void setInputBroadcastGroups(KernelSpec& spec) {
 // or their descendants are involved in, which means that in a DAG of
 // pointwise operations all tensors are expandable to the (single) output.
 // Note: The logic is slightly complicated by concatenation and chunking.
+// A trailing reduction is computed over the innermost dimension of the
+// map size.
 static void upfrontCompilation(KernelSpec& spec) {
   setInputBroadcastGroups(spec);
   setInputChunkDescriptors(spec);
+  setReductionDescriptor(spec);
 }
 
 int64_t registerFusion(const Node* fusion_group) {
@@ -164,6 +176,9 @@ std::shared_ptr<FusedKernel> compileKernel(
     if (output->node()->kind() == prim::FusedConcat) {
       sizes.at(output->node()->i(attr::dim)) *= output->node()->inputs().size();
     }
+    if (spec.reduction()) {
+      sizes.back() = 1;
+    }
     auto type = CompleteTensorType::create(*scalar_type, device, sizes);
     output_desc.emplace_back(std::move(type));
   }
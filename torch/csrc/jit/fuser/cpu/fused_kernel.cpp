@@ -3,6 +3,7 @@
 #include "torch/csrc/jit/assertions.h"
 #include "torch/csrc/jit/code_template.h"
 #include "torch/csrc/jit/fuser/compiler.h"
+#include "torch/csrc/jit/fuser/disk_cache.h"
 #include "torch/csrc/jit/fuser/cpu/temp_file.h"
 #include "torch/csrc/jit/fuser/cpu/dynamic_library.h"
 #include "torch/csrc/utils/memory.h"
@@ -69,7 +70,7 @@ static const std::string compile_string =
 #endif
   "-std=c++11 -fPIC ${fopenmp} -shared \"${cpp_file}\" -o \"${so_file}\" -lm";
 
-static void runCompiler(
+static std::string compileCommand(
   const std::string& cpp_file
 , const std::string& so_file) {
   auto& config = getConfig();
@@ -78,7 +79,14 @@ static void runCompiler(
   env.s("fopenmp", config.openmp ? "-fopenmp" : "");
   env.s("cpp_file", cpp_file);
   env.s("so_file", so_file);
-  std::string result = format(compile_string, env);
+  return format(compile_string, env);
+}
+
+static void runCompiler(
+  const std::string& cpp_file
+, const std::string& so_file) {
+  auto& config = getConfig();
+  std::string result = compileCommand(cpp_file, so_file);
   int r = system(result.c_str());
   if (config.openmp && r != 0) {
     std::cerr << "warning: pytorch jit fuser failed to compile with openmp, trying without it...\n";
@@ -114,16 +122,27 @@ FusedKernelCPU::FusedKernelCPU(
           std::move(chunk_desc),
           std::move(concat_desc),
           has_random) {
-  auto& config = getConfig();
-  TempFile so_file(so_template, 3);
-  TempFile cpp_file(cpp_template, 4);
-  cpp_file.write(code_);
-  cpp_file.sync();
-  runCompiler(cpp_file.name(), so_file.name());
-  if (debugFuser() >= 2) disas(so_file.name());
-  so_lib = make_unique<DynamicLibrary>(so_file.name().c_str());
+  // The compiled library only depends on the source and on the compile
+  // command (minus the file names)
+  auto cacheKey = [&] {
+    return compileCommand("", "") + "\n" + kernelSourceKey(name_, code_);
+  };
+  std::string symbol = name_;
+  if (auto cached = lookupDiskCache(cacheKey(), ".so")) {
+    so_lib = make_unique<DynamicLibrary>(cached->path.c_str());
+    symbol = cached->name;
+  } else {
+    TempFile so_file(so_template, 3);
+    TempFile cpp_file(cpp_template, 4);
+    cpp_file.write(code_);
+    cpp_file.sync();
+    runCompiler(cpp_file.name(), so_file.name());
+    if (debugFuser() >= 2) disas(so_file.name());
+    so_lib = make_unique<DynamicLibrary>(so_file.name().c_str());
+    storeInDiskCache(cacheKey(), ".so", name_, readFile(so_file.name()));
+  }
   #pragma GCC diagnostic ignored "-Wpedantic"
-    kernel = reinterpret_cast<void(*)(uint32_t, void**)>(so_lib->sym(name_.c_str()));
+    kernel = reinterpret_cast<void(*)(uint32_t, void**)>(so_lib->sym(symbol.c_str()));
   #pragma GCC diagnostic pop
 }
 
@@ -5,6 +5,7 @@
 #include "THC/THC.h"
 #include "torch/csrc/cuda/cuda_check.h"
 #include "torch/csrc/jit/resource_guard.h"
+#include "torch/csrc/jit/fuser/disk_cache.h"
 
 // Note: unclear why this forward declaration is necessary
 #include "THC/THCTensorRandom.h"
@@ -103,39 +104,58 @@ FusedKernelCUDA::FusedKernelCUDA(
   int major, minor;
   getMajorMinor(prop_, major, minor);
 
-  // Creates the NVRTC program
-  nvrtcProgram program;
-  TORCH_NVRTC_CHECK(nvrtcCreateProgram(
-    &program
-  , code_.c_str()
-  , nullptr
-  , 0
-  , nullptr
-  , nullptr));
-
   const std::string compute = "--gpu-architecture=compute_" + std::to_string(major) + std::to_string(minor);
   const std::vector<const char *> args = {"--std=c++11", compute.c_str(), "-default-device"};
-  const auto result = nvrtcCompileProgram(program, args.size(), args.data());
-  if (result == NVRTC_ERROR_COMPILATION) {
-    size_t logsize;
-    nvrtcGetProgramLogSize(program, &logsize);
-    std::vector<char> log(logsize);
-    nvrtcGetProgramLog(program, log.data());
-    std::stringstream cu;
-    cu << log.data();
-    throw std::runtime_error(cu.str());
+
+  // The PTX depends on the source, the NVRTC version and the options
+  int nvrtc_major, nvrtc_minor;
+  TORCH_NVRTC_CHECK(nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+  std::stringstream key;
+  key << "nvrtc " << nvrtc_major << "." << nvrtc_minor;
+  for (const char* arg : args) {
+    key << " " << arg;
+  }
+  key << "\n" << kernelSourceKey(name_, code_);
+
+  std::string function_name = name_;
+  if (auto cached = lookupDiskCache(key.str(), ".ptx")) {
+    const auto ptx = readFile(cached->path);
+    ptx_.assign(ptx.begin(), ptx.end());
+    function_name = cached->name;
+  } else {
+    // Creates the NVRTC program
+    nvrtcProgram program;
+    TORCH_NVRTC_CHECK(nvrtcCreateProgram(
+      &program
+    , code_.c_str()
+    , nullptr
+    , 0
+    , nullptr
+    , nullptr));
+
+    const auto result = nvrtcCompileProgram(program, args.size(), args.data());
+    if (result == NVRTC_ERROR_COMPILATION) {
+      size_t logsize;
+      nvrtcGetProgramLogSize(program, &logsize);
+      std::vector<char> log(logsize);
+      nvrtcGetProgramLog(program, log.data());
+      std::stringstream cu;
+      cu << log.data();
+      throw std::runtime_error(cu.str());
+    }
+    ResourceGuard holdProgram([&] {
+      TORCH_NVRTC_CHECK(nvrtcDestroyProgram(&program));
+    });
+    TORCH_NVRTC_CHECK(result);
+    size_t ptx_size;
+    TORCH_NVRTC_CHECK(nvrtcGetPTXSize(program, &ptx_size));
+    ptx_.resize(ptx_size);
+    TORCH_NVRTC_CHECK(nvrtcGetPTX(program, ptx_.data()));
+    storeInDiskCache(key.str(), ".ptx", name_, std::string(ptx_.begin(), ptx_.end()));
   }
-  ResourceGuard holdProgram([&] {
-    TORCH_NVRTC_CHECK(nvrtcDestroyProgram(&program));
-  });
-  TORCH_NVRTC_CHECK(result);
-  size_t ptx_size;
-  TORCH_NVRTC_CHECK(nvrtcGetPTXSize(program, &ptx_size));
-  ptx_.resize(ptx_size);
-  TORCH_NVRTC_CHECK(nvrtcGetPTX(program, ptx_.data()));
 
   TORCH_CU_CHECK(cuModuleLoadData(&module_, ptx_.data()));
-  TORCH_CU_CHECK(cuModuleGetFunction(&function_, module_, name_.c_str()));
+  TORCH_CU_CHECK(cuModuleGetFunction(&function_, module_, function_name.c_str()));
 
   // Computes max blocks
   TORCH_CU_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(
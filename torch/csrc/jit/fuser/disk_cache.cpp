@@ -0,0 +1,136 @@
+#include "torch/csrc/jit/fuser/disk_cache.h"
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace torch { namespace jit { namespace fuser {
+
+static const std::string kernel_name_placeholder = "${kernel_name}";
+
+static c10::optional<std::string> cacheDir() {
+  static const c10::optional<std::string> dir = []() -> c10::optional<std::string> {
+    const char* dir_env = getenv("PYTORCH_FUSER_CACHE_DIR");
+    if (!dir_env || dir_env[0] == '\0') return c10::nullopt;
+    #ifdef _WIN32
+      _mkdir(dir_env);
+    #else
+      mkdir(dir_env, 0755);
+    #endif
+    return std::string(dir_env);
+  }();
+  return dir;
+}
+
+// 64-bit FNV-1a. Collisions are detected by comparing the full key stored
+// next to each entry, so this doesn't need to be a cryptographic hash.
+static std::string hashKey(const std::string& key) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return ss.str();
+}
+
+static std::string entryPath(
+    const std::string& dir,
+    const std::string& key,
+    const std::string& extension) {
+  return dir + "/" + hashKey(key) + extension;
+}
+
+static bool fileExists(const std::string& path) {
+  struct stat buffer;
+  return stat(path.c_str(), &buffer) == 0;
+}
+
+// Writes to a temporary file first and renames it, so that other processes
+// never see partially written entries.
+static void writeFileAtomic(const std::string& path, const std::string& contents) {
+  static std::atomic<size_t> counter{0};
+  std::ostringstream tmp;
+  tmp << path << ".tmp"
+      << std::chrono::steady_clock::now().time_since_epoch().count()
+      << "_" << counter++;
+  {
+    std::ofstream out(tmp.str(), std::ios::binary);
+    if (!out) return;
+    out.write(contents.data(), contents.size());
+    if (!out) {
+      out.close();
+      std::remove(tmp.str().c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp.str().c_str());
+  }
+}
+
+std::string readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+std::string kernelSourceKey(const std::string& name, const std::string& code) {
+  std::string key = code;
+  size_t pos = 0;
+  while ((pos = key.find(name, pos)) != std::string::npos) {
+    key.replace(pos, name.size(), kernel_name_placeholder);
+    pos += kernel_name_placeholder.size();
+  }
+  return key;
+}
+
+// Each entry is two files: <hash><extension> with the artifact, and
+// <hash><extension>.key with the name of the kernel on the first line,
+// followed by the full key. The key file is written last.
+c10::optional<CachedKernel> lookupDiskCache(
+    const std::string& key,
+    const std::string& extension) {
+  const auto dir = cacheDir();
+  if (!dir) return c10::nullopt;
+  const auto path = entryPath(*dir, key, extension);
+  const auto key_path = path + ".key";
+  if (!fileExists(key_path) || !fileExists(path)) return c10::nullopt;
+
+  const auto stored = readFile(key_path);
+  const auto newline = stored.find('\n');
+  if (newline == std::string::npos || stored.compare(newline + 1, std::string::npos, key) != 0) {
+    return c10::nullopt;
+  }
+  return CachedKernel{path, stored.substr(0, newline)};
+}
+
+void storeInDiskCache(
+    const std::string& key,
+    const std::string& extension,
+    const std::string& name,
+    const std::string& artifact) {
+  const auto dir = cacheDir();
+  if (!dir) return;
+  const auto path = entryPath(*dir, key, extension);
+  writeFileAtomic(path, artifact);
+  if (fileExists(path)) {
+    writeFileAtomic(path + ".key", name + "\n" + key);
+  }
+}
+
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,57 @@
+#pragma once
+#include "torch/csrc/jit/fuser/config.h"
+#if USE_CUDA_FUSER || USE_CPU_FUSER
+
+#include "c10/util/Optional.h"
+#include "torch/csrc/WindowsTorchApiMacro.h"
+
+#include <string>
+
+namespace torch { namespace jit { namespace fuser {
+
+// An on-disk cache of compiled kernels, shared by all processes using the
+// same directory, so fused kernels survive process restarts.
+//
+// Entries are addressed by a key holding everything the compiled artifact
+// depends on: the kernel source, the compiler, its flags and the target
+// architecture. Kernel names depend on the order in which a process
+// compiles its fusions, so they are left out of the key (see
+// kernelSourceKey) and the name the artifact was compiled with is stored
+// along with it. The cache directory is given by the
+// PYTORCH_FUSER_CACHE_DIR environment variable, and the cache is disabled
+// when it isn't set.
+
+struct CachedKernel {
+  // path of the compiled artifact
+  std::string path;
+  // name of the kernel in the artifact
+  std::string name;
+};
+
+// Returns the source of a kernel with its name replaced by a placeholder
+TORCH_API std::string kernelSourceKey(
+    const std::string& name,
+    const std::string& code);
+
+// Returns the artifact cached for key, if there is one.
+TORCH_API c10::optional<CachedKernel> lookupDiskCache(
+    const std::string& key,
+    const std::string& extension);
+
+// Stores the artifact compiled for key, which contains a kernel called
+// name. Failures to write are ignored (the kernel is compiled again the
+// next time).
+TORCH_API void storeInDiskCache(
+    const std::string& key,
+    const std::string& extension,
+    const std::string& name,
+    const std::string& artifact);
+
+// Reads a whole (binary) file, e.g. a cached artifact
+TORCH_API std::string readFile(const std::string& path);
+
+} // namespace fuser
+} // namespace jit
+} // namespace torch
+
+#endif // USE_CUDA_FUSER || USE_CPU_FUSER
@@ -149,7 +149,6 @@ static void compressContiguous(
     size_t total_size = sizes[cur];
     cur++;
     while (cont[cur-1] && cur < ndim) {
-      JIT_ASSERT(strides[cur-1] == sizes[cur]*strides[cur]);
       total_size *= sizes[cur];
       cur++;
     }
@@ -158,15 +157,25 @@ static void compressContiguous(
     compressed_dims++;
   }
 
-  if (ndim > 0) JIT_ASSERT(!cont.back() || strides.back() == 1);
+  // Checks that the strides are contiguous where cont says so. Dims of size 1
+  // are contiguous regardless of their stride (see TensorDesc::findContiguous).
+  int64_t expected_stride = 1;
+  for (int64_t i = static_cast<int64_t>(ndim) - 1; i >= 0; --i) {
+    if (sizes[i] == 1) continue;
+    JIT_ASSERT(!cont[i] || strides[i] == expected_stride);
+    expected_stride = sizes[i]*strides[i];
+  }
 }
 
 // Launches the requested fusion on the given device with the given inputs.
 // Output pointers are stored in outputs (to be put on the stack later).
+// Kernels ending in a reduction run once per row of the map size, and take
+// the length of the rows as their last argument.
 void launchFusion(
   const FusedKernel& fusion
 , const at::Device device
 , const at::ArrayRef<at::Tensor>& inputs
+, const c10::optional<ReductionInfo>& reduction
 , std::vector<at::Tensor>& outputs) {
   // Fails if fusion and given inputs disagree
   JIT_ASSERT(inputs.size() == fusion.inputDesc().size());
@@ -198,6 +207,15 @@ void launchFusion(
     numel = computeNumel(map_size);
   }
 
+  // Computes the size of the outputs and the number of rows to reduce
+  std::vector<int64_t> output_size(map_size.begin(), map_size.end());
+  uint32_t reduction_size = 1;
+  if (reduction) {
+    reduction_size = map_size.back();
+    numel /= reduction_size;
+    output_size.back() = 1;
+  }
+
   // Computes the storage needed to store TensorInfo structs for inputs and outputs.
   size_t uncompressedDim = fusion.inputDesc().at(0).contiguity.size();
   size_t maxPossibleTensorInfoSize = sizeof(TensorInfo) + 2 * sizeof(uint32_t) * uncompressedDim;
@@ -207,7 +225,7 @@ void launchFusion(
 
   // A vector of arguments to the kernel (numel, *input_desc_s, *output_desc_s)
   std::vector<void*> arguments;
-  arguments.reserve(3 + flat_inputs_size + flat_outputs_size);
+  arguments.reserve(4 + flat_inputs_size + flat_outputs_size);
   arguments.push_back(&numel);
 
   auto addTensorInfoRaw = [&](
@@ -257,7 +275,7 @@ void launchFusion(
   for (size_t i = 0; i < fusion.outputDesc().size(); ++i) {
     const auto& c = fusion.concatDesc()[i];
     if (c.isNoop()) {
-      outputs.push_back(at::empty(map_size, ref_options));
+      outputs.push_back(at::empty(output_size, ref_options));
       addTensorInfo(fusion.outputDesc()[i], outputs[i]);
     } else {
       size_t small_size = map_size[c.dim()];
@@ -277,7 +295,15 @@ void launchFusion(
     }
   }
 
+  if (reduction) {
+    arguments.push_back(&reduction_size);
+  }
+
   fusion.launch_raw(numel, arguments);
+
+  if (reduction && !reduction->keepdim()) {
+    outputs[0] = outputs[0].squeeze(-1);
+  }
 }
 
 
@@ -323,6 +349,11 @@ bool runFusion(
 
   // Tries to run fallback if map size can't be computed
   if (!maybe_map_size) return false;
+  // Reductions over empty rows (or 0-dim tensors) are left to the fallback
+  if (spec.reduction() &&
+      (maybe_map_size->empty() || maybe_map_size->back() == 0)) {
+    return false;
+  }
   expandArgs(spec, inputs, *maybe_map_size);
 
   // Retrieves the kernel, compiling (and caching) if necessary
@@ -337,7 +368,7 @@ bool runFusion(
 
   // Launches fusion
   std::vector<at::Tensor> outputs;
-  launchFusion(*(*maybe_kernel), device, inputs, outputs);
+  launchFusion(*(*maybe_kernel), device, inputs, spec.reduction(), outputs);
 
   // Updates stack
   drop(stack, spec.nInputs());
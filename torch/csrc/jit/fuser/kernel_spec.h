@@ -41,6 +41,20 @@ private:
   int64_t dim_;
 };
 
+// Helper struct describing a sum over the innermost dimension that ends the
+// kernel (see isFusableReductionNode in graph_fuser.cpp): whether the reduced
+// dimension is kept in the (single) output.
+struct TORCH_API ReductionInfo {
+  ReductionInfo(const bool _keepdim)
+  : keepdim_{_keepdim}
+  { };
+
+  bool keepdim() const { return keepdim_; }
+
+private:
+  bool keepdim_;
+};
+
  // "Kernel Specification." - Contains device-independent fusion information.
  // Each kernel specification contains a map of instantiated generated functions
  // that implement some or most of its functionality. Multiple generated
@@ -62,6 +76,7 @@ struct TORCH_API KernelSpec {
   , nInputs_{_graph->inputs().size()}
   , inputBroadcastGroups_{}
   , inputChunks_{}
+  , reduction_{}
   , kernels_{}
   { }
 
@@ -81,6 +96,9 @@ struct TORCH_API KernelSpec {
   std::vector<PartitionInfo>& inputChunks() { return inputChunks_; }
   const std::vector<PartitionInfo>& inputChunks() const { return inputChunks_; }
 
+  c10::optional<ReductionInfo>& reduction() { return reduction_; }
+  const c10::optional<ReductionInfo>& reduction() const { return reduction_; }
+
   // Cache functions
   c10::optional<std::shared_ptr<FusedKernel>> findKernel(const ArgSpec& arg_spec) const {
     std::lock_guard<std::mutex> guard{mutex_};
@@ -102,6 +120,7 @@ private:
   uint64_t nInputs_;
   std::vector<std::vector<int64_t>> inputBroadcastGroups_;
   std::vector<PartitionInfo> inputChunks_;
+  c10::optional<ReductionInfo> reduction_;
   mutable std::mutex mutex_;
   mutable std::unordered_map<
     ArgSpec
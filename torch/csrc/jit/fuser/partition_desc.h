@@ -30,12 +30,15 @@ struct TORCH_API PartitionDesc {
   , dim_{_dim} {
     JIT_ASSERT(nSubTensors_ > 1);
     std::vector<bool> cont = _desc.contiguity;
-    if (dim_ > 0) {
-      // when we narrow the concatenated output/chunked input
-      // we make the size[dim] smaller while keeping the stride[dim] the same,
-      // meaning: stride[dim - 1] != stride[dim]*size[dim]
-      // so dim - 1 is no longer contiguous
-      cont[dim_ - 1] = false;
+    // when we narrow the concatenated output/chunked input
+    // we make the size[dim] smaller while keeping the stride[dim] the same,
+    // meaning: stride[dim - 1] != stride[dim]*size[dim]
+    // so dim - 1 is no longer contiguous
+    // Note: dims of size 1 are skipped by contiguity (see TensorDesc), so
+    //  the dim made discontiguous may be any dim before dim. Sizes aren't
+    //  known here, so all of them are marked.
+    for (size_t i = 0; i < dim_; ++i) {
+      cont[i] = false;
     }
     subTensorDesc_.reset(new TensorDesc(_desc.scalar_type, cont));
   }
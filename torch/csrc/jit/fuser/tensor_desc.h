@@ -17,6 +17,10 @@ namespace torch { namespace jit { namespace fuser {
 // type information needed by the compiler for input/outputs
 // contiguity[i] is true if the dim i is contiguous with dim i + 1.
 // contiguity.back() == true means strides.back() == 1.
+// Dims of size 1 are always contiguous (their stride is never used), and are
+// skipped when checking whether the dim before them is contiguous, so that
+// the contiguity pattern, and thus the kernel, doesn't depend on whether
+// e.g. the batch size happens to be 1.
 struct TORCH_API TensorDesc {
   at::ScalarType scalar_type;
   std::vector<bool> contiguity;
@@ -59,9 +63,14 @@ struct TORCH_API TensorDesc {
   , const at::IntList& strides) {
     JIT_ASSERT(sizes.size() == strides.size());
     std::vector<bool> cont(sizes.size());
-    for (size_t i = 0; i < sizes.size(); ++i) {
-      const auto expected_stride = (i + 1 < sizes.size()) ? sizes[i+1]*strides[i+1] : 1;
+    int64_t expected_stride = 1;
+    for (int64_t i = static_cast<int64_t>(sizes.size()) - 1; i >= 0; --i) {
+      if (sizes[i] == 1) {
+        cont[i] = true;
+        continue;
+      }
       cont[i] = (strides[i] == expected_stride);
+      expected_stride = sizes[i]*strides[i];
     }
     return cont;
   }
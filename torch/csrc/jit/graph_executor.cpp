@@ -21,6 +21,7 @@
 #include "torch/csrc/jit/passes/specialize_undef.h"
 #include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/lower_grad_of.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
 #include "torch/csrc/jit/passes/constant_propagation.h"
 #include "torch/csrc/jit/passes/inline_autodiff_subgraphs.h"
 #include "torch/csrc/jit/passes/requires_grad_analysis.h"
@@ -32,6 +33,7 @@
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/jit/script/compiler.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -44,6 +46,8 @@ namespace torch { namespace jit {
 
 namespace {
 
+std::atomic<bool> shape_specialization_enabled{false};
+
 using tensor_list = std::vector<at::Tensor>;
 using Variable = autograd::Variable;
 using autograd::variable_list;
@@ -359,6 +363,20 @@ struct GraphExecutorImpl {
       return fallback.graph;
     }
 
+    if (memoryPlanningEnabled() && !autograd::GradMode::is_enabled() &&
+        num_flat_inputs == num_inputs) {
+      auto planned = planned_cache.find(CompleteArgumentSpec(false, inputs));
+      if (planned != planned_cache.end())
+        return planned->second.graph;
+    }
+
+    if (shapeSpecializationEnabled() && num_flat_inputs == num_inputs) {
+      auto profile = shape_profiles.find(spec);
+      if (profile != shape_profiles.end() && profile->second.specialized_plan &&
+          matchesShapes(*profile->second.specialized_spec, inputs))
+        return profile->second.specialized_plan.graph;
+    }
+
     auto it = plan_cache.find(spec);
     AT_CHECK(it != plan_cache.end(), "No graph found for given inputs");
     return it->second.graph;
@@ -398,11 +416,25 @@ private:
   }
 
   const ExecutionPlan & getOrCompile(const Stack& stack) {
+    // Memory planning needs the exact sizes of all inputs, and is only done
+    // when no gradients are needed (the planned intermediate values couldn't
+    // be saved for backward).
+    if (memoryPlanningEnabled() && !autograd::GradMode::is_enabled() &&
+        num_flat_inputs == num_inputs) {
+      if (auto plan = getOrCompilePlanned(stack)) {
+        return *plan;
+      }
+    }
     // outside lock guard, to minimize the time holding the lock on the fast path
     // ArgumentSpec even computes its hashCode here.
     ArgumentSpec spec(autograd::GradMode::is_enabled(), last(stack, num_inputs), num_flat_inputs);
     {
       std::lock_guard<std::mutex> lock(compile_mutex);
+      if (shapeSpecializationEnabled() && num_flat_inputs == num_inputs) {
+        if (auto plan = getShapeSpecialized(spec, last(stack, num_inputs))) {
+          return *plan;
+        }
+      }
       auto it = plan_cache.find(spec);
       if (it != plan_cache.end())
         return it->second;
@@ -412,9 +444,81 @@ private:
     }
   }
 
-  ExecutionPlan compileSpec(const ArgumentSpec & spec) {
+  // Whether the tensors of inputs have the sizes and strides recorded in
+  // complete_spec. The rest of what it records is already known to match,
+  // since it's part of the ArgumentSpec of the inputs.
+  static bool matchesShapes(const CompleteArgumentSpec& complete_spec, at::ArrayRef<IValue> inputs) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      auto info = complete_spec.at(i);
+      if (!info.isTensor() || !info.defined())
+        continue;
+      const auto& t = inputs[i].toTensor();
+      if (t.sizes() != info.sizes() || t.strides() != info.strides())
+        return false;
+    }
+    return true;
+  }
+
+  // Profiles the shapes of the inputs during the first shape_profiling_runs
+  // runs with a given ArgumentSpec, and then compiles a plan specialized to
+  // the shapes seen in most of them, if any. Afterwards, returns that plan
+  // for the inputs of these shapes, and nullptr for any others (and while
+  // profiling), in which case the generic plan for spec should be used.
+  // Must be called with compile_mutex held.
+  const ExecutionPlan * getShapeSpecialized(const ArgumentSpec& spec, at::ArrayRef<IValue> inputs) {
+    auto& profile = shape_profiles[spec];
+    if (profile.num_runs == shape_profiling_runs) {
+      if (profile.specialized_plan && matchesShapes(*profile.specialized_spec, inputs))
+        return &profile.specialized_plan;
+      return nullptr;
+    }
+    profile.shape_counts[CompleteArgumentSpec(autograd::GradMode::is_enabled(), inputs)]++;
+    if (++profile.num_runs < shape_profiling_runs)
+      return nullptr;
+    auto dominant = std::max_element(
+        profile.shape_counts.begin(), profile.shape_counts.end(),
+        [](const std::pair<const CompleteArgumentSpec, size_t>& a,
+           const std::pair<const CompleteArgumentSpec, size_t>& b) {
+          return a.second < b.second;
+        });
+    if (2 * dominant->second > shape_profiling_runs) {
+      profile.specialized_spec.reset(new CompleteArgumentSpec(dominant->first));
+      profile.specialized_plan = compileSpec(spec, profile.specialized_spec.get());
+    }
+    profile.shape_counts.clear();
+    return nullptr;
+  }
+
+  // Returns nullptr once planned_cache is full, in which case the regular
+  // plan should be used.
+  const ExecutionPlan * getOrCompilePlanned(const Stack& stack) {
+    CompleteArgumentSpec complete_spec(false, last(stack, num_inputs));
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    auto it = planned_cache.find(complete_spec);
+    if (it != planned_cache.end())
+      return &it->second;
+    if (planned_cache.size() >= max_planned_specs)
+      return nullptr;
+    ArgumentSpec spec(false, last(stack, num_inputs), num_flat_inputs);
+    auto plan = compileSpec(spec, &complete_spec);
+    auto r = planned_cache.emplace(std::move(complete_spec), std::move(plan));
+    return &r.first->second;
+  }
+
+  ExecutionPlan compileSpec(const ArgumentSpec & spec, const CompleteArgumentSpec * complete_spec = nullptr) {
     auto opt_graph = graph->copy();
     setInputTypes(*opt_graph, spec);
+    if (complete_spec) {
+      auto inputs = opt_graph->inputs();
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        auto info = complete_spec->at(i);
+        if (info.isTensor() && info.defined()) {
+          inputs[i]->setType(CompleteTensorType::create(
+              info.type(), ConvertIntToCPUOrCUDA(info.device()),
+              info.sizes(), info.strides(), info.requires_grad()));
+        }
+      }
+    }
 
     // Phase 1. Specialize to input definedness (this is very important for
     //          gradient graphs), and run required passes to bring the graph
@@ -452,6 +556,12 @@ private:
     }
     // Make sure there are no leftovers from any passes.
     EliminateDeadCode(opt_graph);
+    // Phase 6. With all shapes known, lay out the intermediate values in
+    //          preallocated arenas (when no gradients are needed, see
+    //          getOrCompile).
+    if (complete_spec && memoryPlanningEnabled() && !autograd::GradMode::is_enabled()) {
+      PlanMemory(opt_graph);
+    }
     return ExecutionPlan(opt_graph);
   }
 
@@ -544,8 +654,28 @@ private:
   // specialized to the spec.
   std::unordered_map<ArgumentSpec, ExecutionPlan> plan_cache;
 
+  // Versions of the graph with memory planning, specialized to exact input
+  // sizes. Only used when memory planning is enabled, and limited to a few
+  // entries, because graphs run with varying sizes would otherwise grow it
+  // without bound (and keep an arena alive per entry).
+  std::unordered_map<CompleteArgumentSpec, ExecutionPlan> planned_cache;
+  static constexpr size_t max_planned_specs = 8;
+
+  // The shapes seen in the first runs with an ArgumentSpec, and the plan
+  // specialized to the dominant ones. Only used when shape specialization is
+  // enabled, see getShapeSpecialized.
+  struct ShapeProfile {
+    size_t num_runs = 0;
+    std::unordered_map<CompleteArgumentSpec, size_t> shape_counts;
+    std::unique_ptr<CompleteArgumentSpec> specialized_spec;
+    ExecutionPlan specialized_plan;
+  };
+  std::unordered_map<ArgumentSpec, ShapeProfile> shape_profiles;
+  static constexpr size_t shape_profiling_runs = 8;
+
   // GraphExecutors can be accessed from multiple threads, so this thread needs to be
-  // held every time we access the fallback or plan_cache.
+  // held every time we access the fallback, plan_cache, planned_cache or
+  // shape_profiles.
   std::mutex compile_mutex;
 
   // Some tunable parameters
@@ -553,6 +683,14 @@ private:
   size_t autodiffSubgraphInlineThreshold = 5;
 };
 
+bool shapeSpecializationEnabled() {
+  return shape_specialization_enabled;
+}
+
+void setShapeSpecializationEnabled(bool value) {
+  shape_specialization_enabled = value;
+}
+
 GraphExecutor::GraphExecutor(std::shared_ptr<Graph> graph, bool optimize)
 : pImpl(new GraphExecutorImpl(std::move(graph), optimize)) {}
 
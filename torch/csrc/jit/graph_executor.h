@@ -41,6 +41,13 @@ private:
   std::shared_ptr<GraphExecutorImpl> pImpl;
 };
 
+// Whether graph executors profile the input shapes of their first runs, and
+// then use a plan specialized to the shapes seen most often (with complete
+// shape information for the fuser, and memory planning if enabled), guarded
+// by a check of the input shapes. Off by default.
+TORCH_API bool shapeSpecializationEnabled();
+TORCH_API void setShapeSpecializationEnabled(bool value);
+
 // These passes need to run before it is valid to pass to the interpreter
 // regardless of whether sizes have been specialized or not.
 TORCH_API void runRequiredPasses(const std::shared_ptr<Graph>& g);
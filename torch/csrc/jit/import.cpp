@@ -363,9 +363,8 @@ at::Tensor MethodDecoder::buildTensor(const onnx::TensorProto& tensor_proto) {
 
 ScriptModuleDeserializer::ScriptModuleDeserializer(const std::string& filename)
     : ifs_(filename, std::ifstream::in | std::ifstream::binary),
-      reader_(&ifs_) {
-  // TODO appropriate support for mmap, right now still use stream reader
-}
+      // The tensors loaded from the file point into the mapping
+      reader_(&ifs_, mapPyTorchFile(filename)) {}
 
 ScriptModuleDeserializer::ScriptModuleDeserializer(std::istream* is)
     : ifs_(), reader_(is) {}
@@ -523,10 +522,12 @@ void import_ir_module(
   deserializer.deserialize(module_lookup);
 }
 
-std::shared_ptr<script::Module> load(std::istream& in) {
-  auto module = std::make_shared<script::Module>();
+namespace {
 
-  auto module_lookup = [&](const std::vector<std::string>& qualified_name) {
+// Returns a lookup that creates the submodules of `module` as they are
+// looked up
+ModuleLookup submoduleLookup(const std::shared_ptr<script::Module>& module) {
+  return [module](const std::vector<std::string>& qualified_name) {
     std::shared_ptr<script::Module> curr = module;
     for (const auto& name : qualified_name) {
       if (curr->find_module(name) == nullptr) {
@@ -536,19 +537,30 @@ std::shared_ptr<script::Module> load(std::istream& in) {
     }
     return curr;
   };
+}
+
+}  // namespace
+
+std::shared_ptr<script::Module> load(std::istream& in) {
+  auto module = std::make_shared<script::Module>();
 
   ScriptModuleDeserializer deserializer(&in);
-  deserializer.deserialize(module_lookup);
+  deserializer.deserialize(submoduleLookup(module));
 
   return module;
 }
 
 std::shared_ptr<script::Module> load(const std::string& filename) {
-  std::ifstream in(filename, std::ios_base::binary);
+  {
+    std::ifstream in(filename, std::ios_base::binary);
+    AT_CHECK(! in.fail(), "load: could not open file ", filename);
+  }
 
-  AT_CHECK(! in.fail(), "load: could not open file ", filename);
+  auto module = std::make_shared<script::Module>();
 
-  auto module = load(in);
+  // Maps the file, so the parameters are loaded without copying them
+  ScriptModuleDeserializer deserializer(filename);
+  deserializer.deserialize(submoduleLookup(module));
 
   return module;
 }
@@ -28,6 +28,10 @@ TORCH_API std::shared_ptr<script::Module> load(std::istream& in);
 /// The file stored at the location given in `filename` must contain a
 /// serialized `script::Module`, exported either via `ScriptModule.save()` in
 /// Python or `torch::jit::ExportModule` in C++.
+///
+/// The file is memory-mapped, and the parameters of the module point into the
+/// mapping instead of being copied. Pages are copied once they are written to;
+/// the file itself is never modified.
 TORCH_API std::shared_ptr<script::Module> load(const std::string& filename);
 
 } // namespace jit
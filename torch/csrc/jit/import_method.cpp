@@ -8,12 +8,15 @@ namespace torch { namespace jit {
 // and methods. It does not depend on python to work.
 struct ModuleAccessorValue : public script::SugaredValue {
   ModuleAccessorValue(std::shared_ptr<script::Module> module)
-  : module(std::move(module)) {}
+  : module_(std::move(module)) {}
   std::string kind() const override {
     return "module";
   }
   // select an attribute on it, e.g. `this.field`
   std::shared_ptr<SugaredValue> attr(SourceRange loc, script::Method & m, const std::string& field) override {
+    // the module is alive while one of its methods is compiled
+    auto module = module_.lock();
+    JIT_ASSERT(module);
     if(script::NamedModule* v = module->find_module(field)) {
       return std::make_shared<ModuleAccessorValue>(v->module);
     } else if(script::NamedParameter* v = module->find_parameter(field)) {
@@ -24,7 +27,9 @@ struct ModuleAccessorValue : public script::SugaredValue {
     return script::SugaredValue::attr(loc, m, field);
   }
 private:
-  std::shared_ptr<script::Module> module;
+  // the methods of the module, which are compiled when first used, hold
+  // this value
+  std::weak_ptr<script::Module> module_;
 };
 
 struct ConstantValue : public script::SugaredValue {
@@ -41,8 +46,8 @@ struct ConstantValue : public script::SugaredValue {
 // in the 'constants' vector. This table is will be stored in a container format
 // and given to the import_method when restoring the code.
 struct ConstantTableValue : public script::SugaredValue {
-  ConstantTableValue(ArrayRef<at::Tensor> constants)
-  : constants_(constants) {}
+  ConstantTableValue(std::shared_ptr<std::vector<at::Tensor>> constants)
+  : constants_(std::move(constants)) {}
   std::string kind() const override {
     return "CONSTANTS";
   }
@@ -53,17 +58,18 @@ struct ConstantTableValue : public script::SugaredValue {
     int64_t offset = std::strtoll(field_s + 1, &end, 10);
     if(field.size() < 2 || *end != 0)
       throw script::ErrorReport(loc) << "invalid constant specifier: " << field;
-    if (offset < 0 || size_t(offset) >= constants_.size()) {
+    if (offset < 0 || size_t(offset) >= constants_->size()) {
       throw script::ErrorReport(loc) << "constant index " << offset
                                      << " is out of bounds (constant table has "
-                                     << constants_.size() << " entries).";
+                                     << constants_->size() << " entries).";
     }
-    Value* value = m.graph()->insertConstant(constants_[offset], loc);
+    Value* value = m.graph()->insertConstant((*constants_)[offset], loc);
     return std::make_shared<script::SimpleValue>(value);
   }
 
  private:
-   ArrayRef<at::Tensor> constants_;
+   // shared by the methods, which are compiled when first used
+   std::shared_ptr<std::vector<at::Tensor>> constants_;
 };
 
 static size_t parseVersionNumber(script::Lexer& L) {
@@ -85,20 +91,24 @@ void import_method(const std::shared_ptr<script::Module>& mod, const std::string
 
   size_t version = parseVersionNumber(p.lexer());
 
-  std::unordered_map<std::string, std::shared_ptr<script::SugaredValue>> env = {
+  // The methods are compiled when first used, so the resolver owns what it
+  // resolves names to
+  auto env = std::make_shared<std::unordered_map<std::string, std::shared_ptr<script::SugaredValue>>>();
+  *env = {
     {"aten", std::make_shared<script::BuiltinModule>("aten", version)},
     {"prim", std::make_shared<script::BuiltinModule>("prim", version)},
-    {"CONSTANTS", std::make_shared<ConstantTableValue>(constant_table)},
+    {"CONSTANTS", std::make_shared<ConstantTableValue>(
+        std::make_shared<std::vector<at::Tensor>>(constant_table))},
     {"fork", std::make_shared<script::ForkValue>()},
     {"annotate", std::make_shared<script::AnnotateValue>()},
     {"inf", std::make_shared<ConstantValue>(std::numeric_limits<double>::infinity())},
     {"nan", std::make_shared<ConstantValue>(std::numeric_limits<double>::quiet_NaN())},
   };
 
-  auto resolver = [&](const std::string& name, script::Method& m, const SourceRange& loc)
+  auto resolver = [env](const std::string& name, script::Method& m, const SourceRange& loc)
   -> std::shared_ptr<script::SugaredValue> {
-    auto it = env.find(name);
-    if (it == env.end())
+    auto it = env->find(name);
+    if (it == env->end())
       return nullptr;
     return it->second;
   };
@@ -112,7 +122,7 @@ void import_method(const std::shared_ptr<script::Module>& mod, const std::string
     resolvers.emplace_back(resolver);
   }
   auto self = std::make_shared<ModuleAccessorValue>(mod);
-  script::defineMethodsInModule(mod, definitions, resolvers, self);
+  script::defineMethodsInModule(mod, definitions, resolvers, self, /*lazily=*/true);
 }
 
 }}
@@ -28,6 +28,8 @@
 #include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/to_batch.h"
 #include "torch/csrc/jit/passes/lower_tuples.h"
+#include "torch/csrc/jit/passes/memory_planning.h"
+#include "torch/csrc/jit/passes/calibration.h"
 #include "torch/csrc/jit/passes/specialize_undef.h"
 #include "torch/csrc/jit/graph_executor.h"
 #include "torch/csrc/jit/script/init.h"
@@ -36,11 +38,14 @@
 #include "torch/csrc/jit/pybind_utils.h"
 #include "torch/csrc/jit/function_schema.h"
 #include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/script/module.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/jit/fuser/interface.h"
 #include "torch/csrc/jit/script/jit_exception.h"
 
 #include "caffe2/serialize/inline_container.h"
 
+#include <ATen/Parallel.h>
 #include <pybind11/functional.h>
 
 #include <memory>
@@ -52,13 +57,78 @@
 
 namespace torch  { namespace jit {
 
-// TODO: make a fake future for python
-namespace detail {
-class Future {
+namespace {
 
+// The future returned by fork() when called from Python. Script functions
+// and methods run asynchronously on the inter-op pool (see at::launch), and
+// fut completes with their result. Other callables are run right away, and
+// their result is kept in value.
+struct PythonFutureWrapper {
+  c10::intrusive_ptr<Future> fut;
+  py::object value;
 };
+
+PythonFutureWrapper forkFromPython(py::args args, py::kwargs kwargs) {
+  if (args.size() < 1) {
+    throw std::runtime_error("fork() expects a function to run");
+  }
+  py::object f = args[0];
+  script::Method* method = nullptr;
+  if (py::isinstance<script::Method>(f)) {
+    method = &py::cast<script::Method&>(f);
+  } else if (py::isinstance<script::Module>(f)) {
+    method = &py::cast<script::Module&>(f).get_method("forward");
+  }
+
+  PythonFutureWrapper result;
+  if (!method) {
+    py::tuple f_args(args.size() - 1);
+    for (size_t i = 1; i < args.size(); ++i) {
+      f_args[i - 1] = args[i];
+    }
+    result.value = f(*f_args, **kwargs);
+    return result;
+  }
+
+  auto stack = createStackForSchema(
+      method->getSchema(), tuple_slice(std::move(args), 1), std::move(kwargs));
+  auto fut = c10::make_intrusive<Future>();
+  result.fut = fut;
+  // Keeps the module owning the method alive until it ran; released with
+  // the GIL held, once the result is set.
+  PyObject* keep_alive = f.release().ptr();
+  bool grad_enabled = autograd::GradMode::is_enabled();
+  at::launch([method, stack, fut, keep_alive, grad_enabled]() mutable {
+    {
+      autograd::AutoGradMode grad_mode(grad_enabled);
+      try {
+        method->run(stack);
+        fut->markCompleted(
+            stack.size() == 1 ? std::move(stack[0])
+                              : IValue(Tuple::create(std::move(stack))));
+      } catch (const std::exception& e) {
+        fut->markCompleted(Future::FutureError(e.what()));
+      }
+    }
+    AutoGIL gil;
+    Py_DECREF(keep_alive);
+  });
+  return result;
+}
+
+py::object waitFromPython(PythonFutureWrapper& fut) {
+  if (!fut.fut) {
+    return fut.value;
+  }
+  {
+    AutoNoGIL no_gil;
+    fut.fut->wait();
+  }
+  return toPyObject(fut.fut->value());
 }
 
+} // anonymous namespace
+
 namespace {
 
 using autograd::variable_list;
@@ -155,6 +225,24 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_canonicalize_ops", CanonicalizeOps)
    .def("_jit_pass_specialize_undef", specializeUndef)
    .def("_jit_override_can_fuse_on_cpu", &overrideCanFuseOnCPU)
+   .def("_jit_fuser_n_compiled_kernels", &nCompiledKernels)
+   .def("_jit_pass_plan_memory", PlanMemory)
+   .def("_jit_set_memory_planning_enabled", &setMemoryPlanningEnabled)
+   .def("_jit_memory_planning_enabled", &memoryPlanningEnabled)
+   .def("_jit_set_shape_specialization_enabled", &setShapeSpecializationEnabled)
+   .def("_jit_shape_specialization_enabled", &shapeSpecializationEnabled)
+   .def("_jit_set_autodiff_recompute_threshold", &setAutodiffRecomputeThreshold)
+   .def("_jit_autodiff_recompute_threshold", &autodiffRecomputeThreshold)
+   .def("_jit_pass_insert_calibration_observers", [](
+       std::shared_ptr<Graph>& g,
+       const std::shared_ptr<Calibration>& calibration,
+       const std::vector<std::string>& kinds) {
+     std::unordered_set<Symbol> symbols;
+     for (const auto& kind : kinds) {
+       symbols.insert(Symbol::fromQualString(kind));
+     }
+     return InsertCalibrationObservers(g, calibration, symbols);
+   }, py::arg("graph"), py::arg("calibration"), py::arg("kinds") = std::vector<std::string>())
    .def("_jit_differentiate", [](Graph &g) {
        // the python binding slightly differs in semantics
        // it makes a copy of the input Graph, and works on that
@@ -163,6 +251,28 @@ void initJITBindings(PyObject *module) {
        return differentiate(g_clone);
    });
 
+  py::class_<Calibration, std::shared_ptr<Calibration>>(m, "Calibration")
+      .def(py::init<int64_t>(), py::arg("nbins") = 2048)
+      .def("names", &Calibration::names)
+      .def(
+          "quantization_params",
+          [](Calibration& self,
+             const std::string& kind,
+             int64_t precision,
+             bool preserve_sparsity) {
+            // name -> (scale, zero_point)
+            py::dict result;
+            for (const auto& entry :
+                 self.quantizationParams(kind, precision, preserve_sparsity)) {
+              result[py::str(entry.first)] = py::make_tuple(
+                  entry.second.scale, entry.second.zero_point);
+            }
+            return result;
+          },
+          py::arg("kind") = "min_max",
+          py::arg("precision") = 8,
+          py::arg("preserve_sparsity") = false);
+
   py::class_<CompleteArgumentSpec>(m, "CompleteArgumentSpec")
       .def("__repr__", [](CompleteArgumentSpec& self) {
         std::ostringstream s;
@@ -328,16 +438,19 @@ void initJITBindings(PyObject *module) {
       });
   });
 
-  py::class_<detail::Future>(m, "Future");
+  py::class_<PythonFutureWrapper>(m, "Future");
 
-  m.def("fork", [](script::Module &sm, py::args args) {
-    // TODO: this is a fake stub
-    return detail::Future();
-  });
+  m.def("fork", forkFromPython, R"(
+Runs fn(*args, **kwargs) asynchronously and returns a Future of its result,
+to be passed to wait(). Script functions and methods run on the inter-op
+thread pool, concurrently with the caller; other functions are run before
+fork() returns. In script code, the forked function runs concurrently too.
+)");
 
-  m.def("wait", [](detail::Future &fut) {
-    // TODO: this is a fake stub
-  });
+  m.def("wait", waitFromPython, R"(
+Waits for the result of a Future returned by fork(), and returns it.
+Errors raised by the forked function are raised here.
+)");
 
 
   initPythonIRBindings(module);
@@ -14,6 +14,8 @@
 #include "torch/csrc/variable_tensor_functions.h"
 #include "torch/csrc/jit/script/jit_exception.h"
 
+#include <ATen/Parallel.h>
+
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -349,9 +351,31 @@ struct UseList {
   ListHandle<bool> free_flags;
 };
 
+// Control flow and a few cheap prim ops are executed by the interpreter loop
+// itself, reading and writing registers directly, instead of through an
+// Operation and the stack. For small graphs (and for loop bookkeeping, which
+// desugarTripCounts turns into int arithmetic) the cost of calling the
+// std::function and moving IValues on and off the stack dominates.
+enum class OpCode : uint8_t {
+  OP, // call inst.callback
+  ASSIGN, // move inputs to outputs
+  JUMP, // jump by inst.arg
+  JUMP_TRUE, // pop a bool, jump by inst.arg if true
+  JUMP_FALSE, // pop a bool, jump by inst.arg if false
+  CONSTANT, // load constants[inst.arg]
+  TUPLE_CONSTRUCT,
+  TUPLE_UNPACK,
+  INT_OP, // binary op on two ints, inst.arg is the BinaryOp
+  BOOL_OP, // binary op on two bools, inst.arg is the BinaryOp
+};
+
+enum BinaryOp : int { ADD, SUB, MUL, AND, OR, EQ, NE, LT, GT, LE, GE };
+
 // one instruction plus meta-data
 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
 struct Instruction {
+  OpCode op = OpCode::OP;
+  int arg = 0;
   Operation callback;
   UseList inputs;
   ListHandle<int> outputs;
@@ -375,11 +399,8 @@ struct CodeImpl {
   void createJumpFalse(int from_inst, int to_inst) {
     auto & inst = instructions[from_inst];
     JIT_ASSERT(inst.debug_name == prim::Placeholder);
-    auto offset = relativeJump(from_inst, to_inst);
-    inst.callback = [offset](Stack & stack) {
-      auto t = pop(stack).toBool();
-      return t ? 0 : offset;
-    };
+    inst.op = OpCode::JUMP_FALSE;
+    inst.arg = relativeJump(from_inst, to_inst);
     inst.debug_name = prim::JumpZ;
   }
 
@@ -387,21 +408,16 @@ struct CodeImpl {
   void createJumpTrue(int from_inst, int to_inst) {
     auto & inst = instructions[from_inst];
     JIT_ASSERT(inst.debug_name == prim::Placeholder);
-    auto offset = relativeJump(from_inst, to_inst);
-    inst.callback = [offset](Stack & stack) {
-      auto t = pop(stack).toBool();
-      return t ? offset : 0;
-    };
+    inst.op = OpCode::JUMP_TRUE;
+    inst.arg = relativeJump(from_inst, to_inst);
     inst.debug_name = prim::JumpNZ;
   }
 
   void createJump(int from_inst, int to_inst) {
     auto & inst = instructions[from_inst];
     JIT_ASSERT(inst.debug_name == prim::Placeholder);
-    auto offset = relativeJump(from_inst, to_inst);
-    inst.callback = [=](Stack & stack) {
-      return offset;
-    };
+    inst.op = OpCode::JUMP;
+    inst.arg = relativeJump(from_inst, to_inst);
     inst.debug_name = prim::Jump;
   }
 
@@ -486,9 +502,76 @@ struct CodeImpl {
 
   size_t insertInstruction(Node * n) {
     auto inst = insertInstruction(n->kind(), n->getSourceLocation(), n->inputs(), moveFlags(n) , n->outputs());
-    instructions[inst].callback = getOperation(n);
+    if (!resolveInline(n, instructions[inst])) {
+      instructions[inst].callback = getOperation(n);
+    }
     return inst;
   }
+
+  // Sets up inst to be executed inline by the interpreter, if n is one of
+  // the ops it handles. Returns false otherwise.
+  bool resolveInline(Node * n, Instruction & inst) {
+    switch (n->kind()) {
+      case prim::Constant: {
+        // lists are left to the operator, which creates a fresh list on every
+        // run, in case it gets mutated
+        auto type = n->output()->type();
+        if (!type->isSubtypeOf(DynamicType::get()) &&
+            !type->isSubtypeOf(NumberType::get()) &&
+            !type->isSubtypeOf(BoolType::get()) &&
+            type != StringType::get()) {
+          return false;
+        }
+        inst.op = OpCode::CONSTANT;
+        inst.arg = constants.size();
+        constants.push_back(*toIValue(n->output()));
+        return true;
+      }
+      case prim::TupleConstruct:
+        inst.op = OpCode::TUPLE_CONSTRUCT;
+        return true;
+      case prim::TupleUnpack:
+        inst.op = OpCode::TUPLE_UNPACK;
+        return true;
+      default:
+        break;
+    }
+
+    if (n->inputs().size() != 2 || n->outputs().size() != 1) {
+      return false;
+    }
+    auto binaryOp = [&]() -> int {
+      switch (n->kind()) {
+        case aten::add: return ADD;
+        case aten::sub: return SUB;
+        case aten::mul: return MUL;
+        case aten::__and__: return AND;
+        case aten::__or__: return OR;
+        case aten::eq: return EQ;
+        case aten::ne: return NE;
+        case aten::lt: return LT;
+        case aten::gt: return GT;
+        case aten::le: return LE;
+        case aten::ge: return GE;
+        default: return -1;
+      }
+    }();
+    if (binaryOp < 0) {
+      return false;
+    }
+    auto ofType = [&](const TypePtr & type) {
+      return *n->input(0)->type() == *type && *n->input(1)->type() == *type;
+    };
+    if (ofType(IntType::get())) {
+      inst.op = OpCode::INT_OP;
+    } else if (ofType(BoolType::get()) && (binaryOp == AND || binaryOp == OR)) {
+      inst.op = OpCode::BOOL_OP;
+    } else {
+      return false;
+    }
+    inst.arg = binaryOp;
+    return true;
+  }
   size_t insertInstruction(Symbol sym,
                            std::shared_ptr<SourceLocation> debug_location,
                                  ArrayRef<Value*> inputs,
@@ -524,7 +607,7 @@ struct CodeImpl {
     // This node effectively forwards its inputs into different places in a register list.
     // We don't need to manipulate the stack in any way, because all inputs are also outputs,
     // and the interpreter will take care of putting them in correct places.
-    instructions[inst].callback = [](Stack& stack) { return 0; };
+    instructions[inst].op = OpCode::ASSIGN;
     return inst;
   }
 
@@ -632,20 +715,61 @@ struct CodeImpl {
   friend struct InterpreterState;
   std::vector<Instruction> instructions;
   int register_size = 0;
+  // values of the prim::Constant nodes handled inline
+  std::vector<IValue> constants;
 
   // all memory ArrayRef<int> are slices of this, to make sure
   // the interpreter is mostly linearly scanning through memory
   std::vector<int> int_data;
   std::vector<bool> bool_data;
+
+  // The register tables of the finished runs, which the next runs reuse
+  // instead of allocating theirs. A few are kept, for the runs of a few
+  // threads at a time.
+  static constexpr size_t kMaxSpareRegisters = 4;
+  std::vector<std::vector<IValue>> spare_registers;
+  std::mutex spare_registers_mutex;
+
+  std::vector<IValue> takeRegisters() {
+    {
+      std::lock_guard<std::mutex> guard(spare_registers_mutex);
+      if (!spare_registers.empty()) {
+        auto registers = std::move(spare_registers.back());
+        spare_registers.pop_back();
+        return registers;
+      }
+    }
+    return std::vector<IValue>(register_size);
+  }
+
+  void returnRegisters(std::vector<IValue> registers) {
+    if (registers.size() != static_cast<size_t>(register_size)) {
+      return;
+    }
+    // most registers were moved from by their last use, the others hold
+    // values which must not outlive the run
+    for (auto& reg : registers) {
+      reg = IValue();
+    }
+    std::lock_guard<std::mutex> guard(spare_registers_mutex);
+    if (spare_registers.size() < kMaxSpareRegisters) {
+      spare_registers.push_back(std::move(registers));
+    }
+  }
 };
 
+constexpr size_t CodeImpl::kMaxSpareRegisters;
+
 // InterpreterState state that and used to compute a Code
 struct InterpreterStateImpl : c10::intrusive_ptr_target {
   InterpreterStateImpl(const Code & code)
   : function(code.pImpl),
     int_data(function->int_data.data()),
     bool_data(function->bool_data),
-    registers(function->register_size) {
+    registers(function->takeRegisters()) {
+  }
+  ~InterpreterStateImpl() {
+    function->returnRegisters(std::move(registers));
   }
 
  private:
@@ -664,8 +788,30 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
         // std::cout << "\n";
         auto & inst = instructions[pc];
         try {
+          if (runInline(inst)) {
+            ++pc;
+            continue;
+          }
           loadTensorsFromRegisters(inst.inputs, stack);
-          size_t new_pc = pc + 1 + inst.callback(stack);
+          size_t new_pc = pc + 1;
+          switch (inst.op) {
+            case OpCode::OP:
+              new_pc += inst.callback(stack);
+              break;
+            case OpCode::JUMP:
+              new_pc += inst.arg;
+              break;
+            case OpCode::JUMP_TRUE:
+              if (pop(stack).toBool())
+                new_pc += inst.arg;
+              break;
+            case OpCode::JUMP_FALSE:
+              if (!pop(stack).toBool())
+                new_pc += inst.arg;
+              break;
+            default:
+              break;
+          }
           for (int i = inst.outputs.size - 1; i >= 0; --i) {
             int reg = get(inst.outputs, i);
             registers[reg] = pop(stack);
@@ -678,15 +824,17 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
 
           getOrCreateFuture();
 
-          InterpreterState state(intrusive_from_this());
-          e.future->addCallback([state](){
-            c10::global_work_queue.schedule(InterpreterContinuation(state, Stack()));
-          });
-
           if (get(inst.inputs.free_flags, 0)) {
             // make sure the register is not freed once we are waked up
             registers[get(inst.inputs.values, 0)] = e.future;
           }
+
+          // The continuation may start on another thread as soon as the
+          // callback is added, so this state must not be touched afterwards.
+          InterpreterState state(intrusive_from_this());
+          e.future->addCallback([state](){
+            at::launch(InterpreterContinuation(state, Stack()));
+          });
           return true;
         } catch(std::exception & e) {
           if (!instructions[pc].debug_location) {
@@ -749,6 +897,69 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
   bool get(const ListHandle<bool> & list, int i) {
     return bool_data[list.start + i];
   }
+  // Executes the instructions that read their inputs straight from the
+  // registers. Returns false for the ones that go through the stack.
+  bool runInline(const Instruction & inst) {
+    switch (inst.op) {
+      case OpCode::CONSTANT:
+        registers[get(inst.outputs, 0)] = function->constants[inst.arg];
+        return true;
+      case OpCode::INT_OP: {
+        int64_t a = registers[get(inst.inputs.values, 0)].toInt();
+        int64_t b = registers[get(inst.inputs.values, 1)].toInt();
+        auto & out = registers[get(inst.outputs, 0)];
+        switch (inst.arg) {
+          case ADD: out = a + b; break;
+          case SUB: out = a - b; break;
+          case MUL: out = a * b; break;
+          case AND: out = a & b; break;
+          case OR: out = a | b; break;
+          case EQ: out = a == b; break;
+          case NE: out = a != b; break;
+          case LT: out = a < b; break;
+          case GT: out = a > b; break;
+          case LE: out = a <= b; break;
+          case GE: out = a >= b; break;
+        }
+        return true;
+      }
+      case OpCode::BOOL_OP: {
+        bool a = registers[get(inst.inputs.values, 0)].toBool();
+        bool b = registers[get(inst.inputs.values, 1)].toBool();
+        registers[get(inst.outputs, 0)] = inst.arg == AND ? a && b : a || b;
+        return true;
+      }
+      case OpCode::TUPLE_CONSTRUCT: {
+        std::vector<IValue> elems;
+        elems.reserve(inst.inputs.values.size);
+        for (int i = 0; i < inst.inputs.values.size; ++i) {
+          auto & reg = registers[get(inst.inputs.values, i)];
+          if (get(inst.inputs.free_flags, i)) {
+            elems.push_back(std::move(reg));
+          } else {
+            elems.push_back(reg);
+          }
+        }
+        registers[get(inst.outputs, 0)] = Tuple::create(std::move(elems));
+        return true;
+      }
+      case OpCode::TUPLE_UNPACK: {
+        auto & reg = registers[get(inst.inputs.values, 0)];
+        auto t = get(inst.inputs.free_flags, 0) ? std::move(reg).toTuple() : reg.toTuple();
+        const auto & elems = t->elements();
+        if (elems.size() != static_cast<size_t>(inst.outputs.size)) {
+          AT_ERROR("Expected a tuple of ", inst.outputs.size, " elements, but got ", elems.size());
+        }
+        for (int i = 0; i < inst.outputs.size; ++i) {
+          registers[get(inst.outputs, i)] = elems[i];
+        }
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
   void loadTensorsFromRegisters(const UseList & uses, Stack & stack) {
     for(int i = 0; i < uses.values.size; i++) {
       int reg = get(uses.values,i);
@@ -3,6 +3,7 @@
 #include <vector>
 #include "c10/util/Optional.h"
 
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/jit/ivalue.h"
 #include "torch/csrc/WindowsTorchApiMacro.h"
 
@@ -70,16 +71,28 @@ struct Suspend : public std::exception {
   c10::intrusive_ptr<Future> future;
 };
 
+// Resumes an interpreter, possibly on another thread. Grad mode is thread
+// local, so the mode of the thread that created the continuation is
+// captured and restored around the run.
 struct InterpreterContinuation {
   InterpreterContinuation(InterpreterState state_, Stack stack_)
-      : state(std::move(state_)), stack(std::move(stack_)) {}
+      : state(std::move(state_)),
+        stack(std::move(stack_)),
+        grad_mode_enabled(autograd::GradMode::is_enabled()) {}
 
   void operator()(void) {
-    state.runAsync(stack);
+    autograd::AutoGradMode grad_mode(grad_mode_enabled);
+    try {
+      state.runAsync(stack);
+    } catch (std::exception& e) {
+      // Nobody is on the stack to catch this; hand it to whoever waits.
+      state.getFuture()->markCompleted(Future::FutureError(e.what()));
+    }
   }
 
  private:
   InterpreterState state;
   Stack stack;
+  bool grad_mode_enabled;
 };
 }}
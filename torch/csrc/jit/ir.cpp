@@ -616,7 +616,8 @@ Value* Node::namedInput(Symbol name) const {
 }
 
 bool Node::matches(const char *signature_literal, at::ArrayRef<Symbol> const_inputs) const {
-  if (!sig(signature_literal).matches(this)) return false;
+  auto op = findSig(signature_literal);
+  if (!op || !op->matches(this)) return false;
   for (Symbol s : const_inputs) {
     if (!is_constant(s)) return false;
   }
@@ -846,14 +847,14 @@ void Node::replaceInputWith(Value * from, Value * to) {
 }
 
 Value* Node::addOutput() {
-  outputs_.push_back(new Value(this, outputs_.size()));
+  outputs_.push_back(owningGraph()->allocValue(this, outputs_.size()));
   schema_ = nullptr;
   return outputs_.back();
 }
 
 Value* Node::insertOutput(size_t i) {
   schema_ = nullptr;
-  outputs_.insert(outputs_.begin() + i, new Value(this, i));
+  outputs_.insert(outputs_.begin() + i, owningGraph()->allocValue(this, i));
   for (size_t itr = i + 1; itr < outputs_.size(); ++itr) {
     outputs_[itr]->setOffset(outputs_[itr]->offset() + 1);
   }
@@ -1280,7 +1281,8 @@ Value* Graph::insert(
 
 Node* Graph::create(NodeKind kind, size_t num_outputs) {
   // NB: Node constructor adds node to all_nodes
-  auto n = new Node(this, kind);
+  auto n = new (node_arena_.allocate()) Node(this, kind);
+  n->in_arena_ = true;
   for(size_t i = 0; i < num_outputs; i++)
     n->addOutput();
   return n;
@@ -1459,26 +1461,37 @@ std::string Graph::toString() const {
 }
 
 Graph::~Graph() {
-  for (const Node * n : all_nodes)
-    delete n;
-  for (const Value * v : all_values)
-    delete v;
+  // the memory of the arenas is freed with them
+  for (const Node * n : all_nodes) {
+    for (const Value * v : n->outputs())
+      v->~Value();
+    if (n->in_arena_)
+      n->~Node();
+    else
+      delete n;
+  }
   for (const Block * b : all_blocks)
     delete b;
 }
 
+Value* Graph::allocValue(Node * node, size_t offset) {
+  return new (value_arena_.allocate()) Value(node, offset);
+}
 void Graph::freeNode(Node * n) {
   auto it = all_nodes.find(n);
   JIT_ASSERT(it != all_nodes.end());
-  delete *it;
   all_nodes.erase(it);
+  if (n->in_arena_) {
+    n->~Node();
+    node_arena_.deallocate(n);
+  } else {
+    delete n;
+  }
 }
 void Graph::freeValue(Value * v) {
   v->setUniqueName("");
-  auto it = all_values.find(v);
-  JIT_ASSERT(it != all_values.end());
-  delete *it;
-  all_values.erase(it);
+  v->~Value();
+  value_arena_.deallocate(v);
 }
 void Graph::freeBlock(Block * b) {
   auto it = all_blocks.find(b);
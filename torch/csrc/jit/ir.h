@@ -10,6 +10,7 @@
 #include "torch/csrc/jit/source_location.h"
 #include "torch/csrc/jit/source_range.h"
 #include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/fixed_size_arena.h"
 #include "torch/csrc/jit/function_schema.h"
 #include "torch/csrc/jit/ivalue.h"
 #include "torch/csrc/jit/type.h"
@@ -232,6 +233,9 @@ private:
   // note: mutable because schema_ is effectively a cache
   mutable const FunctionSchema* schema_;
   topo_position_t topo_position_ = 0;
+  // whether the node is a Node allocated from the node arena of the graph,
+  // and not an instance of a subclass
+  bool in_arena_ = false;
 protected:
   TORCH_API Node(Graph * graph_, NodeKind kind_); //defined after graph
 public:
@@ -620,9 +624,7 @@ protected:
   // of a node in another graph. It should allocate a new instance of the same
   // concrete type as 'this', but in graph 'g' which might be different
   // than graph_
-  virtual Node * allocNewInstance(Graph * g) {
-    return new Node(g, kind());
-  }
+  virtual Node * allocNewInstance(Graph * g); // defined after graph
   // create a copy of all properties of Node s into this.
   // subclasses should extend if they have additional information to copy.
   // 'this' will be allocated with s->allocNewInstance(g) so it should have
@@ -751,12 +753,17 @@ friend struct Value;
 friend struct Block;
 private:
 
+  // the plain nodes and the values are allocated from these, and are
+  // destroyed before them
+  FixedSizeArena node_arena_{sizeof(Node)};
+  FixedSizeArena value_arena_{sizeof(Value)};
+
   // only used to keep track of allocated nodes
   // actual representation of Graph is done with
   // inputs, outputs, nodes
+  // the values are those of the outputs of the nodes
 
   std::unordered_set<const Node*> all_nodes;
-  std::unordered_set<const Value*> all_values;
   std::unordered_set<const Block*> all_blocks;
   size_t next_unique_;
 
@@ -944,6 +951,7 @@ public:
 
 private:
 
+  TORCH_API Value* allocValue(Node * node, size_t offset);
   TORCH_API void freeNode(Node * n);
   TORCH_API void freeValue(Value * v);
   TORCH_API void freeBlock(Block * b);
@@ -979,8 +987,10 @@ inline Value::Value(Node * node_, size_t offset_)
 : node_(node_),
   offset_(offset_),
   unique_(node_->graph_->next_unique_++),
-  type_(DynamicType::get()) {
-  node_->graph_->all_values.emplace(this);
+  type_(DynamicType::get()) {}
+
+inline Node* Node::allocNewInstance(Graph * g) {
+  return g->create(kind(), /*num_outputs=*/0);
 }
 
 inline Value* Value::setType(const TypePtr type) {
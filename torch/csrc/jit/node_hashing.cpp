@@ -7,7 +7,6 @@
 #include "torch/csrc/jit/interned_strings.h"
 #include "torch/csrc/jit/passes/common_subexpression_elimination.h"
 #include "torch/csrc/jit/node_hashing.h"
-#include "torch/csrc/utils/functional.h"
 #include "torch/csrc/utils/hash.h"
 
 namespace torch { namespace jit {
@@ -79,9 +78,16 @@ bool attributesEqualCSE(const Node* lhs, const Node* rhs) {
 
 size_t HashNode::operator()(const Node* k) const {
   JIT_ASSERT(k != nullptr);
-  return get_hash(k->kind(),
-                  fmap(k->outputs(), [](const Value *v) { return v->type()->kind(); }),
-                  fmap(k->inputs(), [](const Value *v) { return v->unique(); }));
+  // Hashes the kind, the output type kinds and the inputs without building
+  // vectors of them, as CSE hashes every node of the graph
+  size_t hash = std::hash<NodeKind>()(k->kind());
+  for (const Value* v : k->outputs()) {
+    hash = hash_combine(hash, static_cast<size_t>(v->type()->kind()));
+  }
+  for (const Value* v : k->inputs()) {
+    hash = hash_combine(hash, v->unique());
+  }
+  return hash;
 };
 
 bool EqualNode::operator()(const Node* lhs, const Node* rhs) const {
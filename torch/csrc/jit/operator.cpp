@@ -370,14 +370,34 @@ std::string canonicalSchemaString(const FunctionSchema& schema) {
   return out.str();
 }
 
+// The name of a schema string, the qualified name before the arguments,
+// which the schema parser would read
+Symbol schemaName(const std::string& schema) {
+  const auto end = schema.find('(');
+  if (end != std::string::npos) {
+    const auto begin = schema.find_first_not_of(" \t\n");
+    const auto last = schema.find_last_not_of(" \t\n", end - 1);
+    if (begin < end && last != std::string::npos && last >= begin) {
+      auto name = schema.substr(begin, last - begin + 1);
+      if (name.find("::") != std::string::npos &&
+          name.find_first_of(" \t\n") == std::string::npos) {
+        return Symbol::fromQualString(name);
+      }
+    }
+  }
+  return Symbol::fromQualString(parseSchema(schema).name());
+}
+
 using OperatorMap = std::unordered_map<Symbol, std::vector<std::shared_ptr<Operator>>>;
 struct OperatorRegistry  {
 private:
   std::mutex lock;
   OperatorMap operators;
-  // list of operators whose schema have not yet been parsed, and must
-  // be registered before any call to lookup an opeator
-  std::vector<std::shared_ptr<Operator>> to_register;
+  // operators whose schema have not yet been parsed, by name, which must
+  // be registered before any call to lookup an operator of that name.
+  // Most processes use a small part of the operators, and parsing the
+  // schemas of all of them would take most of the time to start.
+  OperatorMap to_register;
   // Those two maps are used to implement lookupByLiteral, which is needed for the n->match(...) calls.
   // Basically, every function schema is assigned a unique string you can use to match it. However,
   // parsing those strings or comparing and hashing them character by character would be very slow, so
@@ -390,26 +410,45 @@ private:
   std::unordered_map<const char *, std::shared_ptr<Operator>> operators_by_sig_literal;
 
   // XXX - caller must be holding lock
-  void registerPendingOperators() {
-    for(auto op : to_register) {
-      Symbol sym = Symbol::fromQualString(op->schema().name());
-      operators[sym].push_back(op);
-      operators_by_sig[canonicalSchemaString(op->schema())] = op;
+  void registerPendingOperators(Symbol name) {
+    auto pending = to_register.find(name);
+    if (pending == to_register.end()) {
+      return;
     }
-    to_register.clear();
+    auto& ops = operators[name];
+    for(auto& op : pending->second) {
+      const auto& schema = op->schema();
+      if (schema.is_varret() && !printerHasSpecialCaseFor(name)) {
+        std::cout << c10::str(
+            "missing special case in python printer for non-schematized operator ",
+            schema.name(),
+            ". File a bug to add a case for this operator.\n");
+      }
+      operators_by_sig[canonicalSchemaString(schema)] = op;
+      ops.push_back(std::move(op));
+    }
+    to_register.erase(pending);
   }
 
 public:
   void registerOperator(Operator&& op) {
+    auto name = op.symbol();
     std::lock_guard<std::mutex> guard(lock);
-    to_register.push_back(std::make_shared<Operator>(std::move(op)));
+    to_register[name].push_back(std::make_shared<Operator>(std::move(op)));
   }
 
+  // Returns nullptr for the signatures of operators left out of the build,
+  // none of the overloads of which are registered, as happens with
+  // --selected-op-list. The passes which refer to them then don't match them.
   const std::shared_ptr<Operator>& lookupByLiteral(const char * name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
     auto it = operators_by_sig_literal.find(name);
     if (it == operators_by_sig_literal.end()) {
+      const Symbol sym = schemaName(name);
+      registerPendingOperators(sym);
+      if (operators.count(sym) == 0) {
+        return operators_by_sig_literal.emplace_hint(it, name, nullptr)->second;
+      }
       auto op_ptr_it = operators_by_sig.find(canonicalSchemaString(parseSchema(name)));
       // Handy debugging code that dumps all operators we know about on mismatch
 #if 0
@@ -428,7 +467,7 @@ public:
 
   const std::vector<std::shared_ptr<Operator>>& getOperators(Symbol name) {
     std::lock_guard<std::mutex> guard(lock);
-    registerPendingOperators();
+    registerPendingOperators(name);
     static std::vector<std::shared_ptr<Operator>> empty;
     auto it = operators.find(name);
     if(it != operators.end())
@@ -445,16 +484,6 @@ OperatorRegistry& getRegistry() {
 } // anonymous namespace
 
 void registerOperator(Operator&& op) {
-  if(op.schema().is_varret()) {
-    Symbol s = Symbol::fromQualString(op.schema().name());
-    if (!printerHasSpecialCaseFor(s)) {
-      std::cout << c10::str(
-          "missing special case in python printer for non-schematized operator ",
-          op.schema().name(),
-          ". File a bug to add a case for this operator.\n");
-    }
-  }
-
   getRegistry().registerOperator(std::move(op));
 }
 
@@ -462,8 +491,21 @@ const std::vector<std::shared_ptr<Operator>>& getAllOperatorsFor(Symbol name) {
   return getRegistry().getOperators(name);
 }
 
+Symbol Operator::symbol() const {
+  if (schema_) {
+    return Symbol::fromQualString(schema_->name());
+  }
+  return schemaName(schema_string_.value());
+}
+
+Operator* findSig(const char *signature) {
+  return getRegistry().lookupByLiteral(signature).get();
+}
+
 Operator& sig(const char *signature) {
-  return *getRegistry().lookupByLiteral(signature);
+  auto op = findSig(signature);
+  JIT_ASSERTM(op, "Couldn't find an operator for ", signature);
+  return *op;
 }
 
 FunctionSchema parseSchema(const std::string& schema) {
@@ -543,7 +585,9 @@ OperatorSet::OperatorSet(std::initializer_list<const char *> sig_literals) {
   auto & registry = getRegistry();
   for (const char * sig : sig_literals) {
     auto op = registry.lookupByLiteral(sig);
-    ops[Symbol::fromQualString(op->schema().name())].push_back(op);
+    if (op) {
+      ops[Symbol::fromQualString(op->schema().name())].push_back(op);
+    }
   }
 }
 
@@ -67,6 +67,10 @@ struct TORCH_API Operator {
     }
     return *schema_;
   }
+
+  // The name of the schema, read from the schema string without parsing it
+  // when the schema wasn't parsed yet
+  Symbol symbol() const;
 private:
  mutable c10::optional<std::string> schema_string_;
  // cannot use c10::optional because windows has issues that require an
@@ -92,8 +96,10 @@ inline Operation getOperation(const Node* node) {
 
 TORCH_API void registerOperator(Operator&& op);
 
-// XXX: this function is meant to be used with string literals only!
+// XXX: these functions are meant to be used with string literals only!
 Operator& sig(const char *signature_literal);
+// nullptr when the operator is left out of the build
+Operator* findSig(const char *signature_literal);
 
 struct OperatorSet {
   OperatorSet(std::initializer_list<const char *> sig_literals);
@@ -79,6 +79,23 @@ std::unordered_set<Node*> AliasDb::getWritersForNode(const Node* n) const {
   return writers;
 }
 
+bool AliasDb::mayAlias(const Value* a, const Value* b) const {
+  if (valueToAlias_.count(a) == 0 || valueToAlias_.count(b) == 0) {
+    return false;
+  }
+  const auto& aInfo = valueToAlias_.at(a);
+  const auto& bInfo = valueToAlias_.at(b);
+  if (aInfo.isWildcard() || bInfo.isWildcard()) {
+    return true;
+  }
+  for (const auto& aliasSet : aInfo.sets()) {
+    if (bInfo.sets().count(aliasSet) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void AliasDb::dump() const {
   std::cout << "\n===1. GRAPH===\n";
   graph_->dump();
@@ -182,7 +199,15 @@ void AliasDb::analyze(Node* node) {
     case prim::TupleConstruct:
     case prim::Undefined:
     case prim::FusedConcat:
+    case prim::MemoryArena:
+    case prim::MMTreeReduce:
+    case prim::MMBatchSide:
+    case prim::AddMMBatchSide:
+    case prim::ConvBatchSide:
+    case prim::BatchedMM:
       return analyzeCreator(node);
+    case prim::ArenaSlice:
+      return addAlias(node->output(), node->input());
     case prim::TupleUnpack:
     case prim::TupleIndex:
     case prim::TupleSlice:
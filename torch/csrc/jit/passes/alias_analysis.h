@@ -44,6 +44,10 @@ class AliasDb {
     return getWritersForNode(n).size() != 0;
   }
 
+  // Can `a` and `b` refer to the same memory? Values of immutable types
+  // never alias anything.
+  bool mayAlias(const Value* a, const Value* b) const;
+
   // For debugging: print alias db state to stdout
   void dump() const;
 
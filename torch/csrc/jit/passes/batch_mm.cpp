@@ -2,6 +2,7 @@
 
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/peephole.h"
+#include "torch/csrc/jit/passes/alias_analysis.h"
 #include "torch/csrc/jit/interned_strings.h"
 #include "torch/csrc/jit/constants.h"
 #include "torch/csrc/jit/symbolic_variable.h"
@@ -11,7 +12,10 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <map>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace torch { namespace jit {
 
@@ -124,6 +128,174 @@ RegisterOperators mm_tree_reduction_reg({
     })
 });
 
+// Note [Horizontal batching]
+// Besides the trees above, graphs often contain a number of independent ops of
+// the same kind, none of which uses the result of another, e.g. the
+// projections of the heads of an attention layer, the gates of an unrolled
+// RNN cell, or the branches of an inception block. When they share an operand
+// they can be run as a single, wider op, and the results split again:
+//
+//   mm(X, W1), mm(X, W2)           -> mm(X, cat([W1, W2], 1)).split(1)
+//   mm(W1, X), mm(W2, X)           -> mm(cat([W1, W2], 0), X).split(0)
+//   addmm(b1, X, W1), addmm(b2, X, W2)
+//                                  -> addmm(cat([b1, b2]), X, cat([W1, W2], 1)).split(1)
+//   conv2d(X, W1, b1), conv2d(X, W2, b2)
+//                                  -> conv2d(X, cat([W1, W2]), cat([b1, b2])).split(1)
+//
+// On the GPU, independent mms of the same shapes which share none of their
+// operands are run as a single bmm instead, which saves the launches of the
+// small kernels they usually are. On the CPU bmm is a loop of gemms anyway,
+// so stacking the operands would only add copies.
+//
+// We don't batch elementwise ops: stacking their operands costs as much memory
+// traffic as the ops themselves, and the fuser already merges chains of them.
+//
+// The ops of a batch have to be moved next to each other first, which is done
+// with the alias analysis, and the ops whose operands or results are written
+// to in place are left alone. All of the batched ops check the shapes of their
+// operands at run time and fall back to running the ops one by one if they
+// can't be batched.
+
+static constexpr size_t min_batch_size = 2;
+
+bool same_sizes_except(at::TensorList inputs, int64_t dim) {
+  auto expected_sizes = inputs[0].sizes();
+  return std::all_of(inputs.begin(), inputs.end(),
+                     [expected_sizes, dim](const at::Tensor& t) {
+                       if (t.dim() != static_cast<int64_t>(expected_sizes.size()))
+                         return false;
+                       for (int64_t i = 0; i < t.dim(); ++i) {
+                         if (i != dim && t.size(i) != expected_sizes[i])
+                           return false;
+                       }
+                       return true;
+                     });
+}
+
+std::vector<int64_t> sizes_along(at::TensorList inputs, int64_t dim) {
+  return fmap(inputs, [dim](const at::Tensor& t) { return t.size(dim); });
+}
+
+std::vector<at::Tensor> pop_tensors(Stack& stack, size_t num_inputs) {
+  std::vector<at::Tensor> inputs;
+  inputs.reserve(num_inputs);
+  for (auto it = stack.end() - num_inputs; it != stack.end(); ++it) {
+    // Undefined optional tensors (e.g. missing conv biases) come as None
+    inputs.push_back(it->isTensor() ? std::move(*it).toTensor() : at::Tensor());
+  }
+  drop(stack, num_inputs);
+  return inputs;
+}
+
+void push_tensors(Stack& stack, std::vector<at::Tensor> outputs) {
+  for (auto& output : outputs) {
+    push(stack, std::move(output));
+  }
+}
+
+RegisterOperators mm_batch_side_reg({
+  // One operand shared by all mms, then the other operand of each of them.
+  // attr::side is 0 if the shared operand is the lhs, and 1 if it's the rhs.
+  Operator(
+    prim::MMBatchSide,
+    [](const Node* node) {
+      size_t num_other_inputs = node->inputs().size() - 1;
+      bool shared_lhs = node->i(attr::side) == 0;
+      return [num_other_inputs, shared_lhs](Stack& stack) {
+        auto others = pop_tensors(stack, num_other_inputs);
+        auto shared = pop(stack).toTensor();
+        const int64_t cat_dim = shared_lhs ? 1 : 0;
+        if (shared.dim() == 2 && same_sizes_except(others, cat_dim) && others[0].dim() == 2) {
+          auto other = at::cat(others, cat_dim);
+          auto result = shared_lhs ? at::mm(shared, other) : at::mm(other, shared);
+          push_tensors(stack, result.split_with_sizes(sizes_along(others, cat_dim), cat_dim));
+        } else {
+          for (const auto& other : others) {
+            push(stack, shared_lhs ? at::mm(shared, other) : at::mm(other, shared));
+          }
+        }
+        return 0;
+      };
+    }),
+  // mat1, beta and alpha shared by all addmms, then their biases, then their mat2s.
+  Operator(
+    prim::AddMMBatchSide,
+    [](const Node* node) {
+      size_t num_addmms = (node->inputs().size() - 3) / 2;
+      return [num_addmms](Stack& stack) {
+        auto mat2s = pop_tensors(stack, num_addmms);
+        auto biases = pop_tensors(stack, num_addmms);
+        at::Scalar beta, alpha;
+        at::Tensor mat1;
+        pop(stack, mat1, beta, alpha);
+        bool can_batch = mat1.dim() == 2 && mat2s[0].dim() == 2 &&
+            same_sizes_except(mat2s, 1);
+        for (size_t i = 0; can_batch && i < num_addmms; ++i) {
+          can_batch = biases[i].dim() == 1 && biases[i].size(0) == mat2s[i].size(1);
+        }
+        if (can_batch) {
+          auto result = at::addmm(at::cat(biases), mat1, at::cat(mat2s, 1), beta, alpha);
+          push_tensors(stack, result.split_with_sizes(sizes_along(mat2s, 1), 1));
+        } else {
+          for (size_t i = 0; i < num_addmms; ++i) {
+            push(stack, at::addmm(biases[i], mat1, mat2s[i], beta, alpha));
+          }
+        }
+        return 0;
+      };
+    }),
+  // The input, stride, padding, dilation and groups (always 1) shared by all
+  // conv2ds, then their biases, then their weights.
+  Operator(
+    prim::ConvBatchSide,
+    [](const Node* node) {
+      size_t num_convs = (node->inputs().size() - 5) / 2;
+      return [num_convs](Stack& stack) {
+        auto weights = pop_tensors(stack, num_convs);
+        auto biases = pop_tensors(stack, num_convs);
+        at::Tensor input;
+        std::vector<int64_t> stride, padding, dilation;
+        int64_t groups;
+        pop(stack, input, stride, padding, dilation, groups);
+        bool can_batch = same_sizes_except(weights, 0);
+        bool has_bias = biases[0].defined();
+        for (size_t i = 0; can_batch && i < num_convs; ++i) {
+          can_batch = biases[i].defined() == has_bias &&
+              (!has_bias || (biases[i].dim() == 1 && biases[i].size(0) == weights[i].size(0)));
+        }
+        if (can_batch) {
+          auto result = at::conv2d(
+              input, at::cat(weights), has_bias ? at::cat(biases) : at::Tensor(),
+              stride, padding, dilation, groups);
+          push_tensors(stack, result.split_with_sizes(sizes_along(weights, 0), 1));
+        } else {
+          for (size_t i = 0; i < num_convs; ++i) {
+            push(stack, at::conv2d(input, weights[i], biases[i], stride, padding, dilation, groups));
+          }
+        }
+        return 0;
+      };
+    }),
+  // The lhs of all mms, then their rhs.
+  Operator(
+    prim::BatchedMM,
+    [](const Node* node) {
+      size_t num_mms = node->inputs().size() / 2;
+      return [num_mms](Stack& stack) {
+        auto rhs_inputs = pop_tensors(stack, num_mms);
+        auto lhs_inputs = pop_tensors(stack, num_mms);
+        if (have_same_shape(lhs_inputs) && have_same_shape(rhs_inputs)) {
+          push_tensors(stack, at::bmm(at::stack(lhs_inputs), at::stack(rhs_inputs)).unbind(0));
+        } else {
+          for (size_t i = 0; i < num_mms; ++i) {
+            push(stack, at::mm(lhs_inputs[i], rhs_inputs[i]));
+          }
+        }
+        return 0;
+      };
+    })
+});
+
 // TreeTokens will be used to label nodes of the graph, if the nodes will fit
 // our mm/add tree pattern. Basically we do dynamic programming on DAGs, where
 // when we reach node N with inputs A and B, then A and B have already been
@@ -260,9 +432,203 @@ void BatchMMBlock(Block* block) {
   }
 }
 
+// The ops of the same kind that can be batched together. Ops with equal keys
+// can be batched, provided that they're independent.
+struct BatchKey {
+  enum Kind { MMSharedLHS, MMSharedRHS, AddMMSharedMat1, Conv2dSharedInput, IndependentMM };
+  Kind kind;
+  std::vector<Value*> shared; // the values shared by all ops of the batch
+  std::vector<int64_t> sizes; // the sizes of the operands, for IndependentMM
+
+  bool operator<(const BatchKey& other) const {
+    return std::tie(kind, shared, sizes) < std::tie(other.kind, other.shared, other.sizes);
+  }
+};
+
+// Appends the keys of the batches node could be a part of to keys.
+void findBatchKeys(Node* node, std::vector<BatchKey>& keys) {
+  if (node->matches("aten::mm(Tensor self, Tensor mat2) -> Tensor")) {
+    keys.push_back({BatchKey::MMSharedLHS, {node->inputs()[0]}, {}});
+    keys.push_back({BatchKey::MMSharedRHS, {node->inputs()[1]}, {}});
+    auto lhs_type = node->inputs()[0]->type()->cast<CompleteTensorType>();
+    auto rhs_type = node->inputs()[1]->type()->cast<CompleteTensorType>();
+    // See Note [Horizontal batching] for why this is only done on the GPU
+    if (lhs_type && rhs_type && lhs_type->device().is_cuda() &&
+        lhs_type->device() == rhs_type->device() &&
+        lhs_type->scalarType() == rhs_type->scalarType()) {
+      std::vector<int64_t> sizes = lhs_type->sizes();
+      sizes.insert(sizes.end(), rhs_type->sizes().begin(), rhs_type->sizes().end());
+      sizes.push_back(lhs_type->device().index());
+      sizes.push_back(static_cast<int64_t>(lhs_type->scalarType()));
+      keys.push_back({BatchKey::IndependentMM, {}, std::move(sizes)});
+    }
+  } else if (node->matches("aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    keys.push_back({BatchKey::AddMMSharedMat1,
+                    {node->namedInput(attr::mat1), node->namedInput(attr::beta), node->namedInput(attr::alpha)},
+                    {}});
+  } else if (node->matches("aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor")) {
+    // Grouped convolutions can't be concatenated along their output channels
+    auto groups = node->get<int64_t>(attr::groups);
+    if (!groups || *groups != 1) {
+      return;
+    }
+    keys.push_back({BatchKey::Conv2dSharedInput,
+                    {node->namedInput(attr::input), node->namedInput(attr::stride),
+                     node->namedInput(attr::padding), node->namedInput(attr::dilation),
+                     node->namedInput(attr::groups)},
+                    {}});
+  }
+}
+
+// Returns the node of block which contains node, or nullptr if it's the
+// return node of block.
+Node* findNodeInBlock(Node* node, Block* block) {
+  while (node->owningBlock() != block) {
+    node = node->owningBlock()->owningNode();
+  }
+  return node == block->return_node() ? nullptr : node;
+}
+
+// Adds the nodes of the block that depend on node through their inputs to reached.
+void addUsersInBlock(Node* node, Block* block, std::unordered_set<Node*>& reached) {
+  std::vector<Node*> queue {node};
+  while (!queue.empty()) {
+    auto n = queue.back(); queue.pop_back();
+    for (auto output : n->outputs()) {
+      for (auto& use : output->uses()) {
+        Node* user = findNodeInBlock(use.user, block);
+        if (user && reached.insert(user).second) {
+          queue.push_back(user);
+        }
+      }
+    }
+  }
+}
+
+// Filters nodes (in topological order) down to the ones that don't depend on
+// one of the others, and moves them next to each other, right before the last
+// of them. Nodes that can't be moved are dropped.
+std::vector<Node*> gatherIndependentNodes(
+    const std::vector<Node*>& nodes, Block* block, const AliasDb& aliasDb) {
+  std::vector<Node*> independent;
+  std::unordered_set<Node*> reached;
+  for (Node* node : nodes) {
+    if (reached.count(node) == 0 && !aliasDb.hasWriters(node)) {
+      independent.push_back(node);
+      addUsersInBlock(node, block, reached);
+    }
+  }
+  if (independent.size() < min_batch_size) {
+    return {};
+  }
+  std::vector<Node*> gathered;
+  Node* last = independent.back();
+  for (size_t i = 0; i + 1 < independent.size(); ++i) {
+    if (independent[i]->moveBeforeTopologicallyValid(last, aliasDb)) {
+      gathered.push_back(independent[i]);
+    }
+  }
+  gathered.push_back(last);
+  return gathered;
+}
+
+// Replaces the gathered nodes of a batch by a single node computing all of them.
+void batchNodes(const BatchKey& key, const std::vector<Node*>& nodes) {
+  auto graph = nodes[0]->owningGraph();
+  Node* batched = nullptr;
+  auto inputs_at = [&](size_t i) {
+    return fmap(nodes, [i](Node* n) { return n->inputs().at(i); });
+  };
+  switch (key.kind) {
+    case BatchKey::MMSharedLHS:
+    case BatchKey::MMSharedRHS: {
+      bool shared_lhs = key.kind == BatchKey::MMSharedLHS;
+      std::vector<Value*> inputs {key.shared[0]};
+      auto others = inputs_at(shared_lhs ? 1 : 0);
+      inputs.insert(inputs.end(), others.begin(), others.end());
+      batched = graph->create(prim::MMBatchSide, inputs, nodes.size())
+                    ->i_(attr::side, shared_lhs ? 0 : 1);
+      break;
+    }
+    case BatchKey::AddMMSharedMat1:
+    case BatchKey::Conv2dSharedInput: {
+      // The shared values, then the biases, then the weights
+      std::vector<Value*> inputs = key.shared;
+      bool is_addmm = key.kind == BatchKey::AddMMSharedMat1;
+      auto biases = inputs_at(is_addmm ? 0 : 2);
+      auto weights = inputs_at(is_addmm ? 2 : 1);
+      inputs.insert(inputs.end(), biases.begin(), biases.end());
+      inputs.insert(inputs.end(), weights.begin(), weights.end());
+      batched = graph->create(
+          is_addmm ? prim::AddMMBatchSide : prim::ConvBatchSide,
+          inputs, nodes.size());
+      break;
+    }
+    case BatchKey::IndependentMM: {
+      auto inputs = inputs_at(0);
+      auto rhs_inputs = inputs_at(1);
+      inputs.insert(inputs.end(), rhs_inputs.begin(), rhs_inputs.end());
+      batched = graph->create(prim::BatchedMM, inputs, nodes.size());
+      break;
+    }
+  }
+  batched->insertBefore(nodes[0]);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    batched->outputs()[i]->setType(nodes[i]->output()->type());
+    nodes[i]->output()->replaceAllUsesWith(batched->outputs()[i]);
+  }
+  // NB: the original nodes are now dead, DCE will remove them.
+}
+
+void BatchSharedOperandsBlock(Block* block, const AliasDb& aliasDb) {
+  std::map<BatchKey, std::vector<Node*>> batches;
+  std::vector<BatchKey> keys;
+  std::vector<BatchKey> order;
+  for (auto node : block->nodes()) {
+    for (auto sub_block : node->blocks()) {
+      BatchSharedOperandsBlock(sub_block, aliasDb);
+    }
+    keys.clear();
+    findBatchKeys(node, keys);
+    for (auto& key : keys) {
+      auto& batch = batches[key];
+      if (batch.empty()) {
+        order.push_back(key);
+      }
+      batch.push_back(node);
+    }
+  }
+  // Try the batches with shared operands first, in the order they come in
+  std::stable_sort(order.begin(), order.end(), [](const BatchKey& a, const BatchKey& b) {
+    return a.kind == BatchKey::IndependentMM ? false : b.kind == BatchKey::IndependentMM;
+  });
+
+  std::unordered_set<Node*> batched;
+  for (auto& key : order) {
+    std::vector<Node*> candidates;
+    for (Node* node : batches[key]) {
+      if (batched.count(node) == 0) {
+        candidates.push_back(node);
+      }
+    }
+    if (candidates.size() < min_batch_size) {
+      continue;
+    }
+    auto gathered = gatherIndependentNodes(candidates, block, aliasDb);
+    if (gathered.size() < min_batch_size) {
+      continue;
+    }
+    batched.insert(gathered.begin(), gathered.end());
+    batchNodes(key, gathered);
+  }
+}
+
 void BatchMM(std::shared_ptr<Graph>& graph) {
   BatchMMBlock(graph->block());
   EliminateDeadCode(graph);
+  // See Note [Horizontal batching]
+  BatchSharedOperandsBlock(graph->block(), AliasAnalysis(graph));
+  EliminateDeadCode(graph);
   // It's possible that transpose rearrangements have created sequences of consecutive
   // transposes that didn't exist before.
   PeepholeOptimize(graph);
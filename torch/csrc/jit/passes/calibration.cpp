@@ -0,0 +1,206 @@
+#include "torch/csrc/jit/passes/calibration.h"
+
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/custom_operator.h"
+#include "torch/csrc/jit/operator.h"
+
+#include "caffe2/quantization/server/dynamic_histogram.h"
+
+#include <ATen/Config.h>
+
+#if AT_FBGEMM_ENABLED()
+#include "caffe2/quantization/server/dnnlowp.h"
+#endif
+
+#include <atomic>
+
+namespace torch { namespace jit {
+
+namespace {
+
+std::atomic<int64_t> next_calibration_id{0};
+
+// The calibrations that InsertCalibrationObservers has inserted observers
+// for, so that the operations of the observers can find them by id.
+struct CalibrationRegistry {
+  void add(const std::shared_ptr<Calibration>& calibration) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = calibrations.begin(); it != calibrations.end();) {
+      if (it->second.expired()) {
+        it = calibrations.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    calibrations[calibration->id()] = calibration;
+  }
+
+  std::shared_ptr<Calibration> find(int64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = calibrations.find(id);
+    if (it == calibrations.end()) {
+      return nullptr;
+    }
+    return it->second.lock();
+  }
+
+  std::mutex mutex;
+  std::unordered_map<int64_t, std::weak_ptr<Calibration>> calibrations;
+};
+
+CalibrationRegistry& calibrationRegistry() {
+  static CalibrationRegistry registry;
+  return registry;
+}
+
+void insertObservers(
+    Block* block,
+    const std::shared_ptr<Calibration>& calibration,
+    const std::unordered_set<Symbol>& kinds) {
+  Graph* graph = block->owningGraph();
+  for (auto it = block->nodes().begin(); it != block->nodes().end(); ++it) {
+    Node* node = *it;
+    for (Block* sub : node->blocks()) {
+      insertObservers(sub, calibration, kinds);
+    }
+    if (node->kind() == prim::Constant || node->kind() == prim::Undefined ||
+        node->kind() == prim::CalibrationObserver) {
+      continue;
+    }
+    if (!kinds.empty() && kinds.count(node->kind()) == 0) {
+      continue;
+    }
+    // The observers are visited next by the loop, and skipped
+    Node* insert_point = node;
+    for (Value* output : node->outputs()) {
+      if (!output->type()->isSubtypeOf(DynamicType::get())) {
+        continue;
+      }
+      Node* observer = graph->create(prim::CalibrationObserver, {output}, 0);
+      observer->i_(attr::calibration, calibration->id())
+          ->i_(attr::index, calibration->addValue(output->uniqueName()));
+      observer->insertAfter(insert_point);
+      insert_point = observer;
+    }
+  }
+}
+
+RegisterOperators calibration_reg({
+  Operator(
+    prim::CalibrationObserver,
+    [](const Node* node) {
+      auto calibration =
+          calibrationRegistry().find(node->i(attr::calibration));
+      JIT_ASSERTM(calibration, "the calibration of an observer is gone");
+      auto index = static_cast<size_t>(node->i(attr::index));
+      return [=](Stack& stack) {
+        calibration->observe(index, pop(stack).toTensor());
+        return 0;
+      };
+    }),
+});
+
+} // anonymous namespace
+
+Calibration::Calibration(int64_t nbins)
+    : id_(next_calibration_id++), nbins_(nbins) {
+#if !AT_FBGEMM_ENABLED()
+  AT_ERROR("Calibration requires PyTorch to be built with FBGEMM");
+#endif
+  AT_CHECK(nbins > 0, "Calibration needs at least one bin, got ", nbins);
+}
+
+Calibration::~Calibration() = default;
+
+size_t Calibration::addValue(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AT_CHECK(!finalized_, "Calibration: can't add values once finalized");
+  std::unique_ptr<Entry> entry(new Entry());
+  entry->name = name;
+#if AT_FBGEMM_ENABLED()
+  entry->histogram.reset(new dnnlowp::DynamicHistogram(nbins_));
+#endif
+  entries_.push_back(std::move(entry));
+  return entries_.size() - 1;
+}
+
+void Calibration::observe(size_t index, const at::Tensor& tensor) {
+  if (!tensor.defined() || !at::isFloatingType(tensor.type().scalarType())) {
+    return;
+  }
+  at::Tensor data =
+      tensor.is_variable() ? autograd::as_variable_ref(tensor).data() : tensor;
+  data = data.to(at::kCPU, at::kFloat).contiguous();
+
+  Entry* entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AT_CHECK(!finalized_, "Calibration: can't observe values once finalized");
+    AT_CHECK(index < entries_.size(), "Calibration: no value at index ", index);
+    entry = entries_[index].get();
+  }
+#if AT_FBGEMM_ENABLED()
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  entry->histogram->Add(data.data<float>(), static_cast<int>(data.numel()));
+  entry->count += data.numel();
+#endif
+}
+
+std::vector<std::string> Calibration::names() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> names;
+  for (const auto& entry : entries_) {
+    names.push_back(entry->name);
+  }
+  return names;
+}
+
+std::unordered_map<std::string, Calibration::QuantizationParams>
+Calibration::quantizationParams(
+    const std::string& kind,
+    int64_t precision,
+    bool preserve_sparsity) {
+  static const std::unordered_set<std::string> kinds = {
+      "min_max", "l1", "l2", "l2_approx", "kl", "p99"};
+  AT_CHECK(kinds.count(kind), "Calibration: unknown quantization kind ", kind);
+  AT_CHECK(
+      kind != "p99" || preserve_sparsity,
+      "Calibration: p99 quantization needs preserve_sparsity");
+  AT_CHECK(
+      precision > 0 && precision <= 16,
+      "Calibration: precision must be between 1 and 16 bits, got ",
+      precision);
+
+  std::unordered_map<std::string, QuantizationParams> result;
+#if AT_FBGEMM_ENABLED()
+  std::lock_guard<std::mutex> lock(mutex_);
+  finalized_ = true;
+  const auto quantization_kind = dnnlowp::StringToKind(kind);
+  for (const auto& entry : entries_) {
+    std::lock_guard<std::mutex> entry_lock(entry->mutex);
+    if (entry->count == 0) {
+      continue;
+    }
+    const dnnlowp::Histogram* histogram = entry->histogram->Finalize();
+    const auto qparams =
+        dnnlowp::QuantizationFactory::GetDefaultInstance()
+            ->ChooseQuantizationParams(
+                *histogram,
+                quantization_kind,
+                static_cast<int>(precision),
+                preserve_sparsity);
+    result[entry->name] = {qparams.scale, qparams.zero_point, qparams.precision};
+  }
+#endif
+  return result;
+}
+
+void InsertCalibrationObservers(
+    std::shared_ptr<Graph>& graph,
+    const std::shared_ptr<Calibration>& calibration,
+    const std::unordered_set<Symbol>& kinds) {
+  calibrationRegistry().add(calibration);
+  insertObservers(graph->block(), calibration, kinds);
+}
+
+}}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dnnlowp {
+class DynamicHistogram;
+}
+
+namespace torch { namespace jit {
+
+// Collects the distribution of values of a graph over a calibration set, and
+// chooses int8 quantization parameters for them with the range calibration of
+// the caffe2 dnnlowp operators (min/max, or L1, L2 or KL divergence
+// minimization over a histogram). Requires a build with FBGEMM.
+//
+// Observers are inserted with InsertCalibrationObservers. Once the graph has
+// been run on the calibration inputs, quantizationParams() finalizes the
+// histograms; values observed after that are an error.
+struct TORCH_API Calibration {
+  struct QuantizationParams {
+    double scale;
+    int64_t zero_point;
+    int64_t precision;
+  };
+
+  explicit Calibration(int64_t nbins = 2048);
+  ~Calibration();
+
+  // Adds a histogram for the value called name, and returns its index.
+  size_t addValue(const std::string& name);
+
+  // Adds the elements of a floating point tensor to the histogram at index.
+  void observe(size_t index, const at::Tensor& tensor);
+
+  // The names of the observed values, by index.
+  std::vector<std::string> names() const;
+
+  // The quantization parameters of every value observed at least once, by
+  // name. kind is one of "min_max", "l1", "l2", "l2_approx", "kl" and "p99", as
+  // for the dnnlowp_activation_quantization_kind flag of caffe2.
+  std::unordered_map<std::string, QuantizationParams> quantizationParams(
+      const std::string& kind = "min_max",
+      int64_t precision = 8,
+      bool preserve_sparsity = false);
+
+  // Identifies the calibration in the prim::CalibrationObserver nodes that
+  // record into it.
+  int64_t id() const {
+    return id_;
+  }
+
+ private:
+  struct Entry {
+    std::string name;
+    std::unique_ptr<dnnlowp::DynamicHistogram> histogram;
+    int64_t count = 0;
+    std::mutex mutex;
+  };
+
+  const int64_t id_;
+  const int64_t nbins_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  bool finalized_ = false;
+};
+
+// Inserts a prim::CalibrationObserver after every node of one of the given
+// kinds (or after every node, if kinds is empty), recording each of its
+// tensor outputs into calibration. Floating point outputs are recorded when
+// the graph runs; other outputs are ignored.
+//
+// The calibration is kept alive by the operations of the observers. Run this
+// before the graph is handed to a GraphExecutor, e.g. before a script method
+// is first called, since plans compiled earlier don't see the observers.
+TORCH_API void InsertCalibrationObservers(
+    std::shared_ptr<Graph>& graph,
+    const std::shared_ptr<Calibration>& calibration,
+    const std::unordered_set<Symbol>& kinds = {});
+
+}}
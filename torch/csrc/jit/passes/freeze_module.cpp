@@ -0,0 +1,197 @@
+#include "torch/csrc/jit/passes/freeze_module.h"
+
+#include "torch/csrc/jit/constants.h"
+#include "torch/csrc/jit/passes/alias_analysis.h"
+#include "torch/csrc/jit/passes/constant_pooling.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <ATen/ATen.h>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// The value of v if it's a constant tensor, an undefined tensor if it's a
+// missing optional tensor, and nullopt if it isn't a constant.
+c10::optional<at::Tensor> constantOptionalTensor(const Value* v) {
+  if (v->node()->kind() == prim::None || v->node()->kind() == prim::Undefined) {
+    return at::Tensor();
+  }
+  auto ivalue = toIValue(v);
+  if (!ivalue || !ivalue->isTensor()) {
+    return c10::nullopt;
+  }
+  return ivalue->toTensor();
+}
+
+bool isEvalModeDropout(Node* n) {
+  if (!n->matches("aten::dropout(Tensor input, float p, bool train) -> Tensor") &&
+      !n->matches("aten::feature_dropout(Tensor input, float p, bool train) -> Tensor") &&
+      !n->matches("aten::alpha_dropout(Tensor input, float p, bool train) -> Tensor")) {
+    return false;
+  }
+  auto train = n->get<bool>(attr::train);
+  return train && !*train;
+}
+
+bool isConvolution(Node* n) {
+  return n->matches("aten::conv1d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor") ||
+      n->matches("aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor") ||
+      n->matches("aten::conv3d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor");
+}
+
+// Folds an eval mode batch_norm of the output of a convolution into the
+// weight and bias of the convolution, when all of them are constants:
+//
+//   scale = bn_weight / sqrt(running_var + eps)
+//   weight' = weight * scale (along the output channels)
+//   bias' = (bias - running_mean) * scale + bn_bias
+bool foldConvBatchNorm(Node* bn, const AliasDb& aliasDb) {
+  if (!bn->matches("aten::batch_norm(Tensor input, Tensor? weight, Tensor? bias, Tensor? running_mean, Tensor? running_var, bool training, float momentum, float eps, bool cudnn_enabled) -> Tensor")) {
+    return false;
+  }
+  Node* conv = bn->namedInput(attr::input)->node();
+  auto training = bn->get<bool>(attr::training);
+  if (!training || *training || !isConvolution(conv) ||
+      conv->output()->uses().size() != 1 || aliasDb.hasWriters(conv) ||
+      aliasDb.hasWriters(bn)) {
+    return false;
+  }
+  auto weight = constantOptionalTensor(conv->namedInput(attr::weight));
+  auto bias = constantOptionalTensor(conv->namedInput(attr::bias));
+  auto bn_weight = constantOptionalTensor(bn->namedInput(attr::weight));
+  auto bn_bias = constantOptionalTensor(bn->namedInput(attr::bias));
+  auto running_mean = constantOptionalTensor(bn->namedInput(attr::running_mean));
+  auto running_var = constantOptionalTensor(bn->namedInput(attr::running_var));
+  auto eps = bn->get<double>(attr::eps);
+  if (!weight || !bias || !bn_weight || !bn_bias || !running_mean ||
+      !running_var || !eps || !weight->defined() || !running_mean->defined() ||
+      !running_var->defined()) {
+    return false;
+  }
+
+  auto scale = at::rsqrt(*running_var + *eps);
+  if (bn_weight->defined()) {
+    scale = scale * *bn_weight;
+  }
+  std::vector<int64_t> channel_shape(weight->dim(), 1);
+  channel_shape[0] = -1;
+  auto new_weight = *weight * scale.reshape(channel_shape);
+  auto new_bias = ((bias->defined() ? *bias : at::zeros_like(*running_mean)) -
+                   *running_mean) * scale;
+  if (bn_bias->defined()) {
+    new_bias = new_bias + *bn_bias;
+  }
+
+  auto graph = conv->owningGraph();
+  WithInsertPoint guard(conv);
+  conv->replaceInput(1, graph->insertConstant(new_weight));
+  conv->replaceInput(2, graph->insertConstant(new_bias));
+  bn->output()->replaceAllUsesWith(conv->output());
+  return true;
+}
+
+void OptimizeFrozenBlock(Block* block, const AliasDb& aliasDb) {
+  for (auto node : block->nodes()) {
+    for (auto sub_block : node->blocks()) {
+      OptimizeFrozenBlock(sub_block, aliasDb);
+    }
+    if (isEvalModeDropout(node) && !aliasDb.hasWriters(node)) {
+      node->output()->replaceAllUsesWith(node->namedInput(attr::input));
+    } else {
+      foldConvBatchNorm(node, aliasDb);
+    }
+  }
+}
+
+bool isConstantOne(const Value* v) {
+  auto ivalue = toIValue(v);
+  return ivalue &&
+      ((ivalue->isInt() && ivalue->toInt() == 1) ||
+       (ivalue->isDouble() && ivalue->toDouble() == 1.));
+}
+
+// A linear layer: input @ weight.t() + bias, with bias null if there's none
+struct LinearLayer {
+  Value* input;
+  at::Tensor weight;
+  Value* bias;
+};
+
+// The linear layer a node computes, with a constant weight. Once frozen, the
+// linear layers of script and traced modules are the addmm and matmul of
+// F.linear, on the folded transposes of their weights.
+c10::optional<LinearLayer> matchLinearLayer(Node* n) {
+  if (n->matches("aten::linear(Tensor input, Tensor weight, Tensor? bias) -> Tensor")) {
+    auto weight = constantOptionalTensor(n->namedInput(attr::weight));
+    if (!weight || !weight->defined()) {
+      return c10::nullopt;
+    }
+    auto bias = n->namedInput(attr::bias);
+    return LinearLayer{n->namedInput(attr::input), *weight, bias};
+  }
+  if (n->matches("aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    auto weight_t = constantOptionalTensor(n->namedInput(attr::mat2));
+    // linear_prepacked only adds a bias of the size of a row
+    auto bias = constantOptionalTensor(n->namedInput(attr::self));
+    if (!weight_t || !weight_t->defined() || weight_t->dim() != 2 || !bias ||
+        !bias->defined() || bias->dim() != 1 ||
+        bias->size(0) != weight_t->size(1) ||
+        !isConstantOne(n->namedInput(attr::beta)) ||
+        !isConstantOne(n->namedInput(attr::alpha))) {
+      return c10::nullopt;
+    }
+    return LinearLayer{n->namedInput(attr::mat1), weight_t->t(), n->namedInput(attr::self)};
+  }
+  if (n->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+    auto weight_t = constantOptionalTensor(n->namedInput(attr::other));
+    if (!weight_t || !weight_t->defined() || weight_t->dim() != 2) {
+      return c10::nullopt;
+    }
+    return LinearLayer{n->namedInput(attr::self), weight_t->t(), nullptr};
+  }
+  return c10::nullopt;
+}
+
+void PrepackLinearWeights(Block* block, bool fp16) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* node = *it++;
+    for (auto sub_block : node->blocks()) {
+      PrepackLinearWeights(sub_block, fp16);
+    }
+    auto linear = matchLinearLayer(node);
+    if (!linear || linear->weight.dim() != 2 ||
+        linear->weight.type() != at::CPU(at::kFloat)) {
+      continue;
+    }
+    auto graph = node->owningGraph();
+    WithInsertPoint guard(node);
+    auto packed = graph->insertConstant(at::linear_prepack(linear->weight, fp16));
+    std::vector<NamedValue> args = {linear->input, packed};
+    if (linear->bias) {
+      args.emplace_back(linear->bias);
+    }
+    auto output = graph->insert(aten::linear_prepacked, args);
+    node->output()->replaceAllUsesWith(output);
+    node->destroy();
+  }
+}
+
+} // anonymous namespace
+
+void OptimizeFrozenGraph(std::shared_ptr<Graph>& graph) {
+  ConstantPropagation(graph);
+  OptimizeFrozenBlock(graph->block(), AliasAnalysis(graph));
+  // The folded weights may enable more folding
+  ConstantPropagation(graph);
+  ConstantPooling(graph);
+  EliminateDeadCode(graph);
+}
+
+void PrepackLinearWeights(std::shared_ptr<Graph>& graph, bool fp16) {
+  PrepackLinearWeights(graph->block(), fp16);
+  EliminateDeadCode(graph);
+}
+
+}}
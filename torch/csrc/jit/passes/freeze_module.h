@@ -0,0 +1,21 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Optimizes for inference a graph whose parameters have been turned into
+// constants (see script::Module::freeze): folds everything computed from the
+// parameters alone (e.g. transposed weights, or branches on them), removes
+// dropouts that run in eval mode, and folds eval mode batch_norms into the
+// convolutions that feed them.
+TORCH_API void OptimizeFrozenGraph(std::shared_ptr<Graph>& graph);
+
+// Replaces each linear layer of a constant CPU float weight (an aten::linear,
+// or the aten::addmm or aten::matmul that F.linear runs, once frozen) by an
+// aten::linear_prepacked of the weight prepacked by aten::linear_prepack, in
+// fp16 if fp16 is set, so that BLAS doesn't lay the weight out again on every
+// run. The prepacked weights are opaque: the graph can't be saved anymore.
+TORCH_API void PrepackLinearWeights(std::shared_ptr<Graph>& graph, bool fp16 = false);
+
+}}
@@ -18,6 +18,58 @@ namespace torch { namespace jit {
 
 namespace {
 
+// Check that all non-tensor inputs are constant
+bool hasConstantScalarInputs(Node *node) {
+  for (Value * input : node->inputs()) {
+    if (input->type()->isSubtypeOf(DynamicType::get())) {
+      continue;
+    }
+    if (input->node()->kind() != prim::Constant) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Comparisons are simple maps, except that their outputs are byte tensors.
+// The kernels only write floating point outputs, so a comparison is only
+// fused into the group of its consumers, and never becomes an output of it.
+// This is how the masks of backward formulas, such as the one of relu
+// (grad * (out > 0).type_as(out)), end up in the kernel of the gradient.
+bool isFusableComparison(Node *node) {
+  static OperatorSet comparisons {{
+    "aten::eq(Tensor self, Tensor other) -> Tensor",
+    "aten::eq(Tensor self, Scalar other) -> Tensor",
+    "aten::ge(Tensor self, Tensor other) -> Tensor",
+    "aten::ge(Tensor self, Scalar other) -> Tensor",
+    "aten::gt(Tensor self, Tensor other) -> Tensor",
+    "aten::gt(Tensor self, Scalar other) -> Tensor",
+    "aten::le(Tensor self, Tensor other) -> Tensor",
+    "aten::le(Tensor self, Scalar other) -> Tensor",
+    "aten::lt(Tensor self, Tensor other) -> Tensor",
+    "aten::lt(Tensor self, Scalar other) -> Tensor",
+    "aten::ne(Tensor self, Tensor other) -> Tensor",
+    "aten::ne(Tensor self, Scalar other) -> Tensor",
+  }};
+  return comparisons.find(node) && hasConstantScalarInputs(node);
+}
+
+// type_as only takes the scalar type of other, which must not make the
+// output larger than self, as other inputs of a kernel would. This holds
+// when both shapes are known and equal, and for the masks of backward
+// formulas, comparisons of other.
+bool typeAsKeepsShape(Node *node) {
+  Value * self = node->namedInput(attr::self);
+  Value * other = node->namedInput(attr::other);
+  auto self_type = self->type()->cast<CompleteTensorType>();
+  auto other_type = other->type()->cast<CompleteTensorType>();
+  if (self_type && other_type) {
+    return self_type->sizes() == other_type->sizes();
+  }
+  Node * mask = self->node();
+  return isFusableComparison(mask) && mask->namedInput(attr::self) == other;
+}
+
 // What is a simple mappable operator?  It:
 //    - Has a single tensor output
 //    - Output and all tensor inputs have the same shape
@@ -54,6 +106,7 @@ bool isSimpleMap(Node *node) {
     "aten::mul(Tensor self, Tensor other) -> Tensor",
     "aten::neg(Tensor self) -> Tensor",
     "aten::pow(Tensor self, Tensor exponent) -> Tensor",
+    "aten::pow(Tensor self, Scalar exponent) -> Tensor",
     "aten::rand_like(Tensor self) -> Tensor",
     "aten::reciprocal(Tensor self) -> Tensor",
     "aten::relu(Tensor self) -> Tensor",
@@ -68,6 +121,7 @@ bool isSimpleMap(Node *node) {
     "aten::tan(Tensor self) -> Tensor",
     "aten::tanh(Tensor self) -> Tensor",
     "aten::trunc(Tensor self) -> Tensor",
+    "aten::type_as(Tensor self, Tensor other) -> Tensor",
     "aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor",
     "aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor",
     "aten::mul(Tensor self, Scalar other) -> Tensor",
@@ -76,16 +130,10 @@ bool isSimpleMap(Node *node) {
   if (!simple_mappable.find(node)) {
     return false;
   }
-  // Check that all non-tensor inputs are constant
-  for (Value * input : node->inputs()) {
-    if (input->type()->isSubtypeOf(DynamicType::get())) {
-      continue;
-    }
-    if (input->node()->kind() != prim::Constant) {
-      return false;
-    }
+  if (node->kind() == aten::type_as && !typeAsKeepsShape(node)) {
+    return false;
   }
-  return true;
+  return hasConstantScalarInputs(node);
 }
 
 struct GraphFuser {
@@ -132,7 +180,61 @@ struct GraphFuser {
   }
 
   bool isFusableOnlyAsExitNode(Node * node) {
-    return isFusableCatNode(node) || node->kind() == prim::FusedConcat;
+    return isFusableCatNode(node) || node->kind() == prim::FusedConcat ||
+        isFusableReductionNode(node);
+  }
+
+  // A sum over the innermost dimension can end a fusion group. The kernel
+  // then computes the rest of the group for every element of a row and
+  // accumulates the results, so the group has a single output, the sum.
+  bool isFusableReductionNode(Node * node) {
+    static OperatorSet reductions {{
+      "aten::sum(Tensor self, int[] dim, bool keepdim) -> Tensor",
+    }};
+    if (node->owningBlock() != block_ || !reductions.find(node))
+      return false;
+    if (!node->is_constant(attr::dim) || !node->is_constant(attr::keepdim))
+      return false;
+    auto dims = node->get<std::vector<int64_t>>(attr::dim).value();
+    if (dims.size() != 1)
+      return false;
+    if (dims[0] == -1)
+      return true;
+    auto type = node->namedInput(attr::self)->type()->cast<TensorType>();
+    return type && type->dim() > 0 && dims[0] == type->dim() - 1;
+  }
+
+  bool isReductionGroup(Node * node) {
+    if (node->kind() != prim::FusionGroup) {
+      return false;
+    }
+    auto outputs = getSubgraph(node).outputs();
+    return outputs.size() == 1 && outputs[0]->node()->kind() == aten::sum;
+  }
+
+  bool hasRandom(Node * node) {
+    if (node->kind() == prim::FusionGroup) {
+      for (auto n : getSubgraph(node).nodes()) {
+        if (n->kind() == aten::rand_like) return true;
+      }
+      return false;
+    }
+    return node->kind() == aten::rand_like;
+  }
+
+  // Everything fused into a reduction is computed only for the reduction:
+  // a producer that has other uses would become an output of the group
+  // with a different shape than the sum. Random numbers aren't supported,
+  // because every thread of the kernel now handles a whole row.
+  bool canFuseIntoReduction(Node * consumer, Value * producer) {
+    return allUsersAreThisConsumer(consumer, producer) &&
+        !hasRandom(producer->node());
+  }
+
+  bool isFusableComparisonProducer(Node * consumer, Value * producer) {
+    return producer->node()->owningBlock() == block_ &&
+        isFusableComparison(producer->node()) &&
+        allUsersAreThisConsumer(consumer, producer);
   }
 
   bool allUsersAreThisConsumer(Node * consumer, Value * producer) {
@@ -152,7 +254,7 @@ struct GraphFuser {
     }
     auto subgraph = producer->node()->g(attr::Subgraph);
     auto * node = subgraph->outputs().at(producer->offset())->node();
-    return isFusableOnlyAsExitNode(node);
+    return isFusableOnlyAsExitNode(node) || node->kind() == aten::sum;
   }
 
   Graph & getSubgraph(Node * n) {
@@ -309,7 +411,11 @@ struct GraphFuser {
     Node* real_consumer = consumer->kind() == aten::cat
         ? consumer->namedInput(attr::tensors)->node()
         : consumer;
-    bool shouldFuse = isFusable(producer->node()) &&
+    bool is_reduction =
+        isFusableReductionNode(consumer) || isReductionGroup(consumer);
+    bool shouldFuse = (isFusable(producer->node()) ||
+                       isFusableComparisonProducer(consumer, producer)) &&
+        (!is_reduction || canFuseIntoReduction(consumer, producer)) &&
         // Rearrange nodes such that all uses of producer are after the
         // consumer. Fusion will rewrite those later uses to use the version of
         // producer generated by the fused blob. In this case, producer becomes
@@ -361,7 +467,7 @@ struct GraphFuser {
   }
 
   bool canFuseChunk(Node* consumer, Value* producer) {
-    if (consumer->kind() != prim::FusionGroup) {
+    if (consumer->kind() != prim::FusionGroup || isReductionGroup(consumer)) {
       return false;
     }
     // Does the chunk have constant chunks/dim?
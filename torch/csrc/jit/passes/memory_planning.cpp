@@ -0,0 +1,342 @@
+#include "torch/csrc/jit/passes/memory_planning.h"
+
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/argument_spec.h"
+#include "torch/csrc/jit/assertions.h"
+#include "torch/csrc/jit/custom_operator.h"
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/passes/alias_analysis.h"
+
+#include <ATen/ATen.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch { namespace jit {
+
+// This pass is a liveness based memory planner in the spirit of caffe2's
+// memonger: once the shapes of all intermediate values are fixed (which is
+// the case for graphs specialized to a CompleteArgumentSpec), we know ahead
+// of time how much memory every tensor output needs and when it dies, and
+// can lay all of them out in a single buffer per device and dtype.
+//
+//   %y = aten::mm(%x, %w)               %a = prim::MemoryArena[size=...]()
+//   %z = aten::relu(%y)          ->     %s1 = prim::ArenaSlice[offset=0](%a)
+//   ...                                 %y = aten::mm(%x, %w, %s1)
+//                                       %s2 = prim::ArenaSlice[offset=...](%a)
+//                                       %z = aten::relu(%y, %s2)
+//
+// The arena is allocated on the first run and reused by the following ones,
+// as long as nothing from the previous run still holds on to it.
+
+namespace {
+
+std::atomic<bool> memory_planning_enabled{false};
+
+// Offsets into the arena are aligned to this many bytes.
+constexpr int64_t kAlignment = 64;
+
+struct PlannedValue {
+  Node* node;
+  const Operator* out_variant;
+  CompleteTensorTypePtr type;
+  int64_t numel;
+  // first and last position (in the top-level node list) at which the
+  // memory of the value is in use, inclusive
+  size_t begin;
+  size_t end;
+  int64_t offset;
+};
+
+int64_t numelOf(const CompleteTensorType& type) {
+  int64_t numel = 1;
+  for (auto s : type.sizes()) {
+    numel *= s;
+  }
+  return numel;
+}
+
+int deviceIndex(const CompleteTensorType& type) {
+  return type.device().is_cuda() ? type.device().index() : -1;
+}
+
+// Returns the out= overload of the operator n is an instance of, i.e. the
+// operator taking the same arguments followed by a Tensor named out, or
+// nullptr if there's none or n doesn't produce fresh memory.
+const Operator* findOutVariant(const Node* n) {
+  const FunctionSchema* schema = n->maybeSchema();
+  if (!schema || schema->is_vararg() || schema->is_varret() ||
+      schema->is_mutable() || schema->returns().size() != 1 ||
+      schema->returns()[0].alias_info()) {
+    return nullptr;
+  }
+  const auto& args = schema->arguments();
+  for (const auto& candidate : getAllOperatorsFor(n->kind())) {
+    const auto& candidate_args = candidate->schema().arguments();
+    if (candidate_args.size() != args.size() + 1 ||
+        candidate_args.back().name() != "out" ||
+        !candidate_args.back().type()->isSubtypeOf(DynamicType::get())) {
+      continue;
+    }
+    bool same_args = true;
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (args[i].name() != candidate_args[i].name() ||
+          *args[i].type() != *candidate_args[i].type()) {
+        same_args = false;
+        break;
+      }
+    }
+    if (same_args) {
+      return candidate.get();
+    }
+  }
+  return nullptr;
+}
+
+bool usesAny(const Node* n, const std::unordered_set<const Value*>& values) {
+  for (const Value* input : n->inputs()) {
+    if (values.count(input) != 0) {
+      return true;
+    }
+  }
+  for (const Block* b : n->blocks()) {
+    for (const Node* inner : b->nodes()) {
+      if (usesAny(inner, values)) {
+        return true;
+      }
+    }
+    if (usesAny(b->return_node(), values)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isContainer(const Value* v) {
+  auto kind = v->type()->kind();
+  return kind == TypeKind::ListType || kind == TypeKind::TupleType;
+}
+
+// Computes the last position at which the memory of the output of
+// nodes[pos] may still be read or written, following views of it and
+// containers it's put into. Returns false if it may outlive the graph.
+bool findLastUse(
+    const AliasDb& aliasDb,
+    const std::vector<Node*>& nodes,
+    size_t pos,
+    size_t* last_use) {
+  std::unordered_set<const Value*> derived{nodes[pos]->output()};
+  std::vector<const Value*> derived_list{nodes[pos]->output()};
+  auto addDerived = [&](const Value* v) {
+    if (derived.insert(v).second) {
+      derived_list.push_back(v);
+    }
+  };
+
+  *last_use = pos;
+  for (size_t i = pos + 1; i < nodes.size(); ++i) {
+    Node* n = nodes[i];
+    if (usesAny(n, derived)) {
+      *last_use = i;
+      for (const Value* input : n->inputs()) {
+        if (isContainer(input)) {
+          addDerived(input);
+        }
+      }
+      for (const Value* output : n->outputs()) {
+        if (isContainer(output)) {
+          addDerived(output);
+        }
+      }
+    }
+    for (const Value* output : n->outputs()) {
+      if (derived.count(output) != 0) {
+        continue;
+      }
+      for (size_t j = 0; j < derived_list.size(); ++j) {
+        if (aliasDb.mayAlias(output, derived_list[j])) {
+          addDerived(output);
+          break;
+        }
+      }
+    }
+  }
+  return !usesAny(nodes.back()->owningGraph()->return_node(), derived);
+}
+
+// Places values by decreasing size at the lowest offset that doesn't overlap
+// with any already placed value that is live at the same time. Returns the
+// size of the arena.
+int64_t placeValues(std::vector<PlannedValue*>& values, int64_t alignment) {
+  std::stable_sort(
+      values.begin(), values.end(), [](PlannedValue* a, PlannedValue* b) {
+        return a->numel > b->numel;
+      });
+  auto aligned = [&](int64_t n) {
+    return (n + alignment - 1) / alignment * alignment;
+  };
+
+  int64_t arena_size = 0;
+  std::vector<PlannedValue*> placed;
+  for (PlannedValue* v : values) {
+    std::vector<PlannedValue*> conflicts;
+    for (PlannedValue* p : placed) {
+      if (p->begin <= v->end && v->begin <= p->end) {
+        conflicts.push_back(p);
+      }
+    }
+    std::sort(
+        conflicts.begin(),
+        conflicts.end(),
+        [](PlannedValue* a, PlannedValue* b) { return a->offset < b->offset; });
+    int64_t offset = 0;
+    for (PlannedValue* c : conflicts) {
+      if (offset + v->numel <= c->offset) {
+        break;
+      }
+      offset = std::max(offset, aligned(c->offset + c->numel));
+    }
+    v->offset = offset;
+    arena_size = std::max(arena_size, offset + v->numel);
+    placed.push_back(v);
+  }
+  return arena_size;
+}
+
+} // anonymous namespace
+
+bool memoryPlanningEnabled() {
+  return memory_planning_enabled;
+}
+
+void setMemoryPlanningEnabled(bool value) {
+  memory_planning_enabled = value;
+}
+
+void PlanMemory(std::shared_ptr<Graph>& graph) {
+  AliasDb aliasDb(graph);
+  std::vector<Node*> nodes(graph->nodes().begin(), graph->nodes().end());
+
+  std::vector<PlannedValue> planned;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    Node* n = nodes[i];
+    if (n->outputs().size() != 1) {
+      continue;
+    }
+    auto type = n->output()->type()->cast<CompleteTensorType>();
+    if (!type || type->strides() != type->contiguous()->strides()) {
+      continue;
+    }
+    const Operator* out_variant = findOutVariant(n);
+    size_t last_use;
+    if (!out_variant || !findLastUse(aliasDb, nodes, i, &last_use)) {
+      continue;
+    }
+    planned.push_back({n, out_variant, type, numelOf(*type), i, last_use, 0});
+  }
+  if (planned.empty()) {
+    return;
+  }
+
+  std::map<std::pair<int, at::ScalarType>, std::vector<PlannedValue*>> arenas;
+  for (auto& v : planned) {
+    arenas[{deviceIndex(*v.type), v.type->scalarType()}].push_back(&v);
+  }
+
+  Node* first = *graph->nodes().begin();
+  std::unordered_map<const Node*, Value*> arena_for;
+  for (auto& entry : arenas) {
+    int device = entry.first.first;
+    at::ScalarType dtype = entry.first.second;
+    int64_t alignment =
+        std::max<int64_t>(kAlignment / at::elementSize(dtype), 1);
+    int64_t size = placeValues(entry.second, alignment);
+
+    Node* arena = graph->create(prim::MemoryArena);
+    arena->i_(attr::size, size)
+        ->i_(attr::dtype, static_cast<int64_t>(dtype))
+        ->i_(attr::device, device);
+    arena->output()->setType(CompleteTensorType::create(
+        dtype, ConvertIntToCPUOrCUDA(device), at::IntList{size}));
+    arena->insertBefore(first);
+    for (PlannedValue* v : entry.second) {
+      arena_for[v->node] = arena->output();
+    }
+  }
+
+  for (auto& v : planned) {
+    Node* n = v.node;
+    Node* slice = graph->create(prim::ArenaSlice, {arena_for.at(n)});
+    slice->i_(attr::offset, v.offset)->is_(attr::sizes, v.type->sizes());
+    slice->output()->setType(v.type);
+    slice->insertBefore(n);
+
+    std::vector<Value*> inputs(n->inputs().begin(), n->inputs().end());
+    inputs.push_back(slice->output());
+    Node* out_node = graph->create(n->kind(), inputs);
+    out_node->setSourceLocation(n->getSourceLocation());
+    out_node->output()->copyMetadata(n->output());
+    out_node->insertBefore(n);
+    JIT_ASSERT(findOperatorFor(out_node).get() == v.out_variant);
+    n->output()->replaceAllUsesWith(out_node->output());
+    n->destroy();
+  }
+}
+
+namespace {
+
+// The arena of a prim::MemoryArena node is kept around between runs and
+// handed out again unless some tensor of a previous run still refers to it
+// (e.g. because the graph is being run concurrently from another thread).
+struct CachedArena {
+  at::Tensor get(int64_t size, at::ScalarType dtype, int device) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!arena.defined() || arena.use_count() != 1 ||
+        arena.storage().use_count() != 1) {
+      arena = autograd::make_variable(at::empty(
+          {size}, at::device(ConvertIntToCPUOrCUDA(device)).dtype(dtype)));
+    }
+    return arena;
+  }
+
+  std::mutex mutex;
+  at::Tensor arena;
+};
+
+RegisterOperators memory_planning_reg({
+  Operator(
+    prim::MemoryArena,
+    [](const Node* node) {
+      auto size = node->i(attr::size);
+      auto dtype = static_cast<at::ScalarType>(node->i(attr::dtype));
+      auto device = static_cast<int>(node->i(attr::device));
+      auto cached = std::make_shared<CachedArena>();
+      return [=](Stack& stack) {
+        push(stack, cached->get(size, dtype, device));
+        return 0;
+      };
+    }),
+  Operator(
+    prim::ArenaSlice,
+    [](const Node* node) {
+      auto offset = node->i(attr::offset);
+      auto sizes = node->is(attr::sizes);
+      std::vector<int64_t> strides(sizes.size(), 1);
+      for (int64_t i = static_cast<int64_t>(sizes.size()) - 2; i >= 0; --i) {
+        strides[i] = strides[i + 1] * sizes[i + 1];
+      }
+      return [=](Stack& stack) {
+        auto arena = pop(stack).toTensor();
+        push(stack, arena.as_strided(sizes, strides, offset));
+        return 0;
+      };
+    }),
+});
+
+} // anonymous namespace
+
+}}
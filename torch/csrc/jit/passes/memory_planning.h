@@ -0,0 +1,22 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Assigns the outputs of nodes with statically known, contiguous shapes to
+// offsets in a few preallocated arenas (one per device and dtype), so that
+// values whose lifetimes don't overlap share memory. Planned nodes are
+// rewritten to their out= variants, writing into a prim::ArenaSlice of a
+// prim::MemoryArena, and the arenas are reused across runs of the graph.
+//
+// Values that may escape the graph (through its outputs, or through aliases
+// the pass can't see through) are left alone.
+TORCH_API void PlanMemory(std::shared_ptr<Graph>& graph);
+
+// Whether the graph executor plans memory of graphs run without gradients.
+// Off by default.
+TORCH_API bool memoryPlanningEnabled();
+TORCH_API void setMemoryPlanningEnabled(bool value);
+
+}}
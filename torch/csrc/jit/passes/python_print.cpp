@@ -830,14 +830,21 @@ TORCH_API bool printerHasSpecialCaseFor(Symbol sym) {
     onnx::Reshape, // only used in onnx
     onnx::Shape, // only used in onnx
     prim::AnyDefined, // temporarily inserted by autograd
+    prim::ArenaSlice, // optimization pass adds it
     prim::AutogradAdd, // temporarily inserted by autograd
+    prim::CalibrationObserver, // calibration pass adds it
     prim::ConstantChunk, // optimization pass adds it
     prim::DifferentiableGraph, // optimization pass adds it
     prim::Drop, // used in interpreter only
     prim::FusedConcat, // optimization pass adds it
     prim::FusionGroup, // optimization pass adds it
     prim::Load, // used in interpreter only
+    prim::MemoryArena, // optimization pass adds it
     prim::MMTreeReduce, // used in batched execution only
+    prim::MMBatchSide, // used in batched execution only
+    prim::AddMMBatchSide, // used in batched execution only
+    prim::ConvBatchSide, // used in batched execution only
+    prim::BatchedMM, // used in batched execution only
     prim::Store, // used in interpreter only
 
   };
@@ -111,7 +111,12 @@ inline IValue toIValue(py::handle obj, const TypePtr& type, c10::optional<int32_
       case TypeKind::TensorType:
       case TypeKind::UndefinedTensorType:
       case TypeKind::CompleteTensorType: {
-        auto var = py::cast<autograd::Variable>(obj);
+        // the fast path of the arguments of most methods, which skips the
+        // pybind11 casters
+        if (!THPVariable_Check(obj.ptr())) {
+          throw py::cast_error();
+        }
+        const auto& var = reinterpret_cast<THPVariable*>(obj.ptr())->cdata;
         if (var.is_sparse()) {
           AT_ERROR("sparse tensors not supported");
         }
@@ -132,8 +137,7 @@ inline IValue toIValue(py::handle obj, const TypePtr& type, c10::optional<int32_
         if(!PyTuple_Check(obj.ptr()))
           throw py::cast_error(); // note: the py::cast does not throw cast_error
                                   // because it attempts to iterate a non-tuple
-        py::tuple tuple = py::cast<py::tuple>(obj);
-        size_t tuple_size = tuple.size();
+        size_t tuple_size = PyTuple_GET_SIZE(obj.ptr());
         const auto & elem_types = type->cast<TupleType>()->elements();
         if (elem_types.size() != tuple_size) {
           throw py::cast_error();
@@ -141,7 +145,7 @@ inline IValue toIValue(py::handle obj, const TypePtr& type, c10::optional<int32_
         std::vector<IValue> values;
         values.reserve(tuple_size);
         for (size_t i = 0; i < tuple_size; ++i) {
-          values.push_back(toIValue(tuple[i], elem_types[i]));
+          values.push_back(toIValue(PyTuple_GET_ITEM(obj.ptr(), i), elem_types[i]));
         }
         return Tuple::create(std::move(values));
       }
@@ -275,11 +279,15 @@ inline py::object toPyObject(IValue&& ivalue) {
     }
     return t;
   } else if (ivalue.isTuple()) {
-    auto tuple = ivalue.toTuple();
-    const auto & elements = tuple->elements();
+    auto tuple = std::move(ivalue).toTuple();
+    auto & elements = tuple->elements();
+    // the elements are moved out of the tuples nothing else holds, as those
+    // returned by a method
+    const bool unique = tuple.use_count() == 1;
     py::tuple t { elements.size() };
     for (size_t i = 0; i < elements.size(); ++i) {
-      t[i] = toPyObject(IValue{elements[i]});
+      PyTuple_SET_ITEM(t.ptr(), i, toPyObject(
+          unique ? std::move(elements[i]) : IValue{elements[i]}).release().ptr());
     }
     return t;
   } else {
@@ -312,7 +320,9 @@ private:
   int64_t e;
 };
 
-inline Stack createStackForSchema(
+// Pushes the arguments of a call to schema onto stack
+inline void pushStackForSchema(
+    Stack& stack,
     const FunctionSchema& schema,
     tuple_slice args,
     py::kwargs kwargs = py::kwargs()) {
@@ -322,8 +332,6 @@ inline Stack createStackForSchema(
         " argument(s) but received ",
         args.size() + kwargs.size(), " argument(s). Declaration: ", schema));
   }
-  Stack stack;
-  stack.reserve(schema.arguments().size());
 
   // First push all positional args.
   for (size_t i = 0; i < args.size(); ++i) {
@@ -355,7 +363,15 @@ inline Stack createStackForSchema(
   if (consumed_kwargs != kwargs.size()) {
     detail::findErrorInKwargs(schema, kwargs);
   }
+}
 
+inline Stack createStackForSchema(
+    const FunctionSchema& schema,
+    tuple_slice args,
+    py::kwargs kwargs = py::kwargs()) {
+  Stack stack;
+  stack.reserve(schema.arguments().size());
+  pushStackForSchema(stack, schema, std::move(args), std::move(kwargs));
   return stack;
 }
 
@@ -393,10 +409,49 @@ inline Stack evilDeprecatedBadCreateStackDoNotUse(const py::tuple& tuple, at::Ar
   return result;
 }
 
+namespace detail {
+
+// The stack of the script method calls of a thread, which keeps its capacity
+// from a call to the next so that calls don't allocate it. Calls from within
+// a call, through a Python op, use stacks of their own.
+struct ThreadMethodStack {
+  ThreadMethodStack() {
+    if (!cached().second) {
+      stack_ = &cached().first;
+      cached().second = true;
+    } else {
+      stack_ = &own_;
+    }
+  }
+  ~ThreadMethodStack() {
+    // the values of the call must not outlive it
+    stack_->clear();
+    if (stack_ != &own_) {
+      cached().second = false;
+    }
+  }
+  Stack& get() {
+    return *stack_;
+  }
+
+ private:
+  // the stack, and whether a call is using it
+  static std::pair<Stack, bool>& cached() {
+    static thread_local std::pair<Stack, bool> cached;
+    return cached;
+  }
+  Stack* stack_;
+  Stack own_;
+};
+
+} // namespace detail
+
 inline py::object invokeScriptMethodFromPython(
     script::Method& method,
     tuple_slice args, py::kwargs kwargs) {
-  auto stack = createStackForSchema(method.getSchema(), std::move(args), std::move(kwargs));
+  detail::ThreadMethodStack thread_stack;
+  Stack& stack = thread_stack.get();
+  pushStackForSchema(stack, method.getSchema(), std::move(args), std::move(kwargs));
   {
     AutoNoGIL no_gil_guard;
     method.run(stack);
@@ -136,6 +136,29 @@ void initPythonTracerBindings(PyObject* module) {
     })
     .def("graph", [](TracingState& s) {
       return s.graph;
+    })
+    // fn returns the result of the call and its tensor outputs, of which only
+    // the result is returned
+    .def("_record_call", [](TracingState& s, const std::string& key, variable_list inputs, py::function fn) {
+      py::object result;
+      recordCall(key, inputs, [&] {
+        auto output = fn();
+        result = output[py::int_(0)];
+        return py::cast<variable_list>(output[py::int_(1)]);
+      });
+      return result;
+    })
+    .def("_has_recorded_call", [](TracingState& s, const std::string& key) {
+      return s.recorded_calls.count(key) > 0;
+    })
+    .def("_replay_call", [](TracingState& s, const std::string& key, variable_list inputs, py::function fn) {
+      py::object result;
+      replayCall(key, inputs, [&] {
+        auto output = fn();
+        result = output[py::int_(0)];
+        return py::cast<variable_list>(output[py::int_(1)]);
+      });
+      return result;
     });
 
   m.def("_tracer_warn_use_python", []() {
@@ -12,6 +12,8 @@
 
 #include "torch/csrc/variable_tensor_functions.h"
 
+#include <ATen/Parallel.h>
+
 #include <exception>
 #include <iostream>
 #include <limits>
@@ -52,6 +54,22 @@ void checkImplicitTensorToNum(at::Tensor t, bool toInt) {
   }
 }
 
+// Pushes the elements of a list or a tuple popped off the stack, moving them
+// when nothing else holds the list, as for the lists and tuples built by
+// ListConstruct and TupleConstruct
+template <typename T>
+void pushElements(Stack& stack, c10::intrusive_ptr<T> list) {
+  auto& elems = list->elements();
+  if (list.use_count() == 1) {
+    stack.insert(
+        stack.end(),
+        std::make_move_iterator(elems.begin()),
+        std::make_move_iterator(elems.end()));
+  } else {
+    stack.insert(stack.end(), elems.begin(), elems.end());
+  }
+}
+
 RegisterOperators reg({
     Operator(
         prim::FusionGroup,
@@ -346,11 +364,11 @@ RegisterOperators reg({
           size_t num_elems = node->outputs().size();
           return [=](Stack& stack) {
             auto t = pop(stack).toTuple();
-            const auto & elems = t->elements();
-            if (elems.size() != num_elems) {
-              AT_ERROR("Expected a tuple of ", num_elems, " elements, but got ", elems.size());
+            const size_t size = t->elements().size();
+            if (size != num_elems) {
+              AT_ERROR("Expected a tuple of ", num_elems, " elements, but got ", size);
             }
-            stack.insert(stack.end(), elems.begin(), elems.end());
+            pushElements(stack, std::move(t));
             return 0;
           };
         }),
@@ -376,9 +394,13 @@ RegisterOperators reg({
         auto index = node->i(attr::index);
         return [=](Stack& stack) {
           auto tup = pop(stack).toTuple();
-          const auto & elems = tup->elements();
+          auto & elems = tup->elements();
           // index is normalized to be positive at compile time
-          stack.emplace_back(elems.at(index));
+          if (tup.use_count() == 1) {
+            stack.emplace_back(std::move(elems.at(index)));
+          } else {
+            stack.emplace_back(elems.at(index));
+          }
           return 0;
         };
       }),
@@ -451,11 +473,11 @@ RegisterOperators reg({
             };
           } else if (lt->getElementType() == DynamicType::get()) {
             return [=](Stack& stack) {
-              auto ilist = pop(stack);
-              const auto & list = ilist.toTensorList()->elements();
-              AT_CHECK(list.size() == num_outputs,
-                       "Expected ", num_outputs, " elements in a list but found ", list.size());
-              stack.insert(stack.end(), list.begin(), list.end());
+              auto list = pop(stack).toTensorList();
+              const size_t size = list->elements().size();
+              AT_CHECK(size == num_outputs,
+                       "Expected ", num_outputs, " elements in a list but found ", size);
+              pushElements(stack, std::move(list));
               return 0;
             };
           } else {
@@ -539,7 +561,7 @@ RegisterOperators reg({
 
             push(stack, forked_interprester.getFuture());
 
-            c10::global_work_queue.schedule(std::move(continuation));
+            at::launch(std::move(continuation));
             return 0;
           };
         }),
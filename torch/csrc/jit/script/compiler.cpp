@@ -2432,11 +2432,12 @@ std::vector<Value*> inlineCallTo(Graph& g, Graph& callee, ArrayRef<Value*> input
   return outputs;
 }
 
-void defineMethodsInModule(std::shared_ptr<Module> m, const std::vector<Def>& definitions, const std::vector<Resolver>& resolvers, SugaredValuePtr self) {
+void defineMethodsInModule(std::shared_ptr<Module> m, const std::vector<Def>& definitions, const std::vector<Resolver>& resolvers, SugaredValuePtr self, bool lazily) {
   JIT_ASSERT(definitions.size() == resolvers.size());
   auto resolver_it = resolvers.begin();
   std::vector<Method*> methods;
-  std::unordered_map<std::string, Method*> function_table;
+  // outlives this call when the methods are defined lazily
+  auto function_table = std::make_shared<std::unordered_map<std::string, Method*>>();
   for(Def def : definitions) {
     const std::string& name = def.name().name();
     auto resolver = *resolver_it++;
@@ -2445,12 +2446,12 @@ void defineMethodsInModule(std::shared_ptr<Module> m, const std::vector<Def>& de
       // if self is defined, then these are methods and do not go into the global namespace
       // otherwise, they get defined together so we add them to the function table
       // so the methods can see each other
-      resolver = [resolver, &function_table](
+      resolver = [resolver, function_table](
                      const std::string& name,
                      Method& m,
                      const SourceRange& loc) -> std::shared_ptr<SugaredValue> {
-        auto it = function_table.find(name);
-        if (it != function_table.end()) {
+        auto it = function_table->find(name);
+        if (it != function_table->end()) {
           return std::make_shared<MethodValue>(nullptr, *it->second);
         }
         return resolver(name, m, loc);
@@ -2461,11 +2462,13 @@ void defineMethodsInModule(std::shared_ptr<Module> m, const std::vector<Def>& de
       to_ir(def, resolver, self,  method);
     };
     Method& method = m->create_method(name, creator);
-    function_table[name] = &method;
+    (*function_table)[name] = &method;
     methods.push_back(&method);
   }
-  for(Method* method : methods) {
-    method->ensure_defined();
+  if (!lazily) {
+    for(Method* method : methods) {
+      method->ensure_defined();
+    }
   }
   didFinishEmitModule(m);
 }
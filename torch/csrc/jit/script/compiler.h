@@ -173,7 +173,8 @@ TORCH_API void defineMethodsInModule(
   std::shared_ptr<Module> m,
   const std::vector<Def>& definitions,
   const std::vector<Resolver>& resolvers, /* determines how we handle free variables in each definition*/
-  std::shared_ptr<SugaredValue> self /* if non-null, the first argument to each def, is bound to this value */
+  std::shared_ptr<SugaredValue> self, /* if non-null, the first argument to each def, is bound to this value */
+  bool lazily = false /* if true, each method is compiled when first used instead of before returning */
 );
 
 // same as above but parse the definitions from source
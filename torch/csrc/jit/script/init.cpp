@@ -429,6 +429,13 @@ void initJitScriptBindings(PyObject* module) {
           return py::bytes(buf.str());
       })
       .def("_set_optimized", &Module::set_optimized)
+      .def(
+          "_freeze_for_inference",
+          &Module::freeze,
+          py::arg("prepack_linear_weights") = false,
+          py::arg("fp16") = false)
+      // the methods defined in Python resolve names with the GIL
+      .def("_define_methods", &Module::define_methods, py::call_guard<py::gil_scoped_release>())
       .def(
           "_define",
           [](std::shared_ptr<Module> m,
@@ -4,6 +4,13 @@
 #include "torch/csrc/jit/script/error_report.h"
 #include "torch/csrc/jit/export.h"
 #include "torch/csrc/jit/operator.h"
+#include "torch/csrc/jit/passes/freeze_module.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <unordered_map>
 
 namespace torch { namespace jit { namespace script {
 
@@ -66,12 +73,152 @@ std::vector<Value*> Method::emit_call_to(SourceRange loc, Method & callee, Array
   throw ErrorReport(loc) << failure_messages.str();
 }
 
+namespace {
+
+// Guards the definition state of all methods, the methods being defined by
+// other threads being waited on with definition_cv
+std::mutex definition_mutex;
+std::condition_variable definition_cv;
+// The thread defining a method, and the method each thread waits for
+std::unordered_map<std::thread::id, const Method*> waited_methods;
+
+} // anonymous namespace
+
 void Method::ensure_defined() {
-  if(method_creator) {
-    auto creator = method_creator;
-    method_creator = placeholderCreator;
+  if (defined_.load()) {
+    return;
+  }
+  const auto this_thread = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lock(definition_mutex);
+  while (method_creator && defining_thread_ != std::thread::id()) {
+    // Waiting for a method being defined by this thread, or by a thread
+    // waiting for one, means the methods call each other
+    auto waiting_thread = defining_thread_;
+    while (waiting_thread != this_thread) {
+      auto it = waited_methods.find(waiting_thread);
+      if (it == waited_methods.end()) {
+        break;
+      }
+      waiting_thread = it->second->defining_thread_;
+    }
+    if (waiting_thread == this_thread) {
+      throw RecursiveMethodCallError();
+    }
+    waited_methods[this_thread] = this;
+    definition_cv.wait(lock);
+    waited_methods.erase(this_thread);
+  }
+  if (!method_creator) {
+    return;
+  }
+  auto creator = method_creator;
+  // A method that failed to be defined is not defined again
+  method_creator = placeholderCreator;
+  defining_thread_ = this_thread;
+  lock.unlock();
+  try {
     creator(*this);
-    method_creator = nullptr;
+  } catch (...) {
+    lock.lock();
+    defining_thread_ = std::thread::id();
+    definition_cv.notify_all();
+    throw;
+  }
+  lock.lock();
+  method_creator = nullptr;
+  defining_thread_ = std::thread::id();
+  defined_.store(true);
+  definition_cv.notify_all();
+}
+
+void Method::define_lazily() const {
+  if (defined_.load()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(definition_mutex);
+    if (!method_creator || defining_thread_ == std::this_thread::get_id()) {
+      return;
+    }
+  }
+  const_cast<Method*>(this)->ensure_defined();
+}
+
+void Method::freeze(bool prepack_linear_weights, bool fp16) {
+  ensure_defined();
+  Graph& g = *graph_;
+  const size_t num_inputs = this->num_inputs();
+  {
+    WithInsertPoint guard(*g.nodes().begin());
+    for (size_t i = 0; i < member_inputs.size(); ++i) {
+      const at::Tensor& member = *member_inputs[i];
+      Value* constant = member.defined()
+          ? g.insertConstant(member)
+          : g.insertNode(g.createUndefined())->output();
+      g.inputs().at(num_inputs + i)->replaceAllUsesWith(constant);
+    }
+  }
+  for (size_t i = g.inputs().size(); i-- > num_inputs;) {
+    g.eraseInput(i);
+  }
+  member_inputs.clear();
+  member_input_index.clear();
+  OptimizeFrozenGraph(graph_);
+  if (prepack_linear_weights) {
+    PrepackLinearWeights(graph_, fp16);
+  }
+  // The executor of a method that already ran optimized the old graph
+  if (executor) {
+    executor = GraphExecutor(graph_, optimize);
+  }
+}
+
+void Module::collect_methods(std::vector<Method*>& all) {
+  for (auto& method : methods) {
+    all.push_back(method.value().get());
+  }
+  for (auto& child : modules) {
+    child->module->collect_methods(all);
+  }
+}
+
+void Module::define_methods(size_t num_threads) {
+  std::vector<Method*> to_define;
+  collect_methods(to_define);
+  std::atomic<size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto define = [&] {
+    for (size_t i = next++; i < to_define.size(); i = next++) {
+      try {
+        to_define[i]->ensure_defined();
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(num_threads, to_define.size()); ++i) {
+    threads.emplace_back(define);
+  }
+  define();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void Module::freeze(bool prepack_linear_weights, bool fp16) {
+  for (auto& method : methods) {
+    method.value()->freeze(prepack_linear_weights, fp16);
+  }
+  for (auto& child : modules) {
+    child->module->freeze(prepack_linear_weights, fp16);
   }
 }
 
@@ -15,11 +15,14 @@
 
 #include <c10/util/ArrayRef.h>
 #include "c10/util/Optional.h"
+#include "c10/util/TraceContext.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <ostream>
@@ -49,6 +52,7 @@ struct Method {
   , optimize(optimize)
   , member_inputs(std::move(initial_members))
   , method_creator(std::move(method_creator)) {
+    defined_ = !this->method_creator;
     JIT_ASSERT(graph_->inputs().size() >= member_inputs.size());
     int i = graph_->inputs().size() - member_inputs.size();
     for(at::Tensor* member : member_inputs) {
@@ -56,7 +60,11 @@ struct Method {
     }
   }
 
+  // Runs for a new request unless the caller already is running for one, so
+  // that the events traced while running are attributed to the call
   void run(Stack & stack) {
+    c10::TraceContextGuard trace_guard(c10::TraceContext::currentOrNewRequest());
+    define_lazily();
     for(at::Tensor* tp : member_inputs) {
       stack.emplace_back(*tp);
     }
@@ -73,12 +81,14 @@ struct Method {
   }
 
   std::shared_ptr<Graph> graph_for(Stack inputs) {
+    define_lazily();
     for(at::Tensor* tp : member_inputs) {
       inputs.emplace_back(*tp);
     }
     return get_executor().graphFor(inputs);
   }
   TORCH_API std::shared_ptr<Graph> graph() const {
+    define_lazily();
     return graph_;
   }
 
@@ -91,9 +101,18 @@ struct Method {
   // defined here to keep details of member_input handling confined to this class
   std::vector<Value*> emit_call_to(SourceRange loc, Method & callee, ArrayRef<NamedValue> args, ArrayRef<NamedValue> kwargs);
 
-  // if this isn't yet defined, run its method_creator function
+  // if this isn't yet defined, run its method_creator function. Methods may
+  // be defined by several threads at once: a method being defined by another
+  // thread is waited for, and a call that would wait for the thread waiting
+  // on it is a recursive call.
   TORCH_API void ensure_defined();
 
+  // Replaces the parameters used by this method by constants holding their
+  // current values, and optimizes the graph for inference with them (see
+  // OptimizeFrozenGraph, and PrepackLinearWeights if prepack_linear_weights).
+  // Must not be called while the method runs.
+  TORCH_API void freeze(bool prepack_linear_weights = false, bool fp16 = false);
+
 
   size_t num_inputs() const {
     return graph()->inputs().size() - member_inputs.size();
@@ -110,7 +129,7 @@ struct Method {
   }
 
   std::shared_ptr<Graph> propagate_shapes(std::vector<at::Tensor> inputs, bool with_grad=false) {
-    auto retval = graph_->copy();
+    auto retval = graph()->copy();
     Stack stack;
     stack.reserve(inputs.size() + member_inputs.size());
     for (at::Tensor & i : inputs) {
@@ -126,7 +145,7 @@ struct Method {
   }
 
   std::shared_ptr<Graph> propagate_and_assign_input_and_output_shapes(std::vector<at::Tensor> inputs, std::vector<at::Tensor> outputs, bool with_grad=false, bool propagate=true) {
-    auto retval = graph_->copy();
+    auto retval = graph()->copy();
     for (auto inp : member_inputs) {
       inputs.push_back(*inp);
     }
@@ -152,6 +171,7 @@ struct Method {
   }
 
   std::vector<at::Tensor*> params() const {
+    define_lazily();
     return member_inputs;
   }
 
@@ -188,6 +208,11 @@ struct Method {
 
 private:
 
+  // Defines the method if it's lazily defined (see defineMethodsInModule)
+  // and isn't being defined by this thread, as the compiler accesses the
+  // method it defines
+  TORCH_API void define_lazily() const;
+
   static FunctionSchema defaultSchemaFor(const Method& method) {
     std::vector<Argument> args;
     std::vector<Argument> returns;
@@ -269,6 +294,9 @@ private:
   // is first called.
   // this is used by the compiler so that it can construct methods out of order
   std::function<void(Method&)> method_creator;
+  // whether method_creator ran, and the thread running it
+  std::atomic<bool> defined_;
+  std::thread::id defining_thread_;
 
   // if absent, then we generate a default schema based on the graph
   // mutable because getSchema caches the default schema if one is requested
@@ -437,6 +465,22 @@ struct Module {
     return get_method(method_name)({IValue(std::forward<Types>(args))...});
   }
 
+  /// Compiles the methods of this module and of its submodules that are not
+  /// yet, with up to `num_threads` threads. The methods imported from source
+  /// are otherwise compiled when first used.
+  TORCH_API void define_methods(size_t num_threads);
+
+  /// Freezes all methods of this module and of its submodules for inference.
+  /// The parameters and buffers they use become constants of their graphs,
+  /// which lets the computations on them alone (e.g. transposing weights,
+  /// or folding batch norms into convolutions) be done once and for all.
+  /// The methods keep the current values of the parameters: writing to them
+  /// afterwards has an undefined effect on the results.
+  /// With `prepack_linear_weights`, the weights of the linear layers are also
+  /// laid out once for the GEMMs of the CPU (in fp16, with fp32 compute, if
+  /// `fp16`), and the module can't be saved anymore.
+  TORCH_API void freeze(bool prepack_linear_weights = false, bool fp16 = false);
+
   void save(std::ostream& out);
 
   void save(const std::string& filename);
@@ -447,6 +491,8 @@ struct Module {
       c10::optional<at::ScalarType> dtype,
       bool non_blocking);
 
+  void collect_methods(std::vector<Method*>& all);
+
   // invariant: to ensure member_inputs of Methods stay valid,
   // it is only legal to _add_ new modules and parameters.
   // removing them will allow member_inputs to point to invalid parameters
@@ -11,6 +11,8 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace torch { namespace jit { namespace tracer {
 
@@ -175,6 +177,124 @@ autograd::Variable getSizeOf(const autograd::Variable& var, int64_t dim) {
   return size_var;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Recorded calls
+////////////////////////////////////////////////////////////////////////////////
+variable_list recordCall(
+    const std::string& key,
+    const variable_list& inputs,
+    const std::function<variable_list()>& fn) {
+  auto state = getTracingState();
+  JIT_ASSERT(state);
+  auto& graph = state->graph;
+  TracingState::RecordedCall call;
+  call.inputs = fmap(inputs, getValueTrace);
+  call.scope = graph->current_scope();
+  // Nodes may be inserted before others, after the value they use, so the
+  // nodes of the call are those that were not in the graph before it
+  std::unordered_set<Node*> previous_nodes(graph->nodes().begin(), graph->nodes().end());
+
+  auto outputs = fn();
+
+  for (Node* node : graph->nodes()) {
+    if (previous_nodes.count(node) == 0) {
+      call.nodes.push_back(node);
+    }
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    Value* value = getValueTrace(inputs[i]);
+    call.updated_inputs.push_back(value == call.inputs[i] ? nullptr : value);
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    call.outputs.push_back(
+        outputs[i].defined() ? getOutputTrace(state, outputs[i], i) : nullptr);
+  }
+  state->recorded_calls[key] = std::move(call);
+  return outputs;
+}
+
+bool hasRecordedCall(const std::string& key) {
+  auto& state = getTracingState();
+  return state && state->recorded_calls.count(key) > 0;
+}
+
+variable_list replayCall(
+    const std::string& key,
+    const variable_list& inputs,
+    const std::function<variable_list()>& fn) {
+  auto state = getTracingState();
+  JIT_ASSERT(state);
+  auto& graph = state->graph;
+  const auto& call = state->recorded_calls.at(key);
+  AT_CHECK(
+      inputs.size() == call.inputs.size(), "the call replayed has ",
+      inputs.size(), " inputs but the recorded one had ", call.inputs.size());
+  std::unordered_map<Value*, Value*> env;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    env[call.inputs[i]] = getValueTrace(inputs[i]);
+  }
+
+  variable_list outputs;
+  setTracingState(nullptr);
+  try {
+    outputs = fn();
+  } catch (...) {
+    setTracingState(state);
+    throw;
+  }
+  setTracingState(state);
+  AT_CHECK(
+      outputs.size() == call.outputs.size(), "the call replayed has ",
+      outputs.size(), " outputs but the recorded one had ", call.outputs.size());
+
+  // The values the nodes of the call use that it didn't compute are shared
+  auto lookup = [&](Value* value) {
+    auto it = env.find(value);
+    return it == env.end() ? value : it->second;
+  };
+  // The scopes of the nodes, relative to the scope of the call
+  std::unordered_map<Scope*, ScopePtr> scopes = {
+      {call.scope.get(), graph->current_scope()}};
+  std::function<ScopePtr(ScopePtr)> map_scope = [&](ScopePtr scope) {
+    if (!scope || scope->isRoot()) {
+      return graph->current_scope();
+    }
+    auto it = scopes.find(scope.get());
+    if (it == scopes.end()) {
+      it = scopes.emplace(scope.get(), map_scope(scope->parent())->push(scope->name())).first;
+    }
+    return it->second;
+  };
+  for (Node* node : call.nodes) {
+    // The outputs of a clone take the names of those of the node, which would
+    // be renamed instead
+    std::vector<std::string> names;
+    for (Value* output : node->outputs()) {
+      names.push_back(output->hasUniqueName() ? output->uniqueName() : "");
+      output->setUniqueName("");
+    }
+    Node* clone = graph->insertNode(graph->createClone(node, lookup));
+    clone->setScope(map_scope(node->scope()));
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (!names[i].empty()) {
+        node->outputs()[i]->setUniqueName(names[i]);
+      }
+      env[node->outputs()[i]] = clone->outputs()[i];
+    }
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (call.updated_inputs[i]) {
+      setValueTrace(inputs[i], lookup(call.updated_inputs[i]));
+    }
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (outputs[i].defined() && call.outputs[i]) {
+      setValueTrace(outputs[i], lookup(call.outputs[i]));
+    }
+  }
+  return outputs;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Argument stash
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,4 +246,20 @@ TORCH_API void addOutput(Node* node, const std::vector<at::Tensor>& list);
 
 TORCH_API autograd::Variable getSizeOf(const autograd::Variable& var, int64_t dim);
 
+// Traces fn, a call of inputs returning its outputs, and records it under
+// key, so that the later calls with the key can be replayed
+TORCH_API variable_list recordCall(
+    const std::string& key,
+    const variable_list& inputs,
+    const std::function<variable_list()>& fn);
+TORCH_API bool hasRecordedCall(const std::string& key);
+// Runs fn untraced, and appends to the trace a copy of the nodes of the call
+// recorded under key, of inputs instead of its inputs, as the trace of the
+// outputs of fn. The call has to compute the same function of its inputs as
+// the recorded one did, which only the caller can know.
+TORCH_API variable_list replayCall(
+    const std::string& key,
+    const variable_list& inputs,
+    const std::function<variable_list()>& fn);
+
 }}} // namespace torch::jit::tracer
@@ -21,7 +21,9 @@
 #include <cstdint>
 #include <unordered_map>
 
-namespace torch { namespace jit { namespace tracer {
+namespace torch { namespace jit {
+struct Node;
+namespace tracer {
 
 using torch::autograd::Variable;
 using variable_list = std::vector<Variable>;
@@ -46,6 +48,21 @@ struct TORCH_API TracingState : public std::enable_shared_from_this<TracingState
 
   std::unordered_map<WeakTensor, Value*, WeakTensorHasher, WeakTensorEq> value_map;
   std::shared_ptr<Graph> graph;
+
+  // A call traced once, the nodes of which are copied for the later calls
+  // with the same key instead of tracing them, see recordCall and replayCall
+  struct RecordedCall {
+    std::vector<Value*> inputs;
+    // The values of the inputs the call modified in place, and nullptr for
+    // the others
+    std::vector<Value*> updated_inputs;
+    // nullptr for the undefined outputs
+    std::vector<Value*> outputs;
+    std::vector<Node*> nodes;
+    ScopePtr scope;
+  };
+  std::unordered_map<std::string, RecordedCall> recorded_calls;
+
   bool warn = true;
   std::function<std::string(const Variable& var)> lookup_var_name_fn =
     [](const Variable& var) {return "";};
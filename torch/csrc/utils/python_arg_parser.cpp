@@ -531,6 +531,55 @@ PythonArgParser::PythonArgParser(std::vector<std::string> fmts, bool traceable)
   }
 }
 
+constexpr int PythonArgParser::SignatureCacheKey::max_args;
+constexpr size_t PythonArgParser::cache_size;
+
+// Properties of a tensor argument that FunctionParameter::check and
+// THPUtils_checkIndex look at
+enum TensorFlag : uint8_t {
+  kTensorArg = 1,
+  kRequiresGrad = 2,
+  kZeroDim = 4,
+  kOneElement = 8,
+  kIntegral = 16,
+};
+
+size_t PythonArgParser::SignatureCacheKey::hash() const {
+  size_t h = std::hash<ssize_t>()(nargs);
+  for (ssize_t i = 0; i < nargs; i++) {
+    h = h * 31 + std::hash<PyTypeObject*>()(types[i]);
+    h = h * 31 + tensor_flags[i];
+  }
+  return h;
+}
+
+bool PythonArgParser::make_cache_key(PyObject* args, PyObject* kwargs, SignatureCacheKey& key) {
+  if (kwargs && PyDict_Size(kwargs) > 0) {
+    return false;
+  }
+  auto nargs = PyTuple_GET_SIZE(args);
+  if (nargs > SignatureCacheKey::max_args) {
+    return false;
+  }
+  key.nargs = nargs;
+  key.types.fill(nullptr);
+  key.tensor_flags.fill(0);
+  for (ssize_t i = 0; i < nargs; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(args, i);
+    key.types[i] = Py_TYPE(obj);
+    if (THPVariable_Check(obj)) {
+      auto& var = ((THPVariable*)obj)->cdata;
+      uint8_t flags = kTensorArg;
+      if (var.requires_grad()) flags |= kRequiresGrad;
+      if (var.dim() == 0) flags |= kZeroDim;
+      if (var.numel() == 1) flags |= kOneElement;
+      if (at::isIntegralType(var.type().scalarType())) flags |= kIntegral;
+      key.tensor_flags[i] = flags;
+    }
+  }
+  return true;
+}
+
 PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
@@ -538,9 +587,32 @@ PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject
     return PythonArgs(0, traceable, signature, parsed_args);
   }
 
+  SignatureCacheKey key;
+  bool cacheable = make_cache_key(args, kwargs, key);
+  SignatureCacheEntry* entry = nullptr;
+  if (cacheable) {
+    entry = &cache_[key.hash() % cache_size];
+    if (entry->key == key) {
+      auto& signature = signatures_[entry->idx];
+      if (signature.parse(args, kwargs, parsed_args, false)) {
+        return PythonArgs(entry->idx, traceable, signature, parsed_args);
+      }
+    }
+  }
+
   int i = 0;
   for (auto& signature : signatures_) {
     if (signature.parse(args, kwargs, parsed_args, false)) {
+      if (entry) {
+        for (auto type : key.types) {
+          Py_XINCREF(type);
+        }
+        for (auto type : entry->key.types) {
+          Py_XDECREF(type);
+        }
+        entry->key = key;
+        entry->idx = i;
+      }
       return PythonArgs(i, traceable, signature, parsed_args);
     }
     i++;
@@ -61,6 +61,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -90,14 +91,42 @@ struct PythonArgParser {
   inline PythonArgs parse(PyObject* args, PyObject* kwargs, ParsedArgs<N>& dst);
 
 private:
+  // Which signature a call binds to only depends on the number of arguments,
+  // their Python types and, for tensors, on a few of their properties (see
+  // FunctionParameter::check). Calls with up to max_args positional arguments
+  // and no keyword arguments remember the signature they resolved to under
+  // that key, so that repeated calls don't try each overload in turn.
+  struct SignatureCacheKey {
+    static constexpr int max_args = 4;
+
+    ssize_t nargs = -1;
+    std::array<PyTypeObject*, max_args> types{};
+    std::array<uint8_t, max_args> tensor_flags{};
+
+    bool operator==(const SignatureCacheKey& other) const {
+      return nargs == other.nargs && types == other.types && tensor_flags == other.tensor_flags;
+    }
+    size_t hash() const;
+  };
+  struct SignatureCacheEntry {
+    // The entry holds references to the types in its key, so that their
+    // addresses can't be reused by other types
+    SignatureCacheKey key;
+    int idx = 0;
+  };
+  static constexpr size_t cache_size = 8;
+
   [[noreturn]]
   void print_error(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
   PythonArgs raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
+  static bool make_cache_key(PyObject* args, PyObject* kwargs, SignatureCacheKey& key);
 
   std::vector<FunctionSignature> signatures_;
   std::string function_name;
   ssize_t max_args;
   bool traceable;
+  // Accessed with the GIL held, like the rest of the parser
+  std::array<SignatureCacheEntry, cache_size> cache_;
 };
 
 struct PythonArgs {
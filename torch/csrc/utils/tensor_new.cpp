@@ -21,7 +21,9 @@
 #include <c10/util/Exception.h>
 #include "c10/util/Optional.h"
 
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 using at::Backend;
@@ -550,6 +552,70 @@ Tensor as_tensor(const Type& type, PyObject* args, PyObject* kwargs) {
   throw std::runtime_error("tensor(): invalid arguments");
 }
 
+Tensor tensor_frombuffer(const Type& type, PyObject* args, PyObject* kwargs) {
+  static PythonArgParser parser({
+    "frombuffer(PyObject* buffer, *, ScalarType dtype=None, int64_t count=-1, int64_t offset=0, bool requires_grad=False)",
+  });
+
+  ParsedArgs<5> parsed_args;
+  auto r = parser.parse(args, kwargs, parsed_args);
+  if (r.idx == 0) {
+    PyObject* obj = r.pyobject(0);
+    auto scalar_type = r.scalartypeWithDefault(1, type.scalarType());
+    int64_t count = r.toInt64(2);
+    int64_t offset = r.toInt64(3);
+    if (!PyObject_CheckBuffer(obj)) {
+      throw TypeError("frombuffer(): expected an object that implements the buffer protocol (got %s)",
+          Py_TYPE(obj)->tp_name);
+    }
+
+    // The view is released, and with it the reference to the exporter, when
+    // the storage of the tensor is freed
+    std::unique_ptr<Py_buffer> view(new Py_buffer());
+    if (PyObject_GetBuffer(obj, view.get(), PyBUF_SIMPLE) != 0) {
+      throw python_error();
+    }
+    auto release = [](Py_buffer* view) {
+      AutoGIL gil;
+      PyBuffer_Release(view);
+      delete view;
+    };
+    int64_t length = view->len;
+    int64_t element_size = at::elementSize(scalar_type);
+    std::string error;
+    if (length <= 0 || count == 0) {
+      error = "both the buffer length and count must be greater than 0";
+    } else if (offset < 0 || offset >= length) {
+      error = "offset must be non-negative and less than the buffer length";
+    } else if (count < 0 && (length - offset) % element_size != 0) {
+      error = "buffer length minus offset must be a multiple of the element size";
+    } else if (count > 0 && count > (length - offset) / element_size) {
+      error = "requested buffer length (count times the element size) after offset exceeds the buffer length";
+    }
+    if (!error.empty()) {
+      release(view.release());
+      throw ValueError("frombuffer(): %s (buffer length %lld, offset %lld, count %lld, element size %lld)",
+          error.c_str(), (long long)length, (long long)offset, (long long)count, (long long)element_size);
+    }
+    if (count < 0) {
+      count = (length - offset) / element_size;
+    }
+    if (view->readonly) {
+      PyErr_WarnEx(PyExc_UserWarning,
+        "The given buffer is not writable, and PyTorch does not support non-writable tensors. "
+        "Writing to the returned tensor will write to the buffer anyway.", 1);
+    }
+
+    void* data = static_cast<char*>(view->buf) + offset;
+    Py_buffer* raw_view = view.release();
+    auto tensor = at::CPU(scalar_type).tensorFromBlob(data, {count}, [raw_view, release](void*) {
+      release(raw_view);
+    });
+    return autograd::make_variable(tensor, /*requires_grad=*/r.toBool(4));
+  }
+  throw std::runtime_error("frombuffer(): invalid arguments");
+}
+
 Tensor new_tensor(const Type& type, PyObject* args, PyObject* kwargs) {
   static PythonArgParser parser({
     "new_tensor(PyObject* data, *, ScalarType dtype=None, Device? device=None, bool requires_grad=False)",
@@ -15,6 +15,7 @@ at::Tensor legacy_new_from_data(
 at::Tensor sparse_coo_tensor_ctor(const at::Type& type, PyObject* args, PyObject* kwargs);
 at::Tensor tensor_ctor(const at::Type& type, PyObject* args, PyObject* kwargs);
 at::Tensor as_tensor(const at::Type& type, PyObject* args, PyObject* kwargs);
+at::Tensor tensor_frombuffer(const at::Type& type, PyObject* args, PyObject* kwargs);
 at::Tensor new_tensor(const at::Type& type, PyObject* args, PyObject* kwargs);
 at::Tensor new_empty(const at::Type& type, PyObject* args, PyObject* kwargs);
 at::Tensor new_full(const at::Type& type, PyObject* args, PyObject* kwargs);
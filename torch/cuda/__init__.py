@@ -444,6 +444,136 @@ def max_memory_cached(device=None):
     return torch._C._cuda_maxMemoryCached(device)
 
 
+def memory_stats(device=None):
+    r"""Returns a dictionary of caching allocator statistics for a given
+    device.
+
+    Besides the byte counts reported by :meth:`~torch.cuda.memory_allocated`
+    and :meth:`~torch.cuda.memory_cached`, this includes the number of
+    ``cudaMalloc`` and ``cudaFree`` calls, cache flushes caused by failed
+    allocations, block splits and merges, and ``size_histogram``, where entry
+    ``i`` counts requests of at most ``512 * 2**i`` bytes.
+
+    Arguments:
+        device (torch.device or int, optional): selected device. Returns
+            statistics for the current device, given by :meth:`~torch.cuda.current_device`,
+            if :attr:`device` is ``None`` (default).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    device = _get_device_index(device, optional=True)
+    return torch._C._cuda_memoryStats(device)
+
+
+def memory_snapshot():
+    r"""Returns a list of all memory segments held by the caching allocator,
+    across all devices.
+
+    Each segment is a dictionary with its ``device``, private ``pool_id``
+    (0 for the shared pool), ``address``,
+    ``total_size``, ``allocated_size``, allocation ``stream`` and ``blocks``,
+    the list of blocks the segment is split into, in address order, each with
+    a ``size`` and a ``state`` of ``"allocated"``, ``"free"`` or
+    ``"pending_free"`` (freed, but still in use by a recorded stream).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    return torch._C._cuda_memorySnapshot()
+
+
+def _record_memory_trace(capacity, record_backtraces=False):
+    r"""Keeps the last :attr:`capacity` caching allocator events in a ring
+    buffer, retrieved with :meth:`~torch.cuda._memory_trace`. A capacity of 0
+    turns recording off. Recording backtraces is slow.
+    """
+    torch._C._cuda_setMemoryTraceCapacity(capacity, record_backtraces)
+
+
+def _memory_trace():
+    r"""Returns the recorded caching allocator events, oldest first."""
+    return torch._C._cuda_memoryTrace()
+
+
+def _new_memory_pool():
+    r"""Returns the id of a new private caching allocator pool. Blocks of a
+    private pool are only reused by allocations routed to that pool, on the
+    stream that allocated them.
+    """
+    _lazy_init()
+    return torch._C._cuda_newPoolId()
+
+
+def _memory_pool(pool_id):
+    r"""Context-manager that routes the allocations of the current thread to
+    the private pool :attr:`pool_id`, and restores the previous pool on exit.
+    This takes precedence over the pool of the current stream.
+    """
+    _lazy_init()
+    return torch._C._CudaPoolGuard(pool_id)
+
+
+def _set_stream_memory_pool(stream, pool_id):
+    r"""Routes the allocations on :attr:`stream` to the private pool
+    :attr:`pool_id`, or back to the shared pool if it is 0.
+    """
+    _lazy_init()
+    torch._C._cuda_setStreamPool(stream._cdata, pool_id)
+
+
+def _release_memory_pool(pool_id):
+    r"""Returns the cached, unsplit segments of a private pool to the driver."""
+    torch._C._cuda_releasePool(pool_id)
+
+
+def host_memory_stats():
+    r"""Returns a dictionary of pinned host memory allocator statistics.
+
+    ``num_hits`` and ``num_misses`` count allocations that were served from
+    the cache and that needed a fresh ``cudaHostAlloc``, respectively.
+    ``allocated_bytes`` and ``cached_bytes`` report the memory currently in
+    use and held by the allocator, and ``registered_bytes`` the memory of
+    existing buffers page-locked via :meth:`~torch.cuda.host_register`.
+    """
+    return torch._C._cuda_hostMemoryStats()
+
+
+def reserve_host_memory(size, count=1):
+    r"""Pins :attr:`count` host memory blocks large enough to hold
+    :attr:`size` bytes, so that later pinned allocations of that size are
+    served from the cache.
+
+    Pinned allocations are rounded up to one of four size classes per power
+    of two, so a reserved block is reused by any request that rounds up to the
+    same size. This releases
+    the GIL and may be called from a background thread, e.g. to warm up the
+    cache before the first :class:`~torch.utils.data.DataLoader` batch.
+    """
+    _lazy_init()
+    torch._C._cuda_reserveHostMemory(size, count)
+
+
+def host_register(tensor):
+    r"""Page-locks the memory of an existing CPU tensor in place, so that it
+    can be used for asynchronous copies without staging.
+
+    The tensor must be contiguous, and :meth:`~torch.cuda.host_unregister`
+    must be called before its storage is freed.
+    """
+    _lazy_init()
+    if tensor.is_cuda or not tensor.is_contiguous():
+        raise ValueError("host_register expects a contiguous CPU tensor")
+    torch._C._cuda_hostRegister(tensor.data_ptr(), tensor.numel() * tensor.element_size())
+
+
+def host_unregister(tensor):
+    r"""Undoes :meth:`~torch.cuda.host_register`."""
+    torch._C._cuda_hostUnregister(tensor.data_ptr())
+
+
 def _host_allocator():
     _lazy_init()
     return torch._C._cuda_cudaHostAllocator()
@@ -54,33 +54,7 @@ def reduce_add(inputs, destination=None):
         A tensor containing an elementwise sum of all inputs, placed on the
         ``destination`` device.
     """
-    # TODO: try to find an input on another gpu, copy it,
-    # and accumulate into the copy
-    if destination is None:
-        destination = torch.cuda.current_device()
-    input_size = inputs[0].size()
-    nccl_root = None
-    for i, inp in enumerate(inputs):
-        assert inp.is_cuda, "reduce_add expects all inputs to be on GPUs"
-        if inp.get_device() == destination:
-            nccl_root = i
-        if inp.size() != input_size:
-            got = 'x'.join(str(x) for x in inp.size())
-            expected = 'x'.join(str(x) for x in input_size)
-            raise ValueError("input {} has invalid size: got {}, but expected "
-                             "{}".format(i, got, expected))
-    if nccl_root is None:
-        raise RuntimeError("reduce_add expects destination to be on the same GPU with one of the tensors")
-    result = inp.new(device=destination).resize_as_(inp).zero_()
-
-    if nccl.is_available(inputs) and inputs[0].get_device() == destination:
-        outputs = [result] + [t.new(t.size()) for t in inputs[1:]]
-        nccl.reduce(inputs, outputs, root=nccl_root)
-        return result
-    for inp in inputs:
-        input_correct_gpu = inp.cuda(result.get_device())
-        result.add_(input_correct_gpu)
-    return result
+    return torch._C._reduce_add(inputs, destination)
 
 
 def reduce_add_coalesced(inputs, destination=None, buffer_size=10485760):
@@ -100,32 +74,7 @@ def reduce_add_coalesced(inputs, destination=None, buffer_size=10485760):
         A tuple of tensors containing an elementwise sum of each group of
         inputs, placed on the ``destination`` device.
     """
-    # TODO: When `len(inputs) == 1` and all inputs are on `destination`, just
-    #       return `inputs`.
-    dense_tensors = [[] for _ in inputs]  # shape (num_gpus, num_tensors)
-    output = []
-    ref_order = []
-    # process sparse ones first since they may have different sizes on different gpus
-    for tensor_at_gpus in zip(*inputs):
-        if all(t.is_sparse for t in tensor_at_gpus):
-            result = reduce_add(tensor_at_gpus, destination)
-            output.append(result)
-            ref_order.append(tensor_at_gpus[0])
-        else:
-            for coll, t in zip(dense_tensors, tensor_at_gpus):
-                coll.append(t.to_dense() if t.is_sparse else t)
-            ref_order.append(dense_tensors[0][-1])
-    itrs = [_take_tensors(tensors, buffer_size) for tensors in dense_tensors]
-    # now the dense ones, which have consistent sizes
-    for chunks in zip(*itrs):
-        flat_tensors = [_flatten_dense_tensors(chunk) for chunk in chunks]
-        flat_result = reduce_add(flat_tensors, destination)
-        for t in _unflatten_dense_tensors(flat_result, chunks[0]):
-            # The unflattened tensors do not share storage, and we don't expose
-            # base flat tensor anyways, so give them different version counters.
-            # See NOTE [ Version Counter in comm.*_coalesced ]
-            output.append(t.data)
-    return tuple(_reorder_tensors_as(output, ref_order))
+    return tuple(torch._C._reduce_add_coalesced(inputs, destination, buffer_size))
 
 
 def scatter(tensor, devices, chunk_sizes=None, dim=0, streams=None):
@@ -5,7 +5,7 @@ from datetime import timedelta
 
 from .rendezvous import rendezvous, register_rendezvous_handler
 from . import BroadcastOptions, AllreduceOptions, ReduceOptions, \
-    ScatterOptions, GatherOptions
+    ScatterOptions, GatherOptions, ReduceScatterOptions
 from . import ReduceOp
 from . import PrefixStore
 from . import ProcessGroupGloo
@@ -1131,6 +1131,103 @@ def scatter(tensor,
         work.wait()
 
 
+def reduce_scatter(output,
+                   input_list,
+                   op=ReduceOp.SUM,
+                   group=group.WORLD,
+                   async_op=False):
+    """
+    Reduces, then scatters a list of tensors to all processes in a group.
+
+    Process ``i`` receives the reduction of ``input_list[i]`` over all
+    processes, e.g. to update only its own shard of the optimizer state.
+
+    Arguments:
+        output (Tensor): Output tensor.
+        input_list (list[Tensor]): List of tensors to reduce and scatter, one
+            per process in the group, of the same size as ``output``.
+        op (optional): One of the values from
+            ``torch.distributed.ReduceOp``
+            enum.  Specifies an operation used for element-wise reductions.
+        group (ProcessGroup, optional): The process group to work on
+        async_op (bool, optional): Whether this op should be an async op
+
+    Returns:
+        Async work handle, if async_op is set to True.
+        None, if not async_op or if not part of the group
+
+    """
+    _check_single_tensor(output, "output")
+    _check_tensor_list(input_list, "input_list")
+    if _rank_not_in_group(group):
+        return
+
+    opts = ReduceScatterOptions()
+    opts.reduceOp = op
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        work = _default_pg.reduce_scatter([output], [input_list], opts)
+    else:
+        work = group.reduce_scatter([output], [input_list], opts)
+
+    if async_op:
+        return work
+    else:
+        work.wait()
+
+
+def all_to_all(output,
+               input,
+               output_split_sizes=None,
+               input_split_sizes=None,
+               group=group.WORLD,
+               async_op=False):
+    """
+    Splits the input tensor along its first dimension, scatters the slices
+    to all processes in a group, and concatenates the slices received from
+    all of them, in rank order, into the output tensor.
+
+    Arguments:
+        output (Tensor): Output tensor.
+        input (Tensor): Input tensor to scatter.
+        output_split_sizes (list[int], optional): Sizes of the slices
+            received from every process, along the first dimension of
+            ``output``. When not given, ``output`` is split evenly.
+        input_split_sizes (list[int], optional): Sizes of the slices sent to
+            every process, along the first dimension of ``input``. When not
+            given, ``input`` is split evenly.
+        group (ProcessGroup, optional): The process group to work on
+        async_op (bool, optional): Whether this op should be an async op
+
+    Returns:
+        Async work handle, if async_op is set to True.
+        None, if not async_op or if not part of the group
+
+    """
+    _check_single_tensor(output, "output")
+    _check_single_tensor(input, "input")
+    if _rank_not_in_group(group):
+        return
+
+    output_split_sizes = [] if output_split_sizes is None \
+        else output_split_sizes
+    input_split_sizes = [] if input_split_sizes is None else input_split_sizes
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        work = _default_pg.alltoall(
+            output, input, output_split_sizes, input_split_sizes)
+    else:
+        work = group.alltoall(
+            output, input, output_split_sizes, input_split_sizes)
+
+    if async_op:
+        return work
+    else:
+        work.wait()
+
+
 def barrier(group=group.WORLD,
             async_op=False):
     """
@@ -0,0 +1,359 @@
+r"""
+A parameter server for embedding tables too large to be replicated on every
+process, built on the point-to-point operations of a process group
+(``send``, ``recv`` and ``recv_anysource``, so a Gloo or MPI group).
+
+The rows of every table are partitioned across the server ranks, row ``i``
+on server ``i % len(servers)``. The server ranks run
+:meth:`EmbeddingServer.serve`, which answers the lookups of the trainers and
+applies the gradients they push, until every trainer has shut its client
+down. The trainers use an :class:`EmbeddingClient`, whose lookups and
+gradient pushes return futures. The requests a client queues while it is
+busy are coalesced: a lookup or a push of the same row by several requests
+makes for a single row on the wire, and each server gets one message per
+table. :class:`ShardedEmbeddingBag` is a drop-in for
+:class:`~torch.nn.EmbeddingBag` whose weight lives on the servers.
+
+Example::
+
+    >>> # ranks 0 and 1 serve a 10M x 64 table to ranks 2 and 3
+    >>> tables = [(10000000, 64)]
+    >>> pg = torch.distributed.get_default_group()
+    >>> if rank < 2:
+    >>>     EmbeddingServer(tables, [0, 1], [2, 3], pg, lr=0.1).serve()
+    >>> else:
+    >>>     client = EmbeddingClient(tables, [0, 1], pg)
+    >>>     bag = ShardedEmbeddingBag(client, 0, mode='sum')
+    >>>     ...
+    >>>     loss(bag(input, offsets)).backward()  # pushes the gradients
+    >>>     ...
+    >>>     client.shutdown()
+"""
+
+import threading
+
+import torch
+import torch.nn.functional as F
+from torch.nn.modules.module import Module
+
+
+_LOOKUP = 0
+_PUSH = 1
+_SHUTDOWN = 2
+
+# Tags of the messages of the service, to tell them apart from the other
+# point-to-point messages of the process group
+_HEADER_TAG = 0x451
+_PAYLOAD_TAG = 0x452
+_RESPONSE_TAG = 0x453
+
+
+def _shard_rows(num_embeddings, shard, num_shards):
+    return (num_embeddings - shard + num_shards - 1) // num_shards
+
+
+def _check_tables(tables):
+    for num_embeddings, embedding_dim in tables:
+        if num_embeddings <= 0 or embedding_dim <= 0:
+            raise ValueError("invalid table size ({}, {})".format(
+                num_embeddings, embedding_dim))
+
+
+class EmbeddingServer(object):
+    r"""Holds this rank's shard of every table, and serves it.
+
+    Arguments:
+        tables (list of (int, int)): ``(num_embeddings, embedding_dim)`` of
+            each table, the same on all ranks.
+        servers (list of int): the ranks of ``process_group`` that hold the
+            tables, including this one.
+        clients (list of int): the ranks of ``process_group`` that run an
+            :class:`EmbeddingClient`.
+        process_group: the process group to communicate over.
+        lr (float, optional): the learning rate the gradients pushed are
+            applied with (plain SGD). Default: ``0.01``.
+        dtype (torch.dtype, optional): the type of the tables.
+            Default: ``torch.float``.
+
+    The rows are initialized from :math:`\mathcal{N}(0, 1)`, like
+    :class:`~torch.nn.EmbeddingBag`; :attr:`weights` holds the shards, to
+    load them from a checkpoint instead.
+    """
+
+    def __init__(self, tables, servers, clients, process_group,
+                 lr=0.01, dtype=torch.float):
+        _check_tables(tables)
+        rank = process_group.rank()
+        if rank not in servers:
+            raise ValueError("rank {} is not a server".format(rank))
+        self.tables = list(tables)
+        self.clients = list(clients)
+        self.process_group = process_group
+        self.lr = lr
+        shard = servers.index(rank)
+        self.weights = [
+            torch.randn(_shard_rows(num_embeddings, shard, len(servers)),
+                        embedding_dim, dtype=dtype)
+            for num_embeddings, embedding_dim in self.tables
+        ]
+
+    def _recv(self, tensor, src):
+        self.process_group.recv([tensor], src, _PAYLOAD_TAG).wait()
+        return tensor
+
+    def serve(self):
+        r"""Answers requests until all the clients have shut down."""
+        pg = self.process_group
+        clients = set(self.clients)
+        header = torch.zeros(3, dtype=torch.long)
+        src_tensor = torch.zeros(1, dtype=torch.int)
+        while clients:
+            pg.recv_anysource([header], src_tensor, _HEADER_TAG).wait()
+            src = src_tensor.item()
+            op, table, n = header.tolist()
+            if op == _SHUTDOWN:
+                clients.discard(src)
+                continue
+            weight = self.weights[table]
+            indices = self._recv(torch.empty(n, dtype=torch.long), src)
+            if op == _LOOKUP:
+                pg.send([weight.index_select(0, indices)], src,
+                        _RESPONSE_TAG).wait()
+            elif op == _PUSH:
+                grad = self._recv(weight.new_empty(n, weight.size(1)), src)
+                weight.index_add_(0, indices, grad.mul_(-self.lr))
+            else:
+                raise RuntimeError("invalid request {} from rank {}".format(
+                    op, src))
+
+
+class _Future(object):
+    def __init__(self):
+        self._event = threading.Event()
+        self._value = None
+        self._exception = None
+
+    def _set(self, value=None, exception=None):
+        self._value = value
+        self._exception = exception
+        self._event.set()
+
+    def is_completed(self):
+        return self._event.is_set()
+
+    def wait(self):
+        self._event.wait()
+        if self._exception is not None:
+            raise self._exception
+        return self._value
+
+
+class EmbeddingClient(object):
+    r"""Looks up rows of the tables of the :class:`EmbeddingServer` ranks,
+    and pushes gradients to them, from a thread of its own.
+
+    Arguments:
+        tables (list of (int, int)): the tables, as for the servers.
+        servers (list of int): the ranks of ``process_group`` that hold the
+            tables, in the same order as for the servers.
+        process_group: the process group to communicate over.
+        dtype (torch.dtype, optional): the type of the tables, as for the
+            servers. Default: ``torch.float``.
+
+    The requests are sent in turn, a batch of all those queued at a time;
+    the gradients of a batch are applied before its lookups are answered,
+    so a lookup sees at least the gradients pushed before it.
+    """
+
+    def __init__(self, tables, servers, process_group, dtype=torch.float):
+        _check_tables(tables)
+        self.tables = list(tables)
+        self.dtype = dtype
+        self.servers = list(servers)
+        self.process_group = process_group
+        self._queue = []
+        self._stopping = False
+        self._cv = threading.Condition()
+        self._thread = threading.Thread(target=self._run)
+        self._thread.daemon = True
+        self._thread.start()
+
+    def _check(self, table, indices):
+        if self._stopping:
+            raise RuntimeError("the client is shut down")
+        if indices.dim() != 1 or indices.dtype != torch.long:
+            raise ValueError("indices must be a 1-D LongTensor")
+        num_embeddings = self.tables[table][0]
+        if indices.numel() > 0 and (indices.min().item() < 0 or
+                                    indices.max().item() >= num_embeddings):
+            raise ValueError("index out of range of table {}".format(table))
+
+    def _enqueue(self, request):
+        future = _Future()
+        with self._cv:
+            self._queue.append(request + (future,))
+            self._cv.notify()
+        return future
+
+    def lookup_async(self, table, indices):
+        r"""Returns a future of the rows ``indices`` (a 1-D LongTensor) of
+        ``table``, as an ``(len(indices), embedding_dim)`` CPU tensor."""
+        self._check(table, indices)
+        return self._enqueue((_LOOKUP, table, indices.cpu()))
+
+    def push_gradients_async(self, table, indices, grad):
+        r"""Pushes the gradient ``grad`` of the rows ``indices`` of ``table``,
+        one row of ``grad`` per index, to be applied by the servers. Returns
+        a future completed once they are sent."""
+        self._check(table, indices)
+        if grad.size() != (indices.numel(), self.tables[table][1]):
+            raise ValueError("invalid gradient size {}".format(
+                tuple(grad.size())))
+        grad = grad.detach().to('cpu', self.dtype)
+        return self._enqueue((_PUSH, table, indices.cpu(), grad))
+
+    def shutdown(self):
+        r"""Sends the requests left, and tells the servers this client is
+        done. The servers return from :meth:`~EmbeddingServer.serve` once
+        all clients have shut down."""
+        with self._cv:
+            if self._stopping:
+                return
+            self._stopping = True
+            self._cv.notify()
+        self._thread.join()
+        header = torch.tensor([_SHUTDOWN, 0, 0])
+        for server in self.servers:
+            self.process_group.send([header], server, _HEADER_TAG).wait()
+
+    def _run(self):
+        while True:
+            with self._cv:
+                while not self._queue and not self._stopping:
+                    self._cv.wait()
+                batch, self._queue = self._queue, []
+            if not batch:
+                return
+            try:
+                self._process(batch)
+            except Exception as e:
+                for request in batch:
+                    if not request[-1].is_completed():
+                        request[-1]._set(exception=e)
+
+    # Sends a request for each server that holds some of the rows
+    # ``indices``, and returns the positions, in ``indices``, of the rows of
+    # each of those servers
+    def _send(self, works, op, table, indices, grad=None):
+        pg = self.process_group
+        num_servers = len(self.servers)
+        shards = indices % num_servers
+        positions = []
+        for shard, server in enumerate(self.servers):
+            position = (shards == shard).nonzero().view(-1)
+            if position.numel() == 0:
+                positions.append(None)
+                continue
+            positions.append(position)
+            local = indices.index_select(0, position) // num_servers
+            tensors = [(torch.tensor([op, table, local.numel()]), _HEADER_TAG),
+                       (local, _PAYLOAD_TAG)]
+            if grad is not None:
+                tensors.append((grad.index_select(0, position), _PAYLOAD_TAG))
+            # The works don't keep their tensors alive
+            for tensor, tag in tensors:
+                works.append((pg.send([tensor], server, tag), tensor))
+        return positions
+
+    def _process(self, batch):
+        pg = self.process_group
+        works = []
+
+        pushes = {}
+        lookups = {}
+        for request in batch:
+            group = pushes if request[0] == _PUSH else lookups
+            group.setdefault(request[1], []).append(request)
+
+        for table, requests in sorted(pushes.items()):
+            indices = torch.cat([r[2] for r in requests])
+            grad = torch.cat([r[3] for r in requests])
+            unique, inverse = torch.unique(indices, return_inverse=True)
+            summed = grad.new_zeros(unique.numel(), grad.size(1))
+            summed.index_add_(0, inverse, grad)
+            self._send(works, _PUSH, table, unique, summed)
+
+        responses = []
+        for table, requests in sorted(lookups.items()):
+            indices = torch.cat([r[2] for r in requests])
+            unique, inverse = torch.unique(indices, return_inverse=True)
+            positions = self._send(works, _LOOKUP, table, unique)
+            responses.append((table, requests, unique, inverse, positions))
+
+        # The servers answer a client in the order of its requests
+        for table, requests, unique, inverse, positions in responses:
+            rows = torch.empty(unique.numel(), self.tables[table][1],
+                               dtype=self.dtype)
+            for server, position in zip(self.servers, positions):
+                if position is None:
+                    continue
+                shard_rows = rows.new_empty(position.numel(), rows.size(1))
+                pg.recv([shard_rows], server, _RESPONSE_TAG).wait()
+                rows.index_copy_(0, position, shard_rows)
+            rows = rows.index_select(0, inverse)
+            start = 0
+            for request in requests:
+                n = request[2].numel()
+                request[-1]._set(rows.narrow(0, start, n))
+                start += n
+
+        for work, _ in works:
+            work.wait()
+        for request in batch:
+            if not request[-1].is_completed():
+                request[-1]._set()
+
+
+class ShardedEmbeddingBag(Module):
+    r"""Computes sums or means of 'bags' of embeddings, like
+    :class:`~torch.nn.EmbeddingBag`, from a table of the embedding
+    servers of ``client``.
+
+    The forward looks up the rows of its input, and the backward pushes
+    their gradients to the servers, asynchronously, which apply them. The
+    module itself has no parameter.
+
+    Arguments:
+        client (EmbeddingClient): the client to look rows up with.
+        table (int): the index of the table in the tables of ``client``.
+        mode (string, optional): ``'sum'``, ``'mean'`` or ``'max'``, as for
+            :class:`~torch.nn.EmbeddingBag`. Default: ``'mean'``.
+
+    Inputs: ``input``, ``offsets``, as for :class:`~torch.nn.EmbeddingBag`.
+    The output is on the device of ``input``.
+    """
+
+    def __init__(self, client, table, mode='mean'):
+        super(ShardedEmbeddingBag, self).__init__()
+        self.client = client
+        self.table = table
+        self.num_embeddings, self.embedding_dim = client.tables[table]
+        self.mode = mode
+
+    def forward(self, input, offsets=None):
+        unique, inverse = torch.unique(input, return_inverse=True)
+        indices = unique.cpu()
+        weight = self.client.lookup_async(self.table, indices).wait()
+        weight = weight.to(input.device)
+        if self.training and torch.is_grad_enabled():
+            weight.requires_grad_()
+
+            def push(grad):
+                self.client.push_gradients_async(self.table, indices, grad)
+            weight.register_hook(push)
+        return F.embedding_bag(inverse, weight, offsets, mode=self.mode)
+
+    def extra_repr(self):
+        return '{}, {}, table={}, mode={}'.format(
+            self.num_embeddings, self.embedding_dim, self.table,
+            repr(self.mode))
@@ -25,6 +25,7 @@ __all__ = [
     'stft',
     'tensordot',
     'unique',
+    'unique_consecutive',
 ]
 
 
@@ -439,27 +440,35 @@ def isnan(tensor):
     return tensor != tensor
 
 
-def unique(input, sorted=False, return_inverse=False, dim=None):
+def unique(input, sorted=False, return_inverse=False, return_counts=False, dim=None):
     r"""Returns the unique scalar elements of the input tensor as a 1-D tensor.
 
     Arguments:
         input (Tensor): the input tensor
         sorted (bool): Whether to sort the unique elements in ascending order
-            before returning as output.
+            before returning as output. On CUDA, the unique elements are
+            otherwise found with a hash table, and their order is unspecified.
         return_inverse (bool): Whether to also return the indices for where
             elements in the original input ended up in the returned unique list.
+        return_counts (bool): Whether to also return the counts for each unique
+            element.
         dim (int): the dimension to apply unique. If ``None``, the unique of the
             flattened input is returned. default: ``None``
 
     Returns:
-        (Tensor, Tensor (optional)): A tensor or a tuple of tensors containing
+        (Tensor, Tensor (optional), Tensor (optional)): A tensor or a tuple of tensors containing
 
             - **output** (*Tensor*): the output list of unique scalar elements.
             - **inverse_indices** (*Tensor*): (optional) if
-              :attr:`return_inverse` is True, there will be a
-              2nd returned tensor (same shape as input) representing the indices
+              :attr:`return_inverse` is True, there will be an additional
+              returned tensor (same shape as input) representing the indices
               for where elements in the original input map to in the output;
               otherwise, this function will only return a single tensor.
+            - **counts** (*Tensor*): (optional) if
+              :attr:`return_counts` is True, there will be an additional
+              returned tensor (same shape as output or output.size(dim),
+              if dim was specified) representing the number of occurrences
+              for each unique value or tensor.
 
     Example::
 
@@ -482,22 +491,97 @@ def unique(input, sorted=False, return_inverse=False, dim=None):
         tensor([[ 0,  2],
                 [ 1,  2]])
 
+        >>> output, counts = torch.unique(
+                torch.tensor([1, 3, 2, 3], dtype=torch.long), sorted=True, return_counts=True)
+        >>> counts
+        tensor([ 1,  1,  2])
+
     """
     if dim is not None:
         output, inverse_indices = torch._unique_dim(
             input,
             dim,
             sorted=sorted,
-            return_inverse=return_inverse
+            return_inverse=return_inverse or return_counts
         )
+        if return_counts:
+            counts = inverse_indices.new_zeros(output.size(dim))
+            counts.scatter_add_(0, inverse_indices, torch.ones_like(inverse_indices))
     else:
-        output, inverse_indices = torch._unique(
+        output, inverse_indices, counts = torch._unique2(
             input,
             sorted=sorted,
             return_inverse=return_inverse,
+            return_counts=return_counts,
         )
-    if return_inverse:
+    return _unique_outputs(output, inverse_indices, counts, return_inverse, return_counts)
+
+
+def unique_consecutive(input, return_inverse=False, return_counts=False, dim=None):
+    r"""Eliminates all but the first element from every consecutive group of
+    equivalent elements.
+
+    .. note:: This function is different from :func:`torch.unique` in the sense
+        that it only eliminates consecutive duplicate values, like
+        ``std::unique`` in C++; with a sorted input, the results are the
+        same as those of :func:`torch.unique` with ``sorted=True``.
+
+    Arguments:
+        input (Tensor): the input tensor
+        return_inverse (bool): Whether to also return the indices for where
+            elements in the original input ended up in the returned unique list.
+        return_counts (bool): Whether to also return the counts for each unique
+            element.
+        dim (int): the dimension to apply unique. If ``None``, the unique of the
+            flattened input is returned. default: ``None``
+
+    Returns:
+        (Tensor, Tensor (optional), Tensor (optional)): A tensor or a tuple of tensors containing
+
+            - **output** (*Tensor*): the output list of unique scalar elements.
+            - **inverse_indices** (*Tensor*): (optional) if
+              :attr:`return_inverse` is True, there will be an additional
+              returned tensor (same shape as input, or of the size of
+              dimension dim if it was specified) representing the indices
+              for where elements in the original input map to in the output.
+            - **counts** (*Tensor*): (optional) if
+              :attr:`return_counts` is True, there will be an additional
+              returned tensor (same shape as output or output.size(dim),
+              if dim was specified) representing the number of occurrences
+              for each unique value or tensor.
+
+    Example::
+
+        >>> x = torch.tensor([1, 1, 2, 2, 3, 1, 1, 2])
+        >>> output = torch.unique_consecutive(x)
+        >>> output
+        tensor([1, 2, 3, 1, 2])
+
+        >>> output, inverse_indices = torch.unique_consecutive(x, return_inverse=True)
+        >>> inverse_indices
+        tensor([0, 0, 1, 1, 2, 3, 3, 4])
+
+        >>> output, counts = torch.unique_consecutive(x, return_counts=True)
+        >>> counts
+        tensor([2, 2, 1, 2, 1])
+
+    """
+    if dim is not None:
+        output, inverse_indices, counts = torch._unique_dim_consecutive(
+            input, dim, return_inverse=return_inverse, return_counts=return_counts)
+    else:
+        output, inverse_indices, counts = torch._unique_consecutive(
+            input, return_inverse=return_inverse, return_counts=return_counts)
+    return _unique_outputs(output, inverse_indices, counts, return_inverse, return_counts)
+
+
+def _unique_outputs(output, inverse_indices, counts, return_inverse, return_counts):
+    if return_inverse and return_counts:
+        return output, inverse_indices, counts
+    elif return_inverse:
         return output, inverse_indices
+    elif return_counts:
+        return output, counts
     else:
         return output
 
@@ -53,8 +53,11 @@ _jit_script_compile = torch._C._jit_script_compile
 BatchTensor = torch._C._jit.BatchTensor
 
 Future = torch._C.Future
-_fork = torch._C.fork
-_wait = torch._C.wait
+fork = torch._C.fork
+wait = torch._C.wait
+# the names script code used before fork and wait were public
+_fork = fork
+_wait = wait
 
 
 @contextlib.contextmanager
@@ -395,13 +398,14 @@ class TracingCheckError(Exception):
 
 # Check the traced module against a set of user-provided validation inputs
 @torch.no_grad()
-def _check_trace(check_inputs, func, executor_options, module, check_tolerance):
+def _check_trace(check_inputs, func, executor_options, module, check_tolerance, replay_modules=None):
     # Note: tracing is independent of optimizations, which consume the trace
     executor_options['optimize'] = False
     for inputs in check_inputs:
         if isinstance(inputs, torch.Tensor):
             inputs = (inputs,)
-        check_mod = torch.jit.trace(func, _clone_inputs(inputs), check_trace=False, **executor_options)
+        check_mod = torch.jit.trace(func, _clone_inputs(inputs), check_trace=False,
+                                    replay_modules=replay_modules, **executor_options)
 
         def graph_diagnostic_info():
             mod_canonicalized = torch._C._jit_pass_canonicalize(module.graph)
@@ -526,7 +530,8 @@ TracerWarning.ignore_lib_warnings()
 torch._C._tracer_warn_use_python()
 
 
-def trace(func, example_inputs, optimize=True, check_trace=True, check_inputs=None, check_tolerance=1e-5):
+def trace(func, example_inputs, optimize=True, check_trace=True, check_inputs=None, check_tolerance=1e-5,
+          replay_modules=None):
     """
     Trace a function and return an executable trace that will be optimized
     using just-in-time compilation.
@@ -571,6 +576,14 @@ def trace(func, example_inputs, optimize=True, check_trace=True, check_inputs=No
         check_tolerance (float, optional): Floating-point comparison tolerance to use in the checker procedure.
                                            This can be used to relax the checker strictness in the event that
                                            results diverge numerically for a known reason, such as operator fusion.
+        replay_modules (tuple of types, optional): Types of ``torch.nn.Module``, the instances of which
+                                                   compute the same function of their inputs, parameters
+                                                   and buffers. The calls of such modules with tensors only
+                                                   are traced once for every type, training mode, and
+                                                   shapes, types and devices of their inputs, parameters and
+                                                   buffers. The later calls run untraced, and copies of the
+                                                   nodes of the first are added to the trace, which is much
+                                                   faster for models repeating a layer many times. Default: ``None``
 
     Returns:
         A ``ScriptModule`` object with a single ``forward()`` method containing the traced code.
@@ -594,14 +607,24 @@ def trace(func, example_inputs, optimize=True, check_trace=True, check_inputs=No
         example_inputs = tuple(example_inputs)
     module = TopLevelTracedModule(func, **executor_options)
     var_lookup_fn = _create_interpreter_name_lookup_fn(0)
-    module._create_method_from_trace('forward', func, example_inputs, var_lookup_fn)
+    traced_func = func
+    if replay_modules:
+        replay_types = tuple(replay_modules)
+
+        def traced_func(*args):
+            # The attributes of the tracing state only live as long as a
+            # reference to it
+            tracing_state = torch._C._get_tracing_state()
+            tracing_state._replay_module_types = replay_types
+            return func(*args)
+    module._create_method_from_trace('forward', traced_func, example_inputs, var_lookup_fn)
 
     # Check the trace against new traces created from user-specified inputs
     if check_trace:
         if check_inputs is not None:
-            _check_trace(check_inputs, func, executor_options, module, check_tolerance)
+            _check_trace(check_inputs, func, executor_options, module, check_tolerance, replay_modules)
         else:
-            _check_trace([example_inputs], func, executor_options, module, check_tolerance)
+            _check_trace([example_inputs], func, executor_options, module, check_tolerance, replay_modules)
 
     return module
 
@@ -1090,6 +1113,36 @@ if _enabled:
             rcb = createResolutionCallback(frames_up=1)
             self._define(lang, rcb, True)
 
+        def freeze(self, prepack_linear_weights=False, fp16=False):
+            r"""
+            Optimizes the methods of this module and of its submodules for
+            inference, by turning the parameters and buffers they use into
+            constants. Whatever is computed from them alone is then computed
+            once, e.g. transposed weights, and eval mode batch norms are folded
+            into the convolutions before them.
+
+            The methods keep the current values of the parameters, which
+            shouldn't be modified afterwards.
+
+            Arguments:
+                prepack_linear_weights (bool): also lay out the CPU float
+                    weights of the linear layers for the GEMM once and for
+                    all (see ``torch.linear_prepack``), instead of on each
+                    call. The module can't be saved afterwards.
+                fp16 (bool): with ``prepack_linear_weights``, store the
+                    prepacked weights in fp16, while computing in fp32.
+            """
+            self._freeze_for_inference(prepack_linear_weights, fp16)
+
+        def define_methods(self, num_threads=1):
+            r"""
+            Compiles the methods of this module and of its submodules that are
+            not compiled yet, with up to ``num_threads`` threads. The methods
+            imported from TorchScript source are otherwise compiled when they
+            are first used.
+            """
+            self._define_methods(num_threads)
+
     class WeakScriptModuleProxy(ScriptModule):
         def __init__(self, original, stubs):
             # Guards behavior of __setattr__ and __getattr__ so ScriptModule
@@ -1,9 +1,22 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #include <nccl.h>
 
+// ncclCommAbort() and ncclCommGetAsyncError() are only in NCCL 2.4 and later
+#if defined(NCCL_MAJOR) && \
+    ((NCCL_MAJOR > 2) || (NCCL_MAJOR == 2 && NCCL_MINOR >= 4))
+#define ENABLE_NCCL_ERROR_CHECKING
+#endif
+
+// ncclSend() and ncclRecv() are only in NCCL 2.7 and later
+#if defined(NCCL_MAJOR) && \
+    ((NCCL_MAJOR > 2) || (NCCL_MAJOR == 2 && NCCL_MINOR >= 7))
+#define ENABLE_NCCL_P2P_SUPPORT
+#endif
+
 #define C10D_NCCL_CHECK(cmd)                                              \
   do {                                                                    \
     ncclResult_t error = cmd;                                             \
@@ -25,7 +38,8 @@ class NCCLComm {
   NCCLComm() : NCCLComm(nullptr) {}
 
   ~NCCLComm() noexcept(false) {
-    if (ncclComm_) {
+    // Aborting already released the resources of the communicator
+    if (ncclComm_ && !aborted_) {
       C10D_NCCL_CHECK(ncclCommDestroy(ncclComm_));
     }
   }
@@ -47,10 +61,12 @@ class NCCLComm {
   // Move constructable
   NCCLComm(NCCLComm&& other) {
     std::swap(ncclComm_, other.ncclComm_);
+    std::swap(aborted_, other.aborted_);
   }
   // Move assignable
   NCCLComm& operator=(NCCLComm&& other) {
     std::swap(ncclComm_, other.ncclComm_);
+    std::swap(aborted_, other.aborted_);
     return *this;
   }
 
@@ -58,8 +74,41 @@ class NCCLComm {
     return ncclComm_;
   }
 
+  // Aborts the communicator, which makes the NCCL kernels that are stuck on
+  // it exit. The communicator must not be used anymore afterwards. Can be
+  // called from any thread, and is a nop if NCCL doesn't support it.
+  void ncclCommAbort() {
+    std::lock_guard<std::mutex> lock(mutex_);
+#ifdef ENABLE_NCCL_ERROR_CHECKING
+    if (ncclComm_ && !aborted_) {
+      C10D_NCCL_CHECK(::ncclCommAbort(ncclComm_));
+    }
+#endif
+    aborted_ = true;
+  }
+
+  bool isAborted() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aborted_;
+  }
+
+  // Returns the error that asynchronously failed the communicator, if any
+  ncclResult_t checkForNcclError() {
+    std::lock_guard<std::mutex> lock(mutex_);
+#ifdef ENABLE_NCCL_ERROR_CHECKING
+    if (ncclComm_ && !aborted_) {
+      ncclResult_t ncclAsyncErr;
+      C10D_NCCL_CHECK(ncclCommGetAsyncError(ncclComm_, &ncclAsyncErr));
+      return ncclAsyncErr;
+    }
+#endif
+    return ncclSuccess;
+  }
+
  protected:
-  ncclComm_t ncclComm_;
+  ncclComm_t ncclComm_ = nullptr;
+  bool aborted_ = false;
+  mutable std::mutex mutex_;
 };
 
 } // namespace c10d
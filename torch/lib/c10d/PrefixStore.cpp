@@ -33,6 +33,24 @@ int64_t PrefixStore::add(const std::string& key, int64_t value) {
   return store_.add(joinKey(key), value);
 }
 
+void PrefixStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  store_.multiSet(joinKeys(keys), values);
+}
+
+std::vector<std::vector<uint8_t>> PrefixStore::multiGet(
+    const std::vector<std::string>& keys) {
+  return store_.multiGet(joinKeys(keys));
+}
+
+std::vector<uint8_t> PrefixStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  return store_.compareSet(joinKey(key), expectedValue, desiredValue);
+}
+
 bool PrefixStore::check(const std::vector<std::string>& keys) {
   auto joinedKeys = joinKeys(keys);
   return store_.check(joinedKeys);
@@ -1,11 +1,180 @@
 #include "ProcessGroup.hpp"
 
+#include <stdexcept>
+
 namespace c10d {
 
+namespace {
+
+// Work of a collective that was split into one collective per bucket.
+class CoalescedWork : public ProcessGroup::Work {
+ public:
+  CoalescedWork(
+      std::vector<std::shared_ptr<ProcessGroup::Work>> work,
+      std::vector<std::vector<at::Tensor>> buffers)
+      : work_(std::move(work)), buffers_(std::move(buffers)) {}
+
+  bool isCompleted() override {
+    for (auto& work : work_) {
+      if (!work->isCompleted()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool isSuccess() const override {
+    for (const auto& work : work_) {
+      if (!work->isSuccess()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void synchronize() override {
+    for (auto& work : work_) {
+      work->synchronize();
+    }
+  }
+
+  bool wait() override {
+    // Waits for all buckets, even if one of them failed, because the flat
+    // buffers must stay alive until they're done.
+    bool success = true;
+    for (auto& work : work_) {
+      success = work->wait() && success;
+    }
+    return success;
+  }
+
+  const std::exception& exception() const override {
+    for (const auto& work : work_) {
+      if (!work->isSuccess()) {
+        return work->exception();
+      }
+    }
+    throw std::runtime_error("no exception");
+  }
+
+ protected:
+  std::vector<std::shared_ptr<ProcessGroup::Work>> work_;
+  // The flat tensors the work items refer to
+  std::vector<std::vector<at::Tensor>> buffers_;
+};
+
+// Groups consecutive tensors of the same type in buckets of at most
+// bucketSize bytes. Tensors larger than that get their own bucket.
+std::vector<std::vector<at::Tensor>> coalesceTensors(
+    const std::vector<at::Tensor>& tensors,
+    int64_t bucketSize) {
+  std::vector<std::vector<at::Tensor>> buckets;
+  int64_t currentSize = 0;
+  for (const auto& tensor : tensors) {
+    const int64_t size = tensor.numel() * tensor.type().elementSizeInBytes();
+    if (buckets.empty() || buckets.back()[0].type() != tensor.type() ||
+        buckets.back()[0].device() != tensor.device() ||
+        currentSize + size > bucketSize) {
+      buckets.emplace_back();
+      currentSize = 0;
+    }
+    buckets.back().push_back(tensor);
+    currentSize += size;
+  }
+  return buckets;
+}
+
+// Returns a flat tensor spanning all of the given tensors if they are
+// contiguous and laid out one after the other in the same storage.
+// Returns an undefined tensor otherwise.
+at::Tensor flatViewOf(const std::vector<at::Tensor>& tensors) {
+  const auto& first = tensors[0];
+  const auto* storage = first.storage().unsafeGetStorageImpl();
+  int64_t numel = 0;
+  for (const auto& tensor : tensors) {
+    if (!tensor.is_contiguous() ||
+        tensor.storage().unsafeGetStorageImpl() != storage ||
+        tensor.storage_offset() != first.storage_offset() + numel) {
+      return at::Tensor();
+    }
+    numel += tensor.numel();
+  }
+  return at::empty({0}, first.options())
+      .set_(first.storage(), first.storage_offset(), {numel}, {1});
+}
+
+// Copies the tensors into a new flat buffer and makes them views of it.
+at::Tensor moveIntoFlatBuffer(std::vector<at::Tensor>& tensors) {
+  int64_t numel = 0;
+  for (const auto& tensor : tensors) {
+    numel += tensor.numel();
+  }
+  at::DeviceGuard deviceGuard(tensors[0].device());
+  auto buffer = at::empty({numel}, tensors[0].options());
+  int64_t offset = 0;
+  for (auto& tensor : tensors) {
+    auto view = buffer.narrow(0, offset, tensor.numel()).view(tensor.sizes());
+    view.copy_(tensor);
+    tensor.set_(view);
+    offset += tensor.numel();
+  }
+  return buffer;
+}
+
+} // namespace
+
 ProcessGroup::Work::~Work() {}
 
 ProcessGroup::ProcessGroup(int rank, int size) : rank_(rank), size_(size) {}
 
 ProcessGroup::~ProcessGroup() {}
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::allreduceCoalesced(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceCoalescedOptions& opts) {
+  if (tensors.empty()) {
+    throw std::invalid_argument("argument is empty");
+  }
+  for (const auto& tensor : tensors) {
+    if (tensor.is_sparse()) {
+      throw std::invalid_argument("requires dense tensors");
+    }
+  }
+
+  AllreduceOptions allreduceOpts;
+  allreduceOpts.reduceOp = opts.reduceOp;
+
+  auto buckets = coalesceTensors(tensors, opts.bucketSize);
+  std::vector<std::vector<at::Tensor>> buffers;
+  std::vector<std::shared_ptr<Work>> work;
+  buffers.reserve(buckets.size());
+  work.reserve(buckets.size());
+  for (auto& bucket : buckets) {
+    auto buffer = flatViewOf(bucket);
+    if (!buffer.defined()) {
+      // Note: set_ changes the tensors shared with the caller
+      buffer = moveIntoFlatBuffer(bucket);
+    }
+    buffers.push_back({buffer});
+    work.push_back(allreduce(buffers.back(), allreduceOpts));
+  }
+  return std::make_shared<CoalescedWork>(std::move(work), std::move(buffers));
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::reduceScatter(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ReduceScatterOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroup does not support reduceScatter");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroup::alltoall(
+    at::Tensor& /* unused */,
+    at::Tensor& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroup does not support alltoall");
+}
+
 } // namespace c10d
@@ -95,6 +95,19 @@ class ProcessGroup {
       std::vector<at::Tensor>& data,
       const AllreduceOptions& opts = AllreduceOptions()) = 0;
 
+  // Allreduces a list of tensors of any size, with as few collectives as
+  // possible. The tensors are grouped into buckets of consecutive tensors of
+  // the same type, of at most opts.bucketSize bytes each, and every bucket is
+  // reduced as a single flat tensor with one call to allreduce.
+  //
+  // The first time a bucket is reduced, its tensors are copied into a new
+  // flat buffer and set_ to views of it, which keeps the buffer alive. As
+  // long as they remain such views (e.g. for gradients that are accumulated
+  // into in place), following calls reduce the buffers without any copies.
+  virtual std::shared_ptr<Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceCoalescedOptions& opts = AllreduceCoalescedOptions());
+
   virtual std::shared_ptr<ProcessGroup::Work> reduce(
       std::vector<at::Tensor>& tensors,
       const ReduceOptions& opts = ReduceOptions()) = 0;
@@ -108,6 +121,32 @@ class ProcessGroup {
       std::vector<at::Tensor>& inputTensors,
       const GatherOptions& opts = GatherOptions()) = 0;
 
+  // Reduces inputTensors[i][r] over all processes into outputTensors[i] of
+  // process r (the inverse of allgather). With multiple devices per process,
+  // inputTensors[i] holds (size * outputTensors.size()) tensors and rank r's
+  // device j receives inputTensors[i][r * outputTensors.size() + j].
+  //
+  // Throws if the backend doesn't support it.
+  virtual std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions());
+
+  // Splits inputTensor along its first dimension, sends slice r to process r,
+  // and concatenates the slices received from all processes, in rank order,
+  // into outputTensor. The split sizes are the sizes of the slices along the
+  // first dimension; empty split sizes split the tensor evenly. The output
+  // split sizes of a process must match the input split sizes the others use
+  // for it.
+  //
+  // Throws if the backend doesn't support it.
+  virtual std::shared_ptr<ProcessGroup::Work> alltoall(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions());
+
   virtual std::shared_ptr<ProcessGroup::Work> scatter(
       std::vector<at::Tensor>& outputTensors,
       std::vector<std::vector<at::Tensor>>& inputTensors,
@@ -1,5 +1,7 @@
 #include "ProcessGroupGloo.hpp"
 
+#include <cstring>
+
 #include <gloo/allgather.h>
 #include <gloo/allreduce.h>
 #include <gloo/allreduce_halving_doubling.h>
@@ -10,6 +12,7 @@
 #include <gloo/gather.h>
 #include <gloo/reduce.h>
 #include <gloo/scatter.h>
+#include <gloo/types.h>
 
 #ifdef USE_CUDA
 #include <ATen/cuda/CUDAEvent.h>
@@ -410,7 +413,7 @@ ProcessGroupGloo::ProcessGroupGloo(
     contexts_.push_back(std::move(context));
   }
 
-  threads_.resize(options.threads);
+  threads_.resize(std::max<size_t>(options.threads, contexts_.size()));
   for (size_t i = 0; i < threads_.size(); i++) {
     threads_[i] = std::thread(&ProcessGroupGloo::runLoop, this);
   }
@@ -439,6 +442,10 @@ uint32_t ProcessGroupGloo::nextTag() {
   return collectiveCounter_++;
 }
 
+std::shared_ptr<::gloo::Context>& ProcessGroupGloo::getContext(uint32_t tag) {
+  return contexts_[tag % contexts_.size()];
+}
+
 void ProcessGroupGloo::runLoop(void) {
   std::unique_lock<std::mutex> lock(queueMutex_);
 
@@ -505,7 +512,7 @@ void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
       return;
     case CollectiveType::BARRIER:
       entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
-          new ::gloo::BarrierAllToOne(contexts_[0]));
+          new ::gloo::BarrierAllToOne(entry.context));
       return;
     case CollectiveType::UNUSED:
       break;
@@ -519,8 +526,7 @@ void ProcessGroupGloo::createAllreduce(AlgorithmEntry& entry) {
   const auto& key = entry.key;
   const auto& backend = key.type->backend();
 
-  // Create algorithm against first context
-  auto& context = contexts_[0];
+  auto& context = entry.context;
   at::OptionalDeviceGuard guard(at::device_of(entry.src[0]));
 
   if (backend == at::Backend::CPU) {
@@ -572,8 +578,7 @@ void ProcessGroupGloo::createBroadcast(AlgorithmEntry& entry) {
   const auto& key = entry.key;
   const auto& backend = key.type->backend();
 
-  // Create algorithm against first context
-  auto& context = contexts_[0];
+  auto& context = entry.context;
   at::OptionalDeviceGuard guard(device_of(entry.src[0]));
 
   if (backend == at::Backend::CPU) {
@@ -671,6 +676,8 @@ AlgorithmEntry* ProcessGroupGloo::checkout(const AlgorithmKey& key) {
   // If there is no entry for this key, create a new one
   if (!vec[i]) {
     vec[i] = construct(key);
+    vec[i]->context =
+        contexts_[numEntriesConstructed_++ % contexts_.size()];
   }
 
   auto& entry = vec[i];
@@ -830,14 +837,15 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
   }
 
   std::shared_ptr<AsyncBroadcastWork> work;
-  auto& context = contexts_[0];
+  const auto tag = nextTag();
+  auto& context = getContext(tag);
   if (device.type() == at::kCPU) {
     work = std::make_shared<AsyncBroadcastWork>(
-        context, inputs, opts.rootRank, opts.rootTensor, nextTag());
+        context, inputs, opts.rootRank, opts.rootTensor, tag);
 #ifdef USE_CUDA
   } else if (device.type() == at::kCUDA) {
     work = std::make_shared<AsyncBroadcastCUDAWork>(
-        context, inputs, opts.rootRank, opts.rootTensor, nextTag());
+        context, inputs, opts.rootRank, opts.rootTensor, tag);
 #endif
   } else {
     throw std::runtime_error("Invalid backend");
@@ -972,14 +980,15 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   }
 
   std::shared_ptr<AsyncAllreduceWork> work;
-  auto& context = contexts_[0];
+  const auto tag = nextTag();
+  auto& context = getContext(tag);
   if (device.type() == at::kCPU) {
     work = std::make_shared<AsyncAllreduceWork>(
-        context, inputs, opts.reduceOp, nextTag());
+        context, inputs, opts.reduceOp, tag);
 #ifdef USE_CUDA
   } else if (device.type() == at::kCUDA) {
     work = std::make_shared<AsyncAllreduceCUDAWork>(
-        context, inputs, opts.reduceOp, nextTag());
+        context, inputs, opts.reduceOp, tag);
 #endif
   } else {
     throw std::runtime_error("Invalid backend");
@@ -1054,13 +1063,14 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce(
   assertDense(invalidArgument, inputs);
   assertCPU(invalidArgument, inputs);
 
+  const auto tag = nextTag();
   auto work = std::make_shared<AsyncReduceWork>(
-      contexts_[0],
+      getContext(tag),
       inputs,
       opts.rootRank,
       opts.rootTensor,
       opts.reduceOp,
-      nextTag());
+      tag);
   enqueue(std::bind(AsyncWork::execute, work));
   return work;
 }
@@ -1146,8 +1156,253 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather(
     assertTypeAndSizesMatch(invalidArgument, outputs[i], type, sizes);
   }
 
+  const auto tag = nextTag();
   auto work = std::make_shared<AsyncAllgatherWork>(
-      contexts_[0], outputs, inputs, nextTag());
+      getContext(tag), outputs, inputs, tag);
+  enqueue(std::bind(AsyncWork::execute, work));
+  return work;
+}
+
+namespace {
+
+// Slot prefixes of the collectives implemented with unbound buffers here,
+// so they don't collide with each other, the Gloo collectives, or the tags
+// of send/recv.
+constexpr uint8_t kReduceScatterSlotPrefix = 0x40;
+constexpr uint8_t kAlltoallSlotPrefix = 0x41;
+
+class AsyncReduceScatterWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncReduceScatterWork(
+      const std::shared_ptr<gloo::Context>& context,
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      ReduceOp reduceOp,
+      uint32_t tag)
+      : context(context),
+        outputs(outputs),
+        inputs(inputs),
+        reduceOp(reduceOp),
+        tag(tag) {}
+
+  std::shared_ptr<gloo::Context> context;
+  std::vector<at::Tensor> outputs;
+  std::vector<std::vector<at::Tensor>> inputs;
+  const ReduceOp reduceOp;
+  const uint32_t tag;
+
+  void run() override {
+    auto& output = outputs[0];
+    const auto rank = context->rank;
+    const auto size = context->size;
+    const auto numel = output.numel();
+    const auto nbytes = numel * output.type().elementSizeInBytes();
+    const auto slot = gloo::Slot::build(kReduceScatterSlotPrefix, tag);
+
+    // Every process sends chunk r of its input to process r, and reduces
+    // the chunks it receives from all others, in rank order.
+    auto chunks = fmap(inputs[0], [](const at::Tensor& t) {
+      return t.contiguous();
+    });
+    auto received = at::empty({size, numel}, output.options());
+    std::vector<std::unique_ptr<gloo::transport::UnboundBuffer>> recvBufs;
+    std::vector<std::unique_ptr<gloo::transport::UnboundBuffer>> sendBufs;
+    for (int i = 1; i < size; i++) {
+      const auto src = (rank + size - i) % size;
+      recvBufs.push_back(
+          context->createUnboundBuffer(received[src].data_ptr(), nbytes));
+      recvBufs.back()->recv(src, slot);
+    }
+    for (int i = 1; i < size; i++) {
+      const auto dst = (rank + i) % size;
+      sendBufs.push_back(
+          context->createUnboundBuffer(chunks[dst].data_ptr(), nbytes));
+      sendBufs.back()->send(dst, slot);
+    }
+    received[rank].copy_(chunks[rank].view({-1}));
+    for (auto& buf : recvBufs) {
+      buf->waitRecv();
+    }
+
+    auto result = received[0].clone();
+    const auto fn = getFunction(output.scalar_type(), reduceOp);
+    for (int i = 1; i < size; i++) {
+      fn(result.data_ptr(), result.data_ptr(), received[i].data_ptr(), numel);
+    }
+    output.copy_(result.view(output.sizes()));
+
+    for (auto& buf : sendBufs) {
+      buf->waitSend();
+    }
+  }
+
+ protected:
+  template <typename T>
+  void getFunction(ReduceFunc& fn, const ReduceOp op) {
+    fn = toFunction<T>(op);
+  }
+
+  ReduceFunc getFunction(const at::ScalarType& dtype, const ReduceOp op) {
+    ReduceFunc fn;
+    GENERATE_ALL_TYPES(dtype, getFunction, fn, op);
+    return fn;
+  }
+};
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduceScatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ReduceScatterOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::reduceScatter: " + msg);
+  };
+
+  assertSingleElementOutput(invalidArgument, outputs);
+  assertDense(invalidArgument, outputs);
+  assertCPU(invalidArgument, outputs);
+  if (inputs.size() != 1 ||
+      inputs[0].size() != static_cast<size_t>(getSize())) {
+    invalidArgument(
+        "requires a single-element input list "
+        "containing a list with <size> tensors");
+  }
+  const auto& type = outputs[0].type();
+  const auto& sizes = outputs[0].sizes();
+  assertTypeAndSizesMatch(invalidArgument, inputs[0], type, sizes);
+
+  const auto tag = nextTag();
+  auto work = std::make_shared<AsyncReduceScatterWork>(
+      getContext(tag), outputs, inputs, opts.reduceOp, tag);
+  enqueue(std::bind(AsyncWork::execute, work));
+  return work;
+}
+
+namespace {
+
+class AsyncAlltoallWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncAlltoallWork(
+      const std::shared_ptr<gloo::Context>& context,
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t> outputLengths,
+      std::vector<int64_t> outputOffsets,
+      std::vector<int64_t> inputLengths,
+      std::vector<int64_t> inputOffsets,
+      uint32_t tag)
+      : context(context),
+        outputTensor(outputTensor),
+        inputTensor(inputTensor),
+        outputLengths(std::move(outputLengths)),
+        outputOffsets(std::move(outputOffsets)),
+        inputLengths(std::move(inputLengths)),
+        inputOffsets(std::move(inputOffsets)),
+        tag(tag) {}
+
+  std::shared_ptr<gloo::Context> context;
+  at::Tensor outputTensor;
+  at::Tensor inputTensor;
+  const std::vector<int64_t> outputLengths;
+  const std::vector<int64_t> outputOffsets;
+  const std::vector<int64_t> inputLengths;
+  const std::vector<int64_t> inputOffsets;
+  const uint32_t tag;
+
+  void run() override {
+    const auto rank = context->rank;
+    const auto size = context->size;
+    const auto elementSize = inputTensor.type().elementSizeInBytes();
+    const auto slot = gloo::Slot::build(kAlltoallSlotPrefix, tag);
+    auto output = static_cast<char*>(outputTensor.data_ptr());
+    auto input = static_cast<char*>(inputTensor.data_ptr());
+
+    // Empty slices are neither sent nor received, on both ends
+    std::vector<std::unique_ptr<gloo::transport::UnboundBuffer>> recvBufs;
+    std::vector<std::unique_ptr<gloo::transport::UnboundBuffer>> sendBufs;
+    for (int i = 1; i < size; i++) {
+      const auto src = (rank + size - i) % size;
+      if (outputLengths[src] > 0) {
+        recvBufs.push_back(context->createUnboundBuffer(
+            output + outputOffsets[src] * elementSize,
+            outputLengths[src] * elementSize));
+        recvBufs.back()->recv(src, slot);
+      }
+    }
+    for (int i = 1; i < size; i++) {
+      const auto dst = (rank + i) % size;
+      if (inputLengths[dst] > 0) {
+        sendBufs.push_back(context->createUnboundBuffer(
+            input + inputOffsets[dst] * elementSize,
+            inputLengths[dst] * elementSize));
+        sendBufs.back()->send(dst, slot);
+      }
+    }
+    if (inputLengths[rank] > 0) {
+      std::memcpy(
+          output + outputOffsets[rank] * elementSize,
+          input + inputOffsets[rank] * elementSize,
+          inputLengths[rank] * elementSize);
+    }
+
+    for (auto& buf : recvBufs) {
+      buf->waitRecv();
+    }
+    for (auto& buf : sendBufs) {
+      buf->waitSend();
+    }
+  }
+};
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::alltoall: " + msg);
+  };
+
+  assertDense(invalidArgument, inputTensor);
+  assertDense(invalidArgument, outputTensor);
+  assertCPU(invalidArgument, inputTensor);
+  assertCPU(invalidArgument, outputTensor);
+  assertTypeMatch(invalidArgument, inputTensor.type(), outputTensor, 0);
+
+  std::vector<int64_t> outputLengths, outputOffsets;
+  std::vector<int64_t> inputLengths, inputOffsets;
+  computeLengthsAndOffsets(
+      invalidArgument,
+      outputSplitSizes,
+      outputTensor,
+      size_,
+      &outputLengths,
+      &outputOffsets);
+  computeLengthsAndOffsets(
+      invalidArgument,
+      inputSplitSizes,
+      inputTensor,
+      size_,
+      &inputLengths,
+      &inputOffsets);
+  if (outputLengths[rank_] != inputLengths[rank_]) {
+    invalidArgument("the slice for this process differs in size on both ends");
+  }
+
+  const auto tag = nextTag();
+  auto work = std::make_shared<AsyncAlltoallWork>(
+      getContext(tag),
+      outputTensor,
+      inputTensor,
+      std::move(outputLengths),
+      std::move(outputOffsets),
+      std::move(inputLengths),
+      std::move(inputOffsets),
+      tag);
   enqueue(std::bind(AsyncWork::execute, work));
   return work;
 }
@@ -1233,8 +1488,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::gather(
     }
   }
 
+  const auto tag = nextTag();
   auto work = std::make_shared<AsyncGatherWork>(
-      contexts_[0], outputs, inputs, opts.rootRank, nextTag());
+      getContext(tag), outputs, inputs, opts.rootRank, tag);
   enqueue(std::bind(AsyncWork::execute, work));
   return work;
 }
@@ -1309,8 +1565,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::scatter(
     }
   }
 
+  const auto tag = nextTag();
   auto work = std::make_shared<AsyncScatterWork>(
-      contexts_[0], outputs, inputs, opts.rootRank, nextTag());
+      getContext(tag), outputs, inputs, opts.rootRank, tag);
   enqueue(std::bind(AsyncWork::execute, work));
   return work;
 }
@@ -85,12 +85,14 @@ struct AlgorithmKey {
 // do caching, this entry holds on to memory that we copy to/from.
 //
 // Every unique call (in terms of number of tensors, tensor types,
-// tensor sizes, etc.) gets its own entry. In the future we may extend
-// this to allow multiple entries per unique call, to better exploit
-// parallelism for calls with the same signature.
+// tensor sizes, etc.) gets up to Options::cacheNumAlgorithmEntries
+// entries, used in turn, so that calls with the same signature can be in
+// flight at the same time. Each entry runs its algorithm on one of the
+// contexts of the process group.
 //
 struct AlgorithmEntry {
   AlgorithmKey key;
+  std::shared_ptr<::gloo::Context> context;
   std::unique_ptr<::gloo::Algorithm> algorithm;
   std::vector<at::Tensor> src;
   std::vector<at::Tensor> dst;
@@ -318,8 +320,14 @@ class ProcessGroupGloo : public ProcessGroup {
   struct Options {
     explicit Options();
 
+    // A context is connected over each device, and the collectives are
+    // spread over the contexts in turn, so that they can run at the same
+    // time over several network interfaces (a device per interface).
+    // Point-to-point operations use the first one.
     std::vector<std::shared_ptr<::gloo::transport::Device>> devices;
     std::chrono::milliseconds timeout;
+    // The number of threads running the collectives, at least one per
+    // device
     int threads;
 
     // This controls how many Gloo algorithm instances are created for
@@ -355,6 +363,18 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors) override;
 
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   std::shared_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors,
@@ -405,6 +425,14 @@ class ProcessGroupGloo : public ProcessGroup {
   // Returns next collective tag to use (uses collectiveCounter_).
   uint32_t nextTag();
 
+  // Returns the context the collective of a tag runs on. Like the tags, the
+  // contexts are picked in the same order in all processes.
+  std::shared_ptr<::gloo::Context>& getContext(uint32_t tag);
+
+  // The number of algorithm entries constructed, which picks the context of
+  // the next one
+  size_t numEntriesConstructed_ = 0;
+
   void runLoop(void);
 
   void runSingle(WorkType work);
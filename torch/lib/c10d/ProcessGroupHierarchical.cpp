@@ -0,0 +1,287 @@
+#include "ProcessGroupHierarchical.hpp"
+
+#include <stdexcept>
+
+#include <c10d/Utils.hpp>
+
+namespace c10d {
+
+namespace {
+
+void checkGroups(
+    const std::shared_ptr<ProcessGroup>& intraNode,
+    const std::shared_ptr<ProcessGroup>& interNode) {
+  if (!intraNode || !interNode) {
+    throw std::invalid_argument(
+        "ProcessGroupHierarchical: requires intra-node and inter-node groups");
+  }
+}
+
+int globalRank(
+    const std::shared_ptr<ProcessGroup>& intraNode,
+    const std::shared_ptr<ProcessGroup>& interNode) {
+  checkGroups(intraNode, interNode);
+  return interNode->getRank() * intraNode->getSize() + intraNode->getRank();
+}
+
+int globalSize(
+    const std::shared_ptr<ProcessGroup>& intraNode,
+    const std::shared_ptr<ProcessGroup>& interNode) {
+  checkGroups(intraNode, interNode);
+  return interNode->getSize() * intraNode->getSize();
+}
+
+void waitOrThrow(const std::shared_ptr<ProcessGroup::Work>& work) {
+  if (!work->wait()) {
+    throw std::runtime_error(work->exception().what());
+  }
+}
+
+} // namespace
+
+ProcessGroupHierarchical::WorkHierarchical::WorkHierarchical(
+    std::exception_ptr eptr)
+    : eptr_(eptr) {}
+
+ProcessGroupHierarchical::WorkHierarchical::~WorkHierarchical() {}
+
+bool ProcessGroupHierarchical::WorkHierarchical::isCompleted() {
+  return true;
+}
+
+bool ProcessGroupHierarchical::WorkHierarchical::isSuccess() const {
+  return eptr_ == nullptr;
+}
+
+void ProcessGroupHierarchical::WorkHierarchical::synchronize() {}
+
+bool ProcessGroupHierarchical::WorkHierarchical::wait() {
+  return isSuccess();
+}
+
+const std::exception& ProcessGroupHierarchical::WorkHierarchical::exception()
+    const {
+  std::rethrow_exception(eptr_);
+}
+
+ProcessGroupHierarchical::ProcessGroupHierarchical(
+    std::shared_ptr<ProcessGroup> intraNode,
+    std::shared_ptr<ProcessGroup> interNode)
+    : ProcessGroup(
+          globalRank(intraNode, interNode),
+          globalSize(intraNode, interNode)),
+      intraNode_(std::move(intraNode)),
+      interNode_(std::move(interNode)),
+      localSize_(intraNode_->getSize()),
+      localRank_(intraNode_->getRank()),
+      numNodes_(interNode_->getSize()),
+      node_(interNode_->getRank()) {}
+
+ProcessGroupHierarchical::~ProcessGroupHierarchical() {}
+
+template <typename Fn>
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::run(Fn fn) {
+  try {
+    fn();
+  } catch (...) {
+    return std::make_shared<WorkHierarchical>(std::current_exception());
+  }
+  return std::make_shared<WorkHierarchical>();
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupHierarchical::broadcast: " + msg);
+  };
+
+  assertRootRank(invalidArgument, opts.rootRank, size_);
+  assertRootTensor(invalidArgument, opts.rootTensor, tensors.size());
+  assertSingleElement(invalidArgument, tensors);
+
+  return run([&]() {
+    // The root sends to the processes with the same local rank on the other
+    // nodes first, which then send within their node.
+    const int rootLocalRank = opts.rootRank % localSize_;
+    if (localRank_ == rootLocalRank && numNodes_ > 1) {
+      BroadcastOptions interOpts;
+      interOpts.rootRank = opts.rootRank / localSize_;
+      waitOrThrow(interNode_->broadcast(tensors, interOpts));
+    }
+    if (localSize_ > 1) {
+      BroadcastOptions intraOpts;
+      intraOpts.rootRank = rootLocalRank;
+      waitOrThrow(intraNode_->broadcast(tensors, intraOpts));
+    }
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupHierarchical::allreduce: " + msg);
+  };
+
+  assertSingleElement(invalidArgument, tensors);
+  assertDense(invalidArgument, tensors);
+
+  // Nothing to split if one of the levels is trivial
+  if (numNodes_ == 1) {
+    return intraNode_->allreduce(tensors, opts);
+  }
+  if (localSize_ == 1) {
+    return interNode_->allreduce(tensors, opts);
+  }
+
+  return run([&]() {
+    auto& tensor = tensors[0];
+    const auto numel = tensor.numel();
+    const auto chunk = (numel + localSize_ - 1) / localSize_;
+
+    // Every local rank owns one slice of the (padded) flat tensor
+    auto buffer = at::zeros({chunk * localSize_}, tensor.options());
+    buffer.narrow(0, 0, numel).copy_(tensor.reshape({-1}));
+    std::vector<at::Tensor> intraTensors = {buffer};
+    waitOrThrow(intraNode_->allreduce(intraTensors, opts));
+
+    std::vector<at::Tensor> slice = {
+        buffer.narrow(0, localRank_ * chunk, chunk)};
+    waitOrThrow(interNode_->allreduce(slice, opts));
+
+    std::vector<std::vector<at::Tensor>> slices(1);
+    for (int i = 0; i < localSize_; ++i) {
+      slices[0].push_back(at::empty({chunk}, tensor.options()));
+    }
+    waitOrThrow(intraNode_->allgather(slices, slice));
+    tensor.copy_(at::cat(slices[0]).narrow(0, 0, numel).view(tensor.sizes()));
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupHierarchical::reduce: " + msg);
+  };
+
+  assertRootRank(invalidArgument, opts.rootRank, size_);
+  assertRootTensor(invalidArgument, opts.rootTensor, tensors.size());
+  assertSingleElement(invalidArgument, tensors);
+
+  return run([&]() {
+    // Reduce to the root's local rank within every node, then across nodes
+    const int rootLocalRank = opts.rootRank % localSize_;
+    if (localSize_ > 1) {
+      ReduceOptions intraOpts;
+      intraOpts.reduceOp = opts.reduceOp;
+      intraOpts.rootRank = rootLocalRank;
+      waitOrThrow(intraNode_->reduce(tensors, intraOpts));
+    }
+    if (localRank_ == rootLocalRank && numNodes_ > 1) {
+      ReduceOptions interOpts;
+      interOpts.reduceOp = opts.reduceOp;
+      interOpts.rootRank = opts.rootRank / localSize_;
+      waitOrThrow(interNode_->reduce(tensors, interOpts));
+    }
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather(
+    std::vector<std::vector<at::Tensor>>& outputTensors,
+    std::vector<at::Tensor>& inputTensors) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupHierarchical::allgather: " + msg);
+  };
+
+  assertSingleElementInput(invalidArgument, inputTensors);
+  assertDense(invalidArgument, inputTensors);
+  if (outputTensors.size() != 1 ||
+      outputTensors[0].size() != static_cast<size_t>(size_)) {
+    invalidArgument(
+        "requires a single output tensor list of length " +
+        std::to_string(size_));
+  }
+  const auto& type = inputTensors[0].type();
+  const auto& sizes = inputTensors[0].sizes();
+  assertTypeAndSizesMatch(invalidArgument, outputTensors[0], type, sizes);
+
+  return run([&]() {
+    const auto& input = inputTensors[0];
+    const auto numel = input.numel();
+
+    // Gather within every node, then exchange whole nodes. Ranks are laid
+    // out node after node, so the result is in rank order.
+    std::vector<at::Tensor> flatInput = {input.reshape({-1})};
+    std::vector<std::vector<at::Tensor>> local(1);
+    for (int i = 0; i < localSize_; ++i) {
+      local[0].push_back(at::empty({numel}, input.options()));
+    }
+    waitOrThrow(intraNode_->allgather(local, flatInput));
+
+    std::vector<at::Tensor> node = {at::cat(local[0])};
+    std::vector<std::vector<at::Tensor>> nodes(1);
+    for (int i = 0; i < numNodes_; ++i) {
+      nodes[0].push_back(at::empty({numel * localSize_}, input.options()));
+    }
+    waitOrThrow(interNode_->allgather(nodes, node));
+
+    for (int i = 0; i < size_; ++i) {
+      outputTensors[0][i].copy_(nodes[0][i / localSize_]
+                                    .narrow(0, (i % localSize_) * numel, numel)
+                                    .view(sizes));
+    }
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::barrier() {
+  return run([&]() {
+    // Nobody leaves until all nodes have entered
+    waitOrThrow(intraNode_->barrier());
+    waitOrThrow(interNode_->barrier());
+    waitOrThrow(intraNode_->barrier());
+  });
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::gather(
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    std::vector<at::Tensor>& /* unused */,
+    const GatherOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support gather");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::scatter(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ScatterOptions& /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support scatter");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::send(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */,
+    int /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support send");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recv(
+    std::vector<at::Tensor>& /* unused */,
+    int /* unused */,
+    int /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support recv");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recvAnysource(
+    std::vector<at::Tensor>& /* unused */,
+    int* /* unused */,
+    int /* unused */) {
+  throw std::runtime_error("ProcessGroupHierarchical does not support recv");
+}
+
+std::unordered_map<int, int> ProcessGroupHierarchical::getGroupRank() {
+  throw std::runtime_error(
+      "ProcessGroupHierarchical does not support getGroupRank");
+}
+
+} // namespace c10d
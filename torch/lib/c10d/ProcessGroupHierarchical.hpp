@@ -0,0 +1,129 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+// ProcessGroupHierarchical composes a process group over all processes out
+// of two existing groups: one over the processes of the same node (e.g.
+// ProcessGroupNCCL, using NVLink), and one over the processes with the same
+// local rank on all nodes (e.g. ProcessGroupGloo or ProcessGroupMPI).
+//
+// Every node must have the same number of processes, and the global rank of
+// a process is derived from its ranks in the two groups:
+//
+//   rank = interNode.getRank() * intraNode.getSize() + intraNode.getRank()
+//
+// An allreduce first reduces within every node, then allreduces one slice
+// of 1 / intraNode.getSize() of the tensor per local rank across nodes, and
+// finally allgathers the slices within every node. With N processes per
+// node, every process only sends 1 / N of the tensor between nodes.
+//
+// The two groups are typically created over a single store, using a
+// PrefixStore per node and per local rank so their keys don't collide:
+//
+//   PrefixStore intraStore("intra/" + std::to_string(node), store);
+//   PrefixStore interStore("inter/" + std::to_string(localRank), store);
+//
+// All functions of the class are expected to be called in the same order
+// across all processes in the process group. They issue the collectives of
+// both groups from the calling thread and wait for them, so the returned
+// work has completed (successfully or not) when they return. For CUDA
+// tensors, the results are ordered before any work subsequently queued on
+// the current streams.
+//
+// Only a single tensor per process is supported.
+class ProcessGroupHierarchical : public ProcessGroup {
+ public:
+  class WorkHierarchical : public ProcessGroup::Work {
+   public:
+    explicit WorkHierarchical(std::exception_ptr eptr = nullptr);
+    virtual ~WorkHierarchical();
+
+    bool isCompleted() override;
+
+    bool isSuccess() const override;
+
+    void synchronize() override;
+
+    bool wait() override;
+
+    const std::exception& exception() const override;
+
+   protected:
+    std::exception_ptr eptr_;
+  };
+
+  ProcessGroupHierarchical(
+      std::shared_ptr<ProcessGroup> intraNode,
+      std::shared_ptr<ProcessGroup> interNode);
+
+  virtual ~ProcessGroupHierarchical();
+
+  std::shared_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors) override;
+
+  std::shared_ptr<ProcessGroup::Work> barrier() override;
+
+  // Unsupported Ops
+  std::shared_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int* srcRank,
+      int tag) override;
+
+  std::unordered_map<int, int> getGroupRank() override;
+
+ protected:
+  // Runs fn, returning a work item holding the exception it threw, if any
+  template <typename Fn>
+  std::shared_ptr<ProcessGroup::Work> run(Fn fn);
+
+  std::shared_ptr<ProcessGroup> intraNode_;
+  std::shared_ptr<ProcessGroup> interNode_;
+
+  // Number of processes per node, and the rank within this node
+  const int localSize_;
+  const int localRank_;
+
+  // Number of nodes, and the index of this node
+  const int numNodes_;
+  const int node_;
+};
+
+} // namespace c10d
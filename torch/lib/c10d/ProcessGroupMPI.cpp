@@ -530,6 +530,118 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::allgather(
   return enqueue(std::move(entry));
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (pgComm_ == MPI_COMM_NULL) {
+    return nullptr;
+  }
+  checkSingleTensor(outputTensors);
+  if (inputTensors.size() != 1) {
+    throw std::runtime_error(
+        "Reduce scatter: multi-GPU collective is not supported");
+  }
+  if (static_cast<size_t>(groupSize_) != inputTensors[0].size()) {
+    throw std::runtime_error(
+        "Reduce scatter: number of input tensors should equal "
+        "to the world size");
+  }
+
+  checkSameSizeAndType(outputTensors[0], inputTensors[0]);
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [opts, this](std::unique_ptr<WorkEntry>& entry) {
+        auto data = (entry->dst)[0];
+        auto flatInputTensor = newLikeFlat(entry->src);
+        for (size_t i = 0; i < entry->src.size(); ++i) {
+          flatInputTensor[i].copy_(entry->src[i]);
+        }
+
+        std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+        MPI_CHECK(MPI_Reduce_scatter_block(
+            flatInputTensor.data_ptr(),
+            data.data_ptr(),
+            data.numel(),
+            mpiDatatype.at(data.type().scalarType()),
+            mpiOp.at(opts.reduceOp),
+            pgComm_));
+      };
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors[0], &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry));
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::alltoall(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupMPI::alltoall: " + msg);
+  };
+
+  if (pgComm_ == MPI_COMM_NULL) {
+    return nullptr;
+  }
+  checkSingleTensorHelper(inputTensor);
+  checkSingleTensorHelper(outputTensor);
+  if (inputTensor.type() != outputTensor.type()) {
+    invalidArgument("input and output tensors must have the same type");
+  }
+
+  // MPI takes the counts and displacements in elements, as ints
+  std::vector<int64_t> outputLengths, outputOffsets;
+  std::vector<int64_t> inputLengths, inputOffsets;
+  computeLengthsAndOffsets(
+      invalidArgument,
+      outputSplitSizes,
+      outputTensor,
+      groupSize_,
+      &outputLengths,
+      &outputOffsets);
+  computeLengthsAndOffsets(
+      invalidArgument,
+      inputSplitSizes,
+      inputTensor,
+      groupSize_,
+      &inputLengths,
+      &inputOffsets);
+  auto toInt = [](const std::vector<int64_t>& v) {
+    return std::vector<int>(v.begin(), v.end());
+  };
+  auto recvCounts = toInt(outputLengths);
+  auto recvDispls = toInt(outputOffsets);
+  auto sendCounts = toInt(inputLengths);
+  auto sendDispls = toInt(inputOffsets);
+
+  std::function<void(std::unique_ptr<WorkEntry>&)> runFunc =
+      [recvCounts, recvDispls, sendCounts, sendDispls, this](
+          std::unique_ptr<WorkEntry>& entry) mutable {
+        auto input = (entry->src)[0];
+        auto output = (entry->dst)[0];
+        auto dataType = mpiDatatype.at(input.type().scalarType());
+
+        std::unique_lock<std::mutex> globalLock(pgGlobalMutex_);
+        MPI_CHECK(MPI_Alltoallv(
+            input.data_ptr(),
+            sendCounts.data(),
+            sendDispls.data(),
+            dataType,
+            output.data_ptr(),
+            recvCounts.data(),
+            recvDispls.data(),
+            dataType,
+            pgComm_));
+      };
+  std::vector<at::Tensor> inputTensors = {inputTensor};
+  std::vector<at::Tensor> outputTensors = {outputTensor};
+  auto entry = std::unique_ptr<WorkEntry>(
+      new WorkEntry(&inputTensors, &outputTensors, std::move(runFunc)));
+  return enqueue(std::move(entry));
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::gather(
     std::vector<std::vector<at::Tensor>>& outputTensors,
     std::vector<at::Tensor>& inputTensors,
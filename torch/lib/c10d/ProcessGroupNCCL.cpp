@@ -82,7 +82,7 @@ void syncStreams(
 } // namespace
 
 ProcessGroupNCCL::WorkNCCL::WorkNCCL(const std::vector<at::Device>& devices)
-    : devices_(devices) {
+    : devices_(devices), workStartTime_(std::chrono::steady_clock::now()) {
   // Creates the CUDA event wrappers
   // Note: The actual events are lazily created when first recorded to with
   // DEFAULT_FLAGS = cudaEventDisableTiming.
@@ -111,8 +111,38 @@ bool ProcessGroupNCCL::WorkNCCL::finishedGPUExecution() const {
   return true;
 }
 
-// Same as synchronize(), and will always return true
+std::exception_ptr ProcessGroupNCCL::WorkNCCL::checkForErrors(
+    const std::chrono::milliseconds& timeout) const {
+  for (const auto& ncclComm : ncclComms_) {
+    auto ncclAsyncErr = ncclComm->checkForNcclError();
+    if (ncclAsyncErr != ncclSuccess) {
+      return std::make_exception_ptr(std::runtime_error(
+          "NCCL error: " + std::string(ncclGetErrorString(ncclAsyncErr))));
+    }
+  }
+  if (timeout != kNoTimeout &&
+      std::chrono::steady_clock::now() - workStartTime_ > timeout) {
+    return std::make_exception_ptr(std::runtime_error(
+        "NCCL operation timed out after " + std::to_string(timeout.count()) +
+        " ms"));
+  }
+  return nullptr;
+}
+
+void ProcessGroupNCCL::WorkNCCL::setException(std::exception_ptr exception) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  exception_ = exception;
+}
+
+// Same as synchronize(), and will return true unless the work failed, in
+// which case the error is thrown
 bool ProcessGroupNCCL::WorkNCCL::wait() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
   synchronize();
   return true;
 }
@@ -132,16 +162,23 @@ void ProcessGroupNCCL::WorkNCCL::synchronize() {
 }
 
 bool ProcessGroupNCCL::WorkNCCL::isSuccess() const {
-  return true;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return exception_ == nullptr;
 }
 
 const std::exception& ProcessGroupNCCL::WorkNCCL::exception() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
   throw std::runtime_error(
-      "exception() is not supported by NCCL process "
-      "group's work, since isSuccess() will always return true, and "
-      "isCompleted() and wait() will either succeed or throw");
+      "exception() is only supported by NCCL process group's work if "
+      "isSuccess() returned false");
 }
 
+constexpr std::chrono::milliseconds ProcessGroupNCCL::kNoTimeout;
+constexpr std::chrono::milliseconds ProcessGroupNCCL::kWatchdogInterval;
+
 std::unordered_map<ssize_t, ssize_t> ProcessGroupNCCL::pgUniqueNCCLIDCnt_;
 ssize_t ProcessGroupNCCL::processGroupCounter_ = -1;
 std::mutex ProcessGroupNCCL::pgTrackingLock_;
@@ -149,21 +186,98 @@ std::mutex ProcessGroupNCCL::pgTrackingLock_;
 ProcessGroupNCCL::ProcessGroupNCCL(
     const std::shared_ptr<Store>& store,
     int rank,
-    int size)
-    : ProcessGroup(rank, size), store_(store) {
+    int size,
+    const std::chrono::milliseconds& opTimeout)
+    : ProcessGroup(rank, size), store_(store), opTimeout_(opTimeout) {
   // Generate the Process Group ID for current PG, this needs to be identical
   // for all processes
   std::unique_lock<std::mutex> lock(pgTrackingLock_);
   ++processGroupCounter_;
   pgUniqueNCCLIDCnt_[processGroupCounter_] = -1;
   processGroupID_ = std::to_string(processGroupCounter_);
+  lock.unlock();
+
+  watchdogThread_ = std::thread(&ProcessGroupNCCL::watchdog, this);
 }
 
 ProcessGroupNCCL::~ProcessGroupNCCL() {
+  {
+    std::unique_lock<std::mutex> lock(watchdogMutex_);
+    terminateWatchdog_ = true;
+  }
+  watchdogCV_.notify_one();
+  watchdogThread_.join();
+
   std::unique_lock<std::mutex> lock(pgTrackingLock_);
   pgUniqueNCCLIDCnt_.erase(std::stoull(processGroupID_));
 }
 
+void ProcessGroupNCCL::watchdog() {
+  std::unique_lock<std::mutex> lock(watchdogMutex_);
+  while (!terminateWatchdog_) {
+    watchdogCV_.wait_for(
+        lock, kWatchdogInterval, [&]() { return terminateWatchdog_; });
+
+    // Poll the work without holding the lock, so that queueing new work
+    // never waits for CUDA
+    std::list<std::shared_ptr<WorkNCCL>> workList;
+    workList.swap(workList_);
+    lock.unlock();
+
+    for (auto it = workList.begin(); it != workList.end();) {
+      auto& work = *it;
+      std::exception_ptr exception;
+      try {
+        if (work->finishedGPUExecution()) {
+          it = workList.erase(it);
+          continue;
+        }
+        exception = work->checkForErrors(opTimeout_);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+      if (!exception) {
+        ++it;
+        continue;
+      }
+
+      work->setException(exception);
+      for (auto& ncclComm : work->ncclComms_) {
+        try {
+          ncclComm->ncclCommAbort();
+        } catch (...) {
+          // The work already failed; there's nothing more to do
+        }
+      }
+      {
+        std::lock_guard<std::mutex> guard(watchdogMutex_);
+        if (!watchdogException_) {
+          watchdogException_ = exception;
+        }
+      }
+      it = workList.erase(it);
+    }
+
+    lock.lock();
+    workList_.splice(workList_.begin(), workList);
+  }
+}
+
+void ProcessGroupNCCL::checkForWatchdogError() {
+  std::lock_guard<std::mutex> lock(watchdogMutex_);
+  if (watchdogException_) {
+    std::rethrow_exception(watchdogException_);
+  }
+}
+
+void ProcessGroupNCCL::enqueueWork(
+    const std::shared_ptr<WorkNCCL>& work,
+    const std::vector<std::shared_ptr<NCCLComm>>& ncclComms) {
+  work->ncclComms_ = ncclComms;
+  std::lock_guard<std::mutex> lock(watchdogMutex_);
+  workList_.push_back(work);
+}
+
 void ProcessGroupNCCL::broadcastUniqueNCCLID(ncclUniqueId* ncclID) {
   // Every time when we create a new unique NCCL ID, we need to use a new
   // global key to access/update the store.
@@ -351,6 +465,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
     const AllreduceOptions& opts) {
   tensorCheckHelper(tensors, tensors);
 
+  checkForWatchdogError();
+
   auto devices = getDeviceList(tensors);
   auto key = getKeyFromDevices(devices);
   auto& ncclComms = getNCCLComm(key, devices);
@@ -390,6 +506,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
     work->cudaEvents_[i].record(ncclStream);
   }
 
+  enqueueWork(work, ncclComms);
   return work;
 }
 
@@ -398,6 +515,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
     const BroadcastOptions& opts) {
   tensorCheckHelper(tensors, tensors);
 
+  checkForWatchdogError();
+
   auto devices = getDeviceList(tensors);
   auto key = getKeyFromDevices(devices);
   auto& ncclComms = getNCCLComm(key, devices);
@@ -438,6 +557,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
     work->cudaEvents_[i].record(ncclStream);
   }
 
+  enqueueWork(work, ncclComms);
   return work;
 }
 
@@ -446,6 +566,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
     const ReduceOptions& opts) {
   tensorCheckHelper(tensors, tensors);
 
+  checkForWatchdogError();
+
   auto devices = getDeviceList(tensors);
   auto key = getKeyFromDevices(devices);
   auto& ncclComms = getNCCLComm(key, devices);
@@ -488,6 +610,7 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
     work->cudaEvents_[i].record(ncclStream);
   }
 
+  enqueueWork(work, ncclComms);
   return work;
 }
 
@@ -514,6 +637,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
     }
   }
 
+  checkForWatchdogError();
+
   auto devices = getDeviceList(inputTensors);
   auto key = getKeyFromDevices(devices);
   auto& ncclComms = getNCCLComm(key, devices);
@@ -561,9 +686,185 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
     at::cuda::CUDAStream& ncclStream = ncclStreams_[key][i];
     work->cudaEvents_[i].record(ncclStream);
   }
+
+  enqueueWork(work, ncclComms);
   return work;
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduceScatter(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensors,
+    const ReduceScatterOptions& opts) {
+  if (outputTensors.size() != inputTensors.size()) {
+    throw std::runtime_error("reduceScatter: input and output size mismatch");
+  }
+
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    tensorCheckHelper(
+        std::vector<at::Tensor>{outputTensors[i]},
+        inputTensors[i],
+        size_ * outputTensors.size());
+  }
+
+  checkForWatchdogError();
+
+  auto devices = getDeviceList(outputTensors);
+  auto key = getKeyFromDevices(devices);
+  auto& ncclComms = getNCCLComm(key, devices);
+
+  // First let NCCL streams wait for current streams
+  syncStreams(devices, ncclEvents_[key], ncclStreams_[key]);
+
+  // Work itself will create the CUDA events on all GPUs of tensors
+  auto work = std::make_shared<ProcessGroupNCCL::WorkNCCL>(devices);
+
+  // Flatten the input tensors (for all ranks) into a single big tensor. It is
+  // allocated on the NCCL stream, so its memory isn't reused before the
+  // NCCL kernels are done with it.
+  std::vector<at::Tensor> flattenInputTensors;
+  flattenInputTensors.resize(inputTensors.size());
+  for (size_t i = 0; i < inputTensors.size(); ++i) {
+    at::cuda::CUDAStream& ncclStream = ncclStreams_[key][i];
+    at::cuda::CUDAStreamGuard guard(ncclStream);
+    flattenInputTensors[i] = newLikeFlat(inputTensors, i);
+    for (size_t j = 0; j < inputTensors[0].size(); ++j) {
+      flattenInputTensors[i][j].copy_(inputTensors[i][j], true);
+    }
+  }
+
+  at::cuda::OptionalCUDAGuard gpuGuard;
+
+  std::unique_lock<std::mutex> cudaFreeMutexLock(
+      *(THCCachingAllocator_getCudaFreeMutex()));
+
+  C10D_NCCL_CHECK(ncclGroupStart());
+
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    gpuGuard.set_index(devices[i].index());
+
+    at::cuda::CUDAStream& ncclStream = ncclStreams_[key][i];
+
+    C10D_NCCL_CHECK(ncclReduceScatter(
+        flattenInputTensors[i].data_ptr(),
+        outputTensors[i].data_ptr(),
+        outputTensors[i].numel(),
+        getNcclDataType(outputTensors[i].type().scalarType()),
+        ncclOp[opts.reduceOp],
+        ncclComms[i]->getNcclComm(),
+        ncclStream.stream()));
+  }
+
+  C10D_NCCL_CHECK(ncclGroupEnd());
+
+  // Event should only be recorded after the ncclGroupEnd()
+  for (size_t i = 0; i < outputTensors.size(); ++i) {
+    at::cuda::CUDAStream& ncclStream = ncclStreams_[key][i];
+    work->cudaEvents_[i].record(ncclStream);
+  }
+
+  enqueueWork(work, ncclComms);
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+#ifdef ENABLE_NCCL_P2P_SUPPORT
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupNCCL::alltoall: " + msg);
+  };
+
+  if (!inputTensor.is_cuda() || inputTensor.is_sparse() ||
+      !outputTensor.is_cuda() || outputTensor.is_sparse()) {
+    invalidArgument("only supports dense CUDA tensors");
+  }
+  if (inputTensor.type() != outputTensor.type()) {
+    invalidArgument("input and output tensors must have the same type");
+  }
+  if (inputTensor.get_device() != outputTensor.get_device()) {
+    invalidArgument("input and output tensors must be on the same device");
+  }
+
+  std::vector<int64_t> outputLengths, outputOffsets;
+  std::vector<int64_t> inputLengths, inputOffsets;
+  computeLengthsAndOffsets(
+      invalidArgument,
+      outputSplitSizes,
+      outputTensor,
+      size_,
+      &outputLengths,
+      &outputOffsets);
+  computeLengthsAndOffsets(
+      invalidArgument,
+      inputSplitSizes,
+      inputTensor,
+      size_,
+      &inputLengths,
+      &inputOffsets);
+
+  checkForWatchdogError();
+
+  auto devices = getDeviceList({inputTensor});
+  auto key = getKeyFromDevices(devices);
+  auto& ncclComms = getNCCLComm(key, devices);
+
+  // First let NCCL streams wait for current streams
+  syncStreams(devices, ncclEvents_[key], ncclStreams_[key]);
+
+  // Work itself will create the CUDA events on all GPUs of tensors
+  auto work = std::make_shared<ProcessGroupNCCL::WorkNCCL>(devices);
+
+  at::cuda::OptionalCUDAGuard gpuGuard;
+  gpuGuard.set_index(devices[0].index());
+
+  std::unique_lock<std::mutex> cudaFreeMutexLock(
+      *(THCCachingAllocator_getCudaFreeMutex()));
+
+  at::cuda::CUDAStream& ncclStream = ncclStreams_[key][0];
+  const auto dataType = getNcclDataType(inputTensor.type().scalarType());
+  const auto elementSize = inputTensor.type().elementSizeInBytes();
+  auto input = static_cast<char*>(inputTensor.data_ptr());
+  auto output = static_cast<char*>(outputTensor.data_ptr());
+
+  // All sends and receives are issued as a single group, so they don't
+  // deadlock on each other. Empty slices are skipped on both ends.
+  C10D_NCCL_CHECK(ncclGroupStart());
+  for (int r = 0; r < size_; ++r) {
+    if (inputLengths[r] > 0) {
+      C10D_NCCL_CHECK(ncclSend(
+          input + inputOffsets[r] * elementSize,
+          inputLengths[r],
+          dataType,
+          r,
+          ncclComms[0]->getNcclComm(),
+          ncclStream.stream()));
+    }
+    if (outputLengths[r] > 0) {
+      C10D_NCCL_CHECK(ncclRecv(
+          output + outputOffsets[r] * elementSize,
+          outputLengths[r],
+          dataType,
+          r,
+          ncclComms[0]->getNcclComm(),
+          ncclStream.stream()));
+    }
+  }
+  C10D_NCCL_CHECK(ncclGroupEnd());
+
+  // Event should only be recorded after the ncclGroupEnd()
+  work->cudaEvents_[0].record(ncclStream);
+
+  enqueueWork(work, ncclComms);
+  return work;
+#else
+  throw std::runtime_error(
+      "ProcessGroupNCCL::alltoall requires NCCL 2.7 or later");
+#endif
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::barrier() {
   std::vector<at::Device> devices;
   if (usedDeviceIdxs_.empty()) {
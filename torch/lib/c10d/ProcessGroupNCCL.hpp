@@ -1,6 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <list>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #include <c10d/NCCLUtils.hpp>
@@ -31,12 +36,20 @@ namespace c10d {
 // either WorkNCCL::wait() or WorkNCCL::synchronize(), both achieves the same
 // functionality and are synonyms.
 //
-// Note that WorkNCCL::isSuccess() and WorkNCCL::isCompleted() will always
-// return true since ProcessGroupNCCL is single threaded. Every single NCCL
-// or CUDA failure will simply raise std::runtime_error.
+// Note that WorkNCCL::isCompleted() will always return true since
+// ProcessGroupNCCL is single threaded. Every single NCCL or CUDA failure
+// when queueing an operation will simply raise std::runtime_error.
 //
-// Therefore, WorkNCCL::exception() is not supported since isSuccess() always
-// returns true.
+// Operations that fail or hang once they're running on the GPU are detected
+// by a watchdog thread, which polls the CUDA events of all outstanding work
+// (so there's no host synchronization on the hot path). If the NCCL
+// communicator reports an asynchronous error, or if the operation doesn't
+// finish within the timeout given to the constructor, the watchdog aborts
+// the communicators of the work (with NCCL 2.4 and later, which makes the
+// stuck kernels exit). The work then fails: isSuccess() returns false,
+// exception() returns the error and wait() throws it. All following calls
+// on the process group throw the error as well, since its communicators
+// can't be used anymore.
 //
 // Also note that WorkNCCL::finishedGPUExecution() is a helper function only
 // provided by ProcessGroupNCCL to check if the NCCL operation of WorkNCCL has
@@ -72,13 +85,13 @@ class ProcessGroupNCCL : public ProcessGroup {
     // Non-blocking operation
     bool wait() override;
 
-    // Will always return true
+    // Returns false if the watchdog found that the work failed
     bool isSuccess() const override;
 
     // Same as wait()
     void synchronize() override;
 
-    // Not supported by WorkNCCL
+    // Only supported if isSuccess() returned false
     const std::exception& exception() const override;
 
     // Helper function that checks if the NCCL kernels have finished
@@ -86,9 +99,27 @@ class ProcessGroupNCCL : public ProcessGroup {
     bool finishedGPUExecution() const;
 
    protected:
+    // Returns the error of the work if its communicators failed, or if it
+    // has been running for longer than timeout (unless timeout is zero)
+    std::exception_ptr checkForErrors(
+        const std::chrono::milliseconds& timeout) const;
+
+    // Fails the work (called by the watchdog)
+    void setException(std::exception_ptr exception);
+
     // The cached list of CUDA devices to operate on
     std::vector<at::Device> devices_;
 
+    // The communicators the work runs on, so the watchdog can abort them
+    std::vector<std::shared_ptr<NCCLComm>> ncclComms_;
+
+    // When the work was queued
+    std::chrono::steady_clock::time_point workStartTime_;
+
+    // Set by the watchdog if the work failed
+    mutable std::mutex mutex_;
+    std::exception_ptr exception_;
+
     // The CUDA events tracking this work item on multiple CUDA devices
     std::vector<at::cuda::CUDAEvent> cudaEvents_;
 
@@ -98,8 +129,17 @@ class ProcessGroupNCCL : public ProcessGroup {
     friend class ProcessGroupNCCL;
   };
 
-  // Constructor will also check the number of available GPUs in the system
-  ProcessGroupNCCL(const std::shared_ptr<Store>& store, int rank, int size);
+  static constexpr std::chrono::milliseconds kNoTimeout =
+      std::chrono::milliseconds::zero();
+
+  // Constructor will also check the number of available GPUs in the system.
+  // Operations that don't finish on the GPU within opTimeout are aborted
+  // (see above); a zero opTimeout disables the timeout.
+  ProcessGroupNCCL(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      const std::chrono::milliseconds& opTimeout = kNoTimeout);
 
   virtual ~ProcessGroupNCCL();
 
@@ -119,6 +159,18 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors) override;
 
+  std::shared_ptr<ProcessGroup::Work> reduceScatter(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensors,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   // Unsupported Ops
   std::shared_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
@@ -159,6 +211,17 @@ class ProcessGroupNCCL : public ProcessGroup {
       const std::string& devicesKey,
       const std::vector<at::Device>& devices);
 
+  // Throws the error found by the watchdog, if any
+  void checkForWatchdogError();
+
+  // Hands the work over to the watchdog, once its CUDA events are recorded
+  void enqueueWork(
+      const std::shared_ptr<WorkNCCL>& work,
+      const std::vector<std::shared_ptr<NCCLComm>>& ncclComms);
+
+  // Polls the outstanding work for errors and timeouts
+  void watchdog();
+
   // Tensor checker helper
   void tensorCheckHelper(
       const std::vector<at::Tensor>& input,
@@ -203,6 +266,24 @@ class ProcessGroupNCCL : public ProcessGroup {
   // Device Indexes used for all collectives in this group
   std::set<int> usedDeviceIdxs_;
 
+  // Timeout of every operation, zero if disabled
+  const std::chrono::milliseconds opTimeout_;
+
+  // How often the watchdog polls the outstanding work
+  static constexpr std::chrono::milliseconds kWatchdogInterval =
+      std::chrono::milliseconds(100);
+
+  // Guards the watchdog state below
+  std::mutex watchdogMutex_;
+  std::condition_variable watchdogCV_;
+  bool terminateWatchdog_ = false;
+  // Work that may still be running on the GPU
+  std::list<std::shared_ptr<WorkNCCL>> workList_;
+  // The first error found by the watchdog
+  std::exception_ptr watchdogException_;
+
+  std::thread watchdogThread_;
+
   // processGroupID tracking
   static std::mutex pgTrackingLock_;
   static std::unordered_map<ssize_t, ssize_t> pgUniqueNCCLIDCnt_;
@@ -27,6 +27,25 @@ class Store {
 
   virtual int64_t add(const std::string& key, int64_t value) = 0;
 
+  // Sets all keys in one request, if the store supports batching (by
+  // default, they're set one by one).
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  // Gets all keys in one request, if the store supports batching (by
+  // default, they're read one by one). Waits for all keys to be set.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // Atomically sets key to desiredValue if its current value is
+  // expectedValue, where a key that isn't set compares equal to an empty
+  // value. Returns the value of key after the operation.
+  virtual std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue);
+
   virtual bool check(const std::vector<std::string>& keys) = 0;
 
   virtual void wait(const std::vector<std::string>& keys) = 0;
@@ -1,6 +1,6 @@
 #include "TCPStore.hpp"
 
-#include <poll.h>
+#include <sys/epoll.h>
 
 #include <unistd.h>
 #include <algorithm>
@@ -10,37 +10,84 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_SET,
+  MULTI_GET,
+  COMPARE_SET
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+void sendKeys(int socket, const std::vector<std::string>& keys, bool moreData) {
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(socket, &nkeys, 1, (nkeys > 0) || moreData);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(socket, keys[i], (i != (nkeys - 1)) || moreData);
+  }
+}
+
+std::vector<std::string> recvKeys(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  return keys;
+}
+
 } // anonymous namespace
 
 // TCPStoreDaemon class methods
-// Simply start the daemon thread
-TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
+// Simply start the worker threads
+TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket, size_t numWorkers)
     : storeListenSocket_(storeListenSocket) {
-  // Use control pipe to signal instance destruction to the daemon thread.
+  // Use control pipe to signal instance destruction to the worker threads.
   if (pipe(controlPipeFd_.data()) == -1) {
     throw std::runtime_error(
         "Failed to create the control pipe to start the "
         "TCPStoreDaemon run");
   }
-  daemonThread_ = std::thread(&TCPStoreDaemon::run, this);
+  SYSCHECK(epollFd_ = ::epoll_create1(EPOLL_CLOEXEC));
+
+  // The listening socket is one-shot too, so that only one worker accepts
+  // each new connection
+  struct epoll_event listenEvent = {};
+  listenEvent.events = EPOLLIN | EPOLLONESHOT;
+  listenEvent.data.fd = storeListenSocket_;
+  SYSCHECK(::epoll_ctl(
+      epollFd_, EPOLL_CTL_ADD, storeListenSocket_, &listenEvent));
+  // The read end of the pipe is level-triggered, so that all workers see it
+  // hang up
+  struct epoll_event controlEvent = {};
+  controlEvent.events = EPOLLHUP;
+  controlEvent.data.fd = controlPipeFd_[0];
+  SYSCHECK(::epoll_ctl(
+      epollFd_, EPOLL_CTL_ADD, controlPipeFd_[0], &controlEvent));
+
+  for (size_t i = 0; i < std::max<size_t>(numWorkers, 1); i++) {
+    workerThreads_.emplace_back(&TCPStoreDaemon::run, this);
+  }
 }
 
 TCPStoreDaemon::~TCPStoreDaemon() {
   // Stop the run
   stop();
-  // Join the thread
+  // Join the threads
   join();
   // Close unclosed sockets
   for (auto socket : sockets_) {
-    if (socket != -1) {
-      ::close(socket);
-    }
+    ::close(socket);
+  }
+  if (epollFd_ != -1) {
+    ::close(epollFd_);
   }
   // Now close the rest control pipe
   for (auto fd : controlPipeFd_) {
@@ -51,106 +98,77 @@ TCPStoreDaemon::~TCPStoreDaemon() {
 }
 
 void TCPStoreDaemon::join() {
-  daemonThread_.join();
+  for (auto& thread : workerThreads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+size_t TCPStoreDaemon::defaultNumWorkers() {
+  // Queries are short, so a few workers are enough to keep up with
+  // thousands of clients
+  return std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), 8);
 }
 
 void TCPStoreDaemon::run() {
-  std::vector<struct pollfd> fds;
-  fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
-  // Push the read end of the pipe to signal the stopping of the daemon run
-  fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
-
-  // receive the queries
-  bool finished = false;
-  while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
+  while (true) {
+    struct epoll_event event;
+    int numEvents;
+    SYSCHECK(numEvents = ::epoll_wait(epollFd_, &event, 1, -1));
+    if (numEvents == 0) {
+      continue;
     }
+    const int fd = event.data.fd;
 
-    SYSCHECK(::poll(fds.data(), fds.size(), -1));
-
-    // TCPStore's listening socket has an event and it should now be able to
-    // accept new connections.
-    if (fds[0].revents != 0) {
-      if (fds[0].revents ^ POLLIN) {
+    // The pipe receives an event which tells us to shutdown the daemon
+    if (fd == controlPipeFd_[0]) {
+      // Will be EPOLLHUP when the pipe is closed
+      if (event.events ^ EPOLLHUP) {
         throw std::system_error(
             ECONNABORTED,
             std::system_category(),
-            "Unexpected poll revent on the master's listening socket: " +
-                std::to_string(fds[0].revents));
+            "Unexpected epoll event on the control pipe's reading fd: " +
+                std::to_string(event.events));
       }
-      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
+      break;
     }
-    // The pipe receives an event which tells us to shutdown the daemon
-    if (fds[1].revents != 0) {
-      // Will be POLLUP when the pipe is closed
-      if (fds[1].revents ^ POLLHUP) {
+
+    // TCPStore's listening socket has an event and it should now be able to
+    // accept new connections.
+    if (fd == storeListenSocket_) {
+      if (event.events ^ EPOLLIN) {
         throw std::system_error(
             ECONNABORTED,
             std::system_category(),
-            "Unexpected poll revent on the control pipe's reading fd: " +
-                std::to_string(fds[1].revents));
+            "Unexpected epoll event on the master's listening socket: " +
+                std::to_string(event.events));
       }
-      finished = true;
-      break;
+      accept();
+      rearm(storeListenSocket_);
+      continue;
     }
-    // Skipping the fds[0] and fds[1],
-    // fds[0] is master's listening socket
-    // fds[1] is control pipe's reading fd
-    for (size_t fdIdx = 2; fdIdx < fds.size(); ++fdIdx) {
-      if (fds[fdIdx].revents == 0) {
-        continue;
-      }
 
-      if (fds[fdIdx].revents ^ POLLIN) {
+    // Now query the socket that has the event
+    try {
+      if (event.events ^ EPOLLIN) {
         throw std::system_error(
             ECONNABORTED,
             std::system_category(),
-            "Unexpected poll revent: " + std::to_string(fds[fdIdx].revents) +
-                " on socket: " + std::to_string(fds[fdIdx].fd));
-      }
-      // Now query the socket that has the event
-      try {
-        query(fds[fdIdx].fd);
-      } catch (...) {
-        // There was an error when processing query. Probably an exception
-        // occurred in recv/send what would indicate that socket on the other
-        // side has been closed. If the closing was due to normal exit, then
-        // the store should continue executing. Otherwise, if it was different
-        // exception, other connections will get an exception once they try to
-        // use the store. We will go ahead and close this connection whenever
-        // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
-        --fdIdx;
-        continue;
+            "Unexpected epoll event: " + std::to_string(event.events) +
+                " on socket: " + std::to_string(fd));
       }
+      query(fd);
+      rearm(fd);
+    } catch (...) {
+      // There was an error when processing query. Probably an exception
+      // occurred in recv/send what would indicate that socket on the other
+      // side has been closed. If the closing was due to normal exit, then
+      // the store should continue executing. Otherwise, if it was different
+      // exception, other connections will get an exception once they try to
+      // use the store. We will go ahead and close this connection whenever
+      // we hit an exception here.
+      closeSocket(fd);
     }
   }
 }
@@ -163,11 +181,63 @@ void TCPStoreDaemon::stop() {
   }
 }
 
+void TCPStoreDaemon::accept() {
+  int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sockets_.insert(sockFd);
+  }
+  struct epoll_event event = {};
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.fd = sockFd;
+  try {
+    SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_ADD, sockFd, &event));
+  } catch (...) {
+    closeSocket(sockFd);
+  }
+}
+
+// Sockets are registered one-shot; listen for the next event once the
+// current one has been handled
+void TCPStoreDaemon::rearm(int socket) {
+  struct epoll_event event = {};
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.fd = socket;
+  SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_MOD, socket, &event));
+}
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, socket, nullptr);
+  ::close(socket);
+
+  // Remove all the tracking state of the close FD
+  for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
+    for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
+      if (*vecIt == socket) {
+        vecIt = it->second.erase(vecIt);
+      } else {
+        ++vecIt;
+      }
+    }
+    if (it->second.size() == 0) {
+      it = waitingSockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  keysAwaited_.erase(socket);
+  sockets_.erase(socket);
+}
+
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
-// type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of wait, check and the multi-key queries
+// type of query | number of keys | size of key1 | key1 | ... | values ...
+//
+// The arguments are received without holding mutex_, so that slow clients
+// don't hold up the others.
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
@@ -187,6 +257,15 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::COMPARE_SET) {
+    compareSetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
@@ -197,8 +276,14 @@ void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
   if (socketsToWait != waitingSockets_.end()) {
     for (int socket : socketsToWait->second) {
       if (--keysAwaited_[socket] == 0) {
-        tcputil::sendValue<WaitResponseType>(
-            socket, WaitResponseType::STOP_WAITING);
+        keysAwaited_.erase(socket);
+        try {
+          tcputil::sendValue<WaitResponseType>(
+              socket, WaitResponseType::STOP_WAITING);
+        } catch (...) {
+          // The waiting client is gone; the worker watching its socket
+          // cleans it up
+        }
       }
     }
     waitingSockets_.erase(socketsToWait);
@@ -207,43 +292,102 @@ void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
 
 void TCPStoreDaemon::setHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+  auto value = tcputil::recvVector<uint8_t>(socket);
+  std::lock_guard<std::mutex> lock(mutex_);
+  tcpStore_[key] = std::move(value);
   // On "set", wake up all clients that have been waiting
   wakeupWaitingClients(key);
 }
 
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  auto keys = recvKeys(socket);
+  std::vector<std::vector<uint8_t>> values(keys.size());
+  for (auto& value : values) {
+    value = tcputil::recvVector<uint8_t>(socket);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < keys.size(); i++) {
+    tcpStore_[keys[i]] = std::move(values[i]);
+    wakeupWaitingClients(keys[i]);
+  }
+}
+
+void TCPStoreDaemon::compareSetHandler(int socket) {
+  std::string key = tcputil::recvString(socket);
+  auto expectedValue = tcputil::recvVector<uint8_t>(socket);
+  auto desiredValue = tcputil::recvVector<uint8_t>(socket);
+  std::vector<uint8_t> currentValue;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tcpStore_.find(key);
+    const bool matches = it == tcpStore_.end() ? expectedValue.empty()
+                                               : it->second == expectedValue;
+    if (matches) {
+      tcpStore_[key] = desiredValue;
+      currentValue = std::move(desiredValue);
+      wakeupWaitingClients(key);
+    } else if (it != tcpStore_.end()) {
+      currentValue = it->second;
+    }
+  }
+  tcputil::sendVector<uint8_t>(socket, currentValue);
+}
+
 void TCPStoreDaemon::addHandler(int socket) {
   std::string key = tcputil::recvString(socket);
   int64_t addVal = tcputil::recvValue<int64_t>(socket);
 
-  if (tcpStore_.find(key) != tcpStore_.end()) {
-    auto buf = reinterpret_cast<const char*>(tcpStore_[key].data());
-    auto len = tcpStore_[key].size();
-    addVal += std::stoll(std::string(buf, len));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tcpStore_.find(key);
+    if (it != tcpStore_.end()) {
+      auto buf = reinterpret_cast<const char*>(it->second.data());
+      auto len = it->second.size();
+      addVal += std::stoll(std::string(buf, len));
+    }
+    auto addValStr = std::to_string(addVal);
+    tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
+    // On "add", wake up all clients that have been waiting
+    wakeupWaitingClients(key);
   }
-  auto addValStr = std::to_string(addVal);
-  tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
   // Now send the new value
   tcputil::sendValue<int64_t>(socket, addVal);
-  // On "add", wake up all clients that have been waiting
-  wakeupWaitingClients(key);
 }
 
-void TCPStoreDaemon::getHandler(int socket) const {
+void TCPStoreDaemon::getHandler(int socket) {
   std::string key = tcputil::recvString(socket);
-  auto data = tcpStore_.at(key);
+  std::vector<uint8_t> data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    data = tcpStore_.at(key);
+  }
   tcputil::sendVector<uint8_t>(socket, data);
 }
 
-void TCPStoreDaemon::checkHandler(int socket) const {
-  SizeType nargs;
-  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
-  std::vector<std::string> keys(nargs);
-  for (size_t i = 0; i < nargs; i++) {
-    keys[i] = tcputil::recvString(socket);
+void TCPStoreDaemon::multiGetHandler(int socket) {
+  auto keys = recvKeys(socket);
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& key : keys) {
+      values.push_back(tcpStore_.at(key));
+    }
   }
+  for (size_t i = 0; i < values.size(); i++) {
+    tcputil::sendVector<uint8_t>(socket, values[i], i != (values.size() - 1));
+  }
+}
+
+void TCPStoreDaemon::checkHandler(int socket) {
+  auto keys = recvKeys(socket);
   // Now we have received all the keys
-  if (checkKeys(keys)) {
+  bool ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready = checkKeys(keys);
+  }
+  if (ready) {
     tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::READY);
   } else {
     tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::NOT_READY);
@@ -251,20 +395,21 @@ void TCPStoreDaemon::checkHandler(int socket) const {
 }
 
 void TCPStoreDaemon::waitHandler(int socket) {
-  SizeType nargs;
-  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
-  std::vector<std::string> keys(nargs);
-  for (size_t i = 0; i < nargs; i++) {
-    keys[i] = tcputil::recvString(socket);
-  }
+  auto keys = recvKeys(socket);
+  std::lock_guard<std::mutex> lock(mutex_);
   if (checkKeys(keys)) {
     tcputil::sendValue<WaitResponseType>(
         socket, WaitResponseType::STOP_WAITING);
   } else {
+    // Only wait for the keys that aren't set yet
+    size_t numAwaited = 0;
     for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+      if (tcpStore_.count(key) == 0) {
+        waitingSockets_[key].push_back(socket);
+        numAwaited++;
+      }
     }
-    keysAwaited_[socket] = keys.size();
+    keysAwaited_[socket] = numAwaited;
   }
 }
 
@@ -323,13 +468,46 @@ int64_t TCPStore::add(const std::string& key, int64_t value) {
   return tcputil::recvValue<int64_t>(storeSocket_);
 }
 
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument("multiSet requires as many values as keys");
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET);
+  sendKeys(storeSocket_, keys, !values.empty());
+  for (size_t i = 0; i < values.size(); i++) {
+    tcputil::sendVector<uint8_t>(
+        storeSocket_, values[i], i != (values.size() - 1));
+  }
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  wait(keys);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET);
+  sendKeys(storeSocket_, keys, false);
+  std::vector<std::vector<uint8_t>> values(keys.size());
+  for (auto& value : values) {
+    value = tcputil::recvVector<uint8_t>(storeSocket_);
+  }
+  return values;
+}
+
+std::vector<uint8_t> TCPStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::COMPARE_SET);
+  tcputil::sendString(storeSocket_, key, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, expectedValue, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, desiredValue);
+  return tcputil::recvVector<uint8_t>(storeSocket_);
+}
+
 bool TCPStore::check(const std::vector<std::string>& keys) {
   tcputil::sendValue<QueryType>(storeSocket_, QueryType::CHECK);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
-  }
+  sendKeys(storeSocket_, keys, false);
   auto checkResponse = tcputil::recvValue<CheckResponseType>(storeSocket_);
   if (checkResponse == CheckResponseType::READY) {
     return true;
@@ -359,11 +537,7 @@ void TCPStore::wait(
         sizeof(timeoutTV)));
   }
   tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
-  }
+  sendKeys(storeSocket_, keys, false);
   auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
   if (waitResponse != WaitResponseType::STOP_WAITING) {
     throw std::runtime_error("Stop_waiting response is expected");
@@ -1,45 +1,69 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <c10d/Store.hpp>
 #include <c10d/Utils.hpp>
 
 namespace c10d {
 
+// TCPStoreDaemon serves the store to all TCPStore clients.
+//
+// The client sockets are watched with epoll by a pool of worker threads.
+// Every socket is registered one-shot, so a query is handled by a single
+// worker, which reads it entirely, applies it under mutex_ and re-arms the
+// socket. Queries of different clients are handled concurrently.
 class TCPStoreDaemon {
  public:
-  explicit TCPStoreDaemon(int storeListenSocket);
+  explicit TCPStoreDaemon(
+      int storeListenSocket,
+      size_t numWorkers = defaultNumWorkers());
   ~TCPStoreDaemon();
 
   void join();
 
+  static size_t defaultNumWorkers();
+
  protected:
   void run();
   void stop();
 
+  void accept();
+  void rearm(int socket);
+  void closeSocket(int socket);
+
   void query(int socket);
 
   void setHandler(int socket);
+  void multiSetHandler(int socket);
+  void compareSetHandler(int socket);
   void addHandler(int socket);
-  void getHandler(int socket) const;
-  void checkHandler(int socket) const;
+  void getHandler(int socket);
+  void multiGetHandler(int socket);
+  void checkHandler(int socket);
   void waitHandler(int socket);
 
+  // The following require mutex_ to be held
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
 
-  std::thread daemonThread_;
+  std::vector<std::thread> workerThreads_;
+
+  // Guards all of the state below
+  std::mutex mutex_;
   std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
   // From key -> the list of sockets waiting on it
   std::unordered_map<std::string, std::vector<int>> waitingSockets_;
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
+  std::unordered_set<int> sockets_;
 
-  std::vector<int> sockets_;
   int storeListenSocket_;
+  int epollFd_ = -1;
   std::vector<int> controlPipeFd_{-1, -1};
 };
 
@@ -58,6 +82,18 @@ class TCPStore : public Store {
 
   int64_t add(const std::string& key, int64_t value) override;
 
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue) override;
+
   bool check(const std::vector<std::string>& keys) override;
 
   void wait(const std::vector<std::string>& keys) override;
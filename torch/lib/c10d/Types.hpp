@@ -28,12 +28,24 @@ struct AllreduceOptions {
   ReduceOp reduceOp = ReduceOp::SUM;
 };
 
+struct AllreduceCoalescedOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
+  // Upper bound on the size of every bucket, in bytes
+  int64_t bucketSize = 25 * 1024 * 1024;
+};
+
 struct ReduceOptions {
   ReduceOp reduceOp = ReduceOp::SUM;
   int rootRank = 0;
   int rootTensor = 0;
 };
 
+struct ReduceScatterOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
+};
+
+struct AllToAllOptions {};
+
 struct ScatterOptions {
   int rootRank = 0;
 };
@@ -195,6 +195,51 @@ inline void assertTypeAndSizesMatch(
   assertTypeAndSizesMatch(fn, tensors.slice(1), type, sizes);
 }
 
+// Checks the split sizes of an all-to-all over `size` processes along the
+// first dimension of `tensor`, and returns the number of elements of every
+// slice and the offset of its first element. Empty split sizes split the
+// tensor evenly.
+inline void computeLengthsAndOffsets(
+    std::function<void(const std::string&)> fn,
+    const std::vector<int64_t>& splitSizes,
+    const at::Tensor& tensor,
+    int size,
+    std::vector<int64_t>* lengths,
+    std::vector<int64_t>* offsets) {
+  const int64_t dim0 = tensor.dim() == 0 ? 1 : tensor.size(0);
+  const int64_t rowSize = dim0 == 0 ? 0 : tensor.numel() / dim0;
+  if (!tensor.is_contiguous()) {
+    fn("requires contiguous tensors");
+  }
+  if (splitSizes.empty()) {
+    if (dim0 % size != 0) {
+      fn("tensor's first dimension (" + std::to_string(dim0) +
+         ") isn't divisible by the group size (" + std::to_string(size) +
+         ")");
+    }
+  } else if (splitSizes.size() != static_cast<size_t>(size)) {
+    fn("requires one split size per process (expected " +
+       std::to_string(size) + ", got " + std::to_string(splitSizes.size()) +
+       ")");
+  }
+  lengths->resize(size);
+  offsets->resize(size);
+  int64_t offset = 0;
+  for (int i = 0; i < size; i++) {
+    const int64_t rows = splitSizes.empty() ? dim0 / size : splitSizes[i];
+    if (rows < 0) {
+      fn("invalid split size: " + std::to_string(rows));
+    }
+    (*lengths)[i] = rows * rowSize;
+    (*offsets)[i] = offset;
+    offset += (*lengths)[i];
+  }
+  if (offset != tensor.numel()) {
+    fn("split sizes don't add up to the tensor's first dimension (" +
+       std::to_string(dim0) + ")");
+  }
+}
+
 // Copied from torch/csrc/utils/functional.h.
 template <typename F, typename T>
 inline auto fmap(T& inputs, const F& fn)
@@ -0,0 +1,293 @@
+// Measures the latency and the bandwidth of the collectives of a process
+// group, for messages of sizes from --min-bytes to --max-bytes, doubling.
+// Every process of the group runs it, with the rank and size of the group in
+// the RANK and SIZE environment variables (or from mpirun for MPI), and the
+// processes meet through a FileStore at --store-path, as for the example:
+//
+//   RANK=0 SIZE=2 collective_benchmark --backend nccl --device cuda &
+//   RANK=1 SIZE=2 collective_benchmark --backend nccl --device cuda
+//
+// Rank 0 prints a CSV line per collective and size. The size is that of the
+// whole buffer of a collective: the tensor reduced or broadcast, the gathered
+// output of allgather, and the input of reduce_scatter, of which each rank
+// sends or receives a 1/SIZE slice. The algorithm bandwidth is the size over
+// the time of a collective, and the bus bandwidth scales it by the share of
+// the data each link carries in the optimal algorithm, as nccl-tests do:
+// 2 * (n - 1) / n for allreduce, (n - 1) / n for allgather and
+// reduce_scatter, and 1 for broadcast. Collectives a backend doesn't
+// implement are skipped.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gloo/transport/tcp/device.h>
+
+#include <c10d/FileStore.hpp>
+#include <c10d/ProcessGroupGloo.hpp>
+
+#ifdef USE_C10D_NCCL
+#include <c10d/ProcessGroupNCCL.hpp>
+#endif
+
+#ifdef USE_C10D_MPI
+#include <c10d/ProcessGroupMPI.hpp>
+#endif
+
+#ifdef USE_CUDA
+#include <cuda_runtime.h>
+#endif
+
+namespace {
+
+struct Config {
+  std::string backend = "gloo";
+  std::string device = "cpu";
+  std::vector<std::string> collectives = {
+      "allreduce", "broadcast", "allgather", "reduce_scatter"};
+  int64_t minBytes = 4;
+  int64_t maxBytes = 64 << 20;
+  int warmup = 5;
+  int iters = 20;
+  std::string storePath = "/tmp/c10d_benchmark";
+};
+
+std::vector<std::string> split(const std::string& s) {
+  std::vector<std::string> parts;
+  std::stringstream stream(s);
+  std::string part;
+  while (std::getline(stream, part, ',')) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+void usage(const char* argv0) {
+  std::cerr << "usage: " << argv0
+            << " [--backend gloo|nccl|mpi] [--device cpu|cuda]"
+            << " [--collectives allreduce,broadcast,allgather,reduce_scatter]"
+            << " [--min-bytes N] [--max-bytes N] [--warmup N] [--iters N]"
+            << " [--store-path PATH]" << std::endl;
+  std::exit(1);
+}
+
+Config parseArgs(int argc, char** argv) {
+  Config config;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+    }
+    const std::string value = argv[++i];
+    if (arg == "--backend") {
+      config.backend = value;
+    } else if (arg == "--device") {
+      config.device = value;
+    } else if (arg == "--collectives") {
+      config.collectives = split(value);
+    } else if (arg == "--min-bytes") {
+      config.minBytes = std::stoll(value);
+    } else if (arg == "--max-bytes") {
+      config.maxBytes = std::stoll(value);
+    } else if (arg == "--warmup") {
+      config.warmup = std::stoi(value);
+    } else if (arg == "--iters") {
+      config.iters = std::stoi(value);
+    } else if (arg == "--store-path") {
+      config.storePath = value;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  return config;
+}
+
+int getEnvInt(const char* name) {
+  const char* value = std::getenv(name);
+  if (value == nullptr) {
+    throw std::runtime_error(std::string(name) + " is not set");
+  }
+  return std::atoi(value);
+}
+
+std::shared_ptr<::c10d::ProcessGroup> createProcessGroup(
+    const Config& config) {
+  if (config.backend == "mpi") {
+#ifdef USE_C10D_MPI
+    return ::c10d::ProcessGroupMPI::createProcessGroupMPI();
+#else
+    throw std::runtime_error("c10d was built without MPI");
+#endif
+  }
+  const int rank = getEnvInt("RANK");
+  const int size = getEnvInt("SIZE");
+  auto store = std::make_shared<::c10d::FileStore>(config.storePath, size);
+  if (config.backend == "gloo") {
+    ::c10d::ProcessGroupGloo::Options options;
+    ::gloo::transport::tcp::attr attr;
+    options.devices.push_back(::gloo::transport::tcp::CreateDevice(attr));
+    return std::make_shared<::c10d::ProcessGroupGloo>(
+        store, rank, size, options);
+  }
+  if (config.backend == "nccl") {
+#ifdef USE_C10D_NCCL
+    return std::make_shared<::c10d::ProcessGroupNCCL>(store, rank, size);
+#else
+    throw std::runtime_error("c10d was built without NCCL");
+#endif
+  }
+  throw std::runtime_error("unknown backend " + config.backend);
+}
+
+// The share of the size of a collective that goes through each link in the
+// optimal algorithm, which turns the algorithm bandwidth into the bus
+// bandwidth
+double busFactor(const std::string& collective, int size) {
+  if (collective == "allreduce") {
+    return 2.0 * (size - 1) / size;
+  }
+  if (collective == "allgather" || collective == "reduce_scatter") {
+    return static_cast<double>(size - 1) / size;
+  }
+  return 1.0;
+}
+
+// Runs one kind of collective again and again on the same tensors
+class Collective {
+ public:
+  Collective(
+      ::c10d::ProcessGroup& pg,
+      const std::string& name,
+      at::TensorOptions options,
+      int64_t numel)
+      : pg_(pg), name_(name) {
+    const int size = pg.getSize();
+    const int64_t chunk = numel / size;
+    if (name == "allreduce" || name == "broadcast") {
+      tensors_ = {at::ones({numel}, options)};
+    } else if (name == "allgather") {
+      tensors_ = {at::ones({chunk}, options)};
+      outputs_.resize(1);
+      for (int i = 0; i < size; i++) {
+        outputs_[0].push_back(at::empty({chunk}, options));
+      }
+    } else if (name == "reduce_scatter") {
+      tensors_ = {at::empty({chunk}, options)};
+      outputs_.resize(1);
+      for (int i = 0; i < size; i++) {
+        outputs_[0].push_back(at::ones({chunk}, options));
+      }
+    } else {
+      throw std::runtime_error("unknown collective " + name);
+    }
+  }
+
+  void run() {
+    std::shared_ptr<::c10d::ProcessGroup::Work> work;
+    if (name_ == "allreduce") {
+      work = pg_.allreduce(tensors_);
+    } else if (name_ == "broadcast") {
+      work = pg_.broadcast(tensors_);
+    } else if (name_ == "allgather") {
+      work = pg_.allgather(outputs_, tensors_);
+    } else {
+      work = pg_.reduceScatter(tensors_, outputs_);
+    }
+    if (!work->wait()) {
+      throw std::runtime_error(work->exception().what());
+    }
+  }
+
+ private:
+  ::c10d::ProcessGroup& pg_;
+  const std::string name_;
+  std::vector<at::Tensor> tensors_;
+  // the outputs of allgather, the inputs of reduce_scatter
+  std::vector<std::vector<at::Tensor>> outputs_;
+};
+
+void synchronizeDevice(const Config& config) {
+#ifdef USE_CUDA
+  if (config.device == "cuda") {
+    cudaDeviceSynchronize();
+  }
+#endif
+}
+
+void barrier(::c10d::ProcessGroup& pg) {
+  pg.barrier()->wait();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const Config config = parseArgs(argc, argv);
+  auto pg = createProcessGroup(config);
+  const int rank = pg->getRank();
+  const int size = pg->getSize();
+
+  at::TensorOptions options = at::TensorOptions(at::kFloat);
+  if (config.device == "cuda") {
+    const int numGPUs = at::globalContext().getNumGPUs();
+    if (numGPUs == 0) {
+      throw std::runtime_error("no CUDA device");
+    }
+    options = options.device(at::Device(at::kCUDA, rank % numGPUs));
+  } else if (config.device != "cpu") {
+    throw std::runtime_error("unknown device " + config.device);
+  }
+
+  if (rank == 0) {
+    std::cout << "backend,device,collective,ranks,bytes,iters,"
+              << "avg_us,algbw_GBps,busbw_GBps" << std::endl;
+  }
+  const int64_t elementSize = sizeof(float);
+  for (const auto& name : config.collectives) {
+    for (int64_t bytes = config.minBytes; bytes <= config.maxBytes;
+         bytes *= 2) {
+      // whole elements, divided evenly between the ranks
+      const int64_t numel = std::max<int64_t>(bytes / elementSize / size, 1) * size;
+      Collective collective(*pg, name, options, numel);
+      try {
+        for (int i = 0; i < config.warmup; i++) {
+          collective.run();
+        }
+      } catch (const std::exception& e) {
+        if (rank == 0) {
+          std::cerr << "skipping " << name << ": " << e.what() << std::endl;
+        }
+        break;
+      }
+      synchronizeDevice(config);
+      barrier(*pg);
+
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < config.iters; i++) {
+        collective.run();
+      }
+      synchronizeDevice(config);
+      const auto end = std::chrono::steady_clock::now();
+      barrier(*pg);
+
+      if (rank == 0) {
+        const double seconds =
+            std::chrono::duration<double>(end - start).count() / config.iters;
+        const double actualBytes = numel * elementSize;
+        const double algbw = actualBytes / seconds / 1e9;
+        std::cout << config.backend << "," << config.device << "," << name
+                  << "," << size << "," << static_cast<int64_t>(actualBytes)
+                  << "," << config.iters << "," << seconds * 1e6 << ","
+                  << algbw << "," << algbw * busFactor(name, size)
+                  << std::endl;
+      }
+    }
+  }
+  return 0;
+}
@@ -20,6 +20,46 @@ void testHelper(const std::string& prefix = "") {
   c10d::test::check(serverStore, "key1", "value1");
   c10d::test::check(serverStore, "key2", "value2");
 
+  // Batched set/get
+  std::vector<std::string> multiKeys = {"multi0", "multi1", "multi2"};
+  std::vector<std::vector<uint8_t>> multiValues = {
+      {'a'}, {'b', 'c'}, std::vector<uint8_t>()};
+  serverStore.multiSet(multiKeys, multiValues);
+  if (serverStore.multiGet(multiKeys) != multiValues) {
+    throw std::runtime_error("multiGet returned wrong values");
+  }
+  c10d::test::check(serverStore, "multi1", "bc");
+
+  // Compare-and-set on a new key, with matching and mismatching values
+  auto toBytes = [](const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+  };
+  if (serverStore.compareSet("cas", toBytes(""), toBytes("first")) !=
+      toBytes("first")) {
+    throw std::runtime_error("compareSet didn't set a new key");
+  }
+  if (serverStore.compareSet("cas", toBytes("wrong"), toBytes("second")) !=
+      toBytes("first")) {
+    throw std::runtime_error("compareSet overwrote a mismatching value");
+  }
+  if (serverStore.compareSet("cas", toBytes("first"), toBytes("second")) !=
+      toBytes("second")) {
+    throw std::runtime_error("compareSet didn't set a matching value");
+  }
+
+  // Wait on a mix of keys that are set and keys that aren't set yet
+  {
+    c10d::TCPStore clientTCPStore("127.0.0.1", 29500, false);
+    c10d::PrefixStore clientStore(prefix, clientTCPStore);
+    std::thread waiter([&clientStore] {
+      clientStore.wait({"key0", "late"});
+      c10d::test::check(clientStore, "late", "value");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    c10d::test::set(serverStore, "late", "value");
+    waiter.join();
+  }
+
   // Hammer on TCPStore
   std::vector<std::thread> threads;
   const auto numThreads = 16;
@@ -44,6 +84,15 @@ void testHelper(const std::string& prefix = "") {
           for (auto j = 0; j < numIterations; j++) {
             clientStores[i]->add("counter", 1);
           }
+          // Only one thread may claim the key
+          std::string id = std::to_string(i);
+          auto owner = clientStores[i]->compareSet(
+              "owner",
+              std::vector<uint8_t>(),
+              std::vector<uint8_t>(id.begin(), id.end()));
+          if (std::string(owner.begin(), owner.end()) == id) {
+            clientStores[i]->add("owners", 1);
+          }
           // Let each thread set and get key on its client store
           std::string key = "thread_" + std::to_string(i);
           for (auto j = 0; j < numIterations; j++) {
@@ -81,6 +130,7 @@ void testHelper(const std::string& prefix = "") {
 
   // Check that the counter has the expected value
   c10d::test::check(serverStore, "counter", expectedCounterRes);
+  c10d::test::check(serverStore, "owners", "1");
 
   // Check that each threads' written data from the main thread
   for (auto i = 0; i < numThreads; i++) {
@@ -1,9 +1,16 @@
 #pragma once
 
 #include <unistd.h>
+#include <cstddef>
 
 struct AllocInfo {
   pid_t pid;
   char free;
+  // Together with free, the last reference to the segment was closed and the
+  // segment was left for the manager to pool or unlink. Without it, a request
+  // for a segment of the given size from the pool.
+  char pooled;
+  // The size class of the segment, or 0 if it is not to be pooled
+  size_t size;
   char filename[60];
 };
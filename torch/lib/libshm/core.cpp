@@ -1,3 +1,4 @@
+#include <sys/mman.h>
 #include <cstring>
 #include <string>
 #include <unordered_map>
@@ -14,6 +15,8 @@ AllocInfo get_alloc_info(const char* filename) {
   AllocInfo info = {0};
   info.pid = getpid();
   info.free = false;
+  info.pooled = false;
+  info.size = 0;
   size_t len = strlen(filename);
   if (len >= sizeof(info.filename)) {
     throw std::runtime_error("THMapAllocatorContext_filename too long");
@@ -74,41 +77,73 @@ ClientSocket& get_manager_socket(const std::string& manager_handle) {
   }
 }
 
+// Returns the socket of the given manager, or of the first manager if the
+// handle is empty, starting one if there is none, and sets the handle to it
+ClientSocket& get_or_start_manager_socket(std::string& manager_handle) {
+  if (!manager_handle.empty()) {
+    return get_manager_socket(manager_handle);
+  }
+  if (managers.size() == 0) {
+    start_manager();
+  }
+  const auto &manager = managers.begin();
+  manager_handle = manager->first;
+  return manager->second;
+}
+
+// Rounds the size of a new segment up to one of four sizes per power of two,
+// for the segment to be reused by later allocations of a similar size
+size_t segment_size_class(size_t size) {
+  const size_t page_size = 4096;
+  if (size <= page_size) {
+    return page_size;
+  }
+  size_t power = page_size;
+  while (power * 2 < size) {
+    power *= 2;
+  }
+  const size_t step = power / 4;
+  return (size + step - 1) / step * step;
+}
+
 void libshm_init(const char *manager_exec_path) {
   manager_executable_path = std::string(manager_exec_path);
 }
 
-THManagedMapAllocatorInit::THManagedMapAllocatorInit(const char* manager_handle, const char* filename)
+THManagedMapAllocatorInit::THManagedMapAllocatorInit(const char* manager_handle, const char* filename, size_t size_class, bool from_pool)
   : manager_handle_(manager_handle ? manager_handle : "") {
   // TODO: unlock GIL when contacting the manager
   try {
-    ClientSocket *socket;
-    if (!manager_handle_.empty()) {
-      socket = &get_manager_socket(manager_handle_);
-    } else {
-      if (managers.size() == 0) {
-        start_manager();
-      }
-      const auto &manager = managers.begin();
-      manager_handle_ = manager->first;
-      socket = &manager->second;
+    ClientSocket &socket = get_or_start_manager_socket(manager_handle_);
+    // the manager registered the segments of its pool when handing them out
+    if (!from_pool) {
+      AllocInfo info = get_alloc_info(filename);
+      info.size = size_class;
+      socket.register_allocation(info);
     }
-    AllocInfo info = get_alloc_info(filename);
-    socket->register_allocation(info);
   } catch(std::exception &e) {
     THError(e.what());
   }
 }
 
 THManagedMapAllocator::THManagedMapAllocator(const char *manager_handle, const char *filename, int flags, ptrdiff_t size)
-  : THManagedMapAllocatorInit(manager_handle, filename), THRefcountedMapAllocator(filename, flags, size) {}
+  : THManagedMapAllocator(manager_handle, filename, flags, size, /*size_class=*/0, /*from_pool=*/false) {}
+
+THManagedMapAllocator::THManagedMapAllocator(const char *manager_handle, const char *filename, int flags, ptrdiff_t size, size_t size_class, bool from_pool)
+  : THManagedMapAllocatorInit(manager_handle, filename, size_class, from_pool), THRefcountedMapAllocator(filename, flags, size) {}
 
 void THManagedMapAllocator::close() {
   if (closed_) return;
+  closed_ = true;
   AllocInfo info = get_alloc_info(filename());
   info.free = true;
   ClientSocket &socket = get_manager_socket(manager_handle_);
-  THRefcountedMapAllocator::close();
+  // Unlike THRefcountedMapAllocator, this leaves the segment for the manager to
+  // unlink or to pool once its last reference is closed
+  info.pooled = decref();
+  if (munmap(base_ptr_, size_)) {
+    AT_ERROR("could not unmap the shared memory file ", filename_);
+  }
   socket.register_deallocation(info);
 }
 
@@ -117,7 +152,33 @@ static void deleteTHManagedMapAllocator(void* ptr) {
 }
 
 at::DataPtr THManagedMapAllocator::makeDataPtr(const char* manager_handle, const char* filename, int flags, ptrdiff_t size) {
-  auto* context = new THManagedMapAllocator(manager_handle, filename, flags, size);
+  THManagedMapAllocator* context;
+  if (flags & TH_ALLOCATOR_MAPPED_EXCLUSIVE) {
+    // A new segment, taken from the pool of the manager if it has one of the
+    // right size class
+    std::string handle = manager_handle ? manager_handle : "";
+    const size_t size_class = segment_size_class(size);
+    std::string pooled;
+    try {
+      AllocInfo info = get_alloc_info("");
+      info.pooled = true;
+      info.size = size_class;
+      pooled = get_or_start_manager_socket(handle).acquire_pooled(info);
+    } catch(std::exception &e) {
+      THError(e.what());
+    }
+    if (!pooled.empty()) {
+      context = new THManagedMapAllocator(
+          handle.c_str(), pooled.c_str(),
+          TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE,
+          size_class, size_class, /*from_pool=*/true);
+    } else {
+      context = new THManagedMapAllocator(
+          handle.c_str(), filename, flags, size_class, size_class, /*from_pool=*/false);
+    }
+  } else {
+    context = new THManagedMapAllocator(manager_handle, filename, flags, size);
+  }
   return {context->data(), context, &deleteTHManagedMapAllocator, at::DeviceType::CPU};
 }
 
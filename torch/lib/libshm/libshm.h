@@ -9,13 +9,19 @@ void libshm_init(const char *manager_exec_path);
 // Superclass to run a constructor before THRefcountedMapAllocator
 class THManagedMapAllocatorInit {
 protected:
-  THManagedMapAllocatorInit(const char* manager_handle, const char* filename);
+  THManagedMapAllocatorInit(const char* manager_handle, const char* filename, size_t size_class, bool from_pool);
   std::string manager_handle_;
 };
 
 // Like a THRefcountedMapAllocator, but it also makes use of an external
 // shared memory manager process to ensure that shared memory regions actually
 // get freed in the end (even if processes lose the memory).
+//
+// The segments created by makeDataPtr are rounded up to a size class. When
+// their last reference is closed, they go back to a pool kept by the manager
+// rather than being unlinked, and later segments of the same size class are
+// taken from the pool, which saves creating, resizing and faulting in a new
+// segment for every tensor sent between processes.
 class THManagedMapAllocator : private THManagedMapAllocatorInit, public THRefcountedMapAllocator {
 public:
   THManagedMapAllocator(const char* manager_handle, const char* filename, int flags, ptrdiff_t size);
@@ -28,6 +34,9 @@ public:
   static THManagedMapAllocator* fromDataPtr(const at::DataPtr&);
 
   const char* manager_handle() const { return manager_handle_.c_str(); }
+
+private:
+  THManagedMapAllocator(const char* manager_handle, const char* filename, int flags, ptrdiff_t size, size_t size_class, bool from_pool);
 };
 
 #endif
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <memory>
 #include <unordered_map>
+#include <chrono>
+#include <string>
 
 #include <torch/csrc/utils/tempfile.h>
 #include <c10/util/Optional.h>
@@ -16,6 +18,9 @@
 #include "socket.h"
 
 const int SHUTDOWN_TIMEOUT = 2000; // 2s
+// Segments left in the pool longer than this are unlinked
+const int POOL_TIMEOUT = 250; // 0.25s
+const size_t MAX_POOLED_BYTES = 256 * 1024 * 1024;
 
 #ifdef DEBUG_LOG
 #define COLOR "\033[31;1m"
@@ -39,6 +44,20 @@ std::unordered_map<int, ClientSession> client_sessions;
 // TODO: check if objects have been freed from time to time
 std::set<std::string> used_objects;
 
+using Clock = std::chrono::steady_clock;
+
+struct PooledObject {
+  std::string name;
+  Clock::time_point released;
+};
+
+// The size class of the objects that can be pooled
+std::unordered_map<std::string, size_t> object_sizes;
+// The objects whose last reference was closed, by size class, most recently
+// released last
+std::unordered_map<size_t, std::vector<PooledObject>> pooled_objects;
+size_t pooled_bytes = 0;
+
 
 void register_fd(int fd) {
   struct pollfd pfd = {0};
@@ -82,6 +101,63 @@ void free_used_object(const std::string &name) {
   }
 }
 
+void unlink_object(const std::string &name) {
+  DEBUG("unlinking %s", name.c_str());
+  shm_unlink(name.c_str());
+  used_objects.erase(name);
+  object_sizes.erase(name);
+}
+
+// The last reference to the object was closed
+void release_object(const std::string &name) {
+  auto it = object_sizes.find(name);
+  if (it == object_sizes.end() || pooled_bytes + it->second > MAX_POOLED_BYTES) {
+    unlink_object(name);
+    return;
+  }
+  DEBUG("pooling %s", name.c_str());
+  pooled_objects[it->second].push_back({name, Clock::now()});
+  pooled_bytes += it->second;
+}
+
+// Returns a pooled object of the given size class, or an empty string
+std::string acquire_object(size_t size) {
+  auto it = pooled_objects.find(size);
+  if (it == pooled_objects.end() || it->second.empty()) {
+    return "";
+  }
+  std::string name = std::move(it->second.back().name);
+  it->second.pop_back();
+  pooled_bytes -= size;
+  DEBUG("reusing %s", name.c_str());
+  return name;
+}
+
+// Unlinks the objects pooled since before the given time, and returns how long
+// until the next one expires, in ms, or -1 if the pool is empty
+int trim_pool(Clock::time_point expired) {
+  Clock::time_point oldest = Clock::time_point::max();
+  for (auto &entry : pooled_objects) {
+    auto &objects = entry.second;
+    auto alive = std::find_if(objects.begin(), objects.end(),
+        [expired](const PooledObject &object) { return object.released > expired; });
+    for (auto it = objects.begin(); it != alive; ++it) {
+      unlink_object(it->name);
+      pooled_bytes -= entry.first;
+    }
+    objects.erase(objects.begin(), alive);
+    if (!objects.empty()) {
+      oldest = std::min(oldest, objects.front().released);
+    }
+  }
+  if (oldest == Clock::time_point::max()) {
+    return -1;
+  }
+  auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      oldest - expired).count();
+  return static_cast<int>(remaining) + 1;
+}
+
 int main(int argc, char *argv[]) {
   setsid();  // Daemonize the process
 
@@ -109,8 +185,13 @@ int main(int argc, char *argv[]) {
   std::vector<int> to_remove;
   for (;;) {
     int nevents;
-    if (client_sessions.size() == 0)
+    if (client_sessions.size() == 0) {
+      // there is no one left to reuse the pool
+      trim_pool(Clock::time_point::max());
       timeout = SHUTDOWN_TIMEOUT;
+    } else {
+      timeout = trim_pool(Clock::now() - std::chrono::milliseconds(POOL_TIMEOUT));
+    }
     SYSCHECK(nevents = poll(pollfds.data(), pollfds.size(), timeout));
     timeout = -1;
     if (nevents == 0 && client_sessions.size() == 0)
@@ -137,11 +218,18 @@ int main(int argc, char *argv[]) {
           auto &session = client_sessions.at(pfd.fd);
           AllocInfo info = session.socket.receive();
           session.pid = info.pid;
-          DEBUG("got alloc info: %d %d %s", (int)info.free, info.pid, info.filename);
-          if (info.free) {
+          DEBUG("got alloc info: %d %d %d %s", (int)info.free, (int)info.pooled, info.pid, info.filename);
+          if (info.free && info.pooled) {
+            release_object(info.filename);
+          } else if (info.free) {
             free_used_object(info.filename);
+          } else if (info.pooled) {
+            session.socket.send_filename(acquire_object(info.size));
           } else {
             used_objects.insert(info.filename);
+            if (info.size != 0) {
+              object_sizes[info.filename] = info.size;
+            }
             DEBUG("registered object %s", info.filename);
             session.socket.confirm();
           }
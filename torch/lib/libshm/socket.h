@@ -93,6 +93,13 @@ public:
     send("OK", 2);
   }
 
+  // Answers a request for a pooled segment, with an empty name if there is none
+  void send_filename(const std::string &filename) {
+    char buffer[sizeof(AllocInfo::filename)] = {0};
+    strncpy(buffer, filename.c_str(), sizeof(buffer) - 1);
+    send(buffer, sizeof(buffer));
+  }
+
 };
 
 
@@ -152,4 +159,14 @@ public:
     send(&info, sizeof(info));
   }
 
+  // Returns the name of a segment of info.size bytes from the pool of the
+  // manager, which is registered as used, or an empty string if there is none
+  std::string acquire_pooled(AllocInfo &info) {
+    char buffer[sizeof(AllocInfo::filename)];
+    send(&info, sizeof(info));
+    recv(buffer, sizeof(buffer));
+    buffer[sizeof(buffer) - 1] = '\0';
+    return buffer;
+  }
+
 };
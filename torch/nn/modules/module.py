@@ -445,10 +445,31 @@ class Module(object):
         if not tracing_state._traced_module_stack:
             return None
         module = tracing_state._traced_module_stack[-1]
-        for name, child in module.named_children():
-            if child is self:
-                return name
-        return None
+        # Searching the children at every call of one of them would take a
+        # time quadratic in their number
+        names = tracing_state._traced_module_names.get(id(module))
+        if names is None:
+            names = {}
+            for name, child in module.named_children():
+                names.setdefault(id(child), name)
+            tracing_state._traced_module_names[id(module)] = names
+        return names.get(id(self))
+
+    def _trace_replay_key(self, tracing_state, input, kwargs):
+        # The calls of tensors of the modules of the types given to
+        # torch.jit.trace as replay_modules are traced once for every type,
+        # training mode, and shapes, types and devices of their inputs,
+        # parameters and buffers
+        replay_types = getattr(tracing_state, '_replay_module_types', None)
+        if not replay_types or not isinstance(self, replay_types) or kwargs:
+            return None, None
+        if not all(isinstance(i, torch.Tensor) for i in input):
+            return None, None
+        names = [name for name, _ in self.named_parameters()] + [name for name, _ in self.named_buffers()]
+        tensors = list(input) + list(self.parameters()) + list(self.buffers())
+        key = str((id(type(self)), self.training, len(input), names,
+                   [(t.size(), t.dtype, t.device) for t in tensors]))
+        return key, tensors
 
     def _slow_forward(self, *input, **kwargs):
         input_vars = tuple(torch.autograd.function._iter_tensors(input))
@@ -457,6 +478,7 @@ class Module(object):
             return self.forward(*input, **kwargs)
         if not hasattr(tracing_state, '_traced_module_stack'):
             tracing_state._traced_module_stack = []
+            tracing_state._traced_module_names = {}
         name = self._tracing_name(tracing_state)
         if name:
             tracing_state.push_scope('%s[%s]' % (self._get_name(), name))
@@ -464,7 +486,17 @@ class Module(object):
             tracing_state.push_scope(self._get_name())
         tracing_state._traced_module_stack.append(self)
         try:
-            result = self.forward(*input, **kwargs)
+            key, tensors = self._trace_replay_key(tracing_state, input, kwargs)
+            if key is None:
+                result = self.forward(*input, **kwargs)
+            else:
+                def call():
+                    result = self.forward(*input)
+                    return result, list(torch.autograd.function._iter_tensors(result))
+                if tracing_state._has_recorded_call(key):
+                    result = tracing_state._replay_call(key, tensors, call)
+                else:
+                    result = tracing_state._record_call(key, tensors, call)
         finally:
             tracing_state.pop_scope()
             tracing_state._traced_module_stack.pop()
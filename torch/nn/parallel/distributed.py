@@ -156,6 +156,13 @@ class DistributedDataParallel(Module):
                        bucket can potentially overlap with backward computation.
                        bucket_cap_mb controls the bucket size in MegaBytes (MB)
                        (default: 25)
+        comm_hook: a ``torch.distributed.CommHook`` (e.g.
+                   ``FP16CompressionHook()``, ``TopKCompressionHook(ratio)``
+                   or ``PowerSGDHook(rank)``) used instead of allreduce to
+                   reduce every bucket of gradients, e.g. to compress them.
+                   Hooks keep per-bucket state, so a hook must not be shared
+                   between models. If None, buckets are allreduced exactly.
+                   (default: None)
 
     Attributes:
         module (Module): the module to be parallelized
@@ -166,7 +173,7 @@ class DistributedDataParallel(Module):
     """
     def __init__(self, module, device_ids=None,
                  output_device=None, dim=0, broadcast_buffers=True,
-                 process_group=None, bucket_cap_mb=25):
+                 process_group=None, bucket_cap_mb=25, comm_hook=None):
 
         super(DistributedDataParallel, self).__init__()
 
@@ -187,6 +194,7 @@ class DistributedDataParallel(Module):
         self.device_ids = list(map(lambda x: _get_device_index(x, True), device_ids))
         self.output_device = _get_device_index(output_device, True)
         self.broadcast_buffers = broadcast_buffers
+        self.comm_hook = comm_hook
 
         MB = 1024 * 1024
 
@@ -354,6 +362,10 @@ class DistributedDataParallel(Module):
                 if p.requires_grad:
                     p_tmp = p.expand_as(p)
                     grad_acc = p_tmp.grad_fn.next_functions[0][0]
+                    # Buckets are reduced in reverse order, so have the
+                    # engine produce the gradients of later buckets first
+                    # to let their reduction start as early as possible.
+                    grad_acc.priority = self.bucket_map[p][0] + 1
                     grad_acc.register_hook(self._make_param_hook(p, device_idx))
                     self._grad_accs.append(grad_acc)
 
@@ -410,7 +422,9 @@ class DistributedDataParallel(Module):
         # coalesced tensor into the c10d CUDA stream for reduction
         result = dist._queue_reduction(self.process_group,
                                        self.buckets[bucket_idx],
-                                       self.device_ids)
+                                       self.device_ids,
+                                       self.comm_hook,
+                                       bucket_idx)
         self.reduction_works[bucket_idx] = result[0]
         self.buckets_coalesced[bucket_idx] = result[1]
 
@@ -1,5 +1,5 @@
 from . import rnn
 from .clip_grad import clip_grad_norm, clip_grad_norm_, clip_grad_value_
 from .weight_norm import weight_norm, remove_weight_norm
-from .convert_parameters import parameters_to_vector, vector_to_parameters
+from .convert_parameters import parameters_to_vector, vector_to_parameters, allocate_flat_grads
 from .spectral_norm import spectral_norm, remove_spectral_norm
@@ -1,3 +1,5 @@
+from collections import OrderedDict
+
 import torch
 
 
@@ -53,6 +55,50 @@ def vector_to_parameters(vec, parameters):
         pointer += num_param
 
 
+def allocate_flat_grads(parameters):
+    r"""Allocate the gradients of parameters as views into flat buffers
+
+    The parameters requiring grad are grouped by device and dtype, and the
+    ``.grad`` of each group is allocated once as consecutive views into a
+    single flat buffer, into which the following backward passes accumulate
+    in place. Zeroing the flat buffers, e.g. with ``flat_grad.zero_()``,
+    then zeroes all the gradients at once, and the flat buffers can be passed
+    to collectives without being coalesced first. Gradients the parameters
+    already have are copied into the buffers.
+
+    A backward pass with ``create_graph=True``, or setting ``.grad`` to
+    another tensor, replaces the gradient of a parameter with a tensor of its
+    own, which is no longer a view into the buffer.
+
+    Arguments:
+        parameters (Iterable[Tensor]): an iterator of Tensors that are the
+            parameters of a model.
+
+    Returns:
+        The list of flat gradient buffers, one per device and dtype, in the
+        order the parameters first appear in
+    """
+    groups = OrderedDict()
+    for param in parameters:
+        if param.requires_grad:
+            groups.setdefault((param.device, param.dtype), []).append(param)
+
+    flat_grads = []
+    for params in groups.values():
+        flat_grad = params[0].detach().new_zeros(sum(param.numel() for param in params))
+        offset = 0
+        for param in params:
+            # set_ rather than a view op, so that the gradient is not a view
+            # for autograd and can still be detached in place by zero_grad
+            grad = flat_grad.new_empty(0).set_(flat_grad.storage(), offset, param.size())
+            if param.grad is not None:
+                grad.copy_(param.grad.to_dense() if param.grad.is_sparse else param.grad)
+            param.grad = grad
+            offset += param.numel()
+        flat_grads.append(flat_grad)
+    return flat_grads
+
+
 def _check_param_device(param, old_param_device):
     r"""This helper function is to check if the parameters are located
     in the same device. Currently, the conversion between model parameters
@@ -811,10 +811,11 @@ def index_select(g, self, dim, index):
     return g.op("Gather", self, index, axis_i=dim)
 
 
-def index_put(g, self, indices_list_value, values):
+@parse_args('v', 'v', 'v', 'i')
+def index_put(g, self, indices_list_value, values, accumulate):
     indices_list = _unpack_list(indices_list_value)
     args = [self] + indices_list + [values]
-    return g.op("ATen", *args, operator_s='index_put')
+    return g.op("ATen", *args, accumulate_i=accumulate, operator_s='index_put')
 
 
 def type_as(g, self, other):
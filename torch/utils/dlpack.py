@@ -1,28 +1,50 @@
 from __future__ import absolute_import, division, print_function, unicode_literals
 import torch
+from torch._six import int_classes
 
-from torch._C import _from_dlpack as from_dlpack
-from torch._C import _to_dlpack as to_dlpack
 
-torch._C._add_docstr(from_dlpack, r"""from_dlpack(dlpack) -> Tensor
+def _stream_handle(stream):
+    if stream is None or isinstance(stream, int_classes):
+        return stream
+    # a torch.cuda.Stream
+    return stream.cuda_stream
 
-Decodes a DLPack to a tensor.
 
-Args:
-    dlpack: a PyCapsule object with the dltensor
+def from_dlpack(dlpack, stream=None):
+    r"""from_dlpack(dlpack, stream=None) -> Tensor
 
-The tensor will share the memory with the object represented
-in the dlpack.
-Note that each dlpack can only be consumed once.
-""")
+    Decodes a DLPack to a tensor.
 
-torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor) -> PyCapsule
+    Args:
+        dlpack: a PyCapsule object with the dltensor
+        stream (torch.cuda.Stream or int, optional): the stream the tensor of
+            a CUDA dlpack was produced on, or its ``cudaStream_t`` as an int.
+            The current stream waits for the work queued on it so far, without
+            blocking the host, so that the tensor can be used on the current
+            stream without synchronizing the device. Without a stream, the
+            caller must have synchronized with the producer.
 
-Returns a DLPack representing the tensor.
+    The tensor will share the memory with the object represented
+    in the dlpack.
+    Note that each dlpack can only be consumed once.
+    """
+    return torch._C._from_dlpack(dlpack, _stream_handle(stream))
 
-Args:
-    tensor: a tensor to be exported
 
-The dlpack shares the tensors memory.
-Note that each dlpack can only be consumed once.
-""")
+def to_dlpack(tensor, stream=None):
+    r"""to_dlpack(tensor, stream=None) -> PyCapsule
+
+    Returns a DLPack representing the tensor.
+
+    Args:
+        tensor: a tensor to be exported
+        stream (torch.cuda.Stream or int, optional): the stream the consumer
+            of a CUDA tensor will use it on, or its ``cudaStream_t`` as an int.
+            It waits for the work queued on the current stream so far, without
+            blocking the host. Without a stream, the consumer must synchronize
+            with the current stream itself.
+
+    The dlpack shares the tensors memory.
+    Note that each dlpack can only be consumed once.
+    """
+    return torch._C._to_dlpack(tensor, _stream_handle(stream))